@@ -11,6 +11,7 @@
 #define ZHELE_BINARY_STREAM_H
 
 #include <cstdint>
+#include <type_traits>
 
 namespace Zhele
 {
@@ -174,6 +175,10 @@ namespace Zhele
         /**
          * @brief Read data from source to buffer
          * 
+         * @details
+         * Bytes buffer is read by source bulk method (ReadBuffer) if source has it,
+         * so there is no per-byte call.
+         * 
          * @tparam PtrType Receive buffer pointer type
          * 
          * @param buffer [out] Buffer pointer
@@ -182,6 +187,11 @@ namespace Zhele
         template<typename PtrType>
         inline void Read(PtrType buffer, size_t size)
         {
+            if constexpr (IsBytePointer<PtrType> && requires {_Source::ReadBuffer(buffer, size);})
+            {
+                _Source::ReadBuffer(buffer, size);
+                return;
+            }
             for(size_t i = 0; i < size; ++i)
             {
                 *buffer = _Source::Read();
@@ -208,6 +218,9 @@ namespace Zhele
         /**
          * @brief Writes data
          * 
+         * @details
+         * Bytes buffer is written by source bulk method (WriteBuffer) if source has it.
+         * 
          * @tparam PtrType Source buffer pointer type
          * @param buffer [in] Buffer pointer
          * @param size [in] Bytes to write
@@ -215,6 +228,11 @@ namespace Zhele
         template<typename PtrType>
         inline void Write(PtrType buffer, size_t size)
         {
+            if constexpr (IsBytePointer<PtrType> && requires {_Source::WriteBuffer(buffer, size);})
+            {
+                _Source::WriteBuffer(buffer, size);
+                return;
+            }
             for(size_t i = 0; i < size; ++i)
             {
                 _Source::Write(*buffer);
@@ -234,6 +252,12 @@ namespace Zhele
         {
             _Source::WriteAsync(buffer, size);
         }
+
+    private:
+        /// Pointer to bytes (bulk methods of source work with raw memory)
+        template<typename PtrType>
+        static constexpr bool IsBytePointer = std::is_pointer_v<PtrType>
+            && sizeof(std::remove_pointer_t<PtrType>) == 1;
     };
 }
 
@@ -0,0 +1,13 @@
+/**
+ * @file
+ * United header for CAN
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+#if defined(STM32F1)
+    #include <f1/can.h>
+#endif
+#if defined(STM32F4)
+    #include <f4/can.h>
+#endif
@@ -9,11 +9,15 @@
 #ifndef ZHELE_ADC_COMMON_H
 #define ZHELE_ADC_COMMON_H
 
+#include "macro_utils/declarations.h"
+#include "nvic.h"
+
 #include <initializer_list>
 
 namespace Zhele
 {
     using AdcCallbackType = std::add_pointer_t<void(uint16_t* data, uint32_t count)>;
+    using AdcWatchdogCallbackType = std::add_pointer_t<void()>;
 
     namespace Private
     {
@@ -31,6 +35,28 @@ namespace Zhele
 
             /// Nominal reference voltage (3.3v)
             static const unsigned VRefNominal = 33000;
+
+            /// Nominal internal reference (VREFINT) voltage (1.2v)
+            static const unsigned VRefIntNominal = 12000;
+
+            /// Temperature sensor voltage at 25 C (1.41v)
+            static const unsigned TempSensorV25 = 14100;
+
+            /// Temperature sensor slope (4.3 mV/C)
+            static const unsigned TempSensorSlope = 43;
+
+            /**
+             * @brief Returns fixed-point (16.16) voltage scale
+             * 
+             * @param [in] vRef Reference voltage (in 10E-4 units)
+             * @param [in] maxValue Measurement result that corresponds to reference voltage
+             * 
+             * @returns Scale: volts = (value * scale) >> 16
+             */
+            static constexpr uint32_t VoltsScale(unsigned vRef, unsigned maxValue)
+            {
+                return (static_cast<uint32_t>(vRef) << 16) / maxValue;
+            }
             
             /// Possible adc results
             enum class AdcError
@@ -58,6 +84,9 @@ namespace Zhele
             static const uint8_t TempSensorChannel = 16;
             // Number of referenve voltage channel
             static const uint8_t ReferenceChannel = 17;
+
+            /// Analog watchdog guards all channels (regular and injected)
+            static const uint8_t WatchdogAllChannels = 0xff;
         };
 
         /**
@@ -73,19 +102,21 @@ namespace Zhele
             AdcData()
                 : regularCallback(nullptr),
                 injectedCallback(nullptr),
+                watchdogCallback(nullptr),
                 regularData(0),
                 injectedData(0),
                 error(AdcCommon::AdcError::NoError),
-                vRef(0)
+                voltsScale(0)
             {
             }
 
             AdcCallbackType regularCallback;
             AdcCallbackType injectedCallback;
+            AdcWatchdogCallbackType watchdogCallback;
             uint16_t* regularData;
             uint16_t* injectedData;
             AdcCommon::AdcError error;
-            uint16_t vRef;
+            uint32_t voltsScale;
         };
 
         template <typename _Regs, typename _ClockCtrl, typename _InputPins, typename _DmaChannel>
@@ -279,6 +310,38 @@ namespace Zhele
              */
             static void StopInjected();
 
+            /**
+             * @brief Start injected conversions started by hardware trigger (synchronized sampling)
+             * 
+             * @details
+             * Every trigger event (timer CC or TRGO, for example compare channel near center of
+             * center-aligned PWM period) converts all channels of sequence one after another
+             * and interrupt is raised when the last conversion is done. IrqHandler reads results
+             * to data buffer and calls callback, so results are delivered within conversion time
+             * plus interrupt latency after trigger (assign high ADC interrupt priority by ZHELE_IRQ_PRIORITY).
+             * Injected group interrupts regular conversion, so regular DMA scan
+             * (see StartRegularPingPong) continues in background with the same ADC.
+             * 
+             * @param [in] trigger Injected trigger (should not be software)
+             * @param [in] channels Channels (up to MaxInjected)
+             * @param [out] data Buffer for results (count elements)
+             * @param [in] count Channels count
+             * @param [in] callback Sequence complete callback (called from IrqHandler)
+             * 
+             * @retval true Conversions have been armed
+             * @retval false Invalid arguments
+             */
+            template<typename InjectedTrigger>
+            static bool StartInjectedTriggered(InjectedTrigger trigger, const uint8_t* channels, uint16_t* data, uint8_t count, AdcCallbackType callback);
+
+            /**
+             * @brief Stop triggered injected conversions
+             * 
+             * @par Returns
+             * 	Nothing
+             */
+            static void StopInjectedTriggered();
+
             /**
              * @brief Set trigger for start regular measurement
              * 
@@ -349,6 +412,30 @@ namespace Zhele
             template <typename... _Pins>
             static bool StartRegular(uint16_t* dataBuffer, uint16_t scanCount);
 
+            /**
+             * @brief Start continuous regular measurement to ping-pong buffer
+             * 
+             * @details
+             * Every regular trigger event (see SetRegularTrigger) starts scan of all channels and DMA
+             * writes results to buffer. Buffer is divided into two halves: callback is called with
+             * ready half (pointer and elements count) while DMA fills other one.
+             * So sample rate is defined by trigger timer (timer TRGO), not by CPU load.
+             * DMA runs in circular mode, so there are no gaps between blocks.
+             * If regular trigger is software (SWSTART, default after Init), ADC runs in continuous
+             * mode and converts at its maximum rate (defined by ADC clock and sample time).
+             * Callback should process half before DMA wraps to it again.
+             * 
+             * @param [in] channels Array with channels
+             * @param [in] channelsCount Channels count
+             * @param [out] dataBuffer Buffer. Must has 2 * channelsCount * halfScanCount elements.
+             * @param [in] halfScanCount Scans count in one half of buffer
+             * @param [in] callback Half buffer ready callback
+             * 
+             * @retval true Measurement has been started
+             * @retval false Measurement fail
+             */
+            static bool StartRegularPingPong(const uint8_t* channels, uint8_t channelsCount, uint16_t* dataBuffer, uint16_t halfScanCount, TransferCallback callback);
+
             /**
              * @brief Stop regular measurement
              * 
@@ -357,6 +444,44 @@ namespace Zhele
              */
             static void StopRegular();
 
+            /**
+             * @brief Enable analog watchdog
+             * 
+             * @details
+             * Watchdog compares every conversion result (regular and injected) of guarded channel
+             * with thresholds in hardware, so out-of-window value is detected within one conversion time
+             * without reading samples buffer. Callback is called from IrqHandler (ADC interrupt)
+             * after each conversion out of window, it may disable watchdog or move thresholds (hysteresis).
+             * 
+             * @param [in] channel Guarded channel (WatchdogAllChannels for all channels)
+             * @param [in] low Low threshold
+             * @param [in] high High threshold
+             * @param [in] callback Threshold event callback
+             * 
+             * @par Returns
+             * 	Nothing
+             */
+            static void SetAnalogWatchdog(uint8_t channel, uint16_t low, uint16_t high, AdcWatchdogCallbackType callback);
+
+            /**
+             * @brief Change analog watchdog thresholds
+             * 
+             * @param [in] low Low threshold
+             * @param [in] high High threshold
+             * 
+             * @par Returns
+             * 	Nothing
+             */
+            static void SetAnalogWatchdogThresholds(uint16_t low, uint16_t high);
+
+            /**
+             * @brief Disable analog watchdog
+             * 
+             * @par Returns
+             * 	Nothing
+             */
+            static void DisableAnalogWatchdog();
+
             /**
              * @brief Convert GPIO pin to ADC channel number
              * 
@@ -374,15 +499,57 @@ namespace Zhele
              */
             static AdcError GetError();
 
+            /// Fixed-point voltage scale for nominal reference voltage
+            static constexpr uint32_t NominalVoltsScale = VoltsScale(VRefNominal, (1u << ResolutionBits) - 1);
+
+            /**
+             * @brief Measure supply (reference) voltage by internal reference channel
+             * 
+             * @details
+             * Updates voltage scale used by ToVolts. Call it again if supply voltage can change.
+             * Factory calibration value of internal reference is used if device has one.
+             * 
+             * @returns Supply voltage in 10E-4 units
+             */
+            static unsigned CalibrateSupply();
+
             /**
              * @brief Converts measurement result to voltage
              * 
+             * @details
+             * Result is compensated by measured supply voltage (see CalibrateSupply,
+             * it is called on first conversion). Conversion does not use division.
+             * 
              * @param [in] value Measurement result
              * 
              * @returns Result as voltage in 10E-4 uints
              */
             static unsigned ToVolts(uint16_t value);
 
+            /**
+             * @brief Converts measurement results buffer to voltages
+             * 
+             * @param [in] data Measurement results
+             * @param [in] count Results count
+             * @param [out] volts Voltages in 10E-4 uints. May be equal to data (in-place conversion).
+             * 
+             * @par Returns
+             * 	Nothing
+             */
+            static void ToVolts(const uint16_t* data, unsigned count, uint16_t* volts);
+
+            /**
+             * @brief Converts measurement result to voltage assuming nominal reference voltage
+             * 
+             * @param [in] value Measurement result
+             * 
+             * @returns Result as voltage in 10E-4 uints
+             */
+            static constexpr unsigned ToVoltsNominal(uint16_t value)
+            {
+                return (value * NominalVoltsScale) >> 16;
+            }
+
             /**
              * @brief Returns ADC source clock frequence
              * 
@@ -415,6 +582,15 @@ namespace Zhele
              */
             static int16_t ReadTemperature();
 
+            /**
+             * @brief Converts temperature sensor measurement result to temperature
+             * 
+             * @param [in] value Temperature sensor measurement result
+             * 
+             * @returns Temperature
+             */
+            static int16_t ToTemperature(uint16_t value);
+
             /**
              * @brief Dma handler
              * 
@@ -433,7 +609,7 @@ namespace Zhele
              * @par Returns
              *  Nothing
              */
-            static void IrqHandler();
+            ZHELE_HANDLER static void IrqHandler();
             
         protected:
             static bool VerifyReady(unsigned);
@@ -0,0 +1,100 @@
+/**
+ * @file
+ * Implements ADC stream decimator
+ *
+ * @author Alexey Zhelonkin
+ * @date 2023
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_ADC_DECIMATOR_COMMON_H
+#define ZHELE_ADC_DECIMATOR_COMMON_H
+
+#include <stdint.h>
+
+namespace Zhele
+{
+    /**
+     * @brief Implements software oversampling for ADC streams (boxcar/CIC decimator)
+     *
+     * @details
+     * Replaces hardware oversampler on cores without it. Decimator is designed for
+     * ping-pong block callback (see Adc::StartRegularPingPong): each block is processed at once
+     * instead of handling ADC samples one by one. Samples are interleaved by channels
+     * (scan order), output has the same layout.
+     * Filter state is kept between blocks, so block size does not have to be multiple of ratio.
+     *
+     * Output value is sum of _Ratio^_Stages samples shifted right by _Shift bits (like L4 OVSR/OVSS).
+     * Oversampling by 4^n gives n extra bits of effective resolution (if input noise is enough),
+     * for example boxcar (_Stages = 1) with _Ratio = 16 and _Shift = 0 gives 16-bit output
+     * with 14-bit effective resolution from 12-bit ADC.
+     * _Stages > 1 gives CIC filter with better alias rejection (sinc^_Stages response).
+     *
+     * @tparam _Channels Channels count in scan
+     * @tparam _Ratio Decimation ratio
+     * @tparam _Shift Output right shift
+     * @tparam _Stages Filter order (1 - boxcar)
+     * @tparam _InputBits ADC resolution
+     */
+    template<unsigned _Channels, unsigned _Ratio, unsigned _Shift = 0, unsigned _Stages = 1, unsigned _InputBits = 12>
+    class AdcDecimator
+    {
+        static constexpr uint64_t Gain()
+        {
+            uint64_t gain = 1;
+            for(unsigned i = 0; i < _Stages; ++i)
+                gain *= _Ratio;
+            return gain;
+        }
+
+        static_assert(_Channels > 0, "Channels count should be positive");
+        static_assert(_Ratio > 1, "Decimation ratio should be greater than 1");
+        static_assert(_Stages > 0 && _Stages <= 4, "Stages count should be in range 1..4");
+        static_assert(((Gain() * ((1ull << _InputBits) - 1)) >> 32) == 0, "Filter gain is too large for 32-bit accumulators");
+        static_assert(((Gain() * ((1ull << _InputBits) - 1)) >> _Shift) <= 0xffff, "Output does not fit 16 bits, increase shift");
+    public:
+        /// Output value max
+        static const uint16_t OutputMax = static_cast<uint16_t>((Gain() * ((1ull << _InputBits) - 1)) >> _Shift);
+
+        /**
+         * @brief Decimate samples block
+         *
+         * @param [in] input Input samples (scans)
+         * @param [in] count Input samples count (should be multiple of channels count)
+         * @param [out] output Output samples. May be equal to input (in-place processing).
+         *
+         * @returns Output samples count
+         */
+        unsigned Process(const uint16_t* input, unsigned count, uint16_t* output);
+
+        /**
+         * @brief Decimate DMA block in-place
+         *
+         * @details
+         * Helper for TransferCallback: decimated samples are written to the beginning of block.
+         *
+         * @param [in, out] data Samples block (uint16_t)
+         * @param [in] size Samples count
+         *
+         * @returns Output samples count
+         */
+        unsigned Process(void* data, unsigned size);
+
+        /**
+         * @brief Reset filter state
+         *
+         * @par Returns
+         *  Nothing
+         */
+        void Reset();
+
+    private:
+        uint32_t _integrators[_Channels][_Stages] = {};
+        uint32_t _combs[_Channels][_Stages] = {};
+        unsigned _phase = 0;
+    };
+}
+
+#include "impl/adc_decimator.h"
+
+#endif //! ZHELE_ADC_DECIMATOR_COMMON_H
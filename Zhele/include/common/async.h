@@ -0,0 +1,309 @@
+/**
+ * @file
+ * Implements C++20 coroutines support for asynchronous operations
+ * 
+ * @author Alexey Zhelonkin
+ * @date 2023
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_ASYNC_COMMON_H
+#define ZHELE_ASYNC_COMMON_H
+
+#if !defined (__cpp_impl_coroutine)
+    #error "Coroutines support requires C++20 (-std=c++20)"
+#endif
+
+#include <coroutine>
+#include <stddef.h>
+#include <stdint.h>
+#include <tuple>
+#include <type_traits>
+
+#include "event_loop.h"
+#include "timer_wheel.h"
+
+#if !defined (ZHELE_COROUTINE_FRAMES_COUNT)
+    #define ZHELE_COROUTINE_FRAMES_COUNT 4
+#endif
+
+#if !defined (ZHELE_COROUTINE_FRAME_SIZE)
+    #define ZHELE_COROUTINE_FRAME_SIZE 256
+#endif
+
+namespace Zhele::Async
+{
+    namespace Private
+    {
+        /**
+         * @brief Static storage for coroutine frames
+         * 
+         * @details
+         * Pool contains ZHELE_COROUTINE_FRAMES_COUNT blocks with ZHELE_COROUTINE_FRAME_SIZE bytes each.
+         * Frame size depends on coroutine locals and compiler, so if coroutine can't be created
+         * (Task::IsValid returns false) - increase frame size or count.
+         */
+        class FramePool
+        {
+            static_assert(ZHELE_COROUTINE_FRAMES_COUNT > 0 && ZHELE_COROUTINE_FRAMES_COUNT <= 32, "Frames count should be in 1..32");
+        public:
+            /**
+             * @brief Allocate frame
+             * 
+             * @param [in] size Frame size
+             * 
+             * @returns Frame or nullptr if there is no free frame (or size is too big)
+             */
+            static void* Allocate(size_t size);
+
+            /**
+             * @brief Free frame
+             * 
+             * @param [in] frame Frame
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void Free(void* frame);
+
+        private:
+            alignas(8) static uint8_t _frames[ZHELE_COROUTINE_FRAMES_COUNT][ZHELE_COROUTINE_FRAME_SIZE];
+            static uint32_t _used;
+        };
+    }
+
+    /**
+     * @brief Coroutine task
+     * 
+     * @details
+     * Task is lazy: it starts when it is awaited by other task or spawned in event loop (see Spawn).
+     * Frames are allocated from static pool (no heap).
+     */
+    class Task
+    {
+    public:
+        class promise_type
+        {
+            friend class Task;
+
+            struct FinalAwaiter
+            {
+                bool await_ready() const noexcept { return false; }
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept;
+                void await_resume() const noexcept {}
+            };
+
+        public:
+            Task get_return_object() noexcept { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+            static Task get_return_object_on_allocation_failure() noexcept { return Task(); }
+            std::suspend_always initial_suspend() const noexcept { return {}; }
+            FinalAwaiter final_suspend() const noexcept { return {}; }
+            void return_void() const noexcept {}
+            void unhandled_exception() const noexcept {}
+
+            static void* operator new(size_t size) noexcept { return Private::FramePool::Allocate(size); }
+            static void operator delete(void* frame) noexcept { Private::FramePool::Free(frame); }
+
+        private:
+            std::coroutine_handle<> _continuation;
+            bool _detached = false;
+        };
+
+        Task() = default;
+        Task(const Task&) = delete;
+        Task(Task&& other) noexcept;
+        Task& operator=(const Task&) = delete;
+        Task& operator=(Task&& other) noexcept;
+        ~Task();
+
+        /**
+         * @brief Returns task state
+         * 
+         * @retval true Task was created
+         * @retval false Frame allocation failed
+         */
+        bool IsValid() const { return static_cast<bool>(_handle); }
+
+        /**
+         * @brief Returns task completion state
+         * 
+         * @retval true Task is done
+         * @retval false Task is not started or not completed
+         */
+        bool IsDone() const { return !_handle || _handle.done(); }
+
+        bool await_ready() const noexcept { return IsDone(); }
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> continuation) noexcept;
+        void await_resume() const noexcept {}
+
+        /**
+         * @brief Release coroutine (frame will be destroyed on completion)
+         * 
+         * @returns Coroutine handle
+         */
+        std::coroutine_handle<> Detach();
+
+    private:
+        explicit Task(std::coroutine_handle<promise_type> handle)
+            : _handle(handle)
+        {}
+
+        std::coroutine_handle<promise_type> _handle;
+    };
+
+    /**
+     * @brief Start task in event loop
+     * 
+     * @tparam _Loop Event loop
+     * 
+     * @param [in] task Task
+     * @param [in] priority Event priority
+     * 
+     * @retval true Task was started
+     * @retval false Invalid task or event queue is full
+     */
+    template<typename _Loop>
+    bool Spawn(Task&& task, unsigned priority = 0);
+
+    /**
+     * @brief Awaiter for callback-based asynchronous operation
+     * 
+     * @details
+     * Coroutine is suspended, operation is started with callback, that stores callback arguments
+     * and resumes coroutine from event loop (not from interrupt).
+     * co_await returns nothing (no arguments), argument (one argument) or std::tuple of arguments.
+     * 
+     * @tparam _Loop Event loop
+     * @tparam _Signature Callback signature
+     * @tparam _Starter Operation starter (callable, that takes callback)
+     */
+    template<typename _Loop, typename _Signature, typename _Starter>
+    class CallbackAwaiter;
+
+    template<typename _Loop, typename... _Args, typename _Starter>
+    class CallbackAwaiter<_Loop, void(_Args...), _Starter>
+    {
+        using Result = std::tuple<std::decay_t<_Args>...>;
+    public:
+        using Callback = TemplateUtils::InplaceFunction<void(_Args...)>;
+
+        CallbackAwaiter(_Starter starter, unsigned priority)
+            : _starter(starter), _priority(priority)
+        {}
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle);
+        auto await_resume();
+
+    private:
+        _Starter _starter;
+        unsigned _priority;
+        std::coroutine_handle<> _handle;
+        Result _result;
+    };
+
+    /**
+     * @brief Await callback-based asynchronous operation
+     * 
+     * @par Example
+     * @code
+     * auto [data, size, success] = co_await Await<Loop>([](TransferCallback callback) { Usart1::WriteAsync(buffer, 8, callback); });
+     * I2cStatus status = co_await Await<Loop, void(I2cStatus)>([](I2cCallback callback) { I2c1::EnableAsyncRead(0x68, 0x3b, data, 14, I2cOpts::None, callback); });
+     * @endcode
+     * 
+     * @tparam _Loop Event loop
+     * @tparam _Signature Callback signature (transfer callback by default)
+     * @tparam _Starter Operation starter
+     * 
+     * @param [in] starter Operation starter (callable, that takes callback)
+     * @param [in] priority Resume event priority
+     * 
+     * @returns Awaiter
+     */
+    template<typename _Loop, typename _Signature = void(void*, unsigned, bool), typename _Starter>
+    CallbackAwaiter<_Loop, _Signature, _Starter> Await(_Starter starter, unsigned priority = 0)
+    {
+        return CallbackAwaiter<_Loop, _Signature, _Starter>(starter, priority);
+    }
+
+    /**
+     * @brief Awaiter for yield (resume coroutine after already pending events)
+     * 
+     * @tparam _Loop Event loop
+     */
+    template<typename _Loop>
+    class YieldAwaiter
+    {
+    public:
+        explicit YieldAwaiter(unsigned priority)
+            : _priority(priority)
+        {}
+
+        bool await_ready() const noexcept { return false; }
+        bool await_suspend(std::coroutine_handle<> handle);
+        void await_resume() const noexcept {}
+
+    private:
+        unsigned _priority;
+    };
+
+    /**
+     * @brief Yield execution to other events
+     * 
+     * @tparam _Loop Event loop
+     * 
+     * @param [in] priority Resume event priority
+     * 
+     * @returns Awaiter
+     */
+    template<typename _Loop>
+    YieldAwaiter<_Loop> Yield(unsigned priority = 0)
+    {
+        return YieldAwaiter<_Loop>(priority);
+    }
+
+    /**
+     * @brief Awaiter for delay (based on software timer)
+     * 
+     * @tparam _Loop Event loop
+     * @tparam _Wheel Timer wheel
+     */
+    template<typename _Loop, typename _Wheel>
+    class SleepAwaiter
+    {
+    public:
+        SleepAwaiter(uint32_t ticks, unsigned priority)
+            : _ticks(ticks), _priority(priority)
+        {}
+
+        bool await_ready() const noexcept { return _ticks == 0; }
+        void await_suspend(std::coroutine_handle<> handle);
+        void await_resume() const noexcept {}
+
+    private:
+        Timers::SoftTimer _timer;
+        uint32_t _ticks;
+        unsigned _priority;
+    };
+
+    /**
+     * @brief Suspend coroutine for given time
+     * 
+     * @tparam _Loop Event loop
+     * @tparam _Wheel Timer wheel
+     * 
+     * @param [in] ticks Delay (timer wheel ticks)
+     * @param [in] priority Resume event priority
+     * 
+     * @returns Awaiter
+     */
+    template<typename _Loop, typename _Wheel>
+    SleepAwaiter<_Loop, _Wheel> Sleep(uint32_t ticks, unsigned priority = 0)
+    {
+        return SleepAwaiter<_Loop, _Wheel>(ticks, priority);
+    }
+}
+
+#include "impl/async.h"
+
+#endif //! ZHELE_ASYNC_COMMON_H
@@ -0,0 +1,144 @@
+/**
+ * @file
+ * @brief Bit-band access to SRAM and peripheral bits (Cortex-M3/M4)
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_BITBAND_COMMON_H
+#define ZHELE_BITBAND_COMMON_H
+
+#include <stdint.h>
+
+/**
+ * Bit-band access is used by default if MCU has bit-band regions (stm32f1, stm32f4, stm32l4).
+ * Define ZHELE_BITBAND as 0 to use read-modify-write everywhere.
+ */
+#if !defined (ZHELE_BITBAND)
+    #if defined (PERIPH_BB_BASE) && !defined (ZHELE_HOST_SIMULATION)
+        #define ZHELE_BITBAND 1
+    #else
+        #define ZHELE_BITBAND 0
+    #endif
+#endif
+
+namespace Zhele::BitBand
+{
+    /**
+     * @brief Checks that address belongs to bit-band region
+     *
+     * @details
+     * Regions are the first megabyte of SRAM (0x20000000) and of peripherals (0x40000000),
+     * so APB and AHB1 peripherals are covered, AHB2 (USB OTG, GPIO for stm32l4) is not.
+     *
+     * @param [in] address Address
+     *
+     * @retval true Bit of address has alias
+     * @retval false Bit has no alias
+     */
+    constexpr bool InRegion(uintptr_t address)
+    {
+        return (address - 0x20000000u) < 0x00100000u || (address - 0x40000000u) < 0x00100000u;
+    }
+
+    /**
+     * @brief Returns address of bit alias
+     *
+     * @param [in] address Word address (in bit-band region)
+     * @param [in] bit Bit number
+     *
+     * @returns Alias address
+     */
+    constexpr uintptr_t AliasAddress(uintptr_t address, unsigned bit)
+    {
+        return (address & 0xf0000000u) + 0x02000000u + ((address & 0x000fffffu) << 5) + (bit << 2);
+    }
+
+    /**
+     * @brief Returns alias word of register bit
+     *
+     * @param [in] reg Register (in bit-band region)
+     * @param [in] bit Bit number
+     *
+     * @returns Alias word (reads 0/1; write of 0/1 clears/sets bit)
+     */
+    template<typename T>
+    inline volatile uint32_t& Alias(volatile T& reg, unsigned bit)
+    {
+        return *reinterpret_cast<volatile uint32_t*>(AliasAddress(reinterpret_cast<uintptr_t>(&reg), bit));
+    }
+
+    /**
+     * @brief Set register bits
+     *
+     * @details
+     * Single bit in bit-band region is set by one store to alias (no read-modify-write by CPU,
+     * so interrupt cannot corrupt other bits of register), other masks are set by read-modify-write.
+     * For constant mask and register choice is made at compile time.
+     *
+     * @param [in] reg Register
+     * @param [in] mask Bits mask
+     *
+     * @par Returns
+     *	Nothing
+     */
+    template<typename T, typename U>
+    inline void SetBits(volatile T& reg, U mask)
+    {
+        uint32_t bits = static_cast<uint32_t>(mask);
+    #if ZHELE_BITBAND
+        if(bits != 0 && (bits & (bits - 1)) == 0 && InRegion(reinterpret_cast<uintptr_t>(&reg)))
+        {
+            Alias(reg, __builtin_ctz(bits)) = 1;
+            return;
+        }
+    #endif
+        reg = reg | bits;
+    }
+
+    /**
+     * @brief Clear register bits
+     *
+     * @param [in] reg Register
+     * @param [in] mask Bits mask
+     *
+     * @par Returns
+     *	Nothing
+     */
+    template<typename T, typename U>
+    inline void ClearBits(volatile T& reg, U mask)
+    {
+        uint32_t bits = static_cast<uint32_t>(mask);
+    #if ZHELE_BITBAND
+        if(bits != 0 && (bits & (bits - 1)) == 0 && InRegion(reinterpret_cast<uintptr_t>(&reg)))
+        {
+            Alias(reg, __builtin_ctz(bits)) = 0;
+            return;
+        }
+    #endif
+        reg = reg & ~bits;
+    }
+
+    /**
+     * @brief Test register bit
+     *
+     * @param [in] reg Register
+     * @param [in] mask Bit mask (single bit)
+     *
+     * @retval true Bit is set
+     * @retval false Bit is cleared
+     */
+    template<typename T, typename U>
+    inline bool TestBit(volatile T& reg, U mask)
+    {
+        uint32_t bits = static_cast<uint32_t>(mask);
+    #if ZHELE_BITBAND
+        if(bits != 0 && (bits & (bits - 1)) == 0 && InRegion(reinterpret_cast<uintptr_t>(&reg)))
+            return Alias(reg, __builtin_ctz(bits)) != 0;
+    #endif
+        return (reg & bits) != 0;
+    }
+}
+
+#endif //! ZHELE_BITBAND_COMMON_H
@@ -0,0 +1,499 @@
+/**
+ * @file
+ * Implements bxCAN driver
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_CAN_COMMON_H
+#define ZHELE_CAN_COMMON_H
+
+#include "clock.h"
+#include "iopins.h"
+#include "ioreg.h"
+#include "nvic.h"
+#include "pinlist.h"
+#include "statistics.h"
+
+#include "macro_utils/enum.h"
+#include "../containers/ring_buffer.h"
+#include "../containers/static_priority_queue.h"
+
+/*
+ * CAN options:
+ *  - ZHELE_CAN_RX_QUEUE_SIZE - receive queue size of every RX FIFO in frames (power of 2, default 32);
+ *  - ZHELE_CAN_TX_QUEUE_SIZE - transmit queue size in frames (default 16).
+ */
+#if !defined (ZHELE_CAN_RX_QUEUE_SIZE)
+    #define ZHELE_CAN_RX_QUEUE_SIZE 32
+#endif
+#if !defined (ZHELE_CAN_TX_QUEUE_SIZE)
+    #define ZHELE_CAN_TX_QUEUE_SIZE 16
+#endif
+
+namespace Zhele
+{
+    /**
+     * @brief CAN frame
+     */
+    struct CanFrame
+    {
+        uint32_t Id; ///< Identifier (11 bits for standard frame, 29 bits for extended frame)
+        uint8_t Data[8]; ///< Data
+        uint8_t Length; ///< Data length (0...8)
+        bool Extended; ///< Extended (29-bit) identifier
+        bool Remote; ///< Remote transmission request
+        uint8_t FilterIndex; ///< Index of filter matched received frame (filter match index of reference manual)
+    };
+
+    /**
+     * @brief CAN receive FIFO
+     */
+    enum class CanFifo : uint8_t
+    {
+        Fifo0 = 0,
+        Fifo1 = 1
+    };
+
+    /**
+     * @brief Filter bank in 32-bit mask mode: frame is accepted if (id & mask) == (filter id & mask)
+     *
+     * @tparam _Id Identifier
+     * @tparam _Mask Identifier mask (1 - bit must match)
+     * @tparam _Extended Filter extended identifiers (standard otherwise)
+     * @tparam _Fifo Receive FIFO for accepted frames
+     */
+    template<uint32_t _Id, uint32_t _Mask, bool _Extended = false, CanFifo _Fifo = CanFifo::Fifo0>
+    struct CanMaskFilter32;
+
+    /**
+     * @brief Filter bank in 32-bit list mode: frame is accepted if id equals one of filter identifiers
+     *
+     * @tparam _Id1 First identifier
+     * @tparam _Id2 Second identifier
+     * @tparam _Extended Filter extended identifiers (standard otherwise)
+     * @tparam _Fifo Receive FIFO for accepted frames
+     */
+    template<uint32_t _Id1, uint32_t _Id2, bool _Extended = false, CanFifo _Fifo = CanFifo::Fifo0>
+    struct CanListFilter32;
+
+    /**
+     * @brief Filter bank in 16-bit mask mode (two standard identifier filters)
+     *
+     * @tparam _Id1 First identifier
+     * @tparam _Mask1 First identifier mask
+     * @tparam _Id2 Second identifier
+     * @tparam _Mask2 Second identifier mask
+     * @tparam _Fifo Receive FIFO for accepted frames
+     */
+    template<uint16_t _Id1, uint16_t _Mask1, uint16_t _Id2, uint16_t _Mask2, CanFifo _Fifo = CanFifo::Fifo0>
+    struct CanMaskFilter16;
+
+    /**
+     * @brief Filter bank in 16-bit list mode (four standard identifiers)
+     *
+     * @tparam _Id1 First identifier
+     * @tparam _Id2 Second identifier
+     * @tparam _Id3 Third identifier
+     * @tparam _Id4 Fourth identifier
+     * @tparam _Fifo Receive FIFO for accepted frames
+     */
+    template<uint16_t _Id1, uint16_t _Id2, uint16_t _Id3, uint16_t _Id4, CanFifo _Fifo = CanFifo::Fifo0>
+    struct CanListFilter16;
+
+    class CanBase
+    {
+    public:
+        /**
+         * @brief CAN options
+         */
+        enum Options : uint32_t
+        {
+            None = 0,
+            NoAutoRetransmission = CAN_MCR_NART, ///< Frame is transmitted once (even if error or arbitration lost)
+            AutoBusOff = CAN_MCR_ABOM, ///< Leave bus-off state automatically (after 128 * 11 recessive bits)
+            AutoWakeup = CAN_MCR_AWUM, ///< Leave sleep mode on bus activity
+            Loopback = CAN_BTR_LBKM, ///< Loop back mode (transmitted frames are received)
+            Silent = CAN_BTR_SILM, ///< Silent mode (bus monitoring, nothing is transmitted)
+        };
+
+        /**
+         * @brief Error state
+         */
+        enum class ErrorState : uint8_t
+        {
+            Active, ///< Error active
+            Warning, ///< Error counter reached warning limit (96)
+            Passive, ///< Error passive (error counter is greater than 127)
+            BusOff, ///< Bus-off
+        };
+
+        /**
+         * @brief Calculates bit timing register value
+         *
+         * @details
+         * Selects prescaler with max time quanta count per bit (8...25), which gives exact bit rate and
+         * sample point nearest to required one. SJW is min(4, TS2).
+         *
+         * @param [in] clock CAN clock (APB1) frequence
+         * @param [in] bitrate Bit rate
+         * @param [in] samplePoint Sample point (in permille of bit time)
+         *
+         * @returns BTR value (without mode bits) or 0 if bit rate cannot be reached
+         */
+        static constexpr uint32_t CalculateBitTiming(uint32_t clock, uint32_t bitrate, uint16_t samplePoint = 875);
+
+    protected:
+        /**
+         * @brief Transmit queue entry (mailbox registers image)
+         */
+        struct TxEntry
+        {
+            uint32_t Tir; ///< Identifier register (without TXRQ)
+            uint32_t Tdtr; ///< Length register
+            uint32_t Tdlr; ///< Low data register
+            uint32_t Tdhr; ///< High data register
+            uint32_t Sequence; ///< Queue order (frames with equal identifiers are sent in order of write)
+        };
+
+        /**
+         * @brief Transmit queue order (lower identifier register value wins arbitration and is sent first)
+         */
+        struct TxPriority
+        {
+            bool operator()(const TxEntry& first, const TxEntry& second) const
+            {
+                return first.Tir != second.Tir
+                    ? first.Tir > second.Tir
+                    : static_cast<int32_t>(first.Sequence - second.Sequence) > 0;
+            }
+        };
+
+        static const unsigned MailboxCount = 3;
+        static const uint32_t McrOptionsMask = CAN_MCR_NART | CAN_MCR_ABOM | CAN_MCR_AWUM;
+        static const uint32_t BtrOptionsMask = CAN_BTR_LBKM | CAN_BTR_SILM;
+
+        /**
+         * @brief Converts frame to mailbox registers image
+         *
+         * @param [in] frame Frame
+         * @param [in] sequence Queue order
+         *
+         * @returns Transmit queue entry
+         */
+        static TxEntry ToTxEntry(const CanFrame& frame, uint32_t sequence);
+    };
+
+    DECLARE_ENUM_OPERATIONS(CanBase::Options)
+
+    namespace Private
+    {
+        /**
+         * @brief bxCAN
+         *
+         * @details
+         * Received frames of both RX FIFOs are drained from interrupts into lock-free queues (one per FIFO),
+         * so hardware FIFOs (3 frames only) do not overrun while application is busy.
+         * Written frames are queued by priority (CAN identifier) and loaded into free TX mailboxes from interrupt,
+         * if all mailboxes are busy with frames of lower priority, the lowest one is aborted and requeued.
+         * Enable all four interrupts (TX, RX0, RX1, SCE) and call handlers from vectors.
+         *
+         * @tparam _Regs CAN registers
+         * @tparam _FilterRegs Registers of master CAN (owner of filter banks, CAN1)
+         * @tparam _TxIrq Transmit interrupt
+         * @tparam _Rx0Irq FIFO0 interrupt
+         * @tparam _Rx1Irq FIFO1 interrupt
+         * @tparam _SceIrq Status change and error interrupt
+         * @tparam _ClockCtrl Clock control
+         * @tparam _TxPins TX pins
+         * @tparam _RxPins RX pins
+         */
+        template<typename _Regs, typename _FilterRegs, IRQn_Type _TxIrq, IRQn_Type _Rx0Irq, IRQn_Type _Rx1Irq, IRQn_Type _SceIrq, typename _ClockCtrl, typename _TxPins, typename _RxPins>
+        class Can : public CanBase
+        {
+        public:
+        #if defined (ZHELE_STATISTICS)
+            /// Runtime statistics (errors counters)
+            static CanStatistics Statistics;
+        #endif
+
+            /**
+             * @brief Initializes CAN and enters normal mode
+             *
+             * @details
+             * Bit timing is calculated from APB1 clock. Frames are not received until filters are set.
+             * CAN2 has no own filter banks, so CAN1 clock should be enabled to use it.
+             *
+             * @param [in] bitrate Bit rate
+             * @param [in] options Options
+             *
+             * @retval true Success
+             * @retval false Bit rate cannot be reached or CAN did not leave initialization mode (no bus connected)
+             */
+            static bool Init(uint32_t bitrate, Options options = None);
+
+            /**
+             * @brief Initializes CAN with bit timing calculated at compile time
+             *
+             * @tparam _Bitrate Bit rate
+             * @tparam _ClockTree Clock tree (Clock::ClockTree)
+             * @param [in] options Options
+             *
+             * @retval true Success
+             * @retval false CAN did not leave initialization mode
+             */
+            template<uint32_t _Bitrate, typename _ClockTree>
+            static bool Init(Options options = None);
+
+            /**
+             * @brief Disables CAN and its interrupts
+             *
+             * @par Returns
+             *  Nothing
+             */
+            static void Disable();
+
+            /**
+             * @brief Configures filter banks (first filter is bank 0 for CAN1 and start bank of CAN2 for CAN2)
+             *
+             * @details
+             * Filters are CanMaskFilter32, CanListFilter32, CanMaskFilter16 and CanListFilter16, bank registers
+             * are calculated at compile time. Other banks of CAN are deactivated.
+             *
+             * @tparam _Filters Filters
+             *
+             * @par Returns
+             *  Nothing
+             */
+            template<typename... _Filters>
+            static void SetFilters();
+
+        #if defined (CAN_FMR_CAN2SB)
+            /**
+             * @brief Splits filter banks between CAN1 and CAN2 (call before SetFilters of both)
+             *
+             * @param [in] slaveStartBank First bank of CAN2 (banks [0, slaveStartBank) belong to CAN1)
+             *
+             * @par Returns
+             *  Nothing
+             */
+            static void SplitFilterBanks(uint8_t slaveStartBank);
+        #endif
+
+            /**
+             * @brief Queues frame for transmission
+             *
+             * @param [in] frame Frame
+             *
+             * @retval true Frame is queued
+             * @retval false Transmit queue is full
+             */
+            static bool Write(const CanFrame& frame);
+
+            /**
+             * @brief Returns count of queued (not transmitted yet) frames, including frames in mailboxes
+             *
+             * @returns Pending frames count
+             */
+            static unsigned WritePending();
+
+            /**
+             * @brief Reads received frame (frames of FIFO0 first)
+             *
+             * @param [out] frame Frame
+             *
+             * @retval true Frame is read
+             * @retval false No received frames
+             */
+            static bool Read(CanFrame& frame);
+
+            /**
+             * @brief Reads received frame from FIFO
+             *
+             * @param [in] fifo FIFO
+             * @param [out] frame Frame
+             *
+             * @retval true Frame is read
+             * @retval false No received frames
+             */
+            static bool Read(CanFifo fifo, CanFrame& frame);
+
+            /**
+             * @brief Returns count of received frames in queues
+             *
+             * @returns Frames count
+             */
+            static unsigned ReadAvailable();
+
+            /**
+             * @brief Returns error state
+             *
+             * @returns Error state
+             */
+            static ErrorState GetErrorState();
+
+            /**
+             * @brief Returns transmit error counter
+             *
+             * @returns TEC
+             */
+            static uint8_t TransmitErrors();
+
+            /**
+             * @brief Returns receive error counter
+             *
+             * @returns REC
+             */
+            static uint8_t ReceiveErrors();
+
+            /**
+             * @brief Transmit interrupt handler
+             *
+             * @par Returns
+             *  Nothing
+             */
+            static void TxIrqHandler();
+
+            /**
+             * @brief FIFO0 interrupt handler
+             *
+             * @par Returns
+             *  Nothing
+             */
+            static void Rx0IrqHandler();
+
+            /**
+             * @brief FIFO1 interrupt handler
+             *
+             * @par Returns
+             *  Nothing
+             */
+            static void Rx1IrqHandler();
+
+            /**
+             * @brief Status change and error interrupt handler
+             *
+             * @par Returns
+             *  Nothing
+             */
+            static void SceIrqHandler();
+
+            /**
+             * @brief Select RX and TX pins (set settings)
+             *
+             * @param [in] txPinNumber pin number in Txs PinList
+             * @param [in] rxPinNumber pin number in Rxs PinList
+             *
+             * @par Returns
+             *  Nothing
+             */
+            static void SelectTxRxPins(int8_t txPinNumber, int8_t rxPinNumber);
+
+            /**
+             * @brief Template clone of SelectTxRxPins method
+             *
+             * @tparam TxPinNumber pin number in Txs PinList
+             * @tparam RxPinNumber pin number in Rxs PinList
+             *
+             * @par Returns
+             *  Nothing
+             */
+            template<int8_t TxPinNumber, int8_t RxPinNumber>
+            static void SelectTxRxPins();
+
+            /**
+             * @brief Template clone of SelectTxRxPins method (params are TPin instances)
+             *
+             * @tparam TxPin TxPin
+             * @tparam RxPin RxPin
+             *
+             * @par Returns
+             *  Nothing
+             */
+            template<typename TxPin, typename RxPin>
+            static void SelectTxRxPins();
+
+        private:
+            /**
+             * @brief Initializes CAN with given bit timing
+             *
+             * @param [in] btr Bit timing
+             * @param [in] options Options
+             *
+             * @retval true Success
+             * @retval false CAN did not leave initialization mode
+             */
+            static bool InitBitTiming(uint32_t btr, Options options);
+
+            /**
+             * @brief Returns first filter bank of CAN
+             *
+             * @returns Bank number
+             */
+            static uint8_t FirstFilterBank();
+
+            /**
+             * @brief Returns number of filter banks of CAN
+             *
+             * @returns Banks count
+             */
+            static uint8_t FilterBanksCount();
+
+            /**
+             * @brief Loads queued frames into free mailboxes, aborts low priority mailbox for higher priority frame
+             * (call with interrupts disabled)
+             *
+             * @par Returns
+             *  Nothing
+             */
+            static void FillMailboxes();
+
+            /**
+             * @brief Drains hardware FIFO into receive queue
+             *
+             * @tparam _Fifo FIFO
+             *
+             * @par Returns
+             *  Nothing
+             */
+            template<CanFifo _Fifo>
+            static void DrainFifo();
+
+            static Containers::Private::RingBufferPO2<ZHELE_CAN_RX_QUEUE_SIZE, CanFrame> _rxQueue[2];
+            static Containers::StaticPriorityQueue<TxEntry, ZHELE_CAN_TX_QUEUE_SIZE, TxPriority> _txQueue;
+            static TxEntry _mailboxes[MailboxCount];
+            static uint8_t _mailboxesBusy;
+            static uint8_t _mailboxesAborting;
+            static uint32_t _txSequence;
+        };
+
+    #if defined (ZHELE_STATISTICS)
+        template<typename _Regs, typename _FilterRegs, IRQn_Type _TxIrq, IRQn_Type _Rx0Irq, IRQn_Type _Rx1Irq, IRQn_Type _SceIrq, typename _ClockCtrl, typename _TxPins, typename _RxPins>
+        CanStatistics Can<_Regs, _FilterRegs, _TxIrq, _Rx0Irq, _Rx1Irq, _SceIrq, _ClockCtrl, _TxPins, _RxPins>::Statistics;
+    #endif
+
+        template<typename _Regs, typename _FilterRegs, IRQn_Type _TxIrq, IRQn_Type _Rx0Irq, IRQn_Type _Rx1Irq, IRQn_Type _SceIrq, typename _ClockCtrl, typename _TxPins, typename _RxPins>
+        Containers::Private::RingBufferPO2<ZHELE_CAN_RX_QUEUE_SIZE, CanFrame> Can<_Regs, _FilterRegs, _TxIrq, _Rx0Irq, _Rx1Irq, _SceIrq, _ClockCtrl, _TxPins, _RxPins>::_rxQueue[2];
+
+        template<typename _Regs, typename _FilterRegs, IRQn_Type _TxIrq, IRQn_Type _Rx0Irq, IRQn_Type _Rx1Irq, IRQn_Type _SceIrq, typename _ClockCtrl, typename _TxPins, typename _RxPins>
+        Containers::StaticPriorityQueue<CanBase::TxEntry, ZHELE_CAN_TX_QUEUE_SIZE, CanBase::TxPriority> Can<_Regs, _FilterRegs, _TxIrq, _Rx0Irq, _Rx1Irq, _SceIrq, _ClockCtrl, _TxPins, _RxPins>::_txQueue;
+
+        template<typename _Regs, typename _FilterRegs, IRQn_Type _TxIrq, IRQn_Type _Rx0Irq, IRQn_Type _Rx1Irq, IRQn_Type _SceIrq, typename _ClockCtrl, typename _TxPins, typename _RxPins>
+        CanBase::TxEntry Can<_Regs, _FilterRegs, _TxIrq, _Rx0Irq, _Rx1Irq, _SceIrq, _ClockCtrl, _TxPins, _RxPins>::_mailboxes[MailboxCount];
+
+        template<typename _Regs, typename _FilterRegs, IRQn_Type _TxIrq, IRQn_Type _Rx0Irq, IRQn_Type _Rx1Irq, IRQn_Type _SceIrq, typename _ClockCtrl, typename _TxPins, typename _RxPins>
+        uint8_t Can<_Regs, _FilterRegs, _TxIrq, _Rx0Irq, _Rx1Irq, _SceIrq, _ClockCtrl, _TxPins, _RxPins>::_mailboxesBusy = 0;
+
+        template<typename _Regs, typename _FilterRegs, IRQn_Type _TxIrq, IRQn_Type _Rx0Irq, IRQn_Type _Rx1Irq, IRQn_Type _SceIrq, typename _ClockCtrl, typename _TxPins, typename _RxPins>
+        uint8_t Can<_Regs, _FilterRegs, _TxIrq, _Rx0Irq, _Rx1Irq, _SceIrq, _ClockCtrl, _TxPins, _RxPins>::_mailboxesAborting = 0;
+
+        template<typename _Regs, typename _FilterRegs, IRQn_Type _TxIrq, IRQn_Type _Rx0Irq, IRQn_Type _Rx1Irq, IRQn_Type _SceIrq, typename _ClockCtrl, typename _TxPins, typename _RxPins>
+        uint32_t Can<_Regs, _FilterRegs, _TxIrq, _Rx0Irq, _Rx1Irq, _SceIrq, _ClockCtrl, _TxPins, _RxPins>::_txSequence = 0;
+    }
+}
+
+#include "impl/can.h"
+
+#endif //! ZHELE_CAN_COMMON_H
@@ -579,6 +579,37 @@ namespace Zhele
              * 	Nothing
              */
             static void Disable();
+
+            /**
+             * @brief Enable clock for one more user (reference counting)
+             * 
+             * @details
+             * Clock is enabled by first Acquire call and disabled by last Release call,
+             * so drivers sharing same clock (AFIO, DMA for example) do not disable it for each other.
+             * Do not mix with Disable calls for the same clock.
+             * 
+             * @par Returns
+             * 	Nothing
+             */
+            static void Acquire();
+
+            /**
+             * @brief Release clock (clock is disabled if there is no other users)
+             * 
+             * @par Returns
+             * 	Nothing
+             */
+            static void Release();
+
+            /**
+             * @brief Returns clock users count
+             * 
+             * @returns Count of Acquire calls without Release
+             */
+            static unsigned Users();
+
+        private:
+            static volatile uint8_t _users;
         };
     }
 }
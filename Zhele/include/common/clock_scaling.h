@@ -0,0 +1,165 @@
+/**
+ * @file
+ * Implements runtime system clock change with peripheral notifications
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_CLOCK_SCALING_COMMON_H
+#define ZHELE_CLOCK_SCALING_COMMON_H
+
+#include <clock.h>
+
+#include <stdint.h>
+#include <type_traits>
+
+#if !defined (ZHELE_CLOCK_SCALING_SUBSCRIBERS)
+    #define ZHELE_CLOCK_SCALING_SUBSCRIBERS 8
+#endif
+
+namespace Zhele::Clock
+{
+    /**
+     * @brief Runtime clock scaling
+     *
+     * @details
+     * Every method changes clock with safe flash wait states sequence (wait states are increased
+     * before frequence increase and decreased after frequence decrease), then updates
+     * SystemCoreClock and calls subscribers, so peripherals recalculate their dividers
+     * from new bus clock. Subscribers are called in caller context in subscribe order.
+     * Delays follow new core clock if ZHELE_DELAY_DYNAMIC_CLOCK is defined (see delay.h).
+     *
+     * Typical usage: drop to HSI in idle and burst to PLL (ClockTree) for heavy processing:
+     * @code
+     * ClockScaling::Subscribe(ClockScaling::UpdateUsart<Usart1, 115200>);
+     * ClockScaling::Subscribe(ClockScaling::UpdateTimer<Timers::Timer2, 1000000>);
+     * ClockScaling::Apply<ClockTree<72000000>>();
+     * ...
+     * ClockScaling::SelectClockSource(SysClock::Internal);
+     * @endcode
+     */
+    class ClockScaling
+    {
+    public:
+        using Callback = std::add_pointer_t<void()>;
+
+        /**
+         * @brief Subscribe to clock change
+         *
+         * @param [in] callback Callback (called after every clock change)
+         *
+         * @retval true Callback is added (or is already subscribed)
+         * @retval false No free slots (see ZHELE_CLOCK_SCALING_SUBSCRIBERS)
+         */
+        static bool Subscribe(Callback callback);
+
+        /**
+         * @brief Unsubscribe from clock change
+         *
+         * @param [in] callback Callback
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void Unsubscribe(Callback callback);
+
+        /**
+         * @brief Switch system clock source and notify subscribers
+         *
+         * @param [in] source New system clock source (PLL must be configured before)
+         *
+         * @returns Select result (subscribers are notified on success only)
+         */
+        static SysClock::ErrorCode SelectClockSource(SysClock::ClockSource source);
+
+        /**
+         * @brief Set AHB prescaler and notify subscribers
+         *
+         * @details
+         * Cheapest way to reduce consumption: PLL keeps running, so burst back to full speed is immediate.
+         *
+         * @param [in] prescaler AHB prescaler
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void SetAhbPrescaler(AhbClock::Prescaler prescaler);
+
+        /**
+         * @brief Configure clock tree and notify subscribers
+         *
+         * @tparam _ClockTree Clock tree (ClockTree from common/clock_tree.h)
+         *
+         * @retval true Clock tree is configured
+         * @retval false HSE or PLL start failed (system clock is HSI)
+         */
+        template<typename _ClockTree>
+        static bool Apply()
+        {
+            bool result = _ClockTree::Init();
+            NotifyClockChanged();
+            return result;
+        }
+
+        /**
+         * @brief Notify subscribers about clock change
+         *
+         * @details
+         * Call it after clock is changed without ClockScaling methods.
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void NotifyClockChanged();
+
+        /**
+         * @brief Subscriber that restores USART baud rate
+         *
+         * @tparam _Usart USART
+         * @tparam _Baud Baud rate
+         *
+         * @par Returns
+         *	Nothing
+         */
+        template<typename _Usart, unsigned _Baud>
+        static void UpdateUsart()
+        {
+            _Usart::SetBaud(_Baud);
+        }
+
+        /**
+         * @brief Subscriber that restores SPI clock
+         *
+         * @tparam _Spi SPI
+         * @tparam _MaxFreq Max SCK frequence
+         *
+         * @par Returns
+         *	Nothing
+         */
+        template<typename _Spi, uint32_t _MaxFreq>
+        static void UpdateSpi()
+        {
+            _Spi::SetClockFreq(_MaxFreq);
+        }
+
+        /**
+         * @brief Subscriber that restores timer tick frequence (prescaler)
+         *
+         * @tparam _Timer Timer
+         * @tparam _TickFreq Counter frequence
+         *
+         * @par Returns
+         *	Nothing
+         */
+        template<typename _Timer, uint32_t _TickFreq>
+        static void UpdateTimer()
+        {
+            uint32_t prescaler = _Timer::GetClockFreq() / _TickFreq;
+            _Timer::SetPrescaler(prescaler > 0 ? prescaler - 1 : 0);
+        }
+    };
+}
+
+#endif //! ZHELE_CLOCK_SCALING_COMMON_H
@@ -0,0 +1,191 @@
+/**
+ * @file
+ * Implements compile-time clock tree planner
+ *
+ * @author Alexey Zhelonkin
+ * @date 2023
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_CLOCK_TREE_COMMON_H
+#define ZHELE_CLOCK_TREE_COMMON_H
+
+#include <clock.h>
+#include "nvic.h"
+
+#include <stdint.h>
+#include <type_traits>
+
+namespace Zhele::Clock
+{
+    /// Clock tree planner errors
+    enum class ClockPlanError : uint8_t
+    {
+        None,              ///< Plan is valid
+        SysClockTooHigh,   ///< Requested system clock exceeds MCU limit
+        NoPllConfiguration,///< PLL cannot produce exact requested system clock from HSE
+        NoUsbConfiguration ///< PLL cannot produce system clock and exact 48 MHz USB clock at once
+    };
+
+    /**
+     * @brief Clock tree configuration (result of planner)
+     *
+     * @details
+     * Dividers are stored as real values (not register codes), unused fields are zero.
+     */
+    struct ClockPlan
+    {
+        ClockPlanError Error;
+        ClockFrequenceT SysClock;
+        ClockFrequenceT Apb1Clock;
+        ClockFrequenceT Apb2Clock; ///< Equals Apb1Clock on MCU with one APB (stm32f0)
+        ClockFrequenceT UsbClock;
+        uint8_t PllM;       ///< PLL input divider (PREDIV for stm32f0/f1)
+        uint16_t PllN;      ///< PLL multiplier
+        uint8_t PllP;       ///< PLL system clock divider (PLLR for stm32l4)
+        uint8_t PllQ;       ///< PLL 48 MHz clock divider (USB prescaler multiplied by 2 for stm32f1)
+        uint8_t Apb1Divider;
+        uint8_t Apb2Divider;
+        uint8_t FlashLatency;
+    };
+
+    namespace Private
+    {
+        /// MCU clock limits
+        struct ClockLimits
+        {
+            ClockFrequenceT MaxSysClock;
+            ClockFrequenceT MaxApb1Clock;
+            ClockFrequenceT MaxApb2Clock;
+            ClockFrequenceT FlashWaitStateStep; ///< Max flash frequence without wait states
+            uint8_t MaxFlashLatency;
+        };
+
+        /**
+         * @brief Plan clock tree: HSE -> PLL -> SYSCLK (AHB prescaler is 1)
+         *
+         * @param [in] hse HSE frequence
+         * @param [in] sysClock Required system clock
+         * @param [in] usb Required 48 MHz USB clock
+         * @param [in] maxApb1 APB1 frequence limit (0 for MCU limit)
+         * @param [in] maxApb2 APB2 frequence limit (0 for MCU limit)
+         *
+         * @returns Clock plan
+         */
+        constexpr ClockPlan PlanClockTree(ClockFrequenceT hse, ClockFrequenceT sysClock, bool usb, ClockFrequenceT maxApb1, ClockFrequenceT maxApb2);
+    }
+
+    /**
+     * @brief Clock tree configured at compile time
+     *
+     * @details
+     * PLL dividers, bus prescalers and flash wait states are computed by constexpr planner,
+     * wrong configuration breaks build with static_assert. Init writes fixed register sequence
+     * (there is no runtime search), bus frequencies are constants for baud rate and timer
+     * calculations. AHB clock is equal to system clock.
+     *
+     * @tparam _SysClockFreq Required system clock (exact value)
+     * @tparam _Usb Require 48 MHz USB clock from PLL
+     * @tparam _HseFreq HSE frequence
+     * @tparam _MaxApb1Freq APB1 frequence limit (0 for MCU limit)
+     * @tparam _MaxApb2Freq APB2 frequence limit (0 for MCU limit)
+     */
+    template<ClockFrequenceT _SysClockFreq, bool _Usb = false, ClockFrequenceT _HseFreq = HSE_VALUE,
+        ClockFrequenceT _MaxApb1Freq = 0, ClockFrequenceT _MaxApb2Freq = 0>
+    class ClockTree
+    {
+    public:
+        /// Clock plan
+        static constexpr ClockPlan Plan = Private::PlanClockTree(_HseFreq, _SysClockFreq, _Usb, _MaxApb1Freq, _MaxApb2Freq);
+
+        static_assert(Plan.Error != ClockPlanError::SysClockTooHigh, "Required system clock exceeds MCU limit");
+        static_assert(Plan.Error != ClockPlanError::NoPllConfiguration, "PLL cannot produce required system clock from HSE");
+        static_assert(Plan.Error != ClockPlanError::NoUsbConfiguration, "PLL cannot produce required system clock and 48 MHz USB clock");
+
+        static constexpr ClockFrequenceT SysClockFreq = Plan.SysClock;
+        static constexpr ClockFrequenceT AhbClockFreq = Plan.SysClock;
+        static constexpr ClockFrequenceT Apb1ClockFreq = Plan.Apb1Clock;
+        static constexpr ClockFrequenceT Apb2ClockFreq = Plan.Apb2Clock;
+        /// Timers clock is doubled if APB prescaler is not 1
+        static constexpr ClockFrequenceT Apb1TimerClockFreq = Plan.Apb1Divider == 1 ? Plan.Apb1Clock : 2 * Plan.Apb1Clock;
+        static constexpr ClockFrequenceT Apb2TimerClockFreq = Plan.Apb2Divider == 1 ? Plan.Apb2Clock : 2 * Plan.Apb2Clock;
+        static constexpr ClockFrequenceT UsbClockFreq = Plan.UsbClock;
+
+        /**
+         * @brief Bus clock of peripheral
+         *
+         * @tparam _ClockCtrl Peripheral clock control (for example, Usart1Clock)
+         */
+        template<typename _ClockCtrl>
+        static constexpr ClockFrequenceT BusClockFreq = std::is_base_of_v<Apb2Clock, _ClockCtrl> ? Apb2ClockFreq : Apb1ClockFreq;
+
+        /**
+         * @brief Configure clock tree
+         *
+         * @details
+         * Switches system clock to HSI (if it is not), configures PLL, flash and buses,
+         * then switches system clock to PLL.
+         *
+         * @retval true Clock tree is configured
+         * @retval false HSE or PLL start failed (system clock is HSI)
+         */
+        static bool Init();
+
+        using Callback = std::add_pointer_t<void()>;
+
+        /**
+         * @brief Start clock tree configuration in background
+         *
+         * @details
+         * Method returns immediately: CPU keeps running from reset clock source while HSE starts
+         * and PLL locks (about 1-2 ms), so static data and peripheral registers may be initialized
+         * meanwhile. Peripheral settings should be calculated from ClockTree constants (not from
+         * current bus frequence), they become correct after switch. RCC interrupt is used
+         * (call IrqHandler in RCC_IRQHandler), Poll can be called instead if interrupt is not used.
+         *
+         * @param [in] callback System clock switched callback (called from interrupt)
+         * @param [in] useInterrupt Enable RCC interrupt (or progress by Poll)
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void InitAsync(Callback callback = nullptr, bool useInterrupt = true);
+
+        /**
+         * @brief Check that system clock is switched to PLL
+         *
+         * @retval true Clock tree is configured
+         * @retval false Configuration is in progress
+         */
+        static bool Ready();
+
+        /**
+         * @brief Progress background configuration without interrupt
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void Poll();
+
+        /**
+         * @brief RCC interrupt handler (call it in RCC_IRQHandler)
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void IrqHandler();
+
+    private:
+        static bool SwitchToResetClock();
+        static void ConfigurePll();
+        static bool SwitchToPll();
+        static void ClearReadyFlags();
+
+        static volatile bool _ready;
+        static Callback _callback;
+    };
+}
+
+#include "impl/clock_tree.h"
+
+#endif //! ZHELE_CLOCK_TREE_COMMON_H
@@ -0,0 +1,211 @@
+/**
+ * @file
+ * Implements CRC calculation (table-driven and hardware)
+ *
+ * @author Alexey Zhelonkin
+ * @date 2023
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_CRC_COMMON_H
+#define ZHELE_CRC_COMMON_H
+
+#include <clock.h>
+
+#include "template_utils/data_transfer.h"
+#include "template_utils/lookup_tables.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace Zhele
+{
+    /**
+     * @brief Implements table-driven CRC calculation
+     *
+     * @details
+     * 256 entries lookup table is generated at compile time and placed in flash,
+     * so CRC costs one table access per byte instead of eight shift/xor steps.
+     * CRC with width less than 8 bits (CRC7) is calculated left-aligned.
+     *
+     * @tparam _Type CRC type
+     * @tparam _Width CRC width (bits)
+     * @tparam _Polynomial Polynomial (reversed for reflected CRC, 0x8c for Dallas CRC8 for example)
+     * @tparam _Init Initial value
+     * @tparam _Reflected Reflected (LSB first) algorithm
+     */
+    template<typename _Type, unsigned _Width, _Type _Polynomial, _Type _Init, bool _Reflected>
+    class TableCrc
+    {
+        static constexpr unsigned Bits = sizeof(_Type) * 8;
+        static constexpr unsigned Shift = _Reflected ? 0 : Bits - _Width;
+        static constexpr auto _table = TemplateUtils::CrcTable<_Type, _Width, _Polynomial, _Reflected>();
+    public:
+        using ValueType = _Type;
+        static const _Type Initial = _Init; ///< Initial value
+
+        /**
+         * @brief Continue CRC calculation
+         *
+         * @param [in] crc Current CRC (Initial or result of previous Update)
+         * @param [in] data Data
+         * @param [in] size Data size
+         *
+         * @returns Updated CRC
+         */
+        static _Type Update(_Type crc, const void* data, size_t size);
+
+        /**
+         * @brief Calculate CRC
+         *
+         * @param [in] data Data
+         * @param [in] size Data size
+         *
+         * @returns CRC
+         */
+        static _Type Calculate(const void* data, size_t size);
+    };
+
+    /// Dallas/Maxim CRC8 (1-Wire)
+    using Crc8Dallas = TableCrc<uint8_t, 8, 0x8c, 0x00, true>;
+
+    /// CRC7 (SD/MMC commands)
+    using Crc7 = TableCrc<uint8_t, 7, 0x09, 0x00, false>;
+
+    /// CRC16-CCITT (XModem, SD/MMC data blocks)
+    using Crc16Ccitt = TableCrc<uint16_t, 16, 0x1021, 0x0000, false>;
+
+    /// CRC16 Modbus (Modbus RTU frames, transmitted low byte first)
+    using Crc16Modbus = TableCrc<uint16_t, 16, 0xa001, 0xffff, true>;
+
+#if defined (CRC)
+    /**
+     * @brief Implements hardware CRC unit
+     *
+     * @details
+     * Default configuration is CRC-32/MPEG-2 (polynomial 0x04c11db7, initial value 0xffffffff).
+     * Polynomial, width and initial value are programmable on STM32L4 and some STM32F0.
+     * CRC unit can be fed by DMA (memory to memory transfer, DMA2 for stm32f4).
+     */
+    class HardwareCrc
+    {
+    public:
+    #if defined (CRC_CR_POLYSIZE)
+        /**
+         * @brief CRC width
+         */
+        enum class PolySize : uint32_t
+        {
+            Bits32 = 0, ///< 32 bits
+            Bits16 = CRC_CR_POLYSIZE_0, ///< 16 bits
+            Bits8 = CRC_CR_POLYSIZE_1, ///< 8 bits
+            Bits7 = CRC_CR_POLYSIZE_1 | CRC_CR_POLYSIZE_0 ///< 7 bits
+        };
+    #endif
+
+        /**
+         * @brief Enable CRC unit (and reset current value)
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void Enable();
+
+        /**
+         * @brief Disable CRC unit
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void Disable();
+
+    #if defined (CRC_CR_POLYSIZE)
+        /**
+         * @brief Configure CRC unit
+         *
+         * @param [in] size CRC width
+         * @param [in] polynomial Polynomial (not reversed)
+         * @param [in] initial Initial value
+         * @param [in] reflected Reflect input bytes and output value (LSB first CRC)
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void Configure(PolySize size, uint32_t polynomial, uint32_t initial, bool reflected = false);
+    #endif
+
+        /**
+         * @brief Reset current value to initial
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void Reset();
+
+        /**
+         * @brief Feed 32-bit words
+         *
+         * @param [in] data Data
+         * @param [in] count Words count
+         *
+         * @returns Current CRC
+         */
+        static uint32_t Update(const uint32_t* data, size_t count);
+
+    #if defined (CRC_CR_REV_IN)
+        /**
+         * @brief Feed bytes
+         *
+         * @param [in] data Data
+         * @param [in] size Data size
+         *
+         * @returns Current CRC
+         */
+        static uint32_t Update(const uint8_t* data, size_t size);
+    #endif
+
+        /**
+         * @brief Feed 32-bit words by DMA
+         *
+         * @tparam _DmaChannel DMA channel (stream) for memory to memory transfer
+         *
+         * @param [in] data Data
+         * @param [in] count Words count
+         * @param [in] callback Transfer complete callback (read result with Value)
+         *
+         * @par Returns
+         *	Nothing
+         */
+        template<typename _DmaChannel>
+        static void UpdateAsync(const uint32_t* data, size_t count, TransferCallback callback);
+
+    #if defined (CRC_CR_REV_IN)
+        /**
+         * @brief Feed bytes by DMA
+         *
+         * @tparam _DmaChannel DMA channel (stream) for memory to memory transfer
+         *
+         * @param [in] data Data
+         * @param [in] size Data size
+         * @param [in] callback Transfer complete callback (read result with Value)
+         *
+         * @par Returns
+         *	Nothing
+         */
+        template<typename _DmaChannel>
+        static void UpdateAsync(const uint8_t* data, size_t size, TransferCallback callback);
+    #endif
+
+        /**
+         * @brief Returns current CRC
+         *
+         * @returns CRC
+         */
+        static uint32_t Value();
+    };
+#endif
+}
+
+#include "impl/crc.h"
+
+#endif //! ZHELE_CRC_COMMON_H
@@ -12,11 +12,34 @@
 #include <cstdint>
 
 #include <clock.h>
+#include <dma.h>
 
 namespace Zhele
 {
     namespace Private
     {
+        /**
+         * @brief DAC trigger for timer TRGO
+         * 
+         * @details
+         * Specialized in family header: Value is DacTrigger for timer.
+         * 
+         * @tparam _Timer Timer
+         */
+        template <typename _Timer>
+        struct DacTimerTrigger;
+
+        /**
+         * @brief DMA request (stream channel or channel selection) for DAC channel
+         * 
+         * @details
+         * Specialized in family header.
+         * 
+         * @tparam _Channel DAC channel
+         */
+        template <uint8_t _Channel>
+        struct DacDmaRequest;
+
         /**
          * @brief Implementd Digital-to-Analog converter
          * 
@@ -174,6 +197,240 @@ namespace Zhele
              *  Nothing
              */
             static void CauseSoftwareTrigger();
+
+            /**
+             * @brief Start continuous output from ping-pong buffer
+             * 
+             * @details
+             * DMA writes samples (12-bit right aligned) to data holding register, every trigger event
+             * (see Init(Trigger)) moves next sample to output. Buffer is divided into two halves:
+             * callback is called with sent half (pointer and elements count) which should be refilled
+             * while DMA sends other one. So output sample rate is defined by trigger timer.
+             * 
+             * @tparam _DmaChannel DMA channel (stream) for DAC channel
+             * 
+             * @param [in] buffer Buffer with 2 * halfSize samples
+             * @param [in] halfSize Samples count in one half of buffer
+             * @param [in] callback Half buffer sent callback
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            template <typename _DmaChannel>
+            static void StartPingPong(uint16_t* buffer, uint16_t halfSize, TransferCallback callback);
+
+            /**
+             * @brief Stop DMA output
+             * 
+             * @tparam _DmaChannel DMA channel (stream) for DAC channel
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            template <typename _DmaChannel>
+            static void StopPingPong();
+
+            /**
+             * @brief Start waveform output from buffer paced by timer
+             * 
+             * @details
+             * Timer update event (TRGO) moves next sample to output, DMA feeds data holding register,
+             * so CPU does not handle samples at all.
+             * In circular mode buffer is output endlessly: callback is called with sent half
+             * (ping-pong, see StartPingPong), so size should be even. Buffer may be refilled
+             * from callback or stay constant (periodic waveform).
+             * In single mode callback is called once after whole buffer is sent.
+             * Timer is configured (enabled, period, TRGO) and started by this method.
+             * 
+             * @tparam _DmaChannel DMA channel (stream) for DAC channel
+             * @tparam _Timer Trigger timer (should have DacTimerTrigger specialization)
+             * 
+             * @param [in] buffer Samples (12-bit right aligned)
+             * @param [in] size Samples count
+             * @param [in] sampleRate Output sample rate (Hz)
+             * @param [in] circular Circular (ping-pong) or single output
+             * @param [in] callback Half buffer (circular) or buffer (single) sent callback
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            template <typename _DmaChannel, typename _Timer>
+            static void StartStream(const uint16_t* buffer, uint16_t size, unsigned sampleRate, bool circular, TransferCallback callback);
+
+            /**
+             * @brief Stop waveform output
+             * 
+             * @tparam _DmaChannel DMA channel (stream) for DAC channel
+             * @tparam _Timer Trigger timer
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            template <typename _DmaChannel, typename _Timer>
+            static void StopStream();
+
+        private:
+            template <typename, typename>
+            friend class DacDual;
+
+            /**
+             * @brief Select timer TRGO as channel trigger
+             * 
+             * @tparam _Timer Trigger timer
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            template <typename _Timer>
+            static void SelectTimerTrigger();
+
+            /**
+             * @brief Configure timer update (TRGO) rate and start it
+             * 
+             * @tparam _Timer Trigger timer
+             * 
+             * @param [in] sampleRate Update rate (Hz)
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            template <typename _Timer>
+            static void StartTriggerTimer(unsigned sampleRate);
+        };
+
+        /**
+         * @brief Implements synchronized output of both DAC channels
+         * 
+         * @details
+         * Both channels are written by one access to dual data holding register,
+         * so outputs (I/Q, X/Y) are updated simultaneously by common trigger.
+         * Samples are packed into 32-bit words (channel 1 in low half, channel 2 in high half),
+         * one DMA stream feeds both channels.
+         * 
+         * @tparam _Regs Registers
+         * @tparam _ClockCtrl Clock control
+         */
+        template <typename _Regs, typename _ClockCtrl>
+        class DacDual
+        {
+            using Channel1 = DacBase<_Regs, _ClockCtrl, 0>;
+            using Channel2 = DacBase<_Regs, _ClockCtrl, 1>;
+        public:
+            /**
+             * @brief Init both channels with common trigger
+             * 
+             * @tparam Trigger Trigger type
+             * 
+             * @param trigger Trigger
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            template <typename Trigger>
+            static void Init(Trigger trigger);
+
+            /**
+             * @brief Enable both channels
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void Enable();
+
+            /**
+             * @brief Disable both channels
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void Disable();
+
+            /**
+             * @brief Pack 12-bit right-aligned samples of both channels
+             * 
+             * @param channel1 Channel 1 sample
+             * @param channel2 Channel 2 sample
+             * 
+             * @returns Packed sample
+             */
+            static constexpr uint32_t Pack(uint16_t channel1, uint16_t channel2)
+            {
+                return (channel1 & 0x0fff) | (static_cast<uint32_t>(channel2 & 0x0fff) << 16);
+            }
+
+            /**
+             * @brief Write packed 12-bit right-aligned data
+             * 
+             * @param data Packed data (see Pack)
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void Write(uint32_t data);
+
+            /**
+             * @brief Write 12-bit right-aligned data to both channels
+             * 
+             * @param channel1 Channel 1 data
+             * @param channel2 Channel 2 data
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void Write(uint16_t channel1, uint16_t channel2);
+
+            /**
+             * @brief Write 8-bit data to both channels
+             * 
+             * @param channel1 Channel 1 data
+             * @param channel2 Channel 2 data
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void WriteU8(uint8_t channel1, uint8_t channel2);
+
+            /**
+             * @brief Cause software trigger for both channels
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void CauseSoftwareTrigger();
+
+            /**
+             * @brief Start output of packed samples paced by timer
+             * 
+             * @details
+             * Same as DacBase::StartStream, but each sample is packed pair for both channels.
+             * DMA channel (stream) for DAC channel 1 should be used.
+             * 
+             * @tparam _DmaChannel DMA channel (stream) for DAC channel 1
+             * @tparam _Timer Trigger timer (should have DacTimerTrigger specialization)
+             * 
+             * @param [in] buffer Packed samples (see Pack)
+             * @param [in] size Samples count
+             * @param [in] sampleRate Output sample rate (Hz)
+             * @param [in] circular Circular (ping-pong) or single output
+             * @param [in] callback Half buffer (circular) or buffer (single) sent callback
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            template <typename _DmaChannel, typename _Timer>
+            static void StartStream(const uint32_t* buffer, uint16_t size, unsigned sampleRate, bool circular, TransferCallback callback);
+
+            /**
+             * @brief Stop output
+             * 
+             * @tparam _DmaChannel DMA channel (stream) for DAC channel 1
+             * @tparam _Timer Trigger timer
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            template <typename _DmaChannel, typename _Timer>
+            static void StopStream();
         };
 #if defined (DAC1)
         IO_STRUCT_WRAPPER(DAC1, Dac1Regs, DAC_TypeDef);
@@ -183,6 +440,7 @@ namespace Zhele
 #if defined (DAC1)
     using Dac1Channel1 = Private::DacBase<Private::Dac1Regs, Clock::DacClock, 0>;
     using Dac1Channel2 = Private::DacBase<Private::Dac1Regs, Clock::DacClock, 1>;
+    using Dac1Dual = Private::DacDual<Private::Dac1Regs, Clock::DacClock>;
 #endif
 
 } // namespace Zhele
@@ -0,0 +1,114 @@
+/**
+ * @file
+ * Implements bitwise debouncing of inputs by vertical counters
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DEBOUNCER_COMMON_H
+#define ZHELE_DEBOUNCER_COMMON_H
+
+#include "nvic.h"
+
+#include <stdint.h>
+#include <type_traits>
+
+namespace Zhele
+{
+    /**
+     * @brief Debouncer of several inputs (buttons of PinList, keys of matrix)
+     *
+     * @details
+     * Every input has 2-bit counter stored "vertically" (bit N of two words is counter of input N),
+     * so all inputs are debounced by a few bitwise operations per sample, without loops.
+     * Input state is changed after 4 consecutive samples that differ from it.
+     * Sample inputs periodically (5..10 ms) from timer interrupt or DMA callback:
+     * @code
+     * Debouncer<Buttons::DataType> debouncer;
+     * // Timer IRQ: buttons are active low
+     * debouncer.Update(~Buttons::Read());
+     * // Main loop
+     * if(debouncer.Pressed() & 0x01) ...
+     * @endcode
+     *
+     * @tparam _DataType Inputs word type (unsigned integer, bit for input)
+     */
+    template<typename _DataType>
+    class Debouncer
+    {
+        static_assert(std::is_unsigned_v<_DataType>, "Inputs word should be unsigned integer");
+    public:
+        using DataType = _DataType;
+
+        /**
+         * @brief Process sample
+         *
+         * @param [in] sample Raw inputs (1 is active input)
+         *
+         * @returns Inputs with changed debounced state
+         */
+        DataType Update(DataType sample)
+        {
+            DataType changed = _state ^ sample;
+            // Counter is reset if input equals to state, otherwise counts down from 3
+            _counter0 = ~(_counter0 & changed);
+            _counter1 = _counter0 ^ (_counter1 & changed);
+            changed &= _counter0 & _counter1;
+
+            _state ^= changed;
+            _pressed |= _state & changed;
+            _released |= ~_state & changed;
+            return changed;
+        }
+
+        /**
+         * @brief Returns debounced inputs state
+         *
+         * @returns Active inputs
+         */
+        DataType State() const
+        {
+            return _state;
+        }
+
+        /**
+         * @brief Returns and clears pressed inputs
+         *
+         * @returns Inputs that have become active since last call
+         */
+        DataType Pressed()
+        {
+            return Take(_pressed);
+        }
+
+        /**
+         * @brief Returns and clears released inputs
+         *
+         * @returns Inputs that have become inactive since last call
+         */
+        DataType Released()
+        {
+            return Take(_released);
+        }
+
+    private:
+        static DataType Take(DataType& events)
+        {
+            uint32_t state = DriverCriticalSection::Enter();
+            DataType value = events;
+            events = 0;
+            DriverCriticalSection::Leave(state);
+            return value;
+        }
+
+        DataType _state = 0;
+        DataType _counter0 = static_cast<DataType>(~DataType(0));
+        DataType _counter1 = static_cast<DataType>(~DataType(0));
+        DataType _pressed = 0;
+        DataType _released = 0;
+    };
+}
+
+#endif //! ZHELE_DEBOUNCER_COMMON_H
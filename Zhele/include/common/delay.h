@@ -0,0 +1,125 @@
+/**
+ * @file
+ * Implements cycle-accurate delays
+ * 
+ * @author Alexey Zhelonkin
+ * @date 2023
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DELAY_COMMON_H
+#define ZHELE_DELAY_COMMON_H
+
+#include <stdint.h>
+
+namespace Zhele
+{
+    namespace Private
+    {
+        /**
+         * @brief Busy-wait for given CPU cycles count
+         * 
+         * @details
+         * Cortex-M3 and above: waits by DWT cycle counter (counter is enabled with first call and is never reset).
+         * Cortex-M0: waits by SysTick counter. If SysTick is not running, it will be started as free-running counter
+         * without interrupt, otherwise its current configuration (reload value, clock source) is used as is.
+         * So delay does not depend on compiler optimization level and code placement.
+         * Accuracy is a few tens of cycles (call and loop overhead).
+         * 
+         * @param [in] cycles Cycles count
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        inline void DelayCycles(uint64_t cycles)
+        {
+#if defined (DWT_CTRL_CYCCNTENA_Msk)
+            if((DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk) == 0)
+            {
+                CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+                DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+            }
+
+            // Wait by chunks, so 32-bit counter difference never overflows
+            const uint32_t MaxChunk = 0x40000000;
+            uint32_t start = DWT->CYCCNT;
+            while(cycles > MaxChunk)
+            {
+                while(DWT->CYCCNT - start < MaxChunk) ;
+                start += MaxChunk;
+                cycles -= MaxChunk;
+            }
+            while(DWT->CYCCNT - start < static_cast<uint32_t>(cycles)) ;
+#else
+            if((SysTick->CTRL & SysTick_CTRL_ENABLE_Msk) == 0)
+            {
+                SysTick->LOAD = SysTick_LOAD_RELOAD_Msk;
+                SysTick->VAL = 0;
+                SysTick->CTRL = SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_ENABLE_Msk;
+            }
+
+            // External SysTick clock is HCLK / 8
+            if((SysTick->CTRL & SysTick_CTRL_CLKSOURCE_Msk) == 0)
+                cycles /= 8;
+
+            const uint32_t reload = SysTick->LOAD + 1;
+            uint32_t previous = SysTick->VAL;
+            uint64_t elapsed = 0;
+            while(elapsed < cycles)
+            {
+                uint32_t current = SysTick->VAL;
+                elapsed += previous >= current
+                    ? previous - current
+                    : previous + reload - current;
+                previous = current;
+            }
+#endif
+        }
+    }
+
+    /**
+     * @brief Microseconds delay
+     * 
+     * @tparam us Delay (microseconds)
+     * @tparam CpuFreq CPU frequency (ignored with ZHELE_DELAY_DYNAMIC_CLOCK, SystemCoreClock is used)
+     * 
+     * @par Returns
+     *  Nothing
+     */
+    template<unsigned long us, unsigned long CpuFreq = F_CPU>
+    void delay_us()
+    {
+#if defined (ZHELE_DELAY_DYNAMIC_CLOCK)
+        Private::DelayCycles(static_cast<uint64_t>(SystemCoreClock / 1000000u) * us);
+#else
+        constexpr uint64_t cycles = static_cast<uint64_t>(CpuFreq) * us / 1000000u;
+        Private::DelayCycles(cycles);
+#endif
+    }
+
+    /**
+     * @brief Nanoseconds delay
+     * 
+     * @details
+     * Delay is rounded up to CPU cycle, but can't be less than call overhead (about a few tens of cycles).
+     * 
+     * @tparam ns Delay (nanoseconds)
+     * @tparam CpuFreq CPU frequency (ignored with ZHELE_DELAY_DYNAMIC_CLOCK, SystemCoreClock is used)
+     * 
+     * @par Returns
+     *  Nothing
+     */
+    template<unsigned long ns, unsigned long CpuFreq = F_CPU>
+    void delay_ns()
+    {
+#if defined (ZHELE_DELAY_DYNAMIC_CLOCK)
+        static_assert(ns < 1000000u, "Use delay_us for long delays");
+        Private::DelayCycles((SystemCoreClock / 1000000u * ns + 999u) / 1000u);
+#else
+        constexpr uint64_t cycles = (static_cast<uint64_t>(CpuFreq) * ns + 999999999u) / 1000000000u;
+        Private::DelayCycles(cycles);
+#endif
+    }
+}
+
+#endif //! ZHELE_DELAY_COMMON_H
@@ -11,10 +11,15 @@
 #define ZHELE_DMA_COMMON_H
 
 #include "./template_utils/data_transfer.h"
+#include "./macro_utils/declarations.h"
 #include "./macro_utils/enum.h"
 #include "ioreg.h"
+#include "statistics.h"
+#include "trace.h"
 
 #include <clock.h>
+#include "bitband.h"
+#include "nvic.h"
 
 #include <stddef.h>
 
@@ -37,6 +42,15 @@
     #define ONLY_IF_STREAM_SUPPORTED(TEXT)
 #endif
 
+#if !defined (ZHELE_DMA_VALIDATION) && !defined (NDEBUG)
+    /**
+     * Transfer buffers validation (debug builds, define ZHELE_DMA_VALIDATION as 0 to disable it).
+     * Transfer with misaligned (for PSize/MSize) or not DMA-accessible (CCM) buffer is not started,
+     * transfer callback is called with error.
+     */
+    #define ZHELE_DMA_VALIDATION 1
+#endif
+
 // Dummy function for fix compiler problem.
 // Without this hook compiler does not overload weak irq handlers (not include cpp files with handlers).
 // So, I have placed declaration here and empty definition in each cpp file.
@@ -107,8 +121,59 @@ namespace Zhele
 			HalfTransferInterrupt = DMA_SxCR_HTIE,
 			TransferCompleteInterrupt = DMA_SxCR_TCIE,
             DirectModeErrorInterrupt = DMA_SxCR_DMEIE,
+
+            PeriphFlowControl = DMA_SxCR_PFCTRL, ///< Peripheral is flow controller (SDIO)
+            MemBurst4 = DMA_SxCR_MBURST_0, ///< Memory incremental burst of 4 beats (FIFO mode only)
+            MemBurst8 = DMA_SxCR_MBURST_1, ///< Memory incremental burst of 8 beats (FIFO mode only)
+            MemBurst16 = DMA_SxCR_MBURST_0 | DMA_SxCR_MBURST_1, ///< Memory incremental burst of 16 beats (FIFO mode only)
+            PeriphBurst4 = DMA_SxCR_PBURST_0, ///< Peripheral incremental burst of 4 beats (FIFO mode only)
+            PeriphBurst8 = DMA_SxCR_PBURST_1, ///< Peripheral incremental burst of 8 beats (FIFO mode only)
+            PeriphBurst16 = DMA_SxCR_PBURST_0 | DMA_SxCR_PBURST_1, ///< Peripheral incremental burst of 16 beats (FIFO mode only)
         #endif
         };
+
+    #if defined(DMA_SxFCR_DMDIS)
+        /**
+         * @brief FIFO threshold (FIFO size is 4 words)
+         */
+        enum FifoThreshold : uint32_t
+        {
+            FifoQuarter = 0, ///< 1/4 of FIFO (1 word)
+            FifoHalf = DMA_SxFCR_FTH_0, ///< 1/2 of FIFO (2 words)
+            FifoThreeQuarters = DMA_SxFCR_FTH_1, ///< 3/4 of FIFO (3 words)
+            FifoFull = DMA_SxFCR_FTH_0 | DMA_SxFCR_FTH_1, ///< Full FIFO (4 words)
+        };
+
+        /**
+         * @brief Check FIFO mode configuration
+         * 
+         * @details
+         * In FIFO mode memory and peripheral data sizes may differ (packing/unpacking, for example
+         * 8-bit peripheral data is collected into 32-bit memory words, so memory port is accessed 4 times rarely).
+         * Memory burst size (beats multiplied by memory data size) should divide FIFO threshold
+         * and peripheral burst should not exceed FIFO size (see reference manual, FIFO threshold configurations).
+         * Usage: static_assert(DmaBase::FifoConfigValid(mode, DmaBase::FifoFull));
+         * 
+         * @param [in] mode Channel mode
+         * @param [in] threshold FIFO threshold
+         * 
+         * @retval true Configuration is valid
+         * @retval false Configuration is forbidden
+         */
+        static constexpr bool FifoConfigValid(uint32_t mode, FifoThreshold threshold)
+        {
+            const uint32_t fifoSize = 16;
+            const uint32_t beats[] = {1, 4, 8, 16};
+
+            uint32_t thresholdBytes = 4 * ((threshold >> DMA_SxFCR_FTH_Pos) + 1);
+            uint32_t memoryBurst = beats[(mode & DMA_SxCR_MBURST) >> DMA_SxCR_MBURST_Pos] * (1u << ((mode & DMA_SxCR_MSIZE) >> DMA_SxCR_MSIZE_Pos));
+            uint32_t periphBurst = beats[(mode & DMA_SxCR_PBURST) >> DMA_SxCR_PBURST_Pos] * (1u << ((mode & DMA_SxCR_PSIZE) >> DMA_SxCR_PSIZE_Pos));
+
+            if((mode & DMA_SxCR_MBURST) != 0 && (memoryBurst > thresholdBytes || thresholdBytes % memoryBurst != 0))
+                return false;
+            return periphBurst <= fifoSize;
+        }
+    #endif
     };
 
     /**
@@ -153,6 +218,17 @@ namespace Zhele
          *	Nothing
          */
         inline void NotifyError();
+
+        /**
+         * @brief Buffer (or half of buffer) ready handler. Call user`s callback if it has been set.
+         * 
+         * @param [in] buffer Ready buffer
+         * @param [in] bufferSize Ready buffer size
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        inline void NotifyBufferReady(void* buffer, unsigned bufferSize);
     };
 
     /**
@@ -170,6 +246,10 @@ namespace Zhele
         static DmaChannelData Data;
     public:
         using DmaBase::Mode;
+    #if defined (ZHELE_STATISTICS)
+        /// Runtime statistics (transfers and errors counters)
+        static DmaStatistics Statistics;
+    #endif
 
         /**
          * @brief Initialize DMA channel and start transfer
@@ -185,6 +265,49 @@ namespace Zhele
         static void Transfer(Mode mode, const void* buffer, volatile void* periph, uint32_t bufferSize
         ONLY_IF_STREAM_SUPPORTED(COMMA uint8_t channel = 0));
 
+        /**
+         * @brief Initialize DMA channel and start continuous ping-pong transfer
+         * 
+         * @details
+         * Buffer is divided into two halves. While DMA fills (or sends) one half,
+         * the other one is stable and can be processed by CPU. Transfer callback is called
+         * with pointer to stable half and its size every time DMA switches half.
+         * If DMA supports double buffer mode (DBM, stm32f4) then it is used, otherwise
+         * circular mode with half transfer interrupt is used.
+         * 
+         * @param [in] mode Channel mode (support logic operations, OR ("||") for example)
+         * @param [in] buffer Memory buffer (two halves)
+         * @param [in] periph Peripheral address
+         * @param [in] halfSize Size of one half of buffer
+         * @param [in] channel Channel (for DMA with streams)
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        static void PingPongTransfer(Mode mode, void* buffer, volatile void* periph, uint32_t halfSize
+        ONLY_IF_STREAM_SUPPORTED(COMMA uint8_t channel = 0));
+
+    #if defined(DMA_SxCR_DBM)
+        /**
+         * @brief Initialize DMA stream in double buffer mode and start transfer
+         * 
+         * @details
+         * DMA switches between two memory buffers (M0AR and M1AR) in hardware without gaps.
+         * Transfer callback is called with pointer to completed buffer.
+         * 
+         * @param [in] mode Channel mode (support logic operations, OR ("||") for example)
+         * @param [in] buffer0 First memory buffer
+         * @param [in] buffer1 Second memory buffer
+         * @param [in] periph Peripheral address
+         * @param [in] bufferSize Size of each buffer
+         * @param [in] channel Channel
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        static void DoubleBufferTransfer(Mode mode, const void* buffer0, const void* buffer1, volatile void* periph, uint32_t bufferSize, uint8_t channel = 0);
+    #endif
+
         /**
          * @brief Set transfer callback function 
          * 
@@ -195,6 +318,25 @@ namespace Zhele
          */
         static void SetTransferCallback(TransferCallback callback);
 
+    #if defined(DMA_SxFCR_DMDIS)
+        /**
+         * @brief Enable or disable FIFO mode (direct mode is used by default)
+         * 
+         * @details
+         * FIFO mode is required for burst transfers and data packing (different memory and peripheral
+         * data sizes). Call it before transfer start (FIFO control register is read-only while stream is enabled),
+         * check configuration by FifoConfigValid.
+         * 
+         * @param [in] enable Enable FIFO mode
+         * @param [in] threshold FIFO threshold
+         * @param [in] errorInterrupt Enable FIFO error (overrun/underrun) interrupt
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        static void SetFifoMode(bool enable, FifoThreshold threshold = FifoFull, bool errorInterrupt = false);
+    #endif
+
         /**
          * @brief Check that DMA ready to transfer data
          * 
@@ -332,7 +474,31 @@ namespace Zhele
          * @par Returns
          *	Nothing
          */
-        static void IrqHandler();
+        ZHELE_HANDLER static void IrqHandler();
+
+    private:
+        /**
+         * @brief Returns memory element size (in bytes) for given mode
+         * 
+         * @param [in] mode Channel mode
+         * 
+         * @returns Memory element size
+         */
+        static unsigned MemoryElementSize(uint32_t mode);
+
+    #if ZHELE_DMA_VALIDATION
+        /**
+         * @brief Checks transfer addresses (alignment and DMA accessibility)
+         * 
+         * @param [in] mode Channel mode
+         * @param [in] buffer Memory address
+         * @param [in] periph Peripheral (or second memory) address
+         * 
+         * @retval true Addresses are valid
+         * @retval false Transfer can not be started
+         */
+        static bool ValidateTransfer(uint32_t mode, const void* buffer, volatile void* periph);
+    #endif
     };
 
     /**
@@ -520,6 +686,35 @@ namespace Zhele
          *	Nothing
          */
         static void Disable();
+
+        /**
+         * @brief Mark channel as active (enables module clocking)
+         * 
+         * @details
+         * If ZHELE_DMA_AUTO_GATING is defined, module clock is reference counted by active channels
+         * (see ClockControl::Acquire): it is disabled after last active channel is disabled
+         * (by Disable call or on transfer complete interrupt), so idle DMA does not consume power.
+         * Registers of disabled channel should not be accessed then (DMA is not clocked).
+         * Otherwise method just enables module clocking. Channel methods call it themselves.
+         * 
+         * @tparam ChannelNum Channel number
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        template<int ChannelNum>
+        static void AcquireChannel();
+
+        /**
+         * @brief Mark channel as inactive (disables module clocking after last active channel)
+         * 
+         * @tparam ChannelNum Channel number
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        template<int ChannelNum>
+        static void ReleaseChannel();
     
     #if defined (DMA_CSELR_C1S)
         /**
@@ -535,10 +730,20 @@ namespace Zhele
         template<uint8_t channel>
         static void SetChannelSelect(uint8_t channelSelect);
     #endif
+
+    private:
+    #if defined (ZHELE_DMA_AUTO_GATING)
+        static volatile uint16_t _activeChannels;
+    #endif
     };
 
     template<typename _Module, typename _ChannelRegs, unsigned _Channel, IRQn_Type _IRQnumber>
     DmaChannelData DmaChannel<_Module, _ChannelRegs, _Channel, _IRQnumber>::Data;
+
+#if defined (ZHELE_STATISTICS)
+    template<typename _Module, typename _ChannelRegs, unsigned _Channel, IRQn_Type _IRQnumber>
+    DmaStatistics DmaChannel<_Module, _ChannelRegs, _Channel, _IRQnumber>::Statistics;
+#endif
 }
 
 #include "impl/dma.h"
@@ -0,0 +1,168 @@
+/**
+ * @file
+ * Implements DMA2D (Chrom-ART accelerator)
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DMA2D_COMMON_H
+#define ZHELE_DMA2D_COMMON_H
+
+#include <clock.h>
+#include "nvic.h"
+
+#include <stdint.h>
+
+#if defined (DMA2D)
+namespace Zhele
+{
+    /**
+     * @brief DMA2D (Chrom-ART) graphics accelerator
+     *
+     * @details
+     * Fills, rectangle copies, pixel format conversion and alpha blending of framebuffer areas.
+     * Every area is described by memory address (of its top left pixel), width, height and
+     * line offset (pixels between end of area line and start of next line, i.e. buffer width - area width).
+     * Operations are asynchronous: new operation waits for previous one completion,
+     * CPU access to target area should be preceded by Wait (or completion callback).
+     */
+    class Dma2D
+    {
+    public:
+        /// Pixel format (A8 and A4 are input only, CLUT formats are not supported)
+        enum class ColorMode : uint8_t
+        {
+            Argb8888 = 0, ///< 32 bit ARGB
+            Rgb888 = 1, ///< 24 bit RGB
+            Rgb565 = 2, ///< 16 bit RGB
+            Argb1555 = 3, ///< 16 bit ARGB (1-bit alpha)
+            Argb4444 = 4, ///< 16 bit ARGB (4-bit alpha)
+            A8 = 9, ///< 8 bit alpha, color is set by operation (input only)
+            A4 = 10 ///< 4 bit alpha, color is set by operation (input only)
+        };
+
+        /// Memory area
+        struct Area
+        {
+            const void* Address; ///< Address of top left pixel
+            uint16_t LineOffset; ///< Pixels between lines end and next line start
+            ColorMode Mode; ///< Pixel format
+        };
+
+        /// Operation complete callback (it is called from DMA2D interrupt)
+        using CompleteCallback = void(*)();
+
+        /**
+         * @brief Enables DMA2D clock
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Init();
+
+        /**
+         * @brief Fill area with color
+         *
+         * @param [in] destination Target area
+         * @param [in] width Area width (pixels, up to 16383)
+         * @param [in] height Area height (lines)
+         * @param [in] color Color (in target pixel format)
+         * @param [in] callback Complete callback (optional)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Fill(const Area& destination, uint16_t width, uint16_t height, uint32_t color, CompleteCallback callback = nullptr);
+
+        /**
+         * @brief Copy area (in the same pixel format, source format is ignored)
+         *
+         * @param [in] source Source area
+         * @param [in] destination Target area
+         * @param [in] width Area width (pixels, up to 16383)
+         * @param [in] height Area height (lines)
+         * @param [in] callback Complete callback (optional)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Copy(const Area& source, const Area& destination, uint16_t width, uint16_t height, CompleteCallback callback = nullptr);
+
+        /**
+         * @brief Copy area with pixel format conversion
+         *
+         * @details
+         * For A8/A4 source formats color is set by color parameter.
+         *
+         * @param [in] source Source area
+         * @param [in] destination Target area
+         * @param [in] width Area width (pixels, up to 16383)
+         * @param [in] height Area height (lines)
+         * @param [in] color Color for alpha-only source (RGB888)
+         * @param [in] callback Complete callback (optional)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Convert(const Area& source, const Area& destination, uint16_t width, uint16_t height, uint32_t color = 0, CompleteCallback callback = nullptr);
+
+        /**
+         * @brief Blend foreground area over background area
+         *
+         * @details
+         * Pixel alpha of foreground is multiplied by given alpha.
+         * Background and target areas can be the same (blending in place).
+         *
+         * @param [in] foreground Foreground area
+         * @param [in] background Background area
+         * @param [in] destination Target area
+         * @param [in] width Area width (pixels, up to 16383)
+         * @param [in] height Area height (lines)
+         * @param [in] alpha Foreground alpha multiplier (255 - opaque)
+         * @param [in] color Foreground color for alpha-only formats (RGB888)
+         * @param [in] callback Complete callback (optional)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Blend(const Area& foreground, const Area& background, const Area& destination,
+            uint16_t width, uint16_t height, uint8_t alpha = 255, uint32_t color = 0, CompleteCallback callback = nullptr);
+
+        /**
+         * @brief Returns operation state
+         *
+         * @retval true Operation is in progress
+         * @retval false DMA2D is idle
+         */
+        static bool Busy();
+
+        /**
+         * @brief Wait for operation completion
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Wait();
+
+        /**
+         * @brief DMA2D IRQ handler. Call it from DMA2D_IRQHandler
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void IrqHandler();
+
+    private:
+        static void SetOutput(const Area& destination, uint16_t width, uint16_t height);
+        static void Start(uint32_t mode, CompleteCallback callback);
+
+        static CompleteCallback _callback;
+    };
+}
+#endif
+
+#include "impl/dma2d.h"
+
+#endif //! ZHELE_DMA2D_COMMON_H
@@ -0,0 +1,130 @@
+/**
+ * @file
+ * Implements DMA channel ownership and sharing between peripherals
+ *
+ * @author Alexey Zhelonkin
+ * @date 2023
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DMA_ARBITER_COMMON_H
+#define ZHELE_DMA_ARBITER_COMMON_H
+
+#include "dma.h"
+#include "template_utils/inplace_function.h"
+#include "../containers/ring_buffer.h"
+
+namespace Zhele
+{
+    /// Callback which is called when channel is granted to owner
+    using DmaGrantCallback = TemplateUtils::InplaceFunction<void()>;
+
+    /**
+     * @brief Implements DMA channel lock with request queue
+     *
+     * @details
+     * Allows several peripherals (or drivers) to time-share one DMA channel.
+     * Owner requests channel and starts its transfer (enables peripheral DMA request
+     * and calls peripheral async method) in grant callback. When transfer is completed,
+     * owner disables its peripheral DMA request and releases channel.
+     * Pending requests are granted in FIFO order, so each request waits for
+     * at most _QueueSize transfers.
+     *
+     * @tparam _Channel DMA channel (stream)
+     * @tparam _QueueSize Max pending requests count
+     */
+    template<typename _Channel, unsigned _QueueSize = 4>
+    class DmaChannelArbiter
+    {
+        struct Request
+        {
+            const void* owner;
+            DmaGrantCallback grant;
+        };
+    public:
+        /**
+         * @brief Request channel
+         *
+         * @details
+         * If channel is free, it is granted immediately and callback is called from this method.
+         * Otherwise request is queued and callback will be called from Release (usually from DMA interrupt).
+         *
+         * @param [in] owner Owner identifier (any unique address)
+         * @param [in] grant Grant callback
+         *
+         * @retval true Channel has been granted or request has been queued
+         * @retval false Queue is full
+         */
+        static bool RequestChannel(const void* owner, DmaGrantCallback grant);
+
+        /**
+         * @brief Try to acquire channel without queueing
+         *
+         * @param [in] owner Owner identifier (any unique address)
+         *
+         * @retval true Channel has been acquired
+         * @retval false Channel is busy
+         */
+        static bool TryAcquire(const void* owner);
+
+        /**
+         * @brief Release channel and grant it to next pending owner
+         *
+         * @details
+         * Channel is disabled, its flags and transfer callback are cleared,
+         * so next owner can't be impacted by previous one.
+         *
+         * @param [in] owner Owner identifier
+         *
+         * @retval true Channel has been released
+         * @retval false Channel is not owned by given owner
+         */
+        static bool Release(const void* owner);
+
+        /**
+         * @brief Returns current owner
+         *
+         * @returns Owner identifier or nullptr if channel is free
+         */
+        static const void* Owner();
+
+        /**
+         * @brief Check owner
+         *
+         * @param [in] owner Owner identifier
+         *
+         * @retval true Channel is owned by given owner
+         * @retval false Channel is not owned by given owner
+         */
+        static bool OwnedBy(const void* owner);
+
+        /**
+         * @brief Returns busy state
+         *
+         * @retval true Channel is owned
+         * @retval false Channel is free
+         */
+        static bool Busy();
+
+        /**
+         * @brief Returns pending requests count
+         *
+         * @returns Pending requests count
+         */
+        static unsigned Pending();
+
+    private:
+        static const void* volatile _owner;
+        static Containers::RingBuffer<_QueueSize, Request> _requests;
+    };
+
+    template<typename _Channel, unsigned _QueueSize>
+    const void* volatile DmaChannelArbiter<_Channel, _QueueSize>::_owner = nullptr;
+
+    template<typename _Channel, unsigned _QueueSize>
+    Containers::RingBuffer<_QueueSize, typename DmaChannelArbiter<_Channel, _QueueSize>::Request> DmaChannelArbiter<_Channel, _QueueSize>::_requests;
+}
+
+#include "impl/dma_arbiter.h"
+
+#endif //! ZHELE_DMA_ARBITER_COMMON_H
@@ -0,0 +1,164 @@
+/**
+ * @file
+ * Implements memory-to-memory DMA transfers (copy/fill)
+ *
+ * @author Alexey Zhelonkin
+ * @date 2023
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DMA_MEMORY_COMMON_H
+#define ZHELE_DMA_MEMORY_COMMON_H
+
+#include "dma.h"
+
+#include <stddef.h>
+#include <utility>
+
+namespace Zhele
+{
+    /**
+     * @brief Implements memcpy/memset accelerator based on DMA mem2mem mode
+     *
+     * @details
+     * Class owns given DMA channels and allocates free one for each request.
+     * So, up to sizeof...(_Channels) transfers can be executed simultaneously.
+     * Channels should not be used by peripherals at the same time.
+     * Transfer unit (byte, half-word or word) is selected by buffers alignment and size.
+     *
+     * @note For stm32f4 only DMA2 streams can perform memory-to-memory transfers.
+     *
+     * @tparam _Channels DMA channels (streams)
+     */
+    template<typename... _Channels>
+    class DmaMemory
+    {
+        static_assert(sizeof...(_Channels) > 0, "DmaMemory requires at least one channel.");
+        static_assert(sizeof...(_Channels) <= 32, "DmaMemory supports up to 32 channels.");
+    public:
+        /// Max transfer size (in transfer units)
+        static const uint32_t MaxTransferCount = 0xffff;
+
+        /**
+         * @brief Copy data async (like memcpy)
+         *
+         * @param [out] destination Destination buffer
+         * @param [in] source Source buffer
+         * @param [in] size Size in bytes
+         * @param [in, opt] callback Transfer complete callback (optional parameter)
+         *
+         * @retval true Transfer has been started
+         * @retval false There is no free channel or size is too big
+         */
+        static bool CopyAsync(void* destination, const void* source, size_t size, TransferCallback callback = nullptr);
+
+        /**
+         * @brief Fill buffer async (like memset)
+         *
+         * @param [out] destination Destination buffer
+         * @param [in] pattern Fill value
+         * @param [in] size Size in bytes
+         * @param [in, opt] callback Transfer complete callback (optional parameter)
+         *
+         * @retval true Transfer has been started
+         * @retval false There is no free channel or size is too big
+         */
+        static bool FillAsync(void* destination, uint8_t pattern, size_t size, TransferCallback callback = nullptr);
+
+        /**
+         * @brief Returns busy state
+         *
+         * @retval true At least one transfer is in progress
+         * @retval false All channels are free
+         */
+        static bool Busy();
+
+        /**
+         * @brief Returns free channel existence
+         *
+         * @retval true There is free channel
+         * @retval false All channels are busy
+         */
+        static bool Ready();
+
+    private:
+        /**
+         * @brief Allocate free channel and start transfer
+         *
+         * @param [in] destination Destination buffer
+         * @param [in] source Source buffer (nullptr for fill)
+         * @param [in] pattern Fill pattern (ignored for copy)
+         * @param [in] size Size in bytes
+         * @param [in] callback Transfer complete callback
+         *
+         * @retval true Transfer has been started
+         * @retval false There is no free channel or size is too big
+         */
+        static bool Start(void* destination, const void* source, uint32_t pattern, size_t size, TransferCallback callback);
+
+        /**
+         * @brief Start transfer with channel if it is free
+         *
+         * @tparam _Index Channel index
+         *
+         * @param [in] destination Destination buffer
+         * @param [in] source Source buffer (nullptr for fill)
+         * @param [in] pattern Fill pattern (ignored for copy)
+         * @param [in] size Size in bytes
+         * @param [in] unitShift Transfer unit size (log2)
+         * @param [in] callback Transfer complete callback
+         *
+         * @retval true Channel was free, transfer has been started
+         * @retval false Channel is busy
+         */
+        template<unsigned _Index>
+        static bool TryStart(void* destination, const void* source, uint32_t pattern, size_t size, unsigned unitShift, const TransferCallback& callback);
+
+        /**
+         * @brief Channel transfer complete handler
+         *
+         * @tparam _Index Channel index
+         *
+         * @param [in] data Destination buffer
+         * @param [in] size Transfered units
+         * @param [in] success Transfer result
+         *
+         * @par Returns
+         *	Nothing
+         */
+        template<unsigned _Index>
+        static void TransferComplete(void* data, unsigned size, bool success);
+
+        /**
+         * @brief Start transfer with first free channel
+         *
+         * @tparam _Indexes Channels indexes
+         *
+         * @retval true Transfer has been started
+         * @retval false All channels are busy
+         */
+        template<size_t... _Indexes>
+        static bool StartAny(std::index_sequence<_Indexes...>, void* destination, const void* source, uint32_t pattern, size_t size, unsigned unitShift, const TransferCallback& callback);
+
+        static volatile uint32_t _busy;
+        static uint32_t _patterns[sizeof...(_Channels)];
+        static size_t _sizes[sizeof...(_Channels)];
+        static TransferCallback _callbacks[sizeof...(_Channels)];
+    };
+
+    template<typename... _Channels>
+    volatile uint32_t DmaMemory<_Channels...>::_busy = 0;
+
+    template<typename... _Channels>
+    uint32_t DmaMemory<_Channels...>::_patterns[sizeof...(_Channels)];
+
+    template<typename... _Channels>
+    size_t DmaMemory<_Channels...>::_sizes[sizeof...(_Channels)];
+
+    template<typename... _Channels>
+    TransferCallback DmaMemory<_Channels...>::_callbacks[sizeof...(_Channels)];
+}
+
+#include "impl/dma_memory.h"
+
+#endif //! ZHELE_DMA_MEMORY_COMMON_H
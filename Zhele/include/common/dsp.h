@@ -0,0 +1,353 @@
+/**
+ * @file
+ * Implements fixed-point DSP kernels (FIR, biquad IIR, decimation, mean and RMS)
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DSP_COMMON_H
+#define ZHELE_DSP_COMMON_H
+
+#include <clock.h>
+
+#include <stdint.h>
+
+/**
+ * Dual 16-bit MAC instructions (SMLAD, SMLALD) are used on Cortex-M4 (DSP extension),
+ * portable code is used on Cortex-M0/M3.
+ */
+#if defined (__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+    #define ZHELE_DSP_SIMD 1
+#else
+    #define ZHELE_DSP_SIMD 0
+#endif
+
+namespace Zhele::Dsp
+{
+    /// Q15 value (-1...1 - 2^-15)
+    using Q15 = int16_t;
+    /// Q31 value (-1...1 - 2^-31)
+    using Q31 = int32_t;
+
+    /**
+     * @brief Converts floating point value to Q15 (use at compile time for coefficients)
+     *
+     * @param [in] value Value
+     * @param [in] fractionBits Fraction bits (15 for Q15, 14 for biquad coefficients)
+     *
+     * @returns Q15 value (saturated)
+     */
+    constexpr Q15 ToQ15(double value, unsigned fractionBits = 15);
+
+    /**
+     * @brief Converts floating point value to Q31 (use at compile time for coefficients)
+     *
+     * @param [in] value Value
+     * @param [in] fractionBits Fraction bits (31 for Q31, 30 for biquad coefficients)
+     *
+     * @returns Q31 value (saturated)
+     */
+    constexpr Q31 ToQ31(double value, unsigned fractionBits = 31);
+
+    /**
+     * @brief Converts unsigned ADC samples to Q15 (mid-scale is zero)
+     *
+     * @tparam _Bits ADC resolution
+     *
+     * @param [in] input ADC samples
+     * @param [out] output Q15 samples (may be equal to input)
+     * @param [in] count Samples count
+     *
+     * @par Returns
+     *  Nothing
+     */
+    template<unsigned _Bits = 12>
+    void AdcToQ15(const uint16_t* input, Q15* output, unsigned count);
+
+    /**
+     * @brief FIR filter (Q15 samples and coefficients, 64-bit accumulator)
+     *
+     * @details
+     * Delay line is stored twice, so filter window is always contiguous and two taps are
+     * processed by one SMLALD on Cortex-M4. Output is rounded and saturated.
+     *
+     * @tparam _Taps Taps count
+     */
+    template<unsigned _Taps>
+    class FirQ15
+    {
+        static_assert(_Taps >= 2, "FIR should have at least 2 taps");
+    protected:
+        /// Taps count rounded up to pairs (extra coefficient is zero)
+        static const unsigned Length = (_Taps + 1) & ~1u;
+    public:
+        /**
+         * @brief Constructor
+         *
+         * @param [in] coefficients Impulse response h[0]...h[_Taps - 1] (Q15)
+         */
+        explicit FirQ15(const Q15 (&coefficients)[_Taps]);
+
+        /**
+         * @brief Filters samples block
+         *
+         * @param [in] input Input samples
+         * @param [out] output Output samples (may be equal to input)
+         * @param [in] count Samples count
+         *
+         * @par Returns
+         *  Nothing
+         */
+        void Process(const Q15* input, Q15* output, unsigned count);
+
+        /**
+         * @brief Filters one sample
+         *
+         * @param [in] sample Input sample
+         *
+         * @returns Output sample
+         */
+        Q15 Process(Q15 sample);
+
+        /**
+         * @brief Clears delay line
+         *
+         * @par Returns
+         *  Nothing
+         */
+        void Reset();
+
+    protected:
+        void Push(Q15 sample);
+        Q15 Output() const;
+
+        Q15 _coefficients[Length];
+        Q15 _history[2 * Length];
+        unsigned _index;
+    };
+
+    /**
+     * @brief FIR decimator (anti-aliasing FIR, output is calculated only for each _Factor input)
+     *
+     * @tparam _Taps Taps count
+     * @tparam _Factor Decimation factor
+     */
+    template<unsigned _Taps, unsigned _Factor>
+    class FirDecimatorQ15 : protected FirQ15<_Taps>
+    {
+        static_assert(_Factor > 1, "Decimation factor should be greater than 1");
+        using Base = FirQ15<_Taps>;
+    public:
+        /**
+         * @brief Constructor
+         *
+         * @param [in] coefficients Impulse response (Q15)
+         */
+        explicit FirDecimatorQ15(const Q15 (&coefficients)[_Taps]);
+
+        /**
+         * @brief Decimates samples block
+         *
+         * @details
+         * Phase is kept between blocks, so block size does not have to be multiple of factor.
+         *
+         * @param [in] input Input samples
+         * @param [out] output Output samples (may be equal to input)
+         * @param [in] count Input samples count
+         *
+         * @returns Output samples count
+         */
+        unsigned Process(const Q15* input, Q15* output, unsigned count);
+
+        /**
+         * @brief Clears delay line and phase
+         *
+         * @par Returns
+         *  Nothing
+         */
+        void Reset();
+
+    private:
+        unsigned _phase = 0;
+    };
+
+    /**
+     * @brief Biquad section coefficients for Q15 filter (Q14: value * 2^14, |value| < 2)
+     *
+     * @details
+     * y[n] = b0 x[n] + b1 x[n-1] + b2 x[n-2] + a1 y[n-1] + a2 y[n-2]
+     * (feedback coefficients are negated in comparison with usual a1, a2 notation)
+     */
+    struct BiquadQ15Coefficients
+    {
+        Q15 B0;
+        Q15 B1;
+        Q15 B2;
+        Q15 A1;
+        Q15 A2;
+    };
+
+    /**
+     * @brief Biquad section coefficients for Q31 filter (Q30: value * 2^30, |value| < 2)
+     *
+     * @details
+     * y[n] = b0 x[n] + b1 x[n-1] + b2 x[n-2] + a1 y[n-1] + a2 y[n-2]
+     */
+    struct BiquadQ31Coefficients
+    {
+        Q31 B0;
+        Q31 B1;
+        Q31 B2;
+        Q31 A1;
+        Q31 A2;
+    };
+
+    /**
+     * @brief Cascade of biquad sections (direct form I, Q15 samples, 64-bit accumulator)
+     *
+     * @tparam _Stages Sections count
+     */
+    template<unsigned _Stages>
+    class BiquadCascadeQ15
+    {
+        static_assert(_Stages > 0, "Cascade should have at least one section");
+    public:
+        /**
+         * @brief Constructor
+         *
+         * @param [in] coefficients Sections coefficients
+         */
+        explicit BiquadCascadeQ15(const BiquadQ15Coefficients (&coefficients)[_Stages]);
+
+        /**
+         * @brief Filters samples block
+         *
+         * @param [in] input Input samples
+         * @param [out] output Output samples (may be equal to input)
+         * @param [in] count Samples count
+         *
+         * @par Returns
+         *  Nothing
+         */
+        void Process(const Q15* input, Q15* output, unsigned count);
+
+        /**
+         * @brief Clears filter state
+         *
+         * @par Returns
+         *  Nothing
+         */
+        void Reset();
+
+    private:
+        struct Section
+        {
+            Q15 B0;
+            uint32_t B12; ///< b1 | b2 << 16
+            uint32_t A12; ///< a1 | a2 << 16
+            uint32_t X12; ///< x[n-1] | x[n-2] << 16
+            uint32_t Y12; ///< y[n-1] | y[n-2] << 16
+        };
+        Section _sections[_Stages];
+    };
+
+    /**
+     * @brief Cascade of biquad sections (direct form I, Q31 samples, 64-bit accumulator)
+     *
+     * @details
+     * Input should have some headroom for filters with large gain at any frequency.
+     *
+     * @tparam _Stages Sections count
+     */
+    template<unsigned _Stages>
+    class BiquadCascadeQ31
+    {
+        static_assert(_Stages > 0, "Cascade should have at least one section");
+    public:
+        /**
+         * @brief Constructor
+         *
+         * @param [in] coefficients Sections coefficients
+         */
+        explicit BiquadCascadeQ31(const BiquadQ31Coefficients (&coefficients)[_Stages]);
+
+        /**
+         * @brief Filters samples block
+         *
+         * @param [in] input Input samples
+         * @param [out] output Output samples (may be equal to input)
+         * @param [in] count Samples count
+         *
+         * @par Returns
+         *  Nothing
+         */
+        void Process(const Q31* input, Q31* output, unsigned count);
+
+        /**
+         * @brief Clears filter state
+         *
+         * @par Returns
+         *  Nothing
+         */
+        void Reset();
+
+    private:
+        BiquadQ31Coefficients _coefficients[_Stages];
+        Q31 _state[_Stages][4];
+    };
+
+    /**
+     * @brief Calculates mean value
+     *
+     * @param [in] data Samples
+     * @param [in] count Samples count (positive)
+     *
+     * @returns Mean value
+     */
+    Q15 Mean(const Q15* data, unsigned count);
+
+    /**
+     * @brief Calculates mean value
+     *
+     * @param [in] data Samples
+     * @param [in] count Samples count (positive)
+     *
+     * @returns Mean value
+     */
+    Q31 Mean(const Q31* data, unsigned count);
+
+    /**
+     * @brief Calculates root mean square (two samples per SMLALD on Cortex-M4)
+     *
+     * @param [in] data Samples
+     * @param [in] count Samples count (positive)
+     *
+     * @returns RMS value
+     */
+    Q15 Rms(const Q15* data, unsigned count);
+
+    /**
+     * @brief Calculates root mean square
+     *
+     * @param [in] data Samples
+     * @param [in] count Samples count (positive)
+     *
+     * @returns RMS value
+     */
+    Q31 Rms(const Q31* data, unsigned count);
+
+    /**
+     * @brief Calculates integer square root (bit by bit, no division)
+     *
+     * @param [in] value Value
+     *
+     * @returns Floor of square root
+     */
+    uint32_t SquareRoot(uint64_t value);
+}
+
+#include "impl/dsp.h"
+
+#endif //! ZHELE_DSP_COMMON_H
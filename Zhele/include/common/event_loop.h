@@ -0,0 +1,138 @@
+/**
+ * @file
+ * Implements event queue and run-to-completion scheduler
+ * 
+ * @author Alexey Zhelonkin
+ * @date 2023
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_EVENT_LOOP_COMMON_H
+#define ZHELE_EVENT_LOOP_COMMON_H
+
+#include <atomic>
+#include <stdint.h>
+
+#include "power.h"
+#include "nvic.h"
+#include "template_utils/data_transfer.h"
+#include "template_utils/inplace_function.h"
+
+namespace Zhele
+{
+    /// Event handler type (enough for deferred transfer callback with its arguments)
+    using EventHandler = TemplateUtils::InplaceFunction<void(), 4 * sizeof(void*)>;
+
+    /**
+     * @brief Implements event loop (priority run-to-completion scheduler)
+     * 
+     * @details
+     * Interrupt handlers post events (handlers) into bounded queues, main thread executes them one by one
+     * (highest priority first, FIFO within priority), so heavy work is moved out of interrupt context.
+     * Post is lock-free (LDREX/STREX based) on Cortex-M3 and above, so it never disables interrupts
+     * and can be called from any ISR and from thread. On Cortex-M0 short critical section is used instead.
+     * Events are never preempted by other events (run to completion).
+     * 
+     * @tparam _QueueSize Queue size for each priority (power of 2)
+     * @tparam _Priorities Priorities count (0 - lowest)
+     */
+    template<unsigned _QueueSize = 32, unsigned _Priorities = 2>
+    class EventLoop
+    {
+        static_assert(_QueueSize >= 2 && (_QueueSize & (_QueueSize - 1)) == 0, "Queue size should be power of 2");
+        static_assert(_Priorities > 0);
+    public:
+        /**
+         * @brief Post event
+         * 
+         * @param [in] handler Event handler
+         * @param [in] priority Event priority
+         * 
+         * @retval true Event was queued
+         * @retval false Queue is full (event is dropped)
+         */
+        static bool Post(EventHandler handler, unsigned priority = 0);
+
+        /**
+         * @brief Execute one pending event (with highest priority)
+         * 
+         * @retval true Event was executed
+         * @retval false There is no pending events
+         */
+        static bool RunOnce();
+
+        /**
+         * @brief Execute all pending events
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void RunPending();
+
+        /**
+         * @brief Run event loop (never returns)
+         * 
+         * @details
+         * MCU sleeps (see Power::LowPower::Idle) while there are no pending events.
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        [[noreturn]] static void Run();
+
+        /**
+         * @brief Returns dropped events count (queue overflows)
+         * 
+         * @returns Dropped events count
+         */
+        static unsigned Dropped();
+
+        /**
+         * @brief Makes transfer callback deferred to event loop
+         * 
+         * @details
+         * Returned callback (for DMA, USART, SPI and so on) posts event with its arguments,
+         * target callback is called from event loop. Target should have static storage duration.
+         * Buffer with transferred data should not be reused until target callback is called.
+         * 
+         * @param [in] target Target callback
+         * @param [in] priority Event priority
+         * 
+         * @returns Callback for driver
+         */
+        static TransferCallback Defer(const TransferCallback& target, unsigned priority = 0);
+
+    private:
+        // Slot sequence is stored relative to slot lap start (position - position % _QueueSize),
+        // so zero-initialized (static) queue is ready for use without initialization.
+        // Sequence equals to lap start if slot is free for write and to lap start + 1 if slot contains event.
+        struct Slot
+        {
+            std::atomic<uint32_t> Sequence;
+            EventHandler Handler;
+        };
+
+        struct Queue
+        {
+            Slot Slots[_QueueSize];
+            std::atomic<uint32_t> Tail;
+            uint32_t Head;
+        };
+
+        static constexpr uint32_t Lap(uint32_t position)
+        {
+            return position & ~(_QueueSize - 1);
+        }
+
+        static bool Pop(Queue& queue, EventHandler& handler);
+        static bool Reserve(Queue& queue, uint32_t& position);
+        static bool Empty();
+
+        static Queue _queues[_Priorities];
+        static std::atomic<uint32_t> _dropped;
+    };
+}
+
+#include "impl/event_loop.h"
+
+#endif //! ZHELE_EVENT_LOOP_COMMON_H
@@ -10,6 +10,7 @@
 #define ZHELE_EXTI_COMMON_H
 
 #include <ioports.h>
+#include "nvic.h"
 
 namespace Zhele
 {
@@ -23,6 +24,9 @@ namespace Zhele
     class Exti
     {
     public:
+        static const uint8_t Line = _Line; ///< EXTI line
+        static const IRQn_Type IRQn = _IRQn; ///< IRQ number
+
         enum Trigger
         {
             Rising = 1,
@@ -108,6 +112,25 @@ namespace Zhele
          */
         static void DisableInterrupt();
 
+        /**
+         * @brief Enable event for this EXTI line
+         * 
+         * @details
+         * Event wakes core up from WFE (see LowPower::WaitForEvent) without interrupt handler call.
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void EnableEvent();
+
+        /**
+         * @brief Disable event for this EXTI line
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void DisableEvent();
+
         /**
          * @brief Clear interrupt flag for this EXTI line
          * 
@@ -125,6 +148,72 @@ namespace Zhele
          */
         static void EnableClock();
     };
+
+    /**
+     * @brief EXTI line handler (for ExtiDispatcher)
+     * 
+     * @tparam _Exti EXTI line
+     * @tparam _Callback Handler function
+     */
+    template<typename _Exti, void (*_Callback)()>
+    struct ExtiHandler
+    {
+        using Exti = _Exti;
+        static constexpr void (*Callback)() = _Callback;
+    };
+
+    /**
+     * @brief Implements compile-time EXTI dispatch table
+     * 
+     * @details
+     * Lines 5-9 and 10-15 (4-15 for stm32f0) share one IRQ. Dispatcher handles pending flags
+     * of registered lines of given IRQ: flags are cleared at once and handlers are called
+     * in line order (pending bits are iterated by count trailing zeros).
+     * Call IrqHandler from EXTI IRQ handler, for example:
+     * @code
+     * using Dispatcher = ExtiDispatcher<ExtiHandler<Exti5, OnEncoder>, ExtiHandler<Exti8, OnIr>>;
+     * extern "C" void EXTI9_5_IRQHandler()
+     * {
+     *     Dispatcher::IrqHandler<EXTI9_5_IRQn>();
+     * }
+     * @endcode
+     * 
+     * @tparam _Handlers Line handlers (ExtiHandler)
+     */
+    template<typename... _Handlers>
+    class ExtiDispatcher
+    {
+        using Callback = void (*)();
+
+        template<IRQn_Type _IRQn>
+        static constexpr uint32_t LinesMask = ((_Handlers::Exti::IRQn == _IRQn ? (1ul << _Handlers::Exti::Line) : 0ul) | ... | 0ul);
+
+        static constexpr uint32_t AllLinesMask = ((1ul << _Handlers::Exti::Line) | ... | 0ul);
+        static_assert(sizeof...(_Handlers) == 0 || __builtin_popcountl(AllLinesMask) == sizeof...(_Handlers), "Every line can have only one handler");
+
+        struct Table
+        {
+            constexpr Table()
+                : Callbacks {}
+            {
+                ((Callbacks[_Handlers::Exti::Line] = _Handlers::Callback), ...);
+            }
+
+            Callback Callbacks[32];
+        };
+        static constexpr Table _table {};
+    public:
+        /**
+         * @brief Handle pending lines of IRQ
+         * 
+         * @tparam _IRQn IRQ number
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        template<IRQn_Type _IRQn>
+        static void IrqHandler();
+    };
 }
 
 #include "impl/exti.h"
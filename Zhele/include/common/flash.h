@@ -10,6 +10,7 @@
 #define ZHELE_FLASH_COMMON_H
 
 #include <stdint.h>
+#include <type_traits>
 
 namespace Zhele
 {
@@ -17,7 +18,240 @@ namespace Zhele
 	{
     public:
         static void ConfigureFrequence(uint32_t frequence);
+
+        /**
+         * @brief Set flash latency (wait states)
+         *
+         * @param [in] latency Wait states count
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void SetLatency(uint8_t latency);
+
+        /**
+         * @brief Enable prefetch buffer
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void EnablePrefetch();
+
+        /**
+         * @brief Disable prefetch buffer
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void DisablePrefetch();
+
+#if defined (FLASH_ACR_ICEN)
+        /**
+         * @brief Enable instruction cache
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void EnableICache();
+
+        /**
+         * @brief Disable instruction cache
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void DisableICache();
+
+        /**
+         * @brief Enable data cache
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void EnableDCache();
+
+        /**
+         * @brief Disable data cache
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void DisableDCache();
+
+        /**
+         * @brief Enable ART accelerator (instruction cache, data cache and prefetch)
+         *
+         * @details
+         * Recommended preset for code execution from flash with wait states,
+         * ClockTree applies it with planned latency.
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void EnableArt();
+
+        /**
+         * @brief Disable ART accelerator (instruction cache, data cache and prefetch)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void DisableArt();
+
+        /**
+         * @brief Reset instruction and data caches
+         *
+         * @details
+         * Caches are disabled while reset and restored after it. ErasePage and Program
+         * call this method, so cached lines never hold old flash content.
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void ResetCaches();
+#endif
+
+        /**
+         * @brief Unlock flash for erase/program
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Unlock();
+
+        /**
+         * @brief Lock flash
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Lock();
+
+        /**
+         * @brief Erase page (sector for stm32f4) which contains given address
+         *
+         * @details
+         * Flash should be unlocked. CPU is stalled while erasing if code is executed from flash.
+         *
+         * @param [in] address Any address inside page
+         *
+         * @retval true Page has been erased
+         * @retval false Error
+         */
+        static bool ErasePage(uint32_t address);
+
+        /**
+         * @brief Program flash
+         *
+         * @details
+         * Flash should be unlocked and erased.
+         * Address and size should be aligned to program unit
+         * (2 bytes for stm32f0/f1, 8 bytes for stm32l4, parallelism for stm32f4).
+         *
+         * @param [in] address Destination address
+         * @param [in] data Data to program
+         * @param [in] size Data size (in bytes)
+         *
+         * @retval true Data has been programmed
+         * @retval false Error
+         */
+        static bool Program(uint32_t address, const void* data, uint32_t size);
+
+#if defined (FLASH_CR_PSIZE)
+        /// Program parallelism (depends on supply voltage)
+        enum class Parallelism : uint8_t
+        {
+            x8 = 0,  ///< 1.7...3.6 V
+            x16 = 1, ///< 2.1...3.6 V
+            x32 = 2, ///< 2.7...3.6 V
+            x64 = 3  ///< External Vpp
+        };
+
+        /**
+         * @brief Set program parallelism (x8 by default)
+         *
+         * @param [in] parallelism Parallelism
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void SetParallelism(Parallelism parallelism);
+#endif
+
+#if defined (FLASH_CR_FSTPG)
+        /// Fast programming row size (32 double words)
+        static const uint32_t RowSize = 256;
+
+        /**
+         * @brief Program row by fast programming
+         *
+         * @details
+         * Flash should be unlocked and erased, address should be aligned to row.
+         * Row is programmed at once (about 2 times faster than double words),
+         * interrupts are disabled while row is written. Any flash read breaks fast programming,
+         * so data should be in RAM and the method should be called from RAM for single bank devices.
+         *
+         * @param [in] address Destination address
+         * @param [in] data Row data
+         *
+         * @retval true Row has been programmed
+         * @retval false Error
+         */
+        static bool ProgramRow(uint32_t address, const void* data);
+#endif
+
+        /// Erase/program complete callback
+        using OperationCallback = std::add_pointer_t<void(bool success)>;
+
+        /**
+         * @brief Start page (sector for stm32f4) erase
+         *
+         * @details
+         * Flash should be unlocked. Completion is handled in flash interrupt
+         * (call IrqHandler in FLASH_IRQHandler).
+         *
+         * @param [in] address Any address inside page
+         * @param [in] callback Erase complete callback
+         *
+         * @retval true Erase has been started
+         * @retval false Other operation is in progress
+         */
+        static bool ErasePageAsync(uint32_t address, OperationCallback callback = nullptr);
+
+        /**
+         * @brief Start flash program
+         *
+         * @details
+         * Each program unit is written by flash interrupt (call IrqHandler in FLASH_IRQHandler),
+         * so CPU does not wait the programming. Requirements are the same as Program method,
+         * data should be valid until operation completion.
+         *
+         * @param [in] address Destination address
+         * @param [in] data Data to program
+         * @param [in] size Data size (in bytes)
+         * @param [in] callback Program complete callback
+         *
+         * @retval true Program has been started
+         * @retval false Other operation is in progress
+         */
+        static bool ProgramAsync(uint32_t address, const void* data, uint32_t size, OperationCallback callback = nullptr);
+
+        /**
+         * @brief Check that async operation is in progress
+         *
+         * @retval true Operation is in progress
+         * @retval false Flash is ready
+         */
+        static bool Busy();
+
+        /**
+         * @brief Flash interrupt handler
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void IrqHandler();
     };
 }
 
-#endif //! ZHELE_FLASH_COMMON_H
\ No newline at end of file
+#endif //! ZHELE_FLASH_COMMON_H
@@ -0,0 +1,278 @@
+/**
+ * @file
+ * Implements allocation-free text formatting (without printf)
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_FORMAT_COMMON_H
+#define ZHELE_FORMAT_COMMON_H
+
+#include "template_utils/fixed_string.h"
+
+#include <array>
+#include <stdint.h>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace Zhele::Formatting
+{
+    /// Max length of formatted 32-bit integer (with sign)
+    const unsigned MaxIntegerLength = 11;
+
+    /// Max length of formatted fixed-point or float number (sign, 10 integer digits, point, 9 decimals)
+    const unsigned MaxNumberLength = 21;
+
+    /// Max conversion width
+    const unsigned MaxWidth = 32;
+
+    /**
+     * @brief Fixed-point argument (Q format: value = Raw / 2^_FractionBits)
+     *
+     * @tparam _FractionBits Count of fractional bits (for example, 15 for Q15, 16 for Q16.16)
+     */
+    template<unsigned _FractionBits>
+    struct Fixed
+    {
+        static_assert(_FractionBits < 32, "Fraction bits count should be less than 32");
+        static const unsigned FractionBits = _FractionBits;
+        int32_t Raw;
+    };
+
+    /**
+     * @brief Returns count of decimal digits
+     *
+     * @param [in] value Value
+     *
+     * @returns Digits count (1...10)
+     */
+    constexpr unsigned DecimalDigits(uint32_t value);
+
+    /**
+     * @brief Writes unsigned decimal
+     *
+     * @details
+     * Two digits are written per one division by 100 (digit pairs table).
+     * Buffer is not null-terminated.
+     *
+     * @param [out] buffer Buffer (at least MaxIntegerLength chars)
+     * @param [in] value Value
+     *
+     * @returns Written chars count
+     */
+    constexpr unsigned WriteUnsigned(char* buffer, uint32_t value);
+
+    /**
+     * @brief Writes signed decimal
+     *
+     * @param [out] buffer Buffer (at least MaxIntegerLength chars)
+     * @param [in] value Value
+     *
+     * @returns Written chars count
+     */
+    constexpr unsigned WriteSigned(char* buffer, int32_t value);
+
+    /**
+     * @brief Writes hexadecimal (without prefix)
+     *
+     * @param [out] buffer Buffer (at least 8 chars)
+     * @param [in] value Value
+     * @param [in] minDigits Min digits count (leading zeros are added)
+     * @param [in] upperCase Use A...F instead of a...f
+     *
+     * @returns Written chars count
+     */
+    constexpr unsigned WriteHex(char* buffer, uint32_t value, unsigned minDigits = 1, bool upperCase = false);
+
+    /**
+     * @brief Writes fixed-point number
+     *
+     * @param [out] buffer Buffer (at least MaxNumberLength chars)
+     * @param [in] value Raw value (value / 2^fractionBits)
+     * @param [in] fractionBits Count of fractional bits (0...31)
+     * @param [in] decimals Count of decimals (0...9, last one is rounded)
+     *
+     * @returns Written chars count
+     */
+    constexpr unsigned WriteFixed(char* buffer, int32_t value, unsigned fractionBits, unsigned decimals);
+
+    /**
+     * @brief Writes floating point number
+     *
+     * @details
+     * Number is split to 32-bit integer and scaled fraction, so only integer arithmetic
+     * and two float conversions are used (no software double). Values with absolute value 2^32 and greater
+     * are written in exponent form (1.234e+12).
+     *
+     * @param [out] buffer Buffer (at least MaxNumberLength chars)
+     * @param [in] value Value
+     * @param [in] decimals Count of decimals (0...6, last one is rounded)
+     *
+     * @returns Written chars count
+     */
+    constexpr unsigned WriteFloat(char* buffer, float value, unsigned decimals);
+
+    namespace Private
+    {
+        /**
+         * @brief Format string part: literal and following conversion
+         */
+        struct Segment
+        {
+            unsigned LiteralBegin; ///< Literal begin offset
+            unsigned LiteralEnd; ///< Literal end offset
+            char Type; ///< Conversion type (0 - no conversion)
+            bool Left; ///< Left alignment ('-' flag)
+            bool Zero; ///< Zero padding ('0' flag)
+            bool Plus; ///< Plus for positive numbers ('+' flag)
+            uint8_t Width; ///< Min width
+            int8_t Precision; ///< Precision (-1 if not specified)
+            unsigned Argument; ///< Argument index
+        };
+
+        /**
+         * @brief Counts format segments
+         *
+         * @details
+         * Conversion is %[flags][width][.precision]type, where flags are '-', '+', '0' and type
+         * is one of d, i, u, x, X, c, s, f. "%%" is literal percent.
+         *
+         * @param [in] text Format string
+         * @param [in] length Format string length
+         *
+         * @returns Segments count or -1 if format is invalid
+         */
+        constexpr int SegmentsCount(const char* text, unsigned length);
+
+        /**
+         * @brief Parses format string
+         *
+         * @tparam _Count Segments count
+         *
+         * @param [in] text Format string
+         * @param [in] length Format string length
+         *
+         * @returns Segments
+         */
+        template<unsigned _Count>
+        constexpr std::array<Segment, _Count> Parse(const char* text, unsigned length);
+    }
+
+    /**
+     * @brief Compile-time parsed format string
+     *
+     * @tparam _Format Format string
+     */
+    template<TemplateUtils::fixed_string _Format>
+    struct FormatString
+    {
+        static constexpr int SegmentsCount = Private::SegmentsCount(_Format.Text, _Format.Length);
+        static_assert(SegmentsCount > 0, "Invalid format string (conversions are %[-+0][width][.precision]{d|i|u|x|X|c|s|f})");
+
+        /// Format segments
+        static constexpr std::array<Private::Segment, SegmentsCount> Segments = Private::Parse<SegmentsCount>(_Format.Text, _Format.Length);
+
+        /// Arguments count
+        static constexpr unsigned ArgumentsCount = Segments[SegmentsCount - 1].Argument + (Segments[SegmentsCount - 1].Type != 0 ? 1 : 0);
+    };
+
+    /**
+     * @brief Sink which writes to caller buffer (null-terminated, output is truncated by size)
+     */
+    struct BufferSink
+    {
+        char* Data; ///< Buffer
+        unsigned Size; ///< Buffer size (including null terminator)
+        unsigned Length; ///< Written chars count
+
+        /**
+         * @brief Writes chars
+         *
+         * @param [in] data Chars
+         * @param [in] size Chars count
+         *
+         * @par Returns
+         *  Nothing
+         */
+        constexpr void Write(const char* data, unsigned size);
+    };
+
+    /**
+     * @brief Fixed capacity formatted string (for display Puts methods)
+     *
+     * @tparam _Capacity Max length
+     */
+    template<unsigned _Capacity>
+    struct String
+    {
+        char Text[_Capacity + 1] = {}; ///< Null-terminated text
+        unsigned Length = 0; ///< Length
+
+        /**
+         * @brief Returns null-terminated text
+         *
+         * @returns Text
+         */
+        const char* c_str() const { return Text; }
+    };
+
+    /**
+     * @brief Formats arguments to sink
+     *
+     * @details
+     * Sink is any object with Write(const char* data, unsigned size) method (for example, BufferSink
+     * or BinaryStream) or with Write(uint8_t) method (chars are written one by one).
+     * Format is parsed at compile time, arguments count and types are checked at compile time.
+     *
+     * @tparam _Format Format string
+     * @tparam _Sink Sink type
+     * @tparam _Args Arguments types
+     *
+     * @param [in] sink Sink
+     * @param [in] args Arguments
+     *
+     * @par Returns
+     *  Nothing
+     */
+    template<TemplateUtils::fixed_string _Format, typename _Sink, typename... _Args>
+    constexpr void Print(_Sink& sink, const _Args&... args);
+
+    /**
+     * @brief Formats arguments to buffer
+     *
+     * @tparam _Format Format string
+     * @tparam _Args Arguments types
+     *
+     * @param [out] buffer Buffer
+     * @param [in] size Buffer size (including null terminator)
+     * @param [in] args Arguments
+     *
+     * @returns Written chars count (without null terminator)
+     */
+    template<TemplateUtils::fixed_string _Format, typename... _Args>
+    constexpr unsigned Format(char* buffer, unsigned size, const _Args&... args);
+
+    /**
+     * @brief Formats arguments to fixed capacity string
+     *
+     * @details
+     * Example: Display::Puts<Font>(ToString<"T=%.1f">(temperature).c_str());
+     *
+     * @tparam _Format Format string
+     * @tparam _Capacity String capacity
+     * @tparam _Args Arguments types
+     *
+     * @param [in] args Arguments
+     *
+     * @returns String
+     */
+    template<TemplateUtils::fixed_string _Format, unsigned _Capacity = 32, typename... _Args>
+    constexpr String<_Capacity> ToString(const _Args&... args);
+}
+
+#include "impl/format.h"
+
+#endif //! ZHELE_FORMAT_COMMON_H
@@ -0,0 +1,147 @@
+/**
+ * @file
+ * Implements gated and reciprocal frequency counter on timers pair
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_FREQUENCY_COUNTER_COMMON_H
+#define ZHELE_FREQUENCY_COUNTER_COMMON_H
+
+#include <stdint.h>
+#include <type_traits>
+
+namespace Zhele::Timers
+{
+    /**
+     * @brief Implements frequency counter (up to tens of MHz) without per-edge interrupts
+     *
+     * @details
+     * Gate timer runs in one-pulse mode and opens gate (TRGO = counter enable) for gate time.
+     * High frequencies are measured by gated counting: counter timer is clocked by ETR
+     * (external clock mode 2 with ETR prescaler) and gated by gate timer TRGO,
+     * so only counter overflows (once per 65536 edges) and gate end generate interrupts.
+     * Low frequencies are measured by reciprocal method: counter timer runs on internal clock,
+     * first and last captures of channel 1 (with capture prescaler) during the gate give
+     * time of integral number of periods, so resolution does not depend on input frequency.
+     *
+     * In auto range mode counter switches to reciprocal method if gated count is less than 1000
+     * and back to gated if expected count is greater than 2000. ETR prescaler is increased
+     * if prescaled input frequency is close to max ETR frequency (1/4 timer clock) and decreased
+     * with hysteresis. Measurements are continuous, result is delivered after each gate.
+     *
+     * Input pin should be shared channel 1 and ETR pin of counter timer (for example, PA0 for TIM2).
+     *
+     * @tparam _CounterTimer Counter timer (general purpose timer with ETR)
+     * @tparam _GateTimer Gate timer
+     * @tparam _GateTrigger Counter timer internal trigger connected to gate timer TRGO (see RM, "TIMx internal trigger connection")
+     */
+    template<typename _CounterTimer, typename _GateTimer, typename _CounterTimer::SlaveMode::Trigger _GateTrigger>
+    class FrequencyCounter
+    {
+        using Capture = typename _CounterTimer::template InputCapture<0>;
+
+        /// Gate timer tick frequency (100 us tick)
+        static const uint32_t GateTickFreq = 10000;
+        /// Reciprocal method: max counter ticks per gate (some margin to 16-bit range for captures around gate edges)
+        static const uint32_t MaxGateSpan = 60000;
+        /// Reciprocal method: max captures per gate (capture interrupt is disabled after, so fast input cannot stall CPU)
+        static const uint32_t MaxCaptures = 1024;
+        /// Reciprocal method: max capture interrupts rate (Hz)
+        static const uint32_t MaxCaptureRate = 2000;
+        /// Auto range: gated count to switch to reciprocal method
+        static const uint32_t ReciprocalThreshold = 1000;
+        /// Auto range: expected gated count to switch to gated method
+        static const uint32_t GatedThreshold = 2000;
+    public:
+        /// Result callback (frequency in mHz, zero if input frequency is too low for gate time)
+        using Callback = std::add_pointer_t<void(uint64_t frequency)>;
+
+        /// Measurement range
+        enum class Range : uint8_t
+        {
+            Auto, ///< Select method by input frequency
+            Gated, ///< Count edges during gate (high frequencies)
+            Reciprocal ///< Measure periods time (low frequencies)
+        };
+
+        /// Max gate time (ms)
+        static const uint16_t MaxGateTime = 6553;
+
+        /**
+         * @brief Configures input pin
+         *
+         * @tparam _Pin Counter timer channel 1 and ETR pin
+         *
+         * @par Returns
+         *  Nothing
+         */
+        template<typename _Pin>
+        static void SelectPins();
+
+        /**
+         * @brief Starts continuous measurement
+         *
+         * @param [in] gateTime Gate time (ms, 1...MaxGateTime), measurement resolution is 1 / gateTime for gated method
+         * @param [in] callback Result callback (called from gate timer ISR after each gate)
+         * @param [in] range Measurement range
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Start(uint16_t gateTime, Callback callback, Range range = Range::Auto);
+
+        /**
+         * @brief Stops measurement
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Stop();
+
+        /**
+         * @brief Counter timer IRQ handler
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void CounterIrqHandler();
+
+        /**
+         * @brief Gate timer IRQ handler
+         *
+         * @details
+         * Counter timer IRQ should have the same or higher priority.
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void GateIrqHandler();
+
+    private:
+        static void ConfigureCounter();
+        static void OpenGate();
+        static uint64_t GatedResult();
+        static uint64_t ReciprocalResult();
+        static bool SelectRange(uint64_t frequency);
+
+        static Callback _callback;
+        static uint16_t _gateTicks;
+        static uint16_t _counterPrescaler;
+        static Range _range;
+        static bool _reciprocal;
+        static uint8_t _triggerPrescaler;
+        static uint8_t _capturePrescaler;
+
+        static volatile uint32_t _overflows;
+        static volatile uint32_t _captures;
+        static volatile uint16_t _firstCapture;
+        static volatile uint16_t _lastCapture;
+    };
+}
+
+#include "impl/frequency_counter.h"
+
+#endif //! ZHELE_FREQUENCY_COUNTER_COMMON_H
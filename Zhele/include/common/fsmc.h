@@ -0,0 +1,205 @@
+/**
+ * @file
+ * Implements FSMC NOR/SRAM banks configuration (external SRAM, PSRAM, 8080 LCD)
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_FSMC_COMMON_H
+#define ZHELE_FSMC_COMMON_H
+
+#if defined (FSMC_Bank1)
+
+#include <clock.h>
+#include <pinlist.h>
+
+#include <stdint.h>
+
+namespace Zhele
+{
+    class FsmcBase
+    {
+    public:
+        /**
+         * @brief Memory type
+         */
+        enum class MemoryType : uint32_t
+        {
+            Sram = 0, ///< SRAM (and 8080 LCD controllers)
+            Psram = FSMC_BCR1_MTYP_0, ///< PSRAM (CRAM)
+            Nor = FSMC_BCR1_MTYP_1, ///< NOR flash
+        };
+
+        /**
+         * @brief Data bus width
+         */
+        enum class BusWidth : uint32_t
+        {
+            Bus8 = 0, ///< 8-bit (D0...D7)
+            Bus16 = FSMC_BCR1_MWID_0, ///< 16-bit (D0...D15)
+        };
+
+        /**
+         * @brief Asynchronous access mode (timing diagram)
+         */
+        enum class AccessMode : uint32_t
+        {
+            ModeA = 0, ///< SRAM/PSRAM with NOE toggling
+            ModeB = FSMC_BTR1_ACCMOD_0, ///< NOR flash
+            ModeC = FSMC_BTR1_ACCMOD_1, ///< NOR flash with NOE toggling
+            ModeD = FSMC_BTR1_ACCMOD_0 | FSMC_BTR1_ACCMOD_1, ///< Address hold phase (multiplexed memories)
+        };
+
+        /**
+         * @brief Asynchronous timing (in HCLK cycles)
+         */
+        struct Timing
+        {
+            uint8_t AddressSetup; ///< Address setup (0...15)
+            uint8_t AddressHold; ///< Address hold (1...15, mode D only)
+            uint8_t DataSetup; ///< Data setup (1...255)
+            uint8_t BusTurnaround; ///< Bus turnaround between accesses (0...15)
+        };
+
+        /**
+         * @brief Calculates timing from memory datasheet values
+         *
+         * @param [in] hclk HCLK frequence
+         * @param [in] addressSetupNs Address setup time (ns)
+         * @param [in] dataSetupNs Data setup time (write pulse or read access time, ns)
+         * @param [in] busTurnaroundNs Bus turnaround time (ns)
+         *
+         * @returns Timing (values are rounded up and limited by register fields)
+         */
+        static constexpr Timing CalculateTiming(uint32_t hclk, uint32_t addressSetupNs, uint32_t dataSetupNs, uint32_t busTurnaroundNs = 0)
+        {
+            return Timing {
+                static_cast<uint8_t>(Limit(Cycles(hclk, addressSetupNs), 0, 15)),
+                1,
+                static_cast<uint8_t>(Limit(Cycles(hclk, dataSetupNs), 1, 255)),
+                static_cast<uint8_t>(Limit(Cycles(hclk, busTurnaroundNs), 0, 15))
+            };
+        }
+
+    protected:
+        static constexpr uint32_t Cycles(uint32_t hclk, uint32_t ns)
+        {
+            return static_cast<uint32_t>((static_cast<uint64_t>(hclk) * ns + 999999999) / 1000000000);
+        }
+
+        static constexpr uint32_t Limit(uint32_t value, uint32_t min, uint32_t max)
+        {
+            return value < min ? min : (value > max ? max : value);
+        }
+
+        static constexpr uint32_t TimingRegister(const Timing& timing, AccessMode mode)
+        {
+            return (static_cast<uint32_t>(timing.AddressSetup & 0x0f) << FSMC_BTR1_ADDSET_Pos)
+                | (static_cast<uint32_t>(timing.AddressHold & 0x0f) << FSMC_BTR1_ADDHLD_Pos)
+                | (static_cast<uint32_t>(timing.DataSetup) << FSMC_BTR1_DATAST_Pos)
+                | (static_cast<uint32_t>(timing.BusTurnaround & 0x0f) << FSMC_BTR1_BUSTURN_Pos)
+                | static_cast<uint32_t>(mode);
+        }
+    };
+
+    /**
+     * @brief FSMC NOR/SRAM sub-bank
+     *
+     * @details
+     * Memory is mapped to 0x60000000 + 0x04000000 * (sub-bank - 1), so after Init external RAM is
+     * accessed by ordinary loads and stores (and by DMA). Variables can be placed to external RAM
+     * by ZHELE_EXTRAM (see Zhele/linker/extram_fsmc.ld), such variables must not be accessed before Init.
+     *
+     * @tparam _SubBank Sub-bank (NE pin number, 1...4)
+     */
+    template<unsigned _SubBank>
+    class FsmcSramBank : public FsmcBase
+    {
+        static_assert(_SubBank >= 1 && _SubBank <= 4, "Sub-bank must be 1...4");
+    public:
+        /// Bank start address
+        static const uint32_t BaseAddress = 0x60000000 + 0x04000000 * (_SubBank - 1);
+
+        /**
+         * @brief Configures pins for FSMC
+         *
+         * @tparam _Pins All used FSMC pins (data, address, NOE, NWE, NEx, NBLx)
+         *
+         * @par Returns
+         *	Nothing
+         */
+        template<typename _Pins>
+        static void SelectPins();
+
+        /**
+         * @brief Enables sub-bank with the same read and write timing
+         *
+         * @param [in] type Memory type
+         * @param [in] width Data bus width
+         * @param [in] timing Timing
+         * @param [in] mode Access mode
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void Init(MemoryType type, BusWidth width, const Timing& timing, AccessMode mode = AccessMode::ModeA);
+
+        /**
+         * @brief Enables sub-bank with extended mode (separate write timing)
+         *
+         * @details
+         * Writes to SRAM and LCD controllers are usually much faster than reads,
+         * so with separate write timing framebuffer stores are not slowed down by read access time.
+         *
+         * @param [in] type Memory type
+         * @param [in] width Data bus width
+         * @param [in] readTiming Read timing
+         * @param [in] writeTiming Write timing
+         * @param [in] mode Access mode
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void Init(MemoryType type, BusWidth width, const Timing& readTiming, const Timing& writeTiming, AccessMode mode = AccessMode::ModeA);
+
+        /**
+         * @brief Disables sub-bank
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void Disable();
+
+        /**
+         * @brief Returns pointer to external memory
+         *
+         * @tparam T Data type
+         *
+         * @param [in] offset Offset from bank start (in bytes)
+         *
+         * @returns Pointer
+         */
+        template<typename T = uint16_t>
+        static T* Memory(uint32_t offset = 0)
+        {
+            return reinterpret_cast<T*>(BaseAddress + offset);
+        }
+
+    private:
+        static void Enable(uint32_t control, uint32_t timing, uint32_t writeTiming);
+    };
+
+    /// FSMC sub-banks
+    using FsmcBank1 = FsmcSramBank<1>;
+    using FsmcBank2 = FsmcSramBank<2>;
+    using FsmcBank3 = FsmcSramBank<3>;
+    using FsmcBank4 = FsmcSramBank<4>;
+}
+
+#include "impl/fsmc.h"
+
+#endif //! FSMC_Bank1
+
+#endif //! ZHELE_FSMC_COMMON_H
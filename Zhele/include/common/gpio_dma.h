@@ -0,0 +1,235 @@
+/**
+ * @file
+ * Implements timer-paced DMA transfers to/from GPIO port
+ *
+ * @author Alexey Zhelonkin
+ * @date 2023
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_GPIO_DMA_COMMON_H
+#define ZHELE_GPIO_DMA_COMMON_H
+
+#include "pinlist.h"
+#include "template_utils/data_transfer.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace Zhele::IO
+{
+    /**
+     * @brief Implements timer-paced stream of pinlist values
+     *
+     * @details
+     * Every timer update event DMA writes next word to port BSRR register, so pinlist
+     * outputs change at precise rate without CPU load. Words are prepared by Encode method:
+     * each word sets and clears all pinlist pins at once. All pins must belong to one port.
+     * DMA channel must be connected to timer update request and must have access to GPIO
+     * (DMA2 for stm32f4).
+     *
+     * @tparam _Pins Pinlist
+     * @tparam _Timer Timer (update event paces transfer)
+     * @tparam _DmaChannel DMA channel (stream) connected to timer update request
+     */
+    template<typename _Pins, typename _Timer, typename _DmaChannel>
+    class GpioStreamer
+    {
+        using PinsList = typename _Pins::PinsAsTypeList;
+    public:
+        using Port = typename GetType<0, PinsList>::type::Port;
+        using DataType = typename _Pins::DataType;
+
+        static_assert(Length<Private::PinsForPort<Port, PinsList>>::value == _Pins::Length, "All pins must belong to one port");
+
+        /**
+         * @brief Init pins and timer
+         *
+         * @param [in] rate Words rate (Hz)
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void Init(uint32_t rate);
+
+        /**
+         * @brief Set words rate
+         *
+         * @param [in] rate Words rate (Hz)
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void SetRate(uint32_t rate);
+
+        /**
+         * @brief Convert pinlist value to BSRR word
+         *
+         * @param [in] value Pinlist value
+         *
+         * @returns BSRR word
+         */
+        static uint32_t Encode(DataType value);
+
+        /**
+         * @brief Convert pinlist values to BSRR words
+         *
+         * @param [in] values Pinlist values
+         * @param [out] words BSRR words
+         * @param [in] count Values count
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void Encode(const DataType* values, uint32_t* words, size_t count);
+
+        /**
+         * @brief Start stream
+         *
+         * @param [in] words BSRR words (must remain valid until stream is completed)
+         * @param [in] count Words count
+         * @param [in] callback Stream complete callback
+         * @param [in] circular Repeat words until Stop
+         * @param [in] dmaChannel DMA channel selection (for DMA with streams)
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void Start(const uint32_t* words, uint16_t count, TransferCallback callback = nullptr, bool circular = false
+            ONLY_IF_STREAM_SUPPORTED(COMMA uint8_t dmaChannel = 0));
+
+        /**
+         * @brief Stop stream
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void Stop();
+
+        /**
+         * @brief Check that stream is in progress
+         *
+         * @retval true Stream is in progress
+         * @retval false Stream is completed (or stopped)
+         */
+        static bool Busy();
+    };
+
+    /**
+     * @brief Implements timer-paced sampling of port inputs
+     *
+     * @details
+     * Every timer update event DMA copies port IDR register to samples buffer (logic analyzer).
+     * Raw samples can be converted to pinlist values by Extract method after capture (or from
+     * continuous capture callback). All pins must belong to one port. DMA channel must be connected
+     * to timer update request and must have access to GPIO (DMA2 for stm32f4).
+     *
+     * @tparam _Pins Pinlist
+     * @tparam _Timer Timer (update event paces transfer)
+     * @tparam _DmaChannel DMA channel (stream) connected to timer update request
+     */
+    template<typename _Pins, typename _Timer, typename _DmaChannel>
+    class GpioSampler
+    {
+        using PinsList = typename _Pins::PinsAsTypeList;
+    public:
+        using Port = typename GetType<0, PinsList>::type::Port;
+        using DataType = typename _Pins::DataType;
+
+        static_assert(Length<Private::PinsForPort<Port, PinsList>>::value == _Pins::Length, "All pins must belong to one port");
+
+        /**
+         * @brief Init pins (as inputs) and timer
+         *
+         * @param [in] rate Sample rate (Hz)
+         * @param [in] pull Pins pull mode
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void Init(uint32_t rate, typename _Pins::PullMode pull = _Pins::PullMode::NoPull);
+
+        /**
+         * @brief Set sample rate
+         *
+         * @param [in] rate Sample rate (Hz)
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void SetRate(uint32_t rate);
+
+        /**
+         * @brief Start capture
+         *
+         * @param [out] samples Samples buffer (raw IDR values)
+         * @param [in] count Samples count
+         * @param [in] callback Capture complete callback
+         * @param [in] dmaChannel DMA channel selection (for DMA with streams)
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void Start(uint16_t* samples, uint16_t count, TransferCallback callback = nullptr
+            ONLY_IF_STREAM_SUPPORTED(COMMA uint8_t dmaChannel = 0));
+
+        /**
+         * @brief Start continuous capture
+         *
+         * @details
+         * Buffer is divided into two halves, callback is called with filled half
+         * while DMA fills the other one (see DmaChannel::PingPongTransfer).
+         *
+         * @param [out] samples Samples buffer (two halves)
+         * @param [in] halfSize Size of one half (samples count)
+         * @param [in] callback Half filled callback
+         * @param [in] dmaChannel DMA channel selection (for DMA with streams)
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void StartContinuous(uint16_t* samples, uint16_t halfSize, TransferCallback callback
+            ONLY_IF_STREAM_SUPPORTED(COMMA uint8_t dmaChannel = 0));
+
+        /**
+         * @brief Stop capture
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void Stop();
+
+        /**
+         * @brief Check that capture is in progress
+         *
+         * @retval true Capture is in progress
+         * @retval false Capture is completed (or stopped)
+         */
+        static bool Busy();
+
+        /**
+         * @brief Convert raw sample to pinlist value
+         *
+         * @param [in] sample Raw sample (IDR value)
+         *
+         * @returns Pinlist value
+         */
+        static DataType Extract(uint16_t sample);
+
+        /**
+         * @brief Convert raw samples to pinlist values
+         *
+         * @param [in] samples Raw samples
+         * @param [out] values Pinlist values
+         * @param [in] count Samples count
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void Extract(const uint16_t* samples, DataType* values, size_t count);
+    };
+}
+
+#include "impl/gpio_dma.h"
+
+#endif //! ZHELE_GPIO_DMA_COMMON_H
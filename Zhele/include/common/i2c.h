@@ -11,7 +11,11 @@
 #define ZHELE_I2C_COMMON_H
 
 #include "macro_utils/enum.h"
+#include "nvic.h"
+#include "template_utils/inplace_function.h"
 #include "template_utils/type_list.h"
+#include "statistics.h"
+#include "trace.h"
 
 #include <clock.h>
 #include <iopins.h>
@@ -138,10 +142,66 @@ namespace Zhele
         I2cStatus Status;        
     };
 
-    using I2cCallback = std::add_pointer_t<void(I2cStatus status)>;
+    using I2cCallback = TemplateUtils::InplaceFunction<void(I2cStatus status)>;
+    /// Slave write complete callback (first written register and written bytes count)
+    using I2cSlaveCallback = TemplateUtils::InplaceFunction<void(uint16_t regAddr, uint16_t size)>;
+
+#if defined (I2C_TYPE_1)
+    /**
+     * @brief Calculates TIMINGR register value
+     * 
+     * @details
+     * Solves SCL low/high periods, data setup and hold times for standard (up to 100 kHz),
+     * fast (up to 400 kHz) and fast plus (up to 1 MHz) modes. Analog filter is assumed to be enabled,
+     * digital filter is assumed to be disabled. The smallest suitable prescaler is selected.
+     * Result bus speed is not greater than requested one.
+     * 
+     * @param [in] sourceClock I2C kernel clock frequency (Hz)
+     * @param [in] sclClock Required SCL frequency (Hz)
+     * @param [in] riseTime SCL/SDA rise time (ns), 0 - max value for selected mode
+     * @param [in] fallTime SCL/SDA fall time (ns), 0 - max value for selected mode
+     * 
+     * @returns TIMINGR value or 0 if timing cannot be satisfied
+     */
+    constexpr uint32_t I2cCalculateTiming(uint32_t sourceClock, uint32_t sclClock, uint32_t riseTime = 0, uint32_t fallTime = 0);
+
+    /**
+     * @brief Compile-time I2C timing
+     * 
+     * @tparam _SourceClock I2C kernel clock frequency (Hz)
+     * @tparam _SclClock Required SCL frequency (Hz)
+     * @tparam _RiseTime SCL/SDA rise time (ns), 0 - max value for selected mode
+     * @tparam _FallTime SCL/SDA fall time (ns), 0 - max value for selected mode
+     */
+    template<uint32_t _SourceClock, uint32_t _SclClock, uint32_t _RiseTime = 0, uint32_t _FallTime = 0>
+    struct I2cTiming
+    {
+        static constexpr uint32_t Value = I2cCalculateTiming(_SourceClock, _SclClock, _RiseTime, _FallTime);
+        static constexpr bool FastModePlus = _SclClock > 400000;
+
+        static_assert(Value != 0, "I2C timing cannot be satisfied with given kernel clock");
+    };
+#endif
 
     namespace Private
     {
+    #if defined (I2C_TYPE_1)
+        /**
+         * @brief Fast mode plus drive control
+         * 
+         * @details
+         * Mask is SYSCFG_CFGR1 Fm+ drive bit for I2C instance (0 - instance has not Fm+ drive control).
+         * Family headers specialize it for I2C instances with Fm+ drive control bit.
+         * 
+         * @tparam _Regs I2C registers
+         */
+        template<typename _Regs>
+        struct I2cFastModePlusDrive
+        {
+            static const uint32_t Mask = 0;
+        };
+    #endif
+
         /**
          * @brief Implements I2C protocol.
          * 
@@ -170,20 +230,56 @@ namespace Zhele
             struct AsyncTransferData
             {
             #if defined (I2C_TYPE_1)
+                uint8_t* Buffer;
+                volatile uint16_t Size; ///< Bytes count after current chunk
+                volatile I2cStatus Status;
+            #endif
+            #if defined (I2C_TYPE_2)
                 uint8_t* Buffer;
                 uint16_t Size;
+                uint16_t DevAddr;
+                uint16_t RegAddr;
+                I2cOpts Opts;
+                I2cMode Mode;
+                volatile I2cState State;
             #endif
                 I2cCallback Callback;
             };
 
             static AsyncTransferData _transferData;
+
+            struct SlaveData
+            {
+                uint8_t* Registers;
+                uint16_t Size;
+                volatile uint16_t Pointer; ///< Register pointer
+                volatile uint16_t Start; ///< Current data phase first register
+                volatile uint16_t Length; ///< Current data phase DMA transfer length
+                volatile uint16_t NewPointer; ///< Received register address
+                uint8_t RegAddrBytes;
+                volatile uint8_t RegAddrReceived;
+                volatile I2cMode Mode;
+                volatile bool Enabled;
+                I2cSlaveCallback Callback;
+            };
+
+            static SlaveData _slave;
         public:
             using SclPins = _SclPins;
             using SdaPins = _SdaPins;
+        #if defined (ZHELE_STATISTICS)
+            /// Runtime statistics (errors counters)
+            static I2cStatistics Statistics;
+        #endif
             
             /**
              * @brief Initialize I2C
              * 
+             * @details
+             * MCUs with TIMINGR register support speeds up to 1 MHz (fast mode plus, timing is calculated
+             * from I2C kernel clock, Fm+ drive of I2C pins is enabled for speeds higher than 400 kHz).
+             * Other MCUs support speeds up to 400 kHz (higher speed is limited to 400 kHz).
+             * 
              * @param [in] i2cClockSpeed I2C speed
              * @param [in] dutyCycle2 Enable duty cycle 16/9 (not for all MCU)
              * 
@@ -192,6 +288,21 @@ namespace Zhele
              */
         #if defined (I2C_TYPE_1)
             static void Init(uint32_t i2cClockSpeed = 100000U);
+
+            /**
+             * @brief Initialize I2C with precalculated timing
+             * 
+             * @details
+             * Usage: I2c1::Init<I2cTiming<48000000, 1000000>>();
+             * Fm+ drive of I2C pins is enabled for speeds higher than 400 kHz.
+             * 
+             * @tparam _Timing Timing (I2cTiming instance)
+             * 
+             * @par Returns
+             * 	Nothing
+             */
+            template<typename _Timing>
+            static void Init();
         #endif
         #if defined (I2C_TYPE_2)
             static void Init(uint32_t i2cClockSpeed = 100000U, bool dutyCycle2 = false);
@@ -225,6 +336,16 @@ namespace Zhele
             /**
              * @brief Write data to register async.
              * 
+             * @details
+             * On stm32f1/stm32f4 whole transaction (start, address, register address, data, stop)
+             * is performed in EventIrqHandler/ErrorIrqHandler and DMA interrupts,
+             * so I2C event and error IRQ handlers should call EventIrqHandler and ErrorIrqHandler.
+             * On MCUs with TIMINGR register address phase is synchronous, then whole data is transferred
+             * by one DMA transfer (up to 65535 bytes), NBYTES is reloaded by 255-bytes chunks and transfer
+             * is completed in EventIrqHandler, so event and error IRQ handlers should call them too
+             * (I2C IRQ handler should call EventIrqHandler on MCUs with one I2C interrupt).
+             * Data buffer should be valid until callback is called.
+             * 
              * @param [in] devAddr Device address.
              * @param [in] regAddr Register address.
              * @param [in] data Data to write.
@@ -263,6 +384,10 @@ namespace Zhele
             /**
              * @brief Read some bytes async.
              * 
+             * @details
+             * On stm32f1/stm32f4 whole transaction (start, address, register address, repeated start, data, stop)
+             * is performed in EventIrqHandler/ErrorIrqHandler and DMA interrupts (see WriteAsync).
+             * 
              * @param [in] devAddr Device address.
              * @param [in] regAddr Register address.
              * @param [out] data Output buffer.
@@ -274,6 +399,48 @@ namespace Zhele
              */
             static I2cStatus EnableAsyncRead(uint16_t devAddr, uint16_t regAddr, uint8_t *data, uint16_t size, I2cOpts opts = I2cOpts::None, I2cCallback callback = nullptr);
 
+            /**
+             * @brief Enable slave mode with register map emulation.
+             * 
+             * @details
+             * Call Init first (it configures clock, I2C timing and is required for hold time on MCUs with TIMINGR).
+             * Slave works like typical I2C device with registers: master write starts with register address
+             * (low byte first for 16-bit address, as master methods of this class send it), next bytes are written
+             * to registers starting from that address. Master read returns registers starting from register pointer,
+             * which is auto-incremented by every transferred byte (write-then-restart-read is supported).
+             * Address phase and register address are processed in event IRQ, data are transferred by DMA
+             * directly from/to registers buffer, so there is no clock stretching on data bytes.
+             * Bytes written out of map are discarded, 0xff is returned for reads out of map.
+             * Master methods should not be used while slave mode is enabled.
+             * I2C event and error IRQ handlers should call EventIrqHandler and ErrorIrqHandler.
+             * 
+             * @param [in] ownAddr Own (slave) address.
+             * @param [in] registers Registers buffer (should be valid while slave is enabled).
+             * @param [in] size Registers buffer size.
+             * @param [in] opts Options (10-bit own address, 8/16-bit register address or no register address,
+             * in last case every transaction starts from first register).
+             * @param [in] callback Master write complete callback (called from IRQ on stop or restart).
+             * 
+             * @par Returns
+             * 	Nothing
+             */
+            static void EnableSlave(uint16_t ownAddr, uint8_t* registers, uint16_t size, I2cOpts opts = I2cOpts::None, I2cSlaveCallback callback = nullptr);
+
+            /**
+             * @brief Disable slave mode.
+             * 
+             * @par Returns
+             * 	Nothing
+             */
+            static void DisableSlave();
+
+            /**
+             * @brief Returns slave register pointer.
+             * 
+             * @returns Register pointer.
+             */
+            static uint16_t SlaveRegisterPointer();
+
             /**
              * @brief Write register address.
              * 
@@ -402,6 +569,47 @@ namespace Zhele
              * @param [in] isLast Is this transfer last
              */
             static void SetTransferSize(uint8_t size, bool isLast = true);
+
+            /**
+             * @brief Initialize I2C with given TIMINGR value
+             * 
+             * @param [in] timing TIMINGR value
+             * @param [in] fastModePlus Enable Fm+ drive of I2C pins
+             * 
+             * @par Returns
+             * 	Nothing
+             */
+            static void InitTiming(uint32_t timing, bool fastModePlus);
+
+            /**
+             * @brief Start async data phase (enable interrupts)
+             * 
+             * @param [in] size Data size
+             * 
+             * @par Returns
+             * 	Nothing
+             */
+            static void StartAsync(uint16_t size);
+
+            /**
+             * @brief Abort async transfer (stop DMA, generate stop condition)
+             * 
+             * @param [in] status Transfer status
+             * 
+             * @par Returns
+             * 	Nothing
+             */
+            static void AbortAsync(I2cStatus status);
+
+            /**
+             * @brief Complete async transfer (disable interrupts and call callback)
+             * 
+             * @param [in] status Transfer status
+             * 
+             * @par Returns
+             * 	Nothing
+             */
+            static void CompleteAsync(I2cStatus status);
             #endif
 
             #if defined (I2C_TYPE_2)
@@ -424,8 +632,113 @@ namespace Zhele
              * @retval false Fail.
              */
             static bool Start();
+
+            /**
+             * @brief Start interrupt-driven transaction.
+             * 
+             * @param [in] devAddr Device address.
+             * @param [in] regAddr Register address.
+             * @param [in] data Data buffer.
+             * @param [in] size Data size.
+             * @param [in] opts Options.
+             * @param [in] mode Read or write.
+             * @param [in] callback Complete (or error) callback.
+             * 
+             * @returns Status (Busy if another transaction is in progress).
+             */
+            static I2cStatus StartAsync(uint16_t devAddr, uint16_t regAddr, uint8_t* data, uint16_t size, I2cOpts opts, I2cMode mode, I2cCallback callback);
+
+            /**
+             * @brief Continue transaction after register address (or device address if there is no register).
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void OnRegAddrSent();
+
+            /**
+             * @brief Finish interrupt-driven transaction.
+             * 
+             * @param [in] status Transaction status.
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void CompleteAsync(I2cStatus status);
             #endif
 
+            /**
+             * @brief Slave event (and error on MCUs with TIMINGR) handler.
+             * 
+             * @param [in] status Status register (ISR or SR1) value.
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void SlaveIrqHandler(uint32_t status);
+
+            /**
+             * @brief Switch slave data phase between DMA and interrupts (for dummy bytes out of map).
+             * 
+             * @param [in] dma Use DMA.
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void SlaveSetDataMode(bool dma);
+
+            /**
+             * @brief Disable slave data DMA requests and interrupts.
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void SlaveDisableData();
+
+            /**
+             * @brief Returns slave transmitted data byte is in data register yet.
+             * 
+             * @retval true Last byte loaded by DMA is not sent.
+             * @retval false Data register is empty.
+             */
+            static bool SlaveTxPending();
+
+            /**
+             * @brief Process slave address match.
+             * 
+             * @param [in] read Master reads data.
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void SlaveAddressMatched(bool read);
+
+            /**
+             * @brief Process received byte in interrupt mode (register address or dummy byte).
+             * 
+             * @param [in] data Received byte.
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void SlaveReceived(uint8_t data);
+
+            /**
+             * @brief Start slave data phase from register pointer.
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void SlaveStartData();
+
+            /**
+             * @brief Finish slave data phase (on stop, restart or error).
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void SlaveFinish();
+
             /**
              * @brief Returns last event (SR register value)
              * 
@@ -0,0 +1,188 @@
+/**
+ * @file
+ * Implements queued I2C transactions scheduler
+ *
+ * @author Alexey Zhelonkin
+ * @date 2023
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_I2C_QUEUE_COMMON_H
+#define ZHELE_I2C_QUEUE_COMMON_H
+
+#include "i2c.h"
+#include "../containers/ring_buffer.h"
+
+namespace Zhele
+{
+    /**
+     * @brief I2C transaction priority
+     */
+    enum class I2cPriority : uint8_t
+    {
+        Low = 0, ///< Low priority (background polling)
+        Normal = 1, ///< Normal priority
+        High = 2, ///< High priority (executed before all other pending transactions)
+    };
+
+    /**
+     * @brief I2C transaction descriptor
+     */
+    struct I2cTransaction
+    {
+        uint16_t DevAddr; ///< Device address
+        uint16_t RegAddr; ///< Register address
+        uint8_t* Buffer; ///< Data buffer (should be valid until callback is called)
+        uint16_t Size; ///< Data size
+        I2cMode Mode; ///< Read or write
+        I2cOpts Opts; ///< Options
+        I2cCallback Callback; ///< Complete (or error) callback
+    };
+
+    /**
+     * @brief Implements I2C transactions queue
+     *
+     * @details
+     * Transactions are executed back-to-back by I2C async methods: next transaction
+     * is started from previous transaction complete callback (interrupt), so several drivers
+     * can share one bus without waiting for each other.
+     * Transactions with higher priority are executed first, transactions with the same
+     * priority are executed in FIFO order.
+     * If _MergeBufferSize is not zero, consecutive reads of adjacent registers of the same device
+     * (next register address equals to previous register address + size) are merged
+     * into one bus transaction (device should support register address auto-increment).
+     * Each merged transaction gets its own callback.
+     *
+     * All bus operations should be performed via queue (blocking I2C methods can't be mixed with it).
+     *
+     * @tparam _I2c I2C instance
+     * @tparam _QueueSize Max pending transactions count (for each priority)
+     * @tparam _MergeBufferSize Buffer size for merged reads (0 - disable merging)
+     */
+    template<typename _I2c, unsigned _QueueSize = 8, unsigned _MergeBufferSize = 0>
+    class I2cTransactionQueue
+    {
+        static const unsigned PrioritiesCount = 3;
+        static const unsigned MaxMergedReads = 4;
+
+        using Queue = Containers::RingBuffer<_QueueSize, I2cTransaction>;
+    public:
+        /**
+         * @brief Add transaction to queue
+         *
+         * @details
+         * If bus is idle, transaction is started immediately.
+         *
+         * @param [in] transaction Transaction descriptor
+         * @param [in] priority Transaction priority
+         *
+         * @retval true Transaction has been queued
+         * @retval false Queue is full
+         */
+        static bool Enqueue(const I2cTransaction& transaction, I2cPriority priority = I2cPriority::Normal);
+
+        /**
+         * @brief Queue read transaction
+         *
+         * @param [in] devAddr Device address
+         * @param [in] regAddr Register address
+         * @param [out] data Output buffer
+         * @param [in] size Data size
+         * @param [in] callback Complete (or error) callback
+         * @param [in] priority Transaction priority
+         * @param [in] opts Options
+         *
+         * @retval true Transaction has been queued
+         * @retval false Queue is full
+         */
+        static bool Read(uint16_t devAddr, uint16_t regAddr, uint8_t* data, uint16_t size, I2cCallback callback = nullptr,
+            I2cPriority priority = I2cPriority::Normal, I2cOpts opts = I2cOpts::None);
+
+        /**
+         * @brief Queue write transaction
+         *
+         * @param [in] devAddr Device address
+         * @param [in] regAddr Register address
+         * @param [in] data Data to write
+         * @param [in] size Data size
+         * @param [in] callback Complete (or error) callback
+         * @param [in] priority Transaction priority
+         * @param [in] opts Options
+         *
+         * @retval true Transaction has been queued
+         * @retval false Queue is full
+         */
+        static bool Write(uint16_t devAddr, uint16_t regAddr, const uint8_t* data, uint16_t size, I2cCallback callback = nullptr,
+            I2cPriority priority = I2cPriority::Normal, I2cOpts opts = I2cOpts::None);
+
+        /**
+         * @brief Returns pending transactions count (without active one)
+         *
+         * @returns Pending transactions count
+         */
+        static unsigned Pending();
+
+        /**
+         * @brief Returns busy state
+         *
+         * @retval true Transaction is in progress
+         * @retval false Bus is idle and queue is empty
+         */
+        static bool Busy();
+
+    private:
+        /**
+         * @brief Start next transaction (if bus is idle)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void StartNext();
+
+        /**
+         * @brief Active transaction complete handler
+         *
+         * @param [in] status Transaction status
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void OnComplete(I2cStatus status);
+
+        /**
+         * @brief Check that transaction can be merged with last active one
+         *
+         * @param [in] transaction Transaction
+         * @param [in] mergedSize Current merged reads size
+         *
+         * @retval true Transaction can be merged
+         * @retval false Transaction can not be merged
+         */
+        static bool CanMerge(const I2cTransaction& transaction, unsigned mergedSize);
+
+        static Queue _queues[PrioritiesCount];
+        static I2cTransaction _active[MaxMergedReads];
+        static uint8_t _activeCount;
+        static uint8_t _mergeBuffer[_MergeBufferSize > 0 ? _MergeBufferSize : 1];
+        static volatile bool _busy;
+    };
+
+    template<typename _I2c, unsigned _QueueSize, unsigned _MergeBufferSize>
+    typename I2cTransactionQueue<_I2c, _QueueSize, _MergeBufferSize>::Queue I2cTransactionQueue<_I2c, _QueueSize, _MergeBufferSize>::_queues[PrioritiesCount];
+
+    template<typename _I2c, unsigned _QueueSize, unsigned _MergeBufferSize>
+    I2cTransaction I2cTransactionQueue<_I2c, _QueueSize, _MergeBufferSize>::_active[MaxMergedReads];
+
+    template<typename _I2c, unsigned _QueueSize, unsigned _MergeBufferSize>
+    uint8_t I2cTransactionQueue<_I2c, _QueueSize, _MergeBufferSize>::_activeCount = 0;
+
+    template<typename _I2c, unsigned _QueueSize, unsigned _MergeBufferSize>
+    uint8_t I2cTransactionQueue<_I2c, _QueueSize, _MergeBufferSize>::_mergeBuffer[_MergeBufferSize > 0 ? _MergeBufferSize : 1];
+
+    template<typename _I2c, unsigned _QueueSize, unsigned _MergeBufferSize>
+    volatile bool I2cTransactionQueue<_I2c, _QueueSize, _MergeBufferSize>::_busy = false;
+}
+
+#include "impl/i2c_queue.h"
+
+#endif //! ZHELE_I2C_QUEUE_COMMON_H
@@ -0,0 +1,238 @@
+/**
+ * @file
+ * Implements I2S (SPI peripheral in I2S mode)
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_I2S_COMMON_H
+#define ZHELE_I2S_COMMON_H
+
+#include "ioreg.h"
+#include "template_utils/data_transfer.h"
+
+#include <clock.h>
+#include <iopins.h>
+#include <pinlist.h>
+
+namespace Zhele
+{
+    class I2sBase
+    {
+    public:
+        /**
+         * @brief I2S mode
+         */
+        enum class Mode : uint16_t
+        {
+            MasterTx = SPI_I2SCFGR_I2SCFG_1, ///< Master transmitter
+            MasterRx = SPI_I2SCFGR_I2SCFG_1 | SPI_I2SCFGR_I2SCFG_0, ///< Master receiver (MEMS microphones, codecs ADC)
+        };
+
+        /**
+         * @brief I2S standard
+         */
+        enum class Standard : uint16_t
+        {
+            Philips = 0, ///< I2S Philips standard
+            MsbJustified = SPI_I2SCFGR_I2SSTD_0, ///< MSB justified (left justified)
+            LsbJustified = SPI_I2SCFGR_I2SSTD_1, ///< LSB justified (right justified)
+            PcmShort = SPI_I2SCFGR_I2SSTD_0 | SPI_I2SCFGR_I2SSTD_1, ///< PCM with short frame synchronization
+            PcmLong = SPI_I2SCFGR_I2SSTD_0 | SPI_I2SCFGR_I2SSTD_1 | SPI_I2SCFGR_PCMSYNC, ///< PCM with long frame synchronization
+        };
+
+        /**
+         * @brief Data and channel length
+         */
+        enum class DataFormat : uint16_t
+        {
+            Data16Bit = 0, ///< 16-bit data, 16-bit channel
+            Data16BitExtended = SPI_I2SCFGR_CHLEN, ///< 16-bit data, 32-bit channel
+            Data24Bit = SPI_I2SCFGR_DATLEN_0 | SPI_I2SCFGR_CHLEN, ///< 24-bit data, 32-bit channel
+            Data32Bit = SPI_I2SCFGR_DATLEN_1 | SPI_I2SCFGR_CHLEN, ///< 32-bit data, 32-bit channel
+        };
+
+        /**
+         * @brief I2S clock configuration
+         */
+        struct ClockConfig
+        {
+            uint16_t PllN; ///< PLLI2S multiplier
+            uint8_t PllR; ///< PLLI2S output divider
+            uint16_t Prescaler; ///< I2SPR value (I2SDIV, ODD and MCKOE), 0 if sample rate cannot be reached
+            uint32_t SampleRate; ///< Actual sample rate
+        };
+
+        /**
+         * @brief Calculates I2S prescaler
+         *
+         * @param [in] i2sClock I2S clock frequence
+         * @param [in] sampleRate Sample rate
+         * @param [in] format Data format
+         * @param [in] masterClock Master clock (256 * Fs) output is enabled
+         *
+         * @returns I2SPR value (0 if prescaler is out of range)
+         */
+        static constexpr uint16_t CalculatePrescaler(uint32_t i2sClock, uint32_t sampleRate, DataFormat format, bool masterClock);
+
+        /**
+         * @brief Calculates PLLI2S multiplier, output divider and I2S prescaler nearest to sample rate
+         *
+         * @param [in] pllInput PLLI2S input frequence (PLL source divided by PLLM, 1...2 MHz)
+         * @param [in] sampleRate Sample rate
+         * @param [in] format Data format
+         * @param [in] masterClock Master clock (256 * Fs) output is enabled
+         *
+         * @returns Clock configuration
+         */
+        static constexpr ClockConfig CalculateClock(uint32_t pllInput, uint32_t sampleRate, DataFormat format, bool masterClock);
+
+    protected:
+        /**
+         * @brief Returns data bits divider of I2S clock (bits clocked per sample)
+         *
+         * @param [in] format Data format
+         * @param [in] masterClock Master clock output is enabled
+         *
+         * @returns Divider
+         */
+        static constexpr uint32_t FrameDivider(DataFormat format, bool masterClock);
+    };
+
+    namespace Private
+    {
+        /**
+         * @brief I2S
+         *
+         * @details
+         * Samples are streamed by DMA in ping-pong mode: callback gets half of buffer, which is
+         * not accessed by DMA now, so there is no per-sample CPU work. DR is 16-bit, so buffers consist of
+         * half-words: one per 16-bit sample and two (most significant first) per 24/32-bit sample.
+         * Channels are interleaved (left, right).
+         *
+         * @tparam _Regs SPI registers
+         * @tparam _ClockCtrl SPI clock control
+         * @tparam _I2sClock I2S clock source (PLLI2S)
+         * @tparam _SdPins Serial data pins
+         * @tparam _CkPins Serial clock pins
+         * @tparam _WsPins Word select pins
+         * @tparam _MckPins Master clock pins
+         * @tparam _DmaTx DMA for transmit
+         * @tparam _DmaRx DMA for receive
+         */
+        template<typename _Regs, typename _ClockCtrl, typename _I2sClock, typename _SdPins, typename _CkPins, typename _WsPins, typename _MckPins, typename _DmaTx, typename _DmaRx>
+        class I2s : public I2sBase
+        {
+        public:
+            /**
+             * @brief Configures I2S clock (PLLI2S) and I2S
+             *
+             * @details
+             * PLLI2S is restarted with multiplier and divider nearest to sample rate,
+             * so all I2S instances share one sample rate.
+             *
+             * @param [in] sampleRate Sample rate
+             * @param [in] mode Mode
+             * @param [in] standard Standard
+             * @param [in] format Data format
+             * @param [in] masterClock Enable master clock output (256 * Fs)
+             *
+             * @retval true Success
+             * @retval false Sample rate cannot be reached or PLLI2S does not lock
+             */
+            static bool Init(uint32_t sampleRate, Mode mode, Standard standard = Standard::Philips, DataFormat format = DataFormat::Data16Bit, bool masterClock = false);
+
+            /**
+             * @brief Returns actual sample rate
+             *
+             * @returns Sample rate
+             */
+            static uint32_t SampleRate();
+
+            /**
+             * @brief Starts continuous transmit from ping-pong buffer
+             *
+             * @param [in] buffer Buffer (two halves)
+             * @param [in] halfSize Size of half of buffer (in half-words)
+             * @param [in] callback Callback, it gets half to fill with next samples
+             *
+             * @par Returns
+             *	Nothing
+             */
+            static void StartWriteStream(const uint16_t* buffer, uint16_t halfSize, TransferCallback callback);
+
+            /**
+             * @brief Starts continuous receive into ping-pong buffer
+             *
+             * @param [in] buffer Buffer (two halves)
+             * @param [in] halfSize Size of half of buffer (in half-words)
+             * @param [in] callback Callback, it gets half with received samples
+             *
+             * @par Returns
+             *	Nothing
+             */
+            static void StartReadStream(uint16_t* buffer, uint16_t halfSize, TransferCallback callback);
+
+            /**
+             * @brief Stops stream and disables I2S
+             *
+             * @par Returns
+             *	Nothing
+             */
+            static void StopStream();
+
+            /**
+             * @brief Select pins
+             *
+             * @param [in] sdPinNumber SD pin number
+             * @param [in] ckPinNumber CK pin number
+             * @param [in] wsPinNumber WS pin number
+             * @param [in] mckPinNumber MCK pin number (-1 if MCK is not used)
+             *
+             * @par Returns
+             *	Nothing
+             */
+            static void SelectPins(int8_t sdPinNumber, int8_t ckPinNumber, int8_t wsPinNumber, int8_t mckPinNumber = -1);
+
+            /**
+             * @brief Select pins (template clone)
+             *
+             * @tparam sdPinNumber SD pin number
+             * @tparam ckPinNumber CK pin number
+             * @tparam wsPinNumber WS pin number
+             * @tparam mckPinNumber MCK pin number (-1 if MCK is not used)
+             *
+             * @par Returns
+             *	Nothing
+             */
+            template<int8_t sdPinNumber, int8_t ckPinNumber, int8_t wsPinNumber, int8_t mckPinNumber = -1>
+            static void SelectPins();
+
+            /**
+             * @brief Select pins (template clone, params are TPin instances)
+             *
+             * @tparam SdPin SD pin
+             * @tparam CkPin CK pin
+             * @tparam WsPin WS pin
+             * @tparam MckPin MCK pin (IO::NullPin if MCK is not used)
+             *
+             * @par Returns
+             *	Nothing
+             */
+            template<typename SdPin, typename CkPin, typename WsPin, typename MckPin = IO::NullPin>
+            static void SelectPins();
+
+        private:
+            static uint32_t _sampleRate;
+        };
+
+        template<typename _Regs, typename _ClockCtrl, typename _I2sClock, typename _SdPins, typename _CkPins, typename _WsPins, typename _MckPins, typename _DmaTx, typename _DmaRx>
+        uint32_t I2s<_Regs, _ClockCtrl, _I2sClock, _SdPins, _CkPins, _WsPins, _MckPins, _DmaTx, _DmaRx>::_sampleRate = 0;
+    }
+}
+
+#include "impl/i2s.h"
+
+#endif //! ZHELE_I2S_COMMON_H
@@ -169,8 +169,8 @@ namespace Zhele::Private
         {
         }
 
-        _adcData.vRef = 0;
-        NVIC_EnableIRQ(ADC1_IRQn);
+        _adcData.voltsScale = 0;
+        Nvic::EnableIrq<ADC1_IRQn>();
     }
 
     ADC_TEMPLATE_ARGS
@@ -192,13 +192,15 @@ namespace Zhele::Private
     template <typename InjectedTrigger, typename TriggerMode>
     void ADC_TEMPLATE_QUALIFIER::SetInjectedTrigger(InjectedTrigger trigger, TriggerMode mode)
     {
-        _Regs()->CR2 = (_Regs()->CR2 & ~(ADC_CR2_JEXTSEL | ADC_CR2_JEXTTRIG)) | ((trigger & 0x07) << ADC_CR2_JEXTSEL_Pos) | (mode << ADC_CR2_JEXTTRIG_Pos);
+        _Regs()->CR2 = (_Regs()->CR2 & ~(ADC_CR2_JEXTSEL | ADC_CR2_JEXTTRIG))
+            | ((static_cast<uint32_t>(trigger) << ADC_CR2_JEXTSEL_Pos) & ADC_CR2_JEXTSEL)
+            | (static_cast<uint32_t>(mode) << ADC_CR2_JEXTTRIG_Pos);
     }
 
     template <typename Pins, typename _Regs>
     static void EnableChannel(uint8_t channel)
     {
-        if (channel == AdcCommon::TempSensorChannel)
+        if (channel == AdcCommon::TempSensorChannel || channel == AdcCommon::ReferenceChannel)
         {
             _Regs()->CR2 |= ADC_CR2_TSVREFE;
         }
@@ -210,14 +212,11 @@ namespace Zhele::Private
 
     static unsigned GetJsqr(const uint8_t *channels, uint8_t count, uint32_t jsqr)
     {
-        jsqr = ((count - 1) << 20) | (channels[0] << 0);
-
-        if (count > 1)
-            jsqr |= (channels[1] << 5);
-        if (count > 2)
-            jsqr |= (channels[2] << 10);
-        if (count > 3)
-            jsqr |= (channels[3] << 15);
+        // Sequence shorter than 4 conversions starts from JSQ(4 - JL) and ends by JSQ4,
+        // results are placed to JDR1...JDRn in conversion order
+        jsqr = (count - 1) << 20;
+        for (unsigned i = 0; i < count; ++i)
+            jsqr |= channels[i] << (5 * (4 - count + i));
         return jsqr;
     }
 
@@ -344,6 +343,12 @@ namespace Zhele::Private
                     _adcData.injectedCallback(data, count);
             }
         }
+        if ((sr & ADC_SR_AWD) && (_Regs()->CR1 & ADC_CR1_AWDIE))
+        {
+            _Regs()->SR &= ~ADC_SR_AWD;
+            if (_adcData.watchdogCallback)
+                _adcData.watchdogCallback();
+        }
         // reset all flags
         _Regs()->SR &= ~(ADC_SR_JEOC | ADC_SR_JSTRT);
         NVIC_ClearPendingIRQ(ADC1_IRQn);
@@ -366,7 +371,8 @@ namespace Zhele::Private
 
         _Regs()->CR1 |= ADC_CR1_DISCEN;
         _Regs()->SR = ~(ADC_SR_JEOC);
-        _Regs()->JSQR = (unsigned)channel;
+        // Single conversion is JSQ4
+        _Regs()->JSQR = (unsigned)channel << 15;
 
         EnableChannel<Pins, _Regs>(channel);
 
@@ -412,11 +418,57 @@ namespace Zhele::Private
         _Regs()->JSQR = 0;
     }
 
+    ADC_TEMPLATE_ARGS
+    template<typename InjectedTrigger>
+    bool ADC_TEMPLATE_QUALIFIER::StartInjectedTriggered(InjectedTrigger trigger, const uint8_t* channels, uint16_t* data, uint8_t count, AdcCallbackType callback)
+    {
+        if (count == 0 || count > MaxInjected || data == nullptr)
+        {
+            _adcData.error = AdcError::ArgumentError;
+            return false;
+        }
+
+        // Disable trigger while sequence is changed
+        _Regs()->CR2 &= ~ADC_CR2_JEXTTRIG;
+
+        _adcData.injectedCallback = callback;
+        _adcData.injectedData = data;
+
+        for (unsigned i = 0; i < count; i++)
+            EnableChannel<Pins, _Regs>(channels[i]);
+
+        _Regs()->JSQR = GetJsqr(channels, count, _Regs()->JSQR);
+
+        // Whole sequence per trigger (no discontinuous or auto-injected mode), scan is required for sequence
+        _Regs()->CR1 = (_Regs()->CR1 & ~(ADC_CR1_JDISCEN | ADC_CR1_JAUTO)) | ADC_CR1_SCAN | ADC_CR1_JEOCIE;
+        _Regs()->SR &= ~(ADC_SR_JEOC | ADC_SR_JSTRT);
+
+        _adcData.error = AdcError::NoError;
+        _Regs()->CR2 = (_Regs()->CR2 & ~(ADC_CR2_JEXTSEL | ADC_CR2_JSWSTART))
+            | ((static_cast<uint32_t>(trigger) << ADC_CR2_JEXTSEL_Pos) & ADC_CR2_JEXTSEL)
+            | ADC_CR2_JEXTTRIG;
+        Nvic::EnableIrq<ADC1_IRQn>();
+
+        return true;
+    }
+
+    ADC_TEMPLATE_ARGS
+    void ADC_TEMPLATE_QUALIFIER::StopInjectedTriggered()
+    {
+        // Back to software trigger (Init state)
+        _Regs()->CR2 |= ADC_CR2_JEXTSEL | ADC_CR2_JEXTTRIG;
+        _adcData.injectedCallback = nullptr;
+        _adcData.injectedData = nullptr;
+        StopInjected();
+    }
+
     ADC_TEMPLATE_ARGS
     template<typename RegularTrigger, typename TriggerMode>
     void ADC_TEMPLATE_QUALIFIER::SetRegularTrigger(RegularTrigger trigger, TriggerMode mode)
     {
-        _Regs()->CR2 = (_Regs()->CR2 & ~(ADC_CR2_EXTSEL | ADC_CR2_EXTTRIG)) | ((trigger & 0x0f) << ADC_CR2_EXTSEL) | (mode << ADC_CR2_EXTTRIG_Pos);
+        _Regs()->CR2 = (_Regs()->CR2 & ~(ADC_CR2_EXTSEL | ADC_CR2_EXTTRIG))
+            | ((static_cast<uint32_t>(trigger) << ADC_CR2_EXTSEL_Pos) & ADC_CR2_EXTSEL)
+            | (static_cast<uint32_t>(mode) << ADC_CR2_EXTTRIG_Pos);
     }
 
     ADC_TEMPLATE_ARGS
@@ -575,6 +627,71 @@ namespace Zhele::Private
         return StartRegular({Pins::template PinIndex<_Pins>::Value...}, dataBuffer, scanCount);
     }
 
+    ADC_TEMPLATE_ARGS
+    bool ADC_TEMPLATE_QUALIFIER::StartRegularPingPong(const uint8_t *channels, uint8_t channelsCount, uint16_t *dataBuffer, uint16_t halfScanCount, TransferCallback callback)
+    {
+        if (halfScanCount == 0 || channelsCount == 0 || channelsCount > MaxRegular)
+        {
+            _adcData.error = AdcError::ArgumentError;
+            return false;
+        }
+
+        if (!VerifyReady(ADC_SR_STRT))
+        {
+            _adcData.error = AdcError::NotReady;
+            return false;
+        }
+
+        _Regs()->SR &= ~(ADC_SR_STRT | ADC_SR_EOC);
+
+        _Regs()->SQR1 = ((channelsCount - 1) << 20);
+        _Regs()->SQR3 = 0;
+        _Regs()->SQR2 = 0;
+
+        for (unsigned i = 0; i < channelsCount; i++)
+        {
+            Pins::SetConfiguration(1u << channels[i], Pins::Analog);
+            if (i < 6)
+            {
+                _Regs()->SQR3 |= (channels[i] & 0x1f) << 5 * (i);
+            }
+            else if (i < 12)
+            {
+                _Regs()->SQR2 |= (channels[i] & 0x1f) << 5 * (i - 6);
+            }
+            else
+            {
+                _Regs()->SQR1 |= (channels[i] & 0x1f) << 5 * (i - 12);
+            }
+        }
+
+        _DmaChannel::SetTransferCallback(callback);
+        _DmaChannel::PingPongTransfer(DmaBase::Periph2Mem | DmaBase::MemIncrement | DmaBase::PriorityHigh | DmaBase::PSize16Bits | DmaBase::MSize16Bits,
+                            dataBuffer, &_Regs()->DR, channelsCount * halfScanCount);
+
+        _adcData.error = AdcError::NoError;
+
+        uint32_t controlReg = _Regs()->CR1;
+        controlReg &= ~(ADC_CR1_DISCEN | ADC_CR1_DISCNUM | ADC_CR1_SCAN);
+        if(channelsCount > 1)
+            controlReg |= ADC_CR1_SCAN;
+        _Regs()->CR1 = controlReg;
+
+        if((_Regs()->CR2 & ADC_CR2_EXTSEL) == ADC_CR2_EXTSEL)
+        {
+            // Software trigger: free running conversions at max ADC rate
+            _Regs()->CR2 |= ADC_CR2_CONT | ADC_CR2_DMA;
+            _Regs()->CR2 |= ADC_CR2_SWSTART;
+        }
+        else
+        {
+            // Conversions are started by trigger only
+            _Regs()->CR2 = (_Regs()->CR2 & ~ADC_CR2_CONT) | ADC_CR2_DMA;
+        }
+
+        return true;
+    }
+
     ADC_TEMPLATE_ARGS
     bool ADC_TEMPLATE_QUALIFIER::RegularReady()
     {
@@ -584,12 +701,42 @@ namespace Zhele::Private
     ADC_TEMPLATE_ARGS
     void ADC_TEMPLATE_QUALIFIER::StopRegular()
     {
+        _Regs()->CR2 &= ~(ADC_CR2_CONT | ADC_CR2_DMA);
         _DmaChannel::Disable();
         _Regs()->SR &= ~(ADC_SR_STRT | ADC_SR_EOC);
         _Regs()->SQR1 = 0;
         _Regs()->SQR2 = 0;
         _Regs()->SQR3 = 0;
     }
+
+    ADC_TEMPLATE_ARGS
+    void ADC_TEMPLATE_QUALIFIER::SetAnalogWatchdog(uint8_t channel, uint16_t low, uint16_t high, AdcWatchdogCallbackType callback)
+    {
+        DisableAnalogWatchdog();
+        SetAnalogWatchdogThresholds(low, high);
+        _adcData.watchdogCallback = callback;
+
+        uint32_t cr1 = _Regs()->CR1 & ~(ADC_CR1_AWDCH | ADC_CR1_AWDSGL);
+        if (channel != WatchdogAllChannels)
+            cr1 |= ((channel << ADC_CR1_AWDCH_Pos) & ADC_CR1_AWDCH) | ADC_CR1_AWDSGL;
+
+        _Regs()->SR &= ~ADC_SR_AWD;
+        _Regs()->CR1 = cr1 | ADC_CR1_AWDEN | ADC_CR1_JAWDEN | ADC_CR1_AWDIE;
+    }
+
+    ADC_TEMPLATE_ARGS
+    void ADC_TEMPLATE_QUALIFIER::SetAnalogWatchdogThresholds(uint16_t low, uint16_t high)
+    {
+        _Regs()->LTR = low & ADC_LTR_LT;
+        _Regs()->HTR = high & ADC_HTR_HT;
+    }
+
+    ADC_TEMPLATE_ARGS
+    void ADC_TEMPLATE_QUALIFIER::DisableAnalogWatchdog()
+    {
+        _Regs()->CR1 &= ~(ADC_CR1_AWDEN | ADC_CR1_JAWDEN | ADC_CR1_AWDIE);
+        _Regs()->SR &= ~ADC_SR_AWD;
+    }
 #endif
 
     ADC_TEMPLATE_ARGS
@@ -618,28 +765,71 @@ namespace Zhele::Private
     int16_t ADC_TEMPLATE_QUALIFIER::ReadTemperature()
     {
         SetSampleTime(TempSensorChannel, 250);
-        uint16_t rawValue = ReadInjected(TempSensorChannel);
-        int16_t v25 = 14100;	// x10000
-        int16_t Avg_Slope = 43; // x10000
-        int16_t value = (v25 - ToVolts(rawValue)) / Avg_Slope + 25;
-        return value;
+        return ToTemperature(ReadInjected(TempSensorChannel));
+    }
+
+    ADC_TEMPLATE_ARGS
+    int16_t ADC_TEMPLATE_QUALIFIER::ToTemperature(uint16_t value)
+    {
+#if defined (TEMPSENSOR_CAL1_ADDR) && defined (TEMPSENSOR_CAL2_ADDR)
+        // Calibration values are measured with VREFINT_CAL_VREF supply
+        int32_t raw = static_cast<int32_t>(ToVolts(value) * ((1u << 12) - 1) / (VREFINT_CAL_VREF * 10u));
+        int32_t cal1 = *TEMPSENSOR_CAL1_ADDR;
+        int32_t cal2 = *TEMPSENSOR_CAL2_ADDR;
+        return static_cast<int16_t>((TEMPSENSOR_CAL2_TEMP - TEMPSENSOR_CAL1_TEMP) * (raw - cal1) / (cal2 - cal1) + TEMPSENSOR_CAL1_TEMP);
+#else
+        return static_cast<int16_t>((static_cast<int32_t>(TempSensorV25) - static_cast<int32_t>(ToVolts(value))) / static_cast<int32_t>(TempSensorSlope) + 25);
+#endif
     }
 
     ADC_TEMPLATE_ARGS
     AdcData ADC_TEMPLATE_QUALIFIER::_adcData;
 
+    ADC_TEMPLATE_ARGS
+    unsigned ADC_TEMPLATE_QUALIFIER::CalibrateSupply()
+    {
+        SetSampleTime(ReferenceChannel, 250);
+
+        unsigned vRefRaw = 0;
+        for(int i = 0; i < 4; i++)
+        {
+            vRefRaw += ReadInjected(ReferenceChannel);
+        }
+        vRefRaw = (vRefRaw + 2) / 4;
+        if (vRefRaw == 0)
+            return 0;
+
+#if defined (VREFINT_CAL_ADDR) && defined (VREFINT_CAL_VREF)
+        unsigned vRefInt = VREFINT_CAL_VREF * 10u * (*VREFINT_CAL_ADDR) / ((1u << 12) - 1);
+#else
+        unsigned vRefInt = VRefIntNominal;
+#endif
+        _adcData.voltsScale = VoltsScale(vRefInt, vRefRaw);
+        return (((1u << ResolutionBits) - 1) * _adcData.voltsScale) >> 16;
+    }
+
     ADC_TEMPLATE_ARGS
     unsigned ADC_TEMPLATE_QUALIFIER::ToVolts(uint16_t value)
     {
-        if(_adcData.vRef == 0)
+        if(_adcData.voltsScale == 0)
         {
-            for(int i = 0; i < 4; i++)
-            {
-                _adcData.vRef += ReadInjected(ReferenceChannel);
-            }
-            _adcData.vRef /= 4;
+            CalibrateSupply();
+        }
+        return (value * _adcData.voltsScale) >> 16;
+    }
+
+    ADC_TEMPLATE_ARGS
+    void ADC_TEMPLATE_QUALIFIER::ToVolts(const uint16_t* data, unsigned count, uint16_t* volts)
+    {
+        if(_adcData.voltsScale == 0)
+        {
+            CalibrateSupply();
+        }
+        const uint32_t scale = _adcData.voltsScale;
+        for(unsigned i = 0; i < count; ++i)
+        {
+            volts[i] = static_cast<uint16_t>((data[i] * scale) >> 16);
         }
-        return VRefNominal * value / _adcData.vRef;
     }
 }
 
@@ -0,0 +1,77 @@
+/**
+ * @file
+ * ADC stream decimator methods implementation
+ *
+ * @author Alexey Zhelonkin
+ * @date 2023
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_ADC_DECIMATOR_IMPL_COMMON_H
+#define ZHELE_ADC_DECIMATOR_IMPL_COMMON_H
+
+namespace Zhele
+{
+    #define ADCDECIMATOR_TEMPLATE_ARGS template<unsigned _Channels, unsigned _Ratio, unsigned _Shift, unsigned _Stages, unsigned _InputBits>
+    #define ADCDECIMATOR_TEMPLATE_QUALIFIER AdcDecimator<_Channels, _Ratio, _Shift, _Stages, _InputBits>
+
+    ADCDECIMATOR_TEMPLATE_ARGS
+    unsigned ADCDECIMATOR_TEMPLATE_QUALIFIER::Process(const uint16_t* input, unsigned count, uint16_t* output)
+    {
+        unsigned produced = 0;
+
+        // Output index never overtakes input index, so in-place processing is safe
+        for(unsigned scan = 0; scan + _Channels <= count; scan += _Channels)
+        {
+            for(unsigned channel = 0; channel < _Channels; ++channel)
+            {
+                uint32_t* integrators = _integrators[channel];
+                integrators[0] += input[scan + channel];
+                for(unsigned stage = 1; stage < _Stages; ++stage)
+                    integrators[stage] += integrators[stage - 1];
+            }
+
+            if(++_phase < _Ratio)
+                continue;
+            _phase = 0;
+
+            // Combs run at output rate, wrapping arithmetic is compensated by differences
+            for(unsigned channel = 0; channel < _Channels; ++channel)
+            {
+                uint32_t value = _integrators[channel][_Stages - 1];
+                for(unsigned stage = 0; stage < _Stages; ++stage)
+                {
+                    uint32_t delayed = _combs[channel][stage];
+                    _combs[channel][stage] = value;
+                    value -= delayed;
+                }
+                output[produced++] = static_cast<uint16_t>(value >> _Shift);
+            }
+        }
+
+        return produced;
+    }
+
+    ADCDECIMATOR_TEMPLATE_ARGS
+    unsigned ADCDECIMATOR_TEMPLATE_QUALIFIER::Process(void* data, unsigned size)
+    {
+        uint16_t* samples = static_cast<uint16_t*>(data);
+        return Process(samples, size, samples);
+    }
+
+    ADCDECIMATOR_TEMPLATE_ARGS
+    void ADCDECIMATOR_TEMPLATE_QUALIFIER::Reset()
+    {
+        for(unsigned channel = 0; channel < _Channels; ++channel)
+        {
+            for(unsigned stage = 0; stage < _Stages; ++stage)
+            {
+                _integrators[channel][stage] = 0;
+                _combs[channel][stage] = 0;
+            }
+        }
+        _phase = 0;
+    }
+}
+
+#endif //! ZHELE_ADC_DECIMATOR_IMPL_COMMON_H
@@ -0,0 +1,156 @@
+/**
+ * @file
+ * Coroutines support methods implementation
+ * 
+ * @author Alexey Zhelonkin
+ * @date 2023
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_ASYNC_IMPL_COMMON_H
+#define ZHELE_ASYNC_IMPL_COMMON_H
+
+#include <utility>
+
+namespace Zhele::Async
+{
+    namespace Private
+    {
+        alignas(8) inline uint8_t FramePool::_frames[ZHELE_COROUTINE_FRAMES_COUNT][ZHELE_COROUTINE_FRAME_SIZE];
+        inline uint32_t FramePool::_used = 0;
+
+        inline void* FramePool::Allocate(size_t size)
+        {
+            if(size > ZHELE_COROUTINE_FRAME_SIZE)
+                return nullptr;
+
+            uint32_t state = DriverCriticalSection::Enter();
+
+            void* frame = nullptr;
+            for(unsigned i = 0; i < ZHELE_COROUTINE_FRAMES_COUNT; ++i)
+            {
+                if((_used & (1u << i)) == 0)
+                {
+                    _used |= (1u << i);
+                    frame = _frames[i];
+                    break;
+                }
+            }
+
+            DriverCriticalSection::Leave(state);
+            return frame;
+        }
+
+        inline void FramePool::Free(void* frame)
+        {
+            unsigned index = (static_cast<uint8_t*>(frame) - &_frames[0][0]) / ZHELE_COROUTINE_FRAME_SIZE;
+
+            uint32_t state = DriverCriticalSection::Enter();
+            _used &= ~(1u << index);
+            DriverCriticalSection::Leave(state);
+        }
+    }
+
+    inline std::coroutine_handle<> Task::promise_type::FinalAwaiter::await_suspend(std::coroutine_handle<promise_type> handle) noexcept
+    {
+        promise_type& promise = handle.promise();
+        if(promise._continuation)
+            return promise._continuation;
+
+        if(promise._detached)
+            handle.destroy();
+
+        return std::noop_coroutine();
+    }
+
+    inline Task::Task(Task&& other) noexcept
+        : _handle(std::exchange(other._handle, nullptr))
+    {}
+
+    inline Task& Task::operator=(Task&& other) noexcept
+    {
+        if(this != &other)
+        {
+            if(_handle)
+                _handle.destroy();
+            _handle = std::exchange(other._handle, nullptr);
+        }
+        return *this;
+    }
+
+    inline Task::~Task()
+    {
+        if(_handle)
+            _handle.destroy();
+    }
+
+    inline std::coroutine_handle<> Task::await_suspend(std::coroutine_handle<> continuation) noexcept
+    {
+        _handle.promise()._continuation = continuation;
+        return _handle;
+    }
+
+    inline std::coroutine_handle<> Task::Detach()
+    {
+        if(_handle)
+            _handle.promise()._detached = true;
+        return std::exchange(_handle, nullptr);
+    }
+
+    template<typename _Loop>
+    bool Spawn(Task&& task, unsigned priority)
+    {
+        if(!task.IsValid())
+            return false;
+
+        std::coroutine_handle<> handle = task.Detach();
+        if(!_Loop::Post([handle] { handle.resume(); }, priority))
+        {
+            handle.destroy();
+            return false;
+        }
+        return true;
+    }
+
+    template<typename _Loop, typename... _Args, typename _Starter>
+    void CallbackAwaiter<_Loop, void(_Args...), _Starter>::await_suspend(std::coroutine_handle<> handle)
+    {
+        _handle = handle;
+        _starter(Callback([this](_Args... args) {
+            _result = Result(args...);
+            // If event queue is full, coroutine is resumed immediately (from callback context) rather than lost
+            if(!_Loop::Post([handle = _handle] { handle.resume(); }, _priority))
+                _handle.resume();
+        }));
+    }
+
+    template<typename _Loop, typename... _Args, typename _Starter>
+    auto CallbackAwaiter<_Loop, void(_Args...), _Starter>::await_resume()
+    {
+        if constexpr (sizeof...(_Args) == 0)
+            return;
+        else if constexpr (sizeof...(_Args) == 1)
+            return std::get<0>(_result);
+        else
+            return _result;
+    }
+
+    template<typename _Loop>
+    bool YieldAwaiter<_Loop>::await_suspend(std::coroutine_handle<> handle)
+    {
+        // Continue immediately if event can't be posted
+        return _Loop::Post([handle] { handle.resume(); }, _priority);
+    }
+
+    template<typename _Loop, typename _Wheel>
+    void SleepAwaiter<_Loop, _Wheel>::await_suspend(std::coroutine_handle<> handle)
+    {
+        unsigned priority = _priority;
+        _Wheel::Start(_timer, _ticks, [handle, priority] {
+            if(!_Loop::Post([handle] { handle.resume(); }, priority))
+                handle.resume();
+        });
+    }
+}
+
+#endif //! ZHELE_ASYNC_IMPL_COMMON_H
@@ -0,0 +1,511 @@
+/**
+ * @file
+ * bxCAN methods implementation
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_CAN_IMPL_COMMON_H
+#define ZHELE_CAN_IMPL_COMMON_H
+
+#include <string.h>
+
+namespace Zhele
+{
+    namespace Private
+    {
+        /// Converts standard identifier to 32-bit filter register
+        constexpr uint32_t CanFilterStdId32(uint32_t id) { return id << CAN_TI0R_STID_Pos; }
+        /// Converts extended identifier to 32-bit filter register
+        constexpr uint32_t CanFilterExtId32(uint32_t id) { return (id << CAN_TI0R_EXID_Pos) | CAN_TI0R_IDE; }
+        /// Converts standard identifier to 16-bit filter register
+        constexpr uint32_t CanFilterStdId16(uint16_t id) { return static_cast<uint32_t>(id & 0x7ff) << 5; }
+        /// IDE bit of 16-bit filter register
+        constexpr uint32_t CanFilterIde16 = 1 << 3;
+    }
+
+    template<uint32_t _Id, uint32_t _Mask, bool _Extended, CanFifo _Fifo>
+    struct CanMaskFilter32
+    {
+        static_assert(_Extended || (_Id <= 0x7ff && _Mask <= 0x7ff), "Standard identifier is 11-bit");
+        static_assert(_Id <= 0x1fffffff && _Mask <= 0x1fffffff, "Extended identifier is 29-bit");
+
+        static constexpr bool ListMode = false;
+        static constexpr bool Scale32 = true;
+        static constexpr CanFifo Fifo = _Fifo;
+        static constexpr uint32_t FR1 = _Extended ? Private::CanFilterExtId32(_Id) : Private::CanFilterStdId32(_Id);
+        // IDE bit is always compared, so standard filter does not accept extended frames and vice versa
+        static constexpr uint32_t FR2 = (_Extended ? Private::CanFilterExtId32(_Mask) : Private::CanFilterStdId32(_Mask)) | CAN_TI0R_IDE;
+    };
+
+    template<uint32_t _Id1, uint32_t _Id2, bool _Extended, CanFifo _Fifo>
+    struct CanListFilter32
+    {
+        static_assert(_Extended || (_Id1 <= 0x7ff && _Id2 <= 0x7ff), "Standard identifier is 11-bit");
+        static_assert(_Id1 <= 0x1fffffff && _Id2 <= 0x1fffffff, "Extended identifier is 29-bit");
+
+        static constexpr bool ListMode = true;
+        static constexpr bool Scale32 = true;
+        static constexpr CanFifo Fifo = _Fifo;
+        static constexpr uint32_t FR1 = _Extended ? Private::CanFilterExtId32(_Id1) : Private::CanFilterStdId32(_Id1);
+        static constexpr uint32_t FR2 = _Extended ? Private::CanFilterExtId32(_Id2) : Private::CanFilterStdId32(_Id2);
+    };
+
+    template<uint16_t _Id1, uint16_t _Mask1, uint16_t _Id2, uint16_t _Mask2, CanFifo _Fifo>
+    struct CanMaskFilter16
+    {
+        static_assert(_Id1 <= 0x7ff && _Mask1 <= 0x7ff && _Id2 <= 0x7ff && _Mask2 <= 0x7ff, "Standard identifier is 11-bit");
+
+        static constexpr bool ListMode = false;
+        static constexpr bool Scale32 = false;
+        static constexpr CanFifo Fifo = _Fifo;
+        static constexpr uint32_t FR1 = ((Private::CanFilterStdId16(_Mask1) | Private::CanFilterIde16) << 16) | Private::CanFilterStdId16(_Id1);
+        static constexpr uint32_t FR2 = ((Private::CanFilterStdId16(_Mask2) | Private::CanFilterIde16) << 16) | Private::CanFilterStdId16(_Id2);
+    };
+
+    template<uint16_t _Id1, uint16_t _Id2, uint16_t _Id3, uint16_t _Id4, CanFifo _Fifo>
+    struct CanListFilter16
+    {
+        static_assert(_Id1 <= 0x7ff && _Id2 <= 0x7ff && _Id3 <= 0x7ff && _Id4 <= 0x7ff, "Standard identifier is 11-bit");
+
+        static constexpr bool ListMode = true;
+        static constexpr bool Scale32 = false;
+        static constexpr CanFifo Fifo = _Fifo;
+        static constexpr uint32_t FR1 = (Private::CanFilterStdId16(_Id2) << 16) | Private::CanFilterStdId16(_Id1);
+        static constexpr uint32_t FR2 = (Private::CanFilterStdId16(_Id4) << 16) | Private::CanFilterStdId16(_Id3);
+    };
+
+    constexpr uint32_t CanBase::CalculateBitTiming(uint32_t clock, uint32_t bitrate, uint16_t samplePoint)
+    {
+        uint32_t best = 0;
+        uint32_t bestError = UINT32_MAX;
+        if(bitrate == 0)
+            return best;
+
+        // More quanta per bit gives finer sample point and resynchronization
+        for(uint32_t quanta = 25; quanta >= 8; --quanta)
+        {
+            if(clock % (bitrate * quanta) != 0)
+                continue;
+            uint32_t prescaler = clock / (bitrate * quanta);
+            if(prescaler < 1 || prescaler > 1024)
+                continue;
+
+            // Sample point is at the end of TS1 (SYNC_SEG is one quantum)
+            uint32_t sample = (quanta * samplePoint + 500) / 1000;
+            uint32_t ts1 = sample > 1 ? sample - 1 : 1;
+            if(ts1 > 16)
+                ts1 = 16;
+            if(quanta - 1 - ts1 > 8)
+                ts1 = quanta - 1 - 8;
+            if(quanta - 1 - ts1 < 1)
+                ts1 = quanta - 2;
+            uint32_t ts2 = quanta - 1 - ts1;
+            uint32_t sjw = ts2 < 4 ? ts2 : 4;
+
+            uint32_t actual = (ts1 + 1) * 1000 / quanta;
+            uint32_t error = actual > samplePoint ? actual - samplePoint : samplePoint - actual;
+            if(error < bestError)
+            {
+                bestError = error;
+                best = (prescaler - 1)
+                    | ((ts1 - 1) << CAN_BTR_TS1_Pos)
+                    | ((ts2 - 1) << CAN_BTR_TS2_Pos)
+                    | ((sjw - 1) << CAN_BTR_SJW_Pos);
+            }
+        }
+        return best;
+    }
+
+    inline CanBase::TxEntry CanBase::ToTxEntry(const CanFrame& frame, uint32_t sequence)
+    {
+        TxEntry entry {};
+        entry.Tir = frame.Extended
+            ? (frame.Id << CAN_TI0R_EXID_Pos) | CAN_TI0R_IDE
+            : (frame.Id << CAN_TI0R_STID_Pos);
+        if(frame.Remote)
+            entry.Tir |= CAN_TI0R_RTR;
+        entry.Tdtr = frame.Length > 8 ? 8 : frame.Length;
+        memcpy(&entry.Tdlr, frame.Data, 4);
+        memcpy(&entry.Tdhr, frame.Data + 4, 4);
+        entry.Sequence = sequence;
+        return entry;
+    }
+
+    namespace Private
+    {
+        #define CAN_TEMPLATE_ARGS template<typename _Regs, typename _FilterRegs, IRQn_Type _TxIrq, IRQn_Type _Rx0Irq, IRQn_Type _Rx1Irq, IRQn_Type _SceIrq, typename _ClockCtrl, typename _TxPins, typename _RxPins>
+        #define CAN_TEMPLATE_QUALIFIER Can<_Regs, _FilterRegs, _TxIrq, _Rx0Irq, _Rx1Irq, _SceIrq, _ClockCtrl, _TxPins, _RxPins>
+
+        CAN_TEMPLATE_ARGS
+        bool CAN_TEMPLATE_QUALIFIER::Init(uint32_t bitrate, Options options)
+        {
+            uint32_t btr = CalculateBitTiming(_ClockCtrl::ClockFreq(), bitrate);
+            if(btr == 0)
+                return false;
+            return InitBitTiming(btr, options);
+        }
+
+        CAN_TEMPLATE_ARGS
+        template<uint32_t _Bitrate, typename _ClockTree>
+        bool CAN_TEMPLATE_QUALIFIER::Init(Options options)
+        {
+            constexpr uint32_t btr = CalculateBitTiming(_ClockTree::template BusClockFreq<_ClockCtrl>, _Bitrate);
+            static_assert(btr != 0, "Bit rate cannot be reached with CAN clock");
+            return InitBitTiming(btr, options);
+        }
+
+        CAN_TEMPLATE_ARGS
+        bool CAN_TEMPLATE_QUALIFIER::InitBitTiming(uint32_t btr, Options options)
+        {
+            const uint32_t timeout = 0x10000;
+
+            _ClockCtrl::Enable();
+            // Leave sleep mode and request initialization
+            _Regs()->MCR = CAN_MCR_INRQ;
+            uint32_t counter = 0;
+            while((_Regs()->MSR & CAN_MSR_INAK) == 0)
+            {
+                if(++counter == timeout)
+                    return false;
+            }
+
+            // TXFP is not set: mailboxes are transmitted by identifier priority
+            _Regs()->MCR = CAN_MCR_INRQ | (options & McrOptionsMask);
+            _Regs()->BTR = btr | (options & BtrOptionsMask);
+
+            _rxQueue[0].clear();
+            _rxQueue[1].clear();
+            _txQueue.clear();
+            _mailboxesBusy = 0;
+            _mailboxesAborting = 0;
+
+            _Regs()->IER = CAN_IER_TMEIE
+                | CAN_IER_FMPIE0 | CAN_IER_FOVIE0
+                | CAN_IER_FMPIE1 | CAN_IER_FOVIE1
+                | CAN_IER_EWGIE | CAN_IER_EPVIE | CAN_IER_BOFIE | CAN_IER_LECIE | CAN_IER_ERRIE;
+            Nvic::EnableIrq<_TxIrq>();
+            Nvic::EnableIrq<_Rx0Irq>();
+            Nvic::EnableIrq<_Rx1Irq>();
+            Nvic::EnableIrq<_SceIrq>();
+
+            // Normal mode is entered after 11 recessive bits on bus
+            _Regs()->MCR &= ~CAN_MCR_INRQ;
+            counter = 0;
+            while((_Regs()->MSR & CAN_MSR_INAK) != 0)
+            {
+                if(++counter == timeout)
+                    return false;
+            }
+            return true;
+        }
+
+        CAN_TEMPLATE_ARGS
+        void CAN_TEMPLATE_QUALIFIER::Disable()
+        {
+            NVIC_DisableIRQ(_TxIrq);
+            NVIC_DisableIRQ(_Rx0Irq);
+            NVIC_DisableIRQ(_Rx1Irq);
+            NVIC_DisableIRQ(_SceIrq);
+            _Regs()->IER = 0;
+            _Regs()->MCR = CAN_MCR_RESET;
+
+            _txQueue.clear();
+            _mailboxesBusy = 0;
+            _mailboxesAborting = 0;
+            _ClockCtrl::Disable();
+        }
+
+        CAN_TEMPLATE_ARGS
+        uint8_t CAN_TEMPLATE_QUALIFIER::FirstFilterBank()
+        {
+        #if defined (CAN_FMR_CAN2SB)
+            if constexpr (!std::is_same_v<_Regs, _FilterRegs>)
+                return static_cast<uint8_t>((_FilterRegs()->FMR & CAN_FMR_CAN2SB) >> CAN_FMR_CAN2SB_Pos);
+        #endif
+            return 0;
+        }
+
+        CAN_TEMPLATE_ARGS
+        uint8_t CAN_TEMPLATE_QUALIFIER::FilterBanksCount()
+        {
+        #if defined (CAN_FMR_CAN2SB)
+            const uint8_t slaveStart = static_cast<uint8_t>((_FilterRegs()->FMR & CAN_FMR_CAN2SB) >> CAN_FMR_CAN2SB_Pos);
+            if constexpr (std::is_same_v<_Regs, _FilterRegs>)
+                return slaveStart;
+            else
+                return 28 - slaveStart;
+        #else
+            return 14;
+        #endif
+        }
+
+        CAN_TEMPLATE_ARGS
+        template<typename... _Filters>
+        void CAN_TEMPLATE_QUALIFIER::SetFilters()
+        {
+            static_assert(sizeof...(_Filters) <= 28, "bxCAN has 28 filter banks at most");
+
+            const unsigned first = FirstFilterBank();
+            const unsigned last = first + FilterBanksCount();
+            const uint32_t ownBanks = ((1ul << last) - 1) & ~((1ul << first) - 1);
+
+            uint32_t listMode = 0;
+            uint32_t scale32 = 0;
+            uint32_t fifo1 = 0;
+            uint32_t active = 0;
+            unsigned bank = first;
+
+            _FilterRegs()->FMR |= CAN_FMR_FINIT;
+            _FilterRegs()->FA1R &= ~ownBanks;
+            ([&]{
+                if(bank >= last)
+                    return;
+                _FilterRegs()->sFilterRegister[bank].FR1 = _Filters::FR1;
+                _FilterRegs()->sFilterRegister[bank].FR2 = _Filters::FR2;
+                listMode |= _Filters::ListMode ? (1ul << bank) : 0;
+                scale32 |= _Filters::Scale32 ? (1ul << bank) : 0;
+                fifo1 |= _Filters::Fifo == CanFifo::Fifo1 ? (1ul << bank) : 0;
+                active |= 1ul << bank;
+                ++bank;
+            }(), ...);
+            _FilterRegs()->FM1R = (_FilterRegs()->FM1R & ~ownBanks) | listMode;
+            _FilterRegs()->FS1R = (_FilterRegs()->FS1R & ~ownBanks) | scale32;
+            _FilterRegs()->FFA1R = (_FilterRegs()->FFA1R & ~ownBanks) | fifo1;
+            _FilterRegs()->FA1R |= active;
+            _FilterRegs()->FMR &= ~CAN_FMR_FINIT;
+        }
+
+    #if defined (CAN_FMR_CAN2SB)
+        CAN_TEMPLATE_ARGS
+        void CAN_TEMPLATE_QUALIFIER::SplitFilterBanks(uint8_t slaveStartBank)
+        {
+            _FilterRegs()->FMR |= CAN_FMR_FINIT;
+            _FilterRegs()->FMR = (_FilterRegs()->FMR & ~CAN_FMR_CAN2SB) | (static_cast<uint32_t>(slaveStartBank) << CAN_FMR_CAN2SB_Pos);
+            _FilterRegs()->FMR &= ~CAN_FMR_FINIT;
+        }
+    #endif
+
+        CAN_TEMPLATE_ARGS
+        bool CAN_TEMPLATE_QUALIFIER::Write(const CanFrame& frame)
+        {
+            bool result = false;
+            uint32_t state = DriverCriticalSection::Enter();
+            // Slot is reserved for aborted mailbox, it returns to queue
+            if(_txQueue.size() + (_mailboxesAborting != 0 ? 1 : 0) < _txQueue.capacity())
+            {
+                _txQueue.push(ToTxEntry(frame, _txSequence));
+                _txSequence = _txSequence + 1;
+                FillMailboxes();
+                result = true;
+            }
+            DriverCriticalSection::Leave(state);
+            return result;
+        }
+
+        CAN_TEMPLATE_ARGS
+        unsigned CAN_TEMPLATE_QUALIFIER::WritePending()
+        {
+            uint32_t state = DriverCriticalSection::Enter();
+            unsigned pending = _txQueue.size();
+            for(unsigned mailbox = 0; mailbox < MailboxCount; ++mailbox)
+            {
+                if(_mailboxesBusy & (1 << mailbox))
+                    ++pending;
+            }
+            DriverCriticalSection::Leave(state);
+            return pending;
+        }
+
+        CAN_TEMPLATE_ARGS
+        void CAN_TEMPLATE_QUALIFIER::FillMailboxes()
+        {
+            while(!_txQueue.empty())
+            {
+                uint32_t tsr = _Regs()->TSR;
+                if((tsr & (CAN_TSR_TME0 | CAN_TSR_TME1 | CAN_TSR_TME2)) != 0)
+                {
+                    unsigned mailbox = (tsr & CAN_TSR_CODE) >> CAN_TSR_CODE_Pos;
+                    const TxEntry& entry = _txQueue.top();
+                    _Regs()->sTxMailBox[mailbox].TDTR = entry.Tdtr;
+                    _Regs()->sTxMailBox[mailbox].TDLR = entry.Tdlr;
+                    _Regs()->sTxMailBox[mailbox].TDHR = entry.Tdhr;
+                    _Regs()->sTxMailBox[mailbox].TIR = entry.Tir | CAN_TI0R_TXRQ;
+                    _mailboxes[mailbox] = entry;
+                    _mailboxesBusy |= 1 << mailbox;
+                    _txQueue.pop();
+                    continue;
+                }
+
+                // All mailboxes are busy: replace the lowest priority frame if queue has higher one
+                if(_mailboxesAborting != 0)
+                    break;
+                unsigned lowest = 0;
+                for(unsigned mailbox = 1; mailbox < MailboxCount; ++mailbox)
+                {
+                    if(TxPriority()(_mailboxes[mailbox], _mailboxes[lowest]))
+                        lowest = mailbox;
+                }
+                if(TxPriority()(_mailboxes[lowest], _txQueue.top()))
+                {
+                    _mailboxesAborting = 1 << lowest;
+                    _Regs()->TSR = CAN_TSR_ABRQ0 << (8 * lowest);
+                }
+                break;
+            }
+        }
+
+        CAN_TEMPLATE_ARGS
+        void CAN_TEMPLATE_QUALIFIER::TxIrqHandler()
+        {
+            uint32_t tsr = _Regs()->TSR;
+            for(unsigned mailbox = 0; mailbox < MailboxCount; ++mailbox)
+            {
+                const uint32_t requestCompleted = CAN_TSR_RQCP0 << (8 * mailbox);
+                if((tsr & requestCompleted) == 0)
+                    continue;
+
+                // Clears RQCP, TXOK, ALST and TERR
+                _Regs()->TSR = requestCompleted;
+                const bool aborted = (_mailboxesAborting & (1 << mailbox)) != 0;
+                _mailboxesBusy &= ~(1 << mailbox);
+                _mailboxesAborting &= ~(1 << mailbox);
+
+                if((tsr & (CAN_TSR_TXOK0 << (8 * mailbox))) != 0)
+                    continue;
+
+                // Abort is completed before transmission: frame returns to queue (slot is reserved by Write)
+                if(aborted)
+                {
+                    _txQueue.push(_mailboxes[mailbox]);
+                }
+                else
+                {
+                    ZHELE_STATISTICS_INCREMENT(Statistics, CanCounter::TxFailed);
+                }
+            }
+            FillMailboxes();
+        }
+
+        CAN_TEMPLATE_ARGS
+        template<CanFifo _Fifo>
+        void CAN_TEMPLATE_QUALIFIER::DrainFifo()
+        {
+            const unsigned index = static_cast<unsigned>(_Fifo);
+            // RF0R and RF1R have equal layout
+            volatile uint32_t& rfr = index == 0 ? _Regs()->RF0R : _Regs()->RF1R;
+            auto& queue = _rxQueue[index];
+
+            while((rfr & CAN_RF0R_FMP0) != 0)
+            {
+                const auto& mailbox = _Regs()->sFIFOMailBox[index];
+                uint32_t rir = mailbox.RIR;
+                uint32_t rdtr = mailbox.RDTR;
+                if(!queue.full())
+                {
+                    CanFrame frame;
+                    frame.Extended = (rir & CAN_RI0R_IDE) != 0;
+                    frame.Remote = (rir & CAN_RI0R_RTR) != 0;
+                    frame.Id = frame.Extended ? (rir >> CAN_RI0R_EXID_Pos) : (rir >> CAN_RI0R_STID_Pos);
+                    uint8_t length = rdtr & CAN_RDT0R_DLC;
+                    frame.Length = length > 8 ? 8 : length;
+                    frame.FilterIndex = static_cast<uint8_t>((rdtr & CAN_RDT0R_FMI) >> CAN_RDT0R_FMI_Pos);
+                    uint32_t data[2] = {mailbox.RDLR, mailbox.RDHR};
+                    memcpy(frame.Data, data, sizeof(frame.Data));
+                    queue.push_back(frame);
+                }
+                else
+                {
+                    ZHELE_STATISTICS_INCREMENT(Statistics, CanCounter::RxQueueOverflow);
+                }
+                rfr = CAN_RF0R_RFOM0;
+            }
+
+            if((rfr & CAN_RF0R_FOVR0) != 0)
+            {
+                rfr = CAN_RF0R_FOVR0 | CAN_RF0R_FULL0;
+                ZHELE_STATISTICS_INCREMENT(Statistics, CanCounter::RxOverrun);
+            }
+        }
+
+        CAN_TEMPLATE_ARGS
+        void CAN_TEMPLATE_QUALIFIER::Rx0IrqHandler()
+        {
+            DrainFifo<CanFifo::Fifo0>();
+        }
+
+        CAN_TEMPLATE_ARGS
+        void CAN_TEMPLATE_QUALIFIER::Rx1IrqHandler()
+        {
+            DrainFifo<CanFifo::Fifo1>();
+        }
+
+        CAN_TEMPLATE_ARGS
+        void CAN_TEMPLATE_QUALIFIER::SceIrqHandler()
+        {
+            uint32_t esr = _Regs()->ESR;
+            if((esr & CAN_ESR_LEC) != 0)
+            {
+                ZHELE_STATISTICS_INCREMENT(Statistics, CanCounter::ProtocolErrors);
+                _Regs()->ESR = 0;
+            }
+            if((esr & CAN_ESR_BOFF) != 0)
+            {
+                ZHELE_STATISTICS_INCREMENT(Statistics, CanCounter::BusOff);
+            }
+            _Regs()->MSR = CAN_MSR_ERRI;
+        }
+
+        CAN_TEMPLATE_ARGS
+        bool CAN_TEMPLATE_QUALIFIER::Read(CanFrame& frame)
+        {
+            return Read(CanFifo::Fifo0, frame) || Read(CanFifo::Fifo1, frame);
+        }
+
+        CAN_TEMPLATE_ARGS
+        bool CAN_TEMPLATE_QUALIFIER::Read(CanFifo fifo, CanFrame& frame)
+        {
+            auto& queue = _rxQueue[static_cast<unsigned>(fifo)];
+            if(queue.empty())
+                return false;
+            frame = queue.front();
+            queue.pop_front();
+            return true;
+        }
+
+        CAN_TEMPLATE_ARGS
+        unsigned CAN_TEMPLATE_QUALIFIER::ReadAvailable()
+        {
+            return _rxQueue[0].size() + _rxQueue[1].size();
+        }
+
+        CAN_TEMPLATE_ARGS
+        CanBase::ErrorState CAN_TEMPLATE_QUALIFIER::GetErrorState()
+        {
+            uint32_t esr = _Regs()->ESR;
+            if((esr & CAN_ESR_BOFF) != 0)
+                return ErrorState::BusOff;
+            if((esr & CAN_ESR_EPVF) != 0)
+                return ErrorState::Passive;
+            if((esr & CAN_ESR_EWGF) != 0)
+                return ErrorState::Warning;
+            return ErrorState::Active;
+        }
+
+        CAN_TEMPLATE_ARGS
+        uint8_t CAN_TEMPLATE_QUALIFIER::TransmitErrors()
+        {
+            return static_cast<uint8_t>((_Regs()->ESR & CAN_ESR_TEC) >> CAN_ESR_TEC_Pos);
+        }
+
+        CAN_TEMPLATE_ARGS
+        uint8_t CAN_TEMPLATE_QUALIFIER::ReceiveErrors()
+        {
+            return static_cast<uint8_t>((_Regs()->ESR & CAN_ESR_REC) >> CAN_ESR_REC_Pos);
+        }
+    }
+}
+
+#endif //! ZHELE_CAN_IMPL_COMMON_H
@@ -71,6 +71,40 @@ namespace Zhele::Clock
         _Reg::And(~_Mask);
     }
 
+    template<typename _Reg, unsigned _Mask, typename _ClockSrc>
+    volatile uint8_t ClockControl<_Reg, _Mask, _ClockSrc>::_users = 0;
+
+    template<typename _Reg, unsigned _Mask, typename _ClockSrc>
+    void ClockControl<_Reg, _Mask, _ClockSrc>::Acquire()
+    {
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        if(_users == 0)
+            Enable();
+        _users = _users + 1;
+        __set_PRIMASK(primask);
+    }
+
+    template<typename _Reg, unsigned _Mask, typename _ClockSrc>
+    void ClockControl<_Reg, _Mask, _ClockSrc>::Release()
+    {
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        if(_users > 0)
+        {
+            _users = _users - 1;
+            if(_users == 0)
+                Disable();
+        }
+        __set_PRIMASK(primask);
+    }
+
+    template<typename _Reg, unsigned _Mask, typename _ClockSrc>
+    unsigned ClockControl<_Reg, _Mask, _ClockSrc>::Users()
+    {
+        return _users;
+    }
+
 #if defined (RCC_CSR_LSION)
     constexpr ClockFrequenceT LsiClock::SrcClockFreq()
     {
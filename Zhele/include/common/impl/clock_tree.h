@@ -0,0 +1,403 @@
+/**
+ * @file
+ * Clock tree planner implementation
+ *
+ * @author Alexey Zhelonkin
+ * @date 2023
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_CLOCK_TREE_IMPL_COMMON_H
+#define ZHELE_CLOCK_TREE_IMPL_COMMON_H
+
+namespace Zhele::Clock
+{
+    namespace Private
+    {
+        const static ClockFrequenceT UsbClockFreq = 48000000;
+
+    #if defined (RCC_PLLCFGR_PLLREN)
+        // stm32l4: HSE / M -> VCO (x N) -> / R system clock, / Q 48 MHz clock. Flash wait states for voltage range 1
+        constexpr ClockLimits Limits {80000000, 80000000, 80000000, 16000000, 4};
+
+        constexpr bool FindPll(ClockFrequenceT hse, ClockFrequenceT sysClock, bool usb, ClockPlan& plan)
+        {
+            for(uint8_t m = 1; m <= 8; ++m)
+            {
+                if(hse < 4000000ull * m || hse > 16000000ull * m)
+                    continue;
+
+                for(uint8_t r = 2; r <= 8; r += 2)
+                {
+                    uint64_t vco = static_cast<uint64_t>(sysClock) * r;
+                    if(vco < 64000000 || vco > 344000000 || (vco * m) % hse != 0)
+                        continue;
+                    uint64_t n = vco * m / hse;
+                    if(n < 8 || n > 86)
+                        continue;
+
+                    uint8_t q = 0;
+                    for(uint8_t divider = 2; divider <= 8 && q == 0; divider += 2)
+                    {
+                        if(vco == static_cast<uint64_t>(UsbClockFreq) * divider)
+                            q = divider;
+                    }
+                    if(usb && q == 0)
+                        continue;
+
+                    plan.PllM = m;
+                    plan.PllN = n;
+                    plan.PllP = r;
+                    plan.PllQ = q;
+                    plan.UsbClock = q != 0 ? vco / q : 0;
+                    return true;
+                }
+            }
+            return false;
+        }
+    #elif defined (RCC_PLLCFGR_PLLM)
+        // stm32f4: HSE / M -> VCO (x N) -> / P system clock, / Q 48 MHz clock. Flash wait states for 2.7...3.6 V supply
+        constexpr ClockLimits Limits {180000000, 45000000, 90000000, 30000000, 7};
+
+        constexpr bool FindPll(ClockFrequenceT hse, ClockFrequenceT sysClock, bool usb, ClockPlan& plan)
+        {
+            // Lowest M gives highest VCO input frequence (lowest PLL jitter)
+            for(uint8_t m = 2; m <= 63; ++m)
+            {
+                if(hse < 1000000ull * m || hse > 2000000ull * m)
+                    continue;
+
+                for(uint8_t p = 2; p <= 8; p += 2)
+                {
+                    uint64_t vco = static_cast<uint64_t>(sysClock) * p;
+                    if(vco < 100000000 || vco > 432000000 || (vco * m) % hse != 0)
+                        continue;
+                    uint64_t n = vco * m / hse;
+                    if(n < 50 || n > 432)
+                        continue;
+                    if(usb && vco % UsbClockFreq != 0)
+                        continue;
+
+                    // 48 MHz clock should not exceed 48 MHz even if USB is not used
+                    uint64_t q = (vco + UsbClockFreq - 1) / UsbClockFreq;
+                    if(q < 2)
+                        q = 2;
+                    if(q > 15)
+                    {
+                        if(usb)
+                            continue;
+                        q = 15;
+                    }
+
+                    plan.PllM = m;
+                    plan.PllN = n;
+                    plan.PllP = p;
+                    plan.PllQ = q;
+                    plan.UsbClock = vco / q;
+                    return true;
+                }
+            }
+            return false;
+        }
+    #else
+        // stm32f0/f1: HSE / PREDIV -> x PLLMUL system clock
+    #if defined (RCC_CFGR_PLLMULL)
+        constexpr ClockLimits Limits {72000000, 36000000, 72000000, 24000000, 2};
+    #else
+        constexpr ClockLimits Limits {48000000, 48000000, 48000000, 24000000, 1};
+    #endif
+    #if defined (RCC_CFGR2_PREDIV) || defined (RCC_CFGR2_PREDIV1)
+        const static uint8_t MaxPllInputDivider = 16;
+    #else
+        const static uint8_t MaxPllInputDivider = 2;
+    #endif
+    #if defined (RCC_CFGR2_PREDIV1)
+        const static uint8_t MinPllMultiplier = 4;
+        const static uint8_t MaxPllMultiplier = 9;
+    #else
+        const static uint8_t MinPllMultiplier = 2;
+        const static uint8_t MaxPllMultiplier = 16;
+    #endif
+
+        constexpr bool FindPll(ClockFrequenceT hse, ClockFrequenceT sysClock, bool usb, ClockPlan& plan)
+        {
+            if(sysClock < 16000000)
+                return false;
+
+            for(uint8_t divider = 1; divider <= MaxPllInputDivider; ++divider)
+            {
+                if(hse < 1000000ull * divider || hse > 25000000ull * divider)
+                    continue;
+
+                uint64_t multiplier = static_cast<uint64_t>(sysClock) * divider / hse;
+                if(static_cast<uint64_t>(sysClock) * divider % hse != 0
+                    || multiplier < MinPllMultiplier || multiplier > MaxPllMultiplier)
+                    continue;
+
+                // USB clock is 2 * PLL / Q: Q = 2 is USB prescaler 1, Q = 3 is prescaler 1.5
+                uint8_t q = 0;
+            #if defined (RCC_CFGR_USBPRE) || defined (RCC_CFGR_OTGFSPRE)
+                if(2ull * sysClock == 2ull * UsbClockFreq)
+                    q = 2;
+                else if(2ull * sysClock == 3ull * UsbClockFreq)
+                    q = 3;
+            #elif defined (RCC_CFGR3_USBSW)
+                if(sysClock == UsbClockFreq)
+                    q = 2;
+            #endif
+                if(usb && q == 0)
+                    return false;
+
+                plan.PllM = divider;
+                plan.PllN = multiplier;
+                plan.PllP = 1;
+                plan.PllQ = q;
+                plan.UsbClock = q != 0 ? 2ull * sysClock / q : 0;
+                return true;
+            }
+            return false;
+        }
+    #endif
+
+        constexpr uint8_t ApbDivider(ClockFrequenceT clock, ClockFrequenceT max)
+        {
+            uint8_t divider = 1;
+            while(divider < 16 && clock / divider > max)
+                divider *= 2;
+            return divider;
+        }
+
+        constexpr uint32_t ApbPrescalerCode(uint8_t divider)
+        {
+            // 0xx - not divided, 100 - /2, 101 - /4, 110 - /8, 111 - /16
+            uint32_t code = 3;
+            for(uint8_t value = divider; value > 1; value >>= 1)
+                ++code;
+            return divider == 1 ? 0 : code;
+        }
+
+        constexpr ClockPlan PlanClockTree(ClockFrequenceT hse, ClockFrequenceT sysClock, bool usb, ClockFrequenceT maxApb1, ClockFrequenceT maxApb2)
+        {
+            ClockPlan plan {};
+            if(sysClock > Limits.MaxSysClock)
+            {
+                plan.Error = ClockPlanError::SysClockTooHigh;
+                return plan;
+            }
+
+            if(!FindPll(hse, sysClock, usb, plan))
+            {
+                ClockPlan withoutUsb {};
+                plan.Error = usb && FindPll(hse, sysClock, false, withoutUsb)
+                    ? ClockPlanError::NoUsbConfiguration
+                    : ClockPlanError::NoPllConfiguration;
+                return plan;
+            }
+
+            plan.Error = ClockPlanError::None;
+            plan.SysClock = sysClock;
+            plan.Apb1Divider = ApbDivider(sysClock, maxApb1 != 0 ? maxApb1 : Limits.MaxApb1Clock);
+        #if defined (RCC_CFGR_PPRE2_Pos)
+            plan.Apb2Divider = ApbDivider(sysClock, maxApb2 != 0 ? maxApb2 : Limits.MaxApb2Clock);
+        #else
+            plan.Apb2Divider = plan.Apb1Divider;
+        #endif
+            plan.Apb1Clock = sysClock / plan.Apb1Divider;
+            plan.Apb2Clock = sysClock / plan.Apb2Divider;
+            plan.FlashLatency = (sysClock - 1) / Limits.FlashWaitStateStep;
+            return plan;
+        }
+    }
+
+    #define CLOCKTREE_TEMPLATE_ARGS template<ClockFrequenceT _SysClockFreq, bool _Usb, ClockFrequenceT _HseFreq, ClockFrequenceT _MaxApb1Freq, ClockFrequenceT _MaxApb2Freq>
+    #define CLOCKTREE_TEMPLATE_QUALIFIER ClockTree<_SysClockFreq, _Usb, _HseFreq, _MaxApb1Freq, _MaxApb2Freq>
+
+    CLOCKTREE_TEMPLATE_ARGS
+    volatile bool CLOCKTREE_TEMPLATE_QUALIFIER::_ready = false;
+
+    CLOCKTREE_TEMPLATE_ARGS
+    typename CLOCKTREE_TEMPLATE_QUALIFIER::Callback CLOCKTREE_TEMPLATE_QUALIFIER::_callback = nullptr;
+
+    CLOCKTREE_TEMPLATE_ARGS
+    bool CLOCKTREE_TEMPLATE_QUALIFIER::Init()
+    {
+        SwitchToResetClock();
+        if(!HseClock::Enable())
+            return false;
+
+        ConfigurePll();
+        if(!PllClock::Enable())
+            return false;
+
+        _ready = SwitchToPll();
+        return _ready;
+    }
+
+    CLOCKTREE_TEMPLATE_ARGS
+    void CLOCKTREE_TEMPLATE_QUALIFIER::InitAsync(Callback callback, bool useInterrupt)
+    {
+        _callback = callback;
+        _ready = false;
+        SwitchToResetClock();
+        // PLL is configured before its source is ready, it is enabled by HSE ready event
+        ConfigurePll();
+        ClearReadyFlags();
+
+        if(useInterrupt)
+        {
+        #if defined (RCC_CIER_HSERDYIE)
+            RCC->CIER |= RCC_CIER_HSERDYIE | RCC_CIER_PLLRDYIE;
+        #else
+            RCC->CIR |= RCC_CIR_HSERDYIE | RCC_CIR_PLLRDYIE;
+        #endif
+            Nvic::EnableIrq<RCC_IRQn>();
+        }
+
+        RCC->CR |= RCC_CR_HSEON;
+    }
+
+    CLOCKTREE_TEMPLATE_ARGS
+    bool CLOCKTREE_TEMPLATE_QUALIFIER::Ready()
+    {
+        return _ready;
+    }
+
+    CLOCKTREE_TEMPLATE_ARGS
+    void CLOCKTREE_TEMPLATE_QUALIFIER::Poll()
+    {
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+
+        bool switched = false;
+        if(!_ready)
+        {
+            uint32_t cr = RCC->CR;
+            if((cr & RCC_CR_HSERDY) && !(cr & RCC_CR_PLLON))
+                RCC->CR |= RCC_CR_PLLON;
+
+            if(cr & RCC_CR_PLLRDY)
+            {
+            #if defined (RCC_CIER_HSERDYIE)
+                RCC->CIER &= ~(RCC_CIER_HSERDYIE | RCC_CIER_PLLRDYIE);
+            #else
+                RCC->CIR &= ~(RCC_CIR_HSERDYIE | RCC_CIR_PLLRDYIE);
+            #endif
+                _ready = switched = SwitchToPll();
+            }
+        }
+        ClearReadyFlags();
+        __set_PRIMASK(primask);
+
+        if(switched && _callback)
+            _callback();
+    }
+
+    CLOCKTREE_TEMPLATE_ARGS
+    void CLOCKTREE_TEMPLATE_QUALIFIER::IrqHandler()
+    {
+        Poll();
+    }
+
+    CLOCKTREE_TEMPLATE_ARGS
+    bool CLOCKTREE_TEMPLATE_QUALIFIER::SwitchToResetClock()
+    {
+        static_assert(Plan.FlashLatency <= Private::Limits.MaxFlashLatency, "Flash latency is out of range");
+
+        // PLL cannot be reconfigured while it is system clock, so switch to reset clock source (HSI, MSI for stm32l4)
+        RCC->CFGR &= ~RCC_CFGR_SW;
+        uint32_t timeout = 10000;
+        while ((RCC->CFGR & RCC_CFGR_SWS) != 0 && --timeout)
+            continue;
+        PllClock::Disable();
+        return timeout != 0;
+    }
+
+    CLOCKTREE_TEMPLATE_ARGS
+    void CLOCKTREE_TEMPLATE_QUALIFIER::ConfigurePll()
+    {
+    #if defined (RCC_PLLCFGR_PLLREN)
+        RCC->PLLCFGR = RCC_PLLCFGR_PLLSRC_HSE
+            | ((Plan.PllM - 1) << RCC_PLLCFGR_PLLM_Pos)
+            | (Plan.PllN << RCC_PLLCFGR_PLLN_Pos)
+            | (((Plan.PllP >> 1) - 1) << RCC_PLLCFGR_PLLR_Pos)
+            | RCC_PLLCFGR_PLLREN
+            | (_Usb ? ((((Plan.PllQ >> 1) - 1) << RCC_PLLCFGR_PLLQ_Pos) | RCC_PLLCFGR_PLLQEN) : 0);
+        if constexpr (_Usb)
+            RCC->CCIPR = (RCC->CCIPR & ~RCC_CCIPR_CLK48SEL) | RCC_CCIPR_CLK48SEL_1;
+    #elif defined (RCC_PLLCFGR_PLLM)
+        RCC->PLLCFGR = RCC_PLLCFGR_PLLSRC_HSE
+            | (Plan.PllM << RCC_PLLCFGR_PLLM_Pos)
+            | (Plan.PllN << RCC_PLLCFGR_PLLN_Pos)
+            | (((Plan.PllP >> 1) - 1) << RCC_PLLCFGR_PLLP_Pos)
+            | (Plan.PllQ << RCC_PLLCFGR_PLLQ_Pos)
+        #if defined (RCC_PLLCFGR_PLLR)
+            | (RCC->PLLCFGR & RCC_PLLCFGR_PLLR)
+        #endif
+            ;
+    #else
+    #if defined (RCC_CFGR_PLLMULL)
+        uint32_t cfgr = RCC->CFGR & ~(RCC_CFGR_PLLMULL | RCC_CFGR_PLLSRC);
+        cfgr |= ((Plan.PllN - 2) << RCC_CFGR_PLLMULL_Pos) | RCC_CFGR_PLLSRC;
+    #else
+        uint32_t cfgr = RCC->CFGR & ~(RCC_CFGR_PLLMUL | RCC_CFGR_PLLSRC);
+        cfgr |= ((Plan.PllN - 2) << RCC_CFGR_PLLMUL_Pos) | RCC_CFGR_PLLSRC_HSE_PREDIV;
+    #endif
+    #if defined (RCC_CFGR2_PREDIV)
+        RCC->CFGR2 = (RCC->CFGR2 & ~RCC_CFGR2_PREDIV) | (Plan.PllM - 1);
+    #elif defined (RCC_CFGR2_PREDIV1)
+        RCC->CFGR2 = (RCC->CFGR2 & ~(RCC_CFGR2_PREDIV1 | RCC_CFGR2_PREDIV1SRC)) | ((Plan.PllM - 1) << RCC_CFGR2_PREDIV1_Pos);
+    #else
+        cfgr = (cfgr & ~RCC_CFGR_PLLXTPRE) | (Plan.PllM == 2 ? RCC_CFGR_PLLXTPRE : 0);
+    #endif
+    #if defined (RCC_CFGR_USBPRE)
+        cfgr = (cfgr & ~RCC_CFGR_USBPRE) | (Plan.PllQ == 2 ? RCC_CFGR_USBPRE : 0);
+    #elif defined (RCC_CFGR_OTGFSPRE)
+        cfgr = (cfgr & ~RCC_CFGR_OTGFSPRE) | (Plan.PllQ == 2 ? RCC_CFGR_OTGFSPRE : 0);
+    #endif
+        RCC->CFGR = cfgr;
+    #if defined (RCC_CFGR3_USBSW)
+        if constexpr (_Usb)
+            RCC->CFGR3 |= RCC_CFGR3_USBSW_PLLCLK;
+    #endif
+    #endif
+    }
+
+    CLOCKTREE_TEMPLATE_ARGS
+    bool CLOCKTREE_TEMPLATE_QUALIFIER::SwitchToPll()
+    {
+        // Wait states are set before frequence increase
+        Flash::SetLatency(Plan.FlashLatency);
+    #if defined (FLASH_ACR_ICEN)
+        Flash::EnableArt();
+    #else
+        Flash::EnablePrefetch();
+    #endif
+
+    #if defined (RCC_CFGR_PPRE2_Pos)
+        RCC->CFGR = (RCC->CFGR & ~(RCC_CFGR_HPRE | RCC_CFGR_PPRE1 | RCC_CFGR_PPRE2))
+            | (Private::ApbPrescalerCode(Plan.Apb1Divider) << RCC_CFGR_PPRE1_Pos)
+            | (Private::ApbPrescalerCode(Plan.Apb2Divider) << RCC_CFGR_PPRE2_Pos);
+    #else
+        RCC->CFGR = (RCC->CFGR & ~(RCC_CFGR_HPRE | RCC_CFGR_PPRE))
+            | (Private::ApbPrescalerCode(Plan.Apb1Divider) << RCC_CFGR_PPRE_Pos);
+    #endif
+
+        RCC->CFGR = (RCC->CFGR & ~RCC_CFGR_SW) | RCC_CFGR_SW_PLL;
+        uint32_t timeout = 10000;
+        while ((RCC->CFGR & RCC_CFGR_SWS) != RCC_CFGR_SWS_PLL && --timeout)
+            continue;
+        return timeout != 0;
+    }
+
+    CLOCKTREE_TEMPLATE_ARGS
+    void CLOCKTREE_TEMPLATE_QUALIFIER::ClearReadyFlags()
+    {
+    #if defined (RCC_CICR_HSERDYC)
+        RCC->CICR = RCC_CICR_HSERDYC | RCC_CICR_PLLRDYC;
+    #else
+        RCC->CIR |= RCC_CIR_HSERDYC | RCC_CIR_PLLRDYC;
+    #endif
+    }
+}
+
+#endif //! ZHELE_CLOCK_TREE_IMPL_COMMON_H
@@ -0,0 +1,110 @@
+/**
+ * @file
+ * CRC methods implementation
+ *
+ * @author Alexey Zhelonkin
+ * @date 2023
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_CRC_IMPL_COMMON_H
+#define ZHELE_CRC_IMPL_COMMON_H
+
+namespace Zhele
+{
+    #define TABLECRC_TEMPLATE_ARGS template<typename _Type, unsigned _Width, _Type _Polynomial, _Type _Init, bool _Reflected>
+    #define TABLECRC_TEMPLATE_QUALIFIER TableCrc<_Type, _Width, _Polynomial, _Init, _Reflected>
+
+    TABLECRC_TEMPLATE_ARGS
+    _Type TABLECRC_TEMPLATE_QUALIFIER::Update(_Type crc, const void* data, size_t size)
+    {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        _Type value = _Type(crc << Shift);
+        for(size_t i = 0; i < size; ++i)
+        {
+            if constexpr (_Reflected)
+                value = _Type((value >> 8) ^ _table.Values[(value ^ bytes[i]) & 0xff]);
+            else
+                value = _Type((value << 8) ^ _table.Values[((value >> (Bits - 8)) ^ bytes[i]) & 0xff]);
+        }
+        return _Type(value >> Shift);
+    }
+
+    TABLECRC_TEMPLATE_ARGS
+    _Type TABLECRC_TEMPLATE_QUALIFIER::Calculate(const void* data, size_t size)
+    {
+        return Update(_Init, data, size);
+    }
+
+#if defined (CRC)
+    inline void HardwareCrc::Enable()
+    {
+        Clock::CrcClock::Enable();
+        Reset();
+    }
+
+    inline void HardwareCrc::Disable()
+    {
+        Clock::CrcClock::Disable();
+    }
+
+#if defined (CRC_CR_POLYSIZE)
+    inline void HardwareCrc::Configure(PolySize size, uint32_t polynomial, uint32_t initial, bool reflected)
+    {
+        CRC->POL = polynomial;
+        CRC->INIT = initial;
+        CRC->CR = static_cast<uint32_t>(size) | (reflected ? (CRC_CR_REV_IN_0 | CRC_CR_REV_OUT) : 0);
+        Reset();
+    }
+#endif
+
+    inline void HardwareCrc::Reset()
+    {
+        CRC->CR |= CRC_CR_RESET;
+    }
+
+    inline uint32_t HardwareCrc::Update(const uint32_t* data, size_t count)
+    {
+        for(size_t i = 0; i < count; ++i)
+            CRC->DR = data[i];
+        return CRC->DR;
+    }
+
+#if defined (CRC_CR_REV_IN)
+    inline uint32_t HardwareCrc::Update(const uint8_t* data, size_t size)
+    {
+        for(size_t i = 0; i < size; ++i)
+            *reinterpret_cast<volatile uint8_t*>(&CRC->DR) = data[i];
+        return CRC->DR;
+    }
+#endif
+
+    template<typename _DmaChannel>
+    void HardwareCrc::UpdateAsync(const uint32_t* data, size_t count, TransferCallback callback)
+    {
+        _DmaChannel::ClearTransferComplete();
+        _DmaChannel::SetTransferCallback(callback);
+        // Memory to memory: "peripheral" address is source, memory address is destination
+        _DmaChannel::Transfer(_DmaChannel::Mem2Mem | _DmaChannel::PeriphIncrement | _DmaChannel::PSize32Bits | _DmaChannel::MSize32Bits,
+            const_cast<uint32_t*>(&CRC->DR), const_cast<uint32_t*>(data), count);
+    }
+
+#if defined (CRC_CR_REV_IN)
+    template<typename _DmaChannel>
+    void HardwareCrc::UpdateAsync(const uint8_t* data, size_t size, TransferCallback callback)
+    {
+        _DmaChannel::ClearTransferComplete();
+        _DmaChannel::SetTransferCallback(callback);
+        _DmaChannel::Transfer(_DmaChannel::Mem2Mem | _DmaChannel::PeriphIncrement | _DmaChannel::PSize8Bits | _DmaChannel::MSize8Bits,
+            const_cast<uint32_t*>(&CRC->DR), const_cast<uint8_t*>(data), size);
+    }
+#endif
+
+    inline uint32_t HardwareCrc::Value()
+    {
+        return CRC->DR;
+    }
+#endif
+}
+
+#endif //! ZHELE_CRC_IMPL_COMMON_H
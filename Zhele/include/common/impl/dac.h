@@ -110,6 +110,153 @@ namespace Zhele::Private
     {
         _Regs()->SWTRIGR = 1 << _Channel;
     }
+
+    DAC_TEMPLATE_ARGS
+    template <typename _DmaChannel>
+    void DAC_TEMPLATE_QUALIFIER::StartPingPong(uint16_t* buffer, uint16_t halfSize, TransferCallback callback)
+    {
+        _DmaChannel::SetTransferCallback(callback);
+        _DmaChannel::PingPongTransfer(DmaBase::Mem2Periph | DmaBase::MemIncrement | DmaBase::PriorityHigh | DmaBase::PSize16Bits | DmaBase::MSize16Bits,
+            buffer, _Channel == 0 ? &_Regs()->DHR12R1 : &_Regs()->DHR12R2, halfSize ONLY_IF_STREAM_SUPPORTED(COMMA DacDmaRequest<_Channel>::Value));
+        _Regs()->CR |= DAC_CR_DMAEN1 << (_Channel * ChannelOffset);
+    }
+
+    DAC_TEMPLATE_ARGS
+    template <typename _DmaChannel>
+    void DAC_TEMPLATE_QUALIFIER::StopPingPong()
+    {
+        _Regs()->CR &= ~(DAC_CR_DMAEN1 << (_Channel * ChannelOffset));
+        _DmaChannel::Disable();
+    }
+
+    DAC_TEMPLATE_ARGS
+    template <typename _DmaChannel, typename _Timer>
+    void DAC_TEMPLATE_QUALIFIER::StartStream(const uint16_t* buffer, uint16_t size, unsigned sampleRate, bool circular, TransferCallback callback)
+    {
+        _ClockCtrl::Enable();
+        SelectTimerTrigger<_Timer>();
+
+        if (circular)
+        {
+            StartPingPong<_DmaChannel>(const_cast<uint16_t*>(buffer), size / 2, callback);
+        }
+        else
+        {
+            _DmaChannel::SetTransferCallback(callback);
+            _DmaChannel::Transfer(DmaBase::Mem2Periph | DmaBase::MemIncrement | DmaBase::PriorityHigh | DmaBase::PSize16Bits | DmaBase::MSize16Bits,
+                buffer, _Channel == 0 ? &_Regs()->DHR12R1 : &_Regs()->DHR12R2, size ONLY_IF_STREAM_SUPPORTED(COMMA DacDmaRequest<_Channel>::Value));
+            _Regs()->CR |= DAC_CR_DMAEN1 << (_Channel * ChannelOffset);
+        }
+        Enable();
+
+        StartTriggerTimer<_Timer>(sampleRate);
+    }
+
+    DAC_TEMPLATE_ARGS
+    template <typename _Timer>
+    void DAC_TEMPLATE_QUALIFIER::SelectTimerTrigger()
+    {
+        _Regs()->CR = (_Regs()->CR & ~((DAC_CR_TSEL1 | DAC_CR_WAVE1_Msk) << (_Channel * ChannelOffset)))
+            | ((DAC_CR_TEN1 | (static_cast<uint32_t>(DacTimerTrigger<_Timer>::Value) << DAC_CR_TSEL1_Pos)) << (_Channel * ChannelOffset));
+    }
+
+    DAC_TEMPLATE_ARGS
+    template <typename _Timer>
+    void DAC_TEMPLATE_QUALIFIER::StartTriggerTimer(unsigned sampleRate)
+    {
+        unsigned divider = _Timer::GetClockFreq() / sampleRate;
+        unsigned prescaler = (divider - 1) / 0x10000;
+        _Timer::Enable();
+        _Timer::SetPrescaler(prescaler);
+        _Timer::SetPeriod(divider / (prescaler + 1) - 1);
+        _Timer::SetMasterMode(_Timer::MasterMode::Update);
+        _Timer::Start();
+    }
+
+    DAC_TEMPLATE_ARGS
+    template <typename _DmaChannel, typename _Timer>
+    void DAC_TEMPLATE_QUALIFIER::StopStream()
+    {
+        _Timer::Stop();
+        StopPingPong<_DmaChannel>();
+    }
+
+    #define DACDUAL_TEMPLATE_ARGS template <typename _Regs, typename _ClockCtrl>
+    #define DACDUAL_TEMPLATE_QUALIFIER DacDual<_Regs, _ClockCtrl>
+
+    DACDUAL_TEMPLATE_ARGS
+    template <typename Trigger>
+    void DACDUAL_TEMPLATE_QUALIFIER::Init(Trigger trigger)
+    {
+        Channel1::Init(trigger);
+        Channel2::Init(trigger);
+    }
+
+    DACDUAL_TEMPLATE_ARGS
+    void DACDUAL_TEMPLATE_QUALIFIER::Enable()
+    {
+        _Regs()->CR |= DAC_CR_EN1 | DAC_CR_EN2;
+    }
+
+    DACDUAL_TEMPLATE_ARGS
+    void DACDUAL_TEMPLATE_QUALIFIER::Disable()
+    {
+        _Regs()->CR &= ~(DAC_CR_EN1 | DAC_CR_EN2);
+    }
+
+    DACDUAL_TEMPLATE_ARGS
+    void DACDUAL_TEMPLATE_QUALIFIER::Write(uint32_t data)
+    {
+        _Regs()->DHR12RD = data;
+    }
+
+    DACDUAL_TEMPLATE_ARGS
+    void DACDUAL_TEMPLATE_QUALIFIER::Write(uint16_t channel1, uint16_t channel2)
+    {
+        _Regs()->DHR12RD = Pack(channel1, channel2);
+    }
+
+    DACDUAL_TEMPLATE_ARGS
+    void DACDUAL_TEMPLATE_QUALIFIER::WriteU8(uint8_t channel1, uint8_t channel2)
+    {
+        _Regs()->DHR8RD = channel1 | (channel2 << 8);
+    }
+
+    DACDUAL_TEMPLATE_ARGS
+    void DACDUAL_TEMPLATE_QUALIFIER::CauseSoftwareTrigger()
+    {
+        _Regs()->SWTRIGR = DAC_SWTRIGR_SWTRIG1 | DAC_SWTRIGR_SWTRIG2;
+    }
+
+    DACDUAL_TEMPLATE_ARGS
+    template <typename _DmaChannel, typename _Timer>
+    void DACDUAL_TEMPLATE_QUALIFIER::StartStream(const uint32_t* buffer, uint16_t size, unsigned sampleRate, bool circular, TransferCallback callback)
+    {
+        _ClockCtrl::Enable();
+        Channel1::template SelectTimerTrigger<_Timer>();
+        Channel2::template SelectTimerTrigger<_Timer>();
+
+        // Channel 1 DMA request moves both samples, channel 2 is updated by the same trigger
+        DmaBase::Mode mode = DmaBase::Mem2Periph | DmaBase::MemIncrement | DmaBase::PriorityHigh | DmaBase::PSize32Bits | DmaBase::MSize32Bits;
+        _DmaChannel::SetTransferCallback(callback);
+        if (circular)
+            _DmaChannel::PingPongTransfer(mode, const_cast<uint32_t*>(buffer), &_Regs()->DHR12RD, size / 2 ONLY_IF_STREAM_SUPPORTED(COMMA DacDmaRequest<0>::Value));
+        else
+            _DmaChannel::Transfer(mode, buffer, &_Regs()->DHR12RD, size ONLY_IF_STREAM_SUPPORTED(COMMA DacDmaRequest<0>::Value));
+        _Regs()->CR = (_Regs()->CR & ~DAC_CR_DMAEN2) | DAC_CR_DMAEN1;
+
+        Enable();
+
+        Channel1::template StartTriggerTimer<_Timer>(sampleRate);
+    }
+
+    DACDUAL_TEMPLATE_ARGS
+    template <typename _DmaChannel, typename _Timer>
+    void DACDUAL_TEMPLATE_QUALIFIER::StopStream()
+    {
+        _Timer::Stop();
+        Channel1::template StopPingPong<_DmaChannel>();
+    }
 }
 
 #endif //! ZHELE_DAC_IMPL_COMMON_H
\ No newline at end of file
@@ -28,6 +28,14 @@ namespace Zhele
         }
     }
 
+    void DmaChannelData::NotifyBufferReady(void* buffer, unsigned bufferSize)
+    {
+        if(transferCallback)
+        {
+            transferCallback(buffer, bufferSize, true);
+        }
+    }
+
     #define DMACHANNEL_TEMPLATE_ARGS template<typename _Module, typename _ChannelRegs, unsigned _Channel, IRQn_Type _IRQNumber>
     #define DMACHANNEL_TEMPLATE_QUALIFIER DmaChannel<_Module, _ChannelRegs, _Channel, _IRQNumber>
 
@@ -35,7 +43,17 @@ namespace Zhele
     void DMACHANNEL_TEMPLATE_QUALIFIER::Transfer(Mode mode, const void* buffer, volatile void* periph, uint32_t bufferSize
     ONLY_IF_STREAM_SUPPORTED(COMMA uint8_t channel))
     {
-        _Module::Enable();
+    #if ZHELE_DMA_VALIDATION
+        if(!ValidateTransfer(mode, buffer, periph))
+        {
+            Data.data = const_cast<void*>(buffer);
+            Data.size = bufferSize;
+            ZHELE_STATISTICS_INCREMENT(Statistics, DmaCounter::Errors);
+            Data.NotifyError();
+            return;
+        }
+    #endif
+        _Module::template AcquireChannel<_Channel>();
         if(!TransferError())
         {
             while(!Ready())
@@ -59,7 +77,7 @@ namespace Zhele
     if(Data.transferCallback)
         mode = mode | DmaBase::TransferCompleteInterrupt | DmaBase::TransferErrorInterrupt;
 
-    NVIC_EnableIRQ(_IRQNumber);
+    Nvic::EnableIrq<_IRQNumber>();
 
     #if defined (DMA_CCR_EN)
         ONLY_IF_STREAM_SUPPORTED (_Module::template SetChannelSelect<_Channel> (channel));
@@ -69,12 +87,73 @@ namespace Zhele
         _ChannelRegs()->CR = mode | ((channel & 0x07) << 25) | DMA_SxCR_EN;
     #endif
     }
+
+    DMACHANNEL_TEMPLATE_ARGS
+    void DMACHANNEL_TEMPLATE_QUALIFIER::PingPongTransfer(Mode mode, void* buffer, volatile void* periph, uint32_t halfSize
+    ONLY_IF_STREAM_SUPPORTED(COMMA uint8_t channel))
+    {
+    #if defined(DMA_SxCR_DBM)
+        DoubleBufferTransfer(mode, buffer, static_cast<uint8_t*>(buffer) + halfSize * MemoryElementSize(mode), periph, halfSize, channel);
+    #else
+        Transfer(mode | Mode::Circular | Mode::HalfTransferInterrupt, buffer, periph, halfSize * 2 ONLY_IF_STREAM_SUPPORTED(COMMA channel));
+    #endif
+    }
+
+#if defined(DMA_SxCR_DBM)
+    DMACHANNEL_TEMPLATE_ARGS
+    void DMACHANNEL_TEMPLATE_QUALIFIER::DoubleBufferTransfer(Mode mode, const void* buffer0, const void* buffer1, volatile void* periph, uint32_t bufferSize, uint8_t channel)
+    {
+    #if ZHELE_DMA_VALIDATION
+        if(!ValidateTransfer(mode, buffer0, periph) || !ValidateTransfer(mode, buffer1, periph))
+        {
+            Data.data = const_cast<void*>(buffer0);
+            Data.size = bufferSize;
+            ZHELE_STATISTICS_INCREMENT(Statistics, DmaCounter::Errors);
+            Data.NotifyError();
+            return;
+        }
+    #endif
+        _Module::template AcquireChannel<_Channel>();
+        if(!TransferError())
+        {
+            while(!Ready())
+                ;
+        }
+        _ChannelRegs()->CR = 0;
+        _ChannelRegs()->NDTR = bufferSize;
+        _ChannelRegs()->PAR = reinterpret_cast<uint32_t>(periph);
+        _ChannelRegs()->M0AR = reinterpret_cast<uint32_t>(buffer0);
+        _ChannelRegs()->M1AR = reinterpret_cast<uint32_t>(buffer1);
+
+        Data.data = const_cast<void*>(buffer0);
+        Data.size = bufferSize;
+
+        mode = mode | Mode::Circular;
+        if(Data.transferCallback)
+            mode = mode | DmaBase::TransferCompleteInterrupt | DmaBase::TransferErrorInterrupt;
+
+        Nvic::EnableIrq<_IRQNumber>();
+
+        _ChannelRegs()->CR = mode | DMA_SxCR_DBM | ((channel & 0x07) << 25) | DMA_SxCR_EN;
+    }
+#endif
+
     DMACHANNEL_TEMPLATE_ARGS
     void DMACHANNEL_TEMPLATE_QUALIFIER::SetTransferCallback(TransferCallback callback)
     {
         Data.transferCallback = callback;
     }
 
+#if defined(DMA_SxFCR_DMDIS)
+    DMACHANNEL_TEMPLATE_ARGS
+    void DMACHANNEL_TEMPLATE_QUALIFIER::SetFifoMode(bool enable, FifoThreshold threshold, bool errorInterrupt)
+    {
+        _ChannelRegs()->FCR = enable
+            ? DMA_SxFCR_DMDIS | threshold | (errorInterrupt ? DMA_SxFCR_FEIE : 0)
+            : 0;
+    }
+#endif
+
     DMACHANNEL_TEMPLATE_ARGS
     bool DMACHANNEL_TEMPLATE_QUALIFIER::Ready()
     {
@@ -90,13 +169,15 @@ namespace Zhele
     DMACHANNEL_TEMPLATE_ARGS
     void DMACHANNEL_TEMPLATE_QUALIFIER::Enable()
     {
-        _ChannelRegs()->ONLY_FOR_CCR(CCR)ONLY_FOR_SXCR(CR) |= ONLY_FOR_CCR(DMA_CCR_EN)ONLY_FOR_SXCR(DMA_SxCR_EN);
+        _Module::template AcquireChannel<_Channel>();
+        BitBand::SetBits(_ChannelRegs()->ONLY_FOR_CCR(CCR)ONLY_FOR_SXCR(CR), ONLY_FOR_CCR(DMA_CCR_EN)ONLY_FOR_SXCR(DMA_SxCR_EN));
     }
 
     DMACHANNEL_TEMPLATE_ARGS
     void DMACHANNEL_TEMPLATE_QUALIFIER::Disable()
     {
-        _ChannelRegs()->ONLY_FOR_CCR(CCR)ONLY_FOR_SXCR(CR) &= ~ONLY_FOR_CCR(DMA_CCR_EN)ONLY_FOR_SXCR(DMA_SxCR_EN);
+        BitBand::ClearBits(_ChannelRegs()->ONLY_FOR_CCR(CCR)ONLY_FOR_SXCR(CR), ONLY_FOR_CCR(DMA_CCR_EN)ONLY_FOR_SXCR(DMA_SxCR_EN));
+        _Module::template ReleaseChannel<_Channel>();
     }
 
     DMACHANNEL_TEMPLATE_ARGS
@@ -174,26 +255,88 @@ namespace Zhele
     DMACHANNEL_TEMPLATE_ARGS
     void DMACHANNEL_TEMPLATE_QUALIFIER::IrqHandler()
     {
+        ZHELE_TRACE_SCOPE(Trace::Event::DmaIrqEnter, Trace::Event::DmaIrqExit, reinterpret_cast<uintptr_t>(_ChannelRegs::Get()));
+        uint32_t control = _ChannelRegs()->ONLY_FOR_CCR(CCR)ONLY_FOR_SXCR(CR);
+
+        if(HalfTransfer())
+        {
+            ClearHalfTransfer();
+
+            if((control & Mode::HalfTransferInterrupt) != 0 ONLY_FOR_SXCR(&& (control & DMA_SxCR_DBM) == 0))
+                Data.NotifyBufferReady(Data.data, Data.size / 2);
+        }
         if(TransferComplete())
         {
             ClearFlags();
-            
-            if(static_cast<uint32_t>(_ChannelRegs()->ONLY_FOR_CCR(CCR)ONLY_FOR_SXCR(CR) & Mode::Circular) == 0)
+            ZHELE_STATISTICS_INCREMENT(Statistics, DmaCounter::Transfers);
+
+            if(static_cast<uint32_t>(control & Mode::Circular) == 0)
                 Disable();
 
-            Data.NotifyTransferComplete();
+        #if defined(DMA_SxCR_DBM)
+            if((control & DMA_SxCR_DBM) != 0)
+            {
+                // CT bit points to buffer which is used by DMA now, so other buffer is ready.
+                Data.NotifyBufferReady(reinterpret_cast<void*>((control & DMA_SxCR_CT) != 0
+                    ? _ChannelRegs()->M0AR
+                    : _ChannelRegs()->M1AR), Data.size);
+            }
+            else
+        #endif
+            if((control & Mode::HalfTransferInterrupt) != 0)
+            {
+                unsigned half = Data.size / 2;
+                Data.NotifyBufferReady(static_cast<uint8_t*>(Data.data) + half * MemoryElementSize(control), Data.size - half);
+            }
+            else
+            {
+                Data.NotifyTransferComplete();
+            }
         }
         if(TransferError())
         {
             ClearFlags();
+            ZHELE_STATISTICS_INCREMENT(Statistics, DmaCounter::Errors);
 
             if(static_cast<uint32_t>(_ChannelRegs()->ONLY_FOR_CCR(CCR)ONLY_FOR_SXCR(CR) & Mode::Circular) == 0)
                 Disable();
 
             Data.NotifyError();
         }
+    #if defined(DMA_SxFCR_FEIE)
+        // FIFO error (enabled by SetFifoMode) does not stop stream, it is counted only
+        if(_Module::template FifoError<_Channel>())
+        {
+            _Module::template ClearFifoError<_Channel>();
+            ZHELE_STATISTICS_INCREMENT(Statistics, DmaCounter::Errors);
+        }
+    #endif
     }
 
+    DMACHANNEL_TEMPLATE_ARGS
+    unsigned DMACHANNEL_TEMPLATE_QUALIFIER::MemoryElementSize(uint32_t mode)
+    {
+        return 1 << ((mode & (Mode::MSize16Bits | Mode::MSize32Bits)) >> ONLY_FOR_CCR(DMA_CCR_MSIZE_Pos)ONLY_FOR_SXCR(DMA_SxCR_MSIZE_Pos));
+    }
+
+#if ZHELE_DMA_VALIDATION
+    DMACHANNEL_TEMPLATE_ARGS
+    bool DMACHANNEL_TEMPLATE_QUALIFIER::ValidateTransfer(uint32_t mode, const void* buffer, volatile void* periph)
+    {
+        uint32_t memory = reinterpret_cast<uint32_t>(buffer);
+        uint32_t peripheral = reinterpret_cast<uint32_t>(periph);
+        unsigned periphElementSize = 1 << ((mode & (Mode::PSize16Bits | Mode::PSize32Bits)) >> ONLY_FOR_CCR(DMA_CCR_PSIZE_Pos)ONLY_FOR_SXCR(DMA_SxCR_PSIZE_Pos));
+        if(memory % MemoryElementSize(mode) != 0 || peripheral % periphElementSize != 0)
+            return false;
+    #if defined (CCMDATARAM_BASE)
+        // CCM is connected to core D-bus only (see ZHELE_CCMDATA and ZHELE_DMADATA)
+        if(memory - CCMDATARAM_BASE < 0x10000 || peripheral - CCMDATARAM_BASE < 0x10000)
+            return false;
+    #endif
+        return true;
+    }
+#endif
+
     #define DMAMODULE_TEMPLATE_ARGS template<typename _DmaRegs, typename _Clock, unsigned _Channels>
     #define DMAMODULE_TEMPLATE_QUALIFIER DmaModule<_DmaRegs, _Clock, _Channels>
 
@@ -229,25 +372,26 @@ namespace Zhele
     template<int ChannelNum, typename DMAMODULE_TEMPLATE_QUALIFIER::Flags FlagMask>
     void DMAMODULE_TEMPLATE_QUALIFIER::ClearChannelFlag()
     {
+        // Flag clear registers are write-only (write 1 to clear), so flags are cleared by plain store
     #if defined(DMA_CCR_EN)
-        _DmaRegs()->IFCR |= (static_cast<uint32_t>(FlagMask) << ((ChannelNum - 1) * 4));
+        _DmaRegs()->IFCR = (static_cast<uint32_t>(FlagMask) << ((ChannelNum - 1) * 4));
     #endif
     #if defined(DMA_SxCR_EN)
         if constexpr(ChannelNum <= 1)
         {
-            _DmaRegs()->LIFCR |= (static_cast<uint32_t>(FlagMask) << (ChannelNum * 6));
+            _DmaRegs()->LIFCR = (static_cast<uint32_t>(FlagMask) << (ChannelNum * 6));
         }
         if constexpr(2 <= ChannelNum && ChannelNum <= 3)
         {
-            _DmaRegs()->LIFCR |= (static_cast<uint32_t>(FlagMask) << (4 + ChannelNum * 6));
+            _DmaRegs()->LIFCR = (static_cast<uint32_t>(FlagMask) << (4 + ChannelNum * 6));
         }
         if constexpr(4 <= ChannelNum && ChannelNum <= 5)
         {
-            _DmaRegs()->HIFCR |= (static_cast<uint32_t>(FlagMask) << ((ChannelNum - 4) * 6));
+            _DmaRegs()->HIFCR = (static_cast<uint32_t>(FlagMask) << ((ChannelNum - 4) * 6));
         }
         if constexpr(6 <= ChannelNum && ChannelNum <= 7)
         {
-            _DmaRegs()->HIFCR |= (static_cast<uint32_t>(FlagMask) << (4 + (ChannelNum - 4) * 6));
+            _DmaRegs()->HIFCR = (static_cast<uint32_t>(FlagMask) << (4 + (ChannelNum - 4) * 6));
         }
     #endif
     }
@@ -361,6 +505,45 @@ namespace Zhele
         _Clock::Disable();
     }
 
+#if defined (ZHELE_DMA_AUTO_GATING)
+    DMAMODULE_TEMPLATE_ARGS
+    volatile uint16_t DMAMODULE_TEMPLATE_QUALIFIER::_activeChannels = 0;
+#endif
+
+    DMAMODULE_TEMPLATE_ARGS
+    template<int ChannelNum>
+    void DMAMODULE_TEMPLATE_QUALIFIER::AcquireChannel()
+    {
+    #if defined (ZHELE_DMA_AUTO_GATING)
+        uint32_t state = DriverCriticalSection::Enter();
+        if((_activeChannels & (1u << ChannelNum)) == 0)
+        {
+            _activeChannels = _activeChannels | (1u << ChannelNum);
+            _Clock::Acquire();
+        }
+        DriverCriticalSection::Leave(state);
+        // See note.
+        DmaDummy();
+    #else
+        Enable();
+    #endif
+    }
+
+    DMAMODULE_TEMPLATE_ARGS
+    template<int ChannelNum>
+    void DMAMODULE_TEMPLATE_QUALIFIER::ReleaseChannel()
+    {
+    #if defined (ZHELE_DMA_AUTO_GATING)
+        uint32_t state = DriverCriticalSection::Enter();
+        if((_activeChannels & (1u << ChannelNum)) != 0)
+        {
+            _activeChannels = _activeChannels & ~(1u << ChannelNum);
+            _Clock::Release();
+        }
+        DriverCriticalSection::Leave(state);
+    #endif
+    }
+
     #if defined (DMA_CSELR_C1S)
         DMAMODULE_TEMPLATE_ARGS
         template<uint8_t channel>
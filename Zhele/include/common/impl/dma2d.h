@@ -0,0 +1,127 @@
+/**
+ * @file
+ * DMA2D methods implementation
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DMA2D_IMPL_COMMON_H
+#define ZHELE_DMA2D_IMPL_COMMON_H
+
+#if defined (DMA2D)
+namespace Zhele
+{
+    namespace Private
+    {
+        // CR MODE field values
+        static constexpr uint32_t Dma2DMemoryToMemory = 0 << 16;
+        static constexpr uint32_t Dma2DMemoryToMemoryPfc = 1 << 16;
+        static constexpr uint32_t Dma2DMemoryToMemoryBlend = 2 << 16;
+        static constexpr uint32_t Dma2DRegisterToMemory = 3 << 16;
+
+        // FGPFCCR/BGPFCCR fields
+        static constexpr unsigned Dma2DAlphaModePos = 16;
+        static constexpr unsigned Dma2DAlphaPos = 24;
+        static constexpr uint32_t Dma2DAlphaMultiply = 2;
+    }
+
+    inline Dma2D::CompleteCallback Dma2D::_callback = nullptr;
+
+    inline void Dma2D::Init()
+    {
+        Clock::Dma2DClock::Enable();
+    }
+
+    inline void Dma2D::Fill(const Area& destination, uint16_t width, uint16_t height, uint32_t color, CompleteCallback callback)
+    {
+        Wait();
+        SetOutput(destination, width, height);
+        DMA2D->OCOLR = color;
+        Start(Private::Dma2DRegisterToMemory, callback);
+    }
+
+    inline void Dma2D::Copy(const Area& source, const Area& destination, uint16_t width, uint16_t height, CompleteCallback callback)
+    {
+        Wait();
+        SetOutput(destination, width, height);
+        DMA2D->FGMAR = reinterpret_cast<uint32_t>(source.Address);
+        DMA2D->FGOR = source.LineOffset;
+        // Transfer size depends on foreground format
+        DMA2D->FGPFCCR = static_cast<uint32_t>(destination.Mode);
+        Start(Private::Dma2DMemoryToMemory, callback);
+    }
+
+    inline void Dma2D::Convert(const Area& source, const Area& destination, uint16_t width, uint16_t height, uint32_t color, CompleteCallback callback)
+    {
+        Wait();
+        SetOutput(destination, width, height);
+        DMA2D->FGMAR = reinterpret_cast<uint32_t>(source.Address);
+        DMA2D->FGOR = source.LineOffset;
+        DMA2D->FGPFCCR = static_cast<uint32_t>(source.Mode);
+        DMA2D->FGCOLR = color;
+        Start(Private::Dma2DMemoryToMemoryPfc, callback);
+    }
+
+    inline void Dma2D::Blend(const Area& foreground, const Area& background, const Area& destination,
+        uint16_t width, uint16_t height, uint8_t alpha, uint32_t color, CompleteCallback callback)
+    {
+        Wait();
+        SetOutput(destination, width, height);
+        DMA2D->FGMAR = reinterpret_cast<uint32_t>(foreground.Address);
+        DMA2D->FGOR = foreground.LineOffset;
+        DMA2D->FGPFCCR = static_cast<uint32_t>(foreground.Mode)
+            | (Private::Dma2DAlphaMultiply << Private::Dma2DAlphaModePos)
+            | (static_cast<uint32_t>(alpha) << Private::Dma2DAlphaPos);
+        DMA2D->FGCOLR = color;
+        DMA2D->BGMAR = reinterpret_cast<uint32_t>(background.Address);
+        DMA2D->BGOR = background.LineOffset;
+        DMA2D->BGPFCCR = static_cast<uint32_t>(background.Mode);
+        Start(Private::Dma2DMemoryToMemoryBlend, callback);
+    }
+
+    inline bool Dma2D::Busy()
+    {
+        return DMA2D->CR & DMA2D_CR_START;
+    }
+
+    inline void Dma2D::Wait()
+    {
+        while(Busy()) continue;
+    }
+
+    inline void Dma2D::IrqHandler()
+    {
+        if(!(DMA2D->ISR & DMA2D_ISR_TCIF))
+            return;
+        DMA2D->IFCR = DMA2D_IFCR_CTCIF;
+        DMA2D->CR &= ~DMA2D_CR_TCIE;
+
+        CompleteCallback callback = _callback;
+        _callback = nullptr;
+        if(callback != nullptr)
+            callback();
+    }
+
+    inline void Dma2D::SetOutput(const Area& destination, uint16_t width, uint16_t height)
+    {
+        DMA2D->OMAR = reinterpret_cast<uint32_t>(destination.Address);
+        DMA2D->OOR = destination.LineOffset;
+        DMA2D->OPFCCR = static_cast<uint32_t>(destination.Mode);
+        // Pixels per line (PL) and lines count (NL)
+        DMA2D->NLR = (static_cast<uint32_t>(width) << 16) | height;
+    }
+
+    inline void Dma2D::Start(uint32_t mode, CompleteCallback callback)
+    {
+        DMA2D->IFCR = DMA2D_IFCR_CTCIF;
+        _callback = callback;
+        if(callback != nullptr)
+            Nvic::EnableIrq<DMA2D_IRQn>();
+        DMA2D->CR = mode | (callback != nullptr ? DMA2D_CR_TCIE : 0) | DMA2D_CR_START;
+    }
+}
+#endif
+
+#endif //! ZHELE_DMA2D_IMPL_COMMON_H
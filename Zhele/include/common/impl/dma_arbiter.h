@@ -0,0 +1,105 @@
+/**
+ * @file
+ * DMA channel arbiter methods implementation
+ *
+ * @author Alexey Zhelonkin
+ * @date 2023
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DMA_ARBITER_IMPL_COMMON_H
+#define ZHELE_DMA_ARBITER_IMPL_COMMON_H
+
+namespace Zhele
+{
+    #define DMAARBITER_TEMPLATE_ARGS template<typename _Channel, unsigned _QueueSize>
+    #define DMAARBITER_TEMPLATE_QUALIFIER DmaChannelArbiter<_Channel, _QueueSize>
+
+    DMAARBITER_TEMPLATE_ARGS
+    bool DMAARBITER_TEMPLATE_QUALIFIER::RequestChannel(const void* owner, DmaGrantCallback grant)
+    {
+        uint32_t state = DriverCriticalSection::Enter();
+        if(_owner == nullptr)
+        {
+            _owner = owner;
+            DriverCriticalSection::Leave(state);
+
+            if(grant)
+                grant();
+            return true;
+        }
+
+        bool queued = _requests.push_back(Request {owner, grant});
+        DriverCriticalSection::Leave(state);
+
+        return queued;
+    }
+
+    DMAARBITER_TEMPLATE_ARGS
+    bool DMAARBITER_TEMPLATE_QUALIFIER::TryAcquire(const void* owner)
+    {
+        uint32_t state = DriverCriticalSection::Enter();
+        bool acquired = _owner == nullptr;
+        if(acquired)
+            _owner = owner;
+        DriverCriticalSection::Leave(state);
+
+        return acquired;
+    }
+
+    DMAARBITER_TEMPLATE_ARGS
+    bool DMAARBITER_TEMPLATE_QUALIFIER::Release(const void* owner)
+    {
+        uint32_t state = DriverCriticalSection::Enter();
+        if(_owner != owner)
+        {
+            DriverCriticalSection::Leave(state);
+            return false;
+        }
+
+        _Channel::Disable();
+        _Channel::ClearFlags();
+        _Channel::SetTransferCallback(nullptr);
+
+        Request next;
+        bool hasNext = !_requests.empty();
+        if(hasNext)
+        {
+            next = _requests.front();
+            _requests.pop_front();
+        }
+        _owner = hasNext ? next.owner : nullptr;
+        DriverCriticalSection::Leave(state);
+
+        if(hasNext && next.grant)
+            next.grant();
+
+        return true;
+    }
+
+    DMAARBITER_TEMPLATE_ARGS
+    const void* DMAARBITER_TEMPLATE_QUALIFIER::Owner()
+    {
+        return _owner;
+    }
+
+    DMAARBITER_TEMPLATE_ARGS
+    bool DMAARBITER_TEMPLATE_QUALIFIER::OwnedBy(const void* owner)
+    {
+        return _owner == owner;
+    }
+
+    DMAARBITER_TEMPLATE_ARGS
+    bool DMAARBITER_TEMPLATE_QUALIFIER::Busy()
+    {
+        return _owner != nullptr;
+    }
+
+    DMAARBITER_TEMPLATE_ARGS
+    unsigned DMAARBITER_TEMPLATE_QUALIFIER::Pending()
+    {
+        return _requests.size();
+    }
+}
+
+#endif //! ZHELE_DMA_ARBITER_IMPL_COMMON_H
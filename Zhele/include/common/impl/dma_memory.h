@@ -0,0 +1,128 @@
+/**
+ * @file
+ * Memory-to-memory DMA methods implementation
+ *
+ * @author Alexey Zhelonkin
+ * @date 2023
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DMA_MEMORY_IMPL_COMMON_H
+#define ZHELE_DMA_MEMORY_IMPL_COMMON_H
+
+#include "../template_utils/type_list.h"
+
+namespace Zhele
+{
+    #define DMAMEMORY_TEMPLATE_ARGS template<typename... _Channels>
+    #define DMAMEMORY_TEMPLATE_QUALIFIER DmaMemory<_Channels...>
+
+    DMAMEMORY_TEMPLATE_ARGS
+    bool DMAMEMORY_TEMPLATE_QUALIFIER::CopyAsync(void* destination, const void* source, size_t size, TransferCallback callback)
+    {
+        return Start(destination, source, 0, size, callback);
+    }
+
+    DMAMEMORY_TEMPLATE_ARGS
+    bool DMAMEMORY_TEMPLATE_QUALIFIER::FillAsync(void* destination, uint8_t pattern, size_t size, TransferCallback callback)
+    {
+        return Start(destination, nullptr, pattern * 0x01010101u, size, callback);
+    }
+
+    DMAMEMORY_TEMPLATE_ARGS
+    bool DMAMEMORY_TEMPLATE_QUALIFIER::Busy()
+    {
+        return _busy != 0;
+    }
+
+    DMAMEMORY_TEMPLATE_ARGS
+    bool DMAMEMORY_TEMPLATE_QUALIFIER::Ready()
+    {
+        return _busy != (0xffffffffu >> (32 - sizeof...(_Channels)));
+    }
+
+    DMAMEMORY_TEMPLATE_ARGS
+    bool DMAMEMORY_TEMPLATE_QUALIFIER::Start(void* destination, const void* source, uint32_t pattern, size_t size, TransferCallback callback)
+    {
+        if(size == 0)
+        {
+            if(callback)
+                callback(destination, 0, true);
+            return true;
+        }
+
+        // Select widest transfer unit allowed by alignment of buffers and size
+        uintptr_t alignment = reinterpret_cast<uintptr_t>(destination) | reinterpret_cast<uintptr_t>(source) | size;
+        unsigned unitShift = (alignment & 0x03) == 0
+            ? 2
+            : (alignment & 0x01) == 0 ? 1 : 0;
+
+        if((size >> unitShift) > MaxTransferCount)
+            return false;
+
+        uint32_t state = DriverCriticalSection::Enter();
+        bool started = StartAny(std::make_index_sequence<sizeof...(_Channels)>{}, destination, source, pattern, size, unitShift, callback);
+        DriverCriticalSection::Leave(state);
+
+        return started;
+    }
+
+    DMAMEMORY_TEMPLATE_ARGS
+    template<size_t... _Indexes>
+    bool DMAMEMORY_TEMPLATE_QUALIFIER::StartAny(std::index_sequence<_Indexes...>, void* destination, const void* source, uint32_t pattern, size_t size, unsigned unitShift, const TransferCallback& callback)
+    {
+        return (TryStart<_Indexes>(destination, source, pattern, size, unitShift, callback) || ...);
+    }
+
+    DMAMEMORY_TEMPLATE_ARGS
+    template<unsigned _Index>
+    bool DMAMEMORY_TEMPLATE_QUALIFIER::TryStart(void* destination, const void* source, uint32_t pattern, size_t size, unsigned unitShift, const TransferCallback& callback)
+    {
+        using Channel = TemplateUtils::GetType_t<_Index, TemplateUtils::TypeList<_Channels...>>;
+        static const DmaBase::Mode MemorySizes[] = {DmaBase::MSize8Bits, DmaBase::MSize16Bits, DmaBase::MSize32Bits};
+        static const DmaBase::Mode PeriphSizes[] = {DmaBase::PSize8Bits, DmaBase::PSize16Bits, DmaBase::PSize32Bits};
+
+        const uint32_t mask = 1u << _Index;
+        if((_busy & mask) != 0)
+            return false;
+        _busy |= mask;
+
+        _callbacks[_Index] = callback;
+        _sizes[_Index] = size;
+
+        DmaBase::Mode mode = DmaBase::Mem2Mem | DmaBase::MemIncrement | MemorySizes[unitShift] | PeriphSizes[unitShift];
+        if(source != nullptr)
+        {
+            mode = mode | DmaBase::PeriphIncrement;
+        }
+        else
+        {
+            _patterns[_Index] = pattern;
+            source = &_patterns[_Index];
+        }
+
+        // In Mem2Mem mode source is periph, destination is memory
+        Channel::SetTransferCallback(TransferComplete<_Index>);
+        Channel::Transfer(mode, destination, const_cast<void*>(source), size >> unitShift);
+
+        return true;
+    }
+
+    DMAMEMORY_TEMPLATE_ARGS
+    template<unsigned _Index>
+    void DMAMEMORY_TEMPLATE_QUALIFIER::TransferComplete(void* data, unsigned size, bool success)
+    {
+        TransferCallback callback = _callbacks[_Index];
+        size_t transfered = _sizes[_Index];
+        _callbacks[_Index] = nullptr;
+
+        uint32_t state = DriverCriticalSection::Enter();
+        _busy &= ~(1u << _Index);
+        DriverCriticalSection::Leave(state);
+
+        if(callback)
+            callback(data, transfered, success);
+    }
+}
+
+#endif //! ZHELE_DMA_MEMORY_IMPL_COMMON_H
@@ -0,0 +1,291 @@
+/**
+ * @file
+ * Implements fixed-point DSP kernels
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DSP_IMPL_COMMON_H
+#define ZHELE_DSP_IMPL_COMMON_H
+
+#include <string.h>
+
+namespace Zhele::Dsp
+{
+    namespace Private
+    {
+        /**
+         * @brief Saturates value to _Bits signed bits (SSAT on Cortex-M3/M4)
+         */
+        template<unsigned _Bits>
+        inline int32_t Saturate(int32_t value)
+        {
+#if defined (__CORTEX_M) && (__CORTEX_M >= 3)
+            return __SSAT(value, _Bits);
+#else
+            const int32_t max = (1 << (_Bits - 1)) - 1;
+            return value > max ? max : (value < -max - 1 ? -max - 1 : value);
+#endif
+        }
+
+        /**
+         * @brief Saturates 64-bit value to 32 bits
+         */
+        inline int32_t Saturate32(int64_t value)
+        {
+            return value > INT32_MAX ? INT32_MAX : (value < INT32_MIN ? INT32_MIN : static_cast<int32_t>(value));
+        }
+
+        /**
+         * @brief Packs two Q15 values (first to low half)
+         */
+        inline uint32_t Pack(Q15 low, Q15 high)
+        {
+            return static_cast<uint16_t>(low) | (static_cast<uint32_t>(static_cast<uint16_t>(high)) << 16);
+        }
+
+        /**
+         * @brief Loads two adjacent Q15 values (unaligned load is allowed on Cortex-M3/M4)
+         */
+        inline uint32_t Load2(const Q15* data)
+        {
+            uint32_t value;
+            memcpy(&value, data, sizeof(value));
+            return value;
+        }
+
+        /**
+         * @brief Dual 16-bit multiply with 64-bit accumulate: acc + x.lo * y.lo + x.hi * y.hi
+         */
+        inline int64_t DualMacLong(uint32_t x, uint32_t y, int64_t acc)
+        {
+#if ZHELE_DSP_SIMD
+            return static_cast<int64_t>(__SMLALD(x, y, static_cast<uint64_t>(acc)));
+#else
+            return acc + static_cast<int32_t>(static_cast<int16_t>(x)) * static_cast<int16_t>(y)
+                + static_cast<int32_t>(static_cast<int16_t>(x >> 16)) * static_cast<int16_t>(y >> 16);
+#endif
+        }
+    }
+
+    constexpr Q15 ToQ15(double value, unsigned fractionBits)
+    {
+        double scaled = value * static_cast<double>(1ull << fractionBits);
+        scaled += scaled >= 0 ? 0.5 : -0.5;
+        return scaled >= 32767.0 ? 32767 : (scaled <= -32768.0 ? -32768 : static_cast<Q15>(scaled));
+    }
+
+    constexpr Q31 ToQ31(double value, unsigned fractionBits)
+    {
+        double scaled = value * static_cast<double>(1ull << fractionBits);
+        scaled += scaled >= 0 ? 0.5 : -0.5;
+        return scaled >= 2147483647.0 ? INT32_MAX : (scaled <= -2147483648.0 ? INT32_MIN : static_cast<Q31>(scaled));
+    }
+
+    template<unsigned _Bits>
+    void AdcToQ15(const uint16_t* input, Q15* output, unsigned count)
+    {
+        static_assert(_Bits > 0 && _Bits <= 16, "ADC resolution should be 1...16 bits");
+        for (unsigned i = 0; i < count; ++i)
+            output[i] = static_cast<Q15>((static_cast<int32_t>(input[i]) - (1 << (_Bits - 1))) << (16 - _Bits));
+    }
+
+    template<unsigned _Taps>
+    FirQ15<_Taps>::FirQ15(const Q15 (&coefficients)[_Taps])
+    {
+        // Window is in chronological order (the oldest sample first), so coefficients are reversed
+        for (unsigned i = 0; i < Length; ++i)
+            _coefficients[Length - 1 - i] = i < _Taps ? coefficients[i] : 0;
+        Reset();
+    }
+
+    template<unsigned _Taps>
+    void FirQ15<_Taps>::Reset()
+    {
+        for (unsigned i = 0; i < 2 * Length; ++i)
+            _history[i] = 0;
+        _index = 0;
+    }
+
+    template<unsigned _Taps>
+    void FirQ15<_Taps>::Push(Q15 sample)
+    {
+        if (++_index == Length)
+            _index = 0;
+        _history[_index] = sample;
+        _history[_index + Length] = sample;
+    }
+
+    template<unsigned _Taps>
+    Q15 FirQ15<_Taps>::Output() const
+    {
+        const Q15* window = &_history[_index + 1];
+        int64_t acc = 0;
+#if ZHELE_DSP_SIMD
+        for (unsigned i = 0; i < Length; i += 2)
+            acc = Private::DualMacLong(Private::Load2(&window[i]), Private::Load2(&_coefficients[i]), acc);
+#else
+        for (unsigned i = 0; i < Length; ++i)
+            acc += static_cast<int32_t>(window[i]) * _coefficients[i];
+#endif
+        return static_cast<Q15>(Private::Saturate<16>(Private::Saturate32((acc + (1 << 14)) >> 15)));
+    }
+
+    template<unsigned _Taps>
+    Q15 FirQ15<_Taps>::Process(Q15 sample)
+    {
+        Push(sample);
+        return Output();
+    }
+
+    template<unsigned _Taps>
+    void FirQ15<_Taps>::Process(const Q15* input, Q15* output, unsigned count)
+    {
+        for (unsigned i = 0; i < count; ++i)
+        {
+            Push(input[i]);
+            output[i] = Output();
+        }
+    }
+
+    template<unsigned _Taps, unsigned _Factor>
+    FirDecimatorQ15<_Taps, _Factor>::FirDecimatorQ15(const Q15 (&coefficients)[_Taps])
+        : Base(coefficients)
+    {
+    }
+
+    template<unsigned _Taps, unsigned _Factor>
+    unsigned FirDecimatorQ15<_Taps, _Factor>::Process(const Q15* input, Q15* output, unsigned count)
+    {
+        unsigned produced = 0;
+        // Output index never overtakes input index, so in-place processing is safe
+        for (unsigned i = 0; i < count; ++i)
+        {
+            Base::Push(input[i]);
+            if (++_phase < _Factor)
+                continue;
+            _phase = 0;
+            output[produced++] = Base::Output();
+        }
+        return produced;
+    }
+
+    template<unsigned _Taps, unsigned _Factor>
+    void FirDecimatorQ15<_Taps, _Factor>::Reset()
+    {
+        Base::Reset();
+        _phase = 0;
+    }
+
+    template<unsigned _Stages>
+    BiquadCascadeQ15<_Stages>::BiquadCascadeQ15(const BiquadQ15Coefficients (&coefficients)[_Stages])
+    {
+        for (unsigned i = 0; i < _Stages; ++i)
+        {
+            _sections[i].B0 = coefficients[i].B0;
+            _sections[i].B12 = Private::Pack(coefficients[i].B1, coefficients[i].B2);
+            _sections[i].A12 = Private::Pack(coefficients[i].A1, coefficients[i].A2);
+        }
+        Reset();
+    }
+
+    template<unsigned _Stages>
+    void BiquadCascadeQ15<_Stages>::Reset()
+    {
+        for (Section& section : _sections)
+        {
+            section.X12 = 0;
+            section.Y12 = 0;
+        }
+    }
+
+    template<unsigned _Stages>
+    void BiquadCascadeQ15<_Stages>::Process(const Q15* input, Q15* output, unsigned count)
+    {
+        for (Section& section : _sections)
+        {
+            Q15 b0 = section.B0;
+            uint32_t b12 = section.B12;
+            uint32_t a12 = section.A12;
+            uint32_t x12 = section.X12;
+            uint32_t y12 = section.Y12;
+
+            // Section processes whole block, state stays in registers
+            for (unsigned i = 0; i < count; ++i)
+            {
+                Q15 x = input[i];
+                int64_t acc = static_cast<int32_t>(b0) * x;
+                acc = Private::DualMacLong(b12, x12, acc);
+                acc = Private::DualMacLong(a12, y12, acc);
+                Q15 y = static_cast<Q15>(Private::Saturate<16>(Private::Saturate32((acc + (1 << 13)) >> 14)));
+
+                x12 = (x12 << 16) | static_cast<uint16_t>(x);
+                y12 = (y12 << 16) | static_cast<uint16_t>(y);
+                output[i] = y;
+            }
+
+            section.X12 = x12;
+            section.Y12 = y12;
+            input = output;
+        }
+    }
+
+    template<unsigned _Stages>
+    BiquadCascadeQ31<_Stages>::BiquadCascadeQ31(const BiquadQ31Coefficients (&coefficients)[_Stages])
+    {
+        for (unsigned i = 0; i < _Stages; ++i)
+            _coefficients[i] = coefficients[i];
+        Reset();
+    }
+
+    template<unsigned _Stages>
+    void BiquadCascadeQ31<_Stages>::Reset()
+    {
+        for (unsigned i = 0; i < _Stages; ++i)
+        {
+            for (unsigned j = 0; j < 4; ++j)
+                _state[i][j] = 0;
+        }
+    }
+
+    template<unsigned _Stages>
+    void BiquadCascadeQ31<_Stages>::Process(const Q31* input, Q31* output, unsigned count)
+    {
+        for (unsigned stage = 0; stage < _Stages; ++stage)
+        {
+            const BiquadQ31Coefficients& c = _coefficients[stage];
+            Q31 x1 = _state[stage][0];
+            Q31 x2 = _state[stage][1];
+            Q31 y1 = _state[stage][2];
+            Q31 y2 = _state[stage][3];
+
+            for (unsigned i = 0; i < count; ++i)
+            {
+                Q31 x = input[i];
+                // SMLAL on Cortex-M3/M4
+                int64_t acc = static_cast<int64_t>(c.B0) * x;
+                acc += static_cast<int64_t>(c.B1) * x1;
+                acc += static_cast<int64_t>(c.B2) * x2;
+                acc += static_cast<int64_t>(c.A1) * y1;
+                acc += static_cast<int64_t>(c.A2) * y2;
+                Q31 y = Private::Saturate32((acc + (1 << 29)) >> 30);
+
+                x2 = x1;
+                x1 = x;
+                y2 = y1;
+                y1 = y;
+                output[i] = y;
+            }
+
+            _state[stage][0] = x1;
+            _state[stage][1] = x2;
+            _state[stage][2] = y1;
+            _state[stage][3] = y2;
+            input = output;
+        }
+    }
+}
+
+#endif //! ZHELE_DSP_IMPL_COMMON_H
@@ -0,0 +1,149 @@
+/**
+ * @file
+ * Event loop methods implementation
+ * 
+ * @author Alexey Zhelonkin
+ * @date 2023
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_EVENT_LOOP_IMPL_COMMON_H
+#define ZHELE_EVENT_LOOP_IMPL_COMMON_H
+
+namespace Zhele
+{
+    #define EVENTLOOP_TEMPLATE_ARGS template<unsigned _QueueSize, unsigned _Priorities>
+    #define EVENTLOOP_TEMPLATE_QUALIFIER EventLoop<_QueueSize, _Priorities>
+
+    EVENTLOOP_TEMPLATE_ARGS
+    typename EVENTLOOP_TEMPLATE_QUALIFIER::Queue EVENTLOOP_TEMPLATE_QUALIFIER::_queues[_Priorities];
+
+    EVENTLOOP_TEMPLATE_ARGS
+    std::atomic<uint32_t> EVENTLOOP_TEMPLATE_QUALIFIER::_dropped {0};
+
+    EVENTLOOP_TEMPLATE_ARGS
+    bool EVENTLOOP_TEMPLATE_QUALIFIER::Reserve(Queue& queue, uint32_t& position)
+    {
+#if (__CORTEX_M >= 3)
+        position = queue.Tail.load(std::memory_order_relaxed);
+        for(;;)
+        {
+            Slot& slot = queue.Slots[position % _QueueSize];
+            int32_t diff = static_cast<int32_t>(slot.Sequence.load(std::memory_order_acquire) - Lap(position));
+            if(diff < 0)
+                return false;
+            if(diff == 0 && queue.Tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                return true;
+            if(diff > 0)
+                position = queue.Tail.load(std::memory_order_relaxed);
+        }
+#else
+        uint32_t state = DriverCriticalSection::Enter();
+
+        position = queue.Tail.load(std::memory_order_relaxed);
+        bool reserved = queue.Slots[position % _QueueSize].Sequence.load(std::memory_order_relaxed) == Lap(position);
+        if(reserved)
+            queue.Tail.store(position + 1, std::memory_order_relaxed);
+
+        DriverCriticalSection::Leave(state);
+        return reserved;
+#endif
+    }
+
+    EVENTLOOP_TEMPLATE_ARGS
+    bool EVENTLOOP_TEMPLATE_QUALIFIER::Post(EventHandler handler, unsigned priority)
+    {
+        if(priority >= _Priorities)
+            priority = _Priorities - 1;
+
+        Queue& queue = _queues[priority];
+        uint32_t position;
+        if(!Reserve(queue, position))
+        {
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        Slot& slot = queue.Slots[position % _QueueSize];
+        slot.Handler = handler;
+        slot.Sequence.store(Lap(position) + 1, std::memory_order_release);
+        return true;
+    }
+
+    EVENTLOOP_TEMPLATE_ARGS
+    bool EVENTLOOP_TEMPLATE_QUALIFIER::Pop(Queue& queue, EventHandler& handler)
+    {
+        Slot& slot = queue.Slots[queue.Head % _QueueSize];
+        if(slot.Sequence.load(std::memory_order_acquire) != Lap(queue.Head) + 1)
+            return false;
+
+        handler = slot.Handler;
+        slot.Sequence.store(Lap(queue.Head) + _QueueSize, std::memory_order_release);
+        ++queue.Head;
+        return true;
+    }
+
+    EVENTLOOP_TEMPLATE_ARGS
+    bool EVENTLOOP_TEMPLATE_QUALIFIER::RunOnce()
+    {
+        EventHandler handler;
+        for(unsigned priority = _Priorities; priority > 0; --priority)
+        {
+            if(Pop(_queues[priority - 1], handler))
+            {
+                handler();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    EVENTLOOP_TEMPLATE_ARGS
+    void EVENTLOOP_TEMPLATE_QUALIFIER::RunPending()
+    {
+        while(RunOnce()) ;
+    }
+
+    EVENTLOOP_TEMPLATE_ARGS
+    bool EVENTLOOP_TEMPLATE_QUALIFIER::Empty()
+    {
+        for(const Queue& queue : _queues)
+        {
+            if(queue.Slots[queue.Head % _QueueSize].Sequence.load(std::memory_order_acquire) == Lap(queue.Head) + 1)
+                return false;
+        }
+        return true;
+    }
+
+    EVENTLOOP_TEMPLATE_ARGS
+    void EVENTLOOP_TEMPLATE_QUALIFIER::Run()
+    {
+        for(;;)
+        {
+            RunPending();
+
+            // Pending interrupt wakes MCU up even with PRIMASK set, so event posted after check is not lost
+            __disable_irq();
+            if(Empty())
+                Power::LowPower::Idle();
+            __enable_irq();
+        }
+    }
+
+    EVENTLOOP_TEMPLATE_ARGS
+    unsigned EVENTLOOP_TEMPLATE_QUALIFIER::Dropped()
+    {
+        return _dropped.load(std::memory_order_relaxed);
+    }
+
+    EVENTLOOP_TEMPLATE_ARGS
+    TransferCallback EVENTLOOP_TEMPLATE_QUALIFIER::Defer(const TransferCallback& target, unsigned priority)
+    {
+        const TransferCallback* callback = &target;
+        return [callback, priority](void* data, unsigned size, bool success) {
+            Post([callback, data, size, success] { (*callback)(data, size, success); }, priority);
+        };
+    }
+}
+
+#endif //! ZHELE_EVENT_LOOP_IMPL_COMMON_H
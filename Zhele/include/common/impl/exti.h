@@ -53,7 +53,7 @@ namespace Zhele
     void Exti<_Line, _IRQn>::EnableInterrupt()
     {
         EXTI->IMR = (EXTI->IMR & ~(1 << _Line)) | (1 << _Line);
-        NVIC_EnableIRQ(_IRQn);
+        Nvic::EnableIrq<_IRQn>();
     }
 
     template<uint8_t _Line, IRQn_Type _IRQn>
@@ -63,10 +63,39 @@ namespace Zhele
         NVIC_DisableIRQ(_IRQn);
     }
 
+    template<uint8_t _Line, IRQn_Type _IRQn>
+    void Exti<_Line, _IRQn>::EnableEvent()
+    {
+        EXTI->EMR |= (1 << _Line);
+    }
+
+    template<uint8_t _Line, IRQn_Type _IRQn>
+    void Exti<_Line, _IRQn>::DisableEvent()
+    {
+        EXTI->EMR &= (~(1 << _Line));
+    }
+
     template<uint8_t _Line, IRQn_Type _IRQn>
     void Exti<_Line, _IRQn>::ClearInterruptFlag()
     {
-        EXTI->PR |= (1 << _Line);
+        // Write 1 to clear: read-modify-write would clear other pending lines
+        EXTI->PR = (1 << _Line);
+    }
+
+    template<typename... _Handlers>
+    template<IRQn_Type _IRQn>
+    void ExtiDispatcher<_Handlers...>::IrqHandler()
+    {
+        // Flags are cleared before handlers call, so new events are not lost
+        uint32_t pending = EXTI->PR & LinesMask<_IRQn>;
+        EXTI->PR = pending;
+
+        while(pending != 0)
+        {
+            unsigned line = __builtin_ctz(pending);
+            pending &= pending - 1;
+            _table.Callbacks[line]();
+        }
     }
 }
 #endif //! ZHELE_EXTI_IMPL_COMMON_H
\ No newline at end of file
@@ -0,0 +1,444 @@
+/**
+ * @file
+ * Implements allocation-free text formatting (without printf)
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_FORMAT_IMPL_COMMON_H
+#define ZHELE_FORMAT_IMPL_COMMON_H
+
+namespace Zhele::Formatting
+{
+    namespace Private
+    {
+        /// "00" ... "99"
+        constexpr char DigitPairs[201] =
+            "00010203040506070809"
+            "10111213141516171819"
+            "20212223242526272829"
+            "30313233343536373839"
+            "40414243444546474849"
+            "50515253545556575859"
+            "60616263646566676869"
+            "70717273747576777879"
+            "80818283848586878889"
+            "90919293949596979899";
+
+        constexpr uint32_t PowersOf10[] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000};
+
+        constexpr unsigned Negate(char* buffer, unsigned length)
+        {
+            for (unsigned i = length; i > 0; --i)
+                buffer[i] = buffer[i - 1];
+            buffer[0] = '-';
+            return length + 1;
+        }
+
+        constexpr unsigned WriteFraction(char* buffer, uint32_t fraction, unsigned decimals)
+        {
+            if (decimals == 0)
+                return 0;
+            buffer[0] = '.';
+            for (unsigned i = decimals; i > 0; --i)
+            {
+                buffer[i] = static_cast<char>('0' + fraction % 10);
+                fraction /= 10;
+            }
+            return decimals + 1;
+        }
+
+        constexpr int SegmentsCount(const char* text, unsigned length)
+        {
+            int count = 1;
+            for (unsigned i = 0; i < length; ++i)
+            {
+                if (text[i] != '%')
+                    continue;
+                ++count;
+                if (++i < length && text[i] == '%')
+                    continue;
+                while (i < length && (text[i] == '-' || text[i] == '+' || text[i] == '0'))
+                    ++i;
+                unsigned width = 0;
+                while (i < length && text[i] >= '0' && text[i] <= '9')
+                    width = width * 10 + (text[i++] - '0');
+                if (width > MaxWidth)
+                    return -1;
+                if (i < length && text[i] == '.')
+                {
+                    unsigned precision = 0;
+                    while (++i < length && text[i] >= '0' && text[i] <= '9')
+                        precision = precision * 10 + (text[i] - '0');
+                    if (precision > 9)
+                        return -1;
+                }
+                if (i >= length)
+                    return -1;
+                switch (text[i])
+                {
+                case 'd': case 'i': case 'u': case 'x': case 'X': case 'c': case 's': case 'f':
+                    break;
+                default:
+                    return -1;
+                }
+            }
+            return count;
+        }
+
+        template<unsigned _Count>
+        constexpr std::array<Segment, _Count> Parse(const char* text, unsigned length)
+        {
+            std::array<Segment, _Count> segments {};
+            unsigned index = 0;
+            unsigned argument = 0;
+            unsigned begin = 0;
+            for (unsigned i = 0; i < length; ++i)
+            {
+                if (text[i] != '%')
+                    continue;
+
+                Segment& segment = segments[index++];
+                segment = Segment {begin, i, 0, false, false, false, 0, -1, argument};
+                if (text[i + 1] == '%')
+                {
+                    // Literal includes the first percent
+                    segment.LiteralEnd = ++i;
+                    begin = i + 1;
+                    continue;
+                }
+
+                for (++i; text[i] == '-' || text[i] == '+' || text[i] == '0'; ++i)
+                {
+                    segment.Left |= text[i] == '-';
+                    segment.Plus |= text[i] == '+';
+                    segment.Zero |= text[i] == '0';
+                }
+                for (; text[i] >= '0' && text[i] <= '9'; ++i)
+                    segment.Width = static_cast<uint8_t>(segment.Width * 10 + (text[i] - '0'));
+                if (text[i] == '.')
+                {
+                    segment.Precision = 0;
+                    for (++i; text[i] >= '0' && text[i] <= '9'; ++i)
+                        segment.Precision = static_cast<int8_t>(segment.Precision * 10 + (text[i] - '0'));
+                }
+                segment.Type = text[i];
+                ++argument;
+                begin = i + 1;
+            }
+            segments[index] = Segment {begin, length, 0, false, false, false, 0, -1, argument};
+            return segments;
+        }
+
+        template<typename _Sink>
+        constexpr void WriteToSink(_Sink& sink, const char* data, unsigned size)
+        {
+            if constexpr (requires { sink.Write(data, size); })
+            {
+                sink.Write(data, size);
+            }
+            else
+            {
+                for (unsigned i = 0; i < size; ++i)
+                    sink.Write(static_cast<uint8_t>(data[i]));
+            }
+        }
+
+        template<typename T>
+        constexpr bool IsFixed = false;
+        template<unsigned _FractionBits>
+        constexpr bool IsFixed<Fixed<_FractionBits>> = true;
+
+        template<typename T>
+        constexpr bool IsInteger = std::is_integral_v<T> || std::is_enum_v<T>;
+
+        template<typename T>
+        constexpr uint32_t ToUnsigned(T value)
+        {
+            if constexpr (std::is_pointer_v<T>)
+                return static_cast<uint32_t>(reinterpret_cast<uintptr_t>(value));
+            else
+                return static_cast<uint32_t>(value);
+        }
+
+        /**
+         * @brief Formats one argument by segment conversion
+         *
+         * @tparam _Segment Segment
+         * @tparam _Sink Sink type
+         * @tparam T Argument type
+         *
+         * @param [in] sink Sink
+         * @param [in] value Argument
+         *
+         * @par Returns
+         *  Nothing
+         */
+        template<Segment _Segment, typename _Sink, typename T>
+        constexpr void WriteArgument(_Sink& sink, const T& value)
+        {
+            using Type = std::decay_t<T>;
+            char buffer[MaxWidth + MaxNumberLength] = {};
+            unsigned length = 0;
+            bool numeric = true;
+            const char* text = buffer;
+
+            if constexpr (_Segment.Type == 'd' || _Segment.Type == 'i')
+            {
+                static_assert(IsInteger<Type> && sizeof(Type) <= sizeof(uint32_t), "%d requires integer (up to 32 bits)");
+                length = WriteSigned(buffer, static_cast<int32_t>(value));
+            }
+            else if constexpr (_Segment.Type == 'u')
+            {
+                static_assert(IsInteger<Type> && sizeof(Type) <= sizeof(uint32_t), "%u requires integer (up to 32 bits)");
+                length = WriteUnsigned(buffer, static_cast<uint32_t>(value));
+            }
+            else if constexpr (_Segment.Type == 'x' || _Segment.Type == 'X')
+            {
+                static_assert((IsInteger<Type> && sizeof(Type) <= sizeof(uint32_t)) || std::is_pointer_v<Type>, "%x requires integer (up to 32 bits) or pointer");
+                length = WriteHex(buffer, ToUnsigned(value), _Segment.Precision > 0 ? _Segment.Precision : 1, _Segment.Type == 'X');
+            }
+            else if constexpr (_Segment.Type == 'f')
+            {
+                constexpr unsigned decimals = _Segment.Precision >= 0 ? _Segment.Precision : (IsFixed<Type> ? 3 : 2);
+                if constexpr (IsFixed<Type>)
+                {
+                    length = WriteFixed(buffer, value.Raw, Type::FractionBits, decimals);
+                }
+                else
+                {
+                    static_assert(std::is_floating_point_v<Type>, "%f requires float or Fixed");
+                    static_assert(decimals <= 6, "Float precision is limited to 6 decimals");
+                    length = WriteFloat(buffer, static_cast<float>(value), decimals);
+                }
+            }
+            else if constexpr (_Segment.Type == 'c')
+            {
+                static_assert(std::is_integral_v<Type>, "%c requires char");
+                buffer[0] = static_cast<char>(value);
+                length = 1;
+                numeric = false;
+            }
+            else
+            {
+                static_assert(std::is_convertible_v<Type, const char*>, "%s requires string");
+                text = value;
+                while (text[length] != 0 && (_Segment.Precision < 0 || length < static_cast<unsigned>(_Segment.Precision)))
+                    ++length;
+                numeric = false;
+            }
+
+            if (numeric && _Segment.Plus && buffer[0] != '-' && _Segment.Type != 'x' && _Segment.Type != 'X' && _Segment.Type != 'u')
+            {
+                for (unsigned i = length; i > 0; --i)
+                    buffer[i] = buffer[i - 1];
+                buffer[0] = '+';
+                ++length;
+            }
+
+            if (length >= _Segment.Width)
+            {
+                WriteToSink(sink, text, length);
+                return;
+            }
+
+            char padding[MaxWidth] = {};
+            unsigned paddingLength = _Segment.Width - length;
+            bool zero = numeric && _Segment.Zero && !_Segment.Left;
+            for (unsigned i = 0; i < paddingLength; ++i)
+                padding[i] = zero ? '0' : ' ';
+
+            if (_Segment.Left)
+            {
+                WriteToSink(sink, text, length);
+                WriteToSink(sink, padding, paddingLength);
+            }
+            else if (zero && (buffer[0] == '-' || buffer[0] == '+'))
+            {
+                // Sign goes before zeros
+                WriteToSink(sink, buffer, 1);
+                WriteToSink(sink, padding, paddingLength);
+                WriteToSink(sink, buffer + 1, length - 1);
+            }
+            else
+            {
+                WriteToSink(sink, padding, paddingLength);
+                WriteToSink(sink, text, length);
+            }
+        }
+
+        template<TemplateUtils::fixed_string _Format, typename _Sink, typename _Tuple, unsigned... _Indexes>
+        constexpr void PrintSegments(_Sink& sink, const _Tuple& arguments, std::integer_sequence<unsigned, _Indexes...>)
+        {
+            using Format = FormatString<_Format>;
+            auto printSegment = [&]<unsigned _Index>()
+            {
+                constexpr Segment segment = Format::Segments[_Index];
+                if constexpr (segment.LiteralEnd > segment.LiteralBegin)
+                    WriteToSink(sink, _Format.Text + segment.LiteralBegin, segment.LiteralEnd - segment.LiteralBegin);
+                if constexpr (segment.Type != 0)
+                    WriteArgument<segment>(sink, std::get<segment.Argument>(arguments));
+            };
+            (printSegment.template operator()<_Indexes>(), ...);
+        }
+    }
+
+    constexpr unsigned DecimalDigits(uint32_t value)
+    {
+        unsigned digits = 1;
+        while (digits < 10 && value >= Private::PowersOf10[digits])
+            ++digits;
+        return digits;
+    }
+
+    constexpr unsigned WriteUnsigned(char* buffer, uint32_t value)
+    {
+        unsigned length = DecimalDigits(value);
+        unsigned position = length;
+        while (value >= 100)
+        {
+            unsigned pair = (value % 100) * 2;
+            value /= 100;
+            buffer[--position] = Private::DigitPairs[pair + 1];
+            buffer[--position] = Private::DigitPairs[pair];
+        }
+        if (value >= 10)
+        {
+            buffer[--position] = Private::DigitPairs[value * 2 + 1];
+            buffer[--position] = Private::DigitPairs[value * 2];
+        }
+        else
+        {
+            buffer[--position] = static_cast<char>('0' + value);
+        }
+        return length;
+    }
+
+    constexpr unsigned WriteSigned(char* buffer, int32_t value)
+    {
+        if (value >= 0)
+            return WriteUnsigned(buffer, static_cast<uint32_t>(value));
+        buffer[0] = '-';
+        return WriteUnsigned(buffer + 1, 0u - static_cast<uint32_t>(value)) + 1;
+    }
+
+    constexpr unsigned WriteHex(char* buffer, uint32_t value, unsigned minDigits, bool upperCase)
+    {
+        const char* digits = upperCase ? "0123456789ABCDEF" : "0123456789abcdef";
+        unsigned length = 1;
+        while (length < 8 && (value >> (length * 4)) != 0)
+            ++length;
+        if (length < minDigits)
+            length = minDigits > 8 ? 8 : minDigits;
+        for (unsigned i = length; i > 0; --i)
+        {
+            buffer[i - 1] = digits[value & 0x0f];
+            value >>= 4;
+        }
+        return length;
+    }
+
+    constexpr unsigned WriteFixed(char* buffer, int32_t value, unsigned fractionBits, unsigned decimals)
+    {
+        uint32_t absolute = value < 0 ? 0u - static_cast<uint32_t>(value) : static_cast<uint32_t>(value);
+        uint32_t integer = absolute >> fractionBits;
+        uint32_t fractionMask = (1u << fractionBits) - 1;
+        uint32_t scale = Private::PowersOf10[decimals];
+        // (fraction * 10^decimals + 0.5) / 2^fractionBits
+        uint32_t fraction = fractionBits != 0
+            ? static_cast<uint32_t>(((static_cast<uint64_t>(absolute & fractionMask) * scale) + (1ull << (fractionBits - 1))) >> fractionBits)
+            : 0;
+        if (fraction >= scale)
+        {
+            fraction -= scale;
+            ++integer;
+        }
+
+        unsigned length = WriteUnsigned(buffer, integer);
+        length += Private::WriteFraction(buffer + length, fraction, decimals);
+        return value < 0 && (integer != 0 || fraction != 0) ? Private::Negate(buffer, length) : length;
+    }
+
+    constexpr unsigned WriteFloat(char* buffer, float value, unsigned decimals)
+    {
+        if (value != value)
+        {
+            buffer[0] = 'n'; buffer[1] = 'a'; buffer[2] = 'n';
+            return 3;
+        }
+
+        bool negative = value < 0;
+        float absolute = negative ? -value : value;
+        unsigned length = 0;
+        if (absolute > 3.4028235e38f)
+        {
+            buffer[0] = 'i'; buffer[1] = 'n'; buffer[2] = 'f';
+            length = 3;
+        }
+        else if (absolute >= 4294967296.0f)
+        {
+            int exponent = 0;
+            while (absolute >= 10.0f)
+            {
+                absolute /= 10.0f;
+                ++exponent;
+            }
+            length = WriteFloat(buffer, absolute, decimals);
+            buffer[length++] = 'e';
+            buffer[length++] = '+';
+            length += WriteUnsigned(buffer + length, exponent);
+        }
+        else
+        {
+            uint32_t integer = static_cast<uint32_t>(absolute);
+            uint32_t scale = Private::PowersOf10[decimals];
+            uint32_t fraction = static_cast<uint32_t>((absolute - static_cast<float>(integer)) * static_cast<float>(scale) + 0.5f);
+            if (fraction >= scale)
+            {
+                fraction -= scale;
+                ++integer;
+            }
+            length = WriteUnsigned(buffer, integer);
+            length += Private::WriteFraction(buffer + length, fraction, decimals);
+        }
+        return negative ? Private::Negate(buffer, length) : length;
+    }
+
+    constexpr void BufferSink::Write(const char* data, unsigned size)
+    {
+        for (unsigned i = 0; i < size && Length + 1 < Size; ++i)
+            Data[Length++] = data[i];
+        if (Size != 0)
+            Data[Length] = 0;
+    }
+
+    template<TemplateUtils::fixed_string _Format, typename _Sink, typename... _Args>
+    constexpr void Print(_Sink& sink, const _Args&... args)
+    {
+        using Format = FormatString<_Format>;
+        static_assert(Format::ArgumentsCount == sizeof...(_Args), "Arguments count does not match format");
+        Private::PrintSegments<_Format>(sink, std::forward_as_tuple(args...), std::make_integer_sequence<unsigned, Format::SegmentsCount>());
+    }
+
+    template<TemplateUtils::fixed_string _Format, typename... _Args>
+    constexpr unsigned Format(char* buffer, unsigned size, const _Args&... args)
+    {
+        BufferSink sink {buffer, size, 0};
+        if (size != 0)
+            buffer[0] = 0;
+        Print<_Format>(sink, args...);
+        return sink.Length;
+    }
+
+    template<TemplateUtils::fixed_string _Format, unsigned _Capacity, typename... _Args>
+    constexpr String<_Capacity> ToString(const _Args&... args)
+    {
+        String<_Capacity> result;
+        result.Length = Format<_Format>(result.Text, _Capacity + 1, args...);
+        return result;
+    }
+}
+
+#endif //! ZHELE_FORMAT_IMPL_COMMON_H
@@ -0,0 +1,289 @@
+/**
+ * @file
+ * Frequency counter methods implementation
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_FREQUENCY_COUNTER_IMPL_COMMON_H
+#define ZHELE_FREQUENCY_COUNTER_IMPL_COMMON_H
+
+namespace Zhele::Timers
+{
+    #define FREQUENCYCOUNTER_TEMPLATE_ARGS template<typename _CounterTimer, typename _GateTimer, typename _CounterTimer::SlaveMode::Trigger _GateTrigger>
+    #define FREQUENCYCOUNTER_TEMPLATE_QUALIFIER FrequencyCounter<_CounterTimer, _GateTimer, _GateTrigger>
+
+    FREQUENCYCOUNTER_TEMPLATE_ARGS
+    typename FREQUENCYCOUNTER_TEMPLATE_QUALIFIER::Callback FREQUENCYCOUNTER_TEMPLATE_QUALIFIER::_callback = nullptr;
+
+    FREQUENCYCOUNTER_TEMPLATE_ARGS
+    uint16_t FREQUENCYCOUNTER_TEMPLATE_QUALIFIER::_gateTicks = 0;
+
+    FREQUENCYCOUNTER_TEMPLATE_ARGS
+    uint16_t FREQUENCYCOUNTER_TEMPLATE_QUALIFIER::_counterPrescaler = 1;
+
+    FREQUENCYCOUNTER_TEMPLATE_ARGS
+    typename FREQUENCYCOUNTER_TEMPLATE_QUALIFIER::Range FREQUENCYCOUNTER_TEMPLATE_QUALIFIER::_range = Range::Auto;
+
+    FREQUENCYCOUNTER_TEMPLATE_ARGS
+    bool FREQUENCYCOUNTER_TEMPLATE_QUALIFIER::_reciprocal = false;
+
+    FREQUENCYCOUNTER_TEMPLATE_ARGS
+    uint8_t FREQUENCYCOUNTER_TEMPLATE_QUALIFIER::_triggerPrescaler = 0;
+
+    FREQUENCYCOUNTER_TEMPLATE_ARGS
+    uint8_t FREQUENCYCOUNTER_TEMPLATE_QUALIFIER::_capturePrescaler = 0;
+
+    FREQUENCYCOUNTER_TEMPLATE_ARGS
+    volatile uint32_t FREQUENCYCOUNTER_TEMPLATE_QUALIFIER::_overflows = 0;
+
+    FREQUENCYCOUNTER_TEMPLATE_ARGS
+    volatile uint32_t FREQUENCYCOUNTER_TEMPLATE_QUALIFIER::_captures = 0;
+
+    FREQUENCYCOUNTER_TEMPLATE_ARGS
+    volatile uint16_t FREQUENCYCOUNTER_TEMPLATE_QUALIFIER::_firstCapture = 0;
+
+    FREQUENCYCOUNTER_TEMPLATE_ARGS
+    volatile uint16_t FREQUENCYCOUNTER_TEMPLATE_QUALIFIER::_lastCapture = 0;
+
+    FREQUENCYCOUNTER_TEMPLATE_ARGS
+    template<typename _Pin>
+    void FREQUENCYCOUNTER_TEMPLATE_QUALIFIER::SelectPins()
+    {
+        // ETR and TI1 both sample the same pin
+        Capture::template SelectPins<_Pin>();
+    }
+
+    FREQUENCYCOUNTER_TEMPLATE_ARGS
+    void FREQUENCYCOUNTER_TEMPLATE_QUALIFIER::Start(uint16_t gateTime, Callback callback, Range range)
+    {
+        if (gateTime == 0)
+            gateTime = 1;
+        if (gateTime > MaxGateTime)
+            gateTime = MaxGateTime;
+
+        _callback = callback;
+        _range = range;
+        _gateTicks = gateTime * (GateTickFreq / 1000);
+        _reciprocal = range == Range::Reciprocal;
+        _triggerPrescaler = 0;
+        _capturePrescaler = 0;
+
+        // Reciprocal method: gate should not exceed 16-bit counter range (captures difference is calculated modulo 2^16)
+        _CounterTimer::Enable();
+        uint64_t ticks = static_cast<uint64_t>(_CounterTimer::GetClockFreq()) * _gateTicks;
+        uint64_t prescaler = (ticks + static_cast<uint64_t>(GateTickFreq) * MaxGateSpan - 1) / (static_cast<uint64_t>(GateTickFreq) * MaxGateSpan);
+        _counterPrescaler = static_cast<uint16_t>(prescaler > 0 ? prescaler : 1);
+
+        _GateTimer::Enable();
+        _GateTimer::Stop();
+        _GateTimer::SetPrescaler(_GateTimer::GetClockFreq() / GateTickFreq - 1);
+        _GateTimer::SetPeriod(_gateTicks - 1);
+        _GateTimer::EnableOnePulseMode();
+        _GateTimer::SetMasterMode(_GateTimer::MasterMode::Enable);
+
+        ConfigureCounter();
+
+        // First start generates update flag (update request source is not selected yet)
+        OpenGate();
+        _GateTimer::ClearInterruptFlag();
+        _GateTimer::EnableInterrupt();
+    }
+
+    FREQUENCYCOUNTER_TEMPLATE_ARGS
+    void FREQUENCYCOUNTER_TEMPLATE_QUALIFIER::Stop()
+    {
+        _GateTimer::DisableInterrupt();
+        _GateTimer::Stop();
+
+        _CounterTimer::DisableInterrupt();
+        Capture::DisableInterrupt();
+        Capture::Disable();
+        _CounterTimer::Stop();
+        _CounterTimer::SlaveMode::DisableSlaveMode();
+        _CounterTimer::SlaveMode::SetExternalClockMode2(_CounterTimer::SlaveMode::ExternalClockMode2::Disabled);
+        _CounterTimer::ClearInterruptFlag();
+        _GateTimer::ClearInterruptFlag();
+    }
+
+    FREQUENCYCOUNTER_TEMPLATE_ARGS
+    void FREQUENCYCOUNTER_TEMPLATE_QUALIFIER::ConfigureCounter()
+    {
+        using SlaveMode = typename _CounterTimer::SlaveMode;
+
+        _CounterTimer::DisableInterrupt();
+        Capture::DisableInterrupt();
+        Capture::Disable();
+        _CounterTimer::Stop();
+        _CounterTimer::SetPeriod(0xffff);
+
+        if (_reciprocal)
+        {
+            SlaveMode::DisableSlaveMode();
+            SlaveMode::SetExternalClockMode2(SlaveMode::ExternalClockMode2::Disabled);
+            _CounterTimer::SetPrescaler(_counterPrescaler - 1);
+
+            Capture::SetCaptureMode(Capture::CaptureMode::Direct);
+            Capture::SetCapturePrescaler(static_cast<typename Capture::CapturePrescaler>(_capturePrescaler << TIM_CCMR1_IC1PSC_Pos));
+            Capture::SetCapturePolarity(Capture::CapturePolarity::RisingEdge);
+            Capture::Enable();
+        }
+        else
+        {
+            SlaveMode::SetExternalTriggerFilter(SlaveMode::ExternalTriggerFilter::NoFilter);
+            SlaveMode::SetExternalTriggerPolarity(SlaveMode::ExternalTriggerPolarity::NonInverted);
+            SlaveMode::SetTriggerPrescaler(static_cast<typename SlaveMode::ExternalTriggerPrescaler>(_triggerPrescaler << TIM_SMCR_ETPS_Pos));
+            SlaveMode::SetExternalClockMode2(SlaveMode::ExternalClockMode2::Enabled);
+            SlaveMode::SelectTrigger(_GateTrigger);
+            SlaveMode::EnableSlaveMode(SlaveMode::Mode::GatedMode);
+            _CounterTimer::SetPrescaler(0);
+        }
+
+        // Counter does not count in gated mode until gate is open
+        _CounterTimer::Start();
+        _CounterTimer::ClearInterruptFlag();
+
+        if (_reciprocal)
+            Capture::EnableInterrupt();
+        else
+            _CounterTimer::EnableInterrupt();
+    }
+
+    FREQUENCYCOUNTER_TEMPLATE_ARGS
+    void FREQUENCYCOUNTER_TEMPLATE_QUALIFIER::OpenGate()
+    {
+        _overflows = 0;
+        _captures = 0;
+        if (!_reciprocal)
+            _CounterTimer::SetCounterValue(0);
+        else
+            Capture::EnableInterrupt();
+
+        _GateTimer::Start();
+    }
+
+    FREQUENCYCOUNTER_TEMPLATE_ARGS
+    uint64_t FREQUENCYCOUNTER_TEMPLATE_QUALIFIER::GatedResult()
+    {
+        // Gate is closed, so counter is stopped and overflow flag is stable
+        uint32_t overflows = _overflows;
+        if (_CounterTimer::IsInterrupt())
+        {
+            ++overflows;
+            _CounterTimer::ClearInterruptFlag();
+        }
+
+        uint64_t count = (static_cast<uint64_t>(overflows) << 16) | _CounterTimer::GetCounterValue();
+        return (count << _triggerPrescaler) * GateTickFreq * 1000 / _gateTicks;
+    }
+
+    FREQUENCYCOUNTER_TEMPLATE_ARGS
+    uint64_t FREQUENCYCOUNTER_TEMPLATE_QUALIFIER::ReciprocalResult()
+    {
+        Capture::DisableInterrupt();
+        uint32_t captures = _captures;
+        uint16_t span = static_cast<uint16_t>(_lastCapture - _firstCapture);
+        if (captures < 2 || span == 0)
+            return 0;
+
+        uint64_t periods = static_cast<uint64_t>(captures - 1) << _capturePrescaler;
+        return periods * _CounterTimer::GetClockFreq() * 1000 / (static_cast<uint64_t>(_counterPrescaler) * span);
+    }
+
+    FREQUENCYCOUNTER_TEMPLATE_ARGS
+    bool FREQUENCYCOUNTER_TEMPLATE_QUALIFIER::SelectRange(uint64_t frequency)
+    {
+        // Edges count (Hz * gate time) for gated method
+        uint64_t edges = frequency * _gateTicks / (static_cast<uint64_t>(GateTickFreq) * 1000);
+        uint8_t triggerPrescaler = _triggerPrescaler;
+        uint8_t capturePrescaler = _capturePrescaler;
+        bool reciprocal = _reciprocal;
+
+        if (_range == Range::Auto)
+        {
+            if (!_reciprocal && edges < ReciprocalThreshold)
+                reciprocal = true;
+            else if (_reciprocal && edges > GatedThreshold)
+                reciprocal = false;
+        }
+
+        if (reciprocal)
+        {
+            // Capture once every 1...8 periods to keep interrupts rate low
+            capturePrescaler = 0;
+            while (capturePrescaler < 3 && (frequency >> capturePrescaler) > static_cast<uint64_t>(MaxCaptureRate) * 1000)
+                ++capturePrescaler;
+        }
+        else
+        {
+            // ETR (after prescaler) should be less than 1/4 of timer clock
+            uint64_t clock = static_cast<uint64_t>(_CounterTimer::GetClockFreq()) * 1000;
+            if (_reciprocal)
+                triggerPrescaler = 0;
+            while (triggerPrescaler < 3 && (frequency >> triggerPrescaler) > clock / 6)
+                ++triggerPrescaler;
+            if (triggerPrescaler > 0 && (frequency >> triggerPrescaler) < clock / 16)
+                --triggerPrescaler;
+        }
+
+        bool changed = reciprocal != _reciprocal
+            || (reciprocal && capturePrescaler != _capturePrescaler)
+            || (!reciprocal && triggerPrescaler != _triggerPrescaler);
+        _reciprocal = reciprocal;
+        _triggerPrescaler = triggerPrescaler;
+        _capturePrescaler = capturePrescaler;
+        return changed;
+    }
+
+    FREQUENCYCOUNTER_TEMPLATE_ARGS
+    void FREQUENCYCOUNTER_TEMPLATE_QUALIFIER::CounterIrqHandler()
+    {
+        if (!_reciprocal)
+        {
+            if (_CounterTimer::IsInterrupt())
+            {
+                _overflows = _overflows + 1;
+                _CounterTimer::ClearInterruptFlag();
+            }
+            return;
+        }
+
+        if (Capture::IsInterrupt())
+        {
+            uint16_t value = Capture::GetValue();
+            Capture::ClearInterruptFlag();
+
+            uint32_t captures = _captures;
+            if (captures == 0)
+                _firstCapture = value;
+            _lastCapture = value;
+            _captures = ++captures;
+
+            // First and last captures are enough, stop interrupts for too fast input
+            if (captures >= MaxCaptures)
+                Capture::DisableInterrupt();
+        }
+    }
+
+    FREQUENCYCOUNTER_TEMPLATE_ARGS
+    void FREQUENCYCOUNTER_TEMPLATE_QUALIFIER::GateIrqHandler()
+    {
+        if (!_GateTimer::IsInterrupt())
+            return;
+        _GateTimer::ClearInterruptFlag();
+
+        uint64_t frequency = _reciprocal ? ReciprocalResult() : GatedResult();
+        if (SelectRange(frequency))
+            ConfigureCounter();
+
+        // Next gate is opened before callback, so callback duration does not add dead time
+        OpenGate();
+
+        if (_callback != nullptr)
+            _callback(frequency);
+    }
+}
+
+#endif //! ZHELE_FREQUENCY_COUNTER_IMPL_COMMON_H
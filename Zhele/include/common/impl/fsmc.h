@@ -0,0 +1,57 @@
+/**
+ * @file
+ * FSMC methods implementation
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_FSMC_IMPL_COMMON_H
+#define ZHELE_FSMC_IMPL_COMMON_H
+
+namespace Zhele
+{
+    template<unsigned _SubBank>
+    template<typename _Pins>
+    void FsmcSramBank<_SubBank>::SelectPins()
+    {
+        _Pins::Enable();
+        // FSMC is AF12 for stm32f4 (alternate function number is not used by stm32f1)
+        _Pins::template Configure<_Pins::Configuration::AltFunc, _Pins::Speed::Fast, _Pins::DriverType::PushPull, _Pins::PullMode::NoPull, 12>();
+    }
+
+    template<unsigned _SubBank>
+    void FsmcSramBank<_SubBank>::Init(MemoryType type, BusWidth width, const Timing& timing, AccessMode mode)
+    {
+        Enable(static_cast<uint32_t>(type) | static_cast<uint32_t>(width), TimingRegister(timing, mode), 0x0fffffff);
+    }
+
+    template<unsigned _SubBank>
+    void FsmcSramBank<_SubBank>::Init(MemoryType type, BusWidth width, const Timing& readTiming, const Timing& writeTiming, AccessMode mode)
+    {
+        // BWTR has no CLKDIV/DATLAT fields, keep them at reset value
+        Enable(static_cast<uint32_t>(type) | static_cast<uint32_t>(width) | FSMC_BCR1_EXTMOD,
+            TimingRegister(readTiming, mode), TimingRegister(writeTiming, mode) | 0x0ff00000);
+    }
+
+    template<unsigned _SubBank>
+    void FsmcSramBank<_SubBank>::Disable()
+    {
+        FSMC_Bank1->BTCR[2 * (_SubBank - 1)] = FSMC_Bank1->BTCR[2 * (_SubBank - 1)] & ~FSMC_BCR1_MBKEN;
+    }
+
+    template<unsigned _SubBank>
+    void FsmcSramBank<_SubBank>::Enable(uint32_t control, uint32_t timing, uint32_t writeTiming)
+    {
+        Clock::FsmcClock::Enable();
+
+        // No address/data multiplexing, asynchronous access, write enabled
+        FSMC_Bank1->BTCR[2 * (_SubBank - 1)] = 0;
+        FSMC_Bank1->BTCR[2 * (_SubBank - 1) + 1] = timing;
+        FSMC_Bank1E->BWTR[2 * (_SubBank - 1)] = writeTiming;
+        FSMC_Bank1->BTCR[2 * (_SubBank - 1)] = control | FSMC_BCR1_WREN | FSMC_BCR1_MBKEN;
+    }
+}
+
+#endif //! ZHELE_FSMC_IMPL_COMMON_H
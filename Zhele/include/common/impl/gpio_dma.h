@@ -0,0 +1,156 @@
+/**
+ * @file
+ * GPIO DMA methods implementation
+ *
+ * @author Alexey Zhelonkin
+ * @date 2023
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_GPIO_DMA_IMPL_COMMON_H
+#define ZHELE_GPIO_DMA_IMPL_COMMON_H
+
+namespace Zhele::IO
+{
+    #define GPIOSTREAMER_TEMPLATE_ARGS template<typename _Pins, typename _Timer, typename _DmaChannel>
+    #define GPIOSTREAMER_TEMPLATE_QUALIFIER GpioStreamer<_Pins, _Timer, _DmaChannel>
+
+    GPIOSTREAMER_TEMPLATE_ARGS
+    void GPIOSTREAMER_TEMPLATE_QUALIFIER::Init(uint32_t rate)
+    {
+        _Pins::Enable();
+        _Pins::template SetConfiguration<_Pins::Configuration::Out>();
+        _Pins::template SetDriverType<_Pins::DriverType::PushPull>();
+        _Pins::template SetSpeed<_Pins::Speed::Fast>();
+
+        _Timer::Enable();
+        SetRate(rate);
+    }
+
+    GPIOSTREAMER_TEMPLATE_ARGS
+    void GPIOSTREAMER_TEMPLATE_QUALIFIER::SetRate(uint32_t rate)
+    {
+        _Timer::SetUpdateRate(rate);
+    }
+
+    GPIOSTREAMER_TEMPLATE_ARGS
+    uint32_t GPIOSTREAMER_TEMPLATE_QUALIFIER::Encode(DataType value)
+    {
+        // Set bits have priority in BSRR, so all pins can be cleared in the same word
+        return (static_cast<uint32_t>(Private::PortMask<Private::PinsForPort<Port, PinsList>>::value) << 16)
+            | Private::GetPinlistValueForPort<Port, PinsList>(value);
+    }
+
+    GPIOSTREAMER_TEMPLATE_ARGS
+    void GPIOSTREAMER_TEMPLATE_QUALIFIER::Encode(const DataType* values, uint32_t* words, size_t count)
+    {
+        for(size_t i = 0; i < count; ++i)
+            words[i] = Encode(values[i]);
+    }
+
+    GPIOSTREAMER_TEMPLATE_ARGS
+    void GPIOSTREAMER_TEMPLATE_QUALIFIER::Start(const uint32_t* words, uint16_t count, TransferCallback callback, bool circular
+        ONLY_IF_STREAM_SUPPORTED(COMMA uint8_t dmaChannel))
+    {
+        typename _DmaChannel::Mode mode = _DmaChannel::Mem2Periph | _DmaChannel::MemIncrement
+            | _DmaChannel::PSize32Bits | _DmaChannel::MSize32Bits | _DmaChannel::PriorityVeryHigh;
+        if(circular)
+            mode = mode | _DmaChannel::Circular;
+
+        _Timer::Stop();
+        _DmaChannel::ClearTransferComplete();
+        _DmaChannel::SetTransferCallback(callback);
+        _DmaChannel::Transfer(mode, words, &Port::Regs()->BSRR, count ONLY_IF_STREAM_SUPPORTED(COMMA dmaChannel));
+        _Timer::DmaRequestEnable();
+        // Start generates update event, so first word is written immediately
+        _Timer::Start();
+    }
+
+    GPIOSTREAMER_TEMPLATE_ARGS
+    void GPIOSTREAMER_TEMPLATE_QUALIFIER::Stop()
+    {
+        _Timer::Stop();
+        _Timer::DmaRequestDisable();
+        _DmaChannel::Disable();
+    }
+
+    GPIOSTREAMER_TEMPLATE_ARGS
+    bool GPIOSTREAMER_TEMPLATE_QUALIFIER::Busy()
+    {
+        return _DmaChannel::Enabled() && _DmaChannel::RemainingTransfers() != 0;
+    }
+
+    #define GPIOSAMPLER_TEMPLATE_ARGS template<typename _Pins, typename _Timer, typename _DmaChannel>
+    #define GPIOSAMPLER_TEMPLATE_QUALIFIER GpioSampler<_Pins, _Timer, _DmaChannel>
+
+    GPIOSAMPLER_TEMPLATE_ARGS
+    void GPIOSAMPLER_TEMPLATE_QUALIFIER::Init(uint32_t rate, typename _Pins::PullMode pull)
+    {
+        _Pins::Enable();
+        _Pins::template SetConfiguration<_Pins::Configuration::In>();
+        _Pins::SetPullMode(static_cast<DataType>(-1), pull);
+
+        _Timer::Enable();
+        SetRate(rate);
+    }
+
+    GPIOSAMPLER_TEMPLATE_ARGS
+    void GPIOSAMPLER_TEMPLATE_QUALIFIER::SetRate(uint32_t rate)
+    {
+        _Timer::SetUpdateRate(rate);
+    }
+
+    GPIOSAMPLER_TEMPLATE_ARGS
+    void GPIOSAMPLER_TEMPLATE_QUALIFIER::Start(uint16_t* samples, uint16_t count, TransferCallback callback
+        ONLY_IF_STREAM_SUPPORTED(COMMA uint8_t dmaChannel))
+    {
+        _Timer::Stop();
+        _DmaChannel::ClearTransferComplete();
+        _DmaChannel::SetTransferCallback(callback);
+        _DmaChannel::Transfer(_DmaChannel::Periph2Mem | _DmaChannel::MemIncrement | _DmaChannel::PSize16Bits | _DmaChannel::MSize16Bits
+            | _DmaChannel::PriorityVeryHigh, samples, &Port::Regs()->IDR, count ONLY_IF_STREAM_SUPPORTED(COMMA dmaChannel));
+        _Timer::DmaRequestEnable();
+        _Timer::Start();
+    }
+
+    GPIOSAMPLER_TEMPLATE_ARGS
+    void GPIOSAMPLER_TEMPLATE_QUALIFIER::StartContinuous(uint16_t* samples, uint16_t halfSize, TransferCallback callback
+        ONLY_IF_STREAM_SUPPORTED(COMMA uint8_t dmaChannel))
+    {
+        _Timer::Stop();
+        _DmaChannel::SetTransferCallback(callback);
+        _DmaChannel::PingPongTransfer(_DmaChannel::Periph2Mem | _DmaChannel::MemIncrement | _DmaChannel::PSize16Bits | _DmaChannel::MSize16Bits
+            | _DmaChannel::PriorityVeryHigh, samples, &Port::Regs()->IDR, halfSize ONLY_IF_STREAM_SUPPORTED(COMMA dmaChannel));
+        _Timer::DmaRequestEnable();
+        _Timer::Start();
+    }
+
+    GPIOSAMPLER_TEMPLATE_ARGS
+    void GPIOSAMPLER_TEMPLATE_QUALIFIER::Stop()
+    {
+        _Timer::Stop();
+        _Timer::DmaRequestDisable();
+        _DmaChannel::Disable();
+    }
+
+    GPIOSAMPLER_TEMPLATE_ARGS
+    bool GPIOSAMPLER_TEMPLATE_QUALIFIER::Busy()
+    {
+        return _DmaChannel::Enabled() && _DmaChannel::RemainingTransfers() != 0;
+    }
+
+    GPIOSAMPLER_TEMPLATE_ARGS
+    typename GPIOSAMPLER_TEMPLATE_QUALIFIER::DataType GPIOSAMPLER_TEMPLATE_QUALIFIER::Extract(uint16_t sample)
+    {
+        return Private::PortValueMap<PinsList, Private::PinsForPort<Port, PinsList>>::template ExtractPinlistValueFromPort<DataType>(sample);
+    }
+
+    GPIOSAMPLER_TEMPLATE_ARGS
+    void GPIOSAMPLER_TEMPLATE_QUALIFIER::Extract(const uint16_t* samples, DataType* values, size_t count)
+    {
+        for(size_t i = 0; i < count; ++i)
+            values[i] = Extract(samples[i]);
+    }
+}
+
+#endif //! ZHELE_GPIO_DMA_IMPL_COMMON_H
@@ -12,6 +12,80 @@
 
 namespace Zhele
 {
+#if defined (I2C_TYPE_1)
+    namespace Private
+    {
+        static constexpr uint64_t I2cDivCeil(uint64_t value, uint64_t divider)
+        {
+            return (value + divider - 1) / divider;
+        }
+    }
+
+    constexpr uint32_t I2cCalculateTiming(uint32_t sourceClock, uint32_t sclClock, uint32_t riseTime, uint32_t fallTime)
+    {
+        if(sourceClock == 0 || sclClock == 0 || sclClock > 1000000)
+            return 0;
+
+        // All times are in picoseconds
+        const bool stdMode = sclClock <= 100000;
+        const bool fastMode = sclClock <= 400000;
+
+        const int64_t lowMin = (stdMode ? 4700 : fastMode ? 1300 : 500) * 1000ll;
+        const int64_t highMin = (stdMode ? 4000 : fastMode ? 600 : 260) * 1000ll;
+        const int64_t setupMin = (stdMode ? 250 : fastMode ? 100 : 50) * 1000ll;
+        const int64_t rise = (riseTime != 0 ? riseTime : stdMode ? 1000 : fastMode ? 300 : 120) * 1000ll;
+        const int64_t fall = (fallTime != 0 ? fallTime : fastMode ? 300 : 120) * 1000ll;
+
+        // Analog filter min delay
+        const int64_t filterMin = 50000;
+
+        const int64_t clockPeriod = 1000000000000ll / sourceClock;
+        const int64_t sclPeriod = 1000000000000ll / sclClock;
+
+        // I2C kernel clock should be fast enough to detect SCL edges
+        if(4 * clockPeriod >= lowMin - filterMin || clockPeriod >= highMin)
+            return 0;
+
+        // SCL low and high detection delays (tSYNC1 + tSYNC2)
+        const int64_t sync = rise + fall + 2 * (filterMin + 2 * clockPeriod);
+
+        for(uint32_t presc = 0; presc < 16; ++presc)
+        {
+            const int64_t prescPeriod = (presc + 1) * clockPeriod;
+
+            const uint64_t scldel = Private::I2cDivCeil(rise + setupMin, prescPeriod) - 1;
+            if(scldel > 15)
+                continue;
+
+            // Minimal data hold time. Max data valid time (tVD;DAT) is not checked: with worst-case
+            // rise time and analog filter delay it cannot be guaranteed in fast mode plus.
+            const int64_t sdadelMin = fall - filterMin - 3 * clockPeriod;
+            const uint64_t sdadel = sdadelMin > 0 ? Private::I2cDivCeil(sdadelMin, prescPeriod) : 0;
+            if(sdadel > 15)
+                continue;
+
+            const uint64_t total = sclPeriod > sync ? Private::I2cDivCeil(sclPeriod - sync, prescPeriod) : 0;
+            uint64_t low = Private::I2cDivCeil(total * lowMin, lowMin + highMin);
+            if(low < Private::I2cDivCeil(lowMin, prescPeriod))
+                low = Private::I2cDivCeil(lowMin, prescPeriod);
+            uint64_t high = total > low ? total - low : 0;
+            if(high < Private::I2cDivCeil(highMin, prescPeriod))
+                high = Private::I2cDivCeil(highMin, prescPeriod);
+
+            if(low > 256 || high > 256)
+                continue;
+
+            return (presc << I2C_TIMINGR_PRESC_Pos)
+                | (static_cast<uint32_t>(scldel) << I2C_TIMINGR_SCLDEL_Pos)
+                | (static_cast<uint32_t>(sdadel) << I2C_TIMINGR_SDADEL_Pos)
+                | (static_cast<uint32_t>(high - 1) << I2C_TIMINGR_SCLH_Pos)
+                | (static_cast<uint32_t>(low - 1) << I2C_TIMINGR_SCLL_Pos);
+        }
+
+        return 0;
+    }
+#endif
+
     namespace Private
     {
         #define I2C_TEMPLATE_ARGS template< \
@@ -36,46 +110,42 @@ namespace Zhele
 
         I2C_TEMPLATE_ARGS
         typename I2C_TEMPLATE_QUALIFIER::AsyncTransferData I2C_TEMPLATE_QUALIFIER::_transferData;
+    #if defined (ZHELE_STATISTICS)
+        I2C_TEMPLATE_ARGS
+        I2cStatistics I2C_TEMPLATE_QUALIFIER::Statistics;
+    #endif
     #if defined (I2C_TYPE_1)
-    static inline uint32_t CalcTiming (uint32_t sourceClock, uint32_t sclClock)
+    I2C_TEMPLATE_ARGS
+    void I2C_TEMPLATE_QUALIFIER::Init(uint32_t i2cClockSpeed)
     {
-        uint32_t tClk = 4000000000u / sourceClock;	// 4*nsec
-        uint32_t t2Scl = 2000000000u / sclClock;	// 4*nsec
-        bool stdMode = sclClock <= 100000;
-        bool fstMode = sclClock <= 400000;
-        uint32_t riseTime = (stdMode ? 1000 : fstMode ? 300 : 120) * 4;	// 4*nsec
-        uint32_t fallTime = (fstMode ? 300 : 120) * 4;	// 4*nsec
-        uint32_t tsudat = (stdMode ? 250 : fstMode ? 100 : 50) * 4;	// 4*nsec
-        uint32_t tLow = t2Scl - (stdMode ? fallTime : 0) - 3 * tClk;
-        uint32_t tHi = t2Scl - (stdMode ? 0 : fallTime) - riseTime - 3 * tClk;
-        uint32_t sclh = tLow / tClk;
-        uint32_t scll = tHi / tClk;
-        uint32_t scldel = tsudat / tClk;
-
-        sclh -= sclh > 0 ? 1 : 0;
-        scll -= scll > 0 ? 1 : 0;
-        scldel -= scldel > 0 ? 1 : 0;
-
-        uint32_t presc = scll / 256;
-        if (presc > 0)
-        {
-            sclh /= (presc + 1);
-            scll /= (presc + 1);
-            scldel /= (presc + 1);
-        }
-
-        return (scll << I2C_TIMINGR_SCLL_Pos) | (sclh << I2C_TIMINGR_SCLH_Pos) | (scldel << I2C_TIMINGR_SCLDEL_Pos) | (presc << I2C_TIMINGR_PRESC_Pos);
+        InitTiming(I2cCalculateTiming(_ClockCtrl::ClockFreq(), i2cClockSpeed), i2cClockSpeed > 400000);
     }
 
     I2C_TEMPLATE_ARGS
-    void I2C_TEMPLATE_QUALIFIER::Init(uint32_t i2cClockSpeed)
+    template<typename _Timing>
+    void I2C_TEMPLATE_QUALIFIER::Init()
+    {
+        InitTiming(_Timing::Value, _Timing::FastModePlus);
+    }
+
+    I2C_TEMPLATE_ARGS
+    void I2C_TEMPLATE_QUALIFIER::InitTiming(uint32_t timing, bool fastModePlus)
     {
         _ClockCtrl::Enable();
         
         _Regs()->CR1 &= ~I2C_CR1_PE;
         while (_Regs()->CR1 & I2C_CR1_PE) {};
 
-        _Regs()->TIMINGR = CalcTiming(_ClockCtrl::ClockFreq(), i2cClockSpeed);
+        if constexpr (I2cFastModePlusDrive<_Regs>::Mask != 0)
+        {
+            Clock::SysCfgCompClock::Enable();
+            if(fastModePlus)
+                SYSCFG->CFGR1 |= I2cFastModePlusDrive<_Regs>::Mask;
+            else
+                SYSCFG->CFGR1 &= ~I2cFastModePlusDrive<_Regs>::Mask;
+        }
+
+        _Regs()->TIMINGR = timing;
         _Regs()->CR1 |= I2C_CR1_PE;
 
         while ((_Regs()->CR1 & I2C_CR1_PE) == 0) {};
@@ -177,53 +247,20 @@ namespace Zhele
         }
 
         _transferData.Buffer = const_cast<uint8_t*>(data);
-        _transferData.Size = size;
         _transferData.Callback = callback;
 
+        // Whole data is transferred by one DMA transfer, NBYTES is reloaded by 255-bytes chunks in EventIrqHandler
         SetTransferSize(size > 255 ? 255 : size, size <= 255);
+        StartAsync(size);
+
         _DmaTx::ClearTransferComplete();
-        _Regs()->CR1 |= I2C_CR1_TXDMAEN;
         _DmaTx::SetTransferCallback([](void* buffer, unsigned bytesTransmit, bool success)
         {
-            if (!success)
-            {
-                if(_transferData.Callback != nullptr)
-                    _transferData.Callback(GetErorFromEvent(GetLastEvent()));
-                return;
-            }
-
-            _transferData.Size -= bytesTransmit;
-            _transferData.Buffer += bytesTransmit;
-
-            if(!WaitEvent(_transferData.Size > 0 ? TransfertCompleteReload : TransfertComplete))
-            {
-                if(_transferData.Callback != nullptr)
-                    _transferData.Callback(GetErorFromEvent(GetLastEvent()));
-                return;
-            }
-
-            if(_transferData.Size > 255)
-            {
-                SetTransferSize(255, false);
-                _DmaTx::ClearTransferComplete();
-                _DmaTx::Transfer(_DmaTx::Mem2Periph | _DmaTx::MemIncrement, _transferData.Buffer, &_Regs()->TXDR, 255);
-                return;
-            }
-            if(_transferData.Size > 0)
-            {
-                SetTransferSize(_transferData.Size & 0xff);
-                _DmaTx::ClearTransferComplete();
-                _DmaTx::Transfer(_DmaTx::Mem2Periph | _DmaTx::MemIncrement, _transferData.Buffer, &_Regs()->TXDR, _transferData.Size);
-            }
-            else
-            {
-                _Regs()->CR1 &= ~I2C_CR1_TXDMAEN;
-                if(_transferData.Callback != nullptr)
-                    _transferData.Callback(I2cStatus::Success);
-            }
+            if(!success)
+                AbortAsync(I2cStatus::BusError);
         });
-        
-        _DmaTx::Transfer(_DmaTx::Mem2Periph | _DmaTx::MemIncrement, data, &_Regs()->TXDR, (size > 255 ? 255 : size));
+        _Regs()->CR1 |= I2C_CR1_TXDMAEN;
+        _DmaTx::Transfer(_DmaTx::Mem2Periph | _DmaTx::MemIncrement, data, &_Regs()->TXDR, size);
 
         return I2cStatus::Success;
     }
@@ -327,53 +364,19 @@ namespace Zhele
             return GetErorFromEvent(GetLastEvent());
 
         _transferData.Buffer = data;
-        _transferData.Size = size;
         _transferData.Callback = callback;
 
-        _DmaRx::ClearTransferComplete();
-        _Regs()->CR1 |= I2C_CR1_RXDMAEN;
+        // Whole data is transferred by one DMA transfer, NBYTES is reloaded by 255-bytes chunks in EventIrqHandler
+        StartAsync(size);
 
+        _DmaRx::ClearTransferComplete();
         _DmaRx::SetTransferCallback([](void* buffer, unsigned bytesReceived, bool success)
         {
-            if (!success)
-            {
-                if(_transferData.Callback != nullptr)
-                    _transferData.Callback(GetErorFromEvent(GetLastEvent()));
-                return;
-            }
-
-            _transferData.Size -= bytesReceived;
-            _transferData.Buffer += bytesReceived;
-
-            if(!WaitEvent(_transferData.Size > 0 ? TransfertCompleteReload : TransfertComplete))
-            {
-                if(_transferData.Callback != nullptr)
-                    _transferData.Callback(GetErorFromEvent(GetLastEvent()));
-                return;
-            }
-
-            if(_transferData.Size > 255)
-            {
-                SetTransferSize(255, false);
-                _DmaRx::ClearTransferComplete();
-                _DmaRx::Transfer(_DmaRx::Periph2Mem | _DmaRx::MemIncrement | _DmaRx::Circular, _transferData.Buffer, &_Regs()->RXDR, 255);
-                return;
-            }
-            if(_transferData.Size > 0)
-            {
-                SetTransferSize(_transferData.Size & 0xff);
-                _DmaRx::ClearTransferComplete();
-                _DmaRx::Transfer(_DmaRx::Periph2Mem | _DmaRx::MemIncrement | _DmaRx::Circular, _transferData.Buffer, &_Regs()->RXDR, _transferData.Size);
-            }
-            else
-            {
-                _Regs()->CR1 &= ~I2C_CR1_RXDMAEN;
-                if(_transferData.Callback != nullptr)
-                    _transferData.Callback(I2cStatus::Success);
-            }
+            if(!success)
+                AbortAsync(I2cStatus::BusError);
         });
-
-        _DmaRx::Transfer(_DmaRx::Periph2Mem | _DmaRx::MemIncrement | _DmaRx::Circular, data, &_Regs()->RXDR, (size > 255 ? 255 : size));
+        _Regs()->CR1 |= I2C_CR1_RXDMAEN;
+        _DmaRx::Transfer(_DmaRx::Periph2Mem | _DmaRx::MemIncrement, data, &_Regs()->RXDR, size);
 
         return I2cStatus::Success;
     }
@@ -448,6 +451,111 @@ namespace Zhele
             | (size << I2C_CR2_NBYTES_Pos)
             | (isLast ? 0 : I2C_CR2_RELOAD);
     }
+
+    I2C_TEMPLATE_ARGS
+    void I2C_TEMPLATE_QUALIFIER::StartAsync(uint16_t size)
+    {
+        // First chunk is already set to NBYTES
+        _transferData.Size = size > 255 ? size - 255 : 0;
+        _transferData.Status = I2cStatus::Success;
+
+        _Regs()->ICR = I2C_ICR_STOPCF | I2C_ICR_NACKCF | I2C_ICR_BERRCF | I2C_ICR_ARLOCF | I2C_ICR_OVRCF;
+        _Regs()->CR1 |= I2C_CR1_TCIE | I2C_CR1_STOPIE | I2C_CR1_NACKIE | I2C_CR1_ERRIE;
+
+        Nvic::EnableIrq<_EventIrqNumber>();
+        if constexpr(_EventIrqNumber != _ErrorIrqNumber)
+        {
+            Nvic::EnableIrq<_ErrorIrqNumber>();
+        }
+    }
+
+    I2C_TEMPLATE_ARGS
+    void I2C_TEMPLATE_QUALIFIER::AbortAsync(I2cStatus status)
+    {
+        _DmaTx::Disable();
+        _DmaRx::Disable();
+        if((_Regs()->ISR & I2C_ISR_BUSY) && !(status == I2cStatus::ArbitrationError))
+            _Regs()->CR2 |= I2C_CR2_STOP;
+        CompleteAsync(status);
+    }
+
+    I2C_TEMPLATE_ARGS
+    void I2C_TEMPLATE_QUALIFIER::CompleteAsync(I2cStatus status)
+    {
+        _Regs()->CR1 &= ~(I2C_CR1_TCIE | I2C_CR1_STOPIE | I2C_CR1_NACKIE | I2C_CR1_ERRIE | I2C_CR1_TXDMAEN | I2C_CR1_RXDMAEN);
+
+        if(_transferData.Callback != nullptr)
+        {
+            _transferData.Callback(status);
+        }
+    }
+
+    I2C_TEMPLATE_ARGS
+    void I2C_TEMPLATE_QUALIFIER::EventIrqHandler()
+    {
+        uint32_t isr = _Regs()->ISR;
+        ZHELE_TRACE_EVENT(Trace::Event::I2cEvent, isr);
+
+        // Async transfer is not active
+        if((_Regs()->CR1 & I2C_CR1_STOPIE) == 0)
+            return;
+
+        if constexpr(_EventIrqNumber == _ErrorIrqNumber)
+        {
+            if(isr & (I2C_ISR_BERR | I2C_ISR_ARLO | I2C_ISR_OVR | I2C_ISR_TIMEOUT))
+            {
+                ErrorIrqHandler();
+                return;
+            }
+        }
+
+        if(isr & I2C_ISR_NACKF)
+        {
+            _Regs()->ICR = I2C_ICR_NACKCF;
+            _transferData.Status = GetErorFromEvent(AckFailure);
+            _DmaTx::Disable();
+            _DmaRx::Disable();
+            // Stop is generated automatically only in autoend mode without reload
+            if((_Regs()->CR2 & (I2C_CR2_AUTOEND | I2C_CR2_RELOAD)) != I2C_CR2_AUTOEND)
+                _Regs()->CR2 |= I2C_CR2_STOP;
+        }
+        else if(isr & I2C_ISR_TCR)
+        {
+            // Next chunk, DMA transfer continues (SCL is stretched until NBYTES is written)
+            uint16_t chunk = _transferData.Size > 255 ? 255 : _transferData.Size;
+            _transferData.Size -= chunk;
+            SetTransferSize(chunk, _transferData.Size == 0);
+        }
+        else if(isr & I2C_ISR_TC)
+        {
+            // Should not happen in autoend mode, but TC interrupt is enabled with TCR one
+            _Regs()->CR2 |= I2C_CR2_STOP;
+        }
+
+        if(isr & I2C_ISR_STOPF)
+        {
+            _Regs()->ICR = I2C_ICR_STOPCF;
+            CompleteAsync(_transferData.Status);
+        }
+    }
+
+    I2C_TEMPLATE_ARGS
+    void I2C_TEMPLATE_QUALIFIER::ErrorIrqHandler()
+    {
+        const uint32_t errors = I2C_ISR_BERR | I2C_ISR_ARLO | I2C_ISR_OVR | I2C_ISR_TIMEOUT;
+        uint32_t isr = _Regs()->ISR;
+        ZHELE_TRACE_EVENT(Trace::Event::I2cError, isr);
+
+        if((isr & errors) == 0)
+            return;
+        // Error flags and clear flags have same positions
+        _Regs()->ICR = isr & errors;
+
+        if((_Regs()->CR1 & I2C_CR1_ERRIE) == 0)
+            return;
+
+        AbortAsync(GetErorFromEvent(isr & errors));
+    }
     #endif
     #if defined (I2C_TYPE_2)
         template<typename _Regs>
@@ -499,6 +607,10 @@ namespace Zhele
             _Regs()->CR1 = 0;
             while (_Regs()->CR1 & I2C_CR1_PE) {};
             
+            // Fast mode plus is not supported by this I2C
+            if(i2cClockSpeed > 400000)
+                i2cClockSpeed = 400000;
+
             uint32_t sourceClock = _ClockCtrl::ClockFreq();
             CalcTiming<_Regs>(sourceClock, i2cClockSpeed, dutyCycle2);
 
@@ -509,10 +621,10 @@ namespace Zhele
             _Regs()->OAR1 = 2;
             _Regs()->OAR2 = 0;
 
-            NVIC_EnableIRQ(_EventIrqNumber);
+            Nvic::EnableIrq<_EventIrqNumber>();
             if constexpr(_EventIrqNumber != _ErrorIrqNumber)
             {
-                NVIC_EnableIRQ(_ErrorIrqNumber);
+                Nvic::EnableIrq<_ErrorIrqNumber>();
             }
         }
 
@@ -587,53 +699,7 @@ namespace Zhele
         I2C_TEMPLATE_ARGS
         I2cStatus I2C_TEMPLATE_QUALIFIER::WriteAsync(uint16_t devAddr, uint16_t regAddr, const uint8_t *data, uint16_t size, I2cOpts opts, I2cCallback callback)
         {
-            _Regs()->SR1 = 0;
-            _Regs()->SR2 = 0;
-
-            if(!WaitWhileBusy())
-                return GetErorFromEvent(GetLastEvent());
-
-            _Regs()->CR1 |= I2C_CR1_ACK;
-            
-            if(!Start())
-                return GetErorFromEvent(GetLastEvent());
-            
-           if(!WriteDevAddr(devAddr, false, opts))
-                return GetErorFromEvent(GetLastEvent());
-
-            if(!HasAnyFlag(opts, I2cOpts::RegAddrNone) )
-            {
-                if(!WriteRegAddr(regAddr, opts))
-                    return GetErorFromEvent(GetLastEvent());
-            }
-            
-            _transferData.Callback = callback;
-
-            _DmaTx::ClearTransferComplete();
-            _Regs()->CR2 |= I2C_CR2_DMAEN;
-
-            _DmaTx::SetTransferCallback([](void* buffer, unsigned size, bool success)
-            {
-                if(!WaitEvent(Events::ByteTransferFinished))
-                {
-                    if (_transferData.Callback != nullptr)
-                    {
-                        _transferData.Callback(GetErorFromEvent(GetLastEvent()));
-                    }
-                }
-
-                _Regs()->CR1 &= ~I2C_CR1_ACK;
-                _Regs()->CR1 |= I2C_CR1_STOP;
-
-                if (_transferData.Callback != nullptr)
-                {
-                    _transferData.Callback(success ? I2cStatus::Success : GetErorFromEvent(GetLastEvent()));
-                }
-            });
-
-            _DmaTx::Transfer(_DmaTx::Mem2Periph | _DmaTx::MemIncrement, data, &_Regs()->DR, size);
-
-            return I2cStatus::Success;
+            return StartAsync(devAddr, regAddr, const_cast<uint8_t*>(data), size, opts, I2cMode::Write, callback);
         }
 
         I2C_TEMPLATE_ARGS
@@ -714,60 +780,216 @@ namespace Zhele
 
         I2C_TEMPLATE_ARGS
         I2cStatus I2C_TEMPLATE_QUALIFIER::EnableAsyncRead(uint16_t devAddr, uint16_t regAddr, uint8_t *data, uint16_t size, I2cOpts opts, I2cCallback callback)
-        {            
-            if(!WaitWhileBusy())
-                GetErorFromEvent(GetLastEvent());
-            
-            if(!Start())
-                GetErorFromEvent(GetLastEvent());
+        {
+            if(size == 0)
+                return I2cStatus::ArgumentError;
 
-            if(!WriteDevAddr(devAddr, false, opts))
-                GetErorFromEvent(GetLastEvent());
+            return StartAsync(devAddr, regAddr, data, size, opts, I2cMode::Read, callback);
+        }
 
-            if(!HasAnyFlag(opts, I2cOpts::RegAddrNone))
+        I2C_TEMPLATE_ARGS
+        I2cStatus I2C_TEMPLATE_QUALIFIER::StartAsync(uint16_t devAddr, uint16_t regAddr, uint8_t* data, uint16_t size, I2cOpts opts, I2cMode mode, I2cCallback callback)
+        {
+            // Previous transaction stop condition is generated in a few microseconds
+            for(uint32_t i = _timeout; i > 0 && (_Regs()->CR1 & I2C_CR1_STOP); --i);
+
+            uint32_t state = DriverCriticalSection::Enter();
+            if(_transferData.State != I2cState::Idle || (_Regs()->SR2 & I2C_SR2_BUSY))
             {
-                if(!WriteRegAddr(regAddr, opts))
-                    return GetErorFromEvent(GetLastEvent());
+                DriverCriticalSection::Leave(state);
+                return I2cStatus::Busy;
             }
-            
-            if(!Start())
-                return GetErorFromEvent(GetLastEvent());
-
-            _Regs()->CR1 |= I2C_CR1_ACK;
 
-            if(!WriteDevAddr(devAddr, true, opts))
-                GetErorFromEvent(GetLastEvent());
-            
+            _transferData.Buffer = data;
+            _transferData.Size = size;
+            _transferData.DevAddr = devAddr;
+            _transferData.RegAddr = regAddr;
+            _transferData.Opts = opts;
+            _transferData.Mode = mode;
             _transferData.Callback = callback;
+            // Read without register address starts from device address for read
+            _transferData.State = mode == I2cMode::Read && HasAllFlags(opts, I2cOpts::RegAddrNone)
+                ? I2cState::Restart
+                : I2cState::Start;
+            DriverCriticalSection::Leave(state);
 
-            _DmaRx::ClearTransferComplete();
-            _Regs()->CR2 |= I2C_CR2_DMAEN;
+            _Regs()->SR1 = 0;
+            _Regs()->CR2 |= I2C_CR2_ITEVTEN | I2C_CR2_ITERREN;
+            _Regs()->CR1 |= I2C_CR1_ACK | I2C_CR1_START;
+
+            return I2cStatus::Success;
+        }
 
-            _DmaRx::SetTransferCallback([](void* buffer, unsigned size, bool success)
+        I2C_TEMPLATE_ARGS
+        void I2C_TEMPLATE_QUALIFIER::EventIrqHandler()
+        {
+            uint32_t sr1 = _Regs()->SR1;
+            ZHELE_TRACE_EVENT(Trace::Event::I2cEvent, (sr1 & 0xffff) | (static_cast<uint32_t>(_transferData.State) << 16));
+
+            switch (_transferData.State)
             {
-                _Regs()->CR1 &= ~I2C_CR1_ACK;
+            case I2cState::Start:
+            case I2cState::Restart:
+                if(sr1 & I2C_SR1_SB)
+                {
+                    bool read = _transferData.State == I2cState::Restart;
+                    _Regs()->DR = (_transferData.DevAddr << 1) | (read ? 1 : 0);
+                    _transferData.State = read ? I2cState::DevAddrRead : I2cState::DevAddr;
+                }
+                break;
 
-                if(!WaitEvent(Events::RxNotEmpty | Events::MasterSlave | Events::BusBusy))
+            case I2cState::DevAddr:
+                if(sr1 & I2C_SR1_ADDR)
                 {
-                    if (_transferData.Callback != nullptr)
+                    static_cast<void>(_Regs()->SR2); // Clear ADDR
+
+                    if(HasAllFlags(_transferData.Opts, I2cOpts::RegAddrNone))
+                    {
+                        OnRegAddrSent();
+                    }
+                    else
                     {
-                        _transferData.Callback(GetErorFromEvent(GetLastEvent()));
+                        _Regs()->DR = static_cast<uint8_t>(_transferData.RegAddr);
+                        _transferData.State = HasAnyFlag(_transferData.Opts, I2cOpts::RegAddr16Bit)
+                            ? I2cState::RegAddrNextByte
+                            : I2cState::RegAddr;
                     }
                 }
+                break;
+
+            case I2cState::RegAddrNextByte:
+                if(sr1 & I2C_SR1_BTF)
+                {
+                    _Regs()->DR = static_cast<uint8_t>(_transferData.RegAddr >> 8);
+                    _transferData.State = I2cState::RegAddr;
+                }
+                break;
 
-                static_cast<uint8_t*>(buffer)[size] = static_cast<uint8_t>(_Regs()->DR);
+            case I2cState::RegAddr:
+                if(sr1 & I2C_SR1_BTF)
+                {
+                    OnRegAddrSent();
+                }
+                break;
+
+            case I2cState::DevAddrRead:
+                if(sr1 & I2C_SR1_ADDR)
+                {
+                    _transferData.State = I2cState::Data;
+                    if(_transferData.Size == 1)
+                    {
+                        // Single byte: NACK and STOP right after address, byte is read on RXNE
+                        _Regs()->CR1 &= ~I2C_CR1_ACK;
+                        static_cast<void>(_Regs()->SR2);
+                        _Regs()->CR1 |= I2C_CR1_STOP;
+                        _Regs()->CR2 |= I2C_CR2_ITBUFEN;
+                    }
+                    else
+                    {
+                        // LAST bit makes I2C NACK last byte received by DMA
+                        _Regs()->CR2 = (_Regs()->CR2 & ~I2C_CR2_ITEVTEN) | I2C_CR2_DMAEN | I2C_CR2_LAST;
+                        _DmaRx::ClearTransferComplete();
+                        _DmaRx::SetTransferCallback([](void*, unsigned, bool success)
+                        {
+                            _Regs()->CR1 |= I2C_CR1_STOP;
+                            CompleteAsync(success ? I2cStatus::Success : I2cStatus::BusError);
+                        });
+                        _DmaRx::Transfer(_DmaRx::Periph2Mem | _DmaRx::MemIncrement, _transferData.Buffer, &_Regs()->DR, _transferData.Size);
+                        static_cast<void>(_Regs()->SR2);
+                    }
+                }
+                break;
+
+            case I2cState::Data:
+                if(_transferData.Mode == I2cMode::Read && (sr1 & I2C_SR1_RXNE))
+                {
+                    _transferData.Buffer[0] = static_cast<uint8_t>(_Regs()->DR);
+                    CompleteAsync(I2cStatus::Success);
+                }
+                break;
+
+            case I2cState::Stop:
+                if(sr1 & I2C_SR1_BTF)
+                {
+                    _Regs()->CR1 |= I2C_CR1_STOP;
+                    CompleteAsync(I2cStatus::Success);
+                }
+                break;
 
+            default:
+                // Unexpected event, disable interrupts
+                _Regs()->CR2 &= ~(I2C_CR2_ITEVTEN | I2C_CR2_ITBUFEN);
+                break;
+            }
+        }
+
+        I2C_TEMPLATE_ARGS
+        void I2C_TEMPLATE_QUALIFIER::ErrorIrqHandler()
+        {
+            const uint32_t errors = I2C_SR1_BERR | I2C_SR1_ARLO | I2C_SR1_AF | I2C_SR1_OVR | I2C_SR1_TIMEOUT;
+            uint32_t sr1 = _Regs()->SR1;
+            _Regs()->SR1 = ~(sr1 & errors) & 0xffff;
+            ZHELE_TRACE_EVENT(Trace::Event::I2cError, (sr1 & 0xffff) | (static_cast<uint32_t>(_transferData.State) << 16));
+
+            if(_transferData.State == I2cState::Idle)
+                return;
+
+            // Master loses bus on arbitration lost, otherwise bus should be released
+            if((sr1 & I2C_SR1_ARLO) == 0)
+                _Regs()->CR1 |= I2C_CR1_STOP;
+
+            _DmaTx::Disable();
+            _DmaRx::Disable();
+
+            CompleteAsync(GetErorFromEvent(sr1 & errors));
+        }
+
+        I2C_TEMPLATE_ARGS
+        void I2C_TEMPLATE_QUALIFIER::OnRegAddrSent()
+        {
+            if(_transferData.Mode == I2cMode::Read)
+            {
+                _transferData.State = I2cState::Restart;
+                _Regs()->CR1 |= I2C_CR1_START;
+                return;
+            }
+
+            if(_transferData.Size == 0)
+            {
                 _Regs()->CR1 |= I2C_CR1_STOP;
+                CompleteAsync(I2cStatus::Success);
+                return;
+            }
 
-                if (_transferData.Callback != nullptr)
+            // Events are not needed while DMA transmits data, BTF after last byte means transfer end
+            _transferData.State = I2cState::Data;
+            _Regs()->CR2 = (_Regs()->CR2 & ~I2C_CR2_ITEVTEN) | I2C_CR2_DMAEN;
+            _DmaTx::ClearTransferComplete();
+            _DmaTx::SetTransferCallback([](void*, unsigned, bool success)
+            {
+                if(!success)
                 {
-                    _transferData.Callback(success ? I2cStatus::Success : GetErorFromEvent(GetLastEvent()));
+                    _Regs()->CR1 |= I2C_CR1_STOP;
+                    CompleteAsync(I2cStatus::BusError);
+                    return;
                 }
+                _transferData.State = I2cState::Stop;
+                _Regs()->CR2 = (_Regs()->CR2 & ~I2C_CR2_DMAEN) | I2C_CR2_ITEVTEN;
             });
+            _DmaTx::Transfer(_DmaTx::Mem2Periph | _DmaTx::MemIncrement, _transferData.Buffer, &_Regs()->DR, _transferData.Size);
+        }
 
-            _DmaRx::Transfer(_DmaRx::Periph2Mem | _DmaRx::MemIncrement | _DmaRx::Circular, data, &_Regs()->DR, size - 1);
+        I2C_TEMPLATE_ARGS
+        void I2C_TEMPLATE_QUALIFIER::CompleteAsync(I2cStatus status)
+        {
+            _Regs()->CR2 &= ~(I2C_CR2_ITEVTEN | I2C_CR2_ITERREN | I2C_CR2_ITBUFEN | I2C_CR2_DMAEN | I2C_CR2_LAST);
+            _transferData.Mode = I2cMode::Idle;
+            _transferData.State = I2cState::Idle;
 
-            return I2cStatus::Success;
+            if(_transferData.Callback != nullptr)
+            {
+                _transferData.Callback(status);
+            }
         }
 
         I2C_TEMPLATE_ARGS
@@ -811,7 +1033,8 @@ namespace Zhele
         I2C_TEMPLATE_ARGS
         bool I2C_TEMPLATE_QUALIFIER::Busy()
         {
-            return (_Regs()->SR2 & I2C_SR2_BUSY) > 0;
+            // SR2 is not read during async transaction (it clears ADDR flag)
+            return _transferData.State != I2cState::Idle || (_Regs()->SR2 & I2C_SR2_BUSY) > 0;
         }
 
         I2C_TEMPLATE_ARGS
@@ -848,24 +1071,30 @@ namespace Zhele
         {
             if(lastevent & Timeout)
             {
+                ZHELE_STATISTICS_INCREMENT(Statistics, I2cCounter::Timeout);
                 return I2cStatus::Timeout;
             }
             if(lastevent & Overrun)
             {
+                ZHELE_STATISTICS_INCREMENT(Statistics, I2cCounter::Overrun);
                 return I2cStatus::Overflow;
             }
             if(lastevent & AckFailure)
             {
+                ZHELE_STATISTICS_INCREMENT(Statistics, I2cCounter::Nack);
                 return I2cStatus::Nack;
             }
             if(lastevent & ArbitrationLost)
             {
+                ZHELE_STATISTICS_INCREMENT(Statistics, I2cCounter::ArbitrationLost);
                 return I2cStatus::ArbitrationError;
             }
             if(lastevent & BusError)
             {
+                ZHELE_STATISTICS_INCREMENT(Statistics, I2cCounter::BusError);
                 return I2cStatus::BusError;
             }
+            ZHELE_STATISTICS_INCREMENT(Statistics, I2cCounter::Timeout);
             return I2cStatus::Timeout;
         }
     }
@@ -0,0 +1,146 @@
+/**
+ * @file
+ * I2C transactions queue methods implementation
+ *
+ * @author Alexey Zhelonkin
+ * @date 2023
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_I2C_QUEUE_IMPL_COMMON_H
+#define ZHELE_I2C_QUEUE_IMPL_COMMON_H
+
+#include <string.h>
+
+namespace Zhele
+{
+    #define I2CQUEUE_TEMPLATE_ARGS template<typename _I2c, unsigned _QueueSize, unsigned _MergeBufferSize>
+    #define I2CQUEUE_TEMPLATE_QUALIFIER I2cTransactionQueue<_I2c, _QueueSize, _MergeBufferSize>
+
+    I2CQUEUE_TEMPLATE_ARGS
+    bool I2CQUEUE_TEMPLATE_QUALIFIER::Enqueue(const I2cTransaction& transaction, I2cPriority priority)
+    {
+        uint32_t state = DriverCriticalSection::Enter();
+        bool queued = _queues[static_cast<uint8_t>(priority)].push_back(transaction);
+        DriverCriticalSection::Leave(state);
+
+        if(queued)
+            StartNext();
+
+        return queued;
+    }
+
+    I2CQUEUE_TEMPLATE_ARGS
+    bool I2CQUEUE_TEMPLATE_QUALIFIER::Read(uint16_t devAddr, uint16_t regAddr, uint8_t* data, uint16_t size, I2cCallback callback, I2cPriority priority, I2cOpts opts)
+    {
+        return Enqueue(I2cTransaction {devAddr, regAddr, data, size, I2cMode::Read, opts, callback}, priority);
+    }
+
+    I2CQUEUE_TEMPLATE_ARGS
+    bool I2CQUEUE_TEMPLATE_QUALIFIER::Write(uint16_t devAddr, uint16_t regAddr, const uint8_t* data, uint16_t size, I2cCallback callback, I2cPriority priority, I2cOpts opts)
+    {
+        return Enqueue(I2cTransaction {devAddr, regAddr, const_cast<uint8_t*>(data), size, I2cMode::Write, opts, callback}, priority);
+    }
+
+    I2CQUEUE_TEMPLATE_ARGS
+    unsigned I2CQUEUE_TEMPLATE_QUALIFIER::Pending()
+    {
+        unsigned pending = 0;
+        for(const Queue& queue : _queues)
+            pending += queue.size();
+        return pending;
+    }
+
+    I2CQUEUE_TEMPLATE_ARGS
+    bool I2CQUEUE_TEMPLATE_QUALIFIER::Busy()
+    {
+        return _busy || Pending() > 0;
+    }
+
+    I2CQUEUE_TEMPLATE_ARGS
+    bool I2CQUEUE_TEMPLATE_QUALIFIER::CanMerge(const I2cTransaction& transaction, unsigned mergedSize)
+    {
+        const I2cTransaction& last = _active[_activeCount - 1];
+
+        return transaction.Mode == I2cMode::Read
+            && transaction.DevAddr == last.DevAddr
+            && transaction.Opts == last.Opts
+            && transaction.RegAddr == last.RegAddr + last.Size
+            && mergedSize + transaction.Size <= _MergeBufferSize;
+    }
+
+    I2CQUEUE_TEMPLATE_ARGS
+    void I2CQUEUE_TEMPLATE_QUALIFIER::StartNext()
+    {
+        uint32_t state = DriverCriticalSection::Enter();
+
+        Queue* queue = nullptr;
+        for(unsigned i = PrioritiesCount; i > 0 && queue == nullptr; --i)
+        {
+            if(!_queues[i - 1].empty())
+                queue = &_queues[i - 1];
+        }
+
+        if(_busy || queue == nullptr)
+        {
+            DriverCriticalSection::Leave(state);
+            return;
+        }
+
+        _active[0] = queue->front();
+        queue->pop_front();
+        _activeCount = 1;
+        unsigned size = _active[0].Size;
+
+        if constexpr (_MergeBufferSize > 0)
+        {
+            if(_active[0].Mode == I2cMode::Read
+                && !HasAllFlags(_active[0].Opts, I2cOpts::RegAddrNone)
+                && _active[0].Size <= _MergeBufferSize)
+            {
+                while(_activeCount < MaxMergedReads && !queue->empty() && CanMerge(queue->front(), size))
+                {
+                    size += queue->front().Size;
+                    _active[_activeCount++] = queue->front();
+                    queue->pop_front();
+                }
+            }
+        }
+
+        _busy = true;
+        DriverCriticalSection::Leave(state);
+
+        const I2cTransaction& first = _active[0];
+        I2cStatus status = first.Mode == I2cMode::Read
+            ? _I2c::EnableAsyncRead(first.DevAddr, first.RegAddr, _activeCount > 1 ? _mergeBuffer : first.Buffer, size, first.Opts, OnComplete)
+            : _I2c::WriteAsync(first.DevAddr, first.RegAddr, first.Buffer, size, first.Opts, OnComplete);
+
+        if(status != I2cStatus::Success)
+            OnComplete(status);
+    }
+
+    I2CQUEUE_TEMPLATE_ARGS
+    void I2CQUEUE_TEMPLATE_QUALIFIER::OnComplete(I2cStatus status)
+    {
+        const uint8_t* merged = _mergeBuffer;
+        for(unsigned i = 0; i < _activeCount; ++i)
+        {
+            I2cTransaction& transaction = _active[i];
+            if(_activeCount > 1)
+            {
+                if(status == I2cStatus::Success)
+                    memcpy(transaction.Buffer, merged, transaction.Size);
+                merged += transaction.Size;
+            }
+
+            if(transaction.Callback)
+                transaction.Callback(status);
+        }
+
+        _activeCount = 0;
+        _busy = false;
+        StartNext();
+    }
+}
+
+#endif //! ZHELE_I2C_QUEUE_IMPL_COMMON_H
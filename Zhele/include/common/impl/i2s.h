@@ -0,0 +1,154 @@
+/**
+ * @file
+ * I2S methods implementation
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_I2S_IMPL_COMMON_H
+#define ZHELE_I2S_IMPL_COMMON_H
+
+namespace Zhele
+{
+    constexpr uint32_t I2sBase::FrameDivider(DataFormat format, bool masterClock)
+    {
+        // Fs = I2SCLK / (divider * (2 * I2SDIV + ODD))
+        if(masterClock)
+            return 256;
+        return format == DataFormat::Data16Bit ? 32 : 64;
+    }
+
+    constexpr uint16_t I2sBase::CalculatePrescaler(uint32_t i2sClock, uint32_t sampleRate, DataFormat format, bool masterClock)
+    {
+        if(sampleRate == 0)
+            return 0;
+        uint64_t bitClock = static_cast<uint64_t>(sampleRate) * FrameDivider(format, masterClock);
+        uint64_t divider = (i2sClock + bitClock / 2) / bitClock;
+        if(divider < 4 || divider > 511)
+            return 0;
+        return static_cast<uint16_t>((divider >> 1)
+            | ((divider & 1) != 0 ? SPI_I2SPR_ODD : 0)
+            | (masterClock ? SPI_I2SPR_MCKOE : 0));
+    }
+
+    constexpr I2sBase::ClockConfig I2sBase::CalculateClock(uint32_t pllInput, uint32_t sampleRate, DataFormat format, bool masterClock)
+    {
+        ClockConfig best {0, 0, 0, 0};
+        uint64_t bestError = UINT64_MAX;
+        const uint32_t divider = FrameDivider(format, masterClock);
+
+        for(uint32_t n = 50; n <= 432; ++n)
+        {
+            uint64_t vco = static_cast<uint64_t>(pllInput) * n;
+            if(vco < 100000000 || vco > 432000000)
+                continue;
+            for(uint32_t r = 2; r <= 7; ++r)
+            {
+                uint32_t i2sClock = static_cast<uint32_t>(vco / r);
+                if(i2sClock > 192000000)
+                    continue;
+                uint16_t prescaler = CalculatePrescaler(i2sClock, sampleRate, format, masterClock);
+                if(prescaler == 0)
+                    continue;
+                uint32_t value = ((prescaler & 0xff) << 1) | ((prescaler & SPI_I2SPR_ODD) != 0 ? 1 : 0);
+                uint32_t actual = i2sClock / (divider * value);
+                uint64_t error = actual > sampleRate ? actual - sampleRate : sampleRate - actual;
+                if(error < bestError)
+                {
+                    bestError = error;
+                    best = ClockConfig {static_cast<uint16_t>(n), static_cast<uint8_t>(r), prescaler, actual};
+                }
+            }
+        }
+        return best;
+    }
+
+    namespace Private
+    {
+        #define I2S_TEMPLATE_ARGS template<typename _Regs, typename _ClockCtrl, typename _I2sClock, typename _SdPins, typename _CkPins, typename _WsPins, typename _MckPins, typename _DmaTx, typename _DmaRx>
+        #define I2S_TEMPLATE_QUALIFIER I2s<_Regs, _ClockCtrl, _I2sClock, _SdPins, _CkPins, _WsPins, _MckPins, _DmaTx, _DmaRx>
+
+        I2S_TEMPLATE_ARGS
+        bool I2S_TEMPLATE_QUALIFIER::Init(uint32_t sampleRate, Mode mode, Standard standard, DataFormat format, bool masterClock)
+        {
+            ClockConfig config = CalculateClock(_I2sClock::SrcClockFreq(), sampleRate, format, masterClock);
+            if(config.Prescaler == 0)
+                return false;
+
+            _I2sClock::Disable();
+            _I2sClock::SetMultiplier(config.PllN);
+            _I2sClock::SetOutputDivider(config.PllR);
+            if(!_I2sClock::Enable())
+                return false;
+
+            _ClockCtrl::Enable();
+            _Regs()->I2SCFGR = 0;
+            _Regs()->I2SPR = config.Prescaler;
+            _Regs()->I2SCFGR = SPI_I2SCFGR_I2SMOD
+                | static_cast<uint16_t>(mode)
+                | static_cast<uint16_t>(standard)
+                | static_cast<uint16_t>(format);
+            _sampleRate = config.SampleRate;
+            return true;
+        }
+
+        I2S_TEMPLATE_ARGS
+        uint32_t I2S_TEMPLATE_QUALIFIER::SampleRate()
+        {
+            return _sampleRate;
+        }
+
+        I2S_TEMPLATE_ARGS
+        void I2S_TEMPLATE_QUALIFIER::StartWriteStream(const uint16_t* buffer, uint16_t halfSize, TransferCallback callback)
+        {
+            _DmaTx::SetTransferCallback(callback);
+            _DmaTx::PingPongTransfer(_DmaTx::Mem2Periph | _DmaTx::MemIncrement | _DmaTx::PriorityHigh | _DmaTx::PSize16Bits | _DmaTx::MSize16Bits,
+                const_cast<uint16_t*>(buffer), &_Regs()->DR, halfSize);
+            _Regs()->CR2 |= SPI_CR2_TXDMAEN;
+            _Regs()->I2SCFGR |= SPI_I2SCFGR_I2SE;
+        }
+
+        I2S_TEMPLATE_ARGS
+        void I2S_TEMPLATE_QUALIFIER::StartReadStream(uint16_t* buffer, uint16_t halfSize, TransferCallback callback)
+        {
+            _DmaRx::SetTransferCallback(callback);
+            _DmaRx::PingPongTransfer(_DmaRx::Periph2Mem | _DmaRx::MemIncrement | _DmaRx::PriorityHigh | _DmaRx::PSize16Bits | _DmaRx::MSize16Bits,
+                buffer, &_Regs()->DR, halfSize);
+            _Regs()->CR2 |= SPI_CR2_RXDMAEN;
+            // Master receiver starts clocking immediately after enable
+            _Regs()->I2SCFGR |= SPI_I2SCFGR_I2SE;
+        }
+
+        I2S_TEMPLATE_ARGS
+        void I2S_TEMPLATE_QUALIFIER::StopStream()
+        {
+            _Regs()->I2SCFGR &= ~SPI_I2SCFGR_I2SE;
+            _Regs()->CR2 &= ~(SPI_CR2_TXDMAEN | SPI_CR2_RXDMAEN);
+            _DmaTx::Disable();
+            _DmaRx::Disable();
+        }
+
+        I2S_TEMPLATE_ARGS
+        template<typename SdPin, typename CkPin, typename WsPin, typename MckPin>
+        void I2S_TEMPLATE_QUALIFIER::SelectPins()
+        {
+            const int8_t sdPinIndex = TypeIndex<SdPin, typename _SdPins::PinsAsTypeList>::value;
+            const int8_t ckPinIndex = TypeIndex<CkPin, typename _CkPins::PinsAsTypeList>::value;
+            const int8_t wsPinIndex = TypeIndex<WsPin, typename _WsPins::PinsAsTypeList>::value;
+            const int8_t mckPinIndex = !std::is_same_v<MckPin, IO::NullPin>
+                                ? TypeIndex<MckPin, typename _MckPins::PinsAsTypeList>::value
+                                : -1;
+
+            static_assert(sdPinIndex >= 0);
+            static_assert(ckPinIndex >= 0);
+            static_assert(wsPinIndex >= 0);
+            static_assert(mckPinIndex >= -1);
+
+            SelectPins<sdPinIndex, ckPinIndex, wsPinIndex, mckPinIndex>();
+        }
+    }
+}
+
+#endif //! ZHELE_I2S_IMPL_COMMON_H
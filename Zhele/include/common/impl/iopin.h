@@ -123,6 +123,14 @@ namespace Zhele::IO
 		_ConfigPort::template AltFuncNumber<1u << _Pin, funcNumber>();
 	}
 
+	template<typename _Port, uint8_t _Pin, typename _ConfigPort>
+	template<typename TPin<_Port, _Pin, _ConfigPort>::Configuration configuration, typename TPin<_Port, _Pin, _ConfigPort>::Speed speed,
+		typename TPin<_Port, _Pin, _ConfigPort>::DriverType driverType, typename TPin<_Port, _Pin, _ConfigPort>::PullMode pullMode, uint8_t funcNumber>
+	void TPin<_Port, _Pin, _ConfigPort>::Configure()
+	{
+		_ConfigPort::template Configure<1u << _Pin, configuration, speed, driverType, pullMode, funcNumber>();
+	}
+
 	template<typename _Port, uint8_t _Pin, typename _ConfigPort>
 	bool TPin<_Port, _Pin, _ConfigPort>::IsSet()
 	{
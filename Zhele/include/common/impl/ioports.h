@@ -147,8 +147,35 @@ namespace Zhele::IO::Private
     template<typename PORTIMPL_TEMPLATE_QUALIFIER::DataType mask, uint8_t number>
     void PORTIMPL_TEMPLATE_QUALIFIER::AltFuncNumber()
     {
-        _Regs()->AFR[0] = UnpackConfig4Bit(mask & 0xff, _Regs()->AFR[0], number);
-        _Regs()->AFR[1] = UnpackConfig4Bit((mask >> 8) & 0xff, _Regs()->AFR[1], number);
+        if constexpr ((mask & 0xff) != 0)
+            _Regs()->AFR[0] = UnpackConfig4Bit(mask & 0xff, _Regs()->AFR[0], number);
+        if constexpr ((mask >> 8) != 0)
+            _Regs()->AFR[1] = UnpackConfig4Bit((mask >> 8) & 0xff, _Regs()->AFR[1], number);
+    }
+
+    PORTIMPL_TEMPLATE_ARGS
+    template<typename PORTIMPL_TEMPLATE_QUALIFIER::DataType mask, typename PORTIMPL_TEMPLATE_QUALIFIER::Configuration configuration,
+        typename PORTIMPL_TEMPLATE_QUALIFIER::Speed speed, typename PORTIMPL_TEMPLATE_QUALIFIER::DriverType driver,
+        typename PORTIMPL_TEMPLATE_QUALIFIER::PullMode pull, uint8_t number>
+    void PORTIMPL_TEMPLATE_QUALIFIER::Configure()
+    {
+        constexpr unsigned modeMask = UnpackConfig2bits(mask, 0, 0x03);
+        constexpr unsigned lowAfMask = UnpackConfig4Bit(mask & 0xff, 0, 0x0f);
+        constexpr unsigned highAfMask = UnpackConfig4Bit((mask >> 8) & 0xff, 0, 0x0f);
+
+        if constexpr (configuration != Analog)
+        {
+            _Regs()->OTYPER = (_Regs()->OTYPER & ~mask) | mask * driver;
+            _Regs()->OSPEEDR = (_Regs()->OSPEEDR & ~modeMask) | UnpackConfig2bits(mask, 0, speed);
+        }
+        _Regs()->PUPDR = (_Regs()->PUPDR & ~modeMask) | UnpackConfig2bits(mask, 0, pull);
+
+        if constexpr (configuration == AltFunc && lowAfMask != 0)
+            _Regs()->AFR[0] = (_Regs()->AFR[0] & ~lowAfMask) | UnpackConfig4Bit(mask & 0xff, 0, number);
+        if constexpr (configuration == AltFunc && highAfMask != 0)
+            _Regs()->AFR[1] = (_Regs()->AFR[1] & ~highAfMask) | UnpackConfig4Bit((mask >> 8) & 0xff, 0, number);
+
+        _Regs()->MODER = (_Regs()->MODER & ~modeMask) | UnpackConfig2bits(mask, 0, configuration);
     }
 
     PORTIMPL_TEMPLATE_ARGS
@@ -162,5 +189,11 @@ namespace Zhele::IO::Private
     {
         _ClkEnReg::Disable();
     }
+
+    PORTIMPL_TEMPLATE_ARGS
+    GPIO_TypeDef* PORTIMPL_TEMPLATE_QUALIFIER::Regs()
+    {
+        return _Regs::Get();
+    }
 }
 #endif //! ZHELE_IOPORTS_IMPL_COMMON_H
\ No newline at end of file
@@ -0,0 +1,114 @@
+/**
+ * @file
+ * Implements deferred binary logging
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_LOG_IMPL_COMMON_H
+#define ZHELE_LOG_IMPL_COMMON_H
+
+namespace Zhele::Log
+{
+    template<unsigned _Size>
+    Containers::RingBuffer<_Size, uint32_t> LogBuffer<_Size>::_buffer;
+    template<unsigned _Size>
+    Containers::SingleWriterValue<uint32_t> LogBuffer<_Size>::_dropped = 0;
+
+    template<unsigned _Size>
+    void LogBuffer<_Size>::Enable()
+    {
+#if defined (DWT)
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+    }
+
+    template<unsigned _Size>
+    template<TemplateUtils::fixed_string _Format, typename... _Args>
+    void LogBuffer<_Size>::Write(_Args... args)
+    {
+        static_assert(Format<_Format>::ArgumentsCount >= 0, "Unsupported format conversion (d, i, u, x, X, c, f, e, g, p are supported)");
+        static_assert(Format<_Format>::ArgumentsCount == sizeof...(_Args), "Arguments count does not match format");
+        static_assert(2 + sizeof...(_Args) <= _Size, "Record does not fit to log buffer");
+
+        const uint32_t record[] = {(Format<_Format>::Id << 8) | sizeof...(_Args), Timestamp(), Private::Encode(args)...};
+        WriteRecord(record, sizeof(record) / sizeof(uint32_t));
+    }
+
+    template<unsigned _Size>
+    void LogBuffer<_Size>::WriteRecord(const uint32_t* words, unsigned count)
+    {
+        uint32_t state = DriverCriticalSection::Enter();
+        if(static_cast<unsigned>(_buffer.capacity() - _buffer.size()) >= count)
+            _buffer.write(words, count);
+        else
+            _dropped.store(_dropped.load() + 1);
+        DriverCriticalSection::Leave(state);
+    }
+
+    template<unsigned _Size>
+    uint32_t LogBuffer<_Size>::Timestamp()
+    {
+#if defined (DWT)
+        return DWT->CYCCNT;
+#else
+        return 0;
+#endif
+    }
+
+    template<unsigned _Size>
+    unsigned LogBuffer<_Size>::Read(uint32_t* words, unsigned count)
+    {
+        return _buffer.read(words, count);
+    }
+
+    template<unsigned _Size>
+    uint32_t LogBuffer<_Size>::Dropped()
+    {
+        return _dropped.load();
+    }
+
+    template<unsigned _Size>
+    void LogBuffer<_Size>::DrainItm()
+    {
+#if defined (ITM)
+        if((ITM->TCR & ITM_TCR_ITMENA_Msk) == 0 || (ITM->TER & (1UL << ZHELE_LOG_ITM_PORT)) == 0)
+            return;
+
+        uint32_t word;
+        while(_buffer.read(&word, 1) != 0)
+        {
+            while(ITM->PORT[ZHELE_LOG_ITM_PORT].u32 == 0)
+                continue;
+            ITM->PORT[ZHELE_LOG_ITM_PORT].u32 = word;
+        }
+#endif
+    }
+
+    template<unsigned _Size>
+    template<typename _Usart>
+    bool LogBuffer<_Size>::DrainUsart()
+    {
+        static Containers::SingleWriterValue<uint32_t> pending = 0;
+
+        if(pending.load() != 0)
+            return false;
+
+        // Only contiguous part is sent, the rest (after buffer end) is sent by the next call
+        auto span = _buffer.peek_read_span().first;
+        if(span.size == 0)
+            return false;
+
+        pending.store(span.size);
+        _Usart::WriteAsync(span.data, span.size * sizeof(uint32_t), [](void*, unsigned, bool) {
+            _buffer.consume(pending.load());
+            pending.store(0);
+        });
+        return true;
+    }
+}
+
+#endif //! ZHELE_LOG_IMPL_COMMON_H
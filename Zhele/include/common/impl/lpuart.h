@@ -0,0 +1,71 @@
+/**
+ * @file
+ * LPUART methods implementation
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_LPUART_IMPL_COMMON_H
+#define ZHELE_LPUART_IMPL_COMMON_H
+
+namespace Zhele::Private
+{
+    #define LPUART_TEMPLATE_ARGS template<typename _Regs, IRQn_Type _IRQNumber, typename _ClockCtrl, typename _TxPins, typename _RxPins, typename _DmaTx, typename _DmaRx>
+    #define LPUART_TEMPLATE_QUALIFIER LpUart<_Regs, _IRQNumber, _ClockCtrl, _TxPins, _RxPins, _DmaTx, _DmaRx>
+
+    LPUART_TEMPLATE_ARGS
+    template<unsigned long baud>
+    void LPUART_TEMPLATE_QUALIFIER::Init(UsartBase::UsartMode mode)
+    {
+        Init(baud, mode);
+    }
+
+    LPUART_TEMPLATE_ARGS
+    void LPUART_TEMPLATE_QUALIFIER::Init(unsigned baud, UsartBase::UsartMode mode)
+    {
+        // OVER8 bit is reserved
+        uint32_t cr1 = mode.CR1 & ~USART_CR1_OVER8;
+        _ClockCtrl::Enable();
+        _Regs()->CR1 = cr1;
+        SetBaud(baud);
+        _Regs()->CR3 = mode.CR3;
+        _Regs()->CR2 = mode.CR2;
+        _Regs()->CR1 = cr1 | USART_CR1_UE;
+    }
+
+    LPUART_TEMPLATE_ARGS
+    void LPUART_TEMPLATE_QUALIFIER::SetBaud(unsigned baud)
+    {
+        uint32_t brr = CalculateBrr(_ClockCtrl::ClockFreq(), baud);
+        if(brr == 0)
+            return;
+
+        // BRR is written only while LPUART is disabled
+        uint32_t cr1 = _Regs()->CR1;
+        _Regs()->CR1 = cr1 & ~USART_CR1_UE;
+        _Regs()->BRR = brr;
+        _Regs()->CR1 = cr1;
+    }
+
+    LPUART_TEMPLATE_ARGS
+    unsigned LPUART_TEMPLATE_QUALIFIER::GetBaud()
+    {
+        uint32_t brr = _Regs()->BRR;
+        return brr != 0 ? (static_cast<uint64_t>(_ClockCtrl::ClockFreq()) << 8) / brr : 0;
+    }
+
+    LPUART_TEMPLATE_ARGS
+    constexpr uint32_t LPUART_TEMPLATE_QUALIFIER::CalculateBrr(uint32_t clock, uint32_t baud)
+    {
+        if(baud == 0)
+            return 0;
+
+        uint64_t brr = ((static_cast<uint64_t>(clock) << 8) + baud / 2) / baud;
+        // BRR is 20-bit, values below 0x300 are forbidden
+        return (brr >= 0x300 && brr <= 0xfffff) ? static_cast<uint32_t>(brr) : 0;
+    }
+}
+
+#endif //! ZHELE_LPUART_IMPL_COMMON_H
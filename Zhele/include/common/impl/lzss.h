@@ -0,0 +1,200 @@
+/**
+ * @file
+ * Implements streaming LZSS compressor
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_LZSS_IMPL_COMMON_H
+#define ZHELE_LZSS_IMPL_COMMON_H
+
+#define LZSS_ENCODER_TEMPLATE_ARGS template<unsigned _WindowBits, unsigned _LengthBits, unsigned _OutputSize>
+#define LZSS_ENCODER_TEMPLATE_QUALIFIER LzssEncoder<_WindowBits, _LengthBits, _OutputSize>
+
+namespace Zhele::Compression
+{
+    LZSS_ENCODER_TEMPLATE_ARGS
+    LZSS_ENCODER_TEMPLATE_QUALIFIER::LzssEncoder()
+    {
+        Reset();
+    }
+
+    LZSS_ENCODER_TEMPLATE_ARGS
+    void LZSS_ENCODER_TEMPLATE_QUALIFIER::Reset()
+    {
+        // Empty chain entries are rejected by distance check (candidate before stream start)
+        for (unsigned i = 0; i < HashSize; ++i)
+            _head[i] = 0;
+        for (unsigned i = 0; i < WindowSize; ++i)
+            _previous[i] = 0;
+        _inputEnd = 0;
+        _position = 0;
+        _syncPosition = 0;
+        _outputTotal = 0;
+        _bits = 0;
+        _bitCount = 0;
+        _outputCount = 0;
+    }
+
+    LZSS_ENCODER_TEMPLATE_ARGS
+    template<typename _Sink>
+    void LZSS_ENCODER_TEMPLATE_QUALIFIER::Write(const void* data, unsigned size, _Sink& sink)
+    {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        while (size > 0)
+        {
+            // Ring keeps window before current position and pending bytes
+            if (_inputEnd - _position >= WindowSize)
+            {
+                Encode(MaxMatch - 1, sink);
+                continue;
+            }
+            _ring[_inputEnd & (RingSize - 1)] = *bytes++;
+            ++_inputEnd;
+            --size;
+        }
+        Encode(MaxMatch - 1, sink);
+    }
+
+    LZSS_ENCODER_TEMPLATE_ARGS
+    template<typename _Sink>
+    void LZSS_ENCODER_TEMPLATE_QUALIFIER::Flush(_Sink& sink)
+    {
+        Encode(0, sink);
+        if (_syncPosition != _position)
+        {
+            PutBits(0, 1 + _WindowBits, sink);
+            if (_bitCount != 0)
+                PutBits(0, 8 - _bitCount, sink);
+            _syncPosition = _position;
+        }
+        FlushOutput(sink);
+    }
+
+    LZSS_ENCODER_TEMPLATE_ARGS
+    template<typename _Sink>
+    void LZSS_ENCODER_TEMPLATE_QUALIFIER::Finish(_Sink& sink)
+    {
+        Flush(sink);
+        Reset();
+    }
+
+    LZSS_ENCODER_TEMPLATE_ARGS
+    uint32_t LZSS_ENCODER_TEMPLATE_QUALIFIER::InputSize() const
+    {
+        return _inputEnd;
+    }
+
+    LZSS_ENCODER_TEMPLATE_ARGS
+    uint32_t LZSS_ENCODER_TEMPLATE_QUALIFIER::OutputSize() const
+    {
+        return _outputTotal;
+    }
+
+    LZSS_ENCODER_TEMPLATE_ARGS
+    template<typename _Sink>
+    void LZSS_ENCODER_TEMPLATE_QUALIFIER::Encode(unsigned minPending, _Sink& sink)
+    {
+        while (_inputEnd - _position > minPending)
+        {
+            unsigned pending = _inputEnd - _position;
+            unsigned offset = 0;
+            unsigned length = FindMatch(_position, pending < MaxMatch ? pending : MaxMatch, offset);
+
+            if (length >= MinMatch)
+            {
+                PutBits((offset << _LengthBits) | (length - MinMatch), 1 + _WindowBits + _LengthBits, sink);
+            }
+            else
+            {
+                length = 1;
+                PutBits(0x100 | _ring[_position & (RingSize - 1)], 9, sink);
+            }
+
+            for (unsigned i = 0; i < length; ++i, ++_position)
+            {
+                if (_position + 1 < _inputEnd)
+                    Insert(_position);
+            }
+        }
+    }
+
+    LZSS_ENCODER_TEMPLATE_ARGS
+    template<typename _Sink>
+    void LZSS_ENCODER_TEMPLATE_QUALIFIER::PutBits(uint32_t value, unsigned count, _Sink& sink)
+    {
+        _bits = (_bits << count) | value;
+        _bitCount += count;
+        while (_bitCount >= 8)
+        {
+            _bitCount -= 8;
+            _output[_outputCount++] = static_cast<uint8_t>(_bits >> _bitCount);
+            ++_outputTotal;
+            if (_outputCount == _OutputSize)
+                FlushOutput(sink);
+        }
+    }
+
+    LZSS_ENCODER_TEMPLATE_ARGS
+    template<typename _Sink>
+    void LZSS_ENCODER_TEMPLATE_QUALIFIER::FlushOutput(_Sink& sink)
+    {
+        if (_outputCount == 0)
+            return;
+        sink.Write(_output, _outputCount);
+        _outputCount = 0;
+    }
+
+    LZSS_ENCODER_TEMPLATE_ARGS
+    unsigned LZSS_ENCODER_TEMPLATE_QUALIFIER::Hash(uint32_t position) const
+    {
+        unsigned first = _ring[position & (RingSize - 1)];
+        unsigned second = _ring[(position + 1) & (RingSize - 1)];
+        return ((first << 3) ^ (first >> 5) ^ second) & (HashSize - 1);
+    }
+
+    LZSS_ENCODER_TEMPLATE_ARGS
+    void LZSS_ENCODER_TEMPLATE_QUALIFIER::Insert(uint32_t position)
+    {
+        unsigned hash = Hash(position);
+        _previous[position & (WindowSize - 1)] = _head[hash];
+        _head[hash] = static_cast<uint16_t>(position);
+    }
+
+    LZSS_ENCODER_TEMPLATE_ARGS
+    unsigned LZSS_ENCODER_TEMPLATE_QUALIFIER::FindMatch(uint32_t position, unsigned maxLength, unsigned& offset) const
+    {
+        if (maxLength < MinMatch || maxLength < 2)
+            return 0;
+
+        unsigned bestLength = 0;
+        unsigned lastDistance = 0;
+        uint16_t candidate = _head[Hash(position)];
+        for (unsigned i = 0; i < MaxCandidates; ++i)
+        {
+            // Positions are stored by low 16 bits, chain is valid while distance grows
+            unsigned distance = static_cast<uint16_t>(static_cast<uint16_t>(position) - candidate);
+            if (distance <= lastDistance || distance >= WindowSize || distance > position)
+                break;
+            lastDistance = distance;
+
+            uint32_t start = position - distance;
+            unsigned length = 0;
+            while (length < maxLength && _ring[(start + length) & (RingSize - 1)] == _ring[(position + length) & (RingSize - 1)])
+                ++length;
+            if (length > bestLength)
+            {
+                bestLength = length;
+                offset = distance;
+                if (length == maxLength)
+                    break;
+            }
+            candidate = _previous[start & (WindowSize - 1)];
+        }
+        return bestLength;
+    }
+}
+
+#endif //! ZHELE_LZSS_IMPL_COMMON_H
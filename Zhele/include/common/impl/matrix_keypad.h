@@ -0,0 +1,115 @@
+/**
+ * @file
+ * Matrix keypad methods implementation
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_MATRIX_KEYPAD_IMPL_COMMON_H
+#define ZHELE_MATRIX_KEYPAD_IMPL_COMMON_H
+
+namespace Zhele::IO
+{
+    #define MATRIX_KEYPAD_TEMPLATE_ARGS template<typename _Rows, typename _Columns, typename _Timer, typename _RowDma, typename _ColumnDma, unsigned _Channel>
+    #define MATRIX_KEYPAD_TEMPLATE_QUALIFIER MatrixKeypad<_Rows, _Columns, _Timer, _RowDma, _ColumnDma, _Channel>
+
+    MATRIX_KEYPAD_TEMPLATE_ARGS
+    uint32_t MATRIX_KEYPAD_TEMPLATE_QUALIFIER::_rowWords[RowsCount];
+    MATRIX_KEYPAD_TEMPLATE_ARGS
+    uint16_t MATRIX_KEYPAD_TEMPLATE_QUALIFIER::_samples[2 * RowsCount];
+    MATRIX_KEYPAD_TEMPLATE_ARGS
+    Debouncer<typename MATRIX_KEYPAD_TEMPLATE_QUALIFIER::KeysType> MATRIX_KEYPAD_TEMPLATE_QUALIFIER::_debouncer;
+    MATRIX_KEYPAD_TEMPLATE_ARGS
+    typename MATRIX_KEYPAD_TEMPLATE_QUALIFIER::Callback MATRIX_KEYPAD_TEMPLATE_QUALIFIER::_callback = nullptr;
+
+    MATRIX_KEYPAD_TEMPLATE_ARGS
+    void MATRIX_KEYPAD_TEMPLATE_QUALIFIER::Init(uint32_t rowsRate)
+    {
+        _Rows::Enable();
+        _Rows::Write(static_cast<typename _Rows::DataType>(-1));
+        _Rows::template SetConfiguration<_Rows::Configuration::Out>();
+        _Rows::template SetDriverType<_Rows::DriverType::OpenDrain>();
+
+        _Columns::Enable();
+        _Columns::template SetConfiguration<_Columns::Configuration::In>();
+        _Columns::template SetPullMode<_Columns::PullMode::PullUp>();
+
+        // Only one row is driven low at a time
+        for(unsigned row = 0; row < RowsCount; ++row)
+            _rowWords[row] = RowsStreamer::Encode(static_cast<typename _Rows::DataType>(~(1u << row)));
+
+        _Timer::Enable();
+        _Timer::SetUpdateRate(rowsRate);
+        // Columns are sampled in the middle of row period
+        Compare::SetPulse(_Timer::GetPeriod() / 2);
+    }
+
+    MATRIX_KEYPAD_TEMPLATE_ARGS
+    void MATRIX_KEYPAD_TEMPLATE_QUALIFIER::Start(Callback callback
+        ONLY_IF_STREAM_SUPPORTED(COMMA uint8_t rowDmaChannel COMMA uint8_t columnDmaChannel))
+    {
+        _callback = callback;
+
+        _Timer::Stop();
+        _RowDma::ClearTransferComplete();
+        _RowDma::Transfer(_RowDma::Mem2Periph | _RowDma::MemIncrement | _RowDma::Circular | _RowDma::PSize32Bits | _RowDma::MSize32Bits
+            | _RowDma::PriorityVeryHigh, _rowWords, &RowsStreamer::Port::Regs()->BSRR, RowsCount ONLY_IF_STREAM_SUPPORTED(COMMA rowDmaChannel));
+        _ColumnDma::SetTransferCallback(OnScan);
+        _ColumnDma::PingPongTransfer(_ColumnDma::Periph2Mem | _ColumnDma::MemIncrement | _ColumnDma::PSize16Bits | _ColumnDma::MSize16Bits
+            | _ColumnDma::PriorityVeryHigh, _samples, &ColumnsSampler::Port::Regs()->IDR, RowsCount ONLY_IF_STREAM_SUPPORTED(COMMA columnDmaChannel));
+
+        _Timer::DmaRequestEnable();
+        Compare::EnableDmaRequest();
+        // Start generates update event: first row is selected before first compare event
+        _Timer::Start();
+    }
+
+    MATRIX_KEYPAD_TEMPLATE_ARGS
+    void MATRIX_KEYPAD_TEMPLATE_QUALIFIER::Stop()
+    {
+        _Timer::Stop();
+        _Timer::DmaRequestDisable();
+        Compare::DisableDmaRequest();
+        _RowDma::Disable();
+        _ColumnDma::Disable();
+        _Rows::Write(static_cast<typename _Rows::DataType>(-1));
+    }
+
+    MATRIX_KEYPAD_TEMPLATE_ARGS
+    typename MATRIX_KEYPAD_TEMPLATE_QUALIFIER::KeysType MATRIX_KEYPAD_TEMPLATE_QUALIFIER::State()
+    {
+        return _debouncer.State();
+    }
+
+    MATRIX_KEYPAD_TEMPLATE_ARGS
+    typename MATRIX_KEYPAD_TEMPLATE_QUALIFIER::KeysType MATRIX_KEYPAD_TEMPLATE_QUALIFIER::Pressed()
+    {
+        return _debouncer.Pressed();
+    }
+
+    MATRIX_KEYPAD_TEMPLATE_ARGS
+    typename MATRIX_KEYPAD_TEMPLATE_QUALIFIER::KeysType MATRIX_KEYPAD_TEMPLATE_QUALIFIER::Released()
+    {
+        return _debouncer.Released();
+    }
+
+    MATRIX_KEYPAD_TEMPLATE_ARGS
+    void MATRIX_KEYPAD_TEMPLATE_QUALIFIER::OnScan(void* data, [[maybe_unused]] unsigned size, [[maybe_unused]] bool success)
+    {
+        constexpr KeysType columnsMask = (KeysType(1) << ColumnsCount) - 1;
+        const uint16_t* samples = static_cast<const uint16_t*>(data);
+
+        // Pressed key pulls its column low
+        KeysType keys = 0;
+        for(unsigned row = 0; row < RowsCount; ++row)
+            keys |= (~static_cast<KeysType>(ColumnsSampler::Extract(samples[row])) & columnsMask) << (row * ColumnsCount);
+
+        KeysType changed = _debouncer.Update(keys);
+        if(changed != 0 && _callback != nullptr)
+            _callback(changed);
+    }
+}
+
+#endif //! ZHELE_MATRIX_KEYPAD_IMPL_COMMON_H
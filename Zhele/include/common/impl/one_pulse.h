@@ -0,0 +1,107 @@
+/**
+ * @file
+ * One-pulse helper methods implementation
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_ONE_PULSE_IMPL_COMMON_H
+#define ZHELE_ONE_PULSE_IMPL_COMMON_H
+
+namespace Zhele::Timers
+{
+    #define ONE_PULSE_TEMPLATE_ARGS template<typename _Timer, typename _Pin, unsigned _Channel>
+    #define ONE_PULSE_TEMPLATE_QUALIFIER OnePulse<_Timer, _Pin, _Channel>
+
+    ONE_PULSE_TEMPLATE_ARGS
+    typename ONE_PULSE_TEMPLATE_QUALIFIER::Callback ONE_PULSE_TEMPLATE_QUALIFIER::_callback = nullptr;
+    ONE_PULSE_TEMPLATE_ARGS
+    volatile bool ONE_PULSE_TEMPLATE_QUALIFIER::_busy = false;
+
+    ONE_PULSE_TEMPLATE_ARGS
+    void ONE_PULSE_TEMPLATE_QUALIFIER::Init(uint32_t tickFrequency)
+    {
+        _Timer::Enable();
+        _Timer::SetPrescaler(_Timer::GetClockFreq() / tickFrequency - 1);
+        _Timer::EnableOnePulseMode();
+
+        if constexpr (HasOutput)
+        {
+            using Output = typename _Timer::template OutputCompare<_Channel>;
+            Output::template SelectPins<_Pin>();
+            Output::SetOutputMode(Output::OutputMode::PWM2);
+            // Pin is inactive until first pulse (counter is below compare value)
+            Output::SetPulse(1);
+            Output::Enable();
+        }
+    }
+
+    ONE_PULSE_TEMPLATE_ARGS
+    bool ONE_PULSE_TEMPLATE_QUALIFIER::Delay(Counter duration, Callback callback)
+    {
+        if(_busy)
+            return false;
+        Start(duration > 0 ? duration - 1 : 0, callback);
+        return true;
+    }
+
+    ONE_PULSE_TEMPLATE_ARGS
+    bool ONE_PULSE_TEMPLATE_QUALIFIER::Pulse(Counter width, Counter delay, Callback callback)
+    {
+        static_assert(HasOutput, "Pulse requires output pin");
+        if(_busy)
+            return false;
+
+        // Zero compare value keeps pin active after pulse
+        if(delay == 0)
+            delay = 1;
+        if(width == 0)
+            width = 1;
+        _Timer::template OutputCompare<_Channel>::SetPulse(delay);
+        Start(delay + width - 1, callback);
+        return true;
+    }
+
+    ONE_PULSE_TEMPLATE_ARGS
+    bool ONE_PULSE_TEMPLATE_QUALIFIER::Busy()
+    {
+        return _busy;
+    }
+
+    ONE_PULSE_TEMPLATE_ARGS
+    void ONE_PULSE_TEMPLATE_QUALIFIER::Wait()
+    {
+        while(_busy)
+            continue;
+    }
+
+    ONE_PULSE_TEMPLATE_ARGS
+    void ONE_PULSE_TEMPLATE_QUALIFIER::IrqHandler()
+    {
+        if(!_Timer::IsInterrupt())
+            return;
+        _Timer::ClearInterruptFlag();
+        // Counter has been stopped by hardware
+        _busy = false;
+        if(_callback != nullptr)
+            _callback();
+    }
+
+    ONE_PULSE_TEMPLATE_ARGS
+    void ONE_PULSE_TEMPLATE_QUALIFIER::Start(Counter period, Callback callback)
+    {
+        _callback = callback;
+        _busy = true;
+        _Timer::SetPeriod(period);
+
+        // Update generation (preload of period and compare values) sets update flag, it is not pulse end
+        _Timer::DisableInterrupt();
+        _Timer::Start();
+        _Timer::ClearInterruptFlag();
+        _Timer::EnableInterrupt();
+    }
+}
+
+#endif //! ZHELE_ONE_PULSE_IMPL_COMMON_H
@@ -10,10 +10,21 @@
 #ifndef ZHELE_ONE_WIRE_IMPL_COMMON_H
 #define ZHELE_ONE_WIRE_IMPL_COMMON_H
 
+#include <string.h>
+
 namespace Zhele 
 {
     template<typename _Usart, typename _Pin>
-    void OneWire<_Usart, _Pin>::Init()
+    const uint32_t OneWireUsartEngine<_Usart, _Pin>::ResetBaud[2] = {9600, 66666};
+
+    template<typename _Usart, typename _Pin>
+    const uint32_t OneWireUsartEngine<_Usart, _Pin>::SlotBaud[2] = {115200, 1000000};
+
+    template<typename _Usart, typename _Pin>
+    OneWireSpeed OneWireUsartEngine<_Usart, _Pin>::_speed = OneWireSpeed::Standard;
+
+    template<typename _Usart, typename _Pin>
+    void OneWireUsartEngine<_Usart, _Pin>::Init()
     {
         _Usart::Init(9600, _Usart::UsartMode::DataBits8
                         | _Usart::UsartMode::NoneParity
@@ -26,101 +37,494 @@ namespace Zhele
         _Pin::SetDriverType(_Pin::DriverType::OpenDrain);
         _Pin::SetPullMode(_Pin::PullMode::PullUp);
         _Pin::SetSpeed(_Pin::Speed::Fast);
+        _speed = OneWireSpeed::Standard;
     }
 
     template<typename _Usart, typename _Pin>
-    bool OneWire<_Usart, _Pin>::Reset()
+    bool OneWireUsartEngine<_Usart, _Pin>::Reset()
     {
-        _Usart::SetBaud(9600);
+        // 0xf0: start bit and 4 zero bits are reset pulse (520 us or 75 us), presence pulls some of high bits
+        _Usart::SetBaud(ResetBaud[static_cast<uint8_t>(_speed)]);
 
         volatile bool complete = false;
         uint8_t precenseBit = 0;
 
         _Usart::EnableAsyncRead(&precenseBit, 1, [&complete](void*, unsigned, bool){complete = true;});
         _Usart::Write(0xf0);
-        while (!complete);
+        Power::LowPower::WaitFor(complete);
 
-        _Usart::SetBaud(115200);
+        _Usart::SetBaud(SlotBaud[static_cast<uint8_t>(_speed)]);
 
         return precenseBit != 0xf0;
     }
 
     template<typename _Usart, typename _Pin>
-    void OneWire<_Usart, _Pin>::WriteByte(uint8_t byteToWrite)
+    void OneWireUsartEngine<_Usart, _Pin>::SetSpeed(OneWireSpeed speed)
+    {
+        _speed = speed;
+        _Usart::SetBaud(SlotBaud[static_cast<uint8_t>(_speed)]);
+    }
+
+    template<typename _Usart, typename _Pin>
+    void OneWireUsartEngine<_Usart, _Pin>::Exchange(uint8_t* slots, unsigned count, TransferCallback callback)
+    {
+        // Send slots async, receive because it's half-duplex
+        _Usart::EnableAsyncRead(slots, count, callback);
+        _Usart::Write(slots, count, true);
+    }
+
+    #define ONEWIRETIMERENGINE_TEMPLATE_ARGS template<typename _Timer, typename _Pin, unsigned _PulseChannel, unsigned _SampleChannel, typename _PulseDma, typename _SampleDma, uint8_t _PulseDmaRequest, uint8_t _SampleDmaRequest>
+    #define ONEWIRETIMERENGINE_TEMPLATE_QUALIFIER OneWireTimerEngine<_Timer, _Pin, _PulseChannel, _SampleChannel, _PulseDma, _SampleDma, _PulseDmaRequest, _SampleDmaRequest>
+
+    // Standard: 70 us slot, 6/60 us low, sample at 12 us. Overdrive: 10 us slot, 1.25/7.5 us low, sample at 1.75 us
+    ONEWIRETIMERENGINE_TEMPLATE_ARGS
+    const typename ONEWIRETIMERENGINE_TEMPLATE_QUALIFIER::Timings ONEWIRETIMERENGINE_TEMPLATE_QUALIFIER::SlotTimings[2] = {
+        {280, 24, 240, 48}, {40, 5, 30, 7}
+    };
+
+    // Standard: 480 us low, presence sample at 550 us, 960 us total. Overdrive: 75 us low, sample at 83 us, 150 us total
+    ONEWIRETIMERENGINE_TEMPLATE_ARGS
+    const typename ONEWIRETIMERENGINE_TEMPLATE_QUALIFIER::Timings ONEWIRETIMERENGINE_TEMPLATE_QUALIFIER::ResetTimings[2] = {
+        {3840, 1920, 1920, 2200}, {600, 300, 300, 332}
+    };
+
+    ONEWIRETIMERENGINE_TEMPLATE_ARGS
+    uint16_t ONEWIRETIMERENGINE_TEMPLATE_QUALIFIER::_pulses[MaxSlots + 1];
+
+    ONEWIRETIMERENGINE_TEMPLATE_ARGS
+    uint16_t ONEWIRETIMERENGINE_TEMPLATE_QUALIFIER::_samples[MaxSlots + 1];
+
+    ONEWIRETIMERENGINE_TEMPLATE_ARGS
+    uint8_t* ONEWIRETIMERENGINE_TEMPLATE_QUALIFIER::_slots = nullptr;
+
+    ONEWIRETIMERENGINE_TEMPLATE_ARGS
+    unsigned ONEWIRETIMERENGINE_TEMPLATE_QUALIFIER::_count = 0;
+
+    ONEWIRETIMERENGINE_TEMPLATE_ARGS
+    TransferCallback ONEWIRETIMERENGINE_TEMPLATE_QUALIFIER::_callback;
+
+    ONEWIRETIMERENGINE_TEMPLATE_ARGS
+    OneWireSpeed ONEWIRETIMERENGINE_TEMPLATE_QUALIFIER::_speed = OneWireSpeed::Standard;
+
+    ONEWIRETIMERENGINE_TEMPLATE_ARGS
+    void ONEWIRETIMERENGINE_TEMPLATE_QUALIFIER::Init()
+    {
+        _Timer::Enable();
+        _Timer::SetPrescaler(_Timer::GetClockFreq() / TickFreq - 1);
+
+        // Compare value 0 is released line
+        Pulse::SetOutputMode(Pulse::OutputMode::PWM2);
+        Pulse::SetPulse(0);
+        Pulse::template SelectPins<_Pin>();
+        _Pin::SetDriverType(_Pin::DriverType::OpenDrain);
+        _Pin::SetPullMode(_Pin::PullMode::PullUp);
+        Pulse::Enable();
+
+        Sample::SetOutputMode(Sample::OutputMode::Timing);
+        Sample::EnableDmaRequest();
+
+        _speed = OneWireSpeed::Standard;
+    }
+
+    ONEWIRETIMERENGINE_TEMPLATE_ARGS
+    bool ONEWIRETIMERENGINE_TEMPLATE_QUALIFIER::Reset()
     {
-        uint8_t buffer[8];
-        uint8_t dummyBuffer[8];
-        ConvertToBits(byteToWrite, buffer);
         volatile bool complete = false;
+        _slots = nullptr;
+        _count = 1;
+        _callback = [&complete](void*, unsigned, bool){complete = true;};
 
-        // Send byte async, receive because it's half-duplex
-        _Usart::EnableAsyncRead(dummyBuffer, 8, [&complete](void*, unsigned, bool){complete = true;});
-        _Usart::Write(buffer, 8, true);
+        const Timings& timings = ResetTimings[static_cast<uint8_t>(_speed)];
+        _pulses[0] = timings.One;
+        Run(timings, 1);
+        Power::LowPower::WaitFor(complete);
 
-        while(!complete);
+        return (_samples[0] & (1 << _Pin::Number)) == 0;
     }
 
-    template<typename _Usart, typename _Pin>
-    uint8_t OneWire<_Usart, _Pin>::ReadByte()
+    ONEWIRETIMERENGINE_TEMPLATE_ARGS
+    void ONEWIRETIMERENGINE_TEMPLATE_QUALIFIER::SetSpeed(OneWireSpeed speed)
     {
-        uint8_t buffer[8];
-        volatile bool readComplete = false;            
+        _speed = speed;
+    }
 
-        _Usart::EnableAsyncRead(buffer, 8,
-                        [&readComplete](void* data, unsigned size, bool success){
-                            readComplete = true;});
-        
-        _Usart::Write(_readDummyBuffer, 8, true);
+    ONEWIRETIMERENGINE_TEMPLATE_ARGS
+    void ONEWIRETIMERENGINE_TEMPLATE_QUALIFIER::Exchange(uint8_t* slots, unsigned count, TransferCallback callback)
+    {
+        if(count > MaxSlots)
+            count = MaxSlots;
 
-        while (!readComplete){}
+        _slots = slots;
+        _count = count;
+        _callback = callback;
 
-        return ConvertToByte(buffer);
+        const Timings& timings = SlotTimings[static_cast<uint8_t>(_speed)];
+        for(unsigned i = 0; i < count; ++i)
+            _pulses[i] = slots[i] == 0xff ? timings.One : timings.Zero;
+        Run(timings, count);
     }
 
-    template<typename _Usart, typename _Pin>
-    void OneWire<_Usart, _Pin>::ReadBytes(void* data, uint8_t size)
+    ONEWIRETIMERENGINE_TEMPLATE_ARGS
+    void ONEWIRETIMERENGINE_TEMPLATE_QUALIFIER::Run(const Timings& timings, unsigned count)
     {
-        uint8_t* buffer = reinterpret_cast<uint8_t*>(data);
+        using DmaBurstBase = typename _Timer::DmaBurstBase;
+        constexpr auto ccr = static_cast<DmaBurstBase>(static_cast<uint8_t>(DmaBurstBase::Ccr1) + _PulseChannel);
+
+        _Timer::Stop();
+        _Timer::SetPeriod(timings.Period - 1);
+        Sample::SetPulse(timings.Sample);
+
+        // Extra sample is taken in idle slot after the last one, so line is released when transfer completes
+        _SampleDma::ClearTransferComplete();
+        _SampleDma::SetTransferCallback(OnComplete);
+        _SampleDma::Transfer(_SampleDma::Periph2Mem | _SampleDma::MemIncrement | _SampleDma::PSize16Bits | _SampleDma::MSize16Bits
+            | _SampleDma::PriorityVeryHigh, _samples, &Port::Regs()->IDR, count + 1 ONLY_IF_STREAM_SUPPORTED(COMMA _SampleDmaRequest));
+
+        // First slot is loaded by start (update generation), DMA loads next slots and idle slot (zero low time) on updates
+        _pulses[count] = 0;
+        _Timer::template StartDmaBurst<_PulseDma>(ccr, 1, &_pulses[1], count, false, nullptr ONLY_IF_STREAM_SUPPORTED(COMMA _PulseDmaRequest));
+        Pulse::SetPulse(_pulses[0]);
+        _Timer::Start();
+    }
 
-        for(uint8_t i = 0; i < size; ++i)
+    ONEWIRETIMERENGINE_TEMPLATE_ARGS
+    void ONEWIRETIMERENGINE_TEMPLATE_QUALIFIER::OnComplete(void*, unsigned, bool success)
+    {
+        _Timer::Stop();
+        _Timer::template StopDmaBurst<_PulseDma>();
+
+        if(_slots != nullptr)
         {
-            buffer[i] = ReadByte();
+            for(unsigned i = 0; i < _count; ++i)
+                _slots[i] = (_samples[i] & (1 << _Pin::Number)) != 0 ? 0xff : 0x00;
         }
+
+        if(_callback)
+            _callback(_slots, _count, success);
     }
 
-    template<typename _Usart, typename _Pin>
-    void OneWire<_Usart, _Pin>::MatchRom(const uint8_t rom[8])
+    template<typename _Engine>
+    uint8_t BasicOneWire<_Engine>::_slots[MaxTransactionSize * 8];
+
+    template<typename _Engine>
+    uint8_t* BasicOneWire<_Engine>::_readData = nullptr;
+
+    template<typename _Engine>
+    uint8_t BasicOneWire<_Engine>::_writeSize = 0;
+
+    template<typename _Engine>
+    uint8_t BasicOneWire<_Engine>::_readSize = 0;
+
+    template<typename _Engine>
+    TransferCallback BasicOneWire<_Engine>::_callback;
+
+    template<typename _Engine>
+    uint8_t BasicOneWire<_Engine>::_searchRom[8];
+
+    template<typename _Engine>
+    uint8_t BasicOneWire<_Engine>::_lastDiscrepancy = 0;
+
+    template<typename _Engine>
+    uint8_t BasicOneWire<_Engine>::_lastFamilyDiscrepancy = 0;
+
+    template<typename _Engine>
+    bool BasicOneWire<_Engine>::_lastDevice = false;
+
+    template<typename _Engine>
+    void BasicOneWire<_Engine>::Init()
+    {
+        _Engine::Init();
+    }
+
+    template<typename _Engine>
+    bool BasicOneWire<_Engine>::Reset()
+    {
+        return _Engine::Reset();
+    }
+
+    template<typename _Engine>
+    void BasicOneWire<_Engine>::SetSpeed(OneWireSpeed speed)
+    {
+        _Engine::SetSpeed(speed);
+    }
+
+    template<typename _Engine>
+    bool BasicOneWire<_Engine>::TransactionAsync(const void* writeData, uint8_t writeSize, void* readData, uint8_t readSize, TransferCallback callback)
+    {
+        unsigned size = writeSize + readSize;
+        if(size == 0 || size > MaxTransactionSize)
+            return false;
+
+        const uint8_t* bytes = static_cast<const uint8_t*>(writeData);
+        for(uint8_t i = 0; i < writeSize; ++i)
+            ConvertToBits(bytes[i], &_slots[i * 8]);
+        // Read slots are "write 1" slots
+        memset(&_slots[writeSize * 8], 0xff, readSize * 8);
+
+        _readData = static_cast<uint8_t*>(readData);
+        _writeSize = writeSize;
+        _readSize = readSize;
+        _callback = callback;
+
+        _Engine::Exchange(_slots, size * 8, OnTransactionComplete);
+
+        return true;
+    }
+
+    template<typename _Engine>
+    bool BasicOneWire<_Engine>::Transaction(const void* writeData, uint8_t writeSize, void* readData, uint8_t readSize)
+    {
+        volatile bool complete = false;
+        if(!TransactionAsync(writeData, writeSize, readData, readSize, [&complete](void*, unsigned, bool){complete = true;}))
+            return false;
+
+        Power::LowPower::WaitFor(complete);
+        return true;
+    }
+
+    template<typename _Engine>
+    void BasicOneWire<_Engine>::OnTransactionComplete(void* data, unsigned size, bool success)
+    {
+        for(uint8_t i = 0; i < _readSize; ++i)
+            _readData[i] = ConvertToByte(&_slots[(_writeSize + i) * 8]);
+
+        if(_callback)
+            _callback(_readData, _readSize, success);
+    }
+
+    template<typename _Engine>
+    void BasicOneWire<_Engine>::WriteByte(uint8_t byteToWrite)
+    {
+        Transaction(&byteToWrite, 1);
+    }
+
+    template<typename _Engine>
+    uint8_t BasicOneWire<_Engine>::ReadByte()
     {
-        WriteByte(Commands::Match);
+        uint8_t result = 0;
+        Transaction(nullptr, 0, &result, 1);
+        return result;
+    }
 
-        for (uint8_t i = 0; i < 8; ++i) {
-            WriteByte(rom[i]);
+    template<typename _Engine>
+    void BasicOneWire<_Engine>::ReadBytes(void* data, uint8_t size)
+    {
+        uint8_t* buffer = reinterpret_cast<uint8_t*>(data);
+
+        while(size > 0)
+        {
+            uint8_t chunk = size < MaxTransactionSize ? size : MaxTransactionSize;
+            Transaction(nullptr, 0, buffer, chunk);
+            buffer += chunk;
+            size -= chunk;
         }
     }
 
-    template<typename _Usart, typename _Pin>
-    void OneWire<_Usart, _Pin>::SkipRom()
+    template<typename _Engine>
+    void BasicOneWire<_Engine>::MatchRom(const uint8_t rom[8])
+    {
+        uint8_t command[9] = {Commands::Match};
+        memcpy(&command[1], rom, 8);
+        Transaction(command, sizeof(command));
+    }
+
+    template<typename _Engine>
+    void BasicOneWire<_Engine>::SkipRom()
     {
         Reset();
         WriteByte(Commands::Skip);
     }
 
-    template<typename _Usart, typename _Pin>
-    bool OneWire<_Usart, _Pin>::ReadRom(uint8_t* rom)
+    template<typename _Engine>
+    bool BasicOneWire<_Engine>::OverdriveSkipRom()
     {
+        SetSpeed(OneWireSpeed::Standard);
         if(!Reset())
             return false;
-        WriteByte(Commands::Read);
 
-        for (uint8_t i = 0; i < 8; ++i)
+        WriteByte(Commands::OverdriveSkip);
+        SetSpeed(OneWireSpeed::Overdrive);
+        return true;
+    }
+
+    template<typename _Engine>
+    bool BasicOneWire<_Engine>::OverdriveMatchRom(const uint8_t rom[8])
+    {
+        SetSpeed(OneWireSpeed::Standard);
+        if(!Reset())
+            return false;
+
+        // Command is sent at standard speed, ROM at overdrive speed
+        WriteByte(Commands::OverdriveMatch);
+        SetSpeed(OneWireSpeed::Overdrive);
+        Transaction(rom, 8);
+        return true;
+    }
+
+    template<typename _Engine>
+    bool BasicOneWire<_Engine>::ReadRom(uint8_t* rom)
+    {
+        if(!Reset())
+            return false;
+        uint8_t command = Commands::Read;
+        Transaction(&command, 1, rom, 8);
+        return true;
+    }
+
+    template<typename _Engine>
+    bool BasicOneWire<_Engine>::SearchFirst(uint8_t* rom, bool alarm)
+    {
+        _lastDiscrepancy = 0;
+        _lastFamilyDiscrepancy = 0;
+        _lastDevice = false;
+
+        return SearchStep(rom, alarm);
+    }
+
+    template<typename _Engine>
+    bool BasicOneWire<_Engine>::SearchNext(uint8_t* rom, bool alarm)
+    {
+        return SearchStep(rom, alarm);
+    }
+
+    template<typename _Engine>
+    bool BasicOneWire<_Engine>::SearchFamily(uint8_t family, uint8_t* rom)
+    {
+        // Start search from given family: first 8 bits are forced, other are zeroes
+        memset(_searchRom, 0, sizeof(_searchRom));
+        _searchRom[0] = family;
+        _lastDiscrepancy = 64;
+        _lastFamilyDiscrepancy = 0;
+        _lastDevice = false;
+
+        return SearchStep(rom, false) && rom[0] == family;
+    }
+
+    template<typename _Engine>
+    uint8_t BasicOneWire<_Engine>::Enumerate(uint8_t (*roms)[8], uint8_t maxCount, uint8_t family, bool alarm)
+    {
+        if(maxCount == 0)
+            return 0;
+
+        bool found = family != 0 && !alarm
+            ? SearchFamily(family, roms[0])
+            : SearchFirst(roms[0], alarm);
+
+        uint8_t count = 0;
+        while(found)
         {
-            rom[i] = ReadByte();
+            if(family == 0 || roms[count][0] == family)
+                ++count;
+            else if(!alarm)
+                break; // Devices are found in ROM order, so there are no more devices of family
+
+            if(count == maxCount)
+                break;
+            found = SearchNext(roms[count], alarm);
+        }
+        return count;
+    }
+
+    template<typename _Engine>
+    bool BasicOneWire<_Engine>::SearchStep(uint8_t* rom, bool alarm)
+    {
+        if(_lastDevice || !Reset())
+        {
+            _lastDiscrepancy = 0;
+            _lastFamilyDiscrepancy = 0;
+            _lastDevice = false;
+            return false;
         }
+
+        WriteByte(alarm ? Commands::AlarmSearch : Commands::Search);
+
+        uint8_t lastZero = 0;
+        // Read bit and complement bit for first ROM bit
+        _slots[0] = 0xff;
+        _slots[1] = 0xff;
+        ExchangeSlots(2);
+
+        for(uint8_t bitNumber = 1; bitNumber <= 64; ++bitNumber)
+        {
+            bool bit = _slots[0] == 0xff;
+            bool complementBit = _slots[1] == 0xff;
+            if(bit && complementBit)
+            {
+                // No devices participating in search
+                _lastDiscrepancy = 0;
+                _lastFamilyDiscrepancy = 0;
+                return false;
+            }
+
+            uint8_t byteNumber = (bitNumber - 1) / 8;
+            uint8_t mask = 1 << ((bitNumber - 1) % 8);
+
+            bool direction;
+            if(bit != complementBit)
+            {
+                direction = bit;
+            }
+            else
+            {
+                // Discrepancy: devices with 0 and 1 both
+                direction = bitNumber < _lastDiscrepancy
+                    ? (_searchRom[byteNumber] & mask) != 0
+                    : bitNumber == _lastDiscrepancy;
+
+                if(!direction)
+                {
+                    lastZero = bitNumber;
+                    if(lastZero < 9)
+                        _lastFamilyDiscrepancy = lastZero;
+                }
+            }
+
+            _searchRom[byteNumber] = direction
+                ? _searchRom[byteNumber] | mask
+                : _searchRom[byteNumber] & ~mask;
+
+            // Write direction and read next bit pair with one transfer
+            _slots[0] = direction ? 0xff : 0x00;
+            _slots[1] = 0xff;
+            _slots[2] = 0xff;
+            ExchangeSlots(bitNumber < 64 ? 3 : 1);
+            _slots[0] = _slots[1];
+            _slots[1] = _slots[2];
+        }
+
+        _lastDiscrepancy = lastZero;
+        _lastDevice = lastZero == 0;
+
+        if(Crc(_searchRom, 7) != _searchRom[7])
+        {
+            _lastDiscrepancy = 0;
+            _lastFamilyDiscrepancy = 0;
+            _lastDevice = false;
+            return false;
+        }
+
+        memcpy(rom, _searchRom, 8);
         return true;
     }
 
-    template<typename _Usart, typename _Pin>
-    uint8_t OneWire<_Usart, _Pin>::ConvertToByte(const uint8_t* bits)
+    template<typename _Engine>
+    void BasicOneWire<_Engine>::ExchangeSlots(uint8_t count)
+    {
+        volatile bool complete = false;
+
+        _Engine::Exchange(_slots, count, [&complete](void*, unsigned, bool){complete = true;});
+
+        Power::LowPower::WaitFor(complete);
+    }
+
+    template<typename _Engine>
+    uint8_t BasicOneWire<_Engine>::Crc(const void* data, uint8_t size)
+    {
+        return Crc8Dallas::Calculate(data, size);
+    }
+
+    template<typename _Engine>
+    uint8_t BasicOneWire<_Engine>::ConvertToByte(const uint8_t* bits)
     {
         uint8_t resultByte;
         resultByte = 0;
@@ -134,8 +538,8 @@ namespace Zhele
         return resultByte;
     }
 
-    template<typename _Usart, typename _Pin>
-    void OneWire<_Usart, _Pin>::ConvertToBits(uint8_t byte, uint8_t* bits)
+    template<typename _Engine>
+    void BasicOneWire<_Engine>::ConvertToBits(uint8_t byte, uint8_t* bits)
     {
         for (uint8_t i = 0; i < 8; ++i)
         {
@@ -14,30 +14,57 @@ namespace Zhele::IO
 {
     namespace Private
     {
-        template<typename... _PortPins>
-        template<typename _PinList, typename _DataType>
-        NativePortBase::DataType PinListExpander<TypeList<_PortPins...>>::ExpandPinlistValue(_DataType value)
+        template<typename _PinList, typename... _PortPins>
+        template<size_t... _Groups>
+        uint32_t PortValueMap<_PinList, TypeList<_PortPins...>>::ExpandByShift(uint32_t value, std::index_sequence<_Groups...>)
         {
-            return (((value & (1 << TypeIndex<_PortPins, _PinList>::value)) > 0 ? 1 << _PortPins::Number : 0) | ...);
+            return (ShiftBits<Groups.Shift[_Groups]>(value & Groups.Mask[_Groups]) | ...);
         }
 
-        template<typename... _PortPins>
-        template<typename _PinList, typename _DataType>
-        _DataType PinListExpander<TypeList<_PortPins...>>::ExtractPinlistValueFromPort(NativePortBase::DataType value)
+        template<typename _PinList, typename... _PortPins>
+        template<size_t... _Groups>
+        uint32_t PortValueMap<_PinList, TypeList<_PortPins...>>::ExtractByShift(uint32_t value, std::index_sequence<_Groups...>)
         {
-            return (((value & (1 << _PortPins::Number)) > 0 ? (1 << TypeIndex<_PortPins, _PinList>::value) : 0) | ...);
+            return ((ShiftBits<-Groups.Shift[_Groups]>(value) & Groups.Mask[_Groups]) | ...);
+        }
+
+        template<typename _PinList, typename... _PortPins>
+        template<unsigned _UsedNibbles, typename _Type, unsigned _Nibbles, size_t... _Nibble>
+        _Type PortValueMap<_PinList, TypeList<_PortPins...>>::Lookup(const PinScatterTable<_Type, _Nibbles>& table, uint32_t value, std::index_sequence<_Nibble...>)
+        {
+            return (((_UsedNibbles & (1u << _Nibble)) != 0 ? table.Values[_Nibble][(value >> (_Nibble * 4)) & 0x0f] : 0) | ...);
+        }
+
+        template<typename _PinList, typename... _PortPins>
+        template<typename _DataType>
+        NativePortBase::DataType PortValueMap<_PinList, TypeList<_PortPins...>>::ExpandPinlistValue(_DataType value)
+        {
+            if constexpr (UseExpandTable)
+                return Lookup<ExpandNibbles>(ExpandTable, value, std::make_index_sequence<ListNibbles>{});
+            else
+                return ExpandByShift(value, std::make_index_sequence<Groups.Count>{});
+        }
+
+        template<typename _PinList, typename... _PortPins>
+        template<typename _DataType>
+        _DataType PortValueMap<_PinList, TypeList<_PortPins...>>::ExtractPinlistValueFromPort(NativePortBase::DataType value)
+        {
+            if constexpr (UseExtractTable)
+                return Lookup<ExtractNibbles>(ExtractTable, value, std::make_index_sequence<4>{});
+            else
+                return ExtractByShift(value, std::make_index_sequence<Groups.Count>{});
         }
 
         template<typename _Port, typename _PinList, typename _DataType>
         typename _Port::DataType GetPinlistValueForPort(_DataType value)
         {
-            return PinListExpander<PinsForPort<_Port, _PinList>>::template ExpandPinlistValue<_PinList>(value);
+            return PortValueMap<_PinList, PinsForPort<_Port, _PinList>>::ExpandPinlistValue(value);
         }
 
         template<typename _Port, typename _PinList, typename _DataType>
         _DataType GetPinlistValuePartFromPort()
         {
-            return PinListExpander<PinsForPort<_Port, _PinList>>::template ExtractPinlistValueFromPort<_PinList, _DataType>(_Port::PinRead());
+            return PortValueMap<_PinList, PinsForPort<_Port, _PinList>>::template ExtractPinlistValueFromPort<_DataType>(_Port::PinRead());
         }
 
         template<typename _PinList, typename... _Ports>
@@ -46,7 +73,7 @@ namespace Zhele::IO
         {
             if constexpr (Length<PinsForPort<_Port, _PinList>>::value == 16)
             {
-                _Port::Send(Private::GetPinlistValueForPort<_Port, _PinList>(value));
+                _Port::Write(Private::GetPinlistValueForPort<_Port, _PinList>(value));
             }
             else
             {
@@ -122,6 +149,60 @@ namespace Zhele::IO
         {
             (_Ports::AltFuncNumber(Private::GetPinlistValueForPort<_Ports, _PinList>(mask), number), ...);
         }
+
+        template<typename _PinList, typename... _Ports>
+        template<uint32_t mask, NativePortBase::Configuration config>
+        void PortsWriter<_PinList, TypeList<_Ports...>>::SetConfiguration()
+        {
+            ((PinlistMaskForPort<_Ports, _PinList, mask> != 0
+                ? _Ports::template SetConfiguration<PinlistMaskForPort<_Ports, _PinList, mask>, config>()
+                : void()), ...);
+        }
+
+        template<typename _PinList, typename... _Ports>
+        template<uint32_t mask, NativePortBase::Speed speed>
+        void PortsWriter<_PinList, TypeList<_Ports...>>::SetSpeed()
+        {
+            ((PinlistMaskForPort<_Ports, _PinList, mask> != 0
+                ? _Ports::template SetSpeed<PinlistMaskForPort<_Ports, _PinList, mask>, speed>()
+                : void()), ...);
+        }
+
+        template<typename _PinList, typename... _Ports>
+        template<uint32_t mask, NativePortBase::PullMode mode>
+        void PortsWriter<_PinList, TypeList<_Ports...>>::SetPullMode()
+        {
+            ((PinlistMaskForPort<_Ports, _PinList, mask> != 0
+                ? _Ports::template SetPullMode<PinlistMaskForPort<_Ports, _PinList, mask>, mode>()
+                : void()), ...);
+        }
+
+        template<typename _PinList, typename... _Ports>
+        template<uint32_t mask, NativePortBase::DriverType driver>
+        void PortsWriter<_PinList, TypeList<_Ports...>>::SetDriverType()
+        {
+            ((PinlistMaskForPort<_Ports, _PinList, mask> != 0
+                ? _Ports::template SetDriverType<PinlistMaskForPort<_Ports, _PinList, mask>, driver>()
+                : void()), ...);
+        }
+
+        template<typename _PinList, typename... _Ports>
+        template<uint32_t mask, uint8_t number>
+        void PortsWriter<_PinList, TypeList<_Ports...>>::AltFuncNumber()
+        {
+            ((PinlistMaskForPort<_Ports, _PinList, mask> != 0
+                ? _Ports::template AltFuncNumber<PinlistMaskForPort<_Ports, _PinList, mask>, number>()
+                : void()), ...);
+        }
+
+        template<typename _PinList, typename... _Ports>
+        template<uint32_t mask, NativePortBase::Configuration config, NativePortBase::Speed speed, NativePortBase::DriverType driver, NativePortBase::PullMode pull, uint8_t number>
+        void PortsWriter<_PinList, TypeList<_Ports...>>::Configure()
+        {
+            ((PinlistMaskForPort<_Ports, _PinList, mask> != 0
+                ? _Ports::template Configure<PinlistMaskForPort<_Ports, _PinList, mask>, config, speed, driver, pull, number>()
+                : void()), ...);
+        }
     }
 
     template<typename... _Pins>
@@ -171,14 +252,14 @@ namespace Zhele::IO
     template<typename PinList<_Pins...>::DataType mask, NativePortBase::Configuration config>
     void PinList<_Pins...>::SetConfiguration()
     {
-        PortWriter::SetConfiguration(mask, config);
+        PortWriter::template SetConfiguration<mask, config>();
     }
 
     template<typename... _Pins>
     template<NativePortBase::Configuration config>
     void PinList<_Pins...>::SetConfiguration()
     {
-        PortWriter::SetConfiguration(-1, config);
+        PortWriter::template SetConfiguration<~0u, config>();
     }
 
     template<typename... _Pins>
@@ -191,14 +272,14 @@ namespace Zhele::IO
     template<typename PinList<_Pins...>::DataType mask, NativePortBase::Speed speed>
     void PinList<_Pins...>::SetSpeed()
     {
-        PortWriter::SetSpeed(mask, speed);
+        PortWriter::template SetSpeed<mask, speed>();
     }
 
     template<typename... _Pins>
     template<NativePortBase::Speed speed>
     void PinList<_Pins...>::SetSpeed()
     {
-        PortWriter::SetSpeed(-1, speed);
+        PortWriter::template SetSpeed<~0u, speed>();
     }
 
     template<typename... _Pins>
@@ -211,14 +292,14 @@ namespace Zhele::IO
     template<typename PinList<_Pins...>::DataType mask, NativePortBase::PullMode pull>
     void PinList<_Pins...>::SetPullMode()
     {
-        PortWriter::SetPullMode(mask, pull);
+        PortWriter::template SetPullMode<mask, pull>();
     }
 
     template<typename... _Pins>
     template<NativePortBase::PullMode pull>
     void PinList<_Pins...>::SetPullMode()
     {
-        PortWriter::SetPullMode(-1, pull);
+        PortWriter::template SetPullMode<~0u, pull>();
     }
 
     template<typename... _Pins>
@@ -231,14 +312,14 @@ namespace Zhele::IO
     template<typename PinList<_Pins...>::DataType mask, NativePortBase::DriverType driver>
     void PinList<_Pins...>::SetDriverType()
     {
-        PortWriter::SetDriverType(mask, driver);
+        PortWriter::template SetDriverType<mask, driver>();
     }
 
     template<typename... _Pins>
     template<NativePortBase::DriverType driver>
     void PinList<_Pins...>::SetDriverType()
     {
-        PortWriter::SetDriverType(-1, driver);
+        PortWriter::template SetDriverType<~0u, driver>();
     }
 
     template<typename... _Pins>
@@ -251,14 +332,28 @@ namespace Zhele::IO
     template<typename PinList<_Pins...>::DataType mask, unsigned number>
     void PinList<_Pins...>::AltFuncNumber()
     {
-        PortWriter::AltFuncNumber(mask, number);
+        PortWriter::template AltFuncNumber<mask, number>();
     }
 
     template<typename... _Pins>
     template<unsigned number>
     void PinList<_Pins...>::AltFuncNumber()
     {
-        PortWriter::AltFuncNumber(-1, number);
+        PortWriter::template AltFuncNumber<~0u, number>();
+    }
+
+    template<typename... _Pins>
+    template<NativePortBase::Configuration config, NativePortBase::Speed speed, NativePortBase::DriverType driver, NativePortBase::PullMode pull, unsigned number>
+    void PinList<_Pins...>::Configure()
+    {
+        PortWriter::template Configure<~0u, config, speed, driver, pull, number>();
+    }
+
+    template<typename... _Pins>
+    template<typename PinList<_Pins...>::DataType mask, NativePortBase::Configuration config, NativePortBase::Speed speed, NativePortBase::DriverType driver, NativePortBase::PullMode pull, unsigned number>
+    void PinList<_Pins...>::ConfigureMasked()
+    {
+        PortWriter::template Configure<mask, config, speed, driver, pull, number>();
     }
 }
 #endif //! ZHELE_PINLIST_IMPL_COMMON_H
@@ -0,0 +1,155 @@
+/**
+ * @file
+ * Low-power waiting methods implementation
+ * 
+ * @author Alexey Zhelonkin
+ * @date 2023
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_POWER_IMPL_COMMON_H
+#define ZHELE_POWER_IMPL_COMMON_H
+
+namespace Zhele::Power
+{
+#if defined (PWR_CR1_LPMS)
+    inline LowPower::StopMode LowPower::_stopMode = LowPower::StopMode::Stop1;
+#endif
+    inline unsigned LowPower::_wakeLatencyBudget = 0;
+    inline volatile unsigned LowPower::_stopBlockers = 0;
+
+#if defined (PWR_CR1_LPMS)
+    inline void LowPower::SetStopMode(StopMode mode)
+    {
+        _stopMode = mode;
+    }
+#endif
+
+    inline void LowPower::SetWakeLatencyBudget(unsigned us)
+    {
+        _wakeLatencyBudget = us;
+    }
+
+    inline void LowPower::BlockStop()
+    {
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        _stopBlockers = _stopBlockers + 1;
+        __set_PRIMASK(primask);
+    }
+
+    inline void LowPower::UnblockStop()
+    {
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        if(_stopBlockers > 0)
+            _stopBlockers = _stopBlockers - 1;
+        __set_PRIMASK(primask);
+    }
+
+    inline bool LowPower::StopAllowed()
+    {
+#if defined (PWR_CR1_LPMS)
+        if(_stopBlockers != 0 || _wakeLatencyBudget < ZHELE_STOP_WAKE_LATENCY_US)
+            return false;
+
+        // DMA is stopped in Stop mode
+        DMA_Channel_TypeDef* channels[] = {
+            DMA1_Channel1, DMA1_Channel2, DMA1_Channel3, DMA1_Channel4, DMA1_Channel5, DMA1_Channel6, DMA1_Channel7,
+        #if defined (DMA2)
+            DMA2_Channel1, DMA2_Channel2, DMA2_Channel3, DMA2_Channel4, DMA2_Channel5, DMA2_Channel6, DMA2_Channel7,
+        #endif
+        };
+        for(DMA_Channel_TypeDef* channel : channels)
+        {
+            if(channel->CCR & DMA_CCR_EN)
+                return false;
+        }
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    inline void LowPower::EnterStop()
+    {
+#if defined (PWR_CR1_LPMS)
+        uint32_t clockSource = RCC->CFGR & RCC_CFGR_SWS;
+
+        RCC->APB1ENR1 |= RCC_APB1ENR1_PWREN;
+        PWR->CR1 = (PWR->CR1 & ~PWR_CR1_LPMS) | static_cast<uint32_t>(_stopMode);
+        // Wake up with HSI16 (faster than MSI and it is PLL source candidate)
+        RCC->CFGR |= RCC_CFGR_STOPWUCK;
+
+        SCB->SCR |= SCB_SCR_SLEEPDEEP_Msk;
+        __DSB();
+        __WFI();
+        SCB->SCR &= ~SCB_SCR_SLEEPDEEP_Msk;
+
+        if(clockSource == RCC_CFGR_SWS_PLL)
+            Clock::SysClock::SelectClockSource(Clock::SysClock::Pll);
+        else if(clockSource == RCC_CFGR_SWS_HSE)
+            Clock::SysClock::SelectClockSource(Clock::SysClock::External);
+#endif
+    }
+
+    inline void LowPower::Idle()
+    {
+        if(StopAllowed())
+        {
+            EnterStop();
+            return;
+        }
+
+        __WFI();
+    }
+
+    template<typename _Condition>
+    void LowPower::WaitFor(_Condition condition)
+    {
+        uint32_t primask = __get_PRIMASK();
+        for(;;)
+        {
+            __disable_irq();
+            if(condition())
+                break;
+            Idle();
+            // Pending interrupt is handled here
+            __set_PRIMASK(primask);
+        }
+        __set_PRIMASK(primask);
+    }
+
+    inline void LowPower::WaitFor(const volatile bool& flag)
+    {
+        WaitFor([&flag] { return flag; });
+    }
+
+    inline void LowPower::WaitForEvent()
+    {
+        __WFE();
+    }
+
+    template<typename _Condition>
+    void LowPower::WaitForEvent(_Condition condition)
+    {
+        // Event between check and WFE is kept in event register
+        while(!condition())
+            __WFE();
+    }
+
+    inline void LowPower::SendEvent()
+    {
+        __SEV();
+    }
+
+    inline void LowPower::SetEventOnPending(bool enable)
+    {
+        if(enable)
+            SCB->SCR |= SCB_SCR_SEVONPEND_Msk;
+        else
+            SCB->SCR &= ~SCB_SCR_SEVONPEND_Msk;
+    }
+}
+
+#endif //! ZHELE_POWER_IMPL_COMMON_H
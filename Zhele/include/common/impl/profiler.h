@@ -0,0 +1,46 @@
+/**
+ * @file
+ * Implements interrupts profiling
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_PROFILER_IMPL_COMMON_H
+#define ZHELE_PROFILER_IMPL_COMMON_H
+
+namespace Zhele
+{
+#if defined (DWT)
+    template<IRQn_Type _IRQNumber>
+    uint32_t IsrProfile<_IRQNumber>::_calls = 0;
+    template<IRQn_Type _IRQNumber>
+    uint32_t IsrProfile<_IRQNumber>::_maxCycles = 0;
+    template<IRQn_Type _IRQNumber>
+    uint64_t IsrProfile<_IRQNumber>::_cycles = 0;
+
+    template<IRQn_Type _IRQNumber>
+    void IsrProfile<_IRQNumber>::Reset()
+    {
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        _calls = 0;
+        _maxCycles = 0;
+        _cycles = 0;
+        __set_PRIMASK(primask);
+    }
+
+    template<IRQn_Type _IRQNumber>
+    void IsrProfile<_IRQNumber>::Account(uint32_t cycles)
+    {
+        // Called from handler itself, handler of same IRQ cannot preempt it
+        ++_calls;
+        _cycles += cycles;
+        if(cycles > _maxCycles)
+            _maxCycles = cycles;
+    }
+#endif
+}
+
+#endif //! ZHELE_PROFILER_IMPL_COMMON_H
@@ -0,0 +1,330 @@
+/**
+ * @file
+ * QUADSPI methods implementation
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_QSPI_IMPL_COMMON_H
+#define ZHELE_QSPI_IMPL_COMMON_H
+
+namespace Zhele
+{
+    constexpr uint32_t QspiBase::CommandConfig(const Command& command, uint32_t mode)
+    {
+        return command.Instruction
+            | (static_cast<uint32_t>(command.InstructionLines) << QUADSPI_CCR_IMODE_Pos)
+            | (static_cast<uint32_t>(command.AddressLines) << QUADSPI_CCR_ADMODE_Pos)
+            | (static_cast<uint32_t>(command.Address) << QUADSPI_CCR_ADSIZE_Pos)
+            | (static_cast<uint32_t>(command.AlternateLines) << QUADSPI_CCR_ABMODE_Pos)
+            | (static_cast<uint32_t>(command.AlternateSize) << QUADSPI_CCR_ABSIZE_Pos)
+            | ((command.DummyCycles & 0x1f) << QUADSPI_CCR_DCYC_Pos)
+            | (static_cast<uint32_t>(command.DataLines) << QUADSPI_CCR_DMODE_Pos)
+            | (mode << QUADSPI_CCR_FMODE_Pos)
+            | (command.SendInstructionOnce ? QUADSPI_CCR_SIOO : 0);
+    }
+
+    namespace Private
+    {
+        #define QSPI_TEMPLATE_ARGS template<typename _Regs, typename _ClockCtrl, typename _ClkPins, typename _NcsPins, typename _Io0Pins, typename _Io1Pins, typename _Io2Pins, typename _Io3Pins, typename _Dma, IRQn_Type _IRQNumber>
+        #define QSPI_TEMPLATE_QUALIFIER Qspi<_Regs, _ClockCtrl, _ClkPins, _NcsPins, _Io0Pins, _Io1Pins, _Io2Pins, _Io3Pins, _Dma, _IRQNumber>
+
+        QSPI_TEMPLATE_ARGS
+        void QSPI_TEMPLATE_QUALIFIER::Init(uint32_t frequence, uint32_t flashSize, bool clockMode3, uint8_t chipSelectHighCycles)
+        {
+            _ClockCtrl::Enable();
+            _Regs()->CR = 0;
+
+            // QUADSPI clock is AHB clock divided by (PRESCALER + 1)
+            uint32_t prescaler = (_ClockCtrl::ClockFreq() + frequence - 1) / frequence;
+            prescaler = prescaler > 0 ? prescaler - 1 : 0;
+            if(prescaler > 255)
+                prescaler = 255;
+
+            // Flash size is 2 ^ (FSIZE + 1)
+            uint32_t flashSizeBits = 0;
+            while((2ul << flashSizeBits) < flashSize && flashSizeBits < 31)
+                ++flashSizeBits;
+
+            _Regs()->DCR = (flashSizeBits << QUADSPI_DCR_FSIZE_Pos)
+                | (((chipSelectHighCycles > 0 ? chipSelectHighCycles - 1 : 0) & 0x07) << QUADSPI_DCR_CSHT_Pos)
+                | (clockMode3 ? QUADSPI_DCR_CKMODE : 0);
+            // Sample shift by half cycle gives flash output more time at high clock
+            _Regs()->CR = (prescaler << QUADSPI_CR_PRESCALER_Pos) | QUADSPI_CR_SSHIFT | QUADSPI_CR_EN;
+            _memoryMapped = false;
+        }
+
+        QSPI_TEMPLATE_ARGS
+        void QSPI_TEMPLATE_QUALIFIER::Disable()
+        {
+            Abort();
+            _Regs()->CR = 0;
+            _ClockCtrl::Disable();
+        }
+
+        QSPI_TEMPLATE_ARGS
+        bool QSPI_TEMPLATE_QUALIFIER::Busy()
+        {
+            return _memoryMapped || (_Regs()->SR & QUADSPI_SR_BUSY) != 0;
+        }
+
+        QSPI_TEMPLATE_ARGS
+        void QSPI_TEMPLATE_QUALIFIER::Abort()
+        {
+            if((_Regs()->CR & QUADSPI_CR_DMAEN) != 0)
+            {
+                _Dma::Disable();
+                _Regs()->CR &= ~QUADSPI_CR_DMAEN;
+            }
+            _Regs()->CR &= ~QUADSPI_CR_SMIE;
+            _Regs()->CR |= QUADSPI_CR_ABORT;
+            while((_Regs()->CR & QUADSPI_CR_ABORT) != 0)
+                continue;
+            _memoryMapped = false;
+        }
+
+        QSPI_TEMPLATE_ARGS
+        bool QSPI_TEMPLATE_QUALIFIER::Execute(const Command& command, uint32_t address)
+        {
+            ExitMemoryMapped();
+            Start(command, IndirectWriteMode, address, 0);
+            return Finish();
+        }
+
+        QSPI_TEMPLATE_ARGS
+        bool QSPI_TEMPLATE_QUALIFIER::Read(const Command& command, uint32_t address, void* data, uint32_t size)
+        {
+            ExitMemoryMapped();
+            _Regs()->CR &= ~QUADSPI_CR_FTHRES;
+            Start(command, IndirectReadMode, address, size);
+
+            uint8_t* destination = static_cast<uint8_t*>(data);
+            volatile uint8_t* dr = reinterpret_cast<volatile uint8_t*>(&_Regs()->DR);
+            for(uint32_t i = 0; i < size; ++i)
+            {
+                while((_Regs()->SR & (QUADSPI_SR_FTF | QUADSPI_SR_TCF | QUADSPI_SR_TEF)) == 0)
+                    continue;
+                if((_Regs()->SR & QUADSPI_SR_TEF) != 0)
+                    break;
+                *destination++ = *dr;
+            }
+            return Finish();
+        }
+
+        QSPI_TEMPLATE_ARGS
+        bool QSPI_TEMPLATE_QUALIFIER::Write(const Command& command, uint32_t address, const void* data, uint32_t size)
+        {
+            ExitMemoryMapped();
+            _Regs()->CR &= ~QUADSPI_CR_FTHRES;
+            Start(command, IndirectWriteMode, address, size);
+
+            const uint8_t* source = static_cast<const uint8_t*>(data);
+            volatile uint8_t* dr = reinterpret_cast<volatile uint8_t*>(&_Regs()->DR);
+            for(uint32_t i = 0; i < size; ++i)
+            {
+                while((_Regs()->SR & (QUADSPI_SR_FTF | QUADSPI_SR_TEF)) == 0)
+                    continue;
+                if((_Regs()->SR & QUADSPI_SR_TEF) != 0)
+                    break;
+                *dr = *source++;
+            }
+            return Finish();
+        }
+
+        QSPI_TEMPLATE_ARGS
+        void QSPI_TEMPLATE_QUALIFIER::ReadAsync(const Command& command, uint32_t address, void* data, uint32_t size, TransferCallback callback)
+        {
+            StartDma(command, IndirectReadMode, address, data, size, callback);
+        }
+
+        QSPI_TEMPLATE_ARGS
+        void QSPI_TEMPLATE_QUALIFIER::WriteAsync(const Command& command, uint32_t address, const void* data, uint32_t size, TransferCallback callback)
+        {
+            StartDma(command, IndirectWriteMode, address, const_cast<void*>(data), size, callback);
+        }
+
+        QSPI_TEMPLATE_ARGS
+        uint8_t QSPI_TEMPLATE_QUALIFIER::WaitStatus(const Command& command, uint8_t mask, uint8_t match, uint16_t interval)
+        {
+            ExitMemoryMapped();
+            while((_Regs()->SR & QUADSPI_SR_BUSY) != 0)
+                continue;
+
+            _Regs()->PSMKR = mask;
+            _Regs()->PSMAR = match;
+            _Regs()->PIR = interval;
+            _Regs()->CR = (_Regs()->CR & ~(QUADSPI_CR_PMM | QUADSPI_CR_SMIE)) | QUADSPI_CR_APMS;
+            Start(command, AutoPollingMode, 0, 1);
+
+            while((_Regs()->SR & QUADSPI_SR_SMF) == 0)
+                continue;
+            uint8_t status = *reinterpret_cast<volatile uint8_t*>(&_Regs()->DR);
+            _Regs()->FCR = QUADSPI_FCR_CSMF;
+            return status;
+        }
+
+        QSPI_TEMPLATE_ARGS
+        void QSPI_TEMPLATE_QUALIFIER::WaitStatusAsync(const Command& command, uint8_t mask, uint8_t match, MatchCallback callback, uint16_t interval)
+        {
+            ExitMemoryMapped();
+            while((_Regs()->SR & QUADSPI_SR_BUSY) != 0)
+                continue;
+
+            _matchCallback = callback;
+            _Regs()->PSMKR = mask;
+            _Regs()->PSMAR = match;
+            _Regs()->PIR = interval;
+            _Regs()->CR = (_Regs()->CR & ~QUADSPI_CR_PMM) | QUADSPI_CR_APMS | QUADSPI_CR_SMIE;
+            Nvic::EnableIrq<_IRQNumber>();
+            Start(command, AutoPollingMode, 0, 1);
+        }
+
+        QSPI_TEMPLATE_ARGS
+        void QSPI_TEMPLATE_QUALIFIER::EnableMemoryMapped(const Command& readCommand, uint16_t timeout)
+        {
+            ExitMemoryMapped();
+            while((_Regs()->SR & QUADSPI_SR_BUSY) != 0)
+                continue;
+
+            if(timeout > 0)
+            {
+                _Regs()->LPTR = timeout;
+                _Regs()->CR |= QUADSPI_CR_TCEN;
+            }
+            else
+            {
+                _Regs()->CR &= ~QUADSPI_CR_TCEN;
+            }
+
+            _Regs()->FCR = QUADSPI_FCR_CTEF | QUADSPI_FCR_CTCF | QUADSPI_FCR_CSMF | QUADSPI_FCR_CTOF;
+            if(readCommand.AlternateLines != Lines::None)
+                _Regs()->ABR = readCommand.Alternate;
+            _Regs()->CCR = CommandConfig(readCommand, MemoryMappedMode);
+            _memoryMapped = true;
+        }
+
+        QSPI_TEMPLATE_ARGS
+        bool QSPI_TEMPLATE_QUALIFIER::MemoryMapped()
+        {
+            return _memoryMapped;
+        }
+
+        QSPI_TEMPLATE_ARGS
+        void QSPI_TEMPLATE_QUALIFIER::IrqHandler()
+        {
+            if((_Regs()->SR & QUADSPI_SR_SMF) != 0 && (_Regs()->CR & QUADSPI_CR_SMIE) != 0)
+            {
+                uint8_t status = *reinterpret_cast<volatile uint8_t*>(&_Regs()->DR);
+                _Regs()->CR &= ~QUADSPI_CR_SMIE;
+                _Regs()->FCR = QUADSPI_FCR_CSMF;
+
+                MatchCallback callback = _matchCallback;
+                _matchCallback = nullptr;
+                if(callback)
+                    callback(status);
+            }
+        }
+
+        QSPI_TEMPLATE_ARGS
+        template<typename ClkPin, typename NcsPin, typename Io0Pin, typename Io1Pin, typename Io2Pin, typename Io3Pin>
+        void QSPI_TEMPLATE_QUALIFIER::SelectPins()
+        {
+            const int8_t clkPinIndex = TypeIndex<ClkPin, typename _ClkPins::PinsAsTypeList>::value;
+            const int8_t ncsPinIndex = TypeIndex<NcsPin, typename _NcsPins::PinsAsTypeList>::value;
+            const int8_t io0PinIndex = TypeIndex<Io0Pin, typename _Io0Pins::PinsAsTypeList>::value;
+            const int8_t io1PinIndex = TypeIndex<Io1Pin, typename _Io1Pins::PinsAsTypeList>::value;
+            const int8_t io2PinIndex = !std::is_same_v<Io2Pin, IO::NullPin>
+                                ? TypeIndex<Io2Pin, typename _Io2Pins::PinsAsTypeList>::value
+                                : -1;
+            const int8_t io3PinIndex = !std::is_same_v<Io3Pin, IO::NullPin>
+                                ? TypeIndex<Io3Pin, typename _Io3Pins::PinsAsTypeList>::value
+                                : -1;
+
+            static_assert(clkPinIndex >= 0);
+            static_assert(ncsPinIndex >= 0);
+            static_assert(io0PinIndex >= 0);
+            static_assert(io1PinIndex >= 0);
+            static_assert(io2PinIndex >= -1);
+            static_assert(io3PinIndex >= -1);
+
+            SelectPins<clkPinIndex, ncsPinIndex, io0PinIndex, io1PinIndex, io2PinIndex, io3PinIndex>();
+        }
+
+        QSPI_TEMPLATE_ARGS
+        void QSPI_TEMPLATE_QUALIFIER::ExitMemoryMapped()
+        {
+            if(_memoryMapped)
+                Abort();
+        }
+
+        QSPI_TEMPLATE_ARGS
+        void QSPI_TEMPLATE_QUALIFIER::Start(const Command& command, uint32_t mode, uint32_t address, uint32_t size)
+        {
+            while((_Regs()->SR & QUADSPI_SR_BUSY) != 0)
+                continue;
+
+            _Regs()->FCR = QUADSPI_FCR_CTEF | QUADSPI_FCR_CTCF | QUADSPI_FCR_CSMF | QUADSPI_FCR_CTOF;
+            if(command.DataLines != Lines::None)
+                _Regs()->DLR = size - 1;
+            if(command.AlternateLines != Lines::None)
+                _Regs()->ABR = command.Alternate;
+            // Command starts on CCR write (or on AR write if command has address)
+            _Regs()->CCR = CommandConfig(command, mode);
+            if(command.AddressLines != Lines::None)
+                _Regs()->AR = address;
+        }
+
+        QSPI_TEMPLATE_ARGS
+        bool QSPI_TEMPLATE_QUALIFIER::Finish()
+        {
+            while((_Regs()->SR & (QUADSPI_SR_TCF | QUADSPI_SR_TEF)) == 0)
+                continue;
+            bool success = (_Regs()->SR & QUADSPI_SR_TEF) == 0;
+            _Regs()->FCR = QUADSPI_FCR_CTCF | QUADSPI_FCR_CTEF;
+            return success;
+        }
+
+        QSPI_TEMPLATE_ARGS
+        void QSPI_TEMPLATE_QUALIFIER::StartDma(const Command& command, uint32_t mode, uint32_t address, void* data, uint32_t size, TransferCallback callback)
+        {
+            ExitMemoryMapped();
+            while((_Regs()->SR & QUADSPI_SR_BUSY) != 0)
+                continue;
+
+            // FIFO threshold should match DMA access size
+            bool words = (reinterpret_cast<uintptr_t>(data) & 0x03) == 0 && (size & 0x03) == 0;
+            _Regs()->CR = (_Regs()->CR & ~QUADSPI_CR_FTHRES) | ((words ? 3 : 0) << QUADSPI_CR_FTHRES_Pos);
+
+            _callback = callback;
+            typename _Dma::Mode dmaMode = (mode == IndirectReadMode ? _Dma::Periph2Mem : _Dma::Mem2Periph)
+                | _Dma::MemIncrement
+                | (words ? (_Dma::PSize32Bits | _Dma::MSize32Bits) : (_Dma::PSize8Bits | _Dma::MSize8Bits));
+            _Dma::ClearTransferComplete();
+            _Dma::SetTransferCallback(OnDmaComplete);
+            _Dma::Transfer(dmaMode, data, &_Regs()->DR, words ? size / 4 : size);
+
+            Start(command, mode, address, size);
+            _Regs()->CR |= QUADSPI_CR_DMAEN;
+        }
+
+        QSPI_TEMPLATE_ARGS
+        void QSPI_TEMPLATE_QUALIFIER::OnDmaComplete(void* data, unsigned size, bool success)
+        {
+            // Write DMA completes when last data is put to FIFO, so wait for transfer complete
+            if(success)
+                success = Finish();
+            else
+                Abort();
+            _Regs()->CR &= ~QUADSPI_CR_DMAEN;
+
+            TransferCallback callback = _callback;
+            _callback = nullptr;
+            if(callback)
+                callback(data, size, success);
+        }
+    }
+}
+
+#endif //! ZHELE_QSPI_IMPL_COMMON_H
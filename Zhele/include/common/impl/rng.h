@@ -0,0 +1,143 @@
+/**
+ * @file
+ * Hardware random number generator methods implementation
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_RNG_IMPL_COMMON_H
+#define ZHELE_RNG_IMPL_COMMON_H
+
+#if defined (RNG)
+namespace Zhele
+{
+    #define RNG_TEMPLATE_ARGS template<uint8_t _PoolSize>
+    #define RNG_TEMPLATE_QUALIFIER HardwareRng<_PoolSize>
+
+    RNG_TEMPLATE_ARGS
+    uint32_t RNG_TEMPLATE_QUALIFIER::_pool[_PoolSize];
+    RNG_TEMPLATE_ARGS
+    volatile uint8_t RNG_TEMPLATE_QUALIFIER::_head = 0;
+    RNG_TEMPLATE_ARGS
+    volatile uint8_t RNG_TEMPLATE_QUALIFIER::_tail = 0;
+    RNG_TEMPLATE_ARGS
+    uint32_t RNG_TEMPLATE_QUALIFIER::_last = 0;
+    RNG_TEMPLATE_ARGS
+    bool RNG_TEMPLATE_QUALIFIER::_hasLast = false;
+    RNG_TEMPLATE_ARGS
+    volatile uint32_t RNG_TEMPLATE_QUALIFIER::_errors = 0;
+
+    RNG_TEMPLATE_ARGS
+    void RNG_TEMPLATE_QUALIFIER::Init()
+    {
+        Clock::RngClock::Enable();
+        Start();
+        Nvic::EnableIrq<IRQn>();
+    }
+
+    RNG_TEMPLATE_ARGS
+    void RNG_TEMPLATE_QUALIFIER::Disable()
+    {
+        RNG->CR = 0;
+    }
+
+    RNG_TEMPLATE_ARGS
+    bool RNG_TEMPLATE_QUALIFIER::TryGet(uint32_t& value)
+    {
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        if(_head == _tail)
+        {
+            __set_PRIMASK(primask);
+            return false;
+        }
+        value = _pool[_head % _PoolSize];
+        _head = _head + 1;
+        // Pool has free word: resume filling
+        if(RNG->CR & RNG_CR_RNGEN)
+            RNG->CR |= RNG_CR_IE;
+        __set_PRIMASK(primask);
+        return true;
+    }
+
+    RNG_TEMPLATE_ARGS
+    uint32_t RNG_TEMPLATE_QUALIFIER::Get()
+    {
+        uint32_t value;
+        while(!TryGet(value))
+            continue;
+        return value;
+    }
+
+    RNG_TEMPLATE_ARGS
+    uint32_t RNG_TEMPLATE_QUALIFIER::Range(uint32_t bound)
+    {
+        return static_cast<uint32_t>((static_cast<uint64_t>(Get()) * bound) >> 32);
+    }
+
+    RNG_TEMPLATE_ARGS
+    unsigned RNG_TEMPLATE_QUALIFIER::Available()
+    {
+        return static_cast<uint8_t>(_tail - _head);
+    }
+
+    RNG_TEMPLATE_ARGS
+    uint32_t RNG_TEMPLATE_QUALIFIER::Errors()
+    {
+        return _errors;
+    }
+
+    RNG_TEMPLATE_ARGS
+    void RNG_TEMPLATE_QUALIFIER::IrqHandler()
+    {
+        uint32_t status = RNG->SR;
+        if(status & RNG_SR_SEIS)
+        {
+            // Flags are cleared by writing zero. Seed error: generator is restarted, current word is not used
+            RNG->SR = ~RNG_SR_SEIS;
+            _errors = _errors + 1;
+            Start();
+            return;
+        }
+        if(status & RNG_SR_CEIS)
+        {
+            RNG->SR = ~RNG_SR_CEIS;
+            _errors = _errors + 1;
+        }
+        if(!(status & RNG_SR_DRDY))
+            return;
+
+        uint32_t value = RNG->DR;
+        // Continuous test: every word is compared with previous one, first word is only saved
+        bool valid = _hasLast && value != _last;
+        if(_hasLast && value == _last)
+            _errors = _errors + 1;
+        _last = value;
+        _hasLast = true;
+        if(!valid)
+            return;
+
+        uint8_t count = _tail - _head;
+        if(count < _PoolSize)
+        {
+            _pool[_tail % _PoolSize] = value;
+            _tail = _tail + 1;
+            ++count;
+        }
+        if(count == _PoolSize)
+            RNG->CR &= ~RNG_CR_IE;
+    }
+
+    RNG_TEMPLATE_ARGS
+    void RNG_TEMPLATE_QUALIFIER::Start()
+    {
+        _hasLast = false;
+        RNG->CR = 0;
+        RNG->CR = RNG_CR_RNGEN | RNG_CR_IE;
+    }
+}
+#endif
+
+#endif //! ZHELE_RNG_IMPL_COMMON_H
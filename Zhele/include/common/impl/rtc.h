@@ -0,0 +1,440 @@
+/**
+ * @file
+ * Internal RTC methods implementation
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_RTC_IMPL_COMMON_H
+#define ZHELE_RTC_IMPL_COMMON_H
+
+namespace Zhele::Timers
+{
+    inline Rtc::WakeupCallback Rtc::_wakeupCallback = nullptr;
+    inline uint32_t Rtc::_wakeupPeriod = 0;
+
+    inline bool Rtc::Init(ClockSource source)
+    {
+        EnableBackupAccess();
+
+        const uint32_t select = source == ClockSource::Lse ? RCC_BDCR_RTCSEL_0 : RCC_BDCR_RTCSEL_1;
+        if((RCC->BDCR & RCC_BDCR_RTCEN) && (RCC->BDCR & RCC_BDCR_RTCSEL) == select)
+        {
+            // LSI is not in backup domain and is stopped by reset
+            if(source == ClockSource::Lsi && !StartClockSource(source))
+                return false;
+            WaitSync();
+            return true;
+        }
+
+        // Clock source can be changed only by backup domain reset (backup registers are cleared)
+        if(RCC->BDCR & RCC_BDCR_RTCSEL)
+        {
+            RCC->BDCR |= RCC_BDCR_BDRST;
+            RCC->BDCR &= ~RCC_BDCR_BDRST;
+        }
+        if(!StartClockSource(source))
+            return false;
+        RCC->BDCR |= select | RCC_BDCR_RTCEN;
+
+        const uint32_t freq = ClockFreq();
+    #if defined (RTC_CRL_RSF)
+        WaitSync();
+        WaitWrite();
+        RTC->CRL |= RTC_CRL_CNF;
+        RTC->PRLH = (freq - 1) >> 16;
+        RTC->PRLL = (freq - 1) & 0xffff;
+        RTC->CNTH = 0;
+        RTC->CNTL = 0;
+        RTC->CRL &= ~RTC_CRL_CNF;
+        WaitWrite();
+    #else
+        Unlock();
+        RTC->ISR |= RTC_ISR_INIT;
+        while(!(RTC->ISR & RTC_ISR_INITF)) continue;
+        // Async prescaler 128 (lowest consumption), sync prescaler gives 1 Hz
+        RTC->PRER = freq / 128 - 1;
+        RTC->PRER |= 127 << RTC_PRER_PREDIV_A_Pos;
+        RTC->ISR &= ~RTC_ISR_INIT;
+        Lock();
+        WaitSync();
+    #endif
+        return true;
+    }
+
+    inline uint32_t Rtc::ClockFreq()
+    {
+        if((RCC->BDCR & RCC_BDCR_RTCSEL) == RCC_BDCR_RTCSEL_1)
+            return Clock::LsiClock::ClockFreq();
+    #if defined (LSE_VALUE)
+        return LSE_VALUE;
+    #else
+        return 32768;
+    #endif
+    }
+
+    inline uint32_t Rtc::SubsecondRate()
+    {
+    #if defined (RTC_CRL_RSF)
+        return ClockFreq();
+    #else
+        return (RTC->PRER & RTC_PRER_PREDIV_S) + 1;
+    #endif
+    }
+
+#if defined (RTC_CRL_RSF)
+    inline uint32_t Rtc::GetCounter()
+    {
+        // Low half can overflow between reads
+        uint16_t high = RTC->CNTH;
+        uint16_t low = RTC->CNTL;
+        if(RTC->CNTH != high)
+        {
+            high = RTC->CNTH;
+            low = RTC->CNTL;
+        }
+        return (static_cast<uint32_t>(high) << 16) | low;
+    }
+
+    inline void Rtc::SetCounter(uint32_t counter)
+    {
+        WaitWrite();
+        RTC->CRL |= RTC_CRL_CNF;
+        RTC->CNTH = counter >> 16;
+        RTC->CNTL = counter & 0xffff;
+        RTC->CRL &= ~RTC_CRL_CNF;
+        WaitWrite();
+    }
+
+    inline Rtc::Timestamp Rtc::GetTimestamp()
+    {
+        // Prescaler registers are write-only, reload value is known from clock frequency
+        const uint32_t reload = ClockFreq() - 1;
+        uint32_t counter, divider;
+        do
+        {
+            counter = GetCounter();
+            divider = (static_cast<uint32_t>(RTC->DIVH & 0x0f) << 16) | RTC->DIVL;
+        } while(GetCounter() != counter);
+        return {counter, static_cast<uint16_t>(reload - divider)};
+    }
+
+    inline void Rtc::StartWakeupTimer(uint32_t periodMs, WakeupCallback callback)
+    {
+        _wakeupCallback = callback;
+        _wakeupPeriod = periodMs < 1000 ? 1 : (periodMs + 999) / 1000;
+
+        RTC->CRL &= ~RTC_CRL_ALRF;
+        SetAlarm(GetCounter() + _wakeupPeriod);
+        RTC->CRH |= RTC_CRH_ALRIE;
+        EnableWakeupExti(true);
+        Nvic::EnableIrq<RTC_Alarm_IRQn>();
+    }
+
+    inline void Rtc::StopWakeupTimer()
+    {
+        RTC->CRH &= ~RTC_CRH_ALRIE;
+        EnableWakeupExti(false);
+        _wakeupPeriod = 0;
+    }
+
+    inline void Rtc::SetCalibration(int16_t ppm)
+    {
+        // Every 2^20 clock pulses CAL pulses are masked
+        uint32_t pulses = ppm < 0 ? (static_cast<uint32_t>(-ppm) * 1048576 + 500000) / 1000000 : 0;
+        if(pulses > BKP_RTCCR_CAL)
+            pulses = BKP_RTCCR_CAL;
+        BKP->RTCCR = (BKP->RTCCR & ~BKP_RTCCR_CAL) | pulses;
+    }
+
+    inline void Rtc::IrqHandler()
+    {
+        if(!(RTC->CRL & RTC_CRL_ALRF))
+            return;
+        RTC->CRL &= ~RTC_CRL_ALRF;
+        EXTI->PR = EXTI_PR_PR17;
+
+        if(_wakeupPeriod == 0)
+            return;
+        // Next alarm is kept on period grid
+        uint32_t alarm = (static_cast<uint32_t>(RTC->ALRH) << 16) | RTC->ALRL;
+        alarm += _wakeupPeriod;
+        if(static_cast<int32_t>(alarm - GetCounter()) <= 0)
+            alarm = GetCounter() + _wakeupPeriod;
+        SetAlarm(alarm);
+
+        if(_wakeupCallback != nullptr)
+            _wakeupCallback();
+    }
+
+    inline void Rtc::WaitWrite()
+    {
+        while(!(RTC->CRL & RTC_CRL_RTOFF)) continue;
+    }
+
+    inline void Rtc::SetAlarm(uint32_t alarm)
+    {
+        WaitWrite();
+        RTC->CRL |= RTC_CRL_CNF;
+        RTC->ALRH = alarm >> 16;
+        RTC->ALRL = alarm & 0xffff;
+        RTC->CRL &= ~RTC_CRL_CNF;
+        WaitWrite();
+    }
+#else
+    inline Rtc::DateTime Rtc::GetDateTime()
+    {
+        // Reading TR locks DR shadow register until DR is read
+        uint32_t time = RTC->TR;
+        uint32_t date = RTC->DR;
+        return {
+            FromBcd(time & (RTC_TR_ST | RTC_TR_SU)),
+            FromBcd((time & (RTC_TR_MNT | RTC_TR_MNU)) >> RTC_TR_MNU_Pos),
+            FromBcd((time & (RTC_TR_HT | RTC_TR_HU)) >> RTC_TR_HU_Pos),
+            static_cast<uint8_t>((date & RTC_DR_WDU) >> RTC_DR_WDU_Pos),
+            FromBcd(date & (RTC_DR_DT | RTC_DR_DU)),
+            FromBcd((date & (RTC_DR_MT | RTC_DR_MU)) >> RTC_DR_MU_Pos),
+            FromBcd((date & (RTC_DR_YT | RTC_DR_YU)) >> RTC_DR_YU_Pos)
+        };
+    }
+
+    inline void Rtc::SetDateTime(const DateTime& dateTime)
+    {
+        uint32_t time = ToBcd(dateTime.Seconds)
+            | (ToBcd(dateTime.Minutes) << RTC_TR_MNU_Pos)
+            | (ToBcd(dateTime.Hours) << RTC_TR_HU_Pos);
+        uint32_t date = ToBcd(dateTime.Day)
+            | (ToBcd(dateTime.Month) << RTC_DR_MU_Pos)
+            | ((dateTime.Weekday & 0x07) << RTC_DR_WDU_Pos)
+            | (ToBcd(dateTime.Year) << RTC_DR_YU_Pos);
+
+        Unlock();
+        RTC->ISR |= RTC_ISR_INIT;
+        while(!(RTC->ISR & RTC_ISR_INITF)) continue;
+        RTC->TR = time;
+        RTC->DR = date;
+        RTC->ISR &= ~RTC_ISR_INIT;
+        Lock();
+        WaitSync();
+    }
+
+    inline Rtc::Timestamp Rtc::GetTimestamp()
+    {
+        // Reading SSR locks TR and DR shadow registers until DR is read
+        uint32_t subseconds = RTC->SSR;
+        uint32_t time = RTC->TR;
+        uint32_t date = RTC->DR;
+
+        uint32_t seconds = DaysSince2000(FromBcd((date & (RTC_DR_YT | RTC_DR_YU)) >> RTC_DR_YU_Pos),
+                FromBcd((date & (RTC_DR_MT | RTC_DR_MU)) >> RTC_DR_MU_Pos),
+                FromBcd(date & (RTC_DR_DT | RTC_DR_DU))) * 86400
+            + FromBcd((time & (RTC_TR_HT | RTC_TR_HU)) >> RTC_TR_HU_Pos) * 3600
+            + FromBcd((time & (RTC_TR_MNT | RTC_TR_MNU)) >> RTC_TR_MNU_Pos) * 60
+            + FromBcd(time & (RTC_TR_ST | RTC_TR_SU));
+        // Subseconds register is down-counter
+        return {seconds, static_cast<uint16_t>((RTC->PRER & RTC_PRER_PREDIV_S) - subseconds)};
+    }
+
+    inline void Rtc::StartWakeupTimer(uint32_t periodMs, WakeupCallback callback)
+    {
+        _wakeupCallback = callback;
+        _wakeupPeriod = periodMs;
+
+        uint32_t reload;
+        uint32_t clockSelect;
+        if(periodMs <= 32000)
+        {
+            // RTCCLK / 16
+            reload = periodMs * (ClockFreq() / 16) / 1000;
+            clockSelect = 0;
+        }
+        else
+        {
+            // ck_spre (1 Hz)
+            reload = periodMs / 1000;
+            clockSelect = RTC_CR_WUCKSEL_2;
+        }
+        if(reload == 0)
+            reload = 1;
+        if(reload > 0x10000)
+            reload = 0x10000;
+
+        Unlock();
+        RTC->CR &= ~(RTC_CR_WUTE | RTC_CR_WUTIE);
+        while(!(RTC->ISR & RTC_ISR_WUTWF)) continue;
+        RTC->WUTR = reload - 1;
+        RTC->CR = (RTC->CR & ~RTC_CR_WUCKSEL) | clockSelect;
+        RTC->ISR = ~(RTC_ISR_WUTF | RTC_ISR_INIT) | (RTC->ISR & RTC_ISR_INIT);
+        RTC->CR |= RTC_CR_WUTE | RTC_CR_WUTIE;
+        Lock();
+
+        EnableWakeupExti(true);
+        Nvic::EnableIrq<RTC_WKUP_IRQn>();
+    }
+
+    inline void Rtc::StopWakeupTimer()
+    {
+        Unlock();
+        RTC->CR &= ~(RTC_CR_WUTE | RTC_CR_WUTIE);
+        Lock();
+        EnableWakeupExti(false);
+        _wakeupPeriod = 0;
+    }
+
+    inline void Rtc::SetCalibration(int16_t ppm)
+    {
+        // Every 2^20 clock pulses CALM pulses are masked and 512 * CALP pulses are added
+        int32_t pulses = (static_cast<int32_t>(ppm) * 1048576 + (ppm < 0 ? -500000 : 500000)) / 1000000;
+        if(pulses > 512)
+            pulses = 512;
+        if(pulses < -511)
+            pulses = -511;
+        uint32_t calibration = pulses > 0
+            ? RTC_CALR_CALP | static_cast<uint32_t>(512 - pulses)
+            : static_cast<uint32_t>(-pulses);
+
+        Unlock();
+        while(RTC->ISR & RTC_ISR_RECALPF) continue;
+        RTC->CALR = calibration;
+        Lock();
+    }
+
+    inline void Rtc::IrqHandler()
+    {
+        if(!(RTC->ISR & RTC_ISR_WUTF))
+            return;
+        // Flag is cleared by writing zero, INIT bit is kept
+        RTC->ISR = ~(RTC_ISR_WUTF | RTC_ISR_INIT) | (RTC->ISR & RTC_ISR_INIT);
+    #if defined (EXTI_PR1_PIF20)
+        EXTI->PR1 = EXTI_PR1_PIF20;
+    #else
+        EXTI->PR = EXTI_PR_PR22;
+    #endif
+
+        if(_wakeupCallback != nullptr)
+            _wakeupCallback();
+    }
+
+    inline void Rtc::Unlock()
+    {
+        RTC->WPR = 0xca;
+        RTC->WPR = 0x53;
+    }
+
+    inline void Rtc::Lock()
+    {
+        RTC->WPR = 0xff;
+    }
+
+    constexpr uint8_t Rtc::FromBcd(uint32_t value)
+    {
+        return static_cast<uint8_t>((value >> 4) * 10 + (value & 0x0f));
+    }
+
+    constexpr uint32_t Rtc::ToBcd(uint8_t value)
+    {
+        return ((value / 10) << 4) | (value % 10);
+    }
+
+    constexpr uint32_t Rtc::DaysSince2000(uint8_t year, uint8_t month, uint8_t day)
+    {
+        constexpr uint16_t daysBeforeMonth[] = {0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334};
+        // 2000 is leap year, so leap years before given one are (year + 3) / 4
+        uint32_t days = year * 365u + (year + 3u) / 4 + daysBeforeMonth[(month - 1) % 12] + day - 1;
+        if(year % 4 == 0 && month > 2)
+            ++days;
+        return days;
+    }
+#endif
+
+    inline bool Rtc::StartClockSource(ClockSource source)
+    {
+        if(source == ClockSource::Lsi)
+            return Clock::LsiClock::Enable();
+
+        if(RCC->BDCR & RCC_BDCR_LSERDY)
+            return true;
+        RCC->BDCR |= RCC_BDCR_LSEON;
+        // Crystal startup takes up to 2 s
+        for(uint32_t counter = 0; counter < 0x2000000; ++counter)
+        {
+            if(RCC->BDCR & RCC_BDCR_LSERDY)
+                return true;
+        }
+        RCC->BDCR &= ~RCC_BDCR_LSEON;
+        return false;
+    }
+
+    inline void Rtc::EnableBackupAccess()
+    {
+    #if defined (RTC_CRL_RSF)
+        Clock::PowerClock::Enable();
+        Clock::BackupClock::Enable();
+        PWR->CR |= PWR_CR_DBP;
+    #elif defined (PWR_CR1_DBP)
+        Clock::PwrClock::Enable();
+    #if defined (RCC_APB1ENR1_RTCAPBEN)
+        Clock::RtcApbClock::Enable();
+    #endif
+        PWR->CR1 |= PWR_CR1_DBP;
+    #else
+        Clock::PwrClock::Enable();
+        PWR->CR |= PWR_CR_DBP;
+    #endif
+    }
+
+    inline void Rtc::WaitSync()
+    {
+    #if defined (RTC_CRL_RSF)
+        RTC->CRL &= ~RTC_CRL_RSF;
+        while(!(RTC->CRL & RTC_CRL_RSF)) continue;
+    #else
+        Unlock();
+        RTC->ISR &= ~RTC_ISR_RSF;
+        Lock();
+        while(!(RTC->ISR & RTC_ISR_RSF)) continue;
+    #endif
+    }
+
+    inline void Rtc::EnableWakeupExti(bool enable)
+    {
+    #if defined (RTC_CRL_RSF)
+        // EXTI line 17 (RTC alarm)
+        if(enable)
+        {
+            EXTI->RTSR |= EXTI_RTSR_TR17;
+            EXTI->IMR |= EXTI_IMR_MR17;
+        }
+        else
+        {
+            EXTI->IMR &= ~EXTI_IMR_MR17;
+        }
+    #elif defined (EXTI_IMR1_IM20)
+        // EXTI line 20 (RTC wakeup timer)
+        if(enable)
+        {
+            EXTI->RTSR1 |= EXTI_RTSR1_RT20;
+            EXTI->IMR1 |= EXTI_IMR1_IM20;
+        }
+        else
+        {
+            EXTI->IMR1 &= ~EXTI_IMR1_IM20;
+        }
+    #else
+        // EXTI line 22 (RTC wakeup timer)
+        if(enable)
+        {
+            EXTI->RTSR |= EXTI_RTSR_TR22;
+            EXTI->IMR |= EXTI_IMR_MR22;
+        }
+        else
+        {
+            EXTI->IMR &= ~EXTI_IMR_MR22;
+        }
+    #endif
+    }
+}
+
+#endif //! ZHELE_RTC_IMPL_COMMON_H
@@ -0,0 +1,263 @@
+/**
+ * @file
+ * Implements spectrum analysis
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_SPECTRUM_IMPL_COMMON_H
+#define ZHELE_SPECTRUM_IMPL_COMMON_H
+
+namespace Zhele::Dsp
+{
+    namespace Private
+    {
+        /**
+         * @brief Stores two adjacent Q15 values
+         */
+        inline void Store2(Q15* data, uint32_t value)
+        {
+            memcpy(data, &value, sizeof(value));
+        }
+
+        /**
+         * @brief Packed halving addition: (x + y) / 2 for both halves
+         */
+        inline uint32_t HalvingAdd(uint32_t x, uint32_t y)
+        {
+#if ZHELE_DSP_SIMD
+            return __SHADD16(x, y);
+#else
+            return Pack(static_cast<Q15>((static_cast<int16_t>(x) + static_cast<int16_t>(y)) >> 1),
+                static_cast<Q15>((static_cast<int16_t>(x >> 16) + static_cast<int16_t>(y >> 16)) >> 1));
+#endif
+        }
+
+        /**
+         * @brief Packed halving subtraction: (x - y) / 2 for both halves
+         */
+        inline uint32_t HalvingSub(uint32_t x, uint32_t y)
+        {
+#if ZHELE_DSP_SIMD
+            return __SHSUB16(x, y);
+#else
+            return Pack(static_cast<Q15>((static_cast<int16_t>(x) - static_cast<int16_t>(y)) >> 1),
+                static_cast<Q15>((static_cast<int16_t>(x >> 16) - static_cast<int16_t>(y >> 16)) >> 1));
+#endif
+        }
+
+        /**
+         * @brief Complex multiplication of packed Q15 values (real part is low half)
+         */
+        inline uint32_t ComplexMultiply(uint32_t x, uint32_t w)
+        {
+#if ZHELE_DSP_SIMD
+            int32_t re = __SMUSD(x, w);
+            int32_t im = __SMUADX(x, w);
+#else
+            int32_t xr = static_cast<int16_t>(x), xi = static_cast<int16_t>(x >> 16);
+            int32_t wr = static_cast<int16_t>(w), wi = static_cast<int16_t>(w >> 16);
+            int32_t re = xr * wr - xi * wi;
+            int32_t im = xr * wi + xi * wr;
+#endif
+            return Pack(static_cast<Q15>(Saturate<16>(re >> 15)), static_cast<Q15>(Saturate<16>(im >> 15)));
+        }
+
+        /**
+         * @brief Multiplies packed complex value by -i
+         */
+        inline uint32_t RotateMinusI(uint32_t x)
+        {
+            return Pack(static_cast<Q15>(x >> 16), static_cast<Q15>(Saturate<16>(-static_cast<int32_t>(static_cast<int16_t>(x)))));
+        }
+
+        /**
+         * @brief Complex conjugate of packed value
+         */
+        inline uint32_t Conjugate(uint32_t x)
+        {
+            return Pack(static_cast<Q15>(x), static_cast<Q15>(Saturate<16>(-static_cast<int32_t>(static_cast<int16_t>(x >> 16)))));
+        }
+    }
+
+    template<unsigned _Size>
+    void RealFftQ15<_Size>::ComplexFft(Q15* data)
+    {
+        // Bit reversal permutation (decimation in time)
+        for (unsigned i = 1, j = 0; i < Points; ++i)
+        {
+            unsigned bit = Points >> 1;
+            for (; j & bit; bit >>= 1)
+                j ^= bit;
+            j ^= bit;
+            if (i < j)
+            {
+                uint32_t x = Private::Load2(&data[2 * i]);
+                Private::Store2(&data[2 * i], Private::Load2(&data[2 * j]));
+                Private::Store2(&data[2 * j], x);
+            }
+        }
+
+        unsigned length = 1;
+        // Odd stages count: single radix-2 stage, then radix-4 passes
+        if ((__builtin_ctz(Points) & 1) != 0)
+        {
+            for (unsigned i = 0; i < Points; i += 2)
+            {
+                uint32_t a = Private::Load2(&data[2 * i]);
+                uint32_t b = Private::Load2(&data[2 * i + 2]);
+                Private::Store2(&data[2 * i], Private::HalvingAdd(a, b));
+                Private::Store2(&data[2 * i + 2], Private::HalvingSub(a, b));
+            }
+            length = 2;
+        }
+
+        for (; length < Points; length *= 4)
+        {
+            // W(2L)^j = W(N)^(j N / 2L), W(4L)^j = W(N)^(j N / 4L)
+            const unsigned step1 = _Size / (2 * length);
+            const unsigned step2 = _Size / (4 * length);
+            for (unsigned group = 0; group < Points; group += 4 * length)
+            {
+                for (unsigned j = 0; j < length; ++j)
+                {
+                    uint32_t w1 = _twiddles.Values[j * step1];
+                    uint32_t w2 = _twiddles.Values[j * step2];
+                    Q15* x = &data[2 * (group + j)];
+
+                    uint32_t a = Private::Load2(x);
+                    uint32_t b = Private::ComplexMultiply(Private::Load2(x + 2 * length), w1);
+                    uint32_t c = Private::Load2(x + 4 * length);
+                    uint32_t d = Private::ComplexMultiply(Private::Load2(x + 6 * length), w1);
+
+                    // First stage: two butterflies of size 2L
+                    uint32_t a1 = Private::HalvingAdd(a, b);
+                    uint32_t b1 = Private::HalvingSub(a, b);
+                    uint32_t c1 = Private::ComplexMultiply(Private::HalvingAdd(c, d), w2);
+                    // W(4L)^(j + L) = W(4L)^j * (-i)
+                    uint32_t d1 = Private::RotateMinusI(Private::ComplexMultiply(Private::HalvingSub(c, d), w2));
+
+                    // Second stage: butterflies of size 4L
+                    Private::Store2(x, Private::HalvingAdd(a1, c1));
+                    Private::Store2(x + 4 * length, Private::HalvingSub(a1, c1));
+                    Private::Store2(x + 2 * length, Private::HalvingAdd(b1, d1));
+                    Private::Store2(x + 6 * length, Private::HalvingSub(b1, d1));
+                }
+            }
+        }
+    }
+
+    template<unsigned _Size>
+    void RealFftQ15<_Size>::Forward(Q15* data)
+    {
+        ComplexFft(data);
+
+        // Z = FFT(even + i odd) / M, X[k] / N = (E + W^k (-i) D) / 2, X[M - k] / N = conj(E - W^k (-i) D) / 2,
+        // where E = (Z[k] + conj(Z[M - k])) / 2, D = (Z[k] - conj(Z[M - k])) / 2
+        int32_t re = data[0];
+        int32_t im = data[1];
+        data[0] = static_cast<Q15>((re + im) >> 1);
+        data[1] = static_cast<Q15>((re - im) >> 1);
+
+        for (unsigned k = 1; k <= Points / 2; ++k)
+        {
+            uint32_t a = Private::Load2(&data[2 * k]);
+            uint32_t b = Private::Conjugate(Private::Load2(&data[2 * (Points - k)]));
+
+            uint32_t e = Private::HalvingAdd(a, b);
+            uint32_t f = Private::ComplexMultiply(Private::RotateMinusI(Private::HalvingSub(a, b)), _twiddles.Values[k]);
+
+            Private::Store2(&data[2 * (Points - k)], Private::Conjugate(Private::HalvingSub(e, f)));
+            Private::Store2(&data[2 * k], Private::HalvingAdd(e, f));
+        }
+    }
+
+    template<unsigned _Size>
+    void RealFftQ15<_Size>::Magnitude(const Q15* spectrum, Q15* magnitude)
+    {
+        magnitude[0] = static_cast<Q15>(spectrum[0] < 0 ? (spectrum[0] == -32768 ? 32767 : -spectrum[0]) : spectrum[0]);
+        for (unsigned k = 1; k < Bins; ++k)
+        {
+            int32_t re = spectrum[2 * k];
+            int32_t im = spectrum[2 * k + 1];
+            uint32_t value = SquareRoot(static_cast<uint32_t>(re * re) + static_cast<uint32_t>(im * im));
+            magnitude[k] = static_cast<Q15>(value > 32767 ? 32767 : value);
+        }
+    }
+
+    template<uint32_t _SampleRate, unsigned _BlockSize, uint32_t... _Frequencies>
+    GoertzelBank<_SampleRate, _BlockSize, _Frequencies...>::GoertzelBank()
+    {
+        for (unsigned i = 0; i < Count; ++i)
+            _magnitudes[i] = 0;
+        Reset();
+    }
+
+    template<uint32_t _SampleRate, unsigned _BlockSize, uint32_t... _Frequencies>
+    bool GoertzelBank<_SampleRate, _BlockSize, _Frequencies...>::Process(const Q15* data, unsigned count)
+    {
+        bool completed = false;
+        while (count > 0)
+        {
+            unsigned chunk = _BlockSize - _samples;
+            if (chunk > count)
+                chunk = count;
+
+            for (unsigned i = 0; i < Count; ++i)
+            {
+                // Filter processes whole chunk, state stays in registers
+                const int32_t coefficient = _coefficients[i];
+                int32_t s1 = _s1[i];
+                int32_t s2 = _s2[i];
+                for (unsigned n = 0; n < chunk; ++n)
+                {
+                    int32_t s0 = data[n] + static_cast<int32_t>((static_cast<int64_t>(coefficient) * s1) >> 14) - s2;
+                    s2 = s1;
+                    s1 = s0;
+                }
+                _s1[i] = s1;
+                _s2[i] = s2;
+            }
+
+            data += chunk;
+            count -= chunk;
+            _samples += chunk;
+            if (_samples < _BlockSize)
+                break;
+
+            for (unsigned i = 0; i < Count; ++i)
+            {
+                int64_t s1 = _s1[i];
+                int64_t s2 = _s2[i];
+                int64_t power = s1 * s1 + s2 * s2 - ((_coefficients[i] * s1 * s2) >> 14);
+                // |X[k]| = A N / 2 for sine with amplitude A
+                uint32_t amplitude = 2 * SquareRoot(power > 0 ? static_cast<uint64_t>(power) : 0) / _BlockSize;
+                _magnitudes[i] = static_cast<Q15>(amplitude > 32767 ? 32767 : amplitude);
+            }
+            Reset();
+            completed = true;
+        }
+        return completed;
+    }
+
+    template<uint32_t _SampleRate, unsigned _BlockSize, uint32_t... _Frequencies>
+    Q15 GoertzelBank<_SampleRate, _BlockSize, _Frequencies...>::Magnitude(unsigned index) const
+    {
+        return _magnitudes[index];
+    }
+
+    template<uint32_t _SampleRate, unsigned _BlockSize, uint32_t... _Frequencies>
+    void GoertzelBank<_SampleRate, _BlockSize, _Frequencies...>::Reset()
+    {
+        for (unsigned i = 0; i < Count; ++i)
+        {
+            _s1[i] = 0;
+            _s2[i] = 0;
+        }
+        _samples = 0;
+    }
+}
+
+#endif //! ZHELE_SPECTRUM_IMPL_COMMON_H
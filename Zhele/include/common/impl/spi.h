@@ -48,50 +48,90 @@ namespace Zhele::Private
         Enable();
     }
 
+    SPI_TEMPLATE_ARGS
+    template<uint32_t _MaxFreq, typename _ClockTree>
+    void SPI_TEMPLATE_QUALIFIER::Init(SPI_TEMPLATE_QUALIFIER::Mode mode)
+    {
+        constexpr uint32_t busClock = _ClockTree::template BusClockFreq<_Clock>;
+        constexpr ClockDivider divider = CalculateDivider(busClock, _MaxFreq);
+        static_assert((busClock >> ((divider >> SPI_CR1_BR_Pos) + 1)) <= _MaxFreq, "SPI clock cannot be divided down to required frequence");
+
+        Init(divider, mode);
+    }
+
     SPI_TEMPLATE_ARGS
     void SPI_TEMPLATE_QUALIFIER::SetDivider(SPI_TEMPLATE_QUALIFIER::ClockDivider divider)
     {
-        _Regs()->CR1 = (_Regs()->CR1 & ~SPI_CR1_BR) | divider;
+        ModifyRegister(_Regs()->CR1, RegisterField<SPI_CR1_BR>::Bits(divider));
+    }
+
+    SPI_TEMPLATE_ARGS
+    uint32_t SPI_TEMPLATE_QUALIFIER::GetClockFreq()
+    {
+        return _Clock::ClockFreq();
+    }
+
+    SPI_TEMPLATE_ARGS
+    uint32_t SPI_TEMPLATE_QUALIFIER::SetClockFreq(uint32_t maxFreq)
+    {
+        uint32_t busClock = GetClockFreq();
+        ClockDivider divider = CalculateDivider(busClock, maxFreq);
+        SetDivider(divider);
+        return busClock >> ((divider >> SPI_CR1_BR_Pos) + 1);
     }
 
     SPI_TEMPLATE_ARGS
     void SPI_TEMPLATE_QUALIFIER::SetClockPolarity(SPI_TEMPLATE_QUALIFIER::ClockPolarity clockPolarity)
     {
-        _Regs()->CR1 = (_Regs()->CR1 & ~SPI_CR1_CPOL) | clockPolarity;
+        ModifyRegister(_Regs()->CR1, RegisterField<SPI_CR1_CPOL>::Bits(clockPolarity));
     }
 
     SPI_TEMPLATE_ARGS
     void SPI_TEMPLATE_QUALIFIER::SetClockPhase(SPI_TEMPLATE_QUALIFIER::ClockPhase clockPhase)
     {
-        _Regs()->CR1 = (_Regs()->CR1 & ~SPI_CR1_CPHA) | clockPhase;
+        ModifyRegister(_Regs()->CR1, RegisterField<SPI_CR1_CPHA>::Bits(clockPhase));
     }
 
     SPI_TEMPLATE_ARGS
     void SPI_TEMPLATE_QUALIFIER::SetBitOrder(SPI_TEMPLATE_QUALIFIER::BitOrder bitOrder)
     {
-        _Regs()->CR1 = (_Regs()->CR1 & ~SPI_CR1_LSBFIRST) | bitOrder;
+        ModifyRegister(_Regs()->CR1, RegisterField<SPI_CR1_LSBFIRST>::Bits(bitOrder));
     }
 
     SPI_TEMPLATE_ARGS
     void SPI_TEMPLATE_QUALIFIER::SetDataSize(SPI_TEMPLATE_QUALIFIER::DataSize dataSize)
     {
         #if defined (SPI_CR1_DFF)
-            _Regs()->CR1 = (_Regs()->CR1 & ~SPI_CR1_DFF_Msk) | dataSize;
+            ModifyRegister(_Regs()->CR1, RegisterField<SPI_CR1_DFF>::Bits(dataSize));
         #else
-            _Regs()->CR2 = (_Regs()->CR2 & ~SPI_CR2_DS) | dataSize;
+            ModifyRegister(_Regs()->CR2, RegisterField<SPI_CR2_DS>::Bits(dataSize)
             #if defined(SPI_CR2_FRXTH)
-                if(dataSize <= DataSize8)
-                {
-                    _Regs()->CR2 |= SPI_CR2_FRXTH;
-                }
+                // RXNE event threshold should match frame size
+                | RegisterField<SPI_CR2_FRXTH>::Value(dataSize <= DataSize8)
             #endif
+                );
+        #endif
+    }
+
+    SPI_TEMPLATE_ARGS
+    void SPI_TEMPLATE_QUALIFIER::SetFrameFormat(SPI_TEMPLATE_QUALIFIER::ClockPolarity clockPolarity, SPI_TEMPLATE_QUALIFIER::ClockPhase clockPhase,
+        SPI_TEMPLATE_QUALIFIER::BitOrder bitOrder, SPI_TEMPLATE_QUALIFIER::DataSize dataSize)
+    {
+        auto format = RegisterField<SPI_CR1_CPOL>::Bits(clockPolarity)
+            | RegisterField<SPI_CR1_CPHA>::Bits(clockPhase)
+            | RegisterField<SPI_CR1_LSBFIRST>::Bits(bitOrder);
+        #if defined (SPI_CR1_DFF)
+            ModifyRegister(_Regs()->CR1, format | RegisterField<SPI_CR1_DFF>::Bits(dataSize));
+        #else
+            ModifyRegister(_Regs()->CR1, format);
+            SetDataSize(dataSize);
         #endif
     }
 
     SPI_TEMPLATE_ARGS
     void SPI_TEMPLATE_QUALIFIER::SetSlaveControl(SPI_TEMPLATE_QUALIFIER::SlaveControl slaveControl)
     {
-        _Regs()->CR1 = (_Regs()->CR1 & ~SPI_CR1_SSM) | slaveControl;
+        ModifyRegister(_Regs()->CR1, RegisterField<SPI_CR1_SSM>::Bits(slaveControl));
     }
 
     SPI_TEMPLATE_ARGS
@@ -159,7 +199,7 @@ namespace Zhele::Private
             ? (_DmaTx::PSize16Bits | _DmaTx::MSize16Bits)
             : (_DmaTx::PSize8Bits | _DmaTx::MSize8Bits);
         _DmaRx::SetTransferCallback(callback);
-        _DmaRx::Transfer(_DmaRx::Periph2Mem | _DmaRx::MemIncrement | _DmaRx::Circular | dataSize, receiveBuffer, &_Regs()->DR, bufferSize);
+        _DmaRx::Transfer(_DmaRx::Periph2Mem | _DmaRx::MemIncrement | dataSize, receiveBuffer, &_Regs()->DR, bufferSize);
 
         _DmaTx::Transfer(_DmaTx::Mem2Periph | _DmaRx::MemIncrement | dataSize, transmitBuffer, &_Regs()->DR, bufferSize);
     }
@@ -206,6 +246,31 @@ namespace Zhele::Private
         _DmaTx::Transfer(_DmaTx::Mem2Periph | dataSize, data, &_Regs()->DR, size);
     }
 
+    SPI_TEMPLATE_ARGS
+    void SPI_TEMPLATE_QUALIFIER::WriteStream(const void* data, uint16_t halfSize, TransferCallback callback)
+    {
+        _DmaTx::ClearTransferComplete();
+        _Regs()->CR2 |= SPI_CR2_TXDMAEN;
+        auto dataSize = 
+        #if defined(SPI_CR1_DFF)
+            (_Regs()->CR1 & SPI_CR1_DFF) > 0
+        #else
+            (_Regs()->CR2 & SPI_CR2_DS) > DataSize8
+        #endif
+            ? (_DmaTx::PSize16Bits | _DmaTx::MSize16Bits)
+            : (_DmaTx::PSize8Bits | _DmaTx::MSize8Bits);
+
+        _DmaTx::SetTransferCallback(callback);
+        _DmaTx::PingPongTransfer(_DmaTx::Mem2Periph | _DmaTx::MemIncrement | dataSize, const_cast<void*>(data), &_Regs()->DR, halfSize);
+    }
+
+    SPI_TEMPLATE_ARGS
+    void SPI_TEMPLATE_QUALIFIER::StopWriteStream()
+    {
+        _DmaTx::Disable();
+        _Regs()->CR2 &= ~SPI_CR2_TXDMAEN;
+    }
+
     SPI_TEMPLATE_ARGS
     uint16_t SPI_TEMPLATE_QUALIFIER::Read()
     {
@@ -226,11 +291,266 @@ namespace Zhele::Private
             ? (_DmaTx::PSize16Bits | _DmaTx::MSize16Bits)
             : (_DmaTx::PSize8Bits | _DmaTx::MSize8Bits);
         _DmaRx::SetTransferCallback(callback);
-        _DmaRx::Transfer(_DmaRx::Periph2Mem | _DmaRx::MemIncrement | _DmaRx::Circular | dataSize, receiveBuffer, &_Regs()->DR, bufferSize);
+        _DmaRx::Transfer(_DmaRx::Periph2Mem | _DmaRx::MemIncrement | dataSize, receiveBuffer, &_Regs()->DR, bufferSize);
 
         // Send dummmy value
         uint16_t dummy = 0xffff;
         _DmaTx::Transfer(_DmaTx::Mem2Periph | dataSize, &dummy, &_Regs()->DR, bufferSize);
     }
+
+    SPI_TEMPLATE_ARGS
+    void SPI_TEMPLATE_QUALIFIER::WriteBuffer(const void* data, size_t size)
+    {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+
+        if(size >= WideTransferThreshold && !WideFrames())
+        {
+            ChangeDataSize(DataSize16);
+            for(; size >= sizeof(uint32_t); size -= sizeof(uint32_t), bytes += sizeof(uint32_t))
+            {
+                uint32_t word;
+                memcpy(&word, bytes, sizeof(word));
+                word = SwapFrames(word);
+                TransferFrame(static_cast<uint16_t>(word));
+                TransferFrame(static_cast<uint16_t>(word >> 16));
+            }
+            ChangeDataSize(DataSize8);
+        }
+
+        for(; size > 0; --size, ++bytes)
+            Send(*bytes);
+    }
+
+    SPI_TEMPLATE_ARGS
+    void SPI_TEMPLATE_QUALIFIER::ReadBuffer(void* data, size_t size)
+    {
+        uint8_t* bytes = static_cast<uint8_t*>(data);
+
+        if(size >= WideTransferThreshold && !WideFrames())
+        {
+            ChangeDataSize(DataSize16);
+            for(; size >= sizeof(uint32_t); size -= sizeof(uint32_t), bytes += sizeof(uint32_t))
+            {
+                uint32_t word = TransferFrame(0xffff);
+                word |= static_cast<uint32_t>(TransferFrame(0xffff)) << 16;
+                word = SwapFrames(word);
+                memcpy(bytes, &word, sizeof(word));
+            }
+            ChangeDataSize(DataSize8);
+        }
+
+        for(; size > 0; --size, ++bytes)
+            *bytes = static_cast<uint8_t>(Send(0xffff));
+    }
+
+    SPI_TEMPLATE_ARGS
+    void SPI_TEMPLATE_QUALIFIER::DisableDma()
+    {
+        _Regs()->CR2 &= ~(SPI_CR2_RXDMAEN | SPI_CR2_TXDMAEN);
+    }
+
+    SPI_TEMPLATE_ARGS
+    bool SPI_TEMPLATE_QUALIFIER::QueueTransaction(const Transaction& transaction)
+    {
+        uint32_t state = DriverCriticalSection::Enter();
+        bool queued = _transactions.push_back(transaction);
+        if(queued && !_transactionActive)
+        {
+            _transactionActive = true;
+            StartTransaction();
+        }
+        DriverCriticalSection::Leave(state);
+
+        return queued;
+    }
+
+    SPI_TEMPLATE_ARGS
+    size_t SPI_TEMPLATE_QUALIFIER::TransactionQueueFree()
+    {
+        return _transactions.capacity() - _transactions.size();
+    }
+
+    SPI_TEMPLATE_ARGS
+    bool SPI_TEMPLATE_QUALIFIER::TransactionQueueEmpty()
+    {
+        return !_transactionActive;
+    }
+
+    SPI_TEMPLATE_ARGS
+    bool SPI_TEMPLATE_QUALIFIER::WideFrames()
+    {
+    #if defined(SPI_CR1_DFF)
+        return (_Regs()->CR1 & SPI_CR1_DFF) > 0;
+    #else
+        return (_Regs()->CR2 & SPI_CR2_DS) > DataSize8;
+    #endif
+    }
+
+    SPI_TEMPLATE_ARGS
+    void SPI_TEMPLATE_QUALIFIER::ChangeDataSize(SPI_TEMPLATE_QUALIFIER::DataSize dataSize)
+    {
+        // Data size can be changed only if SPI is disabled
+        while(Busy())
+            continue;
+        Disable();
+        SetDataSize(dataSize);
+        Enable();
+    }
+
+    SPI_TEMPLATE_ARGS
+    uint16_t SPI_TEMPLATE_QUALIFIER::TransferFrame(uint16_t value)
+    {
+        while ((_Regs()->SR & SPI_SR_TXE) == 0);
+        _Regs()->DR = value;
+        while ((_Regs()->SR & SPI_SR_RXNE) == 0);
+        return _Regs()->DR;
+    }
+
+    SPI_TEMPLATE_ARGS
+    uint32_t SPI_TEMPLATE_QUALIFIER::SwapFrames(uint32_t word)
+    {
+        // MSB first frame sends high byte first, so bytes in each half-word are swapped
+        return (_Regs()->CR1 & SPI_CR1_LSBFIRST) != 0
+            ? word
+            : __REV16(word);
+    }
+
+    SPI_TEMPLATE_ARGS
+    void SPI_TEMPLATE_QUALIFIER::StartTransaction()
+    {
+        const Transaction& transaction = _transactions.front();
+
+    #if defined (SPI_CR1_DFF)
+        if((_Regs()->CR1 & SPI_CR1_DFF) != transaction.dataSize)
+    #else
+        if((_Regs()->CR2 & SPI_CR2_DS) != transaction.dataSize)
+    #endif
+        {
+            ChangeDataSize(transaction.dataSize);
+        }
+
+        if(transaction.chipSelect != nullptr && (transaction.chipSelectAction & SelectBefore) != 0)
+            transaction.chipSelect(true);
+
+        typename _DmaTx::Mode dataSize = transaction.dataSize > DataSize8
+            ? (_DmaTx::PSize16Bits | _DmaTx::MSize16Bits)
+            : (_DmaTx::PSize8Bits | _DmaTx::MSize8Bits);
+
+        _DmaRx::ClearTransferComplete();
+        _DmaTx::ClearTransferComplete();
+        _Regs()->CR2 |= SPI_CR2_RXDMAEN;
+        _DmaRx::SetTransferCallback(TransactionComplete);
+        if(transaction.receiveBuffer != nullptr)
+            _DmaRx::Transfer(_DmaRx::Periph2Mem | _DmaRx::MemIncrement | dataSize, transaction.receiveBuffer, &_Regs()->DR, transaction.size);
+        else
+            _DmaRx::Transfer(_DmaRx::Periph2Mem | dataSize, &_receiveDummy, &_Regs()->DR, transaction.size);
+
+        _Regs()->CR2 |= SPI_CR2_TXDMAEN;
+        _DmaTx::SetTransferCallback(nullptr);
+        if(transaction.transmitBuffer != nullptr)
+            _DmaTx::Transfer(_DmaTx::Mem2Periph | _DmaTx::MemIncrement | dataSize, transaction.transmitBuffer, &_Regs()->DR, transaction.size);
+        else
+            _DmaTx::Transfer(_DmaTx::Mem2Periph | dataSize, &_transmitDummy, &_Regs()->DR, transaction.size);
+    }
+
+    SPI_TEMPLATE_ARGS
+    void SPI_TEMPLATE_QUALIFIER::TransactionComplete(void* data, unsigned size, bool success)
+    {
+        Transaction transaction = _transactions.front();
+        _transactions.pop_front();
+
+        if(transaction.chipSelect != nullptr && (transaction.chipSelectAction & DeselectAfter) != 0)
+            transaction.chipSelect(false);
+
+        if(!_transactions.empty())
+            StartTransaction();
+        else
+            _transactionActive = false;
+
+        if(transaction.callback)
+            transaction.callback(transaction.receiveBuffer, transaction.size, success);
+    }
+
+    SPI_TEMPLATE_ARGS
+    template<typename _NssExti, typename _NssPin>
+    void SPI_TEMPLATE_QUALIFIER::EnableSlaveStream(const void* transmitBuffer, void* receiveBuffer, uint16_t size, SlaveFrameCallback callback)
+    {
+        _slaveStream.TransmitBuffer = transmitBuffer;
+        _slaveStream.ReceiveBuffer = static_cast<uint8_t*>(receiveBuffer);
+        _slaveStream.Size = size;
+        _slaveStream.Active = 0;
+        _slaveStream.Callback = callback;
+
+        _DmaRx::SetTransferCallback(nullptr);
+        _DmaTx::SetTransferCallback(nullptr);
+        ArmSlaveStream();
+
+        _NssExti::template Init<_NssExti::Rising, typename _NssPin::Port>();
+        _NssExti::ClearInterruptFlag();
+        _NssExti::EnableInterrupt();
+    }
+
+    SPI_TEMPLATE_ARGS
+    void SPI_TEMPLATE_QUALIFIER::DisableSlaveStream()
+    {
+        _slaveStream.Size = 0;
+        _Regs()->CR2 &= ~(SPI_CR2_RXDMAEN | SPI_CR2_TXDMAEN);
+        _DmaTx::Disable();
+        _DmaRx::Disable();
+    }
+
+    SPI_TEMPLATE_ARGS
+    void SPI_TEMPLATE_QUALIFIER::SlaveFrameEnd()
+    {
+        if(_slaveStream.Size == 0)
+            return;
+
+        // Last received frame may wait for DMA service yet
+        for(unsigned i = 0; i < 16 && (_Regs()->SR & SPI_SR_RXNE) != 0; ++i)
+            continue;
+
+        uint16_t received = _slaveStream.Size - _DmaRx::RemainingTransfers();
+        uint8_t* frame = _slaveStream.ReceiveBuffer + _slaveStream.Active * _slaveStream.Size * (WideFrames() ? 2 : 1);
+
+        _slaveStream.Active ^= 1;
+        ArmSlaveStream();
+
+        if(_slaveStream.Callback)
+            _slaveStream.Callback(frame, received);
+    }
+
+    SPI_TEMPLATE_ARGS
+    void SPI_TEMPLATE_QUALIFIER::ArmSlaveStream()
+    {
+        _Regs()->CR2 &= ~(SPI_CR2_RXDMAEN | SPI_CR2_TXDMAEN);
+        _DmaTx::Disable();
+        _DmaRx::Disable();
+        Disable();
+
+        // Drop frames received after buffer end (and overrun flag, it is cleared by DR and SR read)
+        while((_Regs()->SR & SPI_SR_RXNE) != 0)
+            static_cast<void>(_Regs()->DR);
+        static_cast<void>(_Regs()->SR);
+
+        bool wide = WideFrames();
+        typename _DmaTx::Mode dataSize = wide
+            ? (_DmaTx::PSize16Bits | _DmaTx::MSize16Bits)
+            : (_DmaTx::PSize8Bits | _DmaTx::MSize8Bits);
+        uint8_t* receiveBuffer = _slaveStream.ReceiveBuffer + _slaveStream.Active * _slaveStream.Size * (wide ? 2 : 1);
+
+        // Receive DMA is enabled before transmit one, SPI is enabled last (see reference manual)
+        _DmaRx::ClearTransferComplete();
+        _DmaRx::Transfer(_DmaRx::Periph2Mem | _DmaRx::MemIncrement | dataSize, receiveBuffer, &_Regs()->DR, _slaveStream.Size);
+        _Regs()->CR2 |= SPI_CR2_RXDMAEN;
+
+        _DmaTx::ClearTransferComplete();
+        if(_slaveStream.TransmitBuffer != nullptr)
+            _DmaTx::Transfer(_DmaTx::Mem2Periph | _DmaTx::MemIncrement | dataSize, _slaveStream.TransmitBuffer, &_Regs()->DR, _slaveStream.Size);
+        else
+            _DmaTx::Transfer(_DmaTx::Mem2Periph | dataSize, &_transmitDummy, &_Regs()->DR, _slaveStream.Size);
+        _Regs()->CR2 |= SPI_CR2_TXDMAEN;
+
+        Enable();
+    }
 }
 #endif //! ZHELE_SPI_IMPL_COMMON_H
\ No newline at end of file
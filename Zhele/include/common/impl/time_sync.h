@@ -0,0 +1,176 @@
+/**
+ * @file
+ * Time synchronization methods implementation
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_TIME_SYNC_IMPL_COMMON_H
+#define ZHELE_TIME_SYNC_IMPL_COMMON_H
+
+namespace Zhele::Clock
+{
+    template<typename _Timebase, unsigned _Channel>
+    volatile uint32_t TimebaseCapture<_Timebase, _Channel>::_timestamp = 0;
+    template<typename _Timebase, unsigned _Channel>
+    volatile bool TimebaseCapture<_Timebase, _Channel>::_ready = false;
+    template<typename _Timebase, unsigned _Channel>
+    bool TimebaseCapture<_Timebase, _Channel>::_oneShot = false;
+
+    template<typename _Timebase, unsigned _Channel>
+    template<typename _Pin>
+    void TimebaseCapture<_Timebase, _Channel>::Init(bool fallingEdge, bool oneShot)
+    {
+        _oneShot = oneShot;
+        _ready = false;
+
+        Capture::template SelectPins<_Pin>();
+        Capture::SetCapturePolarity(fallingEdge ? Capture::CapturePolarity::FallingEdge : Capture::CapturePolarity::RisingEdge);
+        Capture::SetCaptureMode(Capture::CaptureMode::Direct);
+        Capture::ClearInterruptFlag();
+        Capture::EnableInterrupt();
+        if(!oneShot)
+            Capture::Enable();
+    }
+
+    template<typename _Timebase, unsigned _Channel>
+    void TimebaseCapture<_Timebase, _Channel>::Arm()
+    {
+        Capture::ClearInterruptFlag();
+        Capture::Enable();
+    }
+
+    template<typename _Timebase, unsigned _Channel>
+    bool TimebaseCapture<_Timebase, _Channel>::Get(uint32_t& timestamp)
+    {
+        if(!_ready)
+            return false;
+
+        timestamp = _timestamp;
+        _ready = false;
+        return true;
+    }
+
+    template<typename _Timebase, unsigned _Channel>
+    void TimebaseCapture<_Timebase, _Channel>::IrqHandler()
+    {
+        if(!Capture::IsInterrupt())
+            return;
+
+        uint16_t capture = Capture::GetValue();
+        Capture::ClearInterruptFlag();
+        if(_oneShot)
+            Capture::Disable();
+
+        // Ticks counter has passed capture less than 65536 ticks ago
+        uint32_t now = _Timebase::Ticks();
+        _timestamp = now - static_cast<uint16_t>(static_cast<uint16_t>(now) - capture);
+        _ready = true;
+    }
+
+    inline void TimeSyncMaster::Prepare(TimeSyncMessage& message)
+    {
+        message.Magic = TimeSyncMessage::MagicValue;
+        message.Sequence = _sequence++;
+        // Previous timestamp is unknown: mark it by own sequence (never matches previous one)
+        message.PreviousSequence = _timestampValid ? _timestampSequence : message.Sequence;
+        for(uint8_t i = 0; i < 4; ++i)
+            message.PreviousTimestamp[i] = static_cast<uint8_t>(_timestamp >> (i * 8));
+        _timestampValid = false;
+    }
+
+    inline void TimeSyncMaster::OnTransmitted(uint32_t timestamp)
+    {
+        _timestamp = timestamp;
+        _timestampSequence = _sequence - 1;
+        _timestampValid = true;
+    }
+
+    template<uint32_t _MaxError, uint8_t _DriftShift, uint8_t _MaxRejected>
+    bool TimeSyncSlave<_MaxError, _DriftShift, _MaxRejected>::OnReceived(const TimeSyncMessage& message, uint32_t timestamp)
+    {
+        if(message.Magic != TimeSyncMessage::MagicValue)
+            return false;
+
+        bool updated = false;
+        if(_rxValid && message.PreviousSequence == _rxSequence && message.PreviousSequence != message.Sequence)
+        {
+            uint32_t master = message.PreviousTimestamp[0] | (message.PreviousTimestamp[1] << 8)
+                | (message.PreviousTimestamp[2] << 16) | (static_cast<uint32_t>(message.PreviousTimestamp[3]) << 24);
+            updated = Update(master + _latency, _rxTimestamp);
+        }
+
+        _rxSequence = message.Sequence;
+        _rxTimestamp = timestamp;
+        _rxValid = true;
+        return updated;
+    }
+
+    template<uint32_t _MaxError, uint8_t _DriftShift, uint8_t _MaxRejected>
+    bool TimeSyncSlave<_MaxError, _DriftShift, _MaxRejected>::Update(uint32_t master, uint32_t local)
+    {
+        if(_points == 0)
+        {
+            _master = master;
+            _local = local;
+            _drift = 0;
+            _lastError = 0;
+            _points = 1;
+            return true;
+        }
+
+        int32_t localInterval = static_cast<int32_t>(local - _local);
+        if(localInterval <= 0)
+            return false;
+
+        _lastError = static_cast<int32_t>(master - ToMaster(local));
+        if(_points >= 2 && (_lastError > static_cast<int32_t>(_MaxError) || _lastError < -static_cast<int32_t>(_MaxError)))
+        {
+            if(++_rejected >= _MaxRejected)
+                Reset();
+            return false;
+        }
+        _rejected = 0;
+
+        int32_t masterInterval = static_cast<int32_t>(master - _master);
+        int32_t measured = static_cast<int32_t>((static_cast<int64_t>(masterInterval - localInterval) << 32) / localInterval);
+        if(_points == 1)
+            _drift = measured;
+        else
+            _drift += (measured - _drift) / (1 << _DriftShift);
+
+        _master = master;
+        _local = local;
+        if(_points < 2)
+            ++_points;
+        return true;
+    }
+
+    template<uint32_t _MaxError, uint8_t _DriftShift, uint8_t _MaxRejected>
+    uint32_t TimeSyncSlave<_MaxError, _DriftShift, _MaxRejected>::ToMaster(uint32_t local) const
+    {
+        int32_t interval = static_cast<int32_t>(local - _local);
+        return _master + interval + static_cast<int32_t>((static_cast<int64_t>(interval) * _drift) >> 32);
+    }
+
+    template<uint32_t _MaxError, uint8_t _DriftShift, uint8_t _MaxRejected>
+    uint32_t TimeSyncSlave<_MaxError, _DriftShift, _MaxRejected>::ToLocal(uint32_t master) const
+    {
+        // First order inverse is exact enough for ppm-level drift
+        int32_t interval = static_cast<int32_t>(master - _master);
+        return _local + interval - static_cast<int32_t>((static_cast<int64_t>(interval) * _drift) >> 32);
+    }
+
+    template<uint32_t _MaxError, uint8_t _DriftShift, uint8_t _MaxRejected>
+    void TimeSyncSlave<_MaxError, _DriftShift, _MaxRejected>::Reset()
+    {
+        _points = 0;
+        _rejected = 0;
+        _drift = 0;
+        _rxValid = false;
+    }
+}
+
+#endif //! ZHELE_TIME_SYNC_IMPL_COMMON_H
@@ -0,0 +1,152 @@
+/**
+ * @file
+ * Timebase methods implementation
+ * 
+ * @author Alexey Zhelonkin
+ * @date 2023
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_TIMEBASE_IMPL_COMMON_H
+#define ZHELE_TIMEBASE_IMPL_COMMON_H
+
+namespace Zhele::Clock
+{
+    #define TIMERTIMEBASE_TEMPLATE_ARGS template<typename _LowTimer, typename _HighTimer, typename _HighTimer::SlaveMode::Trigger _Trigger, unsigned long _TickFreq>
+    #define TIMERTIMEBASE_TEMPLATE_QUALIFIER TimerTimebase<_LowTimer, _HighTimer, _Trigger, _TickFreq>
+
+    TIMERTIMEBASE_TEMPLATE_ARGS
+    volatile uint32_t TIMERTIMEBASE_TEMPLATE_QUALIFIER::_overflows = 0;
+
+    TIMERTIMEBASE_TEMPLATE_ARGS
+    void TIMERTIMEBASE_TEMPLATE_QUALIFIER::Init()
+    {
+        _LowTimer::Enable();
+        _LowTimer::SetPrescaler(_LowTimer::GetClockFreq() / _TickFreq - 1);
+        _LowTimer::SetPeriod(0xffff);
+        _LowTimer::SetMasterMode(_LowTimer::MasterMode::Update);
+
+        _HighTimer::Enable();
+        _HighTimer::SetPrescaler(0);
+        _HighTimer::SetPeriod(0xffff);
+        _HighTimer::SlaveMode::SelectTrigger(_Trigger);
+        _HighTimer::SlaveMode::EnableSlaveMode(_HighTimer::SlaveMode::Mode::ExternalClockMode);
+        _HighTimer::ClearInterruptFlag();
+        _HighTimer::EnableInterrupt();
+
+        _overflows = 0;
+        _HighTimer::Start();
+        _LowTimer::Start();
+    }
+
+    TIMERTIMEBASE_TEMPLATE_ARGS
+    uint32_t TIMERTIMEBASE_TEMPLATE_QUALIFIER::Ticks()
+    {
+        uint16_t high, low;
+        do
+        {
+            high = _HighTimer::GetCounterValue();
+            low = _LowTimer::GetCounterValue();
+        } while (high != _HighTimer::GetCounterValue());
+
+        return (static_cast<uint32_t>(high) << 16) | low;
+    }
+
+    TIMERTIMEBASE_TEMPLATE_ARGS
+    uint64_t TIMERTIMEBASE_TEMPLATE_QUALIFIER::Ticks64()
+    {
+        uint32_t overflows, ticks;
+        bool pending;
+        do
+        {
+            overflows = _overflows;
+            ticks = Ticks();
+            pending = _HighTimer::IsInterrupt();
+        } while (overflows != _overflows);
+
+        // Overflow occured, but has not been handled yet (interrupts disabled or called from higher priority ISR)
+        if (pending && (ticks & 0x80000000) == 0)
+            ++overflows;
+
+        return (static_cast<uint64_t>(overflows) << 32) | ticks;
+    }
+
+    TIMERTIMEBASE_TEMPLATE_ARGS
+    uint32_t TIMERTIMEBASE_TEMPLATE_QUALIFIER::Micros()
+    {
+        if constexpr (TicksPerMicrosecond == 1)
+            return Ticks();
+        else
+            return static_cast<uint32_t>(Micros64());
+    }
+
+    TIMERTIMEBASE_TEMPLATE_ARGS
+    uint64_t TIMERTIMEBASE_TEMPLATE_QUALIFIER::Micros64()
+    {
+        return Ticks64() / TicksPerMicrosecond;
+    }
+
+    TIMERTIMEBASE_TEMPLATE_ARGS
+    void TIMERTIMEBASE_TEMPLATE_QUALIFIER::UpdateIrqHandler()
+    {
+        if (_HighTimer::IsInterrupt())
+        {
+            _overflows = _overflows + 1;
+            _HighTimer::ClearInterruptFlag();
+        }
+    }
+
+#if defined (DWT_CTRL_CYCCNTENA_Msk)
+    template<unsigned long _CpuFreq>
+    uint32_t DwtTimebase<_CpuFreq>::_high = 0;
+
+    template<unsigned long _CpuFreq>
+    uint32_t DwtTimebase<_CpuFreq>::_lastLow = 0;
+
+    template<unsigned long _CpuFreq>
+    void DwtTimebase<_CpuFreq>::Init()
+    {
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->CYCCNT = 0;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+        _high = 0;
+        _lastLow = 0;
+    }
+
+    template<unsigned long _CpuFreq>
+    uint32_t DwtTimebase<_CpuFreq>::Ticks()
+    {
+        return DWT->CYCCNT;
+    }
+
+    template<unsigned long _CpuFreq>
+    uint64_t DwtTimebase<_CpuFreq>::Ticks64()
+    {
+        uint32_t state = DriverCriticalSection::Enter();
+
+        uint32_t low = DWT->CYCCNT;
+        if (low < _lastLow)
+            ++_high;
+        _lastLow = low;
+        uint64_t ticks = (static_cast<uint64_t>(_high) << 32) | low;
+
+        DriverCriticalSection::Leave(state);
+        return ticks;
+    }
+
+    template<unsigned long _CpuFreq>
+    uint32_t DwtTimebase<_CpuFreq>::Micros()
+    {
+        return static_cast<uint32_t>(Micros64());
+    }
+
+    template<unsigned long _CpuFreq>
+    uint64_t DwtTimebase<_CpuFreq>::Micros64()
+    {
+        return Ticks64() / TicksPerMicrosecond;
+    }
+#endif
+}
+
+#endif //! ZHELE_TIMEBASE_IMPL_COMMON_H
@@ -88,17 +88,28 @@ namespace Zhele::Timers::Private
         return _Regs()->ARR;
     }
 
+    BASETIMER_TEMPLATE_ARGS
+    void BASETIMER_TEMPLATE_QUALIFIER::SetUpdateRate(uint32_t rate)
+    {
+        uint32_t ticks = GetClockFreq() / rate;
+        if(ticks == 0)
+            ticks = 1;
+        uint32_t prescaler = (ticks - 1) / 0x10000;
+        SetPrescaler(prescaler);
+        SetPeriod(ticks / (prescaler + 1) - 1);
+    }
+
 
     BASETIMER_TEMPLATE_ARGS
     void BASETIMER_TEMPLATE_QUALIFIER::EnableOnePulseMode()
     {
-        _Regs()->CR1 |= TIM_CR1_OPM;
+        BitBand::SetBits(_Regs()->CR1, TIM_CR1_OPM);
     }    
 
     BASETIMER_TEMPLATE_ARGS
     void BASETIMER_TEMPLATE_QUALIFIER::DisableOnePulseMode()
     {
-        _Regs()->CR1 &= ~TIM_CR1_OPM;
+        BitBand::ClearBits(_Regs()->CR1, TIM_CR1_OPM);
     }
 
     BASETIMER_TEMPLATE_ARGS
@@ -118,14 +129,14 @@ namespace Zhele::Timers::Private
     BASETIMER_TEMPLATE_ARGS
     void BASETIMER_TEMPLATE_QUALIFIER::EnableInterrupt(Interrupt interruptMask)
     {
-        _Regs()->DIER |= static_cast<uint16_t>(interruptMask);
-        NVIC_EnableIRQ(_IRQNumber);
+        BitBand::SetBits(_Regs()->DIER, static_cast<uint16_t>(interruptMask));
+        Nvic::EnableIrq<_IRQNumber>();
     }
 
     BASETIMER_TEMPLATE_ARGS
     void BASETIMER_TEMPLATE_QUALIFIER::DisableInterrupt(Interrupt interruptMask)
     {
-        _Regs()->DIER &= ~(static_cast<uint16_t>(interruptMask));
+        BitBand::ClearBits(_Regs()->DIER, static_cast<uint16_t>(interruptMask));
     }
 
     BASETIMER_TEMPLATE_ARGS
@@ -150,18 +161,61 @@ namespace Zhele::Timers::Private
     BASETIMER_TEMPLATE_ARGS
     void BASETIMER_TEMPLATE_QUALIFIER::DmaRequestEnable()
     {
-        _Regs()->DIER |= TIM_DIER_UDE;
+        BitBand::SetBits(_Regs()->DIER, TIM_DIER_UDE);
     }
 
     BASETIMER_TEMPLATE_ARGS
     void BASETIMER_TEMPLATE_QUALIFIER::DmaRequestDisable()
     {
-        _Regs()->DIER &= ~TIM_DIER_UDE;
+        BitBand::ClearBits(_Regs()->DIER, TIM_DIER_UDE);
     }
 
     #define GPTIMER_TEMPLATE_ARGS template<typename _Regs, typename _ClockEnReg, IRQn_Type _IRQNumber, template<unsigned> typename _ChPins>
     #define GPTIMER_TEMPLATE_QUALIFIER GPTimer<_Regs, _ClockEnReg, _IRQNumber, _ChPins>
 
+    GPTIMER_TEMPLATE_ARGS
+    template<typename _DmaChannel>
+    void GPTIMER_TEMPLATE_QUALIFIER::StartDmaBurst(DmaBurstBase base, uint8_t burstLength, const uint16_t* buffer, uint16_t updatesCount,
+        bool circular, TransferCallback callback ONLY_IF_STREAM_SUPPORTED(COMMA uint8_t dmaChannel))
+    {
+        const uint8_t first = static_cast<uint8_t>(base);
+        const uint8_t last = first + burstLength - 1;
+        const auto inBurst = [first, last](DmaBurstBase reg) { return first <= static_cast<uint8_t>(reg) && static_cast<uint8_t>(reg) <= last; };
+
+        StopDmaBurst<_DmaChannel>();
+
+        if(inBurst(DmaBurstBase::Arr))
+            _Regs()->CR1 |= TIM_CR1_ARPE;
+        if(inBurst(DmaBurstBase::Ccr1))
+            _Regs()->CCMR1 |= TIM_CCMR1_OC1PE;
+        if(inBurst(DmaBurstBase::Ccr2))
+            _Regs()->CCMR1 |= TIM_CCMR1_OC2PE;
+        if(inBurst(DmaBurstBase::Ccr3))
+            _Regs()->CCMR2 |= TIM_CCMR2_OC3PE;
+        if(inBurst(DmaBurstBase::Ccr4))
+            _Regs()->CCMR2 |= TIM_CCMR2_OC4PE;
+
+        _Regs()->DCR = ((first << TIM_DCR_DBA_Pos) & TIM_DCR_DBA) | (((burstLength - 1) << TIM_DCR_DBL_Pos) & TIM_DCR_DBL);
+
+        DmaBase::Mode mode = DmaBase::Mem2Periph | DmaBase::MemIncrement | DmaBase::PSize16Bits | DmaBase::MSize16Bits | DmaBase::PriorityHigh;
+        _DmaChannel::SetTransferCallback(callback);
+        if(circular)
+            _DmaChannel::PingPongTransfer(mode, const_cast<uint16_t*>(buffer), &_Regs()->DMAR, burstLength * updatesCount / 2 ONLY_IF_STREAM_SUPPORTED(COMMA dmaChannel));
+        else
+            _DmaChannel::Transfer(mode, buffer, &_Regs()->DMAR, burstLength * updatesCount ONLY_IF_STREAM_SUPPORTED(COMMA dmaChannel));
+
+        Base::DmaRequestEnable();
+    }
+
+    GPTIMER_TEMPLATE_ARGS
+    template<typename _DmaChannel>
+    void GPTIMER_TEMPLATE_QUALIFIER::StopDmaBurst()
+    {
+        Base::DmaRequestDisable();
+        _DmaChannel::Disable();
+        _Regs()->DCR = 0;
+    }
+
     GPTIMER_TEMPLATE_ARGS
     void GPTIMER_TEMPLATE_QUALIFIER::SlaveMode::EnableSlaveMode(Mode mode)
     {
@@ -186,19 +240,37 @@ namespace Zhele::Timers::Private
         _Regs()->SMCR = (_Regs()->SMCR & ~TIM_SMCR_ETPS_Msk) | static_cast<uint16_t>(prescaler);
     }
 
+    GPTIMER_TEMPLATE_ARGS
+    void GPTIMER_TEMPLATE_QUALIFIER::SlaveMode::SetExternalTriggerFilter(ExternalTriggerFilter filter)
+    {
+        _Regs()->SMCR = (_Regs()->SMCR & ~TIM_SMCR_ETF_Msk) | static_cast<uint16_t>(filter);
+    }
+
+    GPTIMER_TEMPLATE_ARGS
+    void GPTIMER_TEMPLATE_QUALIFIER::SlaveMode::SetExternalTriggerPolarity(ExternalTriggerPolarity polarity)
+    {
+        _Regs()->SMCR = (_Regs()->SMCR & ~TIM_SMCR_ETP_Msk) | static_cast<uint16_t>(polarity);
+    }
+
+    GPTIMER_TEMPLATE_ARGS
+    void GPTIMER_TEMPLATE_QUALIFIER::SlaveMode::SetExternalClockMode2(ExternalClockMode2 mode)
+    {
+        _Regs()->SMCR = (_Regs()->SMCR & ~TIM_SMCR_ECE_Msk) | static_cast<uint16_t>(mode);
+    }
+
     GPTIMER_TEMPLATE_ARGS
     template<unsigned _ChannelNumber>
     void GPTIMER_TEMPLATE_QUALIFIER::ChannelBase<_ChannelNumber>::EnableInterrupt()
     {
-        _Regs()->DIER |= (TIM_DIER_CC1IE << _ChannelNumber);
-        NVIC_EnableIRQ(_IRQNumber);
+        BitBand::SetBits(_Regs()->DIER, TIM_DIER_CC1IE << _ChannelNumber);
+        Nvic::EnableIrq<_IRQNumber>();
     }
 
     GPTIMER_TEMPLATE_ARGS
     template<unsigned _ChannelNumber>
     void GPTIMER_TEMPLATE_QUALIFIER::ChannelBase<_ChannelNumber>::DisableInterrupt()
     {
-        _Regs()->DIER &= ~(TIM_DIER_CC1IE << _ChannelNumber);
+        BitBand::ClearBits(_Regs()->DIER, TIM_DIER_CC1IE << _ChannelNumber);
     }
 
     GPTIMER_TEMPLATE_ARGS
@@ -219,14 +291,14 @@ namespace Zhele::Timers::Private
     template<unsigned _ChannelNumber>
     void GPTIMER_TEMPLATE_QUALIFIER::ChannelBase<_ChannelNumber>::EnableDmaRequest()
     {
-        _Regs()->DIER |= (TIM_DIER_CC1DE << _ChannelNumber);
+        BitBand::SetBits(_Regs()->DIER, TIM_DIER_CC1DE << _ChannelNumber);
     }
 
     GPTIMER_TEMPLATE_ARGS
     template<unsigned _ChannelNumber>
     void GPTIMER_TEMPLATE_QUALIFIER::ChannelBase<_ChannelNumber>::DisableDmaRequest()
     {
-        _Regs()->DIER &= ~(TIM_DIER_CC1DE << _ChannelNumber);
+        BitBand::ClearBits(_Regs()->DIER, TIM_DIER_CC1DE << _ChannelNumber);
     }
 
     GPTIMER_TEMPLATE_ARGS
@@ -257,6 +329,13 @@ namespace Zhele::Timers::Private
         Channel::ModeBitField::Set(mode);
     }
 
+    GPTIMER_TEMPLATE_ARGS
+    template<unsigned _ChannelNumber>
+    void GPTIMER_TEMPLATE_QUALIFIER::InputCapture<_ChannelNumber>::SetCapturePrescaler(CapturePrescaler prescaler)
+    {
+        Channel::ModeBitField::Set((Channel::ModeBitField::Get() & ~TIM_CCMR1_IC1PSC) | static_cast<uint32_t>(prescaler));
+    }
+
     GPTIMER_TEMPLATE_ARGS
     template<unsigned _ChannelNumber>
     typename GPTIMER_TEMPLATE_QUALIFIER::Base::Counter GPTIMER_TEMPLATE_QUALIFIER::InputCapture<_ChannelNumber>::GetValue()
@@ -264,6 +343,39 @@ namespace Zhele::Timers::Private
         return (&_Regs()->CCR1)[_ChannelNumber];
     }
 
+    GPTIMER_TEMPLATE_ARGS
+    template<unsigned _ChannelNumber>
+    template<typename _DmaChannel>
+    void GPTIMER_TEMPLATE_QUALIFIER::InputCapture<_ChannelNumber>::StartCaptureStream(uint16_t* buffer, uint16_t halfSize, TransferCallback callback
+        ONLY_IF_STREAM_SUPPORTED(COMMA uint8_t dmaChannel))
+    {
+        _DmaChannel::SetTransferCallback(callback);
+        _DmaChannel::PingPongTransfer(DmaBase::Periph2Mem | DmaBase::MemIncrement | DmaBase::PSize16Bits | DmaBase::MSize16Bits | DmaBase::PriorityHigh,
+            buffer, &(&_Regs()->CCR1)[_ChannelNumber], halfSize ONLY_IF_STREAM_SUPPORTED(COMMA dmaChannel));
+        Channel::EnableDmaRequest();
+    }
+
+    GPTIMER_TEMPLATE_ARGS
+    template<unsigned _ChannelNumber>
+    template<typename _DmaChannel>
+    void GPTIMER_TEMPLATE_QUALIFIER::InputCapture<_ChannelNumber>::StartCaptureRing(uint16_t* buffer, uint16_t size
+        ONLY_IF_STREAM_SUPPORTED(COMMA uint8_t dmaChannel))
+    {
+        _DmaChannel::SetTransferCallback(nullptr);
+        _DmaChannel::Transfer(DmaBase::Periph2Mem | DmaBase::MemIncrement | DmaBase::PSize16Bits | DmaBase::MSize16Bits | DmaBase::Circular | DmaBase::PriorityHigh,
+            buffer, &(&_Regs()->CCR1)[_ChannelNumber], size ONLY_IF_STREAM_SUPPORTED(COMMA dmaChannel));
+        Channel::EnableDmaRequest();
+    }
+
+    GPTIMER_TEMPLATE_ARGS
+    template<unsigned _ChannelNumber>
+    template<typename _DmaChannel>
+    void GPTIMER_TEMPLATE_QUALIFIER::InputCapture<_ChannelNumber>::StopCaptureStream()
+    {
+        Channel::DisableDmaRequest();
+        _DmaChannel::Disable();
+    }
+
     GPTIMER_TEMPLATE_ARGS
     template<unsigned _ChannelNumber>
     void GPTIMER_TEMPLATE_QUALIFIER::OutputCompare<_ChannelNumber>::SetPulse(typename Base::Counter pulse)
@@ -338,8 +450,89 @@ namespace Zhele::Timers::Private
         Base::template SelectPins<Pin>();
     }
 
-    #define ADVANCED_TIMER_TEMPLATE_ARGS template<typename _Regs, typename _ClockEnReg, IRQn_Type _IRQNumber, template<unsigned> typename _ChPins>
-    #define ADVANCED_TIMER_TEMPLATE_QUALIFIER AdvancedTimer<_Regs, _ClockEnReg, _IRQNumber, _ChPins>
+    #define ADVANCED_TIMER_TEMPLATE_ARGS template<typename _Regs, typename _ClockEnReg, IRQn_Type _IRQNumber, template<unsigned> typename _ChPins, template<unsigned> typename _ChNPins, typename _BreakPins, IRQn_Type _BreakIRQNumber>
+    #define ADVANCED_TIMER_TEMPLATE_QUALIFIER AdvancedTimer<_Regs, _ClockEnReg, _IRQNumber, _ChPins, _ChNPins, _BreakPins, _BreakIRQNumber>
+
+    ADVANCED_TIMER_TEMPLATE_ARGS
+    void ADVANCED_TIMER_TEMPLATE_QUALIFIER::SetDeadTime(uint8_t dtg)
+    {
+        _Regs()->BDTR = (_Regs()->BDTR & ~TIM_BDTR_DTG_Msk) | (dtg << TIM_BDTR_DTG_Pos);
+    }
+
+    ADVANCED_TIMER_TEMPLATE_ARGS
+    void ADVANCED_TIMER_TEMPLATE_QUALIFIER::SetDeadTimeNs(unsigned nanoseconds)
+    {
+        _Regs()->CR1 &= ~TIM_CR1_CKD_Msk;
+        unsigned ticks = static_cast<unsigned>((static_cast<uint64_t>(Base::GetClockFreq()) * nanoseconds + 999999999u) / 1000000000u);
+        SetDeadTime(DeadTimeToDtg(ticks));
+    }
+
+    ADVANCED_TIMER_TEMPLATE_ARGS
+    void ADVANCED_TIMER_TEMPLATE_QUALIFIER::EnableBreak(BreakPolarity polarity, bool automaticOutput)
+    {
+        _Regs()->BDTR = (_Regs()->BDTR & ~(TIM_BDTR_BKP | TIM_BDTR_AOE))
+            | TIM_BDTR_BKE
+            | static_cast<uint16_t>(polarity)
+            | (automaticOutput ? TIM_BDTR_AOE : 0);
+    }
+
+    ADVANCED_TIMER_TEMPLATE_ARGS
+    void ADVANCED_TIMER_TEMPLATE_QUALIFIER::DisableBreak()
+    {
+        _Regs()->BDTR &= ~(TIM_BDTR_BKE | TIM_BDTR_AOE);
+    }
+
+    ADVANCED_TIMER_TEMPLATE_ARGS
+    void ADVANCED_TIMER_TEMPLATE_QUALIFIER::EnableBreakInterrupt()
+    {
+        BitBand::SetBits(_Regs()->DIER, TIM_DIER_BIE);
+        Nvic::EnableIrq<_BreakIRQNumber>();
+    }
+
+    ADVANCED_TIMER_TEMPLATE_ARGS
+    void ADVANCED_TIMER_TEMPLATE_QUALIFIER::DisableBreakInterrupt()
+    {
+        BitBand::ClearBits(_Regs()->DIER, TIM_DIER_BIE);
+    }
+
+    ADVANCED_TIMER_TEMPLATE_ARGS
+    bool ADVANCED_TIMER_TEMPLATE_QUALIFIER::IsBreak()
+    {
+        return _Regs()->SR & TIM_SR_BIF;
+    }
+
+    ADVANCED_TIMER_TEMPLATE_ARGS
+    void ADVANCED_TIMER_TEMPLATE_QUALIFIER::ClearBreakFlag()
+    {
+        _Regs()->SR = ~TIM_SR_BIF;
+        NVIC_ClearPendingIRQ(_BreakIRQNumber);
+    }
+
+    ADVANCED_TIMER_TEMPLATE_ARGS
+    void ADVANCED_TIMER_TEMPLATE_QUALIFIER::EnableOutputs()
+    {
+        _Regs()->BDTR |= TIM_BDTR_MOE;
+    }
+
+    ADVANCED_TIMER_TEMPLATE_ARGS
+    void ADVANCED_TIMER_TEMPLATE_QUALIFIER::DisableOutputs()
+    {
+        _Regs()->BDTR &= ~TIM_BDTR_MOE;
+    }
+
+    ADVANCED_TIMER_TEMPLATE_ARGS
+    void ADVANCED_TIMER_TEMPLATE_QUALIFIER::SetOffStateSelection(bool runMode, bool idleMode)
+    {
+        _Regs()->BDTR = (_Regs()->BDTR & ~(TIM_BDTR_OSSR | TIM_BDTR_OSSI))
+            | (runMode ? TIM_BDTR_OSSR : 0)
+            | (idleMode ? TIM_BDTR_OSSI : 0);
+    }
+
+    ADVANCED_TIMER_TEMPLATE_ARGS
+    void ADVANCED_TIMER_TEMPLATE_QUALIFIER::Lock(LockLevel level)
+    {
+        _Regs()->BDTR = (_Regs()->BDTR & ~TIM_BDTR_LOCK_Msk) | static_cast<uint16_t>(level);
+    }
 
     ADVANCED_TIMER_TEMPLATE_ARGS
     void ADVANCED_TIMER_TEMPLATE_QUALIFIER::SetRepetitionCounter(uint8_t repetitionCounter)
@@ -352,5 +545,36 @@ namespace Zhele::Timers::Private
     {
         return _Regs()->RCR & 0xff;
     }
+
+    ADVANCED_TIMER_TEMPLATE_ARGS
+    template<unsigned _ChannelNumber>
+    void ADVANCED_TIMER_TEMPLATE_QUALIFIER::ComplementaryPWMGeneration<_ChannelNumber>::EnableComplementary()
+    {
+        _Regs()->CCER |= (TIM_CCER_CC1NE << (_ChannelNumber * 4));
+    }
+
+    ADVANCED_TIMER_TEMPLATE_ARGS
+    template<unsigned _ChannelNumber>
+    void ADVANCED_TIMER_TEMPLATE_QUALIFIER::ComplementaryPWMGeneration<_ChannelNumber>::DisableComplementary()
+    {
+        _Regs()->CCER &= ~(TIM_CCER_CC1NE << (_ChannelNumber * 4));
+    }
+
+    ADVANCED_TIMER_TEMPLATE_ARGS
+    template<unsigned _ChannelNumber>
+    void ADVANCED_TIMER_TEMPLATE_QUALIFIER::ComplementaryPWMGeneration<_ChannelNumber>::SetComplementaryPolarity(OutputPolarity polarity)
+    {
+        // CCxNP is located next to CCxNE as CCxP next to CCxE
+        _Regs()->CCER = (_Regs()->CCER & ~(TIM_CCER_CC1NP << (_ChannelNumber * 4)))
+            | ((polarity == OutputPolarity::ActiveLow ? TIM_CCER_CC1NP : 0) << (_ChannelNumber * 4));
+    }
+
+    ADVANCED_TIMER_TEMPLATE_ARGS
+    template<unsigned _ChannelNumber>
+    void ADVANCED_TIMER_TEMPLATE_QUALIFIER::ComplementaryPWMGeneration<_ChannelNumber>::SetIdleState(bool output, bool complementary)
+    {
+        _Regs()->CR2 = (_Regs()->CR2 & ~((TIM_CR2_OIS1 | TIM_CR2_OIS1N) << (_ChannelNumber * 2)))
+            | (((output ? TIM_CR2_OIS1 : 0) | (complementary ? TIM_CR2_OIS1N : 0)) << (_ChannelNumber * 2));
+    }
 }
 #endif //! ZHELE_TIMER_IMPL_COMMON_H
\ No newline at end of file
@@ -0,0 +1,283 @@
+/**
+ * @file
+ * Software timers service methods implementation
+ * 
+ * @author Alexey Zhelonkin
+ * @date 2023
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_TIMER_WHEEL_IMPL_COMMON_H
+#define ZHELE_TIMER_WHEEL_IMPL_COMMON_H
+
+namespace Zhele::Timers
+{
+    #define TIMERWHEEL_TEMPLATE_ARGS template<typename _Timer, unsigned _ChannelNumber, unsigned _Levels>
+    #define TIMERWHEEL_TEMPLATE_QUALIFIER TimerWheel<_Timer, _ChannelNumber, _Levels>
+
+    TIMERWHEEL_TEMPLATE_ARGS
+    SoftTimer* TIMERWHEEL_TEMPLATE_QUALIFIER::_slots[_Levels][SlotsCount];
+
+    TIMERWHEEL_TEMPLATE_ARGS
+    uint32_t TIMERWHEEL_TEMPLATE_QUALIFIER::_occupied[_Levels];
+
+    TIMERWHEEL_TEMPLATE_ARGS
+    uint32_t TIMERWHEEL_TEMPLATE_QUALIFIER::_now = 0;
+
+    TIMERWHEEL_TEMPLATE_ARGS
+    uint32_t TIMERWHEEL_TEMPLATE_QUALIFIER::_time = 0;
+
+    TIMERWHEEL_TEMPLATE_ARGS
+    uint16_t TIMERWHEEL_TEMPLATE_QUALIFIER::_lastCounter = 0;
+
+    TIMERWHEEL_TEMPLATE_ARGS
+    void TIMERWHEEL_TEMPLATE_QUALIFIER::Init(unsigned tickFreq)
+    {
+        _Timer::Enable();
+        _Timer::SetPrescaler(_Timer::GetClockFreq() / tickFreq - 1);
+        _Timer::SetPeriod(0xffff);
+        _Timer::ResetCounterValue();
+
+        _now = 0;
+        _time = 0;
+        _lastCounter = 0;
+
+        Channel::SetPulse(MaxCompareDelta);
+        Channel::ClearInterruptFlag();
+        Channel::EnableInterrupt();
+
+        _Timer::Start();
+    }
+
+    TIMERWHEEL_TEMPLATE_ARGS
+    void TIMERWHEEL_TEMPLATE_QUALIFIER::Start(SoftTimer& timer, uint32_t delay, SoftTimerCallback callback, uint32_t period)
+    {
+        uint32_t state = DriverCriticalSection::Enter();
+
+        if(timer.IsActive())
+            Unlink(&timer);
+
+        UpdateTime();
+        timer._expires = _time + (delay > 0 ? delay : 1);
+        timer._period = period;
+        timer._callback = callback;
+        Link(&timer);
+        Reschedule();
+
+        DriverCriticalSection::Leave(state);
+    }
+
+    TIMERWHEEL_TEMPLATE_ARGS
+    void TIMERWHEEL_TEMPLATE_QUALIFIER::Stop(SoftTimer& timer)
+    {
+        uint32_t state = DriverCriticalSection::Enter();
+
+        if(timer.IsActive())
+            Unlink(&timer);
+
+        DriverCriticalSection::Leave(state);
+    }
+
+    TIMERWHEEL_TEMPLATE_ARGS
+    uint32_t TIMERWHEEL_TEMPLATE_QUALIFIER::Now()
+    {
+        uint32_t state = DriverCriticalSection::Enter();
+
+        UpdateTime();
+        uint32_t time = _time;
+
+        DriverCriticalSection::Leave(state);
+        return time;
+    }
+
+    TIMERWHEEL_TEMPLATE_ARGS
+    void TIMERWHEEL_TEMPLATE_QUALIFIER::IrqHandler()
+    {
+        if(!Channel::IsInterrupt())
+            return;
+
+        Channel::ClearInterruptFlag();
+        Process();
+    }
+
+    TIMERWHEEL_TEMPLATE_ARGS
+    void TIMERWHEEL_TEMPLATE_QUALIFIER::UpdateTime()
+    {
+        uint16_t counter = _Timer::GetCounterValue();
+        _time += static_cast<uint16_t>(counter - _lastCounter);
+        _lastCounter = counter;
+    }
+
+    TIMERWHEEL_TEMPLATE_ARGS
+    void TIMERWHEEL_TEMPLATE_QUALIFIER::Link(SoftTimer* timer)
+    {
+        uint32_t delta = timer->_expires - _now;
+        if(static_cast<int32_t>(delta) < 0)
+            delta = 0;
+        else if(delta > MaxDelta)
+            delta = MaxDelta;
+
+        // Level is selected by delta, slot - by (clamped) expiration time bits of this level
+        unsigned level = 0;
+        while(level < _Levels - 1 && (delta >> (SlotBits * (level + 1))) != 0)
+            ++level;
+        unsigned slot = ((_now + delta) >> (SlotBits * level)) & (SlotsCount - 1);
+
+        SoftTimer** head = &_slots[level][slot];
+        timer->_next = *head;
+        if(*head != nullptr)
+            (*head)->_pprev = &timer->_next;
+        *head = timer;
+        timer->_pprev = head;
+        timer->_bucket = level * SlotsCount + slot;
+
+        _occupied[level] |= (1u << slot);
+    }
+
+    TIMERWHEEL_TEMPLATE_ARGS
+    void TIMERWHEEL_TEMPLATE_QUALIFIER::Unlink(SoftTimer* timer)
+    {
+        *timer->_pprev = timer->_next;
+        if(timer->_next != nullptr)
+            timer->_next->_pprev = timer->_pprev;
+
+        unsigned level = timer->_bucket / SlotsCount;
+        unsigned slot = timer->_bucket % SlotsCount;
+        if(_slots[level][slot] == nullptr)
+            _occupied[level] &= ~(1u << slot);
+
+        timer->_next = nullptr;
+        timer->_pprev = nullptr;
+    }
+
+    TIMERWHEEL_TEMPLATE_ARGS
+    bool TIMERWHEEL_TEMPLATE_QUALIFIER::NextEvent(uint32_t& time)
+    {
+        bool found = false;
+        for(unsigned level = 0; level < _Levels; ++level)
+        {
+            if(_occupied[level] == 0)
+                continue;
+
+            // Search occupied slot after current (current slot of level > 0 means full turn)
+            unsigned shift = SlotBits * level;
+            uint32_t current = (_now >> shift) + 1;
+            unsigned rotation = current & (SlotsCount - 1);
+            uint32_t rotated = rotation == 0
+                ? _occupied[level]
+                : (_occupied[level] >> rotation) | (_occupied[level] << (SlotsCount - rotation));
+            uint32_t event = (current + __builtin_ctz(rotated)) << shift;
+
+            if(!found || static_cast<int32_t>(event - time) < 0)
+                time = event;
+            found = true;
+        }
+        return found;
+    }
+
+    TIMERWHEEL_TEMPLATE_ARGS
+    void TIMERWHEEL_TEMPLATE_QUALIFIER::Cascade(unsigned level)
+    {
+        unsigned slot = (_now >> (SlotBits * level)) & (SlotsCount - 1);
+        SoftTimer* timer = _slots[level][slot];
+        _slots[level][slot] = nullptr;
+        _occupied[level] &= ~(1u << slot);
+
+        while(timer != nullptr)
+        {
+            SoftTimer* next = timer->_next;
+            Link(timer);
+            timer = next;
+        }
+    }
+
+    TIMERWHEEL_TEMPLATE_ARGS
+    SoftTimer* TIMERWHEEL_TEMPLATE_QUALIFIER::PopExpired()
+    {
+        SoftTimer*& head = _slots[0][_now & (SlotsCount - 1)];
+        while(head != nullptr)
+        {
+            SoftTimer* timer = head;
+            Unlink(timer);
+
+            // Long delay clamped by wheel range
+            if(static_cast<int32_t>(timer->_expires - _now) > 0)
+            {
+                Link(timer);
+                continue;
+            }
+
+            if(timer->_period != 0)
+            {
+                timer->_expires += timer->_period;
+                Link(timer);
+            }
+            return timer;
+        }
+        return nullptr;
+    }
+
+    TIMERWHEEL_TEMPLATE_ARGS
+    void TIMERWHEEL_TEMPLATE_QUALIFIER::Reschedule()
+    {
+        uint32_t next;
+        uint32_t delta = MaxCompareDelta;
+        if(NextEvent(next))
+        {
+            int32_t remaining = static_cast<int32_t>(next - _time);
+            if(remaining < static_cast<int32_t>(delta))
+                delta = remaining > 1 ? remaining : 1;
+        }
+
+        // Compare point can be missed if counter has passed it before write
+        for(;;)
+        {
+            uint16_t compare = _lastCounter + delta;
+            Channel::SetPulse(compare);
+            uint16_t counter = _Timer::GetCounterValue();
+            if(Channel::IsInterrupt() || static_cast<int16_t>(compare - counter) > 0)
+                break;
+            UpdateTime();
+            delta = 1;
+        }
+    }
+
+    TIMERWHEEL_TEMPLATE_ARGS
+    void TIMERWHEEL_TEMPLATE_QUALIFIER::Process()
+    {
+        uint32_t state = DriverCriticalSection::Enter();
+        UpdateTime();
+
+        for(;;)
+        {
+            uint32_t next;
+            if(!NextEvent(next) || static_cast<int32_t>(next - _time) > 0)
+            {
+                // Nothing is expired up to current time, so wheel time can be moved forward safely
+                _now = _time;
+                break;
+            }
+
+            _now = next;
+            for(unsigned level = _Levels - 1; level > 0; --level)
+            {
+                if((_now & ((1ul << (SlotBits * level)) - 1)) == 0)
+                    Cascade(level);
+            }
+
+            while(SoftTimer* timer = PopExpired())
+            {
+                SoftTimerCallback callback = timer->_callback;
+                DriverCriticalSection::Leave(state);
+                callback();
+                DriverCriticalSection::Enter();
+            }
+            UpdateTime();
+        }
+
+        Reschedule();
+        DriverCriticalSection::Leave(state);
+    }
+}
+
+#endif //! ZHELE_TIMER_WHEEL_IMPL_COMMON_H
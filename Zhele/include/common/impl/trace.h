@@ -0,0 +1,124 @@
+/**
+ * @file
+ * Implements lightweight event tracing
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_TRACE_IMPL_COMMON_H
+#define ZHELE_TRACE_IMPL_COMMON_H
+
+namespace Zhele::Trace
+{
+    template<unsigned _Size>
+    Record TraceBuffer<_Size>::_records[_Size];
+    template<unsigned _Size>
+    std::atomic<uint32_t> TraceBuffer<_Size>::_head = 0;
+    template<unsigned _Size>
+    std::atomic<uint32_t> TraceBuffer<_Size>::_tail = 0;
+    template<unsigned _Size>
+    std::atomic<uint32_t> TraceBuffer<_Size>::_dropped = 0;
+
+    template<unsigned _Size>
+    void TraceBuffer<_Size>::Enable()
+    {
+#if defined (DWT)
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+    }
+
+    template<unsigned _Size>
+    void TraceBuffer<_Size>::Write(uint32_t id, uint32_t payload)
+    {
+#if (__CORTEX_M >= 3)
+        uint32_t index = _head.fetch_add(1, std::memory_order_relaxed);
+#else
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        uint32_t index = _head.load(std::memory_order_relaxed);
+        _head.store(index + 1, std::memory_order_relaxed);
+        __set_PRIMASK(primask);
+#endif
+        Record& record = _records[index & (_Size - 1)];
+#if defined (DWT)
+        record.Timestamp = DWT->CYCCNT;
+#else
+        record.Timestamp = 0;
+#endif
+        record.Id = id;
+        record.Payload = payload;
+    }
+
+    template<unsigned _Size>
+    unsigned TraceBuffer<_Size>::Read(Record* records, unsigned count)
+    {
+        uint32_t head = _head.load(std::memory_order_acquire);
+        uint32_t tail = _tail.load(std::memory_order_relaxed);
+
+        if(head - tail > _Size)
+        {
+            _dropped.fetch_add(head - tail - _Size, std::memory_order_relaxed);
+            tail = head - _Size;
+        }
+
+        unsigned available = head - tail;
+        if(count > available)
+            count = available;
+
+        for(unsigned i = 0; i < count; ++i)
+            records[i] = _records[(tail + i) & (_Size - 1)];
+
+        _tail.store(tail + count, std::memory_order_release);
+        return count;
+    }
+
+    template<unsigned _Size>
+    uint32_t TraceBuffer<_Size>::Dropped()
+    {
+        return _dropped.load(std::memory_order_relaxed);
+    }
+
+    template<unsigned _Size>
+    void TraceBuffer<_Size>::DrainItm()
+    {
+#if defined (ITM)
+        if((ITM->TCR & ITM_TCR_ITMENA_Msk) == 0 || (ITM->TER & (1UL << ZHELE_TRACE_ITM_PORT)) == 0)
+            return;
+
+        Record record;
+        while(Read(&record, 1) != 0)
+        {
+            for(uint32_t word : {record.Timestamp, record.Id, record.Payload})
+            {
+                while(ITM->PORT[ZHELE_TRACE_ITM_PORT].u32 == 0)
+                    continue;
+                ITM->PORT[ZHELE_TRACE_ITM_PORT].u32 = word;
+            }
+        }
+#endif
+    }
+
+    template<unsigned _Size>
+    template<typename _Usart>
+    bool TraceBuffer<_Size>::DrainUsart()
+    {
+        static Record buffer[ZHELE_TRACE_DRAIN_RECORDS];
+        static std::atomic<bool> busy = false;
+
+        if(busy.load(std::memory_order_acquire))
+            return false;
+
+        unsigned count = Read(buffer, ZHELE_TRACE_DRAIN_RECORDS);
+        if(count == 0)
+            return false;
+
+        busy.store(true, std::memory_order_relaxed);
+        _Usart::WriteAsync(buffer, count * sizeof(Record), [](void*, unsigned, bool) { busy.store(false, std::memory_order_release); });
+        return true;
+    }
+}
+
+#endif //! ZHELE_TRACE_IMPL_COMMON_H
@@ -55,6 +55,40 @@ namespace Zhele
         return cr1 | cr3;
     }
 
+    constexpr UsartBase::BaudConfig UsartBase::CalculateBaud(uint32_t clock, uint32_t baud)
+    {
+        BaudConfig best {0, false, UINT16_MAX};
+        if(baud == 0)
+            return best;
+
+    #if defined (USART_CR1_OVER8)
+        const unsigned oversamplingModes = 2;
+    #else
+        const unsigned oversamplingModes = 1;
+    #endif
+
+        for(unsigned over8 = 0; over8 < oversamplingModes; ++over8)
+        {
+            // USARTDIV in 1/16 (OVER16) or 1/8 (OVER8) of bit, rounded to nearest
+            uint64_t divider = ((static_cast<uint64_t>(clock) << over8) + baud / 2) / baud;
+            if(divider < 16 || divider > UINT16_MAX)
+                continue;
+
+            uint64_t actual = (static_cast<uint64_t>(clock) << over8) / divider;
+            uint64_t difference = actual > baud ? actual - baud : baud - actual;
+            uint16_t error = static_cast<uint16_t>(difference * 10000 / baud);
+            if(best.Brr == 0 || error < best.Error)
+            {
+                // OVER8: fraction is 3 bits, BRR[3] must be kept cleared
+                uint16_t brr = over8
+                    ? static_cast<uint16_t>((divider & ~0xfull) | ((divider & 0x0full) >> 1))
+                    : static_cast<uint16_t>(divider);
+                best = BaudConfig{brr, over8 != 0, error};
+            }
+        }
+        return best;
+    }
+
     namespace Private
     {
         #define USART_TEMPLATE_ARGS template<typename _Regs, IRQn_Type _IRQNumber, typename _ClockCtrl, typename _TxPins, typename _RxPins, typename _DmaTx, typename _DmaRx>
@@ -67,10 +101,32 @@ namespace Zhele
             Init(baud, mode);
         }
 
+        USART_TEMPLATE_ARGS
+        template<unsigned long baud, typename _ClockTree>
+        void USART_TEMPLATE_QUALIFIER::Init(UsartMode mode)
+        {
+            constexpr BaudConfig config = CalculateBaud(_ClockTree::template BusClockFreq<_ClockCtrl>, baud);
+            static_assert(config.Brr != 0, "Baud rate is out of range for USART clock");
+            static_assert(config.Brr == 0 || config.Error <= 200, "Baud rate error is more than 2%");
+
+            _ClockCtrl::Enable();
+            _Regs()->BRR = config.Brr;
+            _Regs()->STATUS_REG = 0x00;
+            _Regs()->CR3 = mode.CR3;
+            _Regs()->CR2 = mode.CR2;
+        #if defined (USART_CR1_OVER8)
+            _Regs()->CR1 = (mode.CR1 & ~USART_CR1_OVER8) | (config.Over8 ? USART_CR1_OVER8 : 0) | USART_CR1_UE;
+        #else
+            _Regs()->CR1 = mode.CR1 | USART_CR1_UE;
+        #endif
+        }
+
         USART_TEMPLATE_ARGS
         void USART_TEMPLATE_QUALIFIER::Init(unsigned baud, UsartMode mode)
         {
             _ClockCtrl::Enable();
+            // Oversampling mode should be set before baud rate calculation
+            _Regs()->CR1 = mode.CR1;
             SetBaud(baud);
             _Regs()->STATUS_REG = 0x00;
             _Regs()->CR3 = mode.CR3;
@@ -97,9 +153,85 @@ namespace Zhele
         USART_TEMPLATE_ARGS
         void USART_TEMPLATE_QUALIFIER::SetBaud(unsigned baud)
         {
-            _Regs()->BRR = _ClockCtrl::ClockFreq() / baud;
+            uint32_t brr = _ClockCtrl::ClockFreq() / baud;
+        #if defined (USART_CR1_OVER8)
+            if(_Regs()->CR1 & USART_CR1_OVER8)
+            {
+                // OVER8: fraction is 3 bits, BRR[3] must be kept cleared
+                uint32_t divider = 2 * _ClockCtrl::ClockFreq() / baud;
+                brr = (divider & ~0x0fu) | ((divider & 0x0fu) >> 1);
+            }
+        #endif
+        #if defined (USART_ISR_PE)
+            // BRR of USART with ISR register is written only while USART is disabled (baud change at runtime)
+            uint32_t cr1 = _Regs()->CR1;
+            if(cr1 & USART_CR1_UE)
+            {
+                _Regs()->CR1 = cr1 & ~USART_CR1_UE;
+                _Regs()->BRR = brr;
+                _Regs()->CR1 = cr1;
+                return;
+            }
+        #endif
+            _Regs()->BRR = brr;
+        }
+
+        USART_TEMPLATE_ARGS
+        unsigned USART_TEMPLATE_QUALIFIER::GetBaud()
+        {
+            uint32_t brr = _Regs()->BRR;
+        #if defined (USART_CR1_OVER8)
+            if(_Regs()->CR1 & USART_CR1_OVER8)
+            {
+                uint32_t divider = (brr & ~0x0fu) | ((brr & 0x07u) << 1);
+                return divider != 0 ? 2 * _ClockCtrl::ClockFreq() / divider : 0;
+            }
+        #endif
+            return brr != 0 ? _ClockCtrl::ClockFreq() / brr : 0;
         }
 
+    #if defined (USART_CR2_ABREN)
+        USART_TEMPLATE_ARGS
+        void USART_TEMPLATE_QUALIFIER::EnableAutoBaud(AutoBaudMode mode, AutoBaudCallback callback)
+        {
+            _autoBaudCallback = callback;
+
+            // ABREN and ABRMODE can be written only when USART is disabled
+            uint32_t cr1 = _Regs()->CR1;
+            _Regs()->CR1 = cr1 & ~USART_CR1_UE;
+        #if defined (USART_CR2_ABRMODE)
+            _Regs()->CR2 = (_Regs()->CR2 & ~USART_CR2_ABRMODE) | USART_CR2_ABREN | static_cast<uint32_t>(mode);
+        #else
+            _Regs()->CR2 |= USART_CR2_ABREN;
+        #endif
+            _Regs()->CR1 = cr1;
+            _Regs()->RQR = USART_RQR_ABRRQ;
+
+            if(callback)
+            {
+                // Sync character sets RXNE, detection result is checked in IrqHandler
+                BitBand::SetBits(_Regs()->CR1, USART_CR1_RXNEIE);
+                Nvic::EnableIrq<_IRQNumber>();
+            }
+        }
+
+        USART_TEMPLATE_ARGS
+        void USART_TEMPLATE_QUALIFIER::DisableAutoBaud()
+        {
+            _autoBaudCallback = nullptr;
+            uint32_t cr1 = _Regs()->CR1;
+            _Regs()->CR1 = cr1 & ~USART_CR1_UE;
+            _Regs()->CR2 &= ~USART_CR2_ABREN;
+            _Regs()->CR1 = cr1;
+        }
+
+        USART_TEMPLATE_ARGS
+        bool USART_TEMPLATE_QUALIFIER::AutoBaudLocked()
+        {
+            return (_Regs()->ISR & (USART_ISR_ABRF | USART_ISR_ABRE)) == USART_ISR_ABRF;
+        }
+    #endif
+
         USART_TEMPLATE_ARGS
         bool USART_TEMPLATE_QUALIFIER::ReadReady()
         {
@@ -118,11 +250,177 @@ namespace Zhele
         void USART_TEMPLATE_QUALIFIER::EnableAsyncRead(void* receiveBuffer, size_t bufferSize, TransferCallback callback)
         {
             _DmaRx::ClearTransferComplete();
-            _Regs()->CR3 |= USART_CR3_DMAR;
+            BitBand::SetBits(_Regs()->CR3, USART_CR3_DMAR);
             _DmaRx::SetTransferCallback(callback);
             _DmaRx::Transfer(_DmaRx::Periph2Mem | _DmaRx::MemIncrement | _DmaRx::Circular, receiveBuffer, &_Regs()->RECEIVE_DATA_REG, bufferSize);
         }
 
+        USART_TEMPLATE_ARGS
+        void USART_TEMPLATE_QUALIFIER::EnableStreamRead(void* receiveBuffer, size_t bufferSize, TransferCallback callback)
+        {
+            _stream.buffer = static_cast<uint8_t*>(receiveBuffer);
+            _stream.size = bufferSize;
+            _stream.readIndex = 0;
+            _stream.notifyIndex = 0;
+            _stream.callback = callback;
+
+            _DmaRx::ClearTransferComplete();
+            BitBand::SetBits(_Regs()->CR3, USART_CR3_DMAR);
+            _DmaRx::SetTransferCallback([](void* data, unsigned size, bool success){
+                NotifyStreamData();
+            });
+            _DmaRx::Transfer(_DmaRx::Periph2Mem | _DmaRx::MemIncrement | _DmaRx::Circular, receiveBuffer, &_Regs()->RECEIVE_DATA_REG, bufferSize);
+
+            ClearIdleFlag();
+            EnableInterrupt(IdleInt);
+        }
+
+        USART_TEMPLATE_ARGS
+        void USART_TEMPLATE_QUALIFIER::DisableStreamRead()
+        {
+            DisableInterrupt(IdleInt);
+            _DmaRx::Disable();
+            _DmaRx::SetTransferCallback(nullptr);
+            BitBand::ClearBits(_Regs()->CR3, USART_CR3_DMAR);
+            _stream.callback = nullptr;
+        }
+
+        USART_TEMPLATE_ARGS
+        size_t USART_TEMPLATE_QUALIFIER::StreamAvailable()
+        {
+            size_t writeIndex = StreamWriteIndex();
+            size_t readIndex = _stream.readIndex;
+            return writeIndex >= readIndex
+                ? writeIndex - readIndex
+                : _stream.size - readIndex + writeIndex;
+        }
+
+        USART_TEMPLATE_ARGS
+        size_t USART_TEMPLATE_QUALIFIER::StreamPeek(const uint8_t*& data)
+        {
+            size_t writeIndex = StreamWriteIndex();
+            size_t readIndex = _stream.readIndex;
+            data = _stream.buffer + readIndex;
+            return writeIndex >= readIndex
+                ? writeIndex - readIndex
+                : _stream.size - readIndex;
+        }
+
+        USART_TEMPLATE_ARGS
+        void USART_TEMPLATE_QUALIFIER::StreamConsume(size_t size)
+        {
+            size_t readIndex = _stream.readIndex + size;
+            _stream.readIndex = readIndex >= _stream.size
+                ? readIndex - _stream.size
+                : readIndex;
+        }
+
+        USART_TEMPLATE_ARGS
+        size_t USART_TEMPLATE_QUALIFIER::StreamRead(void* data, size_t size)
+        {
+            uint8_t* out = static_cast<uint8_t*>(data);
+            size_t readed = 0;
+            const uint8_t* block;
+            size_t blockSize;
+            while(readed < size && (blockSize = StreamPeek(block)) > 0)
+            {
+                if(blockSize > size - readed)
+                    blockSize = size - readed;
+                for(size_t i = 0; i < blockSize; ++i)
+                    out[readed + i] = block[i];
+                readed += blockSize;
+                StreamConsume(blockSize);
+            }
+            return readed;
+        }
+
+        USART_TEMPLATE_ARGS
+        void USART_TEMPLATE_QUALIFIER::IrqHandler()
+        {
+        #if defined (ZHELE_STATISTICS)
+            // Idle flag clearing clears error flags too
+            CountErrors(_Regs()->STATUS_REG);
+        #endif
+            if((_Regs()->STATUS_REG & IdleInt) && (_Regs()->CR1 & USART_CR1_IDLEIE))
+            {
+                ClearIdleFlag();
+                NotifyStreamData();
+            }
+        #if defined (USART_CR2_ABREN)
+            if(_autoBaudCallback && (_Regs()->ISR & USART_ISR_ABRF))
+            {
+                if(_Regs()->ISR & USART_ISR_ABRE)
+                {
+                    // Measurement failed (noise or wrong sync character): drop character and restart on next one
+                    _Regs()->RQR = USART_RQR_ABRRQ | USART_RQR_RXFRQ;
+                }
+                else
+                {
+                    AutoBaudCallback callback = _autoBaudCallback;
+                    _autoBaudCallback = nullptr;
+                    BitBand::ClearBits(_Regs()->CR1, USART_CR1_RXNEIE);
+                    callback(GetBaud());
+                }
+            }
+        #endif
+        #if defined (USART_CR3_WUS)
+            if((_Regs()->ISR & USART_ISR_WUF) && (_Regs()->CR3 & USART_CR3_WUFIE))
+                _Regs()->ICR = USART_ICR_WUCF;
+        #endif
+        #if defined (USART_CR2_RTOEN)
+            if(_frame.enabled && (_Regs()->ISR & USART_ISR_RTOF))
+            {
+                _Regs()->ICR = USART_ICR_RTOCF | ErrorInt | ParityErrorInt;
+                QueueFrame();
+            }
+        #endif
+        }
+
+        USART_TEMPLATE_ARGS
+        size_t USART_TEMPLATE_QUALIFIER::StreamWriteIndex()
+        {
+            size_t writeIndex = _stream.size - _DmaRx::RemainingTransfers();
+            // NDTR is reloaded to buffer size after wrap
+            return writeIndex >= _stream.size ? 0 : writeIndex;
+        }
+
+        USART_TEMPLATE_ARGS
+        void USART_TEMPLATE_QUALIFIER::NotifyStreamData()
+        {
+            size_t writeIndex = StreamWriteIndex();
+            size_t notifyIndex = _stream.notifyIndex;
+            if(writeIndex == notifyIndex)
+                return;
+            _stream.notifyIndex = writeIndex;
+
+            if(!_stream.callback)
+                return;
+
+            if(writeIndex > notifyIndex)
+            {
+                _stream.callback(_stream.buffer + notifyIndex, writeIndex - notifyIndex, true);
+            }
+            else
+            {
+                _stream.callback(_stream.buffer + notifyIndex, _stream.size - notifyIndex, true);
+                if(writeIndex > 0)
+                    _stream.callback(_stream.buffer, writeIndex, true);
+            }
+        }
+
+        USART_TEMPLATE_ARGS
+        void USART_TEMPLATE_QUALIFIER::ClearIdleFlag()
+        {
+        #if defined(USART_TYPE_1)
+            _Regs()->ICR = IdleInt | ErrorInt | ParityErrorInt;
+        #endif
+        #if defined(USART_TYPE_2)
+            // IDLE and error flags are cleared by SR read followed by DR read
+            static_cast<void>(_Regs()->SR);
+            static_cast<void>(_Regs()->DR);
+        #endif
+        }
+
         USART_TEMPLATE_ARGS
         bool USART_TEMPLATE_QUALIFIER::WriteReady()
         {
@@ -158,16 +456,95 @@ namespace Zhele
             while (!WriteReady()) ;
             _DmaTx::ClearTransferComplete();
             _DmaTx::SetTransferCallback(callback);
-            _Regs()->CR3 |= USART_CR3_DMAT;
+            BitBand::SetBits(_Regs()->CR3, USART_CR3_DMAT);
         #if defined (USART_TYPE_1)
-            _Regs()->ICR |= TxCompleteInt;
+            _Regs()->ICR = TxCompleteInt;
         #endif
         #if defined (USART_TYPE_2)
-            _Regs()->SR &= ~TxCompleteInt;
+            _Regs()->SR = ~static_cast<uint32_t>(TxCompleteInt);
         #endif
             _DmaTx::Transfer(_DmaTx::Mem2Periph | _DmaTx::MemIncrement, data, &_Regs()->TRANSMIT_DATA_REG, size);
         }
 
+        USART_TEMPLATE_ARGS
+        bool USART_TEMPLATE_QUALIFIER::QueueWrite(const void* data, size_t size)
+        {
+            TxDescriptor descriptor {data, static_cast<uint16_t>(size)};
+            return QueueWrite(&descriptor, 1) == 1;
+        }
+
+        USART_TEMPLATE_ARGS
+        size_t USART_TEMPLATE_QUALIFIER::QueueWrite(const TxDescriptor* descriptors, size_t count)
+        {
+            size_t queued = 0;
+
+            uint32_t state = DriverCriticalSection::Enter();
+            for(; queued < count; ++queued)
+            {
+                if(descriptors[queued].size == 0)
+                    continue;
+                if(!_txQueue.push_back(descriptors[queued]))
+                    break;
+            }
+            if(!_txQueueActive && !_txQueue.empty())
+            {
+                _txQueueActive = true;
+                StartQueuedWrite();
+            }
+            DriverCriticalSection::Leave(state);
+
+            return queued;
+        }
+
+        USART_TEMPLATE_ARGS
+        void USART_TEMPLATE_QUALIFIER::SetWriteQueueCallback(TransferCallback callback)
+        {
+            _txQueueCallback = callback;
+        }
+
+        USART_TEMPLATE_ARGS
+        size_t USART_TEMPLATE_QUALIFIER::WriteQueueFree()
+        {
+            return _txQueue.capacity() - _txQueue.size();
+        }
+
+        USART_TEMPLATE_ARGS
+        bool USART_TEMPLATE_QUALIFIER::WriteQueueEmpty()
+        {
+            return !_txQueueActive;
+        }
+
+        USART_TEMPLATE_ARGS
+        void USART_TEMPLATE_QUALIFIER::StartQueuedWrite()
+        {
+            const TxDescriptor& descriptor = _txQueue.front();
+
+            _DmaTx::ClearTransferComplete();
+            _DmaTx::SetTransferCallback(QueuedWriteComplete);
+            BitBand::SetBits(_Regs()->CR3, USART_CR3_DMAT);
+        #if defined (USART_TYPE_1)
+            _Regs()->ICR = TxCompleteInt;
+        #endif
+        #if defined (USART_TYPE_2)
+            _Regs()->SR = ~static_cast<uint32_t>(TxCompleteInt);
+        #endif
+            _DmaTx::Transfer(_DmaTx::Mem2Periph | _DmaTx::MemIncrement, descriptor.data, &_Regs()->TRANSMIT_DATA_REG, descriptor.size);
+        }
+
+        USART_TEMPLATE_ARGS
+        void USART_TEMPLATE_QUALIFIER::QueuedWriteComplete(void* data, unsigned size, bool success)
+        {
+            _txQueue.pop_front();
+
+            if(!_txQueue.empty())
+                StartQueuedWrite();
+            else
+                _txQueueActive = false;
+
+            if(_txQueueCallback)
+                _txQueueCallback(data, size, success);
+        }
+
         USART_TEMPLATE_ARGS
         void USART_TEMPLATE_QUALIFIER::Write(uint8_t data)
         {
@@ -206,12 +583,258 @@ namespace Zhele
             if(interruptFlags & CtsInt)
                 cr3Mask |= USART_CR3_CTSIE;
 
-            _Regs()->CR1 |= cr1Mask;
-            _Regs()->CR2 |= cr2Mask;
-            _Regs()->CR3 |= cr3Mask;
+        #if defined (USART_CR3_TXFTIE)
+            if(interruptFlags & TxFifoThresholdInt)
+                cr3Mask |= USART_CR3_TXFTIE;
+            if(interruptFlags & RxFifoThresholdInt)
+                cr3Mask |= USART_CR3_RXFTIE;
+        #endif
+
+            BitBand::SetBits(_Regs()->CR1, cr1Mask);
+            BitBand::SetBits(_Regs()->CR2, cr2Mask);
+            BitBand::SetBits(_Regs()->CR3, cr3Mask);
 
             if(interruptFlags != NoInterrupt)
-                NVIC_EnableIRQ(_IRQNumber);
+                Nvic::EnableIrq<_IRQNumber>();
+        }
+
+        USART_TEMPLATE_ARGS
+        void USART_TEMPLATE_QUALIFIER::DisableDma()
+        {
+            _Regs()->CR3 &= ~(USART_CR3_DMAT | USART_CR3_DMAR);
+        }
+
+    #if defined (USART_CR3_DEM)
+        USART_TEMPLATE_ARGS
+        void USART_TEMPLATE_QUALIFIER::EnableDriverEnable(uint8_t assertionTime, uint8_t deassertionTime, bool activeLow)
+        {
+            // DEM, DEP, DEAT and DEDT can be written only when USART is disabled
+            uint32_t cr1 = _Regs()->CR1;
+            _Regs()->CR1 = cr1 & ~USART_CR1_UE;
+            _Regs()->CR3 = (_Regs()->CR3 & ~USART_CR3_DEP) | USART_CR3_DEM | (activeLow ? USART_CR3_DEP : 0);
+            cr1 = (cr1 & ~(USART_CR1_DEAT | USART_CR1_DEDT))
+                | ((static_cast<uint32_t>(assertionTime) << USART_CR1_DEAT_Pos) & USART_CR1_DEAT)
+                | ((static_cast<uint32_t>(deassertionTime) << USART_CR1_DEDT_Pos) & USART_CR1_DEDT);
+            _Regs()->CR1 = cr1 & ~USART_CR1_UE;
+            _Regs()->CR1 = cr1;
+        }
+
+        USART_TEMPLATE_ARGS
+        void USART_TEMPLATE_QUALIFIER::DisableDriverEnable()
+        {
+            uint32_t cr1 = _Regs()->CR1;
+            _Regs()->CR1 = cr1 & ~USART_CR1_UE;
+            _Regs()->CR3 &= ~(USART_CR3_DEM | USART_CR3_DEP);
+            _Regs()->CR1 = cr1;
+        }
+    #endif
+
+        USART_TEMPLATE_ARGS
+        void USART_TEMPLATE_QUALIFIER::EnterMuteMode()
+        {
+        #if defined (USART_RQR_MMRQ)
+            _Regs()->RQR = USART_RQR_MMRQ;
+        #else
+            BitBand::SetBits(_Regs()->CR1, USART_CR1_RWU);
+        #endif
+        }
+
+        USART_TEMPLATE_ARGS
+        bool USART_TEMPLATE_QUALIFIER::IsMuted()
+        {
+        #if defined (USART_ISR_RWU)
+            return _Regs()->ISR & USART_ISR_RWU;
+        #else
+            return _Regs()->CR1 & USART_CR1_RWU;
+        #endif
+        }
+
+        USART_TEMPLATE_ARGS
+        void USART_TEMPLATE_QUALIFIER::WriteAddress(uint8_t address)
+        {
+        #if defined (USART_CR1_M0)
+            bool nineBits = _Regs()->CR1 & USART_CR1_M0;
+        #else
+            bool nineBits = _Regs()->CR1 & USART_CR1_M;
+        #endif
+            while (!WriteReady()) continue;
+
+            _Regs()->TRANSMIT_DATA_REG = nineBits ? (0x100u | address) : (0x80u | address);
+        }
+
+    #if defined (USART_CR3_WUS)
+        USART_TEMPLATE_ARGS
+        void USART_TEMPLATE_QUALIFIER::EnableWakeupFromStop(WakeupSource source)
+        {
+            // WUS can be written only when USART is disabled
+            uint32_t cr1 = _Regs()->CR1;
+            _Regs()->CR1 = cr1 & ~USART_CR1_UE;
+            _Regs()->CR3 = (_Regs()->CR3 & ~USART_CR3_WUS) | static_cast<uint32_t>(source) | USART_CR3_WUFIE
+            #if defined (USART_CR3_UCESM)
+                | USART_CR3_UCESM
+            #endif
+                ;
+            _Regs()->ICR = USART_ICR_WUCF;
+            _Regs()->CR1 = cr1 | USART_CR1_UESM;
+            Nvic::EnableIrq<_IRQNumber>();
+        }
+
+        USART_TEMPLATE_ARGS
+        void USART_TEMPLATE_QUALIFIER::DisableWakeupFromStop()
+        {
+            _Regs()->CR1 &= ~USART_CR1_UESM;
+        #if defined (USART_CR3_UCESM)
+            _Regs()->CR3 &= ~(USART_CR3_WUFIE | USART_CR3_UCESM);
+        #else
+            _Regs()->CR3 &= ~USART_CR3_WUFIE;
+        #endif
+        }
+    #endif
+
+    #if defined (USART_CR2_RTOEN)
+        USART_TEMPLATE_ARGS
+        void USART_TEMPLATE_QUALIFIER::EnableReceiverTimeout(uint32_t bits)
+        {
+            _Regs()->RTOR = (_Regs()->RTOR & ~USART_RTOR_RTO) | (bits & USART_RTOR_RTO);
+            _Regs()->ICR = USART_ICR_RTOCF;
+            _Regs()->CR2 |= USART_CR2_RTOEN;
+            BitBand::SetBits(_Regs()->CR1, USART_CR1_RTOIE);
+            Nvic::EnableIrq<_IRQNumber>();
+        }
+
+        USART_TEMPLATE_ARGS
+        void USART_TEMPLATE_QUALIFIER::DisableReceiverTimeout()
+        {
+            BitBand::ClearBits(_Regs()->CR1, USART_CR1_RTOIE);
+            _Regs()->CR2 &= ~USART_CR2_RTOEN;
+        }
+
+        USART_TEMPLATE_ARGS
+        bool USART_TEMPLATE_QUALIFIER::ReceiverTimeout()
+        {
+            if((_Regs()->ISR & USART_ISR_RTOF) == 0)
+                return false;
+            _Regs()->ICR = USART_ICR_RTOCF;
+            return true;
+        }
+
+        USART_TEMPLATE_ARGS
+        void USART_TEMPLATE_QUALIFIER::EnableFrameRead(void* receiveBuffer, size_t bufferSize, uint32_t timeoutBits, TransferCallback callback)
+        {
+            _stream.buffer = static_cast<uint8_t*>(receiveBuffer);
+            _stream.size = bufferSize;
+            _stream.readIndex = 0;
+            _stream.notifyIndex = 0;
+            _stream.callback = nullptr;
+
+            _frame.start = 0;
+            _frame.callback = callback;
+            _frames.clear();
+
+            _DmaRx::ClearTransferComplete();
+            BitBand::SetBits(_Regs()->CR3, USART_CR3_DMAR);
+            _DmaRx::SetTransferCallback(nullptr);
+            _DmaRx::Transfer(_DmaRx::Periph2Mem | _DmaRx::MemIncrement | _DmaRx::Circular, receiveBuffer, &_Regs()->RECEIVE_DATA_REG, bufferSize);
+
+            _frame.enabled = true;
+            EnableReceiverTimeout(timeoutBits);
+        }
+
+        USART_TEMPLATE_ARGS
+        void USART_TEMPLATE_QUALIFIER::DisableFrameRead()
+        {
+            DisableReceiverTimeout();
+            _frame.enabled = false;
+            _DmaRx::Disable();
+            BitBand::ClearBits(_Regs()->CR3, USART_CR3_DMAR);
+            _frame.callback = nullptr;
+        }
+
+        USART_TEMPLATE_ARGS
+        size_t USART_TEMPLATE_QUALIFIER::FramesAvailable()
+        {
+            return _frames.size();
+        }
+
+        USART_TEMPLATE_ARGS
+        bool USART_TEMPLATE_QUALIFIER::FramePeek(RxFrame& frame)
+        {
+            if(_frames.empty())
+                return false;
+
+            const UsartFrameDescriptor& descriptor = _frames.front();
+            frame.data = _stream.buffer + descriptor.offset;
+            if(descriptor.offset + descriptor.size > _stream.size)
+            {
+                frame.size = _stream.size - descriptor.offset;
+                frame.wrappedData = _stream.buffer;
+                frame.wrappedSize = descriptor.size - frame.size;
+            }
+            else
+            {
+                frame.size = descriptor.size;
+                frame.wrappedData = nullptr;
+                frame.wrappedSize = 0;
+            }
+            return true;
+        }
+
+        USART_TEMPLATE_ARGS
+        void USART_TEMPLATE_QUALIFIER::FrameConsume()
+        {
+            if(_frames.empty())
+                return;
+
+            // Dropped frames (if frame queue was full) are skipped too
+            const UsartFrameDescriptor& descriptor = _frames.front();
+            size_t readIndex = descriptor.offset + descriptor.size;
+            _stream.readIndex = readIndex >= _stream.size
+                ? readIndex - _stream.size
+                : readIndex;
+            _frames.pop_front();
+        }
+
+        USART_TEMPLATE_ARGS
+        size_t USART_TEMPLATE_QUALIFIER::FrameRead(void* data, size_t size)
+        {
+            RxFrame frame;
+            if(!FramePeek(frame))
+                return 0;
+
+            uint8_t* out = static_cast<uint8_t*>(data);
+            size_t readed = 0;
+            for(size_t i = 0; i < frame.size && readed < size; ++i)
+                out[readed++] = frame.data[i];
+            for(size_t i = 0; i < frame.wrappedSize && readed < size; ++i)
+                out[readed++] = frame.wrappedData[i];
+
+            FrameConsume();
+            return readed;
+        }
+
+        USART_TEMPLATE_ARGS
+        void USART_TEMPLATE_QUALIFIER::QueueFrame()
+        {
+            size_t end = StreamWriteIndex();
+            size_t start = _frame.start;
+            if(end == start)
+                return;
+            _frame.start = end;
+
+            uint16_t size = end > start
+                ? end - start
+                : _stream.size - start + end;
+            bool queued = _frames.push_back(UsartFrameDescriptor{static_cast<uint16_t>(start), size});
+
+            if(_frame.callback)
+                _frame.callback(_stream.buffer + start, size, queued);
+        }
+    #endif
+
+        USART_TEMPLATE_ARGS
+        bool USART_TEMPLATE_QUALIFIER::TransmitComplete()
+        {
+            return (_Regs()->STATUS_REG & TxCompleteInt) != 0;
         }
 
         USART_TEMPLATE_ARGS
@@ -243,9 +866,16 @@ namespace Zhele
             if(interruptFlags & CtsInt)
                 cr3Mask |= USART_CR3_CTSIE;
 
-            _Regs()->CR1 &= ~cr1Mask;
-            _Regs()->CR2 &= ~cr2Mask;
-            _Regs()->CR3 &= ~cr3Mask;
+        #if defined (USART_CR3_TXFTIE)
+            if(interruptFlags & TxFifoThresholdInt)
+                cr3Mask |= USART_CR3_TXFTIE;
+            if(interruptFlags & RxFifoThresholdInt)
+                cr3Mask |= USART_CR3_RXFTIE;
+        #endif
+
+            BitBand::ClearBits(_Regs()->CR1, cr1Mask);
+            BitBand::ClearBits(_Regs()->CR2, cr2Mask);
+            BitBand::ClearBits(_Regs()->CR3, cr3Mask);
         }
 
         USART_TEMPLATE_ARGS
@@ -257,17 +887,38 @@ namespace Zhele
         USART_TEMPLATE_ARGS
         typename USART_TEMPLATE_QUALIFIER::Error USART_TEMPLATE_QUALIFIER::GetError()
         {
-            return static_cast<Error>(_Regs()->STATUS_REG & ErrorMask);
+            uint32_t errors = _Regs()->STATUS_REG & ErrorMask;
+        #if defined (ZHELE_STATISTICS)
+            CountErrors(errors);
+        #endif
+            return static_cast<Error>(errors);
+        }
+
+    #if defined (ZHELE_STATISTICS)
+        USART_TEMPLATE_ARGS
+        void USART_TEMPLATE_QUALIFIER::CountErrors(uint32_t status)
+        {
+            if(status & OverrunError)
+                Statistics.Increment(UsartCounter::Overrun);
+            if(status & NoiseError)
+                Statistics.Increment(UsartCounter::Noise);
+            if(status & FramingError)
+                Statistics.Increment(UsartCounter::Framing);
+            if(status & ParityError)
+                Statistics.Increment(UsartCounter::Parity);
         }
+    #endif
 
         USART_TEMPLATE_ARGS
         void USART_TEMPLATE_QUALIFIER::ClearInterruptFlag(InterruptFlags interruptFlags)
         {
+            // Flags are cleared by plain store: ICR is write 1 to clear, SR flags are cleared by writing 0
+            // (writing 1 has no effect), so flags set meanwhile are not lost
         #if defined(USART_TYPE_1)
-            _Regs()->ICR |= interruptFlags;
+            _Regs()->ICR = interruptFlags;
         #endif
         #if defined(USART_TYPE_2)
-            _Regs()->SR &= ~interruptFlags;
+            _Regs()->SR = ~static_cast<uint32_t>(interruptFlags);
         #endif
         }
     }
@@ -0,0 +1,112 @@
+/**
+ * @file
+ * USART auto baud rate detection methods implementation
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_USART_AUTOBAUD_IMPL_COMMON_H
+#define ZHELE_USART_AUTOBAUD_IMPL_COMMON_H
+
+namespace Zhele
+{
+    #define USART_AUTOBAUD_TEMPLATE_ARGS template<typename _Usart, typename _Timer, unsigned _Channel, unsigned _Edges>
+    #define USART_AUTOBAUD_TEMPLATE_QUALIFIER UsartAutoBaud<_Usart, _Timer, _Channel, _Edges>
+
+    USART_AUTOBAUD_TEMPLATE_ARGS
+    typename USART_AUTOBAUD_TEMPLATE_QUALIFIER::Callback USART_AUTOBAUD_TEMPLATE_QUALIFIER::_callback = nullptr;
+    USART_AUTOBAUD_TEMPLATE_ARGS
+    uint16_t USART_AUTOBAUD_TEMPLATE_QUALIFIER::_last = 0;
+    USART_AUTOBAUD_TEMPLATE_ARGS
+    uint16_t USART_AUTOBAUD_TEMPLATE_QUALIFIER::_minInterval = 0;
+    USART_AUTOBAUD_TEMPLATE_ARGS
+    volatile uint8_t USART_AUTOBAUD_TEMPLATE_QUALIFIER::_edges = 0;
+
+    USART_AUTOBAUD_TEMPLATE_ARGS
+    template<typename _Pin>
+    void USART_AUTOBAUD_TEMPLATE_QUALIFIER::Start(Callback callback, unsigned minBaud)
+    {
+        _callback = callback;
+        _edges = 0;
+        _minInterval = UINT16_MAX;
+
+        // Two bit durations of min baud rate should fit 16-bit counter
+        uint32_t prescaler = 2 * (_Timer::GetClockFreq() / minBaud) / 65536;
+        _Timer::Enable();
+        _Timer::SetPrescaler(prescaler);
+        _Timer::SetPeriodAndUpdate(UINT16_MAX);
+        _Timer::Start();
+
+        Capture::template SelectPins<_Pin>();
+        Capture::SetCapturePolarity(Capture::CapturePolarity::FallingEdge);
+        Capture::SetCaptureMode(Capture::CaptureMode::Direct);
+        Capture::ClearInterruptFlag();
+        Capture::EnableInterrupt();
+        Capture::Enable();
+    }
+
+    USART_AUTOBAUD_TEMPLATE_ARGS
+    void USART_AUTOBAUD_TEMPLATE_QUALIFIER::Stop()
+    {
+        Capture::DisableInterrupt();
+        Capture::Disable();
+        _edges = _Edges;
+    }
+
+    USART_AUTOBAUD_TEMPLATE_ARGS
+    bool USART_AUTOBAUD_TEMPLATE_QUALIFIER::Busy()
+    {
+        return _edges < _Edges;
+    }
+
+    USART_AUTOBAUD_TEMPLATE_ARGS
+    constexpr unsigned USART_AUTOBAUD_TEMPLATE_QUALIFIER::RoundBaud(unsigned baud)
+    {
+        constexpr unsigned standard[] = {1200, 2400, 4800, 9600, 14400, 19200, 38400, 57600,
+            115200, 230400, 460800, 921600, 1000000, 2000000, 3000000, 4000000};
+        for(unsigned value : standard)
+        {
+            unsigned difference = baud > value ? baud - value : value - baud;
+            if(difference * 100 < value * 3)
+                return value;
+        }
+        return baud;
+    }
+
+    USART_AUTOBAUD_TEMPLATE_ARGS
+    void USART_AUTOBAUD_TEMPLATE_QUALIFIER::IrqHandler()
+    {
+        if(!Capture::IsInterrupt())
+            return;
+
+        uint16_t capture = Capture::GetValue();
+        Capture::ClearInterruptFlag();
+        if(!Busy())
+            return;
+
+        if(_edges > 0)
+        {
+            uint16_t interval = capture - _last;
+            if(interval > 0 && interval < _minInterval)
+                _minInterval = interval;
+        }
+        _last = capture;
+
+        if(++_edges < _Edges)
+            return;
+
+        Capture::DisableInterrupt();
+        Capture::Disable();
+
+        // Falling edges of 0x55 character are two bits apart
+        uint32_t clock = _Timer::GetClockFreq() / (_Timer::GetPrescaler() + 1);
+        unsigned baud = RoundBaud(2 * clock / _minInterval);
+        _Usart::SetBaud(baud);
+        if(_callback)
+            _callback(baud);
+    }
+}
+
+#endif //! ZHELE_USART_AUTOBAUD_IMPL_COMMON_H
@@ -194,6 +194,21 @@ namespace Zhele
 			template<uint8_t funcNumber>
 			static void AltFuncNumber();
 
+			/**
+			 * @brief Set all pin attributes at once (each configuration register is written once)
+			 * 
+			 * @tparam configuration Target configuration
+			 * @tparam speed Pin speed
+			 * @tparam driverType Driver type
+			 * @tparam pullMode Pull type
+			 * @tparam funcNumber Alternative pin function number
+			 * 
+			 * @par Returns
+			 *	Nothing
+			 */
+			template<Configuration configuration, Speed speed, DriverType driverType = DriverType::PushPull, PullMode pullMode = PullMode::NoPull, uint8_t funcNumber = 0>
+			static void Configure();
+
 			/**
 			 * @brief Check that pin is set now
 			 * 
@@ -133,10 +133,18 @@ namespace Zhele
 
             static void SetSpeed(DataT, Speed)
             {}
+
+            template<DataT mask, Speed>
+            static void SetSpeed()
+            {}
             
             static void SetPullMode(DataT, PullMode)
             {}
 
+            template<DataT mask, PullMode>
+            static void SetPullMode()
+            {}
+
             template<DataT mask, DriverType>
             static void SetDriverType()
             {}
@@ -147,6 +155,14 @@ namespace Zhele
             static void AltFuncNumber(DataT, uint8_t)
             {}
 
+            template<DataT mask, uint8_t>
+            static void AltFuncNumber()
+            {}
+
+            template<DataT mask, Configuration, Speed, DriverType, PullMode, uint8_t>
+            static void Configure()
+            {}
+
             enum{Id = '-'};
             enum{Width=sizeof(DataT)*8};
         };
@@ -413,6 +429,25 @@ namespace Zhele
                  */
                 template<DataType mask, uint8_t number>
                 static void AltFuncNumber();
+
+                /**
+                 * @brief Set all pin attributes at once
+                 * @details
+                 * Register images are calculated at compile time, each register is written once.
+                 * Mode register is written last, so pin is switched to new mode with final attributes.
+                 * 
+                 * @tparam mask Pin mask
+                 * @tparam configuration Selected pins configuration
+                 * @tparam speed Selected pins speed
+                 * @tparam driver Driver type for selected pins
+                 * @tparam pull Pull mode for selected pins
+                 * @tparam number Alternate function number (for AltFunc configuration)
+                 * 
+                 * @par Returns
+                 *	Nothing
+                 */
+                template<DataType mask, Configuration configuration, Speed speed, DriverType driver, PullMode pull, uint8_t number>
+                static void Configure();
                 
 
                 /**
@@ -430,6 +465,13 @@ namespace Zhele
                  *	Nothing
                  */
                 static void Disable();
+
+                /**
+                 * @brief Returns port registers (for DMA transfers to/from port registers)
+                 * 
+                 * @returns Port registers
+                 */
+                static GPIO_TypeDef* Regs();
                 
                 enum { Id = ID };
             };
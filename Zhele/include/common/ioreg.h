@@ -9,10 +9,151 @@
 #ifndef ZHELE_IOREG_COMMON_H
 #define ZHELE_IOREG_COMMON_H
 
+#include "simulation.h"
+
 #include <cstdint>
 
 namespace Zhele
 {
+    /**
+     * @brief Register fields value (mask of modified fields and their new bits)
+     *
+     * @details
+     * Values of different fields are merged by operator |, so several fields are written
+     * by one read-modify-write. All members are constexpr: for constant values masks are merged
+     * at compile time and only one load, one AND/OR pair and one store remain.
+     *
+     * @tparam _DataType Register data type
+     */
+    template<typename _DataType = uint32_t>
+    struct RegisterFieldValue
+    {
+        _DataType Mask; ///< Modified bits
+        _DataType Bits; ///< New value of modified bits
+
+        constexpr RegisterFieldValue operator|(RegisterFieldValue other) const
+        {
+            return {static_cast<_DataType>(Mask | other.Mask), static_cast<_DataType>((Bits & ~other.Mask) | other.Bits)};
+        }
+    };
+
+    /**
+     * @brief Register field
+     *
+     * @code
+     * using Cpha = RegisterField<SPI_CR1_CPHA>;
+     * using Br = RegisterField<SPI_CR1_BR>;
+     * ModifyRegister(SPI1->CR1, Cpha::Set() | Br::Value(3) | RegisterField<SPI_CR1_LSBFIRST>::Clear());
+     * @endcode
+     *
+     * @tparam _Mask Field mask (from MCU header, for example SPI_CR1_BR)
+     * @tparam _DataType Register data type
+     */
+    template<uint32_t _Mask, typename _DataType = uint32_t>
+    class RegisterField
+    {
+        static_assert(_Mask != 0, "Field mask cannot be empty");
+
+        static constexpr unsigned FindPosition(uint32_t mask)
+        {
+            unsigned position = 0;
+            while((mask & 1) == 0)
+            {
+                mask >>= 1;
+                ++position;
+            }
+            return position;
+        }
+    public:
+        using ValueT = RegisterFieldValue<_DataType>;
+
+        /// Field mask
+        static constexpr _DataType Mask = static_cast<_DataType>(_Mask);
+        /// Field position (lowest bit)
+        static constexpr unsigned Position = FindPosition(_Mask);
+
+        /**
+         * @brief Field value (not shifted)
+         *
+         * @param [in] value Value
+         *
+         * @returns Field value
+         */
+        template<typename T>
+        static constexpr ValueT Value(T value)
+        {
+            return {Mask, static_cast<_DataType>((static_cast<uint32_t>(value) << Position) & _Mask)};
+        }
+
+        /**
+         * @brief Field value from already shifted bits (for example, CMSIS define or enum with register bits)
+         *
+         * @param [in] bits Bits
+         *
+         * @returns Field value
+         */
+        template<typename T>
+        static constexpr ValueT Bits(T bits)
+        {
+            return {Mask, static_cast<_DataType>(static_cast<uint32_t>(bits) & _Mask)};
+        }
+
+        /**
+         * @brief Value with all field bits set
+         *
+         * @returns Field value
+         */
+        static constexpr ValueT Set()
+        {
+            return {Mask, Mask};
+        }
+
+        /**
+         * @brief Value with all field bits cleared
+         *
+         * @returns Field value
+         */
+        static constexpr ValueT Clear()
+        {
+            return {Mask, 0};
+        }
+    };
+
+    /**
+     * @brief Write fields by one read-modify-write
+     *
+     * @details
+     * If value covers all register bits, register is written without read.
+     *
+     * @param [in] reg Register
+     * @param [in] value Fields value
+     *
+     * @par Returns
+     *	Nothing
+     */
+    template<typename _Reg, typename _DataType>
+    inline void ModifyRegister(_Reg& reg, RegisterFieldValue<_DataType> value)
+    {
+        if(value.Mask == static_cast<_DataType>(~_DataType(0)))
+            reg = value.Bits;
+        else
+            reg = (reg & ~value.Mask) | value.Bits;
+    }
+
+    /**
+     * @brief Write register (fields that are not specified are zero)
+     *
+     * @param [in] reg Register
+     * @param [in] value Fields value
+     *
+     * @par Returns
+     *	Nothing
+     */
+    template<typename _Reg, typename _DataType>
+    inline void WriteRegister(_Reg& reg, RegisterFieldValue<_DataType> value)
+    {
+        reg = value.Bits;
+    }
 
     /**
      * @brief Declare class with bit operations
@@ -29,32 +170,34 @@ namespace Zhele
     {\
     public:\
         using DataT = DATA_TYPE;\
-        static DataT Get(){return REG_NAME;}\
-        static void Set(DataT value){REG_NAME = value;}\
-        static void Or(DataT value){REG_NAME |= value;}\
-        static void And(DataT value){REG_NAME &= value;}\
-        static void Xor(DataT value){REG_NAME ^= value;}\
-        static void AndOr(DataT andMask, DataT orMask){REG_NAME = (REG_NAME & andMask) | orMask;}\
+        static DataT Get(){return ZHELE_IO_REG(REG_NAME);}\
+        static void Set(DataT value){ZHELE_IO_REG(REG_NAME) = value;}\
+        static void Or(DataT value){ZHELE_IO_REG(REG_NAME) |= value;}\
+        static void And(DataT value){ZHELE_IO_REG(REG_NAME) &= value;}\
+        static void Xor(DataT value){ZHELE_IO_REG(REG_NAME) ^= value;}\
+        static void AndOr(DataT andMask, DataT orMask){ZHELE_IO_REG(REG_NAME) = (ZHELE_IO_REG(REG_NAME) & andMask) | orMask;}\
+        static void Modify(RegisterFieldValue<DataT> value){ModifyRegister(ZHELE_IO_REG(REG_NAME), value);}\
         template<unsigned Bit>\
-        static bool IsBitSet(){return REG_NAME & (1 << Bit);}\
+        static bool IsBitSet(){return ZHELE_IO_REG(REG_NAME) & (1 << Bit);}\
         template<unsigned Bit>\
-        static bool IsBitClear(){return !(REG_NAME & (1 << Bit));}\
+        static bool IsBitClear(){return !(ZHELE_IO_REG(REG_NAME) & (1 << Bit));}\
     }
 
     template<uint32_t _Address, typename _DataType>
     class RegisterWrapper
     {
     public:
-        static _DataType Get(){return  *reinterpret_cast<_DataType*>(_Address);}
-        static void Set(_DataType value){ *reinterpret_cast<_DataType*>(_Address) = value;}
-        static void Or(_DataType value){ *reinterpret_cast<_DataType*>(_Address) |= value;}
-        static void And(_DataType value){ *reinterpret_cast<_DataType*>(_Address) &= value;}
-        static void Xor(_DataType value){ *reinterpret_cast<_DataType*>(_Address) ^= value;}
-        static void AndOr(_DataType andMask, _DataType orMask){ *reinterpret_cast<_DataType*>(_Address) = ( *reinterpret_cast<_DataType*>(_Address) & andMask) | orMask;}
+        static _DataType Get(){return  *ZHELE_IO_PTR(reinterpret_cast<_DataType*>(_Address));}
+        static void Set(_DataType value){ *ZHELE_IO_PTR(reinterpret_cast<_DataType*>(_Address)) = value;}
+        static void Or(_DataType value){ *ZHELE_IO_PTR(reinterpret_cast<_DataType*>(_Address)) |= value;}
+        static void And(_DataType value){ *ZHELE_IO_PTR(reinterpret_cast<_DataType*>(_Address)) &= value;}
+        static void Xor(_DataType value){ *ZHELE_IO_PTR(reinterpret_cast<_DataType*>(_Address)) ^= value;}
+        static void AndOr(_DataType andMask, _DataType orMask){ *ZHELE_IO_PTR(reinterpret_cast<_DataType*>(_Address)) = ( *ZHELE_IO_PTR(reinterpret_cast<_DataType*>(_Address)) & andMask) | orMask;}
+        static void Modify(RegisterFieldValue<_DataType> value){ ModifyRegister(*ZHELE_IO_PTR(reinterpret_cast<_DataType*>(_Address)), value);}
         template<unsigned Bit>
-        static bool IsBitSet(){return  *reinterpret_cast<_DataType*>(_Address) & (1 << Bit);}
+        static bool IsBitSet(){return  *ZHELE_IO_PTR(reinterpret_cast<_DataType*>(_Address)) & (1 << Bit);}
         template<unsigned Bit>
-        static bool IsBitClear(){return !( *reinterpret_cast<_DataType*>(_Address) & (1 << Bit));}
+        static bool IsBitClear(){return !( *ZHELE_IO_PTR(reinterpret_cast<_DataType*>(_Address)) & (1 << Bit));}
     };
 
     /**
@@ -65,7 +208,7 @@ namespace Zhele
     {\
     public:\
         using DataT = DATA_TYPE;\
-        static DataT Get(){return REG_NAME;}\
+        static DataT Get(){return ZHELE_IO_REG(REG_NAME);}\
     }
 
     #define IO_STRUCT_WRAPPER(STRUCT_PTR, CLASS_NAME, STRUCT_TYPE) \
@@ -73,8 +216,8 @@ namespace Zhele
     {\
     public:\
         using DataT = STRUCT_TYPE;\
-        static DataT* Get(){return ((DataT*)STRUCT_PTR);}\
-        DataT* operator->(){return ((DataT*)(STRUCT_PTR));}\
+        static DataT* Get(){return ZHELE_IO_PTR((DataT*)STRUCT_PTR);}\
+        DataT* operator->(){return ZHELE_IO_PTR((DataT*)(STRUCT_PTR));}\
     }
 
     /**
@@ -87,8 +230,8 @@ namespace Zhele
         using DataT = DATA_TYPE;\
         using RegT = decltype(REG_NAME);\
         static constexpr RegT Mask = ((RegT(1u) << BITFIELD_LENGTH) - 1);\
-        static DataT Get(){return static_cast<DataT>((REG_NAME >> BITFIELD_OFFSET) & Mask);}\
-        static void Set(DataT value){REG_NAME = (REG_NAME & ~(Mask << BITFIELD_OFFSET)) | (((RegT)value & Mask) << BITFIELD_OFFSET);}\
+        static DataT Get(){return static_cast<DataT>((ZHELE_IO_REG(REG_NAME) >> BITFIELD_OFFSET) & Mask);}\
+        static void Set(DataT value){ZHELE_IO_REG(REG_NAME) = (ZHELE_IO_REG(REG_NAME) & ~(Mask << BITFIELD_OFFSET)) | (((RegT)value & Mask) << BITFIELD_OFFSET);}\
     }
     
     #define DECLARE_IO_BITFIELD_WRAPPER(REG_NAME, CLASS_NAME, CMSIS_DEFINE) \
@@ -117,6 +260,7 @@ namespace Zhele
         static void And(DataT){}
         static void Xor(DataT){}
         static void AndOr(DataT, DataT){}
+        static void Modify(RegisterFieldValue<DataT>){}
         template<unsigned Bit>
         static bool IsBitSet(){return false;}
         template<unsigned Bit>
@@ -143,6 +287,7 @@ namespace Zhele
         static void And(DataT value){Value() &= value;}
         static void Xor(DataT value){Value() ^= value;}
         static void AndOr(DataT andMask, DataT orMask){Value() = (Value() & andMask) | orMask;}
+        static void Modify(RegisterFieldValue<DataT> value){ModifyRegister(Value(), value);}
         template<int Bit>
         static bool BitIsSet(){return Value() & (1 << Bit);}
         template<int Bit>
@@ -195,7 +340,7 @@ namespace Zhele
     class IoBit
     {
     public:
-        static volatile _DataType& Value(){ return *reinterpret_cast<_DataType*>(_RegAddr);}
+        static volatile _DataType& Value(){ return *ZHELE_IO_PTR(reinterpret_cast<_DataType*>(_RegAddr));}
         static bool IsSet(){ return ((Value() >> _BitfieldOffset) & 0x01) != 0; }
         static void Set(){ Value() |= 1 << _BitfieldOffset; }
         static void Clear(){ Value() &= ~(1 << _BitfieldOffset); }
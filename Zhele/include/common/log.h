@@ -0,0 +1,254 @@
+/**
+ * @file
+ * Implements deferred binary logging
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_LOG_COMMON_H
+#define ZHELE_LOG_COMMON_H
+
+/*
+ * Log options:
+ *  - ZHELE_LOG - enable logging (otherwise log macros expand to nothing);
+ *  - ZHELE_LOG_BUFFER_SIZE - log ring buffer size in 32-bit words (power of 2, default 256);
+ *  - ZHELE_LOG_ITM_PORT - ITM stimulus port for DrainItm (default 1, port 0 is used by trace).
+ */
+#if defined (ZHELE_LOG)
+
+#include <clock.h>
+
+#include "nvic.h"
+#include "template_utils/fixed_string.h"
+#include "../containers/ring_buffer.h"
+
+#include <bit>
+#include <stdint.h>
+#include <type_traits>
+
+#if !defined (ZHELE_LOG_BUFFER_SIZE)
+    #define ZHELE_LOG_BUFFER_SIZE 256
+#endif
+#if !defined (ZHELE_LOG_ITM_PORT)
+    #define ZHELE_LOG_ITM_PORT 1
+#endif
+
+namespace Zhele::Log
+{
+    namespace Private
+    {
+        /**
+         * @brief Calculates format id (FNV-1a hash folded to 24 bits, see tools/log_decoder.py)
+         *
+         * @param [in] text Format string
+         * @param [in] length Format string length
+         *
+         * @returns Format id
+         */
+        constexpr uint32_t FormatId(const char* text, unsigned length)
+        {
+            uint32_t hash = 2166136261u;
+            for (unsigned i = 0; i < length; ++i)
+            {
+                hash ^= static_cast<uint8_t>(text[i]);
+                hash *= 16777619u;
+            }
+            return (hash >> 24) ^ (hash & 0x00ffffff);
+        }
+
+        /**
+         * @brief Counts format conversions
+         *
+         * @details
+         * Conversion is %[flags][width][.precision][h|l]type, where type is one of d, i, u, x, X, c, f, e, g, p.
+         * Strings (%s) are not supported: only argument value is logged, text is not copied.
+         *
+         * @param [in] text Format string
+         * @param [in] length Format string length
+         *
+         * @returns Conversions count or -1 if format has unsupported conversion
+         */
+        constexpr int ArgumentsCount(const char* text, unsigned length)
+        {
+            int count = 0;
+            for (unsigned i = 0; i < length; ++i)
+            {
+                if (text[i] != '%')
+                    continue;
+                if (++i < length && text[i] == '%')
+                    continue;
+                while (i < length && (text[i] == '-' || text[i] == '+' || text[i] == ' ' || text[i] == '#' || text[i] == '0'))
+                    ++i;
+                while (i < length && ((text[i] >= '0' && text[i] <= '9') || text[i] == '.'))
+                    ++i;
+                if (i < length && (text[i] == 'h' || text[i] == 'l'))
+                    ++i;
+                if (i >= length)
+                    return -1;
+                switch (text[i])
+                {
+                case 'd': case 'i': case 'u': case 'x': case 'X': case 'c': case 'f': case 'e': case 'g': case 'p':
+                    ++count;
+                    break;
+                default:
+                    return -1;
+                }
+            }
+            return count;
+        }
+
+        /**
+         * @brief Converts argument to record word
+         *
+         * @param [in] value Argument (integer up to 32 bits, enum, pointer or floating point)
+         *
+         * @returns Raw value (floating point values are converted to float)
+         */
+        template<typename T>
+        uint32_t Encode(T value)
+        {
+            if constexpr (std::is_floating_point_v<T>)
+                return std::bit_cast<uint32_t>(static_cast<float>(value));
+            else if constexpr (std::is_pointer_v<T>)
+                return static_cast<uint32_t>(reinterpret_cast<uintptr_t>(value));
+            else if constexpr (std::is_enum_v<T>)
+                return static_cast<uint32_t>(value);
+            else
+            {
+                static_assert(std::is_integral_v<T> && sizeof(T) <= sizeof(uint32_t), "Only 32-bit integers, enums, pointers and floats can be logged");
+                return static_cast<uint32_t>(value);
+            }
+        }
+    }
+
+    /**
+     * @brief Compile-time format properties
+     *
+     * @tparam _Format Format string
+     */
+    template<TemplateUtils::fixed_string _Format>
+    struct Format
+    {
+        /// Format id (record header)
+        static constexpr uint32_t Id = Private::FormatId(_Format.Text, _Format.Length);
+        /// Arguments count (-1 if format is not supported)
+        static constexpr int ArgumentsCount = Private::ArgumentsCount(_Format.Text, _Format.Length);
+    };
+
+    /**
+     * @brief Binary log ring buffer
+     *
+     * @details
+     * Format string is never formatted or stored by MCU: record contains only format id (compile-time hash),
+     * timestamp and raw arguments, so write costs a few dozen cycles and 8 + 4 * N bytes.
+     * Host decoder (tools/log_decoder.py) finds format strings by id in sources and formats records.
+     *
+     * Record layout (32-bit little endian words):
+     *  - header: format id << 8 | arguments count;
+     *  - timestamp: CPU cycles counter (DWT CYCCNT), 0 if MCU has no cycle counter;
+     *  - arguments.
+     *
+     * Records are written from any context, writers are serialized by short driver critical section
+     * (see ZHELE_DRIVER_CRITICAL_PRIORITY). If buffer has no space, record is dropped and counted.
+     *
+     * @tparam _Size Buffer size (in 32-bit words, power of 2)
+     */
+    template<unsigned _Size>
+    class LogBuffer
+    {
+        static_assert((_Size & (_Size - 1)) == 0, "Log buffer size should be power of 2.");
+    public:
+        /**
+         * @brief Enables cycles counter for timestamps
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Enable();
+
+        /**
+         * @brief Writes record
+         *
+         * @tparam _Format Format string (printf-like, see Private::ArgumentsCount)
+         * @tparam _Args Arguments types
+         *
+         * @param [in] args Arguments
+         *
+         * @par Returns
+         *  Nothing
+         */
+        template<TemplateUtils::fixed_string _Format, typename... _Args>
+        static void Write(_Args... args);
+
+        /**
+         * @brief Reads raw records data (for custom sink, for example USB CDC)
+         *
+         * @details
+         * Do not mix with DrainUsart while transfer is in progress.
+         *
+         * @param [out] words Destination
+         * @param [in] count Max words count
+         *
+         * @returns Read words count
+         */
+        static unsigned Read(uint32_t* words, unsigned count);
+
+        /**
+         * @brief Returns dropped records count
+         *
+         * @returns Dropped records count
+         */
+        static uint32_t Dropped();
+
+        /**
+         * @brief Writes all pending records to ITM stimulus port (SWO).
+         *
+         * @details
+         * Does nothing if ITM or stimulus port is disabled (debugger does not capture SWO).
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void DrainItm();
+
+        /**
+         * @brief Starts async (DMA) write of pending records to USART
+         *
+         * @details
+         * Call periodically (for example, from main loop). DMA reads records directly from log buffer,
+         * space is released when transfer completes.
+         *
+         * @tparam _Usart USART
+         *
+         * @retval true Transfer started
+         * @retval false No pending records or previous transfer is not completed
+         */
+        template<typename _Usart>
+        static bool DrainUsart();
+
+    private:
+        static void WriteRecord(const uint32_t* words, unsigned count);
+        static uint32_t Timestamp();
+
+        static Containers::RingBuffer<_Size, uint32_t> _buffer;
+        static Containers::SingleWriterValue<uint32_t> _dropped;
+    };
+
+    /// Log buffer
+    using Buffer = LogBuffer<ZHELE_LOG_BUFFER_SIZE>;
+}
+
+/// Writes log record, for example ZHELE_LOG_WRITE("adc %u, temperature %f", value, temperature)
+#define ZHELE_LOG_WRITE(FORMAT, ...) ::Zhele::Log::Buffer::Write<FORMAT>(__VA_ARGS__)
+
+#include "impl/log.h"
+
+#else
+
+#define ZHELE_LOG_WRITE(FORMAT, ...)
+
+#endif
+
+#endif //! ZHELE_LOG_COMMON_H
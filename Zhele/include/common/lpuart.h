@@ -0,0 +1,93 @@
+/**
+ * @file
+ * Implements LPUART (low-power UART)
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_LPUART_COMMON_H
+#define ZHELE_LPUART_COMMON_H
+
+#include "usart.h"
+
+namespace Zhele::Private
+{
+    /**
+     * @brief Implements LPUART
+     *
+     * @details
+     * LPUART is asynchronous USART with other baud rate generator (BRR = 256 * clock / baud).
+     * It has no oversampling selection, synchronous, smartcard, LIN, receiver timeout
+     * and auto baud rate detection modes (do not use them), all other USART methods (DMA included) work as usual.
+     * Kernel clock can be LSE (select clock source before Init), so receiver works in Stop 2 mode
+     * (up to 9600 baud, see EnableWakeupFromStop). Clock should be in range [3 * baud, 4096 * baud].
+     *
+     * @tparam _Regs Registers
+     * @tparam _IRQNumber IRQ number
+     * @tparam _ClockCtrl Clock
+     * @tparam _TxPins TX pins
+     * @tparam _RxPins RX pins
+     * @tparam _DmaTx TX DMA channel
+     * @tparam _DmaRx RX DMA channel
+     */
+    template<typename _Regs, IRQn_Type _IRQNumber, typename _ClockCtrl, typename _TxPins, typename _RxPins, typename _DmaTx, typename _DmaRx>
+    class LpUart : public Usart<_Regs, _IRQNumber, _ClockCtrl, _TxPins, _RxPins, _DmaTx, _DmaRx>
+    {
+    public:
+        /**
+         * @brief Initialize LPUART
+         *
+         * @tparam baud Baud rate
+         * @param [in] mode Mode
+         *
+         * @par Returns
+         *	Nothing
+         */
+        template<unsigned long baud>
+        static inline void Init(UsartBase::UsartMode mode = DefaultUsartMode);
+
+        /**
+         * @brief Initialize LPUART
+         *
+         * @param [in] baud Baud rate
+         * @param [in] mode Mode
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void Init(unsigned baud, UsartBase::UsartMode mode = DefaultUsartMode);
+
+        /**
+         * @brief Set baud rate (BRR is kept if baud rate is unreachable)
+         *
+         * @param [in] baud Baud rate
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void SetBaud(unsigned baud);
+
+        /**
+         * @brief Returns current baud rate (calculated by BRR)
+         *
+         * @returns Baud rate
+         */
+        static unsigned GetBaud();
+
+        /**
+         * @brief Calculate BRR for baud rate
+         *
+         * @param [in] clock LPUART clock frequence
+         * @param [in] baud Baud rate
+         *
+         * @returns BRR register value (0 if baud rate is unreachable)
+         */
+        static constexpr uint32_t CalculateBrr(uint32_t clock, uint32_t baud);
+    };
+}
+
+#include "impl/lpuart.h"
+
+#endif //! ZHELE_LPUART_COMMON_H
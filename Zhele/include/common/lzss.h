@@ -0,0 +1,166 @@
+/**
+ * @file
+ * Implements streaming LZSS compressor (for logs written to SD card or USB CDC)
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_LZSS_COMMON_H
+#define ZHELE_LZSS_COMMON_H
+
+#include <stdint.h>
+
+namespace Zhele::Compression
+{
+    /**
+     * @brief Streaming LZSS encoder
+     *
+     * @details
+     * Bit stream (MSB first) consists of tokens:
+     *  - literal: 1, byte (8 bits);
+     *  - match: 0, offset (_WindowBits bits, 1...2^_WindowBits-1), length - MinMatch (_LengthBits bits);
+     *  - sync: 0, offset = 0 (_WindowBits bits), then zero bits up to byte boundary.
+     * Sync is written by Flush, so all data written before Flush can be decoded
+     * while stream continues (dictionary is kept). Host decoder is tools/lzss_decoder.py.
+     *
+     * Matches are searched by hash chains of 2-byte prefixes (no full window scan),
+     * all buffers are object members (no heap). Compressed data is passed to sink by chunks
+     * of _OutputSize bytes, sink is any object with Write(const uint8_t* data, unsigned size) method
+     * (for example, ContiguousLogFile or CDC stream) and it should accept all data.
+     *
+     * Memory: 2^(_WindowBits + 1) + 2^(_WindowBits + 1) + 512 + _OutputSize bytes
+     * (2.6 KB for default parameters).
+     *
+     * @tparam _WindowBits Window size bits (8...12)
+     * @tparam _LengthBits Match length bits (2...8)
+     * @tparam _OutputSize Output chunk size
+     */
+    template<unsigned _WindowBits = 9, unsigned _LengthBits = 4, unsigned _OutputSize = 64>
+    class LzssEncoder
+    {
+        static_assert(_WindowBits >= 8 && _WindowBits <= 12, "Window bits should be 8...12");
+        static_assert(_LengthBits >= 2 && _LengthBits <= 8, "Length bits should be 2...8");
+        static_assert(_OutputSize > 0, "Output size should be positive");
+
+        static const unsigned WindowSize = 1u << _WindowBits;
+        static const unsigned RingSize = WindowSize * 2;
+        static const unsigned HashSize = 256;
+        static const unsigned MaxCandidates = 16;
+    public:
+        /// Min match length (shorter matches are longer than literals)
+        static const unsigned MinMatch = (1 + _WindowBits + _LengthBits) / 9 + 1;
+
+        /// Max match length
+        static const unsigned MaxMatch = MinMatch + (1u << _LengthBits) - 1;
+
+        static_assert(MaxMatch < WindowSize, "Max match should be less than window");
+
+        /**
+         * @brief Constructor
+         */
+        LzssEncoder();
+
+        /**
+         * @brief Starts new stream (dictionary is cleared)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        void Reset();
+
+        /**
+         * @brief Compresses data
+         *
+         * @details
+         * Up to MaxMatch last bytes are kept in lookahead until next Write or Flush.
+         *
+         * @tparam _Sink Sink type
+         *
+         * @param [in] data Data
+         * @param [in] size Data size
+         * @param [in] sink Compressed data sink
+         *
+         * @par Returns
+         *  Nothing
+         */
+        template<typename _Sink>
+        void Write(const void* data, unsigned size, _Sink& sink);
+
+        /**
+         * @brief Compresses all pending data, writes sync token and passes output to sink
+         *
+         * @details
+         * Costs 1-2 bytes, so call it when data should be delivered (CDC idle, f_sync),
+         * not after each record.
+         *
+         * @tparam _Sink Sink type
+         *
+         * @param [in] sink Compressed data sink
+         *
+         * @par Returns
+         *  Nothing
+         */
+        template<typename _Sink>
+        void Flush(_Sink& sink);
+
+        /**
+         * @brief Flushes data and starts new stream (for example, before file close)
+         *
+         * @tparam _Sink Sink type
+         *
+         * @param [in] sink Compressed data sink
+         *
+         * @par Returns
+         *  Nothing
+         */
+        template<typename _Sink>
+        void Finish(_Sink& sink);
+
+        /**
+         * @brief Returns count of input bytes
+         *
+         * @returns Input bytes count (since Reset)
+         */
+        uint32_t InputSize() const;
+
+        /**
+         * @brief Returns count of compressed bytes
+         *
+         * @returns Output bytes count (since Reset, including buffered)
+         */
+        uint32_t OutputSize() const;
+
+    private:
+        template<typename _Sink>
+        void Encode(unsigned minPending, _Sink& sink);
+
+        template<typename _Sink>
+        void PutBits(uint32_t value, unsigned count, _Sink& sink);
+
+        template<typename _Sink>
+        void FlushOutput(_Sink& sink);
+
+        unsigned Hash(uint32_t position) const;
+        void Insert(uint32_t position);
+        unsigned FindMatch(uint32_t position, unsigned maxLength, unsigned& offset) const;
+
+        uint8_t _ring[RingSize];
+        uint16_t _head[HashSize];
+        uint16_t _previous[WindowSize];
+        uint8_t _output[_OutputSize];
+
+        uint32_t _inputEnd;
+        uint32_t _position;
+        uint32_t _syncPosition;
+        uint32_t _outputTotal;
+        uint32_t _bits;
+        unsigned _bitCount;
+        unsigned _outputCount;
+    };
+}
+
+#include "impl/lzss.h"
+
+#endif //! ZHELE_LZSS_COMMON_H
@@ -2,7 +2,56 @@
 #define ZHELE_DECLARATIONS_H
 
 #if defined (__GNUC__) && defined(__arm__)
+/**
+ * Place function in RAM (.ramfunc section, see Zhele/linker/ramfunc.ld).
+ * Code is executed without flash wait states and does not stall while flash is programmed.
+ * Function is never inlined into flash code and is called by long call.
+ *
+ * @note GCC ignores section attribute of template functions, use the macro for
+ * ordinary functions (interrupt vectors, DSP kernels).
+ */
+#define ZHELE_RAMFUNC __attribute__((section(".ramfunc"), noinline, long_call))
+
+/**
+ * Place variable in core coupled memory (.ccmram section, see Zhele/linker/ccmram_f4.ld).
+ * CCM is not accessible by DMA and is not initialized by startup code.
+ */
+#define ZHELE_CCMDATA __attribute__((section(".ccmram")))
+
+/**
+ * Place variable in DMA-accessible RAM (.dmaram section, see Zhele/linker/dmaram.ld).
+ * Use it for DMA buffers when .data/.bss (or stack) are placed in CCM. Variable is aligned to word
+ * (any PSize/MSize) and is not initialized by startup code.
+ */
+#define ZHELE_DMADATA __attribute__((section(".dmaram"), aligned(4)))
+
+/**
+ * Place variable in external RAM (.extram section, see Zhele/linker/extram_fsmc.ld).
+ * Variable must not be accessed before FSMC bank is initialized.
+ */
+#define ZHELE_EXTRAM __attribute__((section(".extram")))
+
+#if defined (ZHELE_HANDLERS_IN_RAM)
+#define ZHELE_INTERRUPT(ISR_NAME) ZHELE_RAMFUNC __attribute__((interrupt)) void ISR_NAME()
+#else
 #define ZHELE_INTERRUPT(ISR_NAME) __attribute__((interrupt)) void ISR_NAME()
 #endif
+#else
+#define ZHELE_RAMFUNC
+#define ZHELE_CCMDATA
+#define ZHELE_DMADATA
+#define ZHELE_EXTRAM
+#endif
+
+/**
+ * Framework interrupt handlers (DMA, ADC, USB) are inlined into interrupt vector
+ * if ZHELE_HANDLERS_IN_RAM is defined, so with vector placed in RAM
+ * (ZHELE_INTERRUPT or ZHELE_RAMFUNC) the whole handler runs from RAM.
+ */
+#if defined (ZHELE_HANDLERS_IN_RAM)
+#define ZHELE_HANDLER __attribute__((always_inline)) inline
+#else
+#define ZHELE_HANDLER
+#endif
 
-#endif //!ZHELE_DECLARATIONS_H
\ No newline at end of file
+#endif //!ZHELE_DECLARATIONS_H
@@ -0,0 +1,138 @@
+/**
+ * @file
+ * Implements matrix keypad scanned by timer and DMA
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_MATRIX_KEYPAD_COMMON_H
+#define ZHELE_MATRIX_KEYPAD_COMMON_H
+
+#include "debouncer.h"
+#include "gpio_dma.h"
+
+#include <stdint.h>
+#include <type_traits>
+
+namespace Zhele::IO
+{
+    /**
+     * @brief Matrix keypad (up to 64 keys) scanned without CPU
+     *
+     * @details
+     * Rows are open-drain outputs, columns are pulled-up inputs. Timer update event DMA writes
+     * next row word to rows port BSRR (selected row is driven low), timer compare event DMA
+     * copies columns port IDR to samples buffer in the middle of period (lines are settled).
+     * Samples buffer is continuous ping-pong buffer of two scans, so after every scan DMA callback
+     * converts scan to keys word and debounces all keys by one Debouncer update.
+     * There is only one interrupt per scan. Scan period is rows count divided by rows rate,
+     * it should be 1..10 ms (4 debounce samples). All rows must belong to one port and all columns
+     * to one port. DMA channels must be connected to timer update and channel requests
+     * and must have access to GPIO (DMA2 for stm32f4).
+     *
+     * Key index is row * columns count + column.
+     *
+     * @tparam _Rows Rows pinlist
+     * @tparam _Columns Columns pinlist
+     * @tparam _Timer Timer (paces scanning)
+     * @tparam _RowDma DMA channel (stream) connected to timer update request
+     * @tparam _ColumnDma DMA channel (stream) connected to timer channel request
+     * @tparam _Channel Timer channel (0..3) for columns sampling
+     */
+    template<typename _Rows, typename _Columns, typename _Timer, typename _RowDma, typename _ColumnDma, unsigned _Channel = 0>
+    class MatrixKeypad
+    {
+        static constexpr unsigned RowsCount = _Rows::Length;
+        static constexpr unsigned ColumnsCount = _Columns::Length;
+        static_assert(RowsCount * ColumnsCount <= 64, "Keypad supports up to 64 keys");
+
+        using RowsStreamer = GpioStreamer<_Rows, _Timer, _RowDma>;
+        using ColumnsSampler = GpioSampler<_Columns, _Timer, _ColumnDma>;
+        using Compare = typename _Timer::template OutputCompare<_Channel>;
+    public:
+        /// Keys word (bit for key)
+        using KeysType = std::conditional_t<(RowsCount * ColumnsCount <= 32), uint32_t, uint64_t>;
+
+        /// Keys changed callback (it is called from DMA interrupt)
+        using Callback = void(*)(KeysType changed);
+
+        /**
+         * @brief Init pins and timer
+         *
+         * @param [in] rowsRate Rows switching rate (Hz)
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void Init(uint32_t rowsRate);
+
+        /**
+         * @brief Start scanning
+         *
+         * @param [in] callback Keys changed callback (optional)
+         * @param [in] rowDmaChannel Update request DMA channel selection (for DMA with streams)
+         * @param [in] columnDmaChannel Timer channel request DMA channel selection (for DMA with streams)
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void Start(Callback callback = nullptr
+            ONLY_IF_STREAM_SUPPORTED(COMMA uint8_t rowDmaChannel = 0 COMMA uint8_t columnDmaChannel = 0));
+
+        /**
+         * @brief Stop scanning
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void Stop();
+
+        /**
+         * @brief Returns key index
+         *
+         * @param [in] row Row
+         * @param [in] column Column
+         *
+         * @returns Index of key bit
+         */
+        static constexpr unsigned KeyIndex(unsigned row, unsigned column)
+        {
+            return row * ColumnsCount + column;
+        }
+
+        /**
+         * @brief Returns debounced keys state
+         *
+         * @returns Pressed keys
+         */
+        static KeysType State();
+
+        /**
+         * @brief Returns and clears pressed keys events
+         *
+         * @returns Keys pressed since last call
+         */
+        static KeysType Pressed();
+
+        /**
+         * @brief Returns and clears released keys events
+         *
+         * @returns Keys released since last call
+         */
+        static KeysType Released();
+
+    private:
+        static void OnScan(void* data, unsigned size, bool success);
+
+        static uint32_t _rowWords[RowsCount];
+        static uint16_t _samples[2 * RowsCount];
+        static Debouncer<KeysType> _debouncer;
+        static Callback _callback;
+    };
+}
+
+#include "impl/matrix_keypad.h"
+
+#endif //! ZHELE_MATRIX_KEYPAD_COMMON_H
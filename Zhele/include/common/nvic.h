@@ -0,0 +1,198 @@
+/**
+ * @file
+ * @brief Interrupt priorities and critical sections
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_NVIC_COMMON_H
+#define ZHELE_NVIC_COMMON_H
+
+#include <clock.h>
+
+#include <stdint.h>
+
+/**
+ * Priority of interrupts without IrqPriority specialization.
+ * Negative value means that priority is not changed (reset value is 0, the highest).
+ */
+#if !defined (ZHELE_DEFAULT_IRQ_PRIORITY)
+    #define ZHELE_DEFAULT_IRQ_PRIORITY -1
+#endif
+
+/**
+ * Masking level of library critical sections (queues, arbiters, pools).
+ * 0 - all interrupts are masked (PRIMASK). Nonzero value N - only interrupts with
+ * priority N and lower are masked (BASEPRI), so handlers with priority 0...N-1 are never delayed,
+ * but they must not call library methods which use critical sections.
+ */
+#if !defined (ZHELE_DRIVER_CRITICAL_PRIORITY)
+    #define ZHELE_DRIVER_CRITICAL_PRIORITY 0
+#endif
+
+/**
+ * @brief Assigns interrupt priority at compile time (use at global scope)
+ *
+ * @details
+ * Priority is applied by peripheral when it enables interrupt, for example:
+ * ZHELE_IRQ_PRIORITY(TIM1_UP_IRQn, 0);
+ * ZHELE_IRQ_PRIORITY(USART1_IRQn, 3);
+ */
+#define ZHELE_IRQ_PRIORITY(IRQN, PRIORITY) \
+    template<> struct Zhele::IrqPriority<IRQN> \
+    { \
+        static_assert((PRIORITY) >= 0 && (PRIORITY) < (1 << __NVIC_PRIO_BITS), "Priority is out of range"); \
+        static constexpr int Value = (PRIORITY); \
+    }
+
+namespace Zhele
+{
+    /**
+     * @brief Interrupt priority (can be specialized by ZHELE_IRQ_PRIORITY)
+     *
+     * @tparam _IRQn Interrupt number
+     */
+    template<IRQn_Type _IRQn>
+    struct IrqPriority
+    {
+        static constexpr int Value = ZHELE_DEFAULT_IRQ_PRIORITY;
+    };
+
+    /**
+     * @brief NVIC control
+     */
+    class Nvic
+    {
+    public:
+        /// Priority bits count
+        static const unsigned PriorityBits = __NVIC_PRIO_BITS;
+
+        /// The lowest priority
+        static const uint8_t LowestPriority = (1u << __NVIC_PRIO_BITS) - 1;
+
+        /**
+         * @brief Applies compile-time priority (if it is assigned) and enables interrupt
+         *
+         * @tparam _IRQn Interrupt number
+         *
+         * @par Returns
+         *	Nothing
+         */
+        template<IRQn_Type _IRQn>
+        static void EnableIrq()
+        {
+            ApplyPriority<_IRQn>();
+            NVIC_EnableIRQ(_IRQn);
+        }
+
+        /**
+         * @brief Applies compile-time priority (if it is assigned)
+         *
+         * @tparam _IRQn Interrupt number
+         *
+         * @par Returns
+         *	Nothing
+         */
+        template<IRQn_Type _IRQn>
+        static void ApplyPriority()
+        {
+            if constexpr (IrqPriority<_IRQn>::Value >= 0)
+                NVIC_SetPriority(_IRQn, IrqPriority<_IRQn>::Value);
+        }
+
+        /**
+         * @brief Set interrupt priority
+         *
+         * @param [in] irq Interrupt number
+         * @param [in] priority Priority (0 is the highest)
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void SetPriority(IRQn_Type irq, uint8_t priority)
+        {
+            NVIC_SetPriority(irq, priority);
+        }
+    };
+
+    /**
+     * @brief Critical section which masks interrupts with priority _Priority and lower
+     *
+     * @details
+     * Interrupts with higher priority (0..._Priority-1) are not masked. BASEPRI is used for
+     * Cortex-M3/M4, PRIMASK is used for Cortex-M0 and for _Priority = 0 (all interrupts are masked).
+     * Nested critical sections are allowed, state is restored on exit.
+     *
+     * @tparam _Priority Masking level
+     */
+    template<uint8_t _Priority>
+    class CriticalSection
+    {
+        static_assert(_Priority < (1u << __NVIC_PRIO_BITS), "Priority is out of range");
+    #if defined (__CORTEX_M) && (__CORTEX_M >= 3)
+        static const bool UseBasepri = _Priority != 0;
+    #else
+        static const bool UseBasepri = false;
+    #endif
+    public:
+        CriticalSection() : _state(Enter())
+        {}
+
+        ~CriticalSection()
+        {
+            Leave(_state);
+        }
+
+        CriticalSection(const CriticalSection&) = delete;
+        CriticalSection& operator=(const CriticalSection&) = delete;
+
+        /**
+         * @brief Enters critical section
+         *
+         * @returns Previous state (for Leave)
+         */
+        static uint32_t Enter()
+        {
+        #if defined (__CORTEX_M) && (__CORTEX_M >= 3)
+            if constexpr (UseBasepri)
+            {
+                uint32_t basepri = __get_BASEPRI();
+                // BASEPRI_MAX never lowers current masking level
+                __set_BASEPRI_MAX(static_cast<uint32_t>(_Priority) << (8 - __NVIC_PRIO_BITS));
+                return basepri;
+            }
+        #endif
+            uint32_t primask = __get_PRIMASK();
+            __disable_irq();
+            return primask;
+        }
+
+        /**
+         * @brief Leaves critical section
+         *
+         * @param [in] state State returned by Enter
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void Leave(uint32_t state)
+        {
+        #if defined (__CORTEX_M) && (__CORTEX_M >= 3)
+            if constexpr (UseBasepri)
+            {
+                __set_BASEPRI(state);
+                return;
+            }
+        #endif
+            __set_PRIMASK(state);
+        }
+    private:
+        uint32_t _state;
+    };
+
+    /// Critical section of library internals (see ZHELE_DRIVER_CRITICAL_PRIORITY)
+    using DriverCriticalSection = CriticalSection<ZHELE_DRIVER_CRITICAL_PRIORITY>;
+}
+
+#endif //! ZHELE_NVIC_COMMON_H
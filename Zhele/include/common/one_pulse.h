@@ -0,0 +1,118 @@
+/**
+ * @file
+ * Implements hardware-timed pulses and delays (timer one-pulse mode)
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_ONE_PULSE_COMMON_H
+#define ZHELE_ONE_PULSE_COMMON_H
+
+#include "iopins.h"
+
+#include <stdint.h>
+#include <type_traits>
+
+namespace Zhele::Timers
+{
+    /**
+     * @brief Hardware-timed pulses and delays on timer in one-pulse mode
+     *
+     * @details
+     * Counter stops by itself at update event, so pulse width and delay are exact (timer ticks)
+     * and do not depend on CPU load and compiler optimization. Completion callback is called
+     * from timer update interrupt (call IrqHandler from timer IRQ handler).
+     * With output pin pulse is generated by output compare channel (PWM mode 2):
+     * pin is inactive for delay ticks, then active for width ticks. Pin is low between pulses.
+     * Advanced timers (Timer1, Timer8) outputs require main output enable (MOE) by application.
+     * @code
+     * using CePulse = OnePulse<Timer3, Pa6, 0>;
+     * CePulse::Init();
+     * CePulse::Pulse(15); // 15 us CE pulse without busy-wait
+     * @endcode
+     *
+     * @tparam _Timer Timer (any timer for delays, timer with output compare channels for pulses)
+     * @tparam _Pin Output pin (NullPin for delays only)
+     * @tparam _Channel Output compare channel of pin (from 0)
+     */
+    template<typename _Timer, typename _Pin = IO::NullPin, unsigned _Channel = 0>
+    class OnePulse
+    {
+        static constexpr bool HasOutput = !std::is_same_v<_Pin, IO::NullPin>;
+    public:
+        /// Timer counter type
+        using Counter = typename _Timer::Counter;
+
+        /// Completion callback (it is called from timer interrupt)
+        using Callback = void(*)();
+
+        /**
+         * @brief Init timer (and output pin)
+         *
+         * @param [in] tickFrequency Timer tick frequency (Hz), default is 1 MHz (durations in microseconds)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Init(uint32_t tickFrequency = 1000000);
+
+        /**
+         * @brief Start delay
+         *
+         * @param [in] duration Delay (ticks, from 1)
+         * @param [in] callback Completion callback (optional)
+         *
+         * @retval true Delay has been started
+         * @retval false Previous pulse or delay is in progress
+         */
+        static bool Delay(Counter duration, Callback callback = nullptr);
+
+        /**
+         * @brief Start pulse on output pin
+         *
+         * @param [in] width Pulse width (ticks, from 1)
+         * @param [in] delay Delay before pulse (ticks, from 1), width + delay should fit counter
+         * @param [in] callback Completion callback (optional)
+         *
+         * @retval true Pulse has been started
+         * @retval false Previous pulse or delay is in progress
+         */
+        static bool Pulse(Counter width, Counter delay = 1, Callback callback = nullptr);
+
+        /**
+         * @brief Returns pulse (delay) state
+         *
+         * @retval true Pulse or delay is in progress
+         * @retval false Timer is idle
+         */
+        static bool Busy();
+
+        /**
+         * @brief Wait for pulse (delay) completion
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Wait();
+
+        /**
+         * @brief Timer IRQ handler. Call it from timer IRQ handler
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void IrqHandler();
+
+    private:
+        static void Start(Counter period, Callback callback);
+
+        static Callback _callback;
+        static volatile bool _busy;
+    };
+}
+
+#include "impl/one_pulse.h"
+
+#endif //! ZHELE_ONE_PULSE_COMMON_H
@@ -14,23 +14,205 @@
 
 #include <stdint.h>
 
+#include "crc.h"
+#include "dma.h"
+#include "power.h"
+#include "template_utils/data_transfer.h"
+
+#if !defined (ZHELE_ONE_WIRE_TRANSACTION_SIZE)
+    /// Max one-wire transaction size (bytes to write + bytes to read)
+    #define ZHELE_ONE_WIRE_TRANSACTION_SIZE 24
+#endif
+
 namespace Zhele
 {
+    /// One-wire bus speed
+    enum class OneWireSpeed : uint8_t
+    {
+        Standard, ///< Standard speed (about 15 kbps)
+        Overdrive ///< Overdrive speed (about 100 kbps, supported by some devices only)
+    };
+
     /**
-     * @brief Class for one-wired communicate
+     * @brief One-wire bit engine based on half-duplex USART
      * 
-     * @tparam Pin GPIO Pin
+     * @details
+     * Reset pulse is 0xf0 byte at low baud (9600 for standard speed, 66666 for overdrive),
+     * every bit slot is one byte at high baud (115200 or 1000000): 0xff is "write 1" (or read) slot,
+     * 0x00 is "write 0" slot, received echo is 0xff if line was not pulled by device.
+     * Overdrive requires strong pull-up (about 2.2 kOhm) and USART clock that allows 1 Mbaud.
+     * 
+     * @tparam _Usart USART
+     * @tparam _Pin Line pin (USART TX pin)
      */
     template<typename _Usart, typename _Pin>
-    class OneWire
+    class OneWireUsartEngine
     {
+        static const uint32_t ResetBaud[2];
+        static const uint32_t SlotBaud[2];
     public:
+        /**
+         * @brief Init USART and pin
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        static void Init();
+
+        /**
+         * @brief Generates reset pulse at current speed
+         * 
+         * @retval true Presence detected
+         * @retval false No presence
+         */
+        static bool Reset();
+
+        /**
+         * @brief Sets bus speed (for next reset and slots)
+         * 
+         * @param [in] speed Speed
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        static void SetSpeed(OneWireSpeed speed);
+
+        /**
+         * @brief Starts bit slots exchange (in-place)
+         * 
+         * @param [in, out] slots Slots (0xff - write 1 or read, 0x00 - write 0), received line state after completion
+         * @param [in] count Slots count
+         * @param [in] callback Completion callback
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        static void Exchange(uint8_t* slots, unsigned count, TransferCallback callback);
+
+    private:
+        static OneWireSpeed _speed;
+    };
+
+    /**
+     * @brief One-wire bit engine based on timer and two DMA channels (without USART)
+     * 
+     * @details
+     * Timer counts with 0.25 us tick, every timer period is one bit slot. Pulse channel works
+     * in PWM2 mode (line is low while counter is less than compare value) on open-drain pin,
+     * timer update DMA request loads low time of next slot (1 or 0 slot) to compare register,
+     * so slots are generated back-to-back without CPU. Sample channel compare event triggers
+     * DMA request that reads GPIO input register at sample time of every slot.
+     * Timer clock should be multiple of 4 MHz.
+     * 
+     * @tparam _Timer Timer
+     * @tparam _Pin Line pin (pulse channel pin)
+     * @tparam _PulseChannel Timer channel connected to pin (0...3)
+     * @tparam _SampleChannel Other timer channel used for sampling (0...3)
+     * @tparam _PulseDma DMA channel (stream) connected to timer update request
+     * @tparam _SampleDma DMA channel (stream) connected to sample channel request
+     * @tparam _PulseDmaRequest Pulse DMA channel selection (for DMA with streams, ignored otherwise)
+     * @tparam _SampleDmaRequest Sample DMA channel selection (for DMA with streams, ignored otherwise)
+     */
+    template<typename _Timer, typename _Pin, unsigned _PulseChannel, unsigned _SampleChannel, typename _PulseDma, typename _SampleDma,
+        uint8_t _PulseDmaRequest = 0, uint8_t _SampleDmaRequest = 0>
+    class OneWireTimerEngine
+    {
+        static_assert(_PulseChannel < 4 && _SampleChannel < 4, "Timer channel should be 0...3");
+        static_assert(_PulseChannel != _SampleChannel, "Pulse and sample channels should be different");
+
+        using Pulse = typename _Timer::template PWMGeneration<_PulseChannel>;
+        using Sample = typename _Timer::template OutputCompare<_SampleChannel>;
+        using Port = typename _Pin::Port;
+
+        /// Timer tick frequency (0.25 us)
+        static const uint32_t TickFreq = 4000000;
+        static const unsigned MaxSlots = ZHELE_ONE_WIRE_TRANSACTION_SIZE * 8;
+
+        /// Slot timings (ticks)
+        struct Timings
+        {
+            uint16_t Period; ///< Slot time
+            uint16_t One; ///< Low time of "write 1" (and read) slot
+            uint16_t Zero; ///< Low time of "write 0" slot
+            uint16_t Sample; ///< Sample time
+        };
+        static const Timings SlotTimings[2];
+        static const Timings ResetTimings[2];
+    public:
+        /**
+         * @brief Init timer, DMA and pin
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        static void Init();
+
+        /**
+         * @brief Generates reset pulse at current speed
+         * 
+         * @retval true Presence detected
+         * @retval false No presence
+         */
+        static bool Reset();
+
+        /**
+         * @brief Sets bus speed (for next reset and slots)
+         * 
+         * @param [in] speed Speed
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        static void SetSpeed(OneWireSpeed speed);
+
+        /**
+         * @brief Starts bit slots exchange (in-place)
+         * 
+         * @param [in, out] slots Slots (0xff - write 1 or read, 0x00 - write 0), received line state after completion
+         * @param [in] count Slots count (up to ZHELE_ONE_WIRE_TRANSACTION_SIZE * 8)
+         * @param [in] callback Completion callback
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        static void Exchange(uint8_t* slots, unsigned count, TransferCallback callback);
+
+    private:
+        static void Run(const Timings& timings, unsigned count);
+        static void OnComplete(void* data, unsigned size, bool success);
+
+        static uint16_t _pulses[MaxSlots + 1];
+        static uint16_t _samples[MaxSlots + 1];
+        static uint8_t* _slots;
+        static unsigned _count;
+        static TransferCallback _callback;
+        static OneWireSpeed _speed;
+    };
+
+    /**
+     * @brief Class for one-wired communicate
+     * 
+     * @details
+     * Protocol layer (ROM commands, search, transactions) over bit engine.
+     * 
+     * @tparam _Engine Bit engine (OneWireUsartEngine or OneWireTimerEngine)
+     */
+    template<typename _Engine>
+    class BasicOneWire
+    {
+    public:
+        /// Max transaction size (bytes to write + bytes to read)
+        static const uint8_t MaxTransactionSize = ZHELE_ONE_WIRE_TRANSACTION_SIZE;
+
         enum Commands : uint8_t
         {
             Read = 0x33,
             Match = 0x55,
             Skip = 0xcc,
             Search = 0xf0,
+            AlarmSearch = 0xec,
+            OverdriveSkip = 0x3c,
+            OverdriveMatch = 0x69,
         };
         
         /**
@@ -52,7 +234,53 @@ namespace Zhele
          * @retval false Fail reset (precense not detected)
          */
         static bool Reset();
+
+        /**
+         * @brief Sets bus speed
+         * 
+         * @details
+         * Devices are switched to overdrive by OverdriveSkipRom or OverdriveMatchRom only,
+         * reset at standard speed returns all devices to standard speed.
+         * 
+         * @param [in] speed Speed
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        static void SetSpeed(OneWireSpeed speed);
     
+        /**
+         * @brief Performs transaction (write bytes and then read bytes) with one DMA transfer
+         * 
+         * @details
+         * All bytes are expanded to bit-slots buffer once, then it is transmitted via one DMA transfer,
+         * received bits (line state) are decoded after completion.
+         * Line should be reset before transaction (if required by command).
+         * 
+         * @param [in] writeData Data to write
+         * @param [in] writeSize Write size
+         * @param [out] readData Output buffer
+         * @param [in] readSize Size to read
+         * 
+         * @retval true Success
+         * @retval false Transaction is too long (see MaxTransactionSize)
+         */
+        static bool Transaction(const void* writeData, uint8_t writeSize, void* readData = nullptr, uint8_t readSize = 0);
+
+        /**
+         * @brief Starts asynchronous transaction (write bytes and then read bytes) with one DMA transfer
+         * 
+         * @param [in] writeData Data to write
+         * @param [in] writeSize Write size
+         * @param [out] readData Output buffer (should be valid until callback is called)
+         * @param [in] readSize Size to read
+         * @param [in] callback Completion callback (receives read data)
+         * 
+         * @retval true Transaction was started
+         * @retval false Transaction is too long (see MaxTransactionSize)
+         */
+        static bool TransactionAsync(const void* writeData, uint8_t writeSize, void* readData, uint8_t readSize, TransferCallback callback);
+
 
         /**
          * @brief Writes byte to line
@@ -108,6 +336,34 @@ namespace Zhele
          *	Nothing
          */
         static void SkipRom();
+
+        /**
+         * @brief Switches all overdrive-capable devices (and bus) to overdrive speed
+         * 
+         * @details
+         * Resets line at standard speed and sends "Overdrive Skip ROM" command.
+         * After that devices stay in overdrive until standard speed reset, so any command
+         * (for example search) can follow overdrive reset. Devices without overdrive support
+         * ignore overdrive communication.
+         * 
+         * @retval true Precense bit was detected
+         * @retval false No precense bit was detected
+         */
+        static bool OverdriveSkipRom();
+
+        /**
+         * @brief Switches device with given ROM (and bus) to overdrive speed and selects it
+         * 
+         * @details
+         * Resets line at standard speed, sends "Overdrive Match ROM" command at standard speed
+         * and ROM at overdrive speed. Function command can follow immediately.
+         * 
+         * @param [in] rom 8-bytes array with device ROM
+         * 
+         * @retval true Precense bit was detected
+         * @retval false No precense bit was detected
+         */
+        static bool OverdriveMatchRom(const uint8_t rom[8]);
        
 
         /**
@@ -129,15 +385,60 @@ namespace Zhele
          * @brief Start new search.
          * 
          * @param [out] rom Address of found device.
+         * @param [in] alarm Search only devices with alarm condition (Alarm Search command)
          * 
-         * @todo Implement this method
+         * @retval true Device was found
+         * @retval false No devices
+         */
+        static bool SearchFirst(uint8_t* rom, bool alarm = false);
+
+        /**
+         * @brief Continue search (find next device)
          * 
-         * @returns
-         *	Nothing
+         * @param [out] rom Address of found device.
+         * @param [in] alarm Search only devices with alarm condition (Alarm Search command)
+         * 
+         * @retval true Device was found
+         * @retval false No more devices
          */
-        static void SearchFirst(uint8_t* rom)
-        {
-        }
+        static bool SearchNext(uint8_t* rom, bool alarm = false);
+
+        /**
+         * @brief Start new search of devices with given family code
+         * 
+         * @details
+         * Use SearchNext to find next device, search is completed when SearchNext returns
+         * false or device with other family is found.
+         * 
+         * @param [in] family Family code
+         * @param [out] rom Address of found device.
+         * 
+         * @retval true Device was found
+         * @retval false No devices of given family
+         */
+        static bool SearchFamily(uint8_t family, uint8_t* rom);
+
+        /**
+         * @brief Find all devices on line
+         * 
+         * @param [out] roms Found addresses
+         * @param [in] maxCount Max devices count
+         * @param [in] family Family code filter (0 - any family)
+         * @param [in] alarm Search only devices with alarm condition
+         * 
+         * @returns Found devices count
+         */
+        static uint8_t Enumerate(uint8_t (*roms)[8], uint8_t maxCount, uint8_t family = 0, bool alarm = false);
+
+        /**
+         * @brief Calculates one-wire CRC8 (Dallas/Maxim)
+         * 
+         * @param [in] data Data
+         * @param [in] size Data size
+         * 
+         * @returns CRC
+         */
+        static uint8_t Crc(const void* data, uint8_t size);
 
     private:
         /**
@@ -160,11 +461,59 @@ namespace Zhele
          *  Nothing
          */
         static void ConvertToBits(uint8_t byte, uint8_t* bits);
+
+        /**
+         * @brief Transaction DMA completion handler
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void OnTransactionComplete(void* data, unsigned size, bool success);
+
+        /**
+         * @brief Transmit prepared bit-slots and receive line state (in-place)
+         * 
+         * @param [in] count Slots count
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void ExchangeSlots(uint8_t count);
+
+        /**
+         * @brief Search step (Maxim AN187 algorithm)
+         * 
+         * @param [out] rom Found address
+         * @param [in] alarm Alarm search
+         * 
+         * @retval true Device was found
+         * @retval false No more devices
+         */
+        static bool SearchStep(uint8_t* rom, bool alarm);
        
     private:
-        // Dummy buffer for read operation
-        static constexpr uint8_t _readDummyBuffer[] = {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff};
+        // Bit-slots buffer: TX and RX at once (every byte is received only after it has been transmitted)
+        static uint8_t _slots[MaxTransactionSize * 8];
+        static uint8_t* _readData;
+        static uint8_t _writeSize;
+        static uint8_t _readSize;
+        static TransferCallback _callback;
+
+        // Search state
+        static uint8_t _searchRom[8];
+        static uint8_t _lastDiscrepancy;
+        static uint8_t _lastFamilyDiscrepancy;
+        static bool _lastDevice;
     };
+
+    /**
+     * @brief One-wire bus on half-duplex USART
+     * 
+     * @tparam _Usart USART
+     * @tparam _Pin Line pin (USART TX pin)
+     */
+    template<typename _Usart, typename _Pin>
+    using OneWire = BasicOneWire<OneWireUsartEngine<_Usart, _Pin>>;
 }
 
 #include "impl/one_wire.h"
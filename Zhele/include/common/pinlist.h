@@ -14,7 +14,10 @@
 #include "template_utils/type_list.h"
 #include "template_utils/data_type_selector.h"
 
+#include <stddef.h>
+#include <stdint.h>
 #include <type_traits>
+#include <utility>
 
 using namespace Zhele::TemplateUtils;
 
@@ -60,40 +63,209 @@ namespace Zhele
                 static const unsigned int value = ((1 << _Pins::Number) | ...);
             };
 
+            /**
+             * @brief Groups of pins with same shift (port pin number minus pinlist index)
+             */
+            template<unsigned _Count>
+            struct PinShiftGroups
+            {
+                int Shift[_Count]; ///< Shift from pinlist value to port value
+                uint32_t Mask[_Count]; ///< Pinlist value mask
+                unsigned Count; ///< Groups count
+            };
+
+            /**
+             * @brief Make pin shift groups
+             * 
+             * @param [in] indexes Pins indexes in pinlist
+             * @param [in] numbers Pins numbers in port
+             * 
+             * @returns Shift groups
+             */
+            template<unsigned _Count>
+            constexpr PinShiftGroups<_Count> MakePinShiftGroups(const unsigned (&indexes)[_Count], const unsigned (&numbers)[_Count])
+            {
+                PinShiftGroups<_Count> groups {};
+                for(unsigned i = 0; i < _Count; ++i)
+                {
+                    int shift = static_cast<int>(numbers[i]) - static_cast<int>(indexes[i]);
+                    unsigned group = 0;
+                    while(group < groups.Count && groups.Shift[group] != shift)
+                        ++group;
+                    if(group == groups.Count)
+                        groups.Shift[groups.Count++] = shift;
+                    groups.Mask[group] |= 1u << indexes[i];
+                }
+                return groups;
+            }
+
+            /**
+             * @brief Bit scatter table: value for each nibble of source value
+             */
+            template<typename _Type, unsigned _Nibbles>
+            struct PinScatterTable
+            {
+                _Type Values[_Nibbles][16]; ///< Destination values
+            };
+
+            /**
+             * @brief Make bit scatter table
+             * 
+             * @param [in] from Source bit positions
+             * @param [in] to Destination bit positions
+             * 
+             * @returns Scatter table
+             */
+            template<typename _Type, unsigned _Nibbles, unsigned _Count>
+            constexpr PinScatterTable<_Type, _Nibbles> MakePinScatterTable(const unsigned (&from)[_Count], const unsigned (&to)[_Count])
+            {
+                PinScatterTable<_Type, _Nibbles> table {};
+                for(unsigned nibble = 0; nibble < _Nibbles; ++nibble)
+                {
+                    for(unsigned value = 0; value < 16; ++value)
+                    {
+                        for(unsigned i = 0; i < _Count; ++i)
+                        {
+                            if(from[i] / 4 == nibble && (value & (1u << (from[i] % 4))) != 0)
+                                table.Values[nibble][value] |= static_cast<_Type>(1u << to[i]);
+                        }
+                    }
+                }
+                return table;
+            }
+
+            /**
+             * @brief Mask of source nibbles used by scatter
+             * 
+             * @param [in] from Source bit positions
+             * 
+             * @returns Nibbles mask
+             */
+            template<unsigned _Count>
+            constexpr unsigned UsedNibbles(const unsigned (&from)[_Count])
+            {
+                unsigned mask = 0;
+                for(unsigned i = 0; i < _Count; ++i)
+                    mask |= 1u << (from[i] / 4);
+                return mask;
+            }
+
+            /**
+             * @brief Returns count of set bits
+             * 
+             * @param [in] value Value
+             * 
+             * @returns Set bits count
+             */
+            constexpr unsigned BitsCount(unsigned value)
+            {
+                unsigned count = 0;
+                for(; value != 0; value &= value - 1)
+                    ++count;
+                return count;
+            }
+
+            /**
+             * @brief Shift value left (positive shift) or right (negative shift)
+             * 
+             * @tparam _Shift Shift
+             * 
+             * @param [in] value Value
+             * 
+             * @returns Shifted value
+             */
+            template<int _Shift>
+            constexpr uint32_t ShiftBits(uint32_t value)
+            {
+                if constexpr (_Shift >= 0)
+                    return value << _Shift;
+                else
+                    return value >> -_Shift;
+            }
+
             /**
              * @brief Class for convert values from value for pinlist to values for each port
+             * 
+             * @details
+             * Pins with same difference between port pin number and pinlist index (contiguous runs,
+             * 8/16-bit parallel bus for example) are converted by one shift-and-mask operation.
+             * If pins order is too scattered, constexpr nibble lookup tables are used instead,
+             * so conversion cost does not depend on pins order.
+             * 
+             * @tparam _PinList Pinlist
+             * @tparam _PortPins Pinlist pins of one port
              */
             template<typename...>
-            class PinListExpander {};
-            template<typename... _PortPins>
-            class PinListExpander<TypeList<_PortPins...>>
+            class PortValueMap {};
+            template<typename _PinList, typename... _PortPins>
+            class PortValueMap<_PinList, TypeList<_PortPins...>>
             {
+                static constexpr unsigned Count = sizeof...(_PortPins);
+                static constexpr unsigned ListNibbles = (Length<_PinList>::value + 3) / 4;
+                static constexpr unsigned Indexes[Count] = {TypeIndex<_PortPins, _PinList>::value...};
+                static constexpr unsigned Numbers[Count] = {_PortPins::Number...};
+
+                static constexpr PinShiftGroups<Count> Groups = MakePinShiftGroups(Indexes, Numbers);
+                static constexpr unsigned ExpandNibbles = UsedNibbles(Indexes);
+                static constexpr unsigned ExtractNibbles = UsedNibbles(Numbers);
+                // Table lookup costs about one shift-and-mask group per nibble
+                static constexpr bool UseExpandTable = Groups.Count > BitsCount(ExpandNibbles) + 1;
+                static constexpr bool UseExtractTable = Groups.Count > BitsCount(ExtractNibbles) + 1;
+
+                static constexpr PinScatterTable<NativePortBase::DataType, ListNibbles> ExpandTable
+                    = MakePinScatterTable<NativePortBase::DataType, ListNibbles>(Indexes, Numbers);
+                static constexpr PinScatterTable<uint32_t, 4> ExtractTable = MakePinScatterTable<uint32_t, 4>(Numbers, Indexes);
+
+                template<size_t... _Groups>
+                static uint32_t ExpandByShift(uint32_t value, std::index_sequence<_Groups...>);
+
+                template<size_t... _Groups>
+                static uint32_t ExtractByShift(uint32_t value, std::index_sequence<_Groups...>);
+
+                template<unsigned _UsedNibbles, typename _Type, unsigned _Nibbles, size_t... _Nibble>
+                static _Type Lookup(const PinScatterTable<_Type, _Nibbles>& table, uint32_t value, std::index_sequence<_Nibble...>);
             public:
                 /**
                  * @brief Expand pinlist value to one port's value (ODR)
                  * 
-                 * @tparam _PinList Pinlist
                  * @tparam _DataType Data type
                  * 
                  * @param value Pinlist value
                  * 
                  * @return NativePortBase::DataType value for specific port
                  */
-                template<typename _PinList, typename _DataType>
+                template<typename _DataType>
                 static NativePortBase::DataType ExpandPinlistValue(_DataType value);
 
                 /**
                  * @brief Extact pinlist value part from one port's value (IDR)
                  * 
-                 * @tparam _PinList Pinlist
                  * @tparam _DataType Data type
                  * 
                  * @param value Port value
                  * 
                  * @return _DataType Pinlist part value (for next OR operation)
                  */
-                template<typename _PinList, typename _DataType>
+                template<typename _DataType>
                 static _DataType ExtractPinlistValueFromPort(NativePortBase::DataType value);
+
+                /**
+                 * @brief Expand pinlist mask to port mask at compile time
+                 * 
+                 * @param mask Pinlist mask
+                 * 
+                 * @return Port pins mask
+                 */
+                static constexpr NativePortBase::DataType ExpandPinlistMask(uint32_t mask)
+                {
+                    NativePortBase::DataType result = 0;
+                    for (unsigned i = 0; i < Count; ++i)
+                    {
+                        if ((mask & (1u << Indexes[i])) != 0)
+                            result |= static_cast<NativePortBase::DataType>(1u << Numbers[i]);
+                    }
+                    return result;
+                }
             };
 
             /**
@@ -108,6 +280,12 @@ namespace Zhele
             template<typename _Port, typename _PinList, typename _DataType>
             _DataType GetPinlistValuePartFromPort();
 
+            /**
+             * @brief Target port`s mask for pinlist mask (compile time)
+             */
+            template<typename _Port, typename _PinList, uint32_t _Mask>
+            constexpr NativePortBase::DataType PinlistMaskForPort = PortValueMap<_PinList, PinsForPort<_Port, _PinList>>::ExpandPinlistMask(_Mask);
+
             /**
              * @brief Writer to ports
              * @details
@@ -254,7 +432,42 @@ namespace Zhele
                  */
                 template<typename _DataType>
                 static void AltFuncNumber(_DataType mask, uint8_t number);
-                
+
+                /**
+                 * @brief Template clones of configuration methods
+                 * @details
+                 * Port masks are calculated at compile time, ports without masked pins are not touched.
+                 */
+                template<uint32_t mask, NativePortBase::Configuration config>
+                static void SetConfiguration();
+
+                template<uint32_t mask, NativePortBase::Speed speed>
+                static void SetSpeed();
+
+                template<uint32_t mask, NativePortBase::PullMode mode>
+                static void SetPullMode();
+
+                template<uint32_t mask, NativePortBase::DriverType driver>
+                static void SetDriverType();
+
+                template<uint32_t mask, uint8_t number>
+                static void AltFuncNumber();
+
+                /**
+                 * @brief Set all pin attributes with mask
+                 * 
+                 * @tparam mask Mask
+                 * @tparam config Configuration
+                 * @tparam speed Speed
+                 * @tparam driver Driver type
+                 * @tparam pull Pull mode
+                 * @tparam number Alternate function number
+                 * 
+                 * @par Returns
+                 * 	Nothing
+                 */
+                template<uint32_t mask, NativePortBase::Configuration config, NativePortBase::Speed speed, NativePortBase::DriverType driver, NativePortBase::PullMode pull, uint8_t number>
+                static void Configure();
             };
         }
         /**
@@ -528,6 +741,40 @@ namespace Zhele
              */
             template<unsigned number>
             static void AltFuncNumber();
+
+            /**
+             * @brief Set all pin attributes at once
+             * @details
+             * Register images for each used port are calculated at compile time and every
+             * configuration register is written once (instead of one read-modify-write per attribute).
+             * 
+             * @tparam config Configuration
+             * @tparam speed Speed
+             * @tparam driver Driver type
+             * @tparam pull Pull mode
+             * @tparam number Alternate function number
+             * 
+             * @par Returns
+             * 	Nothing
+             */
+            template<Configuration config, Speed speed, DriverType driver = DriverType::PushPull, PullMode pull = PullMode::NoPull, unsigned number = 0>
+            static void Configure();
+
+            /**
+             * @brief Set all pin attributes with mask
+             * 
+             * @tparam mask Mask
+             * @tparam config Configuration
+             * @tparam speed Speed
+             * @tparam driver Driver type
+             * @tparam pull Pull mode
+             * @tparam number Alternate function number
+             * 
+             * @par Returns
+             * 	Nothing
+             */
+            template<DataType mask, Configuration config, Speed speed, DriverType driver, PullMode pull, unsigned number>
+            static void ConfigureMasked();
             
 
             /**
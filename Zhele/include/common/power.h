@@ -0,0 +1,191 @@
+/**
+ * @file
+ * Implements low-power waiting
+ * 
+ * @author Alexey Zhelonkin
+ * @date 2023
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_POWER_COMMON_H
+#define ZHELE_POWER_COMMON_H
+
+#include <clock.h>
+
+#include <stdint.h>
+
+#if !defined (ZHELE_STOP_WAKE_LATENCY_US)
+    /// Stop mode wake up latency (including system clock restore), us
+    #define ZHELE_STOP_WAKE_LATENCY_US 100
+#endif
+
+namespace Zhele::Power
+{
+    /**
+     * @brief Implements low-power waiting for asynchronous operations completion
+     * 
+     * @details
+     * Instead of busy-wait loop (while(!complete);) core sleeps until interrupt (any completion is signaled by interrupt).
+     * Sleep mode (WFI) is used by default. Stop mode (STM32L4) is used if wake latency budget
+     * is not less than ZHELE_STOP_WAKE_LATENCY_US, there is no active DMA channels and Stop mode is not blocked
+     * (some peripherals do not work in Stop mode: drivers or user code should call BlockStop while it is active).
+     * System clock source is restored after wake up (before interrupt handler is called).
+     * Waiting should be completed by interrupt: polling of peripheral flags without interrupt is not allowed.
+     */
+    class LowPower
+    {
+    public:
+    #if defined (PWR_CR1_LPMS)
+        /**
+         * @brief Stop mode
+         */
+        enum class StopMode : uint32_t
+        {
+            Stop1 = PWR_CR1_LPMS_STOP1, ///< Stop 1 (default)
+            Stop2 = PWR_CR1_LPMS_STOP2, ///< Stop 2 (lowest consumption, only LPUART1, LPTIM1, I2C3, RTC and comparators work)
+        };
+
+        /**
+         * @brief Select Stop mode
+         * 
+         * @details
+         * Peripherals that do not work in selected Stop mode (USART1 in Stop 2 for example)
+         * should block Stop mode (see BlockStop) while they are active.
+         * 
+         * @param [in] mode Stop mode
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void SetStopMode(StopMode mode);
+    #endif
+
+        /**
+         * @brief Set allowed wake up latency
+         * 
+         * @param [in] us Latency (us), 0 disables Stop mode
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void SetWakeLatencyBudget(unsigned us);
+
+        /**
+         * @brief Forbid Stop mode (nested calls are counted)
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void BlockStop();
+
+        /**
+         * @brief Allow Stop mode (cancels one BlockStop call)
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void UnblockStop();
+
+        /**
+         * @brief Enter low power mode until interrupt
+         * 
+         * @details
+         * Should be called with disabled interrupts (PRIMASK) after waiting condition check,
+         * so event occured after check will not be lost (pending interrupt wakes core up).
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Idle();
+
+        /**
+         * @brief Wait for condition in low power mode
+         * 
+         * @tparam _Condition Condition (callable, returns bool)
+         * 
+         * @param [in] condition Condition
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        template<typename _Condition>
+        static void WaitFor(_Condition condition);
+
+        /**
+         * @brief Wait for flag in low power mode
+         * 
+         * @param [in] flag Flag (set by interrupt handler or callback)
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void WaitFor(const volatile bool& flag);
+
+        /**
+         * @brief Wait for event (WFE)
+         * 
+         * @details
+         * Core sleeps (Stop mode is not used) until event: EXTI line event (see Exti::EnableEvent),
+         * SEV instruction (see SendEvent), any interrupt or pending disabled interrupt
+         * (if SetEventOnPending is enabled). Event occured before call is not lost
+         * (WFE returns immediately and clears event register), but it can return without new event,
+         * so it should be called in a loop (see WaitForEvent with condition).
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void WaitForEvent();
+
+        /**
+         * @brief Wait for condition by events (WFE)
+         * 
+         * @details
+         * Tight waiting for external signal (pin level with EXTI event enabled, for example):
+         * condition is checked after every event, no interrupt handler is called.
+         * 
+         * @tparam _Condition Condition (callable, returns bool)
+         * 
+         * @param [in] condition Condition
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        template<typename _Condition>
+        static void WaitForEvent(_Condition condition);
+
+        /**
+         * @brief Send event (SEV), wakes core up from WFE
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void SendEvent();
+
+        /**
+         * @brief Enable or disable event on pending interrupt (SEVONPEND)
+         * 
+         * @details
+         * If enabled, pending interrupt wakes core up from WFE even if it is disabled in NVIC.
+         * 
+         * @param [in] enable Enable flag
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void SetEventOnPending(bool enable);
+
+    private:
+        static bool StopAllowed();
+        static void EnterStop();
+
+    #if defined (PWR_CR1_LPMS)
+        static StopMode _stopMode;
+    #endif
+        static unsigned _wakeLatencyBudget;
+        static volatile unsigned _stopBlockers;
+    };
+}
+
+#include "impl/power.h"
+
+#endif //! ZHELE_POWER_COMMON_H
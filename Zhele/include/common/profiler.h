@@ -0,0 +1,236 @@
+/**
+ * @file
+ * Implements stack watermark and interrupts CPU load profiling
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_PROFILER_COMMON_H
+#define ZHELE_PROFILER_COMMON_H
+
+#include <clock.h>
+
+#include <stdint.h>
+
+/*
+ * Profiler options:
+ *  - ZHELE_STACK_TOP - stack top address (default _estack symbol from linker script);
+ *  - ZHELE_STACK_SIZE - monitored stack size (default _Min_Stack_Size symbol from linker script).
+ */
+#if !defined (ZHELE_STACK_TOP)
+    extern "C" uint32_t _estack;
+    #define ZHELE_STACK_TOP (reinterpret_cast<uintptr_t>(&_estack))
+#endif
+#if !defined (ZHELE_STACK_SIZE)
+    extern "C" uint32_t _Min_Stack_Size;
+    #define ZHELE_STACK_SIZE (reinterpret_cast<uintptr_t>(&_Min_Stack_Size))
+#endif
+
+namespace Zhele
+{
+    /**
+     * @brief Main stack watermark
+     *
+     * @details
+     * Fill stack with pattern at startup (as early as possible), then Used returns max stack usage
+     * (by thread code and all interrupts, they share main stack) since fill.
+     */
+    class StackWatermark
+    {
+        static const uint32_t Pattern = 0xa5a5a5a5;
+        static const uintptr_t Margin = 64;
+    public:
+        /**
+         * @brief Fills unused part of stack with pattern
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Fill();
+
+        /**
+         * @brief Returns max stack usage since fill (high-water mark)
+         *
+         * @returns Used stack size (in bytes)
+         */
+        static uintptr_t Used();
+
+        /**
+         * @brief Returns never used stack size
+         *
+         * @returns Free stack size (in bytes)
+         */
+        static uintptr_t Free();
+
+        /**
+         * @brief Returns monitored stack size
+         *
+         * @returns Stack size (in bytes)
+         */
+        static uintptr_t Size();
+
+    private:
+        static uint32_t* Bottom();
+        static uint32_t* Top();
+    };
+
+#if defined (DWT)
+    /**
+     * @brief Interrupts CPU load meter
+     *
+     * @details
+     * Measures time (CPU cycles, DWT CYCCNT) spent in profiled interrupt handlers.
+     * Nested interrupts are excluded from preempted handler`s time, so every handler is charged its own time only.
+     * Measurement window starts on Reset, call Reset (or read loads) at least once per CYCCNT period
+     * (2^32 cycles, about 60 seconds at 72 MHz).
+     *
+     * Profile handler with ZHELE_ISR_PROFILE(IRQn) macro in the beginning of handler:
+     * @code
+     * extern "C" void USART1_IRQHandler()
+     * {
+     *     ZHELE_ISR_PROFILE(USART1_IRQn);
+     *     ...
+     * }
+     * @endcode
+     */
+    class IsrLoadMeter
+    {
+    public:
+        /**
+         * @brief Enables cycles counter and starts measurement window
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Enable();
+
+        /**
+         * @brief Starts new measurement window (resets total, per-interrupt counters are reset by IsrProfile::Reset)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Reset();
+
+        /**
+         * @brief Returns measurement window duration
+         *
+         * @returns Cycles since window start
+         */
+        static uint32_t WindowCycles();
+
+        /**
+         * @brief Returns total load of all profiled interrupts
+         *
+         * @returns Load in permille (1000 means CPU is busy by interrupts all time)
+         */
+        static uint32_t Load();
+
+        /**
+         * @brief Converts cycles in window to permille load
+         *
+         * @param [in] cycles Cycles
+         *
+         * @returns Load in permille
+         */
+        static uint32_t ToLoad(uint64_t cycles);
+
+        /**
+         * @brief Marks handler entry
+         *
+         * @returns Context for Exit
+         */
+        static uint64_t Enter();
+
+        /**
+         * @brief Marks handler exit
+         *
+         * @param [in] context Entry context
+         *
+         * @returns Cycles spent in handler (nested handlers excluded)
+         */
+        static uint32_t Exit(uint64_t context);
+
+    private:
+        static uint32_t _windowStart;
+        static uint64_t _totalCycles;
+        static uint32_t _nestedCycles;
+    };
+
+    /**
+     * @brief Single interrupt profile
+     *
+     * @tparam _IRQNumber Interrupt number
+     */
+    template<IRQn_Type _IRQNumber>
+    class IsrProfile
+    {
+    public:
+        /**
+         * @brief Handler scope (measures time from construction to destruction)
+         */
+        class Scope
+        {
+        public:
+            Scope() : _context(IsrLoadMeter::Enter()) {}
+            ~Scope() { IsrProfile::Account(IsrLoadMeter::Exit(_context)); }
+        private:
+            uint64_t _context;
+        };
+
+        /**
+         * @brief Returns handler calls count
+         *
+         * @returns Calls count
+         */
+        static uint32_t Calls() { return _calls; }
+
+        /**
+         * @brief Returns max handler duration
+         *
+         * @returns Max cycles per call
+         */
+        static uint32_t MaxCycles() { return _maxCycles; }
+
+        /**
+         * @brief Returns total handler time
+         *
+         * @returns Cycles
+         */
+        static uint64_t Cycles() { return _cycles; }
+
+        /**
+         * @brief Returns handler load in current window
+         *
+         * @returns Load in permille
+         */
+        static uint32_t Load() { return IsrLoadMeter::ToLoad(_cycles); }
+
+        /**
+         * @brief Resets counters
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Reset();
+
+    private:
+        static void Account(uint32_t cycles);
+
+        static uint32_t _calls;
+        static uint32_t _maxCycles;
+        static uint64_t _cycles;
+    };
+#endif
+}
+
+#if defined (DWT)
+    /// Profiles interrupt handler (place in the beginning of handler)
+    #define ZHELE_ISR_PROFILE(IRQ_NUMBER) ::Zhele::IsrProfile<IRQ_NUMBER>::Scope zheleIsrProfileScope
+#endif
+
+#include "impl/profiler.h"
+
+#endif //! ZHELE_PROFILER_COMMON_H
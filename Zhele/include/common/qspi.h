@@ -0,0 +1,369 @@
+/**
+ * @file
+ * Implements QUADSPI
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_QSPI_COMMON_H
+#define ZHELE_QSPI_COMMON_H
+
+#include "ioreg.h"
+#include "nvic.h"
+#include "template_utils/data_transfer.h"
+
+#include <clock.h>
+#include <iopins.h>
+#include <pinlist.h>
+
+namespace Zhele
+{
+    class QspiBase
+    {
+    public:
+        /**
+         * @brief Command phase lines
+         */
+        enum class Lines : uint8_t
+        {
+            None = 0, ///< Phase is skipped
+            Single = 1, ///< Single line (IO0/IO1 as MOSI/MISO)
+            Dual = 2, ///< Two lines
+            Quad = 3, ///< Four lines
+        };
+
+        /**
+         * @brief Address (and alternate bytes) size
+         */
+        enum class AddressSize : uint8_t
+        {
+            Address8Bit = 0, ///< 8-bit
+            Address16Bit = 1, ///< 16-bit
+            Address24Bit = 2, ///< 24-bit
+            Address32Bit = 3, ///< 32-bit
+        };
+
+        /**
+         * @brief Flash command description
+         */
+        struct Command
+        {
+            uint8_t Instruction; ///< Instruction
+            Lines InstructionLines = Lines::Single; ///< Instruction phase lines
+            Lines AddressLines = Lines::None; ///< Address phase lines
+            AddressSize Address = AddressSize::Address24Bit; ///< Address size
+            Lines AlternateLines = Lines::None; ///< Alternate bytes phase lines (mode bits)
+            AddressSize AlternateSize = AddressSize::Address8Bit; ///< Alternate bytes size
+            uint32_t Alternate = 0; ///< Alternate bytes
+            uint8_t DummyCycles = 0; ///< Dummy cycles (0...31)
+            Lines DataLines = Lines::None; ///< Data phase lines
+            bool SendInstructionOnce = false; ///< Send instruction only for the first memory mapped access (continuous read mode)
+        };
+
+        /// Memory mapped region start address
+        static const uint32_t MemoryMappedBase = 0x90000000;
+
+    protected:
+        static const uint32_t IndirectWriteMode = 0; ///< Indirect write functional mode
+        static const uint32_t IndirectReadMode = 1; ///< Indirect read functional mode
+        static const uint32_t AutoPollingMode = 2; ///< Status polling functional mode
+        static const uint32_t MemoryMappedMode = 3; ///< Memory mapped functional mode
+
+        /**
+         * @brief Returns CCR value for command
+         *
+         * @param [in] command Command
+         * @param [in] mode Functional mode (FMODE bits)
+         *
+         * @returns CCR value
+         */
+        static constexpr uint32_t CommandConfig(const Command& command, uint32_t mode);
+    };
+
+    namespace Private
+    {
+        /**
+         * @brief QUADSPI (quad SPI flash interface)
+         *
+         * @details
+         * Indirect mode executes flash commands (polling or DMA transfers), status polling mode waits
+         * flash status by hardware (it does not load CPU and bus), memory mapped mode maps flash
+         * to MemoryMappedBase, so assets (fonts, images, lookup tables) can be read as const data
+         * directly from flash with quad speed. Any indirect command exits memory mapped mode,
+         * so mapped data should not be accessed until EnableMemoryMapped is called again.
+         *
+         * @tparam _Regs QUADSPI registers
+         * @tparam _ClockCtrl QUADSPI clock control
+         * @tparam _ClkPins Clock pins
+         * @tparam _NcsPins Chip select pins
+         * @tparam _Io0Pins IO0 pins
+         * @tparam _Io1Pins IO1 pins
+         * @tparam _Io2Pins IO2 pins
+         * @tparam _Io3Pins IO3 pins
+         * @tparam _Dma DMA channel (both directions)
+         * @tparam _IRQNumber IRQ number
+         */
+        template<typename _Regs, typename _ClockCtrl, typename _ClkPins, typename _NcsPins, typename _Io0Pins, typename _Io1Pins, typename _Io2Pins, typename _Io3Pins, typename _Dma, IRQn_Type _IRQNumber>
+        class Qspi : public QspiBase
+        {
+        public:
+            /**
+             * @brief Status polling complete callback
+             */
+            using MatchCallback = TemplateUtils::InplaceFunction<void(uint8_t status)>;
+
+            /**
+             * @brief Init QUADSPI
+             *
+             * @param [in] frequence Max clock frequence (prescaler divides AHB clock)
+             * @param [in] flashSize Flash size (in bytes, power of 2)
+             * @param [in] clockMode3 Clock is high while chip select is high (SPI mode 3), otherwise mode 0
+             * @param [in] chipSelectHighCycles Min chip select high time between commands (in clock cycles, 1...8)
+             *
+             * @par Returns
+             *	Nothing
+             */
+            static void Init(uint32_t frequence, uint32_t flashSize, bool clockMode3 = false, uint8_t chipSelectHighCycles = 2);
+
+            /**
+             * @brief Disable QUADSPI
+             *
+             * @par Returns
+             *	Nothing
+             */
+            static void Disable();
+
+            /**
+             * @brief Returns interface state
+             *
+             * @retval true Command is in progress (or memory mapped mode is enabled)
+             * @retval false Interface is free
+             */
+            static bool Busy();
+
+            /**
+             * @brief Aborts current command (and exits memory mapped mode)
+             *
+             * @par Returns
+             *	Nothing
+             */
+            static void Abort();
+
+            /**
+             * @brief Sends command without data (write enable, erase)
+             *
+             * @param [in] command Command
+             * @param [in] address Address (ignored if command has no address)
+             *
+             * @retval true Success
+             * @retval false Transfer error
+             */
+            static bool Execute(const Command& command, uint32_t address = 0);
+
+            /**
+             * @brief Executes command and reads data (CPU polls FIFO)
+             *
+             * @param [in] command Command
+             * @param [in] address Address
+             * @param [out] data Destination
+             * @param [in] size Data size
+             *
+             * @retval true Success
+             * @retval false Transfer error
+             */
+            static bool Read(const Command& command, uint32_t address, void* data, uint32_t size);
+
+            /**
+             * @brief Executes command and writes data (CPU polls FIFO)
+             *
+             * @param [in] command Command
+             * @param [in] address Address
+             * @param [in] data Data
+             * @param [in] size Data size
+             *
+             * @retval true Success
+             * @retval false Transfer error
+             */
+            static bool Write(const Command& command, uint32_t address, const void* data, uint32_t size);
+
+            /**
+             * @brief Executes command and reads data by DMA
+             *
+             * @details
+             * Data is transferred by words if buffer and size are word-aligned.
+             *
+             * @param [in] command Command
+             * @param [in] address Address
+             * @param [out] data Destination
+             * @param [in] size Data size (up to 65535 bytes or words)
+             * @param [in] callback Transfer complete callback
+             *
+             * @par Returns
+             *	Nothing
+             */
+            static void ReadAsync(const Command& command, uint32_t address, void* data, uint32_t size, TransferCallback callback = nullptr);
+
+            /**
+             * @brief Executes command and writes data by DMA
+             *
+             * @details
+             * Data is transferred by words if buffer and size are word-aligned.
+             *
+             * @param [in] command Command
+             * @param [in] address Address
+             * @param [in] data Data
+             * @param [in] size Data size (up to 65535 bytes or words)
+             * @param [in] callback Transfer complete callback (is called when all data is sent to flash)
+             *
+             * @par Returns
+             *	Nothing
+             */
+            static void WriteAsync(const Command& command, uint32_t address, const void* data, uint32_t size, TransferCallback callback = nullptr);
+
+            /**
+             * @brief Waits for status match, status is polled by QUADSPI
+             *
+             * @param [in] command Read status command (with single data byte)
+             * @param [in] mask Status mask
+             * @param [in] match Expected value of masked status
+             * @param [in] interval Poll interval (in clock cycles)
+             *
+             * @returns Status
+             */
+            static uint8_t WaitStatus(const Command& command, uint8_t mask, uint8_t match, uint16_t interval = 16);
+
+            /**
+             * @brief Starts background status polling by QUADSPI
+             *
+             * @details
+             * Callback is called from QUADSPI interrupt when masked status is matched
+             * (for example, when program or erase is completed).
+             *
+             * @param [in] command Read status command (with single data byte)
+             * @param [in] mask Status mask
+             * @param [in] match Expected value of masked status
+             * @param [in] callback Status match callback
+             * @param [in] interval Poll interval (in clock cycles)
+             *
+             * @par Returns
+             *	Nothing
+             */
+            static void WaitStatusAsync(const Command& command, uint8_t mask, uint8_t match, MatchCallback callback, uint16_t interval = 16);
+
+            /**
+             * @brief Enables memory mapped mode
+             *
+             * @param [in] readCommand Read command (usually quad IO fast read)
+             * @param [in] timeout Chip select is released after such count of idle clock cycles (0 - keep selected, flash stays in prefetch)
+             *
+             * @par Returns
+             *	Nothing
+             */
+            static void EnableMemoryMapped(const Command& readCommand, uint16_t timeout = 0);
+
+            /**
+             * @brief Returns memory mapped mode state
+             *
+             * @retval true Memory mapped mode is enabled
+             * @retval false Interface is in indirect mode
+             */
+            static bool MemoryMapped();
+
+            /**
+             * @brief Returns pointer to memory mapped flash data
+             *
+             * @tparam T Data type
+             *
+             * @param [in] address Flash address
+             *
+             * @returns Pointer to data
+             */
+            template<typename T = uint8_t>
+            static const T* Data(uint32_t address = 0)
+            {
+                return reinterpret_cast<const T*>(MemoryMappedBase + address);
+            }
+
+            /**
+             * @brief Interrupt handler (status match)
+             *
+             * @par Returns
+             *	Nothing
+             */
+            static void IrqHandler();
+
+            /**
+             * @brief Select pins
+             *
+             * @param [in] clkPinNumber CLK pin number
+             * @param [in] ncsPinNumber NCS pin number
+             * @param [in] io0PinNumber IO0 pin number
+             * @param [in] io1PinNumber IO1 pin number
+             * @param [in] io2PinNumber IO2 pin number (-1 for dual mode)
+             * @param [in] io3PinNumber IO3 pin number (-1 for dual mode)
+             *
+             * @par Returns
+             *	Nothing
+             */
+            static void SelectPins(int8_t clkPinNumber, int8_t ncsPinNumber, int8_t io0PinNumber, int8_t io1PinNumber, int8_t io2PinNumber = -1, int8_t io3PinNumber = -1);
+
+            /**
+             * @brief Select pins (template clone)
+             *
+             * @tparam clkPinNumber CLK pin number
+             * @tparam ncsPinNumber NCS pin number
+             * @tparam io0PinNumber IO0 pin number
+             * @tparam io1PinNumber IO1 pin number
+             * @tparam io2PinNumber IO2 pin number (-1 for dual mode)
+             * @tparam io3PinNumber IO3 pin number (-1 for dual mode)
+             *
+             * @par Returns
+             *	Nothing
+             */
+            template<int8_t clkPinNumber, int8_t ncsPinNumber, int8_t io0PinNumber, int8_t io1PinNumber, int8_t io2PinNumber = -1, int8_t io3PinNumber = -1>
+            static void SelectPins();
+
+            /**
+             * @brief Select pins (template clone, params are TPin instances)
+             *
+             * @tparam ClkPin CLK pin
+             * @tparam NcsPin NCS pin
+             * @tparam Io0Pin IO0 pin
+             * @tparam Io1Pin IO1 pin
+             * @tparam Io2Pin IO2 pin (IO::NullPin for dual mode)
+             * @tparam Io3Pin IO3 pin (IO::NullPin for dual mode)
+             *
+             * @par Returns
+             *	Nothing
+             */
+            template<typename ClkPin, typename NcsPin, typename Io0Pin, typename Io1Pin, typename Io2Pin = IO::NullPin, typename Io3Pin = IO::NullPin>
+            static void SelectPins();
+
+        private:
+            static void ExitMemoryMapped();
+            static void Start(const Command& command, uint32_t mode, uint32_t address, uint32_t size);
+            static bool Finish();
+            static void StartDma(const Command& command, uint32_t mode, uint32_t address, void* data, uint32_t size, TransferCallback callback);
+            static void OnDmaComplete(void* data, unsigned size, bool success);
+
+            static TransferCallback _callback;
+            static MatchCallback _matchCallback;
+            static volatile bool _memoryMapped;
+        };
+
+        template<typename _Regs, typename _ClockCtrl, typename _ClkPins, typename _NcsPins, typename _Io0Pins, typename _Io1Pins, typename _Io2Pins, typename _Io3Pins, typename _Dma, IRQn_Type _IRQNumber>
+        TransferCallback Qspi<_Regs, _ClockCtrl, _ClkPins, _NcsPins, _Io0Pins, _Io1Pins, _Io2Pins, _Io3Pins, _Dma, _IRQNumber>::_callback;
+
+        template<typename _Regs, typename _ClockCtrl, typename _ClkPins, typename _NcsPins, typename _Io0Pins, typename _Io1Pins, typename _Io2Pins, typename _Io3Pins, typename _Dma, IRQn_Type _IRQNumber>
+        typename Qspi<_Regs, _ClockCtrl, _ClkPins, _NcsPins, _Io0Pins, _Io1Pins, _Io2Pins, _Io3Pins, _Dma, _IRQNumber>::MatchCallback Qspi<_Regs, _ClockCtrl, _ClkPins, _NcsPins, _Io0Pins, _Io1Pins, _Io2Pins, _Io3Pins, _Dma, _IRQNumber>::_matchCallback;
+
+        template<typename _Regs, typename _ClockCtrl, typename _ClkPins, typename _NcsPins, typename _Io0Pins, typename _Io1Pins, typename _Io2Pins, typename _Io3Pins, typename _Dma, IRQn_Type _IRQNumber>
+        volatile bool Qspi<_Regs, _ClockCtrl, _ClkPins, _NcsPins, _Io0Pins, _Io1Pins, _Io2Pins, _Io3Pins, _Dma, _IRQNumber>::_memoryMapped = false;
+    }
+}
+
+#include "impl/qspi.h"
+
+#endif //! ZHELE_QSPI_COMMON_H
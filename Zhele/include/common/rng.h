@@ -0,0 +1,131 @@
+/**
+ * @file
+ * Implements hardware random number generator
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_RNG_COMMON_H
+#define ZHELE_RNG_COMMON_H
+
+#include <clock.h>
+#include "nvic.h"
+
+#include <stdint.h>
+
+#if defined (RNG)
+namespace Zhele
+{
+    /**
+     * @brief Hardware random number generator with entropy pool
+     *
+     * @details
+     * RNG interrupt keeps pool filled in background, so random word is taken from pool in constant time
+     * (generation takes 40 RNG clock cycles). Interrupt is disabled while pool is full.
+     * First word after start and repeated words are discarded (continuous test), seed error restarts
+     * generator, clock error is counted (generation continues after clock is fixed).
+     * RNG clock (48 MHz for stm32l4: CLK48 source should be configured by application) should be
+     * not less than HCLK / 16.
+     *
+     * @tparam _PoolSize Pool size (words, power of two up to 128)
+     */
+    template<uint8_t _PoolSize = 8>
+    class HardwareRng
+    {
+        static_assert(_PoolSize >= 2 && _PoolSize <= 128 && (_PoolSize & (_PoolSize - 1)) == 0, "Pool size should be power of two (up to 128).");
+
+        /// RNG IRQ (HASH_RNG_IRQn or RNG_IRQn, the same for all series)
+        static const IRQn_Type IRQn = static_cast<IRQn_Type>(80);
+    public:
+        /**
+         * @brief Enables RNG and starts pool filling
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Init();
+
+        /**
+         * @brief Stops RNG (pool content is kept)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Disable();
+
+        /**
+         * @brief Returns random word from pool
+         *
+         * @param [out] value Random word
+         *
+         * @retval true Success
+         * @retval false Pool is empty
+         */
+        static bool TryGet(uint32_t& value);
+
+        /**
+         * @brief Returns random word (waits for generation if pool is empty)
+         *
+         * @details
+         * RNG should be started by Init.
+         *
+         * @returns Random word
+         */
+        static uint32_t Get();
+
+        /**
+         * @brief Returns random value in range
+         *
+         * @details
+         * Value is scaled by multiplication (bias does not exceed bound / 2^32),
+         * it is suitable for backoff delays and slot selection.
+         *
+         * @param [in] bound Upper bound (exclusive)
+         *
+         * @returns Random value from 0 to bound - 1
+         */
+        static uint32_t Range(uint32_t bound);
+
+        /**
+         * @brief Returns pool words count
+         *
+         * @returns Available words
+         */
+        static unsigned Available();
+
+        /**
+         * @brief Returns seed and clock errors count
+         *
+         * @returns Errors count
+         */
+        static uint32_t Errors();
+
+        /**
+         * @brief RNG IRQ handler. Call it from HASH_RNG_IRQHandler (RNG_IRQHandler)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void IrqHandler();
+
+    private:
+        static void Start();
+
+        static uint32_t _pool[_PoolSize];
+        static volatile uint8_t _head;
+        static volatile uint8_t _tail;
+        static uint32_t _last;
+        static bool _hasLast;
+        static volatile uint32_t _errors;
+    };
+
+    /// Hardware random number generator with default pool
+    using Rng = HardwareRng<>;
+}
+#endif
+
+#include "impl/rng.h"
+
+#endif //! ZHELE_RNG_COMMON_H
@@ -0,0 +1,203 @@
+/**
+ * @file
+ * Implements internal RTC
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_RTC_COMMON_H
+#define ZHELE_RTC_COMMON_H
+
+#include <clock.h>
+#include "nvic.h"
+
+#include <stdint.h>
+
+namespace Zhele::Timers
+{
+    /**
+     * @brief Internal RTC (backup domain real-time clock)
+     *
+     * @details
+     * RTC is clocked by LSE (or LSI) and keeps running in Stop and Standby modes and
+     * during reset (if backup domain is powered), so Init does not reset running clock.
+     * Stm32f1 has 32-bit seconds counter (time format is defined by application),
+     * other series have BCD calendar. Timestamp is seconds and fraction of second
+     * (prescaler counter, 1/32768 s with LSE for stm32f1 and 1/256 s for other series).
+     * Wakeup timer wakes MCU periodically from Stop mode (EXTI line of RTC wakeup is configured).
+     * Stm32f1 has no wakeup timer, alarm is rearmed by IrqHandler instead (period is rounded to seconds).
+     */
+    class Rtc
+    {
+    public:
+        /// RTC clock source
+        enum class ClockSource : uint8_t
+        {
+            Lse, ///< External 32768 Hz crystal (accurate, works without main power)
+            Lsi ///< Internal low-speed oscillator (inaccurate)
+        };
+
+        /// Calendar date and time
+        struct DateTime
+        {
+            uint8_t Seconds; ///< Seconds, from 00 to 59
+            uint8_t Minutes; ///< Minutes, from 00 to 59
+            uint8_t Hours; ///< Hours, 24 hours mode, from 00 to 23
+            uint8_t Weekday; ///< Day in a week, from 1 (Monday) to 7
+            uint8_t Day; ///< Day in a month, from 1 to 31
+            uint8_t Month; ///< Month in a year, from 1 to 12
+            uint8_t Year; ///< Year, from 00 (2000) to 99 (2099)
+        };
+
+        /// Timestamp
+        struct Timestamp
+        {
+            uint32_t Seconds; ///< Seconds (counter for stm32f1, seconds since 2000-01-01 for calendar)
+            uint16_t Subseconds; ///< Fraction of second (in 1 / SubsecondRate units)
+        };
+
+        /// Wakeup callback (it is called from RTC interrupt)
+        using WakeupCallback = void(*)();
+
+        /**
+         * @brief Init RTC
+         *
+         * @details
+         * Enables backup domain access, starts clock source and RTC.
+         * Running RTC (after reset) is not reinitialized, time is kept.
+         *
+         * @param [in] source Clock source
+         *
+         * @retval true RTC is running
+         * @retval false Clock source has not been started
+         */
+        static bool Init(ClockSource source = ClockSource::Lse);
+
+        /**
+         * @brief Returns RTC clock frequency
+         *
+         * @returns Frequency (Hz)
+         */
+        static uint32_t ClockFreq();
+
+        /**
+         * @brief Returns subseconds rate
+         *
+         * @returns Subseconds count per second
+         */
+        static uint32_t SubsecondRate();
+
+    #if defined (RTC_CRL_RSF)
+        /**
+         * @brief Returns seconds counter
+         *
+         * @returns Counter value
+         */
+        static uint32_t GetCounter();
+
+        /**
+         * @brief Set seconds counter
+         *
+         * @param [in] counter Counter value
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void SetCounter(uint32_t counter);
+    #else
+        /**
+         * @brief Returns calendar date and time
+         *
+         * @returns Date and time
+         */
+        static DateTime GetDateTime();
+
+        /**
+         * @brief Set calendar date and time
+         *
+         * @param [in] dateTime Date and time
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void SetDateTime(const DateTime& dateTime);
+    #endif
+
+        /**
+         * @brief Returns current timestamp (no I2C or other bus traffic)
+         *
+         * @returns Timestamp
+         */
+        static Timestamp GetTimestamp();
+
+        /**
+         * @brief Start periodic wakeup timer
+         *
+         * @details
+         * Period resolution is 1/2048 s (with LSE) up to 32 s and 1 s for longer periods
+         * (stm32f1: 1 s for all periods).
+         *
+         * @param [in] periodMs Period (ms)
+         * @param [in] callback Wakeup callback (optional)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void StartWakeupTimer(uint32_t periodMs, WakeupCallback callback = nullptr);
+
+        /**
+         * @brief Stop wakeup timer
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void StopWakeupTimer();
+
+        /**
+         * @brief Set smooth calibration
+         *
+         * @details
+         * Clock is corrected by masking (or adding) pulses, step is 0.954 ppm.
+         * Stm32f1 can only slow clock down (from 0 to -121 ppm).
+         *
+         * @param [in] ppm Correction (parts per million, positive value speeds clock up)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void SetCalibration(int16_t ppm);
+
+        /**
+         * @brief Wakeup IRQ handler. Call it from RTC_WKUP_IRQHandler (RTC_Alarm_IRQHandler for stm32f1)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void IrqHandler();
+
+    private:
+        static void EnableBackupAccess();
+        static bool StartClockSource(ClockSource source);
+        static void WaitSync();
+        static void EnableWakeupExti(bool enable);
+    #if defined (RTC_CRL_RSF)
+        static void WaitWrite();
+        static void SetAlarm(uint32_t alarm);
+    #else
+        static void Unlock();
+        static void Lock();
+        static constexpr uint8_t FromBcd(uint32_t value);
+        static constexpr uint32_t ToBcd(uint8_t value);
+        static constexpr uint32_t DaysSince2000(uint8_t year, uint8_t month, uint8_t day);
+    #endif
+
+        static WakeupCallback _wakeupCallback;
+        static uint32_t _wakeupPeriod;
+    };
+}
+
+#include "impl/rtc.h"
+
+#endif //! ZHELE_RTC_COMMON_H
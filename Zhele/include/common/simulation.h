@@ -0,0 +1,288 @@
+/**
+ * @file
+ * @brief Host-side simulation of peripheral registers
+ *
+ * @details
+ * If ZHELE_HOST_SIMULATION is defined, register wrappers (ioreg.h) access simulated register file
+ * instead of fixed addresses, so library code can be unit-tested and benchmarked on host.
+ * Host build needs MCU header usable on host (core intrinsics stubbed). Direct CMSIS accesses
+ * (RCC->..., NVIC functions) are not remapped.
+ *
+ * @code
+ * class GpioaModel : public Zhele::Simulation::PeripheralModel
+ * {
+ * public:
+ *     GpioaModel() : PeripheralModel(GPIOA_BASE, 0x400) {}
+ *     void OnAccess(uintptr_t address) override { Register(offsetof(GPIO_TypeDef, IDR)) = 0x0001; }
+ * };
+ * @endcode
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_SIMULATION_COMMON_H
+#define ZHELE_SIMULATION_COMMON_H
+
+#if defined (ZHELE_HOST_SIMULATION)
+
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace Zhele::Simulation
+{
+    /**
+     * @brief Peripheral model base
+     *
+     * @details
+     * Model owns address range (peripheral registers block). Register wrappers notify model before every
+     * access to its registers, so model can update status registers (set TXE flag, complete conversion, etc).
+     * Step is called by simulation loop (usually test code), so model can emulate ongoing processes.
+     */
+    class PeripheralModel
+    {
+    public:
+        /**
+         * @brief Construct model
+         *
+         * @param [in] base Registers block base address (address from MCU header)
+         * @param [in] size Registers block size
+         */
+        PeripheralModel(uintptr_t base, uintptr_t size)
+            : _base(base), _size(size)
+        {}
+
+        virtual ~PeripheralModel() = default;
+
+        /**
+         * @brief Checks address belongs to model
+         *
+         * @param [in] address Register address
+         *
+         * @retval true Address belongs to model
+         * @retval false Address does not belong to model
+         */
+        bool Contains(uintptr_t address) const
+        {
+            return address >= _base && address - _base < _size;
+        }
+
+        /**
+         * @brief Access notification (before read/write)
+         *
+         * @param [in] address Register address
+         *
+         * @par Returns
+         *  Nothing
+         */
+        virtual void OnAccess(uintptr_t address) {}
+
+        /**
+         * @brief Simulation step
+         *
+         * @par Returns
+         *  Nothing
+         */
+        virtual void Step() {}
+
+    protected:
+        /**
+         * @brief Returns simulated register
+         *
+         * @tparam T Register type
+         *
+         * @param [in] offset Register offset from block base
+         *
+         * @returns Reference to simulated register
+         */
+        template<typename T = uint32_t>
+        T& Register(uintptr_t offset);
+
+    private:
+        uintptr_t _base;
+        uintptr_t _size;
+    };
+
+    /**
+     * @brief Simulated register file
+     *
+     * @details
+     * Every address from MCU header is mapped to host memory: memory is allocated on first access
+     * (by 1KB pages, peripheral register blocks are 1KB-aligned) and zero-filled, so reset value of all registers is 0.
+     */
+    class RegisterFile
+    {
+        static const uintptr_t PageSize = 1024;
+
+        static std::map<uintptr_t, std::vector<uint8_t>>& Regions()
+        {
+            static std::map<uintptr_t, std::vector<uint8_t>> regions;
+            return regions;
+        }
+
+        static std::vector<PeripheralModel*>& Models()
+        {
+            static std::vector<PeripheralModel*> models;
+            return models;
+        }
+    public:
+        /**
+         * @brief Maps target address range to host memory
+         *
+         * @details
+         * Range is placed into one contiguous region (overlapped regions are merged),
+         * so registers structs can be larger than page.
+         *
+         * @param [in] address Target address
+         * @param [in] size Range size
+         *
+         * @returns Host address
+         */
+        static uint8_t* Map(uintptr_t address, uintptr_t size = sizeof(uint32_t))
+        {
+            auto& regions = Regions();
+            uintptr_t begin = address & ~(PageSize - 1);
+            uintptr_t end = (address + size + PageSize - 1) & ~(PageSize - 1);
+
+            auto it = regions.upper_bound(address);
+            if(it != regions.begin())
+            {
+                auto previous = std::prev(it);
+                if(previous->first + previous->second.size() >= address + size)
+                    return previous->second.data() + (address - previous->first);
+                if(previous->first + previous->second.size() > begin)
+                    it = previous;
+            }
+
+            // Merge all overlapped regions into new one
+            std::vector<uint8_t> memory;
+            if(it != regions.end() && it->first < begin)
+                begin = it->first;
+            while(it != regions.end() && it->first < end)
+            {
+                uintptr_t regionEnd = it->first + it->second.size();
+                end = regionEnd > end ? regionEnd : end;
+                memory.resize(end - begin, 0);
+                memcpy(memory.data() + (it->first - begin), it->second.data(), it->second.size());
+                it = regions.erase(it);
+            }
+            memory.resize(end - begin, 0);
+            auto& region = regions[begin] = std::move(memory);
+            return region.data() + (address - begin);
+        }
+
+        /**
+         * @brief Maps target address to host memory and notifies models
+         *
+         * @param [in] address Target address
+         * @param [in] size Range size
+         *
+         * @returns Host address
+         */
+        static uint8_t* Access(uintptr_t address, uintptr_t size)
+        {
+            for(PeripheralModel* model : Models())
+            {
+                if(model->Contains(address))
+                    model->OnAccess(address);
+            }
+            return Map(address, size);
+        }
+
+        /**
+         * @brief Attaches peripheral model
+         *
+         * @param [in] model Model
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Attach(PeripheralModel& model)
+        {
+            Models().push_back(&model);
+        }
+
+        /**
+         * @brief Detaches peripheral model
+         *
+         * @param [in] model Model
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Detach(PeripheralModel& model)
+        {
+            auto& models = Models();
+            for(auto it = models.begin(); it != models.end(); ++it)
+            {
+                if(*it == &model)
+                {
+                    models.erase(it);
+                    break;
+                }
+            }
+        }
+
+        /**
+         * @brief Calls Step of all models
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Step()
+        {
+            for(PeripheralModel* model : Models())
+                model->Step();
+        }
+
+        /**
+         * @brief Resets all registers to 0 (models stay attached)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Reset()
+        {
+            Regions().clear();
+        }
+    };
+
+    /**
+     * @brief Remaps target pointer (register or registers struct) to simulated register file
+     *
+     * @tparam T Pointee type
+     *
+     * @param [in] target Target pointer (from MCU header)
+     *
+     * @returns Host pointer
+     */
+    template<typename T>
+    inline T* Remap(T* target)
+    {
+        return reinterpret_cast<T*>(RegisterFile::Access(reinterpret_cast<uintptr_t>(target), sizeof(T)));
+    }
+
+    template<typename T>
+    T& PeripheralModel::Register(uintptr_t offset)
+    {
+        return *reinterpret_cast<T*>(RegisterFile::Map(_base + offset, sizeof(T)));
+    }
+}
+
+/// Target register (lvalue expression) in simulated register file
+#define ZHELE_IO_REG(REG_NAME) (*::Zhele::Simulation::Remap(&(REG_NAME)))
+/// Target pointer in simulated register file
+#define ZHELE_IO_PTR(PTR) (::Zhele::Simulation::Remap(PTR))
+
+#else
+
+#define ZHELE_IO_REG(REG_NAME) (REG_NAME)
+#define ZHELE_IO_PTR(PTR) (PTR)
+
+#endif
+
+#endif //! ZHELE_SIMULATION_COMMON_H
@@ -0,0 +1,197 @@
+/**
+ * @file
+ * Implements spectrum analysis (Q15 real FFT and Goertzel tone detection)
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_SPECTRUM_COMMON_H
+#define ZHELE_SPECTRUM_COMMON_H
+
+#include "dsp.h"
+#include "template_utils/constexpr_math.h"
+#include "template_utils/static_array.h"
+
+namespace Zhele::Dsp
+{
+    namespace Private
+    {
+        /**
+         * @brief FFT twiddle factors table (generated at compile time)
+         *
+         * @details
+         * W^k = cos(2 pi k / N) - i sin(2 pi k / N), k = 0...N/2 - 1,
+         * real part is in low half, imaginary part is in high half (Q15).
+         *
+         * @tparam _Size Real FFT size (N)
+         */
+        template<unsigned _Size>
+        constexpr TemplateUtils::StaticArray<uint32_t, _Size / 2> FftTwiddles()
+        {
+            return TemplateUtils::GenerateArray<uint32_t, _Size / 2>([](size_t k) {
+                double angle = 2 * TemplateUtils::Pi * k / _Size;
+                return static_cast<uint16_t>(ToQ15(TemplateUtils::Cos(angle)))
+                    | (static_cast<uint32_t>(static_cast<uint16_t>(ToQ15(-TemplateUtils::Sin(angle)))) << 16);
+            });
+        }
+    }
+
+    /**
+     * @brief In-place real FFT (Q15)
+     *
+     * @details
+     * N real samples are processed as N/2 complex points (even samples are real parts,
+     * odd samples are imaginary parts) by radix-4 passes (two radix-2 stages per pass with
+     * three complex multiplications per four points) and split into real spectrum.
+     * Each radix-2 stage halves data, so result is scaled by 1/N and never overflows.
+     * Packed 16-bit complex arithmetic (SHADD16, SMUSD, SMUADX) is used on Cortex-M4.
+     *
+     * Twiddle factors table (2N bytes) is generated at compile time and placed in flash.
+     *
+     * @tparam _Size FFT size (samples count, power of 2, 16...4096)
+     */
+    template<unsigned _Size>
+    class RealFftQ15
+    {
+        static_assert(_Size >= 16 && _Size <= 4096 && (_Size & (_Size - 1)) == 0, "FFT size should be power of 2 (16...4096)");
+
+        /// Complex FFT points
+        static const unsigned Points = _Size / 2;
+
+        static constexpr auto _twiddles = Private::FftTwiddles<_Size>();
+    public:
+        /// Spectrum bins count (DC...Nyquist excluded)
+        static const unsigned Bins = _Size / 2;
+
+        /**
+         * @brief Calculates spectrum
+         *
+         * @details
+         * Output format: data[0] is X[0] (DC), data[1] is X[N/2] (Nyquist), both real,
+         * then real and imaginary parts of X[1]...X[N/2 - 1]. Values are X[k] / N.
+         *
+         * @param [in, out] data Samples (N values), spectrum on return
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Forward(Q15* data);
+
+        /**
+         * @brief Calculates magnitudes of spectrum calculated by Forward
+         *
+         * @param [in] spectrum Spectrum (N values)
+         * @param [out] magnitude Magnitudes of bins 0...N/2 - 1 (N/2 values, may be equal to spectrum)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Magnitude(const Q15* spectrum, Q15* magnitude);
+
+        /**
+         * @brief Returns bin center frequency
+         *
+         * @param [in] sampleRate Sample rate (Hz)
+         * @param [in] bin Bin index
+         *
+         * @returns Frequency (Hz)
+         */
+        static constexpr uint32_t BinFrequency(uint32_t sampleRate, unsigned bin)
+        {
+            return static_cast<uint32_t>(static_cast<uint64_t>(sampleRate) * bin / _Size);
+        }
+
+    private:
+        static void ComplexFft(Q15* data);
+    };
+
+    /**
+     * @brief Goertzel filters bank (tone detection: DTMF, carrier, vibration harmonics)
+     *
+     * @details
+     * Target frequencies are rounded to nearest bin of _BlockSize-points DFT,
+     * coefficients 2cos(2 pi k / N) are calculated at compile time.
+     * One multiply-accumulate per sample per frequency, results are updated
+     * after each _BlockSize samples.
+     *
+     * @tparam _SampleRate Sample rate (Hz)
+     * @tparam _BlockSize Samples count per analysis block
+     * @tparam _Frequencies Target frequencies (Hz)
+     */
+    template<uint32_t _SampleRate, unsigned _BlockSize, uint32_t... _Frequencies>
+    class GoertzelBank
+    {
+        static_assert(sizeof...(_Frequencies) > 0, "Bank should have at least one frequency");
+        static_assert(_BlockSize >= 8 && _BlockSize <= 4096, "Block size should be 8...4096");
+        static_assert(((_Frequencies < _SampleRate / 2) && ...), "Frequencies should be less than Nyquist frequency");
+    public:
+        /// Frequencies count
+        static const unsigned Count = sizeof...(_Frequencies);
+
+        /**
+         * @brief Constructor
+         */
+        GoertzelBank();
+
+        /**
+         * @brief Processes samples
+         *
+         * @param [in] data Samples
+         * @param [in] count Samples count (may be not multiple of block size)
+         *
+         * @retval true At least one block is completed, magnitudes are updated
+         * @retval false Block is not completed
+         */
+        bool Process(const Q15* data, unsigned count);
+
+        /**
+         * @brief Returns tone amplitude of the last completed block
+         *
+         * @param [in] index Frequency index
+         *
+         * @returns Amplitude (Q15, full-scale sine gives 32767)
+         */
+        Q15 Magnitude(unsigned index) const;
+
+        /**
+         * @brief Returns detector frequency (target frequency rounded to bin)
+         *
+         * @param [in] index Frequency index
+         *
+         * @returns Frequency (Hz)
+         */
+        static constexpr uint32_t BinFrequency(unsigned index)
+        {
+            return static_cast<uint32_t>(static_cast<uint64_t>(_bins[index]) * _SampleRate / _BlockSize);
+        }
+
+        /**
+         * @brief Clears current block (magnitudes are kept)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        void Reset();
+
+    private:
+        static constexpr unsigned Bin(uint32_t frequency)
+        {
+            return static_cast<unsigned>((static_cast<uint64_t>(frequency) * _BlockSize + _SampleRate / 2) / _SampleRate);
+        }
+
+        static constexpr unsigned _bins[Count] = {Bin(_Frequencies)...};
+        /// 2cos(2 pi k / N), Q14
+        static constexpr Q15 _coefficients[Count] = {ToQ15(2 * TemplateUtils::Cos(2 * TemplateUtils::Pi * Bin(_Frequencies) / _BlockSize), 14)...};
+
+        int32_t _s1[Count];
+        int32_t _s2[Count];
+        Q15 _magnitudes[Count];
+        unsigned _samples;
+    };
+}
+
+#include "impl/spectrum.h"
+
+#endif //! ZHELE_SPECTRUM_COMMON_H
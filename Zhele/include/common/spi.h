@@ -10,12 +10,20 @@
 #define ZHELE_SPI_COMMON_H
 
 #include "ioreg.h"
+#include "nvic.h"
 #include "template_utils/data_transfer.h"
+#include "../containers/ring_buffer.h"
 
 #include <clock.h>
 #include <iopins.h>
 #include <pinlist.h>
 
+#include <cstring>
+
+#if !defined(ZHELE_SPI_TRANSACTION_QUEUE_SIZE)
+    #define ZHELE_SPI_TRANSACTION_QUEUE_SIZE 4
+#endif
+
 namespace Zhele
 {
     namespace Private
@@ -138,6 +146,73 @@ namespace Zhele
                 LsbFirst			= SPI_CR1_LSBFIRST, ///< LSB
                 MsbFirst			= 0 ///< MSB
             };
+
+            /**
+             * @brief Chip select actions for transaction
+             */
+            enum ChipSelectAction : uint8_t
+            {
+                KeepChipSelect = 0, ///< Do not change chip select
+                SelectBefore = 0x01, ///< Select device before transaction
+                DeselectAfter = 0x02, ///< Deselect device after transaction
+                SelectAndDeselect = SelectBefore | DeselectAfter ///< Select before and deselect after transaction
+            };
+
+            /// Chip select control function (select = true for select device)
+            using ChipSelectControl = std::add_pointer_t<void(bool select)>;
+
+            /**
+             * @brief Chip select control for active low CS pin
+             * 
+             * @tparam _Pin CS pin
+             * 
+             * @param [in] select Select (true) or deselect (false) device
+             * 
+             * @par Returns
+             * 	Nothing
+             */
+            template<typename _Pin>
+            static void ActiveLowChipSelect(bool select)
+            {
+                if(select)
+                    _Pin::Clear();
+                else
+                    _Pin::Set();
+            }
+
+            /**
+             * @brief Transaction queue item
+             */
+            struct Transaction
+            {
+                const void* transmitBuffer; ///< Data to transmit (nullptr for transmit 0xff)
+                void* receiveBuffer; ///< Receive buffer (nullptr for ignore received data)
+                uint16_t size; ///< Data size (count of elements)
+                DataSize dataSize; ///< Data size (8 or 16 bit)
+                ChipSelectControl chipSelect; ///< Chip select control (nullptr for none)
+                ChipSelectAction chipSelectAction; ///< Chip select action
+                TransferCallback callback; ///< Transaction complete callback
+            };
+
+            /// Slave stream frame callback (received frame and its size in data frames)
+            using SlaveFrameCallback = TemplateUtils::InplaceFunction<void(void* data, uint16_t size)>;
+
+            /**
+             * @brief Select fastest clock divider with SCK not above given frequence
+             * 
+             * @param [in] busClock SPI bus clock frequence
+             * @param [in] maxFreq Max SCK frequence
+             * 
+             * @returns Clock divider (Div256 if max frequence is too low)
+             */
+            static constexpr ClockDivider CalculateDivider(uint32_t busClock, uint32_t maxFreq)
+            {
+                unsigned divider = 0;
+                // Div2 is 0, each next divider value doubles prescaler
+                while(divider < 7 && (busClock >> (divider + 1)) > maxFreq)
+                    ++divider;
+                return static_cast<ClockDivider>(divider << SPI_CR1_BR_Pos);
+            }
         };
         
 
@@ -182,6 +257,23 @@ namespace Zhele
              * 	Nothing
              */
             static void Init(ClockDivider divider = Medium, Mode mode = Master);
+
+            /**
+             * @brief Init SPI interface with clock divider calculated at compile time
+             * 
+             * @details
+             * Divider is selected from constant bus clock of clock tree (fastest SCK not above given),
+             * build fails if SCK cannot be divided down to given frequence.
+             * 
+             * @tparam _MaxFreq Max SCK frequence
+             * @tparam _ClockTree Clock tree (Clock::ClockTree)
+             * @param [in] mode SPI mode
+             * 
+             * @par Returns
+             * 	Nothing
+             */
+            template<uint32_t _MaxFreq, typename _ClockTree>
+            static void Init(Mode mode = Master);
            
 
             /**
@@ -193,6 +285,22 @@ namespace Zhele
              *	Nothing
              */
             static void SetDivider(ClockDivider divider);
+
+            /**
+             * @brief Returns SPI module source (bus) clock frequence
+             * 
+             * @returns Bus clock frequence
+             */
+            static uint32_t GetClockFreq();
+
+            /**
+             * @brief Set fastest SPI clock not above given frequence
+             * 
+             * @param [in] maxFreq Max SCK frequence
+             * 
+             * @returns Actual SCK frequence (bus clock / 256 if max frequence is too low)
+             */
+            static uint32_t SetClockFreq(uint32_t maxFreq);
            
             /**
              * @brief Set SPI clock polarity (CPOL)
@@ -238,6 +346,23 @@ namespace Zhele
              * 	Nothing
              */
             static void SetDataSize(DataSize dataSize);
+
+            /**
+             * @brief Set SPI frame format
+             * 
+             * @details
+             * Polarity, phase, bit order and data size are written by one read-modify-write
+             * per register (CR1, and CR2 for series with DS field) instead of four.
+             * 
+             * @param [in] clockPolarity Polarity
+             * @param [in] clockPhase Clock phase
+             * @param [in] bitOrder Bit order
+             * @param [in] dataSize Data size
+             * 
+             * @par Returns
+             * 	Nothing
+             */
+            static void SetFrameFormat(ClockPolarity clockPolarity, ClockPhase clockPhase, BitOrder bitOrder, DataSize dataSize);
           
             /**
              * @brief Set slave control (NSS pin)
@@ -328,6 +453,30 @@ namespace Zhele
              */
             static void WriteAsyncNoIncrement(const void* data, uint16_t size, TransferCallback callback = nullptr);
 
+            /**
+             * @brief Start continuous ping-pong write (by circular DMA) with ignored receive
+             * 
+             * @details
+             * Callback is called after each half of buffer is sent (with pointer to this half),
+             * so half can be refilled while other one is being sent. Transfer is stopped by StopWriteStream.
+             * 
+             * @param [in] data Data buffer (two halves)
+             * @param [in] halfSize Size of one half (count of elements)
+             * @param [in] callback Half sent callback
+             * 
+             * @par Returns
+             * 	Nothing
+             */
+            static void WriteStream(const void* data, uint16_t halfSize, TransferCallback callback);
+
+            /**
+             * @brief Stop continuous write
+             * 
+             * @par Returns
+             * 	Nothing
+             */
+            static void StopWriteStream();
+
             /**
              * @brief Read data (via send 0xFF dummy value)
              * 
@@ -347,6 +496,122 @@ namespace Zhele
              *  Nothing
              */
             static void ReadAsync(void* receiveBuffer, size_t bufferSize, TransferCallback callback = nullptr);
+
+            /**
+             * @brief Send data buffer with ignored receive
+             * 
+             * @details
+             * Long buffer is sent by 16-bit frames (two bytes per frame, byte order is fixed by __REV16),
+             * so bus waits and register accesses are halved. Data size is restored to 8 bit after transfer.
+             * If SPI is configured for 16-bit frames, every byte is sent as single frame (as Write does).
+             * 
+             * @param [in] data Data buffer
+             * @param [in] size Buffer size in bytes
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void WriteBuffer(const void* data, size_t size);
+
+            /**
+             * @brief Read data buffer (via send 0xFF dummy values)
+             * 
+             * @details
+             * Long buffer is received by 16-bit frames (see WriteBuffer).
+             * 
+             * @param [out] data Output buffer
+             * @param [in] size Size to read in bytes
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void ReadBuffer(void* data, size_t size);
+
+            /**
+             * @brief Disable DMA requests (both transmit and receive)
+             * 
+             * @details
+             * Should be called before releasing shared DMA channel (see DmaChannelArbiter)
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void DisableDma();
+
+            /**
+             * @brief Add transaction to queue
+             * 
+             * @details
+             * Transactions are executed back-to-back from DMA interrupt.
+             * Each transaction is full-duplex (receive DMA channel is used for completion detection),
+             * so chip select is released only after last data frame has been received.
+             * Transaction data buffers must remain valid until its callback is called.
+             * 
+             * @param [in] transaction Transaction
+             * 
+             * @retval true Transaction has been queued
+             * @retval false Queue is full
+             */
+            static bool QueueTransaction(const Transaction& transaction);
+
+            /**
+             * @brief Returns free space in transaction queue
+             * 
+             * @returns Count of transactions that can be queued
+             */
+            static size_t TransactionQueueFree();
+
+            /**
+             * @brief Check that all queued transactions are completed
+             * 
+             * @retval true Queue is empty, no active transaction
+             * @retval false Transaction is in progress
+             */
+            static bool TransactionQueueEmpty();
+
+            /**
+             * @brief Start slave streaming with NSS-framed transactions
+             * 
+             * @details
+             * SPI should be initialized in slave mode with hardware NSS (AutoSlaveControl).
+             * Transmit and receive DMA are armed for whole frame before master selects device. Transaction end
+             * is detected by NSS rising edge: it's EXTI line is configured by this method, EXTI IRQ handler
+             * should call SlaveFrameEnd (for example, by ExtiDispatcher<ExtiHandler<Exti4, Spi1::SlaveFrameEnd>>).
+             * On frame end DMA is re-armed at once (receive buffer halves are swapped), then callback is called
+             * with received data, so next frame can be received while previous one is processed.
+             * Transmit buffer is sent from start on every frame. If master clocks less frames than armed,
+             * data register (and TX FIFO on MCUs with it) keeps one (up to FIFO size) frames of previous response,
+             * so they are sent first in next transaction: protocols usually start response with dummy/status frames.
+             * 
+             * @tparam _NssExti EXTI line of NSS pin
+             * @tparam _NssPin NSS pin
+             * 
+             * @param [in] transmitBuffer Response data (nullptr for transmit 0xff)
+             * @param [in] receiveBuffer Receive buffer for two frames (2 * size data frames)
+             * @param [in] size Max frame size (count of data frames)
+             * @param [in] callback Frame callback (called from EXTI IRQ)
+             * 
+             * @par Returns
+             * 	Nothing
+             */
+            template<typename _NssExti, typename _NssPin>
+            static void EnableSlaveStream(const void* transmitBuffer, void* receiveBuffer, uint16_t size, SlaveFrameCallback callback);
+
+            /**
+             * @brief Stop slave streaming (NSS EXTI interrupt is not disabled)
+             * 
+             * @par Returns
+             * 	Nothing
+             */
+            static void DisableSlaveStream();
+
+            /**
+             * @brief Slave stream frame end handler (call it on NSS rising edge)
+             * 
+             * @par Returns
+             * 	Nothing
+             */
+            static void SlaveFrameEnd();
          
 
             /**
@@ -389,7 +654,101 @@ namespace Zhele
              */
             template<typename mosiPin, typename misoPin, typename clockPin, typename ssPin>
             static void SelectPins();
+
+        private:
+            /// Minimal buffer size for 16-bit frames transfer (data size switch has own cost)
+            static const size_t WideTransferThreshold = 16;
+
+            /**
+             * @brief Check that SPI is configured for 16-bit frames
+             * 
+             * @retval true Data size is 16 bit
+             * @retval false Data size is 8 bit (or less)
+             */
+            static bool WideFrames();
+
+            /**
+             * @brief Change data size (waits current transfer end)
+             * 
+             * @param [in] dataSize New data size
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void ChangeDataSize(DataSize dataSize);
+
+            /**
+             * @brief Send and receive one frame without data size check
+             * 
+             * @param [in] value Frame to send
+             * 
+             * @returns Received frame
+             */
+            static uint16_t TransferFrame(uint16_t value);
+
+            /**
+             * @brief Convert memory bytes to frames (and back) for current bit order
+             * 
+             * @param [in] word Two bytes pairs
+             * 
+             * @returns Two 16-bit frames (first frame in low half)
+             */
+            static uint32_t SwapFrames(uint32_t word);
+
+            /**
+             * @brief Start first transaction from queue
+             * 
+             * @par Returns
+             * 	Nothing
+             */
+            static void StartTransaction();
+
+            /**
+             * @brief Transaction complete handler (DMA receive callback)
+             * 
+             * @par Returns
+             * 	Nothing
+             */
+            static void TransactionComplete(void* data, unsigned size, bool success);
+
+            /**
+             * @brief Arm slave stream DMA for next frame
+             * 
+             * @par Returns
+             * 	Nothing
+             */
+            static void ArmSlaveStream();
+
+            struct SlaveStreamData
+            {
+                const void* TransmitBuffer;
+                uint8_t* ReceiveBuffer;
+                uint16_t Size;
+                uint8_t Active; ///< Active receive buffer half
+                SlaveFrameCallback Callback;
+            };
+
+            static Containers::RingBuffer<ZHELE_SPI_TRANSACTION_QUEUE_SIZE, Transaction> _transactions;
+            static volatile bool _transactionActive;
+            static uint16_t _transmitDummy;
+            static uint16_t _receiveDummy;
+            static SlaveStreamData _slaveStream;
         };
+
+        template<typename _Regs, typename _Clock, typename _MosiPins, typename _MisoPins, typename _ClockPins, typename _SsPins, typename _DmaTx, typename _DmaRx>
+        Containers::RingBuffer<ZHELE_SPI_TRANSACTION_QUEUE_SIZE, SpiBase::Transaction> Spi<_Regs, _Clock, _MosiPins, _MisoPins, _ClockPins, _SsPins, _DmaTx, _DmaRx>::_transactions;
+
+        template<typename _Regs, typename _Clock, typename _MosiPins, typename _MisoPins, typename _ClockPins, typename _SsPins, typename _DmaTx, typename _DmaRx>
+        volatile bool Spi<_Regs, _Clock, _MosiPins, _MisoPins, _ClockPins, _SsPins, _DmaTx, _DmaRx>::_transactionActive = false;
+
+        template<typename _Regs, typename _Clock, typename _MosiPins, typename _MisoPins, typename _ClockPins, typename _SsPins, typename _DmaTx, typename _DmaRx>
+        uint16_t Spi<_Regs, _Clock, _MosiPins, _MisoPins, _ClockPins, _SsPins, _DmaTx, _DmaRx>::_transmitDummy = 0xffff;
+
+        template<typename _Regs, typename _Clock, typename _MosiPins, typename _MisoPins, typename _ClockPins, typename _SsPins, typename _DmaTx, typename _DmaRx>
+        uint16_t Spi<_Regs, _Clock, _MosiPins, _MisoPins, _ClockPins, _SsPins, _DmaTx, _DmaRx>::_receiveDummy;
+
+        template<typename _Regs, typename _Clock, typename _MosiPins, typename _MisoPins, typename _ClockPins, typename _SsPins, typename _DmaTx, typename _DmaRx>
+        typename Spi<_Regs, _Clock, _MosiPins, _MisoPins, _ClockPins, _SsPins, _DmaTx, _DmaRx>::SlaveStreamData Spi<_Regs, _Clock, _MosiPins, _MisoPins, _ClockPins, _SsPins, _DmaTx, _DmaRx>::_slaveStream;
     }
 }
 
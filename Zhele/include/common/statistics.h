@@ -0,0 +1,180 @@
+/**
+ * @file
+ * Implements peripheral runtime statistics counters
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_STATISTICS_COMMON_H
+#define ZHELE_STATISTICS_COMMON_H
+
+/*
+ * Statistics options:
+ *  - ZHELE_STATISTICS - enable statistics counters (every peripheral class gets static Statistics member),
+ *    otherwise counting macro expands to nothing.
+ */
+#if defined (ZHELE_STATISTICS)
+
+#include <array>
+#include <atomic>
+#include <stdint.h>
+
+namespace Zhele
+{
+    /**
+     * @brief I2C counters
+     */
+    enum class I2cCounter : uint8_t
+    {
+        Nack, ///< NACK received
+        Timeout, ///< Timeout
+        Overrun, ///< Overrun/underrun
+        ArbitrationLost, ///< Arbitration lost
+        BusError, ///< Bus error
+        Count
+    };
+
+    /**
+     * @brief USART counters
+     */
+    enum class UsartCounter : uint8_t
+    {
+        Overrun, ///< Overrun error
+        Noise, ///< Noise error
+        Framing, ///< Framing error
+        Parity, ///< Parity error
+        Count
+    };
+
+    /**
+     * @brief DMA channel counters
+     */
+    enum class DmaCounter : uint8_t
+    {
+        Transfers, ///< Transfer complete events (every buffer in circular mode)
+        Errors, ///< Transfer errors
+        Count
+    };
+
+    /**
+     * @brief USB device counters
+     */
+    enum class UsbCounter : uint8_t
+    {
+        Resets, ///< Bus resets
+        InPackets, ///< Transmitted (IN) packets (completed IN transfers for OTG core)
+        OutPackets, ///< Received (OUT and SETUP) packets (RX FIFO entries for OTG core)
+        Errors, ///< Bus errors (CRC, bit stuffing, timeout). Stm32f0/f1/l4 only
+        PacketMemoryOverruns, ///< Packet memory overrun/underrun. Stm32f0/f1/l4 only
+        Count
+    };
+
+    /**
+     * @brief CAN counters
+     */
+    enum class CanCounter : uint8_t
+    {
+        RxOverrun, ///< Frame lost in full hardware RX FIFO
+        RxQueueOverflow, ///< Frame dropped, receive queue is full
+        TxFailed, ///< Frame is not transmitted (no automatic retransmission mode)
+        ProtocolErrors, ///< Bus errors (stuff, form, acknowledgment, bit, CRC)
+        BusOff, ///< Bus-off events
+        Count
+    };
+
+    /**
+     * @brief Peripheral statistics
+     *
+     * @details
+     * Counters are incremented atomically from interrupts and can be read (each one or snapshot of all)
+     * from any context. Every counter wraps around at 2^32.
+     *
+     * @tparam _Counter Counters enum (with Count element)
+     */
+    template<typename _Counter>
+    class PeripheralStatistics
+    {
+        static const unsigned CountersCount = static_cast<unsigned>(_Counter::Count);
+    public:
+        using Snapshot = std::array<uint32_t, CountersCount>;
+
+        /**
+         * @brief Increments counter
+         *
+         * @param [in] counter Counter
+         *
+         * @par Returns
+         *  Nothing
+         */
+        void Increment(_Counter counter)
+        {
+            std::atomic<uint32_t>& value = _counters[static_cast<unsigned>(counter)];
+#if (__CORTEX_M >= 3)
+            value.fetch_add(1, std::memory_order_relaxed);
+#else
+            uint32_t primask = __get_PRIMASK();
+            __disable_irq();
+            value.store(value.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            __set_PRIMASK(primask);
+#endif
+        }
+
+        /**
+         * @brief Returns counter value
+         *
+         * @param [in] counter Counter
+         *
+         * @returns Counter value
+         */
+        uint32_t Get(_Counter counter) const
+        {
+            return _counters[static_cast<unsigned>(counter)].load(std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Returns all counters values
+         *
+         * @returns Counters (indexed by counters enum)
+         */
+        Snapshot Get() const
+        {
+            Snapshot snapshot;
+            for(unsigned i = 0; i < CountersCount; ++i)
+                snapshot[i] = _counters[i].load(std::memory_order_relaxed);
+            return snapshot;
+        }
+
+        /**
+         * @brief Resets all counters
+         *
+         * @par Returns
+         *  Nothing
+         */
+        void Reset()
+        {
+            for(auto& counter : _counters)
+                counter.store(0, std::memory_order_relaxed);
+        }
+    private:
+        std::atomic<uint32_t> _counters[CountersCount] {};
+    };
+
+    using I2cStatistics = PeripheralStatistics<I2cCounter>;
+    using UsartStatistics = PeripheralStatistics<UsartCounter>;
+    using DmaStatistics = PeripheralStatistics<DmaCounter>;
+    using UsbStatistics = PeripheralStatistics<UsbCounter>;
+    using CanStatistics = PeripheralStatistics<CanCounter>;
+}
+
+/// Increments statistics counter
+#define ZHELE_STATISTICS_INCREMENT(STATISTICS, COUNTER) (STATISTICS).Increment(COUNTER)
+
+#else
+
+#define ZHELE_STATISTICS_INCREMENT(STATISTICS, COUNTER)
+
+#endif
+
+#endif //! ZHELE_STATISTICS_COMMON_H
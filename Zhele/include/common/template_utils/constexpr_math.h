@@ -0,0 +1,147 @@
+/**
+ * @file
+ * Implements math functions for compile-time tables
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_CONSTEXPR_MATH_H
+#define ZHELE_CONSTEXPR_MATH_H
+
+namespace Zhele::TemplateUtils
+{
+    /// Pi
+    constexpr double Pi = 3.14159265358979323846;
+
+    /**
+     * @brief Calculates sine (Taylor series after range reduction, error < 1e-12)
+     *
+     * @param [in] x Angle (radians)
+     *
+     * @returns Sine
+     */
+    constexpr double Sin(double x)
+    {
+        // Reduce to [-pi, pi], then to [-pi/2, pi/2] (sin(pi - x) = sin(x))
+        long turns = static_cast<long>(x / (2 * Pi));
+        x -= static_cast<double>(turns) * 2 * Pi;
+        if (x > Pi)
+            x -= 2 * Pi;
+        else if (x < -Pi)
+            x += 2 * Pi;
+        if (x > Pi / 2)
+            x = Pi - x;
+        else if (x < -Pi / 2)
+            x = -Pi - x;
+
+        double term = x;
+        double sum = x;
+        for (int i = 1; i < 12; ++i)
+        {
+            term *= -x * x / ((2 * i) * (2 * i + 1));
+            sum += term;
+        }
+        return sum;
+    }
+
+    /**
+     * @brief Calculates cosine
+     *
+     * @param [in] x Angle (radians)
+     *
+     * @returns Cosine
+     */
+    constexpr double Cos(double x)
+    {
+        return Sin(x + Pi / 2);
+    }
+
+    /// Natural logarithm of 2
+    constexpr double Ln2 = 0.69314718055994530942;
+
+    /**
+     * @brief Calculates exponent (Taylor series after range reduction)
+     *
+     * @param [in] x Power
+     *
+     * @returns e^x
+     */
+    constexpr double Exp(double x)
+    {
+        // e^x = 2^n * e^r, |r| <= ln2 / 2
+        long n = static_cast<long>(x / Ln2 + (x >= 0 ? 0.5 : -0.5));
+        double r = x - static_cast<double>(n) * Ln2;
+
+        double term = 1;
+        double sum = 1;
+        for (int i = 1; i < 20; ++i)
+        {
+            term *= r / i;
+            sum += term;
+        }
+        for (; n > 0; --n)
+            sum *= 2;
+        for (; n < 0; ++n)
+            sum /= 2;
+        return sum;
+    }
+
+    /**
+     * @brief Calculates natural logarithm
+     *
+     * @param [in] x Value (positive)
+     *
+     * @returns ln(x)
+     */
+    constexpr double Log(double x)
+    {
+        if (x <= 0)
+            return -1e300;
+
+        // x = m * 2^e, 1 <= m < 2, ln(m) = 2 atanh((m - 1) / (m + 1))
+        long e = 0;
+        for (; x >= 2; x /= 2)
+            ++e;
+        for (; x < 1; x *= 2)
+            --e;
+
+        double z = (x - 1) / (x + 1);
+        double power = z;
+        double sum = 0;
+        for (int i = 0; i < 20; ++i)
+        {
+            sum += power / (2 * i + 1);
+            power *= z * z;
+        }
+        return 2 * sum + static_cast<double>(e) * Ln2;
+    }
+
+    /**
+     * @brief Raises value to power
+     *
+     * @param [in] x Base (non-negative)
+     * @param [in] y Power
+     *
+     * @returns x^y
+     */
+    constexpr double Pow(double x, double y)
+    {
+        return x > 0 ? Exp(y * Log(x)) : 0;
+    }
+
+    /**
+     * @brief Rounds value to nearest integer (half away from zero)
+     *
+     * @param [in] x Value
+     *
+     * @returns Rounded value
+     */
+    constexpr long Round(double x)
+    {
+        return static_cast<long>(x >= 0 ? x + 0.5 : x - 0.5);
+    }
+}
+
+#endif //! ZHELE_CONSTEXPR_MATH_H
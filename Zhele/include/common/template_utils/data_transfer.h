@@ -10,18 +10,18 @@
 #ifndef ZHELE_DATATRANSFER_H
 #define ZHELE_DATATRANSFER_H
 
+#include "inplace_function.h"
+
 #include <type_traits>
-#include <functional>
 namespace Zhele
 {
-    // Using std::function insted pointer takes about 300 bytes flash and 60 bytes RAM.
-    // Therefore, it's big question: std::function or pointer.
-    /// Transfer callback pointer
-    //using TransferCallback = std::add_pointer_t<void(void* data, unsigned size, bool success)>;
-    using TransferCallback = std::function<void(void* data, unsigned size, bool success)>;
-    /// Tagged transfer callback pointer
-    //using TaggedTransferCallback = std::add_pointer_t<void(void* tag, void* data, unsigned size, bool success)>;
-    using TaggedTransferCallback = std::function<void(void* tag, void* data, unsigned size, bool success)>;
+    // std::function allows lambdas as callbacks, but takes about 300 bytes flash and 60 bytes RAM
+    // and may allocate memory. InplaceFunction stores small trivially copyable lambdas in place,
+    // so it's as cheap as pointer (one indirect call) and still allows captures.
+    /// Transfer callback
+    using TransferCallback = TemplateUtils::InplaceFunction<void(void* data, unsigned size, bool success)>;
+    /// Tagged transfer callback
+    using TaggedTransferCallback = TemplateUtils::InplaceFunction<void(void* tag, void* data, unsigned size, bool success)>;
 }
 
 #endif //!ZHELE_DATATRANSFER_H
\ No newline at end of file
@@ -24,6 +24,17 @@ namespace Zhele::TemplateUtils
         const static unsigned Length = _Length;
         const static unsigned Size = _Length;
         char Text[_Length + 1] = {};
+
+        /**
+         * @brief Constructs string from literal (allows template<fixed_string S> ... Foo<"text">)
+         *
+         * @param [in] str String literal
+         */
+        constexpr fixed_string(const char (&str)[_Length + 1])
+        {
+            for (unsigned i = 0; i < _Length; ++i)
+                Text[i] = str[i];
+        }
     };
 
     template <unsigned _Length>
@@ -0,0 +1,138 @@
+/**
+ * @file
+ * Packet schema methods implementation
+ *
+ * @author Alexey Zhelonkin
+ * @date 2023
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_PACKET_SCHEMA_IMPL_H
+#define ZHELE_PACKET_SCHEMA_IMPL_H
+
+namespace Zhele::TemplateUtils
+{
+    #define PACKETSCHEMA_TEMPLATE_ARGS template<typename _Type, typename... _Fields>
+    #define PACKETSCHEMA_TEMPLATE_QUALIFIER PacketSchema<_Type, _Fields...>
+
+    PACKETSCHEMA_TEMPLATE_ARGS
+    constexpr void PACKETSCHEMA_TEMPLATE_QUALIFIER::Encode(const _Type& object, uint8_t* buffer)
+    {
+        EncodeBytes(object, buffer, std::make_index_sequence<Size>());
+    }
+
+    PACKETSCHEMA_TEMPLATE_ARGS
+    constexpr void PACKETSCHEMA_TEMPLATE_QUALIFIER::Decode(const uint8_t* buffer, _Type& object)
+    {
+        DecodeFields(buffer, object, std::index_sequence_for<_Fields...>());
+    }
+
+    PACKETSCHEMA_TEMPLATE_ARGS
+    template<typename _Stream>
+    void PACKETSCHEMA_TEMPLATE_QUALIFIER::Write(_Stream& stream, const _Type& object)
+    {
+        WriteBytes(stream, object, std::make_index_sequence<Size>());
+    }
+
+    PACKETSCHEMA_TEMPLATE_ARGS
+    template<typename _Stream>
+    void PACKETSCHEMA_TEMPLATE_QUALIFIER::Read(_Stream& stream, _Type& object)
+    {
+        // Field may cover several bytes, so packet is received first
+        uint8_t buffer[Size];
+        for(uint8_t& byte : buffer)
+            byte = stream.Read();
+        Decode(buffer, object);
+    }
+
+    PACKETSCHEMA_TEMPLATE_ARGS
+    template<size_t _Byte, size_t... _Indexes>
+    constexpr uint8_t PACKETSCHEMA_TEMPLATE_QUALIFIER::EncodeByte(const _Type& object, std::index_sequence<_Indexes...>)
+    {
+        return (FieldByte<_Byte, _Indexes>(object) | ...);
+    }
+
+    PACKETSCHEMA_TEMPLATE_ARGS
+    template<size_t _Byte, size_t _Index>
+    constexpr uint8_t PACKETSCHEMA_TEMPLATE_QUALIFIER::FieldByte(const _Type& object)
+    {
+        using FieldType = FieldAt<_Index>;
+        constexpr unsigned offset = _layout.Offsets[_Index];
+        constexpr unsigned first = offset / 8;
+        constexpr unsigned last = (offset + FieldType::Bits - 1) / 8;
+
+        if constexpr (_Byte < first || _Byte > last)
+        {
+            return 0;
+        }
+        else
+        {
+            // 32-bit arithmetic is enough for most of fields (and it is much cheaper for Cortex-M0)
+            using WordType = std::conditional_t<(FieldType::Bits + offset % 8 <= 32), uint32_t, uint64_t>;
+            static_assert(FieldType::Bits + offset % 8 <= 64, "Bit field is too wide");
+
+            constexpr WordType mask = FieldType::Bits >= 8 * sizeof(WordType)
+                ? ~WordType(0)
+                : (WordType(1) << FieldType::Bits) - 1;
+            WordType value = static_cast<WordType>(FieldType::Get(object)) & mask;
+
+            if constexpr (FieldType::Order == BigEndian)
+                return static_cast<uint8_t>(value >> (8 * (last - _Byte)));
+            else
+                return static_cast<uint8_t>((value << (offset % 8)) >> (8 * (_Byte - first)));
+        }
+    }
+
+    PACKETSCHEMA_TEMPLATE_ARGS
+    template<size_t _Index>
+    constexpr void PACKETSCHEMA_TEMPLATE_QUALIFIER::DecodeField(const uint8_t* buffer, _Type& object)
+    {
+        using FieldType = FieldAt<_Index>;
+        constexpr unsigned offset = _layout.Offsets[_Index];
+        constexpr unsigned first = offset / 8;
+        constexpr unsigned last = (offset + FieldType::Bits - 1) / 8;
+
+        using WordType = std::conditional_t<(FieldType::Bits + offset % 8 <= 32), uint32_t, uint64_t>;
+        constexpr WordType mask = FieldType::Bits >= 8 * sizeof(WordType)
+            ? ~WordType(0)
+            : (WordType(1) << FieldType::Bits) - 1;
+
+        // Loops have constant bounds, so they are unrolled
+        WordType value = 0;
+        if constexpr (FieldType::Order == BigEndian)
+        {
+            for(unsigned i = first; i <= last; ++i)
+                value = (value << 8) | buffer[i];
+        }
+        else
+        {
+            for(unsigned i = last + 1; i > first; --i)
+                value = (value << 8) | buffer[i - 1];
+            value >>= offset % 8;
+        }
+        FieldType::Set(object, value & mask);
+    }
+
+    PACKETSCHEMA_TEMPLATE_ARGS
+    template<size_t... _Bytes>
+    constexpr void PACKETSCHEMA_TEMPLATE_QUALIFIER::EncodeBytes(const _Type& object, uint8_t* buffer, std::index_sequence<_Bytes...>)
+    {
+        ((buffer[_Bytes] = EncodeByte<_Bytes>(object, std::index_sequence_for<_Fields...>())), ...);
+    }
+
+    PACKETSCHEMA_TEMPLATE_ARGS
+    template<size_t... _Indexes>
+    constexpr void PACKETSCHEMA_TEMPLATE_QUALIFIER::DecodeFields(const uint8_t* buffer, _Type& object, std::index_sequence<_Indexes...>)
+    {
+        (DecodeField<_Indexes>(buffer, object), ...);
+    }
+
+    PACKETSCHEMA_TEMPLATE_ARGS
+    template<typename _Stream, size_t... _Bytes>
+    void PACKETSCHEMA_TEMPLATE_QUALIFIER::WriteBytes(_Stream& stream, const _Type& object, std::index_sequence<_Bytes...>)
+    {
+        (stream.Write(EncodeByte<_Bytes>(object, std::index_sequence_for<_Fields...>())), ...);
+    }
+}
+
+#endif //! ZHELE_PACKET_SCHEMA_IMPL_H
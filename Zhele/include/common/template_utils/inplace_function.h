@@ -0,0 +1,152 @@
+/**
+ * @file
+ * Implements non-allocating callable wrapper (delegate)
+ *
+ * @author Alexey Zhelonkin
+ * @date 2023
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_INPLACE_FUNCTION_H
+#define ZHELE_INPLACE_FUNCTION_H
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace Zhele::TemplateUtils
+{
+    /// Default capacity of inplace function (enough for capture of two pointers/references)
+    static const unsigned DefaultInplaceFunctionCapacity = 2 * sizeof(void*);
+
+    template<typename _Signature, unsigned _Capacity = DefaultInplaceFunctionCapacity>
+    class InplaceFunction;
+
+    /**
+     * @brief Implements fixed-capacity callable wrapper.
+     *
+     * @details
+     * Unlike std::function it never allocates memory: callable object (function pointer or lambda)
+     * is stored in internal buffer. Callable must be trivially copyable (lambda with captured
+     * pointers, references and scalars), so InplaceFunction itself is trivially copyable too.
+     * Call costs one indirect call.
+     *
+     * @tparam _Result Result type
+     * @tparam _Args Arguments types
+     * @tparam _Capacity Internal buffer size
+     */
+    template<typename _Result, typename... _Args, unsigned _Capacity>
+    class InplaceFunction<_Result(_Args...), _Capacity>
+    {
+        using Invoker = _Result(*)(void* storage, _Args... args);
+    public:
+        /**
+         * @brief Constructs empty function
+         */
+        constexpr InplaceFunction()
+            : _storage{}, _invoker(nullptr)
+        {}
+
+        /**
+         * @brief Constructs empty function
+         */
+        constexpr InplaceFunction(std::nullptr_t)
+            : InplaceFunction()
+        {}
+
+        /**
+         * @brief Constructs function from callable object (function pointer, lambda)
+         *
+         * @param [in] callable Callable object
+         */
+        template<typename _Callable, typename = std::enable_if_t<!std::is_same_v<std::decay_t<_Callable>, InplaceFunction>
+            && std::is_invocable_r_v<_Result, std::decay_t<_Callable>&, _Args...>>>
+        InplaceFunction(_Callable&& callable)
+            : _storage{}, _invoker(nullptr)
+        {
+            using CallableType = std::decay_t<_Callable>;
+
+            static_assert(sizeof(CallableType) <= _Capacity, "Callable is too big for inplace function. Increase capacity.");
+            static_assert(alignof(CallableType) <= alignof(void*), "Callable alignment is not supported.");
+            static_assert(std::is_trivially_copyable_v<CallableType>, "Callable must be trivially copyable.");
+
+            if constexpr (std::is_pointer_v<CallableType>)
+            {
+                if(callable == nullptr)
+                    return;
+            }
+
+            new(_storage) CallableType(std::forward<_Callable>(callable));
+            _invoker = &Invoke<CallableType>;
+        }
+
+        /**
+         * @brief Reset function
+         *
+         * @returns Reference to this
+         */
+        InplaceFunction& operator=(std::nullptr_t)
+        {
+            _invoker = nullptr;
+            return *this;
+        }
+
+        /**
+         * @brief Call stored callable
+         *
+         * @param [in] args Arguments
+         *
+         * @returns Callable result
+         */
+        _Result operator()(_Args... args) const
+        {
+            return _invoker(const_cast<unsigned char*>(_storage), std::forward<_Args>(args)...);
+        }
+
+        /**
+         * @brief Check that function is not empty
+         *
+         * @retval true Function is not empty
+         * @retval false Function is empty
+         */
+        explicit operator bool() const
+        {
+            return _invoker != nullptr;
+        }
+
+        /**
+         * @brief Compare function with nullptr
+         *
+         * @retval true Function is empty
+         * @retval false Function is not empty
+         */
+        friend bool operator==(const InplaceFunction& function, std::nullptr_t)
+        {
+            return function._invoker == nullptr;
+        }
+
+        /**
+         * @brief Compare function with nullptr
+         *
+         * @retval true Function is not empty
+         * @retval false Function is empty
+         */
+        friend bool operator!=(const InplaceFunction& function, std::nullptr_t)
+        {
+            return function._invoker != nullptr;
+        }
+
+    private:
+        template<typename _Callable>
+        static _Result Invoke(void* storage, _Args... args)
+        {
+            return (*std::launder(reinterpret_cast<_Callable*>(storage)))(std::forward<_Args>(args)...);
+        }
+
+        alignas(void*) unsigned char _storage[_Capacity];
+        Invoker _invoker;
+    };
+}
+
+#endif //!ZHELE_INPLACE_FUNCTION_H
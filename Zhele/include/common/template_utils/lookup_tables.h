@@ -0,0 +1,226 @@
+/**
+ * @file
+ * Implements compile-time lookup tables generators (waveforms, gamma, NTC, CRC)
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_LOOKUP_TABLES_H
+#define ZHELE_LOOKUP_TABLES_H
+
+#include "constexpr_math.h"
+#include "static_array.h"
+
+#include <stdint.h>
+
+namespace Zhele::TemplateUtils
+{
+    /**
+     * @brief Generates one sine period: offset + amplitude * sin(2 pi i / _Size)
+     *
+     * @details
+     * For DAC waveform DMA: constexpr auto sine = SineTable<uint16_t, 64>(2047, 2048);
+     *
+     * @tparam _Type Element type
+     * @tparam _Size Samples count
+     *
+     * @param [in] amplitude Amplitude
+     * @param [in] offset Offset
+     *
+     * @returns Table
+     */
+    template<typename _Type, size_t _Size>
+    constexpr StaticArray<_Type, _Size> SineTable(double amplitude, double offset = 0)
+    {
+        return GenerateArray<_Type, _Size>([=](size_t i) { return Round(offset + amplitude * Sin(2 * Pi * i / _Size)); });
+    }
+
+    /**
+     * @brief Generates one cosine period: offset + amplitude * cos(2 pi i / _Size)
+     *
+     * @tparam _Type Element type
+     * @tparam _Size Samples count
+     *
+     * @param [in] amplitude Amplitude
+     * @param [in] offset Offset
+     *
+     * @returns Table
+     */
+    template<typename _Type, size_t _Size>
+    constexpr StaticArray<_Type, _Size> CosineTable(double amplitude, double offset = 0)
+    {
+        return GenerateArray<_Type, _Size>([=](size_t i) { return Round(offset + amplitude * Cos(2 * Pi * i / _Size)); });
+    }
+
+    /**
+     * @brief Generates quarter of sine period: amplitude * sin(pi / 2 * i / _Size), i = 0..._Size
+     *
+     * @details
+     * Full period (4 * _Size phase steps) is restored by QuarterWaveSine/QuarterWaveCosine,
+     * so table is four times smaller than full period table.
+     *
+     * @tparam _Type Element type (signed)
+     * @tparam _Size Phase steps per quarter
+     *
+     * @param [in] amplitude Amplitude
+     *
+     * @returns Table (_Size + 1 values)
+     */
+    template<typename _Type, size_t _Size>
+    constexpr StaticArray<_Type, _Size + 1> QuarterSineTable(double amplitude)
+    {
+        return GenerateArray<_Type, _Size + 1>([=](size_t i) { return Round(amplitude * Sin(Pi / 2 * i / _Size)); });
+    }
+
+    /**
+     * @brief Returns sine by quarter-wave table
+     *
+     * @param [in] table Table generated by QuarterSineTable
+     * @param [in] phase Phase (4 * quarter steps are one period, greater values are wrapped)
+     *
+     * @returns Sine value
+     */
+    template<typename _Type, size_t _Size>
+    constexpr _Type QuarterWaveSine(const StaticArray<_Type, _Size>& table, uint32_t phase)
+    {
+        constexpr uint32_t quarter = _Size - 1;
+        phase %= 4 * quarter;
+        uint32_t index = phase % quarter;
+        switch (phase / quarter)
+        {
+        case 0:
+            return table[index];
+        case 1:
+            return table[quarter - index];
+        case 2:
+            return static_cast<_Type>(-table[index]);
+        default:
+            return static_cast<_Type>(-table[quarter - index]);
+        }
+    }
+
+    /**
+     * @brief Returns cosine by quarter-wave table
+     *
+     * @param [in] table Table generated by QuarterSineTable
+     * @param [in] phase Phase (4 * quarter steps are one period, greater values are wrapped)
+     *
+     * @returns Cosine value
+     */
+    template<typename _Type, size_t _Size>
+    constexpr _Type QuarterWaveCosine(const StaticArray<_Type, _Size>& table, uint32_t phase)
+    {
+        return QuarterWaveSine(table, phase % (4 * (_Size - 1)) + (_Size - 1));
+    }
+
+    /**
+     * @brief Generates gamma correction curve: maxValue * (i / (_Size - 1))^gamma
+     *
+     * @details
+     * For display color correction: constexpr auto gamma = GammaTable<uint8_t, 256>(2.2, 255);
+     *
+     * @tparam _Type Element type
+     * @tparam _Size Input levels count
+     *
+     * @param [in] gamma Gamma
+     * @param [in] maxValue Output value for max input
+     *
+     * @returns Table
+     */
+    template<typename _Type, size_t _Size>
+    constexpr StaticArray<_Type, _Size> GammaTable(double gamma, double maxValue)
+    {
+        static_assert(_Size > 1, "Table should have at least 2 values");
+        return GenerateArray<_Type, _Size>([=](size_t i) { return Round(maxValue * Pow(static_cast<double>(i) / (_Size - 1), gamma)); });
+    }
+
+    /**
+     * @brief Generates NTC thermistor curve: temperature (0.1 degree Celsius) by ADC code
+     *
+     * @details
+     * Thermistor is connected to ground, series resistor is connected to ADC reference,
+     * so code = adcMax * R / (R + seriesResistance). Temperature is calculated by beta equation
+     * for codes i * adcMax / (_Size - 1), use Interpolate to convert ADC code:
+     * constexpr auto ntc = NtcTable<33>(3950, 10000, 10000, 4095);
+     * int16_t temperature = Interpolate(ntc, code, 4095);
+     * Curve is steep near end codes, so increase points count if wide temperature range is required.
+     *
+     * @tparam _Size Points count
+     *
+     * @param [in] beta Beta coefficient (K)
+     * @param [in] resistance25 Resistance at 25 degrees Celsius (Ohm)
+     * @param [in] seriesResistance Series resistor (Ohm)
+     * @param [in] adcMax Max ADC code
+     *
+     * @returns Table (saturated to int16_t)
+     */
+    template<size_t _Size>
+    constexpr StaticArray<int16_t, _Size> NtcTable(double beta, double resistance25, double seriesResistance, uint32_t adcMax)
+    {
+        static_assert(_Size > 1, "Table should have at least 2 values");
+        return GenerateArray<int16_t, _Size>([=](size_t i) {
+            // End points (short and open thermistor) are moved by half of code
+            double code = static_cast<double>(i) * adcMax / (_Size - 1);
+            code = code < 0.5 ? 0.5 : (code > adcMax - 0.5 ? adcMax - 0.5 : code);
+            double resistance = seriesResistance * code / (adcMax - code);
+            long temperature = Round((1 / (1 / 298.15 + Log(resistance / resistance25) / beta) - 273.15) * 10);
+            return temperature > INT16_MAX ? INT16_MAX : (temperature < INT16_MIN ? INT16_MIN : temperature);
+        });
+    }
+
+    /**
+     * @brief Linear interpolation in table of uniformly spaced points (sensor linearization)
+     *
+     * @param [in] table Table (value of point i is for input i * maxInput / (Size - 1))
+     * @param [in] input Input value (0...maxInput)
+     * @param [in] maxInput Max input value
+     *
+     * @returns Interpolated value
+     */
+    template<typename _Type, size_t _Size>
+    constexpr _Type Interpolate(const StaticArray<_Type, _Size>& table, uint32_t input, uint32_t maxInput)
+    {
+        // Position with 8 fraction bits
+        uint32_t position = static_cast<uint32_t>(static_cast<uint64_t>(input) * (_Size - 1) * 256 / maxInput);
+        uint32_t index = position >> 8;
+        if (index >= _Size - 1)
+            return table[_Size - 1];
+
+        int32_t fraction = position & 0xff;
+        int32_t low = table[index];
+        int32_t high = table[index + 1];
+        return static_cast<_Type>(low + (high - low) * fraction / 256);
+    }
+
+    /**
+     * @brief Generates CRC lookup table (256 values)
+     *
+     * @tparam _Type CRC register type
+     * @tparam _Width CRC width (bits)
+     * @tparam _Polynomial Polynomial (reversed for reflected CRC)
+     * @tparam _Reflected Reflected (LSB first) algorithm
+     *
+     * @returns Table (CRC with width less than register width is left-aligned for not reflected algorithm)
+     */
+    template<typename _Type, unsigned _Width, _Type _Polynomial, bool _Reflected>
+    constexpr StaticArray<_Type, 256> CrcTable()
+    {
+        constexpr unsigned bits = sizeof(_Type) * 8;
+        constexpr unsigned shift = _Reflected ? 0 : bits - _Width;
+        return GenerateArray<_Type, 256>([](size_t i) {
+            _Type value = _Reflected ? _Type(i) : _Type(i << (bits - 8));
+            for(unsigned bit = 0; bit < 8; ++bit)
+            {
+                if constexpr (_Reflected)
+                    value = (value & 1) ? _Type((value >> 1) ^ _Polynomial) : _Type(value >> 1);
+                else
+                    value = (value & (_Type(1) << (bits - 1))) ? _Type((value << 1) ^ (_Type)(_Polynomial << shift)) : _Type(value << 1);
+            }
+            return value;
+        });
+    }
+}
+
+#endif //! ZHELE_LOOKUP_TABLES_H
@@ -0,0 +1,285 @@
+/**
+ * @file
+ * Implements compile-time packet schema (struct <-> bytes serialization)
+ *
+ * @author Alexey Zhelonkin
+ * @date 2023
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_PACKET_SCHEMA_H
+#define ZHELE_PACKET_SCHEMA_H
+
+#include "data_transfer.h"
+#include "../../binary_stream.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace Zhele::TemplateUtils
+{
+    namespace Private
+    {
+        template<typename _MemberPointer>
+        struct MemberPointerTraits;
+
+        template<typename _Class, typename _Member>
+        struct MemberPointerTraits<_Member _Class::*>
+        {
+            using ClassType = _Class;
+            using MemberType = _Member;
+        };
+
+        template<typename _Type, bool _IsEnum = std::is_enum_v<_Type>>
+        struct IntegralOf
+        {
+            using type = _Type;
+        };
+
+        template<typename _Type>
+        struct IntegralOf<_Type, true>
+        {
+            using type = std::underlying_type_t<_Type>;
+        };
+
+        /**
+         * @brief Member field base (value access)
+         *
+         * @tparam _Member Pointer to member (integral, enum or bool member)
+         * @tparam _Bits Field width in packet
+         * @tparam _Order Bytes order
+         * @tparam _Aligned Field starts from byte boundary
+         */
+        template<auto _Member, unsigned _Bits, Endianness _Order, bool _Aligned>
+        struct MemberField
+        {
+            using ClassType = typename MemberPointerTraits<decltype(_Member)>::ClassType;
+            using MemberType = typename MemberPointerTraits<decltype(_Member)>::MemberType;
+            using IntegralType = typename IntegralOf<MemberType>::type;
+
+            static_assert(std::is_integral_v<IntegralType>, "Packet field should be integral, enum or bool");
+            static_assert(_Bits > 0 && _Bits <= 8 * sizeof(IntegralType), "Packet field width exceeds member size");
+            static_assert(_Order != MixedEndian, "Mixed endian is not supported by packet schema");
+
+            static constexpr unsigned Bits = _Bits;
+            static constexpr Endianness Order = _Order;
+            static constexpr bool Aligned = _Aligned;
+
+            /**
+             * @brief Get field value from object
+             *
+             * @param [in] object Object
+             *
+             * @returns Raw value (not masked)
+             */
+            static constexpr uint64_t Get(const ClassType& object)
+            {
+                return static_cast<uint64_t>(static_cast<IntegralType>(object.*_Member));
+            }
+
+            /**
+             * @brief Set field value in object
+             *
+             * @param [out] object Object
+             * @param [in] value Raw value (masked by field width)
+             *
+             * @par Returns
+             *  Nothing
+             */
+            static constexpr void Set(ClassType& object, uint64_t value)
+            {
+                // Sign extension for narrow signed fields
+                if constexpr (std::is_signed_v<IntegralType> && _Bits < 64)
+                {
+                    if(value & (uint64_t(1) << (_Bits - 1)))
+                        value |= ~uint64_t(0) << _Bits;
+                }
+                object.*_Member = static_cast<MemberType>(static_cast<IntegralType>(value));
+            }
+        };
+    }
+
+    /**
+     * @brief Byte aligned packet field
+     *
+     * @tparam _Member Pointer to member
+     * @tparam _Order Bytes order
+     * @tparam _Bytes Field size in packet (member size by default, less value truncates member)
+     */
+    template<auto _Member, Endianness _Order = LittleEndian,
+        unsigned _Bytes = sizeof(typename Private::MemberPointerTraits<decltype(_Member)>::MemberType)>
+    struct Field : Private::MemberField<_Member, 8 * _Bytes, _Order, true>
+    {
+    };
+
+    /**
+     * @brief Bit packed packet field
+     *
+     * @details
+     * Bit fields are packed from least significant bit of byte,
+     * consecutive bit fields share bytes. Byte aligned field after bit field
+     * starts from next byte.
+     *
+     * @tparam _Member Pointer to member
+     * @tparam _Bits Field width
+     */
+    template<auto _Member, unsigned _Bits>
+    struct BitField : Private::MemberField<_Member, _Bits, LittleEndian, false>
+    {
+    };
+
+    /**
+     * @brief Reserved bits (zeros on encode, ignored on decode)
+     *
+     * @tparam _Bits Reserved bits count
+     */
+    template<unsigned _Bits>
+    struct Reserved
+    {
+        static constexpr unsigned Bits = _Bits;
+        static constexpr Endianness Order = LittleEndian;
+        static constexpr bool Aligned = false;
+
+        template<typename _Class>
+        static constexpr uint64_t Get(const _Class&) { return 0; }
+        template<typename _Class>
+        static constexpr void Set(_Class&, uint64_t) {}
+    };
+
+    namespace Private
+    {
+        /// Fields offsets (in bits)
+        template<size_t _FieldsCount>
+        struct PacketLayout
+        {
+            unsigned Offsets[_FieldsCount];
+            unsigned Bits;
+        };
+
+        template<typename... _Fields>
+        constexpr PacketLayout<sizeof...(_Fields)> CalculatePacketLayout()
+        {
+            PacketLayout<sizeof...(_Fields)> layout {};
+            unsigned offset = 0;
+            unsigned index = 0;
+            ((offset = _Fields::Aligned ? (offset + 7) / 8 * 8 : offset,
+                layout.Offsets[index++] = offset,
+                offset += _Fields::Bits), ...);
+            layout.Bits = offset;
+            return layout;
+        }
+    }
+
+    /**
+     * @brief Packet schema
+     *
+     * @details
+     * Packet layout is calculated at compile time, so encode and decode
+     * are straight-line code with constant offsets and shifts (no loops
+     * over field descriptors, no intermediate copies).
+     *
+     * @par Example
+     * @code
+     * struct Telemetry { uint16_t Id; int16_t Temperature; uint8_t Flags; uint8_t Channel; };
+     * using TelemetryPacket = PacketSchema<Telemetry,
+     *     Field<&Telemetry::Id, BigEndian>,
+     *     Field<&Telemetry::Temperature>,
+     *     BitField<&Telemetry::Flags, 4>,
+     *     BitField<&Telemetry::Channel, 4>>;
+     * uint8_t buffer[TelemetryPacket::Size];
+     * TelemetryPacket::Encode(telemetry, buffer);
+     * @endcode
+     *
+     * @tparam _Type Object type
+     * @tparam _Fields Packet fields (Field, BitField, Reserved)
+     */
+    template<typename _Type, typename... _Fields>
+    class PacketSchema
+    {
+        static_assert(sizeof...(_Fields) > 0, "Packet schema should have at least one field");
+
+        static constexpr Private::PacketLayout<sizeof...(_Fields)> _layout = Private::CalculatePacketLayout<_Fields...>();
+
+        template<size_t _Index>
+        using FieldAt = std::tuple_element_t<_Index, std::tuple<_Fields...>>;
+
+    public:
+        /// Packet size in bytes
+        static constexpr size_t Size = (_layout.Bits + 7) / 8;
+
+        /**
+         * @brief Encode object to buffer
+         *
+         * @param [in] object Object
+         * @param [out] buffer Output buffer (Size bytes)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static constexpr void Encode(const _Type& object, uint8_t* buffer);
+
+        /**
+         * @brief Decode object from buffer
+         *
+         * @param [in] buffer Packet (Size bytes)
+         * @param [out] object Object
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static constexpr void Decode(const uint8_t* buffer, _Type& object);
+
+        /**
+         * @brief Write object to stream (BinaryStream or any type with Write(uint8_t) method)
+         *
+         * @details
+         * Packet bytes are generated one by one directly to stream.
+         *
+         * @param [in] stream Output stream
+         * @param [in] object Object
+         *
+         * @par Returns
+         *  Nothing
+         */
+        template<typename _Stream>
+        static void Write(_Stream& stream, const _Type& object);
+
+        /**
+         * @brief Read object from stream (BinaryStream or any type with Read() method)
+         *
+         * @param [in] stream Input stream
+         * @param [out] object Object
+         *
+         * @par Returns
+         *  Nothing
+         */
+        template<typename _Stream>
+        static void Read(_Stream& stream, _Type& object);
+
+    private:
+        template<size_t _Byte, size_t... _Indexes>
+        static constexpr uint8_t EncodeByte(const _Type& object, std::index_sequence<_Indexes...>);
+
+        template<size_t _Byte, size_t _Index>
+        static constexpr uint8_t FieldByte(const _Type& object);
+
+        template<size_t _Index>
+        static constexpr void DecodeField(const uint8_t* buffer, _Type& object);
+
+        template<size_t... _Bytes>
+        static constexpr void EncodeBytes(const _Type& object, uint8_t* buffer, std::index_sequence<_Bytes...>);
+
+        template<size_t... _Indexes>
+        static constexpr void DecodeFields(const uint8_t* buffer, _Type& object, std::index_sequence<_Indexes...>);
+
+        template<typename _Stream, size_t... _Bytes>
+        static void WriteBytes(_Stream& stream, const _Type& object, std::index_sequence<_Bytes...>);
+    };
+}
+
+#include "impl/packet_schema.h"
+
+#endif //! ZHELE_PACKET_SCHEMA_H
@@ -13,6 +13,7 @@
 #include "type_list.h"
 
 #include <cstddef>
+#include <cstdint>
 
 namespace Zhele::TemplateUtils
 {
@@ -93,6 +94,62 @@ namespace Zhele::TemplateUtils
     public:
         using type = Int8_tArray<Numbers..., Value>;
     };
+
+    /**
+     * @brief Constant array (literal type, so it can be generated at compile time and placed in flash).
+     *
+     * @tparam _Type Element type
+     * @tparam _Size Elements count
+     */
+    template<typename _Type, size_t _Size>
+    struct StaticArray
+    {
+        using ValueType = _Type;
+        static const size_t Size = _Size;
+
+        /**
+         * @brief Returns element.
+         *
+         * @param [in] index Index
+         *
+         * @returns Element with given index.
+         */
+        constexpr const _Type& operator[](size_t index) const {return Values[index];}
+        constexpr _Type& operator[](size_t index) {return Values[index];}
+
+        /**
+         * @brief Returns pointer to elements (for DMA for example).
+         *
+         * @returns Pointer to first element.
+         */
+        constexpr const _Type* Data() const {return Values;}
+
+        _Type Values[_Size];
+    };
+
+    /**
+     * @brief Generates array at compile time.
+     *
+     * @details
+     * Use result to initialize constexpr variable, so table is calculated by compiler
+     * and placed in flash: constexpr auto table = GenerateArray<uint16_t, 64>([](size_t i) {...});
+     *
+     * @tparam _Type Element type
+     * @tparam _Size Elements count
+     * @tparam _Generator Generator type (callable object: _Type(size_t index))
+     *
+     * @param [in] generator Generator
+     *
+     * @returns Generated array.
+     */
+    template<typename _Type, size_t _Size, typename _Generator>
+    constexpr StaticArray<_Type, _Size> GenerateArray(_Generator generator)
+    {
+        StaticArray<_Type, _Size> result {};
+        for(size_t i = 0; i < _Size; ++i)
+            result.Values[i] = static_cast<_Type>(generator(i));
+        return result;
+    }
 }
 
 #endif //!ZHELE_STATICARRAY_H
\ No newline at end of file
@@ -38,33 +38,91 @@ namespace Zhele
             static const unsigned value = sizeof...(Types);
         };
 
+        namespace Private
+        {
+            /**
+             * @brief Returns index of first true value
+             *
+             * @param [in] values Values (last one is sentinel)
+             * @param [in] count Values count (without sentinel)
+             *
+             * @returns Index or -1 if there is no true values
+             */
+            constexpr int FindFirst(const bool* values, unsigned count)
+            {
+                for(unsigned i = 0; i < count; ++i)
+                {
+                    if(values[i])
+                        return static_cast<int>(i);
+                }
+                return -1;
+            }
+
+            /**
+             * @brief Indexes of true values
+             */
+            template<unsigned Size>
+            struct Selection
+            {
+                unsigned Indexes[Size + 1];
+                unsigned Count;
+            };
+
+            template<unsigned Size>
+            constexpr Selection<Size> SelectIndexes(const bool* values)
+            {
+                Selection<Size> selection {};
+                for(unsigned i = 0; i < Size; ++i)
+                {
+                    if(values[i])
+                        selection.Indexes[selection.Count++] = i;
+                }
+                return selection;
+            }
+
+#if defined (__has_builtin)
+#if __has_builtin(__type_pack_element)
+#define ZHELE_HAS_TYPE_PACK_ELEMENT
+#endif
+#endif
+
+#if defined (ZHELE_HAS_TYPE_PACK_ELEMENT)
+            template<unsigned Index, typename... Types>
+            using PackElement = __type_pack_element<Index, Types...>;
+#else
+            // Select type by overload resolution (one instantiation per list instead of recursion)
+            template<std::size_t Index, typename T>
+            struct IndexedType
+            {
+                using type = T;
+            };
+
+            template<typename, typename...>
+            struct IndexedTypes;
+
+            template<std::size_t... Indexes, typename... Types>
+            struct IndexedTypes<std::index_sequence<Indexes...>, Types...> : IndexedType<Indexes, Types>... {};
+
+            template<std::size_t Index, typename T>
+            IndexedType<Index, T> SelectIndexed(const IndexedType<Index, T>&);
+
+            template<unsigned Index, typename... Types>
+            using PackElement = typename decltype(SelectIndexed<Index>(std::declval<IndexedTypes<std::index_sequence_for<Types...>, Types...>>()))::type;
+#endif
+        }
+
         /**
          * @brief Search type in typelist
          */
         template<typename, typename...>
         class TypeIndex {};
 
-        template<typename Search>
-        class TypeIndex<Search, TypeList<>>
-        {
-        public:
-            static const int value = -1;
-        };
-
-        template<typename Search, typename... Tail>
-        class TypeIndex<Search, TypeList<Search, Tail...>>
+        template<typename Search, typename... Types>
+        class TypeIndex<Search, TypeList<Types...>>
         {
+            static constexpr bool Matches[] = {std::is_same_v<Search, Types>..., false};
         public:
-            static const int value = 0;
-        };
-
-        template<typename Search, typename Head, typename... Tail>
-        class TypeIndex<Search, TypeList<Head, Tail...>>
-        {
-        public:
-            static const int value = TypeIndex<Search, TypeList<Tail...>>::value >= 0
-                ? TypeIndex<Search, TypeList<Tail...>>::value + 1
-                : TypeIndex<Search, TypeList<Tail...>>::value;
+            static const int value = Private::FindFirst(Matches, sizeof...(Types));
         };
 
         /**
@@ -80,19 +138,12 @@ namespace Zhele
             using type = void;
         };
 
-        template<typename Head, typename... Tail>
-        class GetType<0, TypeList<Head, Tail...>>
-        {
-        public:
-            using type = Head;
-        };
-
         template<int Index, typename Head, typename... Tail>
         class GetType<Index, TypeList<Head , Tail...>>
         {
-            static_assert(Index < Length<TypeList<Head, Tail...>>::value);
+            static_assert(Index >= 0 && Index < static_cast<int>(Length<TypeList<Head, Tail...>>::value));
         public:
-            using type = typename GetType<Index - 1, TypeList<Tail...>>::type;
+            using type = Private::PackElement<Index, Head, Tail...>;
         };
 
         template<int Index, typename Types>
@@ -320,8 +371,19 @@ namespace Zhele
         template<template <typename> class Predicate, typename... Types>
         class Sample<Predicate, TypeList<Types...>>
         {
+            // void elements are removed too (as DeleteAll<void, ...> did)
+            static constexpr bool Matches[] = {(static_cast<bool>(Predicate<Types>::value) && !std::is_void_v<Types>)..., false};
+            static constexpr Private::Selection<sizeof...(Types)> Selected = Private::SelectIndexes<sizeof...(Types)>(Matches);
+
+            template<typename>
+            struct SampleImpl;
+            template<std::size_t... Indexes>
+            struct SampleImpl<std::index_sequence<Indexes...>>
+            {
+                using type = TypeList<Private::PackElement<Selected.Indexes[Indexes], Types...>...>;
+            };
         public:
-            using type = typename DeleteAll<void, TypeList<typename Select<Predicate<Types>::value, Types, void>::value ...>>::type;
+            using type = typename SampleImpl<std::make_index_sequence<Selected.Count>>::type;
         };
 
         template<template <typename> class Predicate, typename... Types>
@@ -333,22 +395,12 @@ namespace Zhele
         template<template <typename> class, typename...>
         class Search;
 
-        template<template <typename> class Predicate>
-        class Search<Predicate, TypeList<>>
-        {
-        public:
-            static const int value = -1;
-        };
-
-        template<template <typename> class Predicate, typename Head, typename... Tail>
-        class Search<Predicate, TypeList<Head, Tail...>>
+        template<template <typename> class Predicate, typename... Types>
+        class Search<Predicate, TypeList<Types...>>
         {
+            static constexpr bool Matches[] = {static_cast<bool>(Predicate<Types>::value)..., false};
         public:
-            static const int value = Predicate<Head>::value
-                ? 0
-                : (Search<Predicate, TypeList<Tail...>>::value >= 0
-                    ? Search<Predicate, TypeList<Tail...>>::value + 1
-                    : Search<Predicate, TypeList<Tail...>>::value);
+            static const int value = Private::FindFirst(Matches, sizeof...(Types));
         };
 
         // Thanks https://codereview.stackexchange.com/questions/131194/selection-sorting-a-type-list-compile-time
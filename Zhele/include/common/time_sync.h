@@ -0,0 +1,246 @@
+/**
+ * @file
+ * Implements cross-node time synchronization on capture timestamps
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_TIME_SYNC_COMMON_H
+#define ZHELE_TIME_SYNC_COMMON_H
+
+#include <stdint.h>
+
+namespace Zhele::Clock
+{
+    /**
+     * @brief Timestamps pin edges by input capture of timebase low timer
+     *
+     * @details
+     * Capture is done by hardware, so timestamp does not depend on interrupt latency.
+     * Connect radio IRQ (or UART RX) line to channel pin: the same pin may be used as EXTI source.
+     * 16-bit capture is extended to 32-bit timebase ticks in IrqHandler (call it from low timer IRQ handler).
+     * In one-shot mode only first edge after Arm is captured (first start bit of UART frame).
+     *
+     * @tparam _Timebase Timebase (TimerTimebase)
+     * @tparam _Channel Capture channel of timebase low timer
+     */
+    template<typename _Timebase, unsigned _Channel>
+    class TimebaseCapture
+    {
+        using Capture = typename _Timebase::LowTimer::template InputCapture<_Channel>;
+    public:
+        /**
+         * @brief Init capture (Timebase should be initialized)
+         *
+         * @tparam _Pin Channel pin
+         *
+         * @param [in] fallingEdge Capture falling edge (radio IRQ, UART start bit) or rising one
+         * @param [in] oneShot Capture only first edge after Arm
+         *
+         * @par Returns
+         *  Nothing
+         */
+        template<typename _Pin>
+        static void Init(bool fallingEdge = true, bool oneShot = false);
+
+        /**
+         * @brief Enables capture of next edge (one-shot mode)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Arm();
+
+        /**
+         * @brief Gets captured timestamp
+         *
+         * @param [out] timestamp Edge timestamp (timebase ticks)
+         *
+         * @retval true New timestamp is captured
+         * @retval false No edges since last call
+         */
+        static bool Get(uint32_t& timestamp);
+
+        /**
+         * @brief Capture IRQ handler. Call it from low timer IRQ handler
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void IrqHandler();
+
+    private:
+        static volatile uint32_t _timestamp;
+        static volatile bool _ready;
+        static bool _oneShot;
+    };
+
+    /**
+     * @brief Synchronization message
+     *
+     * @details
+     * Message carries transmission timestamp of previous message (one-step with delayed timestamp):
+     * transmitter time is captured on the same event as receiver time (for example, TX_DS and RX_DR
+     * radio interrupts, start bit on RS-485 bus), so constant delays cancel each other.
+     */
+    struct TimeSyncMessage
+    {
+        uint8_t Magic; ///< TimeSyncMessage::MagicValue
+        uint8_t Sequence; ///< Message number
+        uint8_t PreviousSequence; ///< Number of message with timestamp below
+        uint8_t PreviousTimestamp[4]; ///< Transmission time of previous message (master ticks, little endian)
+
+        static const uint8_t MagicValue = 0x75; ///< Magic value
+    };
+
+    /**
+     * @brief Time synchronization master
+     */
+    class TimeSyncMaster
+    {
+    public:
+        /**
+         * @brief Fills next synchronization message
+         *
+         * @param [out] message Message
+         *
+         * @par Returns
+         *  Nothing
+         */
+        void Prepare(TimeSyncMessage& message);
+
+        /**
+         * @brief Sets transmission time of last prepared message
+         *
+         * @param [in] timestamp Transmission timestamp (ticks)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        void OnTransmitted(uint32_t timestamp);
+
+    private:
+        uint32_t _timestamp = 0;
+        uint8_t _sequence = 0;
+        uint8_t _timestampSequence = 0xff;
+        bool _timestampValid = false;
+    };
+
+    /**
+     * @brief Time synchronization slave (disciplined clock)
+     *
+     * @details
+     * Every synchronization point (pair of master and local timestamps of the same event) steps offset
+     * to measured one, frequency error (drift) is estimated from intervals between points and filtered
+     * (exponential average, weight 2^-_DriftShift). Master time between points is extrapolated with drift,
+     * so alignment error is capture jitter plus residual drift by synchronization period
+     * (less than 1 us with 1 MHz ticks and 1 s period after drift converges).
+     * Point with too large prediction error is rejected (interference, missed capture),
+     * several rejected points in a row restart synchronization.
+     *
+     * @tparam _MaxError Max prediction error (ticks) of accepted synchronization point
+     * @tparam _DriftShift Drift filter shift
+     * @tparam _MaxRejected Rejected points in a row to restart synchronization
+     */
+    template<uint32_t _MaxError = 1000, uint8_t _DriftShift = 2, uint8_t _MaxRejected = 3>
+    class TimeSyncSlave
+    {
+    public:
+        /**
+         * @brief Constructs slave
+         *
+         * @param [in] latency Receiver latency relative to master timestamp (ticks, calibration constant)
+         */
+        TimeSyncSlave(int32_t latency = 0)
+            : _latency(latency)
+        {}
+
+        /**
+         * @brief Processes received synchronization message
+         *
+         * @param [in] message Message
+         * @param [in] timestamp Local reception timestamp (ticks) of this message
+         *
+         * @retval true Clock is updated
+         * @retval false Message does not carry timestamp of previous received one (or point is rejected)
+         */
+        bool OnReceived(const TimeSyncMessage& message, uint32_t timestamp);
+
+        /**
+         * @brief Adds synchronization point
+         *
+         * @param [in] master Master time of event
+         * @param [in] local Local time of event
+         *
+         * @retval true Clock is updated
+         * @retval false Point is rejected
+         */
+        bool Update(uint32_t master, uint32_t local);
+
+        /**
+         * @brief Converts local time to master time
+         *
+         * @param [in] local Local time (ticks)
+         *
+         * @returns Master time (ticks)
+         */
+        uint32_t ToMaster(uint32_t local) const;
+
+        /**
+         * @brief Converts master time to local time (for example, to schedule sampling at master time)
+         *
+         * @param [in] master Master time (ticks)
+         *
+         * @returns Local time (ticks)
+         */
+        uint32_t ToLocal(uint32_t master) const;
+
+        /**
+         * @brief Returns synchronization state
+         *
+         * @retval true Clock is synchronized (two points at least)
+         * @retval false Clock is not synchronized
+         */
+        bool Synchronized() const { return _points >= 2; }
+
+        /**
+         * @brief Returns prediction error of last synchronization point
+         *
+         * @returns Error (ticks, master minus predicted)
+         */
+        int32_t LastError() const { return _lastError; }
+
+        /**
+         * @brief Returns estimated drift
+         *
+         * @returns Master frequency relative to local one minus 1 (parts per 2^32)
+         */
+        int32_t Drift() const { return _drift; }
+
+        /**
+         * @brief Restarts synchronization
+         *
+         * @par Returns
+         *  Nothing
+         */
+        void Reset();
+
+    private:
+        int32_t _latency;
+        uint32_t _master = 0;
+        uint32_t _local = 0;
+        int32_t _drift = 0;
+        int32_t _lastError = 0;
+        uint32_t _rxTimestamp = 0;
+        uint8_t _rxSequence = 0;
+        bool _rxValid = false;
+        uint8_t _points = 0;
+        uint8_t _rejected = 0;
+    };
+}
+
+#include "impl/time_sync.h"
+
+#endif //! ZHELE_TIME_SYNC_COMMON_H
@@ -0,0 +1,157 @@
+/**
+ * @file
+ * Implements monotonic system timebase
+ * 
+ * @author Alexey Zhelonkin
+ * @date 2023
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_TIMEBASE_COMMON_H
+#define ZHELE_TIMEBASE_COMMON_H
+
+#include <stdint.h>
+
+#include "nvic.h"
+
+namespace Zhele::Clock
+{
+    /**
+     * @brief Implements 32/64-bit timebase on chained timers
+     * 
+     * @details
+     * Low timer counts ticks, its update event (TRGO) clocks high timer (slave external clock mode),
+     * so pair of 16-bit counters forms 32-bit counter without interrupts.
+     * High timer overflow interrupt extends counter to 64 bits (call UpdateIrqHandler from high timer IRQ handler).
+     * Counter reads are lock-free and can be performed from ISRs.
+     * Reading Ticks64 from ISR with priority higher than high timer IRQ
+     * is safe except short window inside UpdateIrqHandler.
+     * 
+     * @tparam _LowTimer Low (master) timer
+     * @tparam _HighTimer High (slave) timer
+     * @tparam _Trigger High timer internal trigger connected to low timer TRGO (see RM, "TIMx internal trigger connection")
+     * @tparam _TickFreq Tick frequency (should be multiple of 1 MHz)
+     */
+    template<typename _LowTimer, typename _HighTimer, typename _HighTimer::SlaveMode::Trigger _Trigger, unsigned long _TickFreq = 1000000>
+    class TimerTimebase
+    {
+        static_assert(_TickFreq % 1000000 == 0, "Tick frequency should be multiple of 1 MHz");
+        static const unsigned long TicksPerMicrosecond = _TickFreq / 1000000;
+    public:
+        /// Low timer (its counter is 16 LSB of ticks counter, so its capture channels timestamp events)
+        using LowTimer = _LowTimer;
+
+        /// Tick frequency
+        static const unsigned long TickFreq = _TickFreq;
+
+        /**
+         * @brief Init and start timebase
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Init();
+
+        /**
+         * @brief Returns 32-bit ticks counter
+         * 
+         * @returns Ticks count
+         */
+        static uint32_t Ticks();
+
+        /**
+         * @brief Returns 64-bit ticks counter
+         * 
+         * @returns Ticks count
+         */
+        static uint64_t Ticks64();
+
+        /**
+         * @brief Returns microseconds since Init (wraps)
+         * 
+         * @returns Microseconds count
+         */
+        static uint32_t Micros();
+
+        /**
+         * @brief Returns microseconds since Init
+         * 
+         * @returns Microseconds count
+         */
+        static uint64_t Micros64();
+
+        /**
+         * @brief High timer update IRQ handler
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void UpdateIrqHandler();
+
+    private:
+        static volatile uint32_t _overflows;
+    };
+
+#if defined (DWT_CTRL_CYCCNTENA_Msk)
+    /**
+     * @brief Implements timebase on DWT cycle counter (Cortex-M3 and above)
+     * 
+     * @details
+     * 32-bit counter (Ticks) is lock-free. 64-bit counter is extended in software (in short critical section),
+     * so Ticks64 (or Micros64) should be called at least once per CYCCNT period (2^32 / CpuFreq, ~59 s for 72 MHz),
+     * for example from SysTick handler.
+     * 
+     * @tparam _CpuFreq CPU frequency
+     */
+    template<unsigned long _CpuFreq = F_CPU>
+    class DwtTimebase
+    {
+        static_assert(_CpuFreq % 1000000 == 0, "CPU frequency should be multiple of 1 MHz");
+        static const unsigned long TicksPerMicrosecond = _CpuFreq / 1000000;
+    public:
+        /**
+         * @brief Init and start timebase
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Init();
+
+        /**
+         * @brief Returns 32-bit ticks (CPU cycles) counter
+         * 
+         * @returns Ticks count
+         */
+        static uint32_t Ticks();
+
+        /**
+         * @brief Returns 64-bit ticks (CPU cycles) counter
+         * 
+         * @returns Ticks count
+         */
+        static uint64_t Ticks64();
+
+        /**
+         * @brief Returns microseconds since Init (wraps)
+         * 
+         * @returns Microseconds count
+         */
+        static uint32_t Micros();
+
+        /**
+         * @brief Returns microseconds since Init
+         * 
+         * @returns Microseconds count
+         */
+        static uint64_t Micros64();
+
+    private:
+        static uint32_t _high;
+        static uint32_t _lastLow;
+    };
+#endif
+}
+
+#include "impl/timebase.h"
+
+#endif //! ZHELE_TIMEBASE_COMMON_H
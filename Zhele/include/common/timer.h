@@ -9,10 +9,13 @@
 #ifndef ZHELE_TIMER_COMMON_H
 #define ZHELE_TIMER_COMMON_H
 
+#include "bitband.h"
 #include "clock.h"
 #include "ioreg.h"
+#include <dma.h>
 #include "iopins.h"
 #include "macro_utils/enum.h"
+#include "nvic.h"
 #include "template_utils/type_list.h"
 #include "pinlist.h"
 
@@ -205,6 +208,16 @@ namespace Zhele::Timers
              * (auto-reload preload enable) bit in CR1 register
              */
             static Counter GetPeriod();
+
+            /**
+             * @brief Set update event rate (select prescaler and period)
+             * 
+             * @param [in] rate Update rate (Hz)
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void SetUpdateRate(uint32_t rate);
            
             /**
              * @brief Enable one-pulse mode
@@ -421,6 +434,69 @@ namespace Zhele::Timers
             };
 
         public:
+            /// First register of DMA burst (value of DBA field, register offset in words)
+            enum class DmaBurstBase : uint8_t
+            {
+                Cr1 = 0, ///< CR1 register
+                Cr2 = 1, ///< CR2 register
+                Smcr = 2, ///< SMCR register
+                Dier = 3, ///< DIER register
+                Sr = 4, ///< SR register
+                Egr = 5, ///< EGR register
+                Ccmr1 = 6, ///< CCMR1 register
+                Ccmr2 = 7, ///< CCMR2 register
+                Ccer = 8, ///< CCER register
+                Cnt = 9, ///< CNT register
+                Psc = 10, ///< PSC register
+                Arr = 11, ///< ARR register
+                Rcr = 12, ///< RCR register (advanced timers only)
+                Ccr1 = 13, ///< CCR1 register
+                Ccr2 = 14, ///< CCR2 register
+                Ccr3 = 15, ///< CCR3 register
+                Ccr4 = 16, ///< CCR4 register
+            };
+
+            /**
+             * @brief Start DMA burst updates of timer registers
+             * 
+             * @details
+             * Every update event DMA writes burstLength consecutive registers (starting from base)
+             * through DMAR register, values are taken from buffer one by one.
+             * So buffer contains updatesCount groups of burstLength values (for example ARR, CCR1
+             * or CCR1..CCR4 for every PWM period). Preload is enabled for ARR and CCRx registers
+             * in burst, so new values take effect from next period without glitches.
+             * In circular mode buffer is repeated endlessly: callback is called with sent half
+             * (ping-pong, see DmaChannel::PingPongTransfer), so updatesCount should be even.
+             * In single mode callback is called once after whole buffer is sent.
+             * 
+             * @tparam _DmaChannel DMA channel (stream) connected to timer update request
+             * 
+             * @param [in] base First register
+             * @param [in] burstLength Registers count in burst (1..18)
+             * @param [in] buffer Register values (burstLength * updatesCount elements)
+             * @param [in] updatesCount Updates (bursts) count
+             * @param [in] circular Circular (ping-pong) or single transfer
+             * @param [in] callback Half buffer (circular) or buffer (single) sent callback
+             * @param [in] dmaChannel DMA channel selection (for DMA with streams)
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            template<typename _DmaChannel>
+            static void StartDmaBurst(DmaBurstBase base, uint8_t burstLength, const uint16_t* buffer, uint16_t updatesCount,
+                bool circular = false, TransferCallback callback = nullptr ONLY_IF_STREAM_SUPPORTED(COMMA uint8_t dmaChannel = 0));
+
+            /**
+             * @brief Stop DMA burst updates
+             * 
+             * @tparam _DmaChannel DMA channel (stream) connected to timer update request
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            template<typename _DmaChannel>
+            static void StopDmaBurst();
+
             class SlaveMode
             {
             public:
@@ -531,6 +607,40 @@ namespace Zhele::Timers
                  *  Nothing
                  */
                 static void SetTriggerPrescaler(ExternalTriggerPrescaler prescaler);
+
+                /**
+                 * @brief Select external trigger (ETR) filter
+                 * 
+                 * @param filter Filter
+                 * 
+                 * @par Returns
+                 *  Nothing
+                 */
+                static void SetExternalTriggerFilter(ExternalTriggerFilter filter);
+
+                /**
+                 * @brief Select external trigger (ETR) polarity
+                 * 
+                 * @param polarity Polarity (inverted counts falling edges)
+                 * 
+                 * @par Returns
+                 *  Nothing
+                 */
+                static void SetExternalTriggerPolarity(ExternalTriggerPolarity polarity);
+
+                /**
+                 * @brief Enable or disable external clock mode 2 (counter is clocked by ETR)
+                 * 
+                 * @details
+                 * Mode 2 can be combined with reset, gated and trigger slave modes
+                 * (trigger input should not be ETR in this case).
+                 * 
+                 * @param mode Mode
+                 * 
+                 * @par Returns
+                 *  Nothing
+                 */
+                static void SetExternalClockMode2(ExternalClockMode2 mode);
             };
 
             /**
@@ -562,6 +672,15 @@ namespace Zhele::Timers
                     CaptureTrc = TIM_CCMR1_CC1S_0 | TIM_CCMR1_CC1S_1 ///< Capture input TRC
                 };
 
+                /// Capture prescaler (capture is done once every N events)
+                enum class CapturePrescaler : uint8_t
+                {
+                    Div1 = 0, ///< Every event
+                    Div2 = TIM_CCMR1_IC1PSC_0, ///< Once every 2 events
+                    Div4 = TIM_CCMR1_IC1PSC_1, ///< Once every 4 events
+                    Div8 = TIM_CCMR1_IC1PSC ///< Once every 8 events
+                };
+
                 /**
                  * @brief Set capture polarity
                  * 
@@ -582,6 +701,16 @@ namespace Zhele::Timers
                  */
                 static void SetCaptureMode(CaptureMode mode);
 
+                /**
+                 * @brief Set capture prescaler
+                 * 
+                 * @param [in] prescaler Capture prescaler
+                 * 
+                 * @par Returns
+                 *  Nothing
+                 */
+                static void SetCapturePrescaler(CapturePrescaler prescaler);
+
                 /**
                  * @brief Get the Value object
                  * 
@@ -589,6 +718,60 @@ namespace Zhele::Timers
                  */
                 static typename Base::Counter GetValue();
 
+                /**
+                 * @brief Start capture stream to ping-pong buffer
+                 * 
+                 * @details
+                 * Every capture event DMA copies capture register to buffer, so edges are timestamped
+                 * without interrupt per edge. Buffer is divided into two halves: callback is called with
+                 * filled half (pointer and elements count) while DMA fills other one.
+                 * Raw values are 16-bit counter values, use CaptureTimestamps to extend them to 32 bits.
+                 * 
+                 * @tparam _DmaChannel DMA channel (stream) connected to channel capture request
+                 * 
+                 * @param [out] buffer Buffer with 2 * halfSize elements
+                 * @param [in] halfSize Elements count in one half of buffer
+                 * @param [in] callback Half buffer filled callback
+                 * @param [in] dmaChannel DMA channel selection (for DMA with streams)
+                 * 
+                 * @par Returns
+                 *  Nothing
+                 */
+                template<typename _DmaChannel>
+                static void StartCaptureStream(uint16_t* buffer, uint16_t halfSize, TransferCallback callback
+                    ONLY_IF_STREAM_SUPPORTED(COMMA uint8_t dmaChannel = 0));
+
+                /**
+                 * @brief Start capture to ring buffer
+                 * 
+                 * @details
+                 * DMA writes capture values to circular buffer without interrupts, reader polls
+                 * write position (buffer size minus DMA remaining transfers). Stop by StopCaptureStream.
+                 * 
+                 * @tparam _DmaChannel DMA channel (stream) connected to channel capture request
+                 * 
+                 * @param [out] buffer Ring buffer
+                 * @param [in] size Buffer size (elements count)
+                 * @param [in] dmaChannel DMA channel selection (for DMA with streams)
+                 * 
+                 * @par Returns
+                 *  Nothing
+                 */
+                template<typename _DmaChannel>
+                static void StartCaptureRing(uint16_t* buffer, uint16_t size
+                    ONLY_IF_STREAM_SUPPORTED(COMMA uint8_t dmaChannel = 0));
+
+                /**
+                 * @brief Stop capture stream
+                 * 
+                 * @tparam _DmaChannel DMA channel (stream) connected to channel capture request
+                 * 
+                 * @par Returns
+                 *  Nothing
+                 */
+                template<typename _DmaChannel>
+                static void StopCaptureStream();
+
                 /**
                  * @brief Select channel pin
                  * 
@@ -784,19 +967,184 @@ namespace Zhele::Timers
         /**
          * @brief Class implements STM32 advanced timer`s functional.
          * 
+         * @details
+         * Advanced timer extends general-purpose timer with complementary outputs (CHxN),
+         * dead-time generation, break input and repetition counter.
+         * 
          * @tparam _Regs Timer`s register wrapper
          * @tparam _ClockEnReg Timer`s clock
          * @tparam _IRQNumber Timer`s IRQ number
          * @tparam _ChPins Channel`s pins
-         * 
-         * @todo Implements this class!
+         * @tparam _ChNPins Complementary channel`s pins
+         * @tparam _BreakPins Break input pins
+         * @tparam _BreakIRQNumber Timer`s break IRQ number
          */
-        template<typename _Regs, typename _ClockEnReg, IRQn_Type _IRQNumber, template<unsigned> typename _ChPins>
+        template<typename _Regs, typename _ClockEnReg, IRQn_Type _IRQNumber, template<unsigned> typename _ChPins,
+            template<unsigned> typename _ChNPins, typename _BreakPins, IRQn_Type _BreakIRQNumber>
         class AdvancedTimer : public GPTimer<_Regs, _ClockEnReg, _IRQNumber, _ChPins>
         {
             using Base = GPTimer<_Regs, _ClockEnReg, _IRQNumber, _ChPins>;
 
         public:
+            /// Break input polarity
+            enum class BreakPolarity : uint16_t
+            {
+                ActiveLow = 0, ///< Break input is active low
+                ActiveHigh = TIM_BDTR_BKP, ///< Break input is active high
+            };
+
+            /// Registers lock level (see LOCK bits in BDTR)
+            enum class LockLevel : uint16_t
+            {
+                Off = 0x00 << TIM_BDTR_LOCK_Pos, ///< No lock
+                Level1 = 0x01 << TIM_BDTR_LOCK_Pos, ///< Dead time, break, idle states are locked
+                Level2 = 0x02 << TIM_BDTR_LOCK_Pos, ///< Level 1 + polarity and off-state selection
+                Level3 = 0x03 << TIM_BDTR_LOCK_Pos, ///< Level 2 + output compare modes
+            };
+
+            /**
+             * @brief Converts dead time (in timer clock ticks) to DTG field value
+             * 
+             * @param [in] ticks Dead time in timer clock ticks (up to 1008)
+             * 
+             * @returns DTG field value (dead time is rounded up, saturated at 1008 ticks)
+             */
+            static constexpr uint8_t DeadTimeToDtg(unsigned ticks)
+            {
+                return ticks < 128 ? ticks
+                    : ticks < 256 ? (0x80 | ((ticks + 1) / 2 - 64))
+                    : ticks < 512 ? (0xc0 | ((ticks + 7) / 8 - 32))
+                    : ticks < 1008 ? (0xe0 | ((ticks + 15) / 16 - 32))
+                    : 0xff;
+            }
+
+            /**
+             * @brief Set dead time (DTG field value)
+             * 
+             * @param [in] dtg DTG field value (see reference manual or DeadTimeToDtg)
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void SetDeadTime(uint8_t dtg);
+
+            /**
+             * @brief Set dead time in nanoseconds
+             * 
+             * @details
+             * Dead time is inserted between output and complementary output switching. It is calculated
+             * from timer clock (clock division CKD = 1), max value is 1008 timer clock ticks.
+             * 
+             * @param [in] nanoseconds Dead time (ns)
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void SetDeadTimeNs(unsigned nanoseconds);
+
+            /**
+             * @brief Enable break input
+             * 
+             * @details
+             * Active break level disables outputs (MOE is reset) asynchronously, without CPU,
+             * outputs are switched to idle states (see ComplementaryPWMGeneration::SetIdleState).
+             * 
+             * @param [in] polarity Break input polarity
+             * @param [in] automaticOutput Set MOE automatically at next update event after break is released
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void EnableBreak(BreakPolarity polarity, bool automaticOutput = false);
+
+            /**
+             * @brief Disable break input
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void DisableBreak();
+
+            /**
+             * @brief Select break input pin
+             * 
+             * @tparam Pin Pin class
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            template<typename Pin>
+            static void SelectBreakPins();
+
+            /**
+             * @brief Enable break interrupt
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void EnableBreakInterrupt();
+
+            /**
+             * @brief Disable break interrupt
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void DisableBreakInterrupt();
+
+            /**
+             * @brief Check break flag
+             * 
+             * @retval true Break has been occured
+             * @retval false No break
+             */
+            static bool IsBreak();
+
+            /**
+             * @brief Clear break flag
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void ClearBreakFlag();
+
+            /**
+             * @brief Enable main output (set MOE)
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void EnableOutputs();
+
+            /**
+             * @brief Disable main output (reset MOE)
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void DisableOutputs();
+
+            /**
+             * @brief Set off-state selection
+             * 
+             * @param [in] runMode Drive outputs with inactive level in run mode (OSSR) instead of disabling them
+             * @param [in] idleMode Drive outputs with idle level in idle mode (OSSI) instead of disabling them
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void SetOffStateSelection(bool runMode, bool idleMode);
+
+            /**
+             * @brief Lock configuration (until reset)
+             * 
+             * @param [in] level Lock level
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void Lock(LockLevel level);
+
             /**
              * @brief Set repetition counter (RCR reister)
              * 
@@ -813,8 +1161,139 @@ namespace Zhele::Timers
              * @returns Current RCR register value
              */
             static uint8_t GetRepetitionCounter();
+
+            /**
+             * @brief Internal class for PWM with complementary output
+             * 
+             * @tparam _ChannelNumber Channel number (0..2)
+             */
+            template<unsigned _ChannelNumber>
+            class ComplementaryPWMGeneration : public Base::template PWMGeneration<_ChannelNumber>
+            {
+                static_assert(_ChannelNumber < 3, "Only channels 1-3 have complementary outputs");
+            public:
+                using ComplementaryPins = typename _ChNPins<_ChannelNumber>::Pins::Key;
+                using ComplementaryPinsAltFuncNumber = typename _ChNPins<_ChannelNumber>::Pins::Value;
+                using OutputPolarity = typename Base::template OutputCompare<_ChannelNumber>::OutputPolarity;
+
+                /**
+                 * @brief Enable complementary output
+                 * 
+                 * @par Returns
+                 *  Nothing
+                 */
+                static void EnableComplementary();
+
+                /**
+                 * @brief Disable complementary output
+                 * 
+                 * @par Returns
+                 *  Nothing
+                 */
+                static void DisableComplementary();
+
+                /**
+                 * @brief Set complementary output polarity
+                 * 
+                 * @param [in] polarity Output polarity
+                 * 
+                 * @par Returns
+                 *  Nothing
+                 */
+                static void SetComplementaryPolarity(OutputPolarity polarity);
+
+                /**
+                 * @brief Set outputs levels when main output is disabled (MOE = 0)
+                 * 
+                 * @param [in] output Output idle level
+                 * @param [in] complementary Complementary output idle level
+                 * 
+                 * @par Returns
+                 *  Nothing
+                 */
+                static void SetIdleState(bool output, bool complementary);
+
+                /**
+                 * @brief Select complementary channel pin
+                 * 
+                 * @param [in] pinNumber Pin number
+                 * 
+                 * @par Returns
+                 *  Nothing
+                 */
+                static void SelectComplementaryPins(int pinNumber);
+
+                /**
+                 * @brief Select complementary channel pin by number (template method)
+                 * 
+                 * @tparam PinNumber Pin number
+                 * 
+                 * @par Returns
+                 *  Nothing
+                 */
+                template<unsigned PinNumber>
+                static void SelectComplementaryPins();
+
+                /**
+                 * @brief Select complementary channel pin (template method)
+                 * 
+                 * @tparam Pin Pin class
+                 * 
+                 * @par Returns
+                 *  Nothing
+                 */
+                template<typename Pin>
+                static void SelectComplementaryPins();
+            };
         };
     }
+
+    /**
+     * @brief Extends 16-bit capture values to 32-bit timestamps
+     * 
+     * @details
+     * Timestamp is accumulated from differences between consecutive captures, so it is monotonic
+     * and does not depend on buffer (block) boundaries. Interval between two consecutive edges
+     * should be less than timer period (65536 ticks for full period), otherwise overflows are lost:
+     * select prescaler for the longest expected gap.
+     */
+    class CaptureTimestamps
+    {
+    public:
+        /**
+         * @brief Convert captures block to timestamps
+         * 
+         * @param [in] captures Raw capture values
+         * @param [in] count Values count
+         * @param [out] timestamps 32-bit timestamps
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        void Process(const uint16_t* captures, unsigned count, uint32_t* timestamps)
+        {
+            for(unsigned i = 0; i < count; ++i)
+            {
+                _timestamp += static_cast<uint16_t>(captures[i] - _lastCapture);
+                _lastCapture = captures[i];
+                timestamps[i] = _timestamp;
+            }
+        }
+
+        /**
+         * @brief Returns last timestamp
+         * 
+         * @returns Timestamp of last processed capture
+         */
+        uint32_t Last() const
+        {
+            return _timestamp;
+        }
+
+    private:
+        uint32_t _timestamp = 0;
+        uint16_t _lastCapture = 0;
+    };
 }
 
 #include "impl/timer.h"
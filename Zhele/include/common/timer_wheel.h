@@ -0,0 +1,154 @@
+/**
+ * @file
+ * Implements software timers service (hierarchical timer wheel)
+ * 
+ * @author Alexey Zhelonkin
+ * @date 2023
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_TIMER_WHEEL_COMMON_H
+#define ZHELE_TIMER_WHEEL_COMMON_H
+
+#include <stdint.h>
+
+#include "template_utils/inplace_function.h"
+#include "nvic.h"
+
+namespace Zhele::Timers
+{
+    /// Software timer callback type
+    using SoftTimerCallback = TemplateUtils::InplaceFunction<void()>;
+
+    template<typename _Timer, unsigned _ChannelNumber, unsigned _Levels>
+    class TimerWheel;
+
+    /**
+     * @brief Software timer
+     * 
+     * @details
+     * Timer object is owned by user (static or global storage) and linked into wheel by Start method.
+     * Timer object should not be destroyed while it is active.
+     */
+    class SoftTimer
+    {
+        template<typename _Timer, unsigned _ChannelNumber, unsigned _Levels>
+        friend class TimerWheel;
+    public:
+        /**
+         * @brief Returns timer state
+         * 
+         * @retval true Timer is started (waits for expiration)
+         * @retval false Timer is stopped
+         */
+        bool IsActive() const
+        {
+            return _pprev != nullptr;
+        }
+
+    private:
+        SoftTimer* _next = nullptr;
+        SoftTimer** _pprev = nullptr;
+        uint32_t _expires = 0;
+        uint32_t _period = 0;
+        uint16_t _bucket = 0;
+        SoftTimerCallback _callback;
+    };
+
+    /**
+     * @brief Implements software timers service driven by one hardware timer
+     * 
+     * @details
+     * Timers are stored in hierarchical wheel (_Levels levels, 32 slots each, intrusive doubly linked lists),
+     * so start and stop are O(1) and don't depend on active timers count.
+     * Hardware timer counter is free-running, output compare channel is reprogrammed
+     * to the next deadline (or slot cascade point), so there are no periodic tick interrupts.
+     * Max delay is 2^(5 * _Levels) - 1 ticks, longer delays are cascaded several times.
+     * Callbacks are called from timer IRQ handler (call IrqHandler from timer interrupt handler).
+     * 
+     * @tparam _Timer General purpose timer
+     * @tparam _ChannelNumber Output compare channel number
+     * @tparam _Levels Wheel levels count (1..6)
+     */
+    template<typename _Timer, unsigned _ChannelNumber = 0, unsigned _Levels = 5>
+    class TimerWheel
+    {
+        static_assert(_Levels > 0 && _Levels <= 6, "Timer wheel supports 1..6 levels");
+
+        using Channel = typename _Timer::template OutputCompare<_ChannelNumber>;
+
+        static const unsigned SlotBits = 5;
+        static const unsigned SlotsCount = 1 << SlotBits;
+        static const uint32_t MaxDelta = (_Levels * SlotBits < 32) ? (1ul << (_Levels * SlotBits)) - 1 : 0xffffffff;
+        // Hardware compare is programmed not later then half of counter period, so software time is extended correctly
+        static const uint16_t MaxCompareDelta = 0x8000;
+    public:
+        /**
+         * @brief Init hardware timer and start service
+         * 
+         * @param [in] tickFreq Tick frequency (Hz)
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Init(unsigned tickFreq);
+
+        /**
+         * @brief Start (or restart) software timer
+         * 
+         * @param [in] timer Timer
+         * @param [in] delay Delay before first call (ticks, should be greater than zero)
+         * @param [in] callback Callback
+         * @param [in] period Period (ticks) for periodic timer or 0 for one-shot timer
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Start(SoftTimer& timer, uint32_t delay, SoftTimerCallback callback, uint32_t period = 0);
+
+        /**
+         * @brief Stop (cancel) software timer
+         * 
+         * @param [in] timer Timer
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Stop(SoftTimer& timer);
+
+        /**
+         * @brief Returns current time
+         * 
+         * @returns Ticks count since Init (wraps)
+         */
+        static uint32_t Now();
+
+        /**
+         * @brief Timer IRQ handler
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void IrqHandler();
+
+    private:
+        static void UpdateTime();
+        static void Link(SoftTimer* timer);
+        static void Unlink(SoftTimer* timer);
+        static bool NextEvent(uint32_t& time);
+        static void Cascade(unsigned level);
+        static SoftTimer* PopExpired();
+        static void Reschedule();
+        static void Process();
+
+        static SoftTimer* _slots[_Levels][SlotsCount];
+        static uint32_t _occupied[_Levels];
+        static uint32_t _now;
+        static uint32_t _time;
+        static uint16_t _lastCounter;
+    };
+}
+
+#include "impl/timer_wheel.h"
+
+#endif //! ZHELE_TIMER_WHEEL_COMMON_H
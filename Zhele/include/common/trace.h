@@ -0,0 +1,183 @@
+/**
+ * @file
+ * Implements lightweight event tracing
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_TRACE_COMMON_H
+#define ZHELE_TRACE_COMMON_H
+
+/*
+ * Trace options:
+ *  - ZHELE_TRACE - enable tracing (otherwise trace macros expand to nothing);
+ *  - ZHELE_TRACE_BUFFER_SIZE - trace ring buffer size in records (power of 2, default 64);
+ *  - ZHELE_TRACE_ITM_PORT - ITM stimulus port for DrainItm (default 0);
+ *  - ZHELE_TRACE_DRAIN_RECORDS - max records per one DrainUsart transfer (default 16).
+ */
+#if defined (ZHELE_TRACE)
+
+#include <atomic>
+#include <stdint.h>
+
+#if !defined (ZHELE_TRACE_BUFFER_SIZE)
+    #define ZHELE_TRACE_BUFFER_SIZE 64
+#endif
+#if !defined (ZHELE_TRACE_ITM_PORT)
+    #define ZHELE_TRACE_ITM_PORT 0
+#endif
+#if !defined (ZHELE_TRACE_DRAIN_RECORDS)
+    #define ZHELE_TRACE_DRAIN_RECORDS 16
+#endif
+
+namespace Zhele::Trace
+{
+    /**
+     * @brief Library trace events (application events should start from User)
+     */
+    enum class Event : uint16_t
+    {
+        DmaIrqEnter = 1, ///< DMA channel IRQ handler entry (payload: channel registers address)
+        DmaIrqExit = 2, ///< DMA channel IRQ handler exit (payload: channel registers address)
+        UsbEndpoint = 3, ///< USB endpoint handler (payload: number | direction << 8)
+        I2cEvent = 4, ///< I2C event IRQ (payload: SR1 | state << 16, ISR on MCUs with TIMINGR)
+        I2cError = 5, ///< I2C error IRQ (payload: SR1 | state << 16, ISR on MCUs with TIMINGR)
+        User = 0x100, ///< First application event
+    };
+
+    /**
+     * @brief Trace record
+     */
+    struct Record
+    {
+        uint32_t Timestamp; ///< CPU cycles counter (DWT CYCCNT), 0 if MCU has no cycle counter
+        uint32_t Id; ///< Event id
+        uint32_t Payload; ///< Event payload
+    };
+
+    /**
+     * @brief Trace ring buffer
+     *
+     * @details
+     * Records are written from any context (thread or interrupts), writer reserves slot by atomic increment
+     * (interrupts are disabled for a few instructions on Cortex-M0, which has no exclusive access instructions).
+     * If reader is slower than writers, oldest records are overwritten and counted as dropped.
+     *
+     * @tparam _Size Buffer size (in records, power of 2)
+     */
+    template<unsigned _Size>
+    class TraceBuffer
+    {
+        static_assert((_Size & (_Size - 1)) == 0, "Trace buffer size should be power of 2.");
+    public:
+        /**
+         * @brief Enables cycles counter for timestamps
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Enable();
+
+        /**
+         * @brief Writes record
+         *
+         * @param [in] id Event id
+         * @param [in] payload Event payload
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Write(uint32_t id, uint32_t payload);
+
+        /**
+         * @brief Reads records
+         *
+         * @param [out] records Destination
+         * @param [in] count Max records count
+         *
+         * @returns Read records count
+         */
+        static unsigned Read(Record* records, unsigned count);
+
+        /**
+         * @brief Returns dropped (overwritten) records count
+         *
+         * @returns Dropped records count
+         */
+        static uint32_t Dropped();
+
+        /**
+         * @brief Writes all pending records to ITM stimulus port (SWO).
+         *
+         * @details
+         * Does nothing if ITM or stimulus port is disabled (debugger does not capture SWO).
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void DrainItm();
+
+        /**
+         * @brief Starts async (DMA) write of pending records to USART
+         *
+         * @details
+         * Call periodically (for example, from main loop). Records are written in binary form (see Record),
+         * new transfer starts only after previous one completes.
+         *
+         * @tparam _Usart USART
+         *
+         * @retval true Transfer started
+         * @retval false No pending records or previous transfer is not completed
+         */
+        template<typename _Usart>
+        static bool DrainUsart();
+
+    private:
+        static Record _records[_Size];
+        static std::atomic<uint32_t> _head;
+        static std::atomic<uint32_t> _tail;
+        static std::atomic<uint32_t> _dropped;
+    };
+
+    /// Trace buffer
+    using Buffer = TraceBuffer<ZHELE_TRACE_BUFFER_SIZE>;
+
+    /**
+     * @brief Writes trace record on construction and destruction (scope entry/exit)
+     */
+    class Scope
+    {
+    public:
+        Scope(Event enter, Event exit, uint32_t payload)
+            : _exit(exit), _payload(payload)
+        {
+            Buffer::Write(static_cast<uint32_t>(enter), payload);
+        }
+
+        ~Scope()
+        {
+            Buffer::Write(static_cast<uint32_t>(_exit), _payload);
+        }
+    private:
+        Event _exit;
+        uint32_t _payload;
+    };
+}
+
+/// Writes trace record
+#define ZHELE_TRACE_EVENT(ID, PAYLOAD) ::Zhele::Trace::Buffer::Write(static_cast<uint32_t>(ID), static_cast<uint32_t>(PAYLOAD))
+/// Writes trace records on scope entry and exit
+#define ZHELE_TRACE_SCOPE(ENTER_ID, EXIT_ID, PAYLOAD) ::Zhele::Trace::Scope zheleTraceScope(ENTER_ID, EXIT_ID, static_cast<uint32_t>(PAYLOAD))
+
+#include "impl/trace.h"
+
+#else
+
+#define ZHELE_TRACE_EVENT(ID, PAYLOAD)
+#define ZHELE_TRACE_SCOPE(ENTER_ID, EXIT_ID, PAYLOAD)
+
+#endif
+
+#endif //! ZHELE_TRACE_COMMON_H
@@ -10,13 +10,25 @@
 #ifndef ZHELE_UART_COMMON_H
 #define ZHELE_UART_COMMON_H
 
+#include "bitband.h"
 #include "clock.h"
 #include "dma.h"
 #include "iopins.h"
 #include "ioreg.h"
+#include "nvic.h"
 #include "pinlist.h"
+#include "statistics.h"
 
 #include "./template_utils/data_transfer.h"
+#include "../containers/ring_buffer.h"
+
+#if !defined(ZHELE_USART_TX_QUEUE_SIZE)
+    #define ZHELE_USART_TX_QUEUE_SIZE 8
+#endif
+
+#if !defined(ZHELE_USART_FRAME_QUEUE_SIZE)
+    #define ZHELE_USART_FRAME_QUEUE_SIZE 8
+#endif
 
 namespace Zhele
 {
@@ -54,6 +66,36 @@ namespace Zhele
                 TxEnable = USART_CR1_TE,
                 RxTxEnable  = USART_CR1_RE | USART_CR1_TE,
                 Default = RxTxEnable,
+
+                Oversampling16 = 0,
+                Oversampling8 = ///< Oversampling by 8 (2x higher max baud rate, less noise tolerance)
+                #if defined (USART_CR1_OVER8)
+                    USART_CR1_OVER8,
+                #else
+                    0,
+                #endif
+
+                NoMute = 0,
+                IdleLineWakeup = ///< Mute mode, receiver wakes up on idle line (see EnterMuteMode)
+                #if defined (USART_CR1_MME)
+                    USART_CR1_MME,
+                #else
+                    0,
+                #endif
+                AddressMarkWakeup = ///< Mute mode, receiver wakes up on address character with node address (see EnterMuteMode)
+                #if defined (USART_CR1_MME)
+                    USART_CR1_MME | USART_CR1_WAKE,
+                #else
+                    USART_CR1_WAKE,
+                #endif
+
+                FifoDisable = 0,
+                FifoEnable = ///< TX/RX FIFO mode (8 data words each)
+                #if defined (USART_CR1_FIFOEN)
+                    USART_CR1_FIFOEN
+                #else
+                    0
+                #endif
             } CR1;
 
             enum _CR2 : uint32_t
@@ -64,9 +106,33 @@ namespace Zhele
                 OneStopBit         = 0,
                 HalfStopBit        = USART_CR2_STOP_0,
                 TwoStopBits        = USART_CR2_STOP_1,
-                OneAndHalfStopBits = (USART_CR2_STOP_0 | USART_CR2_STOP_1)
+                OneAndHalfStopBits = (USART_CR2_STOP_0 | USART_CR2_STOP_1),
+
+                Address4Bit = 0,
+                Address7Bit = ///< 7-bit node address (8-bit in 9-bit data mode) instead of 4-bit one
+                #if defined (USART_CR2_ADDM7)
+                    USART_CR2_ADDM7
+                #else
+                    0
+                #endif
             } CR2;
 
+            /**
+             * @brief Node address for address mark wakeup
+             *
+             * @details
+             * 4 LSB of address are compared with 4 LSB of address character (USART with 4-bit address
+             * detection only and Address4Bit mode), whole address otherwise (Address7Bit mode).
+             *
+             * @param [in] address Node address
+             *
+             * @returns CR2 flags
+             */
+            static constexpr _CR2 NodeAddress(uint8_t address)
+            {
+                return static_cast<_CR2>((static_cast<uint32_t>(address) << USART_CR2_ADD_Pos) & USART_CR2_ADD);
+            }
+
             enum _CR3 : uint32_t
             {
                 FullDuplex = 0,
@@ -79,6 +145,22 @@ namespace Zhele
                 #else
                     0
                 #endif
+            #if defined (USART_CR3_TXFTCFG)
+                ,
+                TxFifoThreshold1_8 = 0,
+                TxFifoThreshold1_4 = 1u << USART_CR3_TXFTCFG_Pos,
+                TxFifoThreshold1_2 = 2u << USART_CR3_TXFTCFG_Pos,
+                TxFifoThreshold3_4 = 3u << USART_CR3_TXFTCFG_Pos,
+                TxFifoThreshold7_8 = 4u << USART_CR3_TXFTCFG_Pos,
+                TxFifoEmpty = 5u << USART_CR3_TXFTCFG_Pos,
+
+                RxFifoThreshold1_8 = 0,
+                RxFifoThreshold1_4 = 1u << USART_CR3_RXFTCFG_Pos,
+                RxFifoThreshold1_2 = 2u << USART_CR3_RXFTCFG_Pos,
+                RxFifoThreshold3_4 = 3u << USART_CR3_RXFTCFG_Pos,
+                RxFifoThreshold7_8 = 4u << USART_CR3_RXFTCFG_Pos,
+                RxFifoFull = 5u << USART_CR3_RXFTCFG_Pos,
+            #endif
             } CR3;
 
             UsartMode operator | (UsartMode::_CR1 flag)
@@ -114,6 +196,8 @@ namespace Zhele
 
             ErrorInt       = USART_SR_FE | USART_SR_NE | USART_SR_ORE,	
             CtsInt         = USART_SR_CTS,
+            TxFifoThresholdInt = 0,
+            RxFifoThresholdInt = 0,
         #endif
         #if defined (USART_ISR_PE)
             ParityErrorInt = USART_ISR_PE,	///< Parity error
@@ -128,8 +212,16 @@ namespace Zhele
             #endif
             ErrorInt       = USART_ISR_FE | USART_ISR_NE | USART_ISR_ORE,	
             CtsInt         = USART_ISR_CTS,
+            #if defined(USART_ISR_TXFT)
+            TxFifoThresholdInt = USART_ISR_TXFT, ///< TX FIFO reached threshold (FIFO mode)
+            RxFifoThresholdInt = USART_ISR_RXFT, ///< RX FIFO reached threshold (FIFO mode)
+            #else
+            TxFifoThresholdInt = 0,
+            RxFifoThresholdInt = 0,
+            #endif
         #endif
             AllInterrupts  = ParityErrorInt | TxEmptyInt | TxCompleteInt | RxNotEmptyInt | IdleInt | LineBreakInt | ErrorInt | CtsInt
+                | TxFifoThresholdInt | RxFifoThresholdInt
         };
 
         enum Error
@@ -149,12 +241,86 @@ namespace Zhele
         #endif
         };
 
+    #if defined (USART_CR2_ABREN)
+        /**
+         * @brief Auto baud rate detection mode
+         */
+        enum class AutoBaudMode : uint32_t
+        {
+            StartBit = 0, ///< Start bit duration (first character LSB should be 1)
+        #if defined (USART_CR2_ABRMODE)
+            FallingEdge = USART_CR2_ABRMODE_0, ///< Falling edges distance (first character starts with 10xx bits)
+            Frame7F = USART_CR2_ABRMODE_1, ///< 0x7F character
+            Frame55 = USART_CR2_ABRMODE_0 | USART_CR2_ABRMODE_1 ///< 0x55 ('U') character
+        #endif
+        };
+    #endif
+
+    #if defined (USART_CR3_WUS)
+        /**
+         * @brief Wakeup from Stop mode event
+         */
+        enum class WakeupSource : uint32_t
+        {
+            AddressMatch = 0, ///< Address character with node address (see UsartMode::NodeAddress)
+            StartBit = USART_CR3_WUS_1, ///< Start bit of any character
+            RxNotEmpty = USART_CR3_WUS_0 | USART_CR3_WUS_1 ///< Received character
+        };
+    #endif
+
+        /// Auto baud rate detection callback (detected baud rate)
+        using AutoBaudCallback = void(*)(unsigned baud);
+
+        /**
+         * @brief Transmit queue item
+         */
+        struct TxDescriptor
+        {
+            const void* data; ///< Data to write
+            uint16_t size; ///< Data size
+        };
+
+        /**
+         * @brief Received frame (frame read mode)
+         */
+        struct RxFrame
+        {
+            const uint8_t* data; ///< Frame data
+            uint16_t size; ///< Size of contiguous part of frame
+            const uint8_t* wrappedData; ///< Rest of frame at receive buffer start (if frame wraps buffer end), nullptr otherwise
+            uint16_t wrappedSize; ///< Size of rest of frame
+        };
+
+        /**
+         * @brief Baud rate register configuration
+         */
+        struct BaudConfig
+        {
+            uint16_t Brr; ///< BRR register value (0 if baud rate is unreachable)
+            bool Over8; ///< Oversampling by 8 (instead of 16)
+            uint16_t Error; ///< Baud rate error (in 0.01%)
+        };
+
+        /**
+         * @brief Calculate BRR (and oversampling) for baud rate
+         *
+         * @details
+         * Oversampling by 16 is used if it gives the same or better accuracy (it is more tolerant to noise),
+         * oversampling by 8 (if MCU supports it) gives 2x higher max baud rate and finer divider.
+         *
+         * @param [in] clock USART clock frequence
+         * @param [in] baud Baud rate
+         *
+         * @returns Baud rate configuration
+         */
+        static constexpr BaudConfig CalculateBaud(uint32_t clock, uint32_t baud);
+
     protected:
         static const unsigned ErrorMask = OverrunError | NoiseError | FramingError | ParityError;
 
         static const unsigned InterruptMask = ParityErrorInt | TxEmptyInt |
                 TxCompleteInt | RxNotEmptyInt | IdleInt | LineBreakInt |
-                ErrorInt | CtsInt;
+                ErrorInt | CtsInt | TxFifoThresholdInt | RxFifoThresholdInt;
     };
     
     static const UsartBase::UsartMode DefaultUsartMode = {
@@ -164,10 +330,46 @@ namespace Zhele
 
     namespace Private
     {
+        /**
+         * @brief USART stream read data
+         */
+        struct UsartStreamData
+        {
+            uint8_t* buffer = nullptr; ///< Circular receive buffer
+            uint16_t size = 0; ///< Receive buffer size
+            volatile uint16_t readIndex = 0; ///< Read position
+            volatile uint16_t notifyIndex = 0; ///< Position of last notification
+            TransferCallback callback = nullptr; ///< New data callback
+        };
+
+        /**
+         * @brief USART frame read data
+         */
+        struct UsartFrameData
+        {
+            volatile uint16_t start = 0; ///< Start position of receiving frame
+            volatile bool enabled = false; ///< Frame read mode enabled
+            TransferCallback callback = nullptr; ///< Frame received callback
+        };
+
+        /**
+         * @brief Received frame position in stream buffer
+         */
+        struct UsartFrameDescriptor
+        {
+            uint16_t offset; ///< Frame start
+            uint16_t size; ///< Frame size
+        };
+
         template<typename _Regs, IRQn_Type _IRQNumber, typename _ClockCtrl, typename _TxPins, typename _RxPins, typename _DmaTx, typename _DmaRx>
         class Usart : public UsartBase
         {
         public:
+        #if defined (ZHELE_STATISTICS)
+            /// Runtime statistics (errors counters)
+            static UsartStatistics Statistics;
+        #endif
+
             /**
              * @brief Initialize USART
              * 
@@ -179,6 +381,23 @@ namespace Zhele
              */
             template<unsigned long baud>
             static inline void Init(UsartMode mode = DefaultUsartMode);
+
+            /**
+             * @brief Initialize USART with baud rate calculated at compile time
+             * 
+             * @details
+             * BRR and oversampling are selected from constant bus clock of clock tree (Oversampling8 flag
+             * of mode is ignored), build fails if baud rate error is more than 2%.
+             * 
+             * @tparam baud Baud rate
+             * @tparam _ClockTree Clock tree (Clock::ClockTree)
+             * @param [in] mode Mode
+             * 
+             * @par Returns
+             *	Nothing
+             */
+            template<unsigned long baud, typename _ClockTree>
+            static void Init(UsartMode mode = DefaultUsartMode);
             
 
             /**
@@ -219,6 +438,54 @@ namespace Zhele
              */
             static void SetBaud(unsigned baud);           
 
+            /**
+             * @brief Returns current baud rate (calculated by BRR)
+             * 
+             * @returns Baud rate
+             */
+            static unsigned GetBaud();
+
+        #if defined (USART_CR2_ABREN)
+            /**
+             * @brief Enable auto baud rate detection
+             * 
+             * @details
+             * USART measures first received character (sync character of selected mode) and sets BRR itself,
+             * sync character is received as usual. Callback is called from IrqHandler (call it from USART
+             * IRQ handler) once baud rate is detected (RXNE interrupt is enabled until then),
+             * failed measurement is restarted on next character.
+             * Not all USART instances support auto baud rate detection (see reference manual).
+             * Method should be called after Init.
+             * 
+             * @param [in] mode Detection mode
+             * @param [in] callback Baud rate detected callback (optional parameter)
+             * 
+             * @par Returns
+             *	Nothing
+             */
+        #if defined (USART_CR2_ABRMODE)
+            static void EnableAutoBaud(AutoBaudMode mode = AutoBaudMode::Frame55, AutoBaudCallback callback = nullptr);
+        #else
+            static void EnableAutoBaud(AutoBaudMode mode = AutoBaudMode::StartBit, AutoBaudCallback callback = nullptr);
+        #endif
+
+            /**
+             * @brief Disable auto baud rate detection (detected baud rate is kept)
+             * 
+             * @par Returns
+             *	Nothing
+             */
+            static void DisableAutoBaud();
+
+            /**
+             * @brief Returns auto baud rate detection state
+             * 
+             * @retval true Baud rate is detected
+             * @retval false Detection is in progress (or failed)
+             */
+            static bool AutoBaudLocked();
+        #endif
+
             /**
              * @brief Check that USART ready to read
              * 
@@ -245,7 +512,77 @@ namespace Zhele
              * 	Nothing
              */
             static void EnableAsyncRead(void* receiveBuffer, size_t bufferSize, TransferCallback callback = nullptr);
-           
+
+            /**
+             * @brief Enable stream read (circular DMA + IDLE line detection)
+             *
+             * @details
+             * Receiver writes incoming bytes to circular buffer via DMA without any per-byte interrupts.
+             * Callback is called when line becomes idle (end of frame) and when DMA wraps buffer,
+             * with pointer to new data placed in buffer and its size (data is not copied).
+             * Call IrqHandler method from USART IRQ handler.
+             *
+             * @param [in] receiveBuffer Circular receive buffer
+             * @param [in] bufferSize Receive buffer size
+             * @param [in] callback New data callback (optional parameter)
+             *
+             * @par Returns
+             * 	Nothing
+             */
+            static void EnableStreamRead(void* receiveBuffer, size_t bufferSize, TransferCallback callback = nullptr);
+
+            /**
+             * @brief Disable stream read
+             *
+             * @par Returns
+             * 	Nothing
+             */
+            static void DisableStreamRead();
+
+            /**
+             * @brief Returns count of received bytes that were not read yet
+             *
+             * @returns Count of available bytes
+             */
+            static size_t StreamAvailable();
+
+            /**
+             * @brief Returns pointer to first unread byte and size of contiguous unread block
+             *
+             * @param [out] data Pointer to first unread byte
+             *
+             * @returns Contiguous block size (may be less than StreamAvailable if data wraps buffer end)
+             */
+            static size_t StreamPeek(const uint8_t*& data);
+
+            /**
+             * @brief Mark bytes as read
+             *
+             * @param [in] size Bytes count
+             *
+             * @par Returns
+             * 	Nothing
+             */
+            static void StreamConsume(size_t size);
+
+            /**
+             * @brief Read (copy) received bytes
+             *
+             * @param [out] data Output buffer
+             * @param [in] size Output buffer size
+             *
+             * @returns Readed bytes count
+             */
+            static size_t StreamRead(void* data, size_t size);
+
+            /**
+             * @brief USART IRQ handler (handles IDLE line event in stream read mode and receiver timeout in frame read mode)
+             *
+             * @par Returns
+             * 	Nothing
+             */
+            static void IrqHandler();
+
 
             /**
              * @brief Check that USART ready to write
@@ -291,6 +628,268 @@ namespace Zhele
              */
             static void WriteAsync(const void* data, size_t size, TransferCallback callback = nullptr);
 
+            /**
+             * @brief Add data to transmit queue (via DMA)
+             *
+             * @details
+             * Method does not wait for previous transfer, it returns immediately.
+             * Queued blocks are transmitted back-to-back from DMA transfer complete IRQ.
+             * Data must remain valid until its transfer complete.
+             * Do not mix with WriteAsync while queue is not empty.
+             *
+             * @param [in] data Data to write
+             * @param [in] size Data size
+             *
+             * @retval true Data was queued
+             * @retval false Queue is full
+             */
+            static bool QueueWrite(const void* data, size_t size);
+
+            /**
+             * @brief Add several data blocks to transmit queue (via DMA)
+             *
+             * @param [in] descriptors Data blocks
+             * @param [in] count Blocks count
+             *
+             * @returns Count of queued blocks (less than count if queue is full)
+             */
+            static size_t QueueWrite(const TxDescriptor* descriptors, size_t count);
+
+            /**
+             * @brief Set callback for queued transfers
+             *
+             * @param [in] callback Callback, that is called after each queued block transfer
+             *
+             * @par Returns
+             * 	Nothing
+             */
+            static void SetWriteQueueCallback(TransferCallback callback);
+
+            /**
+             * @brief Returns free space in transmit queue
+             *
+             * @returns Count of blocks that can be queued
+             */
+            static size_t WriteQueueFree();
+
+            /**
+             * @brief Check that transmit queue is empty (all queued blocks has been transmitted)
+             *
+             * @retval true Queue is empty
+             * @retval false Queue is not empty
+             */
+            static bool WriteQueueEmpty();
+
+            /**
+             * @brief Disable DMA requests (both transmit and receive)
+             * 
+             * @details
+             * Should be called before releasing shared DMA channel (see DmaChannelArbiter)
+             * 
+             * @par Returns
+             *	Nothing
+             */
+            static void DisableDma();
+
+        #if defined (USART_CR3_DEM)
+            /**
+             * @brief Enable hardware RS-485 driver enable output (DE function of RTS pin)
+             * 
+             * @details
+             * USART drives DE pin itself: it is asserted before start bit of first frame
+             * and deasserted after stop bit of last frame. Times are in sample time units
+             * (1/16 or 1/8 bit depending on oversampling), 0..31. Method should be called after Init.
+             * 
+             * @param [in] assertionTime Time between DE activation and start bit
+             * @param [in] deassertionTime Time between end of last stop bit and DE deactivation
+             * @param [in] activeLow DE signal polarity
+             * 
+             * @par Returns
+             *	Nothing
+             */
+            static void EnableDriverEnable(uint8_t assertionTime = 0, uint8_t deassertionTime = 0, bool activeLow = false);
+
+            /**
+             * @brief Disable hardware RS-485 driver enable output
+             * 
+             * @par Returns
+             *	Nothing
+             */
+            static void DisableDriverEnable();
+        #endif
+
+            /**
+             * @brief Enter mute mode
+             *
+             * @details
+             * Mute mode should be selected on Init (IdleLineWakeup or AddressMarkWakeup mode).
+             * Muted receiver ignores bus traffic (no RXNE, no DMA requests, no interrupts) until wakeup:
+             * idle line (call it after first byte of frame to other node, rest of frame is skipped)
+             * or address character with node address (see UsartMode::NodeAddress), that is received
+             * as first byte of frame. So multi-drop bus node receives only own frames and calls
+             * this method again after frame end. Address mark is set MSB of character (9th bit in 9-bit data mode).
+             *
+             * @par Returns
+             *	Nothing
+             */
+            static void EnterMuteMode();
+
+            /**
+             * @brief Returns mute state
+             *
+             * @retval true Receiver is muted
+             * @retval false Receiver is active
+             */
+            static bool IsMuted();
+
+            /**
+             * @brief Write address character (sync)
+             *
+             * @details
+             * Address mark (MSB: 9th bit in 9-bit data mode, 8th bit otherwise) is added to address,
+             * so only receivers with this node address wake up (address mark wakeup mode).
+             *
+             * @param [in] address Node address
+             *
+             * @par Returns
+             *	Nothing
+             */
+            static void WriteAddress(uint8_t address);
+
+        #if defined (USART_CR3_WUS)
+            /**
+             * @brief Enable wakeup from Stop mode
+             *
+             * @details
+             * USART kernel clock should work in Stop mode (HSI16 or LSE, see reference manual): receiver
+             * keeps receiving while core sleeps, so byte that wakes MCU up is not lost. Wakeup event
+             * interrupt (flag is cleared by IrqHandler, call it from USART IRQ handler) wakes core up,
+             * received data should be read by RXNE interrupt: DMA does not work in Stop mode
+             * (LowPower does not enter Stop mode while DMA channel is enabled).
+             * Not all USART instances support wakeup from Stop mode (see reference manual).
+             * Method should be called after Init.
+             *
+             * @param [in] source Wakeup event
+             *
+             * @par Returns
+             *	Nothing
+             */
+            static void EnableWakeupFromStop(WakeupSource source = WakeupSource::StartBit);
+
+            /**
+             * @brief Disable wakeup from Stop mode
+             *
+             * @par Returns
+             *	Nothing
+             */
+            static void DisableWakeupFromStop();
+        #endif
+
+        #if defined (USART_CR2_RTOEN)
+            /**
+             * @brief Enable receiver timeout interrupt
+             * 
+             * @details
+             * Timeout counter starts after stop bit of each received frame, so interrupt
+             * fires after line idle for specified time (Modbus t3.5 for example).
+             * Not all USART instances support receiver timeout (see reference manual).
+             * 
+             * @param [in] bits Timeout in bit durations (24 bit max)
+             * 
+             * @par Returns
+             *	Nothing
+             */
+            static void EnableReceiverTimeout(uint32_t bits);
+
+            /**
+             * @brief Disable receiver timeout interrupt
+             * 
+             * @par Returns
+             *	Nothing
+             */
+            static void DisableReceiverTimeout();
+
+            /**
+             * @brief Check and clear receiver timeout flag
+             * 
+             * @retval true Receiver timeout occured
+             * @retval false No receiver timeout
+             */
+            static bool ReceiverTimeout();
+
+            /**
+             * @brief Enable frame read (circular DMA + receiver timeout)
+             *
+             * @details
+             * Receiver writes incoming bytes to circular buffer via DMA without any per-byte interrupts,
+             * receiver timeout (line idle for given time) marks end of frame and frame is placed to frame queue
+             * (up to ZHELE_USART_FRAME_QUEUE_SIZE frames). Frames are not copied, frame may wrap buffer end
+             * (see RxFrame), frame should be consumed before DMA overwrites it. Callback is called from interrupt
+             * for every frame with pointer to frame start and frame size (success is false if frame queue is full
+             * and frame is dropped). Call IrqHandler method from USART IRQ handler.
+             *
+             * @param [in] receiveBuffer Circular receive buffer
+             * @param [in] bufferSize Receive buffer size
+             * @param [in] timeoutBits End of frame timeout in bit durations (24 bit max)
+             * @param [in] callback Frame received callback (optional parameter)
+             *
+             * @par Returns
+             * 	Nothing
+             */
+            static void EnableFrameRead(void* receiveBuffer, size_t bufferSize, uint32_t timeoutBits, TransferCallback callback = nullptr);
+
+            /**
+             * @brief Disable frame read
+             *
+             * @par Returns
+             * 	Nothing
+             */
+            static void DisableFrameRead();
+
+            /**
+             * @brief Returns count of received frames that were not consumed yet
+             *
+             * @returns Frames count
+             */
+            static size_t FramesAvailable();
+
+            /**
+             * @brief Returns oldest received frame (frame stays in queue)
+             *
+             * @param [out] frame Frame
+             *
+             * @retval true Frame is returned
+             * @retval false There is no received frames
+             */
+            static bool FramePeek(RxFrame& frame);
+
+            /**
+             * @brief Remove oldest frame from queue (frame data may be overwritten after this call)
+             *
+             * @par Returns
+             * 	Nothing
+             */
+            static void FrameConsume();
+
+            /**
+             * @brief Read (copy) and remove oldest frame
+             *
+             * @param [out] data Output buffer
+             * @param [in] size Output buffer size (frame is truncated if it is larger)
+             *
+             * @returns Readed bytes count (0 if there is no received frames)
+             */
+            static size_t FrameRead(void* data, size_t size);
+        #endif
+
+            /**
+             * @brief Check that last frame has been transmitted (TC flag)
+             * 
+             * @retval true Transmission complete
+             * @retval false Transmission in progress
+             */
+            static bool TransmitComplete();
+
             /**
              * @brief Synch write byte
              * 
@@ -383,7 +982,111 @@ namespace Zhele
              */
             template<typename TxPin, typename RxPin = typename IO::NullPin>
             static void SelectTxRxPins();
+        private:
+        #if defined (ZHELE_STATISTICS)
+            /**
+             * @brief Counts errors
+             *
+             * @param [in] status Status register value
+             *
+             * @par Returns
+             *  Nothing
+             */
+            static void CountErrors(uint32_t status);
+        #endif
+
+            /**
+             * @brief Returns DMA write position in stream buffer
+             *
+             * @returns Write position
+             */
+            static size_t StreamWriteIndex();
+
+            /**
+             * @brief Notify user about new data in stream buffer
+             *
+             * @par Returns
+             *	Nothing
+             */
+            static void NotifyStreamData();
+
+        #if defined (USART_CR2_ABREN)
+            static AutoBaudCallback _autoBaudCallback;
+        #endif
+
+        #if defined (USART_CR2_RTOEN)
+            /**
+             * @brief Put received frame to frame queue
+             *
+             * @par Returns
+             *	Nothing
+             */
+            static void QueueFrame();
+
+            static UsartFrameData _frame;
+            static Containers::RingBuffer<ZHELE_USART_FRAME_QUEUE_SIZE, UsartFrameDescriptor> _frames;
+        #endif
+
+            /**
+             * @brief Clear IDLE (and error) flags
+             *
+             * @par Returns
+             *	Nothing
+             */
+            static void ClearIdleFlag();
+
+            /**
+             * @brief Start transfer of first block in transmit queue
+             *
+             * @par Returns
+             *	Nothing
+             */
+            static void StartQueuedWrite();
+
+            /**
+             * @brief Queued block transfer complete handler
+             *
+             * @par Returns
+             *	Nothing
+             */
+            static void QueuedWriteComplete(void* data, unsigned size, bool success);
+
+            static UsartStreamData _stream;
+
+            static Containers::RingBuffer<ZHELE_USART_TX_QUEUE_SIZE, TxDescriptor> _txQueue;
+            static TransferCallback _txQueueCallback;
+            static volatile bool _txQueueActive;
         };
+
+        template<typename _Regs, IRQn_Type _IRQNumber, typename _ClockCtrl, typename _TxPins, typename _RxPins, typename _DmaTx, typename _DmaRx>
+        UsartStreamData Usart<_Regs, _IRQNumber, _ClockCtrl, _TxPins, _RxPins, _DmaTx, _DmaRx>::_stream;
+
+    #if defined (USART_CR2_RTOEN)
+        template<typename _Regs, IRQn_Type _IRQNumber, typename _ClockCtrl, typename _TxPins, typename _RxPins, typename _DmaTx, typename _DmaRx>
+        UsartFrameData Usart<_Regs, _IRQNumber, _ClockCtrl, _TxPins, _RxPins, _DmaTx, _DmaRx>::_frame;
+
+        template<typename _Regs, IRQn_Type _IRQNumber, typename _ClockCtrl, typename _TxPins, typename _RxPins, typename _DmaTx, typename _DmaRx>
+        Containers::RingBuffer<ZHELE_USART_FRAME_QUEUE_SIZE, UsartFrameDescriptor> Usart<_Regs, _IRQNumber, _ClockCtrl, _TxPins, _RxPins, _DmaTx, _DmaRx>::_frames;
+    #endif
+
+    #if defined (USART_CR2_ABREN)
+        template<typename _Regs, IRQn_Type _IRQNumber, typename _ClockCtrl, typename _TxPins, typename _RxPins, typename _DmaTx, typename _DmaRx>
+        UsartBase::AutoBaudCallback Usart<_Regs, _IRQNumber, _ClockCtrl, _TxPins, _RxPins, _DmaTx, _DmaRx>::_autoBaudCallback = nullptr;
+    #endif
+
+    #if defined (ZHELE_STATISTICS)
+        template<typename _Regs, IRQn_Type _IRQNumber, typename _ClockCtrl, typename _TxPins, typename _RxPins, typename _DmaTx, typename _DmaRx>
+        UsartStatistics Usart<_Regs, _IRQNumber, _ClockCtrl, _TxPins, _RxPins, _DmaTx, _DmaRx>::Statistics;
+    #endif
+
+        template<typename _Regs, IRQn_Type _IRQNumber, typename _ClockCtrl, typename _TxPins, typename _RxPins, typename _DmaTx, typename _DmaRx>
+        Containers::RingBuffer<ZHELE_USART_TX_QUEUE_SIZE, UsartBase::TxDescriptor> Usart<_Regs, _IRQNumber, _ClockCtrl, _TxPins, _RxPins, _DmaTx, _DmaRx>::_txQueue;
+
+        template<typename _Regs, IRQn_Type _IRQNumber, typename _ClockCtrl, typename _TxPins, typename _RxPins, typename _DmaTx, typename _DmaRx>
+        TransferCallback Usart<_Regs, _IRQNumber, _ClockCtrl, _TxPins, _RxPins, _DmaTx, _DmaRx>::_txQueueCallback;
+
+        template<typename _Regs, IRQn_Type _IRQNumber, typename _ClockCtrl, typename _TxPins, typename _RxPins, typename _DmaTx, typename _DmaRx>
+        volatile bool Usart<_Regs, _IRQNumber, _ClockCtrl, _TxPins, _RxPins, _DmaTx, _DmaRx>::_txQueueActive = false;
     }
 }
 
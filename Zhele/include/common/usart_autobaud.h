@@ -0,0 +1,99 @@
+/**
+ * @file
+ * Implements USART auto baud rate detection by timer input capture
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_USART_AUTOBAUD_COMMON_H
+#define ZHELE_USART_AUTOBAUD_COMMON_H
+
+#include <stdint.h>
+
+namespace Zhele
+{
+    /**
+     * @brief Auto baud rate detection by timer input capture (for USART without ABR, F1 for example)
+     *
+     * @details
+     * Timer channel pin should be connected to USART RX line (or be the same pin: PA10 is USART1 RX and TIM1 CH3,
+     * PA3 is USART2 RX and TIM2 CH4 on F1). Host sends 0x55 ('U') sync characters: falling edges of 0x55 character
+     * are two bit durations apart, so minimal distance between captured falling edges gives baud rate.
+     * Detected baud rate is rounded to standard one (if it is close enough) and set to USART, then callback is called.
+     * Characters received by USART during detection are garbage, they should be dropped.
+     * Timer should not be used for anything else during detection (its prescaler and period are changed).
+     *
+     * @tparam _Usart USART
+     * @tparam _Timer Timer (general purpose or advanced)
+     * @tparam _Channel Capture channel of RX pin
+     * @tparam _Edges Falling edges to measure (0x55 character contains 5 falling edges)
+     */
+    template<typename _Usart, typename _Timer, unsigned _Channel, unsigned _Edges = 5>
+    class UsartAutoBaud
+    {
+        static_assert(_Edges >= 2, "At least two edges are required");
+        using Capture = typename _Timer::template InputCapture<_Channel>;
+    public:
+        /// Detection complete callback (detected baud rate)
+        using Callback = void(*)(unsigned baud);
+
+        /**
+         * @brief Start detection
+         *
+         * @tparam _Pin Channel pin (USART RX pin)
+         *
+         * @param [in] callback Baud rate detected callback
+         * @param [in] minBaud Min baud rate to detect (timer resolution is decreased for low baud rates)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        template<typename _Pin>
+        static void Start(Callback callback, unsigned minBaud = 9600);
+
+        /**
+         * @brief Stop detection (baud rate is not changed)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Stop();
+
+        /**
+         * @brief Returns detection state
+         *
+         * @retval true Detection is in progress
+         * @retval false Detection is not started or completed
+         */
+        static bool Busy();
+
+        /**
+         * @brief Rounds baud rate to standard one
+         *
+         * @param [in] baud Measured baud rate
+         *
+         * @returns Standard baud rate (if it differs less than 3%) or measured one
+         */
+        static constexpr unsigned RoundBaud(unsigned baud);
+
+        /**
+         * @brief Capture IRQ handler. Call it from timer IRQ handler
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void IrqHandler();
+
+    private:
+        static Callback _callback;
+        static uint16_t _last;
+        static uint16_t _minInterval;
+        static volatile uint8_t _edges;
+    };
+}
+
+#include "impl/usart_autobaud.h"
+
+#endif //! ZHELE_USART_AUTOBAUD_COMMON_H
@@ -0,0 +1,669 @@
+/**
+ * @file
+ * Implement USB Audio class (UAC1)
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2023
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_USB_AUDIO_H
+#define ZHELE_USB_AUDIO_H
+
+#include "interface.h"
+
+#include "../template_utils/type_list.h"
+#include "../../containers/ring_buffer.h"
+
+namespace Zhele::Usb
+{
+    /**
+     * @brief Audio interface subclass
+     */
+    enum class AudioSubclass : uint8_t
+    {
+        AudioControl = 0x01, ///< Audio control interface
+        AudioStreaming = 0x02, ///< Audio streaming interface
+    };
+
+    /**
+     * @brief Audio class-specific descriptor types
+     */
+    enum class AudioDescriptorType : uint8_t
+    {
+        Interface = 0x24, ///< Class-specific interface descriptor
+        Endpoint = 0x25, ///< Class-specific endpoint descriptor
+    };
+
+    /**
+     * @brief Audio terminal types
+     */
+    enum class AudioTerminalType : uint16_t
+    {
+        UsbStreaming = 0x0101, ///< USB streaming
+        Microphone = 0x0201, ///< Microphone
+        Speaker = 0x0301, ///< Speaker
+        Headphones = 0x0302, ///< Headphones
+        LineConnector = 0x0603, ///< Analog line connector
+    };
+
+#pragma pack(push, 1)
+    /**
+     * @brief Audio control interface header descriptor (for one streaming interface)
+     */
+    struct AudioControlHeaderDescriptor
+    {
+        uint8_t Length = 9; ///< Length
+        AudioDescriptorType Type = AudioDescriptorType::Interface; ///< Descriptor type
+        uint8_t SubType = 0x01; ///< Descriptor subtype (header)
+        uint16_t AdcVersion = 0x0100; ///< Audio class version (1.0)
+        uint16_t TotalLength; ///< Total length of class-specific audio control descriptors
+        uint8_t InterfacesCount = 1; ///< Streaming interfaces count
+        uint8_t StreamingInterface; ///< Streaming interface number
+    };
+
+    /**
+     * @brief Input terminal descriptor
+     */
+    struct AudioInputTerminalDescriptor
+    {
+        uint8_t Length = 12; ///< Length
+        AudioDescriptorType Type = AudioDescriptorType::Interface; ///< Descriptor type
+        uint8_t SubType = 0x02; ///< Descriptor subtype (input terminal)
+        uint8_t TerminalId; ///< Terminal ID
+        AudioTerminalType TerminalType; ///< Terminal type
+        uint8_t AssociatedTerminal = 0; ///< Associated output terminal
+        uint8_t ChannelsCount; ///< Channels count
+        uint16_t ChannelConfig = 0; ///< Spatial locations of channels
+        uint8_t ChannelNames = 0; ///< First channel name string index
+        uint8_t StringIndex = 0; ///< Terminal string index
+    };
+
+    /**
+     * @brief Output terminal descriptor
+     */
+    struct AudioOutputTerminalDescriptor
+    {
+        uint8_t Length = 9; ///< Length
+        AudioDescriptorType Type = AudioDescriptorType::Interface; ///< Descriptor type
+        uint8_t SubType = 0x03; ///< Descriptor subtype (output terminal)
+        uint8_t TerminalId; ///< Terminal ID
+        AudioTerminalType TerminalType; ///< Terminal type
+        uint8_t AssociatedTerminal = 0; ///< Associated input terminal
+        uint8_t SourceId; ///< Source unit/terminal ID
+        uint8_t StringIndex = 0; ///< Terminal string index
+    };
+
+    /**
+     * @brief Audio streaming interface general descriptor
+     */
+    struct AudioStreamingGeneralDescriptor
+    {
+        uint8_t Length = 7; ///< Length
+        AudioDescriptorType Type = AudioDescriptorType::Interface; ///< Descriptor type
+        uint8_t SubType = 0x01; ///< Descriptor subtype (general)
+        uint8_t TerminalLink; ///< Terminal connected to endpoint
+        uint8_t Delay = 1; ///< Delay (in frames)
+        uint16_t FormatTag = 0x0001; ///< Format (PCM)
+    };
+
+    /**
+     * @brief Type I format descriptor (one discrete sample rate)
+     */
+    struct AudioFormatTypeIDescriptor
+    {
+        uint8_t Length = 11; ///< Length
+        AudioDescriptorType Type = AudioDescriptorType::Interface; ///< Descriptor type
+        uint8_t SubType = 0x02; ///< Descriptor subtype (format type)
+        uint8_t FormatType = 0x01; ///< Format type I
+        uint8_t ChannelsCount; ///< Channels count
+        uint8_t SubframeSize; ///< Bytes per sample
+        uint8_t BitResolution; ///< Bits per sample
+        uint8_t SampleRatesCount = 1; ///< Sample rates count
+        uint8_t SampleRate[3]; ///< Sample rate (Hz)
+    };
+
+    /**
+     * @brief Standard audio isochronous endpoint descriptor
+     */
+    struct AudioEndpointDescriptor
+    {
+        uint8_t Length = 9; ///< Length (always 9)
+        DescriptorType Type = DescriptorType::Endpoint; ///< Descriptor type (always 0x05)
+        uint8_t Address; ///< Endpoint address
+        uint8_t Attributes; ///< Endpoint attributes
+        uint16_t MaxPacketSize; ///< Endpoint max packet size
+        uint8_t Interval; ///< Endpoint poll interval
+        uint8_t Refresh = 0; ///< Feedback refresh rate (2^Refresh ms, for feedback endpoint only)
+        uint8_t SynchAddress = 0; ///< Feedback endpoint address (for data endpoint)
+    };
+
+    /**
+     * @brief Class-specific audio data endpoint descriptor
+     */
+    struct AudioDataEndpointDescriptor
+    {
+        uint8_t Length = 7; ///< Length
+        AudioDescriptorType Type = AudioDescriptorType::Endpoint; ///< Descriptor type
+        uint8_t SubType = 0x01; ///< Descriptor subtype (general)
+        uint8_t Attributes = 0; ///< Controls (no sampling frequency/pitch controls)
+        uint8_t LockDelayUnits = 0; ///< Lock delay units
+        uint16_t LockDelay = 0; ///< Lock delay
+    };
+#pragma pack(pop)
+
+    /**
+     * @brief Implements audio control interface
+     *
+     * @details
+     * Interface describes one terminal chain: input terminal (ID 1) connected to output terminal (ID 2).
+     * One of terminals should be USB streaming terminal, it is linked with streaming interface.
+     *
+     * @tparam _Number Interface number
+     * @tparam _Ep0 Zero endpoint instance
+     * @tparam _InputTerminal Input terminal type
+     * @tparam _OutputTerminal Output terminal type
+     * @tparam _Channels Channels count
+     * @tparam _StreamingInterface Streaming interface number
+     */
+    template <uint8_t _Number, typename _Ep0, AudioTerminalType _InputTerminal, AudioTerminalType _OutputTerminal, uint8_t _Channels, uint8_t _StreamingInterface>
+    class AudioControlInterface : public Interface<_Number, 0, DeviceAndInterfaceClass::Audio, static_cast<uint8_t>(AudioSubclass::AudioControl), 0, _Ep0>
+    {
+        static_assert(_InputTerminal == AudioTerminalType::UsbStreaming || _OutputTerminal == AudioTerminalType::UsbStreaming,
+            "One of terminals should be USB streaming terminal.");
+    public:
+        /// Input terminal ID
+        static const uint8_t InputTerminalId = 1;
+        /// Output terminal ID
+        static const uint8_t OutputTerminalId = 2;
+        /// Streaming interface terminal link
+        static const uint8_t StreamingTerminalId = _InputTerminal == AudioTerminalType::UsbStreaming ? InputTerminalId : OutputTerminalId;
+
+        /**
+         * @brief Interface setup request handler
+         *
+         * @details
+         * Interface has no controls, so class-specific requests are stalled.
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void SetupHandler()
+        {
+            SetupPacket* setup = reinterpret_cast<SetupPacket*>(_Ep0::RxBuffer);
+
+            if(setup->RequestType.Type == 0 && setup->Request == StandartRequestCode::SetInterface)
+            {
+                _Ep0::SendZLP();
+            }
+            else if(setup->RequestType.Type == 0 && setup->Request == StandartRequestCode::GetInterface)
+            {
+                uint8_t alternateSetting = 0;
+                _Ep0::SendData(&alternateSetting, 1);
+            }
+            else
+            {
+                _Ep0::SetTxStatus(EndpointStatus::Stall);
+            }
+        }
+
+        /**
+         * @brief Returns descriptor
+         *
+         * @returns Descriptor bytes (interface and class-specific audio control descriptors)
+         */
+        static constexpr auto Descriptor()
+        {
+            return ConcatDescriptors(
+                DescriptorBytes(InterfaceDescriptor {
+                    .Number = _Number,
+                    .AlternateSetting = 0,
+                    .EndpointsCount = 0,
+                    .Class = DeviceAndInterfaceClass::Audio,
+                    .SubClass = static_cast<uint8_t>(AudioSubclass::AudioControl),
+                    .Protocol = 0
+                }),
+                DescriptorBytes(AudioControlHeaderDescriptor {
+                    .TotalLength = sizeof(AudioControlHeaderDescriptor) + sizeof(AudioInputTerminalDescriptor) + sizeof(AudioOutputTerminalDescriptor),
+                    .StreamingInterface = _StreamingInterface
+                }),
+                DescriptorBytes(AudioInputTerminalDescriptor {
+                    .TerminalId = InputTerminalId,
+                    .TerminalType = _InputTerminal,
+                    .ChannelsCount = _Channels
+                }),
+                DescriptorBytes(AudioOutputTerminalDescriptor {
+                    .TerminalId = OutputTerminalId,
+                    .TerminalType = _OutputTerminal,
+                    .SourceId = InputTerminalId
+                }));
+        }
+    };
+
+    /**
+     * @brief Microphone (device to host) audio control interface
+     */
+    template <uint8_t _Number, typename _Ep0, uint8_t _Channels, uint8_t _StreamingInterface>
+    using MicrophoneControlInterface = AudioControlInterface<_Number, _Ep0, AudioTerminalType::Microphone, AudioTerminalType::UsbStreaming, _Channels, _StreamingInterface>;
+
+    /**
+     * @brief Speaker (host to device) audio control interface
+     */
+    template <uint8_t _Number, typename _Ep0, uint8_t _Channels, uint8_t _StreamingInterface>
+    using SpeakerControlInterface = AudioControlInterface<_Number, _Ep0, AudioTerminalType::UsbStreaming, AudioTerminalType::Speaker, _Channels, _StreamingInterface>;
+
+    /**
+     * @brief Implements audio streaming interface
+     *
+     * @details
+     * Interface has two alternate settings: 0 - zero bandwidth (no endpoints),
+     * 1 - PCM stream over isochronous endpoint. Endpoints are reset when host selects
+     * alternate setting 1 (starts streaming) and disabled when host returns to alternate setting 0.
+     * Optional feedback endpoint is used for asynchronous OUT endpoint: it reports to host
+     * actual device sample rate (samples per frame in 10.14 format).
+     *
+     * @tparam _Number Interface number
+     * @tparam _Ep0 Zero endpoint instance
+     * @tparam _TerminalLink Terminal ID connected to endpoint (see AudioControlInterface::StreamingTerminalId)
+     * @tparam _SampleRate Sample rate (Hz)
+     * @tparam _Channels Channels count
+     * @tparam _BitResolution Bits per sample (16 or 24)
+     * @tparam _Endpoint Isochronous data endpoint
+     * @tparam _FeedbackEndpoint Isochronous feedback endpoint (optional)
+     */
+    template <uint8_t _Number, typename _Ep0, uint8_t _TerminalLink, uint32_t _SampleRate, uint8_t _Channels, uint8_t _BitResolution, typename _Endpoint, typename... _FeedbackEndpoint>
+    class AudioStreamingInterface : public Interface<_Number, 0, DeviceAndInterfaceClass::Audio, static_cast<uint8_t>(AudioSubclass::AudioStreaming), 0, _Ep0, _Endpoint, _FeedbackEndpoint...>
+    {
+        static_assert(_Endpoint::Type == EndpointType::Isochronous, "Audio data endpoint should be isochronous.");
+        static_assert(sizeof...(_FeedbackEndpoint) <= 1, "Only one feedback endpoint is allowed.");
+        static_assert(_BitResolution == 16 || _BitResolution == 24, "Only 16 and 24 bits samples are supported.");
+
+        using Base = Interface<_Number, 0, DeviceAndInterfaceClass::Audio, static_cast<uint8_t>(AudioSubclass::AudioStreaming), 0, _Ep0, _Endpoint, _FeedbackEndpoint...>;
+    public:
+        /// Bytes per sample
+        static const uint8_t SubframeSize = _BitResolution / 8;
+        /// Feedback refresh period (2^FeedbackRefresh ms)
+        static const uint8_t FeedbackRefresh = 2;
+
+        /**
+         * @brief Returns streaming state
+         *
+         * @retval true Host has selected streaming alternate setting
+         * @retval false Interface is in zero bandwidth setting
+         */
+        static bool Streaming()
+        {
+            return _alternateSetting != 0;
+        }
+
+        /**
+         * @brief Reset interface
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Reset()
+        {
+            _alternateSetting = 0;
+            Base::Reset();
+        }
+
+        /**
+         * @brief Interface setup request handler
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void SetupHandler()
+        {
+            SetupPacket* setup = reinterpret_cast<SetupPacket*>(_Ep0::RxBuffer);
+
+            if(setup->RequestType.Type == 0 && setup->Request == StandartRequestCode::SetInterface && setup->Value <= 1)
+            {
+                _alternateSetting = setup->Value;
+                if(_alternateSetting != 0)
+                {
+                    Base::Reset();
+                }
+                else
+                {
+                    Base::Deactivate();
+                }
+                _Ep0::SendZLP();
+            }
+            else if(setup->RequestType.Type == 0 && setup->Request == StandartRequestCode::GetInterface)
+            {
+                _Ep0::SendData(&_alternateSetting, 1);
+            }
+            else
+            {
+                _Ep0::SetTxStatus(EndpointStatus::Stall);
+            }
+        }
+
+        /**
+         * @brief Returns descriptor
+         *
+         * @returns Descriptor bytes (both alternate settings with class-specific and endpoints descriptors)
+         */
+        static constexpr auto Descriptor()
+        {
+            // Alternate setting 0: zero bandwidth, alternate setting 1: streaming
+            constexpr auto streaming = ConcatDescriptors(
+                DescriptorBytes(InterfaceDescriptor {
+                    .Number = _Number,
+                    .AlternateSetting = 0,
+                    .EndpointsCount = 0,
+                    .Class = DeviceAndInterfaceClass::Audio,
+                    .SubClass = static_cast<uint8_t>(AudioSubclass::AudioStreaming),
+                    .Protocol = 0
+                }),
+                DescriptorBytes(InterfaceDescriptor {
+                    .Number = _Number,
+                    .AlternateSetting = 1,
+                    .EndpointsCount = Base::EndpointsCount,
+                    .Class = DeviceAndInterfaceClass::Audio,
+                    .SubClass = static_cast<uint8_t>(AudioSubclass::AudioStreaming),
+                    .Protocol = 0
+                }),
+                DescriptorBytes(AudioStreamingGeneralDescriptor {
+                    .TerminalLink = _TerminalLink
+                }),
+                DescriptorBytes(AudioFormatTypeIDescriptor {
+                    .ChannelsCount = _Channels,
+                    .SubframeSize = SubframeSize,
+                    .BitResolution = _BitResolution,
+                    .SampleRate = {static_cast<uint8_t>(_SampleRate), static_cast<uint8_t>(_SampleRate >> 8), static_cast<uint8_t>(_SampleRate >> 16)}
+                }),
+                DescriptorBytes(AudioEndpointDescriptor {
+                    .Address = EndpointAddress<_Endpoint>(),
+                    .Attributes = _Endpoint::Attributes,
+                    .MaxPacketSize = _Endpoint::MaxPacketSize,
+                    .Interval = _Endpoint::Interval,
+                    .SynchAddress = FeedbackEndpointAddress()
+                }),
+                DescriptorBytes(AudioDataEndpointDescriptor {}));
+
+            if constexpr (sizeof...(_FeedbackEndpoint) > 0)
+            {
+                return ConcatDescriptors(streaming, DescriptorBytes(AudioEndpointDescriptor {
+                    .Address = FeedbackEndpointAddress(),
+                    .Attributes = (_FeedbackEndpoint::Attributes, ...),
+                    .MaxPacketSize = (_FeedbackEndpoint::MaxPacketSize, ...),
+                    .Interval = 1,
+                    .Refresh = FeedbackRefresh
+                }));
+            }
+            else
+            {
+                return streaming;
+            }
+        }
+
+    private:
+        template<typename _Ep>
+        static constexpr uint8_t EndpointAddress()
+        {
+            return static_cast<uint8_t>(_Ep::Number) | ((static_cast<uint8_t>(_Ep::Direction) & 0x01) << 7);
+        }
+
+        static constexpr uint8_t FeedbackEndpointAddress()
+        {
+            if constexpr (sizeof...(_FeedbackEndpoint) > 0)
+                return (EndpointAddress<_FeedbackEndpoint>(), ...);
+            else
+                return 0;
+        }
+
+        static uint8_t _alternateSetting;
+    };
+
+    template <uint8_t _Number, typename _Ep0, uint8_t _TerminalLink, uint32_t _SampleRate, uint8_t _Channels, uint8_t _BitResolution, typename _Endpoint, typename... _FeedbackEndpoint>
+    uint8_t AudioStreamingInterface<_Number, _Ep0, _TerminalLink, _SampleRate, _Channels, _BitResolution, _Endpoint, _FeedbackEndpoint...>::_alternateSetting = 0;
+
+#if defined (USB)
+    /**
+     * @brief Device to host (microphone) PCM stream
+     *
+     * @details
+     * Samples (unsigned, right aligned, for example from ADC DMA ping-pong buffer) are converted
+     * to signed 16-bit PCM and stored in FIFO. Every frame one packet is sent from isochronous IN endpoint.
+     * Endpoint is asynchronous: sample rate is defined by sampling timer, so packet contains
+     * nominal samples count +-1 sample to keep FIFO half full (host adapts to packet size).
+     * If host does not read stream (FIFO overflow), new samples are dropped and latency
+     * is restored on next frame.
+     *
+     * @code
+     * Adc1::StartRegularPingPong(channels, 1, adcBuffer, 48, [](void* data, unsigned size, bool) {
+     *     Microphone::Push(static_cast<uint16_t*>(data), size);
+     * });
+     * Microphone::Start();
+     * @endcode
+     *
+     * @tparam _Endpoint Isochronous IN endpoint
+     * @tparam _SampleRate Sample rate (Hz)
+     * @tparam _Channels Channels count
+     * @tparam _FifoSamples FIFO size (samples, power of 2)
+     * @tparam _Resolution Input samples resolution (bits)
+     */
+    template<typename _Endpoint, uint32_t _SampleRate, uint8_t _Channels = 1, unsigned _FifoSamples = 512, uint8_t _Resolution = 12>
+    class AudioInStream
+    {
+        static const unsigned MaxFrameSamples = (_SampleRate + 999) / 1000 + 1;
+        static const unsigned TargetLevel = _FifoSamples / 2;
+
+        static_assert((_FifoSamples & (_FifoSamples - 1)) == 0, "FIFO size should be power of 2.");
+        static_assert(_FifoSamples >= 4 * MaxFrameSamples * _Channels, "FIFO should contain at least 4 frames.");
+        static_assert(_Endpoint::MaxPacketSize >= MaxFrameSamples * _Channels * sizeof(int16_t), "Endpoint max packet size is too small for sample rate.");
+
+        using Fifo = Containers::Private::RingBufferPO2<_FifoSamples, int16_t>;
+    public:
+        /**
+         * @brief Start stream (install frame handler)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Start()
+        {
+            _Endpoint::SendPacket(0, OnFrame);
+        }
+
+        /**
+         * @brief Push samples to stream (can be called from DMA interrupt)
+         *
+         * @param [in] samples Samples (interleaved channels)
+         * @param [in] count Samples count
+         *
+         * @returns Count of pushed samples (less than count if FIFO is full)
+         */
+        static unsigned Push(const uint16_t* samples, unsigned count)
+        {
+            unsigned pushed = 0;
+            int16_t converted[32];
+            while(pushed < count)
+            {
+                unsigned chunk = count - pushed < 32 ? count - pushed : 32;
+                for(unsigned i = 0; i < chunk; ++i)
+                {
+                    converted[i] = static_cast<int16_t>((samples[pushed + i] << (16 - _Resolution)) ^ 0x8000);
+                }
+                unsigned written = _fifo.write(converted, chunk);
+                pushed += written;
+                if(written < chunk)
+                    break;
+            }
+            return pushed;
+        }
+
+        /**
+         * @brief Returns FIFO level
+         *
+         * @returns Samples count in FIFO
+         */
+        static unsigned Level()
+        {
+            return _fifo.size();
+        }
+
+    private:
+        static void OnFrame()
+        {
+            // Nominal samples per frame (fractional part is accumulated, 44100 Hz -> 44,44,...,45)
+            _rateAccumulator += _SampleRate;
+            unsigned frameSamples = _rateAccumulator / 1000;
+            _rateAccumulator %= 1000;
+
+            unsigned level = _fifo.size() / _Channels;
+            if(level > TargetLevel / _Channels + 4 * MaxFrameSamples)
+            {
+                // Stream was not read by host, restore latency
+                _fifo.skip((level - TargetLevel / _Channels) * _Channels);
+                level = TargetLevel / _Channels;
+            }
+
+            if(level > TargetLevel / _Channels + MaxFrameSamples)
+                ++frameSamples;
+            else if(level + MaxFrameSamples < TargetLevel / _Channels && frameSamples > 0)
+                --frameSamples;
+
+            if(frameSamples > level)
+                frameSamples = level;
+
+            int16_t packet[MaxFrameSamples * _Channels];
+            unsigned count = _fifo.read(packet, frameSamples * _Channels);
+            _Endpoint::SendData(packet, count * sizeof(int16_t), OnFrame);
+        }
+
+        static Fifo _fifo;
+        static uint32_t _rateAccumulator;
+    };
+
+    template<typename _Endpoint, uint32_t _SampleRate, uint8_t _Channels, unsigned _FifoSamples, uint8_t _Resolution>
+    typename AudioInStream<_Endpoint, _SampleRate, _Channels, _FifoSamples, _Resolution>::Fifo AudioInStream<_Endpoint, _SampleRate, _Channels, _FifoSamples, _Resolution>::_fifo;
+    template<typename _Endpoint, uint32_t _SampleRate, uint8_t _Channels, unsigned _FifoSamples, uint8_t _Resolution>
+    uint32_t AudioInStream<_Endpoint, _SampleRate, _Channels, _FifoSamples, _Resolution>::_rateAccumulator = 0;
+
+    /**
+     * @brief Host to device (speaker) PCM stream with explicit feedback
+     *
+     * @details
+     * Received 16-bit PCM packets are stored in FIFO, samples are taken from FIFO
+     * (for example, to DAC DMA ping-pong buffer) and converted to unsigned right aligned values.
+     * Output sample rate is defined by DAC trigger timer, so FIFO level shows difference between
+     * host and device clocks. Feedback endpoint reports to host samples per frame (10.14 format)
+     * corrected by FIFO level error, so host sends more or less samples and FIFO stays half full.
+     *
+     * OUT endpoint HandleRx should call AudioOutStream::HandleRx:
+     * @code
+     * template<> void SpeakerEndpoint::HandleRx(void* data, uint16_t size) { Speaker::HandleRx(data, size); }
+     * @endcode
+     *
+     * @tparam _Endpoint Isochronous OUT endpoint
+     * @tparam _FeedbackEndpoint Isochronous IN feedback endpoint
+     * @tparam _SampleRate Sample rate (Hz)
+     * @tparam _Channels Channels count
+     * @tparam _FifoSamples FIFO size (samples, power of 2)
+     * @tparam _Resolution Output samples resolution (bits)
+     */
+    template<typename _Endpoint, typename _FeedbackEndpoint, uint32_t _SampleRate, uint8_t _Channels = 1, unsigned _FifoSamples = 512, uint8_t _Resolution = 12>
+    class AudioOutStream
+    {
+        static const unsigned TargetLevel = _FifoSamples / 2;
+        /// Nominal samples per frame in 10.14 format
+        static const uint32_t NominalFeedback = static_cast<uint32_t>((static_cast<uint64_t>(_SampleRate) << 14) / 1000);
+
+        static_assert((_FifoSamples & (_FifoSamples - 1)) == 0, "FIFO size should be power of 2.");
+        static_assert(_FifoSamples * sizeof(int16_t) >= 4 * _Endpoint::MaxPacketSize, "FIFO should contain at least 4 packets.");
+        static_assert(_FeedbackEndpoint::MaxPacketSize >= 3, "Feedback endpoint max packet size should be at least 3.");
+
+        using Fifo = Containers::Private::RingBufferPO2<_FifoSamples, int16_t>;
+    public:
+        /**
+         * @brief Start stream (install feedback handler)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Start()
+        {
+            OnFeedback();
+        }
+
+        /**
+         * @brief Take samples from stream (can be called from DMA interrupt)
+         *
+         * @details
+         * If FIFO does not contain enough samples, rest of buffer is filled with silence.
+         *
+         * @param [out] samples Samples buffer (interleaved channels)
+         * @param [in] count Samples count
+         *
+         * @returns Count of samples taken from FIFO
+         */
+        static unsigned Pop(uint16_t* samples, unsigned count)
+        {
+            unsigned taken = _fifo.read(reinterpret_cast<int16_t*>(samples), count);
+            for(unsigned i = 0; i < taken; ++i)
+            {
+                samples[i] = (samples[i] ^ 0x8000) >> (16 - _Resolution);
+            }
+            for(unsigned i = taken; i < count; ++i)
+            {
+                samples[i] = 1 << (_Resolution - 1);
+            }
+            return taken;
+        }
+
+        /**
+         * @brief Returns FIFO level
+         *
+         * @returns Samples count in FIFO
+         */
+        static unsigned Level()
+        {
+            return _fifo.size();
+        }
+
+        /**
+         * @brief Handle received packet (should be called from OUT endpoint HandleRx)
+         *
+         * @param [in] data Packet buffer (in packet memory)
+         * @param [in] size Packet size
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void HandleRx(void* data, uint16_t size)
+        {
+            int16_t packet[_Endpoint::MaxPacketSize / sizeof(int16_t)];
+            if(size > _Endpoint::MaxPacketSize)
+                size = _Endpoint::MaxPacketSize;
+            CopyFromUsbPma(packet, data, size);
+            _fifo.write(packet, size / sizeof(int16_t));
+        }
+
+    private:
+        static void OnFeedback()
+        {
+            // 1/64 sample per frame correction for every sample of FIFO level error
+            int32_t error = static_cast<int32_t>(TargetLevel / _Channels) - static_cast<int32_t>(_fifo.size() / _Channels);
+            int32_t correction = error * (1 << 8);
+            if(correction > (1 << 14))
+                correction = 1 << 14;
+            if(correction < -(1 << 14))
+                correction = -(1 << 14);
+
+            uint32_t feedback = NominalFeedback + correction;
+            uint8_t packet[3] = {static_cast<uint8_t>(feedback), static_cast<uint8_t>(feedback >> 8), static_cast<uint8_t>(feedback >> 16)};
+            _FeedbackEndpoint::SendData(packet, sizeof(packet), OnFeedback);
+        }
+
+        static Fifo _fifo;
+    };
+
+    template<typename _Endpoint, typename _FeedbackEndpoint, uint32_t _SampleRate, uint8_t _Channels, unsigned _FifoSamples, uint8_t _Resolution>
+    typename AudioOutStream<_Endpoint, _FeedbackEndpoint, _SampleRate, _Channels, _FifoSamples, _Resolution>::Fifo AudioOutStream<_Endpoint, _FeedbackEndpoint, _SampleRate, _Channels, _FifoSamples, _Resolution>::_fifo;
+#endif
+}
+#endif // ZHELE_USB_AUDIO_H
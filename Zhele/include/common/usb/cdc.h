@@ -10,9 +10,11 @@
 #ifndef ZHELE_USB_CDC_H
 #define ZHELE_USB_CDC_H
 
+#include "composite.h"
 #include "interface.h"
 
 #include "../template_utils/type_list.h"
+#include "../../containers/ring_buffer.h"
 
 #include <string.h>
 
@@ -58,6 +60,36 @@ namespace Zhele::Usb
         using Base = Interface<_Number, _AlternateSetting, DeviceAndInterfaceClass::Comm, _SubClass, _Protocol, _Ep0, _Endpoint>;
         static LineCoding _lineCoding;
     public:
+        /// Line coding changed callback
+        using LineCodingCallback = void(*)(const LineCoding& lineCoding);
+
+        /**
+         * @brief Set line coding changed callback
+         * 
+         * @details
+         * Callback is called from USB interrupt when host has sent SET_LINE_CODING data
+         * (port is opened or its settings are changed).
+         * 
+         * @param [in] callback Callback (nullptr to disable)
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void SetLineCodingCallback(LineCodingCallback callback)
+        {
+            _lineCodingCallback = callback;
+        }
+
+        /**
+         * @brief Returns current line coding
+         * 
+         * @returns Line coding set by host
+         */
+        static const LineCoding& GetLineCoding()
+        {
+            return _lineCoding;
+        }
+
         /**
          * @brief Interface setup request handler
          * 
@@ -74,12 +106,7 @@ namespace Zhele::Usb
                 if(setup->Length == 7)
                 {
                     // Wait line coding
-                    _Ep0::SetOutDataTransferCallback([]{
-                        memcpy(&_lineCoding, reinterpret_cast<const void*>(_Ep0::RxBuffer), 7);
-                        _Ep0::ResetOutDataTransferCallback();
-                        _Ep0::SendZLP();
-                    });
-                    _Ep0::SetRxStatus(EndpointStatus::Valid);
+                    _Ep0::ReceiveControlData(&_lineCoding, sizeof(LineCoding), LineCodingReceived);
                 }
                 break;
             case CdcRequest::GetLineCoding:
@@ -94,39 +121,39 @@ namespace Zhele::Usb
         }
 
         /**
-         * @brief Fills descriptor
-         * 
-         * @param [out] descriptor Destination memory
+         * @brief Returns descriptor
          * 
-         * @par Returns
-         *  Nothing
+         * @returns Descriptor bytes (interface, functionals and endpoint descriptors)
          */
-        static uint16_t FillDescriptor(InterfaceDescriptor* descriptor)
+        static constexpr auto Descriptor()
         {
-            uint16_t totalLength = sizeof(InterfaceDescriptor);
-            
-            *descriptor = InterfaceDescriptor {
+            return ConcatDescriptors(DescriptorBytes(InterfaceDescriptor {
                 .Number = _Number,
                 .AlternateSetting = _AlternateSetting,
                 .EndpointsCount = Base::EndpointsCount,
                 .Class = DeviceAndInterfaceClass::Comm,
                 .SubClass = _SubClass,
                 .Protocol = _Protocol
-            };
-        
-            uint8_t* functionalDescriptors = reinterpret_cast<uint8_t*>(descriptor);
-
-            ((totalLength += _Functionals::FillDescriptor(&functionalDescriptors[totalLength])), ...);
-
-            EndpointDescriptor* endpointDescriptors = reinterpret_cast<EndpointDescriptor*>(&functionalDescriptors[totalLength]);
-            totalLength += _Endpoint::FillDescriptor(endpointDescriptors);
+            }), _Functionals::Descriptor()..., _Endpoint::Descriptor());
+        }
 
-            return totalLength;
+    private:
+        static bool LineCodingReceived([[maybe_unused]] uint16_t size)
+        {
+            if(_lineCodingCallback)
+                _lineCodingCallback(_lineCoding);
+            return true;
         }
+
+        static LineCodingCallback _lineCodingCallback;
     };
     template <uint8_t _Number, uint8_t _AlternateSetting, uint8_t _SubClass, uint8_t _Protocol, typename _Ep0, typename _Endpoint, typename... _Functionals>
     LineCoding CdcCommInterface<_Number, _AlternateSetting, _SubClass, _Protocol, _Ep0, _Endpoint, _Functionals...>::_lineCoding = {115200, 0, 0, 8};
 
+    template <uint8_t _Number, uint8_t _AlternateSetting, uint8_t _SubClass, uint8_t _Protocol, typename _Ep0, typename _Endpoint, typename... _Functionals>
+    typename CdcCommInterface<_Number, _AlternateSetting, _SubClass, _Protocol, _Ep0, _Endpoint, _Functionals...>::LineCodingCallback
+        CdcCommInterface<_Number, _AlternateSetting, _SubClass, _Protocol, _Ep0, _Endpoint, _Functionals...>::_lineCodingCallback = nullptr;
+
     /**
      * @brief Implements CDC communication interface
      * 
@@ -154,30 +181,20 @@ namespace Zhele::Usb
         }
 
         /**
-         * @brief Fills descriptor
-         * 
-         * @param [out] descriptor Destination memory
+         * @brief Returns descriptor
          * 
-         * @par Returns
-         *  Nothing
+         * @returns Descriptor bytes (interface and endpoints descriptors)
          */
-        static uint16_t FillDescriptor(InterfaceDescriptor* descriptor)
+        static constexpr auto Descriptor()
         {
-            uint16_t totalLength = sizeof(InterfaceDescriptor);
-            
-            *descriptor = InterfaceDescriptor {
+            return ConcatDescriptors(DescriptorBytes(InterfaceDescriptor {
                 .Number = _Number,
                 .AlternateSetting = _AlternateSetting,
                 .EndpointsCount = Base::EndpointsCount,
                 .Class = DeviceAndInterfaceClass::CdcData,
                 .SubClass = _SubClass,
                 .Protocol = _Protocol
-            };
-
-            uint8_t* endpointsDescriptors = reinterpret_cast<uint8_t*>(descriptor);
-            ((totalLength += _Endpoints::FillDescriptor(reinterpret_cast<EndpointDescriptor*>(&endpointsDescriptors[totalLength]))), ...);
-
-            return totalLength;
+            }), _Endpoints::Descriptor()...);
         }
     };
 
@@ -191,19 +208,20 @@ namespace Zhele::Usb
     template<uint8_t _DescriptorType, uint8_t _DescriptorSubtype, uint8_t... _Data>
     class FunctionalDescriptor
     {
-        static constexpr uint8_t _data[sizeof...(_Data)] = {_Data...};
     public:
-        static uint8_t FillDescriptor(void* address)
+        /**
+         * @brief Returns descriptor
+         * 
+         * @returns Descriptor bytes
+         */
+        static constexpr auto Descriptor()
         {
-            uint8_t* destination = reinterpret_cast<uint8_t*>(address);
-            
-            destination[0] = 3 + sizeof...(_Data); // bFunctionLength
-            destination[1] = _DescriptorType; // bDescriptorType
-            destination[2] = _DescriptorSubtype; // bDescriptorSubtype
-
-            memcpy(&destination[3], _data, sizeof...(_Data)); // Data
-
-            return 3 + sizeof...(_Data);
+            return std::array<uint8_t, 3 + sizeof...(_Data)> {
+                3 + sizeof...(_Data), // bFunctionLength
+                _DescriptorType, // bDescriptorType
+                _DescriptorSubtype, // bDescriptorSubtype
+                _Data... // Data
+            };
         }
     };
 
@@ -223,6 +241,7 @@ namespace Zhele::Usb
         DeviceManagement = 0x09, ///< Device Management
         MobileDirectLine = 0x0a, ///< Mobile Direct Line Model
         Obex = 0x0b, ///< OBEX
+        Ncm = 0x0d, ///< Network Control Model
     };
     
     /**
@@ -257,5 +276,338 @@ namespace Zhele::Usb
      */
     template<uint8_t _Number, typename _Ep0, typename _Endpoint>
     using DefaultCdcCommInterface = CdcCommInterface<_Number, 0, 0x02, 0x01, _Ep0, _Endpoint, HeaderFunctional, CallManagementFunctional, AcmFunctional, UnionFunctional>;
+
+    /**
+     * @brief CDC ACM communication interface of composite device
+     * 
+     * @details
+     * Unlike DefaultCdcCommInterface, call management and union functionals refer to given
+     * data interface, and descriptor is preceded by interface association descriptor
+     * (communication and data interfaces are one function). So several ACM ports can be
+     * placed in one configuration. Device class should be DeviceAndInterfaceClass::Miscellaneous
+     * with subclass 0x02 and protocol 0x01 (IAD device).
+     * 
+     * @tparam _Number Interface number
+     * @tparam _DataInterface Data interface number (usually _Number + 1)
+     * @tparam _Ep0 Zero endpoint
+     * @tparam _Endpoint Communication endpoint
+     */
+    template<uint8_t _Number, uint8_t _DataInterface, typename _Ep0, typename _Endpoint>
+    class CdcAcmCommInterface : public CdcCommInterface<_Number, 0, 0x02, 0x01, _Ep0, _Endpoint, HeaderFunctional,
+        InterfaceFunctionalDescriptor<static_cast<uint8_t>(CdcInterfaceSubClass::DirectLine), 0x00, _DataInterface>,
+        AcmFunctional,
+        InterfaceFunctionalDescriptor<static_cast<uint8_t>(CdcInterfaceSubClass::Ethernet), _Number, _DataInterface>>
+    {
+        using Base = CdcCommInterface<_Number, 0, 0x02, 0x01, _Ep0, _Endpoint, HeaderFunctional,
+            InterfaceFunctionalDescriptor<static_cast<uint8_t>(CdcInterfaceSubClass::DirectLine), 0x00, _DataInterface>,
+            AcmFunctional,
+            InterfaceFunctionalDescriptor<static_cast<uint8_t>(CdcInterfaceSubClass::Ethernet), _Number, _DataInterface>>;
+
+        static_assert(_DataInterface == _Number + 1, "Associated interfaces should be contiguous (data interface follows communication one).");
+    public:
+        /**
+         * @brief Returns descriptor
+         * 
+         * @returns Descriptor bytes (interface association, interface, functionals and endpoint descriptors)
+         */
+        static constexpr auto Descriptor()
+        {
+            return ConcatDescriptors(DescriptorBytes(InterfaceAssociationDescriptor {
+                .FirstInterface = _Number,
+                .InterfacesCount = 2,
+                .Class = DeviceAndInterfaceClass::Comm,
+                .SubClass = 0x02,
+                .Protocol = 0x01
+            }), Base::Descriptor());
+        }
+    };
+
+#if defined (USB)
+    /**
+     * @brief Buffered CDC data stream over double-buffered bulk endpoints
+     * 
+     * @details
+     * Received packets are stored in RX FIFO, data for host is collected in TX FIFO.
+     * FIFOs are lock-free single producer/single consumer ring buffers, so Read/Write
+     * can be called from main loop while endpoints are handled in USB interrupt.
+     * If RX FIFO has no space for two more packets, OUT endpoint is NAKed
+     * (host retries later) until application reads data.
+     * Small writes are coalesced: packet is sent only when MaxPacketSize bytes are collected,
+     * on Flush or after _FlushTimeout Tick calls without writes. There is no SOF interrupt
+     * in device, so Tick should be called periodically (SysTick or timer, 1 ms for example).
+     * 
+     * OUT endpoint HandleRx should call CdcStream::HandleRx:
+     * @code
+     * template<> void CdcDataOutEndpoint::HandleRx(void* data, uint16_t size) { Stream::HandleRx(data, size); }
+     * @endcode
+     * 
+     * @tparam _OutEp OUT bulk double-buffered endpoint
+     * @tparam _InEp IN bulk double-buffered endpoint
+     * @tparam _RxSize RX FIFO size (power of 2)
+     * @tparam _TxSize TX FIFO size (power of 2)
+     * @tparam _FlushTimeout Idle ticks before partial packet sending
+     */
+    template<typename _OutEp, typename _InEp, unsigned _RxSize = 256, unsigned _TxSize = 256, unsigned _FlushTimeout = 2>
+    class CdcStream
+    {
+        static_assert((_RxSize & (_RxSize - 1)) == 0 && (_TxSize & (_TxSize - 1)) == 0, "FIFO sizes should be powers of 2.");
+        static_assert(_RxSize >= 4 * _OutEp::MaxPacketSize, "RX FIFO should contain at least 4 packets.");
+        static_assert(_TxSize >= _InEp::MaxPacketSize, "TX FIFO should contain at least one packet.");
+
+        using RxFifo = Containers::Private::RingBufferPO2<_RxSize, uint8_t>;
+        using TxFifo = Containers::Private::RingBufferPO2<_TxSize, uint8_t>;
+    public:
+        /**
+         * @brief Write data to TX FIFO
+         * 
+         * @param [in] data Data
+         * @param [in] size Data size
+         * 
+         * @returns Count of written bytes (less than size if FIFO is full)
+         */
+        static unsigned Write(const void* data, unsigned size)
+        {
+            unsigned written = _txFifo.write(reinterpret_cast<const uint8_t*>(data), size < _TxSize ? size : _TxSize);
+            _idleTicks = 0;
+            StartTx(false);
+            return written;
+        }
+
+        /**
+         * @brief Read received data
+         * 
+         * @param [out] data Output buffer
+         * @param [in] size Buffer size
+         * 
+         * @returns Count of read bytes
+         */
+        static unsigned Read(void* data, unsigned size)
+        {
+            unsigned read = _rxFifo.read(reinterpret_cast<uint8_t*>(data), size < _RxSize ? size : _RxSize);
+            ResumeRx();
+            return read;
+        }
+
+        /**
+         * @brief Returns count of received bytes
+         * 
+         * @returns Bytes count
+         */
+        static unsigned Available()
+        {
+            return _rxFifo.size();
+        }
+
+        /**
+         * @brief Returns free space in TX FIFO
+         * 
+         * @returns Bytes count
+         */
+        static unsigned WriteAvailable()
+        {
+            return _TxSize - _txFifo.size();
+        }
+
+        /**
+         * @brief Send all data from TX FIFO (including partial packet)
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Flush()
+        {
+            _flushRequested = true;
+            StartTx(true);
+        }
+
+        /**
+         * @brief Flush timer tick
+         * 
+         * @details
+         * Should be called periodically. Partial packet is sent
+         * if there were no writes during _FlushTimeout ticks.
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Tick()
+        {
+            if(_txFifo.empty())
+                return;
+            if(++_idleTicks >= _FlushTimeout)
+            {
+                _idleTicks = 0;
+                Flush();
+            }
+        }
+
+        /**
+         * @brief Handle received packet (should be called from OUT endpoint HandleRx)
+         * 
+         * @param [in] data Packet buffer (in packet memory)
+         * @param [in] size Packet size
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void HandleRx(void* data, uint16_t size)
+        {
+            uint8_t packet[_OutEp::MaxPacketSize];
+            if(size > _OutEp::MaxPacketSize)
+                size = _OutEp::MaxPacketSize;
+            CopyFromUsbPma(packet, data, size);
+            _rxFifo.write(packet, size);
+
+            if(_RxSize - _rxFifo.size() < 2 * _OutEp::MaxPacketSize)
+            {
+                _rxPaused = true;
+                _OutEp::SetRxStatus(EndpointStatus::Nak);
+            }
+        }
+
+    private:
+        static void ResumeRx()
+        {
+            if(!_rxPaused)
+                return;
+
+            uint32_t primask = __get_PRIMASK();
+            __disable_irq();
+            if(_rxPaused && _RxSize - _rxFifo.size() >= 2 * _OutEp::MaxPacketSize)
+            {
+                _rxPaused = false;
+                _OutEp::SetRxStatus(EndpointStatus::Valid);
+            }
+            __set_PRIMASK(primask);
+        }
+
+        static void StartTx(bool flush)
+        {
+            uint32_t primask = __get_PRIMASK();
+            __disable_irq();
+            unsigned pending = _txFifo.size();
+            if(_txBusy || pending == 0 || (pending < _InEp::MaxPacketSize && !flush))
+            {
+                if(pending == 0)
+                    _flushRequested = false;
+                __set_PRIMASK(primask);
+                return;
+            }
+            _txBusy = true;
+            __set_PRIMASK(primask);
+
+            unsigned size = _txFifo.contiguous_size();
+            if(size > _InEp::MaxPacketSize)
+                size = _InEp::MaxPacketSize;
+            CopyToUsbPma(const_cast<uint16_t*>(_InEp::PacketBuffer()), &_txFifo.front(), size);
+            _txFifo.skip(size);
+            _InEp::SendPacket(size, OnTxComplete);
+        }
+
+        static void OnTxComplete()
+        {
+            _txBusy = false;
+            StartTx(_flushRequested);
+        }
+
+        static RxFifo _rxFifo;
+        static TxFifo _txFifo;
+        static volatile bool _txBusy;
+        static volatile bool _rxPaused;
+        static volatile bool _flushRequested;
+        static volatile unsigned _idleTicks;
+    };
+
+    template<typename _OutEp, typename _InEp, unsigned _RxSize, unsigned _TxSize, unsigned _FlushTimeout>
+    typename CdcStream<_OutEp, _InEp, _RxSize, _TxSize, _FlushTimeout>::RxFifo CdcStream<_OutEp, _InEp, _RxSize, _TxSize, _FlushTimeout>::_rxFifo;
+
+    template<typename _OutEp, typename _InEp, unsigned _RxSize, unsigned _TxSize, unsigned _FlushTimeout>
+    typename CdcStream<_OutEp, _InEp, _RxSize, _TxSize, _FlushTimeout>::TxFifo CdcStream<_OutEp, _InEp, _RxSize, _TxSize, _FlushTimeout>::_txFifo;
+
+    template<typename _OutEp, typename _InEp, unsigned _RxSize, unsigned _TxSize, unsigned _FlushTimeout>
+    volatile bool CdcStream<_OutEp, _InEp, _RxSize, _TxSize, _FlushTimeout>::_txBusy = false;
+
+    template<typename _OutEp, typename _InEp, unsigned _RxSize, unsigned _TxSize, unsigned _FlushTimeout>
+    volatile bool CdcStream<_OutEp, _InEp, _RxSize, _TxSize, _FlushTimeout>::_rxPaused = false;
+
+    template<typename _OutEp, typename _InEp, unsigned _RxSize, unsigned _TxSize, unsigned _FlushTimeout>
+    volatile bool CdcStream<_OutEp, _InEp, _RxSize, _TxSize, _FlushTimeout>::_flushRequested = false;
+
+    template<typename _OutEp, typename _InEp, unsigned _RxSize, unsigned _TxSize, unsigned _FlushTimeout>
+    volatile unsigned CdcStream<_OutEp, _InEp, _RxSize, _TxSize, _FlushTimeout>::_idleTicks = 0;
+
+    /**
+     * @brief Dual-port CDC ACM function (two virtual COM ports)
+     * 
+     * @details
+     * Declares endpoints of two ACM ports as composite plan requests, so endpoints numbers
+     * and packet sizes are chosen to fit packet memory (port 1 endpoints are shrunk first),
+     * and provides both ports interfaces (with interface association descriptors) and streams.
+     * Ports have own endpoints and FIFOs: if host does not read port 1 (console is closed or stalled),
+     * only port 1 TX FIFO fills up (Write returns 0) and only its OUT endpoint is NAKed,
+     * so high-rate data on port 0 is not blocked.
+     * 
+     * @code
+     * using Cdc = DualCdc<>;
+     * using Config = Configuration<0, 250, false, false, Cdc::Comm0, Cdc::Data0, Cdc::Comm1, Cdc::Data1>;
+     * using MyDevice = Device<0x0200, DeviceAndInterfaceClass::Miscellaneous, 0x02, 0x01, 0x0483, 0x5740, 0, Cdc::Ep0, Config>;
+     * template<> void Cdc::OutEp0::HandleRx(void* data, uint16_t size) { Cdc::Stream0::HandleRx(data, size); }
+     * template<> void Cdc::OutEp1::HandleRx(void* data, uint16_t size) { Cdc::Stream1::HandleRx(data, size); }
+     * @endcode
+     * 
+     * @tparam _Ep0Base Control endpoint base
+     * @tparam _FirstInterface Port 0 communication interface number (function takes four interfaces)
+     * @tparam _RxSize0 Port 0 RX FIFO size (power of 2)
+     * @tparam _TxSize0 Port 0 TX FIFO size (power of 2)
+     * @tparam _RxSize1 Port 1 RX FIFO size (power of 2)
+     * @tparam _TxSize1 Port 1 TX FIFO size (power of 2)
+     * @tparam _FlushTimeout Idle ticks before partial packet sending
+     */
+    template<typename _Ep0Base = DefaultEp0, uint8_t _FirstInterface = 0, unsigned _RxSize0 = 512, unsigned _TxSize0 = 512,
+        unsigned _RxSize1 = 256, unsigned _TxSize1 = 256, unsigned _FlushTimeout = 2>
+    class DualCdc
+    {
+        template<uint8_t _Port>
+        class CommRequest : public InEndpointRequest<EndpointType::Interrupt, 8, 0xff> {};
+        template<uint8_t _Port>
+        class OutRequest : public OutEndpointRequest<EndpointType::BulkDoubleBuffered> {};
+        template<uint8_t _Port>
+        class InRequest : public InEndpointRequest<EndpointType::BulkDoubleBuffered> {};
+    public:
+        /// Endpoints plan
+        using Plan = CompositeEndpointsPlan<_Ep0Base, CommRequest<0>, OutRequest<0>, InRequest<0>, CommRequest<1>, OutRequest<1>, InRequest<1>>;
+
+        /// Control endpoint (use it as device control endpoint)
+        using Ep0 = typename Plan::Initializer::template ExtendEndpoint<_Ep0Base>;
+
+        using CommEp0 = typename Plan::Initializer::template ExtendEndpoint<typename Plan::template Endpoint<CommRequest<0>>>; ///< Port 0 notification endpoint
+        using OutEp0 = typename Plan::Initializer::template ExtendEndpoint<typename Plan::template Endpoint<OutRequest<0>>>; ///< Port 0 OUT endpoint
+        using InEp0 = typename Plan::Initializer::template ExtendEndpoint<typename Plan::template Endpoint<InRequest<0>>>; ///< Port 0 IN endpoint
+        using CommEp1 = typename Plan::Initializer::template ExtendEndpoint<typename Plan::template Endpoint<CommRequest<1>>>; ///< Port 1 notification endpoint
+        using OutEp1 = typename Plan::Initializer::template ExtendEndpoint<typename Plan::template Endpoint<OutRequest<1>>>; ///< Port 1 OUT endpoint
+        using InEp1 = typename Plan::Initializer::template ExtendEndpoint<typename Plan::template Endpoint<InRequest<1>>>; ///< Port 1 IN endpoint
+
+        using Comm0 = CdcAcmCommInterface<_FirstInterface, _FirstInterface + 1, Ep0, CommEp0>; ///< Port 0 communication interface
+        using Data0 = CdcDataInterface<_FirstInterface + 1, 0, 0, 0, Ep0, OutEp0, InEp0>; ///< Port 0 data interface
+        using Comm1 = CdcAcmCommInterface<_FirstInterface + 2, _FirstInterface + 3, Ep0, CommEp1>; ///< Port 1 communication interface
+        using Data1 = CdcDataInterface<_FirstInterface + 3, 0, 0, 0, Ep0, OutEp1, InEp1>; ///< Port 1 data interface
+
+        using Stream0 = CdcStream<OutEp0, InEp0, _RxSize0, _TxSize0, _FlushTimeout>; ///< Port 0 stream
+        using Stream1 = CdcStream<OutEp1, InEp1, _RxSize1, _TxSize1, _FlushTimeout>; ///< Port 1 stream
+
+        /**
+         * @brief Flush timer tick of both streams
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Tick()
+        {
+            Stream0::Tick();
+            Stream1::Tick();
+        }
+    };
+#endif
 }
+
 #endif // ZHELE_USB_CDC_H
\ No newline at end of file
@@ -0,0 +1,228 @@
+/**
+ * @file
+ * USB CDC to USART bridge
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_USB_CDC_BRIDGE_H
+#define ZHELE_USB_CDC_BRIDGE_H
+
+#include "cdc.h"
+
+#include <stdint.h>
+
+namespace Zhele::Usb
+{
+#if defined (USB)
+    /**
+     * @brief USB CDC to USART bridge (USB-serial adapter)
+     *
+     * @details
+     * Host to USART: every OUT packet is copied from packet memory to its own slot (packet memory can't be
+     * DMA source) and slot is sent by USART DMA as is, so data is not collected in FIFO. If less than
+     * two slots are free, OUT endpoint is NAKed (host retries later) until USART DMA completes slot.
+     * USART to host: USART receives by circular DMA (Usart::EnableStreamRead) and received data
+     * is copied from DMA buffer directly to IN endpoint packet memory (on USART idle line,
+     * half/full buffer DMA events and IN packet completion).
+     * Baud rate set by host (SET_LINE_CODING) is applied by SetLineCoding (data format is not changed).
+     *
+     * @code
+     * using Bridge = CdcUartBridge<CdcDataEndpoint, CdcDataEndpointIn, Usart1>;
+     * template<> void CdcDataEndpoint::HandleRx(void* data, uint16_t size) { Bridge::HandleRx(data, size); }
+     * ...
+     * CdcComm::SetLineCodingCallback(Bridge::SetLineCoding);
+     * Bridge::Init();
+     * @endcode
+     * USART IRQ handler should call Usart::IrqHandler, its TX and RX DMA channels IRQ handlers should call
+     * channel IrqHandler.
+     *
+     * @tparam _OutEp OUT bulk double-buffered endpoint
+     * @tparam _InEp IN bulk double-buffered endpoint
+     * @tparam _Usart USART (initialized by application)
+     * @tparam _RxSize USART circular DMA buffer size
+     * @tparam _Slots Host to USART packet slots count
+     */
+    template<typename _OutEp, typename _InEp, typename _Usart, unsigned _RxSize = 256, unsigned _Slots = 4>
+    class CdcUartBridge
+    {
+        static_assert(_Slots >= 3 && _Slots <= 255, "Bridge requires from 3 to 255 slots.");
+        static_assert(_RxSize >= 2 * _InEp::MaxPacketSize, "USART buffer should contain at least two packets.");
+    public:
+        /**
+         * @brief Start bridge (USART reception)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Init()
+        {
+            _Usart::EnableStreamRead(_rxBuffer, _RxSize, [](void*, unsigned, bool){ StartTx(); });
+        }
+
+        /**
+         * @brief Apply line coding (can be used as CdcCommInterface line coding callback)
+         *
+         * @param [in] lineCoding Line coding set by host
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void SetLineCoding(const LineCoding& lineCoding)
+        {
+            if(lineCoding.BaudRate != 0)
+                _Usart::SetBaud(lineCoding.BaudRate);
+        }
+
+        /**
+         * @brief Handle received packet (should be called from OUT endpoint HandleRx)
+         *
+         * @param [in] data Packet buffer (in packet memory)
+         * @param [in] size Packet size
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void HandleRx(void* data, uint16_t size)
+        {
+            if(size > _OutEp::MaxPacketSize)
+                size = _OutEp::MaxPacketSize;
+
+            // Endpoint is NAKed before slots run out, so slot after last used one is free
+            uint32_t primask = __get_PRIMASK();
+            __disable_irq();
+            uint8_t slot = (_head + _count) % _Slots;
+            __set_PRIMASK(primask);
+            CopyFromUsbPma(_slots[slot], data, size);
+            _sizes[slot] = size;
+
+            primask = __get_PRIMASK();
+            __disable_irq();
+            _count = _count + 1;
+            if(_Slots - _count < 2)
+            {
+                _rxPaused = true;
+                _OutEp::SetRxStatus(EndpointStatus::Nak);
+            }
+            __set_PRIMASK(primask);
+
+            StartUartTx();
+        }
+
+        /**
+         * @brief Returns count of packets waiting for USART
+         *
+         * @returns Packets count
+         */
+        static unsigned Pending()
+        {
+            return _count;
+        }
+
+    private:
+        static void StartUartTx()
+        {
+            uint32_t primask = __get_PRIMASK();
+            __disable_irq();
+            if(_uartBusy || _count == 0)
+            {
+                __set_PRIMASK(primask);
+                return;
+            }
+            _uartBusy = true;
+            __set_PRIMASK(primask);
+
+            _Usart::WriteAsync(_slots[_head], _sizes[_head], OnUartTxComplete);
+        }
+
+        static void OnUartTxComplete([[maybe_unused]] void* data, [[maybe_unused]] unsigned size, [[maybe_unused]] bool success)
+        {
+            uint32_t primask = __get_PRIMASK();
+            __disable_irq();
+            _head = (_head + 1) % _Slots;
+            _count = _count - 1;
+            _uartBusy = false;
+            if(_rxPaused && _Slots - _count >= 2)
+            {
+                _rxPaused = false;
+                _OutEp::SetRxStatus(EndpointStatus::Valid);
+            }
+            __set_PRIMASK(primask);
+
+            StartUartTx();
+        }
+
+        static void StartTx()
+        {
+            uint32_t primask = __get_PRIMASK();
+            __disable_irq();
+            if(_txBusy)
+            {
+                __set_PRIMASK(primask);
+                return;
+            }
+            _txBusy = true;
+            __set_PRIMASK(primask);
+
+            const uint8_t* data;
+            size_t size = _Usart::StreamPeek(data);
+            if(size == 0)
+            {
+                _txBusy = false;
+                // Data notification could be missed while flag was set
+                if(_Usart::StreamAvailable() > 0)
+                    StartTx();
+                return;
+            }
+            if(size > _InEp::MaxPacketSize)
+                size = _InEp::MaxPacketSize;
+            CopyToUsbPma(const_cast<uint16_t*>(_InEp::PacketBuffer()), data, size);
+            _Usart::StreamConsume(size);
+            _InEp::SendPacket(size, OnTxComplete);
+        }
+
+        static void OnTxComplete()
+        {
+            _txBusy = false;
+            StartTx();
+        }
+
+        static uint8_t _rxBuffer[_RxSize];
+        static uint8_t _slots[_Slots][_OutEp::MaxPacketSize];
+        static uint16_t _sizes[_Slots];
+        static volatile uint8_t _head;
+        static volatile uint8_t _count;
+        static volatile bool _uartBusy;
+        static volatile bool _rxPaused;
+        static volatile bool _txBusy;
+    };
+
+    template<typename _OutEp, typename _InEp, typename _Usart, unsigned _RxSize, unsigned _Slots>
+    uint8_t CdcUartBridge<_OutEp, _InEp, _Usart, _RxSize, _Slots>::_rxBuffer[_RxSize];
+
+    template<typename _OutEp, typename _InEp, typename _Usart, unsigned _RxSize, unsigned _Slots>
+    uint8_t CdcUartBridge<_OutEp, _InEp, _Usart, _RxSize, _Slots>::_slots[_Slots][_OutEp::MaxPacketSize];
+
+    template<typename _OutEp, typename _InEp, typename _Usart, unsigned _RxSize, unsigned _Slots>
+    uint16_t CdcUartBridge<_OutEp, _InEp, _Usart, _RxSize, _Slots>::_sizes[_Slots];
+
+    template<typename _OutEp, typename _InEp, typename _Usart, unsigned _RxSize, unsigned _Slots>
+    volatile uint8_t CdcUartBridge<_OutEp, _InEp, _Usart, _RxSize, _Slots>::_head = 0;
+
+    template<typename _OutEp, typename _InEp, typename _Usart, unsigned _RxSize, unsigned _Slots>
+    volatile uint8_t CdcUartBridge<_OutEp, _InEp, _Usart, _RxSize, _Slots>::_count = 0;
+
+    template<typename _OutEp, typename _InEp, typename _Usart, unsigned _RxSize, unsigned _Slots>
+    volatile bool CdcUartBridge<_OutEp, _InEp, _Usart, _RxSize, _Slots>::_uartBusy = false;
+
+    template<typename _OutEp, typename _InEp, typename _Usart, unsigned _RxSize, unsigned _Slots>
+    volatile bool CdcUartBridge<_OutEp, _InEp, _Usart, _RxSize, _Slots>::_rxPaused = false;
+
+    template<typename _OutEp, typename _InEp, typename _Usart, unsigned _RxSize, unsigned _Slots>
+    volatile bool CdcUartBridge<_OutEp, _InEp, _Usart, _RxSize, _Slots>::_txBusy = false;
+#endif
+}
+
+#endif //! ZHELE_USB_CDC_BRIDGE_H
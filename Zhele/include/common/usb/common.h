@@ -10,9 +10,48 @@
 #ifndef ZHELE_USB_COMMON_H
 #define ZHELE_USB_COMMON_H
 
+#include <array>
+#include <bit>
 #include <stdint.h>
 #include <cstring>
 
+#if defined (USB_OTG_FS)
+    /*
+     * OTG core selection (stm32f4):
+     *  - ZHELE_USB_OTG_HS - use OTG_HS core instead of OTG_FS;
+     *  - ZHELE_USB_OTG_HS_ULPI - OTG_HS works in high-speed mode with external ULPI PHY
+     *    (embedded full-speed PHY is used otherwise);
+     *  - ZHELE_USB_OTG_DMA - OTG_HS internal DMA mode (data is transferred without FIFO access by CPU).
+     */
+    #if defined (ZHELE_USB_OTG_HS)
+        #if !defined (USB_OTG_HS)
+            #error "OTG_HS core is not available."
+        #endif
+        #define ZHELE_USB_OTG_PERIPH_BASE USB_OTG_HS_PERIPH_BASE
+    #else
+        #define ZHELE_USB_OTG_PERIPH_BASE USB_OTG_FS_PERIPH_BASE
+    #endif
+    #if (defined (ZHELE_USB_OTG_HS_ULPI) || defined (ZHELE_USB_OTG_DMA)) && !defined (ZHELE_USB_OTG_HS)
+        #error "ULPI PHY and DMA mode are supported by OTG_HS core only."
+    #endif
+#endif
+
+#if defined (USB)
+    /*
+     * Packet memory layout options:
+     *  - ZHELE_USB_PMA_SIZE - packet memory size in bytes (512 for stm32f1/stm32f3, 1024 otherwise);
+     *  - ZHELE_USB_PMA_DOUBLE_BUFFERED_FIRST - place buffers of double-buffered (bulk and isochronous) endpoints
+     *    right after buffer descriptor table, before other endpoints buffers.
+     */
+    #if !defined (ZHELE_USB_PMA_SIZE)
+        #if defined (STM32F1) || defined (STM32F3)
+            #define ZHELE_USB_PMA_SIZE 512
+        #else
+            #define ZHELE_USB_PMA_SIZE 1024
+        #endif
+    #endif
+#endif
+
 namespace Zhele::Usb
 {
 /// Thanks ST very much O_o
@@ -24,36 +63,150 @@ namespace Zhele::Usb
     const unsigned PmaAlignMultiplier = 1;
 #endif
 
+#if defined (USB)
+    /// Packet memory size (in bytes)
+    const unsigned PmaSize = ZHELE_USB_PMA_SIZE;
+#endif
+
+#if defined (ZHELE_USB_OTG_HS)
+    /// OTG FIFO RAM size (in words)
+    const unsigned OtgFifoRamSize = 1024;
+#elif defined (USB_OTG_FS)
+    /// OTG FIFO RAM size (in words)
+    const unsigned OtgFifoRamSize = 320;
+#endif
+
+    /**
+     * @brief Copy data from USB packet memory
+     * 
+     * @details
+     * Packet memory is accessed by halfwords (PmaAlignMultiplier halfwords stride).
+     * Word-aligned destination is written by words, loop is unrolled.
+     * 
+     * @param [out] destination Destination buffer (RAM)
+     * @param [in] source Source (packet memory)
+     * @param [in] size Data size
+     * 
+     * @par Returns
+     *  Nothing
+     */
     inline void CopyFromUsbPma(void* destination, const void* source, unsigned size)
     {
-        if constexpr(PmaAlignMultiplier != 1) {
-            for(int i = 0; i < size / 2; ++i) {
-                reinterpret_cast<uint16_t*>(destination)[i] = reinterpret_cast<const uint16_t*>(source)[PmaAlignMultiplier * i];
-            }
-            if(size & 0x01) {
-                reinterpret_cast<uint8_t*>(&destination)[size - 1] = reinterpret_cast<const uint8_t*>(source)[PmaAlignMultiplier * (size - 1)];
+        const volatile uint16_t* pma = reinterpret_cast<const volatile uint16_t*>(source);
+        uint8_t* data = reinterpret_cast<uint8_t*>(destination);
+
+        if((reinterpret_cast<uintptr_t>(data) & 0x03) == 0) {
+            uint32_t* words = reinterpret_cast<uint32_t*>(data);
+            for(; size >= 16; size -= 16, words += 4, pma += 8 * PmaAlignMultiplier) {
+                words[0] = pma[0 * PmaAlignMultiplier] | (pma[1 * PmaAlignMultiplier] << 16);
+                words[1] = pma[2 * PmaAlignMultiplier] | (pma[3 * PmaAlignMultiplier] << 16);
+                words[2] = pma[4 * PmaAlignMultiplier] | (pma[5 * PmaAlignMultiplier] << 16);
+                words[3] = pma[6 * PmaAlignMultiplier] | (pma[7 * PmaAlignMultiplier] << 16);
             }
+            data = reinterpret_cast<uint8_t*>(words);
         }
-        else {
-            memcpy(destination, source, size);
+
+        for(; size >= 2; size -= 2, data += 2, pma += PmaAlignMultiplier) {
+            uint16_t halfWord = *pma;
+            data[0] = halfWord & 0xff;
+            data[1] = halfWord >> 8;
+        }
+        if(size > 0) {
+            data[0] = *pma & 0xff;
         }
     }
 
+    /**
+     * @brief Copy data to USB packet memory
+     * 
+     * @details
+     * Packet memory is accessed by halfwords (PmaAlignMultiplier halfwords stride).
+     * Word-aligned source is read by words, loop is unrolled.
+     * Odd-aligned source is handled bytewise.
+     * 
+     * @param [out] destination Destination (packet memory)
+     * @param [in] source Source buffer (RAM)
+     * @param [in] size Data size
+     * 
+     * @par Returns
+     *  Nothing
+     */
     inline void CopyToUsbPma(void* destination, const void* source, unsigned size)
     {
-        if constexpr(PmaAlignMultiplier != 1) {
-            for(int i = 0; i < size / 2; ++i) {
-                reinterpret_cast<uint16_t*>(destination)[PmaAlignMultiplier * i] = reinterpret_cast<const uint16_t*>(source)[i];
+        volatile uint16_t* pma = reinterpret_cast<volatile uint16_t*>(destination);
+        const uint8_t* data = reinterpret_cast<const uint8_t*>(source);
+
+        if((reinterpret_cast<uintptr_t>(data) & 0x03) == 0) {
+            const uint32_t* words = reinterpret_cast<const uint32_t*>(data);
+            for(; size >= 16; size -= 16, words += 4, pma += 8 * PmaAlignMultiplier) {
+                uint32_t word0 = words[0];
+                uint32_t word1 = words[1];
+                uint32_t word2 = words[2];
+                uint32_t word3 = words[3];
+                pma[0 * PmaAlignMultiplier] = word0;
+                pma[1 * PmaAlignMultiplier] = word0 >> 16;
+                pma[2 * PmaAlignMultiplier] = word1;
+                pma[3 * PmaAlignMultiplier] = word1 >> 16;
+                pma[4 * PmaAlignMultiplier] = word2;
+                pma[5 * PmaAlignMultiplier] = word2 >> 16;
+                pma[6 * PmaAlignMultiplier] = word3;
+                pma[7 * PmaAlignMultiplier] = word3 >> 16;
             }
-            if(size & 0x01) {
-                reinterpret_cast<uint8_t*>(&destination)[PmaAlignMultiplier * (size - 1)] = reinterpret_cast<const uint8_t*>(source)[size - 1];
+            data = reinterpret_cast<const uint8_t*>(words);
+        }
+
+        if((reinterpret_cast<uintptr_t>(data) & 0x01) == 0) {
+            const uint16_t* halfWords = reinterpret_cast<const uint16_t*>(data);
+            for(; size >= 2; size -= 2, ++halfWords, pma += PmaAlignMultiplier) {
+                *pma = *halfWords;
             }
+            data = reinterpret_cast<const uint8_t*>(halfWords);
         }
         else {
-            memcpy(destination, source, size);
+            for(; size >= 2; size -= 2, data += 2, pma += PmaAlignMultiplier) {
+                *pma = data[0] | (data[1] << 8);
+            }
+        }
+        if(size > 0) {
+            *pma = data[0];
         }
     }
 
+    /**
+     * @brief Converts descriptor structure to bytes at compile time
+     * 
+     * @tparam _Descriptor Descriptor type (packed structure without bit-fields)
+     * 
+     * @param [in] descriptor Descriptor
+     * 
+     * @returns Descriptor bytes
+     */
+    template<typename _Descriptor>
+    constexpr std::array<uint8_t, sizeof(_Descriptor)> DescriptorBytes(const _Descriptor& descriptor)
+    {
+        return std::bit_cast<std::array<uint8_t, sizeof(_Descriptor)>>(descriptor);
+    }
+
+    /**
+     * @brief Concatenates descriptors at compile time
+     * 
+     * @param [in] descriptors Descriptors bytes
+     * 
+     * @returns Descriptors bytes
+     */
+    template<size_t... _Sizes>
+    constexpr std::array<uint8_t, (0 + ... + _Sizes)> ConcatDescriptors(const std::array<uint8_t, _Sizes>&... descriptors)
+    {
+        std::array<uint8_t, (0 + ... + _Sizes)> result {};
+        size_t offset = 0;
+        auto append = [&result, &offset](const auto& descriptor) {
+            for(uint8_t byte : descriptor)
+                result[offset++] = byte;
+        };
+        (append(descriptors), ...);
+        return result;
+    }
+
     /**
      * @brief Decription type constant
      */
@@ -63,7 +216,12 @@ namespace Zhele::Usb
         Configuration = 0x02, ///< Configuration descriptor
         String = 0x03, ///< String descriptor
         Interface = 0x04, ///< Interface descriptor
-        Endpoint = 0x05 ///< Endpoint descriptor
+        Endpoint = 0x05, ///< Endpoint descriptor
+        DeviceQualifier = 0x06, ///< Device qualifier descriptor
+        OtherSpeedConfiguration = 0x07, ///< Other speed configuration descriptor
+        InterfaceAssociation = 0x0b, ///< Interface association descriptor (IAD)
+        Bos = 0x0f, ///< Binary device object store (BOS) descriptor
+        DeviceCapability = 0x10, ///< Device capability descriptor
     };
 
     /**
@@ -82,6 +240,8 @@ namespace Zhele::Usb
         Storage = 0x08, ///< Storage device
         Hub = 0x09, ///< Hub
         CdcData = 0x0a, ///< CDC Data
+        Miscellaneous = 0xef, ///< Miscellaneous (composite device with interface association descriptors)
+        ApplicationSpecific = 0xfe, ///< Application specific (DFU)
         VendorSpecified = 0xff ///< Vendor specified device
     };
     using InterfaceClass = DeviceAndInterfaceClass; // legacy
@@ -119,6 +279,7 @@ namespace Zhele::Usb
         StringSerialNumberDescriptor = 0x303, ///< String serial number descriptor
         StringMsOsDescriptor = 0x3ee, ///< MS OS Descriptor
         DeviceQualifierDescriptor = 0x600, ///< Device qualifier descriptor
+        BosDescriptor = 0xf00, ///< BOS descriptor
     };
 
     /**
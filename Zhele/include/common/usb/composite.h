@@ -0,0 +1,313 @@
+/**
+ * @file
+ * Implements endpoints planning for composite devices
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_USB_COMPOSITE_H
+#define ZHELE_USB_COMPOSITE_H
+
+#include "common.h"
+#include "endpoint.h"
+#include "endpoints_manager.h"
+
+#include "../template_utils/type_list.h"
+
+#include <array>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace Zhele::Usb
+{
+    /**
+     * @brief Endpoint request for composite endpoints plan (endpoint without number).
+     *
+     * @details
+     * Every function of composite device declares its endpoints as requests (distinct types, so derive from this class)
+     * and plan assigns numbers and packet sizes.
+     *
+     * @tparam _Direction Endpoint direction (In or Out)
+     * @tparam _Type Endpoint type (Bulk, BulkDoubleBuffered or Interrupt)
+     * @tparam _MaxPacketSize Max packet size (0 - choose by plan, bulk endpoints only)
+     * @tparam _Interval Polling interval
+     * @tparam _Zlp Send zero length packet after transfer multiple of max packet size (IN endpoints only)
+     */
+    template<EndpointDirection _Direction, EndpointType _Type, uint16_t _MaxPacketSize = 0, uint8_t _Interval = 0, bool _Zlp = true>
+    class EndpointRequest
+    {
+    public:
+        static const EndpointDirection Direction = _Direction;
+        static const EndpointType Type = _Type;
+        static const uint16_t MaxPacketSize = _MaxPacketSize;
+        static const uint8_t Interval = _Interval;
+        static const bool Zlp = _Zlp;
+
+        static_assert(_Direction == EndpointDirection::In || _Direction == EndpointDirection::Out,
+            "Composite plan supports unidirectional endpoints only (control endpoint is Ep0).");
+        static_assert(_Type == EndpointType::Bulk || _Type == EndpointType::BulkDoubleBuffered || _Type == EndpointType::Interrupt,
+            "Composite plan supports bulk and interrupt endpoints only.");
+        static_assert(_MaxPacketSize != 0 || _Type != EndpointType::Interrupt,
+            "Interrupt endpoint max packet size should be specified.");
+        static_assert(_MaxPacketSize <= 64, "Full-speed bulk and interrupt max packet size is 64 bytes or less.");
+    };
+
+    /**
+     * @brief OUT endpoint request.
+     */
+    template<EndpointType _Type, uint16_t _MaxPacketSize = 0, uint8_t _Interval = 0>
+    using OutEndpointRequest = EndpointRequest<EndpointDirection::Out, _Type, _MaxPacketSize, _Interval>;
+
+    /**
+     * @brief IN endpoint request.
+     */
+    template<EndpointType _Type, uint16_t _MaxPacketSize = 0, uint8_t _Interval = 0>
+    using InEndpointRequest = EndpointRequest<EndpointDirection::In, _Type, _MaxPacketSize, _Interval>;
+
+    /**
+     * @brief IN endpoint request (without ZLP).
+     */
+    template<EndpointType _Type, uint16_t _MaxPacketSize = 0, uint8_t _Interval = 0>
+    using InEndpointWithoutZlpRequest = EndpointRequest<EndpointDirection::In, _Type, _MaxPacketSize, _Interval, false>;
+
+    /**
+     * @brief Planned endpoint (plan entry).
+     */
+    struct PlannedEndpoint
+    {
+        EndpointDirection Direction; ///< Endpoint direction
+        EndpointType Type; ///< Endpoint type
+        uint16_t RequestedMaxPacketSize; ///< Requested max packet size (0 - choose by plan)
+        uint8_t Number; ///< Assigned endpoint number
+        uint16_t MaxPacketSize; ///< Chosen max packet size
+    };
+
+    namespace Private
+    {
+        /**
+         * @brief Calculates packet memory of planned endpoint (same as PacketMemorySize).
+         *
+         * @param [in] endpoint Planned endpoint
+         *
+         * @returns Endpoint buffers size (in bytes)
+         */
+        constexpr uint16_t PlannedPacketMemory(const PlannedEndpoint& endpoint)
+        {
+            uint16_t buffer = (endpoint.Direction == EndpointDirection::In || endpoint.MaxPacketSize <= 62)
+                ? (endpoint.MaxPacketSize + 1) & ~1
+                : (endpoint.MaxPacketSize + 31) & ~31;
+            return endpoint.Type == EndpointType::BulkDoubleBuffered ? 2 * buffer : buffer;
+        }
+
+        /**
+         * @brief Returns max endpoint number of plan.
+         *
+         * @param [in] plan Planned endpoints
+         *
+         * @returns Max number (0 if plan is empty)
+         */
+        template<size_t _Count>
+        constexpr uint8_t MaxPlannedNumber(const std::array<PlannedEndpoint, _Count>& plan)
+        {
+            uint8_t maxNumber = 0;
+            for(const auto& endpoint : plan)
+                maxNumber = endpoint.Number > maxNumber ? endpoint.Number : maxNumber;
+            return maxNumber;
+        }
+
+        /**
+         * @brief Calculates packet memory used by plan (BDT and all buffers).
+         *
+         * @param [in] plan Planned endpoints
+         * @param [in] ep0Memory Control endpoint buffers size
+         *
+         * @returns Used packet memory (in bytes)
+         */
+        template<size_t _Count>
+        constexpr unsigned PlannedPacketMemory(const std::array<PlannedEndpoint, _Count>& plan, unsigned ep0Memory)
+        {
+            unsigned memory = ep0Memory;
+            for(const auto& endpoint : plan)
+                memory += PlannedPacketMemory(endpoint);
+            // Endpoints numbers are consecutive, so every number takes one EPnR (and BDT cell)
+            return memory + 8 * (MaxPlannedNumber<_Count>(plan) + 1);
+        }
+
+        /**
+         * @brief Builds composite endpoints plan.
+         *
+         * @details
+         * Single-buffered endpoints get numbers by direction: i-th IN and i-th OUT endpoints share number
+         * (and EPnR register), so interrupt endpoint of one function and bulk endpoint of other function
+         * take one register. Double-buffered endpoints use whole EPnR, so they get own numbers after shared ones.
+         * Then packet sizes of bulk endpoints without specified size are maximized: all starts from 64 bytes
+         * and the biggest one is halved (down to 8 bytes) while buffers do not fit in packet memory.
+         *
+         * @param [in] plan Requests (number and max packet size are ignored)
+         * @param [in] ep0Memory Control endpoint buffers size
+         * @param [in] availableMemory Packet memory size (0 - do not limit)
+         *
+         * @returns Plan
+         */
+        template<size_t _Count>
+        consteval std::array<PlannedEndpoint, _Count> BuildCompositePlan(std::array<PlannedEndpoint, _Count> plan, unsigned ep0Memory, unsigned availableMemory)
+        {
+            uint8_t inNumber = 0;
+            uint8_t outNumber = 0;
+            for(auto& endpoint : plan)
+            {
+                if(endpoint.Type != EndpointType::BulkDoubleBuffered)
+                    endpoint.Number = endpoint.Direction == EndpointDirection::In ? ++inNumber : ++outNumber;
+                endpoint.MaxPacketSize = endpoint.RequestedMaxPacketSize != 0 ? endpoint.RequestedMaxPacketSize : 64;
+            }
+            uint8_t number = inNumber > outNumber ? inNumber : outNumber;
+            for(auto& endpoint : plan)
+            {
+                if(endpoint.Type == EndpointType::BulkDoubleBuffered)
+                    endpoint.Number = ++number;
+            }
+
+            while(availableMemory != 0 && PlannedPacketMemory(plan, ep0Memory) > availableMemory)
+            {
+                PlannedEndpoint* biggest = nullptr;
+                for(auto& endpoint : plan)
+                {
+                    if(endpoint.RequestedMaxPacketSize == 0 && endpoint.MaxPacketSize > 8
+                        && (biggest == nullptr || PlannedPacketMemory(endpoint) >= PlannedPacketMemory(*biggest)))
+                    {
+                        biggest = &endpoint;
+                    }
+                }
+                if(biggest == nullptr)
+                    break;
+                biggest->MaxPacketSize /= 2;
+            }
+            return plan;
+        }
+    } // namespace Private
+
+#if defined (ZHELE_USB_COMPOSITE_PLAN_REPORT)
+    /**
+     * @brief Plan report entry.
+     *
+     * @details
+     * Compiler warns on the use of deprecated member with class template arguments, so
+     * (if ZHELE_USB_COMPOSITE_PLAN_REPORT is defined) build log contains plan: number, direction and max packet size
+     * of every endpoint, used and available packet memory.
+     */
+    template<uint8_t _Number, EndpointDirection _Direction, uint16_t _MaxPacketSize>
+    class CompositePlanEndpointReport
+    {
+    public:
+        [[deprecated("USB composite plan: endpoint (number, direction, max packet size)")]] static constexpr bool Value = true;
+    };
+
+    template<unsigned _Used, unsigned _Available>
+    class CompositePlanMemoryReport
+    {
+    public:
+        [[deprecated("USB composite plan: packet memory (used, available)")]] static constexpr bool Value = true;
+    };
+#endif
+
+    /**
+     * @brief Composite device endpoints plan.
+     *
+     * @details
+     * Assigns endpoint numbers and chooses bulk endpoints packet sizes (to maximize throughput within packet memory)
+     * for endpoint requests of all device functions. Use Endpoint<Request> as endpoint base and
+     * Initializer instead of EndpointsInitializer.
+     *
+     * @code
+     * class CdcCommRequest : public InEndpointRequest<EndpointType::Interrupt, 8, 255> {};
+     * class CdcOutRequest : public OutEndpointRequest<EndpointType::Bulk> {};
+     * ...
+     * using Plan = CompositeEndpointsPlan<DefaultEp0, CdcCommRequest, CdcOutRequest, ...>;
+     * using CdcCommEpBase = Plan::Endpoint<CdcCommRequest>;
+     * using Ep0 = Plan::Initializer::ExtendEndpoint<DefaultEp0>;
+     * using CdcCommEp = Plan::Initializer::ExtendEndpoint<CdcCommEpBase>;
+     * @endcode
+     *
+     * @tparam _Ep0 Control endpoint base
+     * @tparam _Requests Endpoint requests (distinct types)
+     */
+    template<typename _Ep0, typename... _Requests>
+    class CompositeEndpointsPlan
+    {
+        using RequestsList = TypeList<_Requests...>;
+        static const unsigned Count = sizeof...(_Requests);
+
+        static_assert(Length<typename Unique<RequestsList>::type>::value == Count,
+            "Endpoint requests should be distinct types (derive from EndpointRequest).");
+
+#if defined (USB)
+        static const unsigned Ep0PacketMemory = PacketMemorySize<_Ep0>::value;
+        static const unsigned AvailableMemory = PmaSize;
+#else
+        static const unsigned Ep0PacketMemory = 0;
+        static const unsigned AvailableMemory = 0;
+#endif
+
+        template<typename _Request>
+        static const unsigned IndexOf = TypeIndex<_Request, RequestsList>::value;
+
+        template<typename _Request, uint8_t _Number, uint16_t _MaxPacketSize>
+        using PlannedEndpointBase = typename Select<_Request::Type == EndpointType::BulkDoubleBuffered,
+            typename Select<_Request::Direction == EndpointDirection::In && !_Request::Zlp,
+                InBulkDoubleBufferedWithoutZlpEndpointBase<_Number, _MaxPacketSize>,
+                BulkDoubleBufferedEndpointBase<_Number, _Request::Direction, _MaxPacketSize>>::value,
+            typename Select<_Request::Direction == EndpointDirection::Out,
+                OutEndpointBase<_Number, _Request::Type, _MaxPacketSize, _Request::Interval>,
+            typename Select<_Request::Zlp,
+                InEndpointBase<_Number, _Request::Type, _MaxPacketSize, _Request::Interval>,
+                InEndpointWithoutZlpBase<_Number, _Request::Type, _MaxPacketSize, _Request::Interval>>::value>::value>::value;
+    public:
+        /// Plan (requests order)
+        static constexpr std::array<PlannedEndpoint, Count> Plan = Private::BuildCompositePlan<Count>(
+            {PlannedEndpoint{_Requests::Direction, _Requests::Type, _Requests::MaxPacketSize, 0, 0}...}, Ep0PacketMemory, AvailableMemory);
+
+        /// Max assigned endpoint number
+        static const uint8_t MaxNumber = Private::MaxPlannedNumber<Count>(Plan);
+
+#if defined (USB)
+        /// Used packet memory size (BDT and all endpoints buffers, in bytes)
+        static const unsigned UsedPacketMemory = Private::PlannedPacketMemory<Count>(Plan, Ep0PacketMemory);
+
+        /// Available packet memory size (in bytes)
+        static const unsigned AvailablePacketMemory = PmaSize;
+
+        static_assert(MaxNumber < 8, "Too many endpoints: USB peripheral has 8 endpoint registers.");
+        static_assert(UsedPacketMemory <= AvailablePacketMemory,
+            "Endpoints buffers do not fit in USB packet memory even with 8-byte bulk packets (reduce fixed max packet sizes).");
+#endif
+        static_assert(MaxNumber < 16, "Too many endpoints.");
+
+        /**
+         * @brief Planned endpoint base for request
+         *
+         * @tparam _Request Endpoint request
+         */
+        template<typename _Request>
+        using Endpoint = PlannedEndpointBase<_Request, Plan[IndexOf<_Request>].Number, Plan[IndexOf<_Request>].MaxPacketSize>;
+
+        /// Endpoints initializer for control endpoint and all planned endpoints
+        using Initializer = EndpointsInitializer<_Ep0, Endpoint<_Requests>...>;
+
+#if defined (ZHELE_USB_COMPOSITE_PLAN_REPORT)
+    private:
+        static consteval bool Report()
+        {
+            return (true && ... && CompositePlanEndpointReport<Plan[IndexOf<_Requests>].Number, _Requests::Direction, Plan[IndexOf<_Requests>].MaxPacketSize>::Value)
+#if defined (USB)
+                && CompositePlanMemoryReport<UsedPacketMemory, AvailablePacketMemory>::Value
+#endif
+                ;
+        }
+        static_assert(Report());
+#endif
+    };
+}
+
+#endif //! ZHELE_USB_COMPOSITE_H
@@ -14,17 +14,6 @@
 
 namespace Zhele::Usb
 {
-    /**
-     * @brief Configuration attributes
-     */
-    struct ConfigurationAttributes
-    {
-        uint8_t Reserved : 5; ///< Reserved
-        bool RemoteWakeup : 1 = false; ///< Remote wakeup support
-        bool SelfPowered : 1 = false; ///< Self-powered
-        uint8_t Reserved2 : 1; ///< Reserved
-    };
-
 #pragma pack(push, 1)
     /**
      * @brief Configuration descriptor
@@ -37,7 +26,7 @@ namespace Zhele::Usb
         uint8_t InterfacesCount; ///< Interfaces count
         uint8_t Number; ///< Configuration number
         uint8_t StringIndex = 0; ///< Configuration string index
-        ConfigurationAttributes Attributes; ///< Configuration attributes
+        uint8_t Attributes; ///< Configuration attributes (D7 - reserved (set to one), D6 - self-powered, D5 - remote wakeup)
         uint8_t MaxPower; ///< Max power (in 2mA units)
     };
 #pragma pack(pop)
@@ -55,6 +44,8 @@ namespace Zhele::Usb
     class Configuration
     {
     public:
+        static const uint8_t Number = _Number;
+
         using Interfaces = Zhele::TemplateUtils::TypeList<_Interfaces...>;
         using Endpoints = Zhele::TemplateUtils::Append_t<typename _Interfaces::Endpoints...>;
 
@@ -70,29 +61,32 @@ namespace Zhele::Usb
         }
 
         /**
-         * @brief Fills descriptor
+         * @brief Deactivates configuration (disables all interfaces endpoints)
          * 
-         * @param [out] descriptor Destination memory
-         *
-         * @returns Total bytes written
+         * @par Returns
+         *  Nothing
          */
-        static uint16_t FillDescriptor(ConfigurationDescriptor* descriptor)
+        static void Deactivate()
         {
-            uint16_t totalLength = sizeof(ConfigurationDescriptor);
+            (_Interfaces::Deactivate(), ...);
+        }
 
-            *descriptor = ConfigurationDescriptor {
+        /**
+         * @brief Returns descriptor
+         * 
+         * @returns Descriptor bytes (configuration descriptor with all interfaces descriptors)
+         */
+        static constexpr auto Descriptor()
+        {
+            constexpr auto interfaces = ConcatDescriptors(_Interfaces::Descriptor()...);
+
+            return ConcatDescriptors(DescriptorBytes(ConfigurationDescriptor {
+                .TotalLength = sizeof(ConfigurationDescriptor) + interfaces.size(),
                 .InterfacesCount = sizeof...(_Interfaces),
                 .Number = _Number,
-                .Attributes = {.RemoteWakeup = _RemoteWakeup, .SelfPowered = _SelfPowered},
+                .Attributes = 0x80 | (_SelfPowered ? 0x40 : 0) | (_RemoteWakeup ? 0x20 : 0),
                 .MaxPower = _MaxPower
-            };
-
-            uint8_t* interfacesDescriptors = reinterpret_cast<uint8_t*>(descriptor);
-            ((totalLength += _Interfaces::FillDescriptor(reinterpret_cast<InterfaceDescriptor*>(&interfacesDescriptors[totalLength]))), ...);
-
-            descriptor->TotalLength = totalLength;
-
-            return totalLength;
+            }), interfaces);
         }
     };
 }
@@ -10,13 +10,23 @@
 #ifndef ZHELE_USB_DEVICE_H
 #define ZHELE_USB_DEVICE_H
 
+#include "composite.h"
 #include "configuration.h"
 #include "endpoints_manager.h"
 #include "hid.h"
 #include "cdc.h"
+#include "ncm.h"
 #include "msc.h"
+#include "audio.h"
+#include "vendor.h"
+#include "dfu.h"
 
+#include "../delay.h"
 #include "../ioreg.h"
+#include "../nvic.h"
+#include "../power.h"
+#include "../statistics.h"
+#include "../macro_utils/declarations.h"
 #include "../../common/template_utils/fixed_string.h"
 
 #include <type_traits>
@@ -45,6 +55,27 @@ namespace Zhele::Usb
         uint8_t ConfigurationsCount; ///< Configurations count
     };
 #pragma pack(pop)
+
+    /**
+     * @brief Device qualifier descriptor (for high-speed capable devices).
+     * 
+     * @details
+     * Describes device in other speed (full speed for high-speed device).
+     */
+#pragma pack(push, 1)
+    struct DeviceQualifierDescriptor
+    {
+        uint8_t Length = 10; ///< Length (always 10)
+        DescriptorType Type = DescriptorType::DeviceQualifier; ///< Desciptor type (always 0x06)
+        uint16_t UsbVersion; ///< Usb version (at least 0x0200)
+        DeviceAndInterfaceClass Class; ///< Device class
+        uint8_t SubClass; ///< Device subclass
+        uint8_t Protocol; ///< Device protocol
+        uint8_t MaxPacketSize; ///< Ep0 maximum packet size for other speed
+        uint8_t ConfigurationsCount; ///< Other speed configurations count
+        uint8_t Reserved = 0; ///< Reserved
+    };
+#pragma pack(pop)
     
         /**
      * @brief String descriptor
@@ -58,6 +89,30 @@ namespace Zhele::Usb
     };
 #pragma pack(pop)
 
+    /**
+     * @brief Suspend/resume callback
+     */
+    using PowerStateCallback = std::add_pointer_t<void()>;
+
+    /**
+     * @brief Builds string descriptor at compile time
+     * 
+     * @param [in] string String (UTF-16)
+     * 
+     * @returns Descriptor bytes
+     */
+    template<unsigned _Length>
+    constexpr std::array<uint8_t, 2 + 2 * _Length> StringDescriptorBytes(const Zhele::TemplateUtils::fixed_string_16<_Length>& string)
+    {
+        std::array<uint8_t, 2 + 2 * _Length> bytes {2 + 2 * _Length, static_cast<uint8_t>(DescriptorType::String)};
+        for(unsigned i = 0; i < _Length; ++i)
+        {
+            bytes[2 + 2 * i] = static_cast<uint8_t>(string.Text[i] & 0xff);
+            bytes[3 + 2 * i] = static_cast<uint8_t>(string.Text[i] >> 8);
+        }
+        return bytes;
+    }
+
     /**
      * @brief Implements USB device.
      * 
@@ -73,6 +128,17 @@ namespace Zhele::Usb
      * @tparam _DeviceReleaseNumber Device release number
      * @tparam _Ep0 Endpoint 0 base
      * @tparam _Configurations Device`s configurations
+     * 
+     * @details
+     * Device may have several configurations (numbered from 1), host selects one of them
+     * by SET_CONFIGURATION without re-enumeration. Endpoints of all configurations should be
+     * extended by one EndpointsInitializer: buffers of all endpoints do not overlap in packet memory.
+     * Endpoints of different configurations may have same number (if direction and type are same).
+     * 
+     * While bus is suspended, USB core is in low-power mode (F0/F1/L4: FSUSP + LP_MODE,
+     * OTG: PHY clock is stopped) and Stop mode is not blocked by device (see Power::LowPower).
+     * Suspend callback may gate application clocks, resume callback restores them
+     * (it is called from USB interrupt after wake up).
      */
     template<
         typename _Regs,
@@ -104,18 +170,38 @@ namespace Zhele::Usb
         using Configurations = TypeList<_Configurations...>;
         using Interfaces = Append_t<typename _Configurations::Interfaces...>; 
         using Endpoints = Append_t<typename _Configurations::Endpoints...>;
+        /// Configuration that is active after reset (until host selects configuration)
+        using DefaultConfiguration = typename GetType<0, Configurations>::type;
 
+        // Buffers of all configurations endpoints do not overlap, so configuration switch does not move buffers.
         using EpBufferManager = EndpointsManager<Append_t<_Ep0, Endpoints>>;
+        /// Buffers (FIFO) manager for configuration endpoints
+        template<typename _Configuration>
+        using ConfigurationEpBufferManager = EndpointsManager<Append_t<_Ep0, typename _Configuration::Endpoints>>;
         // Replace Ep0 with this for correct handler register.
-        using EpHandlers = EndpointHandlers<Append_t<This, Endpoints>>;
+        template<typename _Configuration>
+        using ConfigurationEpHandlers = EndpointHandlers<Append_t<This, typename _Configuration::Endpoints>>;
 #if defined (USB_OTG_FS)
-        using EpFifoNotEmptyHandlers = EndpointFifoNotEmptyHandlers<Append_t<This, Endpoints>>;
+        template<typename _Configuration>
+        using ConfigurationEpFifoNotEmptyHandlers = EndpointFifoNotEmptyHandlers<Append_t<This, typename _Configuration::Endpoints>>;
 #endif
-        using IfHandlers = InterfaceHandlers<Interfaces>;
+        template<typename _Configuration>
+        using ConfigurationIfHandlers = InterfaceHandlers<typename _Configuration::Interfaces>;
 
         static uint8_t _tempAddressStorage;
         static volatile bool _isDeviceConfigured;
+        static uint8_t _configurationIndex; ///< Active configuration index
+        static uint8_t _configurationValue; ///< Configuration value selected by host
+        static volatile bool _isSuspended; ///< Bus is suspended
+        static volatile bool _remoteWakeupEnabled; ///< Remote wakeup is enabled by host
+        static PowerStateCallback _suspendCallback; ///< Suspend callback
+        static PowerStateCallback _resumeCallback; ///< Resume callback
     public:
+    #if defined (ZHELE_STATISTICS)
+        /// Runtime statistics (resets, packets and errors counters)
+        static UsbStatistics Statistics;
+    #endif
+
         /**
          * @brief Select clock source
          * 
@@ -154,14 +240,54 @@ namespace Zhele::Usb
         static bool IsDeviceConfigured();
 
         /**
-         * @brief Fills descriptor
+         * @brief Returns bus suspend state
+         * 
+         * @retval true Bus is suspended
+         * @retval false Bus is active
+         */
+        static bool IsSuspended();
+
+        /**
+         * @brief Set suspend callback
          * 
-         * @param [out] descriptor Destination memory
+         * @details
+         * Callback is called from USB interrupt after USB core has entered low-power mode.
+         * Device (bus-powered) should reduce current consumption to suspend budget (2.5 mA).
+         * 
+         * @param [in] callback Callback
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void SetSuspendCallback(PowerStateCallback callback);
+
+        /**
+         * @brief Set resume callback
+         * 
+         * @details
+         * Callback is called from USB interrupt after USB core has left low-power mode
+         * (host resume, reset or remote wakeup).
+         * 
+         * @param [in] callback Callback
          * 
          * @par Returns
          *  Nothing
          */
-        static void FillDescriptor(DeviceDescriptor* descriptor);
+        static void SetResumeCallback(PowerStateCallback callback);
+
+        /**
+         * @brief Send remote wakeup signaling
+         * 
+         * @details
+         * Method drives resume signaling for 5 ms (blocking), so it should not be called
+         * from interrupt handler with higher priority than USB interrupt.
+         * Signaling is sent only if bus is suspended and host enabled remote wakeup feature
+         * (configuration should declare remote wakeup support).
+         * 
+         * @retval true Resume signaling is sent
+         * @retval false Bus is not suspended or remote wakeup is not enabled
+         */
+        static bool RemoteWakeup();
 
         /**
          * @brief Common USB handler
@@ -169,7 +295,7 @@ namespace Zhele::Usb
          * @par Returns
          *  Nothing
          */
-        static void CommonHandler();
+        ZHELE_HANDLER static void CommonHandler();
 
         /**
          * @brief Ep0 (device) CTR handler
@@ -180,6 +306,48 @@ namespace Zhele::Usb
         static void Handler();
 
     private:
+        /// Device descriptor
+        static constexpr auto DeviceDescriptorData = DescriptorBytes(DeviceDescriptor {
+            .UsbVersion = _UsbVersion,
+            .Class = _Class,
+            .SubClass = _SubClass,
+            .Protocol = _Protocol,
+            .MaxPacketSize = _Ep0::MaxPacketSize,
+            .VendorId = _VendorId,
+            .ProductId = _ProductId,
+            .DeviceReleaseNumber = _DeviceReleaseNumber,
+            .ManufacturerStringIndex = (std::is_same_v<decltype(_Manufacturer), decltype(EmptyFixedString16)>) ? 0 : 1,
+            .ProductStringIndex = (std::is_same_v<decltype(_Product), decltype(EmptyFixedString16)>) ? 0 : 2,
+            .SerialNumberStringIndex = (std::is_same_v<decltype(_Serial), decltype(EmptyFixedString16)>) ? 0 : 3,
+            .ConfigurationsCount = sizeof...(_Configurations)
+        });
+        /// Device qualifier descriptor
+        static constexpr auto QualifierDescriptorData = DescriptorBytes(DeviceQualifierDescriptor {
+            .UsbVersion = _UsbVersion,
+            .Class = _Class,
+            .SubClass = _SubClass,
+            .Protocol = _Protocol,
+            .MaxPacketSize = _Ep0::MaxPacketSize,
+            .ConfigurationsCount = sizeof...(_Configurations)
+        });
+        /// Configuration descriptor (with all interfaces and endpoints descriptors)
+        template<typename _Configuration>
+        static constexpr auto ConfigurationDescriptorData = _Configuration::Descriptor();
+        /// MS OS 2.0 descriptors (if any interface provides them)
+        using MsOsDescriptors = MsOs20Descriptors<_Configurations...>;
+        /// MS OS 2.0 descriptor set
+        static constexpr auto MsOs20DescriptorSetData = MsOsDescriptors::DescriptorSet();
+        /// BOS descriptor
+        static constexpr auto BosDescriptorData = MsOsDescriptors::Bos();
+        /// Language ID string descriptor
+        static constexpr auto LangIdDescriptorData = DescriptorBytes(LangIdDescriptor {});
+        /// Manufacturer string descriptor
+        static constexpr auto ManufacturerDescriptorData = StringDescriptorBytes(_Manufacturer);
+        /// Product string descriptor
+        static constexpr auto ProductDescriptorData = StringDescriptorBytes(_Product);
+        /// Serial number string descriptor
+        static constexpr auto SerialDescriptorData = StringDescriptorBytes(_Serial);
+
         /**
          * @brief Handle SETUP request
          * 
@@ -200,6 +368,119 @@ namespace Zhele::Usb
          */
         static void SetAddress(uint16_t address);
 
+        /**
+         * @brief Put USB core in low-power mode (bus suspend)
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Suspend();
+
+        /**
+         * @brief Leave low-power mode (bus resume)
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Resume();
+
+        /**
+         * @brief Send descriptor (not more than requested length)
+         * 
+         * @param [in] descriptor Descriptor bytes
+         * @param [in] length Requested length
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        template<size_t _Size>
+        static void SendDescriptor(const std::array<uint8_t, _Size>& descriptor, uint16_t length)
+        {
+            _Ep0::SendData(descriptor.data(), length < _Size ? length : _Size);
+        }
+
+        /**
+         * @brief Send configuration descriptor by index
+         * 
+         * @param [in] index Configuration index
+         * @param [in] length Requested length
+         * 
+         * @retval true Descriptor is sent
+         * @retval false There is no configuration with given index
+         */
+        static bool SendConfigurationDescriptor(uint8_t index, uint16_t length);
+
+        /**
+         * @brief Select configuration (SET_CONFIGURATION request)
+         * 
+         * @details
+         * Endpoints of previous configuration are disabled, endpoints buffers (BDT cells or FIFO)
+         * are initialized for new configuration, then configuration is reset.
+         * Value 0 returns device to address state (if there is no configuration with number 0).
+         * 
+         * @param [in] value Configuration value (number)
+         * 
+         * @retval true Configuration is selected
+         * @retval false There is no configuration with given value
+         */
+        static bool SetConfiguration(uint8_t value);
+
+        /**
+         * @brief Activate configuration
+         * 
+         * @tparam _Configuration Configuration
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        template<typename _Configuration>
+        static void ActivateConfiguration();
+
+        /**
+         * @brief Deactivate current configuration
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void DeactivateConfiguration();
+
+        /**
+         * @brief Call endpoint handler of active configuration
+         * 
+         * @param [in] number Endpoint number
+         * @param [in] direction Endpoint direction
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void HandleEndpoint(uint8_t number, EndpointDirection direction);
+
+#if defined (USB_OTG_FS)
+        /**
+         * @brief Call RX FIFO not empty handler of active configuration
+         * 
+         * @param [in] number Endpoint number
+         * @param [in] size Received data size
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void HandleRxFifoNotEmpty(uint8_t number, uint16_t size);
+#endif
+
+        /**
+         * @brief Call interface setup handler of active configuration
+         * 
+         * @details
+         * Request to interface that does not exist in active configuration is stalled.
+         * 
+         * @param [in] number Interface number
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void HandleInterfaceSetupRequest(uint8_t number);
+
         /**
          * @brief Calculate DAINTMSK value for OTG
          * 
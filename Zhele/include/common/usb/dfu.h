@@ -0,0 +1,630 @@
+/**
+ * @file
+ * Implement USB DFU (device firmware upgrade) class
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2023
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_USB_DFU_H
+#define ZHELE_USB_DFU_H
+
+#include "interface.h"
+
+#include "../flash.h"
+
+#include <string.h>
+
+namespace Zhele::Usb
+{
+    /// DFU interface subclass
+    static const uint8_t DfuSubClass = 0x01;
+
+    /**
+     * @brief DFU interface protocol
+     */
+    enum class DfuProtocol : uint8_t
+    {
+        Runtime = 0x01, ///< Runtime (application) mode
+        Dfu = 0x02, ///< DFU mode
+    };
+
+    /**
+     * @brief DFU class-specific requests
+     */
+    enum class DfuRequest : uint8_t
+    {
+        Detach = 0x00, ///< Detach (request to switch to DFU mode)
+        Download = 0x01, ///< Download block
+        Upload = 0x02, ///< Upload block
+        GetStatus = 0x03, ///< Get status
+        ClearStatus = 0x04, ///< Clear error status
+        GetState = 0x05, ///< Get state
+        Abort = 0x06, ///< Abort operation
+    };
+
+    /**
+     * @brief DFU states
+     */
+    enum class DfuState : uint8_t
+    {
+        AppIdle = 0, ///< Application mode, idle
+        AppDetach = 1, ///< Application mode, detach request received
+        Idle = 2, ///< DFU mode, idle
+        DownloadSync = 3, ///< Block received, waiting GETSTATUS
+        DownloadBusy = 4, ///< Block programming
+        DownloadIdle = 5, ///< Waiting next block
+        ManifestSync = 6, ///< Download complete, waiting GETSTATUS
+        Manifest = 7, ///< Manifestation
+        ManifestWaitReset = 8, ///< Manifestation complete, waiting reset
+        UploadIdle = 9, ///< Upload in progress
+        Error = 10, ///< Error
+    };
+
+    /**
+     * @brief DFU status codes
+     */
+    enum class DfuStatus : uint8_t
+    {
+        Ok = 0x00, ///< No error
+        ErrorTarget = 0x01, ///< File is not targeted for this device
+        ErrorFile = 0x02, ///< File fails verification
+        ErrorWrite = 0x03, ///< Device is unable to write memory
+        ErrorErase = 0x04, ///< Memory erase failed
+        ErrorCheckErased = 0x05, ///< Memory erase check failed
+        ErrorProgram = 0x06, ///< Program memory function failed
+        ErrorVerify = 0x07, ///< Programmed memory failed verification
+        ErrorAddress = 0x08, ///< Address is out of range
+        ErrorNotDone = 0x09, ///< Download is finished, but device does not think so
+        ErrorFirmware = 0x0a, ///< Firmware is corrupt
+        ErrorVendor = 0x0b, ///< Vendor-specific error
+        ErrorUsbReset = 0x0c, ///< Unexpected USB reset
+        ErrorPowerOnReset = 0x0d, ///< Unexpected power on reset
+        ErrorUnknown = 0x0e, ///< Unknown error
+        ErrorStalledPacket = 0x0f, ///< Unexpected request
+    };
+
+#pragma pack(push, 1)
+    /**
+     * @brief DFU functional descriptor
+     */
+    struct DfuFunctionalDescriptor
+    {
+        uint8_t Length = 9; ///< Length (always 9)
+        uint8_t Type = 0x21; ///< Descriptor type (DFU functional)
+        uint8_t Attributes; ///< Attributes (D0 - can download, D1 - can upload, D2 - manifestation tolerant, D3 - will detach)
+        uint16_t DetachTimeout; ///< Detach timeout (ms)
+        uint16_t TransferSize; ///< Max block size
+        uint16_t DfuVersion = 0x0110; ///< DFU version (1.1)
+    };
+
+    /**
+     * @brief GETSTATUS response
+     */
+    struct DfuStatusResponse
+    {
+        DfuStatus Status; ///< Status
+        uint8_t PollTimeout[3]; ///< Min time (ms) before next GETSTATUS request
+        DfuState State; ///< State
+        uint8_t StringIndex = 0; ///< Status description string index
+    };
+#pragma pack(pop)
+
+    /// DFU callback (detach or manifestation)
+    using DfuCallback = std::add_pointer_t<void()>;
+
+    /**
+     * @brief DFU runtime interface (application mode)
+     *
+     * @details
+     * Host sends DETACH request to switch device to DFU mode. Callback is called after
+     * request status stage, it should reset device to DFU bootloader (device detaches itself).
+     *
+     * @tparam _Number Interface number
+     * @tparam _Ep0 Zero endpoint
+     * @tparam _TransferSize Block size of DFU mode interface
+     * @tparam _DetachTimeout Detach timeout (ms)
+     */
+    template<uint8_t _Number, typename _Ep0, uint16_t _TransferSize = 1024, uint16_t _DetachTimeout = 1000>
+    class DfuRuntimeInterface : public Interface<_Number, 0, DeviceAndInterfaceClass::ApplicationSpecific, DfuSubClass, static_cast<uint8_t>(DfuProtocol::Runtime), _Ep0>
+    {
+        using Base = Interface<_Number, 0, DeviceAndInterfaceClass::ApplicationSpecific, DfuSubClass, static_cast<uint8_t>(DfuProtocol::Runtime), _Ep0>;
+    public:
+        /**
+         * @brief Set detach callback
+         *
+         * @param [in] callback Callback (called from USB interrupt)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void SetDetachCallback(DfuCallback callback)
+        {
+            _detachCallback = callback;
+        }
+
+        /**
+         * @brief Interface setup request handler
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void SetupHandler()
+        {
+            SetupPacket* setup = reinterpret_cast<SetupPacket*>(_Ep0::RxBuffer);
+
+            if(setup->RequestType.Type == 0)
+            {
+                if(setup->Request == StandartRequestCode::SetInterface && setup->Value == 0)
+                    _Ep0::SendZLP();
+                else
+                    _Ep0::SetTxStatus(EndpointStatus::Stall);
+                return;
+            }
+
+            switch (static_cast<DfuRequest>(setup->Request))
+            {
+            case DfuRequest::Detach:
+                _state = DfuState::AppDetach;
+                _Ep0::SendZLP([]{
+                    _Ep0::SetRxStatus(EndpointStatus::Valid);
+                    if(_detachCallback != nullptr)
+                        _detachCallback();
+                });
+                break;
+            case DfuRequest::GetStatus: {
+                static DfuStatusResponse response;
+                response = {.Status = DfuStatus::Ok, .PollTimeout = {}, .State = _state};
+                _Ep0::SendData(&response, sizeof(response));
+                break;
+            }
+            case DfuRequest::GetState:
+                _Ep0::SendData(&_state, sizeof(_state));
+                break;
+            default:
+                _Ep0::SetTxStatus(EndpointStatus::Stall);
+                break;
+            }
+        }
+
+        /**
+         * @brief Returns descriptor
+         *
+         * @returns Descriptor bytes (interface and DFU functional descriptors)
+         */
+        static constexpr auto Descriptor()
+        {
+            return ConcatDescriptors(Base::Descriptor(), DescriptorBytes(DfuFunctionalDescriptor {
+                .Attributes = 0x01 | 0x02 | 0x04 | 0x08,
+                .DetachTimeout = _DetachTimeout,
+                .TransferSize = _TransferSize
+            }));
+        }
+
+    private:
+        static DfuState _state;
+        static DfuCallback _detachCallback;
+    };
+
+    template<uint8_t _Number, typename _Ep0, uint16_t _TransferSize, uint16_t _DetachTimeout>
+    DfuState DfuRuntimeInterface<_Number, _Ep0, _TransferSize, _DetachTimeout>::_state = DfuState::AppIdle;
+    template<uint8_t _Number, typename _Ep0, uint16_t _TransferSize, uint16_t _DetachTimeout>
+    DfuCallback DfuRuntimeInterface<_Number, _Ep0, _TransferSize, _DetachTimeout>::_detachCallback = nullptr;
+
+    /**
+     * @brief DFU mode interface (firmware download to internal flash)
+     *
+     * @details
+     * Block N is written to _FlashAddress + N * _TransferSize. Pages are erased just before
+     * they are programmed (only pages that are written in this download). There are two
+     * block buffers: received block is programmed (by flash interrupt, so Zhele::Flash::IrqHandler
+     * should be called in FLASH_IRQHandler) while host sends next block, host waits
+     * (dfuDNBUSY state) only if both buffers are busy. Upload reads flash region directly.
+     * Interface is manifestation tolerant: after download end flash is locked, manifestation
+     * callback is called (it can set flag to start new firmware) and interface returns to dfuIDLE.
+     *
+     * @tparam _Number Interface number
+     * @tparam _Ep0 Zero endpoint
+     * @tparam _FlashAddress Firmware region start address (page aligned)
+     * @tparam _FlashSize Firmware region size
+     * @tparam _PageSize Flash page (sector) size in firmware region
+     * @tparam _TransferSize Max block size (multiple of 8 and Ep0 max packet size)
+     * @tparam _PollTimeout Poll timeout (ms) if both buffers are busy (about page erase time)
+     */
+    template<uint8_t _Number, typename _Ep0, uint32_t _FlashAddress, uint32_t _FlashSize, uint32_t _PageSize, uint16_t _TransferSize = 1024, uint32_t _PollTimeout = 50>
+    class DfuInterface : public Interface<_Number, 0, DeviceAndInterfaceClass::ApplicationSpecific, DfuSubClass, static_cast<uint8_t>(DfuProtocol::Dfu), _Ep0>
+    {
+        using Base = Interface<_Number, 0, DeviceAndInterfaceClass::ApplicationSpecific, DfuSubClass, static_cast<uint8_t>(DfuProtocol::Dfu), _Ep0>;
+
+        static_assert(_FlashAddress % _PageSize == 0, "Firmware region should be page aligned.");
+        static_assert(_TransferSize % 8 == 0 && _TransferSize % _Ep0::MaxPacketSize == 0, "Transfer size should be multiple of 8 and Ep0 max packet size.");
+    public:
+        /**
+         * @brief Set manifestation callback
+         *
+         * @param [in] callback Callback (called from USB interrupt after download completion)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void SetManifestationCallback(DfuCallback callback)
+        {
+            _manifestationCallback = callback;
+        }
+
+        /**
+         * @brief Returns DFU state
+         *
+         * @returns State
+         */
+        static DfuState State()
+        {
+            return _state;
+        }
+
+        /**
+         * @brief Reset interface
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Reset()
+        {
+            Base::Reset();
+            _Ep0::ResetOutDataTransferCallback();
+            _state = DfuState::Idle;
+            _status = DfuStatus::Ok;
+        }
+
+        /**
+         * @brief Interface setup request handler
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void SetupHandler()
+        {
+            SetupPacket* setup = reinterpret_cast<SetupPacket*>(_Ep0::RxBuffer);
+
+            if(setup->RequestType.Type == 0)
+            {
+                if(setup->Request == StandartRequestCode::SetInterface && setup->Value == 0)
+                    _Ep0::SendZLP();
+                else
+                    _Ep0::SetTxStatus(EndpointStatus::Stall);
+                return;
+            }
+
+            switch (static_cast<DfuRequest>(setup->Request))
+            {
+            case DfuRequest::Download:
+                StartDownload(setup->Value, setup->Length);
+                break;
+            case DfuRequest::Upload:
+                Upload(setup->Value, setup->Length);
+                break;
+            case DfuRequest::GetStatus:
+                SendStatus();
+                break;
+            case DfuRequest::ClearStatus:
+                if(_state == DfuState::Error)
+                {
+                    AbortDownload();
+                    _status = DfuStatus::Ok;
+                    _state = DfuState::Idle;
+                    _Ep0::SendZLP();
+                }
+                else
+                {
+                    Fail(DfuStatus::ErrorStalledPacket);
+                }
+                break;
+            case DfuRequest::GetState:
+                _Ep0::SendData(&_state, sizeof(_state));
+                break;
+            case DfuRequest::Abort:
+                if(_state == DfuState::Idle || _state == DfuState::DownloadIdle || _state == DfuState::UploadIdle)
+                {
+                    AbortDownload();
+                    _state = DfuState::Idle;
+                    _Ep0::SendZLP();
+                }
+                else
+                {
+                    Fail(DfuStatus::ErrorStalledPacket);
+                }
+                break;
+            default:
+                Fail(DfuStatus::ErrorStalledPacket);
+                break;
+            }
+        }
+
+        /**
+         * @brief Returns descriptor
+         *
+         * @returns Descriptor bytes (interface and DFU functional descriptors)
+         */
+        static constexpr auto Descriptor()
+        {
+            return ConcatDescriptors(Base::Descriptor(), DescriptorBytes(DfuFunctionalDescriptor {
+                .Attributes = 0x01 | 0x02 | 0x04,
+                .DetachTimeout = 0,
+                .TransferSize = _TransferSize
+            }));
+        }
+
+    private:
+        static void StartDownload(uint16_t block, uint16_t length)
+        {
+            if(_state != DfuState::Idle && _state != DfuState::DownloadIdle)
+            {
+                Fail(DfuStatus::ErrorStalledPacket);
+                return;
+            }
+
+            // Zero length block is download end
+            if(length == 0)
+            {
+                if(_state == DfuState::Idle)
+                {
+                    Fail(DfuStatus::ErrorStalledPacket);
+                    return;
+                }
+                _state = DfuState::ManifestSync;
+                _Ep0::SendZLP();
+                return;
+            }
+
+            uint32_t offset = static_cast<uint32_t>(block) * _TransferSize;
+            if(length > _TransferSize || offset + length > _FlashSize)
+            {
+                Fail(DfuStatus::ErrorAddress);
+                return;
+            }
+
+            if(_state == DfuState::Idle)
+            {
+                Zhele::Flash::Unlock();
+                _erasedUntil = _FlashAddress;
+            }
+
+            _blockAddress[_receiveIndex] = _FlashAddress + offset;
+            _Ep0::ReceiveControlData(_blocks[_receiveIndex], length, DownloadComplete);
+        }
+
+        static bool DownloadComplete(uint16_t size)
+        {
+            // Pad block to program unit with erased value
+            uint16_t padded = (size + 7) & ~7u;
+            memset(&_blocks[_receiveIndex][size], 0xff, padded - size);
+            _blockLength[_receiveIndex] = padded;
+
+            uint32_t primask = __get_PRIMASK();
+            __disable_irq();
+            _receiveIndex ^= 1;
+            ++_pendingBlocks;
+            __set_PRIMASK(primask);
+
+            _state = DfuState::DownloadSync;
+            StartProgramming();
+            return true;
+        }
+
+        static void Upload(uint16_t block, uint16_t length)
+        {
+            if(_state != DfuState::Idle && _state != DfuState::UploadIdle)
+            {
+                Fail(DfuStatus::ErrorStalledPacket);
+                return;
+            }
+
+            uint32_t offset = static_cast<uint32_t>(block) * _TransferSize;
+            uint32_t size = length < _TransferSize ? length : _TransferSize;
+            if(offset >= _FlashSize)
+                size = 0;
+            else if(offset + size > _FlashSize)
+                size = _FlashSize - offset;
+
+            // Short block is upload end
+            _state = size < length ? DfuState::Idle : DfuState::UploadIdle;
+            _Ep0::SendData(reinterpret_cast<const void*>(_FlashAddress + offset), size);
+        }
+
+        static void SendStatus()
+        {
+            uint32_t pollTimeout = 0;
+            switch (_state)
+            {
+            case DfuState::DownloadSync:
+            case DfuState::DownloadBusy:
+                // Next block can be received while previous one is programmed
+                if(_status != DfuStatus::Ok)
+                {
+                    _state = DfuState::Error;
+                }
+                else if(_pendingBlocks < 2)
+                {
+                    _state = DfuState::DownloadIdle;
+                }
+                else
+                {
+                    _state = DfuState::DownloadBusy;
+                    pollTimeout = _PollTimeout;
+                }
+                break;
+            case DfuState::ManifestSync:
+            case DfuState::Manifest:
+                if(_status != DfuStatus::Ok)
+                {
+                    _state = DfuState::Error;
+                }
+                else if(_pendingBlocks > 0)
+                {
+                    _state = DfuState::Manifest;
+                    pollTimeout = _PollTimeout;
+                }
+                else
+                {
+                    Zhele::Flash::Lock();
+                    _state = DfuState::Idle;
+                    if(_manifestationCallback != nullptr)
+                        _manifestationCallback();
+                }
+                break;
+            default:
+                break;
+            }
+
+            _statusResponse = {
+                .Status = _status,
+                .PollTimeout = {static_cast<uint8_t>(pollTimeout), static_cast<uint8_t>(pollTimeout >> 8), static_cast<uint8_t>(pollTimeout >> 16)},
+                .State = _state
+            };
+            _Ep0::SendData(&_statusResponse, sizeof(_statusResponse));
+        }
+
+        static void Fail(DfuStatus status)
+        {
+            _status = status;
+            _state = DfuState::Error;
+            _Ep0::SetTxStatus(EndpointStatus::Stall);
+        }
+
+        static void AbortDownload()
+        {
+            _Ep0::ResetOutDataTransferCallback();
+            // Block that is programmed now is completed, queued block is dropped
+            uint32_t primask = __get_PRIMASK();
+            __disable_irq();
+            if(_pendingBlocks > 1)
+            {
+                _pendingBlocks = 1;
+                _receiveIndex = _programIndex ^ 1;
+            }
+            if(!_programming)
+                _pendingBlocks = 0;
+            __set_PRIMASK(primask);
+
+            if(!_programming)
+                Zhele::Flash::Lock();
+        }
+
+        static void StartProgramming()
+        {
+            uint32_t primask = __get_PRIMASK();
+            __disable_irq();
+            bool start = !_programming && _pendingBlocks > 0;
+            _programming = start;
+            __set_PRIMASK(primask);
+
+            if(start)
+                ProgramBlock();
+        }
+
+        static void ProgramBlock()
+        {
+            uint32_t end = _blockAddress[_programIndex] + _blockLength[_programIndex];
+            if(_erasedUntil < end)
+            {
+                if(_erasedUntil < _blockAddress[_programIndex])
+                    _erasedUntil = _blockAddress[_programIndex] - (_blockAddress[_programIndex] - _FlashAddress) % _PageSize;
+                if(!Zhele::Flash::ErasePageAsync(_erasedUntil, EraseComplete))
+                    CompleteBlock(DfuStatus::ErrorWrite);
+                return;
+            }
+            if(!Zhele::Flash::ProgramAsync(_blockAddress[_programIndex], _blocks[_programIndex], _blockLength[_programIndex], ProgramComplete))
+                CompleteBlock(DfuStatus::ErrorWrite);
+        }
+
+        static void EraseComplete(bool success)
+        {
+            if(!success)
+            {
+                CompleteBlock(DfuStatus::ErrorErase);
+                return;
+            }
+            _erasedUntil += _PageSize;
+            ProgramBlock();
+        }
+
+        static void ProgramComplete(bool success)
+        {
+            if(!success)
+                CompleteBlock(DfuStatus::ErrorProgram);
+            else if(memcmp(reinterpret_cast<const void*>(_blockAddress[_programIndex]), _blocks[_programIndex], _blockLength[_programIndex]) != 0)
+                CompleteBlock(DfuStatus::ErrorVerify);
+            else
+                CompleteBlock(DfuStatus::Ok);
+        }
+
+        static void CompleteBlock(DfuStatus status)
+        {
+            uint32_t primask = __get_PRIMASK();
+            __disable_irq();
+            if(status != DfuStatus::Ok)
+            {
+                // Error is reported on next GETSTATUS, queued block is dropped
+                _status = status;
+                _pendingBlocks = 0;
+                _receiveIndex = _programIndex;
+            }
+            else
+            {
+                _programIndex ^= 1;
+                --_pendingBlocks;
+            }
+            _programming = false;
+            __set_PRIMASK(primask);
+
+            StartProgramming();
+        }
+
+        static DfuState _state;
+        static DfuStatus _status;
+        static DfuStatusResponse _statusResponse;
+        static DfuCallback _manifestationCallback;
+
+        static uint8_t _blocks[2][_TransferSize] __attribute__((aligned(8)));
+        static uint32_t _blockAddress[2];
+        static uint16_t _blockLength[2];
+        static uint8_t _receiveIndex;
+        static uint8_t _programIndex;
+        static volatile uint8_t _pendingBlocks;
+        static volatile bool _programming;
+        static uint32_t _erasedUntil;
+    };
+
+    #define DFU_INTERFACE_TEMPLATE_ARGS template<uint8_t _Number, typename _Ep0, uint32_t _FlashAddress, uint32_t _FlashSize, uint32_t _PageSize, uint16_t _TransferSize, uint32_t _PollTimeout>
+    #define DFU_INTERFACE_TEMPLATE_QUALIFIER DfuInterface<_Number, _Ep0, _FlashAddress, _FlashSize, _PageSize, _TransferSize, _PollTimeout>
+
+    DFU_INTERFACE_TEMPLATE_ARGS
+    DfuState DFU_INTERFACE_TEMPLATE_QUALIFIER::_state = DfuState::Idle;
+    DFU_INTERFACE_TEMPLATE_ARGS
+    DfuStatus DFU_INTERFACE_TEMPLATE_QUALIFIER::_status = DfuStatus::Ok;
+    DFU_INTERFACE_TEMPLATE_ARGS
+    DfuStatusResponse DFU_INTERFACE_TEMPLATE_QUALIFIER::_statusResponse;
+    DFU_INTERFACE_TEMPLATE_ARGS
+    DfuCallback DFU_INTERFACE_TEMPLATE_QUALIFIER::_manifestationCallback = nullptr;
+    DFU_INTERFACE_TEMPLATE_ARGS
+    uint8_t DFU_INTERFACE_TEMPLATE_QUALIFIER::_blocks[2][_TransferSize] __attribute__((aligned(8)));
+    DFU_INTERFACE_TEMPLATE_ARGS
+    uint32_t DFU_INTERFACE_TEMPLATE_QUALIFIER::_blockAddress[2];
+    DFU_INTERFACE_TEMPLATE_ARGS
+    uint16_t DFU_INTERFACE_TEMPLATE_QUALIFIER::_blockLength[2];
+    DFU_INTERFACE_TEMPLATE_ARGS
+    uint8_t DFU_INTERFACE_TEMPLATE_QUALIFIER::_receiveIndex = 0;
+    DFU_INTERFACE_TEMPLATE_ARGS
+    uint8_t DFU_INTERFACE_TEMPLATE_QUALIFIER::_programIndex = 0;
+    DFU_INTERFACE_TEMPLATE_ARGS
+    volatile uint8_t DFU_INTERFACE_TEMPLATE_QUALIFIER::_pendingBlocks = 0;
+    DFU_INTERFACE_TEMPLATE_ARGS
+    volatile bool DFU_INTERFACE_TEMPLATE_QUALIFIER::_programming = false;
+    DFU_INTERFACE_TEMPLATE_ARGS
+    uint32_t DFU_INTERFACE_TEMPLATE_QUALIFIER::_erasedUntil = _FlashAddress;
+
+    #undef DFU_INTERFACE_TEMPLATE_ARGS
+    #undef DFU_INTERFACE_TEMPLATE_QUALIFIER
+}
+#endif // ZHELE_USB_DFU_H
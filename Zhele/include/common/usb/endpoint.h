@@ -17,6 +17,8 @@
 #ifndef ZHELE_USB_ENDPOINT_H
 #define ZHELE_USB_ENDPOINT_H
 
+#include "../ioreg.h"
+#include "../macro_utils/declarations.h"
 #include "../template_utils/type_list.h"
 #include "../template_utils/static_array.h"
 
@@ -101,6 +103,7 @@ namespace Zhele::Usb
         static const EndpointType Type = _Type;
         static const uint16_t MaxPacketSize = _MaxPacketSize;
         static const uint8_t Interval = _Interval;
+        static const uint8_t Attributes = static_cast<uint8_t>(_Type) & 0x03;
     };
 
     template<uint8_t _Number, EndpointDirection _Direction, EndpointType _Type, uint16_t _MaxPacketSize, uint8_t _Interval>
@@ -142,6 +145,53 @@ namespace Zhele::Usb
         const static bool DisableZlp;
     };
 
+    /**
+     * @brief Isochronous endpoint synchronization type
+     */
+    enum class IsochronousSync : uint8_t
+    {
+        None = 0b00, ///< No synchronization
+        Asynchronous = 0b01, ///< Asynchronous (device clock defines data rate)
+        Adaptive = 0b10, ///< Adaptive (device adapts to host data rate)
+        Synchronous = 0b11, ///< Synchronous (data rate is locked to SOF)
+    };
+
+    /**
+     * @brief Isochronous endpoint usage type
+     */
+    enum class IsochronousUsage : uint8_t
+    {
+        Data = 0b00, ///< Data endpoint
+        Feedback = 0b01, ///< Explicit feedback endpoint
+        ImplicitFeedback = 0b10, ///< Data endpoint with implicit feedback
+    };
+
+    /**
+     * @brief Isochronous endpoint base
+     * 
+     * @details
+     * Isochronous endpoint transfers one packet per (micro)frame without handshake and retries.
+     * For stm32f0/f1 packet memory double buffering is used (application fills/reads one buffer
+     * while USB transfers other), for OTG core endpoint is enabled for next frame (even/odd).
+     * 
+     * @tparam _Number Endpoint number (address)
+     * @tparam _Direction Endpoint direction (In or Out)
+     * @tparam _MaxPacketSize Max packet size
+     * @tparam _Sync Synchronization type
+     * @tparam _Usage Usage type
+     * @tparam _Interval Polling interval (2^(_Interval - 1) frames)
+     */
+    template<uint8_t _Number, EndpointDirection _Direction, uint16_t _MaxPacketSize,
+        IsochronousSync _Sync = IsochronousSync::Asynchronous, IsochronousUsage _Usage = IsochronousUsage::Data, uint8_t _Interval = 1>
+    class IsochronousEndpointBase : public UniDirectionalEndpointBase<_Number, _Direction, EndpointType::Isochronous, _MaxPacketSize, _Interval>
+    {
+        static_assert(_Direction != EndpointDirection::Bidirectional, "Isochronous endpoint cannot be bidirectional.");
+    public:
+        static const uint8_t Attributes = static_cast<uint8_t>(EndpointType::Isochronous)
+            | (static_cast<uint8_t>(_Sync) << 2)
+            | (static_cast<uint8_t>(_Usage) << 4);
+    };
+
     template <uint8_t _Number, uint16_t _MaxPacketSize>
     class ControlEndpointBase : public EndpointBase<_Number, EndpointDirection::Bidirectional, EndpointType::Control, _MaxPacketSize, 0>
     {      
@@ -194,34 +244,30 @@ namespace Zhele::Usb
         }
 
         /**
-         * @brief Fills descriptor
-         * 
-         * @param [out] descriptor Destination memory.
+         * @brief Returns descriptor
          *
-         * @par Returns
-         *  Nothing
+         * @returns Descriptor bytes (two descriptors for bidirectional endpoint)
          */
-        static uint16_t FillDescriptor(EndpointDescriptor* descriptor)
+        static constexpr auto Descriptor()
         {
-            *descriptor = EndpointDescriptor{
+            constexpr auto descriptor = DescriptorBytes(EndpointDescriptor{
                 .Address = static_cast<uint8_t>(Number) | ((static_cast<uint8_t>(Direction) & 0x01) << 7),
-                .Attributes = static_cast<uint8_t>(Type) & 0x3,
+                .Attributes = _Base::Attributes,
                 .MaxPacketSize = MaxPacketSize,
-                .Interval = Interval};
+                .Interval = Interval});
 
             if constexpr(Direction == EndpointDirection::Bidirectional)
             {
-                ++descriptor;
-                *descriptor = EndpointDescriptor{
+                return ConcatDescriptors(descriptor, DescriptorBytes(EndpointDescriptor{
                     .Address = static_cast<uint8_t>(Number) | (1 << 7),
                     .Attributes = static_cast<uint8_t>(Type),
                     .MaxPacketSize = MaxPacketSize,
-                    .Interval = Interval};
-
-                return 2 * sizeof(EndpointDescriptor);
+                    .Interval = Interval}));
+            }
+            else
+            {
+                return descriptor;
             }
-
-            return sizeof(EndpointDescriptor);
         }
 
         /**
@@ -318,7 +364,7 @@ namespace Zhele::Usb
          * @par Returns
          *  Nothing
         */
-        static void Handler();
+        ZHELE_HANDLER static void Handler();
     private:
 
         template<uint16_t Mask, uint16_t ExtraBits>
@@ -384,10 +430,7 @@ namespace Zhele::Usb
          */
         static void SendData(const void* data, uint16_t size)
         {
-            const uint16_t* source = reinterpret_cast<const uint16_t*>(data);
-            uint16_t* destination = reinterpret_cast<uint16_t*>(_BufferAddress);
-            for(uint16_t i = 0; i < (size + 1) / 2; ++i)
-                destination[PmaAlignMultiplier * i] = source[i];
+            CopyToUsbPma(reinterpret_cast<void*>(_BufferAddress), data, size);
 
             BufferCountReg::Set(size);
             _Endpoint::SetTxStatus(EndpointStatus::Valid);
@@ -439,6 +482,40 @@ namespace Zhele::Usb
             _txCompleteCallback = callback;
             Writer::SendData(_dataToTransmit, _bytesRemain > _Base::MaxPacketSize ? _Base::MaxPacketSize : _bytesRemain);
         }
+
+        /**
+         * @brief Returns TX packet buffer (in packet memory) for direct write
+         * 
+         * @details
+         * Packet can be prepared directly in packet memory (without RAM buffer and copy)
+         * and sent by SendPacket. Halfword i of packet is placed at PacketBuffer()[i * PmaAlignMultiplier].
+         * Buffer can be written only when previous transfer has been completed.
+         * 
+         * @returns Packet buffer
+         */
+        static volatile uint16_t* PacketBuffer()
+        {
+            return reinterpret_cast<volatile uint16_t*>(_BufferAddress);
+        }
+
+        /**
+         * @brief Send packet prepared in PacketBuffer
+         * 
+         * @details
+         * ZLP is not sent after this packet.
+         * 
+         * @param [in] size Packet size (not greater than MaxPacketSize)
+         * @param [in, opt] callback Complete callback
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void SendPacket(uint16_t size, InTransferCallback callback = SetEpRxStatusValid)
+        {
+            _bytesRemain = 0;
+            _txCompleteCallback = callback;
+            Writer::SendData(size);
+        }
     protected:
         static void HandleTx()
         {
@@ -475,6 +552,8 @@ namespace Zhele::Usb
     InTransferCallback EndpointWithTxSupport<_Base, _Reg, _BufferAddress, _CountRegAddress>::_txCompleteCallback = nullptr;
 
     using OutTransferCallback = std::add_pointer_t<void()>;
+    /// Control OUT data stage complete callback (returns false to stall status stage)
+    using ControlDataCallback = std::add_pointer_t<bool(uint16_t size)>;
     /**
      * @brief Endpoint with RX feature
      */
@@ -617,9 +696,80 @@ namespace Zhele::Usb
             }
         }
 
+        /**
+         * @brief Receive control transfer OUT data stage to buffer
+         * 
+         * @details
+         * Should be called from SETUP handler of request with OUT data stage. Packets are
+         * copied to buffer until data stage is complete (requested length or short packet),
+         * then callback is called and status stage is sent: ZLP if there is no callback or it
+         * returns true, STALL otherwise.
+         * 
+         * @param [out] data Buffer
+         * @param [in] size Data stage length (Length field of setup packet)
+         * @param [in] callback Data stage complete callback
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void ReceiveControlData(void* data, uint16_t size, ControlDataCallback callback = nullptr)
+        {
+            _controlBuffer = reinterpret_cast<uint8_t*>(data);
+            _controlSize = size;
+            _controlReceived = 0;
+            _controlCallback = callback;
+            if(size == 0)
+            {
+                CompleteControlData();
+                return;
+            }
+            SetOutDataTransferCallback(HandleControlData);
+            Base::SetRxStatus(EndpointStatus::Valid);
+        }
+
         static void HandleRx();
+
+    private:
+        static void HandleControlData()
+        {
+            uint16_t size = RxBufferCount::Get() & 0x3ff;
+            if(size > _controlSize - _controlReceived)
+                size = _controlSize - _controlReceived;
+            CopyFromUsbPma(_controlBuffer + _controlReceived, reinterpret_cast<const void*>(RxBuffer), size);
+            _controlReceived += size;
+
+            if(size == _Base::MaxPacketSize && _controlReceived < _controlSize)
+            {
+                Base::SetRxStatus(EndpointStatus::Valid);
+                return;
+            }
+            CompleteControlData();
+        }
+
+        static void CompleteControlData()
+        {
+            ResetOutDataTransferCallback();
+            if(_controlCallback == nullptr || _controlCallback(_controlReceived))
+                TxModule::SendZLP();
+            else
+                Base::SetTxStatus(EndpointStatus::Stall);
+        }
+
+        static uint8_t* _controlBuffer;
+        static uint16_t _controlSize;
+        static uint16_t _controlReceived;
+        static ControlDataCallback _controlCallback;
     };
 
+    template<typename _Base, typename _Reg, uint32_t _TxBufferAddress, uint32_t _TxCountRegAddress, uint32_t _RxBufferAddress, uint32_t _RxCountRegAddress>
+    uint8_t* BidirectionalEndpoint<_Base, _Reg, _TxBufferAddress, _TxCountRegAddress, _RxBufferAddress, _RxCountRegAddress>::_controlBuffer = nullptr;
+    template<typename _Base, typename _Reg, uint32_t _TxBufferAddress, uint32_t _TxCountRegAddress, uint32_t _RxBufferAddress, uint32_t _RxCountRegAddress>
+    uint16_t BidirectionalEndpoint<_Base, _Reg, _TxBufferAddress, _TxCountRegAddress, _RxBufferAddress, _RxCountRegAddress>::_controlSize = 0;
+    template<typename _Base, typename _Reg, uint32_t _TxBufferAddress, uint32_t _TxCountRegAddress, uint32_t _RxBufferAddress, uint32_t _RxCountRegAddress>
+    uint16_t BidirectionalEndpoint<_Base, _Reg, _TxBufferAddress, _TxCountRegAddress, _RxBufferAddress, _RxCountRegAddress>::_controlReceived = 0;
+    template<typename _Base, typename _Reg, uint32_t _TxBufferAddress, uint32_t _TxCountRegAddress, uint32_t _RxBufferAddress, uint32_t _RxCountRegAddress>
+    ControlDataCallback BidirectionalEndpoint<_Base, _Reg, _TxBufferAddress, _TxCountRegAddress, _RxBufferAddress, _RxCountRegAddress>::_controlCallback = nullptr;
+
     /**
      * @brief Implements out (RX) double-buffered bulk endpoint
      * 
@@ -777,6 +927,43 @@ namespace Zhele::Usb
             WriteData(_dataToTransmit, _bytesRemain > _Base::MaxPacketSize ? _Base::MaxPacketSize : _bytesRemain);
             Base::SetTxStatus(EndpointStatus::Valid);
         }
+
+        /**
+         * @brief Returns current TX packet buffer (in packet memory) for direct write
+         * 
+         * @details
+         * Packet can be prepared directly in packet memory (without RAM buffer and copy)
+         * and sent by SendPacket. Halfword i of packet is placed at PacketBuffer()[i * PmaAlignMultiplier].
+         * Buffer can be written only when previous transfer has been completed.
+         * 
+         * @returns Packet buffer
+         */
+        static volatile uint16_t* PacketBuffer()
+        {
+            return reinterpret_cast<volatile uint16_t*>(GetCurrentBuffer() == 0 ? Buffer0 : Buffer1);
+        }
+
+        /**
+         * @brief Send packet prepared in PacketBuffer
+         * 
+         * @details
+         * ZLP is not sent after this packet.
+         * 
+         * @param [in] size Packet size (not greater than MaxPacketSize)
+         * @param [in, opt] callback Complete callback
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void SendPacket(uint16_t size, InTransferCallback callback = nullptr)
+        {
+            _bytesRemain = 0;
+            _txCompleteCallback = callback;
+
+            GetCurrentBuffer() == 0 ? Buffer0Count::Set(size) : Buffer1Count::Set(size);
+            SwitchBuffer();
+            Base::SetTxStatus(EndpointStatus::Valid);
+        }
     private:
         /**
          * @brief Send data
@@ -789,14 +976,8 @@ namespace Zhele::Usb
          */
         static void WriteData(const void* data, uint16_t size)
         {
-            uint16_t* destination;
-            destination = reinterpret_cast<uint16_t*>(GetCurrentBuffer() == 0 ? Buffer0 : Buffer1);
+            CopyToUsbPma(reinterpret_cast<void*>(GetCurrentBuffer() == 0 ? Buffer0 : Buffer1), data, size);
 
-            const uint16_t* source = reinterpret_cast<const uint16_t*>(data);
-            for(uint16_t i = 0; i < (size + 1) / 2; ++i)
-                destination[PmaAlignMultiplier * i] = source[i];
-
-            
             GetCurrentBuffer() == 0 ? Buffer0Count::Set(size) : Buffer1Count::Set(size);
 
             SwitchBuffer();
@@ -851,6 +1032,205 @@ namespace Zhele::Usb
         OutBulkDoubleBufferedEndpoint<_Base, _Reg, _Buffer0Address, _Count0RegAddress, _Buffer1Address, _Count1RegAddress>,
         InBulkDoubleBufferedEndpoint<_Base, _Reg, _Buffer0Address, _Count0RegAddress, _Buffer1Address, _Count1RegAddress>
         >;
+
+    /**
+     * @brief Implements in (TX) isochronous endpoint
+     * 
+     * @details
+     * Isochronous endpoint is always double-buffered: USB sends one buffer
+     * (selected by DTOG_TX, hardware toggles it every frame), application fills other one.
+     * Packet written by SendData/SendPacket is sent in next frame. After every IN transaction
+     * sent buffer becomes application buffer, its size is reset (so ZLP is sent if it is not updated)
+     * and callback is called. So callback is called every frame while host polls endpoint.
+     * 
+     * @tparam _Base Enpoint base
+     * @tparam _Reg EPnR register
+     * @tparam _Buffer0Address Buffer0 address
+     * @tparam _Count0RegAddress Count0 register address
+     * @tparam _Buffer1Address Buffer1 address
+     * @tparam _Count1RegAddress Count1 register address
+     */
+    template<typename _Base, typename _Reg, uint32_t _Buffer0Address, uint32_t _Count0RegAddress, uint32_t _Buffer1Address, uint32_t _Count1RegAddress>
+    class InIsochronousEndpoint : public Endpoint<_Base, _Reg>
+    {
+        using Base = Endpoint<_Base, _Reg>;
+
+        using Reg = _Reg;
+        static constexpr uint32_t Buffer0 = _Buffer0Address;
+        using Buffer0Count = RegisterWrapper<_Count0RegAddress, uint16_t>;
+        static constexpr uint32_t Buffer1 = _Buffer1Address;
+        using Buffer1Count = RegisterWrapper<_Count1RegAddress, uint16_t>;
+    public:
+        /**
+         * @brief Reset endpoint
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Reset()
+        {
+            Base::Reset();
+            Buffer0Count::Set(0);
+            Buffer1Count::Set(0);
+            Base::SetTxStatus(EndpointStatus::Valid);
+        }
+
+        /**
+         * @brief CTR handler
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Handler()
+        {
+            Base::ClearCtrTx();
+
+            GetCurrentBuffer() == 0 ? Buffer0Count::Set(0) : Buffer1Count::Set(0);
+
+            if(_txCompleteCallback)
+            {
+                _txCompleteCallback();
+            }
+        }
+
+        /**
+         * @brief Returns application TX packet buffer (in packet memory) for direct write
+         * 
+         * @details
+         * Halfword i of packet is placed at PacketBuffer()[i * PmaAlignMultiplier].
+         * 
+         * @returns Packet buffer
+         */
+        static volatile uint16_t* PacketBuffer()
+        {
+            return reinterpret_cast<volatile uint16_t*>(GetCurrentBuffer() == 0 ? Buffer0 : Buffer1);
+        }
+
+        /**
+         * @brief Send packet prepared in PacketBuffer in next frame
+         * 
+         * @param [in] size Packet size (not greater than MaxPacketSize)
+         * @param [in, opt] callback Frame complete callback
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void SendPacket(uint16_t size, InTransferCallback callback = nullptr)
+        {
+            _txCompleteCallback = callback;
+            GetCurrentBuffer() == 0 ? Buffer0Count::Set(size) : Buffer1Count::Set(size);
+        }
+
+        /**
+         * @brief Send data in next frame
+         * 
+         * @param [in] data Data
+         * @param [in] size Data size (not greater than MaxPacketSize)
+         * @param [in, opt] callback Frame complete callback
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void SendData(const void* data, uint16_t size, InTransferCallback callback = nullptr)
+        {
+            CopyToUsbPma(reinterpret_cast<void*>(GetCurrentBuffer() == 0 ? Buffer0 : Buffer1), data, size);
+            SendPacket(size, callback);
+        }
+    private:
+        /**
+         * @brief Returns current buffer for user.
+         * 
+         * @retval 0 Buffer_0 should be used.
+         * @retval 1 Buffer_1 should be used.
+         */
+        static uint8_t GetCurrentBuffer()
+        {
+            return (Reg::Get() & USB_EP_DTOG_TX) > 0
+                ? 0
+                : 1;
+        }
+
+        static InTransferCallback _txCompleteCallback;
+    };
+
+    template<typename _Base, typename _Reg, uint32_t _Buffer0Address, uint32_t _Count0RegAddress, uint32_t _Buffer1Address, uint32_t _Count1RegAddress>
+    InTransferCallback InIsochronousEndpoint<_Base, _Reg, _Buffer0Address, _Count0RegAddress, _Buffer1Address, _Count1RegAddress>::_txCompleteCallback = nullptr;
+
+    /**
+     * @brief Implements out (RX) isochronous endpoint
+     * 
+     * @details
+     * Isochronous endpoint is always double-buffered: USB receives packet to one buffer
+     * (selected by DTOG_RX, hardware toggles it every frame), application reads other one.
+     * HandleRx is called with received packet every frame, it should be processed
+     * before next frame ends.
+     * 
+     * @tparam _Base Enpoint base
+     * @tparam _Reg EPnR register
+     * @tparam _Buffer0Address Buffer0 address
+     * @tparam _Count0RegAddress Count0 register address
+     * @tparam _Buffer1Address Buffer1 address
+     * @tparam _Count1RegAddress Count1 register address
+     */
+    template<typename _Base, typename _Reg, uint32_t _Buffer0Address, uint32_t _Count0RegAddress, uint32_t _Buffer1Address, uint32_t _Count1RegAddress>
+    class OutIsochronousEndpoint : public Endpoint<_Base, _Reg>
+    {
+        using Base = Endpoint<_Base, _Reg>;
+
+        using Reg = _Reg;
+        static constexpr uint32_t Buffer0 = _Buffer0Address;
+        using Buffer0Count = RegisterWrapper<_Count0RegAddress, uint16_t>;
+        static constexpr uint32_t Buffer1 = _Buffer1Address;
+        using Buffer1Count = RegisterWrapper<_Count1RegAddress, uint16_t>;
+    public:
+        /**
+         * @brief CTR handler
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Handler()
+        {
+            Base::ClearCtrRx();
+
+            GetCurrentBuffer() == 0
+                ? HandleRx(reinterpret_cast<void*>(Buffer0), Buffer0Count::Get() & 0x3ff)
+                : HandleRx(reinterpret_cast<void*>(Buffer1), Buffer1Count::Get() & 0x3ff);
+        }
+
+    private:
+        /**
+         * @brief Returns current buffer for user.
+         * 
+         * @retval 0 Buffer_0 should be used.
+         * @retval 1 Buffer_1 should be used.
+         */
+        static uint8_t GetCurrentBuffer()
+        {
+            return (Reg::Get() & USB_EP_DTOG_RX) > 0
+                ? 0
+                : 1;
+        }
+
+        static void HandleRx(void* data, uint16_t size);
+    };
+
+    /**
+     * @brief Implements isochronous endpoint
+     * 
+     * @tparam _Base Enpoint base
+     * @tparam _Reg EPnR register
+     * @tparam _Buffer0Address Buffer0 address
+     * @tparam _Count0RegAddress Count0 register address
+     * @tparam _Buffer1Address Buffer1 address
+     * @tparam _Count1RegAddress Count1 register address
+     */
+    template<typename _Base, typename _Reg, uint32_t _Buffer0Address, uint32_t _Count0RegAddress, uint32_t _Buffer1Address, uint32_t _Count1RegAddress>
+    using IsochronousEndpoint = std::conditional_t<
+        _Base::Direction == EndpointDirection::Out,
+        OutIsochronousEndpoint<_Base, _Reg, _Buffer0Address, _Count0RegAddress, _Buffer1Address, _Count1RegAddress>,
+        InIsochronousEndpoint<_Base, _Reg, _Buffer0Address, _Count0RegAddress, _Buffer1Address, _Count1RegAddress>
+        >;
 #elif defined (USB_OTG_FS)
     /**
      * @brief Implements endpoint
@@ -869,34 +1249,30 @@ namespace Zhele::Usb
         static const uint8_t Interval = _Base::Interval;
 
         /**
-         * @brief Fills descriptor
-         * 
-         * @param [out] descriptor Destination memory.
+         * @brief Returns descriptor
          *
-         * @par Returns
-         *  Nothing
+         * @returns Descriptor bytes (two descriptors for bidirectional endpoint)
          */
-        static uint16_t FillDescriptor(EndpointDescriptor* descriptor)
+        static constexpr auto Descriptor()
         {
-            *descriptor = EndpointDescriptor{
+            constexpr auto descriptor = DescriptorBytes(EndpointDescriptor{
                 .Address = static_cast<uint8_t>(Number) | ((static_cast<uint8_t>(Direction) & 0x01) << 7),
-                .Attributes = static_cast<uint8_t>(Type) & 0x3,
+                .Attributes = _Base::Attributes,
                 .MaxPacketSize = MaxPacketSize,
-                .Interval = Interval};
+                .Interval = Interval});
 
             if constexpr(Direction == EndpointDirection::Bidirectional)
             {
-                ++descriptor;
-                *descriptor = EndpointDescriptor{
+                return ConcatDescriptors(descriptor, DescriptorBytes(EndpointDescriptor{
                     .Address = static_cast<uint8_t>(Number) | (1 << 7),
                     .Attributes = static_cast<uint8_t>(Type),
                     .MaxPacketSize = MaxPacketSize,
-                    .Interval = Interval};
-
-                return 2 * sizeof(EndpointDescriptor);
+                    .Interval = Interval}));
+            }
+            else
+            {
+                return descriptor;
             }
-
-            return sizeof(EndpointDescriptor);
         }
         
         /**
@@ -906,7 +1282,29 @@ namespace Zhele::Usb
          *  Nothing
         */
         static void Handler();
+    protected:
+        /**
+         * @brief Returns frame parity bits for EPENA
+         * 
+         * @details
+         * Isochronous endpoint transfers data only in even or odd frames (selected by
+         * SD0PID_SEVNFRM/SODDFRM bits, the same for DIEPCTL and DOEPCTL), so endpoint is armed for next frame.
+         * 
+         * @returns Parity bits for isochronous endpoint, 0 for other ones
+         */
+        static uint32_t NextFrameParity()
+        {
+            if constexpr (Type == EndpointType::Isochronous)
+            {
+                return DstsOddFrame::IsSet()
+                    ? USB_OTG_DIEPCTL_SD0PID_SEVNFRM
+                    : USB_OTG_DIEPCTL_SODDFRM;
+            }
+            return 0;
+        }
     private:
+        static const uint32_t DstsAddress = ZHELE_USB_OTG_PERIPH_BASE + USB_OTG_DEVICE_BASE + offsetof(USB_OTG_DeviceTypeDef, DSTS);
+        using DstsOddFrame = IoBit<DstsAddress, uint32_t, USB_OTG_DSTS_FNSOF_Pos>;
     };
 
     /**
@@ -927,6 +1325,9 @@ namespace Zhele::Usb
     }
 
     using OutTransferCallback = std::add_pointer_t<void()>;
+    using OutDataReceivedCallback = std::add_pointer_t<void(uint32_t size)>;
+    /// Control OUT data stage complete callback (returns false to stall status stage)
+    using ControlDataCallback = std::add_pointer_t<bool(uint16_t size)>;
     /**
      * @brief Implements out (RX) endpoint
      * 
@@ -938,14 +1339,17 @@ namespace Zhele::Usb
     class OutEndpoint : public Endpoint<_Base>
     {
     public:
-        static uint8_t BufferSize;
-        static uint8_t Buffer[_Base::MaxPacketSize];
+        static uint16_t BufferSize;
+        static uint8_t Buffer[_Base::MaxPacketSize] __attribute__((aligned(4)));
 
         /**
          * @brief Reset endpoint
          */
         static void Reset()
         {
+#if defined (ZHELE_USB_OTG_DMA)
+            _Regs()->DOEPDMA = reinterpret_cast<uint32_t>(Buffer);
+#endif
             if constexpr (_Base::Number == 0)
             {
                 static_assert(_Base::MaxPacketSize == 8 || _Base::MaxPacketSize == 16 || _Base::MaxPacketSize == 32 || _Base::MaxPacketSize == 64);
@@ -965,6 +1369,7 @@ namespace Zhele::Usb
                     | (_Base::MaxPacketSize << USB_OTG_DOEPTSIZ_XFRSIZ_Pos);
                 _Regs()->DOEPCTL = USB_OTG_DOEPCTL_EPENA 
                     | USB_OTG_DOEPCTL_CNAK
+                    | Endpoint<_Base>::NextFrameParity()
                     | (static_cast<uint32_t>(_Base::Type) << USB_OTG_DOEPCTL_EPTYP_Pos)
                     | USB_OTG_DOEPCTL_USBAEP
                     | _Base::MaxPacketSize;
@@ -972,13 +1377,68 @@ namespace Zhele::Usb
         }
 
         /**
-         * @brief RX fifo not empty handler
+         * @brief Transfer complete handler
+         * 
+         * @details
+         * Calls ReceiveData callback if multi-packet transfer is active, HandleRx otherwise.
          */
         static void Handler()
         {
+            _Regs()->DOEPINT = USB_OTG_DOEPINT_XFRC;
+
+            if(_receiveBuffer != nullptr)
+            {
+#if defined (ZHELE_USB_OTG_DMA)
+                uint32_t expected = ((_receiveCapacity + _Base::MaxPacketSize - 1) / _Base::MaxPacketSize) * _Base::MaxPacketSize;
+                uint32_t received = expected - (_Regs()->DOEPTSIZ & USB_OTG_DOEPTSIZ_XFRSIZ);
+                _receivedSize = received < _receiveCapacity ? received : _receiveCapacity;
+#endif
+                OutDataReceivedCallback callback = _receiveCallback;
+                _receiveBuffer = nullptr;
+                if(callback)
+                    callback(_receivedSize);
+                return;
+            }
+
+            UpdateBufferSize();
             HandleRx();
         }
 
+        /**
+         * @brief Receive multi-packet transfer directly to buffer
+         * 
+         * @details
+         * Endpoint is programmed for ceil(size / MaxPacketSize) packets, so core NAKs host
+         * only after whole transfer (or short packet). Packets are copied from RX FIFO
+         * to buffer in RXFLVL interrupt, HandleRx is not called, callback is called
+         * with received size instead.
+         * Transfer size is limited by 1023 packets.
+         * In DMA mode buffer should be word-aligned and its size should be multiple of MaxPacketSize.
+         * 
+         * @param [out] data Buffer
+         * @param [in] size Buffer size
+         * @param [in] callback Receive complete callback
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void ReceiveData(void* data, uint32_t size, OutDataReceivedCallback callback)
+        {
+            uint32_t packetsCount = (size + _Base::MaxPacketSize - 1) / _Base::MaxPacketSize;
+
+            _receiveBuffer = reinterpret_cast<uint8_t*>(data);
+            _receiveCapacity = size;
+            _receivedSize = 0;
+            _receiveCallback = callback;
+
+#if defined (ZHELE_USB_OTG_DMA)
+            _Regs()->DOEPDMA = reinterpret_cast<uint32_t>(data);
+#endif
+            _Regs()->DOEPTSIZ = (packetsCount << USB_OTG_DOEPTSIZ_PKTCNT_Pos)
+                | ((packetsCount * _Base::MaxPacketSize) << USB_OTG_DOEPTSIZ_XFRSIZ_Pos);
+            _Regs()->DOEPCTL |= USB_OTG_DOEPCTL_CNAK | USB_OTG_DOEPCTL_EPENA | Endpoint<_Base>::NextFrameParity();
+        }
+
         /**
          * @brief Rx handler
          */
@@ -1009,9 +1469,12 @@ namespace Zhele::Usb
                 break;
             case EndpointStatus::Valid:
                 BufferSize = 0;
+#if defined (ZHELE_USB_OTG_DMA)
+                _Regs()->DOEPDMA = reinterpret_cast<uint32_t>(Buffer);
+#endif
                 _Regs()->DOEPTSIZ = (1 << USB_OTG_DOEPTSIZ_PKTCNT_Pos)
                     | (_Base::MaxPacketSize << USB_OTG_DOEPTSIZ_XFRSIZ_Pos);
-                _Regs()->DOEPCTL |= USB_OTG_DOEPCTL_CNAK | USB_OTG_DOEPCTL_EPENA;
+                _Regs()->DOEPCTL |= USB_OTG_DOEPCTL_CNAK | USB_OTG_DOEPCTL_EPENA | Endpoint<_Base>::NextFrameParity();
                 break;
             }
         }
@@ -1024,6 +1487,24 @@ namespace Zhele::Usb
             SetRxStatus(EndpointStatus::Valid);
         }
 
+        /**
+         * @brief Update BufferSize after transfer complete
+         * 
+         * @details
+         * In DMA mode packet is written to Buffer by core, so received size
+         * is calculated from transfer size register. In FIFO mode BufferSize is updated
+         * by RX FIFO handler, so method does nothing.
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void UpdateBufferSize()
+        {
+#if defined (ZHELE_USB_OTG_DMA)
+            BufferSize = _Base::MaxPacketSize - (_Regs()->DOEPTSIZ & USB_OTG_DOEPTSIZ_XFRSIZ);
+#endif
+        }
+
         /**
          * @brief Clear all interrupts for endpoint
          * 
@@ -1045,6 +1526,24 @@ namespace Zhele::Usb
          */
         static void HandlerFifoNotEmpty(uint16_t size)
         {
+            if(_receiveBuffer != nullptr)
+            {
+                uint32_t free = _receiveCapacity - _receivedSize;
+                uint8_t* destination = _receiveBuffer + _receivedSize;
+                for(int i = 0; i < (size + 3) / 4; ++i)
+                {
+                    uint32_t word = *reinterpret_cast<volatile uint32_t*>(_FifoAddress);
+                    uint32_t bytes = size - i * 4 < 4 ? size - i * 4 : 4;
+                    if(bytes > free)
+                        bytes = free;
+                    memcpy(destination, &word, bytes);
+                    destination += bytes;
+                    free -= bytes;
+                }
+                _receivedSize = _receiveCapacity - free;
+                return;
+            }
+
             for(int i = 0; i < (size + 3) / 4; ++i)
             {
                 reinterpret_cast<uint32_t*>(Buffer + BufferSize)[i] = *reinterpret_cast<uint32_t*>(_FifoAddress);
@@ -1090,6 +1589,10 @@ namespace Zhele::Usb
 
     private:
         static OutTransferCallback _dataTransferCallback;
+        static uint8_t* _receiveBuffer;
+        static uint32_t _receiveCapacity;
+        static uint32_t _receivedSize;
+        static OutDataReceivedCallback _receiveCallback;
     };
 
 
@@ -1097,10 +1600,22 @@ namespace Zhele::Usb
     OutTransferCallback OutEndpoint<_Base, _Regs, _FifoAddress>::_dataTransferCallback = nullptr;
 
     template<typename _Base, typename _Regs, uint32_t _FifoAddress>
-    uint8_t OutEndpoint<_Base, _Regs, _FifoAddress>::BufferSize = 0;
+    uint8_t* OutEndpoint<_Base, _Regs, _FifoAddress>::_receiveBuffer = nullptr;
+
+    template<typename _Base, typename _Regs, uint32_t _FifoAddress>
+    uint32_t OutEndpoint<_Base, _Regs, _FifoAddress>::_receiveCapacity = 0;
+
+    template<typename _Base, typename _Regs, uint32_t _FifoAddress>
+    uint32_t OutEndpoint<_Base, _Regs, _FifoAddress>::_receivedSize = 0;
 
     template<typename _Base, typename _Regs, uint32_t _FifoAddress>
-    uint8_t OutEndpoint<_Base, _Regs, _FifoAddress>::Buffer[_Base::MaxPacketSize] = {};
+    OutDataReceivedCallback OutEndpoint<_Base, _Regs, _FifoAddress>::_receiveCallback = nullptr;
+
+    template<typename _Base, typename _Regs, uint32_t _FifoAddress>
+    uint16_t OutEndpoint<_Base, _Regs, _FifoAddress>::BufferSize = 0;
+
+    template<typename _Base, typename _Regs, uint32_t _FifoAddress>
+    uint8_t OutEndpoint<_Base, _Regs, _FifoAddress>::Buffer[_Base::MaxPacketSize] __attribute__((aligned(4))) = {};
 
     using InTransferCallback = std::add_pointer_t<void()>;
     /**
@@ -1115,9 +1630,9 @@ namespace Zhele::Usb
     class InEndpoint : public Endpoint<_Base>
     {
         using Base = Endpoint<_Base>;
-        static const bool SendZlp = !(requires {_Base::DisableZlp;}); 
+        static const bool SendZlp = !(requires {_Base::DisableZlp;}) && _Base::Type != EndpointType::Isochronous;
         
-        static const uint32_t DiepEmpMskAddress = USB_OTG_FS_PERIPH_BASE + USB_OTG_DEVICE_BASE + offsetof(USB_OTG_DeviceTypeDef, DIEPEMPMSK);
+        static const uint32_t DiepEmpMskAddress = ZHELE_USB_OTG_PERIPH_BASE + USB_OTG_DEVICE_BASE + offsetof(USB_OTG_DeviceTypeDef, DIEPEMPMSK);
         using TxFifoEmptyInterruptMask = IoBit<DiepEmpMskAddress, uint32_t, Base::Number>;
     public:
 
@@ -1170,7 +1685,7 @@ namespace Zhele::Usb
                 return;
             }
 
-            if (_Regs()->DIEPINT & USB_OTG_DIEPINT_TXFE) {
+            if ((_Regs()->DIEPINT & USB_OTG_DIEPINT_TXFE) && TxFifoEmptyInterruptMask::IsSet()) {
                 HandleFifoEmpty();
                 return;
             }
@@ -1200,7 +1715,7 @@ namespace Zhele::Usb
                 _Regs()->DIEPCTL |= USB_OTG_DIEPCTL_SNAK;
                 break;
             case EndpointStatus::Valid:
-                _Regs()->DIEPCTL |= USB_OTG_DIEPCTL_CNAK | USB_OTG_DIEPCTL_EPENA;
+                _Regs()->DIEPCTL |= USB_OTG_DIEPCTL_CNAK | USB_OTG_DIEPCTL_EPENA | Base::NextFrameParity();
                 break;
             }
         }
@@ -1224,6 +1739,7 @@ namespace Zhele::Usb
         static void SendZLP(InTransferCallback callback = nullptr)
         {
             _needZlpSend = false;
+            _bytesRemain = 0;
             _txCompleteCallback = callback;
             _Regs()->DIEPTSIZ = (1 << USB_OTG_DIEPTSIZ_PKTCNT_Pos)
                 | (0 << USB_OTG_DIEPTSIZ_XFRSIZ_Pos);
@@ -1233,6 +1749,13 @@ namespace Zhele::Usb
         /**
          * @brief Send data
          * 
+         * @details
+         * Data is sent as one multi-packet transfer (transfer size is limited by 1023 packets).
+         * TX FIFO is pre-filled immediately, rest packets are written from TX FIFO empty interrupt
+         * (as many packets as FIFO can hold), so callback is called once per transfer.
+         * In DMA mode data is read by core: large buffers should be word-aligned and
+         * stay valid until callback (small ones are copied to endpoint buffer).
+         * 
          * @param [in] data Data
          * @param [in] size Data size
          * @param [in, opt] callback Complete callback
@@ -1240,6 +1763,7 @@ namespace Zhele::Usb
         static void SendData(const void* data, uint32_t size, InTransferCallback callback = nullptr)
         {
             _dataToTransmit = reinterpret_cast<const uint32_t*>(data);
+            _bytesRemain = size;
             _needZlpSend = size % _Base::MaxPacketSize == 0;
             _txCompleteCallback = callback;
 
@@ -1247,9 +1771,21 @@ namespace Zhele::Usb
 
             _Regs()->DIEPTSIZ = (packetsCount << USB_OTG_DIEPTSIZ_PKTCNT_Pos) | (size << USB_OTG_DIEPTSIZ_XFRSIZ_Pos);
 
-            TxFifoEmptyInterruptMask::Set();
-
+#if defined (ZHELE_USB_OTG_DMA)
+            // Small responses are usually built on stack, so copy them to endpoint buffer.
+            if(size <= sizeof(_dmaBuffer))
+            {
+                memcpy(_dmaBuffer, data, size);
+                data = _dmaBuffer;
+            }
+            _Regs()->DIEPDMA = reinterpret_cast<uint32_t>(data);
+            _bytesRemain = 0;
             SetTxStatus(EndpointStatus::Valid);
+#else
+            SetTxStatus(EndpointStatus::Valid);
+
+            HandleFifoEmpty();
+#endif
         }
     protected:
         /**
@@ -1274,41 +1810,44 @@ namespace Zhele::Usb
         }
         
         /**
-         * @brief Handle TX FIFO not empty
+         * @brief Handle TX FIFO empty: write packets while FIFO has free space
          * 
-         * @par Returns
-         *  Nothing
-         */
-        static void HandleFifoEmpty()
-        {
-            SendPacket();
-        }
-
-        /**
-         * @brief Send packet
-         * 
-         * @param size Packet size
+         * @details
+         * TX FIFO empty interrupt is enabled only while transfer has unwritten packets.
          * 
          * @par Returns
          *  Nothing
          */
-        inline static void SendPacket()
+        static void HandleFifoEmpty()
         {
-            int32_t bytesRemain = _Regs()->DIEPTSIZ & USB_OTG_DIEPTSIZ_XFRSIZ;
+            while(_bytesRemain > 0)
+            {
+                uint32_t packetSize = _bytesRemain < _Base::MaxPacketSize
+                    ? _bytesRemain
+                    : _Base::MaxPacketSize;
+                uint32_t doubleWordsToWrite = (packetSize + sizeof(uint32_t) - 1) / sizeof(uint32_t);
 
-            int32_t doubleWordsToWrite = (
-                (bytesRemain < _Base::MaxPacketSize
-                    ? bytesRemain
-                    : _Base::MaxPacketSize)
-                + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+                if((_Regs()->DTXFSTS & USB_OTG_DTXFSTS_INEPTFSAV) < doubleWordsToWrite)
+                    break;
 
-            for(int i = 0; i < doubleWordsToWrite; ++i) {
-                *reinterpret_cast<uint32_t*>(_FifoAddress) = *(_dataToTransmit++);
+                for(uint32_t i = 0; i < doubleWordsToWrite; ++i) {
+                    *reinterpret_cast<volatile uint32_t*>(_FifoAddress) = *(_dataToTransmit++);
+                }
+                _bytesRemain -= packetSize;
             }
+
+            if(_bytesRemain > 0)
+                TxFifoEmptyInterruptMask::Set();
+            else
+                TxFifoEmptyInterruptMask::Clear();
         }
 
     private:
+#if defined (ZHELE_USB_OTG_DMA)
+        static uint32_t _dmaBuffer[(_Base::Number == 0 ? 256 : _Base::MaxPacketSize) / sizeof(uint32_t)];
+#endif
         static const uint32_t* _dataToTransmit;
+        static uint32_t _bytesRemain;
         static bool _needZlpSend;
         static InTransferCallback _txCompleteCallback;
     };
@@ -1316,6 +1855,14 @@ namespace Zhele::Usb
     template<typename _Base, typename _Regs, uint8_t _FifoNumber, uint32_t _FifoAddress>
     const uint32_t* InEndpoint<_Base, _Regs, _FifoNumber, _FifoAddress>::_dataToTransmit = nullptr;
 
+    template<typename _Base, typename _Regs, uint8_t _FifoNumber, uint32_t _FifoAddress>
+    uint32_t InEndpoint<_Base, _Regs, _FifoNumber, _FifoAddress>::_bytesRemain = 0;
+
+#if defined (ZHELE_USB_OTG_DMA)
+    template<typename _Base, typename _Regs, uint8_t _FifoNumber, uint32_t _FifoAddress>
+    uint32_t InEndpoint<_Base, _Regs, _FifoNumber, _FifoAddress>::_dmaBuffer[(_Base::Number == 0 ? 256 : _Base::MaxPacketSize) / sizeof(uint32_t)];
+#endif
+
     template<typename _Base, typename _Regs, uint8_t _FifoNumber, uint32_t _FifoAddress>
     bool InEndpoint<_Base, _Regs, _FifoNumber, _FifoAddress>::_needZlpSend = false;
 
@@ -1360,6 +1907,7 @@ namespace Zhele::Usb
             if(_OutReg()->DOEPINT & USB_OTG_DOEPINT_XFRC)
             {
                 _OutReg()->DOEPINT = USB_OTG_DOEPINT_XFRC;
+                Out::UpdateBufferSize();
                 HandleRx();
             }
         }
@@ -1401,8 +1949,79 @@ namespace Zhele::Usb
             return _InReg()->DIEPINT;
         }
 
+        /**
+         * @brief Receive control transfer OUT data stage to buffer
+         * 
+         * @details
+         * Should be called from SETUP handler of request with OUT data stage. Packets are
+         * copied to buffer until data stage is complete (requested length or short packet),
+         * then callback is called and status stage is sent: ZLP if there is no callback or it
+         * returns true, STALL otherwise.
+         * 
+         * @param [out] data Buffer
+         * @param [in] size Data stage length (Length field of setup packet)
+         * @param [in] callback Data stage complete callback
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void ReceiveControlData(void* data, uint16_t size, ControlDataCallback callback = nullptr)
+        {
+            _controlBuffer = reinterpret_cast<uint8_t*>(data);
+            _controlSize = size;
+            _controlReceived = 0;
+            _controlCallback = callback;
+            if(size == 0)
+            {
+                CompleteControlData();
+                return;
+            }
+            Out::SetOutDataTransferCallback(HandleControlData);
+            Out::SetRxStatus(EndpointStatus::Valid);
+        }
+
         static void HandleRx();
+
+    private:
+        static void HandleControlData()
+        {
+            uint16_t size = Out::BufferSize;
+            if(size > _controlSize - _controlReceived)
+                size = _controlSize - _controlReceived;
+            memcpy(_controlBuffer + _controlReceived, Out::Buffer, size);
+            _controlReceived += size;
+
+            if(size == _Base::MaxPacketSize && _controlReceived < _controlSize)
+            {
+                Out::SetRxStatus(EndpointStatus::Valid);
+                return;
+            }
+            CompleteControlData();
+        }
+
+        static void CompleteControlData()
+        {
+            Out::ResetOutDataTransferCallback();
+            if(_controlCallback == nullptr || _controlCallback(_controlReceived))
+                SendZLP();
+            else
+                In::SetTxStatus(EndpointStatus::Stall);
+        }
+
+        static uint8_t* _controlBuffer;
+        static uint16_t _controlSize;
+        static uint16_t _controlReceived;
+        static ControlDataCallback _controlCallback;
     };
+
+    template<typename _Base, typename _InReg, typename _OutReg, uint8_t _FifoNumber, uint32_t _FifoAddress>
+    uint8_t* BidirectionalEndpoint<_Base, _InReg, _OutReg, _FifoNumber, _FifoAddress>::_controlBuffer = nullptr;
+    template<typename _Base, typename _InReg, typename _OutReg, uint8_t _FifoNumber, uint32_t _FifoAddress>
+    uint16_t BidirectionalEndpoint<_Base, _InReg, _OutReg, _FifoNumber, _FifoAddress>::_controlSize = 0;
+    template<typename _Base, typename _InReg, typename _OutReg, uint8_t _FifoNumber, uint32_t _FifoAddress>
+    uint16_t BidirectionalEndpoint<_Base, _InReg, _OutReg, _FifoNumber, _FifoAddress>::_controlReceived = 0;
+    template<typename _Base, typename _InReg, typename _OutReg, uint8_t _FifoNumber, uint32_t _FifoAddress>
+    ControlDataCallback BidirectionalEndpoint<_Base, _InReg, _OutReg, _FifoNumber, _FifoAddress>::_controlCallback = nullptr;
 #endif
     /**
      * @brief Default Ep0 instance
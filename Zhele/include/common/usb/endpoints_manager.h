@@ -12,9 +12,11 @@
 
 #include "../template_utils/static_array.h"
 #include "../template_utils/type_list.h"
+#include "../trace.h"
 
 #include "endpoint.h"
 
+#include <array>
 #include <type_traits>
 #include <stdint.h>
 #include <string.h>
@@ -119,15 +121,28 @@ namespace Zhele::Usb
     };
 
     /**
-     * @brief Predicate for search control or double-buffered bulk endpoints.
+     * @brief Predicate for search endpoints with two packet buffers (double-buffered bulk and isochronous).
      * 
      * @tparam Endpoint Endpoint
      */
     template<typename Endpoint>
-    class IsBidirectionalOrBulkDoubleBufferedEndpoint
+    class IsDoubleBufferedEndpoint
     {
     public:
         static const bool value = (Endpoint::Type == EndpointType::BulkDoubleBuffered
+                                || Endpoint::Type == EndpointType::Isochronous);
+    };
+
+    /**
+     * @brief Predicate for search control or double-buffered (bulk and isochronous) endpoints.
+     * 
+     * @tparam Endpoint Endpoint
+     */
+    template<typename Endpoint>
+    class IsBidirectionalOrBulkDoubleBufferedEndpoint
+    {
+    public:
+        static const bool value = (IsDoubleBufferedEndpoint<Endpoint>::value
                                 || Endpoint::Direction == EndpointDirection::Bidirectional);
     };
 
@@ -236,6 +251,39 @@ namespace Zhele::Usb
     template<typename Endpoints>
     using SortedUniqueEndpoints = EndpointsSortedByNumberAndDirection<typename Unique<Endpoints>::type>;
 
+    /**
+     * @brief Calculates size of one endpoint`s packet buffer.
+     * 
+     * @details Buffer should start at halfword boundary, so size is rounded up to even.
+     * Receive buffers are allocated by hardware in blocks (2 bytes up to 62 bytes, 32 bytes above),
+     * so receive buffer size is rounded up to block size (otherwise received packet can overwrite next buffer).
+     * 
+     * @tparam Endpoint Endpoint
+     */
+    template<typename Endpoint>
+    class PacketBufferSize
+    {
+    public:
+        static const uint16_t value = (Endpoint::Direction == EndpointDirection::In || Endpoint::MaxPacketSize <= 62)
+            ? (Endpoint::MaxPacketSize + 1) & ~1
+            : (Endpoint::MaxPacketSize + 31) & ~31;
+    };
+
+    /**
+     * @brief Calculates size of all endpoint`s packet buffers (two buffers for control and double-buffered endpoints).
+     * 
+     * @tparam Endpoint Endpoint
+     */
+    template<typename Endpoint>
+    class PacketMemorySize
+    {
+    public:
+        static const uint16_t value = (IsDoubleBufferedEndpoint<Endpoint>::value
+            || Endpoint::Direction == EndpointDirection::Bidirectional)
+                ? 2 * PacketBufferSize<Endpoint>::value
+                : PacketBufferSize<Endpoint>::value;
+    };
+
     /**
      * @brief Calculates endpoint`s buffers offsets.
      * 
@@ -256,11 +304,8 @@ namespace Zhele::Usb
         using Endpoint = GetType<Index, TypeList<Endpoints...>>::type;
         using PreviousEndpoint = GetType<Index - 1, TypeList<Endpoints...>>::type;
     public:
-        static const uint16_t value = OffsetOfBuffer<Index - 1, TypeList<Endpoints...>>::value +
-            ((PreviousEndpoint::Type == EndpointType::BulkDoubleBuffered
-            || PreviousEndpoint::Direction == EndpointDirection::Bidirectional)
-                ? PreviousEndpoint::MaxPacketSize * 2
-                : PreviousEndpoint::MaxPacketSize);
+        static const uint16_t value = OffsetOfBuffer<Index - 1, TypeList<Endpoints...>>::value
+            + PacketMemorySize<PreviousEndpoint>::value;
     };
 
 #if defined (USB)
@@ -283,7 +328,7 @@ namespace Zhele::Usb
     {
         using Endpoint = GetType<Number, TypeList<Endpoints...>>::type;
     public:
-        const unsigned value = Endpoint::Type == EndpointType::BulkDoubleBuffered
+        const unsigned value = IsDoubleBufferedEndpoint<Endpoint>::value
             ? 4 + OffsetOfBuffer<Number - 1, TypeList<Endpoints...>>::value
             : 2 + OffsetOfBuffer<Number - 1, TypeList<Endpoints...>>::value;
     };
@@ -335,16 +380,21 @@ namespace Zhele::Usb
                 ? Endpoint::Number == PreviousEndpoint::Number
                 : false;
 
-        // Two endpoints can share one EPnR (if they are unidirectional, not control and double-buffered Bulk)
+        // Two endpoints can share one EPnR (if they are unidirectional, not control and not double-buffered)
         static const bool IsEndpointIncompatibleWithPrevious = IsEndpointNumberEqualToPreviousEndpointNumber
             && (Endpoint::Type == EndpointType::Control
-                || Endpoint::Type == EndpointType::BulkDoubleBuffered
+                || IsDoubleBufferedEndpoint<Endpoint>::value
                 || Endpoint::Direction == EndpointDirection::Bidirectional
                 || PreviousEndpoint::Type == EndpointType::Control
-                || PreviousEndpoint::Type == EndpointType::BulkDoubleBuffered
+                || IsDoubleBufferedEndpoint<PreviousEndpoint>::value
                 || PreviousEndpoint::Direction == EndpointDirection::Bidirectional);
 
-        static_assert(!IsEndpointIncompatibleWithPrevious, "Incompatible endpoints with same number");
+        // Endpoints with same number, direction and type are alternatives from different configurations (share EPnR and BDT cell)
+        static const bool IsEndpointAlternativeOfPrevious = IsEndpointNumberEqualToPreviousEndpointNumber
+            && Endpoint::Direction == PreviousEndpoint::Direction
+            && Endpoint::Type == PreviousEndpoint::Type;
+
+        static_assert(!IsEndpointIncompatibleWithPrevious || IsEndpointAlternativeOfPrevious, "Incompatible endpoints with same number");
 
     public:
         static const uint8_t RegisterNumber =
@@ -371,21 +421,59 @@ namespace Zhele::Usb
     {
         /// USB PMA base address
         static const uint32_t PmaBufferBase = USB_PMAADDR;
+
+        template<typename Endpoint>
+        class IsSingleBufferedEndpoint
+        {
+        public:
+            static const bool value = !IsDoubleBufferedEndpoint<Endpoint>::value;
+        };
     public:
         using AllEndpointsList = TypeList<AllEndpoints...>;
 
+        /// Endpoints in order of buffers placement in PMA
+#if defined (ZHELE_USB_PMA_DOUBLE_BUFFERED_FIRST)
+        using PacketMemoryEndpointsList = Append_t<Sample_t<IsDoubleBufferedEndpoint, AllEndpointsList>, Sample_t<IsSingleBufferedEndpoint, AllEndpointsList>>;
+#else
+        using PacketMemoryEndpointsList = AllEndpointsList;
+#endif
+
         /// Buffer descriptor table size (all realy used endpoints * 8)
         static const auto BdtSize = 8 * (EndpointEPRn<GetType_t<sizeof...(AllEndpoints) - 1, AllEndpointsList>, AllEndpointsList>::RegisterNumber + 1);
 
         /// Buffer offset in PMA for endpoint
         template<typename Endpoint>
-        static const uint32_t BufferOffset = BdtSize + OffsetOfBuffer<TypeIndex<Endpoint, AllEndpointsList>::value, AllEndpointsList>::value;
+        static const uint32_t BufferOffset = BdtSize + OffsetOfBuffer<TypeIndex<Endpoint, PacketMemoryEndpointsList>::value, PacketMemoryEndpointsList>::value;
+
+        /// Second buffer offset in PMA for endpoint (RX buffer for control endpoint, buffer 1 for double-buffered endpoint)
+        template<typename Endpoint>
+        static const uint32_t SecondBufferOffset = BufferOffset<Endpoint> + PacketBufferSize<Endpoint>::value;
+
+        /**
+         * @brief Packet memory region of endpoint
+         */
+        struct PacketMemoryRegion
+        {
+            uint8_t Number; ///< Endpoint number
+            EndpointDirection Direction; ///< Endpoint direction
+            uint16_t Offset; ///< Buffers offset in PMA (in bytes)
+            uint16_t Size; ///< Buffers size (in bytes)
+        };
+
+        /// Packet memory layout (endpoints order)
+        static constexpr PacketMemoryRegion Layout[] = {{AllEndpoints::Number, AllEndpoints::Direction, BufferOffset<AllEndpoints>, PacketMemorySize<AllEndpoints>::value}...};
+
+        /// Used packet memory size (BDT and all endpoints buffers, in bytes)
+        static const uint32_t UsedPacketMemory = BdtSize + (0 + ... + PacketMemorySize<AllEndpoints>::value);
+
+        /// Available packet memory size (in bytes)
+        static const uint32_t AvailablePacketMemory = PmaSize;
 
         /// Buffer descriptor offset in BDT for endpoint
         template<typename Endpoint>
         static const uint32_t BdtCellOffset =
             EndpointEPRn<Endpoint, AllEndpointsList>::RegisterNumber * 8
-                                + (Endpoint::Type == EndpointType::BulkDoubleBuffered
+                                + (IsDoubleBufferedEndpoint<Endpoint>::value
                                 || Endpoint::Direction == EndpointDirection::In
                                 || Endpoint::Direction == EndpointDirection::Bidirectional
                                     ? 0
@@ -404,14 +492,21 @@ namespace Zhele::Usb
                 typename EndpointEPRn<Endpoint, TypeList<AllEndpoints...>>::type,
                 PmaBufferBase + PmaAlignMultiplier * BufferOffset<Endpoint>, // TxBuffer
                 PmaBufferBase + PmaAlignMultiplier * (BdtCellOffset<Endpoint> + 2), // TxCount
-                PmaBufferBase + PmaAlignMultiplier * (BufferOffset<Endpoint> + Endpoint::MaxPacketSize), // RxBuffer
+                PmaBufferBase + PmaAlignMultiplier * SecondBufferOffset<Endpoint>, // RxBuffer
                 PmaBufferBase + PmaAlignMultiplier * (BdtCellOffset<Endpoint> + 6)>, //RxCount
             typename Select<Endpoint::Type == EndpointType::BulkDoubleBuffered,
             BulkDoubleBufferedEndpoint<Endpoint,
                 typename EndpointEPRn<Endpoint, TypeList<AllEndpoints...>>::type,
                 PmaBufferBase + PmaAlignMultiplier * BufferOffset<Endpoint>, // Buffer0
                 PmaBufferBase + PmaAlignMultiplier * (BdtCellOffset<Endpoint> + 2), // Buffer0Count
-                PmaBufferBase + PmaAlignMultiplier * (BufferOffset<Endpoint> + Endpoint::MaxPacketSize), // Buffer1
+                PmaBufferBase + PmaAlignMultiplier * SecondBufferOffset<Endpoint>, // Buffer1
+                PmaBufferBase + PmaAlignMultiplier * (BdtCellOffset<Endpoint> + 6)>, //Buffer1Count
+            typename Select<Endpoint::Type == EndpointType::Isochronous,
+            IsochronousEndpoint<Endpoint,
+                typename EndpointEPRn<Endpoint, TypeList<AllEndpoints...>>::type,
+                PmaBufferBase + PmaAlignMultiplier * BufferOffset<Endpoint>, // Buffer0
+                PmaBufferBase + PmaAlignMultiplier * (BdtCellOffset<Endpoint> + 2), // Buffer0Count
+                PmaBufferBase + PmaAlignMultiplier * SecondBufferOffset<Endpoint>, // Buffer1
                 PmaBufferBase + PmaAlignMultiplier * (BdtCellOffset<Endpoint> + 6)>, //Buffer1Count
             typename Select<Endpoint::Direction == EndpointDirection::In,
             InEndpoint<Endpoint,
@@ -423,7 +518,7 @@ namespace Zhele::Usb
                 typename EndpointEPRn<Endpoint, TypeList<AllEndpoints...>>::type,
                 PmaBufferBase + PmaAlignMultiplier * BufferOffset<Endpoint>, // Buffer
                 PmaBufferBase + PmaAlignMultiplier * (BdtCellOffset<Endpoint> + 2)>, // BufferCount
-            void>::value>::value>::value>::value;
+            void>::value>::value>::value>::value>::value;
 
         /**
          * @brief Inits USB PMA
@@ -433,13 +528,79 @@ namespace Zhele::Usb
          */
         static void Init()
         {
+            static_assert(UsedPacketMemory <= AvailablePacketMemory,
+                "Endpoints buffers do not fit in USB packet memory (reduce max packet sizes).");
+            static_assert(IsLayoutValid(), "Endpoints buffers overlap.");
+
             (InitTxFieldsInDescriptor<AllEndpoints>(), ...);
             (InitRxAddressFieldInDescriptor<BidirectionalAndBulkDoubleBufferedEndpoints>(), ...);
             (InitRxCountFieldInDescriptor<RxEndpoints>(), ...);
             (InitSecondRxCountFieldInDescriptor<BidirectionalAndBulkDoubleBufferedEndpoints>(), ...);
         }
 
+        /**
+         * @brief Inits buffer descriptors of given endpoints only
+         * 
+         * @details
+         * Used on configuration change: endpoints with same number from different
+         * configurations share BDT cell, so cell should point to buffers of active configuration endpoint.
+         * 
+         * @tparam Endpoints Endpoints (from all endpoints list)
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        template<typename... Endpoints>
+        static void InitEndpoints(TypeList<Endpoints...>)
+        {
+            (InitDescriptor<Endpoints>(), ...);
+        }
+
     private:
+        /**
+         * @brief Checks packet memory layout
+         * 
+         * @details Each region should be halfword-aligned, placed after BDT, inside PMA
+         * and should not overlap other regions.
+         * 
+         * @retval true Layout is valid
+         * @retval false Layout is invalid
+         */
+        static consteval bool IsLayoutValid()
+        {
+            for(unsigned i = 0; i < sizeof...(AllEndpoints); ++i)
+            {
+                const PacketMemoryRegion& region = Layout[i];
+                if(region.Offset % 2 != 0 || region.Offset < BdtSize || region.Offset + region.Size > AvailablePacketMemory)
+                    return false;
+
+                for(unsigned j = i + 1; j < sizeof...(AllEndpoints); ++j)
+                {
+                    if(region.Offset < Layout[j].Offset + Layout[j].Size && Layout[j].Offset < region.Offset + region.Size)
+                        return false;
+                }
+            }
+            return true;
+        }
+
+        template<typename Endpoint>
+        static void InitDescriptor()
+        {
+            InitTxFieldsInDescriptor<Endpoint>();
+            if constexpr (IsBidirectionalOrBulkDoubleBufferedEndpoint<Endpoint>::value)
+            {
+                InitRxAddressFieldInDescriptor<Endpoint>();
+            }
+            if constexpr (IsOutEndpoint<Endpoint>::value)
+            {
+                InitRxCountFieldInDescriptor<Endpoint>();
+            }
+            if constexpr (IsBidirectionalOrBulkDoubleBufferedEndpoint<Endpoint>::value)
+            {
+                InitSecondRxCountFieldInDescriptor<Endpoint>();
+            }
+        }
+
         template<typename Endpoint>
         static void InitTxFieldsInDescriptor()
         {
@@ -449,7 +610,7 @@ namespace Zhele::Usb
         template<typename Endpoint>
         static void InitRxAddressFieldInDescriptor()
         {
-            *reinterpret_cast<uint16_t*>(BdtBase + PmaAlignMultiplier * (BdtCellOffset<Endpoint> + 4)) = BufferOffset<Endpoint> + Endpoint::MaxPacketSize;
+            *reinterpret_cast<uint16_t*>(BdtBase + PmaAlignMultiplier * (BdtCellOffset<Endpoint> + 4)) = SecondBufferOffset<Endpoint>;
         }
         template<typename Endpoint>
         static void InitRxCountFieldInDescriptor()
@@ -465,8 +626,8 @@ namespace Zhele::Usb
         static constexpr uint16_t CalculateRxCountValue()
         {
             return Endpoint::MaxPacketSize <= 62
-                ? (Endpoint::MaxPacketSize / 2) << 10
-                : 0x8000 | ((Endpoint::MaxPacketSize / 32 - 1) << 10);
+                ? ((Endpoint::MaxPacketSize + 1) / 2) << 10
+                : 0x8000 | (((Endpoint::MaxPacketSize + 31) / 32 - 1) << 10);
         }
     };
 
@@ -484,8 +645,8 @@ namespace Zhele::Usb
     >;
 
 #elif defined (USB_OTG_FS)
-    #define USB_INEP(i)  (USB_OTG_FS_PERIPH_BASE + USB_OTG_IN_ENDPOINT_BASE + (i) * USB_OTG_EP_REG_SIZE)
-    #define USB_OUTEP(i) (USB_OTG_FS_PERIPH_BASE + USB_OTG_OUT_ENDPOINT_BASE + (i) * USB_OTG_EP_REG_SIZE)
+    #define USB_INEP(i)  (ZHELE_USB_OTG_PERIPH_BASE + USB_OTG_IN_ENDPOINT_BASE + (i) * USB_OTG_EP_REG_SIZE)
+    #define USB_OUTEP(i) (ZHELE_USB_OTG_PERIPH_BASE + USB_OTG_OUT_ENDPOINT_BASE + (i) * USB_OTG_EP_REG_SIZE)
 
     IO_STRUCT_WRAPPER(USB_INEP(0), InEp0Reg, USB_OTG_INEndpointTypeDef);
     IO_STRUCT_WRAPPER(USB_INEP(1), InEp1Reg, USB_OTG_INEndpointTypeDef);
@@ -511,7 +672,7 @@ namespace Zhele::Usb
     template<typename... AllEndpoints, typename... InEndpoints, typename... OutEndpoints>
     class EndpointsManagerBase<TypeList<AllEndpoints...>, TypeList<InEndpoints...>, TypeList<OutEndpoints...>>
     {
-        IO_STRUCT_WRAPPER(USB_OTG_FS, OtgFsGlobal, USB_OTG_GlobalTypeDef);
+        IO_STRUCT_WRAPPER(ZHELE_USB_OTG_PERIPH_BASE, OtgFsGlobal, USB_OTG_GlobalTypeDef);
 
         /// Buffer offset for endpoint
         template<typename Endpoint>
@@ -539,7 +700,7 @@ namespace Zhele::Usb
             ? 11 + 2 * ((3 + MaximumOfOutEnpointsMaxPacketSize) / 4)
             : 16;
 
-        static const uint32_t FifoBaseAddress = USB_OTG_FS_PERIPH_BASE + USB_OTG_FIFO_BASE;
+        static const uint32_t FifoBaseAddress = ZHELE_USB_OTG_PERIPH_BASE + USB_OTG_FIFO_BASE;
         static const uint32_t EpFifoSize = USB_OTG_FIFO_SIZE;
 
         using InEndpointsList = TypeList<InEndpoints...>;
@@ -581,6 +742,9 @@ namespace Zhele::Usb
          */
         static void Init()
         {
+            static_assert(UsedFifoMemory <= AvailableFifoMemory,
+                "Endpoints FIFOs do not fit in OTG FIFO RAM (reduce max packet sizes).");
+
             OtgFsGlobal()->GRXFSIZ = RxFifoSize;
 
             (InitTransmitFifos<InEndpoints>(), ...);            
@@ -603,12 +767,23 @@ namespace Zhele::Usb
             }
             else
             {
-                using InEndpointsBefore = Slice<0, TypeIndex<Endpoint, InEndpointsList>::value, InEndpointsList>::type;
-                static const uint16_t FifoOffset = RxFifoSize + SumOfFifoSize<InEndpointsBefore>::value;
-                OtgFsGlobal()->DIEPTXF[Endpoint::Number - 1] = (CalculateTxFifoDepth(Endpoint::MaxPacketSize) << 16) | FifoOffset;
+                OtgFsGlobal()->DIEPTXF[Endpoint::Number - 1] = (CalculateTxFifoDepth(Endpoint::MaxPacketSize) << 16) | TxFifoOffset<Endpoint>();
             }
         }
 
+        /**
+         * @brief Calculates TX FIFO offset in FIFO RAM for endpoint (in words)
+         * 
+         * @tparam Endpoint Endpoint
+         * @return constexpr uint16_t TX FIFO offset
+         */
+        template<typename Endpoint>
+        static consteval uint16_t TxFifoOffset()
+        {
+            using InEndpointsBefore = Slice<0, TypeIndex<Endpoint, InEndpointsList>::value, InEndpointsList>::type;
+            return RxFifoSize + SumOfFifoSize<InEndpointsBefore>::value;
+        }
+
         /**
          * @brief Calculates TX FIFO depth 
          * 
@@ -639,6 +814,25 @@ namespace Zhele::Usb
         public:
             const static uint16_t value = (0 + ... + CalculateTxFifoDepth(Endpoints::MaxPacketSize));
         };
+    public:
+        /**
+         * @brief FIFO RAM region
+         */
+        struct FifoRegion
+        {
+            uint8_t Number; ///< TX FIFO number (0xff for shared RX FIFO)
+            uint16_t Offset; ///< Offset in FIFO RAM (in words)
+            uint16_t Size; ///< FIFO depth (in words)
+        };
+
+        /// FIFO RAM layout (RX FIFO, then TX FIFOs)
+        static constexpr FifoRegion Layout[] = {{0xff, 0, RxFifoSize}, {InEndpoints::Number, TxFifoOffset<InEndpoints>(), static_cast<uint16_t>(CalculateTxFifoDepth(InEndpoints::MaxPacketSize))}...};
+
+        /// Used FIFO RAM size (in words)
+        static const uint32_t UsedFifoMemory = RxFifoSize + SumOfFifoSize<InEndpointsList>::value;
+
+        /// Available FIFO RAM size (in words)
+        static const uint32_t AvailableFifoMemory = OtgFifoRamSize;
     };
 
     /**
@@ -662,92 +856,105 @@ namespace Zhele::Usb
     template<typename... Endpoints>
     using EndpointsInitializer = EndpointsManager<TypeList<Endpoints...>>;
 
+    /**
+     * @brief Max endpoint number
+     * 
+     * @tparam Endpoints Endpoints
+     */
+    template<typename Endpoints>
+    const int8_t MaxEndpointNumber = GetType<Zhele::TemplateUtils::Length<SortedUniqueEndpoints<Endpoints>>::value - 1, SortedUniqueEndpoints<Endpoints>>::type::Number;
+
     /**
      * @brief Implements endpoint`s handlers management.
      * 
+     * @details
+     * Handlers table is built at compile time and indexed by endpoint number and direction
+     * (2 * number for IN, 2 * number + 1 for OUT), so USB interrupt does single indexed call.
+     * 
      * @tparam Endpoints Unique sorted endpoints.
-     * @tparam Indexes Handlers indexes.
      */
-    template<typename Endpoints, typename Indexes>
+    template<typename Endpoints>
     class EndpointHandlersBase;
-    template<typename... Endpoints, int8_t... Indexes>
-    class EndpointHandlersBase<TypeList<Endpoints...>, Int8_tArray<Indexes...>>
+    template<typename... Endpoints>
+    class EndpointHandlersBase<TypeList<Endpoints...>>
     {
-        static constexpr EpRequestHandler _handlers[] = {Endpoints::Handler...};
-        static constexpr int8_t _handlersIndexes[] = {Indexes...};
+        static const uint8_t HandlersCount = 2 * (MaxEndpointNumber<TypeList<Endpoints...>> + 1);
+
+        static void Unhandled() {}
+
+        static consteval std::array<EpRequestHandler, HandlersCount> BuildHandlers()
+        {
+            std::array<EpRequestHandler, HandlersCount> handlers {};
+            handlers.fill(Unhandled);
+            auto add = [&handlers](uint8_t number, EndpointDirection direction, EpRequestHandler handler)
+            {
+                if(direction != EndpointDirection::Out)
+                    handlers[2 * number] = handler;
+                if(direction != EndpointDirection::In)
+                    handlers[2 * number + 1] = handler;
+            };
+            (add(Endpoints::Number, Endpoints::Direction, Endpoints::Handler), ...);
+            return handlers;
+        }
+
+        static constexpr std::array<EpRequestHandler, HandlersCount> _handlers = BuildHandlers();
     public:
         inline static void Handle(uint8_t number, EndpointDirection direction)
         {
-            _handlers[_handlersIndexes[2 * number + (direction == EndpointDirection::Out ? 1 : 0)]]();
+            ZHELE_TRACE_EVENT(Trace::Event::UsbEndpoint, number | (static_cast<uint32_t>(direction) << 8));
+            uint8_t index = 2 * number + (direction == EndpointDirection::Out ? 1 : 0);
+            if(index < HandlersCount)
+                _handlers[index]();
         }
     };
 #if defined (USB_OTG_FS)
     /**
-     * @brief Implements endpoint`s handlers management.
+     * @brief Implements endpoint`s RX FIFO not empty handlers management.
      * 
-     * @tparam Endpoints Unique sorted endpoints.
-     * @tparam Indexes Handlers indexes.
+     * @details
+     * Handlers table is built at compile time and indexed by endpoint number.
+     * 
+     * @tparam OutEndpoints Unique sorted OUT (bidirectional) endpoints.
      */
-    template<typename OutEndpoints, typename Indexes>
+    template<typename OutEndpoints>
     class EndpointFifoNotEmptyHandlersBase;
-    template<typename... OutEndpoints, int8_t... Indexes>
-    class EndpointFifoNotEmptyHandlersBase<TypeList<OutEndpoints...>, Int8_tArray<Indexes...>>
+    template<typename... OutEndpoints>
+    class EndpointFifoNotEmptyHandlersBase<TypeList<OutEndpoints...>>
     {
-        /**
-         * @todo Pack rx fifo handlers via add one In endpoints as template parameter.
-         */
-        static constexpr EpRxFifoNotEmptyHandler _rxFifoHandlers[] = {OutEndpoints::HandlerFifoNotEmpty...};
-        static constexpr int8_t _handlersIndexes[] = {Indexes...};
+        static const uint8_t HandlersCount = MaxEndpointNumber<TypeList<OutEndpoints...>> + 1;
+
+        static void Unhandled(uint16_t) {}
+
+        static consteval std::array<EpRxFifoNotEmptyHandler, HandlersCount> BuildHandlers()
+        {
+            std::array<EpRxFifoNotEmptyHandler, HandlersCount> handlers {};
+            handlers.fill(Unhandled);
+            ((handlers[OutEndpoints::Number] = OutEndpoints::HandlerFifoNotEmpty), ...);
+            return handlers;
+        }
+
+        static constexpr std::array<EpRxFifoNotEmptyHandler, HandlersCount> _rxFifoHandlers = BuildHandlers();
     public:
         inline static void HandleRxFifoNotEmpty(uint8_t number, uint16_t size)
         {
-            _rxFifoHandlers[_handlersIndexes[2 * number + 1]](size);
+            if(number < HandlersCount)
+                _rxFifoHandlers[number](size);
         }
     };
 #endif
-    /**
-     * @brief Implements endpoint`s handlers indexes management.
-     * 
-     * @tparam Index Handler index.
-     * @tparam Endpoints Unique sorted endpoints.
-     */
-    template<int8_t Index, typename Endpoints>
-    class EndpointHandlersIndexes
-    {
-        using Predicate = Select<Index % 2 == 0, IsTxOrBidirectionalEndpointWithNumber<Index / 2>, IsRxOrBidirectionalEndpointWithNumber<Index / 2>>::value;
-        static const int8_t EndpointIndex = Search<Predicate::template type, Endpoints>::value;
-    public:
-        using type = typename Int8_tArray_InsertBack<typename EndpointHandlersIndexes<Index - 1, Endpoints>::type, EndpointIndex>::type;
-    };
-    template<typename Endpoints>
-    class EndpointHandlersIndexes<-1, Endpoints>
-    {
-    public:
-        using type = Int8_tArray<>;
-    };
-
-    /**
-     * @brief Max endpoint number
-     * 
-     * @tparam Endpoints Endpoints
-     */
-    template<typename Endpoints>
-    const int8_t MaxEndpointNumber = GetType<Zhele::TemplateUtils::Length<SortedUniqueEndpoints<Endpoints>>::value - 1, SortedUniqueEndpoints<Endpoints>>::type::Number;
 
     /**
      * @brief Endpoint`s handlers.
      */
     template<typename Endpoints>
-    using EndpointHandlers = EndpointHandlersBase<SortedUniqueEndpoints<Endpoints>,
-        typename EndpointHandlersIndexes<MaxEndpointNumber<Endpoints> * 2 + 1, SortedUniqueEndpoints<Endpoints>>::type>;
+    using EndpointHandlers = EndpointHandlersBase<SortedUniqueEndpoints<Endpoints>>;
 
 #if defined (USB_OTG_FS)
     /**
      * @brief Endpoint`s RXFLVLM handlers.
      */
     template<typename Endpoints>
-    using EndpointFifoNotEmptyHandlers = EndpointFifoNotEmptyHandlersBase<Sample_t<IsOutOrBidirectionalEndpoint, SortedUniqueEndpoints<Endpoints>>,
-        typename EndpointHandlersIndexes<MaxEndpointNumber<Endpoints> * 2 + 1, Sample_t<IsOutOrBidirectionalEndpoint, SortedUniqueEndpoints<Endpoints>>>::type>;
+    using EndpointFifoNotEmptyHandlers = EndpointFifoNotEmptyHandlersBase<Sample_t<IsOutOrBidirectionalEndpoint, SortedUniqueEndpoints<Endpoints>>>;
 #endif
 }
 #endif // ZHELE_USB_ENDPOINTS_MANAGER_H
\ No newline at end of file
@@ -55,33 +55,37 @@ namespace Zhele::Usb
         }
 
         /**
-         * @brief Fills reports descriptors
+         * @brief Returns HID descriptor
          * 
-         * @param [out] address Destination memory
-         * 
-         * @returns Total bytes writter
+         * @returns Descriptor bytes (HID descriptor with reports descriptors references)
          */
-        static uint16_t FillReportsDescriptors(uint8_t* address)
+        static constexpr auto Descriptor()
         {
-            ((*address++ = 0x22,
-            *address++ = static_cast<uint8_t>(static_cast<uint16_t>(sizeof(_Reports::Data)) & 0xff),
-            *address++ = static_cast<uint8_t>((static_cast<uint16_t>(sizeof(_Reports::Data)) >> 8) & 0xff)),...);
-
-            return 3 * sizeof...(_Reports);
+            return ConcatDescriptors(DescriptorBytes(HidImpl {}), std::array<uint8_t, 3> {
+                0x22,
+                static_cast<uint8_t>(static_cast<uint16_t>(sizeof(_Reports::Data)) & 0xff),
+                static_cast<uint8_t>((static_cast<uint16_t>(sizeof(_Reports::Data)) >> 8) & 0xff)
+            }...);
         }
 
         /**
-         * @brief Fill HID reports
-         * 
-         * @param [out] address Destination memory
+         * @brief Returns HID reports
          * 
-         * @returns Total bytes writter
+         * @returns Reports bytes
          */
-        static uint16_t FillReports(uint8_t* address)
+        static constexpr auto Reports()
         {
-            ((memcpy(address, _Reports::Data, sizeof(_Reports::Data)), address += sizeof(_Reports::Data)), ...);
+            return ConcatDescriptors(ReportBytes<_Reports>()...);
+        }
 
-            return ReportsSize();
+    private:
+        template<typename _Report>
+        static constexpr auto ReportBytes()
+        {
+            std::array<uint8_t, sizeof(_Report::Data)> bytes {};
+            for(unsigned i = 0; i < bytes.size(); ++i)
+                bytes[i] = _Report::Data[i];
+            return bytes;
         }
     };
 
@@ -102,6 +106,7 @@ namespace Zhele::Usb
     class HidInterface : public Interface<_Number, _AlternateSetting, InterfaceClass::Hid, _SubClass, _Protocol, _Ep0, _Endpoints...>
     {
         using Base = Interface<_Number, _AlternateSetting, InterfaceClass::Hid, _SubClass, _Protocol, _Ep0, _Endpoints...>;
+        static constexpr auto ReportsDescriptor = _HidImpl::Reports();
     public:
         using Endpoints = Base::Endpoints;
 
@@ -118,45 +123,25 @@ namespace Zhele::Usb
             if (setup->Request == StandartRequestCode::GetDescriptor
                 && static_cast<GetDescriptorParameter>(setup->Value) == GetDescriptorParameter::HidReportDescriptor)
             {
-                uint8_t temp[HidInterface::ReportsSize()];
-                uint16_t size = HidInterface::FillReports(temp);
-                _Ep0::SendData(temp, setup->Length < size ? setup->Length : size);
+                _Ep0::SendData(ReportsDescriptor.data(), setup->Length < ReportsDescriptor.size() ? setup->Length : ReportsDescriptor.size());
             }
         }
 
         /**
-         * @brief Fills descriptor
+         * @brief Returns descriptor
          * 
-         * @param [out] descriptor Destination memory
-         * 
-         * @par Returns
-         *  Nothing
+         * @returns Descriptor bytes (interface, HID and endpoints descriptors)
          */
-        static uint16_t FillDescriptor(InterfaceDescriptor* descriptor)
+        static constexpr auto Descriptor()
         {
-            uint16_t totalLength = sizeof(InterfaceDescriptor);
-
-            *descriptor = InterfaceDescriptor {
+            return ConcatDescriptors(DescriptorBytes(InterfaceDescriptor {
                 .Number = _Number,
                 .AlternateSetting = _AlternateSetting,
                 .EndpointsCount = Base::EndpointsCount,
                 .Class = InterfaceClass::Hid,
                 .SubClass = _SubClass,
                 .Protocol = _Protocol
-            };
-            _HidImpl* hidDescriptor = reinterpret_cast<_HidImpl*>(++descriptor);
-            *hidDescriptor = _HidImpl {
-            };
-            
-            uint8_t* reportsPart = reinterpret_cast<uint8_t*>(++hidDescriptor);
-            uint16_t bytesWritten = _HidImpl::FillReportsDescriptors(reportsPart);
-
-            totalLength += sizeof(_HidImpl) + bytesWritten;
-
-            EndpointDescriptor* endpointsDescriptors = reinterpret_cast<EndpointDescriptor*>(&reportsPart[bytesWritten]);
-            totalLength += (0 + ... + _Endpoints::FillDescriptor(endpointsDescriptors++));
-
-            return totalLength;
+            }), _HidImpl::Descriptor(), _Endpoints::Descriptor()...);
         }
 
         /**
@@ -170,16 +155,194 @@ namespace Zhele::Usb
         }
 
         /**
-         * @brief Fills reports
+         * @brief Returns reports
+         * 
+         * @returns Reports bytes
+         */
+        static constexpr auto Reports()
+        {
+            return _HidImpl::Reports();
+        }
+    };
+
+    /**
+     * @brief HID input reports queue for interrupt IN endpoint
+     * 
+     * @details
+     * Queue contains one slot per report ID. Update stores report in its slot and replaces
+     * previous report with the same ID if it has not been sent yet (latest wins),
+     * so host always receives actual state and every report is sent only once.
+     * Pending reports are sent from IN transfer complete callback (round-robin by report ID),
+     * so Update never waits for endpoint and can be called from main loop or interrupts.
+     * 
+     * If report IDs are used, first byte of report is report ID.
+     * 
+     * @tparam _InEp Interrupt IN endpoint
+     * @tparam _ReportSize Maximum report size (including report ID)
+     * @tparam _ReportIds Report IDs (empty if reports have no ID)
+     */
+    template<typename _InEp, unsigned _ReportSize, uint8_t... _ReportIds>
+    class HidReportQueue
+    {
+        static const unsigned SlotsCount = sizeof...(_ReportIds) > 0 ? sizeof...(_ReportIds) : 1;
+
+        static_assert(_ReportSize > 0 && _ReportSize <= _InEp::MaxPacketSize, "Report should fit in one packet.");
+        static_assert(SlotsCount <= 32, "Too many report IDs.");
+
+        static constexpr uint8_t ReportIds[SlotsCount] = {_ReportIds...};
+    public:
+        /**
+         * @brief Queue report
+         * 
+         * @param [in] report Report data (starts with report ID if IDs are used)
+         * @param [in] size Report size
+         * 
+         * @retval true Report is queued
+         * @retval false Invalid report size or unknown report ID
+         */
+        static bool Update(const void* report, unsigned size)
+        {
+            if(size == 0 || size > _ReportSize)
+                return false;
+
+            int slot = FindSlot(*reinterpret_cast<const uint8_t*>(report));
+            if(slot < 0)
+                return false;
+
+            uint32_t primask = __get_PRIMASK();
+            __disable_irq();
+            memcpy(_reports[slot], report, size);
+            _sizes[slot] = size;
+            if(_pending & (1u << slot))
+                ++_coalesced;
+            _pending |= (1u << slot);
+            if(!_busy)
+                SendNext();
+            __set_PRIMASK(primask);
+
+            return true;
+        }
+
+        /**
+         * @brief Returns true if all reports have been sent
          * 
-         * @param [out] descriptor Destination memory
+         * @retval true Queue is empty and endpoint is idle
+         * @retval false There are pending reports
+         */
+        static bool Idle()
+        {
+            return !_busy && _pending == 0;
+        }
+
+        /**
+         * @brief Returns count of reports replaced by newer ones before sending
          * 
-         * @returns Total bytes written
+         * @returns Coalesced reports count
          */
-        static uint16_t FillReports(uint8_t* destination)
+        static unsigned Coalesced()
+        {
+            return _coalesced;
+        }
+
+        /**
+         * @brief Drop pending reports (should be called on USB reset or configuration change)
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Reset()
+        {
+            uint32_t primask = __get_PRIMASK();
+            __disable_irq();
+            _pending = 0;
+            _busy = false;
+            __set_PRIMASK(primask);
+        }
+
+    private:
+        static int FindSlot(uint8_t reportId)
+        {
+            if constexpr (sizeof...(_ReportIds) == 0)
+            {
+                return 0;
+            }
+            else
+            {
+                for(unsigned i = 0; i < SlotsCount; ++i)
+                {
+                    if(ReportIds[i] == reportId)
+                        return i;
+                }
+                return -1;
+            }
+        }
+
+        static void SendNext()
         {
-            return _HidImpl::FillReports(destination);
+            uint32_t pending = _pending;
+            if(pending == 0)
+            {
+                _busy = false;
+                return;
+            }
+
+            unsigned slot = _next;
+            while((pending & (1u << slot)) == 0)
+                slot = slot + 1 < SlotsCount ? slot + 1 : 0;
+            _next = slot + 1 < SlotsCount ? slot + 1 : 0;
+            _pending = pending & ~(1u << slot);
+            _busy = true;
+
+#if defined (USB)
+            CopyToUsbPma(const_cast<uint16_t*>(_InEp::PacketBuffer()), _reports[slot], _sizes[slot]);
+            _InEp::SendPacket(_sizes[slot], OnTxComplete);
+#else
+            // Slot can be updated during transfer, so report is copied to TX buffer
+            memcpy(_txBuffer, _reports[slot], _sizes[slot]);
+            _InEp::SendData(_txBuffer, _sizes[slot], OnTxComplete);
+#endif
         }
+
+        static void OnTxComplete()
+        {
+            uint32_t primask = __get_PRIMASK();
+            __disable_irq();
+            SendNext();
+            __set_PRIMASK(primask);
+        }
+
+        static uint8_t _reports[SlotsCount][_ReportSize];
+        static uint8_t _sizes[SlotsCount];
+#if !defined (USB)
+        static uint8_t _txBuffer[_ReportSize];
+#endif
+        static volatile uint32_t _pending;
+        static volatile bool _busy;
+        static uint8_t _next;
+        static volatile unsigned _coalesced;
     };
+
+    template<typename _InEp, unsigned _ReportSize, uint8_t... _ReportIds>
+    uint8_t HidReportQueue<_InEp, _ReportSize, _ReportIds...>::_reports[SlotsCount][_ReportSize];
+
+    template<typename _InEp, unsigned _ReportSize, uint8_t... _ReportIds>
+    uint8_t HidReportQueue<_InEp, _ReportSize, _ReportIds...>::_sizes[SlotsCount];
+
+#if !defined (USB)
+    template<typename _InEp, unsigned _ReportSize, uint8_t... _ReportIds>
+    uint8_t HidReportQueue<_InEp, _ReportSize, _ReportIds...>::_txBuffer[_ReportSize];
+#endif
+
+    template<typename _InEp, unsigned _ReportSize, uint8_t... _ReportIds>
+    volatile uint32_t HidReportQueue<_InEp, _ReportSize, _ReportIds...>::_pending = 0;
+
+    template<typename _InEp, unsigned _ReportSize, uint8_t... _ReportIds>
+    volatile bool HidReportQueue<_InEp, _ReportSize, _ReportIds...>::_busy = false;
+
+    template<typename _InEp, unsigned _ReportSize, uint8_t... _ReportIds>
+    uint8_t HidReportQueue<_InEp, _ReportSize, _ReportIds...>::_next = 0;
+
+    template<typename _InEp, unsigned _ReportSize, uint8_t... _ReportIds>
+    volatile unsigned HidReportQueue<_InEp, _ReportSize, _ReportIds...>::_coalesced = 0;
 }
 #endif // ZHELE_USB_HID_H
\ No newline at end of file
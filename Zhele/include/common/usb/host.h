@@ -0,0 +1,301 @@
+/**
+ * @file
+ * Implements USB OTG host core (port, enumeration, channels and blocking transfers)
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_USB_HOST_H
+#define ZHELE_USB_HOST_H
+
+#include "device.h"
+
+#include <stdint.h>
+
+#if defined (USB_OTG_FS)
+namespace Zhele::Usb
+{
+    /**
+     * @brief Host state
+     */
+    enum class HostState : uint8_t
+    {
+        Disconnected, ///< No device
+        Attached, ///< Device is connected (debounce)
+        Configured, ///< Device is enumerated and configured
+        Error ///< Enumeration failed (until disconnection)
+    };
+
+    /**
+     * @brief Host transfer result
+     */
+    enum class HostResult : uint8_t
+    {
+        Ok, ///< Transfer is completed
+        Stall, ///< Endpoint is stalled
+        Error, ///< Transaction errors
+        Timeout, ///< Device does not respond (NAK) during timeout
+        Disconnected ///< Device is disconnected
+    };
+
+    /**
+     * @brief Implements USB OTG host (full speed, slave mode without interrupts)
+     *
+     * @details
+     * One device is supported (root port only, without hubs). Host is polled: call Process from main loop,
+     * it detects connection, resets port, enumerates device (address 1) and selects first configuration.
+     * Class drivers (for example, MscHost) find their interfaces in configuration descriptor, allocate
+     * channels and perform blocking transfers. Timeouts are counted by SOF frames (1 ms).
+     * Channels 0 and 1 are used by control pipe. Port power (PPWR) is enabled by Enable,
+     * VBUS switch of board (if any) should be controlled by application.
+     *
+     * @tparam _Regs OTG core global regs wrapper
+     * @tparam _HostRegs OTG host regs wrapper
+     * @tparam _ClockCtrl OTG core clock control
+     * @tparam _ChannelsCount Host channels count
+     * @tparam _ConfigurationSize Configuration descriptor buffer size (longer descriptor is truncated)
+     */
+    template<typename _Regs, typename _HostRegs, typename _ClockCtrl, uint8_t _ChannelsCount, uint16_t _ConfigurationSize = 256>
+    class HostBase
+    {
+    public:
+        /// Device address assigned by host
+        static const uint8_t DeviceAddress = 1;
+
+        /// Control OUT channel
+        static const uint8_t ControlOutChannel = 0;
+
+        /// Control IN channel
+        static const uint8_t ControlInChannel = 1;
+
+        /// Default transfer timeout (ms)
+        static const uint16_t DefaultTimeout = 1000;
+
+        /**
+         * @brief Enables host (core in host mode, port power)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Enable();
+
+        /**
+         * @brief Disables host (port power off)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Disable();
+
+        /**
+         * @brief Processes port state (connection, enumeration, disconnection)
+         *
+         * @details
+         * Enumeration is blocking (about 300 ms including connection debounce and reset).
+         *
+         * @returns State
+         */
+        static HostState Process();
+
+        /**
+         * @brief Returns host state
+         *
+         * @returns State
+         */
+        static HostState State();
+
+        /**
+         * @brief Returns connection state
+         *
+         * @retval true Device is connected to port
+         * @retval false Port is empty
+         */
+        static bool Connected();
+
+        /**
+         * @brief Returns connected device speed
+         *
+         * @retval true Low-speed device
+         * @retval false Full-speed device
+         */
+        static bool LowSpeed();
+
+        /**
+         * @brief Returns device descriptor (valid in Configured state)
+         *
+         * @returns Device descriptor
+         */
+        static const DeviceDescriptor& Device();
+
+        /**
+         * @brief Returns active configuration descriptor (with interfaces and endpoints descriptors)
+         *
+         * @returns Descriptor bytes
+         */
+        static const uint8_t* Configuration();
+
+        /**
+         * @brief Returns size of configuration descriptor
+         *
+         * @returns Size (not greater than _ConfigurationSize)
+         */
+        static uint16_t ConfigurationSize();
+
+        /**
+         * @brief Finds interface descriptor in active configuration
+         *
+         * @param [in] interfaceClass Interface class
+         * @param [in] subClass Interface subclass (0xff - any)
+         * @param [in] protocol Interface protocol (0xff - any)
+         *
+         * @returns Interface descriptor (or nullptr)
+         */
+        static const InterfaceDescriptor* FindInterface(DeviceAndInterfaceClass interfaceClass, uint8_t subClass = 0xff, uint8_t protocol = 0xff);
+
+        /**
+         * @brief Finds endpoint descriptor of interface
+         *
+         * @param [in] interface Interface descriptor (from FindInterface)
+         * @param [in] direction Endpoint direction (In or Out)
+         * @param [in] type Endpoint type
+         *
+         * @returns Endpoint descriptor (or nullptr)
+         */
+        static const EndpointDescriptor* FindEndpoint(const InterfaceDescriptor* interface, EndpointDirection direction, EndpointType type);
+
+        /**
+         * @brief Allocates channel
+         *
+         * @returns Channel number (-1 if all channels are used)
+         */
+        static int8_t AllocateChannel();
+
+        /**
+         * @brief Frees channel
+         *
+         * @param [in] channel Channel number
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void FreeChannel(uint8_t channel);
+
+        /**
+         * @brief Opens channel to device endpoint
+         *
+         * @param [in] channel Channel number
+         * @param [in] endpoint Endpoint descriptor
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void OpenChannel(uint8_t channel, const EndpointDescriptor& endpoint);
+
+        /**
+         * @brief Resets data toggle of channel (after CLEAR_FEATURE(ENDPOINT_HALT) or SET_CONFIGURATION)
+         *
+         * @param [in] channel Channel number
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void ResetToggle(uint8_t channel);
+
+        /**
+         * @brief Performs control transfer
+         *
+         * @param [in] requestType Request type (bmRequestType)
+         * @param [in] request Request (bRequest)
+         * @param [in] value Value (wValue)
+         * @param [in] index Index (wIndex)
+         * @param [in,out] data Data stage buffer (direction is defined by requestType bit 7)
+         * @param [in] length Data stage length (wLength)
+         * @param [out] transferred Transferred data bytes count (optional)
+         *
+         * @returns Result
+         */
+        static HostResult ControlTransfer(uint8_t requestType, uint8_t request, uint16_t value, uint16_t index,
+            void* data, uint16_t length, uint32_t* transferred = nullptr);
+
+        /**
+         * @brief Performs bulk (or interrupt) transfer on opened channel
+         *
+         * @details
+         * IN transfer ends on short packet or when size bytes are received.
+         * NAKed transactions are retried until timeout.
+         *
+         * @param [in] channel Channel number
+         * @param [in,out] data Data buffer
+         * @param [in] size Data size
+         * @param [out] transferred Transferred bytes count (optional)
+         * @param [in] timeout Timeout (ms, less than 16000)
+         *
+         * @returns Result
+         */
+        static HostResult Transfer(uint8_t channel, void* data, uint32_t size, uint32_t* transferred = nullptr, uint16_t timeout = DefaultTimeout);
+
+        /**
+         * @brief Clears endpoint halt (CLEAR_FEATURE(ENDPOINT_HALT)) and resets channel data toggle
+         *
+         * @param [in] channel Channel number
+         *
+         * @returns Result
+         */
+        static HostResult ClearHalt(uint8_t channel);
+
+    private:
+        /**
+         * @brief Channel state
+         */
+        struct Channel
+        {
+            uint8_t Endpoint; ///< Endpoint address (bit 7: IN)
+            uint8_t Type; ///< Endpoint type (HCCHAR EPTYP)
+            uint16_t MaxPacketSize; ///< Max packet size
+            bool Toggle; ///< Next data PID is DATA1
+            bool Used; ///< Channel is allocated
+        };
+
+        static USB_OTG_HostChannelTypeDef* ChannelRegs(uint8_t channel);
+        static volatile uint32_t& PortReg();
+        static volatile uint32_t& Fifo(uint8_t channel);
+        static uint16_t Frame();
+        static bool Expired(uint16_t start, uint16_t timeout);
+        static void WritePort(uint32_t set, uint32_t clear);
+
+        static bool ResetPort();
+        static void Disconnect();
+        static bool Enumerate();
+        static void ConfigureChannel(uint8_t channel);
+        static HostResult DoTransfer(uint8_t channel, uint8_t* data, uint32_t size, bool setup, uint32_t* transferred, uint16_t timeout);
+        static HostResult TransferIn(uint8_t channel, uint8_t* data, uint32_t size, uint32_t* transferred, uint16_t timeout);
+        static HostResult TransferOut(uint8_t channel, const uint8_t* data, uint32_t size, bool setup, uint16_t timeout);
+        static void Halt(uint8_t channel);
+        static uint16_t ReadRxFifo(uint8_t channel, uint8_t* data, uint32_t space);
+
+        static Channel _channels[_ChannelsCount];
+        static DeviceDescriptor _device;
+        static uint8_t _configuration[_ConfigurationSize];
+        static uint16_t _configurationSize;
+        static uint8_t _address;
+        static bool _lowSpeed;
+        static HostState _state;
+    };
+
+    IO_STRUCT_WRAPPER(ZHELE_USB_OTG_PERIPH_BASE + USB_OTG_HOST_BASE, UsbHostRegs, USB_OTG_HostTypeDef);
+
+#if defined (ZHELE_USB_OTG_HS)
+    /// USB host (OTG_HS core with embedded full-speed PHY)
+    using Host = HostBase<UsbRegs, UsbHostRegs, UsbClock, 12>;
+#else
+    /// USB host (OTG_FS core)
+    using Host = HostBase<UsbRegs, UsbHostRegs, UsbClock, 8>;
+#endif
+}
+
+#include "impl/host.h"
+#endif
+
+#endif //! ZHELE_USB_HOST_H
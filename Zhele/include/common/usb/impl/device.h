@@ -57,24 +57,29 @@ namespace Zhele::Usb
     {
         _ClockCtrl::Enable();
         EpBufferManager::Init();
+        Zhele::Power::LowPower::BlockStop();
 
-        _Regs()->CNTR = USB_CNTR_CTRM | USB_CNTR_RESETM;
+        _Regs()->CNTR = USB_CNTR_CTRM | USB_CNTR_RESETM | USB_CNTR_SUSPM | USB_CNTR_WKUPM;
         _Regs()->ISTR = 0;
         _Regs()->BTABLE = 0;
 #if defined (USB_BCDR_DPPU)
         _Regs()->BCDR |= USB_BCDR_DPPU;
 #endif
-        NVIC_EnableIRQ(_IRQNumber);
+        Nvic::EnableIrq<_IRQNumber>();
     }
 
     USB_DEVICE_TEMPLATE_ARGS
     void USB_DEVICE_TEMPLATE_QUALIFIER::Reset()
     {
+        Resume();
+        _remoteWakeupEnabled = false;
         _Ep0::Reset();
-        
-        (_Configurations::Reset(), ...);
 
-        _Regs()->CNTR = USB_CNTR_CTRM | USB_CNTR_RESETM;
+        _configurationIndex = 0;
+        _configurationValue = 0;
+        ActivateConfiguration<DefaultConfiguration>();
+
+        _Regs()->CNTR = USB_CNTR_CTRM | USB_CNTR_RESETM | USB_CNTR_SUSPM | USB_CNTR_WKUPM;
         _Regs()->ISTR = 0;
         _Regs()->BTABLE = 0;
         _Regs()->DADDR = USB_DADDR_EF;
@@ -87,12 +92,37 @@ namespace Zhele::Usb
 
         if(_Regs()->ISTR & USB_ISTR_RESET)
         {
+            ZHELE_STATISTICS_INCREMENT(Statistics, UsbCounter::Resets);
             Reset();
         }
+    #if defined (ZHELE_STATISTICS)
+        // Error flags are set regardless of interrupt mask
+        if(_Regs()->ISTR & USB_ISTR_ERR)
+        {
+            _Regs()->ISTR = static_cast<uint16_t>(~USB_ISTR_ERR);
+            Statistics.Increment(UsbCounter::Errors);
+        }
+        if(_Regs()->ISTR & USB_ISTR_PMAOVR)
+        {
+            _Regs()->ISTR = static_cast<uint16_t>(~USB_ISTR_PMAOVR);
+            Statistics.Increment(UsbCounter::PacketMemoryOverruns);
+        }
+    #endif
+        if(_Regs()->ISTR & USB_ISTR_WKUP)
+        {
+            _Regs()->ISTR = static_cast<uint16_t>(~USB_ISTR_WKUP);
+            Resume();
+        }
+        if(_Regs()->ISTR & USB_ISTR_SUSP)
+        {
+            _Regs()->ISTR = static_cast<uint16_t>(~USB_ISTR_SUSP);
+            Suspend();
+        }
         if (_Regs()->ISTR & USB_ISTR_CTR)
         {
             uint8_t endpoint = _Regs()->ISTR & USB_ISTR_EP_ID;
-            EpHandlers::Handle(endpoint, ((_Regs()->ISTR & USB_ISTR_DIR) != 0 ? EndpointDirection::Out : EndpointDirection::In));
+            ZHELE_STATISTICS_INCREMENT(Statistics, (_Regs()->ISTR & USB_ISTR_DIR) != 0 ? UsbCounter::OutPackets : UsbCounter::InPackets);
+            HandleEndpoint(endpoint, ((_Regs()->ISTR & USB_ISTR_DIR) != 0 ? EndpointDirection::Out : EndpointDirection::In));
         }
     }
 
@@ -128,37 +158,106 @@ namespace Zhele::Usb
             _Ep0::SetRxStatus(EndpointStatus::Valid);
         });
     }
+
+    USB_DEVICE_TEMPLATE_ARGS
+    void USB_DEVICE_TEMPLATE_QUALIFIER::Suspend()
+    {
+        if(_isSuspended)
+            return;
+
+        _isSuspended = true;
+        _Regs()->CNTR |= USB_CNTR_FSUSP;
+        _Regs()->CNTR |= USB_CNTR_LPMODE;
+        Zhele::Power::LowPower::UnblockStop();
+
+        if(_suspendCallback != nullptr)
+            _suspendCallback();
+    }
+
+    USB_DEVICE_TEMPLATE_ARGS
+    void USB_DEVICE_TEMPLATE_QUALIFIER::Resume()
+    {
+        if(!_isSuspended)
+            return;
+
+        Zhele::Power::LowPower::BlockStop();
+        // LP_MODE is cleared by hardware on wake up event, but not on remote wakeup
+        _Regs()->CNTR &= ~USB_CNTR_LPMODE;
+        _Regs()->CNTR &= ~USB_CNTR_FSUSP;
+        _isSuspended = false;
+
+        if(_resumeCallback != nullptr)
+            _resumeCallback();
+    }
+
+    USB_DEVICE_TEMPLATE_ARGS
+    bool USB_DEVICE_TEMPLATE_QUALIFIER::RemoteWakeup()
+    {
+        if(!_isSuspended || !_remoteWakeupEnabled)
+            return false;
+
+        Resume();
+        // Resume signaling: 1..15 ms
+        _Regs()->CNTR |= USB_CNTR_RESUME;
+        Zhele::delay_us<5000>();
+        _Regs()->CNTR &= ~USB_CNTR_RESUME;
+        return true;
+    }
 #elif defined (USB_OTG_FS)
     USB_DEVICE_TEMPLATE_ARGS
     void USB_DEVICE_TEMPLATE_QUALIFIER::Enable()
     {
         _ClockCtrl::Enable();
         
-        EpBufferManager::Init();
+        ConfigurationEpBufferManager<DefaultConfiguration>::Init();
+        Zhele::Power::LowPower::BlockStop();
 
 
         while (!(_Regs()->GRSTCTL & USB_OTG_GRSTCTL_AHBIDL)) continue;
 
-        _DeviceRegs()->DCFG = USB_OTG_DCFG_DSPD;
+#if defined (ZHELE_USB_OTG_HS_ULPI)
+        Zhele::Clock::OtgHsUlpiClock::Enable();
+
+        _DeviceRegs()->DCFG = 0; // High speed
+
+        _Regs()->GUSBCFG = USB_OTG_GUSBCFG_FDMOD // Force device mode
+                        | (0x09 << USB_OTG_GUSBCFG_TRDT_Pos); // Turnaround time for high speed (ULPI PHY)
+
+        _Regs()->GCCFG = USB_OTG_GCCFG_NOVBUSSENS; // Embedded FS PHY stays powered down
+#else
+        _DeviceRegs()->DCFG = USB_OTG_DCFG_DSPD; // Full speed (embedded PHY)
 
         _Regs()->GUSBCFG = USB_OTG_GUSBCFG_FDMOD // Force device mode
                         | (0x06 << USB_OTG_GUSBCFG_TRDT_Pos) // ??
                         | USB_OTG_GUSBCFG_PHYSEL; // USB 2.0
 
         _Regs()->GCCFG = USB_OTG_GCCFG_NOVBUSSENS; // Exit Power Down mode
+#endif
         _Regs()->GINTSTS = 0xfffffffful;
 
         _Regs()->GINTMSK = USB_OTG_GINTMSK_IEPINT   // Enable USB IN TX endpoint interrupt
                             | USB_OTG_GINTMSK_OEPINT   // Enable USB OUT RX endpoint interrupt
-                            | USB_OTG_GINTMSK_RXFLVLM // USB reciving
+#if !defined (ZHELE_USB_OTG_DMA)
+                            | USB_OTG_GINTMSK_RXFLVLM // USB reciving (core writes data to memory in DMA mode)
+#endif
                             | USB_OTG_GINTMSK_USBRST
+                            | USB_OTG_GINTMSK_USBSUSPM // Suspend interrupt
+                            | USB_OTG_GINTMSK_WUIM // Resume (wake up) interrupt
                             | USB_OTG_GINTMSK_ENUMDNEM;    // Reset interrupt
 
+#if !defined (ZHELE_USB_OTG_HS_ULPI)
         _Regs()->GCCFG |= USB_OTG_GCCFG_PWRDWN; // Enable USB
+#endif
         _DeviceRegs()->DCTL = 0;
 
-        NVIC_EnableIRQ(_IRQNumber);
+        Nvic::EnableIrq<_IRQNumber>();
+#if defined (ZHELE_USB_OTG_DMA)
+        _Regs()->GAHBCFG = USB_OTG_GAHBCFG_GINT // On USB general interrupt
+                        | USB_OTG_GAHBCFG_DMAEN // Internal DMA
+                        | (0x03 << USB_OTG_GAHBCFG_HBSTLEN_Pos); // INCR4 bursts
+#else
         _Regs()->GAHBCFG = USB_OTG_GAHBCFG_GINT;       // On USB general interrupt
+#endif
     }
 
     template<typename _Regs>
@@ -181,13 +280,18 @@ namespace Zhele::Usb
     USB_DEVICE_TEMPLATE_ARGS
     void USB_DEVICE_TEMPLATE_QUALIFIER::Reset()
     {
+        Resume();
+        _remoteWakeupEnabled = false;
+
         for (auto i = 0; i < 3; ++i)
             _Regs()->DIEPTXF[i] = 0;
 
-        EpBufferManager::Init();
+        _configurationIndex = 0;
+        _configurationValue = 0;
+        ConfigurationEpBufferManager<DefaultConfiguration>::Init();
 
         _Ep0::Reset();
-        (_Configurations::Reset(), ...);
+        DefaultConfiguration::Reset();
 
         _DeviceRegs()->DAINTMSK = DaintMskCalculator<Append_t<_Ep0, Endpoints>>::value;
         _DeviceRegs()->DOEPMSK = USB_OTG_DOEPMSK_STUPM // Enable setup-done irq
@@ -204,9 +308,20 @@ namespace Zhele::Usb
     {
         if (_Regs()->GINTSTS & USB_OTG_GINTSTS_USBRST) {
             _Regs()->GINTSTS = USB_OTG_GINTSTS_USBRST;
+            ZHELE_STATISTICS_INCREMENT(Statistics, UsbCounter::Resets);
             Reset();
         }
 
+        if (_Regs()->GINTSTS & USB_OTG_GINTSTS_WKUINT) {
+            _Regs()->GINTSTS = USB_OTG_GINTSTS_WKUINT;
+            Resume();
+        }
+
+        if (_Regs()->GINTSTS & USB_OTG_GINTSTS_USBSUSP) {
+            _Regs()->GINTSTS = USB_OTG_GINTSTS_USBSUSP;
+            Suspend();
+        }
+
         if (_Regs()->GINTSTS & USB_OTG_GINTSTS_ENUMDNE) { 
             _Regs()->GINTSTS = USB_OTG_GINTSTS_ENUMDNE;
             _isDeviceConfigured = true;
@@ -216,24 +331,25 @@ namespace Zhele::Usb
             uint32_t status = _Regs()->GRXSTSP;
             uint16_t size = (status & USB_OTG_GRXSTSP_BCNT) >> USB_OTG_GRXSTSP_BCNT_Pos;
             uint8_t enpointNumber = status & USB_OTG_GRXSTSP_EPNUM;
+            ZHELE_STATISTICS_INCREMENT(Statistics, UsbCounter::OutPackets);
 
-            EpFifoNotEmptyHandlers::HandleRxFifoNotEmpty(enpointNumber, size);
+            HandleRxFifoNotEmpty(enpointNumber, size);
         }
 
         if(_Regs()->GINTSTS & USB_OTG_GINTSTS_OEPINT) {
             uint32_t endpoints = _DeviceRegs()->DAINT & _DeviceRegs()->DAINTMSK;
 
             if (endpoints & (1 << 16)) {
-                EpHandlers::Handle(0, EndpointDirection::Out);
+                HandleEndpoint(0, EndpointDirection::Out);
             }
             if (endpoints & (1 << 17)) {
-                EpHandlers::Handle(1, EndpointDirection::Out);
+                HandleEndpoint(1, EndpointDirection::Out);
             }
             if (endpoints & (1 << 18)) {
-                EpHandlers::Handle(2, EndpointDirection::Out);
+                HandleEndpoint(2, EndpointDirection::Out);
             }
             if (endpoints & (1 << 19)) {
-                EpHandlers::Handle(3, EndpointDirection::Out);
+                HandleEndpoint(3, EndpointDirection::Out);
             }
         }
 
@@ -241,16 +357,20 @@ namespace Zhele::Usb
             uint32_t endpoints = _DeviceRegs()->DAINT & _DeviceRegs()->DAINTMSK;
 
             if (endpoints & (1 << 0)) {
-                EpHandlers::Handle(0, EndpointDirection::In);
+                ZHELE_STATISTICS_INCREMENT(Statistics, UsbCounter::InPackets);
+                HandleEndpoint(0, EndpointDirection::In);
             }
             if (endpoints & (1 << 1)) {
-                EpHandlers::Handle(1, EndpointDirection::In);
+                ZHELE_STATISTICS_INCREMENT(Statistics, UsbCounter::InPackets);
+                HandleEndpoint(1, EndpointDirection::In);
             }
             if (endpoints & (1 << 2)) {
-                EpHandlers::Handle(2, EndpointDirection::In);
+                ZHELE_STATISTICS_INCREMENT(Statistics, UsbCounter::InPackets);
+                HandleEndpoint(2, EndpointDirection::In);
             }
             if (endpoints & (1 << 3)) {
-                EpHandlers::Handle(3, EndpointDirection::In);
+                ZHELE_STATISTICS_INCREMENT(Statistics, UsbCounter::InPackets);
+                HandleEndpoint(3, EndpointDirection::In);
             }
         }
     }
@@ -265,6 +385,7 @@ namespace Zhele::Usb
 #endif
         }
         if (_Ep0::GetOutInterrupts() & USB_OTG_DOEPINT_XFRC) {
+            _Ep0::UpdateBufferSize();
             _Ep0::TryHandleDataTransfer();
         }
 
@@ -280,6 +401,49 @@ namespace Zhele::Usb
         _Ep0::SendZLP();
     }
 
+    USB_DEVICE_TEMPLATE_ARGS
+    void USB_DEVICE_TEMPLATE_QUALIFIER::Suspend()
+    {
+        if(_isSuspended || !(_DeviceRegs()->DSTS & USB_OTG_DSTS_SUSPSTS))
+            return;
+
+        _isSuspended = true;
+        // Stop PHY clock
+        *reinterpret_cast<volatile uint32_t*>(ZHELE_USB_OTG_PERIPH_BASE + USB_OTG_PCGCCTL_BASE) |= USB_OTG_PCGCCTL_STOPCLK;
+        Zhele::Power::LowPower::UnblockStop();
+
+        if(_suspendCallback != nullptr)
+            _suspendCallback();
+    }
+
+    USB_DEVICE_TEMPLATE_ARGS
+    void USB_DEVICE_TEMPLATE_QUALIFIER::Resume()
+    {
+        if(!_isSuspended)
+            return;
+
+        Zhele::Power::LowPower::BlockStop();
+        *reinterpret_cast<volatile uint32_t*>(ZHELE_USB_OTG_PERIPH_BASE + USB_OTG_PCGCCTL_BASE) &= ~USB_OTG_PCGCCTL_STOPCLK;
+        _isSuspended = false;
+
+        if(_resumeCallback != nullptr)
+            _resumeCallback();
+    }
+
+    USB_DEVICE_TEMPLATE_ARGS
+    bool USB_DEVICE_TEMPLATE_QUALIFIER::RemoteWakeup()
+    {
+        if(!_isSuspended || !_remoteWakeupEnabled)
+            return false;
+
+        Resume();
+        // Resume signaling: 1..15 ms
+        _DeviceRegs()->DCTL |= USB_OTG_DCTL_RWUSIG;
+        Zhele::delay_us<5000>();
+        _DeviceRegs()->DCTL &= ~USB_OTG_DCTL_RWUSIG;
+        return true;
+    }
+
 #endif
     USB_DEVICE_TEMPLATE_ARGS
     bool USB_DEVICE_TEMPLATE_QUALIFIER::IsDeviceConfigured()
@@ -288,73 +452,103 @@ namespace Zhele::Usb
     }
 
     USB_DEVICE_TEMPLATE_ARGS
-    void USB_DEVICE_TEMPLATE_QUALIFIER::FillDescriptor(DeviceDescriptor* descriptor)
+    bool USB_DEVICE_TEMPLATE_QUALIFIER::IsSuspended()
+    {
+        return _isSuspended;
+    }
+
+    USB_DEVICE_TEMPLATE_ARGS
+    void USB_DEVICE_TEMPLATE_QUALIFIER::SetSuspendCallback(PowerStateCallback callback)
+    {
+        _suspendCallback = callback;
+    }
+
+    USB_DEVICE_TEMPLATE_ARGS
+    void USB_DEVICE_TEMPLATE_QUALIFIER::SetResumeCallback(PowerStateCallback callback)
     {
-        *descriptor = DeviceDescriptor {
-            .UsbVersion = _UsbVersion,
-            .Class = _Class,
-            .SubClass = _SubClass,
-            .Protocol = _Protocol,
-            .MaxPacketSize = _Ep0::MaxPacketSize,
-            .VendorId = _VendorId,
-            .ProductId = _ProductId,
-            .DeviceReleaseNumber = _DeviceReleaseNumber,
-            .ManufacturerStringIndex = (std::is_same_v<decltype(_Manufacturer), decltype(EmptyFixedString16)>) ? 0 : 1,
-            .ProductStringIndex = (std::is_same_v<decltype(_Product), decltype(EmptyFixedString16)>) ? 0 : 2,
-            .SerialNumberStringIndex = (std::is_same_v<decltype(_Serial), decltype(EmptyFixedString16)>) ? 0 : 3,
-            .ConfigurationsCount = sizeof...(_Configurations)
-        };
+        _resumeCallback = callback;
     }
 
     USB_DEVICE_TEMPLATE_ARGS
     void USB_DEVICE_TEMPLATE_QUALIFIER::HandleSetupRequest(SetupPacket* setupRequest)
     {
         if (setupRequest->RequestType.Recipient == 1) {
-            IfHandlers::HandleSetupRequest(setupRequest->Index & 0xff);
+            HandleInterfaceSetupRequest(setupRequest->Index & 0xff);
+            return;
+        }
+
+        // Vendor request to device: only MS OS 2.0 descriptor set is supported
+        if (setupRequest->RequestType.Type == 2) {
+            if constexpr (MsOsDescriptors::Present) {
+                if (static_cast<uint8_t>(setupRequest->Request) == MsOs20VendorCode && setupRequest->Index == MsOs20DescriptorIndex) {
+                    SendDescriptor(MsOs20DescriptorSetData, setupRequest->Length);
+                    return;
+                }
+            }
+            _Ep0::SetTxStatus(EndpointStatus::Stall);
             return;
         }
         
         switch (setupRequest->Request) {
         case StandartRequestCode::GetStatus: {
-            uint16_t status = 0;
+            // D1 of device status - remote wakeup enabled
+            uint16_t status = (setupRequest->RequestType.Recipient == 0 && _remoteWakeupEnabled) ? 0x02 : 0;
             _Ep0::SendData(&status, sizeof(status));
             break;
         }
+        case StandartRequestCode::SetFeature:
+        case StandartRequestCode::ClearFeature: {
+            // Feature selector 1 - DEVICE_REMOTE_WAKEUP
+            if (setupRequest->RequestType.Recipient == 0 && setupRequest->Value == 1) {
+                _remoteWakeupEnabled = setupRequest->Request == StandartRequestCode::SetFeature;
+                _Ep0::SendZLP();
+            } else {
+                _Ep0::SetTxStatus(EndpointStatus::Stall);
+            }
+            break;
+        }
         case StandartRequestCode::SetAddress: {
             SetAddress(setupRequest->Value);
             break;
         }
 
         case StandartRequestCode::GetDescriptor: {
+            // Low byte of value is configuration index
+            if ((setupRequest->Value >> 8) == static_cast<uint8_t>(DescriptorType::Configuration)) {
+                if (!SendConfigurationDescriptor(setupRequest->Value & 0xff, setupRequest->Length)) {
+                    _Ep0::SetTxStatus(EndpointStatus::Stall);
+                }
+                break;
+            }
+
             switch (static_cast<GetDescriptorParameter>(setupRequest->Value)) {
             case GetDescriptorParameter::DeviceDescriptor: {
-                DeviceDescriptor tempDeviceDescriptor;
-                FillDescriptor(&tempDeviceDescriptor);
-                _Ep0::SendData(&tempDeviceDescriptor, setupRequest->Length < sizeof(DeviceDescriptor) ? setupRequest->Length : sizeof(DeviceDescriptor));
+                SendDescriptor(DeviceDescriptorData, setupRequest->Length);
+                break;
+            }
+            case GetDescriptorParameter::BosDescriptor: {
+                if constexpr (MsOsDescriptors::Present) {
+                    SendDescriptor(BosDescriptorData, setupRequest->Length);
+                } else {
+                    _Ep0::SetTxStatus(EndpointStatus::Stall);
+                }
                 break;
             }
 
-            case GetDescriptorParameter::ConfigurationDescriptor: {
-                uint8_t temp[128];
-                // Now supports only one configuration. It will easy to support more by adding dispatcher like in endpoint/interface
-                uint16_t size = GetType<0, Configurations>::type::FillDescriptor(reinterpret_cast<ConfigurationDescriptor*>(&temp[0]));
-                _Ep0::SendData(reinterpret_cast<ConfigurationDescriptor*>(&temp[0]), setupRequest->Length < size ? setupRequest->Length : size);
+#if defined (ZHELE_USB_OTG_HS_ULPI)
+            case GetDescriptorParameter::DeviceQualifierDescriptor: {
+                SendDescriptor(QualifierDescriptorData, setupRequest->Length);
                 break;
             }
+#endif
             case GetDescriptorParameter::StringLangDescriptor: {
-                LangIdDescriptor langIdDescriptor;
-                _Ep0::SendData(&langIdDescriptor, setupRequest->Length < sizeof(langIdDescriptor) ? setupRequest->Length : sizeof(langIdDescriptor));
+                SendDescriptor(LangIdDescriptorData, setupRequest->Length);
                 break;
             }
             case GetDescriptorParameter::StringManDescriptor: {
                 if constexpr (!std::is_same_v<decltype(_Manufacturer), decltype(EmptyFixedString16)>)
                 {
-                    uint8_t temp[sizeof(StringDescriptor) + _Manufacturer.Size];
-                    auto descriptor = reinterpret_cast<StringDescriptor*>(temp);
-                    *descriptor = StringDescriptor {.Length = sizeof(temp)};
-
-                    memcpy(descriptor->String, _Manufacturer.Text, _Manufacturer.Size);
-                    _Ep0::SendData(temp, setupRequest->Length < descriptor->Length ? setupRequest->Length : descriptor->Length);
+                    SendDescriptor(ManufacturerDescriptorData, setupRequest->Length);
                     break;
                 }
             }
@@ -362,24 +556,14 @@ namespace Zhele::Usb
             case GetDescriptorParameter::StringProdDescriptor: {
                 if constexpr (!std::is_same_v<decltype(_Product), decltype(EmptyFixedString16)>)
                 {
-                    uint8_t temp[sizeof(StringDescriptor) + _Product.Size];
-                    auto descriptor = reinterpret_cast<StringDescriptor*>(temp);
-                    *descriptor = StringDescriptor {.Length = sizeof(temp)};
-
-                    memcpy(descriptor->String, _Product.Text, _Product.Size);
-                    _Ep0::SendData(temp, setupRequest->Length < descriptor->Length ? setupRequest->Length : descriptor->Length);
+                    SendDescriptor(ProductDescriptorData, setupRequest->Length);
                     break;
                 }
             }
             case GetDescriptorParameter::StringSerialNumberDescriptor: {
                 if constexpr (!std::is_same_v<decltype(_Serial), decltype(EmptyFixedString16)>)
                 {
-                    uint8_t temp[sizeof(StringDescriptor) + _Serial.Size];
-                    auto descriptor = reinterpret_cast<StringDescriptor*>(temp);
-                    *descriptor = StringDescriptor {.Length = sizeof(temp)};
-
-                    memcpy(descriptor->String, _Serial.Text, _Serial.Size);
-                    _Ep0::SendData(temp, setupRequest->Length < descriptor->Length ? setupRequest->Length : descriptor->Length);
+                    SendDescriptor(SerialDescriptorData, setupRequest->Length);
                     break;
                 }
             }
@@ -390,13 +574,16 @@ namespace Zhele::Usb
             break;
         }
         case StandartRequestCode::GetConfiguration: {
-            uint8_t response = _isDeviceConfigured ? 1 : 0;
+            uint8_t response = _isDeviceConfigured ? _configurationValue : 0;
             _Ep0::SendData(&response, 1);
             break;
         }
         case StandartRequestCode::SetConfiguration: {
-            _isDeviceConfigured = true;
-            _Ep0::SendZLP();
+            if (SetConfiguration(setupRequest->Value & 0xff)) {
+                _Ep0::SendZLP();
+            } else {
+                _Ep0::SetTxStatus(EndpointStatus::Stall);
+            }
             break;
         }
         default:
@@ -405,23 +592,120 @@ namespace Zhele::Usb
         }
     }
 
+    USB_DEVICE_TEMPLATE_ARGS
+    bool USB_DEVICE_TEMPLATE_QUALIFIER::SendConfigurationDescriptor(uint8_t index, uint16_t length)
+    {
+        uint8_t i = 0;
+        return ((i++ == index ? (SendDescriptor(ConfigurationDescriptorData<_Configurations>, length), true) : false) || ...);
+    }
+
+    USB_DEVICE_TEMPLATE_ARGS
+    bool USB_DEVICE_TEMPLATE_QUALIFIER::SetConfiguration(uint8_t value)
+    {
+        uint8_t index = 0;
+        // Device with single configuration accepts any non-zero value (as configuration with number 0 does not follow USB spec)
+        bool found = (((_Configurations::Number == value || (sizeof...(_Configurations) == 1 && value != 0))
+            ? (DeactivateConfiguration(), _configurationIndex = index, ActivateConfiguration<_Configurations>(), true)
+            : (++index, false)) || ...);
+
+        if (found) {
+            _configurationValue = value;
+            _isDeviceConfigured = true;
+        } else if (value == 0) {
+            DeactivateConfiguration();
+            _configurationValue = 0;
+            _isDeviceConfigured = false;
+        }
+
+        return found || value == 0;
+    }
+
+    USB_DEVICE_TEMPLATE_ARGS
+    template<typename _Configuration>
+    void USB_DEVICE_TEMPLATE_QUALIFIER::ActivateConfiguration()
+    {
+#if defined (USB)
+        // Endpoints with same number from different configurations share BDT cell
+        EpBufferManager::InitEndpoints(typename _Configuration::Endpoints {});
+#elif defined (USB_OTG_FS)
+        FlushTx<_Regs>();
+        FlushRx<_Regs>();
+        ConfigurationEpBufferManager<_Configuration>::Init();
+#endif
+        _Configuration::Reset();
+    }
+
+    USB_DEVICE_TEMPLATE_ARGS
+    void USB_DEVICE_TEMPLATE_QUALIFIER::DeactivateConfiguration()
+    {
+        if (!_isDeviceConfigured)
+            return;
+
+        uint8_t index = 0;
+        ((index++ == _configurationIndex ? (_Configurations::Deactivate(), true) : false) || ...);
+    }
+
+    USB_DEVICE_TEMPLATE_ARGS
+    void USB_DEVICE_TEMPLATE_QUALIFIER::HandleEndpoint(uint8_t number, EndpointDirection direction)
+    {
+        if constexpr (sizeof...(_Configurations) == 1) {
+            (ConfigurationEpHandlers<_Configurations>::Handle(number, direction), ...);
+        } else {
+            uint8_t index = 0;
+            ((index++ == _configurationIndex ? (ConfigurationEpHandlers<_Configurations>::Handle(number, direction), true) : false) || ...);
+        }
+    }
+
+#if defined (USB_OTG_FS)
+    USB_DEVICE_TEMPLATE_ARGS
+    void USB_DEVICE_TEMPLATE_QUALIFIER::HandleRxFifoNotEmpty(uint8_t number, uint16_t size)
+    {
+        if constexpr (sizeof...(_Configurations) == 1) {
+            (ConfigurationEpFifoNotEmptyHandlers<_Configurations>::HandleRxFifoNotEmpty(number, size), ...);
+        } else {
+            uint8_t index = 0;
+            ((index++ == _configurationIndex ? (ConfigurationEpFifoNotEmptyHandlers<_Configurations>::HandleRxFifoNotEmpty(number, size), true) : false) || ...);
+        }
+    }
+#endif
+
+    USB_DEVICE_TEMPLATE_ARGS
+    void USB_DEVICE_TEMPLATE_QUALIFIER::HandleInterfaceSetupRequest(uint8_t number)
+    {
+        bool handled = false;
+        if constexpr (sizeof...(_Configurations) == 1) {
+            handled = (ConfigurationIfHandlers<_Configurations>::HandleSetupRequest(number) && ...);
+        } else {
+            uint8_t index = 0;
+            ((index++ == _configurationIndex ? (handled = ConfigurationIfHandlers<_Configurations>::HandleSetupRequest(number), true) : false) || ...);
+        }
+
+        if (!handled) {
+            _Ep0::SetTxStatus(EndpointStatus::Stall);
+        }
+    }
+
 #if defined (USB)
     IO_STRUCT_WRAPPER(USB, UsbRegs, USB_TypeDef);
 #elif defined (USB_OTG_FS)
-    IO_STRUCT_WRAPPER(USB_OTG_FS, UsbRegs, USB_OTG_GlobalTypeDef);
-    IO_STRUCT_WRAPPER(USB_OTG_FS_PERIPH_BASE + USB_OTG_DEVICE_BASE, UsbDeviceRegs, USB_OTG_DeviceTypeDef);
+    IO_STRUCT_WRAPPER(ZHELE_USB_OTG_PERIPH_BASE, UsbRegs, USB_OTG_GlobalTypeDef);
+    IO_STRUCT_WRAPPER(ZHELE_USB_OTG_PERIPH_BASE + USB_OTG_DEVICE_BASE, UsbDeviceRegs, USB_OTG_DeviceTypeDef);
 #endif
 
 #if defined (USB_LP_IRQn)
     #define USB_IRQ USB_LP_IRQn
 #elif defined (USB)
     // #define USB_IRQ USB_IRQ
+#elif defined (ZHELE_USB_OTG_HS)
+    #define USB_IRQ OTG_HS_IRQn
 #elif defined (USB_OTG_FS)
     #define USB_IRQ OTG_FS_IRQn
 #endif
 
 #if defined (USB)
     using UsbClock = Zhele::Clock::UsbClock;
+#elif defined (ZHELE_USB_OTG_HS)
+    using UsbClock = Zhele::Clock::OtgHsClock;
 #elif defined (USB_OTG_FS)
     using UsbClock = Zhele::Clock::OtgFsClock;
 #endif
@@ -464,6 +748,22 @@ namespace Zhele::Usb
 #endif
     USB_DEVICE_TEMPLATE_ARGS
     volatile bool USB_DEVICE_TEMPLATE_QUALIFIER::_isDeviceConfigured = false;
+    USB_DEVICE_TEMPLATE_ARGS
+    uint8_t USB_DEVICE_TEMPLATE_QUALIFIER::_configurationIndex = 0;
+    USB_DEVICE_TEMPLATE_ARGS
+    uint8_t USB_DEVICE_TEMPLATE_QUALIFIER::_configurationValue = 0;
+    USB_DEVICE_TEMPLATE_ARGS
+    volatile bool USB_DEVICE_TEMPLATE_QUALIFIER::_isSuspended = false;
+#if defined (ZHELE_STATISTICS)
+    USB_DEVICE_TEMPLATE_ARGS
+    UsbStatistics USB_DEVICE_TEMPLATE_QUALIFIER::Statistics;
+#endif
+    USB_DEVICE_TEMPLATE_ARGS
+    volatile bool USB_DEVICE_TEMPLATE_QUALIFIER::_remoteWakeupEnabled = false;
+    USB_DEVICE_TEMPLATE_ARGS
+    PowerStateCallback USB_DEVICE_TEMPLATE_QUALIFIER::_suspendCallback = nullptr;
+    USB_DEVICE_TEMPLATE_ARGS
+    PowerStateCallback USB_DEVICE_TEMPLATE_QUALIFIER::_resumeCallback = nullptr;
 }
 
 #endif //! ZHELE_USB_DEVICE_IMPL_H
\ No newline at end of file
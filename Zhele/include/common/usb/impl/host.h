@@ -0,0 +1,721 @@
+/**
+ * @file
+ * Implements USB OTG host methods
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_USB_HOST_IMPL_H
+#define ZHELE_USB_HOST_IMPL_H
+
+#include "../../delay.h"
+
+#include <string.h>
+
+#if defined (ZHELE_USB_OTG_HS_ULPI) || defined (ZHELE_USB_OTG_DMA)
+    #error "USB host supports embedded full-speed PHY in slave mode only."
+#endif
+
+namespace Zhele::Usb
+{
+    #define USB_HOST_TEMPLATE_ARGS template<typename _Regs, typename _HostRegs, typename _ClockCtrl, uint8_t _ChannelsCount, uint16_t _ConfigurationSize>
+    #define USB_HOST_TEMPLATE_QUALIFIER HostBase<_Regs, _HostRegs, _ClockCtrl, _ChannelsCount, _ConfigurationSize>
+
+    USB_HOST_TEMPLATE_ARGS
+    typename USB_HOST_TEMPLATE_QUALIFIER::Channel USB_HOST_TEMPLATE_QUALIFIER::_channels[_ChannelsCount];
+    USB_HOST_TEMPLATE_ARGS
+    DeviceDescriptor USB_HOST_TEMPLATE_QUALIFIER::_device;
+    USB_HOST_TEMPLATE_ARGS
+    uint8_t USB_HOST_TEMPLATE_QUALIFIER::_configuration[_ConfigurationSize];
+    USB_HOST_TEMPLATE_ARGS
+    uint16_t USB_HOST_TEMPLATE_QUALIFIER::_configurationSize = 0;
+    USB_HOST_TEMPLATE_ARGS
+    uint8_t USB_HOST_TEMPLATE_QUALIFIER::_address = 0;
+    USB_HOST_TEMPLATE_ARGS
+    bool USB_HOST_TEMPLATE_QUALIFIER::_lowSpeed = false;
+    USB_HOST_TEMPLATE_ARGS
+    HostState USB_HOST_TEMPLATE_QUALIFIER::_state = HostState::Disconnected;
+
+    USB_HOST_TEMPLATE_ARGS
+    void USB_HOST_TEMPLATE_QUALIFIER::Enable()
+    {
+        _ClockCtrl::Enable();
+
+        _Regs()->GUSBCFG |= USB_OTG_GUSBCFG_PHYSEL;
+        while (!(_Regs()->GRSTCTL & USB_OTG_GRSTCTL_AHBIDL)) continue;
+        _Regs()->GRSTCTL |= USB_OTG_GRSTCTL_CSRST;
+        while (_Regs()->GRSTCTL & USB_OTG_GRSTCTL_CSRST) continue;
+
+        _Regs()->GUSBCFG = (_Regs()->GUSBCFG & ~USB_OTG_GUSBCFG_FDMOD) | USB_OTG_GUSBCFG_FHMOD | USB_OTG_GUSBCFG_PHYSEL;
+        // Forced mode change takes 25 ms
+        Zhele::delay_us<50000>();
+
+        _Regs()->GCCFG = USB_OTG_GCCFG_NOVBUSSENS | USB_OTG_GCCFG_PWRDWN;
+        *reinterpret_cast<volatile uint32_t*>(reinterpret_cast<uintptr_t>(_Regs::Get()) + USB_OTG_PCGCCTL_BASE) = 0;
+        _HostRegs()->HCFG = USB_OTG_HCFG_FSLSPCS_0; // 48 MHz PHY clock
+
+        // FIFOs (words): RX, non-periodic TX, periodic TX
+#if defined (ZHELE_USB_OTG_HS)
+        _Regs()->GRXFSIZ = 0x200;
+        _Regs()->DIEPTXF0_HNPTXFSIZ = (0x100 << 16) | 0x200;
+        _Regs()->HPTXFSIZ = (0xe0 << 16) | 0x300;
+#else
+        _Regs()->GRXFSIZ = 0x80;
+        _Regs()->DIEPTXF0_HNPTXFSIZ = (0x60 << 16) | 0x80;
+        _Regs()->HPTXFSIZ = (0x40 << 16) | 0xe0;
+#endif
+        _Regs()->GRSTCTL = USB_OTG_GRSTCTL_TXFFLSH | (0x10 << USB_OTG_GRSTCTL_TXFNUM_Pos);
+        while (_Regs()->GRSTCTL & USB_OTG_GRSTCTL_TXFFLSH) continue;
+        _Regs()->GRSTCTL = USB_OTG_GRSTCTL_RXFFLSH;
+        while (_Regs()->GRSTCTL & USB_OTG_GRSTCTL_RXFFLSH) continue;
+
+        for(uint8_t i = 0; i < _ChannelsCount; ++i)
+        {
+            ChannelRegs(i)->HCINTMSK = 0;
+            ChannelRegs(i)->HCINT = 0xffffffff;
+            _channels[i].Used = false;
+        }
+        _channels[ControlOutChannel].Used = true;
+        _channels[ControlInChannel].Used = true;
+
+        // Host is polled: core interrupts are not used
+        _Regs()->GAHBCFG = 0;
+        _Regs()->GINTMSK = 0;
+        _Regs()->GINTSTS = 0xffffffff;
+
+        WritePort(USB_OTG_HPRT_PPWR, 0);
+        _state = HostState::Disconnected;
+    }
+
+    USB_HOST_TEMPLATE_ARGS
+    void USB_HOST_TEMPLATE_QUALIFIER::Disable()
+    {
+        Disconnect();
+        WritePort(0, USB_OTG_HPRT_PPWR);
+        _ClockCtrl::Disable();
+    }
+
+    USB_HOST_TEMPLATE_ARGS
+    HostState USB_HOST_TEMPLATE_QUALIFIER::Process()
+    {
+        bool connected = Connected();
+        if(_state != HostState::Disconnected && (!connected || (_Regs()->GINTSTS & USB_OTG_GINTSTS_DISCINT)))
+        {
+            _Regs()->GINTSTS = USB_OTG_GINTSTS_DISCINT;
+            Disconnect();
+            return _state;
+        }
+
+        switch (_state)
+        {
+        case HostState::Disconnected:
+            if(connected)
+            {
+                // Clear connect detection, debounce on next call
+                WritePort(0, 0);
+                _state = HostState::Attached;
+            }
+            break;
+        case HostState::Attached:
+            Zhele::delay_us<200000>();
+            if(!Connected())
+            {
+                _state = HostState::Disconnected;
+                break;
+            }
+            _state = (ResetPort() && Enumerate())
+                ? HostState::Configured
+                : HostState::Error;
+            break;
+        default:
+            break;
+        }
+        return _state;
+    }
+
+    USB_HOST_TEMPLATE_ARGS
+    HostState USB_HOST_TEMPLATE_QUALIFIER::State()
+    {
+        return _state;
+    }
+
+    USB_HOST_TEMPLATE_ARGS
+    bool USB_HOST_TEMPLATE_QUALIFIER::Connected()
+    {
+        return PortReg() & USB_OTG_HPRT_PCSTS;
+    }
+
+    USB_HOST_TEMPLATE_ARGS
+    bool USB_HOST_TEMPLATE_QUALIFIER::LowSpeed()
+    {
+        return _lowSpeed;
+    }
+
+    USB_HOST_TEMPLATE_ARGS
+    const DeviceDescriptor& USB_HOST_TEMPLATE_QUALIFIER::Device()
+    {
+        return _device;
+    }
+
+    USB_HOST_TEMPLATE_ARGS
+    const uint8_t* USB_HOST_TEMPLATE_QUALIFIER::Configuration()
+    {
+        return _configuration;
+    }
+
+    USB_HOST_TEMPLATE_ARGS
+    uint16_t USB_HOST_TEMPLATE_QUALIFIER::ConfigurationSize()
+    {
+        return _configurationSize;
+    }
+
+    USB_HOST_TEMPLATE_ARGS
+    const InterfaceDescriptor* USB_HOST_TEMPLATE_QUALIFIER::FindInterface(DeviceAndInterfaceClass interfaceClass, uint8_t subClass, uint8_t protocol)
+    {
+        for(uint16_t offset = 0; offset + 1 < _configurationSize && _configuration[offset] != 0; offset += _configuration[offset])
+        {
+            if(_configuration[offset + 1] != static_cast<uint8_t>(DescriptorType::Interface) || offset + sizeof(InterfaceDescriptor) > _configurationSize)
+                continue;
+
+            const InterfaceDescriptor* interface = reinterpret_cast<const InterfaceDescriptor*>(&_configuration[offset]);
+            if(interface->AlternateSetting == 0 && interface->Class == interfaceClass
+                && (subClass == 0xff || interface->SubClass == subClass)
+                && (protocol == 0xff || interface->Protocol == protocol))
+            {
+                return interface;
+            }
+        }
+        return nullptr;
+    }
+
+    USB_HOST_TEMPLATE_ARGS
+    const EndpointDescriptor* USB_HOST_TEMPLATE_QUALIFIER::FindEndpoint(const InterfaceDescriptor* interface, EndpointDirection direction, EndpointType type)
+    {
+        if(interface == nullptr)
+            return nullptr;
+
+        uint16_t offset = reinterpret_cast<const uint8_t*>(interface) - _configuration;
+        for(offset += interface->Length; offset + 1 < _configurationSize && _configuration[offset] != 0; offset += _configuration[offset])
+        {
+            uint8_t descriptorType = _configuration[offset + 1];
+            if(descriptorType == static_cast<uint8_t>(DescriptorType::Interface))
+                break;
+            if(descriptorType != static_cast<uint8_t>(DescriptorType::Endpoint) || offset + sizeof(EndpointDescriptor) > _configurationSize)
+                continue;
+
+            const EndpointDescriptor* endpoint = reinterpret_cast<const EndpointDescriptor*>(&_configuration[offset]);
+            if(((endpoint->Address & 0x80) != 0) == (direction == EndpointDirection::In)
+                && (endpoint->Attributes & 0x03) == static_cast<uint8_t>(type))
+            {
+                return endpoint;
+            }
+        }
+        return nullptr;
+    }
+
+    USB_HOST_TEMPLATE_ARGS
+    int8_t USB_HOST_TEMPLATE_QUALIFIER::AllocateChannel()
+    {
+        for(uint8_t i = 0; i < _ChannelsCount; ++i)
+        {
+            if(!_channels[i].Used)
+            {
+                _channels[i].Used = true;
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    USB_HOST_TEMPLATE_ARGS
+    void USB_HOST_TEMPLATE_QUALIFIER::FreeChannel(uint8_t channel)
+    {
+        if(channel > ControlInChannel && channel < _ChannelsCount)
+        {
+            Halt(channel);
+            _channels[channel].Used = false;
+        }
+    }
+
+    USB_HOST_TEMPLATE_ARGS
+    void USB_HOST_TEMPLATE_QUALIFIER::OpenChannel(uint8_t channel, const EndpointDescriptor& endpoint)
+    {
+        _channels[channel].Endpoint = endpoint.Address;
+        _channels[channel].Type = endpoint.Attributes & 0x03;
+        _channels[channel].MaxPacketSize = endpoint.MaxPacketSize & 0x7ff;
+        _channels[channel].Toggle = false;
+        ConfigureChannel(channel);
+    }
+
+    USB_HOST_TEMPLATE_ARGS
+    void USB_HOST_TEMPLATE_QUALIFIER::ResetToggle(uint8_t channel)
+    {
+        _channels[channel].Toggle = false;
+    }
+
+    USB_HOST_TEMPLATE_ARGS
+    HostResult USB_HOST_TEMPLATE_QUALIFIER::ControlTransfer(uint8_t requestType, uint8_t request, uint16_t value, uint16_t index,
+        void* data, uint16_t length, uint32_t* transferred)
+    {
+        uint8_t setup[8] {requestType, request,
+            static_cast<uint8_t>(value), static_cast<uint8_t>(value >> 8),
+            static_cast<uint8_t>(index), static_cast<uint8_t>(index >> 8),
+            static_cast<uint8_t>(length), static_cast<uint8_t>(length >> 8)};
+        bool in = requestType & 0x80;
+
+        HostResult result = DoTransfer(ControlOutChannel, setup, sizeof(setup), true, nullptr, DefaultTimeout);
+        if(result != HostResult::Ok)
+            return result;
+
+        if(length > 0)
+        {
+            uint8_t dataChannel = in ? ControlInChannel : ControlOutChannel;
+            _channels[dataChannel].Toggle = true;
+            result = DoTransfer(dataChannel, static_cast<uint8_t*>(data), length, false, transferred, DefaultTimeout);
+            if(result != HostResult::Ok)
+                return result;
+        }
+        else if(transferred != nullptr)
+        {
+            *transferred = 0;
+        }
+
+        // Status stage (zero length packet in opposite direction)
+        uint8_t statusChannel = (in && length > 0) ? ControlOutChannel : ControlInChannel;
+        _channels[statusChannel].Toggle = true;
+        return DoTransfer(statusChannel, nullptr, 0, false, nullptr, DefaultTimeout);
+    }
+
+    USB_HOST_TEMPLATE_ARGS
+    HostResult USB_HOST_TEMPLATE_QUALIFIER::Transfer(uint8_t channel, void* data, uint32_t size, uint32_t* transferred, uint16_t timeout)
+    {
+        return DoTransfer(channel, static_cast<uint8_t*>(data), size, false, transferred, timeout);
+    }
+
+    USB_HOST_TEMPLATE_ARGS
+    HostResult USB_HOST_TEMPLATE_QUALIFIER::ClearHalt(uint8_t channel)
+    {
+        // CLEAR_FEATURE(ENDPOINT_HALT)
+        HostResult result = ControlTransfer(0x02, static_cast<uint8_t>(StandartRequestCode::ClearFeature), 0, _channels[channel].Endpoint, nullptr, 0);
+        if(result == HostResult::Ok)
+            ResetToggle(channel);
+        return result;
+    }
+
+    USB_HOST_TEMPLATE_ARGS
+    USB_OTG_HostChannelTypeDef* USB_HOST_TEMPLATE_QUALIFIER::ChannelRegs(uint8_t channel)
+    {
+        return reinterpret_cast<USB_OTG_HostChannelTypeDef*>(reinterpret_cast<uintptr_t>(_Regs::Get())
+            + USB_OTG_HOST_CHANNEL_BASE + channel * USB_OTG_HOST_CHANNEL_SIZE);
+    }
+
+    USB_HOST_TEMPLATE_ARGS
+    volatile uint32_t& USB_HOST_TEMPLATE_QUALIFIER::PortReg()
+    {
+        return *reinterpret_cast<volatile uint32_t*>(reinterpret_cast<uintptr_t>(_Regs::Get()) + USB_OTG_HOST_PORT_BASE);
+    }
+
+    USB_HOST_TEMPLATE_ARGS
+    volatile uint32_t& USB_HOST_TEMPLATE_QUALIFIER::Fifo(uint8_t channel)
+    {
+        return *reinterpret_cast<volatile uint32_t*>(reinterpret_cast<uintptr_t>(_Regs::Get()) + USB_OTG_FIFO_BASE + channel * USB_OTG_FIFO_SIZE);
+    }
+
+    USB_HOST_TEMPLATE_ARGS
+    uint16_t USB_HOST_TEMPLATE_QUALIFIER::Frame()
+    {
+        return _HostRegs()->HFNUM & USB_OTG_HFNUM_FRNUM;
+    }
+
+    USB_HOST_TEMPLATE_ARGS
+    bool USB_HOST_TEMPLATE_QUALIFIER::Expired(uint16_t start, uint16_t timeout)
+    {
+        // Frame number is 14-bit counter
+        return ((Frame() - start) & 0x3fff) >= timeout;
+    }
+
+    USB_HOST_TEMPLATE_ARGS
+    void USB_HOST_TEMPLATE_QUALIFIER::WritePort(uint32_t set, uint32_t clear)
+    {
+        // PENA is cleared by writing one, change flags are cleared by writing them back
+        uint32_t port = PortReg() & ~(USB_OTG_HPRT_PENA | clear);
+        PortReg() = port | set;
+    }
+
+    USB_HOST_TEMPLATE_ARGS
+    bool USB_HOST_TEMPLATE_QUALIFIER::ResetPort()
+    {
+        for(uint8_t attempt = 0; attempt < 2; ++attempt)
+        {
+            WritePort(USB_OTG_HPRT_PRST, USB_OTG_HPRT_PCDET | USB_OTG_HPRT_PENCHNG | USB_OTG_HPRT_POCCHNG);
+            Zhele::delay_us<15000>();
+            WritePort(0, USB_OTG_HPRT_PRST | USB_OTG_HPRT_PCDET | USB_OTG_HPRT_PENCHNG | USB_OTG_HPRT_POCCHNG);
+
+            uint8_t timeout = 100;
+            while(!(PortReg() & USB_OTG_HPRT_PENA) && --timeout > 0)
+                Zhele::delay_us<1000>();
+            if(timeout == 0)
+                return false;
+
+            // PHY clock depends on device speed: reset port again after clock change
+            bool lowSpeed = ((PortReg() & USB_OTG_HPRT_PSPD) >> USB_OTG_HPRT_PSPD_Pos) == 2;
+            uint32_t clock = lowSpeed ? USB_OTG_HCFG_FSLSPCS_1 : USB_OTG_HCFG_FSLSPCS_0;
+            _lowSpeed = lowSpeed;
+            _HostRegs()->HFIR = lowSpeed ? 6000 : 48000;
+            if((_HostRegs()->HCFG & USB_OTG_HCFG_FSLSPCS) == clock)
+            {
+                // Reset recovery
+                Zhele::delay_us<20000>();
+                return true;
+            }
+            _HostRegs()->HCFG = (_HostRegs()->HCFG & ~USB_OTG_HCFG_FSLSPCS) | clock;
+        }
+        return false;
+    }
+
+    USB_HOST_TEMPLATE_ARGS
+    void USB_HOST_TEMPLATE_QUALIFIER::Disconnect()
+    {
+        for(uint8_t i = 0; i < _ChannelsCount; ++i)
+        {
+            Halt(i);
+            _channels[i].Used = i <= ControlInChannel;
+        }
+        _configurationSize = 0;
+        _address = 0;
+        _state = HostState::Disconnected;
+    }
+
+    USB_HOST_TEMPLATE_ARGS
+    bool USB_HOST_TEMPLATE_QUALIFIER::Enumerate()
+    {
+        _address = 0;
+        _configurationSize = 0;
+        _channels[ControlOutChannel] = {0x00, static_cast<uint8_t>(EndpointType::Control), 8, false, true};
+        _channels[ControlInChannel] = {0x80, static_cast<uint8_t>(EndpointType::Control), 8, false, true};
+        ConfigureChannel(ControlOutChannel);
+        ConfigureChannel(ControlInChannel);
+
+        const uint8_t getDescriptor = static_cast<uint8_t>(StandartRequestCode::GetDescriptor);
+        const uint16_t deviceDescriptor = static_cast<uint16_t>(DescriptorType::Device) << 8;
+        const uint16_t configurationDescriptor = static_cast<uint16_t>(DescriptorType::Configuration) << 8;
+
+        // Control endpoint max packet size is in first 8 bytes of device descriptor
+        if(ControlTransfer(0x80, getDescriptor, deviceDescriptor, 0, &_device, 8) != HostResult::Ok)
+            return false;
+        _channels[ControlOutChannel].MaxPacketSize = _device.MaxPacketSize;
+        _channels[ControlInChannel].MaxPacketSize = _device.MaxPacketSize;
+        ConfigureChannel(ControlOutChannel);
+        ConfigureChannel(ControlInChannel);
+
+        if(ControlTransfer(0x00, static_cast<uint8_t>(StandartRequestCode::SetAddress), DeviceAddress, 0, nullptr, 0) != HostResult::Ok)
+            return false;
+        Zhele::delay_us<2000>();
+        _address = DeviceAddress;
+        ConfigureChannel(ControlOutChannel);
+        ConfigureChannel(ControlInChannel);
+
+        if(ControlTransfer(0x80, getDescriptor, deviceDescriptor, 0, &_device, sizeof(_device)) != HostResult::Ok)
+            return false;
+
+        uint32_t size = 0;
+        if(ControlTransfer(0x80, getDescriptor, configurationDescriptor, 0, _configuration, sizeof(ConfigurationDescriptor), &size) != HostResult::Ok
+            || size < sizeof(ConfigurationDescriptor))
+        {
+            return false;
+        }
+        uint16_t totalLength = _configuration[2] | (_configuration[3] << 8);
+        if(totalLength > _ConfigurationSize)
+            totalLength = _ConfigurationSize;
+        if(ControlTransfer(0x80, getDescriptor, configurationDescriptor, 0, _configuration, totalLength, &size) != HostResult::Ok)
+            return false;
+        _configurationSize = size;
+
+        return ControlTransfer(0x00, static_cast<uint8_t>(StandartRequestCode::SetConfiguration), _configuration[5], 0, nullptr, 0) == HostResult::Ok;
+    }
+
+    USB_HOST_TEMPLATE_ARGS
+    void USB_HOST_TEMPLATE_QUALIFIER::ConfigureChannel(uint8_t channel)
+    {
+        const Channel& state = _channels[channel];
+        ChannelRegs(channel)->HCINT = 0xffffffff;
+        ChannelRegs(channel)->HCCHAR = (state.MaxPacketSize & USB_OTG_HCCHAR_MPSIZ)
+            | ((state.Endpoint & 0x0f) << USB_OTG_HCCHAR_EPNUM_Pos)
+            | ((state.Endpoint & 0x80) ? USB_OTG_HCCHAR_EPDIR : 0)
+            | (_lowSpeed ? USB_OTG_HCCHAR_LSDEV : 0)
+            | (static_cast<uint32_t>(state.Type) << USB_OTG_HCCHAR_EPTYP_Pos)
+            | (1 << USB_OTG_HCCHAR_MC_Pos)
+            | (static_cast<uint32_t>(_address) << USB_OTG_HCCHAR_DAD_Pos);
+    }
+
+    USB_HOST_TEMPLATE_ARGS
+    HostResult USB_HOST_TEMPLATE_QUALIFIER::DoTransfer(uint8_t channel, uint8_t* data, uint32_t size, bool setup, uint32_t* transferred, uint16_t timeout)
+    {
+        if(!Connected())
+            return HostResult::Disconnected;
+
+        if(_channels[channel].Endpoint & 0x80)
+            return TransferIn(channel, data, size, transferred, timeout);
+
+        HostResult result = TransferOut(channel, data, size, setup, timeout);
+        if(transferred != nullptr)
+            *transferred = result == HostResult::Ok ? size : 0;
+        return result;
+    }
+
+    USB_HOST_TEMPLATE_ARGS
+    HostResult USB_HOST_TEMPLATE_QUALIFIER::TransferIn(uint8_t channel, uint8_t* data, uint32_t size, uint32_t* transferred, uint16_t timeout)
+    {
+        // Packet counter is 10-bit, so long transfer is split
+        static const uint32_t MaxPackets = 256;
+
+        Channel& state = _channels[channel];
+        USB_OTG_HostChannelTypeDef* regs = ChannelRegs(channel);
+        uint32_t received = 0;
+        uint16_t start = Frame();
+        uint8_t errors = 0;
+        HostResult result = HostResult::Ok;
+
+        do
+        {
+            uint32_t packets = (size - received + state.MaxPacketSize - 1) / state.MaxPacketSize;
+            if(packets == 0)
+                packets = 1;
+            if(packets > MaxPackets)
+                packets = MaxPackets;
+            const uint32_t chunk = packets * state.MaxPacketSize;
+            uint32_t chunkReceived = 0;
+            uint32_t packetsReceived = 0;
+            bool shortPacket = false;
+
+            regs->HCINT = 0xffffffff;
+            regs->HCTSIZ = (chunk & USB_OTG_HCTSIZ_XFRSIZ)
+                | (packets << USB_OTG_HCTSIZ_PKTCNT_Pos)
+                | ((state.Toggle ? 2u : 0u) << USB_OTG_HCTSIZ_DPID_Pos);
+            uint32_t control = (regs->HCCHAR & ~(USB_OTG_HCCHAR_CHDIS | USB_OTG_HCCHAR_ODDFRM)) | USB_OTG_HCCHAR_CHENA;
+            if(state.Type == static_cast<uint8_t>(EndpointType::Interrupt) && (Frame() & 0x01) == 0)
+                control |= USB_OTG_HCCHAR_ODDFRM;
+            regs->HCCHAR = control;
+
+            for(;;)
+            {
+                if(_Regs()->GINTSTS & USB_OTG_GINTSTS_RXFLVL)
+                {
+                    uint32_t space = size - received - chunkReceived;
+                    uint16_t count = ReadRxFifo(channel, data != nullptr ? data + received + chunkReceived : nullptr, space);
+                    if(count != 0xffff)
+                    {
+                        chunkReceived += count;
+                        ++packetsReceived;
+                        shortPacket = count < state.MaxPacketSize;
+                        // Next packet of transfer is requested after FIFO read
+                        if(!shortPacket && (regs->HCTSIZ & USB_OTG_HCTSIZ_PKTCNT) != 0)
+                            regs->HCCHAR = (regs->HCCHAR & ~USB_OTG_HCCHAR_CHDIS) | USB_OTG_HCCHAR_CHENA;
+                    }
+                }
+
+                uint32_t interrupts = regs->HCINT;
+                if(interrupts & USB_OTG_HCINT_XFRC)
+                {
+                    result = HostResult::Ok;
+                    break;
+                }
+                if(interrupts & USB_OTG_HCINT_STALL)
+                {
+                    result = HostResult::Stall;
+                    break;
+                }
+                if(interrupts & (USB_OTG_HCINT_TXERR | USB_OTG_HCINT_BBERR | USB_OTG_HCINT_DTERR | USB_OTG_HCINT_FRMOR))
+                {
+                    regs->HCINT = USB_OTG_HCINT_TXERR | USB_OTG_HCINT_BBERR | USB_OTG_HCINT_DTERR | USB_OTG_HCINT_FRMOR;
+                    if(++errors >= 3)
+                    {
+                        result = HostResult::Error;
+                        break;
+                    }
+                    regs->HCCHAR = (regs->HCCHAR & ~USB_OTG_HCCHAR_CHDIS) | USB_OTG_HCCHAR_CHENA;
+                }
+                if(interrupts & USB_OTG_HCINT_NAK)
+                {
+                    regs->HCINT = USB_OTG_HCINT_NAK;
+                    regs->HCCHAR = (regs->HCCHAR & ~USB_OTG_HCCHAR_CHDIS) | USB_OTG_HCCHAR_CHENA;
+                }
+                if(interrupts & USB_OTG_HCINT_ACK)
+                {
+                    regs->HCINT = USB_OTG_HCINT_ACK;
+                    errors = 0;
+                }
+                if(!Connected())
+                {
+                    result = HostResult::Disconnected;
+                    break;
+                }
+                if(Expired(start, timeout))
+                {
+                    result = HostResult::Timeout;
+                    break;
+                }
+            }
+
+            Halt(channel);
+            if(packetsReceived & 0x01)
+                state.Toggle = !state.Toggle;
+            received += chunkReceived;
+
+            if(shortPacket || result != HostResult::Ok)
+                break;
+        }
+        while(received < size);
+
+        if(transferred != nullptr)
+            *transferred = received > size ? size : received;
+        return result;
+    }
+
+    USB_HOST_TEMPLATE_ARGS
+    HostResult USB_HOST_TEMPLATE_QUALIFIER::TransferOut(uint8_t channel, const uint8_t* data, uint32_t size, bool setup, uint16_t timeout)
+    {
+        Channel& state = _channels[channel];
+        USB_OTG_HostChannelTypeDef* regs = ChannelRegs(channel);
+        const bool periodic = state.Type == static_cast<uint8_t>(EndpointType::Interrupt);
+        uint32_t sent = 0;
+        uint16_t start = Frame();
+        uint8_t errors = 0;
+
+        // Packet is sent by one channel enable: NAKed packet is sent again
+        do
+        {
+            uint16_t length = size - sent < state.MaxPacketSize ? size - sent : state.MaxPacketSize;
+            uint32_t pid = setup ? 3u : (state.Toggle ? 2u : 0u);
+
+            regs->HCINT = 0xffffffff;
+            regs->HCTSIZ = length | (1 << USB_OTG_HCTSIZ_PKTCNT_Pos) | (pid << USB_OTG_HCTSIZ_DPID_Pos);
+            uint32_t control = (regs->HCCHAR & ~(USB_OTG_HCCHAR_CHDIS | USB_OTG_HCCHAR_ODDFRM)) | USB_OTG_HCCHAR_CHENA;
+            if(periodic && (Frame() & 0x01) == 0)
+                control |= USB_OTG_HCCHAR_ODDFRM;
+            regs->HCCHAR = control;
+
+            const uint16_t words = (length + 3) / 4;
+            if(words > 0)
+            {
+                for(;;)
+                {
+                    uint32_t status = periodic ? _HostRegs()->HPTXSTS : _Regs()->HNPTXSTS;
+                    if((status & 0xffff) >= words && (status & 0xff0000) != 0)
+                        break;
+                    if(!Connected() || Expired(start, timeout))
+                    {
+                        Halt(channel);
+                        return Connected() ? HostResult::Timeout : HostResult::Disconnected;
+                    }
+                }
+                for(uint16_t i = 0; i < words; ++i)
+                {
+                    uint32_t word = 0;
+                    memcpy(&word, data + sent + i * 4, (length - i * 4) < 4 ? (length - i * 4) : 4);
+                    Fifo(channel) = word;
+                }
+            }
+
+            HostResult result;
+            for(;;)
+            {
+                uint32_t interrupts = regs->HCINT;
+                if(interrupts & (USB_OTG_HCINT_XFRC | USB_OTG_HCINT_ACK))
+                {
+                    result = HostResult::Ok;
+                    break;
+                }
+                if(interrupts & USB_OTG_HCINT_STALL)
+                {
+                    result = HostResult::Stall;
+                    break;
+                }
+                if(interrupts & (USB_OTG_HCINT_NAK | USB_OTG_HCINT_NYET))
+                {
+                    result = HostResult::Timeout;
+                    break;
+                }
+                if(interrupts & (USB_OTG_HCINT_TXERR | USB_OTG_HCINT_FRMOR))
+                {
+                    result = HostResult::Error;
+                    break;
+                }
+                if(!Connected())
+                {
+                    result = HostResult::Disconnected;
+                    break;
+                }
+                if(Expired(start, timeout))
+                {
+                    Halt(channel);
+                    return HostResult::Timeout;
+                }
+            }
+            Halt(channel);
+
+            if(result == HostResult::Ok)
+            {
+                errors = 0;
+                sent += length;
+                if(!setup)
+                    state.Toggle = !state.Toggle;
+            }
+            else if(result == HostResult::Error)
+            {
+                if(++errors >= 3)
+                    return result;
+            }
+            else if(result != HostResult::Timeout || Expired(start, timeout))
+            {
+                return result;
+            }
+        }
+        while(sent < size);
+
+        return HostResult::Ok;
+    }
+
+    USB_HOST_TEMPLATE_ARGS
+    void USB_HOST_TEMPLATE_QUALIFIER::Halt(uint8_t channel)
+    {
+        USB_OTG_HostChannelTypeDef* regs = ChannelRegs(channel);
+        if(regs->HCCHAR & USB_OTG_HCCHAR_CHENA)
+        {
+            regs->HCCHAR |= USB_OTG_HCCHAR_CHDIS | USB_OTG_HCCHAR_CHENA;
+            // Channel halts after current transaction: status entries of RX FIFO are drained meanwhile
+            for(uint32_t timeout = 100000; timeout > 0 && !(regs->HCINT & USB_OTG_HCINT_CHH); --timeout)
+            {
+                if(_Regs()->GINTSTS & USB_OTG_GINTSTS_RXFLVL)
+                    ReadRxFifo(channel, nullptr, 0);
+            }
+        }
+        regs->HCINT = 0xffffffff;
+    }
+
+    USB_HOST_TEMPLATE_ARGS
+    uint16_t USB_HOST_TEMPLATE_QUALIFIER::ReadRxFifo(uint8_t channel, uint8_t* data, uint32_t space)
+    {
+        static const uint32_t InDataPacket = 2;
+
+        uint32_t status = _Regs()->GRXSTSP;
+        uint16_t count = (status & USB_OTG_GRXSTSP_BCNT) >> USB_OTG_GRXSTSP_BCNT_Pos;
+        bool packet = ((status & USB_OTG_GRXSTSP_PKTSTS) >> USB_OTG_GRXSTSP_PKTSTS_Pos) == InDataPacket;
+
+        // Bytes that do not fit buffer are dropped
+        uint32_t copy = count < space ? count : space;
+        for(uint16_t i = 0; i < count; i += 4)
+        {
+            uint32_t word = Fifo(0);
+            if(data != nullptr && i < copy)
+                memcpy(data + i, &word, copy - i < 4 ? copy - i : 4);
+        }
+
+        // Only data packets of current channel are counted
+        return packet && (status & USB_OTG_GRXSTSP_EPNUM) == channel ? count : 0xffff;
+    }
+}
+
+#endif //! ZHELE_USB_HOST_IMPL_H
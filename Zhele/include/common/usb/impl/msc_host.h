@@ -0,0 +1,282 @@
+/**
+ * @file
+ * USB MSC host class methods implementation
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_USB_MSC_HOST_IMPL_H
+#define ZHELE_USB_MSC_HOST_IMPL_H
+
+#include <string.h>
+
+namespace Zhele::Usb
+{
+    #define USB_MSC_HOST_TEMPLATE_ARGS template<typename _Host, uint16_t _Timeout>
+    #define USB_MSC_HOST_TEMPLATE_QUALIFIER MscHost<_Host, _Timeout>
+
+    USB_MSC_HOST_TEMPLATE_ARGS
+    uint32_t USB_MSC_HOST_TEMPLATE_QUALIFIER::_blocksCount = 0;
+    USB_MSC_HOST_TEMPLATE_ARGS
+    uint32_t USB_MSC_HOST_TEMPLATE_QUALIFIER::_blockSize = 0;
+    USB_MSC_HOST_TEMPLATE_ARGS
+    uint32_t USB_MSC_HOST_TEMPLATE_QUALIFIER::_tag = 0;
+    USB_MSC_HOST_TEMPLATE_ARGS
+    uint8_t USB_MSC_HOST_TEMPLATE_QUALIFIER::_interface = 0;
+    USB_MSC_HOST_TEMPLATE_ARGS
+    int8_t USB_MSC_HOST_TEMPLATE_QUALIFIER::_inChannel = -1;
+    USB_MSC_HOST_TEMPLATE_ARGS
+    int8_t USB_MSC_HOST_TEMPLATE_QUALIFIER::_outChannel = -1;
+    USB_MSC_HOST_TEMPLATE_ARGS
+    bool USB_MSC_HOST_TEMPLATE_QUALIFIER::_attached = false;
+    USB_MSC_HOST_TEMPLATE_ARGS
+    bool USB_MSC_HOST_TEMPLATE_QUALIFIER::_ready = false;
+
+    USB_MSC_HOST_TEMPLATE_ARGS
+    bool USB_MSC_HOST_TEMPLATE_QUALIFIER::Process()
+    {
+        if(_Host::Process() != HostState::Configured)
+        {
+            if(_attached)
+                Detach();
+            return false;
+        }
+
+        if(!_attached && !Attach())
+            return false;
+
+        // Medium may become ready some time after enumeration, so poll it once per call
+        if(!_ready)
+            _ready = TestUnitReady() && ReadCapacity();
+        return _ready;
+    }
+
+    USB_MSC_HOST_TEMPLATE_ARGS
+    bool USB_MSC_HOST_TEMPLATE_QUALIFIER::CheckStatus()
+    {
+        return _ready;
+    }
+
+    USB_MSC_HOST_TEMPLATE_ARGS
+    uint32_t USB_MSC_HOST_TEMPLATE_QUALIFIER::BlocksCount()
+    {
+        return _blocksCount;
+    }
+
+    USB_MSC_HOST_TEMPLATE_ARGS
+    size_t USB_MSC_HOST_TEMPLATE_QUALIFIER::BlockSize()
+    {
+        return _blockSize;
+    }
+
+    USB_MSC_HOST_TEMPLATE_ARGS
+    bool USB_MSC_HOST_TEMPLATE_QUALIFIER::ReadBlock(uint8_t* data, uint32_t block)
+    {
+        return ReadMultipleBlock(data, block, 1);
+    }
+
+    USB_MSC_HOST_TEMPLATE_ARGS
+    bool USB_MSC_HOST_TEMPLATE_QUALIFIER::ReadMultipleBlock(uint8_t* data, uint32_t block, uint32_t count)
+    {
+        return ReadWrite(static_cast<uint8_t>(ScsiCommand::Read10), data, block, count);
+    }
+
+    USB_MSC_HOST_TEMPLATE_ARGS
+    bool USB_MSC_HOST_TEMPLATE_QUALIFIER::WriteBlock(const uint8_t* data, uint32_t block)
+    {
+        return WriteMultipleBlock(data, block, 1);
+    }
+
+    USB_MSC_HOST_TEMPLATE_ARGS
+    bool USB_MSC_HOST_TEMPLATE_QUALIFIER::WriteMultipleBlock(const uint8_t* data, uint32_t block, uint32_t count)
+    {
+        return ReadWrite(static_cast<uint8_t>(ScsiCommand::Write10), const_cast<uint8_t*>(data), block, count);
+    }
+
+    USB_MSC_HOST_TEMPLATE_ARGS
+    bool USB_MSC_HOST_TEMPLATE_QUALIFIER::Erase([[maybe_unused]] uint32_t firstBlock, [[maybe_unused]] uint32_t lastBlock)
+    {
+        return _ready;
+    }
+
+    USB_MSC_HOST_TEMPLATE_ARGS
+    bool USB_MSC_HOST_TEMPLATE_QUALIFIER::Sync()
+    {
+        if(!_ready)
+            return false;
+
+        uint8_t command[10] = {static_cast<uint8_t>(ScsiCommand::SynchronizeCache)};
+        // Drives without cache may fail command, it is not an error
+        return Command(command, sizeof(command), nullptr, 0, false) != BulkOnlyCSW::CswStatus::PhaseError;
+    }
+
+    USB_MSC_HOST_TEMPLATE_ARGS
+    bool USB_MSC_HOST_TEMPLATE_QUALIFIER::Attach()
+    {
+        const InterfaceDescriptor* interface = _Host::FindInterface(DeviceAndInterfaceClass::Storage, 0xff, static_cast<uint8_t>(MscProtocol::Bbb));
+        const EndpointDescriptor* in = _Host::FindEndpoint(interface, EndpointDirection::In, EndpointType::Bulk);
+        const EndpointDescriptor* out = _Host::FindEndpoint(interface, EndpointDirection::Out, EndpointType::Bulk);
+        if(in == nullptr || out == nullptr)
+            return false;
+
+        _inChannel = _Host::AllocateChannel();
+        _outChannel = _Host::AllocateChannel();
+        if(_inChannel < 0 || _outChannel < 0)
+        {
+            if(_inChannel >= 0)
+                _Host::FreeChannel(_inChannel);
+            if(_outChannel >= 0)
+                _Host::FreeChannel(_outChannel);
+            _inChannel = _outChannel = -1;
+            return false;
+        }
+        _Host::OpenChannel(_inChannel, *in);
+        _Host::OpenChannel(_outChannel, *out);
+        _interface = interface->Number;
+
+        // Single LUN devices may stall GET_MAX_LUN, only LUN 0 is used anyway
+        uint8_t maxLun = 0;
+        _Host::ControlTransfer(0xa1, static_cast<uint8_t>(MscRequest::GetMaxLun), 0, _interface, &maxLun, 1);
+
+        _attached = true;
+        _ready = false;
+        return true;
+    }
+
+    USB_MSC_HOST_TEMPLATE_ARGS
+    void USB_MSC_HOST_TEMPLATE_QUALIFIER::Detach()
+    {
+        // Host has already released channels on disconnection
+        _inChannel = _outChannel = -1;
+        _attached = false;
+        _ready = false;
+        _blocksCount = 0;
+        _blockSize = 0;
+    }
+
+    USB_MSC_HOST_TEMPLATE_ARGS
+    BulkOnlyCSW::CswStatus USB_MSC_HOST_TEMPLATE_QUALIFIER::Command(const uint8_t* command, uint8_t length, void* data, uint32_t size, bool in)
+    {
+        BulkOnlyCBW cbw{};
+        cbw.Signature = 0x43425355;
+        cbw.Tag = ++_tag;
+        cbw.DataLength = size;
+        cbw.Flags = in ? 0x80 : 0x00;
+        cbw.Lun = 0;
+        cbw.CommandBlockLength = length;
+        memcpy(cbw.CommandBlock, command, length);
+
+        if(_Host::Transfer(_outChannel, &cbw, sizeof(cbw)) != HostResult::Ok)
+        {
+            ResetRecovery();
+            return BulkOnlyCSW::CswStatus::PhaseError;
+        }
+
+        if(size > 0)
+        {
+            uint8_t channel = in ? _inChannel : _outChannel;
+            HostResult result = _Host::Transfer(channel, data, size, nullptr, _Timeout);
+            // Device stalls data endpoint on error, status is still sent
+            if(result == HostResult::Stall)
+            {
+                _Host::ClearHalt(channel);
+            }
+            else if(result != HostResult::Ok)
+            {
+                ResetRecovery();
+                return BulkOnlyCSW::CswStatus::PhaseError;
+            }
+        }
+
+        BulkOnlyCSW csw;
+        uint32_t received = 0;
+        HostResult result = _Host::Transfer(_inChannel, &csw, sizeof(csw), &received, _Timeout);
+        if(result == HostResult::Stall)
+        {
+            _Host::ClearHalt(_inChannel);
+            result = _Host::Transfer(_inChannel, &csw, sizeof(csw), &received, _Timeout);
+        }
+
+        if(result != HostResult::Ok || received != sizeof(csw) || csw.Signature != 0x53425355
+            || csw.Tag != cbw.Tag || csw.Status == BulkOnlyCSW::CswStatus::PhaseError)
+        {
+            ResetRecovery();
+            return BulkOnlyCSW::CswStatus::PhaseError;
+        }
+        return csw.Status;
+    }
+
+    USB_MSC_HOST_TEMPLATE_ARGS
+    void USB_MSC_HOST_TEMPLATE_QUALIFIER::ResetRecovery()
+    {
+        if(!_Host::Connected())
+            return;
+
+        // Bulk-Only Mass Storage Reset and CLEAR_FEATURE(ENDPOINT_HALT) for both endpoints
+        _Host::ControlTransfer(0x21, static_cast<uint8_t>(MscRequest::Bomsr), 0, _interface, nullptr, 0);
+        _Host::ClearHalt(_inChannel);
+        _Host::ClearHalt(_outChannel);
+    }
+
+    USB_MSC_HOST_TEMPLATE_ARGS
+    bool USB_MSC_HOST_TEMPLATE_QUALIFIER::TestUnitReady()
+    {
+        uint8_t command[6] = {static_cast<uint8_t>(ScsiCommand::TestUnitReady)};
+        BulkOnlyCSW::CswStatus status = Command(command, sizeof(command), nullptr, 0, false);
+        if(status == BulkOnlyCSW::CswStatus::Failed)
+        {
+            // Sense data should be read to clear unit attention (medium changed, power on)
+            uint8_t sense[18];
+            uint8_t requestSense[6] = {static_cast<uint8_t>(ScsiCommand::RequestSense), 0, 0, 0, sizeof(sense), 0};
+            Command(requestSense, sizeof(requestSense), sense, sizeof(sense), true);
+        }
+        return status == BulkOnlyCSW::CswStatus::Passed;
+    }
+
+    USB_MSC_HOST_TEMPLATE_ARGS
+    bool USB_MSC_HOST_TEMPLATE_QUALIFIER::ReadCapacity()
+    {
+        uint8_t command[10] = {static_cast<uint8_t>(ScsiCommand::ReadCapacity)};
+        uint8_t response[8];
+        if(Command(command, sizeof(command), response, sizeof(response), true) != BulkOnlyCSW::CswStatus::Passed)
+            return false;
+
+        // Response: last block address and block size (big endian)
+        uint32_t lastBlock = (response[0] << 24) | (response[1] << 16) | (response[2] << 8) | response[3];
+        _blockSize = (response[4] << 24) | (response[5] << 16) | (response[6] << 8) | response[7];
+        _blocksCount = lastBlock + 1;
+        return _blockSize != 0;
+    }
+
+    USB_MSC_HOST_TEMPLATE_ARGS
+    bool USB_MSC_HOST_TEMPLATE_QUALIFIER::ReadWrite(uint8_t opcode, uint8_t* data, uint32_t block, uint32_t count)
+    {
+        if(!_ready)
+            return false;
+
+        while(count > 0)
+        {
+            // READ/WRITE (10) transfer length is 16-bit
+            uint16_t blocks = count > 0xffff ? 0xffff : count;
+            uint8_t command[10] = {
+                opcode, 0,
+                static_cast<uint8_t>(block >> 24), static_cast<uint8_t>(block >> 16), static_cast<uint8_t>(block >> 8), static_cast<uint8_t>(block),
+                0,
+                static_cast<uint8_t>(blocks >> 8), static_cast<uint8_t>(blocks),
+                0
+            };
+            uint32_t size = blocks * _blockSize;
+            if(Command(command, sizeof(command), data, size, opcode == static_cast<uint8_t>(ScsiCommand::Read10)) != BulkOnlyCSW::CswStatus::Passed)
+                return false;
+
+            data += size;
+            block += blocks;
+            count -= blocks;
+        }
+        return true;
+    }
+}
+
+#endif //! ZHELE_USB_MSC_HOST_IMPL_H
@@ -36,6 +36,23 @@ namespace Zhele::Usb
     };
 #pragma pack(pop)
 
+    /**
+     * @brief Interface association descriptor (groups interfaces of one function)
+     */
+#pragma pack(push, 1)
+    struct InterfaceAssociationDescriptor
+    {
+        uint8_t Length = 8; ///< Length (always 8)
+        DescriptorType Type = DescriptorType::InterfaceAssociation; ///< Descriptor type (always 0x0b)
+        uint8_t FirstInterface; ///< First interface number
+        uint8_t InterfacesCount; ///< Count of contiguous interfaces
+        DeviceAndInterfaceClass Class; ///< Function class
+        uint8_t SubClass = 0; ///< Function subclass
+        uint8_t Protocol = 0; ///< Function protocol
+        uint8_t StringIndex = 0; ///< Function string ID
+    };
+#pragma pack(pop)
+
     /**
      * @brief Implements interface
      * 
@@ -69,30 +86,35 @@ namespace Zhele::Usb
         }
 
         /**
-         * @brief Fills descriptor
+         * @brief Deactivate interface (disable endpoints)
          * 
-         * @param [out] descriptor Destination memory
+         * @details
+         * Called when interface leaves active configuration
+         * (or alternate setting without endpoints is selected).
          * 
          * @par Returns
          *  Nothing
          */
-        static uint16_t FillDescriptor(InterfaceDescriptor* descriptor)
+        static void Deactivate()
         {
-            uint16_t totalLength = sizeof(InterfaceDescriptor);
+            (DeactivateEndpoint<_Endpoints>(), ...);
+        }
 
-            *descriptor = InterfaceDescriptor {
+        /**
+         * @brief Returns descriptor
+         * 
+         * @returns Descriptor bytes (interface descriptor with endpoints descriptors)
+         */
+        static constexpr auto Descriptor()
+        {
+            return ConcatDescriptors(DescriptorBytes(InterfaceDescriptor {
                 .Number = _Number,
                 .AlternateSetting = _AlternateSetting,
                 .EndpointsCount = EndpointsCount,
                 .Class = _Class,
                 .SubClass = _SubClass,
                 .Protocol = _Protocol
-            };
-            
-            uint8_t* endpointsDescriptors = reinterpret_cast<uint8_t*>(descriptor);
-            ((totalLength += _Endpoints::FillDescriptor(reinterpret_cast<EndpointDescriptor*>(&endpointsDescriptors[totalLength]))), ...);
-
-            return totalLength;
+            }), _Endpoints::Descriptor()...);
         }
 
         /**
@@ -102,33 +124,26 @@ namespace Zhele::Usb
          *  Nothing
          */
         static void SetupHandler();
+
+    private:
+        template<typename _Endpoint>
+        static void DeactivateEndpoint()
+        {
+            if constexpr (_Endpoint::Direction != EndpointDirection::In)
+            {
+                _Endpoint::SetRxStatus(EndpointStatus::Disable);
+            }
+            if constexpr (_Endpoint::Direction != EndpointDirection::Out)
+            {
+                _Endpoint::SetTxStatus(EndpointStatus::Disable);
+            }
+        }
     };
 
     /**
      * @brief Interface transfer complete callback.
      */
     using InterfaceSetupRequestHandler = std::add_pointer_t<void()>;
-    /**
-     * @brief Implements Interface`s handlers management.
-     * 
-     * @tparam Interfaces Unique sorted Interfaces.
-     * @tparam Indexes Handlers indexes.
-     */
-    
-    template<typename...>
-    class InterfaceHandlersBase;
-    template<typename... Interfaces, int8_t... Indexes>
-    class InterfaceHandlersBase<Zhele::TemplateUtils::TypeList<Interfaces...>, Zhele::TemplateUtils::Int8_tArray<Indexes...>>
-    {
-    public:
-        static constexpr InterfaceSetupRequestHandler _handlers[] = {Interfaces::SetupHandler...};
-        static constexpr int8_t _handlersIndexes[] = {Indexes...};
-    public:
-        inline static void HandleSetupRequest(uint8_t number)
-        {
-            _handlers[_handlersIndexes[number]]();
-        }
-    };
 
     /**
      * @brief Sort interfaces by number and direction
@@ -146,52 +161,56 @@ namespace Zhele::Usb
     template<typename Interfaces>
     using SortedUniqueInterfaces = InterfacesSortedByNumber<typename Zhele::TemplateUtils::Unique<Interfaces>::type>;
 
+    template<typename Interfaces>
+    const int8_t MaxInterfaceNumber = Zhele::TemplateUtils::GetType<Zhele::TemplateUtils::Length<SortedUniqueInterfaces<Interfaces>>::value - 1, SortedUniqueInterfaces<Interfaces>>::type::Number;
+
     /**
-     * @brief Predicate for search interface by number
+     * @brief Implements Interface`s handlers management.
+     * 
+     * @details
+     * Handlers table is built at compile time and indexed by interface number.
+     * If several interfaces have same number, requests are handled by first of them (in sorted list).
      * 
-     * @tparam Number Interface number
+     * @tparam Interfaces Unique sorted Interfaces.
      */
-    template<uint8_t Number>
-    class IsInterfaceWithNumber
+    template<typename...>
+    class InterfaceHandlersBase;
+    template<typename... Interfaces>
+    class InterfaceHandlersBase<Zhele::TemplateUtils::TypeList<Interfaces...>>
     {
-    public:
-        template<typename Interface>
-        class type
+        static const uint8_t HandlersCount = MaxInterfaceNumber<Zhele::TemplateUtils::TypeList<Interfaces...>> + 1;
+
+        static consteval std::array<InterfaceSetupRequestHandler, HandlersCount> BuildHandlers()
         {
-        public:
-            static const bool value = Interface::Number == Number;
-        };
-    };
+            std::array<InterfaceSetupRequestHandler, HandlersCount> handlers {};
+            ((handlers[Interfaces::Number] = handlers[Interfaces::Number] != nullptr ? handlers[Interfaces::Number] : Interfaces::SetupHandler), ...);
+            return handlers;
+        }
 
-    /**
-     * @brief Implements interface`s handlers indexes management.
-     * 
-     * @tparam Index Handler index.
-     * @tparam Interfaces Unique sorted interfaces.
-     */
-    template<int8_t Index, typename Interfaces>
-    class InterfaceHandlersIndexes
-    {
-        using Predicate = IsInterfaceWithNumber<Index>;
-        static const int8_t InterfaceIndex = Zhele::TemplateUtils::Search<Predicate::template type, Interfaces>::value;
+        static constexpr std::array<InterfaceSetupRequestHandler, HandlersCount> _handlers = BuildHandlers();
     public:
-        using type = typename Zhele::TemplateUtils::Int8_tArray_InsertBack<typename InterfaceHandlersIndexes<Index - 1, Interfaces>::type, InterfaceIndex>::type;
-    };
-    template<typename Interfaces>
-    class InterfaceHandlersIndexes<-1, Interfaces>
-    {
-    public:
-        using type = Zhele::TemplateUtils::Int8_tArray<>;
-    };
+        /**
+         * @brief Call interface setup request handler
+         * 
+         * @param [in] number Interface number
+         * 
+         * @retval true Request is handled
+         * @retval false There is no interface with given number
+         */
+        inline static bool HandleSetupRequest(uint8_t number)
+        {
+            if(number >= HandlersCount || _handlers[number] == nullptr)
+                return false;
 
-    template<typename Interfaces>
-    const int8_t MaxInterfaceNumber = Zhele::TemplateUtils::GetType<Zhele::TemplateUtils::Length<SortedUniqueInterfaces<Interfaces>>::value - 1, SortedUniqueInterfaces<Interfaces>>::type::Number;
+            _handlers[number]();
+            return true;
+        }
+    };
 
     /**
      * @brief Interface`s handlers.
      */
     template<typename Interfaces>
-    using InterfaceHandlers = InterfaceHandlersBase<SortedUniqueInterfaces<Interfaces>,
-        typename InterfaceHandlersIndexes<MaxInterfaceNumber<Interfaces> + 1, SortedUniqueInterfaces<Interfaces>>::type>;
+    using InterfaceHandlers = InterfaceHandlersBase<SortedUniqueInterfaces<Interfaces>>;
 }
 #endif // ZHELE_USB_INTERFACE_H
\ No newline at end of file
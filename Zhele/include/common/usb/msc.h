@@ -14,6 +14,10 @@
 
 #include "../template_utils/type_list.h"
 
+#include <array>
+#include <concepts>
+#include <string.h>
+
 namespace Zhele::Usb
 {
     /// Mass storage class subclass
@@ -87,9 +91,16 @@ namespace Zhele::Usb
         Inquiry = 0x12, ///< Inquiry
         ModeSense6 = 0x1a, ///< Mode sense 6
         SendDiagnistic = 0x1d, ///< Send diagnostic
-        ReadCapacity = 0x25, ///< Read capacity
+        ReadCapacity = 0x25, ///< Read capacity (10)
         Read10 = 0x28, ///< Read 10 bytes
         Write10 = 0x2a, ///< Write 10 bytes
+        SynchronizeCache = 0x35, ///< Synchronize cache (10)
+        Read16 = 0x88, ///< Read 16 bytes
+        Write16 = 0x8a, ///< Write 16 bytes
+        SynchronizeCache16 = 0x91, ///< Synchronize cache (16)
+        ServiceActionIn16 = 0x9e, ///< Service action in (16) (READ CAPACITY (16) with service action 10h)
+        Read12 = 0xa8, ///< Read 12 bytes
+        Write12 = 0xaa, ///< Write 12 bytes
 
         MmcStartStopUnit = 0x1b,
         MmcPreventAllowRemoval = 0x1e,
@@ -134,6 +145,21 @@ namespace Zhele::Usb
         0x00	// Byte 17: SenseKeySpecific[0] = 0
     };
 
+    static const uint8_t sense_not_ready_response[18] = {
+        0x70,	// Byte 0: VALID = 0, Response Code = 112
+        0x00,	// Byte 1: Obsolete = 0
+        0x02,	// Byte 2: Sense Key = 2 (Not ready)
+        0, 0, 0, 0,
+        0x0a,	// Byte 7: Additional Sense Length = 10
+        0, 0, 0, 0,
+        0x3a,	// Byte 12: Additional Sense Code (ASC) = 3Ah (Medium not present)
+        0x00,	// Byte 13: Additional Sense Code Qualifier (ASCQ) = 0
+        0x00,	// Byte 14: Field Replaceable Unit Code (FRUC) = 0
+        0x00,	// Byte 15: SKSV = 0, SenseKeySpecific[0] = 0
+        0x00,	// Byte 16: SenseKeySpecific[0] = 0
+        0x00	// Byte 17: SenseKeySpecific[0] = 0
+    };
+
     static const uint8_t inquiry_response[] = {
         0x00,	// Byte 0: Peripheral Qualifier = 0, Peripheral Device Type = 0
         0x80,	// Byte 1: RMB = 1, Reserved = 0
@@ -173,19 +199,120 @@ namespace Zhele::Usb
             if constexpr (sizeof(value) == 4)
                 return ((value & 0xff) << 24) | ((value & 0xff00) << 8) | ((value & 0xff0000) >> 8) | ((value >> 24) & 0xff);
         }
+
+        /**
+         * @brief Read big-endian value from command block (without alignment requirements)
+         * 
+         * @tparam T Value type
+         * 
+         * @param data Value bytes
+         * 
+         * @returns Value
+         */
+        template<typename T>
+        inline constexpr static T ReadBe(const uint8_t* data)
+        {
+            T value = 0;
+            for(unsigned i = 0; i < sizeof(T); ++i)
+                value = (value << 8) | data[i];
+            return value;
+        }
+
+        /**
+         * @brief Write big-endian value to response
+         * 
+         * @tparam T Value type
+         * 
+         * @param data Destination
+         * @param value Value
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        template<typename T>
+        inline constexpr static void WriteBe(uint8_t* data, T value)
+        {
+            for(unsigned i = 0; i < sizeof(T); ++i)
+                data[i] = value >> (8 * (sizeof(T) - 1 - i));
+        }
     };
 
     /**
      * @brief Class for SCSI LUN
      * 
-     * @tparam _LunNumber Number
+     * @details
+     * LUN specialization can optionally define:
+     *  - static constexpr bool WriteProtected (reported by MODE SENSE (6), so host mounts LUN read-only);
+     *  - static bool Ready() (for example, SD card presence; not ready LUN reports "medium not present");
+     *  - static void Sync() (called on SYNCHRONIZE CACHE (10/16) command).
+     * Read10Handler/Write10Handler serve READ/WRITE (10), (12) and (16) commands.
+     * Responses are sent from flash if LUN size is known at compile time (constexpr GetLbaCount/GetLbaSize),
+     * other responses are prepared in static buffer (data is sent after command handler returns).
+     * 
      * @tparam _LunSpecialization LUN specialization (with LBA size/count method, Read/Write handlers)
      */
     template<typename _LunSpecialization>
     class ScsiLun : public ScsiLunBase
     {
+        /// Sense key: illegal request
+        static const uint8_t SenseIllegalRequest = 0x05;
+        /// Additional sense code: invalid command operation code
+        static const uint8_t AscInvalidCommand = 0x20;
+        /// Additional sense code: logical block address out of range
+        static const uint8_t AscLbaOutOfRange = 0x21;
+
+        static constexpr bool IsWriteProtected()
+        {
+            if constexpr (requires {_LunSpecialization::WriteProtected;})
+                return _LunSpecialization::WriteProtected;
+            else
+                return false;
+        }
+
+        static bool IsReady()
+        {
+            if constexpr (requires {_LunSpecialization::Ready();})
+                return _LunSpecialization::Ready();
+            else
+                return true;
+        }
+
+        static constexpr bool ConstSize = requires {
+            typename std::integral_constant<uint32_t, _LunSpecialization::GetLbaCount()>;
+            typename std::integral_constant<uint32_t, _LunSpecialization::GetLbaSize()>;
+        };
+
+        static constexpr std::array<uint8_t, 12> FormatCapacityResponse(uint32_t lbaCount, uint32_t lbaSize)
+        {
+            std::array<uint8_t, 12> response {0, 0, 0, 8};
+            WriteBe(&response[4], lbaCount);
+            WriteBe(&response[8], lbaSize);
+            // Formatted media (descriptor code replaces high byte of block length)
+            response[8] = 0b10;
+            return response;
+        }
+
+        static constexpr std::array<uint8_t, 8> CapacityResponse(uint32_t lbaCount, uint32_t lbaSize)
+        {
+            std::array<uint8_t, 8> response {};
+            WriteBe(&response[0], lbaCount - 1);
+            WriteBe(&response[4], lbaSize);
+            return response;
+        }
+
+        static constexpr std::array<uint8_t, 32> Capacity16Response(uint32_t lbaCount, uint32_t lbaSize)
+        {
+            std::array<uint8_t, 32> response {};
+            WriteBe(&response[0], static_cast<uint64_t>(lbaCount) - 1);
+            WriteBe(&response[8], lbaSize);
+            return response;
+        }
+
+        template<auto _Response>
+        static constexpr auto FlashResponse = _Response;
+
+        static constexpr uint8_t ModeSenseResponse[] = {3, 0, IsWriteProtected() ? uint8_t(0x80) : uint8_t(0), 0};
     public:
-        static const uint8_t Number = _LunSpecialization::LunNumber;
 
         /**
          * @brief LUN command handler
@@ -206,71 +333,154 @@ namespace Zhele::Usb
             csw.Status = BulkOnlyCSW::CswStatus::Passed;
             csw.DataResidue = 0;
 
-            switch (static_cast<ScsiCommand>(cbw.CommandBlock[0]))
+            const uint8_t* cdb = cbw.CommandBlock;
+            switch (static_cast<ScsiCommand>(cdb[0]))
             {
             case ScsiCommand::Inquiry:
-                if(cbw.CommandBlock[1] & 0x01) {
-                    _InEp::SendData(inquiry_page00_data, cbw.DataLength < sizeof(inquiry_page00_data) ? cbw.DataLength : sizeof(inquiry_page00_data), callback);
+                if(cdb[1] & 0x01) {
+                    SendResponse<_InEp>(inquiry_page00_data, sizeof(inquiry_page00_data), cbw, csw, callback);
                 } else {
-                    _InEp::SendData(inquiry_response, cbw.DataLength < sizeof(inquiry_response) ? cbw.DataLength : sizeof(inquiry_response), callback);
+                    SendResponse<_InEp>(inquiry_response, sizeof(inquiry_response), cbw, csw, callback);
                 }
                 break;
-            case ScsiCommand::MmcReadFormatCapacity: {
-                constexpr uint8_t buffer[] = { 0, 0, 0, 8,
-                    (_LunSpecialization::GetLbaCount() >> 24) & 0xff,
-                    (_LunSpecialization::GetLbaCount() >> 16) & 0xff,
-                    (_LunSpecialization::GetLbaCount() >> 8) & 0xff,
-                    (_LunSpecialization::GetLbaCount() >> 0) & 0xff,
-
-                    0b10, // formatted media
-                    (_LunSpecialization::GetLbaSize() >> 16) & 0xff,
-                    (_LunSpecialization::GetLbaSize() >> 8) & 0xff,
-                    (_LunSpecialization::GetLbaSize() >> 0) & 0xff,
-                };
-                _InEp::SendData(buffer, sizeof(buffer), callback);
+            case ScsiCommand::MmcReadFormatCapacity:
+                if constexpr (ConstSize) {
+                    const auto& response = FlashResponse<FormatCapacityResponse(_LunSpecialization::GetLbaCount(), _LunSpecialization::GetLbaSize())>;
+                    SendResponse<_InEp>(response.data(), response.size(), cbw, csw, callback);
+                } else {
+                    auto response = FormatCapacityResponse(_LunSpecialization::GetLbaCount(), _LunSpecialization::GetLbaSize());
+                    memcpy(_response, response.data(), response.size());
+                    SendResponse<_InEp>(_response, response.size(), cbw, csw, callback);
+                }
                 break;
-            }
-            case ScsiCommand::ReadCapacity: {
-                uint32_t buffer[] = { ConvertLeBe(_LunSpecialization::GetLbaCount() - 1), ConvertLeBe(_LunSpecialization::GetLbaSize()) };
-
-                _InEp::SendData(buffer, sizeof(buffer), callback);
+            case ScsiCommand::ReadCapacity:
+                if constexpr (ConstSize) {
+                    const auto& response = FlashResponse<CapacityResponse(_LunSpecialization::GetLbaCount(), _LunSpecialization::GetLbaSize())>;
+                    SendResponse<_InEp>(response.data(), response.size(), cbw, csw, callback);
+                } else {
+                    auto response = CapacityResponse(_LunSpecialization::GetLbaCount(), _LunSpecialization::GetLbaSize());
+                    memcpy(_response, response.data(), response.size());
+                    SendResponse<_InEp>(_response, response.size(), cbw, csw, callback);
+                }
                 break;
-            }
-            case ScsiCommand::ModeSense6: {
-                // TODO:: Add template parameter for LUN type
-                uint8_t buffer[] = {3, 0, 0, 0};
-                csw.DataResidue = cbw.DataLength - sizeof(buffer);
-                _InEp::SendData(buffer, sizeof(buffer), callback);
+            case ScsiCommand::ServiceActionIn16: {
+                // READ CAPACITY (16) only
+                if((cdb[1] & 0x1f) != 0x10) {
+                    Fail(cbw, csw, AscInvalidCommand, callback);
+                    break;
+                }
+                uint32_t allocationLength = ReadBe<uint32_t>(&cdb[10]);
+                if(allocationLength > cbw.DataLength)
+                    allocationLength = cbw.DataLength;
+                if constexpr (ConstSize) {
+                    const auto& response = FlashResponse<Capacity16Response(_LunSpecialization::GetLbaCount(), _LunSpecialization::GetLbaSize())>;
+                    SendResponse<_InEp>(response.data(), response.size() < allocationLength ? response.size() : allocationLength, cbw, csw, callback);
+                } else {
+                    auto response = Capacity16Response(_LunSpecialization::GetLbaCount(), _LunSpecialization::GetLbaSize());
+                    memcpy(_response, response.data(), response.size());
+                    SendResponse<_InEp>(_response, response.size() < allocationLength ? response.size() : allocationLength, cbw, csw, callback);
+                }
                 break;
             }
+            case ScsiCommand::ModeSense6:
+                SendResponse<_InEp>(ModeSenseResponse, sizeof(ModeSenseResponse), cbw, csw, callback);
+                break;
+            case ScsiCommand::RequestSense:
+                if(!IsReady()) {
+                    SendResponse<_InEp>(sense_not_ready_response, sizeof(sense_not_ready_response), cbw, csw, callback);
+                } else if(_senseKey != 0) {
+                    memcpy(_response, sense_response, sizeof(sense_response));
+                    _response[2] = _senseKey;
+                    _response[12] = _asc;
+                    _senseKey = 0;
+                    _asc = 0;
+                    SendResponse<_InEp>(_response, sizeof(sense_response), cbw, csw, callback);
+                } else {
+                    SendResponse<_InEp>(sense_response, sizeof(sense_response), cbw, csw, callback);
+                }
+                break;
             case ScsiCommand::TestUnitReady : {
+                if(!IsReady())
+                    csw.Status = BulkOnlyCSW::CswStatus::Failed;
                 callback();
                 break;
             }
-            case ScsiCommand::Read10: {
-                uint32_t startLba = ConvertLeBe(reinterpret_cast<const ScsiReadWrite10Request*>(&cbw.CommandBlock[0])->BlockAddress);
-                uint32_t lbaCount = ConvertLeBe(reinterpret_cast<const ScsiReadWrite10Request*>(&cbw.CommandBlock[0])->Length);
-
-                _LunSpecialization::template Read10Handler<_InEp>(startLba, lbaCount, callback);
+            case ScsiCommand::SynchronizeCache:
+            case ScsiCommand::SynchronizeCache16: {
+                if constexpr (requires {_LunSpecialization::Sync();})
+                    _LunSpecialization::Sync();
+                callback();
                 break;
             }
-            case ScsiCommand::Write10: {
-                uint32_t startLba = ConvertLeBe(reinterpret_cast<const ScsiReadWrite10Request*>(&cbw.CommandBlock[0])->BlockAddress);
-                uint32_t lbaCount = ConvertLeBe(reinterpret_cast<const ScsiReadWrite10Request*>(&cbw.CommandBlock[0])->Length);
-
-                return _LunSpecialization::Write10Handler(startLba, lbaCount);
-            }
+            case ScsiCommand::Read10:
+                return Read<_InEp>(ReadBe<uint32_t>(&cdb[2]), ReadBe<uint16_t>(&cdb[7]), cbw, csw, callback);
+            case ScsiCommand::Read12:
+                return Read<_InEp>(ReadBe<uint32_t>(&cdb[2]), ReadBe<uint32_t>(&cdb[6]), cbw, csw, callback);
+            case ScsiCommand::Read16:
+                return Read<_InEp>(ReadBe<uint64_t>(&cdb[2]), ReadBe<uint32_t>(&cdb[10]), cbw, csw, callback);
+            case ScsiCommand::Write10:
+                return _LunSpecialization::Write10Handler(ReadBe<uint32_t>(&cdb[2]), ReadBe<uint16_t>(&cdb[7]));
+            case ScsiCommand::Write12:
+                return _LunSpecialization::Write10Handler(ReadBe<uint32_t>(&cdb[2]), ReadBe<uint32_t>(&cdb[6]));
+            case ScsiCommand::Write16:
+                // Data stage is received even if LBA is out of 32-bit range, so pass truncated LBA to handler
+                return _LunSpecialization::Write10Handler(static_cast<uint32_t>(ReadBe<uint64_t>(&cdb[2])), ReadBe<uint32_t>(&cdb[10]));
             case ScsiCommand::MmcStartStopUnit:
             case ScsiCommand::MmcPreventAllowRemoval:
                 callback();
+                break;
             default:
+                // Unsupported command
+                Fail(cbw, csw, AscInvalidCommand, callback);
                 break;
             }
 
             return false;
         }
+
+    private:
+        template<typename _InEp>
+        static void SendResponse(const void* data, uint32_t size, const BulkOnlyCBW& cbw, BulkOnlyCSW& csw, InTransferCallback callback)
+        {
+            if(size > cbw.DataLength)
+                size = cbw.DataLength;
+            csw.DataResidue = cbw.DataLength - size;
+            _InEp::SendData(data, size, callback);
+        }
+
+        template<typename _InEp>
+        static bool Read(uint64_t startLba, uint32_t lbaCount, const BulkOnlyCBW& cbw, BulkOnlyCSW& csw, InTransferCallback callback)
+        {
+            if(startLba + lbaCount > _LunSpecialization::GetLbaCount()) {
+                Fail(cbw, csw, AscLbaOutOfRange, callback);
+                return false;
+            }
+
+            _LunSpecialization::template Read10Handler<_InEp>(static_cast<uint32_t>(startLba), lbaCount, callback);
+            return false;
+        }
+
+        static void Fail(const BulkOnlyCBW& cbw, BulkOnlyCSW& csw, uint8_t asc, InTransferCallback callback)
+        {
+            _senseKey = SenseIllegalRequest;
+            _asc = asc;
+            csw.Status = BulkOnlyCSW::CswStatus::Failed;
+            csw.DataResidue = cbw.DataLength;
+            callback();
+        }
+
+        static uint8_t _senseKey;
+        static uint8_t _asc;
+        static uint8_t _response[32] __attribute__((aligned(4)));
     };
 
+    template<typename _LunSpecialization>
+    uint8_t ScsiLun<_LunSpecialization>::_senseKey = 0;
+    template<typename _LunSpecialization>
+    uint8_t ScsiLun<_LunSpecialization>::_asc = 0;
+    template<typename _LunSpecialization>
+    uint8_t ScsiLun<_LunSpecialization>::_response[32] __attribute__((aligned(4)));
+
     /**
      * @brief Class for SCSI LUN
      * 
@@ -417,6 +627,463 @@ namespace Zhele::Usb
     template<uint32_t _LbaSize, uint32_t _LbaCount>
     uint8_t DefaultScsiLun<_LbaSize, _LbaCount>::_buffer[_LbaCount * _LbaSize];;
 
+    /**
+     * @brief SCSI logical unit over block device (RAM disk, internal flash, SD card)
+     * 
+     * @details
+     * If device blocks are memory mapped (device has Data method), data is transferred
+     * between USB and device memory directly. Otherwise blocks are transferred
+     * via one block buffer.
+     * 
+     * @tparam _Device Block device
+     * @tparam _BlockSize Block size (buffer size for not memory mapped device)
+     */
+    template<typename _Device, uint32_t _BlockSize = 512>
+    class BlockDeviceScsiLun : public ScsiLunBase
+    {
+        static const bool MemoryMapped = requires {_Device::Data(0u);};
+        static const bool WritableMemoryMapped = requires {{_Device::Data(0u)} -> std::same_as<uint8_t*>;};
+    public:
+        /**
+         * @brief Returns LBA size
+         * 
+         * @returns LBA size (in bytes)
+         */
+        static uint32_t GetLbaSize()
+        {
+            return _BlockSize;
+        }
+
+        /**
+         * @brief Returns LBA count
+         * 
+         * @returns LBA count
+         */
+        static uint32_t GetLbaCount()
+        {
+            return _Device::BlocksCount();
+        }
+
+        /**
+         * @brief Returns device status (for TEST UNIT READY)
+         * 
+         * @retval true Device is ready
+         * @retval false Device is not ready
+         */
+        static bool Ready()
+        {
+            return _Device::CheckStatus();
+        }
+
+        /**
+         * @brief Synchronize device (for SYNCHRONIZE CACHE)
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Sync()
+        {
+            _Device::Sync();
+        }
+
+        /**
+         * @brief Read (10) command handler
+         * 
+         * @tparam _InEp IN endpoint
+         * 
+         * @param startLba Start LBA
+         * @param lbaCount LBA count
+         * @param callback Transfer complete callback for call
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        template<typename _InEp>
+        static void Read10Handler(uint32_t startLba, uint32_t lbaCount, InTransferCallback callback)
+        {
+            if constexpr (MemoryMapped)
+            {
+                _InEp::SendData(_Device::Data(startLba), lbaCount * _BlockSize, callback);
+            }
+            else
+            {
+                _txLba = startLba;
+                _txBlocksRemain = lbaCount;
+                _txCompleteCallback = callback;
+                SendNextBlock<_InEp>();
+            }
+        }
+
+        /**
+         * @brief Write (10) command handler
+         * 
+         * @param startLba Start LBA
+         * @param lbaCount LBA count
+         * 
+         * @retval true Wait for next packet
+         * @retval false OUT transfer complete
+         */
+        static bool Write10Handler(uint32_t startLba, uint32_t lbaCount)
+        {
+            _rxLba = startLba;
+            _rxOffset = 0;
+            _rxBytesRemain = lbaCount * _BlockSize;
+
+            return lbaCount > 0;
+        }
+
+        /**
+         * @brief LUN rx handler
+         * 
+         * @details
+         * Block size should be multiple of OUT endpoint packet size.
+         * 
+         * @param data Data
+         * @param size Data size
+         * 
+         * @return true Waiting for next packet (transfer does not complete)
+         * @return false Transfer complete
+         */
+        static bool RxHandler(void* data, uint16_t size)
+        {
+            if constexpr (WritableMemoryMapped)
+            {
+                CopyFromUsbPma(_Device::Data(_rxLba) + _rxOffset, data, size);
+                _rxOffset += size;
+            }
+            else
+            {
+                CopyFromUsbPma(&_buffer[_rxOffset], data, size);
+                _rxOffset += size;
+                if(_rxOffset >= _BlockSize)
+                {
+                    _Device::WriteBlock(_buffer, _rxLba++);
+                    _rxOffset = 0;
+                }
+            }
+
+            _rxBytesRemain -= size;
+            if(_rxBytesRemain > 0)
+                return true;
+
+            _Device::Sync();
+            return false;
+        }
+    private:
+        template<typename _InEp>
+        static void SendNextBlock()
+        {
+            if(_txBlocksRemain == 0)
+            {
+                if(_txCompleteCallback)
+                    _txCompleteCallback();
+                return;
+            }
+
+            _Device::ReadBlock(_buffer, _txLba++);
+            --_txBlocksRemain;
+            _InEp::SendData(_buffer, _BlockSize, SendNextBlock<_InEp>);
+        }
+
+        static uint32_t _txLba;
+        static uint32_t _txBlocksRemain;
+        static InTransferCallback _txCompleteCallback;
+
+        static uint32_t _rxLba;
+        static uint32_t _rxOffset;
+        static int32_t _rxBytesRemain;
+
+        static uint8_t _buffer[_BlockSize];
+    };
+
+    template<typename _Device, uint32_t _BlockSize>
+    uint32_t BlockDeviceScsiLun<_Device, _BlockSize>::_txLba;
+    template<typename _Device, uint32_t _BlockSize>
+    uint32_t BlockDeviceScsiLun<_Device, _BlockSize>::_txBlocksRemain;
+    template<typename _Device, uint32_t _BlockSize>
+    InTransferCallback BlockDeviceScsiLun<_Device, _BlockSize>::_txCompleteCallback;
+    template<typename _Device, uint32_t _BlockSize>
+    uint32_t BlockDeviceScsiLun<_Device, _BlockSize>::_rxLba;
+    template<typename _Device, uint32_t _BlockSize>
+    uint32_t BlockDeviceScsiLun<_Device, _BlockSize>::_rxOffset;
+    template<typename _Device, uint32_t _BlockSize>
+    int32_t BlockDeviceScsiLun<_Device, _BlockSize>::_rxBytesRemain;
+    template<typename _Device, uint32_t _BlockSize>
+    uint8_t BlockDeviceScsiLun<_Device, _BlockSize>::_buffer[_BlockSize];
+
+    /**
+     * @brief SCSI logical unit with double buffered streaming (for SD card)
+     * 
+     * @details
+     * Read (10): block N + 1 is read from device (by DMA) while block N is sent to host.
+     * Write (10): block N is written to device while block N + 1 is received from host.
+     * Device should implement BeginRead/ReadNextBlockAsync/EndRead and
+     * BeginWrite/WriteNextBlockAsync/EndWrite (see SdCard).
+     * IN endpoint should not send ZLP (block is sent by separate SendData call).
+     * Device (SPI DMA) interrupt priority should be higher than USB interrupt priority,
+     * because OUT handler waits for free buffer.
+     * 
+     * @tparam _Device Block device
+     * @tparam _BlockSize Block size
+     */
+    template<typename _Device, uint32_t _BlockSize = 512>
+    class PipelinedScsiLun : public ScsiLunBase
+    {
+        /// Buffer state
+        enum BufferState : uint8_t
+        {
+            Free, ///< Buffer can be filled
+            Busy, ///< Buffer is filled/processed by device or USB
+            Filled ///< Buffer is ready for send/write
+        };
+    public:
+        /**
+         * @brief Returns LBA size
+         * 
+         * @returns LBA size (in bytes)
+         */
+        static uint32_t GetLbaSize()
+        {
+            return _BlockSize;
+        }
+
+        /**
+         * @brief Returns LBA count
+         * 
+         * @returns LBA count
+         */
+        static uint32_t GetLbaCount()
+        {
+            return _Device::BlocksCount();
+        }
+
+        /**
+         * @brief Returns device status (for TEST UNIT READY)
+         * 
+         * @retval true Device is ready
+         * @retval false Device is not ready
+         */
+        static bool Ready()
+        {
+            return _Device::CheckStatus();
+        }
+
+        /**
+         * @brief Synchronize device (for SYNCHRONIZE CACHE)
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Sync()
+        {
+            _Device::Sync();
+        }
+
+        /**
+         * @brief Read (10) command handler
+         * 
+         * @tparam _InEp IN endpoint
+         * 
+         * @param startLba Start LBA
+         * @param lbaCount LBA count
+         * @param callback Transfer complete callback for call
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        template<typename _InEp>
+        static void Read10Handler(uint32_t startLba, uint32_t lbaCount, InTransferCallback callback)
+        {
+            _txCompleteCallback = callback;
+            _deviceBlocksRemain = lbaCount;
+            _usbBlocksRemain = lbaCount;
+            _deviceBuffer = 0;
+            _usbBuffer = 0;
+            _deviceBusy = false;
+            _usbBusy = false;
+            _states[0] = _states[1] = Free;
+
+            if(lbaCount == 0 || !_Device::BeginRead(startLba))
+            {
+                callback();
+                return;
+            }
+            StartRead<_InEp>();
+        }
+
+        /**
+         * @brief Write (10) command handler
+         * 
+         * @param startLba Start LBA
+         * @param lbaCount LBA count
+         * 
+         * @retval true Wait for next packet
+         * @retval false OUT transfer complete
+         */
+        static bool Write10Handler(uint32_t startLba, uint32_t lbaCount)
+        {
+            _rxOffset = 0;
+            _rxBytesRemain = lbaCount * _BlockSize;
+            _deviceBuffer = 0;
+            _usbBuffer = 0;
+            _deviceBusy = false;
+            _states[0] = _states[1] = Free;
+
+            return lbaCount > 0 && _Device::BeginWrite(startLba, lbaCount);
+        }
+
+        /**
+         * @brief LUN rx handler
+         * 
+         * @param data Data
+         * @param size Data size
+         * 
+         * @return true Waiting for next packet (transfer does not complete)
+         * @return false Transfer complete
+         */
+        static bool RxHandler(void* data, uint16_t size)
+        {
+            // Wait while device writes previous block from this buffer
+            while(_states[_usbBuffer] != Free)
+                continue;
+
+            CopyFromUsbPma(&_buffers[_usbBuffer][_rxOffset], data, size);
+            _rxOffset += size;
+            if(_rxOffset >= _BlockSize)
+            {
+                _states[_usbBuffer] = Filled;
+                _usbBuffer ^= 1;
+                _rxOffset = 0;
+                StartWrite();
+            }
+
+            _rxBytesRemain -= size;
+            if(_rxBytesRemain > 0)
+                return true;
+
+            while(_deviceBusy || _states[0] != Free || _states[1] != Free)
+                continue;
+            _Device::EndWrite();
+            return false;
+        }
+    private:
+        static bool Acquire(volatile bool& busy, uint8_t buffer, BufferState state)
+        {
+            uint32_t primask = __get_PRIMASK();
+            __disable_irq();
+            bool acquired = !busy && _states[buffer] == state;
+            if(acquired)
+            {
+                busy = true;
+                _states[buffer] = Busy;
+            }
+            __set_PRIMASK(primask);
+
+            return acquired;
+        }
+
+        template<typename _InEp>
+        static void StartRead()
+        {
+            if(_deviceBlocksRemain == 0 || !Acquire(_deviceBusy, _deviceBuffer, Free))
+                return;
+            --_deviceBlocksRemain;
+            _Device::ReadNextBlockAsync(_buffers[_deviceBuffer], OnBlockRead<_InEp>);
+        }
+
+        template<typename _InEp>
+        static void OnBlockRead(bool success)
+        {
+            // Stop read before last block is sent, so next command can't find card busy
+            if(_deviceBlocksRemain == 0)
+                _Device::EndRead();
+            _states[_deviceBuffer] = Filled;
+            _deviceBuffer ^= 1;
+            _deviceBusy = false;
+
+            StartSend<_InEp>();
+            StartRead<_InEp>();
+        }
+
+        template<typename _InEp>
+        static void StartSend()
+        {
+            if(!Acquire(_usbBusy, _usbBuffer, Filled))
+                return;
+            _InEp::SendData(_buffers[_usbBuffer], _BlockSize, OnBlockSent<_InEp>);
+        }
+
+        template<typename _InEp>
+        static void OnBlockSent()
+        {
+            _states[_usbBuffer] = Free;
+            _usbBuffer ^= 1;
+            _usbBusy = false;
+
+            if(--_usbBlocksRemain == 0)
+            {
+                if(_txCompleteCallback)
+                    _txCompleteCallback();
+                return;
+            }
+
+            StartSend<_InEp>();
+            StartRead<_InEp>();
+        }
+
+        static void StartWrite()
+        {
+            if(!Acquire(_deviceBusy, _deviceBuffer, Filled))
+                return;
+            _Device::WriteNextBlockAsync(_buffers[_deviceBuffer], OnBlockWritten);
+        }
+
+        static void OnBlockWritten(bool success)
+        {
+            _states[_deviceBuffer] = Free;
+            _deviceBuffer ^= 1;
+            _deviceBusy = false;
+
+            StartWrite();
+        }
+
+        static uint8_t _buffers[2][_BlockSize];
+        static volatile BufferState _states[2];
+        static volatile uint8_t _deviceBuffer;
+        static volatile uint8_t _usbBuffer;
+        static volatile bool _deviceBusy;
+        static volatile bool _usbBusy;
+        static volatile uint32_t _deviceBlocksRemain;
+        static volatile uint32_t _usbBlocksRemain;
+        static InTransferCallback _txCompleteCallback;
+
+        static uint32_t _rxOffset;
+        static int32_t _rxBytesRemain;
+    };
+
+    template<typename _Device, uint32_t _BlockSize>
+    uint8_t PipelinedScsiLun<_Device, _BlockSize>::_buffers[2][_BlockSize];
+    template<typename _Device, uint32_t _BlockSize>
+    volatile typename PipelinedScsiLun<_Device, _BlockSize>::BufferState PipelinedScsiLun<_Device, _BlockSize>::_states[2];
+    template<typename _Device, uint32_t _BlockSize>
+    volatile uint8_t PipelinedScsiLun<_Device, _BlockSize>::_deviceBuffer;
+    template<typename _Device, uint32_t _BlockSize>
+    volatile uint8_t PipelinedScsiLun<_Device, _BlockSize>::_usbBuffer;
+    template<typename _Device, uint32_t _BlockSize>
+    volatile bool PipelinedScsiLun<_Device, _BlockSize>::_deviceBusy;
+    template<typename _Device, uint32_t _BlockSize>
+    volatile bool PipelinedScsiLun<_Device, _BlockSize>::_usbBusy;
+    template<typename _Device, uint32_t _BlockSize>
+    volatile uint32_t PipelinedScsiLun<_Device, _BlockSize>::_deviceBlocksRemain;
+    template<typename _Device, uint32_t _BlockSize>
+    volatile uint32_t PipelinedScsiLun<_Device, _BlockSize>::_usbBlocksRemain;
+    template<typename _Device, uint32_t _BlockSize>
+    InTransferCallback PipelinedScsiLun<_Device, _BlockSize>::_txCompleteCallback;
+    template<typename _Device, uint32_t _BlockSize>
+    uint32_t PipelinedScsiLun<_Device, _BlockSize>::_rxOffset;
+    template<typename _Device, uint32_t _BlockSize>
+    int32_t PipelinedScsiLun<_Device, _BlockSize>::_rxBytesRemain;
+
 
     /**
      * @brief Implements SCSI BBB interface
@@ -434,6 +1101,8 @@ namespace Zhele::Usb
     {     
         using Base = Interface<_Number, _AlternateSetting, InterfaceClass::Storage, static_cast<uint8_t>(MscSubclass::Scsi), static_cast<uint8_t>(MscProtocol::Bbb), _Ep0, _OutEp, _InEp>;
 
+        static_assert(sizeof...(_Luns) > 0 && sizeof...(_Luns) <= 16, "Bulk-only MSC supports from 1 to 16 LUNs.");
+
         static constexpr std::add_pointer_t<bool(void* buffer, uint16_t size)> _lunRxHandlers[] = {_Luns::RxHandler...};
         static constexpr std::add_pointer_t<bool(const BulkOnlyCBW& cbw, BulkOnlyCSW& csw, InTransferCallback callback)> _lunCommandHandlers[] = {(ScsiLun<_Luns>::template CommandHandler<_InEp>)...};
     public:
@@ -500,6 +1169,16 @@ namespace Zhele::Usb
                 cbwBytesReceived += size;
 
                 if(cbwBytesReceived == sizeof(BulkOnlyCBW)) {
+                    if(request.Lun >= sizeof...(_Luns)) {
+                        // Invalid LUN: fail command without data stage
+                        response.Tag = request.Tag;
+                        response.DataResidue = request.DataLength;
+                        response.Status = BulkOnlyCSW::CswStatus::Failed;
+                        cbwBytesReceived = 0;
+                        needReceive = false;
+                        _InEp::SendData(&response, sizeof(response));
+                        return;
+                    }
                     needReceive = _lunCommandHandlers[request.Lun](request, response, [](){
                         cbwBytesReceived = 0;
                         _InEp::SendData(&response, sizeof(response));
@@ -0,0 +1,156 @@
+/**
+ * @file
+ * Implements USB MSC host class (bulk-only transport, SCSI block device)
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_USB_MSC_HOST_H
+#define ZHELE_USB_MSC_HOST_H
+
+#include "host.h"
+#include "msc.h"
+
+#include <stdint.h>
+
+#if defined (USB_OTG_FS)
+namespace Zhele::Usb
+{
+    /**
+     * @brief USB mass storage (flash drive) as block device
+     *
+     * @details
+     * Class satisfies BlockDevice concept (see drivers/filesystem/block_device.h), so it can be used
+     * with FatFs (BlockDeviceFatFsAdapter) or SectorCache. Call Process (instead of host Process)
+     * from main loop: after enumeration it finds bulk-only SCSI interface, waits medium
+     * (TEST UNIT READY) and reads capacity. Read and write commands transfer data directly
+     * to/from caller buffer. Only first LUN is used.
+     *
+     * @tparam _Host USB host (Host)
+     * @tparam _Timeout Data transfer timeout (ms)
+     */
+    template<typename _Host, uint16_t _Timeout = 5000>
+    class MscHost
+    {
+    public:
+        /**
+         * @brief Processes host and drive state
+         *
+         * @retval true Drive is ready
+         * @retval false No drive (or drive is not ready)
+         */
+        static bool Process();
+
+        /**
+         * @brief Check device status
+         *
+         * @retval true Drive is ready
+         * @retval false No drive
+         */
+        static bool CheckStatus();
+
+        /**
+         * @brief Returns blocks count
+         *
+         * @returns Blocks count
+         */
+        static uint32_t BlocksCount();
+
+        /**
+         * @brief Returns block size
+         *
+         * @returns Block size (bytes)
+         */
+        static size_t BlockSize();
+
+        /**
+         * @brief Reads block
+         *
+         * @param [out] data Output buffer
+         * @param [in] block Block number
+         *
+         * @retval true Success
+         * @retval false Error
+         */
+        static bool ReadBlock(uint8_t* data, uint32_t block);
+
+        /**
+         * @brief Reads blocks
+         *
+         * @param [out] data Output buffer
+         * @param [in] block First block number
+         * @param [in] count Blocks count
+         *
+         * @retval true Success
+         * @retval false Error
+         */
+        static bool ReadMultipleBlock(uint8_t* data, uint32_t block, uint32_t count);
+
+        /**
+         * @brief Writes block
+         *
+         * @param [in] data Data
+         * @param [in] block Block number
+         *
+         * @retval true Success
+         * @retval false Error
+         */
+        static bool WriteBlock(const uint8_t* data, uint32_t block);
+
+        /**
+         * @brief Writes blocks
+         *
+         * @param [in] data Data
+         * @param [in] block First block number
+         * @param [in] count Blocks count
+         *
+         * @retval true Success
+         * @retval false Error
+         */
+        static bool WriteMultipleBlock(const uint8_t* data, uint32_t block, uint32_t count);
+
+        /**
+         * @brief Erases blocks (drive manages erase itself, so method does nothing)
+         *
+         * @param [in] firstBlock First block
+         * @param [in] lastBlock Last block
+         *
+         * @retval true Drive is ready
+         * @retval false No drive
+         */
+        static bool Erase(uint32_t firstBlock, uint32_t lastBlock);
+
+        /**
+         * @brief Flushes drive cache (SYNCHRONIZE CACHE)
+         *
+         * @retval true Success (or command is not supported)
+         * @retval false Transport error
+         */
+        static bool Sync();
+
+    private:
+        static bool Attach();
+        static void Detach();
+        static BulkOnlyCSW::CswStatus Command(const uint8_t* command, uint8_t length, void* data, uint32_t size, bool in);
+        static void ResetRecovery();
+        static bool TestUnitReady();
+        static bool ReadCapacity();
+        static bool ReadWrite(uint8_t opcode, uint8_t* data, uint32_t block, uint32_t count);
+
+        static uint32_t _blocksCount;
+        static uint32_t _blockSize;
+        static uint32_t _tag;
+        static uint8_t _interface;
+        static int8_t _inChannel;
+        static int8_t _outChannel;
+        static bool _attached;
+        static bool _ready;
+    };
+}
+
+#include "impl/msc_host.h"
+#endif
+
+#endif //! ZHELE_USB_MSC_HOST_H
@@ -0,0 +1,827 @@
+/**
+ * @file
+ * Implement USB CDC-NCM (network control model) class
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2023
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_USB_NCM_H
+#define ZHELE_USB_NCM_H
+
+#include "cdc.h"
+
+#include <string.h>
+
+namespace Zhele::Usb
+{
+    /**
+     * @brief CDC-NCM class-specific requests
+     */
+    enum class NcmRequest : uint8_t
+    {
+        SetEthernetPacketFilter = 0x43, ///< Set ethernet packet filter
+        GetNtbParameters = 0x80, ///< Get NTB parameters
+        GetNtbFormat = 0x83, ///< Get NTB format
+        SetNtbFormat = 0x84, ///< Set NTB format
+        GetNtbInputSize = 0x85, ///< Get NTB input size
+        SetNtbInputSize = 0x86, ///< Set NTB input size
+    };
+
+    /// Data interface protocol (network transfer block)
+    static const uint8_t NcmDataProtocol = 0x01;
+
+    /**
+     * @brief CDC notifications
+     */
+    enum class CdcNotification : uint8_t
+    {
+        NetworkConnection = 0x00, ///< Network connection
+        ConnectionSpeedChange = 0x2a, ///< Connection speed change
+    };
+
+#pragma pack(push, 1)
+    /**
+     * @brief NTB parameters (response to GET_NTB_PARAMETERS)
+     */
+    struct NtbParameters
+    {
+        uint16_t Length = sizeof(NtbParameters); ///< Structure length (always 28)
+        uint16_t NtbFormatsSupported = 0x0001; ///< Supported NTB formats (16-bit only)
+        uint32_t NtbInMaxSize; ///< Max IN NTB size
+        uint16_t NdpInDivisor = 4; ///< IN datagram alignment divisor
+        uint16_t NdpInPayloadRemainder = 0; ///< IN datagram alignment remainder
+        uint16_t NdpInAlignment = 4; ///< IN NDP alignment
+        uint16_t Reserved = 0; ///< Reserved
+        uint32_t NtbOutMaxSize; ///< Max OUT NTB size
+        uint16_t NdpOutDivisor = 4; ///< OUT datagram alignment divisor
+        uint16_t NdpOutPayloadRemainder = 0; ///< OUT datagram alignment remainder
+        uint16_t NdpOutAlignment = 4; ///< OUT NDP alignment
+        uint16_t NtbOutMaxDatagrams = 0; ///< Max datagrams in OUT NTB (0 - no limit)
+    };
+
+    /**
+     * @brief CDC notification header
+     */
+    struct CdcNotificationHeader
+    {
+        uint8_t RequestType = 0xa1; ///< Request type (class, interface, device to host)
+        CdcNotification Notification; ///< Notification code
+        uint16_t Value; ///< Value
+        uint16_t Index; ///< Interface number
+        uint16_t Length; ///< Data length
+    };
+
+    /**
+     * @brief Connection speed change notification
+     */
+    struct CdcSpeedChangeNotification
+    {
+        CdcNotificationHeader Header; ///< Notification header
+        uint32_t DownlinkBitRate; ///< Downlink bit rate (bit/s)
+        uint32_t UplinkBitRate; ///< Uplink bit rate (bit/s)
+    };
+#pragma pack(pop)
+
+    /// Ethernet networking functional (wMaxSegmentSize = 1514, no statistics and filters)
+    template<uint8_t _MacStringIndex>
+    using EthernetNetworkingFunctional = InterfaceFunctionalDescriptor<0x0f, _MacStringIndex, 0x00, 0x00, 0x00, 0x00, 0xea, 0x05, 0x00, 0x00, 0x00>;
+    /// NCM functional (NCM 1.0, no optional requests)
+    using NcmFunctional = InterfaceFunctionalDescriptor<0x1a, 0x00, 0x01, 0x00>;
+
+    /**
+     * @brief Implements CDC-NCM communication interface
+     *
+     * @details
+     * Interface describes network function (header, union, ethernet and NCM functionals)
+     * and handles NCM control requests. MAC address for host side of link is read
+     * by host from string descriptor with index _MacStringIndex (12 hex digits), by default
+     * it is serial number string, so device serial should be MAC address (for example, u"02A0B1C2D3E4").
+     * If NCM is only function of device, device class should be DeviceAndInterfaceClass::Comm.
+     *
+     * @tparam _Number Interface number
+     * @tparam _Ep0 Zero endpoint instance
+     * @tparam _Endpoint Notification (interrupt IN) endpoint
+     * @tparam _DataInterface Data interface number
+     * @tparam _Stream NCM stream (NcmStream)
+     * @tparam _MacStringIndex MAC address string index
+     * @tparam _BitRate Reported link bit rate (bit/s)
+     */
+    template <uint8_t _Number, typename _Ep0, typename _Endpoint, uint8_t _DataInterface, typename _Stream, uint8_t _MacStringIndex = 3, uint32_t _BitRate = 12000000>
+    class NcmCommInterface : public Interface<_Number, 0, DeviceAndInterfaceClass::Comm, static_cast<uint8_t>(CdcInterfaceSubClass::Ncm), 0, _Ep0, _Endpoint>
+    {
+        using Base = Interface<_Number, 0, DeviceAndInterfaceClass::Comm, static_cast<uint8_t>(CdcInterfaceSubClass::Ncm), 0, _Ep0, _Endpoint>;
+
+        static_assert(_Endpoint::Direction == EndpointDirection::In && _Endpoint::Type == EndpointType::Interrupt, "Notification endpoint should be interrupt IN endpoint.");
+        static_assert(_Endpoint::MaxPacketSize >= sizeof(CdcSpeedChangeNotification), "Notification endpoint max packet size should be at least 16 bytes.");
+    public:
+        using Stream = _Stream;
+
+        /**
+         * @brief Interface setup request handler
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void SetupHandler()
+        {
+            SetupPacket* setup = reinterpret_cast<SetupPacket*>(_Ep0::RxBuffer);
+
+            if(setup->RequestType.Type == 0)
+            {
+                if(setup->Request == StandartRequestCode::SetInterface && setup->Value == 0)
+                {
+                    _Ep0::SendZLP();
+                }
+                else if(setup->Request == StandartRequestCode::GetInterface)
+                {
+                    uint8_t alternateSetting = 0;
+                    _Ep0::SendData(&alternateSetting, 1);
+                }
+                else
+                {
+                    _Ep0::SetTxStatus(EndpointStatus::Stall);
+                }
+                return;
+            }
+
+            switch (static_cast<NcmRequest>(setup->Request))
+            {
+            case NcmRequest::GetNtbParameters:
+                _Ep0::SendData(&Parameters, setup->Length < sizeof(NtbParameters) ? setup->Length : sizeof(NtbParameters));
+                break;
+            case NcmRequest::GetNtbFormat: {
+                uint16_t format = 0;
+                _Ep0::SendData(&format, sizeof(format));
+                break;
+            }
+            case NcmRequest::SetNtbFormat:
+                // Only 16-bit NTB is supported
+                if(setup->Value == 0)
+                    _Ep0::SendZLP();
+                else
+                    _Ep0::SetTxStatus(EndpointStatus::Stall);
+                break;
+            case NcmRequest::GetNtbInputSize: {
+                uint32_t size = _Stream::InMaxSize();
+                _Ep0::SendData(&size, sizeof(size));
+                break;
+            }
+            case NcmRequest::SetNtbInputSize:
+                if(setup->Length == 4 || setup->Length == 8)
+                {
+                    // dwNtbInMaxSize (and optional wNtbInMaxDatagrams, which is ignored)
+                    static uint32_t inputSize[2];
+                    _Ep0::ReceiveControlData(inputSize, setup->Length, [](uint16_t) {
+                        _Stream::SetInMaxSize(inputSize[0]);
+                        return true;
+                    });
+                }
+                else
+                {
+                    _Ep0::SetTxStatus(EndpointStatus::Stall);
+                }
+                break;
+            case NcmRequest::SetEthernetPacketFilter:
+                // Filters are not supported, all packets are passed to host
+                _Ep0::SendZLP();
+                break;
+            default:
+                _Ep0::SetTxStatus(EndpointStatus::Stall);
+                break;
+            }
+        }
+
+        /**
+         * @brief Notify host about link state (connection speed and network connection)
+         *
+         * @details
+         * Host brings network interface up only after network connection notification.
+         * Data interface calls this method when host selects alternate setting with endpoints.
+         *
+         * @param [in] connected Link state
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void NotifyConnection(bool connected)
+        {
+            if(connected)
+            {
+                _Endpoint::SendData(&SpeedChange, sizeof(SpeedChange), []{
+                    _Endpoint::SendData(&Connected, sizeof(Connected), nullptr);
+                });
+            }
+            else
+            {
+                _Endpoint::SendData(&Disconnected, sizeof(Disconnected), nullptr);
+            }
+        }
+
+        /**
+         * @brief Returns descriptor
+         *
+         * @returns Descriptor bytes (interface, functionals and endpoint descriptors)
+         */
+        static constexpr auto Descriptor()
+        {
+            return ConcatDescriptors(DescriptorBytes(InterfaceDescriptor {
+                .Number = _Number,
+                .AlternateSetting = 0,
+                .EndpointsCount = Base::EndpointsCount,
+                .Class = DeviceAndInterfaceClass::Comm,
+                .SubClass = static_cast<uint8_t>(CdcInterfaceSubClass::Ncm),
+                .Protocol = 0
+            }),
+            HeaderFunctional::Descriptor(),
+            InterfaceFunctionalDescriptor<static_cast<uint8_t>(CdcInterfaceSubClass::Ethernet), _Number, _DataInterface>::Descriptor(), // Union
+            EthernetNetworkingFunctional<_MacStringIndex>::Descriptor(),
+            NcmFunctional::Descriptor(),
+            _Endpoint::Descriptor());
+        }
+
+    private:
+        static constexpr NtbParameters Parameters {
+            .NtbInMaxSize = _Stream::NtbSize,
+            .NtbOutMaxSize = _Stream::NtbSize
+        };
+        static constexpr CdcSpeedChangeNotification SpeedChange {
+            .Header = {.Notification = CdcNotification::ConnectionSpeedChange, .Value = 0, .Index = _Number, .Length = 8},
+            .DownlinkBitRate = _BitRate,
+            .UplinkBitRate = _BitRate
+        };
+        static constexpr CdcNotificationHeader Connected {.Notification = CdcNotification::NetworkConnection, .Value = 1, .Index = _Number, .Length = 0};
+        static constexpr CdcNotificationHeader Disconnected {.Notification = CdcNotification::NetworkConnection, .Value = 0, .Index = _Number, .Length = 0};
+    };
+
+    /**
+     * @brief Implements CDC-NCM data interface
+     *
+     * @details
+     * Interface has two alternate settings: 0 - no endpoints (network is down),
+     * 1 - bulk IN/OUT endpoints. When host selects alternate setting 1 endpoints and
+     * stream are reset and network connection is notified.
+     *
+     * @tparam _Number Interface number
+     * @tparam _Ep0 Zero endpoint instance
+     * @tparam _Comm Communication interface (NcmCommInterface)
+     * @tparam _OutEp OUT bulk endpoint
+     * @tparam _InEp IN bulk endpoint
+     */
+    template <uint8_t _Number, typename _Ep0, typename _Comm, typename _OutEp, typename _InEp>
+    class NcmDataInterface : public Interface<_Number, 0, DeviceAndInterfaceClass::CdcData, 0, NcmDataProtocol, _Ep0, _OutEp, _InEp>
+    {
+        using Base = Interface<_Number, 0, DeviceAndInterfaceClass::CdcData, 0, NcmDataProtocol, _Ep0, _OutEp, _InEp>;
+    public:
+        /**
+         * @brief Reset interface
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Reset()
+        {
+            _alternateSetting = 0;
+            Base::Reset();
+        }
+
+        /**
+         * @brief Interface setup request handler
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void SetupHandler()
+        {
+            SetupPacket* setup = reinterpret_cast<SetupPacket*>(_Ep0::RxBuffer);
+
+            if(setup->RequestType.Type == 0 && setup->Request == StandartRequestCode::SetInterface && setup->Value <= 1)
+            {
+                _alternateSetting = setup->Value;
+                if(_alternateSetting != 0)
+                {
+                    Base::Reset();
+                    _Comm::Stream::Reset();
+                    _Comm::NotifyConnection(true);
+                }
+                else
+                {
+                    Base::Deactivate();
+                }
+                _Ep0::SendZLP();
+            }
+            else if(setup->RequestType.Type == 0 && setup->Request == StandartRequestCode::GetInterface)
+            {
+                _Ep0::SendData(&_alternateSetting, 1);
+            }
+            else
+            {
+                _Ep0::SetTxStatus(EndpointStatus::Stall);
+            }
+        }
+
+        /**
+         * @brief Returns descriptor
+         *
+         * @returns Descriptor bytes (both alternate settings and endpoints descriptors)
+         */
+        static constexpr auto Descriptor()
+        {
+            return ConcatDescriptors(
+                DescriptorBytes(InterfaceDescriptor {
+                    .Number = _Number,
+                    .AlternateSetting = 0,
+                    .EndpointsCount = 0,
+                    .Class = DeviceAndInterfaceClass::CdcData,
+                    .SubClass = 0,
+                    .Protocol = NcmDataProtocol
+                }),
+                DescriptorBytes(InterfaceDescriptor {
+                    .Number = _Number,
+                    .AlternateSetting = 1,
+                    .EndpointsCount = Base::EndpointsCount,
+                    .Class = DeviceAndInterfaceClass::CdcData,
+                    .SubClass = 0,
+                    .Protocol = NcmDataProtocol
+                }),
+                _OutEp::Descriptor(),
+                _InEp::Descriptor());
+        }
+
+    private:
+        static uint8_t _alternateSetting;
+    };
+
+    template <uint8_t _Number, typename _Ep0, typename _Comm, typename _OutEp, typename _InEp>
+    uint8_t NcmDataInterface<_Number, _Ep0, _Comm, _OutEp, _InEp>::_alternateSetting = 0;
+
+#if defined (USB)
+    /**
+     * @brief Network datagrams stream over CDC-NCM bulk endpoints
+     *
+     * @details
+     * Several ethernet frames are aggregated into one NTB (NCM transfer block) per USB transfer.
+     * IN: frames written by Send are collected in NTB, NTB is sent when it is full
+     * (no space or _MaxDatagrams frames), on Flush or after _FlushTimeout Tick calls without sends.
+     * There are two IN NTB buffers: one is filled by application while other one is transmitted.
+     * OUT: received NTB is parsed by Receive, that returns frames one by one. There are two OUT NTB
+     * buffers: next NTB is received while previous one is read, if both are full, OUT endpoint
+     * is NAKed until application reads frames.
+     * Send, Flush and Tick are mutually excluded (PRIMASK), so Tick can be called from timer interrupt.
+     *
+     * OUT endpoint HandleRx should call NcmStream::HandleRx:
+     * @code
+     * template<> void NcmOutEndpoint::HandleRx(void* data, uint16_t size) { Stream::HandleRx(data, size); }
+     * @endcode
+     *
+     * @tparam _OutEp OUT bulk endpoint
+     * @tparam _InEp IN bulk endpoint
+     * @tparam _NtbSize NTB buffer size (both directions)
+     * @tparam _MaxDatagrams Max frames in IN NTB
+     * @tparam _FlushTimeout Idle ticks before partial NTB sending
+     */
+    template<typename _OutEp, typename _InEp, unsigned _NtbSize = 2048, unsigned _MaxDatagrams = 8, unsigned _FlushTimeout = 1>
+    class NcmStream
+    {
+        static_assert(_NtbSize >= 2048 && _NtbSize <= 0xffff, "NTB size should be in [2048, 65535].");
+        static_assert(_NtbSize % _OutEp::MaxPacketSize == 0, "NTB size should be multiple of OUT endpoint max packet size.");
+
+        static const uint32_t NthSignature = 0x484d434e; ///< "NCMH"
+        static const uint32_t NdpSignature = 0x304d434e; ///< "NCM0"
+        static const uint16_t NthSize = 12; ///< NTH16 size
+        static const uint16_t NdpSize = 8 + 4 * (_MaxDatagrams + 1); ///< NDP16 size (with terminating entry)
+        static const uint16_t FirstDatagramOffset = (NthSize + NdpSize + 3) & ~3u;
+        static const uint16_t MinNtbInSize = 2048;
+    public:
+        /// NTB size
+        static const unsigned NtbSize = _NtbSize;
+
+        /**
+         * @brief Add frame to IN NTB
+         *
+         * @param [in] frame Ethernet frame (without CRC)
+         * @param [in] size Frame size
+         *
+         * @retval true Frame is queued
+         * @retval false Both NTB buffers are busy (or frame is too large)
+         */
+        static bool Send(const void* frame, unsigned size)
+        {
+            // NTB is kept shorter than max size, so it always ends with short packet
+            if(size == 0 || FirstDatagramOffset + size >= _inMaxSize)
+                return false;
+
+            uint32_t primask = __get_PRIMASK();
+            __disable_irq();
+            if(_txLength + ((size + 3) & ~3u) >= _inMaxSize)
+                CloseNtb();
+            if(_txQueued[_txFill])
+            {
+                __set_PRIMASK(primask);
+                StartTx();
+                return false;
+            }
+
+            uint8_t* ntb = _txBuffers[_txFill];
+            memcpy(&ntb[_txLength], frame, size);
+            WriteU16(ntb, NthSize + 8 + 4 * _txCount, _txLength);
+            WriteU16(ntb, NthSize + 10 + 4 * _txCount, size);
+            _txLength = (_txLength + size + 3) & ~3u;
+            ++_txCount;
+            _idleTicks = 0;
+
+            if(_txCount == _MaxDatagrams)
+                CloseNtb();
+            __set_PRIMASK(primask);
+
+            StartTx();
+            return true;
+        }
+
+        /**
+         * @brief Send partial NTB
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Flush()
+        {
+            uint32_t primask = __get_PRIMASK();
+            __disable_irq();
+            CloseNtb();
+            __set_PRIMASK(primask);
+
+            StartTx();
+        }
+
+        /**
+         * @brief Flush timer tick
+         *
+         * @details
+         * Should be called periodically (1 ms for example). Partial NTB
+         * is sent if there were no sends during _FlushTimeout ticks.
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Tick()
+        {
+            if(_txCount == 0)
+                return;
+            if(++_idleTicks >= _FlushTimeout)
+            {
+                _idleTicks = 0;
+                Flush();
+            }
+        }
+
+        /**
+         * @brief Read next received frame
+         *
+         * @param [out] frame Output buffer
+         * @param [in] size Buffer size (frame is truncated if it is larger)
+         *
+         * @returns Frame size (0 if there is no received frames)
+         */
+        static unsigned Receive(void* frame, unsigned size)
+        {
+            while(_rxReady[_rxRead])
+            {
+                const uint8_t* ntb = _rxBuffers[_rxRead];
+                uint16_t index;
+                uint16_t length;
+                if(NextDatagram(ntb, _rxLength[_rxRead], index, length))
+                {
+                    memcpy(frame, &ntb[index], length < size ? length : size);
+                    return length;
+                }
+                ReleaseRxBuffer();
+            }
+            return 0;
+        }
+
+        /**
+         * @brief Handle received packet (should be called from OUT endpoint HandleRx)
+         *
+         * @param [in] data Packet buffer (in packet memory)
+         * @param [in] size Packet size
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void HandleRx(void* data, uint16_t size)
+        {
+            uint8_t fill = _rxFill;
+            if(_rxOverflow || _rxReady[fill] || _rxReceived + size > _NtbSize)
+            {
+                // Too large NTB (or NTB received to full buffer from second PMA buffer) is dropped
+                _rxOverflow = true;
+            }
+            else
+            {
+                CopyFromUsbPma(&_rxBuffers[fill][_rxReceived], data, size);
+                _rxReceived += size;
+            }
+
+            // NTB is complete on short packet (ZLP) or if it has max size
+            if(size == _OutEp::MaxPacketSize && _rxReceived < _NtbSize && !_rxOverflow)
+                return;
+
+            if(!_rxOverflow && IsNtbValid(_rxBuffers[fill], _rxReceived))
+            {
+                _rxLength[fill] = _rxReceived;
+                _rxReady[fill] = true;
+                _rxFill = fill ^ 1;
+            }
+            _rxReceived = 0;
+            _rxOverflow = false;
+
+            if(_rxReady[_rxFill])
+            {
+                _rxPaused = true;
+                _OutEp::SetRxStatus(EndpointStatus::Nak);
+            }
+        }
+
+        /**
+         * @brief Reset stream (host has selected data interface alternate setting 1)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Reset()
+        {
+            _txFill = 0;
+            _txSend = 0;
+            _txQueued[0] = _txQueued[1] = false;
+            _txBusy = false;
+            _txCount = 0;
+            _txLength = FirstDatagramOffset;
+            _idleTicks = 0;
+            _rxFill = 0;
+            _rxRead = 0;
+            _rxReady[0] = _rxReady[1] = false;
+            _rxNdp = 0;
+            _rxReceived = 0;
+            _rxOverflow = false;
+            _rxPaused = false;
+        }
+
+        /**
+         * @brief Returns max IN NTB size
+         *
+         * @returns Size
+         */
+        static uint32_t InMaxSize()
+        {
+            return _inMaxSize;
+        }
+
+        /**
+         * @brief Set max IN NTB size (SET_NTB_INPUT_SIZE request)
+         *
+         * @param [in] size Max NTB size accepted by host
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void SetInMaxSize(uint32_t size)
+        {
+            _inMaxSize = size > _NtbSize ? _NtbSize : (size < MinNtbInSize ? MinNtbInSize : size);
+        }
+
+    private:
+        static uint16_t ReadU16(const uint8_t* data, unsigned offset)
+        {
+            return data[offset] | (data[offset + 1] << 8);
+        }
+
+        static uint32_t ReadU32(const uint8_t* data, unsigned offset)
+        {
+            return ReadU16(data, offset) | (static_cast<uint32_t>(ReadU16(data, offset + 2)) << 16);
+        }
+
+        static void WriteU16(uint8_t* data, unsigned offset, uint16_t value)
+        {
+            data[offset] = value & 0xff;
+            data[offset + 1] = value >> 8;
+        }
+
+        static void WriteU32(uint8_t* data, unsigned offset, uint32_t value)
+        {
+            WriteU16(data, offset, value & 0xffff);
+            WriteU16(data, offset + 2, value >> 16);
+        }
+
+        static bool IsNdpValid(const uint8_t* ntb, uint16_t length, uint16_t ndp)
+        {
+            return ndp >= NthSize && (ndp & 3) == 0 && ndp + 8u <= length
+                && ReadU32(ntb, ndp) == NdpSignature
+                && ReadU16(ntb, ndp + 4) >= 16 && ndp + ReadU16(ntb, ndp + 4) <= length;
+        }
+
+        static bool IsNtbValid(const uint8_t* ntb, uint16_t length)
+        {
+            return length >= NthSize
+                && ReadU32(ntb, 0) == NthSignature
+                && ReadU16(ntb, 4) == NthSize
+                && ReadU16(ntb, 8) <= length
+                && IsNdpValid(ntb, length, ReadU16(ntb, 10));
+        }
+
+        /**
+         * @brief Find next datagram in received NTB
+         *
+         * @details
+         * Read position is kept in _rxNdp (current NDP, 0 - NTB is not parsed yet) and _rxEntry (next NDP entry).
+         * NDP chain is followed only forward (next NDP index should be greater), so broken NTB can't cause endless loop.
+         */
+        static bool NextDatagram(const uint8_t* ntb, uint16_t length, uint16_t& index, uint16_t& datagramLength)
+        {
+            if(_rxNdp == 0)
+            {
+                _rxNdp = ReadU16(ntb, 10);
+                _rxEntry = _rxNdp + 8;
+            }
+
+            for(;;)
+            {
+                uint16_t ndpEnd = _rxNdp + ReadU16(ntb, _rxNdp + 4);
+                while(_rxEntry + 4u <= ndpEnd)
+                {
+                    index = ReadU16(ntb, _rxEntry);
+                    datagramLength = ReadU16(ntb, _rxEntry + 2);
+                    _rxEntry += 4;
+
+                    if(index == 0 || datagramLength == 0)
+                        break;
+                    if(index >= NthSize && index + datagramLength <= length)
+                        return true;
+                }
+
+                uint16_t next = ReadU16(ntb, _rxNdp + 6);
+                if(next <= _rxNdp || !IsNdpValid(ntb, length, next))
+                    return false;
+                _rxNdp = next;
+                _rxEntry = next + 8;
+            }
+        }
+
+        static void ReleaseRxBuffer()
+        {
+            uint32_t primask = __get_PRIMASK();
+            __disable_irq();
+            _rxReady[_rxRead] = false;
+            _rxRead ^= 1;
+            _rxNdp = 0;
+            if(_rxPaused)
+            {
+                _rxPaused = false;
+                _OutEp::SetRxStatus(EndpointStatus::Valid);
+            }
+            __set_PRIMASK(primask);
+        }
+
+        /// Close current IN NTB and queue it (should be called with disabled interrupts)
+        static void CloseNtb()
+        {
+            if(_txCount == 0 || _txQueued[_txFill])
+                return;
+
+            uint8_t* ntb = _txBuffers[_txFill];
+            uint16_t length = _txLength;
+            // Transfer ends with short packet (ZLP is not needed)
+            if(length % _InEp::MaxPacketSize == 0)
+                ++length;
+
+            WriteU32(ntb, 0, NthSignature);
+            WriteU16(ntb, 4, NthSize);
+            WriteU16(ntb, 6, _txSequence++);
+            WriteU16(ntb, 8, length);
+            WriteU16(ntb, 10, NthSize);
+            WriteU32(ntb, NthSize, NdpSignature);
+            WriteU16(ntb, NthSize + 4, 8 + 4 * (_txCount + 1));
+            WriteU16(ntb, NthSize + 6, 0);
+            WriteU32(ntb, NthSize + 8 + 4 * _txCount, 0);
+
+            _txSize[_txFill] = length;
+            _txQueued[_txFill] = true;
+            _txFill ^= 1;
+            _txCount = 0;
+            _txLength = FirstDatagramOffset;
+        }
+
+        static void StartTx()
+        {
+            uint32_t primask = __get_PRIMASK();
+            __disable_irq();
+            if(_txBusy || !_txQueued[_txSend])
+            {
+                __set_PRIMASK(primask);
+                return;
+            }
+            _txBusy = true;
+            __set_PRIMASK(primask);
+
+            _InEp::SendData(_txBuffers[_txSend], _txSize[_txSend], OnTxComplete);
+        }
+
+        static void OnTxComplete()
+        {
+            _txQueued[_txSend] = false;
+            _txSend ^= 1;
+            _txBusy = false;
+            StartTx();
+        }
+
+        alignas(4) static uint8_t _txBuffers[2][_NtbSize];
+        alignas(4) static uint8_t _rxBuffers[2][_NtbSize];
+        static uint16_t _txSize[2];
+        static volatile bool _txQueued[2];
+        static volatile bool _txBusy;
+        static uint8_t _txFill;
+        static uint8_t _txSend;
+        static uint16_t _txCount;
+        static uint16_t _txLength;
+        static uint16_t _txSequence;
+        static volatile unsigned _idleTicks;
+
+        static uint16_t _rxLength[2];
+        static uint16_t _rxNdp;
+        static uint16_t _rxEntry;
+        static volatile bool _rxReady[2];
+        static uint8_t _rxFill;
+        static uint8_t _rxRead;
+        static uint16_t _rxReceived;
+        static bool _rxOverflow;
+        static volatile bool _rxPaused;
+        static uint32_t _inMaxSize;
+    };
+
+    template<typename _OutEp, typename _InEp, unsigned _NtbSize, unsigned _MaxDatagrams, unsigned _FlushTimeout>
+    alignas(4) uint8_t NcmStream<_OutEp, _InEp, _NtbSize, _MaxDatagrams, _FlushTimeout>::_txBuffers[2][_NtbSize];
+
+    template<typename _OutEp, typename _InEp, unsigned _NtbSize, unsigned _MaxDatagrams, unsigned _FlushTimeout>
+    alignas(4) uint8_t NcmStream<_OutEp, _InEp, _NtbSize, _MaxDatagrams, _FlushTimeout>::_rxBuffers[2][_NtbSize];
+
+    template<typename _OutEp, typename _InEp, unsigned _NtbSize, unsigned _MaxDatagrams, unsigned _FlushTimeout>
+    uint16_t NcmStream<_OutEp, _InEp, _NtbSize, _MaxDatagrams, _FlushTimeout>::_txSize[2];
+
+    template<typename _OutEp, typename _InEp, unsigned _NtbSize, unsigned _MaxDatagrams, unsigned _FlushTimeout>
+    volatile bool NcmStream<_OutEp, _InEp, _NtbSize, _MaxDatagrams, _FlushTimeout>::_txQueued[2];
+
+    template<typename _OutEp, typename _InEp, unsigned _NtbSize, unsigned _MaxDatagrams, unsigned _FlushTimeout>
+    volatile bool NcmStream<_OutEp, _InEp, _NtbSize, _MaxDatagrams, _FlushTimeout>::_txBusy = false;
+
+    template<typename _OutEp, typename _InEp, unsigned _NtbSize, unsigned _MaxDatagrams, unsigned _FlushTimeout>
+    uint8_t NcmStream<_OutEp, _InEp, _NtbSize, _MaxDatagrams, _FlushTimeout>::_txFill = 0;
+
+    template<typename _OutEp, typename _InEp, unsigned _NtbSize, unsigned _MaxDatagrams, unsigned _FlushTimeout>
+    uint8_t NcmStream<_OutEp, _InEp, _NtbSize, _MaxDatagrams, _FlushTimeout>::_txSend = 0;
+
+    template<typename _OutEp, typename _InEp, unsigned _NtbSize, unsigned _MaxDatagrams, unsigned _FlushTimeout>
+    uint16_t NcmStream<_OutEp, _InEp, _NtbSize, _MaxDatagrams, _FlushTimeout>::_txCount = 0;
+
+    template<typename _OutEp, typename _InEp, unsigned _NtbSize, unsigned _MaxDatagrams, unsigned _FlushTimeout>
+    uint16_t NcmStream<_OutEp, _InEp, _NtbSize, _MaxDatagrams, _FlushTimeout>::_txLength = NcmStream<_OutEp, _InEp, _NtbSize, _MaxDatagrams, _FlushTimeout>::FirstDatagramOffset;
+
+    template<typename _OutEp, typename _InEp, unsigned _NtbSize, unsigned _MaxDatagrams, unsigned _FlushTimeout>
+    uint16_t NcmStream<_OutEp, _InEp, _NtbSize, _MaxDatagrams, _FlushTimeout>::_txSequence = 0;
+
+    template<typename _OutEp, typename _InEp, unsigned _NtbSize, unsigned _MaxDatagrams, unsigned _FlushTimeout>
+    volatile unsigned NcmStream<_OutEp, _InEp, _NtbSize, _MaxDatagrams, _FlushTimeout>::_idleTicks = 0;
+
+    template<typename _OutEp, typename _InEp, unsigned _NtbSize, unsigned _MaxDatagrams, unsigned _FlushTimeout>
+    uint16_t NcmStream<_OutEp, _InEp, _NtbSize, _MaxDatagrams, _FlushTimeout>::_rxLength[2];
+
+    template<typename _OutEp, typename _InEp, unsigned _NtbSize, unsigned _MaxDatagrams, unsigned _FlushTimeout>
+    uint16_t NcmStream<_OutEp, _InEp, _NtbSize, _MaxDatagrams, _FlushTimeout>::_rxNdp = 0;
+
+    template<typename _OutEp, typename _InEp, unsigned _NtbSize, unsigned _MaxDatagrams, unsigned _FlushTimeout>
+    uint16_t NcmStream<_OutEp, _InEp, _NtbSize, _MaxDatagrams, _FlushTimeout>::_rxEntry = 0;
+
+    template<typename _OutEp, typename _InEp, unsigned _NtbSize, unsigned _MaxDatagrams, unsigned _FlushTimeout>
+    volatile bool NcmStream<_OutEp, _InEp, _NtbSize, _MaxDatagrams, _FlushTimeout>::_rxReady[2];
+
+    template<typename _OutEp, typename _InEp, unsigned _NtbSize, unsigned _MaxDatagrams, unsigned _FlushTimeout>
+    uint8_t NcmStream<_OutEp, _InEp, _NtbSize, _MaxDatagrams, _FlushTimeout>::_rxFill = 0;
+
+    template<typename _OutEp, typename _InEp, unsigned _NtbSize, unsigned _MaxDatagrams, unsigned _FlushTimeout>
+    uint8_t NcmStream<_OutEp, _InEp, _NtbSize, _MaxDatagrams, _FlushTimeout>::_rxRead = 0;
+
+    template<typename _OutEp, typename _InEp, unsigned _NtbSize, unsigned _MaxDatagrams, unsigned _FlushTimeout>
+    uint16_t NcmStream<_OutEp, _InEp, _NtbSize, _MaxDatagrams, _FlushTimeout>::_rxReceived = 0;
+
+    template<typename _OutEp, typename _InEp, unsigned _NtbSize, unsigned _MaxDatagrams, unsigned _FlushTimeout>
+    bool NcmStream<_OutEp, _InEp, _NtbSize, _MaxDatagrams, _FlushTimeout>::_rxOverflow = false;
+
+    template<typename _OutEp, typename _InEp, unsigned _NtbSize, unsigned _MaxDatagrams, unsigned _FlushTimeout>
+    volatile bool NcmStream<_OutEp, _InEp, _NtbSize, _MaxDatagrams, _FlushTimeout>::_rxPaused = false;
+
+    template<typename _OutEp, typename _InEp, unsigned _NtbSize, unsigned _MaxDatagrams, unsigned _FlushTimeout>
+    uint32_t NcmStream<_OutEp, _InEp, _NtbSize, _MaxDatagrams, _FlushTimeout>::_inMaxSize = _NtbSize;
+#endif
+}
+
+#endif // ZHELE_USB_NCM_H
@@ -0,0 +1,624 @@
+/**
+ * @file
+ * Implement USB vendor-specific bulk interface with MS OS 2.0 descriptors
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2023
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_USB_VENDOR_H
+#define ZHELE_USB_VENDOR_H
+
+#include "interface.h"
+
+#include "../template_utils/fixed_string.h"
+
+#include <string.h>
+#include <utility>
+
+/*
+ * MS OS 2.0 options:
+ *  - ZHELE_USB_MS_OS_20_VENDOR_CODE - vendor request code for MS OS 2.0 descriptor set
+ *    (should not conflict with other vendor requests of device).
+ */
+#if !defined (ZHELE_USB_MS_OS_20_VENDOR_CODE)
+    #define ZHELE_USB_MS_OS_20_VENDOR_CODE 0x20
+#endif
+
+namespace Zhele::Usb
+{
+    /// Vendor request code for MS OS 2.0 descriptor set
+    static const uint8_t MsOs20VendorCode = ZHELE_USB_MS_OS_20_VENDOR_CODE;
+    /// wIndex of MS OS 2.0 descriptor set request
+    static const uint16_t MsOs20DescriptorIndex = 0x07;
+    /// Min Windows version for MS OS 2.0 descriptors (Windows 8.1)
+    static const uint32_t MsOs20WindowsVersion = 0x06030000;
+
+    /**
+     * @brief MS OS 2.0 descriptor types
+     */
+    enum class MsOs20DescriptorType : uint16_t
+    {
+        SetHeader = 0x00, ///< Descriptor set header
+        ConfigurationSubsetHeader = 0x01, ///< Configuration subset header
+        FunctionSubsetHeader = 0x02, ///< Function subset header
+        CompatibleId = 0x03, ///< Compatible ID descriptor
+        RegistryProperty = 0x04, ///< Registry property descriptor
+    };
+
+#pragma pack(push, 1)
+    /**
+     * @brief BOS (binary device object store) descriptor header
+     */
+    struct BosDescriptor
+    {
+        uint8_t Length = 5; ///< Length (always 5)
+        DescriptorType Type = DescriptorType::Bos; ///< Descriptor type (always 0x0f)
+        uint16_t TotalLength; ///< Total length (with all capabilities descriptors)
+        uint8_t CapabilitiesCount; ///< Device capabilities count
+    };
+
+    /**
+     * @brief MS OS 2.0 platform capability descriptor
+     */
+    struct MsOs20PlatformCapabilityDescriptor
+    {
+        uint8_t Length = 28; ///< Length (always 28)
+        DescriptorType Type = DescriptorType::DeviceCapability; ///< Descriptor type (always 0x10)
+        uint8_t CapabilityType = 0x05; ///< Capability type (platform)
+        uint8_t Reserved = 0; ///< Reserved
+        /// MS OS 2.0 platform capability UUID {D8DD60DF-4589-4CC7-9CD2-659D9E648A9F}
+        uint8_t PlatformCapabilityUuid[16] = {0xdf, 0x60, 0xdd, 0xd8, 0x89, 0x45, 0xc7, 0x4c, 0x9c, 0xd2, 0x65, 0x9d, 0x9e, 0x64, 0x8a, 0x9f};
+        uint32_t WindowsVersion = MsOs20WindowsVersion; ///< Min Windows version
+        uint16_t DescriptorSetTotalLength; ///< MS OS 2.0 descriptor set length
+        uint8_t VendorCode = MsOs20VendorCode; ///< Vendor request code
+        uint8_t AlternateEnumerationCode = 0; ///< Alternate enumeration code (not supported)
+    };
+
+    /**
+     * @brief MS OS 2.0 descriptor set header
+     */
+    struct MsOs20SetHeader
+    {
+        uint16_t Length = 10; ///< Length (always 10)
+        MsOs20DescriptorType Type = MsOs20DescriptorType::SetHeader; ///< Descriptor type
+        uint32_t WindowsVersion = MsOs20WindowsVersion; ///< Min Windows version
+        uint16_t TotalLength; ///< Descriptor set total length
+    };
+
+    /**
+     * @brief MS OS 2.0 configuration subset header
+     */
+    struct MsOs20ConfigurationSubsetHeader
+    {
+        uint16_t Length = 8; ///< Length (always 8)
+        MsOs20DescriptorType Type = MsOs20DescriptorType::ConfigurationSubsetHeader; ///< Descriptor type
+        uint8_t ConfigurationIndex; ///< Configuration index (not configuration value)
+        uint8_t Reserved = 0; ///< Reserved
+        uint16_t TotalLength; ///< Subset total length
+    };
+
+    /**
+     * @brief MS OS 2.0 function subset header
+     */
+    struct MsOs20FunctionSubsetHeader
+    {
+        uint16_t Length = 8; ///< Length (always 8)
+        MsOs20DescriptorType Type = MsOs20DescriptorType::FunctionSubsetHeader; ///< Descriptor type
+        uint8_t FirstInterface; ///< First interface of function
+        uint8_t Reserved = 0; ///< Reserved
+        uint16_t SubsetLength; ///< Subset total length
+    };
+
+    /**
+     * @brief MS OS 2.0 compatible ID descriptor
+     */
+    struct MsOs20CompatibleIdDescriptor
+    {
+        uint16_t Length = 20; ///< Length (always 20)
+        MsOs20DescriptorType Type = MsOs20DescriptorType::CompatibleId; ///< Descriptor type
+        char CompatibleId[8] = {'W', 'I', 'N', 'U', 'S', 'B', 0, 0}; ///< Compatible ID
+        char SubCompatibleId[8] = {}; ///< Sub-compatible ID
+    };
+#pragma pack(pop)
+
+    /**
+     * @brief Returns MS OS 2.0 registry property descriptor with DeviceInterfaceGUIDs
+     *
+     * @tparam _Guid Interface GUID string in form {xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx}
+     *
+     * @returns Descriptor bytes
+     */
+    template<auto _Guid>
+    constexpr auto MsOs20DeviceInterfaceGuidDescriptor()
+    {
+        static_assert(_Guid.Length == 38, "GUID should be in form {xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx}.");
+
+        constexpr char16_t name[] = u"DeviceInterfaceGUIDs";
+        constexpr uint16_t nameLength = sizeof(name);
+        // REG_MULTI_SZ: GUID string, then empty string
+        constexpr uint16_t dataLength = (_Guid.Length + 2) * 2;
+        constexpr uint16_t length = 10 + nameLength + dataLength;
+
+        std::array<uint8_t, length> result {};
+        size_t offset = 0;
+        auto append = [&result, &offset](uint16_t value) {
+            result[offset++] = value & 0xff;
+            result[offset++] = value >> 8;
+        };
+        append(length);
+        append(static_cast<uint16_t>(MsOs20DescriptorType::RegistryProperty));
+        append(0x0007); // REG_MULTI_SZ
+        append(nameLength);
+        for(char16_t symbol : name)
+            append(symbol);
+        append(dataLength);
+        for(unsigned i = 0; i < _Guid.Length; ++i)
+            append(_Guid.Text[i]);
+        append(0);
+        append(0);
+        return result;
+    }
+
+    /**
+     * @brief Builds MS OS 2.0 descriptor set and BOS descriptor for device configurations
+     *
+     * @details
+     * Interface provides MS OS 2.0 feature descriptors by static MsOs20FeatureDescriptors method.
+     * Function subsets (and configuration subsets) are used only for composite device,
+     * for device with single interface feature descriptors are placed directly to descriptor set.
+     *
+     * @tparam _Configurations Device configurations
+     */
+    template<typename... _Configurations>
+    class MsOs20Descriptors
+    {
+        template<typename _Interface>
+        static constexpr bool HasFeatures = requires { _Interface::MsOs20FeatureDescriptors(); };
+
+        template<typename _Interface>
+        static constexpr auto Features()
+        {
+            if constexpr (HasFeatures<_Interface>)
+                return _Interface::MsOs20FeatureDescriptors();
+            else
+                return std::array<uint8_t, 0> {};
+        }
+
+        template<typename _Interface>
+        static constexpr auto FunctionSubset()
+        {
+            if constexpr (HasFeatures<_Interface>)
+            {
+                constexpr auto features = _Interface::MsOs20FeatureDescriptors();
+                return ConcatDescriptors(DescriptorBytes(MsOs20FunctionSubsetHeader {
+                    .FirstInterface = _Interface::Number,
+                    .SubsetLength = sizeof(MsOs20FunctionSubsetHeader) + features.size()
+                }), features);
+            }
+            else
+            {
+                return std::array<uint8_t, 0> {};
+            }
+        }
+
+        template<typename _Interfaces>
+        struct ConfigurationFeatures;
+        template<typename... _Interfaces>
+        struct ConfigurationFeatures<Zhele::TemplateUtils::TypeList<_Interfaces...>>
+        {
+            static const bool Any = (false || ... || HasFeatures<_Interfaces>);
+            static const bool SingleInterface = (true && ... && (_Interfaces::Number == 0));
+
+            static constexpr auto Features()
+            {
+                return ConcatDescriptors(MsOs20Descriptors::Features<_Interfaces>()...);
+            }
+
+            static constexpr auto FunctionSubsets()
+            {
+                return ConcatDescriptors(MsOs20Descriptors::FunctionSubset<_Interfaces>()...);
+            }
+        };
+
+        template<uint8_t _Index, typename _Configuration>
+        static constexpr auto ConfigurationSubset()
+        {
+            using Features = ConfigurationFeatures<typename _Configuration::Interfaces>;
+            if constexpr (Features::Any)
+            {
+                constexpr auto subsets = Features::FunctionSubsets();
+                return ConcatDescriptors(DescriptorBytes(MsOs20ConfigurationSubsetHeader {
+                    .ConfigurationIndex = _Index,
+                    .TotalLength = sizeof(MsOs20ConfigurationSubsetHeader) + subsets.size()
+                }), subsets);
+            }
+            else
+            {
+                return std::array<uint8_t, 0> {};
+            }
+        }
+
+        template<size_t... _Indexes>
+        static constexpr auto ConfigurationSubsets(std::index_sequence<_Indexes...>)
+        {
+            return ConcatDescriptors(ConfigurationSubset<_Indexes, _Configurations>()...);
+        }
+
+        static constexpr auto Body()
+        {
+            if constexpr (sizeof...(_Configurations) == 1
+                && (ConfigurationFeatures<typename _Configurations::Interfaces>::SingleInterface && ...))
+            {
+                return (ConfigurationFeatures<typename _Configurations::Interfaces>::Features(), ...);
+            }
+            else
+            {
+                return ConfigurationSubsets(std::make_index_sequence<sizeof...(_Configurations)>{});
+            }
+        }
+    public:
+        /// Device has MS OS 2.0 descriptors
+        static const bool Present = (false || ... || ConfigurationFeatures<typename _Configurations::Interfaces>::Any);
+
+        /**
+         * @brief Returns MS OS 2.0 descriptor set
+         *
+         * @returns Descriptor set bytes
+         */
+        static constexpr auto DescriptorSet()
+        {
+            if constexpr (Present)
+            {
+                constexpr auto body = Body();
+                return ConcatDescriptors(DescriptorBytes(MsOs20SetHeader {
+                    .TotalLength = sizeof(MsOs20SetHeader) + body.size()
+                }), body);
+            }
+            else
+            {
+                return std::array<uint8_t, 0> {};
+            }
+        }
+
+        /**
+         * @brief Returns BOS descriptor (with MS OS 2.0 platform capability)
+         *
+         * @returns Descriptor bytes
+         */
+        static constexpr auto Bos()
+        {
+            return ConcatDescriptors(DescriptorBytes(BosDescriptor {
+                .TotalLength = sizeof(BosDescriptor) + sizeof(MsOs20PlatformCapabilityDescriptor),
+                .CapabilitiesCount = 1
+            }), DescriptorBytes(MsOs20PlatformCapabilityDescriptor {
+                .DescriptorSetTotalLength = DescriptorSet().size()
+            }));
+        }
+    };
+
+#if defined (USB)
+    /**
+     * @brief Vendor receive complete callback
+     *
+     * @param [in] size Received data size
+     */
+    using VendorReceiveCallback = std::add_pointer_t<void(uint32_t size)>;
+
+    /**
+     * @brief Large transfers over vendor bulk endpoints
+     *
+     * @details
+     * IN: buffer of any size is split into packets in endpoint interrupt (ZLP is sent if
+     * size is multiple of max packet size), callback is called after last packet.
+     * OUT: packets are copied to caller buffer in endpoint interrupt until buffer is full
+     * or short packet is received. If there is no buffer, up to two packets are kept
+     * and OUT endpoint is NAKed, so host data is never lost.
+     *
+     * OUT endpoint HandleRx should call VendorBulkStream::HandleRx:
+     * @code
+     * template<> void VendorOutEndpoint::HandleRx(void* data, uint16_t size) { VendorBulkStream<VendorOutEndpoint, VendorInEndpoint>::HandleRx(data, size); }
+     * @endcode
+     *
+     * @tparam _OutEp OUT bulk (double-buffered) endpoint
+     * @tparam _InEp IN bulk (double-buffered) endpoint
+     */
+    template<typename _OutEp, typename _InEp>
+    class VendorBulkStream
+    {
+        static const uint16_t PacketSize = _OutEp::MaxPacketSize;
+    public:
+        /**
+         * @brief Start IN transfer
+         *
+         * @param [in] data Data (should be valid until transfer is complete)
+         * @param [in] size Data size
+         * @param [in] callback Transfer complete callback (called from USB interrupt)
+         *
+         * @retval true Transfer is started
+         * @retval false Previous transfer is not complete yet
+         */
+        static bool Send(const void* data, uint32_t size, InTransferCallback callback = nullptr)
+        {
+            uint32_t primask = __get_PRIMASK();
+            __disable_irq();
+            bool busy = _txBusy;
+            _txBusy = true;
+            __set_PRIMASK(primask);
+            if(busy)
+                return false;
+
+            _txCallback = callback;
+            _InEp::SendData(data, size, TxComplete);
+            return true;
+        }
+
+        /**
+         * @brief Returns IN transfer state
+         *
+         * @retval true Transfer is in progress
+         * @retval false There is no transfer
+         */
+        static bool IsSendBusy()
+        {
+            return _txBusy;
+        }
+
+        /**
+         * @brief Start OUT transfer
+         *
+         * @details
+         * If kept packets complete transfer, callback is called from this method.
+         *
+         * @param [in] buffer Buffer
+         * @param [in] size Buffer size (multiple of max packet size)
+         * @param [in] callback Transfer complete callback (called from USB interrupt)
+         *
+         * @retval true Transfer is started
+         * @retval false Previous transfer is not complete yet or buffer size is invalid
+         */
+        static bool Receive(void* buffer, uint32_t size, VendorReceiveCallback callback)
+        {
+            if(size == 0 || size % PacketSize != 0)
+                return false;
+
+            uint32_t primask = __get_PRIMASK();
+            __disable_irq();
+            if(_rxBuffer != nullptr)
+            {
+                __set_PRIMASK(primask);
+                return false;
+            }
+
+            _rxBuffer = static_cast<uint8_t*>(buffer);
+            _rxSize = size;
+            _rxReceived = 0;
+            _rxCallback = callback;
+
+            bool complete = false;
+            while(_pendingCount > 0 && !complete)
+            {
+                uint16_t packetSize = _pendingSize[_pendingFirst];
+                memcpy(&_rxBuffer[_rxReceived], _pending[_pendingFirst], packetSize);
+                _rxReceived += packetSize;
+                _pendingFirst ^= 1;
+                --_pendingCount;
+                complete = packetSize < PacketSize || _rxReceived == _rxSize;
+            }
+
+            if(!complete && _rxPaused)
+            {
+                _rxPaused = false;
+                _OutEp::SetRxStatus(EndpointStatus::Valid);
+            }
+            __set_PRIMASK(primask);
+
+            if(complete)
+                CompleteRx();
+            return true;
+        }
+
+        /**
+         * @brief Returns OUT transfer state
+         *
+         * @retval true Transfer is in progress
+         * @retval false There is no transfer
+         */
+        static bool IsReceiveBusy()
+        {
+            return _rxBuffer != nullptr;
+        }
+
+        /**
+         * @brief OUT endpoint packet handler
+         *
+         * @param [in] data Packet (in packet memory)
+         * @param [in] size Packet size
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void HandleRx(void* data, uint16_t size)
+        {
+            if(_rxBuffer == nullptr)
+            {
+                if(_pendingCount < 2)
+                {
+                    uint8_t index = _pendingFirst ^ _pendingCount;
+                    CopyFromUsbPma(_pending[index], data, size);
+                    _pendingSize[index] = size;
+                    ++_pendingCount;
+                }
+                PauseRx();
+                return;
+            }
+
+            CopyFromUsbPma(&_rxBuffer[_rxReceived], data, size);
+            _rxReceived += size;
+            if(size == PacketSize && _rxReceived < _rxSize)
+                return;
+
+            CompleteRx();
+            if(_rxBuffer == nullptr)
+                PauseRx();
+        }
+
+        /**
+         * @brief Reset stream (abort transfers)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Reset()
+        {
+            _txBusy = false;
+            _txCallback = nullptr;
+            _rxBuffer = nullptr;
+            _rxCallback = nullptr;
+            _rxPaused = false;
+            _pendingFirst = 0;
+            _pendingCount = 0;
+        }
+
+    private:
+        static void TxComplete()
+        {
+            InTransferCallback callback = _txCallback;
+            _txBusy = false;
+            if(callback != nullptr)
+                callback();
+        }
+
+        static void CompleteRx()
+        {
+            VendorReceiveCallback callback = _rxCallback;
+            uint32_t received = _rxReceived;
+            _rxBuffer = nullptr;
+            if(callback != nullptr)
+                callback(received);
+        }
+
+        static void PauseRx()
+        {
+            _rxPaused = true;
+            _OutEp::SetRxStatus(EndpointStatus::Nak);
+        }
+
+        static volatile bool _txBusy;
+        static InTransferCallback _txCallback;
+
+        static uint8_t* volatile _rxBuffer;
+        static uint32_t _rxSize;
+        static uint32_t _rxReceived;
+        static VendorReceiveCallback _rxCallback;
+        static bool _rxPaused;
+
+        static uint8_t _pending[2][PacketSize];
+        static uint16_t _pendingSize[2];
+        static uint8_t _pendingFirst;
+        static uint8_t _pendingCount;
+    };
+
+    template<typename _OutEp, typename _InEp>
+    volatile bool VendorBulkStream<_OutEp, _InEp>::_txBusy = false;
+    template<typename _OutEp, typename _InEp>
+    InTransferCallback VendorBulkStream<_OutEp, _InEp>::_txCallback = nullptr;
+    template<typename _OutEp, typename _InEp>
+    uint8_t* volatile VendorBulkStream<_OutEp, _InEp>::_rxBuffer = nullptr;
+    template<typename _OutEp, typename _InEp>
+    uint32_t VendorBulkStream<_OutEp, _InEp>::_rxSize = 0;
+    template<typename _OutEp, typename _InEp>
+    uint32_t VendorBulkStream<_OutEp, _InEp>::_rxReceived = 0;
+    template<typename _OutEp, typename _InEp>
+    VendorReceiveCallback VendorBulkStream<_OutEp, _InEp>::_rxCallback = nullptr;
+    template<typename _OutEp, typename _InEp>
+    bool VendorBulkStream<_OutEp, _InEp>::_rxPaused = false;
+    template<typename _OutEp, typename _InEp>
+    uint8_t VendorBulkStream<_OutEp, _InEp>::_pending[2][PacketSize];
+    template<typename _OutEp, typename _InEp>
+    uint16_t VendorBulkStream<_OutEp, _InEp>::_pendingSize[2];
+    template<typename _OutEp, typename _InEp>
+    uint8_t VendorBulkStream<_OutEp, _InEp>::_pendingFirst = 0;
+    template<typename _OutEp, typename _InEp>
+    uint8_t VendorBulkStream<_OutEp, _InEp>::_pendingCount = 0;
+#endif
+
+    /**
+     * @brief Vendor-specific interface with bulk endpoints
+     *
+     * @details
+     * Interface provides MS OS 2.0 descriptors (WINUSB compatible ID), so Windows binds
+     * WinUSB driver without INF file (device should have USB version 0x0210 or greater,
+     * otherwise BOS descriptor is not requested). WinUSB binding also allows WebUSB access from browser.
+     * If interface GUID is set, DeviceInterfaceGUIDs registry property is added for WinUSB API applications.
+     *
+     * @tparam _Number Interface number
+     * @tparam _Ep0 Zero endpoint
+     * @tparam _OutEp OUT bulk endpoint
+     * @tparam _InEp IN bulk endpoint
+     * @tparam _InterfaceGuid Device interface GUID string in form {xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx} (optional)
+     */
+    template<uint8_t _Number, typename _Ep0, typename _OutEp, typename _InEp, auto _InterfaceGuid = Zhele::TemplateUtils::EmptyFixedString16>
+    class VendorInterface : public Interface<_Number, 0, DeviceAndInterfaceClass::VendorSpecified, 0, 0, _Ep0, _OutEp, _InEp>
+    {
+        using Base = Interface<_Number, 0, DeviceAndInterfaceClass::VendorSpecified, 0, 0, _Ep0, _OutEp, _InEp>;
+    public:
+#if defined (USB)
+        using Stream = VendorBulkStream<_OutEp, _InEp>;
+#endif
+
+        /**
+         * @brief Reset interface
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Reset()
+        {
+            Base::Reset();
+#if defined (USB)
+            Stream::Reset();
+#endif
+        }
+
+        /**
+         * @brief Interface setup request handler
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void SetupHandler()
+        {
+            SetupPacket* setup = reinterpret_cast<SetupPacket*>(_Ep0::RxBuffer);
+
+            if(setup->RequestType.Type == 0 && setup->Request == StandartRequestCode::SetInterface && setup->Value == 0)
+            {
+                _Ep0::SendZLP();
+            }
+            else if(setup->RequestType.Type == 0 && setup->Request == StandartRequestCode::GetInterface)
+            {
+                uint8_t alternateSetting = 0;
+                _Ep0::SendData(&alternateSetting, 1);
+            }
+            else
+            {
+                _Ep0::SetTxStatus(EndpointStatus::Stall);
+            }
+        }
+
+        /**
+         * @brief Returns MS OS 2.0 feature descriptors
+         *
+         * @returns Descriptors bytes
+         */
+        static constexpr auto MsOs20FeatureDescriptors()
+        {
+            if constexpr (_InterfaceGuid.Length == 0)
+                return DescriptorBytes(MsOs20CompatibleIdDescriptor {});
+            else
+                return ConcatDescriptors(DescriptorBytes(MsOs20CompatibleIdDescriptor {}), MsOs20DeviceInterfaceGuidDescriptor<_InterfaceGuid>());
+        }
+    };
+}
+#endif // ZHELE_USB_VENDOR_H
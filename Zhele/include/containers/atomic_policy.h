@@ -0,0 +1,163 @@
+/**
+ * @file
+ * Implements index and counter types for interrupt-safe containers.
+ *
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_CONTAINERS_ATOMIC_POLICY_H
+#define ZHELE_CONTAINERS_ATOMIC_POLICY_H
+
+#include <clock.h>
+
+#include <atomic>
+#include <stdint.h>
+
+namespace Zhele::Containers
+{
+    /**
+     * @brief Value with single writer (producer or consumer index of SPSC container)
+     *
+     * @details
+     * Aligned load and store of up to 32 bits is single-copy atomic on Cortex-M, so single writer
+     * needs neither LDREX/STREX nor interrupts disabling. Supported MCUs are single-core,
+     * so compiler barrier orders buffer access and index update (no DMB is needed).
+     * Memory order arguments are accepted for std::atomic compatibility.
+     *
+     * @tparam _Type Value type (up to 32 bits)
+     */
+    template<typename _Type>
+    class SingleWriterValue
+    {
+        static_assert(sizeof(_Type) <= sizeof(uint32_t), "Value must fit to one word");
+    public:
+        constexpr SingleWriterValue(_Type value = _Type()) : _value(value)
+        {}
+
+        SingleWriterValue(const SingleWriterValue&) = delete;
+        SingleWriterValue& operator=(const SingleWriterValue&) = delete;
+
+        /**
+         * @brief Reads value (acquire: following buffer reads are not moved before it)
+         *
+         * @returns Value
+         */
+        _Type load(std::memory_order = std::memory_order_seq_cst) const
+        {
+            _Type value = _value;
+            std::atomic_signal_fence(std::memory_order_acquire);
+            return value;
+        }
+
+        /**
+         * @brief Writes value (release: preceding buffer writes are not moved after it)
+         *
+         * @param [in] value Value
+         *
+         * @par Returns
+         *  Nothing
+         */
+        void store(_Type value, std::memory_order = std::memory_order_seq_cst)
+        {
+            std::atomic_signal_fence(std::memory_order_release);
+            _value = value;
+        }
+    private:
+        volatile _Type _value;
+    };
+
+    /**
+     * @brief Counter with several writers (for example, items count updated by producer and consumer)
+     *
+     * @details
+     * Read-modify-write is done by LDREX/STREX for Cortex-M3/M4 and with disabled interrupts
+     * (PRIMASK, a few instructions) for Cortex-M0, so libatomic is never required.
+     *
+     * @tparam _Type Value type (up to 32 bits)
+     */
+    template<typename _Type>
+    class SharedCounter
+    {
+        static_assert(sizeof(_Type) <= sizeof(uint32_t), "Value must fit to one word");
+    public:
+        constexpr SharedCounter(_Type value = _Type()) : _value(value)
+        {}
+
+        SharedCounter(const SharedCounter&) = delete;
+        SharedCounter& operator=(const SharedCounter&) = delete;
+
+        /**
+         * @brief Reads value
+         *
+         * @returns Value
+         */
+        _Type load(std::memory_order = std::memory_order_seq_cst) const
+        {
+            _Type value = _value;
+            std::atomic_signal_fence(std::memory_order_acquire);
+            return value;
+        }
+
+        /**
+         * @brief Writes value
+         *
+         * @param [in] value Value
+         *
+         * @par Returns
+         *  Nothing
+         */
+        void store(_Type value, std::memory_order = std::memory_order_seq_cst)
+        {
+            std::atomic_signal_fence(std::memory_order_release);
+            _value = value;
+        }
+
+        /**
+         * @brief Adds value
+         *
+         * @param [in] value Addend
+         *
+         * @returns Previous value
+         */
+        _Type fetch_add(_Type value, std::memory_order = std::memory_order_seq_cst)
+        {
+#if (__CORTEX_M >= 3)
+            return __atomic_fetch_add(&_value, value, __ATOMIC_ACQ_REL);
+#else
+            uint32_t primask = __get_PRIMASK();
+            __disable_irq();
+            _Type previous = _value;
+            _value = static_cast<_Type>(previous + value);
+            __set_PRIMASK(primask);
+            return previous;
+#endif
+        }
+
+        /**
+         * @brief Subtracts value
+         *
+         * @param [in] value Subtrahend
+         *
+         * @returns Previous value
+         */
+        _Type fetch_sub(_Type value, std::memory_order = std::memory_order_seq_cst)
+        {
+#if (__CORTEX_M >= 3)
+            return __atomic_fetch_sub(&_value, value, __ATOMIC_ACQ_REL);
+#else
+            uint32_t primask = __get_PRIMASK();
+            __disable_irq();
+            _Type previous = _value;
+            _value = static_cast<_Type>(previous - value);
+            __set_PRIMASK(primask);
+            return previous;
+#endif
+        }
+    private:
+        volatile _Type _value;
+    };
+}
+
+#endif //! ZHELE_CONTAINERS_ATOMIC_POLICY_H
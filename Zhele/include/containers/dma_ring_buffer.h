@@ -0,0 +1,149 @@
+/**
+ * @file
+ * Implements ring buffer filled by circular DMA.
+ * 
+ * @author Alexey Zhelonkin
+ * @date 2023
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DMARINGBUFFER_H
+#define ZHELE_DMARINGBUFFER_H
+
+#include "ring_buffer.h"
+
+#include <dma.h>
+
+#include <stdint.h>
+
+namespace Zhele::Containers
+{
+    /**
+     * @brief Implements receive ring buffer filled by circular DMA (peripheral to memory).
+     *
+     * @details
+     * Write index is derived from DMA remaining transfers counter, so peripheral data
+     * (USART, ADC, SPI) gets to buffer without any interrupt, consumer just calls size/read.
+     * Consumer interface is the same as of RingBufferPO2. Data is overwritten if consumer
+     * lags buffer size or more behind DMA (overrun cannot be detected without interrupt),
+     * so buffer holds up to _Size - 1 unread items.
+     *
+     * @tparam _DmaChannel DMA channel (stream) of peripheral receive request
+     * @tparam _Size Buffer size (power of 2)
+     * @tparam _DataType Data type (peripheral data register size)
+     */
+    template<typename _DmaChannel, unsigned _Size, typename _DataType = uint8_t>
+    class DmaRingBuffer
+    {
+        static_assert((_Size & (_Size - 1)) == 0, "Size must be a power of 2");
+        static_assert(sizeof(_DataType) == 1 || sizeof(_DataType) == 2 || sizeof(_DataType) == 4, "Data type should be 8, 16 or 32 bits");
+
+        using Base = Private::RingBufferPO2<_Size, _DataType>;
+    public:
+        using size_type = typename Base::size_type;
+        using const_span = typename Base::const_span;
+        using const_span_pair = typename Base::const_span_pair;
+
+        /**
+         * @brief Start circular DMA transfer from peripheral register to buffer
+         *
+         * @details
+         * Peripheral DMA request should be enabled separately. Buffer may also be used
+         * with circular transfer started by driver (Usart::EnableStreamRead(buffer.data(), buffer.capacity())),
+         * then call clear after start.
+         *
+         * @param [in] periph Peripheral data register
+         * @param [in] channel DMA channel (stm32f4 only)
+         *
+         * @par Returns
+         *	Nothing
+         */
+        void start(volatile void* periph ONLY_IF_STREAM_SUPPORTED(COMMA uint8_t channel = 0));
+
+        /**
+         * @brief Stop DMA transfer
+         *
+         * @par Returns
+         *	Nothing
+         */
+        void stop();
+
+        /**
+         * @brief Returns capacity
+         * 
+         * @returns Buffer capacity
+         */
+        static constexpr size_type capacity();
+
+        /**
+         * @brief Returns count of received items
+         * 
+         * @returns Count of items
+         */
+        size_type size() const;
+
+        /**
+         * @brief Check for emptiness
+         * 
+         * @retval true Buffer is empty
+         * @retval false Buffer is not empty
+         */
+        bool empty() const;
+
+        /**
+         * @brief Retrieve several first items
+         *
+         * @param [out] values Output buffer
+         * @param [in] count Max items count
+         * 
+         * @returns Count of retrieved items
+         */
+        size_type read(_DataType* values, size_type count);
+
+        /**
+         * @brief Returns received items for in place read
+         *
+         * @details
+         * The second span is not empty if items wrap around buffer end.
+         *
+         * @returns Received regions
+         */
+        const_span_pair peek_read_span() const;
+
+        /**
+         * @brief Remove items processed in place
+         *
+         * @param [in] count Processed items count
+         *
+         * @returns Count of removed items
+         */
+        size_type consume(size_type count);
+
+        /**
+         * @brief Remove all received items
+         * 
+         * @par Returns
+         *   Nothing
+         */
+        void clear();
+
+        /**
+         * @brief Returns buffer memory (DMA destination)
+         *
+         * @returns Buffer memory
+         */
+        _DataType* data();
+
+    private:
+        size_type write_index() const;
+
+        static constexpr size_type _mask = _Size - 1;
+
+        _DataType _data[_Size];
+        size_type _readIndex = 0;
+    };
+} // namespace Zhele::Containers
+
+#include "impl/dma_ring_buffer.h"
+
+#endif //! ZHELE_DMARINGBUFFER_H
@@ -0,0 +1,112 @@
+/**
+ * @file
+ * DMA ring buffer methods implementation.
+ * 
+ * @author Alexey Zhelonkin
+ * @date 2023
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DMARINGBUFFER_IMPL_H
+#define ZHELE_DMARINGBUFFER_IMPL_H
+
+#include <algorithm>
+
+namespace Zhele::Containers
+{
+    #define DMARINGBUFFER_TEMPLATE_ARGS template<typename _DmaChannel, unsigned _Size, typename _DataType>
+    #define DMARINGBUFFER_TEMPLATE_QUALIFIER DmaRingBuffer<_DmaChannel, _Size, _DataType>
+
+    DMARINGBUFFER_TEMPLATE_ARGS
+    void DMARINGBUFFER_TEMPLATE_QUALIFIER::start(volatile void* periph ONLY_IF_STREAM_SUPPORTED(COMMA uint8_t channel))
+    {
+        typename _DmaChannel::Mode mode = _DmaChannel::Periph2Mem | _DmaChannel::MemIncrement | _DmaChannel::Circular | _DmaChannel::PriorityHigh;
+        if constexpr (sizeof(_DataType) == 2)
+            mode = mode | _DmaChannel::PSize16Bits | _DmaChannel::MSize16Bits;
+        if constexpr (sizeof(_DataType) == 4)
+            mode = mode | _DmaChannel::PSize32Bits | _DmaChannel::MSize32Bits;
+
+        _readIndex = 0;
+        _DmaChannel::SetTransferCallback(nullptr);
+        _DmaChannel::Transfer(mode, _data, periph, _Size ONLY_IF_STREAM_SUPPORTED(COMMA channel));
+    }
+
+    DMARINGBUFFER_TEMPLATE_ARGS
+    void DMARINGBUFFER_TEMPLATE_QUALIFIER::stop()
+    {
+        _DmaChannel::Disable();
+    }
+
+    DMARINGBUFFER_TEMPLATE_ARGS
+    constexpr typename DMARINGBUFFER_TEMPLATE_QUALIFIER::size_type DMARINGBUFFER_TEMPLATE_QUALIFIER::capacity()
+    {
+        return _Size;
+    }
+
+    DMARINGBUFFER_TEMPLATE_ARGS
+    typename DMARINGBUFFER_TEMPLATE_QUALIFIER::size_type DMARINGBUFFER_TEMPLATE_QUALIFIER::size() const
+    {
+        return (write_index() - _readIndex) & _mask;
+    }
+
+    DMARINGBUFFER_TEMPLATE_ARGS
+    bool DMARINGBUFFER_TEMPLATE_QUALIFIER::empty() const
+    {
+        return write_index() == _readIndex;
+    }
+
+    DMARINGBUFFER_TEMPLATE_ARGS
+    typename DMARINGBUFFER_TEMPLATE_QUALIFIER::size_type DMARINGBUFFER_TEMPLATE_QUALIFIER::read(_DataType* values, size_type count)
+    {
+        const_span_pair received = peek_read_span();
+        if(count > received.size())
+            count = received.size();
+
+        size_type first = received.first.size < count ? received.first.size : count;
+        std::copy(received.first.data, received.first.data + first, values);
+        std::copy(received.second.data, received.second.data + (count - first), values + first);
+
+        return consume(count);
+    }
+
+    DMARINGBUFFER_TEMPLATE_ARGS
+    typename DMARINGBUFFER_TEMPLATE_QUALIFIER::const_span_pair DMARINGBUFFER_TEMPLATE_QUALIFIER::peek_read_span() const
+    {
+        size_type writeIndex = write_index();
+        if(writeIndex >= _readIndex)
+            return {{_data + _readIndex, size_type(writeIndex - _readIndex)}, {_data, 0}};
+        return {{_data + _readIndex, size_type(_Size - _readIndex)}, {_data, writeIndex}};
+    }
+
+    DMARINGBUFFER_TEMPLATE_ARGS
+    typename DMARINGBUFFER_TEMPLATE_QUALIFIER::size_type DMARINGBUFFER_TEMPLATE_QUALIFIER::consume(size_type count)
+    {
+        size_type available = size();
+        if(count > available)
+            count = available;
+
+        _readIndex = (_readIndex + count) & _mask;
+        return count;
+    }
+
+    DMARINGBUFFER_TEMPLATE_ARGS
+    void DMARINGBUFFER_TEMPLATE_QUALIFIER::clear()
+    {
+        _readIndex = write_index();
+    }
+
+    DMARINGBUFFER_TEMPLATE_ARGS
+    _DataType* DMARINGBUFFER_TEMPLATE_QUALIFIER::data()
+    {
+        return _data;
+    }
+
+    DMARINGBUFFER_TEMPLATE_ARGS
+    typename DMARINGBUFFER_TEMPLATE_QUALIFIER::size_type DMARINGBUFFER_TEMPLATE_QUALIFIER::write_index() const
+    {
+        // NDTR is reloaded to buffer size after wrap, so _Size maps to 0
+        return (_Size - _DmaChannel::RemainingTransfers()) & _mask;
+    }
+}
+
+#endif //! ZHELE_DMARINGBUFFER_IMPL_H
@@ -0,0 +1,145 @@
+/**
+ * @file
+ * Intrusive list methods implementation.
+ * 
+ * @author Alexey Zhelonkin
+ * @date 2023
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_INTRUSIVELIST_IMPL_H
+#define ZHELE_INTRUSIVELIST_IMPL_H
+
+namespace Zhele::Containers
+{
+    #define INTRUSIVELIST_TEMPLATE_ARGS template<typename _DataType, bool _IsrSafe>
+    #define INTRUSIVELIST_TEMPLATE_QUALIFIER IntrusiveList<_DataType, _IsrSafe>
+
+    INTRUSIVELIST_TEMPLATE_ARGS
+    INTRUSIVELIST_TEMPLATE_QUALIFIER::IntrusiveList()
+    {
+        _root._prev = &_root;
+        _root._next = &_root;
+    }
+
+    INTRUSIVELIST_TEMPLATE_ARGS
+    bool INTRUSIVELIST_TEMPLATE_QUALIFIER::empty() const
+    {
+        return _root._next == &_root;
+    }
+
+    INTRUSIVELIST_TEMPLATE_ARGS
+    size_t INTRUSIVELIST_TEMPLATE_QUALIFIER::size() const
+    {
+        Lock lock;
+        size_t count = 0;
+        for(const IntrusiveListNode* node = _root._next; node != &_root; node = node->_next)
+            ++count;
+        return count;
+    }
+
+    INTRUSIVELIST_TEMPLATE_ARGS
+    void INTRUSIVELIST_TEMPLATE_QUALIFIER::push_front(_DataType& item)
+    {
+        Lock lock;
+        link(_root._next, &item);
+    }
+
+    INTRUSIVELIST_TEMPLATE_ARGS
+    void INTRUSIVELIST_TEMPLATE_QUALIFIER::push_back(_DataType& item)
+    {
+        Lock lock;
+        link(&_root, &item);
+    }
+
+    INTRUSIVELIST_TEMPLATE_ARGS
+    void INTRUSIVELIST_TEMPLATE_QUALIFIER::insert(_DataType& position, _DataType& item)
+    {
+        Lock lock;
+        link(&position, &item);
+    }
+
+    INTRUSIVELIST_TEMPLATE_ARGS
+    void INTRUSIVELIST_TEMPLATE_QUALIFIER::remove(_DataType& item)
+    {
+        Lock lock;
+        if(item.linked())
+            unlink(&item);
+    }
+
+    INTRUSIVELIST_TEMPLATE_ARGS
+    _DataType* INTRUSIVELIST_TEMPLATE_QUALIFIER::pop_front()
+    {
+        Lock lock;
+        if(empty())
+            return nullptr;
+
+        IntrusiveListNode* node = _root._next;
+        unlink(node);
+        return static_cast<_DataType*>(node);
+    }
+
+    INTRUSIVELIST_TEMPLATE_ARGS
+    _DataType* INTRUSIVELIST_TEMPLATE_QUALIFIER::pop_back()
+    {
+        Lock lock;
+        if(empty())
+            return nullptr;
+
+        IntrusiveListNode* node = _root._prev;
+        unlink(node);
+        return static_cast<_DataType*>(node);
+    }
+
+    INTRUSIVELIST_TEMPLATE_ARGS
+    _DataType* INTRUSIVELIST_TEMPLATE_QUALIFIER::front() const
+    {
+        return empty() ? nullptr : static_cast<_DataType*>(_root._next);
+    }
+
+    INTRUSIVELIST_TEMPLATE_ARGS
+    _DataType* INTRUSIVELIST_TEMPLATE_QUALIFIER::back() const
+    {
+        return empty() ? nullptr : static_cast<_DataType*>(_root._prev);
+    }
+
+    INTRUSIVELIST_TEMPLATE_ARGS
+    void INTRUSIVELIST_TEMPLATE_QUALIFIER::clear()
+    {
+        Lock lock;
+        while(!empty())
+            unlink(_root._next);
+    }
+
+    INTRUSIVELIST_TEMPLATE_ARGS
+    typename INTRUSIVELIST_TEMPLATE_QUALIFIER::iterator INTRUSIVELIST_TEMPLATE_QUALIFIER::begin()
+    {
+        return iterator(_root._next);
+    }
+
+    INTRUSIVELIST_TEMPLATE_ARGS
+    typename INTRUSIVELIST_TEMPLATE_QUALIFIER::iterator INTRUSIVELIST_TEMPLATE_QUALIFIER::end()
+    {
+        return iterator(&_root);
+    }
+
+    INTRUSIVELIST_TEMPLATE_ARGS
+    void INTRUSIVELIST_TEMPLATE_QUALIFIER::link(IntrusiveListNode* before, IntrusiveListNode* node)
+    {
+        node->_next = before;
+        node->_prev = before->_prev;
+        before->_prev->_next = node;
+        before->_prev = node;
+    }
+
+    INTRUSIVELIST_TEMPLATE_ARGS
+    void INTRUSIVELIST_TEMPLATE_QUALIFIER::unlink(IntrusiveListNode* node)
+    {
+        node->_prev->_next = node->_next;
+        node->_next->_prev = node->_prev;
+        node->_prev = nullptr;
+        node->_next = nullptr;
+    }
+}
+
+#endif //! ZHELE_INTRUSIVELIST_IMPL_H
@@ -0,0 +1,39 @@
+/**
+ * @file
+ * Implements optional interrupt lock for containers.
+ * 
+ * @author Alexey Zhelonkin
+ * @date 2023
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_CONTAINERS_ISRLOCK_H
+#define ZHELE_CONTAINERS_ISRLOCK_H
+
+#include <clock.h>
+#include "../../common/nvic.h"
+
+#include <stdint.h>
+
+namespace Zhele::Containers::Private
+{
+    /**
+     * @brief Critical section for the scope (see ZHELE_DRIVER_CRITICAL_PRIORITY)
+     *
+     * @tparam _Enabled Disable interrupts (empty object otherwise)
+     */
+    template<bool _Enabled>
+    class IsrLock : public DriverCriticalSection
+    {
+    };
+
+    template<>
+    class IsrLock<false>
+    {
+    public:
+        // User-provided constructor: unused lock variable is not warned
+        IsrLock() {}
+    };
+}
+
+#endif //! ZHELE_CONTAINERS_ISRLOCK_H
@@ -0,0 +1,154 @@
+/**
+ * @file
+ * Memory pool methods implementation.
+ * 
+ * @author Alexey Zhelonkin
+ * @date 2023
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_MEMORYPOOL_IMPL_H
+#define ZHELE_MEMORYPOOL_IMPL_H
+
+namespace Zhele::Containers
+{
+    #define MEMORYPOOL_TEMPLATE_ARGS template<size_t _BlockSize, unsigned _BlocksCount, size_t _Alignment>
+    #define MEMORYPOOL_TEMPLATE_QUALIFIER MemoryPool<_BlockSize, _BlocksCount, _Alignment>
+
+    MEMORYPOOL_TEMPLATE_ARGS
+    MEMORYPOOL_TEMPLATE_QUALIFIER::MemoryPool() : _head(head(0, 0)), _available(_BlocksCount)
+    {
+        for(unsigned i = 0; i < _BlocksCount; ++i)
+            next(i) = i + 1 < _BlocksCount ? i + 1 : NoBlock;
+    }
+
+    MEMORYPOOL_TEMPLATE_ARGS
+    void* MEMORYPOOL_TEMPLATE_QUALIFIER::allocate()
+    {
+#if (__CORTEX_M >= 3)
+        uint32_t current = _head.load(std::memory_order_acquire);
+        for(;;)
+        {
+            uint16_t index = current & 0xffff;
+            if(index == NoBlock)
+                return nullptr;
+            // Block may be taken by interrupt meanwhile, then version differs and CAS fails
+            uint32_t updated = head((current >> 16) + 1, next(index));
+            if(_head.compare_exchange_weak(current, updated, std::memory_order_acquire, std::memory_order_acquire))
+            {
+                _available.fetch_sub(1, std::memory_order_relaxed);
+                return &_storage[index * BlockSize];
+            }
+        }
+#else
+        uint32_t state = DriverCriticalSection::Enter();
+
+        uint32_t current = _head.load(std::memory_order_relaxed);
+        uint16_t index = current & 0xffff;
+        void* block = nullptr;
+        if(index != NoBlock)
+        {
+            _head.store(head((current >> 16) + 1, next(index)), std::memory_order_relaxed);
+            _available.store(_available.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
+            block = &_storage[index * BlockSize];
+        }
+
+        DriverCriticalSection::Leave(state);
+        return block;
+#endif
+    }
+
+    MEMORYPOOL_TEMPLATE_ARGS
+    void MEMORYPOOL_TEMPLATE_QUALIFIER::deallocate(void* block)
+    {
+        if(block == nullptr)
+            return;
+
+        uint16_t index = (static_cast<uint8_t*>(block) - _storage) / BlockSize;
+#if (__CORTEX_M >= 3)
+        uint32_t current = _head.load(std::memory_order_relaxed);
+        do
+        {
+            next(index) = current & 0xffff;
+        }
+        while(!_head.compare_exchange_weak(current, head((current >> 16) + 1, index), std::memory_order_release, std::memory_order_relaxed));
+        _available.fetch_add(1, std::memory_order_relaxed);
+#else
+        uint32_t state = DriverCriticalSection::Enter();
+
+        uint32_t current = _head.load(std::memory_order_relaxed);
+        next(index) = current & 0xffff;
+        _head.store(head((current >> 16) + 1, index), std::memory_order_relaxed);
+        _available.store(_available.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+        DriverCriticalSection::Leave(state);
+#endif
+    }
+
+    MEMORYPOOL_TEMPLATE_ARGS
+    bool MEMORYPOOL_TEMPLATE_QUALIFIER::owns(const void* block) const
+    {
+        const uint8_t* address = static_cast<const uint8_t*>(block);
+        return address >= _storage && address < _storage + sizeof(_storage)
+            && (address - _storage) % BlockSize == 0;
+    }
+
+    MEMORYPOOL_TEMPLATE_ARGS
+    constexpr unsigned MEMORYPOOL_TEMPLATE_QUALIFIER::capacity()
+    {
+        return _BlocksCount;
+    }
+
+    MEMORYPOOL_TEMPLATE_ARGS
+    unsigned MEMORYPOOL_TEMPLATE_QUALIFIER::available() const
+    {
+        return _available.load(std::memory_order_relaxed);
+    }
+
+    MEMORYPOOL_TEMPLATE_ARGS
+    uint16_t& MEMORYPOOL_TEMPLATE_QUALIFIER::next(uint16_t index)
+    {
+        return *reinterpret_cast<uint16_t*>(&_storage[index * BlockSize]);
+    }
+
+    MEMORYPOOL_TEMPLATE_ARGS
+    constexpr uint32_t MEMORYPOOL_TEMPLATE_QUALIFIER::head(uint32_t version, uint16_t index)
+    {
+        return (version << 16) | index;
+    }
+
+    #define OBJECTPOOL_TEMPLATE_ARGS template<typename _Type, unsigned _Count>
+    #define OBJECTPOOL_TEMPLATE_QUALIFIER ObjectPool<_Type, _Count>
+
+    OBJECTPOOL_TEMPLATE_ARGS
+    template<typename... _Args>
+    _Type* OBJECTPOOL_TEMPLATE_QUALIFIER::create(_Args&&... args)
+    {
+        void* memory = _pool.allocate();
+        return memory ? new(memory) _Type(std::forward<_Args>(args)...) : nullptr;
+    }
+
+    OBJECTPOOL_TEMPLATE_ARGS
+    void OBJECTPOOL_TEMPLATE_QUALIFIER::destroy(_Type* object)
+    {
+        if(object == nullptr)
+            return;
+
+        object->~_Type();
+        _pool.deallocate(object);
+    }
+
+    OBJECTPOOL_TEMPLATE_ARGS
+    constexpr unsigned OBJECTPOOL_TEMPLATE_QUALIFIER::capacity()
+    {
+        return _Count;
+    }
+
+    OBJECTPOOL_TEMPLATE_ARGS
+    unsigned OBJECTPOOL_TEMPLATE_QUALIFIER::available() const
+    {
+        return _pool.available();
+    }
+}
+
+#endif //! ZHELE_MEMORYPOOL_IMPL_H
@@ -0,0 +1,90 @@
+/**
+ * @file
+ * MPMC queue methods implementation
+ * 
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_MPMCQUEUE_IMPL_H
+#define ZHELE_MPMCQUEUE_IMPL_H
+
+namespace Zhele::Containers
+{
+    #define MPMCQUEUE_TEMPLATE_ARGS template<typename _Type, unsigned _Size>
+    #define MPMCQUEUE_TEMPLATE_QUALIFIER MpmcQueue<_Type, _Size>
+
+    MPMCQUEUE_TEMPLATE_ARGS
+    typename MPMCQUEUE_TEMPLATE_QUALIFIER::size_type MPMCQUEUE_TEMPLATE_QUALIFIER::size() const
+    {
+        uint32_t head = _head.load(std::memory_order_relaxed);
+        uint32_t tail = _tail.load(std::memory_order_relaxed);
+        int32_t count = static_cast<int32_t>(tail - head);
+        return count < 0 ? 0 : (count > static_cast<int32_t>(_Size) ? _Size : count);
+    }
+
+    MPMCQUEUE_TEMPLATE_ARGS
+    bool MPMCQUEUE_TEMPLATE_QUALIFIER::empty() const
+    {
+        uint32_t head = _head.load(std::memory_order_relaxed);
+        return _cells[head % _Size].Sequence.load(std::memory_order_acquire) != Lap(head) + 1;
+    }
+
+    MPMCQUEUE_TEMPLATE_ARGS
+    bool MPMCQUEUE_TEMPLATE_QUALIFIER::Reserve(std::atomic<uint32_t>& index, uint32_t ready, uint32_t& position)
+    {
+#if (__CORTEX_M >= 3)
+        position = index.load(std::memory_order_relaxed);
+        for(;;)
+        {
+            Cell& cell = _cells[position % _Size];
+            int32_t diff = static_cast<int32_t>(cell.Sequence.load(std::memory_order_acquire) - (Lap(position) + ready));
+            if(diff < 0)
+                return false;
+            if(diff == 0 && index.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                return true;
+            if(diff > 0)
+                position = index.load(std::memory_order_relaxed);
+        }
+#else
+        uint32_t state = DriverCriticalSection::Enter();
+
+        position = index.load(std::memory_order_relaxed);
+        bool reserved = _cells[position % _Size].Sequence.load(std::memory_order_relaxed) == Lap(position) + ready;
+        if(reserved)
+            index.store(position + 1, std::memory_order_relaxed);
+
+        DriverCriticalSection::Leave(state);
+        return reserved;
+#endif
+    }
+
+    MPMCQUEUE_TEMPLATE_ARGS
+    bool MPMCQUEUE_TEMPLATE_QUALIFIER::push(const _Type& value)
+    {
+        uint32_t position;
+        if(!Reserve(_tail, 0, position))
+            return false;
+
+        Cell& cell = _cells[position % _Size];
+        cell.Value = value;
+        cell.Sequence.store(Lap(position) + 1, std::memory_order_release);
+        return true;
+    }
+
+    MPMCQUEUE_TEMPLATE_ARGS
+    bool MPMCQUEUE_TEMPLATE_QUALIFIER::pop(_Type& value)
+    {
+        uint32_t position;
+        if(!Reserve(_head, 1, position))
+            return false;
+
+        Cell& cell = _cells[position % _Size];
+        value = cell.Value;
+        cell.Sequence.store(Lap(position) + _Size, std::memory_order_release);
+        return true;
+    }
+}
+
+#endif //! ZHELE_MPMCQUEUE_IMPL_H
@@ -0,0 +1,111 @@
+/**
+ * @file
+ * Record queue methods implementation
+ * 
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_RECORDQUEUE_IMPL_H
+#define ZHELE_RECORDQUEUE_IMPL_H
+
+#include <string.h>
+
+namespace Zhele::Containers
+{
+    #define RECORDQUEUE_TEMPLATE_ARGS template<unsigned _Size>
+    #define RECORDQUEUE_TEMPLATE_QUALIFIER RecordQueue<_Size>
+
+    RECORDQUEUE_TEMPLATE_ARGS
+    bool RECORDQUEUE_TEMPLATE_QUALIFIER::empty() const
+    {
+        return _buffer.empty();
+    }
+
+    RECORDQUEUE_TEMPLATE_ARGS
+    uint8_t* RECORDQUEUE_TEMPLATE_QUALIFIER::acquire(size_type size)
+    {
+        _acquired = nullptr;
+        size_type total = sizeof(Header) + Align(size);
+        typename Buffer::span_pair free = _buffer.acquire_write_span();
+
+        // All commits are multiples of header size, so buffer tail is either empty or holds header
+        uint8_t* header = free.first.data;
+        _padding = 0;
+        if(free.first.size < total)
+        {
+            if(free.second.size < total)
+                return nullptr;
+            // Padding is visible for consumer only after commit
+            *reinterpret_cast<Header*>(free.first.data) = Padding;
+            _padding = free.first.size;
+            header = free.second.data;
+        }
+
+        _acquired = header;
+        _acquiredSize = size;
+        return header + sizeof(Header);
+    }
+
+    RECORDQUEUE_TEMPLATE_ARGS
+    void RECORDQUEUE_TEMPLATE_QUALIFIER::commit(size_type size)
+    {
+        if(_acquired == nullptr)
+            return;
+        if(size > _acquiredSize)
+            size = _acquiredSize;
+
+        *reinterpret_cast<Header*>(_acquired) = size;
+        _buffer.commit(_padding + sizeof(Header) + Align(size));
+        _acquired = nullptr;
+    }
+
+    RECORDQUEUE_TEMPLATE_ARGS
+    bool RECORDQUEUE_TEMPLATE_QUALIFIER::push(const void* data, size_type size)
+    {
+        uint8_t* record = acquire(size);
+        if(record == nullptr)
+            return false;
+
+        memcpy(record, data, size);
+        commit(size);
+        return true;
+    }
+
+    RECORDQUEUE_TEMPLATE_ARGS
+    typename RECORDQUEUE_TEMPLATE_QUALIFIER::const_span RECORDQUEUE_TEMPLATE_QUALIFIER::front() const
+    {
+        typename Buffer::const_span_pair stored = _buffer.peek_read_span();
+        if(stored.size() == 0)
+            return {nullptr, 0};
+
+        // Padding is always followed by record at buffer start
+        const uint8_t* header = stored.first.data;
+        if(*reinterpret_cast<const Header*>(header) == Padding)
+            header = stored.second.data;
+
+        return {header + sizeof(Header), *reinterpret_cast<const Header*>(header)};
+    }
+
+    RECORDQUEUE_TEMPLATE_ARGS
+    bool RECORDQUEUE_TEMPLATE_QUALIFIER::pop()
+    {
+        typename Buffer::const_span_pair stored = _buffer.peek_read_span();
+        if(stored.size() == 0)
+            return false;
+
+        size_type padding = 0;
+        const uint8_t* header = stored.first.data;
+        if(*reinterpret_cast<const Header*>(header) == Padding)
+        {
+            padding = stored.first.size;
+            header = stored.second.data;
+        }
+
+        _buffer.consume(padding + sizeof(Header) + Align(*reinterpret_cast<const Header*>(header)));
+        return true;
+    }
+}
+
+#endif //! ZHELE_RECORDQUEUE_IMPL_H
@@ -10,6 +10,7 @@
 #ifndef ZHELE_RINGBUFFER_IMPL_H
 #define ZHELE_RINGBUFFER_IMPL_H
 
+#include <algorithm>
 #include <atomic>
 
 namespace Zhele::Containers::Private
@@ -28,48 +29,51 @@ namespace Zhele::Containers::Private
         return _Size;
     }
 
+    // Single producer/single consumer: each side owns its counter (relaxed load)
+    // and publishes it by release store, counter of other side is loaded with acquire,
+    // so items are copied before index update is visible.
+
     RINGBUFFERPO2_TEMPLATE_ARGS
     typename RINGBUFFERPO2_TEMPLATE_QUALIFIER::size_type RINGBUFFERPO2_TEMPLATE_QUALIFIER::size() const
     {
-        return (_writeCount.load() - _readCount.load());
+        return size_type(_writeCount.load(std::memory_order_acquire) - _readCount.load(std::memory_order_acquire));
     }
 
     RINGBUFFERPO2_TEMPLATE_ARGS
     bool RINGBUFFERPO2_TEMPLATE_QUALIFIER::empty()const
     {
-        return _writeCount.load() == _readCount;
+        return size() == 0;
     }
 
     
     RINGBUFFERPO2_TEMPLATE_ARGS
     bool RINGBUFFERPO2_TEMPLATE_QUALIFIER::full()const
     {
-        return ((_writeCount - _readCount.load()) &
-                (size_type)~(_mask)) != 0;
+        return (size() & (size_type)~(_mask)) != 0;
     }
 
     RINGBUFFERPO2_TEMPLATE_ARGS
     _DataType& RINGBUFFERPO2_TEMPLATE_QUALIFIER::front()
     {
-        return data()[_readCount & _mask];
+        return data()[_readCount.load(std::memory_order_relaxed) & _mask];
     }
 
     RINGBUFFERPO2_TEMPLATE_ARGS
     const _DataType& RINGBUFFERPO2_TEMPLATE_QUALIFIER::front() const
     {
-        return data()[_readCount & _mask];
+        return data()[_readCount.load(std::memory_order_relaxed) & _mask];
     }
 
     RINGBUFFERPO2_TEMPLATE_ARGS
     _DataType& RINGBUFFERPO2_TEMPLATE_QUALIFIER::back()
     {
-        return data()[(_writeCount-1) & _mask];
+        return data()[(_writeCount.load(std::memory_order_relaxed) - 1) & _mask];
     }
 
     RINGBUFFERPO2_TEMPLATE_ARGS
     const _DataType& RINGBUFFERPO2_TEMPLATE_QUALIFIER::back()const
     {
-        return data()[(_writeCount - 1) & _mask];
+        return data()[(_writeCount.load(std::memory_order_relaxed) - 1) & _mask];
     }
 
     RINGBUFFERPO2_TEMPLATE_ARGS
@@ -78,7 +82,9 @@ namespace Zhele::Containers::Private
         if(full())
             return false;
 
-        data()[_writeCount++ & _mask] = value;
+        size_type writeCount = _writeCount.load(std::memory_order_relaxed);
+        data()[writeCount & _mask] = value;
+        _writeCount.store(size_type(writeCount + 1), std::memory_order_release);
 
         return true;
     }
@@ -88,7 +94,10 @@ namespace Zhele::Containers::Private
     {
         if(full())
             return 0;
-        new(&data()[_writeCount++ & _mask]) _DataType();
+
+        size_type writeCount = _writeCount.load(std::memory_order_relaxed);
+        new(&data()[writeCount & _mask]) _DataType();
+        _writeCount.store(size_type(writeCount + 1), std::memory_order_release);
         return true;
     }
 
@@ -98,7 +107,7 @@ namespace Zhele::Containers::Private
         if(empty())
             return false;
 
-        ++_readCount;
+        _readCount.store(size_type(_readCount.load(std::memory_order_relaxed) + 1), std::memory_order_release);
 
         return true;
     }    
@@ -106,20 +115,108 @@ namespace Zhele::Containers::Private
     RINGBUFFERPO2_TEMPLATE_ARGS
     void RINGBUFFERPO2_TEMPLATE_QUALIFIER::clear()
     {
-        _readCount = 0;
-        _writeCount = 0;
+        _readCount.store(0);
+        _writeCount.store(0);
     }
 
     RINGBUFFERPO2_TEMPLATE_ARGS
     _DataType& RINGBUFFERPO2_TEMPLATE_QUALIFIER::operator[] (size_type index)
     {
-        return data()[(_readCount + index) & _mask];
+        return data()[(_readCount.load(std::memory_order_relaxed) + index) & _mask];
     }
 
     RINGBUFFERPO2_TEMPLATE_ARGS
     const _DataType& RINGBUFFERPO2_TEMPLATE_QUALIFIER::operator[] (size_type index)const
     {
-        return data()[(_readCount + index) & _mask];
+        return data()[(_readCount.load(std::memory_order_relaxed) + index) & _mask];
+    }
+
+    RINGBUFFERPO2_TEMPLATE_ARGS
+    typename RINGBUFFERPO2_TEMPLATE_QUALIFIER::size_type RINGBUFFERPO2_TEMPLATE_QUALIFIER::write(const _DataType* values, size_type count)
+    {
+        span_pair free = acquire_write_span();
+        if(count > free.size())
+            count = free.size();
+
+        size_type first = free.first.size < count ? free.first.size : count;
+        std::copy(values, values + first, free.first.data);
+        std::copy(values + first, values + count, free.second.data);
+
+        return commit(count);
+    }
+
+    RINGBUFFERPO2_TEMPLATE_ARGS
+    typename RINGBUFFERPO2_TEMPLATE_QUALIFIER::size_type RINGBUFFERPO2_TEMPLATE_QUALIFIER::read(_DataType* values, size_type count)
+    {
+        const_span_pair stored = peek_read_span();
+        if(count > stored.size())
+            count = stored.size();
+
+        size_type first = stored.first.size < count ? stored.first.size : count;
+        std::copy(stored.first.data, stored.first.data + first, values);
+        std::copy(stored.second.data, stored.second.data + (count - first), values + first);
+
+        return consume(count);
+    }
+
+    RINGBUFFERPO2_TEMPLATE_ARGS
+    typename RINGBUFFERPO2_TEMPLATE_QUALIFIER::size_type RINGBUFFERPO2_TEMPLATE_QUALIFIER::contiguous_size() const
+    {
+        return peek_read_span().first.size;
+    }
+
+    RINGBUFFERPO2_TEMPLATE_ARGS
+    typename RINGBUFFERPO2_TEMPLATE_QUALIFIER::size_type RINGBUFFERPO2_TEMPLATE_QUALIFIER::skip(size_type count)
+    {
+        return consume(count);
+    }
+
+    RINGBUFFERPO2_TEMPLATE_ARGS
+    typename RINGBUFFERPO2_TEMPLATE_QUALIFIER::span_pair RINGBUFFERPO2_TEMPLATE_QUALIFIER::acquire_write_span()
+    {
+        size_type writeCount = _writeCount.load(std::memory_order_relaxed);
+        size_type free = size_type(_Size - size_type(writeCount - _readCount.load(std::memory_order_acquire)));
+        size_type start = writeCount & _mask;
+        size_type tail = size_type(_Size - start);
+        size_type first = tail < free ? tail : free;
+
+        return {{data() + start, first}, {data(), size_type(free - first)}};
+    }
+
+    RINGBUFFERPO2_TEMPLATE_ARGS
+    typename RINGBUFFERPO2_TEMPLATE_QUALIFIER::size_type RINGBUFFERPO2_TEMPLATE_QUALIFIER::commit(size_type count)
+    {
+        size_type writeCount = _writeCount.load(std::memory_order_relaxed);
+        size_type free = size_type(_Size - size_type(writeCount - _readCount.load(std::memory_order_acquire)));
+        if(count > free)
+            count = free;
+
+        _writeCount.store(size_type(writeCount + count), std::memory_order_release);
+        return count;
+    }
+
+    RINGBUFFERPO2_TEMPLATE_ARGS
+    typename RINGBUFFERPO2_TEMPLATE_QUALIFIER::const_span_pair RINGBUFFERPO2_TEMPLATE_QUALIFIER::peek_read_span() const
+    {
+        size_type readCount = _readCount.load(std::memory_order_relaxed);
+        size_type available = size_type(_writeCount.load(std::memory_order_acquire) - readCount);
+        size_type start = readCount & _mask;
+        size_type tail = size_type(_Size - start);
+        size_type first = tail < available ? tail : available;
+
+        return {{data() + start, first}, {data(), size_type(available - first)}};
+    }
+
+    RINGBUFFERPO2_TEMPLATE_ARGS
+    typename RINGBUFFERPO2_TEMPLATE_QUALIFIER::size_type RINGBUFFERPO2_TEMPLATE_QUALIFIER::consume(size_type count)
+    {
+        size_type readCount = _readCount.load(std::memory_order_relaxed);
+        size_type available = size_type(_writeCount.load(std::memory_order_acquire) - readCount);
+        if(count > available)
+            count = available;
+
+        _readCount.store(size_type(readCount + count), std::memory_order_release);
+        return count;
     }
 
     RINGBUFFERPO2_TEMPLATE_ARGS
@@ -168,25 +265,27 @@ namespace Zhele::Containers::Private
     RINGBUFFER_TEMPLATE_ARGS
     _DataType& RINGBUFFER_TEMPLATE_QUALIFIER::front()
     {
-        return data()[_first];
+        return data()[_first.load()];
     }
 
     RINGBUFFER_TEMPLATE_ARGS
     const _DataType& RINGBUFFER_TEMPLATE_QUALIFIER::front()const
     {
-        return data()[_first];
+        return data()[_first.load()];
     }
 
     RINGBUFFER_TEMPLATE_ARGS
     _DataType& RINGBUFFER_TEMPLATE_QUALIFIER::back()
     {
-        return data()[_last-1];
+        size_type last = _last.load();
+        return data()[last == 0 ? _Size - 1 : last - 1];
     }
 
     RINGBUFFER_TEMPLATE_ARGS
     const _DataType& RINGBUFFER_TEMPLATE_QUALIFIER::back()const
     {
-        return data()[_last-1];
+        size_type last = _last.load();
+        return data()[last == 0 ? _Size - 1 : last - 1];
     }
 
     RINGBUFFER_TEMPLATE_ARGS
@@ -194,10 +293,10 @@ namespace Zhele::Containers::Private
     {
         if(_count.load() == _Size)
             return false;
-        data()[_last] = item;
-        _last++;
-        if(_last >= _Size)
-            _last = 0;
+        size_type last = _last.load();
+        data()[last] = item;
+        ++last;
+        _last.store(last >= _Size ? 0 : last);
         _count.fetch_add(1);
         return true;
     }
@@ -207,12 +306,10 @@ namespace Zhele::Containers::Private
     {
         if(_count.load() == _Size)
             return false;
-        new (&data()[_last]) _DataType();
-        ++_last;
-
-        if(_last >= _Size)
-            _last = 0;
-
+        size_type last = _last.load();
+        new (&data()[last]) _DataType();
+        ++last;
+        _last.store(last >= _Size ? 0 : last);
         _count.fetch_add(1);
         
         return true;
@@ -221,13 +318,11 @@ namespace Zhele::Containers::Private
     RINGBUFFER_TEMPLATE_ARGS
     bool RINGBUFFER_TEMPLATE_QUALIFIER::pop_front()
     {
-        if(&_count.load() != 0)
+        if(_count.load() != 0)
         {
+            size_type first = _first.load() + 1;
+            _first.store(first >= _Size ? 0 : first);
             _count.fetch_sub(1);
-            ++_first;
-
-            if(_first >= _Size)
-                _first = 0;
 
             return true;
         }
@@ -238,17 +333,15 @@ namespace Zhele::Containers::Private
     RINGBUFFER_TEMPLATE_ARGS
     void RINGBUFFER_TEMPLATE_QUALIFIER::clear()
     {
-        do
-        {
-            _first = _last = 0;
-        }
-        while(!_count.compare_exchange_weak(_count.load(), size_type(0)));
+        _count.store(0);
+        _first.store(0);
+        _last.store(0);
     }
 
     RINGBUFFER_TEMPLATE_ARGS
     _DataType& RINGBUFFER_TEMPLATE_QUALIFIER::operator[](size_type index)
     {
-        size_type offset = _first + index;
+        size_type offset = _first.load() + index;
         
         if(offset >= _Size)
             offset -= _Size;
@@ -259,7 +352,7 @@ namespace Zhele::Containers::Private
     RINGBUFFER_TEMPLATE_ARGS
     const _DataType& RINGBUFFER_TEMPLATE_QUALIFIER::operator[](size_type index)const
     {
-        size_type offset = _first + index;
+        size_type offset = _first.load() + index;
         
         if(offset >= _Size)
             offset -= _Size;
@@ -0,0 +1,133 @@
+/**
+ * @file
+ * Static priority queue methods implementation.
+ * 
+ * @author Alexey Zhelonkin
+ * @date 2023
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_STATICPRIORITYQUEUE_IMPL_H
+#define ZHELE_STATICPRIORITYQUEUE_IMPL_H
+
+#include <utility>
+
+namespace Zhele::Containers
+{
+    #define STATICPRIORITYQUEUE_TEMPLATE_ARGS template<typename _DataType, size_t _Capacity, typename _Compare, bool _IsrSafe>
+    #define STATICPRIORITYQUEUE_TEMPLATE_QUALIFIER StaticPriorityQueue<_DataType, _Capacity, _Compare, _IsrSafe>
+
+    STATICPRIORITYQUEUE_TEMPLATE_ARGS
+    constexpr typename STATICPRIORITYQUEUE_TEMPLATE_QUALIFIER::size_type STATICPRIORITYQUEUE_TEMPLATE_QUALIFIER::capacity()
+    {
+        return _Capacity;
+    }
+
+    STATICPRIORITYQUEUE_TEMPLATE_ARGS
+    typename STATICPRIORITYQUEUE_TEMPLATE_QUALIFIER::size_type STATICPRIORITYQUEUE_TEMPLATE_QUALIFIER::size() const
+    {
+        return _heap.size();
+    }
+
+    STATICPRIORITYQUEUE_TEMPLATE_ARGS
+    bool STATICPRIORITYQUEUE_TEMPLATE_QUALIFIER::empty() const
+    {
+        return _heap.empty();
+    }
+
+    STATICPRIORITYQUEUE_TEMPLATE_ARGS
+    bool STATICPRIORITYQUEUE_TEMPLATE_QUALIFIER::full() const
+    {
+        return _heap.full();
+    }
+
+    STATICPRIORITYQUEUE_TEMPLATE_ARGS
+    const _DataType& STATICPRIORITYQUEUE_TEMPLATE_QUALIFIER::top() const
+    {
+        return _heap.front();
+    }
+
+    STATICPRIORITYQUEUE_TEMPLATE_ARGS
+    bool STATICPRIORITYQUEUE_TEMPLATE_QUALIFIER::push(const _DataType& value)
+    {
+        Lock lock;
+        if(!_heap.push_back(value))
+            return false;
+
+        sift_up(_heap.size() - 1);
+        return true;
+    }
+
+    STATICPRIORITYQUEUE_TEMPLATE_ARGS
+    bool STATICPRIORITYQUEUE_TEMPLATE_QUALIFIER::pop()
+    {
+        Lock lock;
+        if(_heap.empty())
+            return false;
+
+        pop_unlocked();
+        return true;
+    }
+
+    STATICPRIORITYQUEUE_TEMPLATE_ARGS
+    bool STATICPRIORITYQUEUE_TEMPLATE_QUALIFIER::pop(_DataType& value)
+    {
+        Lock lock;
+        if(_heap.empty())
+            return false;
+
+        value = std::move(_heap.front());
+        pop_unlocked();
+        return true;
+    }
+
+    STATICPRIORITYQUEUE_TEMPLATE_ARGS
+    void STATICPRIORITYQUEUE_TEMPLATE_QUALIFIER::clear()
+    {
+        Lock lock;
+        _heap.clear();
+    }
+
+    STATICPRIORITYQUEUE_TEMPLATE_ARGS
+    void STATICPRIORITYQUEUE_TEMPLATE_QUALIFIER::pop_unlocked()
+    {
+        _heap.erase_unordered(0);
+        if(!_heap.empty())
+            sift_down(0);
+    }
+
+    STATICPRIORITYQUEUE_TEMPLATE_ARGS
+    void STATICPRIORITYQUEUE_TEMPLATE_QUALIFIER::sift_up(size_type index)
+    {
+        while(index > 0)
+        {
+            size_type parent = (index - 1) / 2;
+            if(!_compare(_heap[parent], _heap[index]))
+                break;
+            std::swap(_heap[parent], _heap[index]);
+            index = parent;
+        }
+    }
+
+    STATICPRIORITYQUEUE_TEMPLATE_ARGS
+    void STATICPRIORITYQUEUE_TEMPLATE_QUALIFIER::sift_down(size_type index)
+    {
+        size_type size = _heap.size();
+        for(;;)
+        {
+            size_type largest = index;
+            size_type left = 2 * index + 1;
+            size_type right = left + 1;
+            if(left < size && _compare(_heap[largest], _heap[left]))
+                largest = left;
+            if(right < size && _compare(_heap[largest], _heap[right]))
+                largest = right;
+            if(largest == index)
+                break;
+            std::swap(_heap[index], _heap[largest]);
+            index = largest;
+        }
+    }
+}
+
+#endif //! ZHELE_STATICPRIORITYQUEUE_IMPL_H
@@ -0,0 +1,213 @@
+/**
+ * @file
+ * Static vector methods implementation.
+ * 
+ * @author Alexey Zhelonkin
+ * @date 2023
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_STATICVECTOR_IMPL_H
+#define ZHELE_STATICVECTOR_IMPL_H
+
+namespace Zhele::Containers
+{
+    #define STATICVECTOR_TEMPLATE_ARGS template<typename _DataType, size_t _Capacity, bool _IsrSafe>
+    #define STATICVECTOR_TEMPLATE_QUALIFIER StaticVector<_DataType, _Capacity, _IsrSafe>
+
+    STATICVECTOR_TEMPLATE_ARGS
+    STATICVECTOR_TEMPLATE_QUALIFIER::~StaticVector()
+    {
+        clear();
+    }
+
+    STATICVECTOR_TEMPLATE_ARGS
+    constexpr typename STATICVECTOR_TEMPLATE_QUALIFIER::size_type STATICVECTOR_TEMPLATE_QUALIFIER::capacity()
+    {
+        return _Capacity;
+    }
+
+    STATICVECTOR_TEMPLATE_ARGS
+    typename STATICVECTOR_TEMPLATE_QUALIFIER::size_type STATICVECTOR_TEMPLATE_QUALIFIER::size() const
+    {
+        return _size;
+    }
+
+    STATICVECTOR_TEMPLATE_ARGS
+    bool STATICVECTOR_TEMPLATE_QUALIFIER::empty() const
+    {
+        return _size == 0;
+    }
+
+    STATICVECTOR_TEMPLATE_ARGS
+    bool STATICVECTOR_TEMPLATE_QUALIFIER::full() const
+    {
+        return _size == _Capacity;
+    }
+
+    STATICVECTOR_TEMPLATE_ARGS
+    bool STATICVECTOR_TEMPLATE_QUALIFIER::push_back(const _DataType& value)
+    {
+        return emplace_back(value) != nullptr;
+    }
+
+    STATICVECTOR_TEMPLATE_ARGS
+    template<typename... _Args>
+    _DataType* STATICVECTOR_TEMPLATE_QUALIFIER::emplace_back(_Args&&... args)
+    {
+        Lock lock;
+        if(_size == _Capacity)
+            return nullptr;
+
+        _DataType* item = new(&data()[_size]) _DataType(std::forward<_Args>(args)...);
+        ++_size;
+        return item;
+    }
+
+    STATICVECTOR_TEMPLATE_ARGS
+    bool STATICVECTOR_TEMPLATE_QUALIFIER::pop_back()
+    {
+        Lock lock;
+        if(_size == 0)
+            return false;
+
+        --_size;
+        data()[_size].~_DataType();
+        return true;
+    }
+
+    STATICVECTOR_TEMPLATE_ARGS
+    bool STATICVECTOR_TEMPLATE_QUALIFIER::insert(size_type index, const _DataType& value)
+    {
+        Lock lock;
+        if(_size == _Capacity || index > _size)
+            return false;
+
+        _DataType* items = data();
+        if(index == _size)
+        {
+            new(&items[_size]) _DataType(value);
+        }
+        else
+        {
+            new(&items[_size]) _DataType(std::move(items[_size - 1]));
+            for(size_type i = _size - 1; i > index; --i)
+                items[i] = std::move(items[i - 1]);
+            items[index] = value;
+        }
+        ++_size;
+        return true;
+    }
+
+    STATICVECTOR_TEMPLATE_ARGS
+    bool STATICVECTOR_TEMPLATE_QUALIFIER::erase(size_type index)
+    {
+        Lock lock;
+        if(index >= _size)
+            return false;
+
+        _DataType* items = data();
+        for(size_type i = index; i + 1 < _size; ++i)
+            items[i] = std::move(items[i + 1]);
+        --_size;
+        items[_size].~_DataType();
+        return true;
+    }
+
+    STATICVECTOR_TEMPLATE_ARGS
+    bool STATICVECTOR_TEMPLATE_QUALIFIER::erase_unordered(size_type index)
+    {
+        Lock lock;
+        if(index >= _size)
+            return false;
+
+        _DataType* items = data();
+        --_size;
+        if(index != _size)
+            items[index] = std::move(items[_size]);
+        items[_size].~_DataType();
+        return true;
+    }
+
+    STATICVECTOR_TEMPLATE_ARGS
+    void STATICVECTOR_TEMPLATE_QUALIFIER::clear()
+    {
+        Lock lock;
+        while(_size > 0)
+            data()[--_size].~_DataType();
+    }
+
+    STATICVECTOR_TEMPLATE_ARGS
+    _DataType& STATICVECTOR_TEMPLATE_QUALIFIER::operator[](size_type index)
+    {
+        return data()[index];
+    }
+
+    STATICVECTOR_TEMPLATE_ARGS
+    const _DataType& STATICVECTOR_TEMPLATE_QUALIFIER::operator[](size_type index) const
+    {
+        return data()[index];
+    }
+
+    STATICVECTOR_TEMPLATE_ARGS
+    _DataType& STATICVECTOR_TEMPLATE_QUALIFIER::front()
+    {
+        return data()[0];
+    }
+
+    STATICVECTOR_TEMPLATE_ARGS
+    const _DataType& STATICVECTOR_TEMPLATE_QUALIFIER::front() const
+    {
+        return data()[0];
+    }
+
+    STATICVECTOR_TEMPLATE_ARGS
+    _DataType& STATICVECTOR_TEMPLATE_QUALIFIER::back()
+    {
+        return data()[_size - 1];
+    }
+
+    STATICVECTOR_TEMPLATE_ARGS
+    const _DataType& STATICVECTOR_TEMPLATE_QUALIFIER::back() const
+    {
+        return data()[_size - 1];
+    }
+
+    STATICVECTOR_TEMPLATE_ARGS
+    typename STATICVECTOR_TEMPLATE_QUALIFIER::iterator STATICVECTOR_TEMPLATE_QUALIFIER::begin()
+    {
+        return data();
+    }
+
+    STATICVECTOR_TEMPLATE_ARGS
+    typename STATICVECTOR_TEMPLATE_QUALIFIER::const_iterator STATICVECTOR_TEMPLATE_QUALIFIER::begin() const
+    {
+        return data();
+    }
+
+    STATICVECTOR_TEMPLATE_ARGS
+    typename STATICVECTOR_TEMPLATE_QUALIFIER::iterator STATICVECTOR_TEMPLATE_QUALIFIER::end()
+    {
+        return data() + _size;
+    }
+
+    STATICVECTOR_TEMPLATE_ARGS
+    typename STATICVECTOR_TEMPLATE_QUALIFIER::const_iterator STATICVECTOR_TEMPLATE_QUALIFIER::end() const
+    {
+        return data() + _size;
+    }
+
+    STATICVECTOR_TEMPLATE_ARGS
+    _DataType* STATICVECTOR_TEMPLATE_QUALIFIER::data()
+    {
+        return std::launder(reinterpret_cast<_DataType*>(_data));
+    }
+
+    STATICVECTOR_TEMPLATE_ARGS
+    const _DataType* STATICVECTOR_TEMPLATE_QUALIFIER::data() const
+    {
+        return std::launder(reinterpret_cast<const _DataType*>(_data));
+    }
+}
+
+#endif //! ZHELE_STATICVECTOR_IMPL_H
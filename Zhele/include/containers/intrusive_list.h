@@ -0,0 +1,198 @@
+/**
+ * @file
+ * Implements intrusive doubly linked list.
+ * 
+ * @author Alexey Zhelonkin
+ * @date 2023
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_INTRUSIVELIST_H
+#define ZHELE_INTRUSIVELIST_H
+
+#include "impl/isr_lock.h"
+
+#include <stddef.h>
+
+namespace Zhele::Containers
+{
+    template<typename _DataType, bool _IsrSafe>
+    class IntrusiveList;
+
+    /**
+     * @brief Intrusive list hook (base of list element)
+     *
+     * @details
+     * Element can be in one list at a time, it is not copied by list.
+     */
+    class IntrusiveListNode
+    {
+        template<typename, bool>
+        friend class IntrusiveList;
+    public:
+        IntrusiveListNode() = default;
+        IntrusiveListNode(const IntrusiveListNode&) = delete;
+        IntrusiveListNode& operator=(const IntrusiveListNode&) = delete;
+
+        /**
+        * @brief Check that element is in list
+        * 
+        * @retval true Element is linked
+        * @retval false Element is not linked
+        */
+        bool linked() const { return _next != nullptr; }
+
+    private:
+        IntrusiveListNode* _prev = nullptr;
+        IntrusiveListNode* _next = nullptr;
+    };
+
+    /**
+     * @brief Implements intrusive doubly linked list
+     *
+     * @details
+     * Elements (derived from IntrusiveListNode) are owned by user, list links them
+     * without any allocation. Insert and remove (by element) are O(1).
+     *
+     * @tparam _DataType Element type (derived from IntrusiveListNode)
+     * @tparam _IsrSafe Modifications disable interrupts (list is shared with ISR)
+     */
+    template<typename _DataType, bool _IsrSafe = false>
+    class IntrusiveList
+    {
+        using Lock = Private::IsrLock<_IsrSafe>;
+    public:
+        /// Forward iterator
+        class iterator
+        {
+        public:
+            explicit iterator(IntrusiveListNode* node) : _node(node) {}
+            _DataType& operator*() const { return *static_cast<_DataType*>(_node); }
+            _DataType* operator->() const { return static_cast<_DataType*>(_node); }
+            iterator& operator++() { _node = _node->_next; return *this; }
+            bool operator==(const iterator& other) const { return _node == other._node; }
+            bool operator!=(const iterator& other) const { return _node != other._node; }
+        private:
+            IntrusiveListNode* _node;
+        };
+
+        /**
+        * @brief Constructor (empty list)
+        * 
+        * @par Returns
+        *   Nothing
+        */
+        IntrusiveList();
+
+        IntrusiveList(const IntrusiveList&) = delete;
+        IntrusiveList& operator=(const IntrusiveList&) = delete;
+
+        /**
+        * @brief Check for emptiness
+        * 
+        * @retval true List is empty
+        * @retval false List is not empty
+        */
+        bool empty() const;
+
+        /**
+        * @brief Returns count of elements (O(n))
+        * 
+        * @returns Count of elements
+        */
+        size_t size() const;
+
+        /**
+        * @brief Add element to the beginning
+        *
+        * @param [in] item Element (should not be linked)
+        * 
+        * @par Returns
+        *   Nothing
+        */
+        void push_front(_DataType& item);
+
+        /**
+        * @brief Add element to the end
+        *
+        * @param [in] item Element (should not be linked)
+        * 
+        * @par Returns
+        *   Nothing
+        */
+        void push_back(_DataType& item);
+
+        /**
+        * @brief Insert element before position
+        *
+        * @param [in] position Position (element of this list)
+        * @param [in] item Element (should not be linked)
+        * 
+        * @par Returns
+        *   Nothing
+        */
+        void insert(_DataType& position, _DataType& item);
+
+        /**
+        * @brief Remove element from list
+        *
+        * @param [in] item Element (ignored if not linked)
+        * 
+        * @par Returns
+        *   Nothing
+        */
+        void remove(_DataType& item);
+
+        /**
+        * @brief Remove and return the first element
+        *
+        * @returns Element (nullptr if list is empty)
+        */
+        _DataType* pop_front();
+
+        /**
+        * @brief Remove and return the last element
+        *
+        * @returns Element (nullptr if list is empty)
+        */
+        _DataType* pop_back();
+
+        /**
+        * @brief Returns the first element
+        *
+        * @returns Element (nullptr if list is empty)
+        */
+        _DataType* front() const;
+
+        /**
+        * @brief Returns the last element
+        *
+        * @returns Element (nullptr if list is empty)
+        */
+        _DataType* back() const;
+
+        /**
+        * @brief Unlink all elements
+        * 
+        * @par Returns
+        *   Nothing
+        */
+        void clear();
+
+        /// Iterator to the first element
+        iterator begin();
+        /// Iterator past the last element
+        iterator end();
+
+    private:
+        void link(IntrusiveListNode* before, IntrusiveListNode* node);
+        void unlink(IntrusiveListNode* node);
+
+        // Sentinel of circular list
+        IntrusiveListNode _root;
+    };
+} // namespace Zhele::Containers
+
+#include "impl/intrusive_list.h"
+
+#endif //! ZHELE_INTRUSIVELIST_H
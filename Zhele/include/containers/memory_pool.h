@@ -0,0 +1,193 @@
+/**
+ * @file
+ * Implements fixed-block memory pool.
+ * 
+ * @author Alexey Zhelonkin
+ * @date 2023
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_MEMORYPOOL_H
+#define ZHELE_MEMORYPOOL_H
+
+#include <clock.h>
+#include "../common/nvic.h"
+
+#include <atomic>
+#include <new>
+#include <stddef.h>
+#include <stdint.h>
+#include <utility>
+
+namespace Zhele::Containers
+{
+    /**
+     * @brief Implements pool of fixed-size memory blocks
+     *
+     * @details
+     * Storage is static (compile-time sized), free blocks are linked in list
+     * through their first bytes, so there is no memory overhead except list head.
+     * Allocate and deallocate are O(1) and can be called from any ISR and thread:
+     * lock-free (LDREX/STREX, head is versioned against ABA) on Cortex-M3 and above,
+     * short critical section on Cortex-M0.
+     *
+     * @tparam _BlockSize Block size (bytes)
+     * @tparam _BlocksCount Blocks count (up to 65535)
+     * @tparam _Alignment Block alignment
+     */
+    template<size_t _BlockSize, unsigned _BlocksCount, size_t _Alignment = alignof(max_align_t)>
+    class MemoryPool
+    {
+        static_assert(_BlocksCount > 0 && _BlocksCount < 0xffff, "Blocks count should be 1...65534");
+        static_assert((_Alignment & (_Alignment - 1)) == 0, "Alignment must be a power of 2");
+
+        static const uint16_t NoBlock = 0xffff;
+        static constexpr size_t MinBlockSize = _BlockSize < sizeof(uint16_t) ? sizeof(uint16_t) : _BlockSize;
+    public:
+        /// Real block size (rounded up to alignment)
+        static constexpr size_t BlockSize = (MinBlockSize + _Alignment - 1) & ~(_Alignment - 1);
+
+        /**
+        * @brief Constructor (all blocks are free)
+        * 
+        * @par Returns
+        *   Nothing
+        */
+        MemoryPool();
+
+        MemoryPool(const MemoryPool&) = delete;
+        MemoryPool& operator=(const MemoryPool&) = delete;
+
+        /**
+         * @brief Allocate block
+         *
+         * @returns Block (nullptr if pool is exhausted)
+         */
+        void* allocate();
+
+        /**
+         * @brief Return block to pool
+         *
+         * @param [in] block Block allocated from this pool (nullptr is ignored)
+         *
+         * @par Returns
+         *   Nothing
+         */
+        void deallocate(void* block);
+
+        /**
+         * @brief Check that block belongs to pool
+         *
+         * @param [in] block Block
+         *
+         * @retval true Block is from this pool
+         * @retval false Block is not from this pool
+         */
+        bool owns(const void* block) const;
+
+        /**
+         * @brief Returns blocks count
+         *
+         * @returns Pool capacity
+         */
+        static constexpr unsigned capacity();
+
+        /**
+         * @brief Returns free blocks count
+         *
+         * @returns Free blocks count
+         */
+        unsigned available() const;
+
+    private:
+        uint16_t& next(uint16_t index);
+        static constexpr uint32_t head(uint32_t version, uint16_t index);
+
+        alignas(_Alignment) uint8_t _storage[_BlocksCount * BlockSize];
+        // Version (high half) and index of the first free block (low half)
+        std::atomic<uint32_t> _head;
+        std::atomic<uint16_t> _available;
+    };
+
+    /**
+     * @brief Implements pool of objects
+     *
+     * @tparam _Type Object type
+     * @tparam _Count Objects count
+     */
+    template<typename _Type, unsigned _Count>
+    class ObjectPool
+    {
+    public:
+        /**
+         * @brief Create object in pool
+         *
+         * @param [in] args Constructor arguments
+         *
+         * @returns Object (nullptr if pool is exhausted)
+         */
+        template<typename... _Args>
+        _Type* create(_Args&&... args);
+
+        /**
+         * @brief Destroy object and return its memory to pool
+         *
+         * @param [in] object Object created by this pool (nullptr is ignored)
+         *
+         * @par Returns
+         *   Nothing
+         */
+        void destroy(_Type* object);
+
+        /**
+         * @brief Returns objects count
+         *
+         * @returns Pool capacity
+         */
+        static constexpr unsigned capacity();
+
+        /**
+         * @brief Returns free objects count
+         *
+         * @returns Free objects count
+         */
+        unsigned available() const;
+
+    private:
+        MemoryPool<sizeof(_Type), _Count, alignof(_Type)> _pool;
+    };
+
+    /**
+     * @brief Packet buffer (data with actual size)
+     *
+     * @details
+     * Common buffer for USB packets, USART frames and sector data, so RAM can be shared
+     * between these paths through one PacketPool instead of static buffer in every driver.
+     *
+     * @tparam _Capacity Data capacity (bytes)
+     */
+    template<size_t _Capacity>
+    struct PacketBuffer
+    {
+        static constexpr size_t Capacity = _Capacity;
+
+        // User-provided constructor: data is not zeroed on create
+        PacketBuffer() : Size(0) {}
+
+        uint16_t Size;
+        alignas(4) uint8_t Data[_Capacity];
+    };
+
+    /**
+     * @brief Pool of packet buffers
+     *
+     * @tparam _Capacity Buffer capacity (bytes)
+     * @tparam _Count Buffers count
+     */
+    template<size_t _Capacity, unsigned _Count>
+    using PacketPool = ObjectPool<PacketBuffer<_Capacity>, _Count>;
+} // namespace Zhele::Containers
+
+#include "impl/memory_pool.h"
+
+#endif //! ZHELE_MEMORYPOOL_H
@@ -0,0 +1,113 @@
+/**
+ * @file
+ * Implements bounded lock-free multi-producer multi-consumer queue.
+ * 
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_MPMCQUEUE_H
+#define ZHELE_MPMCQUEUE_H
+
+#include <clock.h>
+#include "../common/nvic.h"
+
+#include <atomic>
+#include <stdint.h>
+
+namespace Zhele::Containers
+{
+    /**
+     * @brief Implements bounded queue for several producers and several consumers
+     *
+     * @details
+     * Every cell has sequence number, producers and consumers reserve position by index CAS
+     * and publish cell by sequence store, so push and pop can be called from any ISR
+     * (with any priority) and from thread without disabling interrupts on Cortex-M3 and above.
+     * On Cortex-M0 (no LDREX/STREX) position is reserved in short critical section.
+     * Operations never wait: if cell is reserved by preempted context but not published yet,
+     * push reports full queue and pop reports empty queue.
+     * Sequence is stored relative to position lap (as in EventLoop), so zero-initialized
+     * (static) queue is ready for use without constructor.
+     *
+     * @tparam _Type Item type (default constructible and copy assignable)
+     * @tparam _Size Capacity (power of 2)
+     */
+    template<typename _Type, unsigned _Size>
+    class MpmcQueue
+    {
+        static_assert(_Size >= 2 && (_Size & (_Size - 1)) == 0, "Queue size should be power of 2");
+    public:
+        using value_type = _Type;
+        using size_type = unsigned;
+
+        /**
+         * @brief Returns capacity
+         * 
+         * @returns Queue capacity
+         */
+        static constexpr size_type capacity() { return _Size; }
+
+        /**
+         * @brief Returns items count
+         * 
+         * @details
+         * Value is approximate if queue is used concurrently.
+         * 
+         * @returns Items count
+         */
+        size_type size() const;
+
+        /**
+         * @brief Check for emptiness
+         * 
+         * @retval true Queue is empty
+         * @retval false Queue is not empty
+         */
+        bool empty() const;
+
+        /**
+         * @brief Add item to queue
+         * 
+         * @param [in] value Item
+         * 
+         * @retval true Item was added
+         * @retval false Queue is full
+         */
+        bool push(const _Type& value);
+
+        /**
+         * @brief Retrieve the first item
+         * 
+         * @param [out] value Item
+         * 
+         * @retval true Item was retrieved
+         * @retval false Queue is empty
+         */
+        bool pop(_Type& value);
+
+    private:
+        // Sequence equals to lap start if cell is free for write and to lap start + 1 if cell contains item.
+        struct Cell
+        {
+            std::atomic<uint32_t> Sequence;
+            _Type Value;
+        };
+
+        static constexpr uint32_t Lap(uint32_t position)
+        {
+            return position & ~(_Size - 1);
+        }
+
+        bool Reserve(std::atomic<uint32_t>& index, uint32_t ready, uint32_t& position);
+
+        Cell _cells[_Size] {};
+        std::atomic<uint32_t> _tail {0};
+        std::atomic<uint32_t> _head {0};
+    };
+}
+
+#include "impl/mpmc_queue.h"
+
+#endif //! ZHELE_MPMCQUEUE_H
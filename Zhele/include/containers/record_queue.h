@@ -0,0 +1,151 @@
+/**
+ * @file
+ * Implements queue of variable length records.
+ * 
+ * @author Alexey Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_RECORDQUEUE_H
+#define ZHELE_RECORDQUEUE_H
+
+#include "ring_buffer.h"
+
+#include <stdint.h>
+
+namespace Zhele::Containers
+{
+    /**
+     * @brief Implements single producer/single consumer queue of variable length records (frames, log records)
+     *
+     * @details
+     * Records are stored in RingBufferPO2 of bytes with 4-byte length header. Record never wraps
+     * around buffer end: if it doesn't fit to buffer tail, tail is filled by padding and record
+     * is placed to buffer start. So producer gets contiguous region to fill (by copy or by DMA)
+     * and consumer gets contiguous record which may be DMA source.
+     * Records are 4-byte aligned (padded to 4-byte boundary) for half-word and word DMA transfers.
+     * Lock-free like RingBufferPO2: producer (acquire/commit/push) and consumer (front/pop)
+     * may be different contexts (thread and ISR).
+     * @code
+     * // Producer
+     * if(uint8_t* frame = queue.acquire(Protocol::MaxFrameSize))
+     *     queue.commit(Protocol::Encode(frame, message));
+     * // Consumer
+     * if(!queue.empty())
+     * {
+     *     auto record = queue.front();
+     *     Usart1::WriteAsync(record.data, record.size, [](void*, unsigned, bool){ queue.pop(); });
+     * }
+     * @endcode
+     *
+     * @tparam _Size Buffer size in bytes (power of 2)
+     */
+    template<unsigned _Size>
+    class RecordQueue
+    {
+        static_assert(_Size >= 16 && (_Size & (_Size - 1)) == 0, "Queue size should be power of 2 (16 bytes at least)");
+
+        using Buffer = Private::RingBufferPO2<_Size, uint8_t>;
+        using Header = uint32_t;
+        static constexpr Header Padding = 0xffffffff;
+    public:
+        using size_type = unsigned;
+
+        /// Stored record
+        struct const_span
+        {
+            const uint8_t* data;
+            size_type size;
+        };
+
+        /**
+         * @brief Returns buffer capacity
+         * 
+         * @returns Capacity in bytes (headers and padding included)
+         */
+        static constexpr size_type capacity() { return _Size; }
+
+        /**
+         * @brief Returns max record size that always fits to empty queue
+         * 
+         * @returns Size in bytes
+         */
+        static constexpr size_type max_record_size() { return _Size / 2 - sizeof(Header); }
+
+        /**
+         * @brief Check for emptiness
+         * 
+         * @retval true Queue has no records
+         * @retval false Queue is not empty
+         */
+        bool empty() const;
+
+        /**
+         * @brief Reserve contiguous region for record (producer side)
+         * 
+         * @details
+         * Region should be filled (by copy or by DMA) and published by commit.
+         * Region is reserved until the next acquire call.
+         * 
+         * @param [in] size Max record size
+         * 
+         * @returns Region or nullptr if there is no space
+         */
+        uint8_t* acquire(size_type size);
+
+        /**
+         * @brief Publish record written to acquired region (producer side)
+         * 
+         * @param [in] size Record size (not greater than acquired size)
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        void commit(size_type size);
+
+        /**
+         * @brief Copy record to queue (producer side)
+         * 
+         * @param [in] data Record
+         * @param [in] size Record size
+         * 
+         * @retval true Record was added
+         * @retval false There is no space
+         */
+        bool push(const void* data, size_type size);
+
+        /**
+         * @brief Returns the first record for in place read (consumer side)
+         * 
+         * @details
+         * Record remains in queue until pop, so it may be used as DMA source.
+         * 
+         * @returns Record (data is nullptr if queue is empty)
+         */
+        const_span front() const;
+
+        /**
+         * @brief Remove the first record (consumer side)
+         * 
+         * @retval true Record was removed
+         * @retval false Queue is empty
+         */
+        bool pop();
+
+    private:
+        static constexpr size_type Align(size_type size)
+        {
+            return (size + sizeof(Header) - 1) & ~(sizeof(Header) - 1);
+        }
+
+        Buffer _buffer;
+        uint8_t* _acquired = nullptr;
+        size_type _acquiredSize = 0;
+        size_type _padding = 0;
+    };
+}
+
+#include "impl/record_queue.h"
+
+#endif //! ZHELE_RECORDQUEUE_H
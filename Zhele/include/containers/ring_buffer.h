@@ -10,9 +10,9 @@
 #ifndef ZHELE_RINGBUFFER_H
 #define ZHELE_RINGBUFFER_H
 
+#include "atomic_policy.h"
 #include "../common/template_utils/data_type_selector.h"
 
-#include <atomic>
 #include <type_traits>
 
 namespace Zhele::Containers
@@ -23,20 +23,53 @@ namespace Zhele::Containers
          * @brief Implements ringbuffer with size equals to power of 2.
          * It is slightly faster than RingBuffer, but limited to sizes.
          * 
+         * @details
+         * Producer and consumer indexes have single writer each, so they are plain loads and
+         * stores with compiler barriers (lock-free and inlined on all cores, including Cortex-M0).
+         * 
          * @tparam _Size Size
          * @tparam _DataType Data type
-         * @tparam _Atomic Atomic
          */
         template<unsigned _Size, typename _DataType>
         class RingBufferPO2
         {
             static_assert((_Size & (_Size - 1)) == 0);//_Size must be a power of 2
-            using Atomic = std::atomic<typename Zhele::TemplateUtils::SuitableUnsignedTypeForLength<_Size>::type>;
+            using Index = SingleWriterValue<typename Zhele::TemplateUtils::SuitableUnsignedTypeForLength<_Size>::type>;
         public:
             using size_type = typename Zhele::TemplateUtils::SuitableUnsignedTypeForLength<_Size>::type;
             using reference = _DataType&;
             using const_reference = const _DataType&;
 
+            /// Contiguous region of buffer
+            template<typename _Type>
+            struct basic_span
+            {
+                _Type* data;
+                size_type size;
+            };
+
+            /**
+             * @brief Buffer region (the second part is not empty if region wraps around buffer end)
+             */
+            template<typename _Type>
+            struct basic_span_pair
+            {
+                basic_span<_Type> first;
+                basic_span<_Type> second;
+
+                /**
+                 * @brief Returns total size of region
+                 *
+                 * @returns Items count
+                 */
+                size_type size() const { return first.size + second.size; }
+            };
+
+            using span = basic_span<_DataType>;
+            using const_span = basic_span<const _DataType>;
+            using span_pair = basic_span_pair<_DataType>;
+            using const_span_pair = basic_span_pair<const _DataType>;
+
             /**
             * @brief Constructor.
             * 
@@ -155,22 +188,108 @@ namespace Zhele::Containers
             */
             inline const_reference operator[] (size_type index)const;
 
+            /**
+            * @brief Add several items to the end
+            * 
+            * @details
+            * Single producer/single consumer safe: write index is updated once after copy.
+            *
+            * @param [in] values Values
+            * @param [in] count Values count
+            * 
+            * @returns Count of added items (less than count if buffer is full)
+            */
+            size_type write(const _DataType* values, size_type count);
+
+            /**
+            * @brief Retrieve several first items
+            * 
+            * @details
+            * Single producer/single consumer safe: read index is updated once after copy.
+            *
+            * @param [out] values Output buffer
+            * @param [in] count Max items count
+            * 
+            * @returns Count of retrieved items
+            */
+            size_type read(_DataType* values, size_type count);
+
+            /**
+            * @brief Returns count of items which are stored contiguously from the first element
+            * 
+            * @details
+            * Allows to process items in place (&front() ... &front() + contiguous_size()).
+            *
+            * @returns Count of contiguous items
+            */
+            size_type contiguous_size() const;
+
+            /**
+            * @brief Remove several first items
+            *
+            * @param [in] count Items count
+            * 
+            * @returns Count of removed items
+            */
+            size_type skip(size_type count);
+
+            /**
+            * @brief Returns free space for in place write (producer side)
+            *
+            * @details
+            * Region may be filled by DMA or by copy, then it should be published by commit.
+            * The second span is not empty if free space wraps around buffer end.
+            *
+            * @returns Free regions
+            */
+            span_pair acquire_write_span();
+
+            /**
+            * @brief Publish items written to acquired region (producer side)
+            *
+            * @param [in] count Written items count (not greater than acquired size)
+            *
+            * @returns Count of published items
+            */
+            size_type commit(size_type count);
+
+            /**
+            * @brief Returns stored items for in place read (consumer side)
+            *
+            * @details
+            * Items remain in buffer until consume. The second span is not empty
+            * if stored items wrap around buffer end.
+            *
+            * @returns Stored regions
+            */
+            const_span_pair peek_read_span() const;
+
+            /**
+            * @brief Remove items processed in place (consumer side)
+            *
+            * @param [in] count Processed items count
+            *
+            * @returns Count of removed items
+            */
+            size_type consume(size_type count);
+
         private:
             _DataType* data();
             const _DataType* data() const;
 
             unsigned _data[(sizeof(_DataType) * (_Size + 1) - 1) / sizeof(unsigned)];
             
-            Atomic _writeCount;
-            Atomic _readCount;
+            Index _writeCount;
+            Index _readCount;
 
-            static constexpr Atomic _mask = _Size - 1;
+            static constexpr size_type _mask = _Size - 1;
         };
         
         template<unsigned _Size, typename _DataType = uint8_t>
         class RingBuffer
         {
-            using Atomic = std::atomic<typename Zhele::TemplateUtils::SuitableUnsignedTypeForLength<_Size>::type>;
+            using Index = SingleWriterValue<typename Zhele::TemplateUtils::SuitableUnsignedTypeForLength<_Size>::type>;
+            using Counter = SharedCounter<typename Zhele::TemplateUtils::SuitableUnsignedTypeForLength<_Size>::type>;
         public:
             using size_type = typename Zhele::TemplateUtils::SuitableUnsignedTypeForLength<_Size>::type;
             using reference = _DataType&;
@@ -299,9 +418,9 @@ namespace Zhele::Containers
             const _DataType* data() const;
 
             unsigned _data[(sizeof(_DataType) * (_Size + 1) - 1) / sizeof(unsigned)];
-            Atomic _count;
-            Atomic _first;
-            Atomic _last;
+            Counter _count;
+            Index _first;
+            Index _last;
         };
     } // namespace Private
 
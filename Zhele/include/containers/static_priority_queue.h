@@ -0,0 +1,125 @@
+/**
+ * @file
+ * Implements fixed-capacity priority queue.
+ * 
+ * @author Alexey Zhelonkin
+ * @date 2023
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_STATICPRIORITYQUEUE_H
+#define ZHELE_STATICPRIORITYQUEUE_H
+
+#include "static_vector.h"
+
+#include <functional>
+#include <stddef.h>
+
+namespace Zhele::Containers
+{
+    /**
+     * @brief Implements priority queue (binary heap) with fixed capacity
+     *
+     * @details
+     * Push and pop are O(log n), top is O(1). As std::priority_queue, top is the greatest
+     * element by _Compare (use std::greater for earliest deadline first).
+     *
+     * @tparam _DataType Data type
+     * @tparam _Capacity Capacity
+     * @tparam _Compare Compare functor
+     * @tparam _IsrSafe Modifications disable interrupts (queue is shared with ISR)
+     */
+    template<typename _DataType, size_t _Capacity, typename _Compare = std::less<_DataType>, bool _IsrSafe = false>
+    class StaticPriorityQueue
+    {
+        using Lock = Private::IsrLock<_IsrSafe>;
+    public:
+        using size_type = size_t;
+        using value_type = _DataType;
+
+        /**
+         * @brief Returns capacity
+         * 
+         * @returns Queue capacity
+         */
+        static constexpr size_type capacity();
+
+        /**
+        * @brief Returns count of elements
+        * 
+        * @returns Count of elements
+        */
+        size_type size() const;
+
+        /**
+        * @brief Check for emptiness
+        * 
+        * @retval true Queue is empty
+        * @retval false Queue is not empty
+        */
+        bool empty() const;
+
+        /**
+        * @brief Check for fullness
+        * 
+        * @retval true Queue is full
+        * @retval false Queue is not full
+        */
+        bool full() const;
+
+        /**
+        * @brief Returns the greatest element
+        * 
+        * @returns Const reference to element (queue should not be empty)
+        */
+        const _DataType& top() const;
+
+        /**
+        * @brief Add an item
+        *
+        * @param [in] value Value
+        * 
+        * @retval true Item is added
+        * @retval false Queue is full
+        */
+        bool push(const _DataType& value);
+
+        /**
+        * @brief Remove the greatest element
+        *
+        * @retval true Item is removed
+        * @retval false Queue is empty
+        */
+        bool pop();
+
+        /**
+        * @brief Retrieve and remove the greatest element
+        *
+        * @param [out] value Removed value
+        *
+        * @retval true Item is removed
+        * @retval false Queue is empty
+        */
+        bool pop(_DataType& value);
+
+        /**
+        * @brief Remove all items
+        * 
+        * @par Returns
+        *   Nothing
+        */
+        void clear();
+
+    private:
+        void sift_up(size_type index);
+        void sift_down(size_type index);
+        void pop_unlocked();
+
+        StaticVector<_DataType, _Capacity> _heap;
+        [[no_unique_address]] _Compare _compare;
+    };
+} // namespace Zhele::Containers
+
+#include "impl/static_priority_queue.h"
+
+#endif //! ZHELE_STATICPRIORITYQUEUE_H
@@ -0,0 +1,209 @@
+/**
+ * @file
+ * Implements fixed-capacity vector.
+ * 
+ * @author Alexey Zhelonkin
+ * @date 2023
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_STATICVECTOR_H
+#define ZHELE_STATICVECTOR_H
+
+#include "impl/isr_lock.h"
+
+#include <new>
+#include <stddef.h>
+#include <utility>
+
+namespace Zhele::Containers
+{
+    /**
+     * @brief Implements vector with fixed capacity (storage is inside object, no heap)
+     *
+     * @details
+     * Elements are constructed in place on insert and destroyed on erase/clear,
+     * so element type need not be default constructible.
+     *
+     * @tparam _DataType Data type
+     * @tparam _Capacity Capacity
+     * @tparam _IsrSafe Modifications disable interrupts (container is shared with ISR)
+     */
+    template<typename _DataType, size_t _Capacity, bool _IsrSafe = false>
+    class StaticVector
+    {
+        using Lock = Private::IsrLock<_IsrSafe>;
+    public:
+        using size_type = size_t;
+        using value_type = _DataType;
+        using reference = _DataType&;
+        using const_reference = const _DataType&;
+        using iterator = _DataType*;
+        using const_iterator = const _DataType*;
+
+        /**
+        * @brief Constructor (empty vector)
+        * 
+        * @par Returns
+        *   Nothing
+        */
+        StaticVector() = default;
+
+        StaticVector(const StaticVector&) = delete;
+        StaticVector& operator=(const StaticVector&) = delete;
+
+        /**
+        * @brief Destructor (destroys elements)
+        * 
+        * @par Returns
+        *   Nothing
+        */
+        ~StaticVector();
+
+        /**
+         * @brief Returns capacity
+         * 
+         * @returns Vector capacity
+         */
+        static constexpr size_type capacity();
+
+        /**
+        * @brief Returns count of elements
+        * 
+        * @returns Count of elements
+        */
+        size_type size() const;
+
+        /**
+        * @brief Check for emptiness
+        * 
+        * @retval true Vector is empty
+        * @retval false Vector is not empty
+        */
+        bool empty() const;
+
+        /**
+        * @brief Check for fullness
+        * 
+        * @retval true Vector is full
+        * @retval false Vector is not full
+        */
+        bool full() const;
+
+        /**
+        * @brief Add an item to the end
+        *
+        * @param [in] value Value
+        * 
+        * @retval true Item is added
+        * @retval false Vector is full
+        */
+        bool push_back(const _DataType& value);
+
+        /**
+        * @brief Construct an item at the end
+        *
+        * @param [in] args Constructor arguments
+        * 
+        * @returns Pointer to new item (nullptr if vector is full)
+        */
+        template<typename... _Args>
+        _DataType* emplace_back(_Args&&... args);
+
+        /**
+        * @brief Remove the last item
+        *
+        * @retval true Item is removed
+        * @retval false Vector is empty
+        */
+        bool pop_back();
+
+        /**
+        * @brief Insert an item before given position
+        *
+        * @param [in] index Position
+        * @param [in] value Value
+        * 
+        * @retval true Item is inserted
+        * @retval false Vector is full or position is out of range
+        */
+        bool insert(size_type index, const _DataType& value);
+
+        /**
+        * @brief Remove an item (next items are shifted)
+        *
+        * @param [in] index Position
+        * 
+        * @retval true Item is removed
+        * @retval false Position is out of range
+        */
+        bool erase(size_type index);
+
+        /**
+        * @brief Remove an item by moving the last item to its place (order is not kept, O(1))
+        *
+        * @param [in] index Position
+        * 
+        * @retval true Item is removed
+        * @retval false Position is out of range
+        */
+        bool erase_unordered(size_type index);
+
+        /**
+        * @brief Remove all items
+        * 
+        * @par Returns
+        *   Nothing
+        */
+        void clear();
+
+        /**
+        * @brief Operator overload []
+        * 
+        * @param [in] index Index
+        * 
+        * @returns Reference to element
+        */
+        reference operator[](size_type index);
+
+        /**
+        * @brief Operator overload []
+        * 
+        * @param [in] index Index
+        * 
+        * @returns Const reference to element
+        */
+        const_reference operator[](size_type index) const;
+
+        /// First element
+        reference front();
+        /// First element
+        const_reference front() const;
+        /// Last element
+        reference back();
+        /// Last element
+        const_reference back() const;
+
+        /// Iterator to the first element
+        iterator begin();
+        /// Iterator to the first element
+        const_iterator begin() const;
+        /// Iterator past the last element
+        iterator end();
+        /// Iterator past the last element
+        const_iterator end() const;
+
+        /// Elements storage
+        _DataType* data();
+        /// Elements storage
+        const _DataType* data() const;
+
+    private:
+        alignas(_DataType) unsigned char _data[sizeof(_DataType) * _Capacity];
+        size_type _size = 0;
+    };
+} // namespace Zhele::Containers
+
+#include "impl/static_vector.h"
+
+#endif //! ZHELE_STATICVECTOR_H
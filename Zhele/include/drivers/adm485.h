@@ -1,46 +1,90 @@
 /**
  * @file
  * Driver for RS485 (wrapper on usart)
- * 
+ *
  * @author Aleksei Zhelonkin
  * @date 2022
  * @license FreeBSD
  */
 
+#ifndef ZHELE_DRIVERS_ADM485_H
+#define ZHELE_DRIVERS_ADM485_H
+
 #include <iopins.h>
 #include <usart.h>
 
+#include <type_traits>
+
 namespace Zhele::Drivers
 {
+#if defined (USART_CR3_DEM)
+    /**
+     * @brief Hardware driver enable pin (USART DE function of RTS pin)
+     *
+     * @details
+     * Use it as Adm485 direct pin: USART switches driver itself exactly at frame boundaries.
+     *
+     * @tparam _Pin RTS/DE pin of USART
+     * @tparam _AltFuncNumber Pin alternate function number
+     * @tparam _AssertionTime DE assertion time (sample time units, 0..31)
+     * @tparam _DeassertionTime DE deassertion time (sample time units, 0..31)
+     */
+    template<typename _Pin, uint8_t _AltFuncNumber, uint8_t _AssertionTime = 0, uint8_t _DeassertionTime = 0>
+    struct Adm485HardwareDe
+    {
+        using Pin = _Pin;
+        static const uint8_t AltFuncNumber = _AltFuncNumber;
+        static const uint8_t AssertionTime = _AssertionTime;
+        static const uint8_t DeassertionTime = _DeassertionTime;
+    };
+#endif
+
+    /**
+     * @brief RS485 transceiver (ADM485, MAX485 and so on)
+     *
+     * @details
+     * Direct pin is switched to receive by transmission complete (TC) event, so line is released
+     * right after stop bit of last byte. Async write uses TC interrupt: call IrqHandler from
+     * USART interrupt handler.
+     * On multi-drop bus nodes can filter frames in hardware: init USART with AddressMarkWakeup mode
+     * and own UsartMode::NodeAddress, call EnterMuteMode after each received frame,
+     * master sends frames by WriteTo.
+     *
+     * @tparam _Usart USART
+     * @tparam _DirectPin Driver enable pin (GPIO, Adm485HardwareDe or NullPin for auto-direction transceivers)
+     */
     template<typename _Usart, typename _DirectPin = IO::NullPin>
     class Adm485 : public _Usart
     {
         using Base = _Usart;
+        using Callback = std::add_pointer_t<void()>;
+
+        static constexpr bool HardwareDe = requires { _DirectPin::DeassertionTime; };
     public:
         using UsartMode = Base::UsartMode;
         /**
          * @brief Initialize USART and direct pin
-         * 
+         *
          * @tparam baud Baud rate
          * @param [in] mode Mode
-         * 
+         *
          * @par Returns
          *	Nothing
             */
         template<unsigned long baud>
         static inline void Init(UsartMode mode = DefaultUsartMode)
         {
-            Base::Init<baud>(mode);
+            Base::template Init<baud>(mode);
             InitPin();
         }
-        
+
 
         /**
          * @brief Initialize USART
-         * 
+         *
          * @param [in] baud Baud rate
          * @param[in] mode Mode
-         * 
+         *
          * @par Returns
          *	Nothing
             */
@@ -52,66 +96,187 @@ namespace Zhele::Drivers
 
         /**
          * @brief Write data to line
-         * 
+         *
+         * @details
+         * Method returns after last byte stop bit.
+         *
          * @param [in] data Data to write
          * @param [in] size Data size
-         * 
+         *
          * @par Returns
          * 	Nothing
          */
         static void Write(const void* data, size_t size)
         {
-            _DirectPin::Set();
-            Base::Write(data, size + 1); // +1, because usart ready when TX buffer empty (not last byte has been transmitted)
-            while(!Base::WriteReady()) continue;
-            _DirectPin::Clear();
+            SetTransmit();
+            Base::Write(data, size);
+            while(!Base::TransmitComplete()) continue;
+            SetReceive();
         }
 
         /**
          * @brief Write data to line async
-         * 
+         *
+         * @details
+         * Data is transferred by DMA, then direct pin is switched by TC interrupt
+         * (hardware DE pin is switched by USART itself, TC interrupt calls callback only).
+         *
          * @param [in] data Data to write
          * @param [in] size Data size
-         * @param [in] async Write async or no
-         * 
+         * @param [in] callback Write complete callback (line is released)
+         *
          * @par Returns
          * 	Nothing
          */
-        static void WriteAsync(const void* data, size_t size, std::add_pointer_t<void()> callback = nullptr)
+        static void WriteAsync(const void* data, size_t size, Callback callback = nullptr)
         {
-            _DirectPin::Set();
-            Base::WriteAsync(data, size + 1, [callback](auto... unused){
-                while(!Base::WriteReady()) continue;
-                _DirectPin::Clear();
-                if(callback)
-                    callback();
-            });
+            if(size == 0)
+                return;
+
+            _callback = callback;
+            SetTransmit();
+            Base::WriteAsync(data, size, DmaWriteComplete);
+        }
+
+        /**
+         * @brief Write addressed frame (address character and data)
+         *
+         * @details
+         * Nodes in address mark mute mode (UsartMode::AddressMarkWakeup) receive frame only
+         * if address equals to their node address, so other nodes are not interrupted by bus traffic.
+         * Method returns after last byte stop bit.
+         *
+         * @param [in] address Destination node address
+         * @param [in] data Data to write
+         * @param [in] size Data size
+         *
+         * @par Returns
+         * 	Nothing
+         */
+        static void WriteTo(uint8_t address, const void* data, size_t size)
+        {
+            SetTransmit();
+            Base::WriteAddress(address);
+            Base::Write(data, size);
+            while(!Base::TransmitComplete()) continue;
+            SetReceive();
+        }
+
+        /**
+         * @brief Write addressed frame async
+         *
+         * @details
+         * Address character is written synchronously, data is transferred by DMA (see WriteAsync).
+         *
+         * @param [in] address Destination node address
+         * @param [in] data Data to write
+         * @param [in] size Data size
+         * @param [in] callback Write complete callback (line is released)
+         *
+         * @par Returns
+         * 	Nothing
+         */
+        static void WriteToAsync(uint8_t address, const void* data, size_t size, Callback callback = nullptr)
+        {
+            _callback = callback;
+            SetTransmit();
+            Base::WriteAddress(address);
+            if(size == 0)
+                DmaWriteComplete(nullptr, 0, true);
+            else
+                Base::WriteAsync(data, size, DmaWriteComplete);
         }
 
         /**
          * @brief Sync write byte
-         * 
+         *
          * @param [in] data Byte to write
-         * 
+         *
          * @par Returns
          *	Nothing
         */
         static void Write(uint8_t data)
         {
-            _DirectPin::Set();
+            SetTransmit();
             Base::Write(data);
-            _DirectPin::Clear();
+            while(!Base::TransmitComplete()) continue;
+            SetReceive();
         }
+
+        /**
+         * @brief USART interrupt handler (call it instead of Usart::IrqHandler)
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void IrqHandler()
+        {
+            if(_waitTransmitComplete && Base::TransmitComplete())
+            {
+                _waitTransmitComplete = false;
+                Base::DisableInterrupt(Base::TxCompleteInt);
+                SetReceive();
+                if(_callback)
+                    _callback();
+            }
+            Base::IrqHandler();
+        }
+
     private:
         static void InitPin()
         {
             if constexpr (std::is_same_v<_DirectPin, IO::NullPin>)
+            {
                 return;
+            }
+        #if defined (USART_CR3_DEM)
+            else if constexpr (HardwareDe)
+            {
+                using Pin = typename _DirectPin::Pin;
+                Pin::Port::Enable();
+                Pin::template SetConfiguration<Pin::Configuration::AltFunc>();
+                Pin::template SetDriverType<Pin::DriverType::PushPull>();
+                Pin::template AltFuncNumber<_DirectPin::AltFuncNumber>();
+                Base::EnableDriverEnable(_DirectPin::AssertionTime, _DirectPin::DeassertionTime);
+            }
+        #endif
+            else
+            {
+                _DirectPin::Port::Enable();
+                _DirectPin::template SetConfiguration<_DirectPin::Configuration::Out>();
+                _DirectPin::template SetDriverType<_DirectPin::DriverType::PushPull>();
+                _DirectPin::Clear();
+            }
+        }
 
-            _DirectPin::Port::Enable();
-            _DirectPin::template SetConfiguration<_DirectPin::Configuration::Out>();
-            _DirectPin::template SetDriverType<_DirectPin::DriverType::PushPull>();
-            _DirectPin::Clear();
+        static void SetTransmit()
+        {
+            if constexpr (!HardwareDe)
+                _DirectPin::Set();
+        }
+
+        static void SetReceive()
+        {
+            if constexpr (!HardwareDe)
+                _DirectPin::Clear();
+        }
+
+        static void DmaWriteComplete(void*, unsigned, bool)
+        {
+            // Last byte is in shift register now, TC interrupt fires after its stop bit
+            _waitTransmitComplete = true;
+            Base::EnableInterrupt(Base::TxCompleteInt);
         }
+
+        static Callback _callback;
+        static volatile bool _waitTransmitComplete;
     };
-}
\ No newline at end of file
+
+    template<typename _Usart, typename _DirectPin>
+    typename Adm485<_Usart, _DirectPin>::Callback Adm485<_Usart, _DirectPin>::_callback = nullptr;
+
+    template<typename _Usart, typename _DirectPin>
+    volatile bool Adm485<_Usart, _DirectPin>::_waitTransmitComplete = false;
+}
+
+#endif //! ZHELE_DRIVERS_ADM485_H
@@ -13,7 +13,10 @@
 #define ZHELE_DRIVERS_AHT10_H
 
 #include <delay.h>
-#include <limits.h>
+#include <limits>
+
+#include <type_traits>
+#include <utility>
 
 namespace Zhele::Drivers
 {
@@ -247,5 +250,252 @@ namespace Zhele::Drivers
             return _I2CBus::Write(AHT10Address, 0, data, Size, I2cOpts::RegAddrNone) == I2cStatus::Success;
         }
     };
+
+    /**
+     * @brief Non-blocking AHT10/AHT20 driver on I2C transactions queue
+     * 
+     * @details
+     * Measurement is a state machine: trigger command is queued, Poll (call it from main loop)
+     * waits measurement time by timebase, then result (status and data) is queued for reading.
+     * If sensor is still busy, read is repeated after short delay. Bus is never held while
+     * sensor converts, so several sensors on one bus measure simultaneously and their
+     * transactions are executed back-to-back by queue.
+     * 
+     * @tparam _I2cQueue I2C transactions queue (See i2c_queue.h)
+     * @tparam _Timebase Timebase with Micros method (See timebase.h)
+     * @tparam _Address I2C address in 7-bit mode (0x38 or 0x39)
+     * @tparam _Priority Queue priority of sensor transactions
+     */
+    template <typename _I2cQueue, typename _Timebase, uint8_t _Address = 0x38, I2cPriority _Priority = I2cPriority::Low>
+    class Aht10Async
+    {
+        const static uint32_t PowerOnTime = 40000; ///< Time after power on (us)
+        const static uint32_t CalibrationTime = 10000; ///< Calibration time (us)
+        const static uint32_t MeasurementTime = 80000; ///< Measurement time (us)
+        const static uint32_t BusyRetryTime = 10000; ///< Read retry delay if sensor is busy (us)
+
+        const static uint8_t Calibrate = 0xe1; ///< Calibrate command
+        const static uint8_t Trigger = 0xac; ///< Trigger command
+        const static uint8_t TriggerArgument = 0x33; ///< Trigger command argument
+
+        const static uint8_t BusyFlag = 0x80; ///< Status busy flag
+        const static uint8_t CalibratedFlag = 0x08; ///< Status calibrated flag
+
+    public:
+        /// Driver state
+        enum class State : uint8_t
+        {
+            NotInitialized, ///< Init has not been started
+            PowerOn, ///< Waiting for power on time
+            Calibrating, ///< Calibration command is queued or in progress
+            Ready, ///< Ready for measurement
+            Measuring, ///< Measurement is in progress
+            Error ///< I2C error or sensor is not calibrated
+        };
+
+        /// Measurement result
+        struct Measurement
+        {
+            int16_t Temperature; ///< Temperature in 0.01 degrees Celsius
+            uint16_t Humidity; ///< Relative humidity in 0.01 %
+        };
+
+        using Callback = std::add_pointer_t<void(bool success, const Measurement& measurement)>;
+
+        /**
+         * @brief Start non-blocking init
+         * 
+         * @details
+         * Init waits power on time (from call), sends calibration command and checks calibration status.
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void StartInit()
+        {
+            Wait(PowerOnTime);
+            _state = State::PowerOn;
+        }
+
+        /**
+         * @brief Start non-blocking measurement
+         * 
+         * @param [in] callback Measurement complete callback (it is called from I2C interrupt)
+         * 
+         * @retval true Measurement has been started
+         * @retval false Sensor is not ready or queue is full
+         */
+        static bool StartMeasurement(Callback callback = nullptr)
+        {
+            if(_state != State::Ready)
+                return false;
+
+            _buffer[0] = Trigger;
+            _buffer[1] = TriggerArgument;
+            _buffer[2] = 0;
+            _callback = callback;
+            _state = State::Measuring;
+            _step = Step::Command;
+            if(!_I2cQueue::Write(_Address, 0, _buffer, 3, OnTriggered, _Priority, I2cOpts::RegAddrNone))
+            {
+                _state = State::Ready;
+                return false;
+            }
+            return true;
+        }
+
+        /**
+         * @brief Process time-driven steps (call it from main loop)
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Poll()
+        {
+            if(_step != Step::Wait || static_cast<uint32_t>(_Timebase::Micros() - _timestamp) < _delay)
+                return;
+
+            State state = _state;
+            if(state == State::PowerOn)
+            {
+                _buffer[0] = Calibrate;
+                _buffer[1] = 0x08;
+                _buffer[2] = 0x00;
+                _step = Step::Command;
+                _state = State::Calibrating;
+                if(!_I2cQueue::Write(_Address, 0, _buffer, 3, OnCalibrationSent, _Priority, I2cOpts::RegAddrNone))
+                {
+                    _step = Step::Wait;
+                    _state = State::PowerOn;
+                }
+            }
+            else if(state == State::Calibrating || state == State::Measuring)
+            {
+                // Status is first byte of measurement data
+                _step = Step::Read;
+                if(!_I2cQueue::Read(_Address, 0, _buffer, state == State::Measuring ? sizeof(_buffer) : 1, OnRead, _Priority, I2cOpts::RegAddrNone))
+                    _step = Step::Wait;
+            }
+        }
+
+        /**
+         * @brief Returns driver state
+         * 
+         * @returns State
+         */
+        static State GetState()
+        {
+            return _state;
+        }
+
+        /**
+         * @brief Returns last measurement result
+         * 
+         * @returns Measurement
+         */
+        static const Measurement& LastMeasurement()
+        {
+            return _measurement;
+        }
+
+    private:
+        /// Current step of state
+        enum class Step : uint8_t
+        {
+            Idle, ///< Nothing to do
+            Command, ///< Command transaction is queued
+            Wait, ///< Waiting for delay
+            Read ///< Read transaction is queued
+        };
+
+        static void Wait(uint32_t delay)
+        {
+            _timestamp = _Timebase::Micros();
+            _delay = delay;
+            _step = Step::Wait;
+        }
+
+        static void Fail()
+        {
+            bool measuring = _state == State::Measuring;
+            _step = Step::Idle;
+            _state = measuring ? State::Ready : State::Error;
+            if(measuring && _callback)
+                _callback(false, _measurement);
+        }
+
+        static void OnCalibrationSent(I2cStatus status)
+        {
+            if(status != I2cStatus::Success)
+                Fail();
+            else
+                Wait(CalibrationTime);
+        }
+
+        static void OnTriggered(I2cStatus status)
+        {
+            if(status != I2cStatus::Success)
+                Fail();
+            else
+                Wait(MeasurementTime);
+        }
+
+        static void OnRead(I2cStatus status)
+        {
+            if(status != I2cStatus::Success)
+            {
+                Fail();
+                return;
+            }
+            if(_buffer[0] & BusyFlag)
+            {
+                Wait(BusyRetryTime);
+                return;
+            }
+
+            _step = Step::Idle;
+            if(_state == State::Calibrating)
+            {
+                _state = (_buffer[0] & CalibratedFlag) ? State::Ready : State::Error;
+                return;
+            }
+
+            // 20-bit values: humidity * 100 / 2^20 = humidity * 625 / 2^16, temperature * 200 / 2^20 - 50
+            uint32_t humidity = (static_cast<uint32_t>(_buffer[1]) << 12) | (_buffer[2] << 4) | (_buffer[3] >> 4);
+            uint32_t temperature = (static_cast<uint32_t>(_buffer[3] & 0x0f) << 16) | (_buffer[4] << 8) | _buffer[5];
+            _measurement.Humidity = static_cast<uint16_t>((humidity * 625) >> 16);
+            _measurement.Temperature = static_cast<int16_t>(static_cast<int32_t>((temperature * 625) >> 15) - 5000);
+
+            _state = State::Ready;
+            if(_callback)
+                _callback(true, _measurement);
+        }
+
+        static uint8_t _buffer[6];
+        static volatile State _state;
+        static volatile Step _step;
+        static uint32_t _timestamp;
+        static uint32_t _delay;
+        static Callback _callback;
+        static Measurement _measurement;
+    };
+
+    #define AHT10ASYNC_TEMPLATE_ARGS template <typename _I2cQueue, typename _Timebase, uint8_t _Address, I2cPriority _Priority>
+    #define AHT10ASYNC_TEMPLATE_QUALIFIER Aht10Async<_I2cQueue, _Timebase, _Address, _Priority>
+
+    AHT10ASYNC_TEMPLATE_ARGS
+    uint8_t AHT10ASYNC_TEMPLATE_QUALIFIER::_buffer[6];
+    AHT10ASYNC_TEMPLATE_ARGS
+    volatile typename AHT10ASYNC_TEMPLATE_QUALIFIER::State AHT10ASYNC_TEMPLATE_QUALIFIER::_state = AHT10ASYNC_TEMPLATE_QUALIFIER::State::NotInitialized;
+    AHT10ASYNC_TEMPLATE_ARGS
+    volatile typename AHT10ASYNC_TEMPLATE_QUALIFIER::Step AHT10ASYNC_TEMPLATE_QUALIFIER::_step = AHT10ASYNC_TEMPLATE_QUALIFIER::Step::Idle;
+    AHT10ASYNC_TEMPLATE_ARGS
+    uint32_t AHT10ASYNC_TEMPLATE_QUALIFIER::_timestamp = 0;
+    AHT10ASYNC_TEMPLATE_ARGS
+    uint32_t AHT10ASYNC_TEMPLATE_QUALIFIER::_delay = 0;
+    AHT10ASYNC_TEMPLATE_ARGS
+    typename AHT10ASYNC_TEMPLATE_QUALIFIER::Callback AHT10ASYNC_TEMPLATE_QUALIFIER::_callback = nullptr;
+    AHT10ASYNC_TEMPLATE_ARGS
+    typename AHT10ASYNC_TEMPLATE_QUALIFIER::Measurement AHT10ASYNC_TEMPLATE_QUALIFIER::_measurement = {};
 }
 #endif // !ZHELE_DRIVERS_AHT10_H
\ No newline at end of file
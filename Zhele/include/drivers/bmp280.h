@@ -12,18 +12,35 @@
 #ifndef ZHELE_DRIVERS_BMP280_H
 #define ZHELE_DRIVERS_BMP280_H
 
+#include <common/template_utils/packet_schema.h>
+
+#include <stdint.h>
+#include <type_traits>
+
+
 namespace Zhele::Drivers
 {
     /**
      * @brief Class for DMP280 sensor
      * 
+     * @details
+     * Pressure and temperature are read by one 6-byte burst and compensated
+     * by datasheet integer formulas (no float math).
+     * If timebase is specified, sensor can be driven without blocking: StartInit and StartMeasurement
+     * start async I2C transactions (call I2C IRQ handlers), Poll (from main loop) handles
+     * startup and forced measurement delays.
+     * 
      * @tparam _I2CBus Target I2C type (See i2c.h)
+     * @tparam _Timebase Timebase with Micros method (See timebase.h), void for blocking usage only
+     * @tparam _Address I2C address in 7-bit mode (0x76 or 0x77)
      */
-    template <typename _I2CBus>
+    template <typename _I2CBus, typename _Timebase = void, uint8_t _Address = 0x76>
     class Bmp280
     {
-        const static uint8_t Bmp280Address = 0x76; ///< I2C address in 7-bit mode
+        const static uint8_t Bmp280Address = _Address; ///< I2C address in 7-bit mode
         const static uint8_t ChipId = 0x58; ///< Chip ID
+        const static uint32_t StartupTime = 2000; ///< Startup time after reset (us)
+        const static int32_t SkippedValue = 0x80000; ///< ADC value of skipped measurement
 
         /// Sensor registers
         enum class Register
@@ -55,6 +72,7 @@ namespace Zhele::Drivers
             TemperatureData = 0xfa, ///< Temperature data register
         };
 
+    public:
         /// Sampling rates
         enum class Sampling : uint8_t
         {
@@ -97,7 +115,23 @@ namespace Zhele::Drivers
             Ms4000 = 0x0, ///< 4000 ms standby
         };
 
-#pragma pack(push, 1)
+        /// Driver state (non-blocking usage)
+        enum class State : uint8_t
+        {
+            NotInitialized, ///< Init has not been started
+            Resetting, ///< Soft reset is being written
+            Startup, ///< Waiting for startup time after reset
+            Configuring, ///< Reading calibration and writing configuration
+            Ready, ///< Ready for measurement
+            Triggering, ///< Forced measurement is being triggered
+            Measuring, ///< Waiting for forced measurement end
+            Reading, ///< Reading measurement result
+            Error ///< I2C error or wrong chip id
+        };
+
+        using Callback = std::add_pointer_t<void(bool success)>;
+
+    private:
         /// Calibration data
         struct CalibrationData
         {
@@ -114,31 +148,75 @@ namespace Zhele::Drivers
             int16_t P8; ///< P8 calibration value
             int16_t P9; ///< P9 calibration value
         };
-#pragma pack(pop)
+
+        /// Calibration registers layout (little-endian words)
+        using CalibrationPacket = TemplateUtils::PacketSchema<CalibrationData,
+            TemplateUtils::Field<&CalibrationData::T1>, TemplateUtils::Field<&CalibrationData::T2>, TemplateUtils::Field<&CalibrationData::T3>,
+            TemplateUtils::Field<&CalibrationData::P1>, TemplateUtils::Field<&CalibrationData::P2>, TemplateUtils::Field<&CalibrationData::P3>,
+            TemplateUtils::Field<&CalibrationData::P4>, TemplateUtils::Field<&CalibrationData::P5>, TemplateUtils::Field<&CalibrationData::P6>,
+            TemplateUtils::Field<&CalibrationData::P7>, TemplateUtils::Field<&CalibrationData::P8>, TemplateUtils::Field<&CalibrationData::P9>>;
 
         /// Control register format
         struct Control
         {
-            uint8_t TemparatureOversampling : 3; ///< Temperature oversampling
-            uint8_t PressureOversampling : 3; ///< Pressure oversampling
-            uint8_t Mode : 2; ///< Device mode
+            uint8_t TemparatureOversampling; ///< Temperature oversampling
+            uint8_t PressureOversampling; ///< Pressure oversampling
+            uint8_t Mode; ///< Device mode
         };
 
+        /// Control register layout (osrs_t [7:5], osrs_p [4:2], mode [1:0])
+        using ControlPacket = TemplateUtils::PacketSchema<Control,
+            TemplateUtils::BitField<&Control::Mode, 2>,
+            TemplateUtils::BitField<&Control::PressureOversampling, 3>,
+            TemplateUtils::BitField<&Control::TemparatureOversampling, 3>>;
+
         /// Configuration register format
         struct Config
         {
-            uint8_t StandbyDuration : 3; ///< Inactive duration (standby time) in normal mode
-            uint8_t Filter : 3; ///< Filter settings
-
-            uint8_t None : 1;     ///< Unused
-            uint8_t SpiEnable : 1; ///< Unused
+            uint8_t StandbyDuration; ///< Inactive duration (standby time) in normal mode
+            uint8_t Filter; ///< Filter settings
+            uint8_t SpiEnable; ///< 3-wire SPI enable
         };
 
+        /// Configuration register layout (t_sb [7:5], filter [4:2], spi3w_en [0])
+        using ConfigPacket = TemplateUtils::PacketSchema<Config,
+            TemplateUtils::BitField<&Config::SpiEnable, 1>,
+            TemplateUtils::Reserved<1>,
+            TemplateUtils::BitField<&Config::Filter, 3>,
+            TemplateUtils::BitField<&Config::StandbyDuration, 3>>;
+
+        /// Burst data size (pressure and temperature registers)
+        const static uint8_t DataSize = 6;
+
         static CalibrationData _calibrationData;
         static Control _control;
         static Config _config;
 
+        static uint8_t _buffer[CalibrationPacket::Size];
+        static volatile State _state;
+        static uint32_t _timestamp;
+        static Callback _callback;
+        static int32_t _temperature;
+        static uint32_t _pressure;
+
     public:
+        /**
+         * @brief Set power mode (call it before init)
+         * 
+         * @details
+         * In normal mode sensor measures continuously and measurement is burst read only.
+         * In forced mode each measurement is triggered by StartMeasurement (or Read).
+         * 
+         * @param [in] mode Power mode
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void SetMode(Mode mode)
+        {
+            _control.Mode = static_cast<uint8_t>(mode);
+        }
+
         /**
          * @brief Init sensor
          * 
@@ -161,42 +239,175 @@ namespace Zhele::Drivers
             
             ReadCalibrationData();
 
-            WriteRegister(Register::Control, *reinterpret_cast<uint8_t*>(&_control));
-            WriteRegister(Register::Config, *reinterpret_cast<uint8_t*>(&_config));
+            // Config register writes are ignored in normal mode, so it is written first
+            uint8_t config;
+            ConfigPacket::Encode(_config, &config);
+            WriteRegister(Register::Config, config);
+            uint8_t control;
+            ControlPacket::Encode(_control, &control);
+            WriteRegister(Register::Control, control);
 
             for(unsigned i = 0; i < 100000; ++i)
                 __asm("nop");
 
+            _state = State::Ready;
             return true;
         }
 
         /**
-         * @brief Read temperature
+         * @brief Start non-blocking init
          * 
-         * @returns Temperature
+         * @details
+         * Init is continued by I2C callbacks and Poll method, sensor is ready when state becomes Ready.
+         * 
+         * @param [in] callback Init complete callback (optional)
+         * 
+         * @retval true Init has been started
+         * @retval false I2C bus is busy
          */
-        static float ReadTemperature()
+        static bool StartInit(Callback callback = nullptr)
         {
-            int32_t raw = ReadRegister24(Register::TemperatureData);
+            static_assert(!std::is_void_v<_Timebase>, "Non-blocking init requires timebase");
+
+            _callback = callback;
+            _buffer[0] = 0xb6;
+            _state = State::Resetting;
+            if(_I2CBus::WriteAsync(Bmp280Address, static_cast<uint16_t>(Register::SoftReset), _buffer, 1, I2cOpts::None, OnResetWritten) != I2cStatus::Success)
+            {
+                _state = State::NotInitialized;
+                return false;
+            }
+            return true;
+        }
 
-            if (raw == 0x800000)
-                return 0;
+        /**
+         * @brief Start non-blocking measurement
+         * 
+         * @details
+         * Normal mode: latest result is burst read immediately.
+         * Forced mode: measurement is triggered, result is read by Poll after measurement time.
+         * 
+         * @param [in] callback Measurement complete callback (optional, it is called from interrupt)
+         * 
+         * @retval true Measurement has been started
+         * @retval false Sensor is not ready or I2C bus is busy
+         */
+        static bool StartMeasurement(Callback callback = nullptr)
+        {
+            if(_state != State::Ready)
+                return false;
 
-            raw >>= 4;
+            _callback = callback;
+            if(_control.Mode == static_cast<uint8_t>(Mode::Forced))
+            {
+                // Forced measurement delay is handled by Poll
+                if constexpr (std::is_void_v<_Timebase>)
+                {
+                    return false;
+                }
+                else
+                {
+                    ControlPacket::Encode(_control, _buffer);
+                    _state = State::Triggering;
+                    if(_I2CBus::WriteAsync(Bmp280Address, static_cast<uint16_t>(Register::Control), _buffer, 1, I2cOpts::None, OnMeasurementTriggered) != I2cStatus::Success)
+                    {
+                        _state = State::Ready;
+                        return false;
+                    }
+                    return true;
+                }
+            }
+            return StartDataRead();
+        }
 
-            int32_t firstTemp = ((((raw >> 3) - (static_cast<int32_t>(_calibrationData.T1) << 1))) *
-                    (static_cast<int32_t>(_calibrationData.T2))) >>
-                    11;
+        /**
+         * @brief Process time-driven steps (startup delay, forced measurement delay)
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Poll()
+        {
+            if constexpr (!std::is_void_v<_Timebase>)
+            {
+                State state = _state;
+                if(state == State::Startup && Elapsed(StartupTime))
+                {
+                    _state = State::Configuring;
+                    if(_I2CBus::EnableAsyncRead(Bmp280Address, static_cast<uint16_t>(Register::DigT1), _buffer, CalibrationPacket::Size, I2cOpts::None, OnCalibrationRead) != I2cStatus::Success)
+                        _state = State::Startup;
+                }
+                else if(state == State::Measuring && Elapsed(MeasurementTime()))
+                {
+                    if(!StartDataRead())
+                        _state = State::Measuring;
+                }
+            }
+        }
 
-            int32_t secondTemp = (((((raw >> 4) - (static_cast<int32_t>(_calibrationData.T1))) *
-                        ((raw >> 4) - (static_cast<int32_t>(_calibrationData.T1)))) >>
-                    12) *
-                    (static_cast<int32_t>(_calibrationData.T3))) >>
-                    14;
+        /**
+         * @brief Returns driver state
+         * 
+         * @returns State
+         */
+        static State GetState()
+        {
+            return _state;
+        }
 
-            firstTemp += secondTemp;
+        /**
+         * @brief Blocking measurement (trigger in forced mode and burst read)
+         * 
+         * @retval true Success
+         * @retval false I2C error
+         */
+        static bool Read()
+        {
+            if(_control.Mode == static_cast<uint8_t>(Mode::Forced))
+            {
+                uint8_t control;
+                ControlPacket::Encode(_control, &control);
+                if(WriteRegister(Register::Control, control) != I2cStatus::Success)
+                    return false;
+                // Status.measuring bit is set while conversion is running
+                while(ReadRegister(Register::Status) & 0x08)
+                    continue;
+            }
+            if(_I2CBus::Read(Bmp280Address, static_cast<uint16_t>(Register::PressureData), _buffer, DataSize) != I2cStatus::Success)
+                return false;
+            ProcessData();
+            return true;
+        }
 
-            return static_cast<float>((firstTemp * 5) >> 8) / 100;
+        /**
+         * @brief Returns last measured temperature
+         * 
+         * @returns Temperature in 0.01 degrees Celsius (5123 equals 51.23 °C)
+         */
+        static int32_t Temperature()
+        {
+            return _temperature;
+        }
+
+        /**
+         * @brief Returns last measured pressure
+         * 
+         * @returns Pressure in Pa in Q24.8 format (24674867 equals 24674867/256 = 96386.2 Pa)
+         */
+        static uint32_t Pressure()
+        {
+            return _pressure;
+        }
+
+        /**
+         * @brief Read temperature
+         * 
+         * @returns Temperature
+         */
+        static float ReadTemperature()
+        {
+            Read();
+            return static_cast<float>(_temperature) / 100;
         }
 
     private:
@@ -219,24 +430,187 @@ namespace Zhele::Drivers
          */
         static void ReadCalibrationData()
         {
-            _I2CBus::Read(Bmp280Address, static_cast<uint16_t>(Register::DigT1), reinterpret_cast<uint8_t*>(&_calibrationData), sizeof(CalibrationData));
+            _I2CBus::Read(Bmp280Address, static_cast<uint16_t>(Register::DigT1), _buffer, CalibrationPacket::Size);
+            CalibrationPacket::Decode(_buffer, _calibrationData);
         }
 
         /**
-         * @brief Read 3-bytes register.
+         * @brief Compensate raw temperature (datasheet integer formula)
          * 
-         * @param regAddress Register address
+         * @param [in] calibration Calibration data
+         * @param [in] raw Raw 20-bit ADC value
+         * @param [out] fine Fine temperature for pressure compensation
+         * 
+         * @returns Temperature in 0.01 degrees Celsius
+         */
+        static constexpr int32_t CompensateTemperature(const CalibrationData& calibration, int32_t raw, int32_t& fine)
+        {
+            int32_t var1 = ((((raw >> 3) - (static_cast<int32_t>(calibration.T1) << 1))) * static_cast<int32_t>(calibration.T2)) >> 11;
+            int32_t var2 = (((((raw >> 4) - static_cast<int32_t>(calibration.T1)) * ((raw >> 4) - static_cast<int32_t>(calibration.T1))) >> 12)
+                * static_cast<int32_t>(calibration.T3)) >> 14;
+            fine = var1 + var2;
+            return (fine * 5 + 128) >> 8;
+        }
+
+        /**
+         * @brief Compensate raw pressure (datasheet 64-bit integer formula)
+         * 
+         * @param [in] calibration Calibration data
+         * @param [in] raw Raw 20-bit ADC value
+         * @param [in] fine Fine temperature
+         * 
+         * @returns Pressure in Pa in Q24.8 format
+         */
+        static constexpr uint32_t CompensatePressure(const CalibrationData& calibration, int32_t raw, int32_t fine)
+        {
+            int64_t var1 = static_cast<int64_t>(fine) - 128000;
+            int64_t var2 = var1 * var1 * static_cast<int64_t>(calibration.P6);
+            var2 = var2 + ((var1 * static_cast<int64_t>(calibration.P5)) * (int64_t(1) << 17));
+            var2 = var2 + (static_cast<int64_t>(calibration.P4) * (int64_t(1) << 35));
+            var1 = ((var1 * var1 * static_cast<int64_t>(calibration.P3)) >> 8) + ((var1 * static_cast<int64_t>(calibration.P2)) * (int64_t(1) << 12));
+            var1 = (((int64_t(1) << 47) + var1) * static_cast<int64_t>(calibration.P1)) >> 33;
+            if(var1 == 0)
+                return 0;
+            int64_t pressure = 1048576 - raw;
+            pressure = (((pressure * (int64_t(1) << 31)) - var2) * 3125) / var1;
+            var1 = (static_cast<int64_t>(calibration.P9) * (pressure >> 13) * (pressure >> 13)) >> 25;
+            var2 = (static_cast<int64_t>(calibration.P8) * pressure) >> 19;
+            pressure = ((pressure + var1 + var2) >> 8) + (static_cast<int64_t>(calibration.P7) * 16);
+            return static_cast<uint32_t>(pressure);
+        }
+
+        /**
+         * @brief Max measurement time for current oversampling (datasheet, appendix B)
+         * 
+         * @returns Measurement time (us)
+         */
+        static uint32_t MeasurementTime()
+        {
+            auto factor = [](uint8_t sampling) -> uint32_t { return sampling == 0 ? 0 : 1u << (sampling - 1); };
+            uint32_t time = 1250 + 2300 * factor(_control.TemparatureOversampling);
+            if(_control.PressureOversampling != 0)
+                time += 2300 * factor(_control.PressureOversampling) + 575;
+            return time;
+        }
+
+        /**
+         * @brief Check that time since last timestamp exceeds given value
+         * 
+         * @param [in] time Time (us)
+         * 
+         * @retval true Time is elapsed
+         * @retval false Time is not elapsed
+         */
+        static bool Elapsed(uint32_t time)
+        {
+            return static_cast<uint32_t>(_Timebase::Micros() - _timestamp) >= time;
+        }
+
+        /**
+         * @brief Decode and compensate burst data
          * 
-         * @return 3-bytes register value
+         * @par Returns
+         *  Nothing
          */
-        static uint32_t ReadRegister24(Register regAddress)
-        {  
-            uint32_t value = 0;
-        
-            _I2CBus::Read(Bmp280Address, static_cast<uint16_t>(regAddress), (reinterpret_cast<uint8_t*>(&value)), 3);
-            std::swap(reinterpret_cast<uint8_t*>(&value)[0], reinterpret_cast<uint8_t*>(&value)[2]);
-
-            return value;
+        static void ProcessData()
+        {
+            int32_t rawPressure = (static_cast<int32_t>(_buffer[0]) << 12) | (_buffer[1] << 4) | (_buffer[2] >> 4);
+            int32_t rawTemperature = (static_cast<int32_t>(_buffer[3]) << 12) | (_buffer[4] << 4) | (_buffer[5] >> 4);
+
+            if(rawTemperature == SkippedValue)
+                return;
+
+            int32_t fine = 0;
+            _temperature = CompensateTemperature(_calibrationData, rawTemperature, fine);
+            if(rawPressure != SkippedValue)
+                _pressure = CompensatePressure(_calibrationData, rawPressure, fine);
+        }
+
+        static bool StartDataRead()
+        {
+            _state = State::Reading;
+            if(_I2CBus::EnableAsyncRead(Bmp280Address, static_cast<uint16_t>(Register::PressureData), _buffer, DataSize, I2cOpts::None, OnDataRead) != I2cStatus::Success)
+            {
+                _state = State::Ready;
+                return false;
+            }
+            return true;
+        }
+
+        static void Complete(State state)
+        {
+            _state = state;
+            Callback callback = _callback;
+            if(callback)
+                callback(state == State::Ready);
+        }
+
+        static void OnResetWritten(I2cStatus status)
+        {
+            if(status != I2cStatus::Success)
+            {
+                Complete(State::Error);
+                return;
+            }
+            _timestamp = _Timebase::Micros();
+            _state = State::Startup;
+        }
+
+        static void OnCalibrationRead(I2cStatus status)
+        {
+            if(status != I2cStatus::Success)
+            {
+                Complete(State::Error);
+                return;
+            }
+            CalibrationPacket::Decode(_buffer, _calibrationData);
+            if(_I2CBus::EnableAsyncRead(Bmp280Address, static_cast<uint16_t>(Register::ChipId), _buffer, 1, I2cOpts::None, OnChipIdRead) != I2cStatus::Success)
+                Complete(State::Error);
+        }
+
+        static void OnChipIdRead(I2cStatus status)
+        {
+            if(status != I2cStatus::Success || _buffer[0] != ChipId)
+            {
+                Complete(State::Error);
+                return;
+            }
+
+            // Register address/data pairs: config (ignored in normal mode) first, then control
+            ConfigPacket::Encode(_config, &_buffer[0]);
+            _buffer[1] = static_cast<uint8_t>(Register::Control);
+            ControlPacket::Encode(_control, &_buffer[2]);
+            if(_I2CBus::WriteAsync(Bmp280Address, static_cast<uint16_t>(Register::Config), _buffer, 3, I2cOpts::None, OnConfigured) != I2cStatus::Success)
+                Complete(State::Error);
+        }
+
+        static void OnConfigured(I2cStatus status)
+        {
+            Complete(status == I2cStatus::Success ? State::Ready : State::Error);
+        }
+
+        static void OnMeasurementTriggered(I2cStatus status)
+        {
+            if(status != I2cStatus::Success)
+            {
+                Complete(State::Error);
+                return;
+            }
+            _timestamp = _Timebase::Micros();
+            _state = State::Measuring;
+        }
+
+        static void OnDataRead(I2cStatus status)
+        {
+            if(status != I2cStatus::Success)
+            {
+                _state = State::Ready;
+                if(_callback)
+                    _callback(false);
+                return;
+            }
+            ProcessData();
+            Complete(State::Ready);
         }
 
         /**
@@ -270,18 +644,33 @@ namespace Zhele::Drivers
         }
     };
 
-    template<typename _I2CBus>
-    Bmp280<_I2CBus>::CalibrationData Bmp280<_I2CBus>::_calibrationData = {};
-    template<typename _I2CBus>
-    Bmp280<_I2CBus>::Control Bmp280<_I2CBus>::_control = {
-        .TemparatureOversampling = static_cast<uint8_t>(Bmp280<_I2CBus>::Sampling::X4),
-        .PressureOversampling  = static_cast<uint8_t>(Bmp280<_I2CBus>::Sampling::X2),
-        .Mode = static_cast<uint8_t>(Bmp280<_I2CBus>::Mode::Normal)
+    #define BMP280_TEMPLATE_ARGS template<typename _I2CBus, typename _Timebase, uint8_t _Address>
+    #define BMP280_TEMPLATE_QUALIFIER Bmp280<_I2CBus, _Timebase, _Address>
+
+    BMP280_TEMPLATE_ARGS
+    BMP280_TEMPLATE_QUALIFIER::CalibrationData BMP280_TEMPLATE_QUALIFIER::_calibrationData = {};
+    BMP280_TEMPLATE_ARGS
+    BMP280_TEMPLATE_QUALIFIER::Control BMP280_TEMPLATE_QUALIFIER::_control = {
+        .TemparatureOversampling = static_cast<uint8_t>(BMP280_TEMPLATE_QUALIFIER::Sampling::X4),
+        .PressureOversampling  = static_cast<uint8_t>(BMP280_TEMPLATE_QUALIFIER::Sampling::X2),
+        .Mode = static_cast<uint8_t>(BMP280_TEMPLATE_QUALIFIER::Mode::Normal)
     };
-    template<typename _I2CBus>
-    Bmp280<_I2CBus>::Config Bmp280<_I2CBus>::_config = {
-        .StandbyDuration = static_cast<uint8_t>(Bmp280<_I2CBus>::StandbyDuration::Ms250),
-        .Filter = static_cast<uint8_t>(Bmp280<_I2CBus>::Filter::X16)
+    BMP280_TEMPLATE_ARGS
+    BMP280_TEMPLATE_QUALIFIER::Config BMP280_TEMPLATE_QUALIFIER::_config = {
+        .StandbyDuration = static_cast<uint8_t>(BMP280_TEMPLATE_QUALIFIER::StandbyDuration::Ms250),
+        .Filter = static_cast<uint8_t>(BMP280_TEMPLATE_QUALIFIER::Filter::X16)
     };
+    BMP280_TEMPLATE_ARGS
+    uint8_t BMP280_TEMPLATE_QUALIFIER::_buffer[BMP280_TEMPLATE_QUALIFIER::CalibrationPacket::Size];
+    BMP280_TEMPLATE_ARGS
+    volatile typename BMP280_TEMPLATE_QUALIFIER::State BMP280_TEMPLATE_QUALIFIER::_state = BMP280_TEMPLATE_QUALIFIER::State::NotInitialized;
+    BMP280_TEMPLATE_ARGS
+    uint32_t BMP280_TEMPLATE_QUALIFIER::_timestamp = 0;
+    BMP280_TEMPLATE_ARGS
+    typename BMP280_TEMPLATE_QUALIFIER::Callback BMP280_TEMPLATE_QUALIFIER::_callback = nullptr;
+    BMP280_TEMPLATE_ARGS
+    int32_t BMP280_TEMPLATE_QUALIFIER::_temperature = 0;
+    BMP280_TEMPLATE_ARGS
+    uint32_t BMP280_TEMPLATE_QUALIFIER::_pressure = 0;
 }
-#endif // !ZHELE_DRIVERS_BMP280_H
\ No newline at end of file
+#endif // !ZHELE_DRIVERS_BMP280_H
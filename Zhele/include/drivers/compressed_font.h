@@ -0,0 +1,338 @@
+/**
+ * @file
+ * Implements compile-time compressed (run-length encoded) fonts
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DRIVERS_COMPRESSED_FONT_H
+#define ZHELE_DRIVERS_COMPRESSED_FONT_H
+
+#include "fonts.h"
+
+#include <stdint.h>
+
+namespace Zhele::Drivers
+{
+    namespace Private
+    {
+        /**
+         * @brief Compile-time run-length encoder of font glyphs
+         *
+         * @details
+         * Glyph pixels are scanned row by row (rows are concatenated), so every run is
+         * one or more horizontal spans. Lengths of alternating background and foreground runs
+         * (first run is background) are stored LSB first: value less than 2^ShortBits - 1 is run length,
+         * otherwise run length is 2^ShortBits - 1 plus next LongBits bits. Longer run is split by
+         * zero-length run of opposite color, trailing background run is not stored,
+         * glyphs are aligned to byte (zero padding decodes to empty runs).
+         *
+         * @tparam _Font Source (uncompressed) font
+         */
+        template<typename _Font>
+        class FontRleEncoder
+        {
+        public:
+            static constexpr unsigned SymbolsCount()
+            {
+                return _Font::SymbolsCount();
+            }
+
+            static constexpr uint8_t GlyphWidth(unsigned index)
+            {
+                return _Font::WidthByIndex(index);
+            }
+
+            /**
+             * @brief Encodes glyph
+             *
+             * @param [in] index Glyph index
+             * @param [in] shortBits Short code bits
+             * @param [in] longBits Long code extra bits
+             * @param [out] output Output (nullptr to count only)
+             *
+             * @returns Encoded size (bytes)
+             */
+            static constexpr unsigned Encode(unsigned index, uint8_t shortBits, uint8_t longBits, uint8_t* output)
+            {
+                const unsigned pixels = GlyphWidth(index) * _Font::Height;
+                const unsigned escape = (1u << shortBits) - 1;
+                const unsigned maxRun = escape + (1u << longBits) - 1;
+                unsigned bits = 0;
+                unsigned position = 0;
+                bool color = false;
+
+                while(position < pixels)
+                {
+                    unsigned run = 0;
+                    while(position + run < pixels && Bit(index, position + run) == color)
+                        ++run;
+
+                    position += run;
+                    if(position == pixels && !color)
+                        break;
+
+                    for(; run > maxRun; run -= maxRun)
+                    {
+                        PutRun(output, bits, maxRun, shortBits, longBits);
+                        PutRun(output, bits, 0, shortBits, longBits);
+                    }
+                    PutRun(output, bits, run, shortBits, longBits);
+                    color = !color;
+                }
+                return (bits + 7) / 8;
+            }
+
+        private:
+            static constexpr bool Bit(unsigned index, unsigned position)
+            {
+                // Glyph is stored by pages (8 rows, LSB is top), last partial page is aligned to MSB
+                const uint8_t extraBits = _Font::Height % 8;
+                const uint8_t width = GlyphWidth(index);
+                const uint8_t* glyph = _Font::GetByIndex(index);
+                uint8_t column = position % width;
+                uint8_t row = position / width;
+                uint8_t page = row / 8;
+                uint8_t value = glyph[page * width + column];
+                if(extraBits > 0 && page == _Font::Height / 8)
+                    value >>= (8 - extraBits);
+                return (value >> (row % 8)) & 0x01;
+            }
+
+            static constexpr void PutRun(uint8_t* output, unsigned& bits, unsigned run, uint8_t shortBits, uint8_t longBits)
+            {
+                const unsigned escape = (1u << shortBits) - 1;
+                if(run < escape)
+                {
+                    Put(output, bits, run, shortBits);
+                }
+                else
+                {
+                    Put(output, bits, escape, shortBits);
+                    Put(output, bits, run - escape, longBits);
+                }
+            }
+
+            static constexpr void Put(uint8_t* output, unsigned& bits, unsigned value, uint8_t count)
+            {
+                for(uint8_t i = 0; i < count; ++i, ++bits)
+                {
+                    if(output != nullptr && ((value >> i) & 0x01))
+                        output[bits / 8] |= 1 << (bits % 8);
+                }
+            }
+        };
+    }
+
+    /**
+     * @brief Compressed font
+     *
+     * @details
+     * Glyphs of source font are run-length encoded at compile time (see Private::FontRleEncoder),
+     * code lengths are chosen to minimize size. Only compressed data, glyph sizes (byte per glyph,
+     * plus offset of every 8th glyph) and widths (for non-monospace font) are placed to flash:
+     * source font data is used in constant expressions only. Gain grows with font size
+     * (there is no gain for small fonts like Font5x7: glyphs consist of short runs).
+     * Renderers (Graphics, GlyphCache) do not unpack glyph bitmap: decoder outputs horizontal spans directly.
+     *
+     * @tparam _Font Source font (MonoSpaceFont or Font)
+     */
+    template<typename _Font>
+    class CompressedFont
+    {
+        using Encoder = Private::FontRleEncoder<_Font>;
+        static constexpr unsigned SymbolsCount = Encoder::SymbolsCount();
+        static constexpr unsigned OffsetStep = 8;
+
+        struct Code
+        {
+            uint8_t ShortBits;
+            uint8_t LongBits;
+            unsigned Size;
+        };
+
+        static constexpr Code ChooseCode()
+        {
+            Code best {0, 0, ~0u};
+            for(uint8_t shortBits = 1; shortBits <= 4; ++shortBits)
+            {
+                for(uint8_t longBits = 2; longBits <= 6; ++longBits)
+                {
+                    unsigned size = 0;
+                    for(unsigned i = 0; i < SymbolsCount; ++i)
+                        size += Encoder::Encode(i, shortBits, longBits, nullptr);
+                    if(size < best.Size)
+                        best = {shortBits, longBits, size};
+                }
+            }
+            return best;
+        }
+
+        static constexpr Code _code = ChooseCode();
+
+        struct Table
+        {
+            uint16_t Offsets[(SymbolsCount + OffsetStep - 1) / OffsetStep];
+            uint8_t Sizes[SymbolsCount];
+            uint8_t Widths[_Font::MonoSpace ? 1 : SymbolsCount];
+            uint8_t Data[_code.Size];
+        };
+
+        static constexpr Table Build()
+        {
+            Table table {};
+            unsigned offset = 0;
+            for(unsigned i = 0; i < SymbolsCount; ++i)
+            {
+                if(i % OffsetStep == 0)
+                    table.Offsets[i / OffsetStep] = offset;
+                if constexpr (!_Font::MonoSpace)
+                    table.Widths[i] = Encoder::GlyphWidth(i);
+                table.Sizes[i] = Encoder::Encode(i, _code.ShortBits, _code.LongBits, &table.Data[offset]);
+                offset += table.Sizes[i];
+            }
+            return table;
+        }
+
+        static constexpr bool CheckSizes()
+        {
+            for(unsigned i = 0; i < SymbolsCount; ++i)
+            {
+                if(Encoder::Encode(i, _code.ShortBits, _code.LongBits, nullptr) > 0xff)
+                    return false;
+            }
+            return true;
+        }
+
+        static_assert(_code.Size < 0x10000, "Font is too large for 16-bit offsets");
+        static_assert(CheckSizes(), "Glyph is too large for 8-bit size");
+        static constexpr Table _table = Build();
+
+    public:
+        /// Font is compressed: Get is not available, use ForEachRun
+        static constexpr bool Compressed = true;
+
+        /// Is font monospace
+        static constexpr bool MonoSpace = _Font::MonoSpace;
+
+        /// Font height
+        static constexpr uint8_t Height = _Font::Height;
+
+        /// Font width (max width for non-monospace font)
+        static constexpr uint8_t Width = _Font::MaxWidth();
+
+        /**
+         * @brief Returns max symbol width
+         *
+         * @returns Max width
+         */
+        static constexpr uint8_t MaxWidth()
+        {
+            return Width;
+        }
+
+        /**
+         * @brief Returns width for given symbol
+         *
+         * @param [in] symbol Symbol
+         *
+         * @returns Symbols`s width.
+         */
+        static constexpr uint8_t GetWidth(char symbol)
+        {
+            if constexpr (MonoSpace)
+                return Width;
+            else
+                return _table.Widths[static_cast<uint8_t>(symbol - _Font::AsciiOffset)];
+        }
+
+        /**
+         * @brief Returns compressed font size
+         *
+         * @returns Size of data and tables (bytes)
+         */
+        static constexpr unsigned Size()
+        {
+            return sizeof(Table);
+        }
+
+        /**
+         * @brief Decodes glyph to horizontal runs
+         *
+         * @tparam _Callback Callable void(uint8_t column, uint8_t row, uint8_t length, bool foreground)
+         *
+         * @param [in] symbol Symbol
+         * @param [in] callback Runs callback (runs never cross line end, empty runs are skipped)
+         * @param [in] background Report background runs (including trailing background)
+         *
+         * @returns Symbol width
+         */
+        template<typename _Callback>
+        static uint8_t ForEachRun(char symbol, _Callback callback, bool background = false)
+        {
+            const unsigned index = static_cast<uint8_t>(symbol - _Font::AsciiOffset);
+            const uint8_t width = GetWidth(symbol);
+            const unsigned escape = (1u << _code.ShortBits) - 1;
+
+            unsigned offset = _table.Offsets[index / OffsetStep];
+            for(unsigned i = index - index % OffsetStep; i < index; ++i)
+                offset += _table.Sizes[i];
+
+            const uint8_t* data = &_table.Data[offset];
+            const unsigned totalBits = _table.Sizes[index] * 8;
+            unsigned bit = 0;
+            uint8_t column = 0;
+            uint8_t row = 0;
+            bool foreground = false;
+
+            auto read = [data, &bit](uint8_t count) {
+                unsigned value = 0;
+                for(uint8_t i = 0; i < count; ++i, ++bit)
+                    value |= ((data[bit / 8] >> (bit % 8)) & 0x01) << i;
+                return value;
+            };
+
+            while(bit + _code.ShortBits <= totalBits && row < Height)
+            {
+                unsigned run = read(_code.ShortBits);
+                if(run == escape)
+                    run += read(_code.LongBits);
+
+                if(foreground || background)
+                {
+                    while(run > 0)
+                    {
+                        uint8_t length = static_cast<unsigned>(width - column) < run ? width - column : run;
+                        callback(column, row, length, foreground);
+                        run -= length;
+                        column += length;
+                        if(column == width)
+                        {
+                            column = 0;
+                            ++row;
+                        }
+                    }
+                }
+                else
+                {
+                    column += run;
+                    row += column / width;
+                    column %= width;
+                }
+                foreground = !foreground;
+            }
+
+            // Trailing background
+            if(background)
+            {
+                for(; row < Height; ++row, column = 0)
+                    callback(column, row, width - column, false);
+            }
+            return width;
+        }
+    };
+}
+
+#endif //! ZHELE_DRIVERS_COMPRESSED_FONT_H
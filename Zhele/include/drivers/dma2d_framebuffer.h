@@ -0,0 +1,200 @@
+/**
+ * @file
+ * Implements framebuffer with DMA2D acceleration (Graphics backend)
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DRIVERS_DMA2D_FRAMEBUFFER_H
+#define ZHELE_DRIVERS_DMA2D_FRAMEBUFFER_H
+
+#include <dma2d.h>
+
+#include <stdint.h>
+#include <type_traits>
+
+#if defined (DMA2D)
+namespace Zhele::Drivers
+{
+    /**
+     * @brief Framebuffer in memory, drawn by DMA2D (Graphics backend)
+     *
+     * @details
+     * Spans and rectangles are filled by DMA2D (short spans are filled by CPU: DMA2D setup costs more),
+     * images are copied with pixel format conversion and alpha blending. Operations are asynchronous,
+     * so CPU composes next primitive while DMA2D fills previous one. Call Wait (or Data) before
+     * framebuffer output (to LTDC or display, Ili9341::DrawImage for example).
+     * @code
+     * using Screen = Dma2DFramebuffer<320, 240>;
+     * using Canvas = Graphics<Screen>;
+     * @endcode
+     *
+     * @tparam _Width Width
+     * @tparam _Height Height
+     * @tparam _Mode Pixel format (RGB565 or ARGB8888)
+     */
+    template<uint16_t _Width, uint16_t _Height, Dma2D::ColorMode _Mode = Dma2D::ColorMode::Rgb565>
+    class Dma2DFramebuffer
+    {
+        static_assert(_Mode == Dma2D::ColorMode::Rgb565 || _Mode == Dma2D::ColorMode::Argb8888,
+            "Framebuffer supports RGB565 and ARGB8888 formats.");
+
+        /// Shorter spans are filled by CPU
+        static const int DmaSpanThreshold = 16;
+    public:
+        /// Color type (for Graphics)
+        using ColorType = std::conditional_t<_Mode == Dma2D::ColorMode::Rgb565, uint16_t, uint32_t>;
+
+        /// Width
+        static const uint16_t Width = _Width;
+        /// Height
+        static const uint16_t Height = _Height;
+
+        /**
+         * @brief Init framebuffer (enables DMA2D)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Init()
+        {
+            Dma2D::Init();
+        }
+
+        /**
+         * @brief Fill horizontal span (Graphics backend interface)
+         *
+         * @param [in] x Left column
+         * @param [in] y Line
+         * @param [in] length Span length
+         * @param [in] color Color
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void FillSpan(int x, int y, int length, ColorType color)
+        {
+            if(length >= DmaSpanThreshold)
+            {
+                FillArea(x, y, length, 1, color);
+                return;
+            }
+            // CPU access should not be overwritten by earlier DMA2D operation
+            Dma2D::Wait();
+            ColorType* pixel = &_buffer[y * _Width + x];
+            for(int i = 0; i < length; ++i)
+                pixel[i] = color;
+        }
+
+        /**
+         * @brief Fill rectangle (Graphics backend interface)
+         *
+         * @param [in] x Left column
+         * @param [in] y Top line
+         * @param [in] width Width
+         * @param [in] height Height
+         * @param [in] color Color
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void FillArea(int x, int y, int width, int height, ColorType color)
+        {
+            Dma2D::Fill(Target(x, y, width), width, height, color);
+        }
+
+        /**
+         * @brief Draw image (image should be inside screen)
+         *
+         * @param [in] x Left column
+         * @param [in] y Top line
+         * @param [in] image Image pixels
+         * @param [in] width Image width
+         * @param [in] height Image height
+         * @param [in] mode Image pixel format (converted if differs from framebuffer format)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void DrawImage(int x, int y, const void* image, uint16_t width, uint16_t height, Dma2D::ColorMode mode = _Mode)
+        {
+            if(!Inside(x, y, width, height))
+                return;
+            if(mode == _Mode)
+                Dma2D::Copy({image, 0, mode}, Target(x, y, width), width, height);
+            else
+                Dma2D::Convert({image, 0, mode}, Target(x, y, width), width, height);
+        }
+
+        /**
+         * @brief Blend image over framebuffer (image should be inside screen)
+         *
+         * @details
+         * Image pixel alpha (ARGB formats) or alpha mask (A8/A4 with given color, antialiased glyphs for example)
+         * is multiplied by alpha.
+         *
+         * @param [in] x Left column
+         * @param [in] y Top line
+         * @param [in] image Image pixels
+         * @param [in] width Image width
+         * @param [in] height Image height
+         * @param [in] mode Image pixel format
+         * @param [in] alpha Image alpha (255 - opaque)
+         * @param [in] color Color for alpha-only formats (RGB888)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void BlendImage(int x, int y, const void* image, uint16_t width, uint16_t height,
+            Dma2D::ColorMode mode, uint8_t alpha = 255, uint32_t color = 0)
+        {
+            if(!Inside(x, y, width, height))
+                return;
+            Dma2D::Area target = Target(x, y, width);
+            Dma2D::Blend({image, 0, mode}, target, target, width, height, alpha, color);
+        }
+
+        /**
+         * @brief Wait for DMA2D operations completion
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Wait()
+        {
+            Dma2D::Wait();
+        }
+
+        /**
+         * @brief Returns framebuffer (waits for drawing completion)
+         *
+         * @returns Pixels (Width * Height, line by line)
+         */
+        static const ColorType* Data()
+        {
+            Dma2D::Wait();
+            return _buffer;
+        }
+
+    private:
+        static bool Inside(int x, int y, int width, int height)
+        {
+            return x >= 0 && y >= 0 && x + width <= _Width && y + height <= _Height;
+        }
+
+        static Dma2D::Area Target(int x, int y, int width)
+        {
+            return {&_buffer[y * _Width + x], static_cast<uint16_t>(_Width - width), _Mode};
+        }
+
+        static ColorType _buffer[_Width * _Height];
+    };
+
+    template<uint16_t _Width, uint16_t _Height, Dma2D::ColorMode _Mode>
+    typename Dma2DFramebuffer<_Width, _Height, _Mode>::ColorType Dma2DFramebuffer<_Width, _Height, _Mode>::_buffer[_Width * _Height];
+}
+#endif
+
+#endif //! ZHELE_DRIVERS_DMA2D_FRAMEBUFFER_H
@@ -301,5 +301,212 @@ namespace Zhele::Drivers
 			return (bin / 10) << 4 | (bin % 10);
 		}
 	};
+
+	/**
+	 * @brief DS1307 RTC with cached time
+	 * 
+	 * @details
+	 * SQW/OUT pin is configured to 1 Hz and connected to EXTI line. Time is read once
+	 * at init, then cached time is incremented by SQW falling edge (seconds register is updated
+	 * at the same moment), so GetDateTime is memory read. Cached time is re-synced with RTC by Poll
+	 * every resync period.
+	 * Call IrqHandler from EXTI IRQ handler (or Tick if EXTI line is served by ExtiDispatcher).
+	 * 
+	 * @tparam _I2CBus Target I2C type (See i2c.h)
+	 * @tparam _Exti EXTI line of SQW pin (See exti.h)
+	 * @tparam _SqwPin SQW/OUT pin (open drain output of RTC, pull-up is enabled)
+	 */
+	template <typename _I2CBus, typename _Exti, typename _SqwPin>
+	class Ds1307CachedClock : public Ds1307<_I2CBus>
+	{
+		using Base = Ds1307<_I2CBus>;
+		const static uint8_t Ds1307Address = (0xD0 >> 1); ///< I2C address in 7-bit mode
+		const static uint8_t ControlRegister = 0x07; ///< Control register address
+		const static uint8_t SquareWave1Hz = 0x10; ///< SQWE bit, RS1:RS0 = 00 (1 Hz)
+
+	public:
+		using Time = typename Base::Time;
+
+		/**
+		 * @brief Enable 1 Hz output and read time
+		 * 
+		 * @param [in] resyncPeriod Re-sync period in seconds (0 - never)
+		 * 
+		 * @par Returns
+		 *	Nothing
+		 */
+		static void Init(uint32_t resyncPeriod = 3600)
+		{
+			_resyncPeriod = resyncPeriod;
+			_I2CBus::WriteU8(Ds1307Address, ControlRegister, SquareWave1Hz);
+
+			_Exti::template InitPin<_SqwPin>(_SqwPin::PullMode::PullUp);
+			_Exti::template Init<_Exti::Trigger::Falling, typename _SqwPin::Port>();
+			_Exti::EnableInterrupt();
+
+			Resync();
+		}
+
+		/**
+		 * @brief Returns cached time
+		 * 
+		 * @details
+		 * Method can be called from any interrupt.
+		 * 
+		 * @returns Current time
+		 */
+		static Time GetDateTime()
+		{
+			uint32_t primask = __get_PRIMASK();
+			__disable_irq();
+			Time time = _time;
+			__set_PRIMASK(primask);
+			return time;
+		}
+
+		/**
+		 * @brief Returns seconds count since init (monotonic, it is not changed by re-sync)
+		 * 
+		 * @returns Seconds count
+		 */
+		static uint32_t Uptime()
+		{
+			return _ticks;
+		}
+
+		/**
+		 * @brief Set time of RTC and cache
+		 * 
+		 * @details
+		 * Seconds register write resets RTC countdown chain, so next edge is after one second.
+		 * 
+		 * @param [in] time Time
+		 * 
+		 * @par Returns
+		 *	Nothing
+		 */
+		static void SetDateTime(const Time& time)
+		{
+			Base::SetDateTime(time);
+			uint32_t primask = __get_PRIMASK();
+			__disable_irq();
+			_time = time;
+			_lastSync = _ticks;
+			__set_PRIMASK(primask);
+		}
+
+		/**
+		 * @brief Read time from RTC to cache
+		 * 
+		 * @details
+		 * Read is repeated if SQW edge occurs during it.
+		 * 
+		 * @par Returns
+		 *	Nothing
+		 */
+		static void Resync()
+		{
+			Time time;
+			uint32_t ticks;
+			do
+			{
+				ticks = _ticks;
+				time = Base::GetDateTime();
+			} while(ticks != _ticks);
+
+			uint32_t primask = __get_PRIMASK();
+			__disable_irq();
+			if(ticks == _ticks)
+			{
+				_time = time;
+				_lastSync = ticks;
+			}
+			__set_PRIMASK(primask);
+		}
+
+		/**
+		 * @brief Re-sync cache if period is elapsed (call it from main loop)
+		 * 
+		 * @par Returns
+		 *	Nothing
+		 */
+		static void Poll()
+		{
+			if(_resyncPeriod != 0 && _ticks - _lastSync >= _resyncPeriod)
+				Resync();
+		}
+
+		/**
+		 * @brief EXTI IRQ handler (clears EXTI flag)
+		 * 
+		 * @par Returns
+		 *	Nothing
+		 */
+		static void IrqHandler()
+		{
+			_Exti::ClearInterruptFlag();
+			Tick();
+		}
+
+		/**
+		 * @brief Increment cached time by one second
+		 * 
+		 * @par Returns
+		 *	Nothing
+		 */
+		static void Tick()
+		{
+			_ticks = _ticks + 1;
+
+			if(++_time.Seconds < 60)
+				return;
+			_time.Seconds = 0;
+			if(++_time.Minutes < 60)
+				return;
+			_time.Minutes = 0;
+			if(++_time.Hours < 24)
+				return;
+			_time.Hours = 0;
+			_time.Weekday = _time.Weekday % 7 + 1;
+			if(++_time.Day <= DaysInMonth(_time.Month, _time.Year))
+				return;
+			_time.Day = 1;
+			if(++_time.Month <= 12)
+				return;
+			_time.Month = 1;
+			_time.Year = (_time.Year + 1) % 100;
+		}
+
+	private:
+		/**
+		 * @brief Returns days count in month
+		 * 
+		 * @param [in] month Month (1 - 12)
+		 * @param [in] year Year (0 - 99, every fourth year of 2000-2099 is leap)
+		 * 
+		 * @returns Days count
+		 */
+		static uint8_t DaysInMonth(uint8_t month, uint8_t year)
+		{
+			static const uint8_t days[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+			if(month == 2 && year % 4 == 0)
+				return 29;
+			return days[(month - 1) % 12];
+		}
+
+		static Time _time;
+		static volatile uint32_t _ticks;
+		static uint32_t _lastSync;
+		static uint32_t _resyncPeriod;
+	};
+
+	template <typename _I2CBus, typename _Exti, typename _SqwPin>
+	typename Ds1307CachedClock<_I2CBus, _Exti, _SqwPin>::Time Ds1307CachedClock<_I2CBus, _Exti, _SqwPin>::_time = {};
+	template <typename _I2CBus, typename _Exti, typename _SqwPin>
+	volatile uint32_t Ds1307CachedClock<_I2CBus, _Exti, _SqwPin>::_ticks = 0;
+	template <typename _I2CBus, typename _Exti, typename _SqwPin>
+	uint32_t Ds1307CachedClock<_I2CBus, _Exti, _SqwPin>::_lastSync = 0;
+	template <typename _I2CBus, typename _Exti, typename _SqwPin>
+	uint32_t Ds1307CachedClock<_I2CBus, _Exti, _SqwPin>::_resyncPeriod = 0;
 }
 #endif // !ZHELE_DRIVERS_DS1307_H
\ No newline at end of file
@@ -11,6 +11,7 @@
 #define ZHELE_DS18B20_H
 
 #include <one_wire.h>
+#include <delay.h>
 
 namespace Zhele::Drivers
 {
@@ -48,6 +49,9 @@ namespace Zhele::Drivers
 
         static constexpr float Resolution = 0.0625;
     public:
+        /// DS18B20 family code
+        static const uint8_t FamilyCode = 0x28;
+
         /**
          * @brief Convert result
          */
@@ -91,13 +95,11 @@ namespace Zhele::Drivers
             if(!_Bus::Reset())
                 return false;
 
-            rom == nullptr
-                ? _Bus::SkipRom()
-                : _Bus::MatchRom(rom);
-
-            _Bus::WriteByte(Commands::ConvertTemperature);
+            uint8_t command[10];
+            uint8_t size = SelectCommand(rom, command);
+            command[size++] = Commands::ConvertTemperature;
 
-            return true;
+            return _Bus::Transaction(command, size);
         }
 
         /**
@@ -114,21 +116,106 @@ namespace Zhele::Drivers
             if(!_Bus::Reset())
                 return ConvertResult{false, ConvertResult::ConvertErrors::PrecenseError};
 
-            rom == nullptr
-                ? _Bus::SkipRom()
-                : _Bus::MatchRom(rom);
-            
-            _Bus::WriteByte(Commands::ReadScratchPad);
-            _Bus::ReadBytes(&scratchpad, sizeof(scratchpad));
+            // Select, command and scratchpad read in one transaction
+            uint8_t command[10];
+            uint8_t size = SelectCommand(rom, command);
+            command[size++] = Commands::ReadScratchPad;
+            _Bus::Transaction(command, size, &scratchpad, sizeof(scratchpad));
 
-            if(CalculateCrc(&scratchpad, 8) != scratchpad.Crc)
-                return ConvertResult{false, ConvertResult::ConvertErrors::CrcError};
+            return Decode(scratchpad);
+        }
 
-            uint8_t resolution = (scratchpad.Configuration >> 5) & 0b11;
-            scratchpad.Lsb &= 0xff << (3 - resolution);
-            float temperature = static_cast<float>(*(reinterpret_cast<int16_t*>(&scratchpad.Lsb))) * Resolution;
+        /**
+         * @brief Returns max temperature convert time
+         * 
+         * @param [in] resolutionBits Resolution (9..12 bits)
+         * 
+         * @returns Convert time (ms)
+         */
+        static constexpr unsigned ConversionTime(uint8_t resolutionBits)
+        {
+            return (750 + (1u << (12 - resolutionBits)) - 1) >> (12 - resolutionBits);
+        }
 
-            return ConvertResult{true, temperature};
+        /**
+         * @brief Find all DS18B20 sensors on line
+         * 
+         * @param [out] roms Found sensors ROMs
+         * @param [in] maxCount Max sensors count
+         * 
+         * @returns Found sensors count
+         */
+        static uint8_t Enumerate(uint8_t (*roms)[8], uint8_t maxCount)
+        {
+            return _Bus::Enumerate(roms, maxCount, FamilyCode);
+        }
+
+        /**
+         * @brief Start temperature convert for all sensors (one SKIP ROM command) and wait for completion
+         * 
+         * @tparam _ResolutionBits Configured sensors resolution (9..12 bits)
+         * 
+         * @retval true Success
+         * @retval false No devices on line
+         */
+        template<uint8_t _ResolutionBits = 12>
+        static bool ConvertAll()
+        {
+            static_assert(_ResolutionBits >= 9 && _ResolutionBits <= 12, "DS18B20 resolution is 9..12 bits");
+
+            if(!Start())
+                return false;
+
+            delay_ms<ConversionTime(_ResolutionBits)>();
+            return true;
+        }
+
+        /**
+         * @brief Read convert results of several sensors
+         * 
+         * @details
+         * Every sensor is read with one DMA transaction. Result of previous sensor is
+         * decoded while transaction for next sensor is in progress.
+         * 
+         * @param [in] roms Sensors ROMs
+         * @param [in] count Sensors count
+         * @param [out] results Conversion results
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void ReadAll(const uint8_t (*roms)[8], uint8_t count, ConvertResult* results)
+        {
+            Scratchpad scratchpads[2];
+            bool pending = false;
+
+            for(uint8_t i = 0; i < count; ++i)
+            {
+                if(!_Bus::Reset())
+                {
+                    results[i] = ConvertResult{false, ConvertResult::ConvertErrors::PrecenseError};
+                    if(pending)
+                        results[i - 1] = Decode(scratchpads[(i - 1) & 1]);
+                    pending = false;
+                    continue;
+                }
+
+                uint8_t command[10];
+                uint8_t size = SelectCommand(roms[i], command);
+                command[size++] = Commands::ReadScratchPad;
+
+                volatile bool complete = false;
+                _Bus::TransactionAsync(command, size, &scratchpads[i & 1], sizeof(Scratchpad), [&complete](void*, unsigned, bool){complete = true;});
+
+                if(pending)
+                    results[i - 1] = Decode(scratchpads[(i - 1) & 1]);
+
+                Power::LowPower::WaitFor(complete);
+                pending = true;
+            }
+
+            if(pending)
+                results[count - 1] = Decode(scratchpads[(count - 1) & 1]);
         }
 
         /**
@@ -144,23 +231,30 @@ namespace Zhele::Drivers
         }
 
     private:
-        static uint8_t CalculateCrc(const void* data, uint8_t size)
+        static ConvertResult Decode(Scratchpad& scratchpad)
         {
-            const uint8_t* castedData = reinterpret_cast<const uint8_t*>(data);
-            uint8_t crc = 0;
-            for(uint8_t i = 0; i < size; ++i)
+            if(_Bus::Crc(&scratchpad, 8) != scratchpad.Crc)
+                return ConvertResult{false, ConvertResult::ConvertErrors::CrcError};
+
+            uint8_t resolution = (scratchpad.Configuration >> 5) & 0b11;
+            scratchpad.Lsb &= 0xff << (3 - resolution);
+            float temperature = static_cast<float>(*(reinterpret_cast<int16_t*>(&scratchpad.Lsb))) * Resolution;
+
+            return ConvertResult{true, temperature};
+        }
+
+        static uint8_t SelectCommand(const uint8_t* rom, uint8_t* command)
+        {
+            if(rom == nullptr)
             {
-                uint8_t byte = castedData[i];
-                for (uint8_t j = 0; j < 8; ++j)
-                {
-                    uint8_t tmp = crc ^ byte;
-                    crc >>= 1;
-                    byte >>= 1;
-                    if ((tmp & 1) > 0)
-                        crc ^= 0x8c;
-                }
+                command[0] = _Bus::Commands::Skip;
+                return 1;
             }
-            return crc;
+
+            command[0] = _Bus::Commands::Match;
+            for(uint8_t i = 0; i < 8; ++i)
+                command[i + 1] = rom[i];
+            return 9;
         }
     };
 }
@@ -10,9 +10,11 @@
 #ifndef ZHELE_DRIVERS_ENCODER_H
 #define ZHELE_DRIVERS_ENCODER_H
 
+#include <iopins.h>
 #include <common/template_utils/type_list.h>
 
 #include <cstdint>
+#include <type_traits>
 
 namespace Zhele::Drivers
 {
@@ -93,5 +95,238 @@ namespace Zhele::Drivers
                 : ((counter + 2) >> 1) % (_MaxValue + 1);
         }
     };
+
+    /**
+     * @brief Class for quadrature encoder with 32-bit position, index and velocity
+     * 
+     * @details
+     * Timer counts every edge of both inputs (encoder mode 3). 32-bit position is accumulated
+     * from signed 16-bit counter differences, so it needs to be updated (by Position or Sample call)
+     * at least once per 32768 counts. Index pulse (Z) is captured by channel 3: capture register
+     * latches counter at index edge, so index position does not depend on interrupt latency.
+     * Velocity is estimated by position difference between periodic samples of second timer.
+     * 
+     * @tparam _Timer GP timer instance
+     * @tparam _PinA Input pin A (for 1 channel)
+     * @tparam _PinB Input pin B (for 2 channel)
+     * @tparam _IndexPin Index pin (for 3 channel, NullPin if index is not used)
+     */
+    template <typename _Timer,
+            typename _PinA = Zhele::TemplateUtils::GetType_t<0, typename _Timer::template InputCapture<0>::Pins>,
+            typename _PinB = Zhele::TemplateUtils::GetType_t<0, typename _Timer::template InputCapture<1>::Pins>,
+            typename _IndexPin = IO::NullPin>
+    class QuadratureEncoder
+    {
+        using InputA = typename _Timer::template InputCapture<0>;
+        using InputB = typename _Timer::template InputCapture<1>;
+        using IndexInput = typename _Timer::template InputCapture<2>;
+
+        static const bool HasIndex = !std::is_same_v<_IndexPin, IO::NullPin>;
+    public:
+        /**
+         * @brief Init encoder
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Init()
+        {
+            _Timer::Enable();
+            _Timer::SetPrescaler(0);
+            _Timer::SetPeriod(0xffff);
+
+            _Timer::SlaveMode::EnableSlaveMode(_Timer::SlaveMode::Mode::EncoderMode3);
+
+            InputA::SetCaptureMode(InputA::CaptureMode::Direct);
+            InputA::Enable();
+            InputA::template SelectPins<_PinA>();
+
+            InputB::SetCaptureMode(InputB::CaptureMode::Direct);
+            InputB::Enable();
+            InputB::template SelectPins<_PinB>();
+
+            if constexpr (HasIndex)
+            {
+                IndexInput::SetCaptureMode(IndexInput::CaptureMode::Direct);
+                IndexInput::SetCapturePolarity(IndexInput::CapturePolarity::RisingEdge);
+                IndexInput::Enable();
+                IndexInput::template SelectPins<_IndexPin>();
+                IndexInput::ClearInterruptFlag();
+                IndexInput::EnableInterrupt();
+            }
+
+            _lastCounter = _Timer::GetCounterValue();
+            _position = 0;
+            _Timer::Start();
+        }
+
+        /**
+         * @brief Start velocity sampling by timer
+         * 
+         * @details
+         * Call Sample method from sample timer IRQ handler.
+         * 
+         * @tparam _SampleTimer Sample timer
+         * 
+         * @param [in] rate Sample rate (Hz)
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        template<typename _SampleTimer>
+        static void EnableVelocity(uint32_t rate)
+        {
+            _sampleRate = rate;
+            _lastSample = Position();
+            _velocity = 0;
+
+            _SampleTimer::Enable();
+            _SampleTimer::SetUpdateRate(rate);
+            _SampleTimer::EnableInterrupt();
+            _SampleTimer::Start();
+        }
+
+        /**
+         * @brief Returns current position
+         * 
+         * @returns Position (counts, 4 counts per encoder period)
+         */
+        static int32_t Position()
+        {
+            uint32_t primask = __get_PRIMASK();
+            __disable_irq();
+            int32_t position = Update();
+            __set_PRIMASK(primask);
+            return position;
+        }
+
+        /**
+         * @brief Set current position
+         * 
+         * @param [in] position New position
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void SetPosition(int32_t position)
+        {
+            uint32_t primask = __get_PRIMASK();
+            __disable_irq();
+            _lastSample += position - Update();
+            _position = position;
+            __set_PRIMASK(primask);
+        }
+
+        /**
+         * @brief Returns velocity
+         * 
+         * @returns Velocity (counts per second) measured at last sample
+         */
+        static int32_t Velocity()
+        {
+            return _velocity;
+        }
+
+        /**
+         * @brief Check for index pulse and clear index flag
+         * 
+         * @retval true Index pulse was captured since last call
+         * @retval false No index pulse
+         */
+        static bool IndexCaptured()
+        {
+            bool captured = _indexCaptured;
+            _indexCaptured = false;
+            return captured;
+        }
+
+        /**
+         * @brief Returns position at last index pulse
+         * 
+         * @returns Position of index
+         */
+        static int32_t IndexPosition()
+        {
+            return _indexPosition;
+        }
+
+        /**
+         * @brief Sample position and update velocity (call from sample timer IRQ handler)
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Sample()
+        {
+            int32_t position = Position();
+            _velocity = (position - _lastSample) * static_cast<int32_t>(_sampleRate);
+            _lastSample = position;
+        }
+
+        /**
+         * @brief Encoder timer IRQ handler (index capture)
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void IrqHandler()
+        {
+            if constexpr (HasIndex)
+            {
+                if(IndexInput::IsInterrupt())
+                {
+                    // Reading capture register clears capture flag
+                    uint16_t capture = IndexInput::GetValue();
+                    uint32_t primask = __get_PRIMASK();
+                    __disable_irq();
+                    int32_t position = Update();
+                    _indexPosition = position - static_cast<int16_t>(_lastCounter - capture);
+                    __set_PRIMASK(primask);
+                    _indexCaptured = true;
+                }
+            }
+        }
+
+    private:
+        static int32_t Update()
+        {
+            uint16_t counter = _Timer::GetCounterValue();
+            _position += static_cast<int16_t>(counter - _lastCounter);
+            _lastCounter = counter;
+            return _position;
+        }
+
+        static volatile int32_t _position;
+        static volatile uint16_t _lastCounter;
+        static int32_t _lastSample;
+        static uint32_t _sampleRate;
+        static volatile int32_t _velocity;
+        static volatile int32_t _indexPosition;
+        static volatile bool _indexCaptured;
+    };
+
+    #define QUADRATURE_ENCODER_TEMPLATE_ARGS template<typename _Timer, typename _PinA, typename _PinB, typename _IndexPin>
+    #define QUADRATURE_ENCODER_TEMPLATE_QUALIFIER QuadratureEncoder<_Timer, _PinA, _PinB, _IndexPin>
+
+    QUADRATURE_ENCODER_TEMPLATE_ARGS
+    volatile int32_t QUADRATURE_ENCODER_TEMPLATE_QUALIFIER::_position = 0;
+
+    QUADRATURE_ENCODER_TEMPLATE_ARGS
+    volatile uint16_t QUADRATURE_ENCODER_TEMPLATE_QUALIFIER::_lastCounter = 0;
+
+    QUADRATURE_ENCODER_TEMPLATE_ARGS
+    int32_t QUADRATURE_ENCODER_TEMPLATE_QUALIFIER::_lastSample = 0;
+
+    QUADRATURE_ENCODER_TEMPLATE_ARGS
+    uint32_t QUADRATURE_ENCODER_TEMPLATE_QUALIFIER::_sampleRate = 0;
+
+    QUADRATURE_ENCODER_TEMPLATE_ARGS
+    volatile int32_t QUADRATURE_ENCODER_TEMPLATE_QUALIFIER::_velocity = 0;
+
+    QUADRATURE_ENCODER_TEMPLATE_ARGS
+    volatile int32_t QUADRATURE_ENCODER_TEMPLATE_QUALIFIER::_indexPosition = 0;
+
+    QUADRATURE_ENCODER_TEMPLATE_ARGS
+    volatile bool QUADRATURE_ENCODER_TEMPLATE_QUALIFIER::_indexCaptured = false;
 }
 #endif // !ZHELE_DRIVERS_ENCODER_H
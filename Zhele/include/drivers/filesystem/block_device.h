@@ -0,0 +1,86 @@
+/**
+ * @file
+ * Block device concept
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2023
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DRIVERS_FILESYSTEM_BLOCKDEVICE_H
+#define ZHELE_DRIVERS_FILESYSTEM_BLOCKDEVICE_H
+
+#include <common/template_utils/inplace_function.h>
+
+#include <concepts>
+#include <cstdint>
+#include <cstddef>
+
+namespace Zhele::Drivers::Filesystem
+{
+    /**
+     * @brief Block device async operation complete callback
+     *
+     * @details
+     * Callback argument is operation result (true - success).
+     */
+    using BlockDeviceCallback = TemplateUtils::InplaceFunction<void(bool)>;
+
+    /**
+     * @brief Block device concept
+     *
+     * @details
+     * Block device is a static class with the same interface as SdCard:
+     *  - bool CheckStatus();
+     *  - uint32_t BlocksCount();
+     *  - size_t BlockSize();
+     *  - bool ReadBlock(uint8_t* data, uint32_t block);
+     *  - bool ReadMultipleBlock(uint8_t* data, uint32_t block, uint32_t count);
+     *  - bool WriteBlock(const uint8_t* data, uint32_t block);
+     *  - bool WriteMultipleBlock(const uint8_t* data, uint32_t block, uint32_t count);
+     *  - bool Erase(uint32_t firstBlock, uint32_t lastBlock);
+     *  - bool Sync();
+     *
+     * Devices can also provide:
+     *  - void ReadAsync(uint8_t* data, uint32_t block, uint32_t count, BlockDeviceCallback callback);
+     *  - void WriteAsync(const uint8_t* data, uint32_t block, uint32_t count, BlockDeviceCallback callback);
+     *  - Data(uint32_t block) which returns pointer to memory mapped block,
+     *    so USB MSC can transfer data without intermediate buffer
+     *    (uint8_t* - for read and write, const uint8_t* - for read only).
+     *
+     * Any block device can be used with SdCardFatFsAdapter (FatFs) and BlockDeviceScsiLun (USB MSC).
+     */
+    template<typename _Device>
+    concept BlockDevice = requires(uint8_t* data, const uint8_t* constData, uint32_t block)
+    {
+        { _Device::CheckStatus() } -> std::same_as<bool>;
+        { _Device::BlocksCount() } -> std::convertible_to<uint32_t>;
+        { _Device::BlockSize() } -> std::convertible_to<size_t>;
+        { _Device::ReadBlock(data, block) } -> std::same_as<bool>;
+        { _Device::ReadMultipleBlock(data, block, block) } -> std::same_as<bool>;
+        { _Device::WriteBlock(constData, block) } -> std::same_as<bool>;
+        { _Device::WriteMultipleBlock(constData, block, block) } -> std::same_as<bool>;
+        { _Device::Erase(block, block) } -> std::same_as<bool>;
+        { _Device::Sync() } -> std::same_as<bool>;
+    };
+
+    /**
+     * @brief Block device with memory mapped blocks
+     */
+    template<typename _Device>
+    concept MemoryMappedBlockDevice = BlockDevice<_Device> && requires(uint32_t block)
+    {
+        { _Device::Data(block) } -> std::convertible_to<const uint8_t*>;
+    };
+
+    /**
+     * @brief Block device with memory mapped writable blocks
+     */
+    template<typename _Device>
+    concept WritableMemoryMappedBlockDevice = BlockDevice<_Device> && requires(uint32_t block)
+    {
+        { _Device::Data(block) } -> std::same_as<uint8_t*>;
+    };
+} // namespace Zhele::Drivers::Filesystem
+
+#endif //! ZHELE_DRIVERS_FILESYSTEM_BLOCKDEVICE_H
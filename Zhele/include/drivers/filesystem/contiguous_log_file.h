@@ -0,0 +1,194 @@
+/**
+ * @file
+ * Preallocated contiguous file with direct sector streaming (for high-rate logging)
+ *
+ * @author Alexey Zhelonkin
+ * @date 2023
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DRIVERS_FILESYSTEM_CONTIGUOUSLOGFILE_H
+#define ZHELE_DRIVERS_FILESYSTEM_CONTIGUOUSLOGFILE_H
+
+#include "fatfs/ff.h"
+
+#include <cstdint>
+#include <cstring>
+
+#if FF_FS_READONLY == 0 && FF_USE_EXPAND == 1
+
+namespace Zhele::Drivers::Filesystem
+{
+    /**
+     * @brief Log file with preallocated contiguous clusters
+     *
+     * @details
+     * Open allocates contiguous space by f_expand, so no cluster allocation is done
+     * while logging. Full sectors are written directly to device by multiple block write,
+     * FatFs window and file buffers are bypassed. Partial sector is kept in object buffer
+     * until it is filled (or until Close). File size is updated (and unused clusters are released)
+     * on Close. If power is lost before Close, file has preallocated size.
+     * Requires FF_FS_READONLY = 0 and FF_USE_EXPAND = 1.
+     *
+     * @tparam _Device Block device of FatFs volume (same class as in FatFs drive table,
+     * so sector cache remains coherent)
+     */
+    template<typename _Device>
+    class ContiguousLogFile
+    {
+        static_assert(FF_MAX_SS == FF_MIN_SS, "Variable sector size is not supported.");
+        static const unsigned SectorSize = FF_MAX_SS;
+    public:
+        /**
+         * @brief Create file (existing file is overwritten) and preallocate space
+         *
+         * @param [in] path File path
+         * @param [in] capacity Max file size (rounded up to cluster size)
+         *
+         * @retval FR_OK Success
+         * @retval FR_DENIED No contiguous space of requested size
+         * @retval Other FatFs error
+         */
+        FRESULT Open(const TCHAR* path, FSIZE_t capacity)
+        {
+            _size = 0;
+            _capacity = 0;
+            FRESULT result = f_open(&_file, path, FA_CREATE_ALWAYS | FA_WRITE);
+            if(result != FR_OK)
+                return result;
+
+            result = f_expand(&_file, capacity, 1);
+            // FAT chain and directory entry are written now, so file is valid after power loss
+            if(result == FR_OK)
+                result = f_sync(&_file);
+            if(result != FR_OK)
+            {
+                f_close(&_file);
+                return result;
+            }
+
+            FATFS* fs = _file.obj.fs;
+            _firstSector = fs->database + static_cast<LBA_t>(fs->csize) * (_file.obj.sclust - 2);
+            _capacity = capacity;
+            return FR_OK;
+        }
+
+        /**
+         * @brief Write data
+         *
+         * @details
+         * Data is buffered only up to sector boundary, the rest full sectors are
+         * written from data buffer directly (it should be suitable for device DMA).
+         *
+         * @param [in] data Data to write
+         * @param [in] size Data size
+         *
+         * @retval FR_OK Success
+         * @retval FR_DENIED File is full (nothing is written)
+         * @retval FR_DISK_ERR Device write error
+         */
+        FRESULT Write(const void* data, size_t size)
+        {
+            if(_size + size > _capacity)
+                return FR_DENIED;
+
+            const uint8_t* source = static_cast<const uint8_t*>(data);
+            unsigned offset = _size % SectorSize;
+            if(offset != 0)
+            {
+                size_t part = SectorSize - offset < size ? SectorSize - offset : size;
+                memcpy(&_buffer[offset], source, part);
+                source += part;
+                size -= part;
+                _size += part;
+                if(_size % SectorSize != 0)
+                    return FR_OK;
+                if(!_Device::WriteBlock(_buffer, CurrentSector() - 1))
+                    return FR_DISK_ERR;
+            }
+
+            uint32_t sectors = size / SectorSize;
+            if(sectors > 0)
+            {
+                if(!_Device::WriteMultipleBlock(source, CurrentSector(), sectors))
+                    return FR_DISK_ERR;
+                source += sectors * SectorSize;
+                size -= sectors * SectorSize;
+                _size += sectors * SectorSize;
+            }
+
+            memcpy(_buffer, source, size);
+            _size += size;
+            return FR_OK;
+        }
+
+        /**
+         * @brief Write buffered partial sector, set file size and close file
+         *
+         * @param [in] releaseUnused Release clusters after file end
+         *
+         * @retval FR_OK Success
+         * @retval Other FatFs error
+         */
+        FRESULT Close(bool releaseUnused = true)
+        {
+            unsigned tail = _size % SectorSize;
+            if(tail != 0)
+            {
+                memset(&_buffer[tail], 0, SectorSize - tail);
+                if(!_Device::WriteBlock(_buffer, CurrentSector()))
+                {
+                    f_close(&_file);
+                    return FR_DISK_ERR;
+                }
+            }
+
+            FRESULT result = FR_OK;
+            if(releaseUnused)
+            {
+                result = f_lseek(&_file, _size);
+                if(result == FR_OK)
+                    result = f_truncate(&_file);
+            }
+            FRESULT closeResult = f_close(&_file);
+            _capacity = 0;
+            return result != FR_OK ? result : closeResult;
+        }
+
+        /**
+         * @brief Returns written data size
+         *
+         * @returns Data size
+         */
+        FSIZE_t Size() const
+        {
+            return _size;
+        }
+
+        /**
+         * @brief Returns preallocated size
+         *
+         * @returns Capacity (0 if file is not opened)
+         */
+        FSIZE_t Capacity() const
+        {
+            return _capacity;
+        }
+
+    private:
+        LBA_t CurrentSector() const
+        {
+            return _firstSector + static_cast<LBA_t>(_size / SectorSize);
+        }
+
+        FIL _file;
+        LBA_t _firstSector = 0;
+        FSIZE_t _capacity = 0;
+        FSIZE_t _size = 0;
+        alignas(4) uint8_t _buffer[SectorSize];
+    };
+} // namespace Zhele::Drivers::Filesystem
+
+#endif
+
+#endif //! ZHELE_DRIVERS_FILESYSTEM_CONTIGUOUSLOGFILE_H
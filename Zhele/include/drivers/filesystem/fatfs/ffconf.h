@@ -4,11 +4,71 @@
 
 #define FFCONF_DEF	86631	/* Revision ID */
 
+/*---------------------------------------------------------------------------/
+/ Zhele Configuration Profiles
+/---------------------------------------------------------------------------*/
+/* Define one of profiles (compiler command line) to select throughput or
+/  footprint oriented options. Profile options can be also overridden
+/  one by one by definition before this file.
+/
+/  ZHELE_FATFS_PROFILE_FAST  - private sector buffer in each file (no window
+/                              buffer flushes on file data access), fast seek
+/                              (cluster link map), f_expand, exFAT for cards
+/                              above 32 GB (needs LFN, single code page table).
+/  ZHELE_FATFS_PROFILE_SMALL - tiny buffer configuration (FIL without sector
+/                              buffer), no LFN, single SBCS code page (437).
+/  No profile                - defaults below. */
+
+#if defined(ZHELE_FATFS_PROFILE_FAST) && defined(ZHELE_FATFS_PROFILE_SMALL)
+#error "Only one FatFs profile can be selected."
+#endif
+
+#if defined(ZHELE_FATFS_PROFILE_FAST)
+#ifndef FF_FS_TINY
+#define FF_FS_TINY		0
+#endif
+#ifndef FF_USE_FASTSEEK
+#define FF_USE_FASTSEEK	1
+#endif
+#ifndef FF_USE_EXPAND
+#define FF_USE_EXPAND	1
+#endif
+#ifndef FF_FS_EXFAT
+#define FF_FS_EXFAT		1
+#endif
+#ifndef FF_USE_LFN
+#define FF_USE_LFN		1
+#endif
+#ifndef FF_CODE_PAGE
+#define FF_CODE_PAGE	437
+#endif
+#endif
+
+#if defined(ZHELE_FATFS_PROFILE_SMALL)
+#ifndef FF_FS_TINY
+#define FF_FS_TINY		1
+#endif
+#ifndef FF_USE_FASTSEEK
+#define FF_USE_FASTSEEK	0
+#endif
+#ifndef FF_FS_EXFAT
+#define FF_FS_EXFAT		0
+#endif
+#ifndef FF_USE_LFN
+#define FF_USE_LFN		0
+#endif
+#ifndef FF_CODE_PAGE
+#define FF_CODE_PAGE	437
+#endif
+#endif
+
 /*---------------------------------------------------------------------------/
 / Function Configurations
 /---------------------------------------------------------------------------*/
 
+#ifndef FF_FS_READONLY
 #define FF_FS_READONLY	1
+#endif
 /* This option switches read-only configuration. (0:Read/Write or 1:Read-only)
 /  Read-only configuration removes writing API functions, f_write(), f_sync(),
 /  f_unlink(), f_mkdir(), f_chmod(), f_rename(), f_truncate(), f_getfree()
@@ -34,11 +94,15 @@
 /* This option switches f_mkfs() function. (0:Disable or 1:Enable) */
 
 
+#ifndef FF_USE_FASTSEEK
 #define FF_USE_FASTSEEK	0
+#endif
 /* This option switches fast seek function. (0:Disable or 1:Enable) */
 
 
+#ifndef FF_USE_EXPAND
 #define FF_USE_EXPAND	0
+#endif
 /* This option switches f_expand function. (0:Disable or 1:Enable) */
 
 
@@ -84,7 +148,9 @@
 / Locale and Namespace Configurations
 /---------------------------------------------------------------------------*/
 
+#ifndef FF_CODE_PAGE
 #define FF_CODE_PAGE	932
+#endif
 /* This option specifies the OEM code page to be used on the target system.
 /  Incorrect code page setting can cause a file open failure.
 /
@@ -113,7 +179,9 @@
 */
 
 
+#ifndef FF_USE_LFN
 #define FF_USE_LFN		0
+#endif
 #define FF_MAX_LFN		255
 /* The FF_USE_LFN switches the support for LFN (long file name).
 /
@@ -224,14 +292,18 @@
 / System Configurations
 /---------------------------------------------------------------------------*/
 
+#ifndef FF_FS_TINY
 #define FF_FS_TINY		0
+#endif
 /* This option switches tiny buffer configuration. (0:Normal or 1:Tiny)
 /  At the tiny configuration, size of file object (FIL) is shrinked FF_MAX_SS bytes.
 /  Instead of private sector buffer eliminated from the file object, common sector
 /  buffer in the filesystem object (FATFS) is used for the file data transfer. */
 
 
+#ifndef FF_FS_EXFAT
 #define FF_FS_EXFAT		0
+#endif
 /* This option switches support for exFAT filesystem. (0:Disable or 1:Enable)
 /  To enable exFAT, also LFN needs to be enabled. (FF_USE_LFN >= 1)
 /  Note that enabling exFAT discards ANSI C (C89) compatibility. */
@@ -276,9 +348,14 @@
 
 
 /* #include <somertos.h>	// O/S definitions */
+#ifndef FF_FS_REENTRANT
 #define FF_FS_REENTRANT	0
+#endif
 #define FF_FS_TIMEOUT	1000
-#define FF_SYNC_t		HANDLE
+#define FF_SYNC_t		BYTE
+/* Zhele: sync object is volume number of FatFsLock (fatfs_lock.h), lock is
+/  never waited (contended file function fails with FR_TIMEOUT), so
+/  FF_FS_TIMEOUT has no effect. */
 /* The option FF_FS_REENTRANT switches the re-entrancy (thread safe) of the FatFs
 /  module itself. Note that regardless of this option, file access to different
 /  volume is always re-entrant and volume control functions, f_mount(), f_mkfs()
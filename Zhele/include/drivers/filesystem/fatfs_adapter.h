@@ -13,13 +13,24 @@
 #include <spi.h>
 #include <drivers/sdcard.h>
 
+#include "fatfs/ff.h"
 #include "fatfs/diskio.h"
+#include "sector_cache.h"
+
+#include <utility>
+
+#if !defined(ZHELE_FATFS_SECTOR_CACHE_SIZE)
+    #define ZHELE_FATFS_SECTOR_CACHE_SIZE 0
+#endif
 
 namespace Zhele::Drivers::Filesystem
 {
     /**
      * @brief FatFs adapter class for sdcard
      * 
+     * @details
+     * Any block device (see block_device.h) can be used instead of SdCard.
+     * 
      * @tparam _SdCardInstance SdCard instance
      */
     template<typename _SdCardInstance>
@@ -53,11 +64,144 @@ namespace Zhele::Drivers::Filesystem
                     : DRESULT::RES_ERROR;
             }
         }
+
+        static DRESULT DiskWrite(const BYTE* buff, LBA_t sector, UINT count)
+        {
+            if(count == 1)
+            {
+                return _SdCardInstance::WriteBlock(buff, static_cast<uint32_t>(sector))
+                    ? DRESULT::RES_OK
+                    : DRESULT::RES_ERROR;
+            }
+            else
+            {
+                return _SdCardInstance::WriteMultipleBlock(buff, static_cast<uint32_t>(sector), count)
+                    ? DRESULT::RES_OK
+                    : DRESULT::RES_ERROR;
+            }
+        }
+
+        static DRESULT DiskIoctl(BYTE cmd, void* buff)
+        {
+            switch(cmd)
+            {
+            case CTRL_SYNC:
+                return _SdCardInstance::Sync()
+                    ? DRESULT::RES_OK
+                    : DRESULT::RES_ERROR;
+            case GET_SECTOR_COUNT:
+                {
+                    uint32_t blocksCount = _SdCardInstance::BlocksCount();
+                    *static_cast<LBA_t*>(buff) = blocksCount;
+                    return blocksCount != 0
+                        ? DRESULT::RES_OK
+                        : DRESULT::RES_ERROR;
+                }
+            case GET_SECTOR_SIZE:
+                *static_cast<WORD*>(buff) = _SdCardInstance::BlockSize();
+                return DRESULT::RES_OK;
+            case GET_BLOCK_SIZE:
+                // Erase block size is unknown
+                *static_cast<DWORD*>(buff) = 1;
+                return DRESULT::RES_OK;
+            case CTRL_TRIM:
+                {
+                    LBA_t* range = static_cast<LBA_t*>(buff);
+                    return _SdCardInstance::Erase(static_cast<uint32_t>(range[0]), static_cast<uint32_t>(range[1]))
+                        ? DRESULT::RES_OK
+                        : DRESULT::RES_ERROR;
+                }
+            default:
+                return DRESULT::RES_PARERR;
+            }
+        }
+    };
+
+    /// FatFs adapter for block device (RAM disk, internal flash)
+    template<typename _Device>
+    using BlockDeviceFatFsAdapter = SdCardFatFsAdapter<_Device>;
+
+    /**
+     * @brief FatFs drive table
+     * 
+     * @details
+     * Dispatches FatFs disk functions to adapter by physical drive number (pdrv).
+     * Drive number is index of adapter in template parameters list.
+     * 
+     * @tparam _Drives Drive adapters (SdCardFatFsAdapter or any class with the same interface)
+     */
+    template<typename... _Drives>
+    class FatFsDriveTable
+    {
+        template<typename _Drive>
+        struct DriveTag
+        {
+            using type = _Drive;
+        };
+
+        template<typename _Result, typename _Function, size_t... _Indexes>
+        static _Result Dispatch(BYTE pdrv, _Result fallback, _Function function, std::index_sequence<_Indexes...>)
+        {
+            _Result result = fallback;
+            static_cast<void>(((pdrv == _Indexes && (result = function(DriveTag<_Drives>{}), true)) || ...));
+            return result;
+        }
+
+        template<typename _Result, typename _Function>
+        static _Result Dispatch(BYTE pdrv, _Result fallback, _Function function)
+        {
+            return Dispatch(pdrv, fallback, function, std::index_sequence_for<_Drives...>{});
+        }
+    public:
+        /// Drives count
+        static const unsigned Count = sizeof...(_Drives);
+
+        static DSTATUS DiskInitialize(BYTE pdrv)
+        {
+            return Dispatch<DSTATUS>(pdrv, STA_NOINIT, [](auto drive) { return decltype(drive)::type::DiskInitialize(); });
+        }
+
+        static DSTATUS DiskStatus(BYTE pdrv)
+        {
+            return Dispatch<DSTATUS>(pdrv, STA_NOINIT, [](auto drive) { return decltype(drive)::type::DiskStatus(); });
+        }
+
+        static DRESULT DiskRead(BYTE pdrv, BYTE* buff, LBA_t sector, UINT count)
+        {
+            return Dispatch<DRESULT>(pdrv, DRESULT::RES_PARERR, [=](auto drive) { return decltype(drive)::type::DiskRead(buff, sector, count); });
+        }
+
+        static DRESULT DiskWrite(BYTE pdrv, const BYTE* buff, LBA_t sector, UINT count)
+        {
+            return Dispatch<DRESULT>(pdrv, DRESULT::RES_PARERR, [=](auto drive) { return decltype(drive)::type::DiskWrite(buff, sector, count); });
+        }
+
+        static DRESULT DiskIoctl(BYTE pdrv, BYTE cmd, void* buff)
+        {
+            return Dispatch<DRESULT>(pdrv, DRESULT::RES_PARERR, [=](auto drive) { return decltype(drive)::type::DiskIoctl(cmd, buff); });
+        }
     };
 
     using SdCardReader = Drivers::SdCard<Spi1, IO::Pa4>;
     
+#if ZHELE_FATFS_SECTOR_CACHE_SIZE > 0
+    using SdCardAdapter = SdCardFatFsAdapter<SectorCache<SdCardReader, ZHELE_FATFS_SECTOR_CACHE_SIZE>>;
+#else
     using SdCardAdapter = SdCardFatFsAdapter<SdCardReader>;
+#endif
 } // namespace Zhele::Drivers::Filesystem
 
+// Custom drive table can be declared in header ZHELE_FATFS_DRIVES_CONFIG, for example:
+// namespace Zhele::Drivers::Filesystem { using FatFsDrives = FatFsDriveTable<SdCardAdapter, BlockDeviceFatFsAdapter<RamBlockDevice<512, 64>>>; }
+#if defined(ZHELE_FATFS_DRIVES_CONFIG)
+    #include ZHELE_FATFS_DRIVES_CONFIG
+#else
+namespace Zhele::Drivers::Filesystem
+{
+    using FatFsDrives = FatFsDriveTable<SdCardAdapter>;
+} // namespace Zhele::Drivers::Filesystem
+#endif
+
+static_assert(Zhele::Drivers::Filesystem::FatFsDrives::Count <= FF_VOLUMES, "Increase FF_VOLUMES in ffconf.h");
+
 #endif //! ZHELE_DRIVERS_FILESYSTEM_FATFSADAPTER_H
\ No newline at end of file
@@ -0,0 +1,122 @@
+/**
+ * @file
+ * FatFs volume lock (FF_FS_REENTRANT synchronization object)
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DRIVERS_FILESYSTEM_FATFSLOCK_H
+#define ZHELE_DRIVERS_FILESYSTEM_FATFSLOCK_H
+
+#include <clock.h>
+#include "../../common/nvic.h"
+
+#include "fatfs/ff.h"
+
+#include <atomic>
+#include <stdint.h>
+
+namespace Zhele::Drivers::Filesystem
+{
+    /**
+     * @brief FatFs volume lock
+     *
+     * @details
+     * Build library with FF_FS_REENTRANT=1 to enable FatFs re-entrancy: every file function
+     * locks its volume for the call by ff_req_grant (ffsystem.cpp), so file functions of different
+     * contexts (event loop tasks and coroutines, interrupt handlers) never modify volume concurrently.
+     * Event loop tasks are not preempted, so busy volume means that file function is called from interrupt
+     * (or from event executed while other file function waits for disk) during other file function.
+     * Holder can't complete until caller returns, so lock is never waited: contended call fails with FR_TIMEOUT
+     * and should be retried later. Coroutine can wait for volume by yielding:
+     * @code
+     * while(FatFsLock::Locked(0))
+     *     co_await Yield<Loop>();
+     * @endcode
+     * Volume is locked only during single file function, so long transfers split into several
+     * f_read/f_write calls (with co_await between them) let other tasks access volume between chunks.
+     */
+    class FatFsLock
+    {
+    public:
+        /**
+         * @brief Try to lock volume
+         *
+         * @param [in] volume Logical drive number
+         *
+         * @retval true Volume is locked by caller
+         * @retval false Volume is busy (or invalid drive number)
+         */
+        static bool TryLock(uint8_t volume);
+
+        /**
+         * @brief Unlock volume
+         *
+         * @param [in] volume Logical drive number
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Unlock(uint8_t volume);
+
+        /**
+         * @brief Returns volume lock state
+         *
+         * @param [in] volume Logical drive number
+         *
+         * @retval true File function is in progress on volume
+         * @retval false Volume is free
+         */
+        static bool Locked(uint8_t volume);
+
+        /**
+         * @brief Returns failed lock attempts count
+         *
+         * @returns Contended file functions count (FR_TIMEOUT results)
+         */
+        static unsigned Contentions();
+
+    private:
+        static std::atomic<bool> _locked[FF_VOLUMES];
+        static std::atomic<unsigned> _contentions;
+    };
+
+    inline bool FatFsLock::TryLock(uint8_t volume)
+    {
+        if(volume >= FF_VOLUMES)
+            return false;
+
+#if (__CORTEX_M >= 3)
+        bool locked = !_locked[volume].exchange(true, std::memory_order_acquire);
+#else
+        uint32_t state = DriverCriticalSection::Enter();
+        bool locked = !_locked[volume].load(std::memory_order_relaxed);
+        if(locked)
+            _locked[volume].store(true, std::memory_order_relaxed);
+        DriverCriticalSection::Leave(state);
+#endif
+        if(!locked)
+            _contentions.fetch_add(1, std::memory_order_relaxed);
+        return locked;
+    }
+
+    inline void FatFsLock::Unlock(uint8_t volume)
+    {
+        if(volume < FF_VOLUMES)
+            _locked[volume].store(false, std::memory_order_release);
+    }
+
+    inline bool FatFsLock::Locked(uint8_t volume)
+    {
+        return volume < FF_VOLUMES && _locked[volume].load(std::memory_order_relaxed);
+    }
+
+    inline unsigned FatFsLock::Contentions()
+    {
+        return _contentions.load(std::memory_order_relaxed);
+    }
+} // namespace Zhele::Drivers::Filesystem
+
+#endif //! ZHELE_DRIVERS_FILESYSTEM_FATFSLOCK_H
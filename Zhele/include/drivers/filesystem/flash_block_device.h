@@ -0,0 +1,279 @@
+/**
+ * @file
+ * Internal flash block device
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2023
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DRIVERS_FILESYSTEM_FLASHBLOCKDEVICE_H
+#define ZHELE_DRIVERS_FILESYSTEM_FLASHBLOCKDEVICE_H
+
+#include <flash.h>
+
+#include "block_device.h"
+
+#include <cstring>
+
+namespace Zhele::Drivers::Filesystem
+{
+    /**
+     * @brief Block device in internal flash
+     *
+     * @details
+     * Flash can be erased by pages only, so written blocks are collected in RAM page buffer.
+     * Page is erased and programmed when block from another page is written and on Sync.
+     * Unchanged pages are not reprogrammed.
+     * Blocks are memory mapped (see Data method) for read, so USB MSC reads them without
+     * intermediate buffer.
+     *
+     * @note For stm32f4 page is flash sector, so region should be placed in sectors with equal size.
+     *
+     * @tparam _StartAddress Region start address (should be page-aligned)
+     * @tparam _BlocksCount Blocks count
+     * @tparam _BlockSize Block size
+     * @tparam _PageSize Flash page (erase unit) size
+     */
+    template<uint32_t _StartAddress, uint32_t _BlocksCount, uint32_t _BlockSize = 512, uint32_t _PageSize = 1024>
+    class FlashBlockDevice
+    {
+        static_assert(_PageSize % _BlockSize == 0, "Page size should be multiple of block size.");
+        static_assert(_StartAddress % _PageSize == 0, "Region should be page-aligned.");
+        static_assert((_BlocksCount * _BlockSize) % _PageSize == 0, "Region size should be multiple of page size.");
+
+        static const uint32_t NoPage = 0xffffffff;
+    public:
+        /**
+         * @brief Check device status
+         *
+         * @return true OK
+         * @return false Error
+         */
+        static bool CheckStatus()
+        {
+            return true;
+        }
+
+        /**
+         * @brief Returns blocks count
+         *
+         * @return uint32_t Blocks count
+         */
+        static constexpr uint32_t BlocksCount()
+        {
+            return _BlocksCount;
+        }
+
+        /**
+         * @brief Returns block size
+         *
+         * @return size_t Block size
+         */
+        static constexpr size_t BlockSize()
+        {
+            return _BlockSize;
+        }
+
+        /**
+         * @brief Returns pointer to block data (in flash)
+         *
+         * @details
+         * Page buffer is written to flash before, so data is always actual.
+         *
+         * @param [in] block Block number
+         *
+         * @returns Block data
+         */
+        static const uint8_t* Data(uint32_t block)
+        {
+            Flush();
+            return reinterpret_cast<const uint8_t*>(_StartAddress + block * _BlockSize);
+        }
+
+        /**
+         * @brief Read block
+         *
+         * @param [out] data Output buffer
+         * @param [in] block Block number
+         *
+         * @return true Success
+         * @return false Fail
+         */
+        static bool ReadBlock(uint8_t* data, uint32_t block)
+        {
+            return ReadMultipleBlock(data, block, 1);
+        }
+
+        /**
+         * @brief Read multiple blocks
+         *
+         * @param [out] data Output buffer
+         * @param [in] block First block number
+         * @param [in] count Blocks count
+         *
+         * @return true Success
+         * @return false Fail
+         */
+        static bool ReadMultipleBlock(uint8_t* data, uint32_t block, uint32_t count)
+        {
+            if(!InRange(block, count))
+                return false;
+
+            for(uint32_t i = 0; i < count; ++i, data += _BlockSize)
+            {
+                uint32_t address = _StartAddress + (block + i) * _BlockSize;
+                const uint8_t* source = PageAddress(address) == _page
+                    ? &_pageBuffer[address - _page]
+                    : reinterpret_cast<const uint8_t*>(address);
+                memcpy(data, source, _BlockSize);
+            }
+            return true;
+        }
+
+        /**
+         * @brief Write block
+         *
+         * @param [in] data Data to write
+         * @param [in] block Block number
+         *
+         * @return true Success
+         * @return false Fail
+         */
+        static bool WriteBlock(const uint8_t* data, uint32_t block)
+        {
+            return WriteMultipleBlock(data, block, 1);
+        }
+
+        /**
+         * @brief Write multiple blocks
+         *
+         * @param [in] data Data to write
+         * @param [in] block First block number
+         * @param [in] count Blocks count
+         *
+         * @return true Success
+         * @return false Fail
+         */
+        static bool WriteMultipleBlock(const uint8_t* data, uint32_t block, uint32_t count)
+        {
+            if(!InRange(block, count))
+                return false;
+
+            for(uint32_t i = 0; i < count; ++i, data += _BlockSize)
+            {
+                uint32_t address = _StartAddress + (block + i) * _BlockSize;
+                uint32_t page = PageAddress(address);
+                if(page != _page)
+                {
+                    if(!Flush())
+                        return false;
+                    memcpy(_pageBuffer, reinterpret_cast<const uint8_t*>(page), _PageSize);
+                    _page = page;
+                }
+                memcpy(&_pageBuffer[address - page], data, _BlockSize);
+            }
+            return true;
+        }
+
+        /**
+         * @brief Erase blocks (nothing to do, pages are erased on write)
+         *
+         * @param [in] firstBlock First block to erase
+         * @param [in] lastBlock Last block to erase (inclusive)
+         *
+         * @return true Success
+         * @return false Fail
+         */
+        static bool Erase(uint32_t firstBlock, uint32_t lastBlock)
+        {
+            return lastBlock >= firstBlock && InRange(firstBlock, lastBlock - firstBlock + 1);
+        }
+
+        /**
+         * @brief Write page buffer to flash
+         *
+         * @return true Success
+         * @return false Fail
+         */
+        static bool Sync()
+        {
+            return Flush();
+        }
+
+        /**
+         * @brief Read blocks (callback is called immediately)
+         *
+         * @param [out] data Output buffer
+         * @param [in] block First block number
+         * @param [in] count Blocks count
+         * @param [in] callback Complete callback
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void ReadAsync(uint8_t* data, uint32_t block, uint32_t count, BlockDeviceCallback callback)
+        {
+            bool result = ReadMultipleBlock(data, block, count);
+            if(callback)
+                callback(result);
+        }
+
+        /**
+         * @brief Write blocks (callback is called immediately)
+         *
+         * @param [in] data Data to write
+         * @param [in] block First block number
+         * @param [in] count Blocks count
+         * @param [in] callback Complete callback
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void WriteAsync(const uint8_t* data, uint32_t block, uint32_t count, BlockDeviceCallback callback)
+        {
+            bool result = WriteMultipleBlock(data, block, count);
+            if(callback)
+                callback(result);
+        }
+
+    private:
+        static bool InRange(uint32_t block, uint32_t count)
+        {
+            return block < _BlocksCount && count <= _BlocksCount - block;
+        }
+
+        static constexpr uint32_t PageAddress(uint32_t address)
+        {
+            return address & ~(_PageSize - 1);
+        }
+
+        static bool Flush()
+        {
+            if(_page == NoPage)
+                return true;
+
+            uint32_t page = _page;
+            _page = NoPage;
+            if(memcmp(_pageBuffer, reinterpret_cast<const uint8_t*>(page), _PageSize) == 0)
+                return true;
+
+            Flash::Unlock();
+            bool result = Flash::ErasePage(page) && Flash::Program(page, _pageBuffer, _PageSize);
+            Flash::Lock();
+
+            return result;
+        }
+
+        static uint8_t _pageBuffer[_PageSize] __attribute__((aligned(8)));
+        static uint32_t _page;
+    };
+
+    template<uint32_t _StartAddress, uint32_t _BlocksCount, uint32_t _BlockSize, uint32_t _PageSize>
+    uint8_t FlashBlockDevice<_StartAddress, _BlocksCount, _BlockSize, _PageSize>::_pageBuffer[_PageSize] __attribute__((aligned(8)));
+
+    template<uint32_t _StartAddress, uint32_t _BlocksCount, uint32_t _BlockSize, uint32_t _PageSize>
+    uint32_t FlashBlockDevice<_StartAddress, _BlocksCount, _BlockSize, _PageSize>::_page = FlashBlockDevice<_StartAddress, _BlocksCount, _BlockSize, _PageSize>::NoPage;
+} // namespace Zhele::Drivers::Filesystem
+
+#endif //! ZHELE_DRIVERS_FILESYSTEM_FLASHBLOCKDEVICE_H
@@ -0,0 +1,448 @@
+/**
+ * @file
+ * Log-structured key-value store in internal flash
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2023
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DRIVERS_FILESYSTEM_FLASHKVSTORE_H
+#define ZHELE_DRIVERS_FILESYSTEM_FLASHKVSTORE_H
+
+#include <flash.h>
+
+#include <common/crc.h>
+
+#include <cstring>
+#include <stddef.h>
+#include <stdint.h>
+#include <type_traits>
+
+namespace Zhele::Drivers::Filesystem
+{
+    /**
+     * @brief Wear-leveled key-value store in internal flash
+     *
+     * @details
+     * Values are never rewritten in place: every write appends record (4 bytes header and value,
+     * padded to double word) to the active page, so updating 4-byte counter costs one double word
+     * program instead of page erase. Record header contains key, value size and CRC8 of record,
+     * so record damaged by power loss is ignored on Init.
+     * When active page is full, the next page (round robin) is erased, latest records of all keys
+     * are copied to it and then page header with incremented sequence number is written.
+     * Page with the greatest sequence number is active, so previous page remains valid until
+     * the compaction is completed.
+     * RAM index holds address of the latest record for each key, so read is memory-mapped access.
+     *
+     * @note For stm32f4 page is flash sector, so region should be placed in sectors with equal size.
+     *
+     * @tparam _StartAddress Region start address (should be page-aligned)
+     * @tparam _PagesCount Pages count (at least 2)
+     * @tparam _MaxKeys Maximum keys count (RAM index size)
+     * @tparam _PageSize Flash page (erase unit) size
+     */
+    template<uint32_t _StartAddress, unsigned _PagesCount = 2, unsigned _MaxKeys = 32, uint32_t _PageSize = 1024>
+    class FlashKvStore
+    {
+        static_assert(_PagesCount >= 2, "At least two pages are required for rotation.");
+        static_assert(_StartAddress % _PageSize == 0, "Region should be page-aligned.");
+
+        static const uint32_t PageMagic = 0x53564b5a;
+        static const uint32_t Erased = 0xffffffff;
+        static const uint16_t NoKey = 0xffff;
+
+        // Program unit of all families divides double word
+        static const uint32_t Alignment = 8;
+
+        struct PageHeader
+        {
+            uint32_t Magic;
+            uint32_t Sequence;
+        };
+
+        struct RecordHeader
+        {
+            uint16_t Key;
+            uint8_t Size;
+            uint8_t Crc;
+        };
+    public:
+        /// Maximum value size
+        static const size_t MaxValueSize = 252;
+
+        /**
+         * @brief Mount store: find active page and build RAM index
+         *
+         * @details
+         * If there is no valid page, region is formatted.
+         *
+         * @return true Success
+         * @return false Fail
+         */
+        static bool Init()
+        {
+            _page = _PagesCount;
+            uint32_t sequence = 0;
+            for(unsigned i = 0; i < _PagesCount; ++i)
+            {
+                const PageHeader* header = reinterpret_cast<const PageHeader*>(PageAddress(i));
+                if(header->Magic == PageMagic && header->Sequence != Erased && (_page == _PagesCount || header->Sequence > sequence))
+                {
+                    _page = i;
+                    sequence = header->Sequence;
+                }
+            }
+            if(_page == _PagesCount)
+                return Format();
+
+            _sequence = sequence;
+            return Scan();
+        }
+
+        /**
+         * @brief Erase all values
+         *
+         * @return true Success
+         * @return false Fail
+         */
+        static bool Format()
+        {
+            _keysCount = 0;
+            _page = 0;
+            _sequence = 1;
+            _writeAddress = PageAddress(0) + sizeof(PageHeader);
+
+            Flash::Unlock();
+            bool result = Flash::ErasePage(PageAddress(0)) && WriteHeader(0, _sequence);
+            Flash::Lock();
+
+            return result;
+        }
+
+        /**
+         * @brief Check that key exists
+         *
+         * @param [in] key Key
+         *
+         * @return true Key exists
+         * @return false Key does not exist
+         */
+        static bool Contains(uint16_t key)
+        {
+            return Find(key) < _keysCount;
+        }
+
+        /**
+         * @brief Returns value size
+         *
+         * @param [in] key Key
+         *
+         * @returns Value size (0 if key does not exist)
+         */
+        static size_t Size(uint16_t key)
+        {
+            unsigned index = Find(key);
+            return index < _keysCount ? Record(index)->Size : 0;
+        }
+
+        /**
+         * @brief Returns pointer to value (in flash)
+         *
+         * @details
+         * Pointer is valid until next write or remove.
+         *
+         * @param [in] key Key
+         *
+         * @returns Value data (nullptr if key does not exist)
+         */
+        static const uint8_t* Data(uint16_t key)
+        {
+            unsigned index = Find(key);
+            return index < _keysCount ? reinterpret_cast<const uint8_t*>(Record(index) + 1) : nullptr;
+        }
+
+        /**
+         * @brief Read value
+         *
+         * @param [in] key Key
+         * @param [out] data Output buffer
+         * @param [in] size Buffer size
+         *
+         * @returns Read bytes count (0 if key does not exist)
+         */
+        static size_t Read(uint16_t key, void* data, size_t size)
+        {
+            unsigned index = Find(key);
+            if(index >= _keysCount)
+                return 0;
+
+            const RecordHeader* record = Record(index);
+            size_t count = record->Size < size ? record->Size : size;
+            memcpy(data, record + 1, count);
+            return count;
+        }
+
+        /**
+         * @brief Read value of trivially copyable type
+         *
+         * @param [in] key Key
+         * @param [out] value Value
+         *
+         * @return true Success
+         * @return false Key does not exist or has another size
+         */
+        template<typename T>
+        static bool Read(uint16_t key, T& value)
+        {
+            static_assert(std::is_trivially_copyable_v<T>, "Value type should be trivially copyable.");
+            return Size(key) == sizeof(T) && Read(key, &value, sizeof(T)) == sizeof(T);
+        }
+
+        /**
+         * @brief Write value
+         *
+         * @details
+         * Nothing is programmed if value is not changed.
+         *
+         * @param [in] key Key (0xffff is reserved)
+         * @param [in] data Value
+         * @param [in] size Value size (1...MaxValueSize)
+         *
+         * @return true Success
+         * @return false Fail (no space, index is full or flash error)
+         */
+        static bool Write(uint16_t key, const void* data, size_t size)
+        {
+            if(key == NoKey || size == 0 || size > MaxValueSize)
+                return false;
+
+            unsigned index = Find(key);
+            if(index < _keysCount)
+            {
+                const RecordHeader* record = Record(index);
+                if(record->Size == size && memcmp(record + 1, data, size) == 0)
+                    return true;
+            }
+            else if(_keysCount >= _MaxKeys)
+            {
+                return false;
+            }
+
+            return Append(key, data, size);
+        }
+
+        /**
+         * @brief Write value of trivially copyable type
+         *
+         * @param [in] key Key (0xffff is reserved)
+         * @param [in] value Value
+         *
+         * @return true Success
+         * @return false Fail
+         */
+        template<typename T>
+        static bool Write(uint16_t key, const T& value)
+        {
+            static_assert(std::is_trivially_copyable_v<T>, "Value type should be trivially copyable.");
+            static_assert(sizeof(T) > 0 && sizeof(T) <= MaxValueSize, "Value is too large.");
+            return Write(key, &value, sizeof(T));
+        }
+
+        /**
+         * @brief Remove key
+         *
+         * @details
+         * Empty record is appended, so key is not restored on Init.
+         *
+         * @param [in] key Key
+         *
+         * @return true Success (or key does not exist)
+         * @return false Fail
+         */
+        static bool Remove(uint16_t key)
+        {
+            if(!Contains(key))
+                return true;
+            return Append(key, nullptr, 0);
+        }
+
+        /**
+         * @brief Returns free space in active page
+         *
+         * @returns Free space (bytes)
+         */
+        static uint32_t FreeSpace()
+        {
+            return PageAddress(_page) + _PageSize - _writeAddress;
+        }
+
+    private:
+        static constexpr uint32_t PageAddress(unsigned page)
+        {
+            return _StartAddress + page * _PageSize;
+        }
+
+        static constexpr uint32_t RecordSize(size_t size)
+        {
+            return (sizeof(RecordHeader) + size + Alignment - 1) & ~(Alignment - 1);
+        }
+
+        static const RecordHeader* Record(unsigned index)
+        {
+            return reinterpret_cast<const RecordHeader*>(_records[index]);
+        }
+
+        static uint8_t RecordCrc(const RecordHeader& header, const void* data)
+        {
+            uint8_t crc = Crc8Dallas::Update(Crc8Dallas::Initial, &header, offsetof(RecordHeader, Crc));
+            return Crc8Dallas::Update(crc, data, header.Size);
+        }
+
+        static unsigned Find(uint16_t key)
+        {
+            for(unsigned i = 0; i < _keysCount; ++i)
+            {
+                if(_keys[i] == key)
+                    return i;
+            }
+            return _keysCount;
+        }
+
+        static void UpdateIndex(uint16_t key, uint32_t address, bool removed)
+        {
+            unsigned index = Find(key);
+            if(removed)
+            {
+                if(index < _keysCount)
+                {
+                    --_keysCount;
+                    _keys[index] = _keys[_keysCount];
+                    _records[index] = _records[_keysCount];
+                }
+                return;
+            }
+            if(index == _keysCount)
+            {
+                if(_keysCount >= _MaxKeys)
+                    return;
+                _keys[_keysCount++] = key;
+            }
+            _records[index] = address;
+        }
+
+        static bool Scan()
+        {
+            _keysCount = 0;
+            uint32_t end = PageAddress(_page) + _PageSize;
+            uint32_t address = PageAddress(_page) + sizeof(PageHeader);
+            while(address + sizeof(RecordHeader) <= end && *reinterpret_cast<const uint32_t*>(address) != Erased)
+            {
+                const RecordHeader* record = reinterpret_cast<const RecordHeader*>(address);
+                uint32_t size = RecordSize(record->Size);
+                if(record->Size > MaxValueSize || size > end - address || record->Crc != RecordCrc(*record, record + 1))
+                {
+                    // Record is damaged (write was interrupted): page cannot be appended, so the next write compacts it
+                    address = end;
+                    break;
+                }
+                UpdateIndex(record->Key, address, record->Size == 0);
+                address += size;
+            }
+            _writeAddress = address;
+            return true;
+        }
+
+        static bool WriteHeader(unsigned page, uint32_t sequence)
+        {
+            PageHeader header {PageMagic, sequence};
+            return Flash::Program(PageAddress(page), &header, sizeof(header));
+        }
+
+        static bool Append(uint16_t key, const void* data, size_t size)
+        {
+            uint32_t recordSize = RecordSize(size);
+            if(recordSize > FreeSpace() && (!Compact() || recordSize > FreeSpace()))
+                return false;
+
+            uint32_t buffer[RecordSize(MaxValueSize) / sizeof(uint32_t)];
+            memset(buffer, 0xff, recordSize);
+            RecordHeader header {key, static_cast<uint8_t>(size), 0};
+            header.Crc = RecordCrc(header, data);
+            memcpy(buffer, &header, sizeof(header));
+            if(size > 0)
+                memcpy(reinterpret_cast<uint8_t*>(buffer) + sizeof(header), data, size);
+
+            uint32_t address = _writeAddress;
+            // Space is reserved even if program fails: partially programmed record cannot be rewritten
+            _writeAddress += recordSize;
+
+            Flash::Unlock();
+            bool result = Flash::Program(address, buffer, recordSize);
+            Flash::Lock();
+
+            if(result)
+                UpdateIndex(key, address, size == 0);
+            return result;
+        }
+
+        static bool Compact()
+        {
+            unsigned page = (_page + 1) % _PagesCount;
+            uint32_t address = PageAddress(page) + sizeof(PageHeader);
+            uint32_t end = PageAddress(page) + _PageSize;
+
+            Flash::Unlock();
+            bool result = Flash::ErasePage(PageAddress(page));
+            for(unsigned i = 0; result && i < _keysCount; ++i)
+            {
+                uint32_t size = RecordSize(Record(i)->Size);
+                result = size <= end - address && Flash::Program(address, Record(i), size);
+                _records[i] = address;
+                address += size;
+            }
+            // Header is written last, so interrupted compaction leaves previous page active
+            result = result && WriteHeader(page, _sequence + 1);
+            Flash::Lock();
+
+            if(!result)
+            {
+                // Previous page is still valid
+                Scan();
+                return false;
+            }
+
+            _page = page;
+            ++_sequence;
+            _writeAddress = address;
+            return true;
+        }
+
+        static uint16_t _keys[_MaxKeys];
+        static uint32_t _records[_MaxKeys];
+        static unsigned _keysCount;
+        static unsigned _page;
+        static uint32_t _sequence;
+        static uint32_t _writeAddress;
+    };
+
+    template<uint32_t _StartAddress, unsigned _PagesCount, unsigned _MaxKeys, uint32_t _PageSize>
+    uint16_t FlashKvStore<_StartAddress, _PagesCount, _MaxKeys, _PageSize>::_keys[_MaxKeys];
+
+    template<uint32_t _StartAddress, unsigned _PagesCount, unsigned _MaxKeys, uint32_t _PageSize>
+    uint32_t FlashKvStore<_StartAddress, _PagesCount, _MaxKeys, _PageSize>::_records[_MaxKeys];
+
+    template<uint32_t _StartAddress, unsigned _PagesCount, unsigned _MaxKeys, uint32_t _PageSize>
+    unsigned FlashKvStore<_StartAddress, _PagesCount, _MaxKeys, _PageSize>::_keysCount = 0;
+
+    template<uint32_t _StartAddress, unsigned _PagesCount, unsigned _MaxKeys, uint32_t _PageSize>
+    unsigned FlashKvStore<_StartAddress, _PagesCount, _MaxKeys, _PageSize>::_page = 0;
+
+    template<uint32_t _StartAddress, unsigned _PagesCount, unsigned _MaxKeys, uint32_t _PageSize>
+    uint32_t FlashKvStore<_StartAddress, _PagesCount, _MaxKeys, _PageSize>::_sequence = 0;
+
+    template<uint32_t _StartAddress, unsigned _PagesCount, unsigned _MaxKeys, uint32_t _PageSize>
+    uint32_t FlashKvStore<_StartAddress, _PagesCount, _MaxKeys, _PageSize>::_writeAddress = 0;
+} // namespace Zhele::Drivers::Filesystem
+
+#endif //! ZHELE_DRIVERS_FILESYSTEM_FLASHKVSTORE_H
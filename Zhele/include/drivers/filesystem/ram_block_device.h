@@ -0,0 +1,244 @@
+/**
+ * @file
+ * RAM disk block device
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2023
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DRIVERS_FILESYSTEM_RAMBLOCKDEVICE_H
+#define ZHELE_DRIVERS_FILESYSTEM_RAMBLOCKDEVICE_H
+
+#include "block_device.h"
+
+#include <cstring>
+#include <type_traits>
+
+namespace Zhele::Drivers::Filesystem
+{
+    /**
+     * @brief RAM disk
+     *
+     * @details
+     * Blocks are memory mapped (see Data method), so USB MSC reads and writes
+     * them without intermediate buffers.
+     * If DmaMemory instance is given, async operations are performed by DMA,
+     * otherwise they are performed by memcpy and callback is called immediately.
+     *
+     * @tparam _BlockSize Block size
+     * @tparam _BlocksCount Blocks count
+     * @tparam _DmaMemory DmaMemory instance for async operations (or void)
+     */
+    template<uint32_t _BlockSize, uint32_t _BlocksCount, typename _DmaMemory = void>
+    class RamBlockDevice
+    {
+    public:
+        /**
+         * @brief Check device status
+         *
+         * @return true OK
+         * @return false Error
+         */
+        static bool CheckStatus()
+        {
+            return true;
+        }
+
+        /**
+         * @brief Returns blocks count
+         *
+         * @return uint32_t Blocks count
+         */
+        static constexpr uint32_t BlocksCount()
+        {
+            return _BlocksCount;
+        }
+
+        /**
+         * @brief Returns block size
+         *
+         * @return size_t Block size
+         */
+        static constexpr size_t BlockSize()
+        {
+            return _BlockSize;
+        }
+
+        /**
+         * @brief Returns pointer to block data
+         *
+         * @param [in] block Block number
+         *
+         * @returns Block data
+         */
+        static uint8_t* Data(uint32_t block)
+        {
+            return &_data[block * _BlockSize];
+        }
+
+        /**
+         * @brief Read block
+         *
+         * @param [out] data Output buffer
+         * @param [in] block Block number
+         *
+         * @return true Success
+         * @return false Fail
+         */
+        static bool ReadBlock(uint8_t* data, uint32_t block)
+        {
+            return ReadMultipleBlock(data, block, 1);
+        }
+
+        /**
+         * @brief Read multiple blocks
+         *
+         * @param [out] data Output buffer
+         * @param [in] block First block number
+         * @param [in] count Blocks count
+         *
+         * @return true Success
+         * @return false Fail
+         */
+        static bool ReadMultipleBlock(uint8_t* data, uint32_t block, uint32_t count)
+        {
+            if(!InRange(block, count))
+                return false;
+            memcpy(data, Data(block), count * _BlockSize);
+            return true;
+        }
+
+        /**
+         * @brief Write block
+         *
+         * @param [in] data Data to write
+         * @param [in] block Block number
+         *
+         * @return true Success
+         * @return false Fail
+         */
+        static bool WriteBlock(const uint8_t* data, uint32_t block)
+        {
+            return WriteMultipleBlock(data, block, 1);
+        }
+
+        /**
+         * @brief Write multiple blocks
+         *
+         * @param [in] data Data to write
+         * @param [in] block First block number
+         * @param [in] count Blocks count
+         *
+         * @return true Success
+         * @return false Fail
+         */
+        static bool WriteMultipleBlock(const uint8_t* data, uint32_t block, uint32_t count)
+        {
+            if(!InRange(block, count))
+                return false;
+            memcpy(Data(block), data, count * _BlockSize);
+            return true;
+        }
+
+        /**
+         * @brief Erase blocks (nothing to do for RAM)
+         *
+         * @param [in] firstBlock First block to erase
+         * @param [in] lastBlock Last block to erase (inclusive)
+         *
+         * @return true Success
+         * @return false Fail
+         */
+        static bool Erase(uint32_t firstBlock, uint32_t lastBlock)
+        {
+            return lastBlock >= firstBlock && InRange(firstBlock, lastBlock - firstBlock + 1);
+        }
+
+        /**
+         * @brief Wait for device (nothing to do for RAM)
+         *
+         * @return true Success
+         */
+        static bool Sync()
+        {
+            return true;
+        }
+
+        /**
+         * @brief Read blocks asynchronously
+         *
+         * @param [out] data Output buffer
+         * @param [in] block First block number
+         * @param [in] count Blocks count
+         * @param [in] callback Complete callback
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void ReadAsync(uint8_t* data, uint32_t block, uint32_t count, BlockDeviceCallback callback)
+        {
+            CopyAsync(data, InRange(block, count) ? Data(block) : nullptr, count * _BlockSize, callback);
+        }
+
+        /**
+         * @brief Write blocks asynchronously
+         *
+         * @param [in] data Data to write
+         * @param [in] block First block number
+         * @param [in] count Blocks count
+         * @param [in] callback Complete callback
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void WriteAsync(const uint8_t* data, uint32_t block, uint32_t count, BlockDeviceCallback callback)
+        {
+            CopyAsync(InRange(block, count) ? Data(block) : nullptr, data, count * _BlockSize, callback);
+        }
+
+    private:
+        static bool InRange(uint32_t block, uint32_t count)
+        {
+            return block < _BlocksCount && count <= _BlocksCount - block;
+        }
+
+        static void CopyAsync(void* destination, const void* source, uint32_t size, BlockDeviceCallback callback)
+        {
+            if(destination == nullptr || source == nullptr)
+            {
+                if(callback)
+                    callback(false);
+                return;
+            }
+
+            if constexpr (!std::is_void_v<_DmaMemory>)
+            {
+                _callback = callback;
+                if(_DmaMemory::CopyAsync(destination, source, size, [](void*, unsigned, bool success){
+                    if(_callback)
+                        _callback(success);
+                }))
+                {
+                    return;
+                }
+            }
+
+            // No DMA or all DMA channels are busy
+            memcpy(destination, source, size);
+            if(callback)
+                callback(true);
+        }
+
+        static uint8_t _data[_BlockSize * _BlocksCount];
+        static BlockDeviceCallback _callback;
+    };
+
+    template<uint32_t _BlockSize, uint32_t _BlocksCount, typename _DmaMemory>
+    uint8_t RamBlockDevice<_BlockSize, _BlocksCount, _DmaMemory>::_data[_BlockSize * _BlocksCount];
+
+    template<uint32_t _BlockSize, uint32_t _BlocksCount, typename _DmaMemory>
+    BlockDeviceCallback RamBlockDevice<_BlockSize, _BlocksCount, _DmaMemory>::_callback;
+} // namespace Zhele::Drivers::Filesystem
+
+#endif //! ZHELE_DRIVERS_FILESYSTEM_RAMBLOCKDEVICE_H
@@ -0,0 +1,280 @@
+/**
+ * @file
+ * Write-back sector cache for block devices
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2023
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DRIVERS_FILESYSTEM_SECTORCACHE_H
+#define ZHELE_DRIVERS_FILESYSTEM_SECTORCACHE_H
+
+#include <cstdint>
+#include <cstring>
+
+namespace Zhele::Drivers::Filesystem
+{
+    /**
+     * @brief Fully associative LRU sector cache with write-back
+     *
+     * @details
+     * Cache has the same interface as block device (SdCard), so it can be used
+     * instead of device in SdCardFatFsAdapter. Single sector reads and writes are cached
+     * (FAT table and directory sectors), multiple sector operations go directly to
+     * device (cached copies are kept coherent). Dirty sectors are written to device
+     * on eviction, on Sync (CTRL_SYNC) and on Flush.
+     *
+     * @tparam _Device Block device (SdCard instance)
+     * @tparam _Sectors Cached sectors count
+     * @tparam _SectorSize Sector size
+     */
+    template<typename _Device, unsigned _Sectors, unsigned _SectorSize = 512>
+    class SectorCache
+    {
+        static_assert(_Sectors > 0, "Sector cache should contain at least one sector.");
+
+        struct Line
+        {
+            uint32_t sector;
+            uint32_t lastUse;
+            bool valid;
+            bool dirty;
+            uint8_t data[_SectorSize];
+        };
+    public:
+        /**
+         * @brief Check device status
+         *
+         * @return true OK
+         * @return false Error
+         */
+        static bool CheckStatus()
+        {
+            return _Device::CheckStatus();
+        }
+
+        /**
+         * @brief Returns device blocks count
+         *
+         * @return uint32_t Blocks count
+         */
+        static uint32_t BlocksCount()
+        {
+            return _Device::BlocksCount();
+        }
+
+        /**
+         * @brief Returns block size
+         *
+         * @return size_t Block size
+         */
+        static size_t BlockSize()
+        {
+            return _SectorSize;
+        }
+
+        /**
+         * @brief Read sector (through cache)
+         *
+         * @param [out] data Output buffer
+         * @param [in] sector Sector number
+         *
+         * @return true Success
+         * @return false Fail
+         */
+        static bool ReadBlock(uint8_t* data, uint32_t sector)
+        {
+            Line* line = Find(sector);
+            if(line == nullptr)
+            {
+                line = Allocate();
+                if(line == nullptr || !_Device::ReadBlock(line->data, sector))
+                    return false;
+                line->sector = sector;
+                line->valid = true;
+                line->dirty = false;
+            }
+            Touch(line);
+            memcpy(data, line->data, _SectorSize);
+            return true;
+        }
+
+        /**
+         * @brief Read multiple sectors (directly from device)
+         *
+         * @param [out] data Output buffer
+         * @param [in] sector First sector number
+         * @param [in] count Sectors count
+         *
+         * @return true Success
+         * @return false Fail
+         */
+        static bool ReadMultipleBlock(uint8_t* data, uint32_t sector, uint32_t count)
+        {
+            if(!_Device::ReadMultipleBlock(data, sector, count))
+                return false;
+
+            // Device contains stale data for dirty sectors, so take them from cache
+            for(Line& line : _lines)
+            {
+                if(line.valid && line.dirty && line.sector - sector < count)
+                    memcpy(data + (line.sector - sector) * _SectorSize, line.data, _SectorSize);
+            }
+            return true;
+        }
+
+        /**
+         * @brief Write sector (to cache, write-back)
+         *
+         * @param [in] data Data to write
+         * @param [in] sector Sector number
+         *
+         * @return true Success
+         * @return false Fail
+         */
+        static bool WriteBlock(const uint8_t* data, uint32_t sector)
+        {
+            Line* line = Find(sector);
+            if(line == nullptr)
+            {
+                line = Allocate();
+                if(line == nullptr)
+                    return false;
+                line->sector = sector;
+                line->valid = true;
+            }
+            memcpy(line->data, data, _SectorSize);
+            line->dirty = true;
+            Touch(line);
+            return true;
+        }
+
+        /**
+         * @brief Write multiple sectors (directly to device)
+         *
+         * @param [in] data Data to write
+         * @param [in] sector First sector number
+         * @param [in] count Sectors count
+         *
+         * @return true Success
+         * @return false Fail
+         */
+        static bool WriteMultipleBlock(const uint8_t* data, uint32_t sector, uint32_t count)
+        {
+            Invalidate(sector, count);
+            return _Device::WriteMultipleBlock(data, sector, count);
+        }
+
+        /**
+         * @brief Erase sectors
+         *
+         * @param [in] firstSector First sector to erase
+         * @param [in] lastSector Last sector to erase (inclusive)
+         *
+         * @return true Success
+         * @return false Fail
+         */
+        static bool Erase(uint32_t firstSector, uint32_t lastSector)
+        {
+            Invalidate(firstSector, lastSector - firstSector + 1);
+            return _Device::Erase(firstSector, lastSector);
+        }
+
+        /**
+         * @brief Write all dirty sectors to device
+         *
+         * @return true Success
+         * @return false Fail
+         */
+        static bool Flush()
+        {
+            bool result = true;
+            for(Line& line : _lines)
+            {
+                result = WriteBack(&line) && result;
+            }
+            return result;
+        }
+
+        /**
+         * @brief Flush cache and wait for device
+         *
+         * @return true Success
+         * @return false Fail
+         */
+        static bool Sync()
+        {
+            bool result = Flush();
+            return _Device::Sync() && result;
+        }
+
+    private:
+        static Line* Find(uint32_t sector)
+        {
+            for(Line& line : _lines)
+            {
+                if(line.valid && line.sector == sector)
+                    return &line;
+            }
+            return nullptr;
+        }
+
+        static Line* Allocate()
+        {
+            Line* victim = &_lines[0];
+            for(Line& line : _lines)
+            {
+                if(!line.valid)
+                {
+                    victim = &line;
+                    break;
+                }
+                if(_useCounter - line.lastUse > _useCounter - victim->lastUse)
+                    victim = &line;
+            }
+            if(!WriteBack(victim))
+                return nullptr;
+            victim->valid = false;
+            return victim;
+        }
+
+        static bool WriteBack(Line* line)
+        {
+            if(!line->valid || !line->dirty)
+                return true;
+            if(!_Device::WriteBlock(line->data, line->sector))
+                return false;
+            line->dirty = false;
+            return true;
+        }
+
+        static void Invalidate(uint32_t sector, uint32_t count)
+        {
+            for(Line& line : _lines)
+            {
+                if(line.valid && line.sector - sector < count)
+                {
+                    line.valid = false;
+                    line.dirty = false;
+                }
+            }
+        }
+
+        static void Touch(Line* line)
+        {
+            line->lastUse = ++_useCounter;
+        }
+
+        static Line _lines[_Sectors];
+        static uint32_t _useCounter;
+    };
+
+    template<typename _Device, unsigned _Sectors, unsigned _SectorSize>
+    typename SectorCache<_Device, _Sectors, _SectorSize>::Line SectorCache<_Device, _Sectors, _SectorSize>::_lines[_Sectors];
+
+    template<typename _Device, unsigned _Sectors, unsigned _SectorSize>
+    uint32_t SectorCache<_Device, _Sectors, _SectorSize>::_useCounter = 0;
+} // namespace Zhele::Drivers::Filesystem
+
+#endif //! ZHELE_DRIVERS_FILESYSTEM_SECTORCACHE_H
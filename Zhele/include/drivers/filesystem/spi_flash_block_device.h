@@ -0,0 +1,351 @@
+/**
+ * @file
+ * External SPI NOR flash block device
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DRIVERS_FILESYSTEM_SPIFLASHBLOCKDEVICE_H
+#define ZHELE_DRIVERS_FILESYSTEM_SPIFLASHBLOCKDEVICE_H
+
+#include "block_device.h"
+
+#include <cstring>
+
+namespace Zhele::Drivers::Filesystem
+{
+    /**
+     * @brief Block device in external SPI NOR flash (W25q)
+     *
+     * @details
+     * Written blocks are collected in RAM sector buffer. Sector is written to flash when block
+     * from another sector is written and on Sync. Sector is erased only if new data sets some bits
+     * (programming can only clear bits), otherwise only changed pages are programmed. After erase only
+     * pages with data are programmed. Erase method erases whole sectors of range (trim), so following
+     * writes to them do not need erase. Reads of blocks out of buffered sector go directly to flash
+     * (one fast read for contiguous blocks).
+     *
+     * @tparam _Flash Flash driver (W25q instance)
+     * @tparam _SectorsCount Region size (in flash sectors)
+     * @tparam _FirstSector Region first sector
+     * @tparam _BlockSize Block size
+     */
+    template<typename _Flash, uint32_t _SectorsCount, uint32_t _FirstSector = 0, uint32_t _BlockSize = 512>
+    class SpiFlashBlockDevice
+    {
+        static const uint32_t SectorSize = _Flash::SectorSize;
+        static const uint32_t PageSize = _Flash::PageSize;
+        static const uint32_t PagesPerSector = SectorSize / PageSize;
+        static const uint32_t BlocksPerSector = SectorSize / _BlockSize;
+        static const uint32_t NoSector = 0xffffffff;
+
+        static_assert(SectorSize % _BlockSize == 0, "Sector size should be multiple of block size.");
+        static_assert(_BlockSize % PageSize == 0, "Block size should be multiple of page size.");
+        static_assert(PagesPerSector <= 32, "Dirty pages mask is 32-bit.");
+    public:
+        /**
+         * @brief Check device status
+         *
+         * @return true OK
+         * @return false Error (flash is not detected or smaller than region)
+         */
+        static bool CheckStatus()
+        {
+            return _Flash::Capacity() >= (_FirstSector + _SectorsCount) * SectorSize;
+        }
+
+        /**
+         * @brief Returns blocks count
+         *
+         * @return uint32_t Blocks count
+         */
+        static constexpr uint32_t BlocksCount()
+        {
+            return _SectorsCount * BlocksPerSector;
+        }
+
+        /**
+         * @brief Returns block size
+         *
+         * @return size_t Block size
+         */
+        static constexpr size_t BlockSize()
+        {
+            return _BlockSize;
+        }
+
+        /**
+         * @brief Read block
+         *
+         * @param [out] data Output buffer
+         * @param [in] block Block number
+         *
+         * @return true Success
+         * @return false Fail
+         */
+        static bool ReadBlock(uint8_t* data, uint32_t block)
+        {
+            return ReadMultipleBlock(data, block, 1);
+        }
+
+        /**
+         * @brief Read multiple blocks
+         *
+         * @param [out] data Output buffer
+         * @param [in] block First block number
+         * @param [in] count Blocks count
+         *
+         * @return true Success
+         * @return false Fail
+         */
+        static bool ReadMultipleBlock(uint8_t* data, uint32_t block, uint32_t count)
+        {
+            if(!InRange(block, count))
+                return false;
+
+            while(count > 0)
+            {
+                if(SectorOf(block) == _sector)
+                {
+                    memcpy(data, &_buffer[Offset(block)], _BlockSize);
+                    ++block;
+                    --count;
+                    data += _BlockSize;
+                    continue;
+                }
+
+                uint32_t run = 1;
+                while(run < count && SectorOf(block + run) != _sector)
+                    ++run;
+                if(!_Flash::Read(Address(block), data, run * _BlockSize))
+                    return false;
+                block += run;
+                count -= run;
+                data += run * _BlockSize;
+            }
+            return true;
+        }
+
+        /**
+         * @brief Write block
+         *
+         * @param [in] data Data to write
+         * @param [in] block Block number
+         *
+         * @return true Success
+         * @return false Fail
+         */
+        static bool WriteBlock(const uint8_t* data, uint32_t block)
+        {
+            return WriteMultipleBlock(data, block, 1);
+        }
+
+        /**
+         * @brief Write multiple blocks
+         *
+         * @param [in] data Data to write
+         * @param [in] block First block number
+         * @param [in] count Blocks count
+         *
+         * @return true Success
+         * @return false Fail
+         */
+        static bool WriteMultipleBlock(const uint8_t* data, uint32_t block, uint32_t count)
+        {
+            if(!InRange(block, count))
+                return false;
+
+            for(uint32_t i = 0; i < count; ++i, ++block, data += _BlockSize)
+            {
+                uint32_t sector = SectorOf(block);
+                if(sector != _sector)
+                {
+                    if(!Flush())
+                        return false;
+                    _sector = NoSector;
+                    if(!_Flash::Read((_FirstSector + sector) * SectorSize, _buffer, SectorSize))
+                        return false;
+                    _sector = sector;
+                }
+
+                uint8_t* cached = &_buffer[Offset(block)];
+                if(memcmp(cached, data, _BlockSize) == 0)
+                    continue;
+
+                for(uint32_t byte = 0; byte < _BlockSize && !_eraseRequired; ++byte)
+                {
+                    if((cached[byte] & data[byte]) != data[byte])
+                        _eraseRequired = true;
+                }
+                memcpy(cached, data, _BlockSize);
+                _dirtyPages |= ((1ul << (_BlockSize / PageSize)) - 1) << (Offset(block) / PageSize);
+            }
+            return true;
+        }
+
+        /**
+         * @brief Erase blocks
+         *
+         * @details
+         * Sectors which are entirely in range are erased, partially covered sectors are not changed.
+         *
+         * @param [in] firstBlock First block to erase
+         * @param [in] lastBlock Last block to erase (inclusive)
+         *
+         * @return true Success
+         * @return false Fail
+         */
+        static bool Erase(uint32_t firstBlock, uint32_t lastBlock)
+        {
+            if(lastBlock < firstBlock || !InRange(firstBlock, lastBlock - firstBlock + 1))
+                return false;
+
+            uint32_t first = (firstBlock + BlocksPerSector - 1) / BlocksPerSector;
+            uint32_t end = (lastBlock + 1) / BlocksPerSector;
+            for(uint32_t sector = first; sector < end; ++sector)
+            {
+                if(sector == _sector)
+                {
+                    _sector = NoSector;
+                    _dirtyPages = 0;
+                    _eraseRequired = false;
+                }
+                if(!_Flash::EraseSector((_FirstSector + sector) * SectorSize))
+                    return false;
+            }
+            return true;
+        }
+
+        /**
+         * @brief Write sector buffer to flash
+         *
+         * @return true Success
+         * @return false Fail
+         */
+        static bool Sync()
+        {
+            return Flush();
+        }
+
+        /**
+         * @brief Read blocks (fast read, DMA)
+         *
+         * @details
+         * Buffered sector is written to flash before (if it is in range), then data is streamed
+         * directly into output buffer. Callback is called from SPI DMA interrupt.
+         *
+         * @param [out] data Output buffer
+         * @param [in] block First block number
+         * @param [in] count Blocks count
+         * @param [in] callback Complete callback
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void ReadAsync(uint8_t* data, uint32_t block, uint32_t count, BlockDeviceCallback callback)
+        {
+            if(!InRange(block, count) || (_sector != NoSector && SectorOf(block) <= _sector && SectorOf(block + count - 1) >= _sector && !Flush()))
+            {
+                if(callback)
+                    callback(false);
+                return;
+            }
+
+            while(!_Flash::ReadAsync(Address(block), data, count * _BlockSize, callback))
+                continue;
+        }
+
+    private:
+        static bool InRange(uint32_t block, uint32_t count)
+        {
+            return block < BlocksCount() && count <= BlocksCount() - block;
+        }
+
+        static constexpr uint32_t SectorOf(uint32_t block)
+        {
+            return block / BlocksPerSector;
+        }
+
+        static constexpr uint32_t Offset(uint32_t block)
+        {
+            return (block % BlocksPerSector) * _BlockSize;
+        }
+
+        static constexpr uint32_t Address(uint32_t block)
+        {
+            return _FirstSector * SectorSize + block * _BlockSize;
+        }
+
+        static bool Erased(const uint8_t* data, uint32_t size)
+        {
+            for(uint32_t i = 0; i < size; ++i)
+            {
+                if(data[i] != 0xff)
+                    return false;
+            }
+            return true;
+        }
+
+        static bool Flush()
+        {
+            if(_sector == NoSector || _dirtyPages == 0)
+                return true;
+
+            uint32_t address = (_FirstSector + _sector) * SectorSize;
+            uint32_t pages = _dirtyPages;
+            if(_eraseRequired)
+            {
+                pages = 0;
+                for(uint32_t page = 0; page < PagesPerSector; ++page)
+                {
+                    if(!Erased(&_buffer[page * PageSize], PageSize))
+                        pages |= 1ul << page;
+                }
+                if(!_Flash::EraseSector(address))
+                    return false;
+            }
+
+            // Flash content is unknown until all pages are programmed
+            _eraseRequired = true;
+            for(uint32_t first = 0; first < PagesPerSector;)
+            {
+                if((pages & (1ul << first)) == 0)
+                {
+                    ++first;
+                    continue;
+                }
+                uint32_t last = first;
+                while(last < PagesPerSector && (pages & (1ul << last)) != 0)
+                    ++last;
+                if(!_Flash::Program(address + first * PageSize, &_buffer[first * PageSize], (last - first) * PageSize))
+                    return false;
+                first = last;
+            }
+
+            _dirtyPages = 0;
+            _eraseRequired = false;
+            return true;
+        }
+
+        static uint8_t _buffer[SectorSize];
+        static uint32_t _sector;
+        static uint32_t _dirtyPages;
+        static bool _eraseRequired;
+    };
+
+    template<typename _Flash, uint32_t _SectorsCount, uint32_t _FirstSector, uint32_t _BlockSize>
+    uint8_t SpiFlashBlockDevice<_Flash, _SectorsCount, _FirstSector, _BlockSize>::_buffer[SectorSize];
+
+    template<typename _Flash, uint32_t _SectorsCount, uint32_t _FirstSector, uint32_t _BlockSize>
+    uint32_t SpiFlashBlockDevice<_Flash, _SectorsCount, _FirstSector, _BlockSize>::_sector = SpiFlashBlockDevice<_Flash, _SectorsCount, _FirstSector, _BlockSize>::NoSector;
+
+    template<typename _Flash, uint32_t _SectorsCount, uint32_t _FirstSector, uint32_t _BlockSize>
+    uint32_t SpiFlashBlockDevice<_Flash, _SectorsCount, _FirstSector, _BlockSize>::_dirtyPages = 0;
+
+    template<typename _Flash, uint32_t _SectorsCount, uint32_t _FirstSector, uint32_t _BlockSize>
+    bool SpiFlashBlockDevice<_Flash, _SectorsCount, _FirstSector, _BlockSize>::_eraseRequired = false;
+} // namespace Zhele::Drivers::Filesystem
+
+#endif //! ZHELE_DRIVERS_FILESYSTEM_SPIFLASHBLOCKDEVICE_H
@@ -1,6 +1,6 @@
 /**
  * @file
- * Implements class for Ssd1306 OLED display
+ * Implements fonts for displays
  * 
  * @author Alexey Zhelonkin (Fonts author taked from "SSD1306Ascii" library : https://github.com/greiman/SSD1306Ascii/blob/master/src/fonts/)
  * Thank @greiman so much
@@ -14,8 +14,20 @@
 
 #include "../common/template_utils/data_type_selector.h"
 
+#include <stdint.h>
+
+#if !defined (ZHELE_GLYPH_CACHE_SIZE)
+    #define ZHELE_GLYPH_CACHE_SIZE 4
+#endif
+
 namespace Zhele::Drivers
 {
+    namespace Private
+    {
+        template<typename _Font>
+        class FontRleEncoder;
+    }
+
     /**
      * @brief Base class for fonts
      * 
@@ -56,22 +68,88 @@ namespace Zhele::Drivers
     template <uint8_t _Width, uint8_t _Height, uint8_t _AsciiOffset = 0, typename Tag = void>
     class MonoSpaceFont : public FontBase<>
     {
+        template<typename> friend class Private::FontRleEncoder;
     public:
         static const uint8_t Width = _Width;
         static const uint8_t Height = _Height;
+        static const uint8_t AsciiOffset = _AsciiOffset;
+
+        /**
+         * @brief Returns max symbol width
+         * 
+         * @returns Max width
+         */
+        static constexpr uint8_t MaxWidth()
+        {
+            return Width;
+        }
+
         static const uint8_t* Get(char symbol)
         {
             return &_data[(symbol - _AsciiOffset) * Width * ((Height + 7) / 8)];
         }
     private:
+        static constexpr unsigned SymbolsCount()
+        {
+            return sizeof(_data) / (Width * ((Height + 7) / 8));
+        }
+
+        static constexpr uint8_t WidthByIndex(unsigned)
+        {
+            return Width;
+        }
+
+        static constexpr const uint8_t* GetByIndex(unsigned index)
+        {
+            return &_data[index * Width * ((Height + 7) / 8)];
+        }
+
         static const uint8_t _data[];
     };
 
+    namespace Private
+    {
+        /**
+         * @brief Compile-time glyph offsets table for non-monospace font
+         * 
+         * @tparam _Font Font
+         */
+        template<typename _Font>
+        class FontAtlas
+        {
+            struct Table
+            {
+                uint16_t Offsets[_Font::SymbolsCount()];
+                uint8_t MaxWidth;
+            };
+
+            static constexpr Table Build()
+            {
+                Table table {};
+                uint16_t offset = 0;
+                for(unsigned i = 0; i < _Font::SymbolsCount(); ++i)
+                {
+                    table.Offsets[i] = offset;
+                    offset += _Font::WidthByIndex(i);
+                    if(_Font::WidthByIndex(i) > table.MaxWidth)
+                        table.MaxWidth = _Font::WidthByIndex(i);
+                }
+                return table;
+            }
+
+        public:
+            static constexpr Table Value = Build();
+        };
+    }
+
     template<uint8_t _Height, uint8_t _AsciiOffset = 0, typename Tag = void>
     class Font : public FontBase<false>
     {
+        template<typename> friend class Private::FontAtlas;
+        template<typename> friend class Private::FontRleEncoder;
     public:
         static const uint8_t Height = _Height;
+        static const uint8_t AsciiOffset = _AsciiOffset;
 
         /**
          * @brief Returns width for given symbol
@@ -80,23 +158,158 @@ namespace Zhele::Drivers
          * 
          * @returns Symbols`s width.
          */
-        static const uint8_t GetWidth(char symbol)
+        static constexpr uint8_t GetWidth(char symbol)
         {
             return _widths[symbol - _AsciiOffset];
         }
-        static const uint8_t* Get(char symbol)
+
+        /**
+         * @brief Returns max symbol width
+         * 
+         * @returns Max width
+         */
+        static constexpr uint8_t MaxWidth()
         {
-            volatile uint16_t offset = 0;
-            for(uint16_t i = 0; i < symbol - _AsciiOffset; ++i)
-                offset += _widths[i];
+            return Private::FontAtlas<Font>::Value.MaxWidth;
+        }
 
-            return &_data[offset * ((Height + 7) / 8)];
+        /**
+         * @brief Returns bytes for given symbol
+         * 
+         * @details
+         * Symbol offset is taken from compile-time offsets table (no runtime widths summation).
+         * 
+         * @param [in] symbol Symbol
+         * 
+         * @returns Array with bytes for given symbol.
+         */
+        static const uint8_t* Get(char symbol)
+        {
+            return &_data[Private::FontAtlas<Font>::Value.Offsets[symbol - _AsciiOffset] * ((Height + 7) / 8)];
         }
     private:
+        static constexpr unsigned SymbolsCount()
+        {
+            return sizeof(_widths);
+        }
+
+        static constexpr uint8_t WidthByIndex(unsigned index)
+        {
+            return _widths[index];
+        }
+
+        static constexpr const uint8_t* GetByIndex(unsigned index)
+        {
+            return &_data[Private::FontAtlas<Font>::Value.Offsets[index] * ((Height + 7) / 8)];
+        }
+
         static const uint8_t _widths[];
         static const uint8_t _data[];
     };
 
+    /**
+     * @brief Cache of recently drawn glyphs expanded to RGB565
+     * 
+     * @details
+     * Glyph pixels are stored column by column (top to bottom in each column).
+     * Cache key is symbol with colors, the oldest entry is replaced on miss.
+     * 
+     * @tparam _Font Font
+     * @tparam _Entries Cache entries count
+     */
+    template<typename _Font, unsigned _Entries = ZHELE_GLYPH_CACHE_SIZE>
+    class GlyphCache
+    {
+        struct Entry
+        {
+            char Symbol;
+            uint8_t Width;
+            uint16_t Color;
+            uint16_t Background;
+            uint16_t Pixels[_Font::MaxWidth() * _Font::Height];
+        };
+
+    public:
+        /**
+         * @brief Returns expanded glyph
+         * 
+         * @param [in] symbol Symbol
+         * @param [in] color Symbol color
+         * @param [in] background Background color
+         * @param [out] width Symbol width
+         * 
+         * @returns Glyph pixels (width * font height)
+         */
+        static const uint16_t* Get(char symbol, uint16_t color, uint16_t background, uint8_t& width)
+        {
+            for(Entry& entry : _entries)
+            {
+                if(entry.Width != 0 && entry.Symbol == symbol && entry.Color == color && entry.Background == background)
+                {
+                    width = entry.Width;
+                    return entry.Pixels;
+                }
+            }
+
+            Entry& entry = _entries[_next];
+            _next = (_next + 1) % _Entries;
+
+            if constexpr (_Font::MonoSpace)
+                entry.Width = _Font::Width;
+            else
+                entry.Width = _Font::GetWidth(symbol);
+            entry.Symbol = symbol;
+            entry.Color = color;
+            entry.Background = background;
+
+            if constexpr (requires { _Font::Compressed; })
+            {
+                // Compressed font: fill by runs
+                uint16_t* pixels = entry.Pixels;
+                _Font::ForEachRun(symbol, [pixels, color, background](uint8_t column, uint8_t row, uint8_t length, bool foreground) {
+                    for(uint8_t i = 0; i < length; ++i)
+                        pixels[(column + i) * _Font::Height + row] = foreground ? color : background;
+                }, true);
+            }
+            else
+            {
+                const uint8_t* glyph = _Font::Get(symbol);
+                const uint8_t extraBits = _Font::Height % 8;
+                uint16_t* pixel = entry.Pixels;
+                for(uint8_t column = 0; column < entry.Width; ++column)
+                {
+                    uint8_t page = 0;
+                    for(; page < _Font::Height / 8; ++page)
+                    {
+                        uint8_t temp = glyph[page * entry.Width + column];
+                        for(uint8_t i = 0; i < 8; ++i, temp >>= 1)
+                            *pixel++ = (temp & 0x01) ? color : background;
+                    }
+
+                    if constexpr (extraBits > 0)
+                    {
+                        uint8_t temp = glyph[page * entry.Width + column] >> (8 - extraBits);
+                        for(uint8_t i = 0; i < extraBits; ++i, temp >>= 1)
+                            *pixel++ = (temp & 0x01) ? color : background;
+                    }
+                }
+            }
+
+            width = entry.Width;
+            return entry.Pixels;
+        }
+
+    private:
+        static Entry _entries[_Entries];
+        static uint8_t _next;
+    };
+
+    template<typename _Font, unsigned _Entries>
+    typename GlyphCache<_Font, _Entries>::Entry GlyphCache<_Font, _Entries>::_entries[_Entries];
+
+    template<typename _Font, unsigned _Entries>
+    uint8_t GlyphCache<_Font, _Entries>::_next = 0;
+
     // Monospaced fonts
     using Font5x7 = MonoSpaceFont<5, 7, 32>;
     using Fixed10x15Bold = MonoSpaceFont<10, 15, 32>;
@@ -107,7 +320,7 @@ namespace Zhele::Drivers
     using TimesNewRoman13Italic = Font<13, 32, TimesNewRomanItalic>;
 
     template<>
-    const uint8_t Font5x7::_data[] = {
+    constexpr uint8_t Font5x7::_data[] = {
         0x00, 0x00, 0x00, 0x00, 0x00, // SPACE
         0x00, 0x00, 0x5F, 0x00, 0x00, // !
         0x00, 0x03, 0x00, 0x03, 0x00, // "
@@ -207,7 +420,7 @@ namespace Zhele::Drivers
     };
 
     template<>
-    const uint8_t Fixed10x15Bold::_data[] = {
+    constexpr uint8_t Fixed10x15Bold::_data[] = {
         0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // *space*
         0x00, 0x00, 0x00, 0x00, 0xfe, 0xfe, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x19, 0x19, 0x00, 0x00, 0x00, 0x00,  // !
         0x00, 0x00, 0x1e, 0x1e, 0x00, 0x00, 0x1e, 0x1e, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // "
@@ -306,7 +519,7 @@ namespace Zhele::Drivers
     };
 
     template<>
-    const uint8_t TimesNewRoman13::_widths[] = {
+    constexpr uint8_t TimesNewRoman13::_widths[] = {
         0x02, 0x01, 0x03, 0x06, 0x05, 0x09, 0x09, 0x01, 0x03, 0x03, 
         0x05, 0x07, 0x02, 0x03, 0x01, 0x03, 0x05, 0x03, 0x05, 0x05, 
         0x06, 0x05, 0x05, 0x05, 0x05, 0x05, 0x01, 0x02, 0x06, 0x06, 
@@ -320,7 +533,7 @@ namespace Zhele::Drivers
     };
 
     template<>
-    const uint8_t TimesNewRoman13::_data[] = {
+    constexpr uint8_t TimesNewRoman13::_data[] = {
         0x00, 0x00, 0x00, 0x00, // 0x20 <space>
         0xFE, 0x10, // 33
         0x0E, 0x00, 0x0E, 0x00, 0x00, 0x00, // 34
@@ -420,7 +633,7 @@ namespace Zhele::Drivers
     };
 
     template<>
-    const uint8_t TimesNewRoman13Italic::_widths[] = {
+    constexpr uint8_t TimesNewRoman13Italic::_widths[] = {
         0x03, 0x03, 0x05, 0x06, 0x06, 0x0A, 0x09, 0x01, 0x03, 0x03, 
         0x04, 0x07, 0x01, 0x03, 0x01, 0x03, 0x05, 0x04, 0x05, 0x05, 
         0x05, 0x06, 0x05, 0x05, 0x06, 0x06, 0x02, 0x03, 0x06, 0x06, 
@@ -434,7 +647,7 @@ namespace Zhele::Drivers
     };
 
     template<>
-    const uint8_t TimesNewRoman13Italic::_data[] = {
+    constexpr uint8_t TimesNewRoman13Italic::_data[] = {
         0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 0x20 <space>
         0x00, 0xE0, 0x1E, 0x10, 0x00, 0x00, // 33
         0x0E, 0x02, 0x00, 0x0E, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, // 34
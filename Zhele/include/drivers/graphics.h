@@ -0,0 +1,248 @@
+/**
+ * @file
+ * Implements 2D graphics (lines, rectangles, circles, text) over display backend spans
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DRIVERS_GRAPHICS_H
+#define ZHELE_DRIVERS_GRAPHICS_H
+
+#include <stdint.h>
+
+namespace Zhele::Drivers
+{
+    /**
+     * @brief Implements 2D graphics with clipping
+     *
+     * @details
+     * All primitives are converted to clipped horizontal spans, so drawing cost scales with spans
+     * count (one framebuffer row operation or one address window with DMA fill) instead of pixels.
+     * Backend (Ssd1306, St7735, Ili9341 or any class with the same interface) should provide:
+     *  - ColorType: color type;
+     *  - Width, Height: screen size;
+     *  - FillSpan(x, y, length, color): fill horizontal span (always inside screen);
+     *  - FillArea(x, y, width, height, color) (optional): fill rectangle (used for rectangles and vertical lines).
+     *
+     * @tparam _Backend Display backend
+     */
+    template<typename _Backend>
+    class Graphics
+    {
+        static constexpr bool HasFillArea = requires { _Backend::FillArea(0, 0, 0, 0, typename _Backend::ColorType{}); };
+    public:
+        /// Color type
+        using Color = typename _Backend::ColorType;
+
+        /**
+         * @brief Sets clipping rectangle (intersected with screen)
+         *
+         * @param [in] x Left column
+         * @param [in] y Top line
+         * @param [in] width Width
+         * @param [in] height Height
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void SetClip(int x, int y, int width, int height);
+
+        /**
+         * @brief Resets clipping rectangle to whole screen
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void ResetClip();
+
+        /**
+         * @brief Draws pixel
+         *
+         * @param [in] x X coordinate
+         * @param [in] y Y coordinate
+         * @param [in] color Color
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void DrawPixel(int x, int y, Color color);
+
+        /**
+         * @brief Draws horizontal line
+         *
+         * @param [in] x Left column
+         * @param [in] y Line
+         * @param [in] length Length
+         * @param [in] color Color
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void DrawHLine(int x, int y, int length, Color color);
+
+        /**
+         * @brief Draws vertical line
+         *
+         * @param [in] x Column
+         * @param [in] y Top line
+         * @param [in] length Length
+         * @param [in] color Color
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void DrawVLine(int x, int y, int length, Color color);
+
+        /**
+         * @brief Draws line (Bresenham), pixels of the same row are merged to one span
+         *
+         * @param [in] x0 Start X
+         * @param [in] y0 Start Y
+         * @param [in] x1 End X
+         * @param [in] y1 End Y
+         * @param [in] color Color
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void DrawLine(int x0, int y0, int x1, int y1, Color color);
+
+        /**
+         * @brief Draws rectangle outline
+         *
+         * @param [in] x Left column
+         * @param [in] y Top line
+         * @param [in] width Width
+         * @param [in] height Height
+         * @param [in] color Color
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void DrawRectangle(int x, int y, int width, int height, Color color);
+
+        /**
+         * @brief Fills rectangle
+         *
+         * @param [in] x Left column
+         * @param [in] y Top line
+         * @param [in] width Width
+         * @param [in] height Height
+         * @param [in] color Color
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void FillRectangle(int x, int y, int width, int height, Color color);
+
+        /**
+         * @brief Draws circle outline (midpoint algorithm)
+         *
+         * @param [in] x Center X
+         * @param [in] y Center Y
+         * @param [in] radius Radius
+         * @param [in] color Color
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void DrawCircle(int x, int y, int radius, Color color);
+
+        /**
+         * @brief Fills circle (every row is one span)
+         *
+         * @param [in] x Center X
+         * @param [in] y Center Y
+         * @param [in] radius Radius
+         * @param [in] color Color
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void FillCircle(int x, int y, int radius, Color color);
+
+        /**
+         * @brief Draws char with transparent background
+         *
+         * @tparam Font Font
+         *
+         * @param [in] x Left column
+         * @param [in] y Top line
+         * @param [in] symbol Symbol
+         * @param [in] color Color
+         *
+         * @returns Symbol width
+         */
+        template<typename Font>
+        static uint8_t DrawChar(int x, int y, char symbol, Color color);
+
+        /**
+         * @brief Draws char with background
+         *
+         * @tparam Font Font
+         *
+         * @param [in] x Left column
+         * @param [in] y Top line
+         * @param [in] symbol Symbol
+         * @param [in] color Color
+         * @param [in] background Background color
+         *
+         * @returns Symbol width
+         */
+        template<typename Font>
+        static uint8_t DrawChar(int x, int y, char symbol, Color color, Color background);
+
+        /**
+         * @brief Draws string with transparent background
+         *
+         * @tparam Font Font
+         *
+         * @param [in] x Left column
+         * @param [in] y Top line
+         * @param [in] str String
+         * @param [in] color Color
+         *
+         * @returns X coordinate after string
+         */
+        template<typename Font>
+        static int DrawString(int x, int y, const char* str, Color color);
+
+        /**
+         * @brief Draws string with background
+         *
+         * @tparam Font Font
+         *
+         * @param [in] x Left column
+         * @param [in] y Top line
+         * @param [in] str String
+         * @param [in] color Color
+         * @param [in] background Background color
+         *
+         * @returns X coordinate after string
+         */
+        template<typename Font>
+        static int DrawString(int x, int y, const char* str, Color color, Color background);
+
+    private:
+        static void Span(int x, int y, int length, Color color);
+        static void Area(int x, int y, int width, int height, Color color);
+
+        template<typename Font>
+        static uint8_t GlyphWidth(char symbol);
+        template<typename Font>
+        static bool GlyphBit(const uint8_t* glyph, uint8_t width, uint8_t column, uint8_t row);
+        template<typename Font, bool _Opaque>
+        static uint8_t RenderChar(int x, int y, char symbol, Color color, Color background);
+
+        static int _clipLeft;
+        static int _clipTop;
+        static int _clipRight;
+        static int _clipBottom;
+    };
+}
+
+#include "impl/graphics.h"
+
+#endif //! ZHELE_DRIVERS_GRAPHICS_H
@@ -12,10 +12,168 @@
 #define ZHELE_DRIVERS_HD44780_H
 
 #include <delay.h>
+#include <i2c.h>
 #include <pinlist.h>
 
+#include <type_traits>
+
 namespace Zhele::Drivers
 {
+    namespace Private
+    {
+        /**
+         * @brief Shadow copy of HD44780 display data RAM
+         * 
+         * @details
+         * Tracks displayed characters and display cursor, so only changed cells
+         * are transmitted and cursor is moved only after skipped cells.
+         * 
+         * @tparam _Width One line width (symbols count)
+         * @tparam _Lines Lines count
+         */
+        template<uint8_t _Width, uint8_t _Lines>
+        class DdramShadow
+        {
+            static const uint16_t Unknown = 0xffff;
+        public:
+            /**
+             * @brief Returns DDRAM address of cell.
+             * 
+             * @param [in] x X-position.
+             * @param [in] y Y-position.
+             * 
+             * @returns DDRAM address.
+             */
+            static uint8_t Address(uint8_t x, uint8_t y)
+            {
+                // Lines 3 and 4 continue lines 1 and 2 in DDRAM
+                return (y & 0x01 ? 0x40 : 0x00) + (y & 0x02 ? _Width : 0) + x;
+            }
+
+            /**
+             * @brief Mark all cells as unknown (display content is not defined).
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            void Invalidate()
+            {
+                for(uint8_t line = 0; line < _Lines; ++line)
+                {
+                    for(uint8_t i = 0; i < _Width; ++i)
+                        _cells[line][i] = Unknown;
+                }
+                _synced = false;
+            }
+
+            /**
+             * @brief Mark display as cleared (cursor is at home).
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            void Reset()
+            {
+                for(uint8_t line = 0; line < _Lines; ++line)
+                {
+                    for(uint8_t i = 0; i < _Width; ++i)
+                        _cells[line][i] = ' ';
+                }
+                SetCursor(0, 0);
+            }
+
+            /**
+             * @brief Set cursor position (display cursor has been moved to it).
+             * 
+             * @param [in] x X-position.
+             * @param [in] y Y-position.
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            void SetCursor(uint8_t x, uint8_t y)
+            {
+                _x = x;
+                _y = y;
+                _synced = true;
+            }
+
+            /**
+             * @brief Set cursor DDRAM address (display cursor has been moved to it).
+             * 
+             * @param [in] address DDRAM address.
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            void SetAddress(uint8_t address)
+            {
+                uint8_t y = address >= 0x40 ? 1 : 0;
+                uint8_t x = address - (y ? 0x40 : 0x00);
+                if(_Lines > 2 && x >= _Width)
+                {
+                    x -= _Width;
+                    y += 2;
+                }
+                SetCursor(x, y);
+            }
+
+            /**
+             * @brief Put character at cursor position.
+             * 
+             * @param [in] symbol Symbol.
+             * @param [in] move Cursor move functor (called with DDRAM address before send if cursor must be moved)
+             * @param [in] send Send functor (called if cell must be sent)
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            template<typename _Move, typename _Send>
+            void Put(char symbol, _Move move, _Send send)
+            {
+                // Cells outside of visible area are not tracked
+                if(_x < _Width && _y < _Lines)
+                {
+                    uint16_t& cell = _cells[_y][_x];
+                    if(cell == static_cast<uint8_t>(symbol))
+                    {
+                        ++_x;
+                        _synced = false;
+                        return;
+                    }
+                    cell = static_cast<uint8_t>(symbol);
+                }
+                Sync(move);
+                send(symbol);
+                ++_x;
+            }
+
+            /**
+             * @brief Move display cursor to cursor position (if it lags behind).
+             * 
+             * @param [in] move Cursor move functor (called with DDRAM address)
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            template<typename _Move>
+            void Sync(_Move move)
+            {
+                if(!_synced)
+                {
+                    move(Address(_x, _y));
+                    _synced = true;
+                }
+            }
+
+        private:
+            uint16_t _cells[_Lines][_Width];
+            uint8_t _x;
+            uint8_t _y;
+            bool _synced;
+        };
+    }
+
     /**
      * @brief Base class for lcd.
      */
@@ -158,6 +316,7 @@ namespace Zhele::Drivers
             Write(FunctionSet | Line2 | Dots5x8 | Bit4Mode);
             Write(DisplayControl | DisplayOn | CursorOn | BlinkOn);
             Write(EntryModeSet | Left | ShiftDecrement);
+            _shadow.Invalidate();
         }
 
         /**
@@ -171,6 +330,7 @@ namespace Zhele::Drivers
             RS::Clear();
             Write(ClearDisplay);
             delay_ms<10>();
+            _shadow.Reset();
         }
 
         /**
@@ -183,6 +343,7 @@ namespace Zhele::Drivers
         {
             RS::Clear();
             Write(ReturnHome);
+            _shadow.SetCursor(0, 0);
         }
 
         /**
@@ -197,6 +358,7 @@ namespace Zhele::Drivers
         {
             RS::Clear();
             Write(SetDDRamAddr | position);
+            _shadow.SetAddress(position);
         }
 
         /**
@@ -211,15 +373,17 @@ namespace Zhele::Drivers
         static void Goto(uint8_t x, uint8_t y)
         {
             RS::Clear();
-            if (y == 1)
-                x += 0x40;
-            Write(SetDDRamAddr + x);
+            Write(SetDDRamAddr | Shadow::Address(x, y));
             Delay();
+            _shadow.SetCursor(x, y);
         }
 
         /**
          * @brief Print text.
          * 
+         * @details
+         * Characters which are already displayed are not transmitted.
+         * 
          * @param [in] text Text
          * 
          * @par Returns
@@ -229,8 +393,9 @@ namespace Zhele::Drivers
         {
             RS::Set();
             while(*text) {
-                Write(*text++);
+                _shadow.Put(*text++, MoveCursor, Write);
             }
+            _shadow.Sync(MoveCursor);
         }
 
         /**
@@ -244,7 +409,8 @@ namespace Zhele::Drivers
         static void Putch(char symbol)
         {
             RS::Set();
-            Write(symbol);
+            _shadow.Put(symbol, MoveCursor, Write);
+            _shadow.Sync(MoveCursor);
         }
 
         /**
@@ -265,6 +431,15 @@ namespace Zhele::Drivers
         }
 
     protected:
+        using Shadow = Private::DdramShadow<LINE_WIDTH, LINES>;
+
+        static void MoveCursor(uint8_t address)
+        {
+            RS::Clear();
+            Write(SetDDRamAddr | address);
+            RS::Set();
+        }
+
         static void Strobe()
         {
             E::Set();
@@ -280,8 +455,13 @@ namespace Zhele::Drivers
             DataBus::Write(c);
             Strobe();
         }
+
+        static Shadow _shadow;
     };
 
+    template<typename RS, typename E, typename D4, typename D5, typename D6, typename D7, uint8_t LINE_WIDTH, uint8_t LINES>
+    typename Lcd<RS, E, D4, D5, D6, D7, LINE_WIDTH, LINES>::Shadow Lcd<RS, E, D4, D5, D6, D7, LINE_WIDTH, LINES>::_shadow;
+
     /**
      * @brief Implements Lcd with read support
      * @tparam RS RS pin
@@ -318,7 +498,7 @@ namespace Zhele::Drivers
         static void Init()
         {
             Base::Init();
-            RW::template SetConfiguration<RW::Out>();
+            RW::template SetConfiguration<RW::Configuration::Out>();
         }
 
         /**
@@ -341,7 +521,7 @@ namespace Zhele::Drivers
          */
         static uint8_t Read()
         {
-            Base::DataBus::template SetConfiguration<Base::DataBus::In>();
+            Base::DataBus::template SetConfiguration<Base::DataBus::Configuration::In>();
             RW::Set();
             E::Set();
             uint8_t res = Base::DataBus::Read() << 4;
@@ -351,11 +531,370 @@ namespace Zhele::Drivers
             res |= Base::DataBus::Read();
             E::Clear();
             RW::Clear();
-            Base::DataBus::template SetConfiguration<Base::DataBus::Out>();
+            Base::DataBus::template SetConfiguration<Base::DataBus::Configuration::Out>();
             return res;
         }
     };
 
+    /**
+     * @brief Implements buffered LCD with HD44780 controller
+     * 
+     * @details
+     * Text is printed to frame buffer, Update method writes to display only changed part
+     * of every line (one address command and characters burst per changed line).
+     * Data bus nibble or byte is written by one pinlist write. Driver does not wait after
+     * every write: it waits before next access, so it polls busy flag (if RW pin is connected)
+     * or waits command execution time only if previous command may be still in progress.
+     * 
+     * @tparam _DataPins Data pins (pinlist D4...D7 for 4-bit mode or D0...D7 for 8-bit mode)
+     * @tparam RS RS pin
+     * @tparam E Enable pin
+     * @tparam RW RW pin (NullPin if RW is tied to ground)
+     * @tparam LINE_WIDTH One line width (symbols count)
+     * @tparam LINES Lines count
+     */
+    template<
+        typename _DataPins,
+        typename RS,
+        typename E,
+        typename RW = IO::NullPin,
+        uint8_t LINE_WIDTH = 16,
+        uint8_t LINES = 2
+        >
+    class LcdBuffered : public LcdBase
+    {
+        static_assert(_DataPins::Length == 4 || _DataPins::Length == 8, "Data bus must have 4 or 8 pins");
+        static_assert(LINES >= 1 && LINES <= 4, "Lines count must be 1...4");
+
+        static const bool Bus8Bit = _DataPins::Length == 8;
+        static const bool HasRw = !std::is_same_v<RW, IO::NullPin>;
+
+        // Commands execution time (us) with margin for slow controllers
+        static const uint16_t ShortCommandTime = 50;
+        static const uint16_t LongCommandTime = 2000;
+    public:
+        /**
+         * @brief Returns line width.
+         *
+         * @returns Line width.
+         */
+        static uint8_t LineWidth()
+        {
+            return LINE_WIDTH;
+        }
+
+        /**
+         * @brief Returns lines count.
+         *
+         * @returns Lines count.
+         */
+        static uint8_t Lines()
+        {
+            return LINES;
+        }
+
+        /**
+         * @brief Init display (and clear it).
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Init()
+        {
+            using ControlPins = IO::PinList<RS, E>;
+            ControlPins::Enable();
+            ControlPins::Clear(0x03);
+            ControlPins::template SetConfiguration<ControlPins::Configuration::Out>();
+            RW::Port::Enable();
+            RW::Clear();
+            RW::template SetConfiguration<RW::Configuration::Out>();
+            _DataPins::Enable();
+            _DataPins::template SetConfiguration<_DataPins::Configuration::Out>();
+
+            // Initialization by instruction: busy flag can't be checked yet
+            delay_ms<40>();
+            WriteBus(0x30);
+            delay_ms<5>();
+            WriteBus(0x30);
+            delay_us<150>();
+            WriteBus(0x30);
+            delay_us<ShortCommandTime>();
+            if constexpr (!Bus8Bit)
+            {
+                WriteBus(0x20);
+                delay_us<ShortCommandTime>();
+            }
+
+            WriteCommand(FunctionSet | (Bus8Bit ? Bit8Mode : Bit4Mode) | (LINES > 1 ? Line2 : Line1) | Dots5x8);
+            WriteCommand(DisplayControl | DisplayOn | CursorOff | BlinkOff);
+            WriteCommand(EntryModeSet | Left | ShiftDecrement);
+            WriteCommand(ClearDisplay);
+
+            for(uint8_t line = 0; line < LINES; ++line)
+            {
+                for(uint8_t i = 0; i < LINE_WIDTH; ++i)
+                {
+                    _buffer[line][i] = ' ';
+                    _shown[line][i] = ' ';
+                }
+            }
+            _x = 0;
+            _y = 0;
+        }
+
+        /**
+         * @brief Clear frame buffer.
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Clear()
+        {
+            for(uint8_t line = 0; line < LINES; ++line)
+            {
+                for(uint8_t i = 0; i < LINE_WIDTH; ++i)
+                    _buffer[line][i] = ' ';
+            }
+            _x = 0;
+            _y = 0;
+        }
+
+        /**
+         * @brief Set frame buffer cursor's position.
+         * 
+         * @param [in] x New X-position.
+         * @param [in] y New Y-position.
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Goto(uint8_t x, uint8_t y)
+        {
+            _x = x;
+            _y = y;
+        }
+
+        /**
+         * @brief Print text to frame buffer.
+         * 
+         * @details
+         * Text is clipped by line end, '\\n' moves cursor to next line.
+         * 
+         * @param [in] text Text
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Puts(const char* text)
+        {
+            while(*text)
+                Putch(*text++);
+        }
+
+        /**
+         * @brief Print one character to frame buffer.
+         * 
+         * @param [in] symbol Symbol
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Putch(char symbol)
+        {
+            if(symbol == '\n')
+            {
+                _x = 0;
+                ++_y;
+                return;
+            }
+            if(_x < LINE_WIDTH && _y < LINES)
+                _buffer[_y][_x] = symbol;
+            ++_x;
+        }
+
+        /**
+         * @brief Write changed characters of frame buffer to display.
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Update()
+        {
+            for(uint8_t line = 0; line < LINES; ++line)
+            {
+                uint8_t first = 0;
+                while(first < LINE_WIDTH && _buffer[line][first] == _shown[line][first])
+                    ++first;
+                if(first == LINE_WIDTH)
+                    continue;
+
+                uint8_t last = LINE_WIDTH - 1;
+                while(_buffer[line][last] == _shown[line][last])
+                    --last;
+
+                // Address counter is incremented by display, so changed span costs one address command
+                WriteCommand(SetDDRamAddr | Private::DdramShadow<LINE_WIDTH, LINES>::Address(first, line));
+                for(uint8_t i = first; i <= last; ++i)
+                {
+                    WriteData(_buffer[line][i]);
+                    _shown[line][i] = _buffer[line][i];
+                }
+            }
+        }
+
+        /**
+         * @brief Rewrite whole display on next update (if display content was lost).
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Invalidate()
+        {
+            for(uint8_t line = 0; line < LINES; ++line)
+            {
+                for(uint8_t i = 0; i < LINE_WIDTH; ++i)
+                    _shown[line][i] = ~_buffer[line][i];
+            }
+        }
+
+        /**
+         * @brief Control display power settings.
+         * 
+         * @tparam DisplayState Display state (on/off).
+         * @tparam CursorState Cursor state.
+         * @tparam BlinkState Cursor blink state.
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        template<PowerControl DisplayState, PowerControl CursorState, PowerControl BlinkState>
+        static void PowerControl()
+        {
+            WriteCommand(DisplayControl | DisplayState | CursorState | BlinkState);
+        }
+
+        /**
+         * @brief Check display is busy.
+         * 
+         * @details
+         * Without RW pin busy flag can't be read, so method returns true
+         * if last command may be still in progress.
+         * 
+         * @retval true Display busy.
+         * @retval false Display not busy.
+         */
+        static bool Busy()
+        {
+            if constexpr (HasRw)
+            {
+                RS::Clear();
+                return ReadBus() & 0x80;
+            }
+            else
+            {
+                return _pendingTime != 0;
+            }
+        }
+
+    protected:
+        static void WriteCommand(uint8_t command)
+        {
+            WaitReady();
+            RS::Clear();
+            Write(command);
+            // Clear display and return home are long commands
+            _pendingTime = command <= (ReturnHome | 0x01) ? LongCommandTime : ShortCommandTime;
+        }
+
+        static void WriteData(uint8_t data)
+        {
+            WaitReady();
+            RS::Set();
+            Write(data);
+            _pendingTime = ShortCommandTime;
+        }
+
+        static void WaitReady()
+        {
+            if constexpr (HasRw)
+            {
+                while(Busy())
+                    continue;
+            }
+            else
+            {
+                if(_pendingTime != 0)
+                    Zhele::Private::DelayCycles(static_cast<uint64_t>(F_CPU) / 1000000u * _pendingTime);
+            }
+            _pendingTime = 0;
+        }
+
+        static void Write(uint8_t value)
+        {
+            if constexpr (Bus8Bit)
+            {
+                WriteBus(value);
+            }
+            else
+            {
+                WriteBus(value);
+                WriteBus(value << 4);
+            }
+        }
+
+        static void WriteBus(uint8_t value)
+        {
+            _DataPins::Write(Bus8Bit ? value : value >> 4);
+            E::Set();
+            delay_ns<450>();
+            E::Clear();
+            delay_ns<500>();
+        }
+
+        static uint8_t ReadBus()
+        {
+            _DataPins::template SetConfiguration<_DataPins::Configuration::In>();
+            RW::Set();
+            uint8_t value = ReadStrobe();
+            if constexpr (!Bus8Bit)
+                value = (value << 4) | ReadStrobe();
+            RW::Clear();
+            _DataPins::template SetConfiguration<_DataPins::Configuration::Out>();
+            return value;
+        }
+
+        static uint8_t ReadStrobe()
+        {
+            E::Set();
+            delay_ns<450>();
+            uint8_t value = _DataPins::Read();
+            E::Clear();
+            delay_ns<500>();
+            return value;
+        }
+
+        static char _buffer[LINES][LINE_WIDTH];
+        static char _shown[LINES][LINE_WIDTH];
+        static uint8_t _x;
+        static uint8_t _y;
+        static uint16_t _pendingTime;
+    };
+
+    template<typename _DataPins, typename RS, typename E, typename RW, uint8_t LINE_WIDTH, uint8_t LINES>
+    char LcdBuffered<_DataPins, RS, E, RW, LINE_WIDTH, LINES>::_buffer[LINES][LINE_WIDTH];
+
+    template<typename _DataPins, typename RS, typename E, typename RW, uint8_t LINE_WIDTH, uint8_t LINES>
+    char LcdBuffered<_DataPins, RS, E, RW, LINE_WIDTH, LINES>::_shown[LINES][LINE_WIDTH];
+
+    template<typename _DataPins, typename RS, typename E, typename RW, uint8_t LINE_WIDTH, uint8_t LINES>
+    uint8_t LcdBuffered<_DataPins, RS, E, RW, LINE_WIDTH, LINES>::_x = 0;
+
+    template<typename _DataPins, typename RS, typename E, typename RW, uint8_t LINE_WIDTH, uint8_t LINES>
+    uint8_t LcdBuffered<_DataPins, RS, E, RW, LINE_WIDTH, LINES>::_y = 0;
+
+    template<typename _DataPins, typename RS, typename E, typename RW, uint8_t LINE_WIDTH, uint8_t LINES>
+    uint16_t LcdBuffered<_DataPins, RS, E, RW, LINE_WIDTH, LINES>::_pendingTime = 0;
+
     /**
      * @brief Class provides LCD displays with HD44780 mcu
      * 
@@ -424,6 +963,7 @@ namespace Zhele::Drivers
             WriteU8(EntryModeSet | Left | ShiftDecrement);
 
             Home();
+            _shadow.Invalidate();
         }
 
         /**
@@ -437,6 +977,7 @@ namespace Zhele::Drivers
             WriteU8(ClearDisplay);
             delay_ms<10>();
             Home();
+            _shadow.Reset();
         }
 
         /**
@@ -449,6 +990,7 @@ namespace Zhele::Drivers
         {
             WriteU8(ReturnHome);
             delay_ms<10>();
+            _shadow.SetCursor(0, 0);
         }
 
         /**
@@ -462,6 +1004,7 @@ namespace Zhele::Drivers
         static void Goto(uint8_t position)
         {
             WriteU8(SetDDRamAddr | position);
+            _shadow.SetAddress(position);
         }
 
         /**
@@ -475,14 +1018,17 @@ namespace Zhele::Drivers
          */
         static void Goto(uint8_t x, uint8_t y)
         {
-            if (y == 1)
-                x += 0x40;
-            WriteU8(SetDDRamAddr | x);
+            WriteU8(SetDDRamAddr | Shadow::Address(x, y));
+            _shadow.SetCursor(x, y);
         }
 
         /**
          * @brief Print text.
          * 
+         * @details
+         * Characters which are already displayed are not transmitted,
+         * changed characters are sent by one I2C transaction.
+         * 
          * @param [in] text Text
          * 
          * @par Returns
@@ -491,8 +1037,10 @@ namespace Zhele::Drivers
         static void Puts(const char* text)
         {
             while(*text) {
-                WriteU8(*text++, Mode::Data);
+                _shadow.Put(*text++, MoveCursor, AppendData);
             }
+            _shadow.Sync(MoveCursor);
+            Flush();
         }
 
         /**
@@ -505,7 +1053,9 @@ namespace Zhele::Drivers
          */
         static void Putch(char symbol)
         {
-            WriteU8(symbol, Mode::Data);
+            _shadow.Put(symbol, MoveCursor, AppendData);
+            _shadow.Sync(MoveCursor);
+            Flush();
         }
 
         /**
@@ -525,30 +1075,87 @@ namespace Zhele::Drivers
         }
 
     protected:
+        using Shadow = Private::DdramShadow<LINE_WIDTH, LINES>;
+
+        // Changed line (with cursor move) fits one burst
+        static const uint16_t BurstSize = 4 * LINE_WIDTH + 8;
+
         static void WriteU8(uint8_t data, Mode mode = Mode::Command)
         {
-            WriteU4((data & 0xf0) | static_cast<uint8_t>(mode));
-            WriteU4(((data << 4) & 0xf0) | static_cast<uint8_t>(mode));
+            Append(data, mode);
+            Flush();
         }
 
         static void WriteU4(uint8_t data)
         {
-            Write(data);
-            Strobe(data);
+            _burst[_burstSize++] = data | BackLight;
+            AppendU4(data);
+            Flush();
+            delay_us<50>();
         }
 
-        static void Strobe(uint8_t data)
+        static void MoveCursor(uint8_t address)
         {
-            Write(data | Enable);
-            delay_us<1>();
-            Write(data & ~Enable);
-            delay_us<50>();
+            Append(SetDDRamAddr | address, Mode::Command);
+        }
+
+        static void AppendData(char symbol)
+        {
+            Append(symbol, Mode::Data);
+        }
+
+        static void Append(uint8_t data, Mode mode)
+        {
+            if(_burstSize + 5 > BurstSize)
+                Flush();
+            // RS must be set before E rise
+            if(_burstSize == 0 || _burstMode != mode)
+            {
+                _burst[_burstSize++] = static_cast<uint8_t>(mode) | BackLight;
+                _burstMode = mode;
+            }
+            AppendU4((data & 0xf0) | static_cast<uint8_t>(mode));
+            AppendU4(((data << 4) & 0xf0) | static_cast<uint8_t>(mode));
+        }
+
+        static void AppendU4(uint8_t data)
+        {
+            // Nibble is latched by E fall. Expander updates outputs once per byte (tens of microseconds
+            // for 100-400 kHz I2C), so pulse width and command execution time are satisfied by bus timing.
+            _burst[_burstSize++] = data | Enable | BackLight;
+            _burst[_burstSize++] = data | BackLight;
+        }
+
+        static void Flush()
+        {
+            if(_burstSize == 0)
+                return;
+            DataBus::Write(_Address, 0x00, _burst, _burstSize, I2cOpts::RegAddrNone);
+            _burstSize = 0;
         }
 
         static void Write(uint8_t data)
         {
             DataBus::WriteU8(_Address, 0x00, data | BackLight, I2cOpts::RegAddrNone);
         }
+
+        static Shadow _shadow;
+        static uint8_t _burst[BurstSize];
+        static uint16_t _burstSize;
+        static Mode _burstMode;
     };
+
+    template<typename _I2cBus, uint8_t _Address, uint8_t LINE_WIDTH, uint8_t LINES>
+    typename LcdI2c<_I2cBus, _Address, LINE_WIDTH, LINES>::Shadow LcdI2c<_I2cBus, _Address, LINE_WIDTH, LINES>::_shadow;
+
+    template<typename _I2cBus, uint8_t _Address, uint8_t LINE_WIDTH, uint8_t LINES>
+    uint8_t LcdI2c<_I2cBus, _Address, LINE_WIDTH, LINES>::_burst[BurstSize];
+
+    template<typename _I2cBus, uint8_t _Address, uint8_t LINE_WIDTH, uint8_t LINES>
+    uint16_t LcdI2c<_I2cBus, _Address, LINE_WIDTH, LINES>::_burstSize = 0;
+
+    template<typename _I2cBus, uint8_t _Address, uint8_t LINE_WIDTH, uint8_t LINES>
+    typename LcdI2c<_I2cBus, _Address, LINE_WIDTH, LINES>::Mode LcdI2c<_I2cBus, _Address, LINE_WIDTH, LINES>::_burstMode
+        = LcdI2c<_I2cBus, _Address, LINE_WIDTH, LINES>::Mode::Command;
 }
 #endif //! ZHELE_DRIVERS_HD44780_H
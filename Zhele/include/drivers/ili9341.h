@@ -0,0 +1,255 @@
+/**
+ * @file
+ * Implements ILI9341 TFT driver for 8080-type parallel bus
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DRIVERS_ILI9341_H
+#define ZHELE_DRIVERS_ILI9341_H
+
+#include "parallel_bus.h"
+
+#include <delay.h>
+#include <iopins.h>
+
+#include <common/template_utils/data_transfer.h>
+
+#include <initializer_list>
+#include <stddef.h>
+#include <stdint.h>
+#include <type_traits>
+
+namespace Zhele::Drivers
+{
+    /**
+     * @brief Implements driver for ILI9341 based TFT (RGB565)
+     *
+     * @details
+     * Driver works over ParallelBus or FsmcBus. With FsmcBus every pixel is one memory store,
+     * so full screen is updated from framebuffer (for example, placed in external SRAM
+     * by ZHELE_EXTRAM) at FSMC write speed or by DMA without CPU.
+     * Bus must be initialized by user (FSMC timing depends on HCLK) before display Init.
+     *
+     * @tparam _Bus Parallel bus (ParallelBus or FsmcBus, 8 or 16 bit)
+     * @tparam _ResetPin Reset pin (NullPin for software reset only)
+     * @tparam _Width Width
+     * @tparam _Height Height
+     */
+    template<typename _Bus, typename _ResetPin = IO::NullPin, uint16_t _Width = 320, uint16_t _Height = 240>
+    class Ili9341
+    {
+        /// Display commands
+        enum class Command : uint8_t
+        {
+            SoftwareReset = 0x01,
+            SleepOut = 0x11,
+            DisplayOn = 0x29,
+            ColumnAddressSet = 0x2a,
+            PageAddressSet = 0x2b,
+            MemoryWrite = 0x2c,
+            MemoryAccessControl = 0x36,
+            PixelFormatSet = 0x3a,
+        };
+
+        enum MadCtl : uint8_t
+        {
+            My = 0x80,
+            Mx = 0x40,
+            Mv = 0x20,
+            Bgr = 0x08,
+        };
+
+        static const uint8_t Rotation = MadCtl::Bgr
+            | (_Width > _Height ? MadCtl::Mv | MadCtl::Mx | MadCtl::My : MadCtl::Mx);
+
+        static const uint16_t MaxDmaTransfer = 0xffff;
+        static constexpr bool WideBus = sizeof(typename _Bus::DataType) == 2;
+
+        static const uint16_t* _dmaData;
+        static uint32_t _dmaRemaining;
+        static volatile bool _dmaBusy;
+        static TransferCallback _dmaCallback;
+    public:
+        /// Color
+        enum Color : uint16_t
+        {
+            Black = 0x0000,
+            Blue = 0x001f,
+            Red = 0xf800,
+            Green = 0x07e0,
+            Cyan = 0x07ff,
+            Magenta = 0xf81f,
+            Yellow = 0xffe0,
+            White = 0xffff
+        };
+
+        /// Color type (for Graphics)
+        using ColorType = uint16_t;
+
+        /// Display width
+        static const uint16_t Width = _Width;
+        /// Display height
+        static const uint16_t Height = _Height;
+
+        /**
+         * @brief Init display (16 bit per pixel)
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void Init();
+
+        /**
+         * @brief Set drawing window and start memory write
+         *
+         * @details
+         * After the call pixels may be written to bus directly (WritePixels or bus methods).
+         *
+         * @param [in] x Left column
+         * @param [in] y Top line
+         * @param [in] width Width
+         * @param [in] height Height
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void SetWindow(uint16_t x, uint16_t y, uint16_t width, uint16_t height);
+
+        /**
+         * @brief Write pixels to current window
+         *
+         * @param [in] pixels Pixels (RGB565)
+         * @param [in] count Pixels count
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void WritePixels(const uint16_t* pixels, size_t count);
+
+        /**
+         * @brief Draw pixel
+         *
+         * @param [in] x X coordinate
+         * @param [in] y Y coordinate
+         * @param [in] color Color
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void DrawPixel(uint16_t x, uint16_t y, uint16_t color);
+
+        /**
+         * @brief Fill rectangle
+         *
+         * @param [in] x Left column
+         * @param [in] y Top line
+         * @param [in] width Width
+         * @param [in] height Height
+         * @param [in] color Color
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void FillRectangle(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t color);
+
+        /**
+         * @brief Fill rectangle (for Graphics)
+         *
+         * @param [in] x Left column
+         * @param [in] y Top line
+         * @param [in] width Width
+         * @param [in] height Height
+         * @param [in] color Color
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void FillArea(int x, int y, int width, int height, uint16_t color);
+
+        /**
+         * @brief Fill horizontal span (for Graphics)
+         *
+         * @param [in] x Left column
+         * @param [in] y Line
+         * @param [in] length Length
+         * @param [in] color Color
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void FillSpan(int x, int y, int length, uint16_t color);
+
+        /**
+         * @brief Fill screen
+         *
+         * @param [in] color Color
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void Fill(uint16_t color);
+
+        /**
+         * @brief Draw image
+         *
+         * @param [in] x Left column
+         * @param [in] y Top line
+         * @param [in] width Image width
+         * @param [in] height Image height
+         * @param [in] image Image (RGB565, width * height)
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void DrawImage(uint16_t x, uint16_t y, uint16_t width, uint16_t height, const uint16_t* image);
+
+        /**
+         * @brief Write full screen framebuffer
+         *
+         * @param [in] framebuffer Framebuffer (RGB565, Width * Height)
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void WriteFramebuffer(const uint16_t* framebuffer);
+
+        /**
+         * @brief Write full screen framebuffer by DMA (16-bit FsmcBus only)
+         *
+         * @details
+         * Framebuffer is sent by chunks (DMA transfer is limited by 65535 words),
+         * the next chunk is started from DMA interrupt.
+         *
+         * @tparam _DmaChannel DMA channel (stream) for memory to memory transfer
+         *
+         * @param [in] framebuffer Framebuffer (must remain valid until transfer is completed)
+         * @param [in] callback Transfer complete callback
+         *
+         * @par Returns
+         *	Nothing
+         */
+        template<typename _DmaChannel>
+        static void WriteFramebufferAsync(const uint16_t* framebuffer, TransferCallback callback = nullptr);
+
+        /**
+         * @brief Returns DMA framebuffer transfer state
+         *
+         * @retval true Transfer is in progress
+         * @retval false No transfer
+         */
+        static bool Busy();
+
+    protected:
+        static void WriteCommand(Command command);
+        static void WriteCommand(Command command, std::initializer_list<uint8_t> parameters);
+        template<typename _DmaChannel>
+        static void NextChunk();
+    };
+}
+
+#include "impl/ili9341.h"
+
+#endif //! ZHELE_DRIVERS_ILI9341_H
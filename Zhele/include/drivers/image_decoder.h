@@ -0,0 +1,168 @@
+/**
+ * @file
+ * Implements streaming image decoders (BMP and RLE) to RGB565 pixels
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DRIVERS_IMAGE_DECODER_H
+#define ZHELE_DRIVERS_IMAGE_DECODER_H
+
+#include <stdint.h>
+
+namespace Zhele::Drivers
+{
+    /**
+     * @brief Streaming BMP decoder
+     *
+     * @details
+     * Supports uncompressed 24-bit and 16-bit (RGB565 bit fields or RGB555) images,
+     * both bottom-up and top-down. Pixels are produced top-down and row by row,
+     * bottom-up image rows are read in reverse order, so source should support random access.
+     * Only small input buffer is used: source is read by chunks of _BufferSize bytes
+     * (FatFs reads file by sectors into its own window, so sequential chunks are read from RAM).
+     *
+     * @tparam _Source Data source: callable unsigned(uint32_t offset, void* buffer, unsigned size), returns read size
+     * @tparam _BufferSize Input buffer size (bytes)
+     */
+    template<typename _Source, unsigned _BufferSize = 96>
+    class BmpDecoder
+    {
+        static_assert(_BufferSize >= 6, "Buffer should fit at least two pixels");
+    public:
+        /**
+         * @brief Constructs decoder
+         *
+         * @param [in] source Data source
+         */
+        BmpDecoder(_Source source)
+            : _source(source)
+        {}
+
+        /**
+         * @brief Reads and checks image header
+         *
+         * @retval true Image is supported
+         * @retval false Image format is not supported (or read error)
+         */
+        bool Open();
+
+        /**
+         * @brief Returns image width
+         *
+         * @returns Width
+         */
+        uint16_t Width() const { return _width; }
+
+        /**
+         * @brief Returns image height
+         *
+         * @returns Height
+         */
+        uint16_t Height() const { return _height; }
+
+        /**
+         * @brief Decodes next pixels
+         *
+         * @param [out] pixels Output (RGB565)
+         * @param [in] count Max pixels count
+         *
+         * @returns Decoded pixels count (less than count at the end of image or on read error)
+         */
+        unsigned Decode(uint16_t* pixels, unsigned count);
+
+    private:
+        _Source _source;
+        uint8_t _buffer[_BufferSize];
+        uint32_t _dataOffset = 0;
+        uint32_t _stride = 0;
+        uint16_t _width = 0;
+        uint16_t _height = 0;
+        uint16_t _row = 0;
+        uint16_t _column = 0;
+        uint8_t _bytesPerPixel = 0;
+        bool _rgb555 = false;
+        bool _bottomUp = false;
+    };
+
+    /**
+     * @brief Streaming RLE image decoder
+     *
+     * @details
+     * Compact RGB565 format (see tools/rle_image.py): header is "RL" and width, height (16-bit),
+     * then runs follow. Run starts with control byte: if bit 7 is set, next pixel is repeated
+     * (control & 0x7f) + 1 times, otherwise (control + 1) pixels follow. Pixels and header values
+     * are little endian, rows are top-down. Source is read sequentially.
+     *
+     * @tparam _Source Data source: callable unsigned(uint32_t offset, void* buffer, unsigned size), returns read size
+     * @tparam _BufferSize Input buffer size (bytes)
+     */
+    template<typename _Source, unsigned _BufferSize = 64>
+    class RleDecoder
+    {
+        static_assert(_BufferSize >= 6, "Buffer should fit header");
+    public:
+        /**
+         * @brief Constructs decoder
+         *
+         * @param [in] source Data source
+         */
+        RleDecoder(_Source source)
+            : _source(source)
+        {}
+
+        /**
+         * @brief Reads and checks image header
+         *
+         * @retval true Image is supported
+         * @retval false Image format is not supported (or read error)
+         */
+        bool Open();
+
+        /**
+         * @brief Returns image width
+         *
+         * @returns Width
+         */
+        uint16_t Width() const { return _width; }
+
+        /**
+         * @brief Returns image height
+         *
+         * @returns Height
+         */
+        uint16_t Height() const { return _height; }
+
+        /**
+         * @brief Decodes next pixels
+         *
+         * @param [out] pixels Output (RGB565)
+         * @param [in] count Max pixels count
+         *
+         * @returns Decoded pixels count (less than count at the end of image or on read error)
+         */
+        unsigned Decode(uint16_t* pixels, unsigned count);
+
+    private:
+        bool ReadByte(uint8_t& value);
+        bool ReadPixel(uint16_t& pixel);
+
+        _Source _source;
+        uint8_t _buffer[_BufferSize];
+        uint32_t _offset = 0;
+        uint16_t _size = 0;
+        uint16_t _position = 0;
+        uint16_t _width = 0;
+        uint16_t _height = 0;
+        uint32_t _pixelsLeft = 0;
+        uint8_t _runLeft = 0;
+        bool _repeat = false;
+        uint16_t _color = 0;
+    };
+}
+
+#include "impl/image_decoder.h"
+
+#endif //! ZHELE_DRIVERS_IMAGE_DECODER_H
@@ -0,0 +1,355 @@
+/**
+ * @file
+ * Graphics methods implementation
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DRIVERS_GRAPHICS_IMPL_H
+#define ZHELE_DRIVERS_GRAPHICS_IMPL_H
+
+namespace Zhele::Drivers
+{
+    template<typename _Backend>
+    int Graphics<_Backend>::_clipLeft = 0;
+
+    template<typename _Backend>
+    int Graphics<_Backend>::_clipTop = 0;
+
+    template<typename _Backend>
+    int Graphics<_Backend>::_clipRight = _Backend::Width;
+
+    template<typename _Backend>
+    int Graphics<_Backend>::_clipBottom = _Backend::Height;
+
+    template<typename _Backend>
+    void Graphics<_Backend>::SetClip(int x, int y, int width, int height)
+    {
+        _clipLeft = x > 0 ? x : 0;
+        _clipTop = y > 0 ? y : 0;
+        _clipRight = x + width < static_cast<int>(_Backend::Width) ? x + width : _Backend::Width;
+        _clipBottom = y + height < static_cast<int>(_Backend::Height) ? y + height : _Backend::Height;
+    }
+
+    template<typename _Backend>
+    void Graphics<_Backend>::ResetClip()
+    {
+        SetClip(0, 0, _Backend::Width, _Backend::Height);
+    }
+
+    template<typename _Backend>
+    void Graphics<_Backend>::DrawPixel(int x, int y, Color color)
+    {
+        Span(x, y, 1, color);
+    }
+
+    template<typename _Backend>
+    void Graphics<_Backend>::DrawHLine(int x, int y, int length, Color color)
+    {
+        Span(x, y, length, color);
+    }
+
+    template<typename _Backend>
+    void Graphics<_Backend>::DrawVLine(int x, int y, int length, Color color)
+    {
+        Area(x, y, 1, length, color);
+    }
+
+    template<typename _Backend>
+    void Graphics<_Backend>::DrawLine(int x0, int y0, int x1, int y1, Color color)
+    {
+        if(y0 == y1)
+        {
+            x0 < x1 ? Span(x0, y0, x1 - x0 + 1, color) : Span(x1, y0, x0 - x1 + 1, color);
+            return;
+        }
+        if(x0 == x1)
+        {
+            y0 < y1 ? Area(x0, y0, 1, y1 - y0 + 1, color) : Area(x0, y1, 1, y0 - y1 + 1, color);
+            return;
+        }
+
+        int dx = x1 > x0 ? x1 - x0 : x0 - x1;
+        int dy = y1 > y0 ? y0 - y1 : y1 - y0;
+        int stepX = x0 < x1 ? 1 : -1;
+        int stepY = y0 < y1 ? 1 : -1;
+        int error = dx + dy;
+        int runStart = x0;
+
+        for(;;)
+        {
+            bool last = x0 == x1 && y0 == y1;
+            int error2 = 2 * error;
+            bool nextRow = !last && error2 <= dx;
+
+            // Row is complete: pixels from run start to current one are one span
+            if(last || nextRow)
+                runStart < x0 ? Span(runStart, y0, x0 - runStart + 1, color) : Span(x0, y0, runStart - x0 + 1, color);
+            if(last)
+                break;
+
+            if(error2 >= dy)
+            {
+                error += dy;
+                x0 += stepX;
+            }
+            if(nextRow)
+            {
+                error += dx;
+                y0 += stepY;
+                runStart = x0;
+            }
+        }
+    }
+
+    template<typename _Backend>
+    void Graphics<_Backend>::DrawRectangle(int x, int y, int width, int height, Color color)
+    {
+        if(width <= 0 || height <= 0)
+            return;
+
+        Span(x, y, width, color);
+        if(height > 1)
+            Span(x, y + height - 1, width, color);
+        if(height > 2)
+        {
+            Area(x, y + 1, 1, height - 2, color);
+            if(width > 1)
+                Area(x + width - 1, y + 1, 1, height - 2, color);
+        }
+    }
+
+    template<typename _Backend>
+    void Graphics<_Backend>::FillRectangle(int x, int y, int width, int height, Color color)
+    {
+        Area(x, y, width, height, color);
+    }
+
+    template<typename _Backend>
+    void Graphics<_Backend>::DrawCircle(int x, int y, int radius, Color color)
+    {
+        if(radius < 0)
+            return;
+
+        int dx = 0;
+        int dy = radius;
+        int decision = 1 - radius;
+        int runStart = 0;
+
+        while(dx <= dy)
+        {
+            // Steep octants: one pixel per row
+            Span(x + dy, y + dx, 1, color);
+            Span(x - dy, y + dx, 1, color);
+            if(dx != 0)
+            {
+                Span(x + dy, y - dx, 1, color);
+                Span(x - dy, y - dx, 1, color);
+            }
+
+            if(decision < 0)
+            {
+                decision += 2 * dx + 3;
+            }
+            else
+            {
+                // Flat octants: pixels of row y +- dy are one span on each side
+                Span(x + runStart, y + dy, dx - runStart + 1, color);
+                Span(x - dx, y + dy, dx - runStart + 1, color);
+                Span(x + runStart, y - dy, dx - runStart + 1, color);
+                Span(x - dx, y - dy, dx - runStart + 1, color);
+                decision += 2 * (dx - dy) + 5;
+                --dy;
+                runStart = dx + 1;
+            }
+            ++dx;
+        }
+
+        if(runStart < dx && runStart <= dy)
+        {
+            int end = dx - 1 < dy ? dx - 1 : dy;
+            Span(x + runStart, y + dy, end - runStart + 1, color);
+            Span(x - end, y + dy, end - runStart + 1, color);
+            Span(x + runStart, y - dy, end - runStart + 1, color);
+            Span(x - end, y - dy, end - runStart + 1, color);
+        }
+    }
+
+    template<typename _Backend>
+    void Graphics<_Backend>::FillCircle(int x, int y, int radius, Color color)
+    {
+        if(radius < 0)
+            return;
+
+        int dx = 0;
+        int dy = radius;
+        int decision = 1 - radius;
+
+        while(dx <= dy)
+        {
+            Span(x - dy, y + dx, 2 * dy + 1, color);
+            if(dx != 0)
+                Span(x - dy, y - dx, 2 * dy + 1, color);
+
+            if(decision < 0)
+            {
+                decision += 2 * dx + 3;
+            }
+            else
+            {
+                // Row y +- dy is drawn once with its widest span (before dy changes)
+                if(dx != dy)
+                {
+                    Span(x - dx, y + dy, 2 * dx + 1, color);
+                    Span(x - dx, y - dy, 2 * dx + 1, color);
+                }
+                decision += 2 * (dx - dy) + 5;
+                --dy;
+            }
+            ++dx;
+        }
+    }
+
+    template<typename _Backend>
+    template<typename Font>
+    uint8_t Graphics<_Backend>::DrawChar(int x, int y, char symbol, Color color)
+    {
+        return RenderChar<Font, false>(x, y, symbol, color, color);
+    }
+
+    template<typename _Backend>
+    template<typename Font>
+    uint8_t Graphics<_Backend>::DrawChar(int x, int y, char symbol, Color color, Color background)
+    {
+        return RenderChar<Font, true>(x, y, symbol, color, background);
+    }
+
+    template<typename _Backend>
+    template<typename Font>
+    int Graphics<_Backend>::DrawString(int x, int y, const char* str, Color color)
+    {
+        while(*str)
+            x += DrawChar<Font>(x, y, *str++, color);
+        return x;
+    }
+
+    template<typename _Backend>
+    template<typename Font>
+    int Graphics<_Backend>::DrawString(int x, int y, const char* str, Color color, Color background)
+    {
+        while(*str)
+            x += DrawChar<Font>(x, y, *str++, color, background);
+        return x;
+    }
+
+    template<typename _Backend>
+    void Graphics<_Backend>::Span(int x, int y, int length, Color color)
+    {
+        if(y < _clipTop || y >= _clipBottom)
+            return;
+
+        int end = x + length < _clipRight ? x + length : _clipRight;
+        if(x < _clipLeft)
+            x = _clipLeft;
+        if(x < end)
+            _Backend::FillSpan(x, y, end - x, color);
+    }
+
+    template<typename _Backend>
+    void Graphics<_Backend>::Area(int x, int y, int width, int height, Color color)
+    {
+        int right = x + width < _clipRight ? x + width : _clipRight;
+        int bottom = y + height < _clipBottom ? y + height : _clipBottom;
+        if(x < _clipLeft)
+            x = _clipLeft;
+        if(y < _clipTop)
+            y = _clipTop;
+        if(x >= right || y >= bottom)
+            return;
+
+        if constexpr (HasFillArea)
+        {
+            _Backend::FillArea(x, y, right - x, bottom - y, color);
+        }
+        else
+        {
+            for(; y < bottom; ++y)
+                _Backend::FillSpan(x, y, right - x, color);
+        }
+    }
+
+    template<typename _Backend>
+    template<typename Font>
+    uint8_t Graphics<_Backend>::GlyphWidth(char symbol)
+    {
+        if constexpr (Font::MonoSpace)
+            return Font::Width;
+        else
+            return Font::GetWidth(symbol);
+    }
+
+    template<typename _Backend>
+    template<typename Font>
+    bool Graphics<_Backend>::GlyphBit(const uint8_t* glyph, uint8_t width, uint8_t column, uint8_t row)
+    {
+        // Glyph is stored by pages (8 rows, LSB is top), last partial page is aligned to MSB
+        const uint8_t extraBits = Font::Height % 8;
+        uint8_t page = row / 8;
+        uint8_t bits = glyph[page * width + column];
+        if(extraBits > 0 && page == Font::Height / 8)
+            bits >>= (8 - extraBits);
+        return (bits >> (row % 8)) & 0x01;
+    }
+
+    template<typename _Backend>
+    template<typename Font, bool _Opaque>
+    uint8_t Graphics<_Backend>::RenderChar(int x, int y, char symbol, Color color, Color background)
+    {
+        uint8_t width = GlyphWidth<Font>(symbol);
+        if(x >= _clipRight || x + width <= _clipLeft || y >= _clipBottom || y + Font::Height <= _clipTop)
+            return width;
+
+        if constexpr (requires { Font::Compressed; })
+        {
+            // Compressed font: decoder outputs spans
+            Font::ForEachRun(symbol, [x, y, color, background](uint8_t column, uint8_t row, uint8_t length, bool foreground) {
+                if(foreground)
+                    Span(x + column, y + row, length, color);
+                else if constexpr (_Opaque)
+                    Span(x + column, y + row, length, background);
+            }, _Opaque);
+        }
+        else
+        {
+            const uint8_t* glyph = Font::Get(symbol);
+            int firstRow = y < _clipTop ? _clipTop - y : 0;
+            int lastRow = y + Font::Height > _clipBottom ? _clipBottom - y : Font::Height;
+
+            for(int row = firstRow; row < lastRow; ++row)
+            {
+                // Runs of equal bits are spans
+                uint8_t runStart = 0;
+                bool runBit = GlyphBit<Font>(glyph, width, 0, row);
+                for(uint8_t column = 1; column <= width; ++column)
+                {
+                    bool bit = column < width && GlyphBit<Font>(glyph, width, column, row);
+                    if(column < width && bit == runBit)
+                        continue;
+
+                    if(runBit)
+                        Span(x + runStart, y + row, column - runStart, color);
+                    else if constexpr (_Opaque)
+                        Span(x + runStart, y + row, column - runStart, background);
+
+                    runStart = column;
+                    runBit = bit;
+                }
+            }
+        }
+        return width;
+    }
+}
+
+#endif //! ZHELE_DRIVERS_GRAPHICS_IMPL_H
@@ -0,0 +1,217 @@
+/**
+ * @file
+ * ILI9341 methods implementation
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DRIVERS_ILI9341_IMPL_H
+#define ZHELE_DRIVERS_ILI9341_IMPL_H
+
+namespace Zhele::Drivers
+{
+    #define ILI9341_TEMPLATE_ARGS template<typename _Bus, typename _ResetPin, uint16_t _Width, uint16_t _Height>
+    #define ILI9341_TEMPLATE_QUALIFIER Ili9341<_Bus, _ResetPin, _Width, _Height>
+
+    ILI9341_TEMPLATE_ARGS
+    const uint16_t* ILI9341_TEMPLATE_QUALIFIER::_dmaData = nullptr;
+    ILI9341_TEMPLATE_ARGS
+    uint32_t ILI9341_TEMPLATE_QUALIFIER::_dmaRemaining = 0;
+    ILI9341_TEMPLATE_ARGS
+    volatile bool ILI9341_TEMPLATE_QUALIFIER::_dmaBusy = false;
+    ILI9341_TEMPLATE_ARGS
+    TransferCallback ILI9341_TEMPLATE_QUALIFIER::_dmaCallback;
+
+    ILI9341_TEMPLATE_ARGS
+    void ILI9341_TEMPLATE_QUALIFIER::Init()
+    {
+        if constexpr (requires { _Bus::Select(); })
+            _Bus::Select();
+
+        if constexpr (!std::is_same_v<_ResetPin, IO::NullPin>)
+        {
+            _ResetPin::Port::Enable();
+            _ResetPin::template SetConfiguration<_ResetPin::Configuration::Out>();
+            _ResetPin::template SetDriverType<_ResetPin::DriverType::PushPull>();
+            _ResetPin::Clear();
+            delay_ms<10>();
+            _ResetPin::Set();
+            delay_ms<120>();
+        }
+
+        WriteCommand(Command::SoftwareReset);
+        delay_ms<120>();
+        WriteCommand(Command::SleepOut);
+        delay_ms<120>();
+        // 16 bit per pixel (RGB565)
+        WriteCommand(Command::PixelFormatSet, {0x55});
+        WriteCommand(Command::MemoryAccessControl, {Rotation});
+        WriteCommand(Command::DisplayOn);
+    }
+
+    ILI9341_TEMPLATE_ARGS
+    void ILI9341_TEMPLATE_QUALIFIER::SetWindow(uint16_t x, uint16_t y, uint16_t width, uint16_t height)
+    {
+        uint16_t x1 = x + width - 1;
+        uint16_t y1 = y + height - 1;
+        WriteCommand(Command::ColumnAddressSet, {static_cast<uint8_t>(x >> 8), static_cast<uint8_t>(x), static_cast<uint8_t>(x1 >> 8), static_cast<uint8_t>(x1)});
+        WriteCommand(Command::PageAddressSet, {static_cast<uint8_t>(y >> 8), static_cast<uint8_t>(y), static_cast<uint8_t>(y1 >> 8), static_cast<uint8_t>(y1)});
+        WriteCommand(Command::MemoryWrite);
+    }
+
+    ILI9341_TEMPLATE_ARGS
+    void ILI9341_TEMPLATE_QUALIFIER::WritePixels(const uint16_t* pixels, size_t count)
+    {
+        if constexpr (WideBus)
+        {
+            _Bus::WriteData(pixels, count);
+        }
+        else
+        {
+            // 8-bit bus: high byte first
+            for(size_t i = 0; i < count; ++i)
+            {
+                _Bus::WriteData(pixels[i] >> 8);
+                _Bus::WriteData(pixels[i] & 0xff);
+            }
+        }
+    }
+
+    ILI9341_TEMPLATE_ARGS
+    void ILI9341_TEMPLATE_QUALIFIER::DrawPixel(uint16_t x, uint16_t y, uint16_t color)
+    {
+        if(x >= _Width || y >= _Height)
+            return;
+
+        SetWindow(x, y, 1, 1);
+        WritePixels(&color, 1);
+    }
+
+    ILI9341_TEMPLATE_ARGS
+    void ILI9341_TEMPLATE_QUALIFIER::FillRectangle(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t color)
+    {
+        if(x >= _Width || y >= _Height)
+            return;
+        if(x + width > _Width)
+            width = _Width - x;
+        if(y + height > _Height)
+            height = _Height - y;
+
+        SetWindow(x, y, width, height);
+        size_t count = static_cast<size_t>(width) * height;
+        if constexpr (WideBus)
+        {
+            _Bus::Fill(color, count);
+        }
+        else
+        {
+            if((color >> 8) == (color & 0xff))
+            {
+                _Bus::Fill(color & 0xff, count * 2);
+            }
+            else
+            {
+                for(size_t i = 0; i < count; ++i)
+                    WritePixels(&color, 1);
+            }
+        }
+    }
+
+    ILI9341_TEMPLATE_ARGS
+    void ILI9341_TEMPLATE_QUALIFIER::Fill(uint16_t color)
+    {
+        FillRectangle(0, 0, _Width, _Height, color);
+    }
+
+    ILI9341_TEMPLATE_ARGS
+    void ILI9341_TEMPLATE_QUALIFIER::FillArea(int x, int y, int width, int height, uint16_t color)
+    {
+        FillRectangle(x, y, width, height, color);
+    }
+
+    ILI9341_TEMPLATE_ARGS
+    void ILI9341_TEMPLATE_QUALIFIER::FillSpan(int x, int y, int length, uint16_t color)
+    {
+        FillRectangle(x, y, length, 1, color);
+    }
+
+    ILI9341_TEMPLATE_ARGS
+    void ILI9341_TEMPLATE_QUALIFIER::DrawImage(uint16_t x, uint16_t y, uint16_t width, uint16_t height, const uint16_t* image)
+    {
+        if(x + width > _Width || y + height > _Height)
+            return;
+
+        SetWindow(x, y, width, height);
+        WritePixels(image, static_cast<size_t>(width) * height);
+    }
+
+    ILI9341_TEMPLATE_ARGS
+    void ILI9341_TEMPLATE_QUALIFIER::WriteFramebuffer(const uint16_t* framebuffer)
+    {
+        DrawImage(0, 0, _Width, _Height, framebuffer);
+    }
+
+    ILI9341_TEMPLATE_ARGS
+    template<typename _DmaChannel>
+    void ILI9341_TEMPLATE_QUALIFIER::WriteFramebufferAsync(const uint16_t* framebuffer, TransferCallback callback)
+    {
+        static_assert(WideBus, "DMA framebuffer transfer requires 16-bit bus");
+
+        while(_dmaBusy)
+            continue;
+
+        _dmaBusy = true;
+        _dmaData = framebuffer;
+        _dmaRemaining = static_cast<uint32_t>(_Width) * _Height;
+        _dmaCallback = callback;
+        SetWindow(0, 0, _Width, _Height);
+        NextChunk<_DmaChannel>();
+    }
+
+    ILI9341_TEMPLATE_ARGS
+    bool ILI9341_TEMPLATE_QUALIFIER::Busy()
+    {
+        return _dmaBusy;
+    }
+
+    ILI9341_TEMPLATE_ARGS
+    void ILI9341_TEMPLATE_QUALIFIER::WriteCommand(Command command)
+    {
+        _Bus::WriteCommand(static_cast<uint8_t>(command));
+    }
+
+    ILI9341_TEMPLATE_ARGS
+    void ILI9341_TEMPLATE_QUALIFIER::WriteCommand(Command command, std::initializer_list<uint8_t> parameters)
+    {
+        _Bus::WriteCommand(static_cast<uint8_t>(command));
+        for(uint8_t parameter : parameters)
+            _Bus::WriteData(parameter);
+    }
+
+    ILI9341_TEMPLATE_ARGS
+    template<typename _DmaChannel>
+    void ILI9341_TEMPLATE_QUALIFIER::NextChunk()
+    {
+        uint16_t chunk = _dmaRemaining > MaxDmaTransfer ? MaxDmaTransfer : _dmaRemaining;
+        const uint16_t* data = _dmaData;
+        _dmaData += chunk;
+        _dmaRemaining -= chunk;
+
+        _Bus::template WriteDataAsync<_DmaChannel>(data, chunk, [](void*, unsigned, bool success){
+            if(success && _dmaRemaining > 0)
+            {
+                NextChunk<_DmaChannel>();
+                return;
+            }
+
+            _dmaBusy = false;
+            uint32_t sent = static_cast<uint32_t>(_Width) * _Height - _dmaRemaining;
+            if(_dmaCallback)
+                _dmaCallback(const_cast<uint16_t*>(_dmaData - sent), sent * sizeof(uint16_t), success);
+        });
+    }
+}
+
+#endif //! ZHELE_DRIVERS_ILI9341_IMPL_H
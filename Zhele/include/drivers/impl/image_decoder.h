@@ -0,0 +1,212 @@
+/**
+ * @file
+ * Image decoders methods implementation
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DRIVERS_IMAGE_DECODER_IMPL_H
+#define ZHELE_DRIVERS_IMAGE_DECODER_IMPL_H
+
+namespace Zhele::Drivers
+{
+    namespace Private
+    {
+        inline uint16_t ReadLe16(const uint8_t* data)
+        {
+            return static_cast<uint16_t>(data[0] | (data[1] << 8));
+        }
+
+        inline uint32_t ReadLe32(const uint8_t* data)
+        {
+            return data[0] | (data[1] << 8) | (data[2] << 16) | (static_cast<uint32_t>(data[3]) << 24);
+        }
+    }
+
+    template<typename _Source, unsigned _BufferSize>
+    bool BmpDecoder<_Source, _BufferSize>::Open()
+    {
+        // File header (14 bytes) and BITMAPINFOHEADER fields up to compression
+        uint8_t header[34];
+        if(_source(0, header, sizeof(header)) != sizeof(header) || header[0] != 'B' || header[1] != 'M')
+            return false;
+
+        _dataOffset = Private::ReadLe32(&header[10]);
+        int32_t width = static_cast<int32_t>(Private::ReadLe32(&header[18]));
+        int32_t height = static_cast<int32_t>(Private::ReadLe32(&header[22]));
+        uint16_t bitsPerPixel = Private::ReadLe16(&header[28]);
+        uint32_t compression = Private::ReadLe32(&header[30]);
+
+        if(width <= 0 || width > 0xffff || height == 0 || height > 0xffff || height < -0xffff)
+            return false;
+
+        if(bitsPerPixel == 24 && compression == 0)
+        {
+            _rgb555 = false;
+        }
+        else if(bitsPerPixel == 16 && compression == 0)
+        {
+            _rgb555 = true;
+        }
+        else if(bitsPerPixel == 16 && compression == 3)
+        {
+            // Red mask follows info header: only RGB565 is supported
+            uint8_t mask[4];
+            if(_source(54, mask, sizeof(mask)) != sizeof(mask) || Private::ReadLe32(mask) != 0xf800)
+                return false;
+            _rgb555 = false;
+        }
+        else
+        {
+            return false;
+        }
+
+        _bytesPerPixel = bitsPerPixel / 8;
+        _width = static_cast<uint16_t>(width);
+        _bottomUp = height > 0;
+        _height = static_cast<uint16_t>(height > 0 ? height : -height);
+        // Rows are aligned to 4 bytes
+        _stride = (static_cast<uint32_t>(_width) * _bytesPerPixel + 3) & ~3u;
+        _row = 0;
+        _column = 0;
+
+        return true;
+    }
+
+    template<typename _Source, unsigned _BufferSize>
+    unsigned BmpDecoder<_Source, _BufferSize>::Decode(uint16_t* pixels, unsigned count)
+    {
+        unsigned produced = 0;
+        while(produced < count && _row < _height)
+        {
+            unsigned chunk = count - produced;
+            if(chunk > static_cast<unsigned>(_width - _column))
+                chunk = _width - _column;
+            if(chunk > _BufferSize / _bytesPerPixel)
+                chunk = _BufferSize / _bytesPerPixel;
+
+            uint32_t fileRow = _bottomUp ? _height - 1 - _row : _row;
+            unsigned size = chunk * _bytesPerPixel;
+            if(_source(_dataOffset + fileRow * _stride + _column * _bytesPerPixel, _buffer, size) != size)
+                break;
+
+            const uint8_t* data = _buffer;
+            uint16_t* output = &pixels[produced];
+            if(_bytesPerPixel == 3)
+            {
+                // B, G, R
+                for(unsigned i = 0; i < chunk; ++i, data += 3)
+                    output[i] = static_cast<uint16_t>(((data[2] & 0xf8) << 8) | ((data[1] & 0xfc) << 3) | (data[0] >> 3));
+            }
+            else if(_rgb555)
+            {
+                for(unsigned i = 0; i < chunk; ++i, data += 2)
+                {
+                    uint16_t value = Private::ReadLe16(data);
+                    output[i] = static_cast<uint16_t>(((value & 0x7fe0) << 1) | (value & 0x001f));
+                }
+            }
+            else
+            {
+                for(unsigned i = 0; i < chunk; ++i, data += 2)
+                    output[i] = Private::ReadLe16(data);
+            }
+
+            produced += chunk;
+            _column += chunk;
+            if(_column == _width)
+            {
+                _column = 0;
+                ++_row;
+            }
+        }
+        return produced;
+    }
+
+    template<typename _Source, unsigned _BufferSize>
+    bool RleDecoder<_Source, _BufferSize>::Open()
+    {
+        _offset = 0;
+        _size = 0;
+        _position = 0;
+        _runLeft = 0;
+        _pixelsLeft = 0;
+
+        uint8_t header[6];
+        for(uint8_t& value : header)
+        {
+            if(!ReadByte(value))
+                return false;
+        }
+        if(header[0] != 'R' || header[1] != 'L')
+            return false;
+
+        _width = Private::ReadLe16(&header[2]);
+        _height = Private::ReadLe16(&header[4]);
+        _pixelsLeft = static_cast<uint32_t>(_width) * _height;
+        return _pixelsLeft != 0;
+    }
+
+    template<typename _Source, unsigned _BufferSize>
+    unsigned RleDecoder<_Source, _BufferSize>::Decode(uint16_t* pixels, unsigned count)
+    {
+        unsigned produced = 0;
+        while(produced < count && _pixelsLeft > 0)
+        {
+            if(_runLeft == 0)
+            {
+                uint8_t control;
+                if(!ReadByte(control))
+                    break;
+                _repeat = (control & 0x80) != 0;
+                _runLeft = (control & 0x7f) + 1;
+                if(_repeat && !ReadPixel(_color))
+                    break;
+            }
+
+            if(_repeat)
+            {
+                for(; _runLeft > 0 && produced < count && _pixelsLeft > 0; --_runLeft, --_pixelsLeft)
+                    pixels[produced++] = _color;
+            }
+            else
+            {
+                if(!ReadPixel(pixels[produced]))
+                    break;
+                ++produced;
+                --_runLeft;
+                --_pixelsLeft;
+            }
+        }
+        return produced;
+    }
+
+    template<typename _Source, unsigned _BufferSize>
+    bool RleDecoder<_Source, _BufferSize>::ReadByte(uint8_t& value)
+    {
+        if(_position == _size)
+        {
+            _size = _source(_offset, _buffer, _BufferSize);
+            _offset += _size;
+            _position = 0;
+            if(_size == 0)
+                return false;
+        }
+        value = _buffer[_position++];
+        return true;
+    }
+
+    template<typename _Source, unsigned _BufferSize>
+    bool RleDecoder<_Source, _BufferSize>::ReadPixel(uint16_t& pixel)
+    {
+        uint8_t data[2];
+        if(!ReadByte(data[0]) || !ReadByte(data[1]))
+            return false;
+        pixel = Private::ReadLe16(data);
+        return true;
+    }
+}
+
+#endif //! ZHELE_DRIVERS_IMAGE_DECODER_IMPL_H
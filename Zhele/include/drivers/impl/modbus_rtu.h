@@ -0,0 +1,678 @@
+/**
+ * @file
+ * Modbus RTU methods implementation
+ *
+ * @author Alexey Zhelonkin
+ * @date 2023
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DRIVERS_MODBUS_RTU_IMPL_H
+#define ZHELE_DRIVERS_MODBUS_RTU_IMPL_H
+
+namespace Zhele::Drivers
+{
+    namespace Private
+    {
+        #define MODBUSTRANSPORT_TEMPLATE_ARGS template<typename _Rs485, typename _Timer, typename _Owner>
+        #define MODBUSTRANSPORT_TEMPLATE_QUALIFIER ModbusRtuTransport<_Rs485, _Timer, _Owner>
+
+        MODBUSTRANSPORT_TEMPLATE_ARGS
+        void MODBUSTRANSPORT_TEMPLATE_QUALIFIER::Init(unsigned baud)
+        {
+            // Character is 11 bits (start, 8 data, parity or second stop, stop),
+            // inter-frame delay is fixed for baud rates more than 19200
+            unsigned characterTime = 11000000u / baud;
+            unsigned frameGap = baud > 19200 ? 1750u : characterTime * 7 / 2;
+
+            _Rs485::Init(baud);
+            _Rs485::EnableStreamRead(_rxBuffer, sizeof(_rxBuffer), nullptr);
+
+            if constexpr (UseTimer)
+            {
+                // Idle line event occurs after one character time, timer counts the rest of t3.5
+                _frameGapMicroseconds = frameGap > characterTime ? frameGap - characterTime : 1;
+                _Timer::Enable();
+                _Timer::SetPrescaler(_Timer::GetClockFreq() / 1000000u - 1);
+                _Timer::SetPeriod(_frameGapMicroseconds);
+                _Timer::EnableInterrupt();
+            }
+            else if constexpr (UseReceiverTimeout)
+            {
+                // Receiver timeout is in bit durations
+                _Rs485::EnableReceiverTimeout(static_cast<uint32_t>(static_cast<uint64_t>(frameGap) * baud / 1000000u));
+            }
+        }
+
+        MODBUSTRANSPORT_TEMPLATE_ARGS
+        void MODBUSTRANSPORT_TEMPLATE_QUALIFIER::IrqHandler()
+        {
+            bool idle = (_Rs485::InterruptSource() & _Rs485::IdleInt) != 0;
+            bool frameEnd = false;
+
+            if constexpr (UseReceiverTimeout)
+                frameEnd = _Rs485::ReceiverTimeout();
+
+            // Direction switch (transmission complete) and idle flag clear
+            _Rs485::IrqHandler();
+
+            if(idle && !UseReceiverTimeout)
+            {
+                if constexpr (UseTimer)
+                {
+                    // Idle line while waiting for t3.5 means gap inside frame
+                    if(_timerActive)
+                        _gapError = true;
+                    RestartTimer();
+                }
+                else
+                {
+                    frameEnd = true;
+                }
+            }
+
+            if(frameEnd)
+                FrameEnd();
+        }
+
+        MODBUSTRANSPORT_TEMPLATE_ARGS
+        void MODBUSTRANSPORT_TEMPLATE_QUALIFIER::TimerIrqHandler()
+        {
+            if constexpr (UseTimer)
+            {
+                if(!_Timer::IsInterrupt())
+                    return;
+                _Timer::ClearInterruptFlag();
+                _timerActive = false;
+
+                if(_gapError)
+                {
+                    _gapError = false;
+                    _Rs485::StreamConsume(_Rs485::StreamAvailable());
+                    return;
+                }
+                FrameEnd();
+            }
+        }
+
+        MODBUSTRANSPORT_TEMPLATE_ARGS
+        bool MODBUSTRANSPORT_TEMPLATE_QUALIFIER::Send(uint8_t* frame, unsigned size)
+        {
+            if(_transmitting)
+                return false;
+
+            // CRC is transmitted low byte first
+            uint16_t crc = Crc16Modbus::Calculate(frame, size);
+            frame[size] = static_cast<uint8_t>(crc);
+            frame[size + 1] = static_cast<uint8_t>(crc >> 8);
+
+            _transmitting = true;
+            _Rs485::WriteAsync(frame, size + 2, TransmitComplete);
+            return true;
+        }
+
+        MODBUSTRANSPORT_TEMPLATE_ARGS
+        bool MODBUSTRANSPORT_TEMPLATE_QUALIFIER::Transmitting()
+        {
+            return _transmitting;
+        }
+
+        MODBUSTRANSPORT_TEMPLATE_ARGS
+        void MODBUSTRANSPORT_TEMPLATE_QUALIFIER::FrameEnd()
+        {
+            unsigned size = _Rs485::StreamRead(_frame, sizeof(_frame));
+
+            // Too long frame or own transmission echo
+            if(_Rs485::StreamAvailable() > 0 || _transmitting)
+            {
+                _Rs485::StreamConsume(_Rs485::StreamAvailable());
+                return;
+            }
+            if(size < 4)
+                return;
+
+            uint16_t crc = Crc16Modbus::Calculate(_frame, size - 2);
+            if(crc != (_frame[size - 2] | (_frame[size - 1] << 8)))
+                return;
+
+            _Owner::OnFrame(_frame, size - 2);
+        }
+
+        MODBUSTRANSPORT_TEMPLATE_ARGS
+        void MODBUSTRANSPORT_TEMPLATE_QUALIFIER::TransmitComplete()
+        {
+            // Line is released, drop anything received during transmission
+            _Rs485::StreamConsume(_Rs485::StreamAvailable());
+            _transmitting = false;
+            _Owner::OnTransmitComplete();
+        }
+
+        MODBUSTRANSPORT_TEMPLATE_ARGS
+        void MODBUSTRANSPORT_TEMPLATE_QUALIFIER::RestartTimer()
+        {
+            if constexpr (UseTimer)
+            {
+                // Stop clears one pulse mode
+                _Timer::Stop();
+                _Timer::EnableOnePulseMode();
+                _timerActive = true;
+                _Timer::Start();
+            }
+        }
+
+        MODBUSTRANSPORT_TEMPLATE_ARGS
+        uint8_t MODBUSTRANSPORT_TEMPLATE_QUALIFIER::_rxBuffer[MaxFrameSize + 1];
+        MODBUSTRANSPORT_TEMPLATE_ARGS
+        uint8_t MODBUSTRANSPORT_TEMPLATE_QUALIFIER::_frame[MaxFrameSize];
+        MODBUSTRANSPORT_TEMPLATE_ARGS
+        uint16_t MODBUSTRANSPORT_TEMPLATE_QUALIFIER::_frameGapMicroseconds = 0;
+        MODBUSTRANSPORT_TEMPLATE_ARGS
+        volatile bool MODBUSTRANSPORT_TEMPLATE_QUALIFIER::_transmitting = false;
+        MODBUSTRANSPORT_TEMPLATE_ARGS
+        volatile bool MODBUSTRANSPORT_TEMPLATE_QUALIFIER::_timerActive = false;
+        MODBUSTRANSPORT_TEMPLATE_ARGS
+        volatile bool MODBUSTRANSPORT_TEMPLATE_QUALIFIER::_gapError = false;
+
+        inline uint16_t ModbusWord(const uint8_t* data)
+        {
+            return static_cast<uint16_t>((data[0] << 8) | data[1]);
+        }
+
+        inline void ModbusPutWord(uint8_t* data, uint16_t value)
+        {
+            data[0] = static_cast<uint8_t>(value >> 8);
+            data[1] = static_cast<uint8_t>(value);
+        }
+    }
+
+    #define MODBUSSLAVE_TEMPLATE_ARGS template<typename _Rs485, typename _Timer>
+    #define MODBUSSLAVE_TEMPLATE_QUALIFIER ModbusRtuSlave<_Rs485, _Timer>
+
+    MODBUSSLAVE_TEMPLATE_ARGS
+    void MODBUSSLAVE_TEMPLATE_QUALIFIER::Init(unsigned baud, uint8_t address, const ModbusRegisterMap* map)
+    {
+        _address = address;
+        _map = map;
+        Transport::Init(baud);
+    }
+
+    MODBUSSLAVE_TEMPLATE_ARGS
+    void MODBUSSLAVE_TEMPLATE_QUALIFIER::SetAddress(uint8_t address)
+    {
+        _address = address;
+    }
+
+    MODBUSSLAVE_TEMPLATE_ARGS
+    void MODBUSSLAVE_TEMPLATE_QUALIFIER::IrqHandler()
+    {
+        Transport::IrqHandler();
+    }
+
+    MODBUSSLAVE_TEMPLATE_ARGS
+    void MODBUSSLAVE_TEMPLATE_QUALIFIER::TimerIrqHandler()
+    {
+        Transport::TimerIrqHandler();
+    }
+
+    MODBUSSLAVE_TEMPLATE_ARGS
+    void MODBUSSLAVE_TEMPLATE_QUALIFIER::OnFrame(const uint8_t* frame, unsigned size)
+    {
+        uint8_t address = frame[0];
+        if(address != _address && address != 0)
+            return;
+
+        ModbusException exception = ModbusException::None;
+        unsigned length = Process(frame + 1, size - 1, _response + 1, exception);
+
+        // Broadcast request has no response
+        if(address == 0)
+            return;
+
+        _response[0] = _address;
+        if(exception != ModbusException::None)
+        {
+            _response[1] = frame[1] | 0x80;
+            _response[2] = static_cast<uint8_t>(exception);
+            length = 2;
+        }
+        Transport::Send(_response, length + 1);
+    }
+
+    MODBUSSLAVE_TEMPLATE_ARGS
+    unsigned MODBUSSLAVE_TEMPLATE_QUALIFIER::Process(const uint8_t* request, unsigned size, uint8_t* response, ModbusException& exception)
+    {
+        // All supported requests have function code, address and quantity (or value)
+        if(size < 5)
+        {
+            exception = ModbusException::IllegalDataValue;
+            return 0;
+        }
+
+        ModbusFunction function = static_cast<ModbusFunction>(request[0]);
+        response[0] = request[0];
+
+        switch(function)
+        {
+        case ModbusFunction::ReadCoils:
+            return ReadBits(_map->Coils, _map->CoilsBlocks, request, response, exception);
+        case ModbusFunction::ReadDiscreteInputs:
+            return ReadBits(_map->DiscreteInputs, _map->DiscreteInputsBlocks, request, response, exception);
+        case ModbusFunction::ReadHoldingRegisters:
+            return ReadRegisters(_map->HoldingRegisters, _map->HoldingRegistersBlocks, request, response, exception);
+        case ModbusFunction::ReadInputRegisters:
+            return ReadRegisters(_map->InputRegisters, _map->InputRegistersBlocks, request, response, exception);
+        case ModbusFunction::WriteSingleCoil:
+        {
+            uint16_t address = Private::ModbusWord(request + 1);
+            uint16_t value = Private::ModbusWord(request + 3);
+            if(value != 0xff00 && value != 0x0000)
+            {
+                exception = ModbusException::IllegalDataValue;
+                return 0;
+            }
+            const ModbusBitBlock* block = FindBlock(_map->Coils, _map->CoilsBlocks, address, 1);
+            if(block == nullptr)
+            {
+                exception = ModbusException::IllegalDataAddress;
+                return 0;
+            }
+            unsigned bit = address - block->Address;
+            if(value)
+                block->Data[bit / 8] |= (1 << (bit % 8));
+            else
+                block->Data[bit / 8] &= ~(1 << (bit % 8));
+            break;
+        }
+        case ModbusFunction::WriteSingleRegister:
+        {
+            uint16_t address = Private::ModbusWord(request + 1);
+            const ModbusRegisterBlock* block = FindBlock(_map->HoldingRegisters, _map->HoldingRegistersBlocks, address, 1);
+            if(block == nullptr)
+            {
+                exception = ModbusException::IllegalDataAddress;
+                return 0;
+            }
+            block->Data[address - block->Address] = Private::ModbusWord(request + 3);
+            break;
+        }
+        case ModbusFunction::WriteMultipleCoils:
+            return WriteCoils(request, size, response, exception);
+        case ModbusFunction::WriteMultipleRegisters:
+            return WriteRegisters(request, size, response, exception);
+        default:
+            exception = ModbusException::IllegalFunction;
+            return 0;
+        }
+
+        // Single write response is request echo
+        if(_map->OnWrite != nullptr)
+        {
+            exception = _map->OnWrite(function, Private::ModbusWord(request + 1), 1);
+            if(exception != ModbusException::None)
+                return 0;
+        }
+        for(unsigned i = 1; i < 5; ++i)
+            response[i] = request[i];
+        return 5;
+    }
+
+    MODBUSSLAVE_TEMPLATE_ARGS
+    unsigned MODBUSSLAVE_TEMPLATE_QUALIFIER::ReadBits(const ModbusBitBlock* blocks, uint8_t count, const uint8_t* request, uint8_t* response, ModbusException& exception)
+    {
+        uint16_t address = Private::ModbusWord(request + 1);
+        uint16_t quantity = Private::ModbusWord(request + 3);
+        if(quantity < 1 || quantity > 2000)
+        {
+            exception = ModbusException::IllegalDataValue;
+            return 0;
+        }
+        const ModbusBitBlock* block = FindBlock(blocks, count, address, quantity);
+        if(block == nullptr)
+        {
+            exception = ModbusException::IllegalDataAddress;
+            return 0;
+        }
+
+        unsigned bytes = (quantity + 7) / 8;
+        unsigned offset = address - block->Address;
+        response[1] = static_cast<uint8_t>(bytes);
+        for(unsigned i = 0; i < bytes; ++i)
+            response[2 + i] = 0;
+        for(unsigned i = 0; i < quantity; ++i)
+        {
+            unsigned bit = offset + i;
+            if(block->Data[bit / 8] & (1 << (bit % 8)))
+                response[2 + i / 8] |= (1 << (i % 8));
+        }
+        return 2 + bytes;
+    }
+
+    MODBUSSLAVE_TEMPLATE_ARGS
+    unsigned MODBUSSLAVE_TEMPLATE_QUALIFIER::ReadRegisters(const ModbusRegisterBlock* blocks, uint8_t count, const uint8_t* request, uint8_t* response, ModbusException& exception)
+    {
+        uint16_t address = Private::ModbusWord(request + 1);
+        uint16_t quantity = Private::ModbusWord(request + 3);
+        if(quantity < 1 || quantity > 125)
+        {
+            exception = ModbusException::IllegalDataValue;
+            return 0;
+        }
+        const ModbusRegisterBlock* block = FindBlock(blocks, count, address, quantity);
+        if(block == nullptr)
+        {
+            exception = ModbusException::IllegalDataAddress;
+            return 0;
+        }
+
+        const uint16_t* data = block->Data + (address - block->Address);
+        response[1] = static_cast<uint8_t>(quantity * 2);
+        for(unsigned i = 0; i < quantity; ++i)
+            Private::ModbusPutWord(response + 2 + 2 * i, data[i]);
+        return 2 + 2 * quantity;
+    }
+
+    MODBUSSLAVE_TEMPLATE_ARGS
+    unsigned MODBUSSLAVE_TEMPLATE_QUALIFIER::WriteCoils(const uint8_t* request, unsigned size, uint8_t* response, ModbusException& exception)
+    {
+        uint16_t address = Private::ModbusWord(request + 1);
+        uint16_t quantity = Private::ModbusWord(request + 3);
+        if(size < 6 || quantity < 1 || quantity > 1968 || request[5] != (quantity + 7) / 8 || size < 6u + request[5])
+        {
+            exception = ModbusException::IllegalDataValue;
+            return 0;
+        }
+        const ModbusBitBlock* block = FindBlock(_map->Coils, _map->CoilsBlocks, address, quantity);
+        if(block == nullptr)
+        {
+            exception = ModbusException::IllegalDataAddress;
+            return 0;
+        }
+
+        unsigned offset = address - block->Address;
+        for(unsigned i = 0; i < quantity; ++i)
+        {
+            unsigned bit = offset + i;
+            if(request[6 + i / 8] & (1 << (i % 8)))
+                block->Data[bit / 8] |= (1 << (bit % 8));
+            else
+                block->Data[bit / 8] &= ~(1 << (bit % 8));
+        }
+
+        if(_map->OnWrite != nullptr)
+        {
+            exception = _map->OnWrite(ModbusFunction::WriteMultipleCoils, address, quantity);
+            if(exception != ModbusException::None)
+                return 0;
+        }
+        for(unsigned i = 1; i < 5; ++i)
+            response[i] = request[i];
+        return 5;
+    }
+
+    MODBUSSLAVE_TEMPLATE_ARGS
+    unsigned MODBUSSLAVE_TEMPLATE_QUALIFIER::WriteRegisters(const uint8_t* request, unsigned size, uint8_t* response, ModbusException& exception)
+    {
+        uint16_t address = Private::ModbusWord(request + 1);
+        uint16_t quantity = Private::ModbusWord(request + 3);
+        if(size < 6 || quantity < 1 || quantity > 123 || request[5] != quantity * 2 || size < 6u + request[5])
+        {
+            exception = ModbusException::IllegalDataValue;
+            return 0;
+        }
+        const ModbusRegisterBlock* block = FindBlock(_map->HoldingRegisters, _map->HoldingRegistersBlocks, address, quantity);
+        if(block == nullptr)
+        {
+            exception = ModbusException::IllegalDataAddress;
+            return 0;
+        }
+
+        uint16_t* data = block->Data + (address - block->Address);
+        for(unsigned i = 0; i < quantity; ++i)
+            data[i] = Private::ModbusWord(request + 6 + 2 * i);
+
+        if(_map->OnWrite != nullptr)
+        {
+            exception = _map->OnWrite(ModbusFunction::WriteMultipleRegisters, address, quantity);
+            if(exception != ModbusException::None)
+                return 0;
+        }
+        for(unsigned i = 1; i < 5; ++i)
+            response[i] = request[i];
+        return 5;
+    }
+
+    MODBUSSLAVE_TEMPLATE_ARGS
+    template<typename _Block>
+    const _Block* MODBUSSLAVE_TEMPLATE_QUALIFIER::FindBlock(const _Block* blocks, uint8_t count, uint16_t address, uint16_t quantity)
+    {
+        for(uint8_t i = 0; i < count; ++i)
+        {
+            const _Block& block = blocks[i];
+            if(address >= block.Address && static_cast<uint32_t>(address) + quantity <= static_cast<uint32_t>(block.Address) + block.Count)
+                return &block;
+        }
+        return nullptr;
+    }
+
+    MODBUSSLAVE_TEMPLATE_ARGS
+    uint8_t MODBUSSLAVE_TEMPLATE_QUALIFIER::_address = 0;
+    MODBUSSLAVE_TEMPLATE_ARGS
+    const ModbusRegisterMap* MODBUSSLAVE_TEMPLATE_QUALIFIER::_map = nullptr;
+    MODBUSSLAVE_TEMPLATE_ARGS
+    uint8_t MODBUSSLAVE_TEMPLATE_QUALIFIER::_response[MODBUSSLAVE_TEMPLATE_QUALIFIER::Transport::MaxFrameSize];
+
+    #define MODBUSMASTER_TEMPLATE_ARGS template<typename _Rs485, typename _Timer>
+    #define MODBUSMASTER_TEMPLATE_QUALIFIER ModbusRtuMaster<_Rs485, _Timer>
+
+    MODBUSMASTER_TEMPLATE_ARGS
+    void MODBUSMASTER_TEMPLATE_QUALIFIER::Init(unsigned baud)
+    {
+        Transport::Init(baud);
+    }
+
+    MODBUSMASTER_TEMPLATE_ARGS
+    bool MODBUSMASTER_TEMPLATE_QUALIFIER::ReadRegisters(uint8_t slave, ModbusFunction function, uint16_t address, uint16_t count, uint16_t* values, Callback callback)
+    {
+        if(count < 1 || count > 125 || (function != ModbusFunction::ReadHoldingRegisters && function != ModbusFunction::ReadInputRegisters))
+            return false;
+        if(_busy)
+            return false;
+
+        _request[0] = slave;
+        _request[1] = static_cast<uint8_t>(function);
+        Private::ModbusPutWord(_request + 2, address);
+        Private::ModbusPutWord(_request + 4, count);
+        _output = values;
+        return Start(6, callback);
+    }
+
+    MODBUSMASTER_TEMPLATE_ARGS
+    bool MODBUSMASTER_TEMPLATE_QUALIFIER::ReadBits(uint8_t slave, ModbusFunction function, uint16_t address, uint16_t count, uint8_t* bits, Callback callback)
+    {
+        if(count < 1 || count > 2000 || (function != ModbusFunction::ReadCoils && function != ModbusFunction::ReadDiscreteInputs))
+            return false;
+        if(_busy)
+            return false;
+
+        _request[0] = slave;
+        _request[1] = static_cast<uint8_t>(function);
+        Private::ModbusPutWord(_request + 2, address);
+        Private::ModbusPutWord(_request + 4, count);
+        _output = bits;
+        return Start(6, callback);
+    }
+
+    MODBUSMASTER_TEMPLATE_ARGS
+    bool MODBUSMASTER_TEMPLATE_QUALIFIER::WriteRegister(uint8_t slave, uint16_t address, uint16_t value, Callback callback)
+    {
+        if(_busy)
+            return false;
+
+        _request[0] = slave;
+        _request[1] = static_cast<uint8_t>(ModbusFunction::WriteSingleRegister);
+        Private::ModbusPutWord(_request + 2, address);
+        Private::ModbusPutWord(_request + 4, value);
+        return Start(6, callback);
+    }
+
+    MODBUSMASTER_TEMPLATE_ARGS
+    bool MODBUSMASTER_TEMPLATE_QUALIFIER::WriteRegisters(uint8_t slave, uint16_t address, uint16_t count, const uint16_t* values, Callback callback)
+    {
+        if(count < 1 || count > 123)
+            return false;
+        if(_busy)
+            return false;
+
+        _request[0] = slave;
+        _request[1] = static_cast<uint8_t>(ModbusFunction::WriteMultipleRegisters);
+        Private::ModbusPutWord(_request + 2, address);
+        Private::ModbusPutWord(_request + 4, count);
+        _request[6] = static_cast<uint8_t>(count * 2);
+        for(unsigned i = 0; i < count; ++i)
+            Private::ModbusPutWord(_request + 7 + 2 * i, values[i]);
+        return Start(7 + 2 * count, callback);
+    }
+
+    MODBUSMASTER_TEMPLATE_ARGS
+    bool MODBUSMASTER_TEMPLATE_QUALIFIER::WriteCoil(uint8_t slave, uint16_t address, bool value, Callback callback)
+    {
+        if(_busy)
+            return false;
+
+        _request[0] = slave;
+        _request[1] = static_cast<uint8_t>(ModbusFunction::WriteSingleCoil);
+        Private::ModbusPutWord(_request + 2, address);
+        Private::ModbusPutWord(_request + 4, value ? 0xff00 : 0x0000);
+        return Start(6, callback);
+    }
+
+    MODBUSMASTER_TEMPLATE_ARGS
+    bool MODBUSMASTER_TEMPLATE_QUALIFIER::Busy()
+    {
+        return _busy;
+    }
+
+    MODBUSMASTER_TEMPLATE_ARGS
+    void MODBUSMASTER_TEMPLATE_QUALIFIER::Cancel()
+    {
+        if(_busy)
+            Complete(ModbusStatus::Canceled);
+    }
+
+    MODBUSMASTER_TEMPLATE_ARGS
+    void MODBUSMASTER_TEMPLATE_QUALIFIER::IrqHandler()
+    {
+        Transport::IrqHandler();
+    }
+
+    MODBUSMASTER_TEMPLATE_ARGS
+    void MODBUSMASTER_TEMPLATE_QUALIFIER::TimerIrqHandler()
+    {
+        Transport::TimerIrqHandler();
+    }
+
+    MODBUSMASTER_TEMPLATE_ARGS
+    void MODBUSMASTER_TEMPLATE_QUALIFIER::OnFrame(const uint8_t* frame, unsigned size)
+    {
+        // Frames from other slaves (or without request) are ignored
+        if(!_busy || frame[0] != _request[0])
+            return;
+
+        if(frame[1] == (_request[1] | 0x80))
+        {
+            Complete(size >= 3 ? ModbusStatus::Exception : ModbusStatus::InvalidResponse,
+                size >= 3 ? static_cast<ModbusException>(frame[2]) : ModbusException::None);
+            return;
+        }
+        if(frame[1] != _request[1])
+        {
+            Complete(ModbusStatus::InvalidResponse);
+            return;
+        }
+
+        uint16_t count = Private::ModbusWord(_request + 4);
+        switch(static_cast<ModbusFunction>(_request[1]))
+        {
+        case ModbusFunction::ReadHoldingRegisters:
+        case ModbusFunction::ReadInputRegisters:
+        {
+            if(size != 3u + 2 * count || frame[2] != 2 * count)
+            {
+                Complete(ModbusStatus::InvalidResponse);
+                return;
+            }
+            uint16_t* values = static_cast<uint16_t*>(_output);
+            for(unsigned i = 0; i < count; ++i)
+                values[i] = Private::ModbusWord(frame + 3 + 2 * i);
+            break;
+        }
+        case ModbusFunction::ReadCoils:
+        case ModbusFunction::ReadDiscreteInputs:
+        {
+            unsigned bytes = (count + 7) / 8;
+            if(size != 3 + bytes || frame[2] != bytes)
+            {
+                Complete(ModbusStatus::InvalidResponse);
+                return;
+            }
+            uint8_t* bits = static_cast<uint8_t*>(_output);
+            for(unsigned i = 0; i < bytes; ++i)
+                bits[i] = frame[3 + i];
+            break;
+        }
+        default:
+            // Write response repeats address, function, register address and value (or quantity)
+            for(unsigned i = 2; i < 6; ++i)
+            {
+                if(size != 6 || frame[i] != _request[i])
+                {
+                    Complete(ModbusStatus::InvalidResponse);
+                    return;
+                }
+            }
+            break;
+        }
+        Complete(ModbusStatus::Success);
+    }
+
+    MODBUSMASTER_TEMPLATE_ARGS
+    void MODBUSMASTER_TEMPLATE_QUALIFIER::OnTransmitComplete()
+    {
+        // Broadcast request has no response
+        if(_busy && _request[0] == 0)
+            Complete(ModbusStatus::Success);
+    }
+
+    MODBUSMASTER_TEMPLATE_ARGS
+    bool MODBUSMASTER_TEMPLATE_QUALIFIER::Start(unsigned size, Callback callback)
+    {
+        _callback = callback;
+        _busy = true;
+        if(!Transport::Send(_request, size))
+        {
+            _busy = false;
+            return false;
+        }
+        return true;
+    }
+
+    MODBUSMASTER_TEMPLATE_ARGS
+    void MODBUSMASTER_TEMPLATE_QUALIFIER::Complete(ModbusStatus status, ModbusException exception)
+    {
+        Callback callback = _callback;
+        _busy = false;
+        if(callback)
+            callback(status, exception);
+    }
+
+    MODBUSMASTER_TEMPLATE_ARGS
+    uint8_t MODBUSMASTER_TEMPLATE_QUALIFIER::_request[MODBUSMASTER_TEMPLATE_QUALIFIER::Transport::MaxFrameSize];
+    MODBUSMASTER_TEMPLATE_ARGS
+    void* MODBUSMASTER_TEMPLATE_QUALIFIER::_output = nullptr;
+    MODBUSMASTER_TEMPLATE_ARGS
+    typename MODBUSMASTER_TEMPLATE_QUALIFIER::Callback MODBUSMASTER_TEMPLATE_QUALIFIER::_callback = nullptr;
+    MODBUSMASTER_TEMPLATE_ARGS
+    volatile bool MODBUSMASTER_TEMPLATE_QUALIFIER::_busy = false;
+}
+
+#endif //! ZHELE_DRIVERS_MODBUS_RTU_IMPL_H
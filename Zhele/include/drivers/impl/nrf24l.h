@@ -0,0 +1,298 @@
+/**
+ * @file
+ * Implements interrupt-driven mode of NRF24L driver
+ *
+ * @author Alexey Zhelonkin
+ * @date 2023
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DRIVERS_NRF24L_IMPL_H
+#define ZHELE_DRIVERS_NRF24L_IMPL_H
+
+#include <string.h>
+
+namespace Zhele::Drivers
+{
+    NRF24L_TEMPLATE_ARGS
+    template<typename _Exti>
+    void NRF24L_TEMPLATE_QUALIFIER::InitIrq(bool dynamicPayload)
+    {
+        static_assert(!std::is_same_v<EXTIPin, IO::NullPin>, "IRQ pin is required for interrupt-driven mode");
+
+        _dynamicPayload = dynamicPayload;
+        WriteRegister(Registers::Feature, dynamicPayload ? (EnableDynamicPayloadLength | EnableAckPayload | EnableDynamicAck) : 0);
+        WriteRegister(Registers::DynamicPayload, dynamicPayload ? 0x3f : 0);
+
+        EXTIPin::Port::Enable();
+        _Exti::template Init<_Exti::Trigger::Falling, typename EXTIPin::Port>();
+        _Exti::template InitPin<EXTIPin>(EXTIPin::PullMode::PullUp);
+        _Exti::EnableInterrupt();
+    }
+
+    NRF24L_TEMPLATE_ARGS
+    void NRF24L_TEMPLATE_QUALIFIER::StartTransmitter()
+    {
+        CEPin::Clear();
+        FlushTx();
+        ClearInterrupts();
+        _inFlight = 0;
+        _receiver = false;
+        WriteRegister(Registers::Configuration, EnableCRC | CRCScheme1Byte | PTX | PowerUp);
+        // CE is held high: module sends packets while TX FIFO is not empty
+        CEPin::Set();
+        Kick(false);
+    }
+
+    NRF24L_TEMPLATE_ARGS
+    void NRF24L_TEMPLATE_QUALIFIER::StartReceiver()
+    {
+        CEPin::Clear();
+        FlushRx();
+        FlushTx();
+        ClearInterrupts();
+        _inFlight = 0;
+        _receiver = true;
+        WriteRegister(Registers::Configuration, EnableCRC | CRCScheme1Byte | PRX | PowerUp);
+        CEPin::Set();
+        Kick(false);
+    }
+
+    NRF24L_TEMPLATE_ARGS
+    bool NRF24L_TEMPLATE_QUALIFIER::Send(const uint8_t* data, uint8_t size, uint8_t pipe)
+    {
+        if(size > MaxPayloadSize || (!_dynamicPayload && size > _payloadSize))
+            return false;
+
+        Packet packet {pipe, _dynamicPayload ? size : _payloadSize, {}};
+        memcpy(packet.Data, data, size);
+        if(!_txQueue.push_back(packet))
+            return false;
+
+        Kick(false);
+        return true;
+    }
+
+    NRF24L_TEMPLATE_ARGS
+    bool NRF24L_TEMPLATE_QUALIFIER::Receive(Packet& packet)
+    {
+        if(_rxQueue.empty())
+            return false;
+
+        packet = _rxQueue.front();
+        _rxQueue.pop_front();
+        return true;
+    }
+
+    NRF24L_TEMPLATE_ARGS
+    unsigned NRF24L_TEMPLATE_QUALIFIER::TxPending()
+    {
+        return _txQueue.size();
+    }
+
+    NRF24L_TEMPLATE_ARGS
+    unsigned NRF24L_TEMPLATE_QUALIFIER::RxAvailable()
+    {
+        return _rxQueue.size();
+    }
+
+    NRF24L_TEMPLATE_ARGS
+    uint32_t NRF24L_TEMPLATE_QUALIFIER::Lost()
+    {
+        return _lost;
+    }
+
+    NRF24L_TEMPLATE_ARGS
+    bool NRF24L_TEMPLATE_QUALIFIER::Busy()
+    {
+        return _busy;
+    }
+
+    NRF24L_TEMPLATE_ARGS
+    void NRF24L_TEMPLATE_QUALIFIER::IrqHandler()
+    {
+        Kick(true);
+    }
+
+    NRF24L_TEMPLATE_ARGS
+    void NRF24L_TEMPLATE_QUALIFIER::QueueTransaction(const void* transmitBuffer, void* receiveBuffer, uint16_t size,
+        typename SpiBus::ChipSelectAction chipSelectAction, TransferCallback callback)
+    {
+        typename SpiBus::Transaction transaction {};
+        transaction.transmitBuffer = transmitBuffer;
+        transaction.receiveBuffer = receiveBuffer;
+        transaction.size = size;
+        transaction.dataSize = SpiBus::DataSize8;
+        transaction.chipSelect = SpiBus::template ActiveLowChipSelect<SSPin>;
+        transaction.chipSelectAction = chipSelectAction;
+        transaction.callback = callback;
+
+        // Service queues at most two transactions at once, so it waits only for foreign transactions
+        while(!SpiBus::QueueTransaction(transaction))
+            continue;
+    }
+
+    NRF24L_TEMPLATE_ARGS
+    void NRF24L_TEMPLATE_QUALIFIER::Kick(bool readStatus)
+    {
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        bool start = !_busy;
+        if(start)
+            _busy = true;
+        else
+            _pending = true;
+        __set_PRIMASK(primask);
+
+        if(!start)
+            return;
+
+        if(readStatus)
+            ReadStatus();
+        else
+            NextStep();
+    }
+
+    NRF24L_TEMPLATE_ARGS
+    void NRF24L_TEMPLATE_QUALIFIER::ReadStatus()
+    {
+        // Write status returns status before clear
+        QueueTransaction(ClearStatusCommand, _response, 2, SpiBus::SelectAndDeselect);
+        QueueTransaction(ReadFifoStatusCommand, _fifoStatus, 2, SpiBus::SelectAndDeselect, OnStatusRead);
+    }
+
+    NRF24L_TEMPLATE_ARGS
+    void NRF24L_TEMPLATE_QUALIFIER::NextStep()
+    {
+        if(_flushPending)
+        {
+            _flushPending = false;
+            QueueTransaction(&FlushTxFifoCommand, nullptr, 1, SpiBus::SelectAndDeselect, OnFlushComplete);
+        }
+        else if(_rxPipe < 6)
+        {
+            _rxPacket.Pipe = _rxPipe;
+            if(_dynamicPayload)
+            {
+                QueueTransaction(ReadWidthCommand, _response, 2, SpiBus::SelectAndDeselect, OnWidthRead);
+            }
+            else
+            {
+                _rxPacket.Size = _payloadSize;
+                QueueTransaction(&ReadPayloadCommand, nullptr, 1, SpiBus::SelectBefore);
+                QueueTransaction(nullptr, _rxPacket.Data, _rxPacket.Size, SpiBus::DeselectAfter, OnPayloadRead);
+            }
+        }
+        else if(_inFlight < TxFifoSize && _inFlight < _txQueue.size())
+        {
+            const Packet& packet = _txQueue[_inFlight];
+            if(_receiver)
+                _command = WriteAckPayloadCommand | (packet.Pipe & 0x07);
+            else
+                _command = (packet.Pipe & NoAckPipe) ? WriteTxPayloadNoAckCommand : WriteTxPayloadCommand;
+            QueueTransaction(&_command, nullptr, 1, SpiBus::SelectBefore);
+            QueueTransaction(packet.Data, nullptr, packet.Size, SpiBus::DeselectAfter, OnPayloadWritten);
+        }
+        else
+        {
+            Finish();
+        }
+    }
+
+    NRF24L_TEMPLATE_ARGS
+    void NRF24L_TEMPLATE_QUALIFIER::Finish()
+    {
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        // IRQ is level signal, but EXTI catches edges only: new event during service should not be missed
+        bool restart = _pending || !EXTIPin::IsSet();
+        _pending = false;
+        if(!restart)
+            _busy = false;
+        __set_PRIMASK(primask);
+
+        if(restart)
+            ReadStatus();
+    }
+
+    NRF24L_TEMPLATE_ARGS
+    void NRF24L_TEMPLATE_QUALIFIER::OnStatusRead(void* data, unsigned size, bool success)
+    {
+        uint8_t status = _response[0];
+        uint8_t fifoStatus = _fifoStatus[1];
+
+        if(status & TxDataSend)
+        {
+            // One TX_DS flag may cover several packets if service was late
+            uint8_t acknowledged = (fifoStatus & TxEmpty) ? _inFlight : 1;
+            if(acknowledged > _inFlight)
+                acknowledged = _inFlight;
+            for(uint8_t i = 0; i < acknowledged; ++i)
+                _txQueue.pop_front();
+            _inFlight -= acknowledged;
+        }
+
+        if(status & MaxRt)
+        {
+            // Drop failed packet, the others are reloaded after flush
+            if(_inFlight > 0)
+                _txQueue.pop_front();
+            ++_lost;
+            _inFlight = 0;
+            _flushPending = true;
+        }
+
+        _rxPipe = (status & RxPipeNumberMask) >> RxPipeNumberPos;
+        NextStep();
+    }
+
+    NRF24L_TEMPLATE_ARGS
+    void NRF24L_TEMPLATE_QUALIFIER::OnStatusRefresh(void* data, unsigned size, bool success)
+    {
+        _rxPipe = (_response[0] & RxPipeNumberMask) >> RxPipeNumberPos;
+        NextStep();
+    }
+
+    NRF24L_TEMPLATE_ARGS
+    void NRF24L_TEMPLATE_QUALIFIER::OnWidthRead(void* data, unsigned size, bool success)
+    {
+        uint8_t width = _response[1];
+        if(width == 0 || width > MaxPayloadSize)
+        {
+            // Corrupted packet: datasheet requires RX FIFO flush
+            ++_lost;
+            QueueTransaction(&FlushRxFifoCommand, nullptr, 1, SpiBus::SelectAndDeselect);
+            QueueTransaction(nullptr, _response, 1, SpiBus::SelectAndDeselect, OnStatusRefresh);
+            return;
+        }
+
+        _rxPacket.Size = width;
+        QueueTransaction(&ReadPayloadCommand, nullptr, 1, SpiBus::SelectBefore);
+        QueueTransaction(nullptr, _rxPacket.Data, width, SpiBus::DeselectAfter, OnPayloadRead);
+    }
+
+    NRF24L_TEMPLATE_ARGS
+    void NRF24L_TEMPLATE_QUALIFIER::OnPayloadRead(void* data, unsigned size, bool success)
+    {
+        if(!_rxQueue.push_back(_rxPacket))
+            ++_lost;
+
+        // NOP returns status with next RX FIFO packet pipe
+        QueueTransaction(nullptr, _response, 1, SpiBus::SelectAndDeselect, OnStatusRefresh);
+    }
+
+    NRF24L_TEMPLATE_ARGS
+    void NRF24L_TEMPLATE_QUALIFIER::OnPayloadWritten(void* data, unsigned size, bool success)
+    {
+        ++_inFlight;
+        NextStep();
+    }
+
+    NRF24L_TEMPLATE_ARGS
+    void NRF24L_TEMPLATE_QUALIFIER::OnFlushComplete(void* data, unsigned size, bool success)
+    {
+        NextStep();
+    }
+}
+
+#endif //! ZHELE_DRIVERS_NRF24L_IMPL_H
@@ -0,0 +1,252 @@
+/**
+ * @file
+ * Implements NRF24L star network methods
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DRIVERS_NRF24L_NETWORK_IMPL_H
+#define ZHELE_DRIVERS_NRF24L_NETWORK_IMPL_H
+
+#include <string.h>
+
+namespace Zhele::Drivers
+{
+    template<typename _Radio, typename _Timebase, uint8_t _Slots, unsigned _SlotLength, unsigned _BeaconSlot>
+    bool Nrf24lHub<_Radio, _Timebase, _Slots, _SlotLength, _BeaconSlot>::_beacon = false;
+    template<typename _Radio, typename _Timebase, uint8_t _Slots, unsigned _SlotLength, unsigned _BeaconSlot>
+    uint8_t Nrf24lHub<_Radio, _Timebase, _Slots, _SlotLength, _BeaconSlot>::_sequence = 0;
+    template<typename _Radio, typename _Timebase, uint8_t _Slots, unsigned _SlotLength, unsigned _BeaconSlot>
+    uint32_t Nrf24lHub<_Radio, _Timebase, _Slots, _SlotLength, _BeaconSlot>::_nextBeacon = 0;
+
+    template<typename _Radio, typename _Timebase, uint8_t _Slots, unsigned _SlotLength, unsigned _BeaconSlot>
+    void Nrf24lHub<_Radio, _Timebase, _Slots, _SlotLength, _BeaconSlot>::Init(const uint8_t* baseAddress, const uint8_t* beaconAddress)
+    {
+        uint8_t address[5];
+        for(uint8_t pipe = 0; pipe < Nrf24lBase::PipesCount; ++pipe)
+        {
+            PipeAddress(baseAddress, pipe, address);
+            _Radio::SetPipeAddress(pipe, address);
+        }
+        // Beacon is not acknowledged: pipe 0 keeps node address
+        _Radio::SetTxAddress(beaconAddress, false);
+
+        _beacon = false;
+        _Radio::StartReceiver();
+        _nextBeacon = _Timebase::Micros();
+    }
+
+    template<typename _Radio, typename _Timebase, uint8_t _Slots, unsigned _SlotLength, unsigned _BeaconSlot>
+    void Nrf24lHub<_Radio, _Timebase, _Slots, _SlotLength, _BeaconSlot>::Poll()
+    {
+        // Mode is switched by blocking register writes: wait for IRQ service
+        if(_Radio::Busy())
+            return;
+
+        uint32_t now = _Timebase::Micros();
+        if(!_beacon)
+        {
+            if(static_cast<int32_t>(now - _nextBeacon) < 0)
+                return;
+
+            Beacon beacon {BeaconMagic, _sequence++, _Slots,
+                {static_cast<uint8_t>(_SlotLength), static_cast<uint8_t>(_SlotLength >> 8)},
+                {static_cast<uint8_t>(_BeaconSlot), static_cast<uint8_t>(_BeaconSlot >> 8)}};
+            _Radio::StartTransmitter();
+            _Radio::Send(reinterpret_cast<const uint8_t*>(&beacon), sizeof(beacon), Nrf24lBase::NoAckPipe);
+            _beacon = true;
+
+            // Frames are not shifted by Poll latency, but skipped ones are not sent late
+            _nextBeacon += FrameLength;
+            if(static_cast<int32_t>(now - _nextBeacon) >= 0)
+                _nextBeacon = now + FrameLength;
+        }
+        else if(_Radio::TxPending() == 0)
+        {
+            _Radio::StartReceiver();
+            _beacon = false;
+        }
+    }
+
+    template<typename _Radio, typename _Timebase, uint8_t _Slots, unsigned _SlotLength, unsigned _BeaconSlot>
+    bool Nrf24lHub<_Radio, _Timebase, _Slots, _SlotLength, _BeaconSlot>::Receive(NodePacket& packet)
+    {
+        typename _Radio::Packet radioPacket;
+        while(_Radio::Receive(radioPacket))
+        {
+            if(radioPacket.Size == 0)
+                continue;
+
+            packet.Node = radioPacket.Data[0];
+            packet.Size = radioPacket.Size - 1;
+            memcpy(packet.Data, &radioPacket.Data[1], packet.Size);
+            return true;
+        }
+        return false;
+    }
+
+    template<typename _Radio, typename _Timebase, uint8_t _Slots, unsigned _SlotLength, unsigned _BeaconSlot>
+    uint8_t Nrf24lHub<_Radio, _Timebase, _Slots, _SlotLength, _BeaconSlot>::Sequence()
+    {
+        return _sequence;
+    }
+
+    #define NRF24L_NODE_TEMPLATE_ARGS template<typename _Radio, typename _Timebase, unsigned _QueueSize, unsigned _Guard, uint8_t _MaxMissedBeacons>
+    #define NRF24L_NODE_TEMPLATE_QUALIFIER Nrf24lNode<_Radio, _Timebase, _QueueSize, _Guard, _MaxMissedBeacons>
+
+    NRF24L_NODE_TEMPLATE_ARGS
+    Containers::RingBuffer<_QueueSize, Nrf24lBase::Packet> NRF24L_NODE_TEMPLATE_QUALIFIER::_queue;
+    NRF24L_NODE_TEMPLATE_ARGS
+    volatile uint32_t NRF24L_NODE_TEMPLATE_QUALIFIER::_irqTime = 0;
+    NRF24L_NODE_TEMPLATE_ARGS
+    uint32_t NRF24L_NODE_TEMPLATE_QUALIFIER::_beaconTime = 0;
+    NRF24L_NODE_TEMPLATE_ARGS
+    uint32_t NRF24L_NODE_TEMPLATE_QUALIFIER::_slotOffset = 0;
+    NRF24L_NODE_TEMPLATE_ARGS
+    uint32_t NRF24L_NODE_TEMPLATE_QUALIFIER::_slotLength = 0;
+    NRF24L_NODE_TEMPLATE_ARGS
+    uint32_t NRF24L_NODE_TEMPLATE_QUALIFIER::_frameLength = 0;
+    NRF24L_NODE_TEMPLATE_ARGS
+    uint32_t NRF24L_NODE_TEMPLATE_QUALIFIER::_slotEnd = 0;
+    NRF24L_NODE_TEMPLATE_ARGS
+    uint8_t NRF24L_NODE_TEMPLATE_QUALIFIER::_node = 0;
+    NRF24L_NODE_TEMPLATE_ARGS
+    uint8_t NRF24L_NODE_TEMPLATE_QUALIFIER::_missed = 0;
+    NRF24L_NODE_TEMPLATE_ARGS
+    bool NRF24L_NODE_TEMPLATE_QUALIFIER::_synchronized = false;
+    NRF24L_NODE_TEMPLATE_ARGS
+    typename NRF24L_NODE_TEMPLATE_QUALIFIER::State NRF24L_NODE_TEMPLATE_QUALIFIER::_state = State::Listen;
+
+    NRF24L_NODE_TEMPLATE_ARGS
+    void NRF24L_NODE_TEMPLATE_QUALIFIER::Init(uint8_t node, const uint8_t* baseAddress, const uint8_t* beaconAddress)
+    {
+        _node = node;
+        uint8_t address[5];
+        PipeAddress(baseAddress, node % Nrf24lBase::PipesCount, address);
+        _Radio::SetTxAddress(address);
+        _Radio::SetPipeAddress(1, beaconAddress);
+
+        _synchronized = false;
+        _state = State::Listen;
+        _Radio::StartReceiver();
+    }
+
+    NRF24L_NODE_TEMPLATE_ARGS
+    bool NRF24L_NODE_TEMPLATE_QUALIFIER::Send(const uint8_t* data, uint8_t size)
+    {
+        if(size > MaxNodeData)
+            return false;
+
+        Nrf24lBase::Packet packet {0, static_cast<uint8_t>(size + 1), {_node}};
+        memcpy(&packet.Data[1], data, size);
+        return _queue.push_back(packet);
+    }
+
+    NRF24L_NODE_TEMPLATE_ARGS
+    void NRF24L_NODE_TEMPLATE_QUALIFIER::Poll()
+    {
+        if(_Radio::Busy())
+            return;
+
+        uint32_t now = _Timebase::Micros();
+        if(_state == State::Transmit)
+        {
+            // Back to receiver before next beacon, unsent packets wait for next slot
+            if(_Radio::TxPending() == 0 || Expired(now, _slotEnd))
+            {
+                _Radio::StartReceiver();
+                _state = State::Listen;
+            }
+            return;
+        }
+
+        typename _Radio::Packet packet;
+        while(_Radio::Receive(packet))
+        {
+            Beacon beacon;
+            if(packet.Size < sizeof(beacon) || packet.Data[0] != BeaconMagic)
+                continue;
+
+            memcpy(&beacon, packet.Data, sizeof(beacon));
+            if(_node >= beacon.Slots)
+                continue;
+
+            uint16_t beaconSlot = beacon.BeaconSlot[0] | (beacon.BeaconSlot[1] << 8);
+            _slotLength = beacon.SlotLength[0] | (beacon.SlotLength[1] << 8);
+            _slotOffset = beaconSlot + _node * _slotLength;
+            _frameLength = beaconSlot + beacon.Slots * _slotLength;
+            _beaconTime = _irqTime;
+            _missed = 0;
+
+            if(!_synchronized)
+            {
+                // Retransmissions (500 us delay, ~800 us per try) should fit slot
+                uint32_t tries = _slotLength > 2 * _Guard ? (_slotLength - 2 * _Guard) / 800 : 0;
+                _Radio::SetAutoRetransmission(2, tries > 16 ? 15 : (tries > 0 ? tries - 1 : 0));
+                _synchronized = true;
+            }
+            _state = State::Wait;
+        }
+
+        if(!_synchronized)
+            return;
+
+        if(_state == State::Listen && Expired(now, _beaconTime + _frameLength + _Guard))
+        {
+            // Beacon is missed: keep predicted schedule for a while
+            _beaconTime += _frameLength;
+            if(++_missed > _MaxMissedBeacons)
+            {
+                _synchronized = false;
+                return;
+            }
+            _state = State::Wait;
+        }
+
+        if(_state == State::Wait && Expired(now, _beaconTime + _slotOffset + _Guard))
+            StartSlot();
+    }
+
+    NRF24L_NODE_TEMPLATE_ARGS
+    bool NRF24L_NODE_TEMPLATE_QUALIFIER::Synchronized()
+    {
+        return _synchronized;
+    }
+
+    NRF24L_NODE_TEMPLATE_ARGS
+    void NRF24L_NODE_TEMPLATE_QUALIFIER::IrqHandler()
+    {
+        _irqTime = _Timebase::Micros();
+        _Radio::IrqHandler();
+    }
+
+    NRF24L_NODE_TEMPLATE_ARGS
+    void NRF24L_NODE_TEMPLATE_QUALIFIER::StartSlot()
+    {
+        _state = State::Listen;
+        _slotEnd = _beaconTime + _slotOffset + _slotLength - _Guard;
+        if((_queue.empty() && _Radio::TxPending() == 0) || Expired(_Timebase::Micros(), _slotEnd))
+            return;
+
+        // Radio TX queue is reloaded to module TX FIFO on start
+        _Radio::StartTransmitter();
+        while(!_queue.empty() && _Radio::TxPending() < Nrf24lBase::TxFifoSize)
+        {
+            const Nrf24lBase::Packet& packet = _queue.front();
+            if(!_Radio::Send(packet.Data, packet.Size))
+                break;
+            _queue.pop_front();
+        }
+        _state = State::Transmit;
+    }
+
+    NRF24L_NODE_TEMPLATE_ARGS
+    bool NRF24L_NODE_TEMPLATE_QUALIFIER::Expired(uint32_t now, uint32_t time)
+    {
+        return static_cast<int32_t>(now - time) >= 0;
+    }
+}
+
+#endif //! ZHELE_DRIVERS_NRF24L_NETWORK_IMPL_H
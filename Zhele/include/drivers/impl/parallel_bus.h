@@ -0,0 +1,217 @@
+/**
+ * @file
+ * Parallel bus methods implementation
+ *
+ * @author Alexey Zhelonkin
+ * @date 2023
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DRIVERS_PARALLEL_BUS_IMPL_H
+#define ZHELE_DRIVERS_PARALLEL_BUS_IMPL_H
+
+namespace Zhele::Drivers
+{
+    #define PARALLELBUS_TEMPLATE_ARGS template<typename _DataPins, typename _WrPin, typename _DcPin, typename _RdPin, typename _CsPin>
+    #define PARALLELBUS_TEMPLATE_QUALIFIER ParallelBus<_DataPins, _WrPin, _DcPin, _RdPin, _CsPin>
+
+    PARALLELBUS_TEMPLATE_ARGS
+    void PARALLELBUS_TEMPLATE_QUALIFIER::Init()
+    {
+        InitControlPin<_WrPin>();
+        InitControlPin<_DcPin>();
+        InitControlPin<_RdPin>();
+        InitControlPin<_CsPin>();
+
+        _DataPins::Enable();
+        _DataPins::template Configure<_DataPins::Configuration::Out, _DataPins::Speed::Fast, _DataPins::DriverType::PushPull>();
+    }
+
+    PARALLELBUS_TEMPLATE_ARGS
+    void PARALLELBUS_TEMPLATE_QUALIFIER::Select()
+    {
+        _CsPin::Clear();
+    }
+
+    PARALLELBUS_TEMPLATE_ARGS
+    void PARALLELBUS_TEMPLATE_QUALIFIER::Deselect()
+    {
+        _CsPin::Set();
+    }
+
+    PARALLELBUS_TEMPLATE_ARGS
+    void PARALLELBUS_TEMPLATE_QUALIFIER::WriteCommand(DataType command)
+    {
+        _DcPin::Clear();
+        _DataPins::Write(command);
+        Strobe();
+        _DcPin::Set();
+    }
+
+    PARALLELBUS_TEMPLATE_ARGS
+    void PARALLELBUS_TEMPLATE_QUALIFIER::WriteData(DataType data)
+    {
+        _DataPins::Write(data);
+        Strobe();
+    }
+
+    PARALLELBUS_TEMPLATE_ARGS
+    void PARALLELBUS_TEMPLATE_QUALIFIER::WriteData(const DataType* data, size_t count)
+    {
+        for(size_t i = 0; i < count; ++i)
+        {
+            _DataPins::Write(data[i]);
+            Strobe();
+        }
+    }
+
+    PARALLELBUS_TEMPLATE_ARGS
+    void PARALLELBUS_TEMPLATE_QUALIFIER::Fill(DataType data, size_t count)
+    {
+        _DataPins::Write(data);
+        for(size_t i = 0; i < count; ++i)
+            Strobe();
+    }
+
+    PARALLELBUS_TEMPLATE_ARGS
+    typename PARALLELBUS_TEMPLATE_QUALIFIER::DataType PARALLELBUS_TEMPLATE_QUALIFIER::ReadData()
+    {
+        _DataPins::template SetConfiguration<_DataPins::Configuration::In>();
+        DataType data = ReadWord();
+        _DataPins::template SetConfiguration<_DataPins::Configuration::Out>();
+        return data;
+    }
+
+    PARALLELBUS_TEMPLATE_ARGS
+    void PARALLELBUS_TEMPLATE_QUALIFIER::ReadData(DataType* data, size_t count)
+    {
+        _DataPins::template SetConfiguration<_DataPins::Configuration::In>();
+        for(size_t i = 0; i < count; ++i)
+            data[i] = ReadWord();
+        _DataPins::template SetConfiguration<_DataPins::Configuration::Out>();
+    }
+
+    PARALLELBUS_TEMPLATE_ARGS
+    template<typename _Pin>
+    void PARALLELBUS_TEMPLATE_QUALIFIER::InitControlPin()
+    {
+        if constexpr (!std::is_same_v<_Pin, IO::NullPin>)
+        {
+            // Control pins are active low
+            _Pin::Port::Enable();
+            _Pin::Set();
+            _Pin::template SetConfiguration<_Pin::Configuration::Out>();
+            _Pin::template SetDriverType<_Pin::DriverType::PushPull>();
+            _Pin::template SetSpeed<_Pin::Speed::Fast>();
+        }
+    }
+
+    PARALLELBUS_TEMPLATE_ARGS
+    void PARALLELBUS_TEMPLATE_QUALIFIER::Strobe()
+    {
+        // Data is latched by rising edge
+        _WrPin::Clear();
+        _WrPin::Set();
+    }
+
+    PARALLELBUS_TEMPLATE_ARGS
+    typename PARALLELBUS_TEMPLATE_QUALIFIER::DataType PARALLELBUS_TEMPLATE_QUALIFIER::ReadWord()
+    {
+        static_assert(!std::is_same_v<_RdPin, IO::NullPin>, "Read strobe pin is required for read");
+
+        _RdPin::Clear();
+        // Read access time of TFT controllers is up to a few hundreds nanoseconds
+        delay_ns<400>();
+        DataType data = _DataPins::Read();
+        _RdPin::Set();
+        return data;
+    }
+
+#if defined (FSMC_Bank1)
+    #define FSMCBUS_TEMPLATE_ARGS template<typename _Pins, unsigned _SubBank, unsigned _DcAddressLine, typename _DataType>
+    #define FSMCBUS_TEMPLATE_QUALIFIER FsmcBus<_Pins, _SubBank, _DcAddressLine, _DataType>
+
+    FSMCBUS_TEMPLATE_ARGS
+    void FSMCBUS_TEMPLATE_QUALIFIER::Init(uint8_t addressSetup, uint8_t dataSetup)
+    {
+        Bank::template SelectPins<_Pins>();
+        Bank::Init(FsmcBase::MemoryType::Sram, Width, FsmcBase::Timing {addressSetup, 1, dataSetup, 0});
+    }
+
+    FSMCBUS_TEMPLATE_ARGS
+    void FSMCBUS_TEMPLATE_QUALIFIER::Init(const FsmcBase::Timing& readTiming, const FsmcBase::Timing& writeTiming)
+    {
+        Bank::template SelectPins<_Pins>();
+        Bank::Init(FsmcBase::MemoryType::Sram, Width, readTiming, writeTiming);
+    }
+
+    FSMCBUS_TEMPLATE_ARGS
+    void FSMCBUS_TEMPLATE_QUALIFIER::WriteCommand(DataType command)
+    {
+        Command() = command;
+    }
+
+    FSMCBUS_TEMPLATE_ARGS
+    void FSMCBUS_TEMPLATE_QUALIFIER::WriteData(DataType data)
+    {
+        Data() = data;
+    }
+
+    FSMCBUS_TEMPLATE_ARGS
+    void FSMCBUS_TEMPLATE_QUALIFIER::WriteData(const DataType* data, size_t count)
+    {
+        for(size_t i = 0; i < count; ++i)
+            Data() = data[i];
+    }
+
+    FSMCBUS_TEMPLATE_ARGS
+    template<typename _DmaChannel>
+    void FSMCBUS_TEMPLATE_QUALIFIER::WriteDataAsync(const DataType* data, uint16_t count, TransferCallback callback)
+    {
+        typename _DmaChannel::Mode mode = _DmaChannel::Mem2Mem | _DmaChannel::PeriphIncrement;
+        if constexpr (sizeof(_DataType) == 2)
+            mode = mode | _DmaChannel::PSize16Bits | _DmaChannel::MSize16Bits;
+        else
+            mode = mode | _DmaChannel::PSize8Bits | _DmaChannel::MSize8Bits;
+
+        _DmaChannel::ClearTransferComplete();
+        _DmaChannel::SetTransferCallback(callback);
+        // Memory to memory: "peripheral" address is source, memory address (display data) is destination
+        _DmaChannel::Transfer(mode, const_cast<DataType*>(&Data()), const_cast<DataType*>(data), count);
+    }
+
+    FSMCBUS_TEMPLATE_ARGS
+    void FSMCBUS_TEMPLATE_QUALIFIER::Fill(DataType data, size_t count)
+    {
+        for(size_t i = 0; i < count; ++i)
+            Data() = data;
+    }
+
+    FSMCBUS_TEMPLATE_ARGS
+    typename FSMCBUS_TEMPLATE_QUALIFIER::DataType FSMCBUS_TEMPLATE_QUALIFIER::ReadData()
+    {
+        return Data();
+    }
+
+    FSMCBUS_TEMPLATE_ARGS
+    void FSMCBUS_TEMPLATE_QUALIFIER::ReadData(DataType* data, size_t count)
+    {
+        for(size_t i = 0; i < count; ++i)
+            data[i] = Data();
+    }
+
+    FSMCBUS_TEMPLATE_ARGS
+    volatile typename FSMCBUS_TEMPLATE_QUALIFIER::DataType& FSMCBUS_TEMPLATE_QUALIFIER::Command()
+    {
+        return *reinterpret_cast<volatile DataType*>(BaseAddress);
+    }
+
+    FSMCBUS_TEMPLATE_ARGS
+    volatile typename FSMCBUS_TEMPLATE_QUALIFIER::DataType& FSMCBUS_TEMPLATE_QUALIFIER::Data()
+    {
+        return *reinterpret_cast<volatile DataType*>(DataAddress);
+    }
+#endif
+}
+
+#endif //! ZHELE_DRIVERS_PARALLEL_BUS_IMPL_H
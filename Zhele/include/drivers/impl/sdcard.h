@@ -17,8 +17,11 @@ namespace Zhele::Drivers
     {
         _CsPin::Clear();
         //Spi.Read();
-        Spi.Write(index | (1 << 6));
-        Spi.WriteU32Be(arg);
+        uint8_t frame[5] = {uint8_t(index | (1 << 6)), uint8_t(arg >> 24), uint8_t(arg >> 16), uint8_t(arg >> 8), uint8_t(arg)};
+        if(useCrc)
+            crc = Crc7::Calculate(frame, sizeof(frame)) << 1;
+        for(uint8_t byte : frame)
+            Spi.Write(byte);
         Spi.Write(crc | 1);
         uint16_t responce = Spi.IgnoreWhile(1000, 0xff);
         if(index == SendStatus && responce !=0xff)
@@ -43,6 +46,9 @@ namespace Zhele::Drivers
         _CsPin::SetDirWrite();
         _CsPin::Set();
 
+        // Card identification clock should be 100-400 kHz
+        _SpiModule::SetClockFreq(400000);
+
         for(uint8_t i=0; i < 20; i++)
             Spi.Read();
 
@@ -107,6 +113,14 @@ namespace Zhele::Drivers
                     _type = SdCardMmc;
             }
         }
+
+        // Card checks command and written data CRC
+        if(useCrc && _type != SdCardNone)
+            SpiCommand(CrcOnOff, 1);
+
+        if(_type != SdCardNone)
+            RampUpClock();
+
         return _type;
     }
 
@@ -119,19 +133,76 @@ namespace Zhele::Drivers
             if(csd[0] & 0xC0) // SD v2
             {
                 uint32_t c_size = (((uint32_t)csd[7] & 0x3F) << 16) | ((uint32_t)csd[8] << 8) | csd[9];
-                return (c_size + 1) * 1024u - 1u;
+                return (c_size + 1) * 1024u;
             }else // SD v1
             {
                 uint32_t c_size = ((((uint32_t)csd[6] << 16) | ((uint32_t)csd[7] << 8) | csd[8]) & 0x0003FFC0) >> 6;
                 uint16_t c_size_mult = ((uint16_t)((csd[9] & 0x03) << 1)) | ((uint16_t)((csd[10] & 0x80) >> 7));
                 uint16_t block_len = csd[5] & 0x0F;
                 block_len = 1u << (block_len - 9);
-                return ((c_size + 1u) * (1u << (c_size_mult + 2u)) * block_len) - 1u;
+                return (c_size + 1u) * (1u << (c_size_mult + 2u)) * block_len;
             }
         }
         return 0;
     }
 
+    template<class _SpiModule, class _CsPin>
+    uint32_t SdCard<_SpiModule, _CsPin>::ReadTransferSpeed()
+    {
+        static const uint8_t timeValues[16] = {0, 10, 12, 13, 15, 20, 25, 30, 35, 40, 45, 50, 55, 60, 70, 80};
+        static const uint32_t rateUnits[4] = {10000, 100000, 1000000, 10000000};
+
+        uint8_t csd[16];
+        if(SpiCommand(SendCsd, 0) != 0 || !ReadDataBlock(csd, 16))
+            return 0;
+
+        // TRAN_SPEED: bits 2:0 - rate unit (100 kbit/s...100 Mbit/s), bits 6:3 - time value (x10)
+        uint8_t tranSpeed = csd[3];
+        if((tranSpeed & 0x07) > 3)
+            return 0;
+        return rateUnits[tranSpeed & 0x07] * timeValues[(tranSpeed >> 3) & 0x0f];
+    }
+
+    template<class _SpiModule, class _CsPin>
+    bool SdCard<_SpiModule, _CsPin>::SwitchHighSpeed()
+    {
+        // Function group 1 (access mode): 1 - high-speed, other groups are not changed (0xf)
+        static const uint32_t highSpeedFunction = 0x00fffff1;
+        static const uint32_t switchMode = 1ul << 31;
+
+        uint8_t status[64];
+        // Check mode: query that high-speed function is supported (bit 401 of status)
+        if(SpiCommand(SwitchFunction, highSpeedFunction) != 0 || !ReadDataBlock(status, 64)
+            || !(status[13] & 0x02))
+        {
+            return false;
+        }
+
+        // Switch mode: function group 1 result (bits 379:376) should be equal to selected function
+        if(SpiCommand(SwitchFunction, switchMode | highSpeedFunction) != 0 || !ReadDataBlock(status, 64))
+            return false;
+        return (status[16] & 0x0f) == 1;
+    }
+
+    template<class _SpiModule, class _CsPin>
+    void SdCard<_SpiModule, _CsPin>::RampUpClock()
+    {
+        uint32_t maxFreq = ReadTransferSpeed();
+        if(maxFreq == 0)
+            return;
+
+        // CMD6 is not supported by MMC and SD v1.0 (command is rejected by the last one)
+        if(ZHELE_SDCARD_HIGH_SPEED && _type != SdCardMmc && SwitchHighSpeed())
+        {
+            // TRAN_SPEED is updated after switch
+            uint32_t highSpeedFreq = ReadTransferSpeed();
+            if(highSpeedFreq > maxFreq)
+                maxFreq = highSpeedFreq;
+        }
+
+        _SpiModule::SetClockFreq(maxFreq);
+    }
+
     template<class _SpiModule, class _CsPin>
     uint32_t SdCard<_SpiModule, _CsPin>::BlocksCount()
     {
@@ -151,6 +222,257 @@ namespace Zhele::Drivers
         _CsPin::Clear();
         return Spi.Ignore(10000u, 0xff) == 0xff;
     }
+
+    template<class _SpiModule, class _CsPin>
+    bool SdCard<_SpiModule, _CsPin>::Sync()
+    {
+        bool result = WaitWhileBusy();
+        _CsPin::Set();
+        Spi.Read();
+        return result;
+    }
+
+    template<class _SpiModule, class _CsPin>
+    bool SdCard<_SpiModule, _CsPin>::Erase(uint32_t firstBlockAddress, uint32_t lastBlockAddress)
+    {
+        if(_type != SdhcCard)
+        {
+            firstBlockAddress <<= 9;
+            lastBlockAddress <<= 9;
+        }
+        if(!Sync())
+            return false;
+        if(SpiCommand(EraseWrBlkStartAddr, firstBlockAddress) != 0
+            || SpiCommand(EraseWrBlkEndAddr, lastBlockAddress) != 0
+            || SpiCommand(SdCardCommand::Erase, 0) != 0)
+        {
+            return false;
+        }
+        return Sync();
+    }
+
+    template<class _SpiModule, class _CsPin>
+    bool SdCard<_SpiModule, _CsPin>::StopTransmission()
+    {
+        Spi.Write(SdCardCommand::StopTransmission | (1 << 6));
+        Spi.WriteU32Be(0);
+        Spi.Write(1);
+        // Skip stuff byte
+        Spi.Read();
+        if(Spi.IgnoreWhile(1000, 0xff) != 0)
+            return false;
+        return Spi.Ignore(10000u, 0xff) == 0xff;
+    }
+
+    template<class _SpiModule, class _CsPin>
+    bool SdCard<_SpiModule, _CsPin>::BeginRead(uint32_t logicalBlockAddress)
+    {
+        if(_type != SdhcCard)
+            logicalBlockAddress <<= 9;
+        if(!WaitWhileBusy())
+            return false;
+        if(SpiCommand(SdCardCommand::ReadMultipleBlock, logicalBlockAddress) != 0)
+            return false;
+
+        _CsPin::Clear();
+        return true;
+    }
+
+    template<class _SpiModule, class _CsPin>
+    bool SdCard<_SpiModule, _CsPin>::EndRead()
+    {
+        bool result = StopTransmission();
+        _CsPin::Set();
+        Spi.Read();
+        return result;
+    }
+
+    template<class _SpiModule, class _CsPin>
+    bool SdCard<_SpiModule, _CsPin>::BeginWrite(uint32_t logicalBlockAddress, uint32_t blocksCount)
+    {
+        if(_type != SdhcCard)
+            logicalBlockAddress <<= 9;
+        if(!WaitWhileBusy())
+            return false;
+        if(_type != SdCardMmc && SpiCommand(AppCmd, 0) <= SdR1Idle)
+            SpiCommand(SetWrBlkEraseCount, blocksCount);
+        if(SpiCommand(SdCardCommand::WriteMultipleBlock, logicalBlockAddress) != 0)
+            return false;
+
+        _CsPin::Clear();
+        return true;
+    }
+
+    template<class _SpiModule, class _CsPin>
+    bool SdCard<_SpiModule, _CsPin>::EndWrite()
+    {
+        // Stop transmission token
+        bool result = Spi.Ignore(10000u, 0xff) == 0xff;
+        Spi.Write(0xFD);
+        Spi.Read();
+        result = Spi.Ignore(10000u, 0xff) == 0xff && result;
+        _CsPin::Set();
+        Spi.Read();
+        return result;
+    }
+
+    template<class _SpiModule, class _CsPin>
+    void SdCard<_SpiModule, _CsPin>::DmaTransfer(const void* transmitBuffer, void* receiveBuffer, size_t size)
+    {
+        static const size_t MaxChunkSize = 0xffff;
+
+        const uint8_t* transmit = static_cast<const uint8_t*>(transmitBuffer);
+        uint8_t* receive = static_cast<uint8_t*>(receiveBuffer);
+
+        while(size > 0)
+        {
+            uint16_t chunkSize = size > MaxChunkSize ? MaxChunkSize : size;
+            typename _SpiModule::Transaction transaction {};
+            transaction.transmitBuffer = transmit;
+            transaction.receiveBuffer = receive;
+            transaction.size = chunkSize;
+            transaction.dataSize = _SpiModule::DataSize8;
+
+            while(!_SpiModule::QueueTransaction(transaction))
+                continue;
+
+            if(transmit != nullptr)
+                transmit += chunkSize;
+            if(receive != nullptr)
+                receive += chunkSize;
+            size -= chunkSize;
+        }
+
+        while(!_SpiModule::TransactionQueueEmpty())
+            continue;
+    }
+#if ZHELE_SDCARD_USE_DMA
+    template<class _SpiModule, class _CsPin>
+    void SdCard<_SpiModule, _CsPin>::QueuePoll(TransferCallback callback)
+    {
+        typename _SpiModule::Transaction transaction {};
+        transaction.receiveBuffer = _asyncResponse;
+        transaction.size = 1;
+        transaction.dataSize = _SpiModule::DataSize8;
+        transaction.callback = callback;
+
+        if(!_SpiModule::QueueTransaction(transaction))
+            CompleteAsync(false);
+    }
+
+    template<class _SpiModule, class _CsPin>
+    void SdCard<_SpiModule, _CsPin>::CompleteAsync(bool success)
+    {
+        Filesystem::BlockDeviceCallback callback = _asyncCallback;
+        _asyncCallback = nullptr;
+        if(callback)
+            callback(success);
+    }
+
+    template<class _SpiModule, class _CsPin>
+    void SdCard<_SpiModule, _CsPin>::ReadNextBlockAsync(uint8_t* data, Filesystem::BlockDeviceCallback callback)
+    {
+        _asyncData = data;
+        _asyncCallback = callback;
+        _asyncPolls = 0;
+        QueuePoll(OnReadTokenPolled);
+    }
+
+    template<class _SpiModule, class _CsPin>
+    void SdCard<_SpiModule, _CsPin>::OnReadTokenPolled(void* data, unsigned size, bool success)
+    {
+        if(success && _asyncResponse[0] == 0xFF && ++_asyncPolls < AsyncPollLimit)
+        {
+            QueuePoll(OnReadTokenPolled);
+            return;
+        }
+        if(!success || _asyncResponse[0] != 0xFE)
+        {
+            CompleteAsync(false);
+            return;
+        }
+
+        // Data block and CRC
+        typename _SpiModule::Transaction transaction {};
+        transaction.receiveBuffer = _asyncData;
+        transaction.size = 512;
+        transaction.dataSize = _SpiModule::DataSize8;
+        bool queued = _SpiModule::QueueTransaction(transaction);
+
+        transaction.receiveBuffer = &_asyncResponse[1];
+        transaction.size = 2;
+        transaction.callback = OnReadPacketReceived;
+        queued = queued && _SpiModule::QueueTransaction(transaction);
+
+        if(!queued)
+            CompleteAsync(false);
+    }
+
+    template<class _SpiModule, class _CsPin>
+    void SdCard<_SpiModule, _CsPin>::OnReadPacketReceived(void* data, unsigned size, bool success)
+    {
+        if(success && useCrc)
+            success = Crc16Ccitt::Calculate(_asyncData, 512) == ((_asyncResponse[1] << 8) | _asyncResponse[2]);
+        CompleteAsync(success);
+    }
+
+    template<class _SpiModule, class _CsPin>
+    void SdCard<_SpiModule, _CsPin>::WriteNextBlockAsync(const uint8_t* data, Filesystem::BlockDeviceCallback callback)
+    {
+        _asyncData = const_cast<uint8_t*>(data);
+        _asyncCallback = callback;
+        uint16_t crc = useCrc ? Crc16Ccitt::Calculate(data, 512) : 0xffff;
+        _asyncCrc[0] = crc >> 8;
+        _asyncCrc[1] = crc;
+        _asyncPolls = 0;
+        QueuePoll(OnWriteReadyPolled);
+    }
+
+    template<class _SpiModule, class _CsPin>
+    void SdCard<_SpiModule, _CsPin>::OnWriteReadyPolled(void* data, unsigned size, bool success)
+    {
+        if(success && _asyncResponse[0] != 0xFF && ++_asyncPolls < AsyncPollLimit)
+        {
+            QueuePoll(OnWriteReadyPolled);
+            return;
+        }
+        if(!success || _asyncResponse[0] != 0xFF)
+        {
+            CompleteAsync(false);
+            return;
+        }
+
+        // Data token, data block, CRC and data response
+        typename _SpiModule::Transaction transaction {};
+        transaction.transmitBuffer = &_asyncToken;
+        transaction.size = 1;
+        transaction.dataSize = _SpiModule::DataSize8;
+        bool queued = _SpiModule::QueueTransaction(transaction);
+
+        transaction.transmitBuffer = _asyncData;
+        transaction.size = 512;
+        queued = queued && _SpiModule::QueueTransaction(transaction);
+
+        transaction.transmitBuffer = _asyncCrc;
+        transaction.size = 2;
+        queued = queued && _SpiModule::QueueTransaction(transaction);
+
+        transaction.transmitBuffer = nullptr;
+        transaction.receiveBuffer = &_asyncResponse[2];
+        transaction.size = 1;
+        transaction.callback = OnWritePacketSent;
+        queued = queued && _SpiModule::QueueTransaction(transaction);
+
+        if(!queued)
+            CompleteAsync(false);
+    }
+
+    template<class _SpiModule, class _CsPin>
+    void SdCard<_SpiModule, _CsPin>::OnWritePacketSent(void* data, unsigned size, bool success)
+    {
+        CompleteAsync(success && (_asyncResponse[2] & 0x1F) == 0x05);
+    }
+#endif
 }
 
 #endif //! ZHELE_DRIVERS_SDCARD_IMPL_H
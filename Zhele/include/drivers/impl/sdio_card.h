@@ -0,0 +1,507 @@
+/**
+ * @file
+ * Implements methods of SdioCard class
+ *
+ * @author Alexey Zhelonkin
+ * @date 2023
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DRIVERS_SDIOCARD_IMPL_H
+#define ZHELE_DRIVERS_SDIOCARD_IMPL_H
+
+namespace Zhele::Drivers
+{
+    #define SDIOCARD_TEMPLATE_ARGS template<typename _DmaChannel>
+    #define SDIOCARD_TEMPLATE_QUALIFIER SdioCard<_DmaChannel>
+
+    SDIOCARD_TEMPLATE_ARGS
+    SdCardType SDIOCARD_TEMPLATE_QUALIFIER::Detect()
+    {
+        _type = SdCardNone;
+        _rca = 0;
+        _blocksCount = 0;
+
+        Clock::SdioClock::Enable();
+        Pins::Enable();
+        Pins::template SetConfiguration<Pins::Configuration::AltFunc>();
+        Pins::template SetDriverType<Pins::DriverType::PushPull>();
+        Pins::template SetSpeed<Pins::Speed::Fast>();
+        Pins::template AltFuncNumber<12>();
+
+        Regs()->POWER = 0;
+        Regs()->MASK = 0;
+        Regs()->DCTRL = 0;
+        Regs()->CLKCR = 0;
+        SetClockFreq(IdentificationFreq);
+        Regs()->POWER = SDIO_POWER_PWRCTRL;
+        // Power ramp up and 74 clocks before first command
+        delay_ms<2, F_CPU>();
+
+        SendCommand(GoIdleState, 0, NoResponse);
+
+        // SD v2 card echoes check pattern
+        bool v2 = SendCommand(SendIfCond, 0x1aa) && (Regs()->RESP1 & 0xfff) == 0x1aa;
+
+        uint32_t ocr = 0;
+        uint16_t timeout = 1000;
+        do
+        {
+            // 2.7-3.6 V, host supports high capacity cards if card is v2
+            if(!SendAppCommand(SdSendOpCond, 0x00ff8000 | (v2 ? 1ul << 30 : 0), false))
+                return _type;
+            ocr = Regs()->RESP1;
+            if(!(ocr & (1ul << 31)))
+                delay_ms<1, F_CPU>();
+        } while(!(ocr & (1ul << 31)) && --timeout);
+
+        if(!(ocr & (1ul << 31)))
+            return _type;
+
+        if(!SendCommand(AllSendCid, 0, LongResponse) || !SendCommand(SendRelativeAddress, 0))
+            return _type;
+        _rca = Regs()->RESP1 & 0xffff0000;
+
+        if(!SendCommand(SendCsd, _rca, LongResponse))
+            return _type;
+        uint32_t response[4] = {Regs()->RESP1, Regs()->RESP2, Regs()->RESP3, Regs()->RESP4};
+        uint8_t csd[16];
+        for(unsigned i = 0; i < 16; ++i)
+            csd[i] = response[i / 4] >> (24 - 8 * (i % 4));
+
+        if(!CardCommand(SelectCard, _rca) || !SendAppCommand(SetBusWidth, 2) || (Regs()->RESP1 & CardStatusErrors))
+            return _type;
+        Regs()->CLKCR = Regs()->CLKCR | SDIO_CLKCR_WIDBUS_0;
+
+        if(csd[0] & 0xC0) // SD v2
+        {
+            uint32_t c_size = (((uint32_t)csd[7] & 0x3F) << 16) | ((uint32_t)csd[8] << 8) | csd[9];
+            _blocksCount = (c_size + 1) * 1024u;
+        }
+        else // SD v1
+        {
+            uint32_t c_size = ((((uint32_t)csd[6] << 16) | ((uint32_t)csd[7] << 8) | csd[8]) & 0x0003FFC0) >> 6;
+            uint16_t c_size_mult = ((uint16_t)((csd[9] & 0x03) << 1)) | ((uint16_t)((csd[10] & 0x80) >> 7));
+            uint16_t block_len = csd[5] & 0x0F;
+            block_len = 1u << (block_len - 9);
+            _blocksCount = (c_size + 1u) * (1u << (c_size_mult + 2u)) * block_len;
+        }
+
+        SdCardType type = !v2
+            ? SdCardV1
+            : (ocr & (1ul << 30)) ? SdhcCard : SdCardV2;
+
+        if(type != SdhcCard && !CardCommand(SetBlockLength, BlockLength))
+            return _type;
+
+        // TRAN_SPEED: bits 2:0 - rate unit (100 kbit/s...100 Mbit/s), bits 6:3 - time value (x10)
+        static const uint8_t timeValues[16] = {0, 10, 12, 13, 15, 20, 25, 30, 35, 40, 45, 50, 55, 60, 70, 80};
+        static const uint32_t rateUnits[4] = {10000, 100000, 1000000, 10000000};
+        uint32_t maxFreq = (csd[3] & 0x07) <= 3
+            ? rateUnits[csd[3] & 0x07] * timeValues[(csd[3] >> 3) & 0x0f]
+            : 0;
+        SetClockFreq(maxFreq != 0 ? maxFreq : 25000000);
+
+        Nvic::EnableIrq<SDIO_IRQn>();
+
+        _type = type;
+        return _type;
+    }
+
+    SDIOCARD_TEMPLATE_ARGS
+    bool SDIOCARD_TEMPLATE_QUALIFIER::CheckStatus()
+    {
+        return _type != SdCardNone && CardCommand(SendStatus, _rca);
+    }
+
+    SDIOCARD_TEMPLATE_ARGS
+    uint32_t SDIOCARD_TEMPLATE_QUALIFIER::BlocksCount()
+    {
+        return _blocksCount;
+    }
+
+    SDIOCARD_TEMPLATE_ARGS
+    size_t SDIOCARD_TEMPLATE_QUALIFIER::BlockSize()
+    {
+        return BlockLength;
+    }
+
+    SDIOCARD_TEMPLATE_ARGS
+    bool SDIOCARD_TEMPLATE_QUALIFIER::Sync()
+    {
+        return WaitReady();
+    }
+
+    SDIOCARD_TEMPLATE_ARGS
+    bool SDIOCARD_TEMPLATE_QUALIFIER::Erase(uint32_t firstBlockAddress, uint32_t lastBlockAddress)
+    {
+        return WaitReady()
+            && CardCommand(EraseWrBlkStartAddr, Address(firstBlockAddress))
+            && CardCommand(EraseWrBlkEndAddr, Address(lastBlockAddress))
+            && CardCommand(SdCardCommand::Erase, 0)
+            && WaitReady();
+    }
+
+    SDIOCARD_TEMPLATE_ARGS
+    bool SDIOCARD_TEMPLATE_QUALIFIER::ReadBlock(uint8_t* data, uint32_t logicalBlockAddress)
+    {
+        if(IsDmaBuffer(data))
+            return TransferBlocks(data, logicalBlockAddress, 1, true);
+
+        if(!TransferBlocks(_buffer, logicalBlockAddress, 1, true))
+            return false;
+        memcpy(data, _buffer, BlockLength);
+        return true;
+    }
+
+    SDIOCARD_TEMPLATE_ARGS
+    bool SDIOCARD_TEMPLATE_QUALIFIER::ReadMultipleBlock(uint8_t* data, uint32_t logicalBlockAddress, uint32_t blocksCount)
+    {
+        bool aligned = IsDmaBuffer(data);
+        while(blocksCount > 0)
+        {
+            uint32_t count = !aligned
+                ? 1
+                : blocksCount < MaxTransferBlocks ? blocksCount : MaxTransferBlocks;
+            bool result = aligned
+                ? TransferBlocks(data, logicalBlockAddress, count, true)
+                : ReadBlock(data, logicalBlockAddress);
+            if(!result)
+                return false;
+            data += count * BlockLength;
+            logicalBlockAddress += count;
+            blocksCount -= count;
+        }
+        return true;
+    }
+
+    SDIOCARD_TEMPLATE_ARGS
+    bool SDIOCARD_TEMPLATE_QUALIFIER::WriteBlock(const uint8_t* data, uint32_t logicalBlockAddress)
+    {
+        if(!IsDmaBuffer(data))
+        {
+            memcpy(_buffer, data, BlockLength);
+            data = _buffer;
+        }
+        return TransferBlocks(const_cast<uint8_t*>(data), logicalBlockAddress, 1, false);
+    }
+
+    SDIOCARD_TEMPLATE_ARGS
+    bool SDIOCARD_TEMPLATE_QUALIFIER::WriteMultipleBlock(const uint8_t* data, uint32_t logicalBlockAddress, uint32_t blocksCount)
+    {
+        bool aligned = IsDmaBuffer(data);
+        while(blocksCount > 0)
+        {
+            uint32_t count = !aligned
+                ? 1
+                : blocksCount < MaxTransferBlocks ? blocksCount : MaxTransferBlocks;
+            bool result = aligned
+                ? TransferBlocks(const_cast<uint8_t*>(data), logicalBlockAddress, count, false)
+                : WriteBlock(data, logicalBlockAddress);
+            if(!result)
+                return false;
+            data += count * BlockLength;
+            logicalBlockAddress += count;
+            blocksCount -= count;
+        }
+        return true;
+    }
+
+    SDIOCARD_TEMPLATE_ARGS
+    bool SDIOCARD_TEMPLATE_QUALIFIER::BeginRead(uint32_t logicalBlockAddress)
+    {
+        _streamAddress = logicalBlockAddress;
+        return WaitReady();
+    }
+
+    SDIOCARD_TEMPLATE_ARGS
+    void SDIOCARD_TEMPLATE_QUALIFIER::ReadNextBlockAsync(uint8_t* data, Filesystem::BlockDeviceCallback callback)
+    {
+        _asyncCallback = callback;
+        _asyncData = data;
+        _asyncRead = true;
+
+        // Read data path should be enabled before command, card starts transfer right after response
+        StartData(IsDmaBuffer(data) ? data : _buffer, BlockLength, true);
+        if(!CardCommand(ReadSingleBlock, Address(_streamAddress++)))
+        {
+            AbortData();
+            _asyncCallback = nullptr;
+            callback(false);
+            return;
+        }
+        Regs()->MASK = DataErrorFlags | SDIO_STA_DATAEND;
+    }
+
+    SDIOCARD_TEMPLATE_ARGS
+    bool SDIOCARD_TEMPLATE_QUALIFIER::EndRead()
+    {
+        return true;
+    }
+
+    SDIOCARD_TEMPLATE_ARGS
+    bool SDIOCARD_TEMPLATE_QUALIFIER::BeginWrite(uint32_t logicalBlockAddress, uint32_t blocksCount)
+    {
+        if(!WaitReady())
+            return false;
+        // Pre-erase is optimization only, so its fail is ignored
+        SendAppCommand(SetWrBlkEraseCount, blocksCount);
+        return CardCommand(SdCardCommand::WriteMultipleBlock, Address(logicalBlockAddress));
+    }
+
+    SDIOCARD_TEMPLATE_ARGS
+    void SDIOCARD_TEMPLATE_QUALIFIER::WriteNextBlockAsync(const uint8_t* data, Filesystem::BlockDeviceCallback callback)
+    {
+        _asyncCallback = callback;
+        _asyncData = nullptr;
+        _asyncRead = false;
+
+        if(!IsDmaBuffer(data))
+        {
+            memcpy(_buffer, data, BlockLength);
+            data = _buffer;
+        }
+        // Card waits for next block of multiple block write, so data path is enabled per block
+        StartData(data, BlockLength, false);
+        Regs()->MASK = DataErrorFlags | SDIO_STA_DATAEND;
+    }
+
+    SDIOCARD_TEMPLATE_ARGS
+    bool SDIOCARD_TEMPLATE_QUALIFIER::EndWrite()
+    {
+        bool result = SendCommand(StopTransmission, 0);
+        return WaitReady() && result;
+    }
+
+    SDIOCARD_TEMPLATE_ARGS
+    void SDIOCARD_TEMPLATE_QUALIFIER::IrqHandler()
+    {
+        uint32_t status = Regs()->STA;
+        if(!(status & (DataErrorFlags | SDIO_STA_DATAEND)))
+            return;
+
+        Regs()->MASK = 0;
+        Regs()->ICR = DataFlags;
+
+        bool success = !(status & DataErrorFlags);
+        if(!success)
+        {
+            AbortData();
+        }
+        else if(_asyncRead)
+        {
+            // Last words may be in SDIO FIFO yet
+            while(!_DmaChannel::Ready())
+                continue;
+            if(!IsDmaBuffer(_asyncData))
+                memcpy(_asyncData, _buffer, BlockLength);
+        }
+
+        Filesystem::BlockDeviceCallback callback = _asyncCallback;
+        _asyncCallback = nullptr;
+        if(callback)
+            callback(success);
+    }
+
+    SDIOCARD_TEMPLATE_ARGS
+    uint32_t SDIOCARD_TEMPLATE_QUALIFIER::AdapterClockFreq()
+    {
+    #if defined (RCC_PLLCFGR_PLLQ)
+        using Pll = Clock::PllClock;
+        return Pll::SrcClockFreq() / Pll::GetDivider() * Pll::GetMultipler() / Pll::GetUsbOutputDivider();
+    #else
+        return Clock::AhbClock::ClockFreq();
+    #endif
+    }
+
+    SDIOCARD_TEMPLATE_ARGS
+    void SDIOCARD_TEMPLATE_QUALIFIER::SetClockFreq(uint32_t maxFreq)
+    {
+        // SDIO_CK = SDIOCLK / (CLKDIV + 2). Bypass mode is not used (errata for stm32f1)
+        uint32_t adapterClock = AdapterClockFreq();
+        uint32_t divider = (adapterClock + maxFreq - 1) / maxFreq;
+        divider = divider < 2 ? 0 : divider - 2;
+        if(divider > 0xff)
+            divider = 0xff;
+
+        Regs()->CLKCR = (Regs()->CLKCR & SDIO_CLKCR_WIDBUS) | SDIO_CLKCR_CLKEN | divider;
+        // 500 ms (write timeout of SDHC card)
+        _dataTimeout = adapterClock / (divider + 2) / 2;
+    }
+
+    SDIOCARD_TEMPLATE_ARGS
+    bool SDIOCARD_TEMPLATE_QUALIFIER::SendCommand(uint8_t index, uint32_t arg, ResponseType response, bool checkCrc)
+    {
+        Regs()->ICR = CommandFlags;
+        Regs()->ARG = arg;
+        Regs()->CMD = (index & SDIO_CMD_CMDINDEX) | response | SDIO_CMD_CPSMEN;
+
+        // Command path state machine has hardware response timeout (64 SDIO_CK), so loops are finite
+        if(response == NoResponse)
+        {
+            while(!(Regs()->STA & SDIO_STA_CMDSENT))
+                continue;
+            Regs()->ICR = CommandFlags;
+            return true;
+        }
+
+        uint32_t status;
+        while(!((status = Regs()->STA) & (SDIO_STA_CMDREND | SDIO_STA_CCRCFAIL | SDIO_STA_CTIMEOUT)))
+            continue;
+        Regs()->ICR = CommandFlags;
+
+        if(status & SDIO_STA_CTIMEOUT)
+            return false;
+        return !checkCrc || !(status & SDIO_STA_CCRCFAIL);
+    }
+
+    SDIOCARD_TEMPLATE_ARGS
+    bool SDIOCARD_TEMPLATE_QUALIFIER::SendAppCommand(uint8_t index, uint32_t arg, bool checkCrc)
+    {
+        return CardCommand(AppCmd, _rca) && SendCommand(index, arg, ShortResponse, checkCrc);
+    }
+
+    SDIOCARD_TEMPLATE_ARGS
+    bool SDIOCARD_TEMPLATE_QUALIFIER::CardCommand(uint8_t index, uint32_t arg)
+    {
+        return SendCommand(index, arg) && !(Regs()->RESP1 & CardStatusErrors);
+    }
+
+    SDIOCARD_TEMPLATE_ARGS
+    bool SDIOCARD_TEMPLATE_QUALIFIER::WaitReady()
+    {
+        // About one second at 24 MHz
+        for(uint32_t timeout = 200000; timeout > 0; --timeout)
+        {
+            if(!CardCommand(SendStatus, _rca))
+                return false;
+            uint32_t status = Regs()->RESP1;
+            if((status & CardReadyForData) && ((status >> 9) & 0x0f) == CardTransferState)
+                return true;
+        }
+        return false;
+    }
+
+    SDIOCARD_TEMPLATE_ARGS
+    uint32_t SDIOCARD_TEMPLATE_QUALIFIER::Address(uint32_t logicalBlockAddress)
+    {
+        return _type == SdhcCard
+            ? logicalBlockAddress
+            : logicalBlockAddress << BlockLengthPower;
+    }
+
+    SDIOCARD_TEMPLATE_ARGS
+    bool SDIOCARD_TEMPLATE_QUALIFIER::IsDmaBuffer(const void* data)
+    {
+        return (reinterpret_cast<uintptr_t>(data) & 0x03) == 0;
+    }
+
+    SDIOCARD_TEMPLATE_ARGS
+    void SDIOCARD_TEMPLATE_QUALIFIER::StartData(const void* data, uint32_t size, bool read)
+    {
+        typename _DmaChannel::Mode mode = _DmaChannel::MemIncrement | _DmaChannel::MSize32Bits | _DmaChannel::PSize32Bits
+            | (read ? _DmaChannel::Periph2Mem : _DmaChannel::Mem2Periph);
+    #if defined (DMA_SxCR_EN)
+        // SDIO requests 4-words bursts and signals end of transfer itself
+        mode = mode | _DmaChannel::PeriphFlowControl | _DmaChannel::MemBurst4 | _DmaChannel::PeriphBurst4;
+        _DmaChannel::SetFifoMode(true);
+    #endif
+        _DmaChannel::ClearFlags();
+        _DmaChannel::Transfer(mode, data, &Regs()->FIFO, size / 4);
+
+        Regs()->ICR = DataFlags;
+        Regs()->DTIMER = _dataTimeout;
+        Regs()->DLEN = size;
+        Regs()->DCTRL = (BlockLengthPower << SDIO_DCTRL_DBLOCKSIZE_Pos) | SDIO_DCTRL_DMAEN | SDIO_DCTRL_DTEN
+            | (read ? SDIO_DCTRL_DTDIR : 0);
+    }
+
+    SDIOCARD_TEMPLATE_ARGS
+    bool SDIOCARD_TEMPLATE_QUALIFIER::WaitDataEnd(bool read)
+    {
+        uint32_t status;
+        while(!((status = Regs()->STA) & (DataErrorFlags | SDIO_STA_DATAEND)))
+            continue;
+        Regs()->ICR = DataFlags;
+
+        if(status & DataErrorFlags)
+        {
+            AbortData();
+            return false;
+        }
+        if(read)
+        {
+            // Last words may be in SDIO FIFO yet
+            while(!_DmaChannel::Ready())
+                continue;
+        }
+        return true;
+    }
+
+    SDIOCARD_TEMPLATE_ARGS
+    void SDIOCARD_TEMPLATE_QUALIFIER::AbortData()
+    {
+        Regs()->DCTRL = 0;
+        Regs()->MASK = 0;
+        _DmaChannel::Disable();
+        Regs()->ICR = DataFlags;
+    }
+
+    SDIOCARD_TEMPLATE_ARGS
+    bool SDIOCARD_TEMPLATE_QUALIFIER::TransferBlocks(uint8_t* data, uint32_t logicalBlockAddress, uint32_t blocksCount, bool read)
+    {
+        if(blocksCount == 0)
+            return true;
+        if(!WaitReady())
+            return false;
+
+        uint32_t address = Address(logicalBlockAddress);
+        uint32_t size = blocksCount * BlockLength;
+        bool multiple = blocksCount > 1;
+
+        if(read)
+        {
+            // Card starts transfer right after response, so data path is enabled before command
+            StartData(data, size, true);
+            if(!CardCommand(multiple ? SdCardCommand::ReadMultipleBlock : ReadSingleBlock, address))
+            {
+                AbortData();
+                return false;
+            }
+        }
+        else
+        {
+            if(multiple)
+                SendAppCommand(SetWrBlkEraseCount, blocksCount);
+            if(!CardCommand(multiple ? SdCardCommand::WriteMultipleBlock : SdCardCommand::WriteBlock, address))
+                return false;
+            StartData(data, size, false);
+        }
+
+        bool result = WaitDataEnd(read);
+        if(multiple)
+            result = SendCommand(StopTransmission, 0) && result;
+        return result;
+    }
+
+    SDIOCARD_TEMPLATE_ARGS
+    SdCardType SDIOCARD_TEMPLATE_QUALIFIER::_type = SdCardNone;
+    SDIOCARD_TEMPLATE_ARGS
+    uint32_t SDIOCARD_TEMPLATE_QUALIFIER::_rca = 0;
+    SDIOCARD_TEMPLATE_ARGS
+    uint32_t SDIOCARD_TEMPLATE_QUALIFIER::_blocksCount = 0;
+    SDIOCARD_TEMPLATE_ARGS
+    uint32_t SDIOCARD_TEMPLATE_QUALIFIER::_dataTimeout = 0;
+    SDIOCARD_TEMPLATE_ARGS
+    uint32_t SDIOCARD_TEMPLATE_QUALIFIER::_streamAddress = 0;
+    SDIOCARD_TEMPLATE_ARGS
+    Filesystem::BlockDeviceCallback SDIOCARD_TEMPLATE_QUALIFIER::_asyncCallback;
+    SDIOCARD_TEMPLATE_ARGS
+    uint8_t* SDIOCARD_TEMPLATE_QUALIFIER::_asyncData = nullptr;
+    SDIOCARD_TEMPLATE_ARGS
+    volatile bool SDIOCARD_TEMPLATE_QUALIFIER::_asyncRead = false;
+    SDIOCARD_TEMPLATE_ARGS
+    alignas(4) uint8_t SDIOCARD_TEMPLATE_QUALIFIER::_buffer[SDIOCARD_TEMPLATE_QUALIFIER::BlockLength];
+}
+
+#endif //! ZHELE_DRIVERS_SDIOCARD_IMPL_H
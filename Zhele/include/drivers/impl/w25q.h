@@ -0,0 +1,297 @@
+/**
+ * @file
+ * Implements W25Qxx SPI NOR flash driver
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DRIVERS_W25Q_IMPL_H
+#define ZHELE_DRIVERS_W25Q_IMPL_H
+
+namespace Zhele::Drivers
+{
+    #define W25Q_TEMPLATE_ARGS template<typename _Spi, typename _CsPin>
+    #define W25Q_TEMPLATE_QUALIFIER W25q<_Spi, _CsPin>
+
+    W25Q_TEMPLATE_ARGS
+    bool W25Q_TEMPLATE_QUALIFIER::Init()
+    {
+        _CsPin::Port::Enable();
+        _CsPin::SetDirWrite();
+        _CsPin::Set();
+
+        // Flash may be in power down mode after MCU reset
+        while(!Queue(&ReleasePowerDownCommand, nullptr, 1, _Spi::SelectAndDeselect))
+            continue;
+        while(!_Spi::TransactionQueueEmpty())
+            continue;
+        delay_us<5>();
+
+        _command[0] = Command::JedecId;
+        while(!Queue(_command, _status, 4, _Spi::SelectAndDeselect))
+            continue;
+        while(!_Spi::TransactionQueueEmpty())
+            continue;
+
+        _id = (_status[1] << 16) | (_status[2] << 8) | _status[3];
+        return Capacity() != 0;
+    }
+
+    W25Q_TEMPLATE_ARGS
+    uint32_t W25Q_TEMPLATE_QUALIFIER::Id()
+    {
+        return _id;
+    }
+
+    W25Q_TEMPLATE_ARGS
+    uint32_t W25Q_TEMPLATE_QUALIFIER::Capacity()
+    {
+        // Capacity code is log2 of size. Chips above 16 MB are accessed in 3-byte address mode (lower 16 MB).
+        uint8_t capacity = _id & 0xff;
+        if(_id == 0xffffff || capacity < 0x10 || capacity > 0x20)
+            return 0;
+        return 1ul << (capacity > 24 ? 24 : capacity);
+    }
+
+    W25Q_TEMPLATE_ARGS
+    bool W25Q_TEMPLATE_QUALIFIER::Busy()
+    {
+        return _busy;
+    }
+
+    W25Q_TEMPLATE_ARGS
+    bool W25Q_TEMPLATE_QUALIFIER::WaitReady()
+    {
+        while(_busy)
+            continue;
+        return _result;
+    }
+
+    W25Q_TEMPLATE_ARGS
+    bool W25Q_TEMPLATE_QUALIFIER::Read(uint32_t address, void* data, size_t size)
+    {
+        while(!ReadAsync(address, data, size))
+            continue;
+        return WaitReady();
+    }
+
+    W25Q_TEMPLATE_ARGS
+    bool W25Q_TEMPLATE_QUALIFIER::ReadAsync(uint32_t address, void* data, size_t size, Callback callback)
+    {
+        if(!BeginOperation(2, callback))
+            return false;
+
+        _data = static_cast<uint8_t*>(data);
+        _address = address;
+        _remaining = size;
+        if(size == 0)
+            CompleteOperation(true);
+        else if(!QueueNextRead())
+            CompleteOperation(false);
+        return true;
+    }
+
+    W25Q_TEMPLATE_ARGS
+    bool W25Q_TEMPLATE_QUALIFIER::Program(uint32_t address, const void* data, size_t size)
+    {
+        while(!ProgramAsync(address, data, size))
+            continue;
+        return WaitReady();
+    }
+
+    W25Q_TEMPLATE_ARGS
+    bool W25Q_TEMPLATE_QUALIFIER::ProgramAsync(uint32_t address, const void* data, size_t size, Callback callback)
+    {
+        if(!BeginOperation(3, callback))
+            return false;
+
+        _data = const_cast<uint8_t*>(static_cast<const uint8_t*>(data));
+        _address = address;
+        _remaining = size;
+        if(size == 0)
+            CompleteOperation(true);
+        else if(!QueueNextPage())
+            CompleteOperation(false);
+        return true;
+    }
+
+    W25Q_TEMPLATE_ARGS
+    bool W25Q_TEMPLATE_QUALIFIER::EraseSector(uint32_t address)
+    {
+        while(!EraseSectorAsync(address))
+            continue;
+        return WaitReady();
+    }
+
+    W25Q_TEMPLATE_ARGS
+    bool W25Q_TEMPLATE_QUALIFIER::EraseSectorAsync(uint32_t address, Callback callback)
+    {
+        return StartErase(Command::SectorErase, address, true, callback);
+    }
+
+    W25Q_TEMPLATE_ARGS
+    bool W25Q_TEMPLATE_QUALIFIER::EraseBlockAsync(uint32_t address, Callback callback)
+    {
+        return StartErase(Command::BlockErase, address, true, callback);
+    }
+
+    W25Q_TEMPLATE_ARGS
+    bool W25Q_TEMPLATE_QUALIFIER::EraseChipAsync(Callback callback)
+    {
+        return StartErase(Command::ChipErase, 0, false, callback);
+    }
+
+    W25Q_TEMPLATE_ARGS
+    bool W25Q_TEMPLATE_QUALIFIER::Queue(const void* transmitBuffer, void* receiveBuffer, uint16_t size,
+        typename _Spi::ChipSelectAction chipSelectAction, TransferCallback callback)
+    {
+        typename _Spi::Transaction transaction {};
+        transaction.transmitBuffer = transmitBuffer;
+        transaction.receiveBuffer = receiveBuffer;
+        transaction.size = size;
+        transaction.dataSize = _Spi::DataSize8;
+        transaction.chipSelect = _Spi::template ActiveLowChipSelect<_CsPin>;
+        transaction.chipSelectAction = chipSelectAction;
+        transaction.callback = callback;
+
+        return _Spi::QueueTransaction(transaction);
+    }
+
+    W25Q_TEMPLATE_ARGS
+    void W25Q_TEMPLATE_QUALIFIER::SetCommand(Command command, uint32_t address)
+    {
+        _command[0] = command;
+        _command[1] = address >> 16;
+        _command[2] = address >> 8;
+        _command[3] = address;
+    }
+
+    W25Q_TEMPLATE_ARGS
+    bool W25Q_TEMPLATE_QUALIFIER::BeginOperation(size_t transactions, Callback callback)
+    {
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        bool ready = !_busy && _Spi::TransactionQueueFree() >= transactions;
+        if(ready)
+        {
+            _busy = true;
+            _callback = callback;
+        }
+        __set_PRIMASK(primask);
+
+        return ready;
+    }
+
+    W25Q_TEMPLATE_ARGS
+    void W25Q_TEMPLATE_QUALIFIER::CompleteOperation(bool success)
+    {
+        Callback callback = _callback;
+        _callback = nullptr;
+        _result = success;
+        _busy = false;
+        if(callback)
+            callback(success);
+    }
+
+    W25Q_TEMPLATE_ARGS
+    bool W25Q_TEMPLATE_QUALIFIER::StartErase(Command command, uint32_t address, bool withAddress, Callback callback)
+    {
+        if(!BeginOperation(2, callback))
+            return false;
+
+        _remaining = 0;
+        _chunkSize = 0;
+        SetCommand(command, address);
+        if(!(Queue(&WriteEnableCommand, nullptr, 1, _Spi::SelectAndDeselect)
+            && Queue(_command, nullptr, withAddress ? 4 : 1, _Spi::SelectAndDeselect, OnCommandSent)))
+        {
+            CompleteOperation(false);
+        }
+        return true;
+    }
+
+    W25Q_TEMPLATE_ARGS
+    bool W25Q_TEMPLATE_QUALIFIER::QueueNextRead()
+    {
+        // Chip select is held by command transaction, so both transactions should be queued
+        if(_Spi::TransactionQueueFree() < 2)
+            return false;
+
+        _chunkSize = _remaining > 0xffff ? 0xffff : _remaining;
+        SetCommand(Command::FastRead, _address);
+        _command[4] = 0xff; // Dummy byte
+        return Queue(_command, nullptr, 5, _Spi::SelectBefore)
+            && Queue(nullptr, _data, _chunkSize, _Spi::DeselectAfter, OnReadComplete);
+    }
+
+    W25Q_TEMPLATE_ARGS
+    bool W25Q_TEMPLATE_QUALIFIER::QueueNextPage()
+    {
+        if(_Spi::TransactionQueueFree() < 3)
+            return false;
+
+        uint32_t pageRemaining = PageSize - (_address % PageSize);
+        _chunkSize = _remaining > pageRemaining ? pageRemaining : _remaining;
+        SetCommand(Command::PageProgram, _address);
+        return Queue(&WriteEnableCommand, nullptr, 1, _Spi::SelectAndDeselect)
+            && Queue(_command, nullptr, 4, _Spi::SelectBefore)
+            && Queue(_data, nullptr, _chunkSize, _Spi::DeselectAfter, OnCommandSent);
+    }
+
+    W25Q_TEMPLATE_ARGS
+    void W25Q_TEMPLATE_QUALIFIER::QueuePoll()
+    {
+        if(_Spi::TransactionQueueFree() < 2
+            || !(Queue(&ReadStatusCommand, nullptr, 1, _Spi::SelectBefore)
+                && Queue(nullptr, _status, ZHELE_W25Q_POLL_SIZE, _Spi::DeselectAfter, OnStatusPolled)))
+        {
+            CompleteOperation(false);
+        }
+    }
+
+    W25Q_TEMPLATE_ARGS
+    void W25Q_TEMPLATE_QUALIFIER::OnReadComplete(void* data, unsigned size, bool success)
+    {
+        _data += _chunkSize;
+        _address += _chunkSize;
+        _remaining -= _chunkSize;
+
+        if(!success)
+            CompleteOperation(false);
+        else if(_remaining == 0)
+            CompleteOperation(true);
+        else if(!QueueNextRead())
+            CompleteOperation(false);
+    }
+
+    W25Q_TEMPLATE_ARGS
+    void W25Q_TEMPLATE_QUALIFIER::OnCommandSent(void* data, unsigned size, bool success)
+    {
+        _data += _chunkSize;
+        _address += _chunkSize;
+        _remaining -= _chunkSize;
+
+        if(!success)
+            CompleteOperation(false);
+        else
+            QueuePoll();
+    }
+
+    W25Q_TEMPLATE_ARGS
+    void W25Q_TEMPLATE_QUALIFIER::OnStatusPolled(void* data, unsigned size, bool success)
+    {
+        if(!success)
+            CompleteOperation(false);
+        // Status register is sent continuously, the last byte is the most recent
+        else if((_status[ZHELE_W25Q_POLL_SIZE - 1] & StatusBusy) != 0)
+            QueuePoll();
+        else if(_remaining == 0)
+            CompleteOperation(true);
+        else if(!QueueNextPage())
+            CompleteOperation(false);
+    }
+}
+
+#endif //! ZHELE_DRIVERS_W25Q_IMPL_H
@@ -0,0 +1,254 @@
+/**
+ * @file
+ * WS2812 driver methods implementation
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DRIVERS_WS2812_IMPL_H
+#define ZHELE_DRIVERS_WS2812_IMPL_H
+
+namespace Zhele::Drivers
+{
+    template<typename _Spi>
+    uint32_t Ws2812SpiTransport<_Spi>::Init()
+    {
+        _Spi::Init(_Spi::ClockDivider::Medium, _Spi::Mode::Master);
+        return _Spi::SetClockFreq(2900000) / 8;
+    }
+
+    template<typename _Spi>
+    void Ws2812SpiTransport<_Spi>::Encode(uint8_t value, Slot* slots)
+    {
+        uint32_t bits = _table[value];
+        slots[0] = static_cast<uint8_t>(bits >> 16);
+        slots[1] = static_cast<uint8_t>(bits >> 8);
+        slots[2] = static_cast<uint8_t>(bits);
+    }
+
+    template<typename _Spi>
+    void Ws2812SpiTransport<_Spi>::Start(Slot* buffer, uint16_t halfSize, TransferCallback callback)
+    {
+        _Spi::WriteStream(buffer, halfSize, callback);
+    }
+
+    template<typename _Spi>
+    void Ws2812SpiTransport<_Spi>::Stop()
+    {
+        _Spi::StopWriteStream();
+    }
+
+    #define WS2812TIMERTRANSPORT_TEMPLATE_ARGS template<typename _Timer, unsigned _Channel, typename _DmaChannel, uint8_t _DmaRequest>
+    #define WS2812TIMERTRANSPORT_TEMPLATE_QUALIFIER Ws2812TimerTransport<_Timer, _Channel, _DmaChannel, _DmaRequest>
+
+    WS2812TIMERTRANSPORT_TEMPLATE_ARGS
+    uint16_t WS2812TIMERTRANSPORT_TEMPLATE_QUALIFIER::_zero = 0;
+
+    WS2812TIMERTRANSPORT_TEMPLATE_ARGS
+    uint16_t WS2812TIMERTRANSPORT_TEMPLATE_QUALIFIER::_one = 0;
+
+    WS2812TIMERTRANSPORT_TEMPLATE_ARGS
+    uint32_t WS2812TIMERTRANSPORT_TEMPLATE_QUALIFIER::Init()
+    {
+        uint32_t clock = _Timer::GetClockFreq();
+        uint16_t period = static_cast<uint16_t>((clock + BitFreq / 2) / BitFreq);
+        _zero = static_cast<uint16_t>(static_cast<uint64_t>(clock) * 35 / 100000000);
+        _one = static_cast<uint16_t>(static_cast<uint64_t>(clock) * 70 / 100000000);
+
+        _Timer::Enable();
+        _Timer::SetPrescaler(0);
+        _Timer::SetPeriod(period - 1);
+        Pwm::SetOutputMode(Pwm::OutputMode::PWM1);
+        Pwm::SetPulse(0);
+        Pwm::Enable();
+        _Timer::Start();
+
+        return clock / period;
+    }
+
+    WS2812TIMERTRANSPORT_TEMPLATE_ARGS
+    void WS2812TIMERTRANSPORT_TEMPLATE_QUALIFIER::Encode(uint8_t value, Slot* slots)
+    {
+        const uint16_t zero = _zero;
+        const uint16_t one = _one;
+        for (unsigned bit = 0; bit < 8; ++bit, value <<= 1)
+            slots[bit] = (value & 0x80) != 0 ? one : zero;
+    }
+
+    WS2812TIMERTRANSPORT_TEMPLATE_ARGS
+    void WS2812TIMERTRANSPORT_TEMPLATE_QUALIFIER::Start(Slot* buffer, uint16_t halfSize, TransferCallback callback)
+    {
+        using DmaBurstBase = typename _Timer::DmaBurstBase;
+        constexpr auto ccr = static_cast<DmaBurstBase>(static_cast<uint8_t>(DmaBurstBase::Ccr1) + _Channel);
+        _Timer::template StartDmaBurst<_DmaChannel>(ccr, 1, buffer, 2 * halfSize, true, callback ONLY_IF_STREAM_SUPPORTED(COMMA _DmaRequest));
+    }
+
+    WS2812TIMERTRANSPORT_TEMPLATE_ARGS
+    void WS2812TIMERTRANSPORT_TEMPLATE_QUALIFIER::Stop()
+    {
+        _Timer::template StopDmaBurst<_DmaChannel>();
+        // Last slots are zeros, so output is already low
+        Pwm::SetPulse(0);
+    }
+
+    #define WS2812_TEMPLATE_ARGS template<typename _Transport, unsigned _Count, Ws2812Format _Format, unsigned _ChunkLeds>
+    #define WS2812_TEMPLATE_QUALIFIER Ws2812<_Transport, _Count, _Format, _ChunkLeds>
+
+    WS2812_TEMPLATE_ARGS
+    uint8_t WS2812_TEMPLATE_QUALIFIER::_pixels[_Count * BytesPerLed];
+
+    WS2812_TEMPLATE_ARGS
+    typename WS2812_TEMPLATE_QUALIFIER::Slot WS2812_TEMPLATE_QUALIFIER::_buffer[2 * ChunkSlots];
+
+    WS2812_TEMPLATE_ARGS
+    uint32_t WS2812_TEMPLATE_QUALIFIER::_resetSlots = 0;
+
+    WS2812_TEMPLATE_ARGS
+    typename WS2812_TEMPLATE_QUALIFIER::Callback WS2812_TEMPLATE_QUALIFIER::_callback = nullptr;
+
+    WS2812_TEMPLATE_ARGS
+    uint16_t WS2812_TEMPLATE_QUALIFIER::_brightness = 256;
+
+    WS2812_TEMPLATE_ARGS
+    unsigned WS2812_TEMPLATE_QUALIFIER::_nextLed = 0;
+
+    WS2812_TEMPLATE_ARGS
+    uint32_t WS2812_TEMPLATE_QUALIFIER::_resetLeft = 0;
+
+    WS2812_TEMPLATE_ARGS
+    typename WS2812_TEMPLATE_QUALIFIER::Slot* WS2812_TEMPLATE_QUALIFIER::_lastChunk = nullptr;
+
+    WS2812_TEMPLATE_ARGS
+    volatile bool WS2812_TEMPLATE_QUALIFIER::_busy = false;
+
+    WS2812_TEMPLATE_ARGS
+    void WS2812_TEMPLATE_QUALIFIER::Init()
+    {
+        uint32_t rate = _Transport::Init();
+        _resetSlots = static_cast<uint32_t>(static_cast<uint64_t>(rate) * ResetTime / 1000000) + 1;
+        Clear();
+        _busy = false;
+    }
+
+    WS2812_TEMPLATE_ARGS
+    void WS2812_TEMPLATE_QUALIFIER::SetPixel(unsigned index, uint8_t red, uint8_t green, uint8_t blue, uint8_t white)
+    {
+        if (index >= _Count)
+            return;
+
+        uint8_t* pixel = &_pixels[index * BytesPerLed];
+        pixel[0] = green;
+        pixel[1] = red;
+        pixel[2] = blue;
+        if constexpr (BytesPerLed == 4)
+            pixel[3] = white;
+    }
+
+    WS2812_TEMPLATE_ARGS
+    void WS2812_TEMPLATE_QUALIFIER::SetPixel(unsigned index, uint32_t color)
+    {
+        SetPixel(index, static_cast<uint8_t>(color >> 16), static_cast<uint8_t>(color >> 8), static_cast<uint8_t>(color), static_cast<uint8_t>(color >> 24));
+    }
+
+    WS2812_TEMPLATE_ARGS
+    void WS2812_TEMPLATE_QUALIFIER::Fill(uint32_t color)
+    {
+        for (unsigned i = 0; i < _Count; ++i)
+            SetPixel(i, color);
+    }
+
+    WS2812_TEMPLATE_ARGS
+    void WS2812_TEMPLATE_QUALIFIER::Clear()
+    {
+        for (unsigned i = 0; i < sizeof(_pixels); ++i)
+            _pixels[i] = 0;
+    }
+
+    WS2812_TEMPLATE_ARGS
+    void WS2812_TEMPLATE_QUALIFIER::SetBrightness(uint8_t brightness)
+    {
+        _brightness = static_cast<uint16_t>(brightness) + 1;
+    }
+
+    WS2812_TEMPLATE_ARGS
+    uint8_t* WS2812_TEMPLATE_QUALIFIER::Pixels()
+    {
+        return _pixels;
+    }
+
+    WS2812_TEMPLATE_ARGS
+    bool WS2812_TEMPLATE_QUALIFIER::Update(Callback callback)
+    {
+        if (_busy)
+            return false;
+
+        _busy = true;
+        _callback = callback;
+        _nextLed = 0;
+        _resetLeft = _resetSlots;
+        _lastChunk = nullptr;
+
+        FillChunk(_buffer);
+        FillChunk(_buffer + ChunkSlots);
+        _Transport::Start(_buffer, ChunkSlots, OnChunkSent);
+        return true;
+    }
+
+    WS2812_TEMPLATE_ARGS
+    bool WS2812_TEMPLATE_QUALIFIER::Busy()
+    {
+        return _busy;
+    }
+
+    WS2812_TEMPLATE_ARGS
+    void WS2812_TEMPLATE_QUALIFIER::FillChunk(Slot* chunk)
+    {
+        unsigned slot = 0;
+        if (_nextLed < _Count)
+        {
+            unsigned last = _nextLed + _ChunkLeds < _Count ? _nextLed + _ChunkLeds : _Count;
+            const uint8_t* pixel = &_pixels[_nextLed * BytesPerLed];
+            const uint8_t* end = &_pixels[last * BytesPerLed];
+            const uint16_t brightness = _brightness;
+            for (; pixel != end; ++pixel, slot += _Transport::SlotsPerByte)
+                _Transport::Encode(static_cast<uint8_t>((*pixel * brightness) >> 8), &chunk[slot]);
+            _nextLed = last;
+        }
+
+        // Rest of chunk after the last LED is part of reset
+        if (slot < ChunkSlots)
+        {
+            for (unsigned i = slot; i < ChunkSlots; ++i)
+                chunk[i] = 0;
+
+            if (_resetLeft > 0)
+            {
+                uint32_t zeros = ChunkSlots - slot;
+                _resetLeft = _resetLeft > zeros ? _resetLeft - zeros : 0;
+                if (_resetLeft == 0)
+                    _lastChunk = chunk;
+            }
+        }
+    }
+
+    WS2812_TEMPLATE_ARGS
+    void WS2812_TEMPLATE_QUALIFIER::OnChunkSent(void* data, unsigned, bool)
+    {
+        Slot* chunk = static_cast<Slot*>(data);
+        if (chunk == _lastChunk)
+        {
+            // Chunk which completes reset is sent, the other one (zeros only) is dropped
+            _Transport::Stop();
+            _busy = false;
+            if (_callback != nullptr)
+                _callback();
+            return;
+        }
+
+        FillChunk(chunk);
+    }
+}
+
+#endif //! ZHELE_DRIVERS_WS2812_IMPL_H
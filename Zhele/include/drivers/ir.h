@@ -12,6 +12,11 @@
 #ifndef ZHELE_DRIVERS_IR_H
 #define ZHELE_DRIVERS_IR_H
 
+#include <dma.h>
+
+#include <stdint.h>
+#include <type_traits>
+
 namespace Zhele::Drivers
 {
     /**
@@ -126,6 +131,85 @@ namespace Zhele::Drivers
         }
     };
 
+    /**
+     * @brief Decodes IR frames from falling edges timestamps block
+     * 
+     * @details
+     * Bulk alternative to IrReceiver: edges are captured by DMA (see InputCapture::StartCaptureStream),
+     * timestamps (1 us units) are extended by CaptureTimestamps and decoded at once in DMA callback.
+     * Bits are recognized by interval between falling edges (pulse + space), so one capture channel is enough.
+     * 
+     * @tparam _Decoder Decoder
+     */
+    template <typename _Decoder>
+    class IrEdgeDecoder
+    {
+    public:
+        /**
+         * @brief Decode falling edges
+         * 
+         * @param [in] timestamps Falling edges timestamps (us)
+         * @param [in] count Timestamps count
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Process(const uint32_t* timestamps, unsigned count)
+        {
+            for(unsigned i = 0; i < count; ++i)
+            {
+                uint32_t width = timestamps[i] - _lastEdge;
+                _lastEdge = timestamps[i];
+
+                if(IsSimilar<_Decoder::StartWidth>(width)) {
+                    _Decoder::Start();
+                    _bits = 0;
+                    _inFrame = true;
+                    continue;
+                }
+
+                if(!_inFrame)
+                    continue;
+
+                if(IsSimilar<_Decoder::Width0>(width)) {
+                    _Decoder::Add0();
+                }
+                else if(IsSimilar<_Decoder::Width1>(width)) {
+                    _Decoder::Add1();
+                }
+                else {
+                    _inFrame = false;
+                    continue;
+                }
+
+                if(++_bits == _Decoder::FrameBits) {
+                    _inFrame = false;
+                    _Decoder::Handle();
+                }
+            }
+        }
+
+    private:
+        template<uint16_t _TargetValue>
+        inline static bool IsSimilar(uint32_t value)
+        {
+            return ((_TargetValue * (100 - _Decoder::EpsilonInPercent) / 100) < value) && (value < (_TargetValue * (100 + _Decoder::EpsilonInPercent) / 100));
+        }
+
+        static uint32_t _lastEdge;
+        static uint8_t _bits;
+        static bool _inFrame;
+    };
+
+    template <typename _Decoder>
+    uint32_t IrEdgeDecoder<_Decoder>::_lastEdge = 0;
+
+    template <typename _Decoder>
+    uint8_t IrEdgeDecoder<_Decoder>::_bits = 0;
+
+    template <typename _Decoder>
+    bool IrEdgeDecoder<_Decoder>::_inFrame = false;
+
     /**
      * @brief NEC decoder
      */
@@ -143,6 +227,8 @@ namespace Zhele::Drivers
 
         static const uint16_t EpsilonInPercent = 20;
 
+        static const uint8_t FrameBits = 32;
+
         /// Command
         /// @todo Add commands
         enum Command : uint16_t
@@ -227,5 +313,468 @@ namespace Zhele::Drivers
 
     uint32_t NecDecoder::_frame;
     NecDecoder::Callback NecDecoder::_callback;
+
+    /// IR protocols
+    enum class IrProtocol : uint8_t
+    {
+        Nec,  ///< NEC (and extended NEC)
+        Rc5,  ///< Philips RC5 (and RC5X)
+        Rc6,  ///< Philips RC6 mode 0
+        Sirc  ///< Sony SIRC (12, 15 and 20 bits)
+    };
+
+    /// IR bits coding
+    enum class IrCoding : uint8_t
+    {
+        PulseDistance, ///< Fixed mark, bit value is space duration (NEC)
+        PulseWidth,    ///< Fixed space, bit value is mark duration (SIRC)
+        Biphase        ///< Manchester coding, every bit is two half bits (RC5, RC6)
+    };
+
+    /**
+     * @brief IR protocol timing descriptor (all durations in us)
+     */
+    struct IrProtocolTiming
+    {
+        IrProtocol Protocol;
+        IrCoding Coding;
+        uint16_t HeaderMark;  ///< Header mark (0 if protocol has no header)
+        uint16_t HeaderSpace; ///< Header space
+        uint16_t RepeatSpace; ///< Repeat code space after header mark (0 if protocol has no repeat code)
+        uint16_t Unit;        ///< Fixed mark/space for pulse coding, half bit for biphase
+        uint16_t Zero;        ///< Bit 0 variable mark/space (pulse coding only)
+        uint16_t One;         ///< Bit 1 variable mark/space (pulse coding only)
+        uint8_t MinBits;      ///< Min data bits count
+        uint8_t MaxBits;      ///< Max data bits count
+        bool MsbFirst;        ///< Bits order
+        uint8_t LongBit;      ///< Index of double width bit for biphase (RC6 trailer bit), 0xff if none
+        bool MarkFirstOne;    ///< Biphase bit 1 is mark then space (RC6), otherwise space then mark (RC5)
+        uint8_t Tolerance;    ///< Timing tolerance (percent)
+    };
+
+    /**
+     * @brief Timings table of supported IR protocols
+     */
+    struct IrProtocols
+    {
+        static constexpr IrProtocolTiming Nec {IrProtocol::Nec, IrCoding::PulseDistance, 9000, 4500, 2250, 562, 562, 1687, 32, 32, false, 0xff, false, 25};
+        static constexpr IrProtocolTiming Sirc {IrProtocol::Sirc, IrCoding::PulseWidth, 2400, 600, 0, 600, 600, 1200, 12, 20, false, 0xff, false, 25};
+        // RC5 first (start) bit is always 1, so its leading space merges with idle line
+        static constexpr IrProtocolTiming Rc5 {IrProtocol::Rc5, IrCoding::Biphase, 0, 0, 0, 889, 0, 0, 14, 14, true, 0xff, false, 25};
+        static constexpr IrProtocolTiming Rc6 {IrProtocol::Rc6, IrCoding::Biphase, 2666, 889, 0, 444, 0, 0, 21, 21, true, 4, true, 25};
+    };
+
+    /**
+     * @brief Decoded IR frame
+     */
+    struct IrFrame
+    {
+        IrProtocol Protocol;
+        uint8_t Bits;      ///< Data bits count
+        bool Repeat;       ///< Repeat code (NEC), address and command are copied from previous frame
+        bool Toggle;       ///< Toggle bit (RC5, RC6)
+        uint16_t Address;  ///< Address (device)
+        uint16_t Command;  ///< Command
+        uint32_t Data;     ///< Raw data bits
+    };
+
+    /**
+     * @brief Table-driven IR frame decoder
+     * 
+     * @details
+     * Decoder collects marks and spaces durations of one frame and matches them
+     * against protocols timings (in template arguments order) when frame end is detected.
+     * 
+     * @tparam _Protocols Protocols timings (see IrProtocols)
+     */
+    template<const IrProtocolTiming&... _Protocols>
+    class IrFrameDecoder
+    {
+    public:
+        /// Max marks and spaces count in frame (NEC frame is 67)
+        static const uint8_t MaxDurations = 72;
+
+        using Callback = std::add_pointer_t<void(const IrFrame& frame)>;
+
+        /**
+         * @brief Set the callback for frame receive
+         * 
+         * @param [in] callback Callback
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void SetCallback(Callback callback)
+        {
+            _callback = callback;
+        }
+
+        /**
+         * @brief Start new frame (first mark begins)
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Begin()
+        {
+            _count = 0;
+            _overflow = false;
+        }
+
+        /**
+         * @brief Add duration to frame (marks and spaces alternate, starting with mark)
+         * 
+         * @param [in] duration Duration (us)
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Add(uint16_t duration)
+        {
+            if(_count < MaxDurations)
+                _durations[_count++] = duration;
+            else
+                _overflow = true;
+        }
+
+        /**
+         * @brief End of frame (pause detect) handler
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void End()
+        {
+            if(_overflow)
+                return;
+
+            IrFrame frame {};
+            if(!(Match(_Protocols, frame) || ...))
+                return;
+
+            if(!frame.Repeat)
+                _last = frame;
+            if(_callback)
+                _callback(frame);
+        }
+
+    private:
+        static bool Match(const IrProtocolTiming& protocol, IrFrame& frame)
+        {
+            frame.Protocol = protocol.Protocol;
+            frame.Data = 0;
+            bool matched = protocol.Coding == IrCoding::Biphase
+                ? MatchBiphase(protocol, frame)
+                : MatchPulses(protocol, frame);
+            return matched && (frame.Repeat || ExtractFields(frame));
+        }
+
+        static bool MatchPulses(const IrProtocolTiming& protocol, IrFrame& frame)
+        {
+            if(_count < 3 || !IsSimilar(_durations[0], protocol.HeaderMark, protocol.Tolerance))
+                return false;
+
+            if(protocol.RepeatSpace != 0 && _count == 3 && IsSimilar(_durations[1], protocol.RepeatSpace, protocol.Tolerance))
+            {
+                if(_last.Bits == 0 || _last.Protocol != protocol.Protocol || !IsSimilar(_durations[2], protocol.Unit, protocol.Tolerance))
+                    return false;
+                frame = _last;
+                frame.Repeat = true;
+                return true;
+            }
+
+            if(!IsSimilar(_durations[1], protocol.HeaderSpace, protocol.Tolerance))
+                return false;
+
+            // Frame ends with mark: stop mark for pulse distance coding, last bit mark for pulse width
+            bool distance = protocol.Coding == IrCoding::PulseDistance;
+            if((_count & 0x01) == 0)
+                return false;
+            uint8_t bits = distance ? (_count - 3) / 2 : (_count - 1) / 2;
+            if(bits < protocol.MinBits || bits > protocol.MaxBits)
+                return false;
+            if(distance && !IsSimilar(_durations[_count - 1], protocol.Unit, protocol.Tolerance))
+                return false;
+
+            for(uint8_t i = 0; i < bits; ++i)
+            {
+                uint8_t markIndex = 2 + 2 * i;
+                uint8_t spaceIndex = markIndex + 1;
+                uint16_t variable = distance ? _durations[spaceIndex] : _durations[markIndex];
+                // Space of last pulse width bit merges with pause
+                if(distance || spaceIndex < _count)
+                {
+                    uint16_t fixed = distance ? _durations[markIndex] : _durations[spaceIndex];
+                    if(!IsSimilar(fixed, protocol.Unit, protocol.Tolerance))
+                        return false;
+                }
+
+                if(IsSimilar(variable, protocol.One, protocol.Tolerance))
+                    AddBit(frame.Data, i, bits, protocol.MsbFirst);
+                else if(!IsSimilar(variable, protocol.Zero, protocol.Tolerance))
+                    return false;
+            }
+
+            frame.Bits = bits;
+            return true;
+        }
+
+        static bool MatchBiphase(const IrProtocolTiming& protocol, IrFrame& frame)
+        {
+            uint8_t index = 0;
+            if(protocol.HeaderMark != 0)
+            {
+                if(_count < 3 || !IsSimilar(_durations[0], protocol.HeaderMark, protocol.Tolerance)
+                    || !IsSimilar(_durations[1], protocol.HeaderSpace, protocol.Tolerance))
+                    return false;
+                index = 2;
+            }
+
+            // Half bits levels (set bit is mark), first bit is always 1
+            uint64_t halves = 0;
+            uint8_t length = protocol.MarkFirstOne ? 0 : 1;
+            for(bool mark = true; index < _count; ++index, mark = !mark)
+            {
+                uint8_t count = HalfBits(_durations[index], protocol);
+                if(count == 0 || length + count > 64)
+                    return false;
+                if(mark)
+                    halves |= ((1ull << count) - 1) << length;
+                length += count;
+            }
+
+            // Last space half bit merges with pause
+            uint8_t extra = protocol.LongBit != 0xff ? 2 : 0;
+            if(length <= extra)
+                return false;
+            uint8_t bits = (length - extra + 1) / 2;
+            if(bits < protocol.MinBits || bits > protocol.MaxBits)
+                return false;
+
+            uint8_t position = 0;
+            for(uint8_t i = 0; i < bits; ++i)
+            {
+                uint8_t width = i == protocol.LongBit ? 2 : 1;
+                bool first = (halves >> position) & 0x01;
+                for(uint8_t half = 0; half < 2 * width; ++half)
+                {
+                    if((((halves >> (position + half)) & 0x01) != 0) != (half < width ? first : !first))
+                        return false;
+                }
+
+                if(first == protocol.MarkFirstOne)
+                    AddBit(frame.Data, i, bits, protocol.MsbFirst);
+                position += 2 * width;
+            }
+
+            frame.Bits = bits;
+            return true;
+        }
+
+        static bool ExtractFields(IrFrame& frame)
+        {
+            uint32_t data = frame.Data;
+            switch(frame.Protocol)
+            {
+            case IrProtocol::Nec:
+            {
+                uint8_t address = data & 0xff;
+                uint8_t addressInverted = (data >> 8) & 0xff;
+                if((((data >> 16) ^ (data >> 24)) & 0xff) != 0xff)
+                    return false;
+                // Extended NEC uses 16-bit address instead of inverted address byte
+                frame.Address = (address ^ addressInverted) == 0xff ? address : (data & 0xffff);
+                frame.Command = (data >> 16) & 0xff;
+                return true;
+            }
+            case IrProtocol::Sirc:
+                frame.Command = data & 0x7f;
+                frame.Address = data >> 7;
+                return true;
+            case IrProtocol::Rc5:
+                // S1, S2 (inverted bit 6 of command for RC5X), toggle, 5 address bits, 6 command bits
+                frame.Command = (data & 0x3f) | (((data >> 12) & 0x01) ? 0 : 0x40);
+                frame.Address = (data >> 6) & 0x1f;
+                frame.Toggle = (data >> 11) & 0x01;
+                return true;
+            case IrProtocol::Rc6:
+                // Start bit, 3 mode bits (mode 0 only), trailer (toggle) bit, 8 address bits, 8 command bits
+                if(((data >> 17) & 0x0f) != 0x08)
+                    return false;
+                frame.Command = data & 0xff;
+                frame.Address = (data >> 8) & 0xff;
+                frame.Toggle = (data >> 16) & 0x01;
+                return true;
+            }
+            return false;
+        }
+
+        static void AddBit(uint32_t& data, uint8_t index, uint8_t bits, bool msbFirst)
+        {
+            data |= 1ul << (msbFirst ? bits - 1 - index : index);
+        }
+
+        static uint8_t HalfBits(uint16_t duration, const IrProtocolTiming& protocol)
+        {
+            uint32_t count = (duration + protocol.Unit / 2) / protocol.Unit;
+            if(count == 0 || count > 4)
+                return 0;
+            uint32_t expected = count * protocol.Unit;
+            uint32_t error = duration > expected ? duration - expected : expected - duration;
+            return error <= protocol.Unit * protocol.Tolerance / 100 ? count : 0;
+        }
+
+        static bool IsSimilar(uint16_t value, uint16_t target, uint8_t tolerance)
+        {
+            return (static_cast<uint32_t>(target) * (100 - tolerance) / 100 < value)
+                && (value < static_cast<uint32_t>(target) * (100 + tolerance) / 100);
+        }
+
+        static uint16_t _durations[MaxDurations];
+        static uint8_t _count;
+        static bool _overflow;
+        static IrFrame _last;
+        static Callback _callback;
+    };
+
+    template<const IrProtocolTiming&... _Protocols>
+    uint16_t IrFrameDecoder<_Protocols...>::_durations[MaxDurations];
+
+    template<const IrProtocolTiming&... _Protocols>
+    uint8_t IrFrameDecoder<_Protocols...>::_count = 0;
+
+    template<const IrProtocolTiming&... _Protocols>
+    bool IrFrameDecoder<_Protocols...>::_overflow = false;
+
+    template<const IrProtocolTiming&... _Protocols>
+    IrFrame IrFrameDecoder<_Protocols...>::_last {};
+
+    template<const IrProtocolTiming&... _Protocols>
+    typename IrFrameDecoder<_Protocols...>::Callback IrFrameDecoder<_Protocols...>::_callback = nullptr;
+
+    /// Decoder of all supported protocols (SIRC is matched before RC6 because of similar header marks)
+    using IrMultiDecoder = IrFrameDecoder<IrProtocols::Nec, IrProtocols::Sirc, IrProtocols::Rc5, IrProtocols::Rc6>;
+
+    /**
+     * @brief IR receiver without edge interrupts
+     * 
+     * @details
+     * Both edges of timer channel 1 input are captured via TI1 edge detector (TRC input,
+     * so it works on stm32f1 too) and DMA writes 16-bit timestamps (1 us) to ring buffer.
+     * CPU does nothing per edge: Poll method (call it from main loop or event loop task
+     * at least every 30 ms) converts new edges to marks/spaces and passes frame to decoder
+     * after pause. Receiver output is expected to be active low (idle high).
+     * 
+     * @tparam _Timer GP timer instance
+     * @tparam _Pin Input pin (timer channel 1)
+     * @tparam _DmaChannel DMA channel (stream) connected to timer channel 1 capture request
+     * @tparam _Decoder Decoder (see IrFrameDecoder)
+     * @tparam _BufferSize Timestamps ring buffer size
+     */
+    template<typename _Timer, typename _Pin, typename _DmaChannel, typename _Decoder = IrMultiDecoder, uint16_t _BufferSize = 128>
+    class IrCaptureReceiver
+    {
+        using Capture = typename _Timer::template InputCapture<0>;
+
+    public:
+        /// Pause between frames (us). Longest space inside frame is NEC header space (4.5 ms)
+        static const uint16_t FrameGap = 7000;
+
+        /**
+         * @brief Init receiver and start capture
+         * 
+         * @param [in] dmaChannel DMA channel selection (for DMA with streams)
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Init(ONLY_IF_STREAM_SUPPORTED(uint8_t dmaChannel = 0))
+        {
+            _Pin::Port::Enable();
+            _Pin::template SetConfiguration<_Pin::Configuration::In>();
+            _Pin::template SetPullMode<_Pin::PullMode::PullUp>();
+
+            _Timer::Enable();
+            _Timer::SetPrescaler(_Timer::GetClockFreq() / 1000000 - 1); // 1us tick
+            _Timer::SetPeriod(0xffff);
+
+            // Slave mode controller is disabled, trigger selection only routes TI1F_ED to TRC
+            _Timer::SlaveMode::SelectTrigger(_Timer::SlaveMode::Trigger::Ti1EdgeDetector);
+            Capture::SetCaptureMode(Capture::CaptureMode::CaptureTrc);
+            Capture::Enable();
+
+            _readIndex = 0;
+            _inFrame = false;
+            Capture::template StartCaptureRing<_DmaChannel>(_buffer, _BufferSize ONLY_IF_STREAM_SUPPORTED(COMMA dmaChannel));
+
+            _Timer::Start();
+        }
+
+        /**
+         * @brief Process captured edges (deferred task)
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Poll()
+        {
+            uint16_t writeIndex = _BufferSize - _DmaChannel::RemainingTransfers();
+            // NDTR is reloaded to buffer size after wrap
+            if(writeIndex >= _BufferSize)
+                writeIndex = 0;
+            // Counter is read after DMA position, so processed edges are never newer than it
+            uint16_t now = static_cast<uint16_t>(_Timer::GetCounterValue());
+
+            while(_readIndex != writeIndex)
+            {
+                OnEdge(_buffer[_readIndex]);
+                if(++_readIndex == _BufferSize)
+                    _readIndex = 0;
+            }
+
+            if(_inFrame && static_cast<uint16_t>(now - _lastEdge) > FrameGap)
+            {
+                _inFrame = false;
+                _Decoder::End();
+            }
+        }
+
+    private:
+        static void OnEdge(uint16_t timestamp)
+        {
+            uint16_t duration = timestamp - _lastEdge;
+            _lastEdge = timestamp;
+
+            if(_inFrame && duration <= FrameGap)
+            {
+                _Decoder::Add(duration);
+                return;
+            }
+
+            if(_inFrame)
+                _Decoder::End();
+
+            // Idle line is high, so first edge after pause is mark begin
+            _inFrame = true;
+            _Decoder::Begin();
+        }
+
+        static uint16_t _buffer[_BufferSize];
+        static uint16_t _readIndex;
+        static uint16_t _lastEdge;
+        static bool _inFrame;
+    };
+
+    template<typename _Timer, typename _Pin, typename _DmaChannel, typename _Decoder, uint16_t _BufferSize>
+    uint16_t IrCaptureReceiver<_Timer, _Pin, _DmaChannel, _Decoder, _BufferSize>::_buffer[_BufferSize];
+
+    template<typename _Timer, typename _Pin, typename _DmaChannel, typename _Decoder, uint16_t _BufferSize>
+    uint16_t IrCaptureReceiver<_Timer, _Pin, _DmaChannel, _Decoder, _BufferSize>::_readIndex = 0;
+
+    template<typename _Timer, typename _Pin, typename _DmaChannel, typename _Decoder, uint16_t _BufferSize>
+    uint16_t IrCaptureReceiver<_Timer, _Pin, _DmaChannel, _Decoder, _BufferSize>::_lastEdge = 0;
+
+    template<typename _Timer, typename _Pin, typename _DmaChannel, typename _Decoder, uint16_t _BufferSize>
+    bool IrCaptureReceiver<_Timer, _Pin, _DmaChannel, _Decoder, _BufferSize>::_inFrame = false;
 }
 #endif // !ZHELE_DRIVERS_IR_H
\ No newline at end of file
@@ -0,0 +1,362 @@
+/**
+ * @file
+ * Modbus RTU master and slave (over Adm485)
+ *
+ * @author Alexey Zhelonkin
+ * @date 2023
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DRIVERS_MODBUS_RTU_H
+#define ZHELE_DRIVERS_MODBUS_RTU_H
+
+#include "adm485.h"
+
+#include <common/crc.h>
+
+#include <stdint.h>
+#include <type_traits>
+
+namespace Zhele::Drivers
+{
+    /// Modbus function codes
+    enum class ModbusFunction : uint8_t
+    {
+        ReadCoils = 0x01, ///< Read coils
+        ReadDiscreteInputs = 0x02, ///< Read discrete inputs
+        ReadHoldingRegisters = 0x03, ///< Read holding registers
+        ReadInputRegisters = 0x04, ///< Read input registers
+        WriteSingleCoil = 0x05, ///< Write single coil
+        WriteSingleRegister = 0x06, ///< Write single holding register
+        WriteMultipleCoils = 0x0f, ///< Write multiple coils
+        WriteMultipleRegisters = 0x10 ///< Write multiple holding registers
+    };
+
+    /// Modbus exception codes
+    enum class ModbusException : uint8_t
+    {
+        None = 0x00, ///< No exception
+        IllegalFunction = 0x01, ///< Function is not supported
+        IllegalDataAddress = 0x02, ///< Address range is not mapped
+        IllegalDataValue = 0x03, ///< Wrong quantity or value
+        SlaveDeviceFailure = 0x04 ///< Write handler failed
+    };
+
+    /// Master request status
+    enum class ModbusStatus : uint8_t
+    {
+        Success, ///< Response received
+        Exception, ///< Slave responded with exception
+        InvalidResponse, ///< Response does not match request
+        Canceled ///< Request was canceled (response timeout)
+    };
+
+    /// Registers block (holding or input registers)
+    struct ModbusRegisterBlock
+    {
+        uint16_t Address; ///< First register address
+        uint16_t Count; ///< Registers count
+        uint16_t* Data; ///< Registers values
+    };
+
+    /// Bits block (coils or discrete inputs)
+    struct ModbusBitBlock
+    {
+        uint16_t Address; ///< First bit address
+        uint16_t Count; ///< Bits count
+        uint8_t* Data; ///< Packed bits (LSB of first byte is first bit)
+    };
+
+    /**
+     * @brief Slave register map
+     *
+     * @details
+     * Each table is array of blocks, request should be covered by one block.
+     * Write callback is called after data has been written to block (from interrupt).
+     */
+    struct ModbusRegisterMap
+    {
+        using WriteCallback = std::add_pointer_t<ModbusException(ModbusFunction function, uint16_t address, uint16_t count)>;
+
+        const ModbusBitBlock* Coils; ///< Coils (read/write bits)
+        uint8_t CoilsBlocks; ///< Coils blocks count
+        const ModbusBitBlock* DiscreteInputs; ///< Discrete inputs (read only bits)
+        uint8_t DiscreteInputsBlocks; ///< Discrete inputs blocks count
+        const ModbusRegisterBlock* HoldingRegisters; ///< Holding registers (read/write)
+        uint8_t HoldingRegistersBlocks; ///< Holding registers blocks count
+        const ModbusRegisterBlock* InputRegisters; ///< Input registers (read only)
+        uint8_t InputRegistersBlocks; ///< Input registers blocks count
+        WriteCallback OnWrite; ///< Write notification (optional)
+    };
+
+    namespace Private
+    {
+        /**
+         * @brief Modbus RTU frames transport
+         *
+         * @details
+         * Receiving is done by circular DMA (USART stream read), CPU is not involved per byte.
+         * Frame end is detected by:
+         * - USART receiver timeout (t3.5) if USART supports it and timer is not specified;
+         * - idle line event (1 character) and timer for the rest of t3.5 if timer is specified
+         *   (gap more than one character time inside frame drops frame, it is t1.5 approximation);
+         * - idle line event only otherwise (fastest response, frame gap is not checked).
+         *
+         * @tparam _Rs485 Adm485 class
+         * @tparam _Timer Timer for t3.5 detection (void if it is not used)
+         * @tparam _Owner Frame handler (OnFrame and OnTransmitComplete static methods)
+         */
+        template<typename _Rs485, typename _Timer, typename _Owner>
+        class ModbusRtuTransport
+        {
+        public:
+            static const unsigned MaxFrameSize = 256;
+
+            static void Init(unsigned baud);
+            static void IrqHandler();
+            static void TimerIrqHandler();
+            static bool Send(uint8_t* frame, unsigned size);
+            static bool Transmitting();
+
+        private:
+            static constexpr bool UseTimer = !std::is_void_v<_Timer>;
+        #if defined (USART_CR2_RTOEN)
+            static constexpr bool UseReceiverTimeout = !UseTimer;
+        #else
+            static constexpr bool UseReceiverTimeout = false;
+        #endif
+
+            static void FrameEnd();
+            static void TransmitComplete();
+            static void RestartTimer();
+
+            // One more byte, so full frame differs from empty circular buffer
+            static uint8_t _rxBuffer[MaxFrameSize + 1];
+            static uint8_t _frame[MaxFrameSize];
+            static uint16_t _frameGapMicroseconds;
+            static volatile bool _transmitting;
+            static volatile bool _timerActive;
+            static volatile bool _gapError;
+        };
+    }
+
+    /**
+     * @brief Modbus RTU slave
+     *
+     * @details
+     * Requests are processed in USART interrupt right after frame end
+     * (response is sent by DMA), main loop is not involved. Call IrqHandler in
+     * USART interrupt handler and TimerIrqHandler in timer interrupt handler (if timer is used).
+     *
+     * @tparam _Rs485 Adm485 class
+     * @tparam _Timer Timer for t3.5 detection (optional)
+     */
+    template<typename _Rs485, typename _Timer = void>
+    class ModbusRtuSlave
+    {
+        using Transport = Private::ModbusRtuTransport<_Rs485, _Timer, ModbusRtuSlave>;
+        friend Transport;
+    public:
+        /**
+         * @brief Init slave
+         *
+         * @param [in] baud Baud rate
+         * @param [in] address Slave address (1..247)
+         * @param [in] map Register map (should be valid all the time)
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void Init(unsigned baud, uint8_t address, const ModbusRegisterMap* map);
+
+        /**
+         * @brief Change slave address
+         *
+         * @param [in] address New address
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void SetAddress(uint8_t address);
+
+        /**
+         * @brief USART interrupt handler
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void IrqHandler();
+
+        /**
+         * @brief Timer interrupt handler
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void TimerIrqHandler();
+
+    private:
+        static void OnFrame(const uint8_t* frame, unsigned size);
+        static void OnTransmitComplete() {}
+
+        static unsigned Process(const uint8_t* request, unsigned size, uint8_t* response, ModbusException& exception);
+        static unsigned ReadBits(const ModbusBitBlock* blocks, uint8_t count, const uint8_t* request, uint8_t* response, ModbusException& exception);
+        static unsigned ReadRegisters(const ModbusRegisterBlock* blocks, uint8_t count, const uint8_t* request, uint8_t* response, ModbusException& exception);
+        static unsigned WriteCoils(const uint8_t* request, unsigned size, uint8_t* response, ModbusException& exception);
+        static unsigned WriteRegisters(const uint8_t* request, unsigned size, uint8_t* response, ModbusException& exception);
+
+        template<typename _Block>
+        static const _Block* FindBlock(const _Block* blocks, uint8_t count, uint16_t address, uint16_t quantity);
+
+        static uint8_t _address;
+        static const ModbusRegisterMap* _map;
+        static uint8_t _response[Transport::MaxFrameSize];
+    };
+
+    /**
+     * @brief Modbus RTU master
+     *
+     * @details
+     * One request may be active. Response (or exception) is reported by callback from interrupt.
+     * Response timeout is not tracked by driver: call Cancel on timeout.
+     *
+     * @tparam _Rs485 Adm485 class
+     * @tparam _Timer Timer for t3.5 detection (optional)
+     */
+    template<typename _Rs485, typename _Timer = void>
+    class ModbusRtuMaster
+    {
+        using Transport = Private::ModbusRtuTransport<_Rs485, _Timer, ModbusRtuMaster>;
+        friend Transport;
+    public:
+        using Callback = std::add_pointer_t<void(ModbusStatus status, ModbusException exception)>;
+
+        /**
+         * @brief Init master
+         *
+         * @param [in] baud Baud rate
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void Init(unsigned baud);
+
+        /**
+         * @brief Read holding or input registers
+         *
+         * @param [in] slave Slave address
+         * @param [in] function ReadHoldingRegisters or ReadInputRegisters
+         * @param [in] address First register address
+         * @param [in] count Registers count (1..125)
+         * @param [out] values Output buffer (should be valid until callback)
+         * @param [in] callback Complete callback
+         *
+         * @retval true Request is sent
+         * @retval false Master is busy or parameters are invalid
+         */
+        static bool ReadRegisters(uint8_t slave, ModbusFunction function, uint16_t address, uint16_t count, uint16_t* values, Callback callback);
+
+        /**
+         * @brief Read coils or discrete inputs
+         *
+         * @param [in] slave Slave address
+         * @param [in] function ReadCoils or ReadDiscreteInputs
+         * @param [in] address First bit address
+         * @param [in] count Bits count (1..2000)
+         * @param [out] bits Output buffer (packed bits, should be valid until callback)
+         * @param [in] callback Complete callback
+         *
+         * @retval true Request is sent
+         * @retval false Master is busy or parameters are invalid
+         */
+        static bool ReadBits(uint8_t slave, ModbusFunction function, uint16_t address, uint16_t count, uint8_t* bits, Callback callback);
+
+        /**
+         * @brief Write single holding register
+         *
+         * @param [in] slave Slave address (0 for broadcast)
+         * @param [in] address Register address
+         * @param [in] value Value
+         * @param [in] callback Complete callback
+         *
+         * @retval true Request is sent
+         * @retval false Master is busy
+         */
+        static bool WriteRegister(uint8_t slave, uint16_t address, uint16_t value, Callback callback);
+
+        /**
+         * @brief Write multiple holding registers
+         *
+         * @param [in] slave Slave address (0 for broadcast)
+         * @param [in] address First register address
+         * @param [in] count Registers count (1..123)
+         * @param [in] values Values
+         * @param [in] callback Complete callback
+         *
+         * @retval true Request is sent
+         * @retval false Master is busy or parameters are invalid
+         */
+        static bool WriteRegisters(uint8_t slave, uint16_t address, uint16_t count, const uint16_t* values, Callback callback);
+
+        /**
+         * @brief Write single coil
+         *
+         * @param [in] slave Slave address (0 for broadcast)
+         * @param [in] address Coil address
+         * @param [in] value Coil state
+         * @param [in] callback Complete callback
+         *
+         * @retval true Request is sent
+         * @retval false Master is busy
+         */
+        static bool WriteCoil(uint8_t slave, uint16_t address, bool value, Callback callback);
+
+        /**
+         * @brief Check that request is active
+         *
+         * @retval true Waiting for response
+         * @retval false Master is ready for new request
+         */
+        static bool Busy();
+
+        /**
+         * @brief Cancel active request (response timeout)
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void Cancel();
+
+        /**
+         * @brief USART interrupt handler
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void IrqHandler();
+
+        /**
+         * @brief Timer interrupt handler
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void TimerIrqHandler();
+
+    private:
+        static void OnFrame(const uint8_t* frame, unsigned size);
+        static void OnTransmitComplete();
+
+        static bool Start(unsigned size, Callback callback);
+        static void Complete(ModbusStatus status, ModbusException exception = ModbusException::None);
+
+        static uint8_t _request[Transport::MaxFrameSize];
+        static void* _output;
+        static Callback _callback;
+        static volatile bool _busy;
+    };
+}
+
+#include "impl/modbus_rtu.h"
+
+#endif //! ZHELE_DRIVERS_MODBUS_RTU_H
@@ -10,6 +10,12 @@
 #ifndef ZHELE_DRIVERS_NRF24L_H
 #define ZHELE_DRIVERS_NRF24L_H
 
+#include <containers/ring_buffer.h>
+#include <common/template_utils/data_transfer.h>
+
+#include <stdint.h>
+#include <type_traits>
+
 namespace Zhele::Drivers
 {	
     /**
@@ -295,6 +301,56 @@ namespace Zhele::Drivers
 
         };
 
+        /**
+         * @brief Feature register wrapper
+         */
+        enum FeatureRegister : uint8_t
+        {
+            EnableDynamicAckPos = 0,
+            EnableDynamicAckMask = 1 << EnableDynamicAckPos,
+            EnableDynamicAck = EnableDynamicAckMask, ///< Enable W_TX_PAYLOAD_NOACK command
+
+            EnableAckPayloadPos = 1,
+            EnableAckPayloadMask = 1 << EnableAckPayloadPos,
+            EnableAckPayload = EnableAckPayloadMask, ///< Enable payload with ACK
+
+            EnableDynamicPayloadLengthPos = 2,
+            EnableDynamicPayloadLengthMask = 1 << EnableDynamicPayloadLengthPos,
+            EnableDynamicPayloadLength = EnableDynamicPayloadLengthMask, ///< Enable dynamic payload length
+        };
+
+        /**
+         * @brief SPI commands
+         */
+        enum Commands : uint8_t
+        {
+            ReadRegisterCommand = 0x00, ///< Read register (OR with register address)
+            WriteRegisterCommand = 0x20, ///< Write register (OR with register address)
+            ReadRxPayloadWidthCommand = 0x60, ///< Read top RX FIFO payload width
+            ReadRxPayloadCommand = 0x61, ///< Read RX payload
+            WriteTxPayloadCommand = 0xa0, ///< Write TX payload
+            WriteTxPayloadNoAckCommand = 0xb0, ///< Write TX payload without acknowledgment
+            WriteAckPayloadCommand = 0xa8, ///< Write payload for ACK (OR with pipe number)
+            FlushTxCommand = 0xe1, ///< Flush TX FIFO
+            FlushRxCommand = 0xe2, ///< Flush RX FIFO
+            NopCommand = 0xff ///< No operation (read status)
+        };
+
+        static const uint8_t MaxPayloadSize = 32; ///< Max payload size
+        static const uint8_t TxFifoSize = 3; ///< Module TX FIFO depth
+        static const uint8_t PipesCount = 6; ///< RX pipes count
+        static const uint8_t NoAckPipe = 0x80; ///< Send without acknowledgment (transmitter mode, see Send)
+
+        /**
+         * @brief Radio packet
+         */
+        struct Packet
+        {
+            uint8_t Pipe; ///< Pipe number (receive pipe or ACK payload pipe)
+            uint8_t Size; ///< Payload size
+            uint8_t Data[MaxPayloadSize]; ///< Payload
+        };
+
         enum class TransmitStatus : uint8_t
         {
             Lost = 0x00, ///< Message is lost
@@ -351,8 +407,10 @@ namespace Zhele::Drivers
      * @tparam SSPin GPIO pin for SS
      * @tparam CEPin GPIO pin for CE
      * @tparam EXTIPin Pin for extern interrupt. Use it if you want to connect IRQ 
+     * @tparam _TxQueueSize Software TX queue size (interrupt-driven mode)
+     * @tparam _RxQueueSize Software RX queue size (interrupt-driven mode)
      */
-    template<typename SpiBus, typename SSPin, typename CEPin, typename EXTIPin = IO::NullPin>
+    template<typename SpiBus, typename SSPin, typename CEPin, typename EXTIPin = IO::NullPin, unsigned _TxQueueSize = 8, unsigned _RxQueueSize = 8>
     class Nrf24l : public Nrf24lBase
     {		
     public:
@@ -455,15 +513,56 @@ namespace Zhele::Drivers
         /**
          * @brief Set transmit address (TX)
          * 
+         * @param [in] address Address (5 bytes, LSB first)
+         * @param [in] ackPipe Set pipe 0 address too (required to receive acknowledgments)
+         * 
          * @par Returns
          *	Nothing
          */
-        static void SetTxAddress(uint8_t* address)
+        static void SetTxAddress(const uint8_t* address, bool ackPipe = true)
         {
-            WriteRegister(Registers::RxAddress0, address, 5);
+            if(ackPipe)
+                WriteRegister(Registers::RxAddress0, address, 5);
             WriteRegister(Registers::TxAddress, address, 5);
         }
 
+        /**
+         * @brief Sets receive pipe address
+         * 
+         * @details
+         * Pipes 2-5 share 4 most significant bytes with pipe 1, only LSB (first byte) of their address is written.
+         * 
+         * @param [in] pipe Pipe (0-5)
+         * @param [in] address Address (5 bytes, LSB first)
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        static void SetPipeAddress(uint8_t pipe, const uint8_t* address)
+        {
+            if(pipe >= PipesCount)
+                return;
+            Registers pipeRegister = static_cast<Registers>(static_cast<uint8_t>(Registers::RxAddress0) + pipe);
+            if(pipe < 2)
+                WriteRegister(pipeRegister, address, 5);
+            else
+                WriteRegister(pipeRegister, address[0]);
+        }
+
+        /**
+         * @brief Sets automatic retransmission
+         * 
+         * @param [in] delay Delay between retransmissions (in 250 us units, 1-16)
+         * @param [in] count Retransmissions count (0-15)
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        static void SetAutoRetransmission(uint8_t delay, uint8_t count)
+        {
+            WriteRegister(Registers::AutoRetransmission, (((delay - 1) & 0x0f) << 4) | (count & 0x0f));
+        }
+
         /**
          * @brief Set RF settings: data rate and power
          * 
@@ -589,6 +688,109 @@ namespace Zhele::Drivers
         {
             return ReadRegister(Registers::ObserveTx) & 0x0f;
         }
+
+        /**
+         * @brief Switch module to interrupt-driven mode
+         * 
+         * @details
+         * In this mode all SPI exchange is performed by SPI DMA transactions from IRQ (EXTI)
+         * and DMA interrupts: software TX queue keeps module TX FIFO full, received packets
+         * (and ACK payloads) are read to software RX queue, failed (MAX_RT) packets are dropped
+         * and next packets are reloaded. Blocking methods must not be used in this mode.
+         * Call IrqHandler from EXTI interrupt handler.
+         * 
+         * @tparam _Exti EXTI line of IRQ pin (EXTIPin)
+         * 
+         * @param [in] dynamicPayload Enable dynamic payload length and ACK payloads
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        template<typename _Exti>
+        static void InitIrq(bool dynamicPayload = true);
+
+        /**
+         * @brief Start transmitter (PTX) in interrupt-driven mode
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        static void StartTransmitter();
+
+        /**
+         * @brief Start receiver (PRX) in interrupt-driven mode
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        static void StartReceiver();
+
+        /**
+         * @brief Add packet to TX queue
+         * 
+         * @details
+         * In receiver mode packet is sent as ACK payload of given pipe.
+         * In transmitter mode pipe NoAckPipe sends packet without acknowledgment (broadcast, requires dynamic payload).
+         * If dynamic payload is disabled, packet is padded with zeros to payload size.
+         * 
+         * @param [in] data Data
+         * @param [in] size Data size (up to 32 bytes)
+         * @param [in] pipe Pipe for ACK payload (receiver mode) or NoAckPipe (transmitter mode)
+         * 
+         * @retval true Packet has been queued
+         * @retval false Queue is full or packet is too large
+         */
+        static bool Send(const uint8_t* data, uint8_t size, uint8_t pipe = 0);
+
+        /**
+         * @brief Get received packet from RX queue
+         * 
+         * @param [out] packet Packet
+         * 
+         * @retval true Packet has been received
+         * @retval false RX queue is empty
+         */
+        static bool Receive(Packet& packet);
+
+        /**
+         * @brief Returns count of packets in TX queue (including loaded to module and not acknowledged yet)
+         * 
+         * @returns Packets count
+         */
+        static unsigned TxPending();
+
+        /**
+         * @brief Returns count of packets in RX queue
+         * 
+         * @returns Packets count
+         */
+        static unsigned RxAvailable();
+
+        /**
+         * @brief Returns count of packets lost (MAX_RT or RX queue overflow)
+         * 
+         * @returns Lost packets count
+         */
+        static uint32_t Lost();
+
+        /**
+         * @brief Returns IRQ service state
+         * 
+         * @details
+         * Blocking methods (configuration, StartReceiver, StartTransmitter) may be called only if service is not active.
+         * 
+         * @retval true Service is active (SPI exchange is in progress)
+         * @retval false Service is idle
+         */
+        static bool Busy();
+
+        /**
+         * @brief IRQ handler. Call it from EXTI interrupt handler
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        static void IrqHandler();
     private:
         static void InitPins()
         {
@@ -706,7 +908,7 @@ namespace Zhele::Drivers
          * @par Returns
          *	Nothing
          */
-        static void WriteRegister(Registers registerAddress, uint8_t* data, uint8_t size)
+        static void WriteRegister(Registers registerAddress, const uint8_t* data, uint8_t size)
         {
             SSPin::Clear();
             SpiBus::Send((static_cast <uint8_t>(registerAddress) & 0x1F) | 0x20);
@@ -752,10 +954,123 @@ namespace Zhele::Drivers
             WriteRegister(Registers::Status, 0x70);
         }
 
+        /**
+         * @brief Queue SPI transaction with chip select control
+         * 
+         * @param [in] transmitBuffer Data to transmit (nullptr for transmit 0xff)
+         * @param [out] receiveBuffer Receive buffer (nullptr for ignore received data)
+         * @param [in] size Data size
+         * @param [in] chipSelectAction Chip select action
+         * @param [in] callback Transaction complete callback
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        static void QueueTransaction(const void* transmitBuffer, void* receiveBuffer, uint16_t size,
+            typename SpiBus::ChipSelectAction chipSelectAction, TransferCallback callback = nullptr);
+
+        /**
+         * @brief Start IRQ service if it is not active
+         * 
+         * @param [in] readStatus Read and clear status first
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        static void Kick(bool readStatus);
+
+        /**
+         * @brief Read and clear status, read FIFO status
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        static void ReadStatus();
+
+        /**
+         * @brief Select next action: flush, read payload, write payload or finish
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        static void NextStep();
+
+        /**
+         * @brief Finish IRQ service (or restart it if IRQ is still active)
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        static void Finish();
+
+        // SPI transaction callbacks
+        static void OnStatusRead(void* data, unsigned size, bool success);
+        static void OnStatusRefresh(void* data, unsigned size, bool success);
+        static void OnWidthRead(void* data, unsigned size, bool success);
+        static void OnPayloadRead(void* data, unsigned size, bool success);
+        static void OnPayloadWritten(void* data, unsigned size, bool success);
+        static void OnFlushComplete(void* data, unsigned size, bool success);
+
+        static constexpr uint8_t ClearStatusCommand[2] = {WriteRegisterCommand | static_cast<uint8_t>(Registers::Status), uint8_t(RxDr) | uint8_t(TxDataSend) | uint8_t(MaxRt)};
+        static constexpr uint8_t ReadFifoStatusCommand[2] = {ReadRegisterCommand | static_cast<uint8_t>(Registers::FifoStatus), NopCommand};
+        static constexpr uint8_t ReadWidthCommand[2] = {ReadRxPayloadWidthCommand, NopCommand};
+        static constexpr uint8_t ReadPayloadCommand = ReadRxPayloadCommand;
+        static constexpr uint8_t FlushTxFifoCommand = FlushTxCommand;
+        static constexpr uint8_t FlushRxFifoCommand = FlushRxCommand;
+
         static uint8_t _payloadSize;
+
+        static Containers::RingBuffer<_TxQueueSize, Packet> _txQueue; ///< TX queue (first _inFlight packets are loaded to module)
+        static Containers::RingBuffer<_RxQueueSize, Packet> _rxQueue; ///< RX queue
+        static Packet _rxPacket; ///< Packet being read
+        static uint8_t _response[2]; ///< Status (and register value) response
+        static uint8_t _fifoStatus[2]; ///< FIFO status response
+        static uint8_t _command; ///< Payload write command
+        static uint8_t _inFlight; ///< Packets loaded to module TX FIFO
+        static uint8_t _rxPipe; ///< Pipe of top RX FIFO packet (7 if RX FIFO is empty)
+        static bool _receiver; ///< Receiver (PRX) mode
+        static bool _dynamicPayload; ///< Dynamic payload length enabled
+        static bool _flushPending; ///< TX FIFO flush required
+        static volatile bool _busy; ///< IRQ service is active
+        static volatile bool _pending; ///< IRQ service restart required
+        static uint32_t _lost; ///< Lost packets count
     };
 
-    template<typename SpiBus, typename SSPin, typename CEPin, typename EXTIPin>
-    uint8_t Nrf24l<SpiBus, SSPin, CEPin, EXTIPin>::_payloadSize;
+    #define NRF24L_TEMPLATE_ARGS template<typename SpiBus, typename SSPin, typename CEPin, typename EXTIPin, unsigned _TxQueueSize, unsigned _RxQueueSize>
+    #define NRF24L_TEMPLATE_QUALIFIER Nrf24l<SpiBus, SSPin, CEPin, EXTIPin, _TxQueueSize, _RxQueueSize>
+
+    NRF24L_TEMPLATE_ARGS
+    uint8_t NRF24L_TEMPLATE_QUALIFIER::_payloadSize;
+    NRF24L_TEMPLATE_ARGS
+    Containers::RingBuffer<_TxQueueSize, Nrf24lBase::Packet> NRF24L_TEMPLATE_QUALIFIER::_txQueue;
+    NRF24L_TEMPLATE_ARGS
+    Containers::RingBuffer<_RxQueueSize, Nrf24lBase::Packet> NRF24L_TEMPLATE_QUALIFIER::_rxQueue;
+    NRF24L_TEMPLATE_ARGS
+    Nrf24lBase::Packet NRF24L_TEMPLATE_QUALIFIER::_rxPacket;
+    NRF24L_TEMPLATE_ARGS
+    uint8_t NRF24L_TEMPLATE_QUALIFIER::_response[2];
+    NRF24L_TEMPLATE_ARGS
+    uint8_t NRF24L_TEMPLATE_QUALIFIER::_fifoStatus[2];
+    NRF24L_TEMPLATE_ARGS
+    uint8_t NRF24L_TEMPLATE_QUALIFIER::_command;
+    NRF24L_TEMPLATE_ARGS
+    uint8_t NRF24L_TEMPLATE_QUALIFIER::_inFlight;
+    NRF24L_TEMPLATE_ARGS
+    uint8_t NRF24L_TEMPLATE_QUALIFIER::_rxPipe = 7;
+    NRF24L_TEMPLATE_ARGS
+    bool NRF24L_TEMPLATE_QUALIFIER::_receiver;
+    NRF24L_TEMPLATE_ARGS
+    bool NRF24L_TEMPLATE_QUALIFIER::_dynamicPayload;
+    NRF24L_TEMPLATE_ARGS
+    bool NRF24L_TEMPLATE_QUALIFIER::_flushPending;
+    NRF24L_TEMPLATE_ARGS
+    volatile bool NRF24L_TEMPLATE_QUALIFIER::_busy;
+    NRF24L_TEMPLATE_ARGS
+    volatile bool NRF24L_TEMPLATE_QUALIFIER::_pending;
+    NRF24L_TEMPLATE_ARGS
+    uint32_t NRF24L_TEMPLATE_QUALIFIER::_lost;
 }
+
+#include "impl/nrf24l.h"
+
 #endif //! ZHELE_DRIVERS_NRF24L_H
\ No newline at end of file
@@ -0,0 +1,227 @@
+/**
+ * @file
+ * Implements NRF24L star network (hub with six pipes and beacon-synchronized TDMA nodes)
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DRIVERS_NRF24L_NETWORK_H
+#define ZHELE_DRIVERS_NRF24L_NETWORK_H
+
+#include "nrf24l.h"
+
+#include <containers/ring_buffer.h>
+
+#include <stdint.h>
+
+namespace Zhele::Drivers
+{
+    /**
+     * @brief Star network definitions
+     *
+     * @details
+     * Hub periodically broadcasts beacon (without acknowledgment). Frame consists of beacon slot
+     * and node slots, node with id N transmits only in slot N, counted from beacon reception time.
+     * So nodes never collide, retransmissions are limited to own slot and latency is determined
+     * by frame length. Node uses hub pipe (id % 6), pipe addresses differ in LSB only
+     * (base address LSB + pipe). First byte of every node payload is node id.
+     */
+    class Nrf24lNetworkBase
+    {
+    public:
+        static const uint8_t BeaconMagic = 0xbe; ///< Beacon first byte
+        static const uint8_t MaxNodeData = Nrf24lBase::MaxPayloadSize - 1; ///< Max node payload (one byte is node id)
+
+        /**
+         * @brief Beacon payload
+         */
+        struct Beacon
+        {
+            uint8_t Magic; ///< BeaconMagic
+            uint8_t Sequence; ///< Beacon counter
+            uint8_t Slots; ///< Node slots count
+            uint8_t SlotLength[2]; ///< Node slot length (us, little endian)
+            uint8_t BeaconSlot[2]; ///< Beacon slot length (us, little endian)
+        };
+
+        /**
+         * @brief Node packet
+         */
+        struct NodePacket
+        {
+            uint8_t Node; ///< Node id
+            uint8_t Size; ///< Data size
+            uint8_t Data[MaxNodeData]; ///< Data
+        };
+
+    protected:
+        static void PipeAddress(const uint8_t* baseAddress, uint8_t pipe, uint8_t* address)
+        {
+            for(uint8_t i = 0; i < 5; ++i)
+                address[i] = baseAddress[i];
+            address[0] += pipe;
+        }
+    };
+
+    /**
+     * @brief Star network hub
+     *
+     * @details
+     * Receives nodes packets on all six pipes and sends beacon every frame
+     * (beacon slot + _Slots * _SlotLength microseconds). Radio should be initialized
+     * in interrupt-driven mode with dynamic payload (Init, InitIrq). Call Poll from main loop,
+     * its period defines beacon jitter (nodes slot timings are measured from beacon reception).
+     *
+     * @tparam _Radio Radio (Nrf24l)
+     * @tparam _Timebase Timebase (class with static uint32_t Micros(), TimerTimebase or DwtTimebase)
+     * @tparam _Slots Node slots count (max nodes count)
+     * @tparam _SlotLength Node slot length (us)
+     * @tparam _BeaconSlot Beacon slot length (us): beacon transmission and radio mode switching
+     */
+    template<typename _Radio, typename _Timebase, uint8_t _Slots, unsigned _SlotLength = 2000, unsigned _BeaconSlot = 1000>
+    class Nrf24lHub : public Nrf24lNetworkBase
+    {
+        static_assert(_SlotLength <= 0xffff && _BeaconSlot <= 0xffff, "Slot length should fit 16 bits");
+        static_assert(_Slots > 0, "Slots count should be positive");
+    public:
+        /// Frame length (us)
+        static const uint32_t FrameLength = _BeaconSlot + _Slots * _SlotLength;
+
+        /**
+         * @brief Init hub
+         *
+         * @param [in] baseAddress Base pipes address (5 bytes, LSB first)
+         * @param [in] beaconAddress Beacon (broadcast) address
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Init(const uint8_t* baseAddress, const uint8_t* beaconAddress);
+
+        /**
+         * @brief Processes hub state (beacon scheduling)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Poll();
+
+        /**
+         * @brief Gets received node packet
+         *
+         * @param [out] packet Packet
+         *
+         * @retval true Packet has been received
+         * @retval false No packets
+         */
+        static bool Receive(NodePacket& packet);
+
+        /**
+         * @brief Returns beacons counter
+         *
+         * @returns Sent beacons count
+         */
+        static uint8_t Sequence();
+
+    private:
+        static bool _beacon;
+        static uint8_t _sequence;
+        static uint32_t _nextBeacon;
+    };
+
+    /**
+     * @brief Star network node
+     *
+     * @details
+     * Listens beacon and transmits queued packets only in own slot (up to TX FIFO size packets per frame).
+     * Auto retransmission is limited to fit slot. Unsent packets are kept in radio TX queue until next slot.
+     * Call IrqHandler (instead of radio IrqHandler) from EXTI interrupt handler: it timestamps beacon,
+     * and Poll from main loop.
+     *
+     * @tparam _Radio Radio (Nrf24l)
+     * @tparam _Timebase Timebase (class with static uint32_t Micros())
+     * @tparam _QueueSize Node packets queue size
+     * @tparam _Guard Guard interval at the beginning and at the end of slot (us)
+     * @tparam _MaxMissedBeacons Missed beacons count after which node loses synchronization
+     */
+    template<typename _Radio, typename _Timebase, unsigned _QueueSize = 4, unsigned _Guard = 200, uint8_t _MaxMissedBeacons = 3>
+    class Nrf24lNode : public Nrf24lNetworkBase
+    {
+    public:
+        /**
+         * @brief Init node
+         *
+         * @param [in] node Node id (slot number)
+         * @param [in] baseAddress Hub base address
+         * @param [in] beaconAddress Beacon address
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Init(uint8_t node, const uint8_t* baseAddress, const uint8_t* beaconAddress);
+
+        /**
+         * @brief Puts packet to queue
+         *
+         * @param [in] data Data
+         * @param [in] size Data size (up to MaxNodeData bytes)
+         *
+         * @retval true Packet has been queued
+         * @retval false Queue is full or data is too large
+         */
+        static bool Send(const uint8_t* data, uint8_t size);
+
+        /**
+         * @brief Processes node state (slot timings)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Poll();
+
+        /**
+         * @brief Returns synchronization state
+         *
+         * @retval true Beacons are received, node transmits in its slot
+         * @retval false Node waits beacon
+         */
+        static bool Synchronized();
+
+        /**
+         * @brief IRQ handler. Call it from EXTI interrupt handler
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void IrqHandler();
+
+    private:
+        enum class State : uint8_t
+        {
+            Listen, ///< Waits beacon
+            Wait, ///< Waits own slot
+            Transmit ///< Transmits in slot
+        };
+
+        static void StartSlot();
+        static bool Expired(uint32_t now, uint32_t time);
+
+        static Containers::RingBuffer<_QueueSize, Nrf24lBase::Packet> _queue; ///< Packets (first byte is node id)
+        static volatile uint32_t _irqTime; ///< Last IRQ time
+        static uint32_t _beaconTime; ///< Last (or predicted) beacon reception time
+        static uint32_t _slotOffset; ///< Own slot offset from beacon
+        static uint32_t _slotLength; ///< Slot length
+        static uint32_t _frameLength; ///< Frame length
+        static uint32_t _slotEnd; ///< Current slot end
+        static uint8_t _node;
+        static uint8_t _missed;
+        static bool _synchronized;
+        static State _state;
+    };
+}
+
+#include "impl/nrf24l_network.h"
+
+#endif //! ZHELE_DRIVERS_NRF24L_NETWORK_H
@@ -0,0 +1,281 @@
+/**
+ * @file
+ * Implements parallel (8080-type) display bus
+ *
+ * @author Alexey Zhelonkin
+ * @date 2023
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DRIVERS_PARALLEL_BUS_H
+#define ZHELE_DRIVERS_PARALLEL_BUS_H
+
+#include <clock.h>
+#include <delay.h>
+#include <fsmc.h>
+#include <pinlist.h>
+
+#include <common/template_utils/data_transfer.h>
+
+#include <stddef.h>
+#include <stdint.h>
+#include <type_traits>
+
+namespace Zhele::Drivers
+{
+    /**
+     * @brief Implements 8080-type parallel bus by GPIO (ILI93xx, ST7789, SSD1963 and other TFT controllers)
+     *
+     * @details
+     * Data word is written by one pinlist write (one BSRR store per used port), so data pins
+     * should be placed on one port in order (D0 = Px0, D1 = Px1...) for the fastest bus.
+     * Write strobe pulse is as short as two GPIO writes, that is enough for most of TFT controllers
+     * on F0/F1/L4, on F4 use FsmcBus if possible.
+     *
+     * @tparam _DataPins Data pins (pinlist with 8 or 16 pins)
+     * @tparam _WrPin Write strobe pin (active low)
+     * @tparam _DcPin Data/Command pin (low for command)
+     * @tparam _RdPin Read strobe pin (active low, NullPin for write-only bus)
+     * @tparam _CsPin Chip select pin (active low, NullPin if CS is tied to ground)
+     */
+    template<typename _DataPins, typename _WrPin, typename _DcPin, typename _RdPin = IO::NullPin, typename _CsPin = IO::NullPin>
+    class ParallelBus
+    {
+    public:
+        using DataType = typename _DataPins::DataType;
+
+        /**
+         * @brief Init bus pins
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void Init();
+
+        /**
+         * @brief Select device (set CS low)
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void Select();
+
+        /**
+         * @brief Deselect device (set CS high)
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void Deselect();
+
+        /**
+         * @brief Write command
+         *
+         * @param [in] command Command
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void WriteCommand(DataType command);
+
+        /**
+         * @brief Write data word
+         *
+         * @param [in] data Data
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void WriteData(DataType data);
+
+        /**
+         * @brief Write data words
+         *
+         * @param [in] data Data
+         * @param [in] count Words count
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void WriteData(const DataType* data, size_t count);
+
+        /**
+         * @brief Write the same data word several times (fill display area)
+         *
+         * @details
+         * Data lines are written once, then write strobe is toggled @p count times.
+         *
+         * @param [in] data Data
+         * @param [in] count Words count
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void Fill(DataType data, size_t count);
+
+        /**
+         * @brief Read data word
+         *
+         * @returns Data
+         */
+        static DataType ReadData();
+
+        /**
+         * @brief Read data words
+         *
+         * @param [out] data Buffer
+         * @param [in] count Words count
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void ReadData(DataType* data, size_t count);
+
+    protected:
+        template<typename _Pin>
+        static void InitControlPin();
+        static void Strobe();
+        static DataType ReadWord();
+    };
+
+#if defined (FSMC_Bank1)
+    /**
+     * @brief Implements 8080-type parallel bus by FSMC (NOR/SRAM bank 1)
+     *
+     * @details
+     * Display is mapped to memory as SRAM: data/command line is connected to address line
+     * and every word costs one memory store. Words of buffer may be written by DMA
+     * (memory to memory transfer, DMA2 for stm32f4).
+     * Typical wiring is 16-bit bus on NE1 with A16 (PD11) as data/command: FsmcBus<Pins, 1, 16>.
+     *
+     * @tparam _Pins All FSMC pins used by display (data, NOE, NWE, NEx, Ax)
+     * @tparam _SubBank NOR/SRAM sub-bank (NE pin number, 1...4)
+     * @tparam _DcAddressLine Number of address line connected to data/command pin (A0...A25)
+     * @tparam _DataType Bus type (uint8_t or uint16_t)
+     */
+    template<typename _Pins, unsigned _SubBank, unsigned _DcAddressLine, typename _DataType = uint16_t>
+    class FsmcBus
+    {
+        static_assert(_SubBank >= 1 && _SubBank <= 4, "Sub-bank must be 1...4");
+        static_assert(std::is_same_v<_DataType, uint8_t> || std::is_same_v<_DataType, uint16_t>, "Bus type must be uint8_t or uint16_t");
+
+        using Bank = FsmcSramBank<_SubBank>;
+        static constexpr FsmcBase::BusWidth Width = sizeof(_DataType) == 2 ? FsmcBase::BusWidth::Bus16 : FsmcBase::BusWidth::Bus8;
+
+        static const uint32_t BaseAddress = Bank::BaseAddress;
+        // For 16-bit bus HADDR[25:1] is output on A[24:0]
+        static const uint32_t DataAddress = BaseAddress | (1ul << (_DcAddressLine + (sizeof(_DataType) - 1)));
+    public:
+        using DataType = _DataType;
+
+        /**
+         * @brief Init FSMC and bus pins
+         *
+         * @param [in] addressSetup Address setup time (HCLK cycles, 0...15)
+         * @param [in] dataSetup Data setup time (HCLK cycles, 1...255)
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void Init(uint8_t addressSetup = 1, uint8_t dataSetup = 5);
+
+        /**
+         * @brief Init FSMC (extended mode) and bus pins
+         *
+         * @details
+         * LCD controllers accept writes much faster than they return data,
+         * so write timing may be set close to controller limit without slowing down reads.
+         *
+         * @param [in] readTiming Read timing (see FsmcBase::CalculateTiming)
+         * @param [in] writeTiming Write timing
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void Init(const FsmcBase::Timing& readTiming, const FsmcBase::Timing& writeTiming);
+
+        /**
+         * @brief Write command
+         *
+         * @param [in] command Command
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void WriteCommand(DataType command);
+
+        /**
+         * @brief Write data word
+         *
+         * @param [in] data Data
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void WriteData(DataType data);
+
+        /**
+         * @brief Write data words
+         *
+         * @param [in] data Data
+         * @param [in] count Words count
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void WriteData(const DataType* data, size_t count);
+
+        /**
+         * @brief Write data words by DMA
+         *
+         * @tparam _DmaChannel DMA channel (stream) for memory to memory transfer
+         *
+         * @param [in] data Data (must remain valid until transfer is completed)
+         * @param [in] count Words count
+         * @param [in] callback Transfer complete callback
+         *
+         * @par Returns
+         *	Nothing
+         */
+        template<typename _DmaChannel>
+        static void WriteDataAsync(const DataType* data, uint16_t count, TransferCallback callback = nullptr);
+
+        /**
+         * @brief Write the same data word several times (fill display area)
+         *
+         * @param [in] data Data
+         * @param [in] count Words count
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void Fill(DataType data, size_t count);
+
+        /**
+         * @brief Read data word
+         *
+         * @returns Data
+         */
+        static DataType ReadData();
+
+        /**
+         * @brief Read data words
+         *
+         * @param [out] data Buffer
+         * @param [in] count Words count
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void ReadData(DataType* data, size_t count);
+
+    private:
+        static volatile DataType& Command();
+        static volatile DataType& Data();
+    };
+#endif
+}
+
+#include "impl/parallel_bus.h"
+
+#endif //! ZHELE_DRIVERS_PARALLEL_BUS_H
@@ -12,6 +12,8 @@
 #include <spi.h>
 #include <delay.h>
 
+#include <type_traits>
+
 namespace Zhele
 {
     namespace Drivers
@@ -19,8 +21,17 @@ namespace Zhele
         /**
          * @brief Implements MFRC522 RFID reader
          * 
+         * @details
+         * FIFO is written and read by SPI bursts (one address byte for whole write,
+         * address byte per read byte without chip select toggling).
+         * If IRQ line is specified, CheckAsync performs request, anticollision and halt
+         * without CPU: FIFO bursts are transferred by SPI DMA, command completion is signaled
+         * by MFRC522 IRQ pin (call IrqHandler from EXTI IRQ handler and SPI DMA IRQ handlers).
+         * 
          * @tparam _SpiBus Target SPI
          * @tparam _SSPin Slave select pin for transaction control
+         * @tparam _IrqExti EXTI line of IRQ pin (void if IRQ is not used)
+         * @tparam _IrqPin IRQ pin
          * 
          * @todo
          * Class exports basic functional: Init and Check method.
@@ -30,7 +41,7 @@ namespace Zhele
          * The best source for Arduino that i know is MFRC522 class
          * https://github.com/miguelbalboa/rfid/
          */
-        template<typename _SpiBus, typename _SSPin = IO::NullPin>
+        template<typename _SpiBus, typename _SSPin = IO::NullPin, typename _IrqExti = void, typename _IrqPin = IO::NullPin>
         class Rc522
         { 
             /**
@@ -125,6 +136,27 @@ namespace Zhele
 
             static const uint8_t MaxDataSize = 16;
 
+            static constexpr bool UseIrq = !std::is_void_v<_IrqExti>;
+
+            /// ComIrq register bits
+            enum ComIrqBits : uint8_t
+            {
+                TimerIrq = 0x01, ///< Timer decremented to zero
+                ErrorIrq = 0x02, ///< Error detected
+                IdleIrq = 0x10, ///< Command terminated
+                RxIrq = 0x20, ///< End of received data
+                TxIrq = 0x40, ///< Last bit of transmitted data was sent out
+            };
+
+            /// Async check steps
+            enum class AsyncStep : uint8_t
+            {
+                Idle, ///< No async operation
+                Request, ///< REQA is in progress
+                AntiCollision, ///< Anticollision is in progress
+                Halt ///< HLTA is in progress
+            };
+
         public:
             enum Status
             {
@@ -133,6 +165,8 @@ namespace Zhele
                 Error
             }; 
 
+            using Callback = std::add_pointer_t<void(Status status)>;
+
             /**
              * @brief Initialize MCU and MFRC522 unit
              * 
@@ -166,6 +200,15 @@ namespace Zhele
                 WriteRegister(Registers::TxASK, 0x40);
                 WriteRegister(Registers::Mode, 0x3d);
 
+                if constexpr (UseIrq)
+                {
+                    // IRQ pin is push-pull, active low (ComIEn IRqInv bit is set by every command)
+                    WriteRegister(Registers::DivInterruptEnable, 0x80);
+                    _IrqExti::template InitPin<_IrqPin>(_IrqPin::PullMode::PullUp);
+                    _IrqExti::template Init<_IrqExti::Trigger::Falling, typename _IrqPin::Port>();
+                    _IrqExti::EnableInterrupt();
+                }
+
                 AntennaOn();
             }
 
@@ -227,7 +270,227 @@ namespace Zhele
                 return true;
             }
 
+            /**
+             * @brief Try to read card without blocking
+             * 
+             * @details
+             * Request, anticollision and halt are performed in interrupts.
+             * 
+             * @param [out] cardId Buffer for card ID (5 bytes, should be valid until callback)
+             * @param [in] callback Complete callback (it is called from interrupt)
+             * 
+             * @retval true Check has been started
+             * @retval false Previous check is in progress
+             */
+            static bool CheckAsync(uint8_t* cardId, Callback callback)
+            {
+                static_assert(UseIrq, "Async check requires IRQ line");
+                if(_step != AsyncStep::Idle)
+                    return false;
+
+                _cardId = cardId;
+                _callback = callback;
+                _step = AsyncStep::Request;
+                uint8_t request = static_cast<uint8_t>(Commands::RequestIdl);
+                StartTransceive(&request, 1, 0x07, RxIrq | IdleIrq);
+                return true;
+            }
+
+            /**
+             * @brief Returns async check state
+             * 
+             * @retval true Async check is in progress
+             * @retval false Reader is idle
+             */
+            static bool Busy()
+            {
+                return _step != AsyncStep::Idle;
+            }
+
+            /**
+             * @brief IRQ pin EXTI handler
+             * 
+             * @par Returns
+             *	Nothing
+             */
+            static void IrqHandler()
+            {
+                _IrqExti::ClearInterruptFlag();
+                if(_step == AsyncStep::Idle)
+                    return;
+
+                uint8_t irq = ReadRegister(Registers::ComIrq);
+                if(!(irq & (_waitIrq | TimerIrq | ErrorIrq)))
+                    return;
+
+                WriteRegister(Registers::ComIrq, 0x7f);
+                WriteRegister(Registers::BitFraming, _bitFraming);
+
+                if(_step == AsyncStep::Halt)
+                {
+                    // Card does not answer HLTA, stop timeout timer
+                    WriteRegister(Registers::Control, 0x80);
+                    _step = AsyncStep::Idle;
+                    if(_callback)
+                        _callback(_status);
+                    return;
+                }
+
+                if((irq & ErrorIrq) && (ReadRegister(Registers::Error) & 0x1b))
+                {
+                    Halt(Status::Error);
+                    return;
+                }
+                if(!(irq & _waitIrq))
+                {
+                    Halt(Status::NoTagError);
+                    return;
+                }
+
+                uint8_t fifoSize = ReadRegister(Registers::FifoLevel);
+                uint8_t lastBits = ReadRegister(Registers::Control) & 0x07;
+                _receivedBits = lastBits ? (fifoSize - 1) * 8 + lastBits : fifoSize * 8;
+                if(fifoSize == 0 || fifoSize > MaxDataSize)
+                {
+                    Halt(Status::Error);
+                    return;
+                }
+
+                // Address byte per read byte, last byte is dummy
+                for(uint8_t i = 0; i < fifoSize; ++i)
+                    _txBuffer[i] = RegisterAddress(Registers::FifoData, true);
+                _txBuffer[fifoSize] = 0;
+                _SSPin::Clear();
+                _SpiBus::SendAsync(_txBuffer, _rxBuffer, fifoSize + 1, OnFifoRead);
+            }
+
         private:
+            /**
+             * @brief Returns register address byte
+             * 
+             * @param [in] registerAddress Register address
+             * @param [in] read Read access
+             * 
+             * @returns Address byte
+             */
+            static constexpr uint8_t RegisterAddress(Registers registerAddress, bool read)
+            {
+                return ((static_cast<uint8_t>(registerAddress) << 1) & 0x7e) | (read ? 0x80 : 0x00);
+            }
+
+            /**
+             * @brief Writes data to FIFO by one burst
+             * 
+             * @param [in] data Data
+             * @param [in] size Data size
+             * 
+             * @par Returns
+             *	Nothing
+             */
+            static void WriteFifo(const uint8_t* data, uint8_t size)
+            {
+                _SSPin::Clear();
+                _SpiBus::Send(RegisterAddress(Registers::FifoData, false));
+                for (uint8_t i = 0; i < size; ++i)
+                    _SpiBus::Send(data[i]);
+                _SSPin::Set();
+            }
+
+            /**
+             * @brief Reads data from FIFO by one burst
+             * 
+             * @param [out] data Output buffer
+             * @param [in] size Data size
+             * 
+             * @par Returns
+             *	Nothing
+             */
+            static void ReadFifo(uint8_t* data, uint8_t size)
+            {
+                const uint8_t address = RegisterAddress(Registers::FifoData, true);
+                _SSPin::Clear();
+                _SpiBus::Send(address);
+                for (uint8_t i = 0; i < size; ++i)
+                    data[i] = _SpiBus::Send(i + 1 < size ? address : 0);
+                _SSPin::Set();
+            }
+
+            /**
+             * @brief Start async transceive
+             * 
+             * @param [in] data Data to transmit
+             * @param [in] size Data size
+             * @param [in] bitFraming Bit framing (last byte bits)
+             * @param [in] waitIrq Complete interrupts
+             * 
+             * @par Returns
+             *	Nothing
+             */
+            static void StartTransceive(const uint8_t* data, uint8_t size, uint8_t bitFraming, uint8_t waitIrq)
+            {
+                _waitIrq = waitIrq;
+                _bitFraming = bitFraming;
+
+                WriteRegister(Registers::Command, static_cast<uint8_t>(Commands::Idle));
+                // Stale flags are cleared before IRQ enable: IRQ pin should not be asserted during FIFO transfer
+                WriteRegister(Registers::ComIrq, 0x7f);
+                WriteRegister(Registers::ComInterruptEnable, 0x80 | waitIrq | TimerIrq | ErrorIrq);
+                WriteRegister(Registers::FifoLevel, 0x80);
+                WriteRegister(Registers::BitFraming, bitFraming);
+
+                _txBuffer[0] = RegisterAddress(Registers::FifoData, false);
+                for (uint8_t i = 0; i < size; ++i)
+                    _txBuffer[i + 1] = data[i];
+                _SSPin::Clear();
+                _SpiBus::SendAsync(_txBuffer, _rxBuffer, size + 1, OnFifoWritten);
+            }
+
+            static void OnFifoWritten(void*, unsigned, bool)
+            {
+                _SSPin::Set();
+                WriteRegister(Registers::Command, static_cast<uint8_t>(Commands::Transceive));
+                // StartSend
+                WriteRegister(Registers::BitFraming, _bitFraming | 0x80);
+            }
+
+            static void OnFifoRead(void*, unsigned, bool)
+            {
+                _SSPin::Set();
+                const uint8_t* data = &_rxBuffer[1];
+
+                if(_step == AsyncStep::Request)
+                {
+                    if(_receivedBits != 0x10)
+                    {
+                        Halt(Status::Error);
+                        return;
+                    }
+                    _step = AsyncStep::AntiCollision;
+                    const uint8_t antiCollision[] = {static_cast<uint8_t>(Commands::AntiCollision), 0x20};
+                    StartTransceive(antiCollision, sizeof(antiCollision), 0x00, RxIrq | IdleIrq);
+                }
+                else if(_step == AsyncStep::AntiCollision)
+                {
+                    uint8_t idCheck = 0;
+                    for (int i = 0; i < 5; ++i)
+                    {
+                        _cardId[i] = data[i];
+                        idCheck ^= data[i];
+                    }
+                    // Last byte is BCC (xor of ID bytes)
+                    Halt(_receivedBits >= 40 && idCheck == 0 ? Status::Success : Status::Error);
+                }
+            }
+
+            static void Halt(Status status)
+            {
+                // HLTA with precalculated CRC_A
+                static const uint8_t halt[] = {static_cast<uint8_t>(Commands::Halt), 0x00, 0x57, 0xcd};
+                _status = status;
+                _step = AsyncStep::Halt;
+                StartTransceive(halt, sizeof(halt), 0x00, TxIrq);
+            }
+
             /**
              * @brief Writes value to register.
              * 
@@ -387,10 +650,7 @@ namespace Zhele
 
                 WriteRegister(Registers::Command, static_cast <uint8_t >(Commands::Idle));
 
-                for (int i = 0; i < transmitDataSize; ++i)
-                {
-                    WriteRegister(Registers::FifoData, transmitData[i]);
-                }
+                WriteFifo(transmitData, transmitDataSize);
 
                 WriteRegister(Registers::Command, static_cast <uint8_t >(command));
 
@@ -442,11 +702,8 @@ namespace Zhele
                         fifoSize = MaxDataSize;
                     }
 
-                    for (int i = 0; i < fifoSize; ++i)
-                    {
-                        receiveData[i] = ReadRegister(Registers::FifoData);
-                    }
-                    
+                    ReadFifo(receiveData, fifoSize);
+
                 }
 
                 return Status::Success;
@@ -481,10 +738,7 @@ namespace Zhele
                 ClearBitMask(Registers::DivIrq, 0x04);
                 SetBitMask(Registers::FifoLevel, 0x80);
 
-                for (int i = 0; i < size; ++i)
-                {
-                    WriteRegister(Registers::FifoData, data[i]);
-                }
+                WriteFifo(data, size);
                 WriteRegister(Registers::Command, static_cast <uint8_t >(Commands::CalculateCRC));
 
                 uint8_t timeout = 0xff;
@@ -588,7 +842,39 @@ namespace Zhele
                 uint16_t resultSize;
                 ToCard(Commands::Transceive, buffer, 4, buffer, &resultSize);
             }
+
+            static uint8_t _txBuffer[MaxDataSize + 1];
+            static uint8_t _rxBuffer[MaxDataSize + 1];
+            static uint8_t* _cardId;
+            static Callback _callback;
+            static volatile AsyncStep _step;
+            static Status _status;
+            static uint8_t _waitIrq;
+            static uint8_t _bitFraming;
+            static uint16_t _receivedBits;
         };
+
+        #define RC522_TEMPLATE_ARGS template<typename _SpiBus, typename _SSPin, typename _IrqExti, typename _IrqPin>
+        #define RC522_TEMPLATE_QUALIFIER Rc522<_SpiBus, _SSPin, _IrqExti, _IrqPin>
+
+        RC522_TEMPLATE_ARGS
+        uint8_t RC522_TEMPLATE_QUALIFIER::_txBuffer[MaxDataSize + 1];
+        RC522_TEMPLATE_ARGS
+        uint8_t RC522_TEMPLATE_QUALIFIER::_rxBuffer[MaxDataSize + 1];
+        RC522_TEMPLATE_ARGS
+        uint8_t* RC522_TEMPLATE_QUALIFIER::_cardId = nullptr;
+        RC522_TEMPLATE_ARGS
+        typename RC522_TEMPLATE_QUALIFIER::Callback RC522_TEMPLATE_QUALIFIER::_callback = nullptr;
+        RC522_TEMPLATE_ARGS
+        volatile typename RC522_TEMPLATE_QUALIFIER::AsyncStep RC522_TEMPLATE_QUALIFIER::_step = RC522_TEMPLATE_QUALIFIER::AsyncStep::Idle;
+        RC522_TEMPLATE_ARGS
+        typename RC522_TEMPLATE_QUALIFIER::Status RC522_TEMPLATE_QUALIFIER::_status = RC522_TEMPLATE_QUALIFIER::Status::Success;
+        RC522_TEMPLATE_ARGS
+        uint8_t RC522_TEMPLATE_QUALIFIER::_waitIrq = 0;
+        RC522_TEMPLATE_ARGS
+        uint8_t RC522_TEMPLATE_QUALIFIER::_bitFraming = 0;
+        RC522_TEMPLATE_ARGS
+        uint16_t RC522_TEMPLATE_QUALIFIER::_receivedBits = 0;
     }
 }
 
@@ -12,6 +12,27 @@
 
 #include <delay.h>
 #include <binary_stream.h>
+#include <common/crc.h>
+#include <common/template_utils/data_transfer.h>
+
+#include "filesystem/block_device.h"
+
+#include <iterator>
+#include <type_traits>
+
+#if !defined(ZHELE_SDCARD_USE_DMA)
+    #define ZHELE_SDCARD_USE_DMA 1
+#endif
+
+#if !defined(ZHELE_SDCARD_USE_CRC)
+    /// Check data blocks CRC16 (and enable card-side CRC check by CMD59)
+    #define ZHELE_SDCARD_USE_CRC 1
+#endif
+
+#if !defined(ZHELE_SDCARD_HIGH_SPEED)
+    /// Switch card to high-speed mode (CMD6) after detect, so SPI clock may be up to 50 MHz
+    #define ZHELE_SDCARD_HIGH_SPEED 0
+#endif
 
 namespace Zhele::Drivers
 {
@@ -20,6 +41,10 @@ namespace Zhele::Drivers
     {
         GoIdleState = 0, ///< Software reset
         SendOpCond = 1, ///< Initiate initialization process
+        AllSendCid = 2, ///< Ask all cards to send CID (SD bus mode)
+        SendRelativeAddress = 3, ///< Ask card to publish relative address (SD bus mode)
+        SwitchFunction = 6, ///< Check or switch card function (high-speed mode)
+        SelectCard = 7, ///< Select card by relative address (SD bus mode)
         SendIfCond = 8, ///< Check voltage range
         SendCsd = 9, ///< Read CSD register
         SendCid  = 10, ///< Read CID register
@@ -28,6 +53,7 @@ namespace Zhele::Drivers
         SetBlockLength = 16, ///< Change R/W block size
         ReadSingleBlock = 17, ///< Read block
         ReadMultipleBlock = 18, ///< Read multiple blocks
+        SetWrBlkEraseCount = 23, ///< Set number of blocks to pre-erase before multiple block write (ACMD23)
         WriteBlock = 24, ///< Write block
         WriteMultipleBlock = 25, ///< Write multiple blocks
         ProgramCsd = 27, ///< Program CSD register
@@ -41,7 +67,8 @@ namespace Zhele::Drivers
         GenCmd = 56, ///< Transfer data block
         ReadOcr = 58, ///< Read OCR register
         CrcOnOff = 59, ///< Turns CRC option on or off
-        SdSendOpCond = 41 // ACMD41
+        SdSendOpCond = 41, // ACMD41
+        SetBusWidth = 6 // ACMD6
     };
 
     /// R1 & R2 response bits
@@ -94,7 +121,7 @@ namespace Zhele::Drivers
     class SdCard
     {
         static const uint16_t CommandTimeoutValue = 100; ///< Command timeout
-        static const bool useCrc = false; ///< CRC using flag
+        static const bool useCrc = ZHELE_SDCARD_USE_CRC; ///< CRC using flag
         static SdCardType _type; ///< SD card type
         static BinaryStream<_SpiModule> Spi; ///< Binary stream
     
@@ -104,7 +131,7 @@ namespace Zhele::Drivers
          * 
          * @param index Index
          * @param arg Argument
-         * @param crc Crc (default 0)
+         * @param crc Crc (default 0, ignored and calculated if CRC is used)
          * @return uint16_t Command result
          */
         static uint16_t SpiCommand(uint8_t index, uint32_t arg, uint8_t crc = 0);
@@ -116,6 +143,29 @@ namespace Zhele::Drivers
          */
         static uint32_t ReadBlocksCount();
 
+        /**
+         * @brief Read max data transfer rate (TRAN_SPEED field of CSD)
+         * 
+         * @return uint32_t Transfer rate in Hz (0 if CSD read failed)
+         */
+        static uint32_t ReadTransferSpeed();
+
+        /**
+         * @brief Switch card to high-speed mode (CMD6)
+         * 
+         * @return true Card is in high-speed mode
+         * @return false Card does not support high-speed mode
+         */
+        static bool SwitchHighSpeed();
+
+        /**
+         * @brief Raise SPI clock up to card max transfer rate
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        static void RampUpClock();
+
         /**
          * @brief Wait while bus is busy
          * 
@@ -125,7 +175,29 @@ namespace Zhele::Drivers
         static bool WaitWhileBusy();
 
         /**
-         * @brief Read data block
+         * @brief Check that iterator can be used for DMA transfer
+         * 
+         * @tparam Iterator Iterator type
+         */
+        template<typename Iterator>
+        static constexpr bool IsDmaIterator = ZHELE_SDCARD_USE_DMA
+            && std::is_pointer_v<Iterator>
+            && sizeof(std::remove_pointer_t<Iterator>) == 1;
+
+        /**
+         * @brief Transfer data via SPI DMA (synchronous)
+         * 
+         * @param [in] transmitBuffer Data to transmit (nullptr for transmit 0xff)
+         * @param [out] receiveBuffer Receive buffer (nullptr for ignore received data)
+         * @param [in] size Data size
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        static void DmaTransfer(const void* transmitBuffer, void* receiveBuffer, size_t size);
+
+        /**
+         * @brief Read data packet (data token, data and CRC) without chip select control
          * 
          * @tparam ReadIterator Iterator type
          * 
@@ -135,32 +207,161 @@ namespace Zhele::Drivers
          * @return false Read failed
          */
         template<typename ReadIterator>
-        static bool ReadDataBlock(ReadIterator iter, size_t size)
+        static bool ReadDataPacket(ReadIterator iter, size_t size)
         {
-            _CsPin::Clear();
-
             uint8_t resp;
             resp = Spi.IgnoreWhile(1000, 0xFF);
             if(resp != 0xFE)
+                return false;
+
+            uint16_t crc = Crc16Ccitt::Initial;
+            if constexpr (IsDmaIterator<ReadIterator>)
             {
-                _CsPin::Set();
+                DmaTransfer(nullptr, iter, size);
+                if(useCrc)
+                    crc = Crc16Ccitt::Calculate(iter, size);
+            }
+            else if constexpr (std::is_pointer_v<ReadIterator>)
+            {
+                // Bulk read (without per-byte calls), CRC is calculated over received buffer
+                Spi.template Read<ReadIterator>(iter, size);
+                if(useCrc)
+                    crc = Crc16Ccitt::Calculate(iter, size);
+            }
+            else if(useCrc)
+            {
+                for(size_t i = 0; i < size; ++i, ++iter)
+                {
+                    uint8_t value = Spi.Read();
+                    crc = Crc16Ccitt::Update(crc, &value, 1);
+                    *iter = value;
+                }
+            }
+            else
+            {
+                Spi. template Read<ReadIterator>(iter, size);
+            }
+            uint16_t receivedCrc = Spi.ReadU16Be();
+            return !useCrc || crc == receivedCrc;
+        }
+
+        /**
+         * @brief Write data packet (data token, data and CRC) and check data response without chip select control
+         * 
+         * @tparam WriteIterator Iterator type
+         * 
+         * @param iter Iterator
+         * @param token Data token (0xFE for single block write, 0xFC for multiple block write)
+         * @return true Write success
+         * @return false Write failed
+         */
+        template<typename WriteIterator>
+        static bool WriteDataPacket(WriteIterator iter, uint8_t token)
+        {
+            if(Spi.Ignore(10000u, 0xff) != 0xff)
                 return false;
+
+            Spi.Write(token);
+            uint16_t crc = Crc16Ccitt::Initial;
+            if constexpr (IsDmaIterator<WriteIterator>)
+            {
+                if(useCrc)
+                    crc = Crc16Ccitt::Calculate(iter, 512);
+                DmaTransfer(iter, nullptr, 512);
             }
-            Spi. template Read<ReadIterator>(iter, size);
-            uint16_t crc = Spi.ReadU16Le();
-            if(useCrc)
+            else if constexpr (std::is_pointer_v<WriteIterator>)
+            {
+                if(useCrc)
+                    crc = Crc16Ccitt::Calculate(iter, 512);
+                Spi.template Write<WriteIterator>(iter, 512);
+            }
+            else if(useCrc)
             {
-                // TBD
+                for(size_t i = 0; i < 512; ++i, ++iter)
+                {
+                    uint8_t value = *iter;
+                    crc = Crc16Ccitt::Update(crc, &value, 1);
+                    Spi.Write(value);
+                }
             }
             else
             {
-                (void)crc;
+                Spi.template Write<WriteIterator>(iter, 512);
             }
+            if(useCrc)
+                Spi.WriteU16Be(crc);
+            else
+                Spi.ReadU16Be();
+            return (Spi.Read() & 0x1F) == 0x05;
+        }
+
+        /**
+         * @brief Read data block
+         * 
+         * @tparam ReadIterator Iterator type
+         * 
+         * @param iter Iterator
+         * @param size Size to read
+         * @return true Read success
+         * @return false Read failed
+         */
+        template<typename ReadIterator>
+        static bool ReadDataBlock(ReadIterator iter, size_t size)
+        {
+            _CsPin::Clear();
+            bool result = ReadDataPacket<ReadIterator>(iter, size);
             _CsPin::Set();
-            Spi.Read();
-            return true;
+            if(result)
+                Spi.Read();
+            return result;
         }
 
+        /**
+         * @brief Send stop transmission command (CMD12) and wait while card is busy
+         * 
+         * @details
+         * Chip select should be cleared (card selected) before call.
+         * 
+         * @return true Success
+         * @return false Fail
+         */
+        static bool StopTransmission();
+
+#if ZHELE_SDCARD_USE_DMA
+        /**
+         * @brief Queue one byte poll transaction for async operation
+         * 
+         * @param [in] callback Poll complete callback
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        static void QueuePoll(TransferCallback callback);
+
+        /**
+         * @brief Complete async operation
+         * 
+         * @param [in] success Operation result
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        static void CompleteAsync(bool success);
+
+        static void OnReadTokenPolled(void* data, unsigned size, bool success);
+        static void OnReadPacketReceived(void* data, unsigned size, bool success);
+        static void OnWriteReadyPolled(void* data, unsigned size, bool success);
+        static void OnWritePacketSent(void* data, unsigned size, bool success);
+
+        static const uint16_t AsyncPollLimit = 10000; ///< Max poll transactions count
+        static void* _asyncData; ///< Async operation data buffer
+        static Filesystem::BlockDeviceCallback _asyncCallback; ///< Async operation complete callback
+        static uint16_t _asyncPolls; ///< Async operation poll counter
+        static uint8_t _asyncResponse[3]; ///< Poll byte, CRC and data response
+        static uint8_t _asyncCrc[2]; ///< Transmitted data block CRC
+        static const uint8_t _asyncToken; ///< Multiple block write data token
+#endif
+
     public:
         /**
          * @brief Check card status
@@ -173,6 +374,11 @@ namespace Zhele::Drivers
         /**
          * @brief Detect sd card type
          * 
+         * @details
+         * Identification is done at SPI clock not above 400 kHz. After that
+         * SPI clock is raised up to card max transfer rate (CSD TRAN_SPEED),
+         * card is switched to high-speed mode before if ZHELE_SDCARD_HIGH_SPEED is set.
+         * 
          * @return SdCardType Card type
          */
         static SdCardType Detect();
@@ -191,6 +397,101 @@ namespace Zhele::Drivers
          */
         static size_t BlockSize();
 
+        /**
+         * @brief Wait for completion of card internal write process
+         * 
+         * @return true Card is ready
+         * @return false Timeout
+         */
+        static bool Sync();
+
+        /**
+         * @brief Erase blocks
+         * 
+         * @param [in] firstBlockAddress First block to erase
+         * @param [in] lastBlockAddress Last block to erase (inclusive)
+         * 
+         * @return true Success
+         * @return false Fail
+         */
+        static bool Erase(uint32_t firstBlockAddress, uint32_t lastBlockAddress);
+
+        /**
+         * @brief Start multiple block read (CMD18)
+         * 
+         * @details
+         * Card remains selected until EndRead call. Blocks are read by
+         * ReadDataPacket (sync) or ReadNextBlockAsync (DMA).
+         * 
+         * @param [in] logicalBlockAddress First block address
+         * 
+         * @return true Success
+         * @return false Fail
+         */
+        static bool BeginRead(uint32_t logicalBlockAddress);
+
+        /**
+         * @brief Stop multiple block read (CMD12) and deselect card
+         * 
+         * @return true Success
+         * @return false Fail
+         */
+        static bool EndRead();
+
+        /**
+         * @brief Start multiple block write (ACMD23 + CMD25)
+         * 
+         * @details
+         * Card remains selected until EndWrite call.
+         * 
+         * @param [in] logicalBlockAddress First block address
+         * @param [in] blocksCount Blocks to write count (for pre-erase)
+         * 
+         * @return true Success
+         * @return false Fail
+         */
+        static bool BeginWrite(uint32_t logicalBlockAddress, uint32_t blocksCount);
+
+        /**
+         * @brief Send stop transmission token, wait while card is busy and deselect card
+         * 
+         * @return true Success
+         * @return false Fail
+         */
+        static bool EndWrite();
+
+#if ZHELE_SDCARD_USE_DMA
+        /**
+         * @brief Read next block of multiple block read (started by BeginRead) asynchronously
+         * 
+         * @details
+         * Data token polling, data and CRC are transferred by SPI DMA transactions,
+         * so method does not wait for card. Callback is called from SPI DMA interrupt.
+         * 
+         * @param [out] data Output buffer (512 bytes)
+         * @param [in] callback Complete callback
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        static void ReadNextBlockAsync(uint8_t* data, Filesystem::BlockDeviceCallback callback);
+
+        /**
+         * @brief Write next block of multiple block write (started by BeginWrite) asynchronously
+         * 
+         * @details
+         * Busy polling, data token, data and data response are transferred by SPI DMA transactions,
+         * so method does not wait for card. Callback is called from SPI DMA interrupt.
+         * 
+         * @param [in] data Data to write (512 bytes)
+         * @param [in] callback Complete callback
+         * 
+         * @par Returns
+         *	Nothing
+         */
+        static void WriteNextBlockAsync(const uint8_t* data, Filesystem::BlockDeviceCallback callback);
+#endif
+
         /**
          * @brief Writes block to card
          * 
@@ -210,16 +511,7 @@ namespace Zhele::Drivers
             if(SpiCommand(SdCardCommand::WriteBlock, logicalBlockAddress) == 0)
             {
                 _CsPin::Clear();
-                if(Spi.Ignore(10000u, 0xff) != 0xff)
-                {
-                    return false;
-                }
-
-                Spi.Write(0xFE);
-                Spi.template Write<WriteIterator>(iter, 512);
-                Spi.ReadU16Be();
-                uint8_t resp;
-                if((resp = Spi.Read() & 0x1F) != 0x05)
+                if(!WriteDataPacket<WriteIterator>(iter, 0xFE))
                 {
                     return false;
                 }
@@ -230,6 +522,40 @@ namespace Zhele::Drivers
             return false;
         }
 
+        /**
+         * @brief Writes multiple blocks to card (CMD25)
+         * 
+         * @details
+         * For SD cards number of blocks is sent by ACMD23 before write,
+         * so card can pre-erase them and write faster.
+         * 
+         * @tparam WriteIterator Iterator type
+         * 
+         * @param iter Iterator
+         * @param logicalBlockAddress Block address
+         * @param [in] blocksCount Blocks to write count
+         * 
+         * @return true Success
+         * @return false Fail
+         */
+        template<typename WriteIterator>
+        static bool WriteMultipleBlock(WriteIterator iter, uint32_t logicalBlockAddress, uint32_t blocksCount)
+        {
+            if(blocksCount == 0)
+                return true;
+            if(!BeginWrite(logicalBlockAddress, blocksCount))
+                return false;
+
+            bool result = true;
+            for(uint32_t block = 0; block < blocksCount && result; ++block)
+            {
+                result = WriteDataPacket<WriteIterator>(iter, 0xFC);
+                std::advance(iter, 512);
+            }
+
+            return EndWrite() && result;
+        }
+
         /**
          * @brief Read block from card
          * 
@@ -270,15 +596,18 @@ namespace Zhele::Drivers
         template<typename ReadIterator>
         static bool ReadMultipleBlock(ReadIterator iter, uint32_t logicalBlockAddress, uint32_t blocksCount)
         {
-            if(_type != SdhcCard)
-                logicalBlockAddress <<= 9;
-            if(!WaitWhileBusy())
+            if(blocksCount == 0)
+                return true;
+            if(!BeginRead(logicalBlockAddress))
                 return false;
-            if(SpiCommand(SdCardCommand::ReadMultipleBlock, logicalBlockAddress) == 0)
+
+            bool result = true;
+            for(uint32_t block = 0; block < blocksCount && result; ++block)
             {
-                ReadDataBlock<ReadIterator>(iter, 512 * blocksCount);
+                result = ReadDataPacket<ReadIterator>(iter, 512);
+                std::advance(iter, 512);
             }
-            return false;
+            return EndRead() && result;
         }
     };
 
@@ -286,6 +615,20 @@ namespace Zhele::Drivers
     SdCardType SdCard<_SpiModule, _CsPin>::_type;
     template<typename _SpiModule, typename _CsPin>        
     BinaryStream<_SpiModule> SdCard<_SpiModule, _CsPin>::Spi;
+#if ZHELE_SDCARD_USE_DMA
+    template<typename _SpiModule, typename _CsPin>
+    void* SdCard<_SpiModule, _CsPin>::_asyncData;
+    template<typename _SpiModule, typename _CsPin>
+    Filesystem::BlockDeviceCallback SdCard<_SpiModule, _CsPin>::_asyncCallback;
+    template<typename _SpiModule, typename _CsPin>
+    uint16_t SdCard<_SpiModule, _CsPin>::_asyncPolls;
+    template<typename _SpiModule, typename _CsPin>
+    uint8_t SdCard<_SpiModule, _CsPin>::_asyncResponse[3];
+    template<typename _SpiModule, typename _CsPin>
+    uint8_t SdCard<_SpiModule, _CsPin>::_asyncCrc[2];
+    template<typename _SpiModule, typename _CsPin>
+    const uint8_t SdCard<_SpiModule, _CsPin>::_asyncToken = 0xFC;
+#endif
 } // namespace Zhele::Drivers
 
 #include "impl/sdcard.h"
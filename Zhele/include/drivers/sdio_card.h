@@ -0,0 +1,392 @@
+/**
+ * @file
+ * Driver for SD card on SDIO peripheral (4-bit bus, DMA)
+ *
+ * @author Alexey Zhelonkin
+ * @date 2023
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DRIVERS_SDIOCARD_H
+#define ZHELE_DRIVERS_SDIOCARD_H
+
+#include <clock.h>
+#include <delay.h>
+#include <dma.h>
+#include <iopins.h>
+#include <pinlist.h>
+
+#include "sdcard.h"
+#include "../common/nvic.h"
+#include "filesystem/block_device.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#if defined (SDIO)
+
+namespace Zhele::Drivers
+{
+    namespace Private
+    {
+        IO_STRUCT_WRAPPER(SDIO, SdioRegs, SDIO_TypeDef);
+
+    #if defined (DMA_SxCR_EN)
+        using SdioDma = Dma2Stream3Channel4;
+    #else
+        using SdioDma = Dma2Channel4;
+    #endif
+    }
+
+    /**
+     * @brief Implements SD card on SDIO peripheral
+     *
+     * @details
+     * Card is used in 4-bit bus mode, data is transferred by DMA. Class has the same
+     * block device interface as SdCard, so it can be used with SdCardFatFsAdapter,
+     * BlockDeviceScsiLun and PipelinedScsiLun.
+     * Pins: D0-D3 - PC8-PC11, CK - PC12, CMD - PD2 (CMD and D0-D3 need external pull-up).
+     * DMA buffers should be 4-bytes aligned, other buffers are copied through internal block buffer.
+     * Async methods (ReadNextBlockAsync/WriteNextBlockAsync) use SDIO interrupt:
+     * call IrqHandler in SDIO interrupt handler.
+     *
+     * @tparam _DmaChannel DMA channel (stream) connected to SDIO
+     */
+    template<typename _DmaChannel = Private::SdioDma>
+    class SdioCard
+    {
+        using Regs = Private::SdioRegs;
+        using Pins = IO::PinList<IO::Pc8, IO::Pc9, IO::Pc10, IO::Pc11, IO::Pc12, IO::Pd2>;
+
+        /// Command response type
+        enum ResponseType : uint32_t
+        {
+            NoResponse = 0, ///< Command without response
+            ShortResponse = SDIO_CMD_WAITRESP_0, ///< 48-bit response (R1, R3, R6, R7)
+            LongResponse = SDIO_CMD_WAITRESP_0 | SDIO_CMD_WAITRESP_1 ///< 136-bit response (R2)
+        };
+
+        static const unsigned BlockLength = 512; ///< Data block length
+        static const unsigned BlockLengthPower = 9; ///< Data block length (power of 2)
+        static const uint32_t MaxTransferBlocks = 128; ///< Max blocks per transfer (DMA counter limit)
+        static const uint32_t CardStatusErrors = 0xfdf98008; ///< Error bits of R1 card status
+        static const uint32_t CardReadyForData = 1ul << 8; ///< READY_FOR_DATA bit of card status
+        static const uint32_t CardTransferState = 4; ///< "tran" state of card status CURRENT_STATE
+        static const uint32_t IdentificationFreq = 400000; ///< Card identification clock
+
+        static const uint32_t CommandFlags = SDIO_STA_CCRCFAIL | SDIO_STA_CTIMEOUT | SDIO_STA_CMDREND | SDIO_STA_CMDSENT;
+        static const uint32_t DataErrorFlags = SDIO_STA_DCRCFAIL | SDIO_STA_DTIMEOUT | SDIO_STA_TXUNDERR | SDIO_STA_RXOVERR | SDIO_STA_STBITERR;
+        static const uint32_t DataFlags = DataErrorFlags | SDIO_STA_DATAEND | SDIO_STA_DBCKEND;
+
+    public:
+        /**
+         * @brief Init SDIO and detect card
+         *
+         * @details
+         * Identification is done at 400 kHz on 1-bit bus. After that card is switched
+         * to 4-bit bus and clock is raised up to card max transfer rate (CSD TRAN_SPEED).
+         *
+         * @return SdCardType Card type (SdCardNone if card is not detected)
+         */
+        static SdCardType Detect();
+
+        /**
+         * @brief Check card status
+         *
+         * @return true OK
+         * @return false Error
+         */
+        static bool CheckStatus();
+
+        /**
+         * @brief Returns card's blocks count (read from CSD by Detect)
+         *
+         * @return uint32_t Blocks count
+         */
+        static uint32_t BlocksCount();
+
+        /**
+         * @brief Returns card's block size
+         *
+         * @return size_t Block size
+         */
+        static size_t BlockSize();
+
+        /**
+         * @brief Wait for completion of card internal write process
+         *
+         * @return true Card is ready
+         * @return false Timeout
+         */
+        static bool Sync();
+
+        /**
+         * @brief Erase blocks
+         *
+         * @param [in] firstBlockAddress First block to erase
+         * @param [in] lastBlockAddress Last block to erase (inclusive)
+         *
+         * @return true Success
+         * @return false Fail
+         */
+        static bool Erase(uint32_t firstBlockAddress, uint32_t lastBlockAddress);
+
+        /**
+         * @brief Read block
+         *
+         * @param [out] data Output buffer (512 bytes)
+         * @param [in] logicalBlockAddress Block address
+         *
+         * @return true Success
+         * @return false Fail
+         */
+        static bool ReadBlock(uint8_t* data, uint32_t logicalBlockAddress);
+
+        /**
+         * @brief Read multiple blocks (CMD18)
+         *
+         * @param [out] data Output buffer
+         * @param [in] logicalBlockAddress First block address
+         * @param [in] blocksCount Blocks count
+         *
+         * @return true Success
+         * @return false Fail
+         */
+        static bool ReadMultipleBlock(uint8_t* data, uint32_t logicalBlockAddress, uint32_t blocksCount);
+
+        /**
+         * @brief Write block
+         *
+         * @param [in] data Data to write (512 bytes)
+         * @param [in] logicalBlockAddress Block address
+         *
+         * @return true Success
+         * @return false Fail
+         */
+        static bool WriteBlock(const uint8_t* data, uint32_t logicalBlockAddress);
+
+        /**
+         * @brief Write multiple blocks (ACMD23 + CMD25)
+         *
+         * @param [in] data Data to write
+         * @param [in] logicalBlockAddress First block address
+         * @param [in] blocksCount Blocks count
+         *
+         * @return true Success
+         * @return false Fail
+         */
+        static bool WriteMultipleBlock(const uint8_t* data, uint32_t logicalBlockAddress, uint32_t blocksCount);
+
+        /**
+         * @brief Start blocks streaming read
+         *
+         * @details
+         * SDIO can't pause card during multiple block read, so each
+         * block of stream is read by single block read command.
+         *
+         * @param [in] logicalBlockAddress First block address
+         *
+         * @return true Success
+         * @return false Fail
+         */
+        static bool BeginRead(uint32_t logicalBlockAddress);
+
+        /**
+         * @brief Read next block of stream (started by BeginRead) asynchronously
+         *
+         * @param [out] data Output buffer (512 bytes)
+         * @param [in] callback Complete callback (called from SDIO interrupt)
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void ReadNextBlockAsync(uint8_t* data, Filesystem::BlockDeviceCallback callback);
+
+        /**
+         * @brief Finish blocks streaming read
+         *
+         * @return true Success
+         * @return false Fail
+         */
+        static bool EndRead();
+
+        /**
+         * @brief Start multiple block write (ACMD23 + CMD25)
+         *
+         * @param [in] logicalBlockAddress First block address
+         * @param [in] blocksCount Blocks to write count (for pre-erase)
+         *
+         * @return true Success
+         * @return false Fail
+         */
+        static bool BeginWrite(uint32_t logicalBlockAddress, uint32_t blocksCount);
+
+        /**
+         * @brief Write next block of multiple block write (started by BeginWrite) asynchronously
+         *
+         * @param [in] data Data to write (512 bytes)
+         * @param [in] callback Complete callback (called from SDIO interrupt)
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void WriteNextBlockAsync(const uint8_t* data, Filesystem::BlockDeviceCallback callback);
+
+        /**
+         * @brief Stop multiple block write (CMD12) and wait while card is busy
+         *
+         * @return true Success
+         * @return false Fail
+         */
+        static bool EndWrite();
+
+        /**
+         * @brief SDIO interrupt handler
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void IrqHandler();
+
+    private:
+        /**
+         * @brief Returns SDIOCLK frequence
+         *
+         * @returns SDIO adapter clock (HCLK for stm32f1, PLL48CLK for stm32f4)
+         */
+        static uint32_t AdapterClockFreq();
+
+        /**
+         * @brief Set SDIO_CK frequence (not above given value)
+         *
+         * @param [in] maxFreq Max SDIO_CK frequence
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void SetClockFreq(uint32_t maxFreq);
+
+        /**
+         * @brief Send command
+         *
+         * @param [in] index Command index
+         * @param [in] arg Argument
+         * @param [in] response Response type
+         * @param [in] checkCrc Check response CRC (R3 response has no CRC)
+         *
+         * @return true Response received
+         * @return false Response timeout or CRC error
+         */
+        static bool SendCommand(uint8_t index, uint32_t arg, ResponseType response = ShortResponse, bool checkCrc = true);
+
+        /**
+         * @brief Send application command (CMD55 + ACMD)
+         *
+         * @param [in] index Command index
+         * @param [in] arg Argument
+         * @param [in] checkCrc Check response CRC
+         *
+         * @return true Response received
+         * @return false Response timeout or CRC error
+         */
+        static bool SendAppCommand(uint8_t index, uint32_t arg, bool checkCrc = true);
+
+        /**
+         * @brief Send command with R1 response and check card status
+         *
+         * @param [in] index Command index
+         * @param [in] arg Argument
+         *
+         * @return true Success
+         * @return false Fail
+         */
+        static bool CardCommand(uint8_t index, uint32_t arg);
+
+        /**
+         * @brief Wait for card "tran" state and ready for data
+         *
+         * @return true Card is ready
+         * @return false Timeout or error
+         */
+        static bool WaitReady();
+
+        /**
+         * @brief Convert block number to command address
+         *
+         * @param [in] logicalBlockAddress Block number
+         *
+         * @return uint32_t Block address (SDHC) or byte address (SDSC)
+         */
+        static uint32_t Address(uint32_t logicalBlockAddress);
+
+        /**
+         * @brief Check that buffer can be used for DMA transfer
+         *
+         * @param [in] data Buffer
+         *
+         * @return true Buffer is 4-bytes aligned
+         * @return false Buffer should be copied through block buffer
+         */
+        static bool IsDmaBuffer(const void* data);
+
+        /**
+         * @brief Start DMA and data path state machine
+         *
+         * @param [in] data Buffer (4-bytes aligned)
+         * @param [in] size Data size
+         * @param [in] read Transfer direction
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void StartData(const void* data, uint32_t size, bool read);
+
+        /**
+         * @brief Wait for end of data transfer (started by StartData)
+         *
+         * @param [in] read Transfer direction
+         *
+         * @return true Success
+         * @return false Data error
+         */
+        static bool WaitDataEnd(bool read);
+
+        /**
+         * @brief Stop data path and DMA after error
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void AbortData();
+
+        /**
+         * @brief Read or write blocks (buffers are 4-bytes aligned)
+         *
+         * @param [in] data Buffer
+         * @param [in] logicalBlockAddress First block address
+         * @param [in] blocksCount Blocks count
+         * @param [in] read Transfer direction
+         *
+         * @return true Success
+         * @return false Fail
+         */
+        static bool TransferBlocks(uint8_t* data, uint32_t logicalBlockAddress, uint32_t blocksCount, bool read);
+
+        static SdCardType _type; ///< Card type
+        static uint32_t _rca; ///< Relative card address (in high half-word)
+        static uint32_t _blocksCount; ///< Card blocks count
+        static uint32_t _dataTimeout; ///< Data timeout (SDIO_CK periods)
+        static uint32_t _streamAddress; ///< Next block of streaming read
+
+        static Filesystem::BlockDeviceCallback _asyncCallback; ///< Async operation callback
+        static uint8_t* _asyncData; ///< Async read output buffer
+        static volatile bool _asyncRead; ///< Async operation direction
+        alignas(4) static uint8_t _buffer[BlockLength]; ///< Block buffer for unaligned data
+    };
+}
+
+#include "impl/sdio_card.h"
+
+#endif
+
+#endif //! ZHELE_DRIVERS_SDIOCARD_H
@@ -0,0 +1,336 @@
+/**
+ * @file
+ * Sensors sampling scheduler
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DRIVERS_SENSOR_SCHEDULER_H
+#define ZHELE_DRIVERS_SENSOR_SCHEDULER_H
+
+#include <stdint.h>
+#include <utility>
+
+namespace Zhele::Drivers
+{
+    /**
+     * @brief Sample collection status
+     */
+    enum class SampleStatus : uint8_t
+    {
+        Pending, ///< Result is not ready yet (collect is repeated on next poll)
+        Success, ///< Sample has been read
+        Failed ///< Sample has been lost (bus or sensor error)
+    };
+
+    /**
+     * @brief Sampling adapter of BMP280 with timebase (non-blocking measurement)
+     *
+     * @details
+     * Sensor should be initialized by StartInit. Sample is available by Temperature/Pressure.
+     *
+     * @tparam _Sensor Bmp280 instance
+     */
+    template<typename _Sensor>
+    class Bmp280Sampling
+    {
+        using State = typename _Sensor::State;
+    public:
+        /// Measurement delay is handled by driver
+        static constexpr uint32_t ConversionTime = 0;
+
+        static void Poll() { _Sensor::Poll(); }
+        static bool Trigger() { return _Sensor::StartMeasurement(); }
+        static SampleStatus Collect()
+        {
+            State state = _Sensor::GetState();
+            if(state == State::Ready)
+                return SampleStatus::Success;
+            return state == State::Error ? SampleStatus::Failed : SampleStatus::Pending;
+        }
+    };
+
+    /**
+     * @brief Sampling adapter of AHT10 on I2C transactions queue
+     *
+     * @details
+     * Sensor should be initialized by StartInit. Sample is available by LastMeasurement.
+     *
+     * @tparam _Sensor Aht10Async instance
+     */
+    template<typename _Sensor>
+    class Aht10Sampling
+    {
+        using State = typename _Sensor::State;
+    public:
+        /// Measurement delay is handled by driver
+        static constexpr uint32_t ConversionTime = 0;
+
+        static void Poll() { _Sensor::Poll(); }
+        static bool Trigger() { return _Sensor::StartMeasurement(); }
+        static SampleStatus Collect()
+        {
+            State state = _Sensor::GetState();
+            if(state == State::Ready)
+                return SampleStatus::Success;
+            return state == State::Error ? SampleStatus::Failed : SampleStatus::Pending;
+        }
+    };
+
+    /**
+     * @brief Sampling adapter of DS18B20 (all sensors of line are triggered by SKIP ROM)
+     *
+     * @details
+     * 1-Wire transactions are blocking, but conversion is not: other sensors
+     * are sampled while DS18B20 converts. Sample is available by Result.
+     *
+     * @tparam _Sensor Ds18b20 instance
+     * @tparam _ResolutionBits Configured sensor resolution (conversion time depends on it)
+     */
+    template<typename _Sensor, uint8_t _ResolutionBits = 12>
+    class Ds18b20Sampling
+    {
+        using ConvertResult = typename _Sensor::ConvertResult;
+    public:
+        static constexpr uint32_t ConversionTime = _Sensor::ConversionTime(_ResolutionBits) * 1000;
+
+        static void Poll() {}
+        static bool Trigger() { return _Sensor::Start(); }
+        static SampleStatus Collect()
+        {
+            _result = _Sensor::Read();
+            return _result.Success ? SampleStatus::Success : SampleStatus::Failed;
+        }
+
+        /**
+         * @brief Returns last sample
+         *
+         * @returns Conversion result
+         */
+        static const ConvertResult& Result() { return _result; }
+
+    private:
+        static ConvertResult _result;
+    };
+
+    template<typename _Sensor, uint8_t _ResolutionBits>
+    typename Ds18b20Sampling<_Sensor, _ResolutionBits>::ConvertResult Ds18b20Sampling<_Sensor, _ResolutionBits>::_result {};
+
+    /**
+     * @brief Sampling adapter of DS1307 (time is read without conversion)
+     *
+     * @tparam _Rtc Ds1307 instance
+     */
+    template<typename _Rtc>
+    class Ds1307Sampling
+    {
+        using Time = typename _Rtc::Time;
+    public:
+        static constexpr uint32_t ConversionTime = 0;
+
+        static void Poll() {}
+        static bool Trigger() { return true; }
+        static SampleStatus Collect()
+        {
+            _time = _Rtc::GetDateTime();
+            return SampleStatus::Success;
+        }
+
+        /**
+         * @brief Returns last read time
+         *
+         * @returns Time
+         */
+        static const Time& Result() { return _time; }
+
+    private:
+        static Time _time;
+    };
+
+    template<typename _Rtc>
+    typename Ds1307Sampling<_Rtc>::Time Ds1307Sampling<_Rtc>::_time {};
+
+    /**
+     * @brief Sampling task
+     *
+     * @tparam _Sensor Sampling adapter (Poll, Trigger, Collect methods and ConversionTime constant)
+     * @tparam _Period Sampling period (us), 0 for back-to-back sampling
+     * @tparam _Callback Sample callback (optional, it is called from scheduler Poll)
+     */
+    template<typename _Sensor, uint32_t _Period, void (*_Callback)(SampleStatus status) = nullptr>
+    struct SamplingTask
+    {
+        using Sensor = _Sensor;
+        static constexpr uint32_t Period = _Period;
+        static constexpr void (*Callback)(SampleStatus status) = _Callback;
+    };
+
+    /**
+     * @brief Declarative sensors sampling scheduler
+     *
+     * @details
+     * Every task is a state machine: sensor is triggered when period elapses, and its result is collected
+     * after sensor conversion time. Poll (call it from main loop) only starts short transactions and never
+     * waits, so while one sensor converts, others are triggered and read. Async drivers (Bmp280, Aht10Async)
+     * queue their transactions, so transactions of sensors on one bus are executed back-to-back.
+     * Sampling adapter is a class with static methods:
+     * - Poll(): driver time-driven steps (called on every scheduler poll);
+     * - Trigger(): start conversion, false if sensor or bus is busy (trigger is repeated on next poll);
+     * - Collect(): read result (SampleStatus::Pending while result is not ready).
+     *
+     * If sampling lags behind period (slow bus, long conversion), missed samples are skipped,
+     * not sampled back-to-back.
+     * @code
+     * using Scheduler = SensorScheduler<Timebase,
+     *     SamplingTask<Bmp280Sampling<Barometer>, 100000>,
+     *     SamplingTask<Ds18b20Sampling<Thermometer>, 0, OnTemperature>>;
+     * @endcode
+     *
+     * @tparam _Timebase Timebase with Micros method (See timebase.h)
+     * @tparam _Tasks Sampling tasks (SamplingTask)
+     */
+    template<typename _Timebase, typename... _Tasks>
+    class SensorScheduler
+    {
+        static constexpr unsigned TasksCount = sizeof...(_Tasks);
+        static_assert(TasksCount > 0, "Scheduler requires at least one task");
+
+        enum class TaskState : uint8_t
+        {
+            Stopped, ///< Task is not started
+            Waiting, ///< Waiting for sampling time
+            Converting ///< Sensor has been triggered
+        };
+    public:
+        /**
+         * @brief Start sampling (all tasks are due immediately)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Start()
+        {
+            uint32_t now = _Timebase::Micros();
+            for(unsigned i = 0; i < TasksCount; ++i)
+            {
+                _due[i] = now;
+                _state[i] = TaskState::Waiting;
+            }
+        }
+
+        /**
+         * @brief Stop sampling (triggered conversions are not collected)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Stop()
+        {
+            for(unsigned i = 0; i < TasksCount; ++i)
+                _state[i] = TaskState::Stopped;
+        }
+
+        /**
+         * @brief Process tasks (call it from main loop)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Poll()
+        {
+            PollTasks(std::make_index_sequence<TasksCount>{});
+        }
+
+        /**
+         * @brief Returns collected samples count
+         *
+         * @returns Successful samples of all tasks
+         */
+        static uint32_t Samples()
+        {
+            return _samples;
+        }
+
+        /**
+         * @brief Returns lost samples count
+         *
+         * @returns Failed samples of all tasks
+         */
+        static uint32_t Failures()
+        {
+            return _failures;
+        }
+
+    private:
+        template<size_t... _Indexes>
+        static void PollTasks(std::index_sequence<_Indexes...>)
+        {
+            (PollTask<_Indexes, _Tasks>(), ...);
+        }
+
+        template<unsigned _Index, typename _Task>
+        static void PollTask()
+        {
+            using Sensor = typename _Task::Sensor;
+            Sensor::Poll();
+
+            uint32_t now = _Timebase::Micros();
+            switch(_state[_Index])
+            {
+            case TaskState::Waiting:
+                if(static_cast<int32_t>(now - _due[_Index]) < 0 || !Sensor::Trigger())
+                    break;
+                _state[_Index] = TaskState::Converting;
+                // Next trigger time is kept on period grid, lagged task skips missed samples
+                _due[_Index] += _Task::Period;
+                if(static_cast<int32_t>(now - _due[_Index]) > 0)
+                    _due[_Index] = now;
+                _ready[_Index] = now + Sensor::ConversionTime;
+                break;
+            case TaskState::Converting:
+            {
+                if(static_cast<int32_t>(now - _ready[_Index]) < 0)
+                    break;
+                SampleStatus status = Sensor::Collect();
+                if(status == SampleStatus::Pending)
+                    break;
+                _state[_Index] = TaskState::Waiting;
+                if(status == SampleStatus::Success)
+                    _samples = _samples + 1;
+                else
+                    _failures = _failures + 1;
+                if constexpr (_Task::Callback != nullptr)
+                    _Task::Callback(status);
+                break;
+            }
+            default:
+                break;
+            }
+        }
+
+        static uint32_t _due[TasksCount];
+        static uint32_t _ready[TasksCount];
+        static TaskState _state[TasksCount];
+        static uint32_t _samples;
+        static uint32_t _failures;
+    };
+
+    template<typename _Timebase, typename... _Tasks>
+    uint32_t SensorScheduler<_Timebase, _Tasks...>::_due[TasksCount];
+
+    template<typename _Timebase, typename... _Tasks>
+    uint32_t SensorScheduler<_Timebase, _Tasks...>::_ready[TasksCount];
+
+    template<typename _Timebase, typename... _Tasks>
+    typename SensorScheduler<_Timebase, _Tasks...>::TaskState SensorScheduler<_Timebase, _Tasks...>::_state[TasksCount];
+
+    template<typename _Timebase, typename... _Tasks>
+    uint32_t SensorScheduler<_Timebase, _Tasks...>::_samples = 0;
+
+    template<typename _Timebase, typename... _Tasks>
+    uint32_t SensorScheduler<_Timebase, _Tasks...>::_failures = 0;
+}
+
+#endif //! ZHELE_DRIVERS_SENSOR_SCHEDULER_H
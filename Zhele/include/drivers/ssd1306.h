@@ -10,22 +10,232 @@
 #define ZHELE_DRIVERS_SSD1306_H
 
 #include <delay.h>
+#include <i2c.h>
+#include <iopins.h>
 
 #include <cstring>
+#include <type_traits>
 
 namespace Zhele::Drivers
 {
-    template <typename I2CBus>
-    class Ssd1306
+    /// Ssd1306 transport transfer complete callback
+    using Ssd1306TransferCallback = void(*)(bool success);
+
+    /**
+     * @brief Ssd1306 I2C transport
+     * 
+     * @tparam _I2c I2C bus
+     * @tparam _Address Display address
+     */
+    template<typename _I2c, uint8_t _Address = (0x78 >> 1)>
+    class Ssd1306I2cTransport
     {
-        static const uint8_t I2cAddress = (0x78 >> 1);
+        static const uint8_t CommandStream = 0x00;
+        static const uint8_t DataStream = 0x40;
+
+    public:
+        /**
+         * @brief Init transport
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Init() {}
+
+        /**
+         * @brief Write commands (blocking)
+         * 
+         * @param [in] commands Commands
+         * @param [in] size Commands size
+         * 
+         * @retval true Success
+         * @retval false Display not responding
+         */
+        static bool WriteCommands(const uint8_t* commands, uint16_t size)
+        {
+            return _I2c::Write(_Address, CommandStream, commands, size) == I2cStatus::Success;
+        }
+
+        /**
+         * @brief Write commands (async)
+         * 
+         * @param [in] commands Commands (should be valid until callback is called)
+         * @param [in] size Commands size
+         * @param [in] callback Complete callback
+         * 
+         * @retval true Transfer has been started
+         * @retval false Bus is busy
+         */
+        static bool WriteCommandsAsync(const uint8_t* commands, uint16_t size, Ssd1306TransferCallback callback)
+        {
+            return WriteAsync(CommandStream, commands, size, callback);
+        }
+
+        /**
+         * @brief Write display data (async)
+         * 
+         * @param [in] data Data (should be valid until callback is called)
+         * @param [in] size Data size
+         * @param [in] callback Complete callback
+         * 
+         * @retval true Transfer has been started
+         * @retval false Bus is busy
+         */
+        static bool WriteDataAsync(const uint8_t* data, uint16_t size, Ssd1306TransferCallback callback)
+        {
+            return WriteAsync(DataStream, data, size, callback);
+        }
+
+    private:
+        static bool WriteAsync(uint8_t control, const uint8_t* data, uint16_t size, Ssd1306TransferCallback callback)
+        {
+            _callback = callback;
+            return _I2c::WriteAsync(_Address, control, data, size, I2cOpts::None, [](I2cStatus status){
+                _callback(status == I2cStatus::Success);
+            }) == I2cStatus::Success;
+        }
+
+        static Ssd1306TransferCallback _callback;
+    };
+
+    template<typename _I2c, uint8_t _Address>
+    Ssd1306TransferCallback Ssd1306I2cTransport<_I2c, _Address>::_callback = nullptr;
+
+    /**
+     * @brief Ssd1306 4-wire SPI transport
+     * 
+     * @details
+     * SPI should be initialized (mode 0, 8 bit data size) by user, display data is sent by DMA.
+     * 
+     * @tparam _Spi SPI bus
+     * @tparam _SsPin Chip select pin
+     * @tparam _DcPin Data/Command pin
+     * @tparam _ResetPin Reset pin (NullPin if not connected)
+     */
+    template<typename _Spi, typename _SsPin, typename _DcPin, typename _ResetPin = IO::NullPin>
+    class Ssd1306SpiTransport
+    {
+    public:
+        /**
+         * @brief Init transport (reset display)
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Init()
+        {
+            _SsPin::Set();
+
+            if constexpr (!std::is_same_v<_ResetPin, IO::NullPin>)
+            {
+                _ResetPin::Clear();
+                delay_ms<1>();
+                _ResetPin::Set();
+                delay_ms<1>();
+            }
+        }
+
+        /**
+         * @brief Write commands (blocking)
+         * 
+         * @param [in] commands Commands
+         * @param [in] size Commands size
+         * 
+         * @retval true Always (there is no way to detect display on SPI)
+         */
+        static bool WriteCommands(const uint8_t* commands, uint16_t size)
+        {
+            _SsPin::Clear();
+            _DcPin::Clear();
+
+            for(uint16_t i = 0; i < size; ++i)
+                _Spi::Write(commands[i]);
+            while(_Spi::Busy()) continue;
+
+            _SsPin::Set();
+            return true;
+        }
+
+        /**
+         * @brief Write commands (async)
+         * 
+         * @param [in] commands Commands (should be valid until callback is called)
+         * @param [in] size Commands size
+         * @param [in] callback Complete callback
+         * 
+         * @retval true Transfer has been started
+         */
+        static bool WriteCommandsAsync(const uint8_t* commands, uint16_t size, Ssd1306TransferCallback callback)
+        {
+            _DcPin::Clear();
+            return WriteAsync(commands, size, callback);
+        }
+
+        /**
+         * @brief Write display data (async)
+         * 
+         * @param [in] data Data (should be valid until callback is called)
+         * @param [in] size Data size
+         * @param [in] callback Complete callback
+         * 
+         * @retval true Transfer has been started
+         */
+        static bool WriteDataAsync(const uint8_t* data, uint16_t size, Ssd1306TransferCallback callback)
+        {
+            _DcPin::Set();
+            return WriteAsync(data, size, callback);
+        }
+
+    private:
+        static bool WriteAsync(const uint8_t* data, uint16_t size, Ssd1306TransferCallback callback)
+        {
+            _callback = callback;
+            _SsPin::Clear();
+            _Spi::WriteAsync(data, size, [](void*, unsigned, bool success){
+                while(_Spi::Busy()) continue;
+                _SsPin::Set();
+                _callback(success);
+            });
+            return true;
+        }
+
+        static Ssd1306TransferCallback _callback;
+    };
+
+    template<typename _Spi, typename _SsPin, typename _DcPin, typename _ResetPin>
+    Ssd1306TransferCallback Ssd1306SpiTransport<_Spi, _SsPin, _DcPin, _ResetPin>::_callback = nullptr;
+
+    /**
+     * @brief Implements Ssd1306 (128x64) OLED display driver
+     * 
+     * @details
+     * Framebuffer logic is independent of bus, bus is given by transport
+     * (Ssd1306I2cTransport or Ssd1306SpiTransport).
+     * With double buffer drawing methods modify back buffer only, Update copies modified regions
+     * to front buffer (it takes few microseconds) and sends them in background, so next frame
+     * can be drawn while previous one is being transmitted without tearing.
+     * 
+     * @tparam _Transport Transport
+     * @tparam _DoubleBuffer Use second (front) framebuffer for transmission
+     */
+    template <typename _Transport, bool _DoubleBuffer = false>
+    class Ssd1306Base
+    {
+    public:
+        /// Display width
         static const uint8_t Width = 128;
+        /// Display height
         static const uint8_t Height = 64;
 
+    private:
+        static const uint8_t Pages = Height / 8;
+
         // Ssd1306 commands
         enum Commands : uint8_t
         {
             SetMemoryMode = 0x20, ///< Set Memory Addressing Mode
+            SetColumnAddress = 0x21, ///< Set column start and end address
+            SetPageAddress = 0x22, ///< Set page start and end address
             On = 0xAF, ///< Display On
             Off = 0xAE, ///< Display off
         };       
@@ -37,6 +247,9 @@ namespace Zhele::Drivers
             On = true ///< Pixel on (color depends of LCD used)
         };
 
+        /// Color type (for Graphics)
+        using ColorType = Pixel;
+
         /**
          * Initialize display
          * 
@@ -58,10 +271,27 @@ namespace Zhele::Drivers
         /**
          * Update LCD
          * 
-         * @par Returns
-         *  Nothing
+         * @details
+         * Sends only modified (dirty) region of each page. Consecutive fully modified pages
+         * are sent by one transfer. Transfer is asynchronous: pages are sent one by one from
+         * I2C complete callback until there are no dirty pages. If update is already in progress,
+         * method does nothing (new changes will be sent by current update).
+         * With double buffer frame is latched (modified regions are copied to front buffer) only if
+         * previous update is complete, otherwise frame is not latched and its changes are sent with
+         * next frame (so animation runs at bus-limited frame rate and drawing never waits for bus).
+         * 
+         * @retval true Frame is latched (or will be sent by current update without double buffer)
+         * @retval false Update is in progress, frame is not latched (double buffer only)
          */
-        static void Update();
+        static bool Update();
+
+        /**
+         * Returns update state
+         * 
+         * @retval true Update is in progress
+         * @retval false Display is updated
+         */
+        static bool UpdateInProgress();
 
         /**
          * Draws pixel (x; y);
@@ -75,6 +305,19 @@ namespace Zhele::Drivers
          */
         static void DrawPixel(uint16_t x, uint16_t y, Pixel state = Pixel::On);
 
+        /**
+         * Fills horizontal span (for Graphics)
+         * 
+         * @param [in] x Left column
+         * @param [in] y Line
+         * @param [in] length Span length (span should be inside screen)
+         * @param [in] state Pixel color (on or off)
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void FillSpan(int x, int y, int length, Pixel state);
+
         /**
          * Sets cursor to given position
          * 
@@ -122,16 +365,85 @@ namespace Zhele::Drivers
          * @par Returns
          *  Nothing
          */
-        void WriteCommand(uint8_t command);
+        static void WriteCommand(uint8_t command);
+
+        /**
+         * Mark columns of page as modified
+         * 
+         * @param [in] page Page
+         * @param [in] first First modified column
+         * @param [in] last Last modified column
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void MarkDirty(uint8_t page, uint8_t first, uint8_t last);
+
+        /**
+         * Copy modified regions of back buffer to front buffer (double buffer only)
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Latch();
+
+        /**
+         * Returns buffer to transmit
+         * 
+         * @returns Front buffer (or the only buffer)
+         */
+        static const uint8_t* FrontBuffer();
+
+        /**
+         * Send window address for next dirty region (or finish update)
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void SendNextRegion();
+
+        /**
+         * Send region data (called after window address has been sent)
+         * 
+         * @param [in] success Window address transfer status
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void SendRegionData(bool success);
+
+        /**
+         * Region data transfer complete handler
+         * 
+         * @param [in] success Region data transfer status
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void OnRegionSent(bool success);
 
     private:
         static uint8_t _buffer[Width * Height / 8];
+
+        static uint8_t _front[_DoubleBuffer ? Width * Height / 8 : 1];
+
+        // Dirty columns [begin; end) for each page (end == 0 - page is clean)
+        static uint8_t _dirtyBegin[Pages];
+        static uint8_t _dirtyEnd[Pages];
+
+        // Latched columns to send (double buffer only, dirty columns are sent otherwise)
+        static uint8_t _sendBegin[Pages];
+        static uint8_t _sendEnd[Pages];
+
+        // Region in progress: command bytes (column and page address)
+        static uint8_t _window[6];
+        static volatile bool _updating;
         static uint16_t _x;
         static uint16_t _y;
     };
 
-    template <typename I2CBus>
-    bool Ssd1306<I2CBus>::Init()
+    template <typename _Transport, bool _DoubleBuffer>
+    bool Ssd1306Base<_Transport, _DoubleBuffer>::Init()
     {
         const uint8_t initSequence[] = {
             Commands::Off,
@@ -157,7 +469,9 @@ namespace Zhele::Drivers
             Commands::On,
         };
 
-        I2CBus::Write(I2cAddress, 0x00, initSequence, sizeof(initSequence));
+        _Transport::Init();
+        if(!_Transport::WriteCommands(initSequence, sizeof(initSequence)))
+            return false;
 
         Fill(Pixel::Off);
         Update();
@@ -168,20 +482,42 @@ namespace Zhele::Drivers
         return true;
     }
 
-    template <typename I2CBus>
-    void Ssd1306<I2CBus>::Fill(Pixel state)
+    template <typename _Transport, bool _DoubleBuffer>
+    void Ssd1306Base<_Transport, _DoubleBuffer>::Fill(Pixel state)
     {
         memset(_buffer, state == Pixel::Off ? 0x00 : 0xff, sizeof(_buffer));
+        for(uint8_t page = 0; page < Pages; ++page)
+        {
+            MarkDirty(page, 0, Width - 1);
+        }
     }
 
-    template <typename I2CBus>
-    void Ssd1306<I2CBus>::Update()
+    template <typename _Transport, bool _DoubleBuffer>
+    bool Ssd1306Base<_Transport, _DoubleBuffer>::Update()
     {
-        I2CBus::WriteAsync(I2cAddress, 0x40, _buffer, Ssd1306<I2CBus>::Width * Ssd1306<I2CBus>::Height / 8);
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        bool updating = _updating;
+        _updating = true;
+        __set_PRIMASK(primask);
+
+        if(updating)
+            return !_DoubleBuffer;
+
+        if constexpr (_DoubleBuffer)
+            Latch();
+        SendNextRegion();
+        return true;
     }
 
-    template <typename I2CBus>
-    void Ssd1306<I2CBus>::DrawPixel(uint16_t x, uint16_t y, Pixel state)
+    template <typename _Transport, bool _DoubleBuffer>
+    bool Ssd1306Base<_Transport, _DoubleBuffer>::UpdateInProgress()
+    {
+        return _updating;
+    }
+
+    template <typename _Transport, bool _DoubleBuffer>
+    void Ssd1306Base<_Transport, _DoubleBuffer>::DrawPixel(uint16_t x, uint16_t y, Pixel state)
     {
         if(x >= Width || y >= Height)
             return;
@@ -193,30 +529,50 @@ namespace Zhele::Drivers
         {
             _buffer[(y / 8) * Width + x] &= ~(1 << (y % 8));
         }
+        MarkDirty(y / 8, x, x);
     }
 
-    template <typename I2CBus>
-    void Ssd1306<I2CBus>::Goto(uint16_t x, uint16_t y)
+    template <typename _Transport, bool _DoubleBuffer>
+    void Ssd1306Base<_Transport, _DoubleBuffer>::FillSpan(int x, int y, int length, Pixel state)
+    {
+        uint8_t* column = &_buffer[(y / 8) * Width + x];
+        const uint8_t mask = 1 << (y % 8);
+        if(state == Pixel::On)
+        {
+            for(int i = 0; i < length; ++i)
+                column[i] |= mask;
+        }
+        else
+        {
+            for(int i = 0; i < length; ++i)
+                column[i] &= ~mask;
+        }
+        MarkDirty(y / 8, x, x + length - 1);
+    }
+
+    template <typename _Transport, bool _DoubleBuffer>
+    void Ssd1306Base<_Transport, _DoubleBuffer>::Goto(uint16_t x, uint16_t y)
     {
         _x = x;
         _y = y;
     }
 
-    template <typename I2CBus>
+    template <typename _Transport, bool _DoubleBuffer>
     template <typename Font>
-    std::enable_if_t<Font::MonoSpace, bool> Ssd1306<I2CBus>::Putc(char symbol)
+    std::enable_if_t<Font::MonoSpace, bool> Ssd1306Base<_Transport, _DoubleBuffer>::Putc(char symbol)
     {            
         if (Width <= (_x + Font::Width) || Height <= (_y + Font::Height))
         {
             return false;
         }
         
+        const uint8_t* glyph = Font::Get(symbol);
         uint8_t page = 0;
         for(; page < Font::Height / 8; ++page)
         {
             for (uint8_t column = 0; column < Font::Width; ++column)
             {
-                _buffer[(_y / 8 + page) * Width + _x + column] = Font::Get(symbol)[page * Font::Width + column];
+                _buffer[(_y / 8 + page) * Width + _x + column] = glyph[page * Font::Width + column];
             }
         }
         const uint8_t extraBits = Font::Height % 8;
@@ -226,31 +582,37 @@ namespace Zhele::Drivers
             {
                 _buffer[(_y + Font::Height) / 8 * Width + _x + column] =
                     (_buffer[(_y + Font::Height) / 8 * Width + _x + column] & (0xff << extraBits))
-                    | (Font::Get(symbol)[page * Font::Width + column] & (0xff >> (8 - extraBits)));
+                    | (glyph[page * Font::Width + column] & (0xff >> (8 - extraBits)));
             }
         }
+
+        for(uint8_t dirtyPage = _y / 8; dirtyPage <= (_y + Font::Height) / 8 && dirtyPage < Pages; ++dirtyPage)
+        {
+            MarkDirty(dirtyPage, _x, _x + Font::Width - 1);
+        }
         
         _x += Font::Width + 1;
         
         return true;
     }
 
-    template <typename I2CBus>
+    template <typename _Transport, bool _DoubleBuffer>
     template <typename Font>
-    std::enable_if_t<!Font::MonoSpace, bool> Ssd1306<I2CBus>::Putc(char symbol)
+    std::enable_if_t<!Font::MonoSpace, bool> Ssd1306Base<_Transport, _DoubleBuffer>::Putc(char symbol)
     {            
-        volatile uint8_t width = Font::GetWidth(symbol);
+        uint8_t width = Font::GetWidth(symbol);
         if (Width <= (_x + width) || Height <= (_y + Font::Height))
         {
             return false;
         }
         
+        const uint8_t* glyph = Font::Get(symbol);
         uint8_t page = 0;
         for(; page < Font::Height / 8; ++page)
         {
             for (uint8_t column = 0; column < width; ++column)
             {
-                _buffer[(_y / 8 + page) * Width + _x + column] = Font::Get(symbol)[page * width + column];
+                _buffer[(_y / 8 + page) * Width + _x + column] = glyph[page * width + column];
             }
         }
         const uint8_t extraBits = Font::Height % 8;
@@ -260,18 +622,23 @@ namespace Zhele::Drivers
             {
                 _buffer[(_y + Font::Height) / 8 * Width + _x + column] =
                     (_buffer[(_y + Font::Height) / 8 * Width + _x + column] & (0xff << extraBits))
-                    | (Font::Get(symbol)[page * width + column] >> (8 - extraBits));
+                    | (glyph[page * width + column] >> (8 - extraBits));
             }
         }
+
+        for(uint8_t dirtyPage = _y / 8; dirtyPage <= (_y + Font::Height) / 8 && dirtyPage < Pages; ++dirtyPage)
+        {
+            MarkDirty(dirtyPage, _x, _x + width - 1);
+        }
         
         _x += width + 1;
         
         return true;
     }
 
-    template <typename I2CBus>
+    template <typename _Transport, bool _DoubleBuffer>
     template <typename Font>
-    bool Ssd1306<I2CBus>::Puts(const char* str)
+    bool Ssd1306Base<_Transport, _DoubleBuffer>::Puts(const char* str)
     {
         while (*str)
         {
@@ -284,18 +651,197 @@ namespace Zhele::Drivers
         return true;
     }
 
-    template <typename I2CBus>
-    void Ssd1306<I2CBus>::WriteCommand(uint8_t command)
+    template <typename _Transport, bool _DoubleBuffer>
+    void Ssd1306Base<_Transport, _DoubleBuffer>::WriteCommand(uint8_t command)
+    {
+        _Transport::WriteCommands(&command, 1);
+    }
+
+    template <typename _Transport, bool _DoubleBuffer>
+    void Ssd1306Base<_Transport, _DoubleBuffer>::MarkDirty(uint8_t page, uint8_t first, uint8_t last)
+    {
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        if(_dirtyEnd[page] == 0)
+        {
+            _dirtyBegin[page] = first;
+            _dirtyEnd[page] = last + 1;
+        }
+        else
+        {
+            if(first < _dirtyBegin[page])
+                _dirtyBegin[page] = first;
+            if(last + 1 > _dirtyEnd[page])
+                _dirtyEnd[page] = last + 1;
+        }
+        __set_PRIMASK(primask);
+    }
+
+    template <typename _Transport, bool _DoubleBuffer>
+    void Ssd1306Base<_Transport, _DoubleBuffer>::Latch()
+    {
+        // Bus is idle, dirty regions are modified by drawing methods only
+        for(uint8_t page = 0; page < Pages; ++page)
+        {
+            _sendBegin[page] = _dirtyBegin[page];
+            _sendEnd[page] = _dirtyEnd[page];
+            if(_dirtyEnd[page] != 0)
+            {
+                uint16_t offset = page * Width + _dirtyBegin[page];
+                memcpy(&_front[offset], &_buffer[offset], _dirtyEnd[page] - _dirtyBegin[page]);
+            }
+            _dirtyBegin[page] = 0;
+            _dirtyEnd[page] = 0;
+        }
+    }
+
+    template <typename _Transport, bool _DoubleBuffer>
+    const uint8_t* Ssd1306Base<_Transport, _DoubleBuffer>::FrontBuffer()
+    {
+        if constexpr (_DoubleBuffer)
+            return _front;
+        else
+            return _buffer;
+    }
+
+    template <typename _Transport, bool _DoubleBuffer>
+    void Ssd1306Base<_Transport, _DoubleBuffer>::SendNextRegion()
     {
-        I2CBus::WriteU8(I2cAddress, 0x00, command);
+        uint8_t* begin = _DoubleBuffer ? _sendBegin : _dirtyBegin;
+        uint8_t* end = _DoubleBuffer ? _sendEnd : _dirtyEnd;
+
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+
+        uint8_t page = 0;
+        while(page < Pages && end[page] == 0)
+            ++page;
+
+        if(page == Pages)
+        {
+            _updating = false;
+            __set_PRIMASK(primask);
+            return;
+        }
+
+        uint8_t first = begin[page];
+        uint8_t last = end[page] - 1;
+        uint8_t lastPage = page;
+
+        // Fully modified consecutive pages are contiguous in buffer
+        while(first == 0 && last == Width - 1 && lastPage + 1 < Pages
+            && begin[lastPage + 1] == 0 && end[lastPage + 1] == Width)
+        {
+            ++lastPage;
+        }
+
+        for(uint8_t i = page; i <= lastPage; ++i)
+        {
+            begin[i] = 0;
+            end[i] = 0;
+        }
+        __set_PRIMASK(primask);
+
+        _window[0] = Commands::SetColumnAddress;
+        _window[1] = first;
+        _window[2] = last;
+        _window[3] = Commands::SetPageAddress;
+        _window[4] = page;
+        _window[5] = lastPage;
+
+        if(!_Transport::WriteCommandsAsync(_window, sizeof(_window), SendRegionData))
+        {
+            SendRegionData(false);
+        }
+    }
+
+    template <typename _Transport, bool _DoubleBuffer>
+    void Ssd1306Base<_Transport, _DoubleBuffer>::SendRegionData(bool success)
+    {
+        if(!success)
+        {
+            OnRegionSent(false);
+            return;
+        }
+
+        const uint8_t* data = &FrontBuffer()[_window[4] * Width + _window[1]];
+        uint16_t size = (_window[5] - _window[4] + 1) * (_window[2] - _window[1] + 1);
+
+        if(!_Transport::WriteDataAsync(data, size, OnRegionSent))
+        {
+            OnRegionSent(false);
+        }
+    }
+
+    template <typename _Transport, bool _DoubleBuffer>
+    void Ssd1306Base<_Transport, _DoubleBuffer>::OnRegionSent(bool success)
+    {
+        if(!success)
+        {
+            // Region will be sent by next update
+            for(uint8_t page = _window[4]; page <= _window[5]; ++page)
+            {
+                MarkDirty(page, _window[1], _window[2]);
+            }
+            if constexpr (_DoubleBuffer)
+            {
+                // Back buffer contains the same or newer data of not sent regions
+                for(uint8_t page = 0; page < Pages; ++page)
+                {
+                    if(_sendEnd[page] != 0)
+                        MarkDirty(page, _sendBegin[page], _sendEnd[page] - 1);
+                    _sendBegin[page] = 0;
+                    _sendEnd[page] = 0;
+                }
+            }
+            _updating = false;
+            return;
+        }
+
+        SendNextRegion();
     }
 
-    template <typename I2CBus>
-    uint8_t Ssd1306<I2CBus>::_buffer[Ssd1306<I2CBus>::Width * Ssd1306<I2CBus>::Height / 8];
-    template <typename I2CBus>
-    uint16_t Ssd1306<I2CBus>::_x = 0;
-    template <typename I2CBus>
-    uint16_t Ssd1306<I2CBus>::_y = 0;
+    template <typename _Transport, bool _DoubleBuffer>
+    uint8_t Ssd1306Base<_Transport, _DoubleBuffer>::_buffer[Ssd1306Base<_Transport, _DoubleBuffer>::Width * Ssd1306Base<_Transport, _DoubleBuffer>::Height / 8];
+    template <typename _Transport, bool _DoubleBuffer>
+    uint8_t Ssd1306Base<_Transport, _DoubleBuffer>::_front[_DoubleBuffer ? Ssd1306Base<_Transport, _DoubleBuffer>::Width * Ssd1306Base<_Transport, _DoubleBuffer>::Height / 8 : 1];
+    template <typename _Transport, bool _DoubleBuffer>
+    uint8_t Ssd1306Base<_Transport, _DoubleBuffer>::_dirtyBegin[Ssd1306Base<_Transport, _DoubleBuffer>::Pages];
+    template <typename _Transport, bool _DoubleBuffer>
+    uint8_t Ssd1306Base<_Transport, _DoubleBuffer>::_dirtyEnd[Ssd1306Base<_Transport, _DoubleBuffer>::Pages];
+    template <typename _Transport, bool _DoubleBuffer>
+    uint8_t Ssd1306Base<_Transport, _DoubleBuffer>::_sendBegin[Ssd1306Base<_Transport, _DoubleBuffer>::Pages];
+    template <typename _Transport, bool _DoubleBuffer>
+    uint8_t Ssd1306Base<_Transport, _DoubleBuffer>::_sendEnd[Ssd1306Base<_Transport, _DoubleBuffer>::Pages];
+    template <typename _Transport, bool _DoubleBuffer>
+    uint8_t Ssd1306Base<_Transport, _DoubleBuffer>::_window[6];
+    template <typename _Transport, bool _DoubleBuffer>
+    volatile bool Ssd1306Base<_Transport, _DoubleBuffer>::_updating = false;
+    template <typename _Transport, bool _DoubleBuffer>
+    uint16_t Ssd1306Base<_Transport, _DoubleBuffer>::_x = 0;
+    template <typename _Transport, bool _DoubleBuffer>
+    uint16_t Ssd1306Base<_Transport, _DoubleBuffer>::_y = 0;
+
+    /**
+     * @brief Ssd1306 display on I2C bus
+     * 
+     * @tparam _I2c I2C bus
+     * @tparam _DoubleBuffer Use second (front) framebuffer for transmission
+     */
+    template <typename _I2c, bool _DoubleBuffer = false>
+    using Ssd1306 = Ssd1306Base<Ssd1306I2cTransport<_I2c>, _DoubleBuffer>;
+
+    /**
+     * @brief Ssd1306 display on 4-wire SPI bus
+     * 
+     * @tparam _Spi SPI bus
+     * @tparam _SsPin Chip select pin
+     * @tparam _DcPin Data/Command pin
+     * @tparam _ResetPin Reset pin (NullPin if not connected)
+     * @tparam _DoubleBuffer Use second (front) framebuffer for transmission
+     */
+    template <typename _Spi, typename _SsPin, typename _DcPin, typename _ResetPin = IO::NullPin, bool _DoubleBuffer = false>
+    using Ssd1306Spi = Ssd1306Base<Ssd1306SpiTransport<_Spi, _SsPin, _DcPin, _ResetPin>, _DoubleBuffer>;
 }
 
 #endif //! ZHELE_DRIVERS_SSD1306_H
\ No newline at end of file
@@ -10,6 +10,7 @@
 #define ZHELE_DRIVERS_ST7735_H
 
 #include <delay.h>
+#include "fonts.h"
 
 #include <cstdint>
 #include <initializer_list>
@@ -25,8 +26,9 @@ namespace Zhele::Drivers
      * @tparam _ResetPin Reset pin
      * @tparam _Width Width
      * @tparam _Height Height
+     * @tparam _StripHeight Strip height (lines) for strip renderer
      */
-    template <typename _SpiBus, typename _SsPin, typename _DcPin, typename _ResetPin, uint8_t _Width = 128, uint8_t _Height = 160>
+    template <typename _SpiBus, typename _SsPin, typename _DcPin, typename _ResetPin, uint8_t _Width = 128, uint8_t _Height = 160, uint8_t _StripHeight = 8>
     class St7735
     {
         enum MadCtl : uint8_t
@@ -64,6 +66,8 @@ namespace Zhele::Drivers
             RamRd = 0x2e,
 
             PrlAr = 0x30,
+            VScrDef = 0x33, ///< Vertical scrolling definition
+            VScrSAdd = 0x37, ///< Vertical scrolling start address
             ColMod = 0x3a,
             MadCtl = 0x36,
 
@@ -96,8 +100,28 @@ namespace Zhele::Drivers
                 ? MadCtl::Mx | MadCtl::My
                 : MadCtl::My | MadCtl::Mv);
 
+        static const uint16_t MaxDmaTransfer = 0xffff;
+        /// Max pixels count of area that is filled without DMA
+        static const unsigned SmallArea = 16;
+        /// Pixels per chunk of streamed image
+        static const unsigned StreamChunkPixels = 64;
+        /// Frame memory lines (scrolling area definition covers all of them)
+        static const uint8_t MemoryLines = 162;
+
         static bool _busy;
+        static volatile bool _dmaTransfer;
+        static uint8_t _scrollTop;
+        static uint8_t _scrollHeight;
+        static uint16_t _fillColor;
+        static uint32_t _fillRemaining;
+        static uint16_t _strips[2][_Width * _StripHeight];
+        static uint16_t _streamChunks[2][StreamChunkPixels];
     public:
+        /// Screen width
+        static const uint8_t Width = _Width;
+        /// Screen height
+        static const uint8_t Height = _Height;
+
         /// Color
         enum Color : uint16_t
         {
@@ -111,6 +135,197 @@ namespace Zhele::Drivers
             White = 0xffff
         };
 
+        /// Color type (for Graphics)
+        using ColorType = uint16_t;
+
+        /**
+         * @brief Screen strip (part of screen in RAM) for strip renderer
+         * 
+         * @details
+         * All coordinates are screen coordinates, drawing is clipped by strip.
+         */
+        class Strip
+        {
+        public:
+            /**
+             * @brief Constructs strip
+             * 
+             * @param [in] buffer Strip buffer
+             * @param [in] x Strip left column
+             * @param [in] y Strip top line
+             * @param [in] width Strip width
+             * @param [in] height Strip height
+             */
+            Strip(uint16_t* buffer, uint8_t x, uint8_t y, uint8_t width, uint8_t height)
+                : _buffer(buffer), _x(x), _y(y), _width(width), _height(height)
+            {}
+
+            /**
+             * @brief Returns strip top line
+             * 
+             * @returns Top line
+             */
+            uint8_t Top() const { return _y; }
+
+            /**
+             * @brief Returns strip height
+             * 
+             * @returns Height
+             */
+            uint8_t Height() const { return _height; }
+
+            /**
+             * @brief Returns strip pixels (RGB565, width * height)
+             *
+             * @details
+             * Scene can fill strip directly, for example by image read from external flash.
+             *
+             * @returns Strip buffer
+             */
+            uint16_t* Data() { return _buffer; }
+
+            /**
+             * @brief Fill strip with given color
+             * 
+             * @param [in] color Color
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            void Fill(uint16_t color)
+            {
+                for(unsigned i = 0; i < static_cast<unsigned>(_width) * _height; ++i)
+                    _buffer[i] = color;
+            }
+
+            /**
+             * @brief Draw pixel
+             * 
+             * @param [in] x X coordinate
+             * @param [in] y Y coordinate
+             * @param [in] color Pixel color
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            void DrawPixel(int x, int y, uint16_t color)
+            {
+                if(x < _x || x >= _x + _width || y < _y || y >= _y + _height)
+                    return;
+                _buffer[(y - _y) * _width + (x - _x)] = color;
+            }
+
+            /**
+             * @brief Fill rectangle
+             * 
+             * @param [in] x X coordinate
+             * @param [in] y Y coordinate
+             * @param [in] width Width
+             * @param [in] height Height
+             * @param [in] color Color
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            void FillRectangle(int x, int y, int width, int height, uint16_t color)
+            {
+                int x0 = x > _x ? x : _x;
+                int x1 = x + width < _x + _width ? x + width : _x + _width;
+                int y0 = y > _y ? y : _y;
+                int y1 = y + height < _y + _height ? y + height : _y + _height;
+
+                for(int line = y0; line < y1; ++line)
+                {
+                    uint16_t* row = &_buffer[(line - _y) * _width];
+                    for(int column = x0; column < x1; ++column)
+                        row[column - _x] = color;
+                }
+            }
+
+            /**
+             * @brief Write char
+             * 
+             * @tparam Font Font
+             * 
+             * @param [in] x X coordinate
+             * @param [in] y Y coordinate
+             * @param [in] symbol Symbol
+             * @param [in] color Symbol color
+             * @param [in] background Background color
+             * 
+             * @returns Symbol width
+             */
+            template<typename Font>
+            uint8_t WriteChar(int x, int y, char symbol, uint16_t color, uint16_t background)
+            {
+                uint8_t width;
+                if constexpr (Font::MonoSpace)
+                    width = Font::Width;
+                else
+                    width = Font::GetWidth(symbol);
+
+                int y0 = y > _y ? y : _y;
+                int y1 = y + Font::Height < _y + _height ? y + Font::Height : _y + _height;
+                if(y0 >= y1)
+                    return width;
+
+                const uint8_t extraBits = Font::Height % 8;
+                const uint8_t* glyph = Font::Get(symbol);
+
+                for(uint8_t column = 0; column < width; ++column)
+                {
+                    int screenX = x + column;
+                    if(screenX < _x || screenX >= _x + _width)
+                        continue;
+
+                    for(int line = y0; line < y1; ++line)
+                    {
+                        uint8_t row = line - y;
+                        uint8_t page = row / 8;
+                        uint8_t temp = glyph[page * width + column];
+                        if(extraBits > 0 && page == Font::Height / 8)
+                            temp >>= (8 - extraBits);
+
+                        _buffer[(line - _y) * _width + (screenX - _x)] = (temp >> (row % 8)) & 0x01 ? color : background;
+                    }
+                }
+
+                return width;
+            }
+
+            /**
+             * @brief Write string
+             * 
+             * @tparam Font Font
+             * 
+             * @param [in] x X coordinate
+             * @param [in] y Y coordinate
+             * @param [in] str String
+             * @param [in] color Symbol color
+             * @param [in] background Background color
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            template<typename Font>
+            void WriteString(int x, int y, const char* str, uint16_t color, uint16_t background)
+            {
+                // Skip strings that are out of strip
+                if(y >= _y + _height || y + Font::Height <= _y)
+                    return;
+
+                while(*str)
+                    x += WriteChar<Font>(x, y, *str++, color, background);
+            }
+
+        private:
+            uint16_t* _buffer;
+            uint8_t _x;
+            uint8_t _y;
+            uint8_t _width;
+            uint8_t _height;
+        };
+
         /**
          * @brief Init display
          * 
@@ -252,6 +467,10 @@ namespace Zhele::Drivers
         /**
          * @brief Fill rectangle
          * 
+         * @details
+         * Color word is sent by DMA without memory increment (16-bit SPI frames),
+         * large areas are sent by chunks (DMA transfer size limit). Operation is async.
+         * 
          * @param x X coordinate
          * @param y Y coordinate
          * @param width Width
@@ -272,13 +491,65 @@ namespace Zhele::Drivers
             _SpiBus::SetDataSize(_SpiBus::DataSize::DataSize16);
 
             _DcPin::Set();
-            
-            _SpiBus::WriteAsyncNoIncrement(&color, height * width, [](void* data, unsigned size, bool success){
-                while(_SpiBus::Busy()) continue;
-                _SsPin::Set();
-                _SpiBus::SetDataSize(_SpiBus::DataSize::DataSize8);
-                _busy = false;
-            });
+
+            // DMA reads color after method returns, so it should not be placed on stack
+            _fillColor = color;
+            _fillRemaining = static_cast<uint32_t>(width) * height;
+            FillNextChunk();
+        }
+
+        /**
+         * @brief Fill rectangle and wait for completion (for Graphics)
+         * 
+         * @details
+         * Small areas are written without DMA (DMA setup takes longer than few pixels transfer).
+         * 
+         * @param [in] x X coordinate
+         * @param [in] y Y coordinate
+         * @param [in] width Width
+         * @param [in] height Height
+         * @param [in] color Color
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void FillArea(int x, int y, int width, int height, uint16_t color)
+        {
+            while(_busy) continue;
+
+            unsigned count = static_cast<unsigned>(width) * height;
+            if(count > SmallArea)
+            {
+                FillRectangle(x, y, width, height, color);
+                while(_busy) continue;
+                return;
+            }
+
+            _SsPin::Clear();
+            SetAddressWindow(x, y, x + width - 1, y + height - 1);
+            _SpiBus::SetDataSize(_SpiBus::DataSize::DataSize16);
+            _DcPin::Set();
+            for(unsigned i = 0; i < count; ++i)
+                _SpiBus::Write(color);
+            while(_SpiBus::Busy()) continue;
+            _SpiBus::SetDataSize(_SpiBus::DataSize::DataSize8);
+            _SsPin::Set();
+        }
+
+        /**
+         * @brief Fill horizontal span (for Graphics)
+         * 
+         * @param [in] x X coordinate
+         * @param [in] y Y coordinate
+         * @param [in] length Length
+         * @param [in] color Color
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void FillSpan(int x, int y, int length, uint16_t color)
+        {
+            FillArea(x, y, length, 1, color);
         }
 
         /**
@@ -317,9 +588,74 @@ namespace Zhele::Drivers
             WriteDataAsync(data, sizeof(uint16_t) * width * height);
         }
 
+        /**
+         * @brief Draw image produced by streaming decoder (BmpDecoder, RleDecoder or any class with Decode method)
+         * 
+         * @details
+         * Pixels are decoded by small chunks into two buffers: next chunk is decoded (and read from source)
+         * while previous one is being sent by DMA, so image of any size is drawn at source read speed
+         * with 256 bytes of pixels buffers. Source should not use display SPI bus.
+         * Method returns after last chunk has been sent.
+         * 
+         * @tparam Decoder Decoder type (unsigned Decode(uint16_t* pixels, unsigned count) method)
+         * 
+         * @param [in] x X coordinate
+         * @param [in] y Y coordinate
+         * @param [in] width Image width
+         * @param [in] height Image height
+         * @param [in] decoder Opened decoder
+         * 
+         * @retval true Image is drawn
+         * @retval false Decoder stopped before the end of image (read error)
+         */
+        template<typename Decoder>
+        static bool DrawStream(uint8_t x, uint8_t y, uint8_t width, uint8_t height, Decoder& decoder)
+        {
+            _busy = true;
+
+            _SsPin::Clear();
+
+            SetAddressWindow(x, y, x + width - 1, y + height - 1);
+
+            _SpiBus::SetDataSize(_SpiBus::DataSize::DataSize16);
+            _DcPin::Set();
+
+            uint32_t remaining = static_cast<uint32_t>(width) * height;
+            uint8_t index = 0;
+            while(remaining > 0)
+            {
+                unsigned count = remaining < StreamChunkPixels ? remaining : StreamChunkPixels;
+                unsigned decoded = decoder.Decode(_streamChunks[index], count);
+                if(decoded == 0)
+                    break;
+
+                while(_dmaTransfer) continue;
+
+                _dmaTransfer = true;
+                _SpiBus::WriteAsync(_streamChunks[index], decoded, [](void*, unsigned, bool){
+                    _dmaTransfer = false;
+                });
+                remaining -= decoded;
+                index ^= 1;
+            }
+
+            while(_dmaTransfer) continue;
+            while(_SpiBus::Busy()) continue;
+
+            _SpiBus::SetDataSize(_SpiBus::DataSize::DataSize8);
+            _SsPin::Set();
+
+            _busy = false;
+            return remaining == 0;
+        }
+
         /**
          * @brief Write char to display
          * 
+         * @details
+         * Glyph is expanded to RGB565 via glyph cache (recently drawn glyphs with the same colors
+         * are not expanded again) and sent by DMA.
+         * 
          * @tparam Font Font
          * 
          * @param x X coordinate
@@ -342,39 +678,19 @@ namespace Zhele::Drivers
             WriteData(Rotation ^ MadCtl::Mv);
 
             uint8_t width;
-            if constexpr (Font::MonoSpace)
-                width = Font::Width;
-            else
-                width = Font::GetWidth(symbol);
+            const uint16_t* pixels = GlyphCache<Font>::Get(symbol, color, background, width);
 
             SetAddressWindow(y, x, y + Font::Height - 1, x + width - 1);
 
             _SpiBus::SetDataSize(_SpiBus::DataSize::DataSize16);
             _DcPin::Set();
 
-            const uint8_t extraBits = Font::Height % 8;
-
-            for (uint8_t column = 0; column < width; ++column) {
-
-                uint8_t page = 0;
-                for(page = 0; page < Font::Height / 8; ++page) {
-                    uint8_t temp = Font::Get(symbol)[page * width + column];
-
-                    for(uint8_t i = 0; i < 8; ++i) {
-                        _SpiBus::Write((temp & 0x01) > 0 ? color : background);
-                        temp >>= 1;
-                    }
-                }
-
-                if constexpr (extraBits > 0) {
-                    uint8_t temp = Font::Get(symbol)[page * width + column] >> (8 - extraBits);
-
-                    for(uint8_t i = 0; i < extraBits; ++i) {
-                        _SpiBus::Write((temp & 0x01) > 0 ? color : background);
-                        temp >>= 1;
-                    }
-                }
-            }
+            _dmaTransfer = true;
+            _SpiBus::WriteAsync(pixels, width * Font::Height, [](void*, unsigned, bool){
+                _dmaTransfer = false;
+            });
+            while(_dmaTransfer) continue;
+            while(_SpiBus::Busy()) continue;
 
             _SpiBus::SetDataSize(_SpiBus::DataSize::DataSize8);
 
@@ -430,6 +746,136 @@ namespace Zhele::Drivers
             }
         }
 
+        /**
+         * @brief Render screen region by strips
+         * 
+         * @details
+         * Region is drawn by strips of _StripHeight lines: scene is called for each strip
+         * and draws primitives into it (scene should draw whole screen, drawing is clipped by strip),
+         * then strip is sent by DMA with 16-bit SPI frames. Two strip buffers are used,
+         * so next strip is rendered while previous one is being transferred.
+         * Method returns after last strip has been sent.
+         * 
+         * @tparam Scene Scene type (callable with Strip& argument)
+         * 
+         * @param [in] x X coordinate
+         * @param [in] y Y coordinate
+         * @param [in] width Region width
+         * @param [in] height Region height
+         * @param [in] scene Scene
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        template<typename Scene>
+        static void Render(uint8_t x, uint8_t y, uint8_t width, uint8_t height, Scene scene)
+        {
+            _busy = true;
+
+            _SsPin::Clear();
+
+            SetAddressWindow(x, y, x + width - 1, y + height - 1);
+
+            _SpiBus::SetDataSize(_SpiBus::DataSize::DataSize16);
+            _DcPin::Set();
+
+            const unsigned bottom = y + height;
+            uint8_t index = 0;
+            for(unsigned top = y; top < bottom; top += _StripHeight, index ^= 1)
+            {
+                uint8_t lines = bottom - top < _StripHeight ? bottom - top : _StripHeight;
+
+                Strip strip(_strips[index], x, top, width, lines);
+                scene(strip);
+
+                while(_dmaTransfer) continue;
+
+                _dmaTransfer = true;
+                _SpiBus::WriteAsync(_strips[index], width * lines, [](void*, unsigned, bool){
+                    _dmaTransfer = false;
+                });
+            }
+
+            while(_dmaTransfer) continue;
+            while(_SpiBus::Busy()) continue;
+
+            _SpiBus::SetDataSize(_SpiBus::DataSize::DataSize8);
+            _SsPin::Set();
+
+            _busy = false;
+        }
+
+        /**
+         * @brief Render whole screen by strips
+         * 
+         * @tparam Scene Scene type (callable with Strip& argument)
+         * 
+         * @param [in] scene Scene
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        template<typename Scene>
+        static void Render(Scene scene)
+        {
+            Render(0, 0, _Width, _Height, scene);
+        }
+
+        /**
+         * @brief Defines hardware scrolling area
+         * 
+         * @details
+         * Lines out of area are fixed. Hardware scrolling moves frame memory lines,
+         * so it is vertical for portrait orientation (width < height) only.
+         * Drawing methods use unscrolled coordinates.
+         * 
+         * @param [in] top First line of area
+         * @param [in] height Area height
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void SetScrollArea(uint8_t top, uint8_t height)
+        {
+            _scrollTop = top;
+            _scrollHeight = height;
+
+            // Frame memory is written bottom to top if row order is reversed
+            uint8_t fixedTop = (Rotation & MadCtl::My) != 0 ? MemoryLines - top - height : top;
+            uint8_t fixedBottom = MemoryLines - fixedTop - height;
+
+            _SsPin::Clear();
+            WriteCommand(Command::VScrDef);
+            WriteData({0x00, fixedTop, 0x00, height, 0x00, fixedBottom});
+            _SsPin::Set();
+
+            Scroll(0);
+        }
+
+        /**
+         * @brief Scrolls area (see SetScrollArea)
+         * 
+         * @details
+         * Line (top + offset) of area is shown at the top of area, area is wrapped,
+         * so offset 1 moves image one line up.
+         * 
+         * @param [in] offset Offset (lines, 0...area height - 1)
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Scroll(uint8_t offset)
+        {
+            uint8_t start = (Rotation & MadCtl::My) != 0
+                ? MemoryLines - _scrollTop - _scrollHeight + (_scrollHeight - offset % _scrollHeight) % _scrollHeight
+                : _scrollTop + offset % _scrollHeight;
+
+            _SsPin::Clear();
+            WriteCommand(Command::VScrSAdd);
+            WriteData({0x00, start});
+            _SsPin::Set();
+        }
+
         /**
          * @brief Reset controller
          * 
@@ -460,6 +906,31 @@ namespace Zhele::Drivers
         }
 
     private:
+        /**
+         * @brief Send next fill chunk (or finish fill)
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void FillNextChunk()
+        {
+            if(_fillRemaining == 0)
+            {
+                while(_SpiBus::Busy()) continue;
+                _SsPin::Set();
+                _SpiBus::SetDataSize(_SpiBus::DataSize::DataSize8);
+                _busy = false;
+                return;
+            }
+
+            uint16_t chunk = _fillRemaining > MaxDmaTransfer ? MaxDmaTransfer : _fillRemaining;
+            _fillRemaining -= chunk;
+
+            _SpiBus::WriteAsyncNoIncrement(&_fillColor, chunk, [](void*, unsigned, bool){
+                FillNextChunk();
+            });
+        }
+
         /**
          * @brief Write command to display
          * 
@@ -520,8 +991,205 @@ namespace Zhele::Drivers
         }
     };
 
-    template <typename _SpiBus, typename _SsPin, typename _DcPin, typename _ResetPin, uint8_t _Width, uint8_t _Height>
-    bool St7735<_SpiBus, _SsPin, _DcPin, _ResetPin, _Width, _Height>::_busy = false;
+    template <typename _SpiBus, typename _SsPin, typename _DcPin, typename _ResetPin, uint8_t _Width, uint8_t _Height, uint8_t _StripHeight>
+    bool St7735<_SpiBus, _SsPin, _DcPin, _ResetPin, _Width, _Height, _StripHeight>::_busy = false;
+
+    template <typename _SpiBus, typename _SsPin, typename _DcPin, typename _ResetPin, uint8_t _Width, uint8_t _Height, uint8_t _StripHeight>
+    uint16_t St7735<_SpiBus, _SsPin, _DcPin, _ResetPin, _Width, _Height, _StripHeight>::_fillColor = 0;
+
+    template <typename _SpiBus, typename _SsPin, typename _DcPin, typename _ResetPin, uint8_t _Width, uint8_t _Height, uint8_t _StripHeight>
+    uint32_t St7735<_SpiBus, _SsPin, _DcPin, _ResetPin, _Width, _Height, _StripHeight>::_fillRemaining = 0;
+
+    template <typename _SpiBus, typename _SsPin, typename _DcPin, typename _ResetPin, uint8_t _Width, uint8_t _Height, uint8_t _StripHeight>
+    volatile bool St7735<_SpiBus, _SsPin, _DcPin, _ResetPin, _Width, _Height, _StripHeight>::_dmaTransfer = false;
+
+    template <typename _SpiBus, typename _SsPin, typename _DcPin, typename _ResetPin, uint8_t _Width, uint8_t _Height, uint8_t _StripHeight>
+    uint16_t St7735<_SpiBus, _SsPin, _DcPin, _ResetPin, _Width, _Height, _StripHeight>::_strips[2][_Width * _StripHeight];
+
+    template <typename _SpiBus, typename _SsPin, typename _DcPin, typename _ResetPin, uint8_t _Width, uint8_t _Height, uint8_t _StripHeight>
+    uint16_t St7735<_SpiBus, _SsPin, _DcPin, _ResetPin, _Width, _Height, _StripHeight>::_streamChunks[2][StreamChunkPixels];
+
+    template <typename _SpiBus, typename _SsPin, typename _DcPin, typename _ResetPin, uint8_t _Width, uint8_t _Height, uint8_t _StripHeight>
+    uint8_t St7735<_SpiBus, _SsPin, _DcPin, _ResetPin, _Width, _Height, _StripHeight>::_scrollTop = 0;
+
+    template <typename _SpiBus, typename _SsPin, typename _DcPin, typename _ResetPin, uint8_t _Width, uint8_t _Height, uint8_t _StripHeight>
+    uint8_t St7735<_SpiBus, _SsPin, _DcPin, _ResetPin, _Width, _Height, _StripHeight>::_scrollHeight = _Height;
+
+    /**
+     * @brief Implements text console (log/terminal view) with hardware scrolling
+     * 
+     * @details
+     * Console occupies text lines of area (other lines of screen are fixed). When cursor
+     * goes below the last line, only the line that appears is cleared and the area is scrolled
+     * by hardware, so output costs one character (or one cleared line) of SPI traffic
+     * instead of full area redraw. Display should be in portrait orientation.
+     * 
+     * @tparam _Display St7735 display
+     * @tparam _Font Font
+     */
+    template <typename _Display, typename _Font>
+    class St7735Console
+    {
+        static_assert(_Display::Width < _Display::Height, "Hardware scrolling is vertical in portrait orientation only");
+    public:
+        /**
+         * @brief Init console (defines scroll area and clears it)
+         * 
+         * @param [in] top Area top line
+         * @param [in] lines Text lines count (0 - up to screen bottom)
+         * @param [in] color Text color
+         * @param [in] background Background color
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Init(uint8_t top = 0, uint8_t lines = 0, uint16_t color = _Display::White, uint16_t background = _Display::Black)
+        {
+            _top = top;
+            _lines = lines != 0 ? lines : (_Display::Height - top) / _Font::Height;
+            SetColors(color, background);
+
+            _Display::SetScrollArea(_top, _lines * _Font::Height);
+            Clear();
+        }
+
+        /**
+         * @brief Set colors for next output
+         * 
+         * @param [in] color Text color
+         * @param [in] background Background color
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void SetColors(uint16_t color, uint16_t background)
+        {
+            _color = color;
+            _background = background;
+        }
+
+        /**
+         * @brief Clear console and move cursor to the first line
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Clear()
+        {
+            _first = 0;
+            _line = 0;
+            _column = 0;
+            _Display::Scroll(0);
+            _Display::FillRectangle(0, _top, _Display::Width, _lines * _Font::Height, _background);
+            while(_Display::Busy()) continue;
+        }
+
+        /**
+         * @brief Write char (new line and carriage return chars are supported)
+         * 
+         * @param [in] symbol Char
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Write(char symbol)
+        {
+            if(symbol == '\n')
+            {
+                NewLine();
+                return;
+            }
+            if(symbol == '\r')
+            {
+                _column = 0;
+                return;
+            }
+
+            uint8_t width;
+            if constexpr (_Font::MonoSpace)
+                width = _Font::Width;
+            else
+                width = _Font::GetWidth(symbol);
+
+            if(_column + width > _Display::Width)
+                NewLine();
+
+            _Display::template WriteChar<_Font>(_column, LineTop(_line), symbol, _color, _background);
+            _column += width;
+        }
+
+        /**
+         * @brief Write string
+         * 
+         * @param [in] str String
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void Write(const char* str)
+        {
+            while(*str)
+                Write(*str++);
+        }
+
+        /**
+         * @brief Move cursor to next line (scroll if cursor is on the last line)
+         * 
+         * @par Returns
+         *  Nothing
+         */
+        static void NewLine()
+        {
+            _column = 0;
+            if(_line + 1 < _lines)
+            {
+                ++_line;
+                return;
+            }
+
+            // Top line goes out and appears at the bottom as a new line
+            _Display::FillRectangle(0, LineTop(0), _Display::Width, _Font::Height, _background);
+            while(_Display::Busy()) continue;
+            _first = (_first + 1) % _lines;
+            _Display::Scroll(_first * _Font::Height);
+        }
+
+    private:
+        // Screen line (unscrolled) of text line
+        static uint8_t LineTop(uint8_t line)
+        {
+            return _top + (_first + line) % _lines * _Font::Height;
+        }
+
+        static uint8_t _top;
+        static uint8_t _lines;
+        static uint8_t _first;
+        static uint8_t _line;
+        static uint8_t _column;
+        static uint16_t _color;
+        static uint16_t _background;
+    };
+
+    template <typename _Display, typename _Font>
+    uint8_t St7735Console<_Display, _Font>::_top = 0;
+
+    template <typename _Display, typename _Font>
+    uint8_t St7735Console<_Display, _Font>::_lines = 1;
+
+    template <typename _Display, typename _Font>
+    uint8_t St7735Console<_Display, _Font>::_first = 0;
+
+    template <typename _Display, typename _Font>
+    uint8_t St7735Console<_Display, _Font>::_line = 0;
+
+    template <typename _Display, typename _Font>
+    uint8_t St7735Console<_Display, _Font>::_column = 0;
+
+    template <typename _Display, typename _Font>
+    uint16_t St7735Console<_Display, _Font>::_color = 0xffff;
+
+    template <typename _Display, typename _Font>
+    uint16_t St7735Console<_Display, _Font>::_background = 0;
 }
 
 #endif //! ZHELE_DRIVERS_ST7735_H
\ No newline at end of file
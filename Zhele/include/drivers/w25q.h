@@ -0,0 +1,342 @@
+/**
+ * @file
+ * Driver for W25Qxx SPI NOR flash
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DRIVERS_W25Q_H
+#define ZHELE_DRIVERS_W25Q_H
+
+#include <delay.h>
+#include <common/template_utils/data_transfer.h>
+
+#include "filesystem/block_device.h"
+
+#include <cstdint>
+#include <cstddef>
+
+#if !defined (ZHELE_W25Q_POLL_SIZE)
+    /// Status bytes read by one busy poll transaction (status register is output continuously while CS is low)
+    #define ZHELE_W25Q_POLL_SIZE 16
+#endif
+
+namespace Zhele::Drivers
+{
+    /**
+     * @brief Implements W25Qxx (and compatible) SPI NOR flash
+     *
+     * @details
+     * All bus operations go through SPI transaction queue (DMA), so flash can share bus with other devices.
+     * Read uses fast read command, data is streamed by DMA directly into destination buffer.
+     * Program and erase run in background: next page program command and status (BUSY) polls
+     * are queued from transaction callbacks, so CPU is free while flash is busy. Async operation callbacks
+     * are called from SPI DMA interrupt. Only one operation can be active at once.
+     *
+     * @tparam _Spi SPI module (with transaction queue)
+     * @tparam _CsPin Chip select pin
+     */
+    template<typename _Spi, typename _CsPin>
+    class W25q
+    {
+        static_assert(ZHELE_W25Q_POLL_SIZE >= 4, "Poll buffer is used for JEDEC ID, so it should contain at least 4 bytes.");
+    public:
+        /// Async operation complete callback (argument is operation result)
+        using Callback = Filesystem::BlockDeviceCallback;
+
+        static const uint32_t PageSize = 256; ///< Program page size
+        static const uint32_t SectorSize = 4096; ///< Erase sector size
+        static const uint32_t BlockSize = 65536; ///< Erase block size
+
+        /// Flash command
+        enum Command : uint8_t
+        {
+            WriteEnable = 0x06, ///< Write enable
+            ReadStatus1 = 0x05, ///< Read status register 1
+            PageProgram = 0x02, ///< Page program
+            FastRead = 0x0B, ///< Fast read (with dummy byte)
+            SectorErase = 0x20, ///< 4 KB sector erase
+            BlockErase = 0xD8, ///< 64 KB block erase
+            ChipErase = 0xC7, ///< Chip erase
+            PowerDown = 0xB9, ///< Power down
+            ReleasePowerDown = 0xAB, ///< Release power down
+            JedecId = 0x9F, ///< Read JEDEC ID
+        };
+
+        /// Status register 1 bits
+        enum Status : uint8_t
+        {
+            StatusBusy = 0x01, ///< Program or erase in progress
+            StatusWriteEnableLatch = 0x02, ///< Write enable latch
+        };
+
+        /**
+         * @brief Init chip select pin, wakes flash up and reads JEDEC ID
+         *
+         * @details
+         * SPI module should be initialized before (mode 0 or 3).
+         *
+         * @retval true Flash detected
+         * @retval false No flash on bus
+         */
+        static bool Init();
+
+        /**
+         * @brief Returns JEDEC ID (manufacturer << 16 | memory type << 8 | capacity)
+         *
+         * @returns JEDEC ID (read by Init)
+         */
+        static uint32_t Id();
+
+        /**
+         * @brief Returns capacity
+         *
+         * @returns Capacity in bytes (0 if flash is not detected)
+         */
+        static uint32_t Capacity();
+
+        /**
+         * @brief Returns background operation state
+         *
+         * @retval true Operation is in progress
+         * @retval false Flash is ready
+         */
+        static bool Busy();
+
+        /**
+         * @brief Waits for background operation complete
+         *
+         * @retval true Last operation succeeded
+         * @retval false Last operation failed
+         */
+        static bool WaitReady();
+
+        /**
+         * @brief Reads data
+         *
+         * @param [in] address Start address
+         * @param [out] data Destination
+         * @param [in] size Data size
+         *
+         * @retval true Success
+         * @retval false Fail
+         */
+        static bool Read(uint32_t address, void* data, size_t size);
+
+        /**
+         * @brief Starts data read (fast read, DMA)
+         *
+         * @param [in] address Start address
+         * @param [out] data Destination
+         * @param [in] size Data size
+         * @param [in] callback Read complete callback
+         *
+         * @retval true Read started
+         * @retval false Flash is busy or transaction queue is full
+         */
+        static bool ReadAsync(uint32_t address, void* data, size_t size, Callback callback = nullptr);
+
+        /**
+         * @brief Programs data (region should be erased)
+         *
+         * @param [in] address Start address
+         * @param [in] data Data
+         * @param [in] size Data size
+         *
+         * @retval true Success
+         * @retval false Fail
+         */
+        static bool Program(uint32_t address, const void* data, size_t size);
+
+        /**
+         * @brief Starts background data program (region should be erased)
+         *
+         * @details
+         * Data is split by pages, data buffer should be valid until callback.
+         *
+         * @param [in] address Start address
+         * @param [in] data Data
+         * @param [in] size Data size
+         * @param [in] callback Program complete callback
+         *
+         * @retval true Program started
+         * @retval false Flash is busy or transaction queue is full
+         */
+        static bool ProgramAsync(uint32_t address, const void* data, size_t size, Callback callback = nullptr);
+
+        /**
+         * @brief Erases 4 KB sector
+         *
+         * @param [in] address Sector address
+         *
+         * @retval true Success
+         * @retval false Fail
+         */
+        static bool EraseSector(uint32_t address);
+
+        /**
+         * @brief Starts background sector erase
+         *
+         * @param [in] address Sector address
+         * @param [in] callback Erase complete callback
+         *
+         * @retval true Erase started
+         * @retval false Flash is busy or transaction queue is full
+         */
+        static bool EraseSectorAsync(uint32_t address, Callback callback = nullptr);
+
+        /**
+         * @brief Starts background 64 KB block erase
+         *
+         * @param [in] address Block address
+         * @param [in] callback Erase complete callback
+         *
+         * @retval true Erase started
+         * @retval false Flash is busy or transaction queue is full
+         */
+        static bool EraseBlockAsync(uint32_t address, Callback callback = nullptr);
+
+        /**
+         * @brief Starts background chip erase
+         *
+         * @param [in] callback Erase complete callback
+         *
+         * @retval true Erase started
+         * @retval false Flash is busy or transaction queue is full
+         */
+        static bool EraseChipAsync(Callback callback = nullptr);
+
+    protected:
+        /**
+         * @brief Queues SPI transaction
+         *
+         * @param [in] transmitBuffer Data to transmit (nullptr for transmit 0xff)
+         * @param [out] receiveBuffer Receive buffer (nullptr for ignore received data)
+         * @param [in] size Data size
+         * @param [in] chipSelectAction Chip select action
+         * @param [in] callback Transaction complete callback
+         *
+         * @retval true Transaction queued
+         * @retval false Transaction queue is full
+         */
+        static bool Queue(const void* transmitBuffer, void* receiveBuffer, uint16_t size,
+            typename _Spi::ChipSelectAction chipSelectAction, TransferCallback callback = nullptr);
+
+        /**
+         * @brief Fills command buffer (command and 24-bit address)
+         *
+         * @param [in] command Command
+         * @param [in] address Address
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void SetCommand(Command command, uint32_t address);
+
+        /**
+         * @brief Starts operation (marks flash as busy)
+         *
+         * @param [in] transactions Transactions required to start operation
+         * @param [in] callback Operation complete callback
+         *
+         * @retval true Operation can be started
+         * @retval false Flash is busy or transaction queue is full
+         */
+        static bool BeginOperation(size_t transactions, Callback callback);
+
+        /**
+         * @brief Finishes operation and calls callback
+         *
+         * @param [in] success Operation result
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void CompleteOperation(bool success);
+
+        /**
+         * @brief Queues write enable and erase command
+         *
+         * @param [in] command Erase command
+         * @param [in] address Erase address
+         * @param [in] withAddress Command has address
+         * @param [in] callback Erase complete callback
+         *
+         * @retval true Erase started
+         * @retval false Flash is busy or transaction queue is full
+         */
+        static bool StartErase(Command command, uint32_t address, bool withAddress, Callback callback);
+
+        /**
+         * @brief Queues fast read of next data chunk (up to 64 KB)
+         *
+         * @retval true Read queued
+         * @retval false Transaction queue is full
+         */
+        static bool QueueNextRead();
+
+        /**
+         * @brief Queues write enable and next page program
+         *
+         * @retval true Page program queued
+         * @retval false Transaction queue is full
+         */
+        static bool QueueNextPage();
+
+        /**
+         * @brief Queues status register poll
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void QueuePoll();
+
+        // SPI transaction callbacks
+        static void OnReadComplete(void* data, unsigned size, bool success);
+        static void OnCommandSent(void* data, unsigned size, bool success);
+        static void OnStatusPolled(void* data, unsigned size, bool success);
+
+    private:
+        static constexpr uint8_t WriteEnableCommand = Command::WriteEnable;
+        static constexpr uint8_t ReadStatusCommand = Command::ReadStatus1;
+        static constexpr uint8_t ReleasePowerDownCommand = Command::ReleasePowerDown;
+
+        static uint32_t _id;
+        static uint8_t _command[5];
+        static uint8_t _status[ZHELE_W25Q_POLL_SIZE];
+        static uint8_t* _data;
+        static uint32_t _address;
+        static uint32_t _remaining;
+        static uint16_t _chunkSize;
+        static Callback _callback;
+        static volatile bool _busy;
+        static volatile bool _result;
+    };
+
+    template<typename _Spi, typename _CsPin>
+    uint32_t W25q<_Spi, _CsPin>::_id = 0;
+    template<typename _Spi, typename _CsPin>
+    uint8_t W25q<_Spi, _CsPin>::_command[5];
+    template<typename _Spi, typename _CsPin>
+    uint8_t W25q<_Spi, _CsPin>::_status[ZHELE_W25Q_POLL_SIZE];
+    template<typename _Spi, typename _CsPin>
+    uint8_t* W25q<_Spi, _CsPin>::_data = nullptr;
+    template<typename _Spi, typename _CsPin>
+    uint32_t W25q<_Spi, _CsPin>::_address = 0;
+    template<typename _Spi, typename _CsPin>
+    uint32_t W25q<_Spi, _CsPin>::_remaining = 0;
+    template<typename _Spi, typename _CsPin>
+    uint16_t W25q<_Spi, _CsPin>::_chunkSize = 0;
+    template<typename _Spi, typename _CsPin>
+    Filesystem::BlockDeviceCallback W25q<_Spi, _CsPin>::_callback;
+    template<typename _Spi, typename _CsPin>
+    volatile bool W25q<_Spi, _CsPin>::_busy = false;
+    template<typename _Spi, typename _CsPin>
+    volatile bool W25q<_Spi, _CsPin>::_result = true;
+} // namespace Zhele::Drivers
+
+#include "impl/w25q.h"
+
+#endif //! ZHELE_DRIVERS_W25Q_H
@@ -0,0 +1,297 @@
+/**
+ * @file
+ * Implements WS2812/SK6812 addressable LED strip driver (SPI or timer PWM with DMA)
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_DRIVERS_WS2812_H
+#define ZHELE_DRIVERS_WS2812_H
+
+#include <dma.h>
+#include <common/template_utils/static_array.h>
+
+#include <stdint.h>
+#include <type_traits>
+
+namespace Zhele::Drivers
+{
+    /// Pixel format (bytes order on wire)
+    enum class Ws2812Format : uint8_t
+    {
+        Grb, ///< WS2812, WS2812B, SK6812 RGB
+        Grbw ///< SK6812 RGBW
+    };
+
+    /**
+     * @brief WS2812 SPI transport
+     *
+     * @details
+     * Each LED bit is sent as three SPI bits (100 is zero, 110 is one), MOSI is data line.
+     * SPI is initialized by transport (SCK is 2.25...2.9 MHz, for example 72 MHz / 32 on SPI1 of stm32f1),
+     * pins should be selected by user.
+     *
+     * @tparam _Spi SPI bus
+     */
+    template<typename _Spi>
+    class Ws2812SpiTransport
+    {
+        static constexpr auto _table = TemplateUtils::GenerateArray<uint32_t, 256>([](size_t value) {
+            uint32_t bits = 0;
+            for (unsigned bit = 0; bit < 8; ++bit)
+                bits = (bits << 3) | ((value & (0x80 >> bit)) != 0 ? 0b110 : 0b100);
+            return bits;
+        });
+    public:
+        /// DMA element
+        using Slot = uint8_t;
+        /// DMA elements per data byte
+        static const unsigned SlotsPerByte = 3;
+
+        /**
+         * @brief Init transport
+         *
+         * @returns Slots rate (Hz)
+         */
+        static uint32_t Init();
+
+        /**
+         * @brief Encodes byte
+         *
+         * @param [in] value Data byte
+         * @param [out] slots Output (SlotsPerByte elements)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Encode(uint8_t value, Slot* slots);
+
+        /**
+         * @brief Starts ping-pong transfer
+         *
+         * @param [in] buffer Slots buffer (two halves)
+         * @param [in] halfSize Half size (slots)
+         * @param [in] callback Half sent callback
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Start(Slot* buffer, uint16_t halfSize, TransferCallback callback);
+
+        /**
+         * @brief Stops transfer
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Stop();
+    };
+
+    /**
+     * @brief WS2812 timer PWM transport
+     *
+     * @details
+     * Timer generates 800 kHz PWM, DMA (timer update request, DMA burst of one CCR register)
+     * loads pulse of each LED bit (0.35 us is zero, 0.7 us is one, suitable for both WS2812B and SK6812).
+     * Timer channel pin should be selected by user (call EnableOutputs for advanced timer).
+     *
+     * @tparam _Timer Timer
+     * @tparam _Channel Timer channel (0...3)
+     * @tparam _DmaChannel DMA channel (stream) connected to timer update request
+     * @tparam _DmaRequest DMA channel selection (for DMA with streams, ignored otherwise)
+     */
+    template<typename _Timer, unsigned _Channel, typename _DmaChannel, uint8_t _DmaRequest = 0>
+    class Ws2812TimerTransport
+    {
+        static_assert(_Channel < 4, "Timer channel should be 0...3");
+        using Pwm = typename _Timer::template PWMGeneration<_Channel>;
+
+        static const uint32_t BitFreq = 800000;
+        static uint16_t _zero;
+        static uint16_t _one;
+    public:
+        /// DMA element
+        using Slot = uint16_t;
+        /// DMA elements per data byte
+        static const unsigned SlotsPerByte = 8;
+
+        /**
+         * @brief Init transport
+         *
+         * @returns Slots rate (Hz)
+         */
+        static uint32_t Init();
+
+        /**
+         * @brief Encodes byte
+         *
+         * @param [in] value Data byte
+         * @param [out] slots Output (SlotsPerByte elements)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Encode(uint8_t value, Slot* slots);
+
+        /**
+         * @brief Starts ping-pong transfer
+         *
+         * @param [in] buffer Slots buffer (two halves)
+         * @param [in] halfSize Half size (slots)
+         * @param [in] callback Half sent callback
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Start(Slot* buffer, uint16_t halfSize, TransferCallback callback);
+
+        /**
+         * @brief Stops transfer
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Stop();
+    };
+
+    /**
+     * @brief Implements WS2812/SK6812 LED strip driver
+     *
+     * @details
+     * Pixels are stored in wire order (3 or 4 bytes per LED). Update streams pixels by circular DMA:
+     * only two chunks of encoded data are kept in RAM, chunk is encoded in DMA half transfer callback
+     * while the other one is being sent. Strip is latched by reset (low level for 300 us) after the last LED.
+     * Pixels can be changed while update is in progress (LEDs which are not sent yet get new values).
+     * Encoding takes few percents of CPU time during update (for example 300 LEDs are sent in 9 ms,
+     * encoding of chunk takes less than 10 us on 72 MHz stm32f1).
+     *
+     * @tparam _Transport Transport (Ws2812SpiTransport or Ws2812TimerTransport)
+     * @tparam _Count LEDs count
+     * @tparam _Format Pixel format
+     * @tparam _ChunkLeds LEDs per chunk (DMA half buffer), chunk should be sent longer than interrupt latency
+     */
+    template<typename _Transport, unsigned _Count, Ws2812Format _Format = Ws2812Format::Grb, unsigned _ChunkLeds = 4>
+    class Ws2812
+    {
+        static_assert(_Count > 0, "Strip should have at least one LED");
+        static_assert(_ChunkLeds > 0, "Chunk should have at least one LED");
+
+        using Slot = typename _Transport::Slot;
+        static const unsigned ResetTime = 300; ///< Reset time (us)
+    public:
+        /// Bytes per LED
+        static const unsigned BytesPerLed = _Format == Ws2812Format::Grbw ? 4 : 3;
+        /// LEDs count
+        static const unsigned Count = _Count;
+        /// Update complete callback
+        using Callback = std::add_pointer_t<void()>;
+
+        /**
+         * @brief Init strip (transport and pixels)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Init();
+
+        /**
+         * @brief Sets LED color
+         *
+         * @param [in] index LED index
+         * @param [in] red Red
+         * @param [in] green Green
+         * @param [in] blue Blue
+         * @param [in] white White (ignored for RGB LEDs)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void SetPixel(unsigned index, uint8_t red, uint8_t green, uint8_t blue, uint8_t white = 0);
+
+        /**
+         * @brief Sets LED color
+         *
+         * @param [in] index LED index
+         * @param [in] color Color (0xWWRRGGBB)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void SetPixel(unsigned index, uint32_t color);
+
+        /**
+         * @brief Sets all LEDs color
+         *
+         * @param [in] color Color (0xWWRRGGBB)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Fill(uint32_t color);
+
+        /**
+         * @brief Turns off all LEDs
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void Clear();
+
+        /**
+         * @brief Sets global brightness (applied during encoding, pixels are not changed)
+         *
+         * @param [in] brightness Brightness (255 is full)
+         *
+         * @par Returns
+         *  Nothing
+         */
+        static void SetBrightness(uint8_t brightness);
+
+        /**
+         * @brief Returns pixels buffer (wire order: G, R, B[, W] for each LED)
+         *
+         * @returns Pixels buffer (Count * BytesPerLed bytes)
+         */
+        static uint8_t* Pixels();
+
+        /**
+         * @brief Starts strip update
+         *
+         * @param [in] callback Update complete callback (called from DMA ISR after reset time)
+         *
+         * @retval true Update is started
+         * @retval false Update is in progress
+         */
+        static bool Update(Callback callback = nullptr);
+
+        /**
+         * @brief Returns update state
+         *
+         * @retval true Update is in progress
+         * @retval false Strip is updated
+         */
+        static bool Busy();
+
+    private:
+        static const unsigned ChunkSlots = _ChunkLeds * BytesPerLed * _Transport::SlotsPerByte;
+
+        static void FillChunk(Slot* chunk);
+        static void OnChunkSent(void* data, unsigned size, bool success);
+
+        static uint8_t _pixels[_Count * BytesPerLed];
+        static Slot _buffer[2 * ChunkSlots];
+        static uint32_t _resetSlots;
+        static Callback _callback;
+        static uint16_t _brightness;
+        static unsigned _nextLed;
+        static uint32_t _resetLeft;
+        static Slot* _lastChunk;
+        static volatile bool _busy;
+    };
+}
+
+#include "impl/ws2812.h"
+
+#endif //! ZHELE_DRIVERS_WS2812_H
@@ -90,8 +90,18 @@ namespace Zhele
         using I2C1SdaPins = Pair<IO::PinList<IO::Pa10, IO::Pa12, IO::Pb7, IO::Pb9, IO::Pb11>, NonTypeTemplateArray<4, 5, 1, 1, 1>>;
 
         IO_STRUCT_WRAPPER(I2C1, I2C1Regs, I2C_TypeDef);
+
+        #if defined (SYSCFG_CFGR1_I2C_FMP_I2C1)
+        template<>
+        struct I2cFastModePlusDrive<I2C1Regs>
+        {
+            static const uint32_t Mask = SYSCFG_CFGR1_I2C_FMP_I2C1;
+        };
+        #endif
     }
     using I2c1 = Private::I2cBase<Private::I2C1Regs, I2C1_IRQn, I2C1_IRQn, Clock::I2c1Clock, Private::I2C1SclPins, Private::I2C1SdaPins, Dma1Channel2, Dma1Channel3>;
 }
 
+#include "../common/i2c_queue.h"
+
 #endif //! ZHELE_I2C_H
\ No newline at end of file
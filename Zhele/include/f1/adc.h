@@ -26,19 +26,36 @@ namespace Zhele
         public:
             // External trigger for regular channels
             enum class RegularTrigger : uint8_t
+            {
+                Timer1CC1 = 0, //< Timer 1 CC1
+                Timer1CC2 = 1, //< Timer 1 CC2
+                Timer1CC3 = 2, //< Timer 1 CC3
+                Timer2CC2 = 3, //< Timer 2 CC2
+                Timer3TRGO = 4, //< Timer 3 TRGO
+                Timer4CC4 = 5, //< Timer 4 CC4
+                Exti11 = 6, //< EXTI line 11 (or Timer 8 TRGO for ADC1/2 on XL-density devices)
+                Software = 7, //< SWSTART bit (free running in continuous mode)
+            };
+
+            // External trigger for injected channels
+            enum class InjectedTrigger : uint8_t
             {
                 Timer1TRGO = 0, //< Timer 1 TRGO
-                Timer1CC4, //< Timer 1 CC4
-                Timer2TRGO, //< Timer 2 TRGO
-                Timer3TRGO, //< Timer 3 TRGO
-                Timer15TRGO, //< Timer 15 TRGO
+                Timer1CC4 = 1, //< Timer 1 CC4
+                Timer2TRGO = 2, //< Timer 2 TRGO
+                Timer2CC1 = 3, //< Timer 2 CC1
+                Timer3CC4 = 4, //< Timer 3 CC4
+                Timer4TRGO = 5, //< Timer 4 TRGO
+                Exti15 = 6, //< EXTI line 15 (or Timer 8 CC4 for ADC1/2 on XL-density devices)
+                Software = 7, //< JSWSTART bit
             };
 
             // Trigger mode
             enum class TriggerMode
             {
-                Disabled, //< Trigger detection disabled,
-                RisingFalling, // Detection on both rising and falling edge
+                Disabled = 0, //< Trigger detection disabled,
+                Rising = 1, //< Detection on rising edge
+                RisingFalling = Rising, //< F1 ADC detects rising edge only (kept for compatibility)
             };
         };
 
@@ -61,9 +78,174 @@ namespace Zhele
             Zhele::IO::Pc5>;
 
         IO_STRUCT_WRAPPER(ADC1, Adc1Regs, ADC_TypeDef);
+    #if defined (ADC2)
+        IO_STRUCT_WRAPPER(ADC2, Adc2Regs, ADC_TypeDef);
+    #endif
+
+    #if defined (ADC_CR1_DUALMOD)
+        /**
+         * @brief Implements dual ADC mode (ADC1 master + ADC2 slave)
+         * 
+         * @details
+         * Both ADCs should be initialized (Init) before use. Master and slave results are
+         * packed into one 32-bit word (master in low half, slave in high half) and are
+         * transferred by master DMA in circular (ping-pong) mode.
+         * Conversions are started by master regular trigger (see Adc::SetRegularTrigger).
+         * With software trigger ADCs run continuously at max rate.
+         * 
+         * @tparam _MasterRegs Master ADC registers
+         * @tparam _SlaveRegs Slave ADC registers
+         * @tparam _InputPins Input pins (shared by both ADCs)
+         * @tparam _DmaChannel Master ADC DMA channel
+         */
+        template <typename _MasterRegs, typename _SlaveRegs, typename _InputPins, typename _DmaChannel>
+        class AdcDual
+        {
+            static const uint8_t MaxRegular = 16;
+        public:
+            /// Dual mode
+            enum class Mode : uint8_t
+            {
+                Independent = 0, ///< Independent mode
+                RegularSimultaneous = 6, ///< Regular simultaneous: both ADCs convert own sequence at the same time
+                FastInterleaved = 7, ///< Fast interleaved: one channel, slave starts immediately, master after 7 ADC clocks
+                SlowInterleaved = 8, ///< Slow interleaved: one channel, slave starts immediately, master after 14 ADC clocks
+            };
+
+            /**
+             * @brief Start continuous dual ADC measurement to ping-pong buffer
+             * 
+             * @details
+             * Simultaneous mode doubles channels count per trigger (current/voltage pairs are phase-aligned),
+             * interleaved modes double sample rate of one channel (channelsCount should be 1).
+             * 
+             * @param [in] mode Dual mode
+             * @param [in] masterChannels Master channels
+             * @param [in] slaveChannels Slave channels (nullptr - same as master channels)
+             * @param [in] channelsCount Channels count (for each ADC)
+             * @param [out] dataBuffer Buffer. Must has 2 * channelsCount * halfScanCount elements.
+             * @param [in] halfScanCount Scans count in one half of buffer
+             * @param [in] callback Half buffer ready callback
+             * 
+             * @retval true Measurement has been started
+             * @retval false Invalid arguments
+             */
+            static bool StartRegular(Mode mode, const uint8_t* masterChannels, const uint8_t* slaveChannels, uint8_t channelsCount,
+                uint32_t* dataBuffer, uint16_t halfScanCount, TransferCallback callback)
+            {
+                bool interleaved = mode == Mode::FastInterleaved || mode == Mode::SlowInterleaved;
+                if (channelsCount == 0 || channelsCount > MaxRegular || halfScanCount == 0 || (interleaved && channelsCount != 1))
+                    return false;
+
+                if (slaveChannels == nullptr)
+                    slaveChannels = masterChannels;
+
+                StopRegular();
+
+                SetSequence<_MasterRegs>(masterChannels, channelsCount);
+                SetSequence<_SlaveRegs>(slaveChannels, channelsCount);
+
+                _MasterRegs()->CR1 = (_MasterRegs()->CR1 & ~(ADC_CR1_DUALMOD | ADC_CR1_DISCEN | ADC_CR1_SCAN))
+                    | (static_cast<uint32_t>(mode) << ADC_CR1_DUALMOD_Pos)
+                    | (channelsCount > 1 ? ADC_CR1_SCAN : 0);
+                _SlaveRegs()->CR1 = (_SlaveRegs()->CR1 & ~(ADC_CR1_DISCEN | ADC_CR1_SCAN))
+                    | (channelsCount > 1 ? ADC_CR1_SCAN : 0);
+
+                // Slave is triggered by master, so its own trigger should be software
+                _SlaveRegs()->CR2 |= ADC_CR2_EXTSEL | ADC_CR2_EXTTRIG;
+
+                _DmaChannel::PingPongTransfer(DmaBase::Periph2Mem | DmaBase::MemIncrement | DmaBase::PriorityHigh | DmaBase::PSize32Bits | DmaBase::MSize32Bits,
+                    dataBuffer, &_MasterRegs()->DR, channelsCount * halfScanCount);
+                _DmaChannel::SetTransferCallback(callback);
+
+                _MasterRegs()->CR2 |= ADC_CR2_DMA;
+
+                // Slow interleaved mode does not allow continuous conversion
+                if ((_MasterRegs()->CR2 & ADC_CR2_EXTSEL) == ADC_CR2_EXTSEL && mode != Mode::SlowInterleaved)
+                {
+                    _SlaveRegs()->CR2 |= ADC_CR2_CONT;
+                    _MasterRegs()->CR2 |= ADC_CR2_CONT;
+                    _MasterRegs()->CR2 |= ADC_CR2_SWSTART;
+                }
+
+                return true;
+            }
+
+            /**
+             * @brief Stop dual ADC measurement (switch ADCs to independent mode)
+             * 
+             * @par Returns
+             *  Nothing
+             */
+            static void StopRegular()
+            {
+                _MasterRegs()->CR2 &= ~(ADC_CR2_CONT | ADC_CR2_DMA);
+                _SlaveRegs()->CR2 &= ~ADC_CR2_CONT;
+                _DmaChannel::Disable();
+                _MasterRegs()->CR1 &= ~ADC_CR1_DUALMOD;
+                _MasterRegs()->SR &= ~(ADC_SR_STRT | ADC_SR_EOC);
+                _SlaveRegs()->SR &= ~(ADC_SR_STRT | ADC_SR_EOC);
+            }
+
+            /**
+             * @brief Returns master result from dual sample
+             * 
+             * @param [in] sample Dual sample
+             * 
+             * @returns Master result
+             */
+            static constexpr uint16_t Master(uint32_t sample)
+            {
+                return sample & 0xffff;
+            }
+
+            /**
+             * @brief Returns slave result from dual sample
+             * 
+             * @param [in] sample Dual sample
+             * 
+             * @returns Slave result
+             */
+            static constexpr uint16_t Slave(uint32_t sample)
+            {
+                return sample >> 16;
+            }
+
+        private:
+            template <typename _Regs>
+            static void SetSequence(const uint8_t* channels, uint8_t count)
+            {
+                _Regs()->SQR1 = ((count - 1) << ADC_SQR1_L_Pos);
+                _Regs()->SQR2 = 0;
+                _Regs()->SQR3 = 0;
+
+                for (unsigned i = 0; i < count; ++i)
+                {
+                    if (channels[i] < _InputPins::Length)
+                        _InputPins::SetConfiguration(1u << channels[i], _InputPins::Analog);
+
+                    if (i < 6)
+                        _Regs()->SQR3 |= (channels[i] & 0x1f) << 5 * i;
+                    else if (i < 12)
+                        _Regs()->SQR2 |= (channels[i] & 0x1f) << 5 * (i - 6);
+                    else
+                        _Regs()->SQR1 |= (channels[i] & 0x1f) << 5 * (i - 12);
+                }
+            }
+        };
+    #endif
     }
 
     using Adc1 = Private::Adc<Private::Adc1Regs, Clock::Adc1Clock, Private::Adc1Pins, Dma1Channel1>;
+#if defined (ADC2)
+    // ADC2 has no DMA request: use it as dual mode slave (Adc12) or read results by interrupts
+    using Adc2 = Private::Adc<Private::Adc2Regs, Clock::Adc2Clock, Private::Adc1Pins, Dma1Channel1>;
+#endif
+#if defined (ADC_CR1_DUALMOD) && defined (ADC2)
+    using Adc12 = Private::AdcDual<Private::Adc1Regs, Private::Adc2Regs, Private::Adc1Pins, Dma1Channel1>;
+#endif
 }
 
+#include "../common/adc_decimator.h"
+
 #endif //! ZHELE_ADC_H
\ No newline at end of file
@@ -0,0 +1,136 @@
+/**
+ * @file
+ * @brief Implements bxCAN for stm32f1 series
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_CAN_H
+#define ZHELE_CAN_H
+
+#include <stm32f1xx.h>
+
+#if defined (CAN1)
+
+#include "../common/can.h"
+
+#include "clock.h"
+#include "iopins.h"
+#include "remap.h"
+#include "../common/template_utils/pair.h"
+#include "../common/template_utils/static_array.h"
+
+namespace Zhele
+{
+    namespace Private
+    {
+        /**
+         * @brief Select RX and TX pins (set settings)
+         * 
+         * @param [in] txPinNumber pin number in Txs PinList
+         * @param [in] rxPinNumber pin number in Rxs PinList
+         * 
+         * @par Returns
+         *	Nothing
+        */
+        template<typename _Regs, typename _FilterRegs, IRQn_Type _TxIrq, IRQn_Type _Rx0Irq, IRQn_Type _Rx1Irq, IRQn_Type _SceIrq, typename _ClockCtrl, typename _TxPins, typename _RxPins>
+        void Can<_Regs, _FilterRegs, _TxIrq, _Rx0Irq, _Rx1Irq, _SceIrq, _ClockCtrl, _TxPins, _RxPins>::SelectTxRxPins(int8_t txPinNumber, int8_t rxPinNumber)
+        {
+            using AltFuncNumbers = typename _TxPins::Value;
+
+            using TxPins = typename _TxPins::Key;
+            using RxPins = typename _RxPins::Key;
+
+            using Type = typename _TxPins::Key::DataType;
+
+            TxPins::Enable();
+            Type maskTx(1 << txPinNumber);
+            TxPins::SetConfiguration(maskTx, TxPins::AltFunc);
+
+            RxPins::Enable();
+            Type maskRx(1 << rxPinNumber);
+            RxPins::SetConfiguration(maskRx, RxPins::In);
+
+            Clock::AfioClock::Enable();
+            Zhele::IO::Private::PeriphRemap<_ClockCtrl>::Set(GetNumberRuntime<AltFuncNumbers>::Get(txPinNumber));
+        }
+
+        /**
+         * @brief Template clone of SelectTxRxPins method
+         * 
+         * @tparam TxPinNumber pin number in Txs PinList
+         * @tparam RxPinNumber pin number in Rxs PinList
+         * 
+         * @par Returns
+         *	Nothing
+        */
+        template<typename _Regs, typename _FilterRegs, IRQn_Type _TxIrq, IRQn_Type _Rx0Irq, IRQn_Type _Rx1Irq, IRQn_Type _SceIrq, typename _ClockCtrl, typename _TxPins, typename _RxPins>
+        template<int8_t TxPinNumber, int8_t RxPinNumber>
+        void Can<_Regs, _FilterRegs, _TxIrq, _Rx0Irq, _Rx1Irq, _SceIrq, _ClockCtrl, _TxPins, _RxPins>::SelectTxRxPins()
+        {
+            static_assert(TxPinNumber == RxPinNumber, "TX and RX pins should belong to one remap");
+
+            using TxAltFuncNumbers = typename _TxPins::Value;
+
+            using TxPin = typename _TxPins::Key:: template Pin<TxPinNumber>;
+            using RxPin = typename _RxPins::Key:: template Pin<RxPinNumber>;
+
+            TxPin::Port::Enable();
+            TxPin::SetConfiguration(TxPin::Port::AltFunc);
+
+            if constexpr (!std::is_same_v<typename RxPin::Port, typename TxPin::Port>)
+            {
+                RxPin::Port::Enable();
+            }
+            RxPin::SetConfiguration(RxPin::Port::In);
+
+            Clock::AfioClock::Enable();
+            Zhele::IO::Private::PeriphRemap<_ClockCtrl>::Set(GetNonTypeValueByIndex<TxPinNumber, TxAltFuncNumbers>::value);
+        }
+
+        /**
+         * @brief Template clone of SelectTxRxPins method (params are TPin instances)
+         * 
+         * @tparam TxPin TxPin
+         * @tparam RxPin RxPin
+         * 
+         * @par Returns
+         *	Nothing
+        */
+        template<typename _Regs, typename _FilterRegs, IRQn_Type _TxIrq, IRQn_Type _Rx0Irq, IRQn_Type _Rx1Irq, IRQn_Type _SceIrq, typename _ClockCtrl, typename _TxPins, typename _RxPins>
+        template<typename TxPin, typename RxPin>
+        void Can<_Regs, _FilterRegs, _TxIrq, _Rx0Irq, _Rx1Irq, _SceIrq, _ClockCtrl, _TxPins, _RxPins>::SelectTxRxPins()
+        {
+            const int8_t txPinIndex = TypeIndex<TxPin, typename _TxPins::Key::PinsAsTypeList>::value;
+            const int8_t rxPinIndex = TypeIndex<RxPin, typename _RxPins::Key::PinsAsTypeList>::value;
+            static_assert(txPinIndex >= 0);
+            static_assert(rxPinIndex >= 0);
+            SelectTxRxPins<txPinIndex, rxPinIndex>();
+        }
+
+        using Can1TxPins = Pair<IO::PinList<IO::Pa12, IO::Pb9, IO::Pd1>, NonTypeTemplateArray<0, 2, 3>>;
+        using Can1RxPins = Pair<IO::PinList<IO::Pa11, IO::Pb8, IO::Pd0>, NonTypeTemplateArray<0, 2, 3>>;
+
+        IO_STRUCT_WRAPPER(CAN1, Can1Regs, CAN_TypeDef);
+
+    #if defined (CAN2)
+        using Can2TxPins = Pair<IO::PinList<IO::Pb13, IO::Pb6>, NonTypeTemplateArray<0, 1>>;
+        using Can2RxPins = Pair<IO::PinList<IO::Pb12, IO::Pb5>, NonTypeTemplateArray<0, 1>>;
+
+        IO_STRUCT_WRAPPER(CAN2, Can2Regs, CAN_TypeDef);
+    #endif
+    }
+
+#if defined (CAN2)
+    using Can1 = Private::Can<Private::Can1Regs, Private::Can1Regs, CAN1_TX_IRQn, CAN1_RX0_IRQn, CAN1_RX1_IRQn, CAN1_SCE_IRQn, Clock::Can1Clock, Private::Can1TxPins, Private::Can1RxPins>;
+    using Can2 = Private::Can<Private::Can2Regs, Private::Can1Regs, CAN2_TX_IRQn, CAN2_RX0_IRQn, CAN2_RX1_IRQn, CAN2_SCE_IRQn, Clock::Can2Clock, Private::Can2TxPins, Private::Can2RxPins>;
+#else
+    // TX and RX0 interrupts are shared with USB
+    using Can1 = Private::Can<Private::Can1Regs, Private::Can1Regs, USB_HP_CAN1_TX_IRQn, USB_LP_CAN1_RX0_IRQn, CAN1_RX1_IRQn, CAN1_SCE_IRQn, Clock::Can1Clock, Private::Can1TxPins, Private::Can1RxPins>;
+#endif
+}
+
+#endif //! CAN1
+
+#endif //! ZHELE_CAN_H
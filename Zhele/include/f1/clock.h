@@ -300,10 +300,10 @@ namespace Zhele::Clock
     #endif
 
     #if defined (RCC_APB2ENR_ADC2EN)
-        using Adc2Clock = ClockControl<PeriphClockEnable2, RCC_APB2ENR_ADC2EN, Apb2Clock>;
+        using Adc2Clock = ClockControl<PeriphClockEnable2, RCC_APB2ENR_ADC2EN, AdcClockSource>;
     #endif
     #if defined (RCC_APB2ENR_ADC3EN)
-        using Adc3Clock = ClockControl<PeriphClockEnable2, RCC_APB2ENR_ADC3EN, Apb2Clock>;
+        using Adc3Clock = ClockControl<PeriphClockEnable2, RCC_APB2ENR_ADC3EN, AdcClockSource>;
     #endif
     #if defined (RCC_APB2ENR_IOPEEN)
         using PorteClock = ClockControl<PeriphClockEnable2, RCC_APB2ENR_IOPEEN, Apb2Clock>;
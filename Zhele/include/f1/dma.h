@@ -57,4 +57,7 @@ namespace Zhele
 #endif
 } // namespace Zhele
 
+#include "../common/dma_arbiter.h"
+#include "../common/dma_memory.h"
+
 #endif //! ZHELE_DMA_H
\ No newline at end of file
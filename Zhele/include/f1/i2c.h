@@ -99,4 +99,6 @@ namespace Zhele
 #endif
 }
 
+#include "../common/i2c_queue.h"
+
 #endif //! ZHELE_I2C_H
\ No newline at end of file
@@ -72,6 +72,25 @@ namespace Zhele
                 mask = ConfigurationMask(mask);
                 return (value & ~(mask * configMask)) | mask * configuration;
             }
+
+            /**
+             * @brief Returns pin configuration bits (CNF and MODE) for all pin attributes
+             *
+             * @param [in] configuration Configuration
+             * @param [in] speed Speed (outputs only)
+             * @param [in] driver Driver type (outputs only)
+             * @param [in] pull Pull mode (inputs only)
+             *
+             * @returns CRL/CRH nibble
+             */
+            static constexpr unsigned PinConfiguration(Configuration configuration, Speed speed, DriverType driver, PullMode pull)
+            {
+                if (configuration == Analog)
+                    return 0;
+                if (configuration == In)
+                    return pull == NoPull ? static_cast<unsigned>(In) : (pull & 0x08);
+                return (configuration & 0x08) | driver | speed;
+            }
         };
 
         class NullPort : public NativePortBase
@@ -131,16 +150,36 @@ namespace Zhele
 
             static void SetSpeed(DataT, Speed)
             {}
+
+            template<DataT mask, Speed>
+            static void SetSpeed()
+            {}
             
             static void SetPullMode(DataT, PullMode)
             {}
+
+            template<DataT mask, PullMode>
+            static void SetPullMode()
+            {}
             
             static void SetDriverType(DataT, DriverType)
             {}
+
+            template<DataT mask, DriverType>
+            static void SetDriverType()
+            {}
             
             static void AltFuncNumber(DataT, uint8_t)
             {}
 
+            template<DataT mask, uint8_t>
+            static void AltFuncNumber()
+            {}
+
+            template<DataT mask, Configuration, Speed, DriverType, PullMode, uint8_t>
+            static void Configure()
+            {}
+
             enum{Id = '-'};
             enum{Width=sizeof(DataT)*8};
         };
@@ -337,11 +376,13 @@ namespace Zhele
                 template<DataType mask, Configuration configuration>
                 static void SetConfiguration()
                 {
-                    constexpr unsigned lowMaskPart = ConfigurationMask(mask);
+                    constexpr unsigned lowMaskPart = ConfigurationMask(mask & 0xff);
                     constexpr unsigned highMaskPart = ConfigurationMask(mask >> 8);
 
-                    _Regs()->CRL = (_Regs()->CRL & ~(lowMaskPart * 0x0f)) | lowMaskPart * configuration;
-                    _Regs()->CRH = (_Regs()->CRH & ~(highMaskPart * 0x0f)) | highMaskPart * configuration;
+                    if constexpr (lowMaskPart != 0)
+                        _Regs()->CRL = (_Regs()->CRL & ~(lowMaskPart * 0x0f)) | lowMaskPart * configuration;
+                    if constexpr (highMaskPart != 0)
+                        _Regs()->CRH = (_Regs()->CRH & ~(highMaskPart * 0x0f)) | highMaskPart * configuration;
                 }
 
                 /**
@@ -370,10 +411,13 @@ namespace Zhele
                 template<DataType mask, Speed speed>
                 static void SetSpeed()
                 {
-                    constexpr unsigned lowMaskPart = ConfigurationMask(mask);
-                    constexpr unsigned highMaskPart = ConfigurationMask(mask);
-                    _Regs()->CRL = (_Regs()->CRL & ~(lowMaskPart * 0x03)) | lowMaskPart * speed;
-                    _Regs()->CRH = (_Regs()->CRH & ~(highMaskPart * 0x03)) | highMaskPart * speed;
+                    constexpr unsigned lowMaskPart = ConfigurationMask(mask & 0xff);
+                    constexpr unsigned highMaskPart = ConfigurationMask(mask >> 8);
+
+                    if constexpr (lowMaskPart != 0)
+                        _Regs()->CRL = (_Regs()->CRL & ~(lowMaskPart * 0x03)) | lowMaskPart * speed;
+                    if constexpr (highMaskPart != 0)
+                        _Regs()->CRH = (_Regs()->CRH & ~(highMaskPart * 0x03)) | highMaskPart * speed;
                 }
 
                 /**
@@ -452,10 +496,51 @@ namespace Zhele
                 template <DataType mask, DriverType driver>
                 static void SetDriverType()
                 {
-                    constexpr unsigned lowMaskPart = ConfigurationMask(mask);
-                    constexpr unsigned highMaskPart = ConfigurationMask(mask);
-                    _Regs()->CRL = (_Regs()->CRL & ~(lowMaskPart * 0x04)) | lowMaskPart * driver;
-                    _Regs()->CRH = (_Regs()->CRH & ~(highMaskPart * 0x04)) | highMaskPart * driver;
+                    constexpr unsigned lowMaskPart = ConfigurationMask(mask & 0xff);
+                    constexpr unsigned highMaskPart = ConfigurationMask(mask >> 8);
+
+                    if constexpr (lowMaskPart != 0)
+                        _Regs()->CRL = (_Regs()->CRL & ~(lowMaskPart * 0x04)) | lowMaskPart * driver;
+                    if constexpr (highMaskPart != 0)
+                        _Regs()->CRH = (_Regs()->CRH & ~(highMaskPart * 0x04)) | highMaskPart * driver;
+                }
+
+                /**
+                 * @brief Set all pin attributes at once
+                 * @details
+                 * Configuration, speed, driver type and pull are packed to CNF/MODE bits at compile time,
+                 * so each of CRL and CRH is written once (and only if mask has pins in it).
+                 * 
+                 * @tparam mask Pin mask
+                 * @tparam configuration Selected pins configuration
+                 * @tparam speed Selected pins speed (outputs only)
+                 * @tparam driver Driver type (outputs only)
+                 * @tparam pull Pull mode (inputs only)
+                 * @tparam number Alternate function number (not supported, use remap)
+                 * 
+                 * @par Returns
+                 *	Nothing
+                 */
+                template<DataType mask, Configuration configuration, Speed speed, DriverType driver, PullMode pull, uint8_t number>
+                static void Configure()
+                {
+                    constexpr unsigned lowMaskPart = ConfigurationMask(mask & 0xff);
+                    constexpr unsigned highMaskPart = ConfigurationMask(mask >> 8);
+                    constexpr unsigned config = PinConfiguration(configuration, speed, driver, pull);
+
+                    // Pull direction is selected by ODR, set it before input is switched to pull mode
+                    if constexpr (configuration == In && pull != NoPull)
+                    {
+                        if constexpr ((pull & 0x10) != 0)
+                            Clear<mask>();
+                        else
+                            Set<mask>();
+                    }
+
+                    if constexpr (lowMaskPart != 0)
+                        _Regs()->CRL = (_Regs()->CRL & ~(lowMaskPart * 0x0f)) | lowMaskPart * config;
+                    if constexpr (highMaskPart != 0)
+                        _Regs()->CRH = (_Regs()->CRH & ~(highMaskPart * 0x0f)) | highMaskPart * config;
                 }
 
                 /**
@@ -507,6 +592,16 @@ namespace Zhele
                 {
                     _ClkEnReg::Disable();
                 }
+
+                /**
+                 * @brief Returns port registers (for DMA transfers to/from port registers)
+                 * 
+                 * @returns Port registers
+                 */
+                static GPIO_TypeDef* Regs()
+                {
+                    return _Regs::Get();
+                }
                 enum { Id = ID };
             };
         }
@@ -82,6 +82,16 @@ namespace Zhele::IO
         DECLARE_IO_BITFIELD_WRAPPER(AFIO->MAPR, I2c1RemapBitField, AFIO_MAPR_I2C1_REMAP)
         DECLARE_PERIPH_REMAP(Zhele::Clock::I2c1Clock, I2c1RemapBitField)
 
+        // CAN remap
+        #if defined (AFIO_MAPR_CAN_REMAP)
+            DECLARE_IO_BITFIELD_WRAPPER(AFIO->MAPR, Can1RemapBitField, AFIO_MAPR_CAN_REMAP)
+            DECLARE_PERIPH_REMAP(Zhele::Clock::Can1Clock, Can1RemapBitField)
+        #endif
+        #if defined (AFIO_MAPR_CAN2_REMAP)
+            DECLARE_IO_BITFIELD_WRAPPER(AFIO->MAPR, Can2RemapBitField, AFIO_MAPR_CAN2_REMAP)
+            DECLARE_PERIPH_REMAP(Zhele::Clock::Can2Clock, Can2RemapBitField)
+        #endif
+
         template<typename Clock>
         using PeriphRemap = typename Private::PeriphRemapBitField<Clock>::BitField;
 
@@ -110,6 +120,12 @@ namespace Zhele::IO
 #endif
 
     using I2c1Remap = Private::PeriphRemap<Zhele::Clock::I2c1Clock>;
+#if defined (AFIO_MAPR_CAN_REMAP)
+    using Can1Remap = Private::PeriphRemap<Zhele::Clock::Can1Clock>;
+#endif
+#if defined (AFIO_MAPR_CAN2_REMAP)
+    using Can2Remap = Private::PeriphRemap<Zhele::Clock::Can2Clock>;
+#endif
 
     using SwjRemap = Private::SwjRemapBitField;
 } // namespace Zhele::IO
@@ -120,6 +120,58 @@ namespace Zhele::Timers
             SelectPins<Pins::template IndexOf<Pin>>();
         }
 
+        ADVANCED_TIMER_TEMPLATE_ARGS
+        template <typename Pin>
+        void ADVANCED_TIMER_TEMPLATE_QUALIFIER::SelectBreakPins()
+        {
+            using Pins = typename _BreakPins::Key;
+            using PinsAltFuncNumbers = typename _BreakPins::Value;
+            static_assert(Pins::template IndexOf<Pin> >= 0);
+
+            Pin::Port::Enable();
+            Pin::template SetConfiguration<Pins::In>();
+            GetTimerRemap<_Regs>::Set(GetNonTypeValueByIndex<Pins::template IndexOf<Pin>, PinsAltFuncNumbers>::value);
+        }
+
+        ADVANCED_TIMER_TEMPLATE_ARGS
+        template <unsigned _ChannelNumber>
+        void ADVANCED_TIMER_TEMPLATE_QUALIFIER::ComplementaryPWMGeneration<_ChannelNumber>::SelectComplementaryPins(int pinNumber)
+        {
+            using Pins = ComplementaryPins;
+            using Type = typename Pins::DataType;
+
+            Type mask = 1 << pinNumber;
+
+            Pins::Enable();
+            Pins::SetConfiguration(mask, Pins::AltFunc);
+            Pins::SetDriverType(mask, Pins::DriverType::PushPull);
+            GetTimerRemap<_Regs>::Set(GetNumberRuntime<ComplementaryPinsAltFuncNumber>::Get(pinNumber));
+        }
+
+        ADVANCED_TIMER_TEMPLATE_ARGS
+        template <unsigned _ChannelNumber>
+        template <unsigned PinNumber>
+        void ADVANCED_TIMER_TEMPLATE_QUALIFIER::ComplementaryPWMGeneration<_ChannelNumber>::SelectComplementaryPins()
+        {
+            using Pins = ComplementaryPins;
+            using Pin = typename Pins::template Pin<PinNumber>;
+
+            Pin::Port::Enable();
+            Pin::template SetConfiguration<Pins::AltFunc>();
+            Pin::template SetDriverType<Pins::DriverType::PushPull>();
+            GetTimerRemap<_Regs>::Set(GetNonTypeValueByIndex<PinNumber, ComplementaryPinsAltFuncNumber>::value);
+        }
+
+        ADVANCED_TIMER_TEMPLATE_ARGS
+        template <unsigned _ChannelNumber>
+        template <typename Pin>
+        void ADVANCED_TIMER_TEMPLATE_QUALIFIER::ComplementaryPWMGeneration<_ChannelNumber>::SelectComplementaryPins()
+        {
+            static_assert(ComplementaryPins::template IndexOf<Pin> >= 0);
+
+            SelectComplementaryPins<ComplementaryPins::template IndexOf<Pin>>();
+        }
+
         using namespace Zhele::IO;
 
         template<unsigned ChannelNumber> struct Tim1ChPins;
@@ -128,6 +180,12 @@ namespace Zhele::Timers
         template<> struct Tim1ChPins<2>{ using Pins = Pair<IO::PinList<Pa10, Pe13>, NonTypeTemplateArray<0, 3>>; };
         template<> struct Tim1ChPins<3>{ using Pins = Pair<IO::PinList<Pa11, Pe14>, NonTypeTemplateArray<0, 3>>; };		
 
+        template<unsigned ChannelNumber> struct Tim1ChNPins;
+        template<> struct Tim1ChNPins<0>{ using Pins = Pair<IO::PinList<Pb13, Pa7, Pe8>, NonTypeTemplateArray<0, 1, 3>>; };
+        template<> struct Tim1ChNPins<1>{ using Pins = Pair<IO::PinList<Pb14, Pb0, Pe10>, NonTypeTemplateArray<0, 1, 3>>; };
+        template<> struct Tim1ChNPins<2>{ using Pins = Pair<IO::PinList<Pb15, Pb1, Pe12>, NonTypeTemplateArray<0, 1, 3>>; };
+        using Tim1BreakPins = Pair<IO::PinList<Pb12, Pa6, Pe15>, NonTypeTemplateArray<0, 1, 3>>;
+
         template<unsigned ChannelNumber> struct Tim2ChPins;
         template<> struct Tim2ChPins<0>{ using Pins = Pair<IO::PinList<Pa0, Pa15, Pa0, Pa15>, NonTypeTemplateArray<0, 1, 2, 3>>; };
         template<> struct Tim2ChPins<1>{ using Pins = Pair<IO::PinList<Pa1, Pb3, Pa1, Pb3>, NonTypeTemplateArray<0, 1, 2, 3>>; };
@@ -161,7 +219,7 @@ namespace Zhele::Timers
 #endif
     }
 
-    using Timer1 = Private::AdvancedTimer<Private::Tim1Regs, Clock::Tim1Clock, TIM1_UP_IRQn, Private::Tim1ChPins>;
+    using Timer1 = Private::AdvancedTimer<Private::Tim1Regs, Clock::Tim1Clock, TIM1_UP_IRQn, Private::Tim1ChPins, Private::Tim1ChNPins, Private::Tim1BreakPins, TIM1_BRK_IRQn>;
     using Timer2 = Private::GPTimer<Private::Tim2Regs, Clock::Tim2Clock, TIM2_IRQn, Private::Tim2ChPins>;
     using Timer3 = Private::GPTimer<Private::Tim3Regs, Clock::Tim3Clock, TIM3_IRQn, Private::Tim3ChPins>;
 #if defined (TIM4)
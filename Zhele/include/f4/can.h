@@ -0,0 +1,116 @@
+/**
+ * @file
+ * @brief Implements bxCAN for stm32f4 series
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_CAN_H
+#define ZHELE_CAN_H
+
+#include <stm32f4xx.h>
+
+#if defined (CAN1)
+
+#include "../common/can.h"
+
+#include "afio_bind.h"
+#include "clock.h"
+#include "iopins.h"
+
+namespace Zhele
+{
+    namespace Private
+    {
+        /**
+         * @brief Select RX and TX pins (set settings)
+         * 
+         * @param [in] txPinNumber pin number in Txs PinList
+         * @param [in] rxPinNumber pin number in Rxs PinList
+         * 
+         * @par Returns
+         *	Nothing
+        */
+        template<typename _Regs, typename _FilterRegs, IRQn_Type _TxIrq, IRQn_Type _Rx0Irq, IRQn_Type _Rx1Irq, IRQn_Type _SceIrq, typename _ClockCtrl, typename _TxPins, typename _RxPins>
+        void Can<_Regs, _FilterRegs, _TxIrq, _Rx0Irq, _Rx1Irq, _SceIrq, _ClockCtrl, _TxPins, _RxPins>::SelectTxRxPins(int8_t txPinNumber, int8_t rxPinNumber)
+        {
+            using Type = typename _TxPins::DataType;
+            _TxPins::Enable();
+            Type maskTx(1 << txPinNumber);
+            _TxPins::SetConfiguration(maskTx, _TxPins::AltFunc);
+            _TxPins::AltFuncNumber(maskTx, GetAltFunctionNumber<_Regs>);
+
+            _RxPins::Enable();
+            Type maskRx(1 << rxPinNumber);
+            _RxPins::SetConfiguration(maskRx, _RxPins::AltFunc);
+            _RxPins::AltFuncNumber(maskRx, GetAltFunctionNumber<_Regs>);
+        }
+
+        /**
+         * @brief Template clone of SelectTxRxPins method
+         * 
+         * @tparam TxPinNumber pin number in Txs PinList
+         * @tparam RxPinNumber pin number in Rxs PinList
+         * 
+         * @par Returns
+         *	Nothing
+        */
+        template<typename _Regs, typename _FilterRegs, IRQn_Type _TxIrq, IRQn_Type _Rx0Irq, IRQn_Type _Rx1Irq, IRQn_Type _SceIrq, typename _ClockCtrl, typename _TxPins, typename _RxPins>
+        template<int8_t TxPinNumber, int8_t RxPinNumber>
+        void Can<_Regs, _FilterRegs, _TxIrq, _Rx0Irq, _Rx1Irq, _SceIrq, _ClockCtrl, _TxPins, _RxPins>::SelectTxRxPins()
+        {
+            using TxPin = typename _TxPins::template Pin<TxPinNumber>;
+            using RxPin = typename _RxPins::template Pin<RxPinNumber>;
+
+            using usedPorts = IO::PortList<typename TemplateUtils::Unique<TypeList<typename TxPin::Port, typename RxPin::Port>>::type>;
+
+            usedPorts::Enable();
+            TxPin::SetConfiguration(TxPin::Port::AltFunc);
+            TxPin::AltFuncNumber(GetAltFunctionNumber<_Regs>);
+            RxPin::SetConfiguration(RxPin::Port::AltFunc);
+            RxPin::AltFuncNumber(GetAltFunctionNumber<_Regs>);
+        }
+
+        /**
+         * @brief Template clone of SelectTxRxPins method (params are TPin instances)
+         * 
+         * @tparam TxPin TxPin
+         * @tparam RxPin RxPin
+         * 
+         * @par Returns
+         *	Nothing
+        */
+        template<typename _Regs, typename _FilterRegs, IRQn_Type _TxIrq, IRQn_Type _Rx0Irq, IRQn_Type _Rx1Irq, IRQn_Type _SceIrq, typename _ClockCtrl, typename _TxPins, typename _RxPins>
+        template<typename TxPin, typename RxPin>
+        void Can<_Regs, _FilterRegs, _TxIrq, _Rx0Irq, _Rx1Irq, _SceIrq, _ClockCtrl, _TxPins, _RxPins>::SelectTxRxPins()
+        {
+            const int8_t txPinIndex = TypeIndex<TxPin, typename _TxPins::PinsAsTypeList>::value;
+            const int8_t rxPinIndex = TypeIndex<RxPin, typename _RxPins::PinsAsTypeList>::value;
+            static_assert(txPinIndex >= 0);
+            static_assert(rxPinIndex >= 0);
+            SelectTxRxPins<txPinIndex, rxPinIndex>();
+        }
+
+        using Can1TxPins = IO::PinList<IO::Pa12, IO::Pb9, IO::Pd1>;
+        using Can1RxPins = IO::PinList<IO::Pa11, IO::Pb8, IO::Pd0>;
+
+        IO_STRUCT_WRAPPER(CAN1, Can1Regs, CAN_TypeDef);
+
+    #if defined (CAN2)
+        using Can2TxPins = IO::PinList<IO::Pb13, IO::Pb6>;
+        using Can2RxPins = IO::PinList<IO::Pb12, IO::Pb5>;
+
+        IO_STRUCT_WRAPPER(CAN2, Can2Regs, CAN_TypeDef);
+    #endif
+    }
+
+    using Can1 = Private::Can<Private::Can1Regs, Private::Can1Regs, CAN1_TX_IRQn, CAN1_RX0_IRQn, CAN1_RX1_IRQn, CAN1_SCE_IRQn, Clock::Can1Clock, Private::Can1TxPins, Private::Can1RxPins>;
+#if defined (CAN2)
+    using Can2 = Private::Can<Private::Can2Regs, Private::Can1Regs, CAN2_TX_IRQn, CAN2_RX0_IRQn, CAN2_RX1_IRQn, CAN2_SCE_IRQn, Clock::Can2Clock, Private::Can2TxPins, Private::Can2RxPins>;
+#endif
+}
+
+#endif //! CAN1
+
+#endif //! ZHELE_CAN_H
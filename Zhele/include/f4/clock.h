@@ -126,6 +126,83 @@ namespace Zhele::Clock
         }
     };
     
+#if defined (RCC_PLLI2SCFGR_PLLI2SN)
+    /**
+     * @brief Implements PLLI2S (I2S clock source)
+     *
+     * @details
+     * PLLI2S input is PLL source divided by PLLM (or by own PLLI2SM if MCU has it),
+     * output is input * PLLI2SN / PLLI2SR. Multiplier and divider should be set while PLLI2S is disabled.
+     */
+    class PllI2sClock : public ClockBase<>
+    {
+    public:
+        /**
+         * @brief Returns PLLI2S input frequence (PLL source divided by input divider)
+         *
+         * @returns Input frequence
+         */
+        static ClockFrequenceT SrcClockFreq();
+
+        /**
+         * @brief Returns PLLI2SN value
+         *
+         * @returns Multiplier
+         */
+        static ClockFrequenceT GetMultipler();
+
+        /**
+         * @brief Set PLLI2SN value
+         *
+         * @param [in] multiplier Multiplier (50...432)
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void SetMultiplier(ClockFrequenceT multiplier);
+
+        /**
+         * @brief Returns PLLI2SR value
+         *
+         * @returns Output divider
+         */
+        static ClockFrequenceT GetOutputDivider();
+
+        /**
+         * @brief Set PLLI2SR value
+         *
+         * @param [in] divider Output divider (2...7)
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void SetOutputDivider(ClockFrequenceT divider);
+
+        /**
+         * @brief Returns I2S clock frequence (PLLI2S R output)
+         *
+         * @returns I2S clock frequence
+         */
+        static ClockFrequenceT ClockFreq();
+
+        /**
+         * @brief Enables PLLI2S and selects it as I2S clock
+         *
+         * @retval true PLLI2S is ready
+         * @retval false PLLI2S is not locked (or PLL source is not ready)
+         */
+        static bool Enable();
+
+        /**
+         * @brief Disables PLLI2S
+         *
+         * @par Returns
+         *	Nothing
+         */
+        static void Disable();
+    };
+#endif
+
     IO_REG_WRAPPER(RCC->AHB1ENR, Ahb1ClockEnableReg, uint32_t);
     IO_REG_WRAPPER(RCC->AHB2ENR, Ahb2ClockEnableReg, uint32_t);
     IO_REG_WRAPPER(RCC->AHB3ENR, Ahb3ClockEnableReg, uint32_t);
@@ -166,7 +243,7 @@ namespace Zhele::Clock
         using CcmDataRamClock = ClockControl<Ahb1ClockEnableReg, RCC_AHB1ENR_CCMDATARAMEN, AhbClock>;
     #endif
     #if defined (RCC_AHB1ENR_DMA2DEN)
-        using Dma2Clock = ClockControl<Ahb1ClockEnableReg, RCC_AHB1ENR_DMA2DEN, AhbClock>;
+        using Dma2DClock = ClockControl<Ahb1ClockEnableReg, RCC_AHB1ENR_DMA2DEN, AhbClock>;
     #endif
     #if defined (RCC_AHB1ENR_ETHMACEN)
         using EthMacClock = ClockControl<Ahb1ClockEnableReg, RCC_AHB1ENR_ETHMACEN, AhbClock>;
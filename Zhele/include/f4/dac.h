@@ -12,6 +12,7 @@
 
 #include <stm32f4xx.h>
 #include "../common/dac.h"
+#include "timer.h"
 
 namespace Zhele
 {
@@ -27,6 +28,19 @@ namespace Zhele
         Exti9 = 0x06, ///< External line 9
         Software = 0x07 ///< Software trigger
     };
+
+#if defined (TIM2)
+    template <>
+    struct Private::DacTimerTrigger<Timers::Timer2> { static const DacTrigger Value = DacTrigger::Timer2Trgo; };
+#endif
+#if defined (TIM4)
+    template <>
+    struct Private::DacTimerTrigger<Timers::Timer4> { static const DacTrigger Value = DacTrigger::Timer4Trgo; };
+#endif
+
+    /// DAC DMA requests are mapped to channel 7 of DMA1 streams 5 (channel 1) and 6 (channel 2)
+    template <uint8_t _Channel>
+    struct Private::DacDmaRequest { static const uint8_t Value = 7; };
 }
 
 #endif //! ZHELE_DAC_H
\ No newline at end of file
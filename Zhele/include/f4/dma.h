@@ -46,6 +46,16 @@ namespace Zhele
             {
                 _DmaStream::Transfer(mode, buffer, periph, bufferSize, _DmaChannel);
             }
+
+            static void PingPongTransfer(DmaBase::Mode mode, void* buffer, volatile void* periph, uint32_t halfSize)
+            {
+                _DmaStream::PingPongTransfer(mode, buffer, periph, halfSize, _DmaChannel);
+            }
+
+            static void DoubleBufferTransfer(DmaBase::Mode mode, const void* buffer0, const void* buffer1, volatile void* periph, uint32_t bufferSize)
+            {
+                _DmaStream::DoubleBufferTransfer(mode, buffer0, buffer1, periph, bufferSize, _DmaChannel);
+            }
         };
     }        
 
@@ -103,4 +113,7 @@ namespace Zhele
     DECLARE_STREAM_CHANNELS(2, 7)
 }
 
+#include "../common/dma_arbiter.h"
+#include "../common/dma_memory.h"
+
 #endif //! ZHELE_DMA_H
\ No newline at end of file
@@ -0,0 +1,123 @@
+/**
+ * @file
+ * @brief Implements I2S for stm32f4 series
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_I2S_H
+#define ZHELE_I2S_H
+
+#include <stm32f4xx.h>
+
+#include "../common/i2s.h"
+
+#include "afio_bind.h"
+#include "clock.h"
+#include "dma.h"
+#include "spi.h"
+
+#if defined (RCC_PLLI2SCFGR_PLLI2SN)
+
+namespace Zhele
+{
+    namespace Private
+    {
+        template<typename _Regs, typename _ClockCtrl, typename _I2sClock, typename _SdPins, typename _CkPins, typename _WsPins, typename _MckPins, typename _DmaTx, typename _DmaRx>
+        void I2s<_Regs, _ClockCtrl, _I2sClock, _SdPins, _CkPins, _WsPins, _MckPins, _DmaTx, _DmaRx>::SelectPins(int8_t sdPinNumber, int8_t ckPinNumber, int8_t wsPinNumber, int8_t mckPinNumber)
+        {
+            using Type = typename _SdPins::DataType;
+
+            _SdPins::Enable();
+            Type maskSd(1 << sdPinNumber);
+            _SdPins::SetConfiguration(maskSd, _SdPins::AltFunc);
+            _SdPins::AltFuncNumber(maskSd, GetAltFunctionNumber<_Regs>);
+
+            _CkPins::Enable();
+            Type maskCk(1 << ckPinNumber);
+            _CkPins::SetConfiguration(maskCk, _CkPins::AltFunc);
+            _CkPins::AltFuncNumber(maskCk, GetAltFunctionNumber<_Regs>);
+
+            _WsPins::Enable();
+            Type maskWs(1 << wsPinNumber);
+            _WsPins::SetConfiguration(maskWs, _WsPins::AltFunc);
+            _WsPins::AltFuncNumber(maskWs, GetAltFunctionNumber<_Regs>);
+
+            if(mckPinNumber != -1)
+            {
+                _MckPins::Enable();
+                Type maskMck(1 << mckPinNumber);
+                _MckPins::SetConfiguration(maskMck, _MckPins::AltFunc);
+                _MckPins::AltFuncNumber(maskMck, GetAltFunctionNumber<_Regs>);
+            }
+        }
+
+        template<typename _Regs, typename _ClockCtrl, typename _I2sClock, typename _SdPins, typename _CkPins, typename _WsPins, typename _MckPins, typename _DmaTx, typename _DmaRx>
+        template<int8_t sdPinNumber, int8_t ckPinNumber, int8_t wsPinNumber, int8_t mckPinNumber>
+        void I2s<_Regs, _ClockCtrl, _I2sClock, _SdPins, _CkPins, _WsPins, _MckPins, _DmaTx, _DmaRx>::SelectPins()
+        {
+            using SdPin = typename _SdPins::template Pin<sdPinNumber>;
+            using CkPin = typename _CkPins::template Pin<ckPinNumber>;
+            using WsPin = typename _WsPins::template Pin<wsPinNumber>;
+            using MckPin = std::conditional_t<mckPinNumber != -1, typename _MckPins::template Pin<mckPinNumber>, typename IO::NullPin>;
+
+            using usedPorts = IO::PortList<typename TemplateUtils::Unique<TypeList<typename SdPin::Port, typename CkPin::Port, typename WsPin::Port, typename MckPin::Port>>::type>;
+            usedPorts::Enable();
+
+            SdPin::template SetConfiguration<SdPin::Port::AltFunc>();
+            SdPin::template AltFuncNumber<GetAltFunctionNumber<_Regs>>();
+
+            CkPin::template SetConfiguration<CkPin::Port::AltFunc>();
+            CkPin::template SetDriverType<CkPin::DriverType::PushPull>();
+            CkPin::template AltFuncNumber<GetAltFunctionNumber<_Regs>>();
+
+            WsPin::template SetConfiguration<WsPin::Port::AltFunc>();
+            WsPin::template SetDriverType<WsPin::DriverType::PushPull>();
+            WsPin::template AltFuncNumber<GetAltFunctionNumber<_Regs>>();
+
+            if constexpr(mckPinNumber != -1)
+            {
+                MckPin::template SetConfiguration<MckPin::Port::AltFunc>();
+                MckPin::template SetDriverType<MckPin::DriverType::PushPull>();
+                MckPin::template AltFuncNumber<GetAltFunctionNumber<_Regs>>();
+            }
+        }
+
+        using I2s2SdPins = IO::PinList<IO::Pb15, IO::Pc3>;
+        using I2s2CkPins = IO::PinList<IO::Pb13, IO::Pb10>;
+        using I2s2WsPins = IO::PinList<IO::Pb12, IO::Pb9>;
+        using I2s2MckPins = IO::PinList<IO::Pc6>;
+
+        using I2s3SdPins = IO::PinList<IO::Pb5, IO::Pc12>;
+        using I2s3CkPins = IO::PinList<IO::Pb3, IO::Pc10>;
+        using I2s3WsPins = IO::PinList<IO::Pa4, IO::Pa15>;
+        using I2s3MckPins = IO::PinList<IO::Pc7>;
+    }
+
+    using I2s2 = Private::I2s<
+        Private::Spi2Regs,
+        Clock::Spi2Clock,
+        Clock::PllI2sClock,
+        Private::I2s2SdPins,
+        Private::I2s2CkPins,
+        Private::I2s2WsPins,
+        Private::I2s2MckPins,
+        Dma1Stream4Channel0,
+        Dma1Stream3Channel0>;
+
+    using I2s3 = Private::I2s<
+        Private::Spi3Regs,
+        Clock::Spi3Clock,
+        Clock::PllI2sClock,
+        Private::I2s3SdPins,
+        Private::I2s3CkPins,
+        Private::I2s3WsPins,
+        Private::I2s3MckPins,
+        Dma1Stream5Channel0,
+        Dma1Stream0Channel0>;
+}
+
+#endif //! RCC_PLLI2SCFGR_PLLI2SN
+
+#endif //! ZHELE_I2S_H
@@ -0,0 +1,17 @@
+/**
+ * @file
+ * United header for FSMC
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @licence FreeBSD
+ */
+
+#if defined(STM32F1)
+    #include <stm32f1xx.h>
+#endif
+#if defined(STM32F4)
+    #include <stm32f4xx.h>
+#endif
+
+#include <common/fsmc.h>
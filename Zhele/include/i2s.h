@@ -0,0 +1,10 @@
+/**
+ * @file
+ * United header for I2S
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+#if defined(STM32F4)
+    #include <f4/i2s.h>
+#endif
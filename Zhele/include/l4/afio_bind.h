@@ -20,25 +20,29 @@
 namespace Zhele::Private
 {
     // USART
-    class Usart1Regs; class Usart2Regs; class Usart3Regs; class Uart4Regs; class Uart5Regs; class Usart6Regs;
+    class Usart1Regs; class Usart2Regs; class Usart3Regs; class Uart4Regs; class Uart5Regs; class Usart6Regs; class LpUart1Regs;
     // SPI
     class Spi1Regs; class Spi2Regs; class Spi3Regs;
     // I2C
     class I2C1Regs; class I2C2Regs; class I2C3Regs; 
     // USB
     class UsbRegs;
+    // QUADSPI
+    class QuadSpiRegs;
 
     using Regs = Zhele::TemplateUtils::TypeList<
-        Usart1Regs, Usart2Regs, Usart3Regs, Uart4Regs, Uart5Regs, Usart6Regs, // Usart
+        Usart1Regs, Usart2Regs, Usart3Regs, Uart4Regs, Uart5Regs, Usart6Regs, LpUart1Regs, // Usart
         Spi1Regs, Spi2Regs, Spi3Regs, // SPI
         I2C1Regs, I2C2Regs, I2C3Regs, // I2C
-        UsbRegs // USB_FS
+        UsbRegs, // USB_FS
+        QuadSpiRegs // QUADSPI
     >;
     using AltFunctionNumbers = Zhele::TemplateUtils::NonTypeTemplateArray<
-        7, 7, 7, 8, 8, 8, // Usart
+        7, 7, 7, 8, 8, 8, 8, // Usart
         5, 5, 6, // SPI
         4, 4, 4, // I2C
-        10 // USB_FS
+        10, // USB_FS
+        10 // QUADSPI
     >;
 
     template <typename _Regs>
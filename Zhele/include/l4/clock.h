@@ -126,6 +126,41 @@ namespace Zhele::Clock
         }
     };
     
+    /**
+     * @brief Implements LPUART1 kernel clock (LPUART1SEL)
+     */
+    class LpUart1ClockSource
+    {
+    public:
+        /**
+         * @brief LPUART1 clock sources
+         */
+        enum ClockSource
+        {
+            Apb1 = 0, ///< APB1 clock (PCLK1, default)
+            System = RCC_CCIPR_LPUART1SEL_0, ///< System clock
+            Hsi = RCC_CCIPR_LPUART1SEL_1, ///< HSI16 (works in Stop 0 and Stop 1 modes)
+            Lse = RCC_CCIPR_LPUART1SEL_0 | RCC_CCIPR_LPUART1SEL_1, ///< LSE (works in all Stop modes, 9600 baud max)
+        };
+
+        /**
+         * @brief Select LPUART1 clock source (source oscillator is enabled if it is off)
+         * 
+         * @param [in] source Clock source
+         * 
+         * @retval true Clock source is ready
+         * @retval false Oscillator start timeout
+         */
+        static bool SelectClockSource(ClockSource source);
+
+        /**
+         * @brief Returns LPUART1 clock frequence
+         * 
+         * @returns Clock frequence
+         */
+        static ClockFrequenceT ClockFreq();
+    };
+
     IO_REG_WRAPPER(RCC->AHB1ENR, Ahb1ClockEnableReg, uint32_t);
     IO_REG_WRAPPER(RCC->AHB2ENR, Ahb2ClockEnableReg, uint32_t);
     IO_REG_WRAPPER(RCC->AHB3ENR, Ahb3ClockEnableReg, uint32_t);
@@ -161,7 +196,7 @@ namespace Zhele::Clock
     using PwrClock = ClockControl<PeriphClockEnable11, RCC_APB1ENR1_PWREN, Apb1Clock>;
     using OpampClock = ClockControl<PeriphClockEnable11, RCC_APB1ENR1_OPAMPEN, Apb1Clock>;
     using LPTim1Clock = ClockControl<PeriphClockEnable11, RCC_APB1ENR1_LPTIM1EN, Apb1Clock>;
-    using LpUart1Clock = ClockControl<PeriphClockEnable12, RCC_APB1ENR2_LPUART1EN, Apb1Clock>;
+    using LpUart1Clock = ClockControl<PeriphClockEnable12, RCC_APB1ENR2_LPUART1EN, LpUart1ClockSource>;
     using LpTim2Clock = ClockControl<PeriphClockEnable12, RCC_APB1ENR2_LPTIM2EN, Apb1Clock>;
 
     using SysCfgCompClock = ClockControl<PeriphClockEnable2, RCC_APB2ENR_SYSCFGEN, Apb2Clock>;
@@ -221,16 +256,16 @@ namespace Zhele::Clock
         using GFXMMUClock = ClockControl<Ahb1ClockEnableReg, RCC_AHB1ENR_GFXMMUEN, AhbClock>;
     #endif
     #if defined (RCC_AHB3ENR_FMCEN)
-        using FmcClock = ClockControl<Ahb2ClockEnableReg, RCC_AHB3ENR_FMCEN, AhbClock>;
+        using FmcClock = ClockControl<Ahb3ClockEnableReg, RCC_AHB3ENR_FMCEN, AhbClock>;
     #endif
     #if defined (RCC_AHB3ENR_OSPI1EN)
-        using OSPI1Clock = ClockControl<Ahb2ClockEnableReg, RCC_AHB3ENR_OSPI1EN, AhbClock>;
+        using OSPI1Clock = ClockControl<Ahb3ClockEnableReg, RCC_AHB3ENR_OSPI1EN, AhbClock>;
     #endif
     #if defined (RCC_AHB3ENR_OSPI2EN)
-        using OSPI2Clock = ClockControl<Ahb2ClockEnableReg, RCC_AHB3ENR_OSPI2EN, AhbClock>;
+        using OSPI2Clock = ClockControl<Ahb3ClockEnableReg, RCC_AHB3ENR_OSPI2EN, AhbClock>;
     #endif    
     #if defined (RCC_AHB3ENR_QSPIEN)
-        using QSPIClock = ClockControl<Ahb2ClockEnableReg, RCC_AHB3ENR_QSPIEN, AhbClock>;
+        using QSPIClock = ClockControl<Ahb3ClockEnableReg, RCC_AHB3ENR_QSPIEN, AhbClock>;
     #endif
 
     #if defined (RCC_APB1ENR1_RTCAPBEN)
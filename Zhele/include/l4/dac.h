@@ -12,6 +12,7 @@
 
 #include <stm32l4xx.h>
 #include "../common/dac.h"
+#include "timer.h"
 
 namespace Zhele
 {
@@ -27,6 +28,21 @@ namespace Zhele
         Exti9 = 0x06, ///< External line 9
         Software = 0x07 ///< Software trigger
     };
+
+#if defined (TIM2)
+    template <>
+    struct Private::DacTimerTrigger<Timers::Timer2> { static const DacTrigger Value = DacTrigger::Timer2Trgo; };
+#endif
+#if defined (TIM4)
+    template <>
+    struct Private::DacTimerTrigger<Timers::Timer4> { static const DacTrigger Value = DacTrigger::Timer4Trgo; };
+#endif
+
+    /// DAC requests for DMA1 channels 3 (channel 1) and 4 (channel 2)
+    template <>
+    struct Private::DacDmaRequest<0> { static const uint8_t Value = 6; };
+    template <>
+    struct Private::DacDmaRequest<1> { static const uint8_t Value = 5; };
 }
 
 #endif //! ZHELE_DAC_H
\ No newline at end of file
@@ -97,4 +97,7 @@ namespace Zhele
     DECLARE_STREAM_CHANNELS(2, 7)
 }
 
+#include "../common/dma_arbiter.h"
+#include "../common/dma_memory.h"
+
 #endif //! ZHELE_DMA_H
\ No newline at end of file
@@ -92,6 +92,30 @@ namespace Zhele
     #if defined (I2C3)
         IO_STRUCT_WRAPPER(I2C3, I2C3Regs, I2C_TypeDef);
     #endif
+
+        #if defined (SYSCFG_CFGR1_I2C1_FMP)
+        template<>
+        struct I2cFastModePlusDrive<I2C1Regs>
+        {
+            static const uint32_t Mask = SYSCFG_CFGR1_I2C1_FMP;
+        };
+        #endif
+        #if defined (SYSCFG_CFGR1_I2C2_FMP)
+        template<>
+        struct I2cFastModePlusDrive<I2C2Regs>
+        {
+            static const uint32_t Mask = SYSCFG_CFGR1_I2C2_FMP;
+        };
+        #endif
+    #if defined (I2C3)
+        #if defined (SYSCFG_CFGR1_I2C3_FMP)
+        template<>
+        struct I2cFastModePlusDrive<I2C3Regs>
+        {
+            static const uint32_t Mask = SYSCFG_CFGR1_I2C3_FMP;
+        };
+        #endif
+    #endif
     }
         using I2c1 = Private::I2cBase<Private::I2C1Regs, I2C1_EV_IRQn, I2C1_ER_IRQn, Clock::I2c1Clock, Private::I2C1SclPins, Private::I2C1SdaPins, Dma1Stream6Channel3, Dma1Stream7Channel3>;
         using I2c2 = Private::I2cBase<Private::I2C2Regs, I2C2_EV_IRQn, I2C2_ER_IRQn, Clock::I2c2Clock, Private::I2C2SclPins, Private::I2C2SdaPins, Dma1Stream4Channel3, Dma1Stream4Channel3>;
@@ -100,4 +124,6 @@ namespace Zhele
     #endif
 }
 
+#include "../common/i2c_queue.h"
+
 #endif //! ZHELE_I2C_H
\ No newline at end of file
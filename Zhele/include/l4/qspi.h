@@ -0,0 +1,155 @@
+/**
+ * @file
+ * @brief Implements QUADSPI for stm32l4 series
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#ifndef ZHELE_QSPI_H
+#define ZHELE_QSPI_H
+
+#include <stm32l4xx.h>
+
+#if defined (QUADSPI)
+
+#include "../common/qspi.h"
+
+#include "afio_bind.h"
+#include "clock.h"
+#include "dma.h"
+
+namespace Zhele
+{
+    namespace Private
+    {
+        template<typename _Regs, typename _ClockCtrl, typename _ClkPins, typename _NcsPins, typename _Io0Pins, typename _Io1Pins, typename _Io2Pins, typename _Io3Pins, typename _Dma, IRQn_Type _IRQNumber>
+        void Qspi<_Regs, _ClockCtrl, _ClkPins, _NcsPins, _Io0Pins, _Io1Pins, _Io2Pins, _Io3Pins, _Dma, _IRQNumber>::SelectPins(int8_t clkPinNumber, int8_t ncsPinNumber, int8_t io0PinNumber, int8_t io1PinNumber, int8_t io2PinNumber, int8_t io3PinNumber)
+        {
+            using Type = typename _ClkPins::DataType;
+
+            _ClkPins::Enable();
+            Type maskClk(1 << clkPinNumber);
+            _ClkPins::SetConfiguration(maskClk, _ClkPins::AltFunc);
+            _ClkPins::SetSpeed(maskClk, _ClkPins::Speed::Fastest);
+            _ClkPins::AltFuncNumber(maskClk, GetAltFunctionNumber<_Regs>);
+
+            _NcsPins::Enable();
+            Type maskNcs(1 << ncsPinNumber);
+            _NcsPins::SetConfiguration(maskNcs, _NcsPins::AltFunc);
+            _NcsPins::SetSpeed(maskNcs, _NcsPins::Speed::Fastest);
+            _NcsPins::AltFuncNumber(maskNcs, GetAltFunctionNumber<_Regs>);
+
+            _Io0Pins::Enable();
+            Type maskIo0(1 << io0PinNumber);
+            _Io0Pins::SetConfiguration(maskIo0, _Io0Pins::AltFunc);
+            _Io0Pins::SetSpeed(maskIo0, _Io0Pins::Speed::Fastest);
+            _Io0Pins::AltFuncNumber(maskIo0, GetAltFunctionNumber<_Regs>);
+
+            _Io1Pins::Enable();
+            Type maskIo1(1 << io1PinNumber);
+            _Io1Pins::SetConfiguration(maskIo1, _Io1Pins::AltFunc);
+            _Io1Pins::SetSpeed(maskIo1, _Io1Pins::Speed::Fastest);
+            _Io1Pins::AltFuncNumber(maskIo1, GetAltFunctionNumber<_Regs>);
+
+            if(io2PinNumber != -1)
+            {
+                _Io2Pins::Enable();
+                Type maskIo2(1 << io2PinNumber);
+                _Io2Pins::SetConfiguration(maskIo2, _Io2Pins::AltFunc);
+                _Io2Pins::SetSpeed(maskIo2, _Io2Pins::Speed::Fastest);
+                _Io2Pins::AltFuncNumber(maskIo2, GetAltFunctionNumber<_Regs>);
+            }
+
+            if(io3PinNumber != -1)
+            {
+                _Io3Pins::Enable();
+                Type maskIo3(1 << io3PinNumber);
+                _Io3Pins::SetConfiguration(maskIo3, _Io3Pins::AltFunc);
+                _Io3Pins::SetSpeed(maskIo3, _Io3Pins::Speed::Fastest);
+                _Io3Pins::AltFuncNumber(maskIo3, GetAltFunctionNumber<_Regs>);
+            }
+        }
+
+        template<typename _Regs, typename _ClockCtrl, typename _ClkPins, typename _NcsPins, typename _Io0Pins, typename _Io1Pins, typename _Io2Pins, typename _Io3Pins, typename _Dma, IRQn_Type _IRQNumber>
+        template<int8_t clkPinNumber, int8_t ncsPinNumber, int8_t io0PinNumber, int8_t io1PinNumber, int8_t io2PinNumber, int8_t io3PinNumber>
+        void Qspi<_Regs, _ClockCtrl, _ClkPins, _NcsPins, _Io0Pins, _Io1Pins, _Io2Pins, _Io3Pins, _Dma, _IRQNumber>::SelectPins()
+        {
+            using ClkPin = typename _ClkPins::template Pin<clkPinNumber>;
+            using NcsPin = typename _NcsPins::template Pin<ncsPinNumber>;
+            using Io0Pin = typename _Io0Pins::template Pin<io0PinNumber>;
+            using Io1Pin = typename _Io1Pins::template Pin<io1PinNumber>;
+            using Io2Pin = std::conditional_t<io2PinNumber != -1, typename _Io2Pins::template Pin<io2PinNumber>, typename IO::NullPin>;
+            using Io3Pin = std::conditional_t<io3PinNumber != -1, typename _Io3Pins::template Pin<io3PinNumber>, typename IO::NullPin>;
+
+            using usedPorts = IO::PortList<typename TemplateUtils::Unique<TypeList<typename ClkPin::Port, typename NcsPin::Port, typename Io0Pin::Port,
+                typename Io1Pin::Port, typename Io2Pin::Port, typename Io3Pin::Port>>::type>;
+            usedPorts::Enable();
+
+            ClkPin::template SetConfiguration<ClkPin::Port::AltFunc>();
+            ClkPin::template SetSpeed<ClkPin::Speed::Fastest>();
+            ClkPin::template AltFuncNumber<GetAltFunctionNumber<_Regs>>();
+
+            NcsPin::template SetConfiguration<NcsPin::Port::AltFunc>();
+            NcsPin::template SetSpeed<NcsPin::Speed::Fastest>();
+            NcsPin::template AltFuncNumber<GetAltFunctionNumber<_Regs>>();
+
+            Io0Pin::template SetConfiguration<Io0Pin::Port::AltFunc>();
+            Io0Pin::template SetSpeed<Io0Pin::Speed::Fastest>();
+            Io0Pin::template AltFuncNumber<GetAltFunctionNumber<_Regs>>();
+
+            Io1Pin::template SetConfiguration<Io1Pin::Port::AltFunc>();
+            Io1Pin::template SetSpeed<Io1Pin::Speed::Fastest>();
+            Io1Pin::template AltFuncNumber<GetAltFunctionNumber<_Regs>>();
+
+            if constexpr(io2PinNumber != -1)
+            {
+                Io2Pin::template SetConfiguration<Io2Pin::Port::AltFunc>();
+                Io2Pin::template SetSpeed<Io2Pin::Speed::Fastest>();
+                Io2Pin::template AltFuncNumber<GetAltFunctionNumber<_Regs>>();
+            }
+
+            if constexpr(io3PinNumber != -1)
+            {
+                Io3Pin::template SetConfiguration<Io3Pin::Port::AltFunc>();
+                Io3Pin::template SetSpeed<Io3Pin::Speed::Fastest>();
+                Io3Pin::template AltFuncNumber<GetAltFunctionNumber<_Regs>>();
+            }
+        }
+
+        IO_STRUCT_WRAPPER(QUADSPI, QuadSpiRegs, QUADSPI_TypeDef);
+
+    #if defined (GPIOE)
+        using QspiClkPins = IO::PinList<IO::Pa3, IO::Pb10, IO::Pe10>;
+        using QspiNcsPins = IO::PinList<IO::Pa2, IO::Pb11, IO::Pe11>;
+        using QspiIo0Pins = IO::PinList<IO::Pb1, IO::Pe12>;
+        using QspiIo1Pins = IO::PinList<IO::Pb0, IO::Pe13>;
+        using QspiIo2Pins = IO::PinList<IO::Pa7, IO::Pe14>;
+        using QspiIo3Pins = IO::PinList<IO::Pa6, IO::Pe15>;
+    #else
+        using QspiClkPins = IO::PinList<IO::Pa3, IO::Pb10>;
+        using QspiNcsPins = IO::PinList<IO::Pa2, IO::Pb11>;
+        using QspiIo0Pins = IO::PinList<IO::Pb1>;
+        using QspiIo1Pins = IO::PinList<IO::Pb0>;
+        using QspiIo2Pins = IO::PinList<IO::Pa7>;
+        using QspiIo3Pins = IO::PinList<IO::Pa6>;
+    #endif
+    }
+
+    // QUADSPI DMA request: DMA2 channel 7 (CSELR = 3), DMA1 channel 5 is used by SPI2 TX
+    using Qspi = Private::Qspi<
+        Private::QuadSpiRegs,
+        Clock::QSPIClock,
+        Private::QspiClkPins,
+        Private::QspiNcsPins,
+        Private::QspiIo0Pins,
+        Private::QspiIo1Pins,
+        Private::QspiIo2Pins,
+        Private::QspiIo3Pins,
+        Dma2Stream7Channel3,
+        QUADSPI_IRQn>;
+}
+
+#endif //! QUADSPI
+
+#endif //! ZHELE_QSPI_H
@@ -12,6 +12,7 @@
 #include <stm32l4xx.h>
 
 #include "../common/usart.h"
+#include "../common/lpuart.h"
 
 #include "afio_bind.h"
 #include "clock.h"
@@ -119,6 +120,9 @@ namespace Zhele
         using Usart6TxPins = IO::PinList<IO::Pc6>;
         using Usart6RxPins = IO::PinList<IO::Pc7>;
 
+        using LpUart1TxPins = IO::PinList<IO::Pb11, IO::Pc1>;
+        using LpUart1RxPins = IO::PinList<IO::Pb10, IO::Pc0>;
+
         IO_STRUCT_WRAPPER(USART1, Usart1Regs, USART_TypeDef);
         IO_STRUCT_WRAPPER(USART2, Usart2Regs, USART_TypeDef);
     #if defined(USART3)
@@ -133,6 +137,9 @@ namespace Zhele
     #if defined(USART6)
         IO_STRUCT_WRAPPER(USART6, Usart6Regs, USART_TypeDef);
     #endif
+    #if defined(LPUART1)
+        IO_STRUCT_WRAPPER(LPUART1, LpUart1Regs, USART_TypeDef);
+    #endif
     }
     using Usart1 = Private::Usart<Private::Usart1Regs, USART1_IRQn, Clock::Usart1Clock, Private::Usart1TxPins, Private::Usart1RxPins, Dma1Stream4Channel2, Dma1Stream5Channel2>;
     using Usart2 = Private::Usart<Private::Usart2Regs, USART2_IRQn, Clock::Usart2Clock, Private::Usart2TxPins, Private::Usart2RxPins, Dma1Stream7Channel2, Dma1Stream6Channel2>;
@@ -145,6 +152,9 @@ namespace Zhele
 #if defined(UART5)
     using Uart5 = Private::Usart<Private::Uart5Regs, UART5_IRQn, Clock::Uart5Clock, Private::Uart5TxPins, Private::Uart5RxPins, Dma2Stream1Channel2, Dma2Stream1Channel2>;
 #endif
+#if defined(LPUART1)
+    using LpUart1 = Private::LpUart<Private::LpUart1Regs, LPUART1_IRQn, Clock::LpUart1Clock, Private::LpUart1TxPins, Private::LpUart1RxPins, Dma2Stream6Channel4, Dma2Stream7Channel4>;
+#endif
 }
 
 #endif //! ZHELE_USART_H
\ No newline at end of file
@@ -0,0 +1,10 @@
+/**
+ * @file
+ * United header for QUADSPI
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+#if defined(STM32L4)
+    #include <l4/qspi.h>
+#endif
@@ -0,0 +1,24 @@
+/**
+ * @file
+ * United header for hardware RNG
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @licence FreeBSD
+ */
+
+#if defined(STM32F0)
+    #include <stm32f0xx.h>
+#endif
+#if defined(STM32F1)
+    #include <stm32f1xx.h>
+#endif
+#if defined(STM32F4)
+    #include <stm32f4xx.h>
+#endif
+#if defined(STM32L4)
+    #include <stm32l4xx.h>
+#endif
+
+
+#include <common/rng.h>
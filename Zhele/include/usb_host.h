@@ -0,0 +1,18 @@
+/**
+ * @file
+ * United header for USB OTG host (MSC host class)
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @licence FreeBSD
+ */
+
+#if defined(STM32F4)
+    #include <stm32f4xx.h>
+#endif
+#if defined(STM32L4)
+    #include <stm32l4xx.h>
+#endif
+
+#include <common/usb/host.h>
+#include <common/usb/msc_host.h>
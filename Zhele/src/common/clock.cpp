@@ -148,7 +148,13 @@ namespace Zhele::Clock
             return InvalidClockSource;
         }
 
-        Flash::ConfigureFrequence(sourceFrequence);
+        // Flash is clocked by HCLK: wait states are increased before frequence increase
+        // and decreased only after switch (frequence decrease)
+        ClockFrequenceT currentFrequence = AhbClock::ClockFreq();
+        ClockFrequenceT ahbDivider = currentFrequence != 0 ? SysClock::ClockFreq() / currentFrequence : 1;
+        ClockFrequenceT targetFrequence = sourceFrequence / ahbDivider;
+        if(targetFrequence >= currentFrequence)
+            Flash::ConfigureFrequence(targetFrequence);
 
         RCC->CFGR = (RCC->CFGR & ~RCC_CFGR_SW) | clockSelectMask;
         
@@ -159,6 +165,8 @@ namespace Zhele::Clock
         {
             return ClockSelectFailed;
         }
+        if(targetFrequence < currentFrequence)
+            Flash::ConfigureFrequence(targetFrequence);
         return Success;
     }
 
@@ -0,0 +1,80 @@
+/**
+ * @file
+ * Implements clock scaling methods.
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#include <common/clock_scaling.h>
+
+namespace Zhele::Clock
+{
+    static ClockScaling::Callback subscribers[ZHELE_CLOCK_SCALING_SUBSCRIBERS];
+
+    bool ClockScaling::Subscribe(Callback callback)
+    {
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        Callback* slot = nullptr;
+        for(auto& subscriber : subscribers)
+        {
+            if(subscriber == callback)
+            {
+                __set_PRIMASK(primask);
+                return true;
+            }
+            if(subscriber == nullptr && slot == nullptr)
+                slot = &subscriber;
+        }
+        if(slot != nullptr)
+            *slot = callback;
+        __set_PRIMASK(primask);
+        return slot != nullptr;
+    }
+
+    void ClockScaling::Unsubscribe(Callback callback)
+    {
+        for(auto& subscriber : subscribers)
+        {
+            if(subscriber == callback)
+                subscriber = nullptr;
+        }
+    }
+
+    SysClock::ErrorCode ClockScaling::SelectClockSource(SysClock::ClockSource source)
+    {
+        SysClock::ErrorCode result = SysClock::SelectClockSource(source);
+        if(result == SysClock::Success)
+            NotifyClockChanged();
+        return result;
+    }
+
+    void ClockScaling::SetAhbPrescaler(AhbClock::Prescaler prescaler)
+    {
+        // HPRE codes are the same for all series: 0xxx - no divide, 1000...1111 - 2...512 (32 is skipped)
+        const uint8_t prescalerShift[] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 3, 4, 6, 7, 8, 9};
+        ClockFrequenceT current = AhbClock::ClockFreq();
+        ClockFrequenceT target = SysClock::ClockFreq() >> prescalerShift[static_cast<uint32_t>(prescaler) & 0x0f];
+
+        // Wait states are increased before frequence increase and decreased after frequence decrease
+        if(target > current)
+            Flash::ConfigureFrequence(target);
+        AhbClock::SetPrescaler(prescaler);
+        if(target < current)
+            Flash::ConfigureFrequence(target);
+
+        NotifyClockChanged();
+    }
+
+    void ClockScaling::NotifyClockChanged()
+    {
+        SystemCoreClock = AhbClock::ClockFreq();
+        for(auto subscriber : subscribers)
+        {
+            if(subscriber != nullptr)
+                subscriber();
+        }
+    }
+}
@@ -0,0 +1,81 @@
+/**
+ * @file
+ * Implements fixed-point statistics kernels.
+ *
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#include <common/dsp.h>
+
+namespace Zhele::Dsp
+{
+    uint32_t SquareRoot(uint64_t value)
+    {
+        uint64_t result = 0;
+        uint64_t bit = 1ull << 62;
+        while (bit > value)
+            bit >>= 2;
+        while (bit != 0)
+        {
+            if (value >= result + bit)
+            {
+                value -= result + bit;
+                result = (result >> 1) + bit;
+            }
+            else
+            {
+                result >>= 1;
+            }
+            bit >>= 2;
+        }
+        return static_cast<uint32_t>(result);
+    }
+
+    Q15 Mean(const Q15* data, unsigned count)
+    {
+        int64_t sum = 0;
+        for (unsigned i = 0; i < count; ++i)
+            sum += data[i];
+        return static_cast<Q15>(sum / static_cast<int32_t>(count));
+    }
+
+    Q31 Mean(const Q31* data, unsigned count)
+    {
+        int64_t sum = 0;
+        for (unsigned i = 0; i < count; ++i)
+            sum += data[i];
+        return static_cast<Q31>(sum / static_cast<int32_t>(count));
+    }
+
+    Q15 Rms(const Q15* data, unsigned count)
+    {
+        int64_t sum = 0;
+        unsigned i = 0;
+#if ZHELE_DSP_SIMD
+        for (; i + 2 <= count; i += 2)
+        {
+            uint32_t pair = Private::Load2(&data[i]);
+            sum = Private::DualMacLong(pair, pair, sum);
+        }
+#endif
+        for (; i < count; ++i)
+            sum += static_cast<int32_t>(data[i]) * data[i];
+
+        // Mean of squares is Q30, its root is Q15
+        uint32_t rms = SquareRoot(static_cast<uint64_t>(sum) / count);
+        return static_cast<Q15>(rms > 32767 ? 32767 : rms);
+    }
+
+    Q31 Rms(const Q31* data, unsigned count)
+    {
+        uint64_t sum = 0;
+        for (unsigned i = 0; i < count; ++i)
+            sum += static_cast<uint64_t>(static_cast<int64_t>(data[i]) * data[i]) >> 31;
+
+        // Mean of squares is Q31, root of Q62 value is Q31
+        uint32_t rms = SquareRoot((sum / count) << 31);
+        return static_cast<Q31>(rms > INT32_MAX ? INT32_MAX : rms);
+    }
+}
@@ -0,0 +1,111 @@
+/**
+ * @file
+ * Implements stack watermark and interrupts load meter.
+ * 
+ * @author Aleksei Zhelonkin
+ * @date 2024
+ * @license FreeBSD
+ */
+
+#include <common/profiler.h>
+
+namespace Zhele
+{
+    uint32_t* StackWatermark::Bottom()
+    {
+        return reinterpret_cast<uint32_t*>(ZHELE_STACK_TOP - ZHELE_STACK_SIZE);
+    }
+
+    uint32_t* StackWatermark::Top()
+    {
+        return reinterpret_cast<uint32_t*>(ZHELE_STACK_TOP);
+    }
+
+    void StackWatermark::Fill()
+    {
+        // Stack below SP is free (interrupts push frames below SP and pop them before return)
+        uint32_t* end = reinterpret_cast<uint32_t*>((__get_MSP() - Margin) & ~3u);
+        for(uint32_t* word = Bottom(); word < end; ++word)
+            *word = Pattern;
+    }
+
+    uintptr_t StackWatermark::Used()
+    {
+        uint32_t* word = Bottom();
+        while(word < Top() && *word == Pattern)
+            ++word;
+        return reinterpret_cast<uintptr_t>(Top()) - reinterpret_cast<uintptr_t>(word);
+    }
+
+    uintptr_t StackWatermark::Free()
+    {
+        return Size() - Used();
+    }
+
+    uintptr_t StackWatermark::Size()
+    {
+        return ZHELE_STACK_SIZE;
+    }
+
+#if defined (DWT)
+    uint32_t IsrLoadMeter::_windowStart = 0;
+    uint64_t IsrLoadMeter::_totalCycles = 0;
+    uint32_t IsrLoadMeter::_nestedCycles = 0;
+
+    void IsrLoadMeter::Enable()
+    {
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+        Reset();
+    }
+
+    void IsrLoadMeter::Reset()
+    {
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        _windowStart = DWT->CYCCNT;
+        _totalCycles = 0;
+        __set_PRIMASK(primask);
+    }
+
+    uint32_t IsrLoadMeter::WindowCycles()
+    {
+        return DWT->CYCCNT - _windowStart;
+    }
+
+    uint32_t IsrLoadMeter::Load()
+    {
+        return ToLoad(_totalCycles);
+    }
+
+    uint32_t IsrLoadMeter::ToLoad(uint64_t cycles)
+    {
+        uint32_t window = WindowCycles();
+        return window != 0 ? static_cast<uint32_t>(cycles * 1000 / window) : 0;
+    }
+
+    uint64_t IsrLoadMeter::Enter()
+    {
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        // Context: entry timestamp and nested cycles of preempted handler
+        uint64_t context = (static_cast<uint64_t>(_nestedCycles) << 32) | DWT->CYCCNT;
+        _nestedCycles = 0;
+        __set_PRIMASK(primask);
+        return context;
+    }
+
+    uint32_t IsrLoadMeter::Exit(uint64_t context)
+    {
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        uint32_t elapsed = DWT->CYCCNT - static_cast<uint32_t>(context);
+        uint32_t own = elapsed - _nestedCycles;
+        _totalCycles += own;
+        // Whole handler time (with nested handlers) is excluded from preempted handler
+        _nestedCycles = static_cast<uint32_t>(context >> 32) + elapsed;
+        __set_PRIMASK(primask);
+        return own;
+    }
+#endif
+}
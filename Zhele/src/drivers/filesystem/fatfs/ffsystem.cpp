@@ -5,6 +5,7 @@
 
 
 #include <drivers/filesystem/fatfs/ff.h>
+#include <drivers/filesystem/fatfs_lock.h>
 
 
 #if FF_USE_LFN == 3	/* Dynamic memory allocation */
@@ -36,45 +37,32 @@ void ff_memfree (
 
 
 
+/*------------------------------------------------------------------------*/
+/* Volume locks (Zhele::Drivers::Filesystem::FatFsLock)                   */
+/*------------------------------------------------------------------------*/
+
+std::atomic<bool> Zhele::Drivers::Filesystem::FatFsLock::_locked[FF_VOLUMES] {};
+std::atomic<unsigned> Zhele::Drivers::Filesystem::FatFsLock::_contentions {0};
+
+
 #if FF_FS_REENTRANT	/* Mutal exclusion */
 
 /*------------------------------------------------------------------------*/
 /* Create a Synchronization Object                                        */
 /*------------------------------------------------------------------------*/
 /* This function is called in f_mount() function to create a new
-/  synchronization object for the volume, such as semaphore and mutex.
+/  synchronization object for the volume. Sync object is volume number.
 /  When a 0 is returned, the f_mount() function fails with FR_INT_ERR.
 */
 
-//const osMutexDef_t Mutex[FF_VOLUMES];	/* Table of CMSIS-RTOS mutex */
-
-
 int ff_cre_syncobj (	/* 1:Function succeeded, 0:Could not create the sync object */
 	BYTE vol,			/* Corresponding volume (logical drive number) */
 	FF_SYNC_t* sobj		/* Pointer to return the created sync object */
 )
 {
-	/* Win32 */
-	*sobj = CreateMutex(NULL, FALSE, NULL);
-	return (int)(*sobj != INVALID_HANDLE_VALUE);
-
-	/* uITRON */
-//	T_CSEM csem = {TA_TPRI,1,1};
-//	*sobj = acre_sem(&csem);
-//	return (int)(*sobj > 0);
-
-	/* uC/OS-II */
-//	OS_ERR err;
-//	*sobj = OSMutexCreate(0, &err);
-//	return (int)(err == OS_NO_ERR);
-
-	/* FreeRTOS */
-//	*sobj = xSemaphoreCreateMutex();
-//	return (int)(*sobj != NULL);
-
-	/* CMSIS-RTOS */
-//	*sobj = osMutexCreate(&Mutex[vol]);
-//	return (int)(*sobj != NULL);
+	*sobj = vol;
+	Zhele::Drivers::Filesystem::FatFsLock::Unlock(vol);
+	return (int)(vol < FF_VOLUMES);
 }
 
 
@@ -90,23 +78,8 @@ int ff_del_syncobj (	/* 1:Function succeeded, 0:Could not delete due to an error
 	FF_SYNC_t sobj		/* Sync object tied to the logical drive to be deleted */
 )
 {
-	/* Win32 */
-	return (int)CloseHandle(sobj);
-
-	/* uITRON */
-//	return (int)(del_sem(sobj) == E_OK);
-
-	/* uC/OS-II */
-//	OS_ERR err;
-//	OSMutexDel(sobj, OS_DEL_ALWAYS, &err);
-//	return (int)(err == OS_NO_ERR);
-
-	/* FreeRTOS */
-//  vSemaphoreDelete(sobj);
-//	return 1;
-
-	/* CMSIS-RTOS */
-//	return (int)(osMutexDelete(sobj) == osOK);
+	Zhele::Drivers::Filesystem::FatFsLock::Unlock(sobj);
+	return 1;
 }
 
 
@@ -115,28 +88,15 @@ int ff_del_syncobj (	/* 1:Function succeeded, 0:Could not delete due to an error
 /*------------------------------------------------------------------------*/
 /* This function is called on entering file functions to lock the volume.
 /  When a 0 is returned, the file function fails with FR_TIMEOUT.
+/  Holder of busy volume is preempted by caller (interrupt or nested event),
+/  so it can't release volume while caller waits: grant is not waited.
 */
 
 int ff_req_grant (	/* 1:Got a grant to access the volume, 0:Could not get a grant */
 	FF_SYNC_t sobj	/* Sync object to wait */
 )
 {
-	/* Win32 */
-	return (int)(WaitForSingleObject(sobj, FF_FS_TIMEOUT) == WAIT_OBJECT_0);
-
-	/* uITRON */
-//	return (int)(wai_sem(sobj) == E_OK);
-
-	/* uC/OS-II */
-//	OS_ERR err;
-//	OSMutexPend(sobj, FF_FS_TIMEOUT, &err));
-//	return (int)(err == OS_NO_ERR);
-
-	/* FreeRTOS */
-//	return (int)(xSemaphoreTake(sobj, FF_FS_TIMEOUT) == pdTRUE);
-
-	/* CMSIS-RTOS */
-//	return (int)(osMutexWait(sobj, FF_FS_TIMEOUT) == osOK);
+	return (int)Zhele::Drivers::Filesystem::FatFsLock::TryLock(sobj);
 }
 
 
@@ -150,21 +110,7 @@ void ff_rel_grant (
 	FF_SYNC_t sobj	/* Sync object to be signaled */
 )
 {
-	/* Win32 */
-	ReleaseMutex(sobj);
-
-	/* uITRON */
-//	sig_sem(sobj);
-
-	/* uC/OS-II */
-//	OSMutexPost(sobj);
-
-	/* FreeRTOS */
-//	xSemaphoreGive(sobj);
-
-	/* CMSIS-RTOS */
-//	osMutexRelease(sobj);
+	Zhele::Drivers::Filesystem::FatFsLock::Unlock(sobj);
 }
 
 #endif
-
@@ -16,7 +16,7 @@
 /*-----------------------------------------------------------------------*/
 DSTATUS disk_status (BYTE pdrv)
 {
-	return Zhele::Drivers::Filesystem::SdCardAdapter::DiskStatus();
+	return Zhele::Drivers::Filesystem::FatFsDrives::DiskStatus(pdrv);
 }
 
 /*-----------------------------------------------------------------------*/
@@ -25,7 +25,7 @@ DSTATUS disk_status (BYTE pdrv)
 
 DSTATUS disk_initialize (BYTE pdrv)
 {
-	return Zhele::Drivers::Filesystem::SdCardAdapter::DiskInitialize();
+	return Zhele::Drivers::Filesystem::FatFsDrives::DiskInitialize(pdrv);
 }
 
 
@@ -41,7 +41,7 @@ DRESULT disk_read (
 	UINT count		/* Number of sectors to read */
 )
 {
-	return Zhele::Drivers::Filesystem::SdCardAdapter::DiskRead(buff, sector, count);
+	return Zhele::Drivers::Filesystem::FatFsDrives::DiskRead(pdrv, buff, sector, count);
 }
 
 
@@ -59,39 +59,7 @@ DRESULT disk_write (
 	UINT count			/* Number of sectors to write */
 )
 {
-	DRESULT res;
-	int result;
-
-	switch (pdrv) {
-	case DEV_RAM :
-		// translate the arguments here
-
-		//result = RAM_disk_write(buff, sector, count);
-
-		// translate the reslut code here
-
-		return res;
-
-	case DEV_MMC :
-		// translate the arguments here
-
-		//result = MMC_disk_write(buff, sector, count);
-
-		// translate the reslut code here
-
-		return res;
-
-	case DEV_USB :
-		// translate the arguments here
-
-		//result = USB_disk_write(buff, sector, count);
-
-		// translate the reslut code here
-
-		return res;
-	}
-
-	return RES_PARERR;
+	return Zhele::Drivers::Filesystem::FatFsDrives::DiskWrite(pdrv, buff, sector, count);
 }
 
 #endif
@@ -107,6 +75,6 @@ DRESULT disk_ioctl (
 	void *buff		/* Buffer to send/receive control data */
 )
 {
-	return RES_PARERR;
+	return Zhele::Drivers::Filesystem::FatFsDrives::DiskIoctl(pdrv, cmd, buff);
 }
 
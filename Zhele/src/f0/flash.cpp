@@ -7,9 +7,174 @@ namespace Zhele
     const static uint32_t MaxFlashFrequence = 24000000;
     void Flash::ConfigureFrequence(uint32_t frequence)
     {
-        FLASH->ACR |= frequence > MaxFlashFrequence
-            ? (FLASH_ACR_PRFTBE | FLASH_ACR_LATENCY)
-            : FLASH_ACR_PRFTBE;
+        SetLatency(frequence > MaxFlashFrequence ? 1 : 0);
+        EnablePrefetch();
+    }
+
+    void Flash::SetLatency(uint8_t latency)
+    {
+        FLASH->ACR = (FLASH->ACR & ~FLASH_ACR_LATENCY) | latency;
+    }
+
+    void Flash::EnablePrefetch()
+    {
+        FLASH->ACR |= FLASH_ACR_PRFTBE;
+    }
+
+    void Flash::DisablePrefetch()
+    {
+        FLASH->ACR &= ~FLASH_ACR_PRFTBE;
+    }
+
+    const static uint32_t FlashErrors = FLASH_SR_PGERR | FLASH_SR_WRPERR;
+    const static uint32_t FlashKey1 = 0x45670123;
+    const static uint32_t FlashKey2 = 0xcdef89ab;
+
+    static bool WaitWhileBusy()
+    {
+        while(FLASH->SR & FLASH_SR_BSY)
+            continue;
+
+        bool success = (FLASH->SR & FlashErrors) == 0;
+        FLASH->SR = FLASH_SR_EOP | FlashErrors;
+        return success;
+    }
+
+    void Flash::Unlock()
+    {
+        if(FLASH->CR & FLASH_CR_LOCK)
+        {
+            FLASH->KEYR = FlashKey1;
+            FLASH->KEYR = FlashKey2;
+        }
+    }
+
+    void Flash::Lock()
+    {
+        FLASH->CR |= FLASH_CR_LOCK;
+    }
+
+    bool Flash::ErasePage(uint32_t address)
+    {
+        WaitWhileBusy();
+        FLASH->CR |= FLASH_CR_PER;
+        FLASH->AR = address;
+        FLASH->CR |= FLASH_CR_STRT;
+        bool success = WaitWhileBusy();
+        FLASH->CR &= ~FLASH_CR_PER;
+
+        return success;
+    }
+
+    static void ProgramHalfWord(volatile uint16_t* destination, const uint8_t* source)
+    {
+        *destination = source[0] | (source[1] << 8);
+    }
+
+    bool Flash::Program(uint32_t address, const void* data, uint32_t size)
+    {
+        const uint8_t* source = reinterpret_cast<const uint8_t*>(data);
+        volatile uint16_t* destination = reinterpret_cast<volatile uint16_t*>(address);
+        bool success = WaitWhileBusy();
+
+        FLASH->CR |= FLASH_CR_PG;
+        for(uint32_t i = 0; success && i < size / 2; ++i)
+        {
+            ProgramHalfWord(&destination[i], &source[2 * i]);
+            success = WaitWhileBusy();
+        }
+        FLASH->CR &= ~FLASH_CR_PG;
+
+        return success;
+    }
+
+    // Async operation state
+    static const uint8_t* asyncSource = nullptr;
+    static volatile uint16_t* asyncDestination = nullptr;
+    static uint32_t asyncRemaining = 0;
+    static Flash::OperationCallback asyncCallback = nullptr;
+    static volatile bool asyncBusy = false;
+
+    static bool StartAsync(Flash::OperationCallback callback)
+    {
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        bool start = !asyncBusy;
+        asyncBusy = true;
+        __set_PRIMASK(primask);
+
+        if(!start)
+            return false;
+
+        asyncCallback = callback;
+        asyncRemaining = 0;
+        WaitWhileBusy();
+        NVIC_EnableIRQ(FLASH_IRQn);
+        return true;
+    }
+
+    static void CompleteAsync(bool success)
+    {
+        FLASH->CR &= ~(FLASH_CR_PG | FLASH_CR_PER | FLASH_CR_EOPIE | FLASH_CR_ERRIE);
+        asyncBusy = false;
+        if(asyncCallback)
+            asyncCallback(success);
+    }
+
+    static void ProgramNext()
+    {
+        ProgramHalfWord(asyncDestination++, asyncSource);
+        asyncSource += 2;
+        --asyncRemaining;
+    }
+
+    bool Flash::ErasePageAsync(uint32_t address, OperationCallback callback)
+    {
+        if(!StartAsync(callback))
+            return false;
+
+        FLASH->CR |= FLASH_CR_PER | FLASH_CR_EOPIE | FLASH_CR_ERRIE;
+        FLASH->AR = address;
+        FLASH->CR |= FLASH_CR_STRT;
+        return true;
+    }
+
+    bool Flash::ProgramAsync(uint32_t address, const void* data, uint32_t size, OperationCallback callback)
+    {
+        if(!StartAsync(callback))
+            return false;
+
+        asyncSource = reinterpret_cast<const uint8_t*>(data);
+        asyncDestination = reinterpret_cast<volatile uint16_t*>(address);
+        asyncRemaining = size / 2;
+        if(asyncRemaining == 0)
+        {
+            CompleteAsync(true);
+            return true;
+        }
+
+        FLASH->CR |= FLASH_CR_PG | FLASH_CR_EOPIE | FLASH_CR_ERRIE;
+        ProgramNext();
+        return true;
+    }
+
+    bool Flash::Busy()
+    {
+        return asyncBusy;
+    }
+
+    void Flash::IrqHandler()
+    {
+        uint32_t status = FLASH->SR;
+        FLASH->SR = FLASH_SR_EOP | FlashErrors;
+        if(!asyncBusy)
+            return;
+
+        bool success = (status & FlashErrors) == 0;
+        if(success && asyncRemaining > 0)
+            ProgramNext();
+        else
+            CompleteAsync(success);
     }
 }
 #endif
\ No newline at end of file
@@ -25,6 +25,21 @@ namespace Zhele::Clock
     IO_BITFIELD_WRAPPER(RCC->PLLCFGR, PllR, uint32_t, PllrBitFieldOffset, PllrBitFieldLength);
 #endif
 
+#if defined (RCC_PLLI2SCFGR_PLLI2SN)
+    const static unsigned PllI2snBitFieldOffset = RCC_PLLI2SCFGR_PLLI2SN_Pos;
+    const static unsigned PllI2snBitFieldLength = GetBitFieldLength<(RCC_PLLI2SCFGR_PLLI2SN_Msk >> RCC_PLLI2SCFGR_PLLI2SN_Pos)>;
+    IO_BITFIELD_WRAPPER(RCC->PLLI2SCFGR, PllI2sN, uint32_t, PllI2snBitFieldOffset, PllI2snBitFieldLength);
+
+    const static unsigned PllI2srBitFieldOffset = RCC_PLLI2SCFGR_PLLI2SR_Pos;
+    const static unsigned PllI2srBitFieldLength = GetBitFieldLength<(RCC_PLLI2SCFGR_PLLI2SR_Msk >> RCC_PLLI2SCFGR_PLLI2SR_Pos)>;
+    IO_BITFIELD_WRAPPER(RCC->PLLI2SCFGR, PllI2sR, uint32_t, PllI2srBitFieldOffset, PllI2srBitFieldLength);
+#endif
+#if defined (RCC_PLLI2SCFGR_PLLI2SM)
+    const static unsigned PllI2smBitFieldOffset = RCC_PLLI2SCFGR_PLLI2SM_Pos;
+    const static unsigned PllI2smBitFieldLength = GetBitFieldLength<(RCC_PLLI2SCFGR_PLLI2SM_Msk >> RCC_PLLI2SCFGR_PLLI2SM_Pos)>;
+    IO_BITFIELD_WRAPPER(RCC->PLLI2SCFGR, PllI2sM, uint32_t, PllI2smBitFieldOffset, PllI2smBitFieldLength);
+#endif
+
     ClockFrequenceT PllClock::SetClockFreq(ClockFrequenceT freq)
     {
         return 0;
@@ -91,6 +106,65 @@ namespace Zhele::Clock
         PllR::Set(divider);
     }
 #endif
+
+#if defined (RCC_PLLI2SCFGR_PLLI2SN)
+    ClockFrequenceT PllI2sClock::SrcClockFreq()
+    {
+    #if defined (RCC_PLLI2SCFGR_PLLI2SM)
+        return PllClock::SrcClockFreq() / PllI2sM::Get();
+    #else
+        return PllClock::SrcClockFreq() / PllClock::GetDivider();
+    #endif
+    }
+
+    ClockFrequenceT PllI2sClock::GetMultipler()
+    {
+        return PllI2sN::Get();
+    }
+
+    void PllI2sClock::SetMultiplier(ClockFrequenceT multiplier)
+    {
+        PllI2sN::Set(multiplier);
+    }
+
+    ClockFrequenceT PllI2sClock::GetOutputDivider()
+    {
+        return PllI2sR::Get();
+    }
+
+    void PllI2sClock::SetOutputDivider(ClockFrequenceT divider)
+    {
+        PllI2sR::Set(divider);
+    }
+
+    ClockFrequenceT PllI2sClock::ClockFreq()
+    {
+        return SrcClockFreq() * GetMultipler() / GetOutputDivider();
+    }
+
+    bool PllI2sClock::Enable()
+    {
+        if (PllClock::GetClockSource() == PllClock::Internal)
+        {
+            if (!HsiClock::Enable())
+                return false;
+        }
+        else
+        {
+            if (!HseClock::Enable())
+                return false;
+        }
+    #if defined (RCC_CFGR_I2SSRC)
+        RCC->CFGR &= ~RCC_CFGR_I2SSRC;
+    #endif
+        return ClockBase::EnableClockSource(RCC_CR_PLLI2SON, RCC_CR_PLLI2SRDY);
+    }
+
+    void PllI2sClock::Disable()
+    {
+        ClockBase::DisableClockSource(RCC_CR_PLLI2SON, RCC_CR_PLLI2SRDY);
+    }
+#endif
 }
 
 #endif
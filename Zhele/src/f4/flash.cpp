@@ -2,6 +2,8 @@
 
 #include "../include/f4/flash.h"
 
+#include <string.h>
+
 namespace Zhele
 {
     const static uint32_t MaxFlashFrequence = 24000000;
@@ -10,7 +12,291 @@ namespace Zhele
         uint32_t ws = (frequence - 1) / MaxFlashFrequence;
         if(ws > 7)
             ws = 7;
-        FLASH->ACR |= FLASH_ACR_PRFTEN | FLASH_ACR_ICEN | FLASH_ACR_DCEN | ws;
+        SetLatency(ws);
+        EnableArt();
+    }
+
+    void Flash::SetLatency(uint8_t latency)
+    {
+        FLASH->ACR = (FLASH->ACR & ~FLASH_ACR_LATENCY) | latency;
+        // New latency should be taken into account before frequence change
+        while((FLASH->ACR & FLASH_ACR_LATENCY) != latency)
+            continue;
+    }
+
+    void Flash::EnablePrefetch()
+    {
+        FLASH->ACR |= FLASH_ACR_PRFTEN;
+    }
+
+    void Flash::DisablePrefetch()
+    {
+        FLASH->ACR &= ~FLASH_ACR_PRFTEN;
+    }
+
+    void Flash::EnableICache()
+    {
+        FLASH->ACR |= FLASH_ACR_ICEN;
+    }
+
+    void Flash::DisableICache()
+    {
+        FLASH->ACR &= ~FLASH_ACR_ICEN;
+    }
+
+    void Flash::EnableDCache()
+    {
+        FLASH->ACR |= FLASH_ACR_DCEN;
+    }
+
+    void Flash::DisableDCache()
+    {
+        FLASH->ACR &= ~FLASH_ACR_DCEN;
+    }
+
+    void Flash::EnableArt()
+    {
+        FLASH->ACR |= FLASH_ACR_ICEN | FLASH_ACR_DCEN | FLASH_ACR_PRFTEN;
+    }
+
+    void Flash::DisableArt()
+    {
+        FLASH->ACR &= ~(FLASH_ACR_ICEN | FLASH_ACR_DCEN | FLASH_ACR_PRFTEN);
+    }
+
+    void Flash::ResetCaches()
+    {
+        // Cache can be reset only when it is disabled
+        uint32_t acr = FLASH->ACR;
+        uint32_t disabled = acr & ~(FLASH_ACR_ICEN | FLASH_ACR_DCEN);
+        FLASH->ACR = disabled;
+        FLASH->ACR = disabled | FLASH_ACR_ICRST | FLASH_ACR_DCRST;
+        FLASH->ACR = disabled;
+        FLASH->ACR = acr;
+    }
+
+    const static uint32_t FlashErrors = FLASH_SR_WRPERR | FLASH_SR_PGAERR | FLASH_SR_PGPERR | FLASH_SR_PGSERR;
+    const static uint32_t FlashKey1 = 0x45670123;
+    const static uint32_t FlashKey2 = 0xcdef89ab;
+
+    static bool WaitWhileBusy()
+    {
+        while(FLASH->SR & FLASH_SR_BSY)
+            continue;
+
+        bool success = (FLASH->SR & FlashErrors) == 0;
+        FLASH->SR = FLASH_SR_EOP | FlashErrors;
+        return success;
+    }
+
+    void Flash::Unlock()
+    {
+        if(FLASH->CR & FLASH_CR_LOCK)
+        {
+            FLASH->KEYR = FlashKey1;
+            FLASH->KEYR = FlashKey2;
+        }
+    }
+
+    void Flash::Lock()
+    {
+        FLASH->CR |= FLASH_CR_LOCK;
+    }
+
+    static uint32_t SectorNumber(uint32_t address)
+    {
+        uint32_t offset = (address - FLASH_BASE) & 0xfffff;
+        uint32_t sector = offset < 0x10000
+            ? offset / 0x4000 // 16K sectors 0..3
+            : offset < 0x20000
+                ? 4 // 64K sector 4
+                : 4 + offset / 0x20000; // 128K sectors 5..11
+
+        // Bank 2 sectors (devices with 2M flash) are numbered from 0x10
+        return (address - FLASH_BASE) >= 0x100000
+            ? sector | 0x10
+            : sector;
+    }
+
+    // x8 parallelism works in whole voltage range
+    static Flash::Parallelism parallelism = Flash::Parallelism::x8;
+
+    void Flash::SetParallelism(Parallelism value)
+    {
+        parallelism = value;
+    }
+
+    static uint32_t ParallelismBits()
+    {
+        return static_cast<uint32_t>(parallelism) << FLASH_CR_PSIZE_Pos;
+    }
+
+    static uint32_t ProgramUnitSize()
+    {
+        return 1u << static_cast<uint8_t>(parallelism);
+    }
+
+    static void ProgramUnit(uint32_t address, const uint8_t* source)
+    {
+        switch(parallelism)
+        {
+        case Flash::Parallelism::x8:
+            *reinterpret_cast<volatile uint8_t*>(address) = source[0];
+            break;
+        case Flash::Parallelism::x16:
+        {
+            uint16_t value;
+            memcpy(&value, source, sizeof(value));
+            *reinterpret_cast<volatile uint16_t*>(address) = value;
+            break;
+        }
+        case Flash::Parallelism::x32:
+        {
+            uint32_t value;
+            memcpy(&value, source, sizeof(value));
+            *reinterpret_cast<volatile uint32_t*>(address) = value;
+            break;
+        }
+        case Flash::Parallelism::x64:
+        {
+            uint32_t value[2];
+            memcpy(value, source, sizeof(value));
+            *reinterpret_cast<volatile uint32_t*>(address) = value[0];
+            // Double word is programmed by two consecutive word writes
+            __ISB();
+            *reinterpret_cast<volatile uint32_t*>(address + 4) = value[1];
+            break;
+        }
+        }
+    }
+
+    static void StartSectorErase(uint32_t address, uint32_t interrupts)
+    {
+        FLASH->CR = (FLASH->CR & ~(FLASH_CR_SNB | FLASH_CR_PSIZE))
+            | FLASH_CR_SER
+            | ParallelismBits()
+            | interrupts
+            | (SectorNumber(address) << FLASH_CR_SNB_Pos);
+        FLASH->CR |= FLASH_CR_STRT;
+    }
+
+    bool Flash::ErasePage(uint32_t address)
+    {
+        WaitWhileBusy();
+        StartSectorErase(address, 0);
+        bool success = WaitWhileBusy();
+        FLASH->CR &= ~(FLASH_CR_SER | FLASH_CR_SNB);
+        ResetCaches();
+
+        return success;
+    }
+
+    bool Flash::Program(uint32_t address, const void* data, uint32_t size)
+    {
+        const uint8_t* source = reinterpret_cast<const uint8_t*>(data);
+        uint32_t unit = ProgramUnitSize();
+        bool success = WaitWhileBusy();
+
+        FLASH->CR = (FLASH->CR & ~FLASH_CR_PSIZE) | ParallelismBits() | FLASH_CR_PG;
+        for(uint32_t offset = 0; success && offset + unit <= size; offset += unit)
+        {
+            ProgramUnit(address + offset, source + offset);
+            success = WaitWhileBusy();
+        }
+        FLASH->CR &= ~FLASH_CR_PG;
+        ResetCaches();
+
+        return success;
+    }
+
+    // Async operation state
+    static const uint8_t* asyncSource = nullptr;
+    static uint32_t asyncAddress = 0;
+    static uint32_t asyncRemaining = 0;
+    static Flash::OperationCallback asyncCallback = nullptr;
+    static volatile bool asyncBusy = false;
+
+    static bool StartAsync(Flash::OperationCallback callback)
+    {
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        bool start = !asyncBusy;
+        asyncBusy = true;
+        __set_PRIMASK(primask);
+
+        if(!start)
+            return false;
+
+        asyncCallback = callback;
+        asyncRemaining = 0;
+        WaitWhileBusy();
+        NVIC_EnableIRQ(FLASH_IRQn);
+        return true;
+    }
+
+    static void CompleteAsync(bool success)
+    {
+        FLASH->CR &= ~(FLASH_CR_PG | FLASH_CR_SER | FLASH_CR_SNB | FLASH_CR_EOPIE | FLASH_CR_ERRIE);
+        Flash::ResetCaches();
+        asyncBusy = false;
+        if(asyncCallback)
+            asyncCallback(success);
+    }
+
+    static void ProgramNext()
+    {
+        uint32_t unit = ProgramUnitSize();
+        ProgramUnit(asyncAddress, asyncSource);
+        asyncAddress += unit;
+        asyncSource += unit;
+        asyncRemaining -= unit;
+    }
+
+    bool Flash::ErasePageAsync(uint32_t address, OperationCallback callback)
+    {
+        if(!StartAsync(callback))
+            return false;
+
+        StartSectorErase(address, FLASH_CR_EOPIE | FLASH_CR_ERRIE);
+        return true;
+    }
+
+    bool Flash::ProgramAsync(uint32_t address, const void* data, uint32_t size, OperationCallback callback)
+    {
+        if(!StartAsync(callback))
+            return false;
+
+        asyncSource = reinterpret_cast<const uint8_t*>(data);
+        asyncAddress = address;
+        asyncRemaining = size - size % ProgramUnitSize();
+        if(asyncRemaining == 0)
+        {
+            CompleteAsync(true);
+            return true;
+        }
+
+        FLASH->CR = (FLASH->CR & ~FLASH_CR_PSIZE) | ParallelismBits() | FLASH_CR_PG | FLASH_CR_EOPIE | FLASH_CR_ERRIE;
+        ProgramNext();
+        return true;
+    }
+
+    bool Flash::Busy()
+    {
+        return asyncBusy;
+    }
+
+    void Flash::IrqHandler()
+    {
+        uint32_t status = FLASH->SR;
+        FLASH->SR = FLASH_SR_EOP | FlashErrors;
+        if(!asyncBusy)
+            return;
+
+        bool success = (status & FlashErrors) == 0;
+        if(success && asyncRemaining > 0)
+            ProgramNext();
+        else
+            CompleteAsync(success);
     }
 }
 
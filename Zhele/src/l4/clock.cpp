@@ -74,6 +74,44 @@ namespace Zhele::Clock
     {
         PllQ::Set(divider);
     }
+
+    bool LpUart1ClockSource::SelectClockSource(ClockSource source)
+    {
+        uint32_t timeout = 0x10000;
+        if(source == Hsi)
+        {
+            if(!HsiClock::Enable())
+                return false;
+        }
+        else if(source == Lse && (RCC->BDCR & RCC_BDCR_LSERDY) == 0)
+        {
+            // LSE is in backup domain
+            RCC->APB1ENR1 |= RCC_APB1ENR1_PWREN;
+            PWR->CR1 |= PWR_CR1_DBP;
+            RCC->BDCR |= RCC_BDCR_LSEON;
+            while((RCC->BDCR & RCC_BDCR_LSERDY) == 0 && --timeout)
+                continue;
+            if(timeout == 0)
+                return false;
+        }
+        RCC->CCIPR = (RCC->CCIPR & ~RCC_CCIPR_LPUART1SEL) | source;
+        return true;
+    }
+
+    ClockFrequenceT LpUart1ClockSource::ClockFreq()
+    {
+        switch(RCC->CCIPR & RCC_CCIPR_LPUART1SEL)
+        {
+        case System:
+            return SysClock::ClockFreq();
+        case Hsi:
+            return HSI_VALUE;
+        case Lse:
+            return 32768;
+        default:
+            return Apb1Clock::ClockFreq();
+        }
+    }
 }
 
 #endif
\ No newline at end of file
@@ -10,7 +10,260 @@ namespace Zhele
         uint32_t ws = (frequence - 1) / MaxFlashFrequence;
         if(ws > 7)
             ws = 7;
-        FLASH->ACR |= FLASH_ACR_PRFTEN | FLASH_ACR_ICEN | FLASH_ACR_DCEN | ws;
+        SetLatency(ws);
+        EnableArt();
+    }
+
+    void Flash::SetLatency(uint8_t latency)
+    {
+        FLASH->ACR = (FLASH->ACR & ~FLASH_ACR_LATENCY) | latency;
+        // New latency should be taken into account before frequence change
+        while((FLASH->ACR & FLASH_ACR_LATENCY) != latency)
+            continue;
+    }
+
+    void Flash::EnablePrefetch()
+    {
+        FLASH->ACR |= FLASH_ACR_PRFTEN;
+    }
+
+    void Flash::DisablePrefetch()
+    {
+        FLASH->ACR &= ~FLASH_ACR_PRFTEN;
+    }
+
+    void Flash::EnableICache()
+    {
+        FLASH->ACR |= FLASH_ACR_ICEN;
+    }
+
+    void Flash::DisableICache()
+    {
+        FLASH->ACR &= ~FLASH_ACR_ICEN;
+    }
+
+    void Flash::EnableDCache()
+    {
+        FLASH->ACR |= FLASH_ACR_DCEN;
+    }
+
+    void Flash::DisableDCache()
+    {
+        FLASH->ACR &= ~FLASH_ACR_DCEN;
+    }
+
+    void Flash::EnableArt()
+    {
+        FLASH->ACR |= FLASH_ACR_ICEN | FLASH_ACR_DCEN | FLASH_ACR_PRFTEN;
+    }
+
+    void Flash::DisableArt()
+    {
+        FLASH->ACR &= ~(FLASH_ACR_ICEN | FLASH_ACR_DCEN | FLASH_ACR_PRFTEN);
+    }
+
+    void Flash::ResetCaches()
+    {
+        // Cache can be reset only when it is disabled
+        uint32_t acr = FLASH->ACR;
+        uint32_t disabled = acr & ~(FLASH_ACR_ICEN | FLASH_ACR_DCEN);
+        FLASH->ACR = disabled;
+        FLASH->ACR = disabled | FLASH_ACR_ICRST | FLASH_ACR_DCRST;
+        FLASH->ACR = disabled;
+        FLASH->ACR = acr;
+    }
+
+    const static uint32_t FlashErrors = FLASH_SR_OPERR | FLASH_SR_PROGERR | FLASH_SR_WRPERR | FLASH_SR_PGAERR
+        | FLASH_SR_SIZERR | FLASH_SR_PGSERR | FLASH_SR_MISERR | FLASH_SR_FASTERR;
+    const static uint32_t FlashPageSize = 2048;
+    const static uint32_t FlashKey1 = 0x45670123;
+    const static uint32_t FlashKey2 = 0xcdef89ab;
+
+    static bool WaitWhileBusy()
+    {
+        while(FLASH->SR & FLASH_SR_BSY)
+            continue;
+
+        bool success = (FLASH->SR & FlashErrors) == 0;
+        FLASH->SR = FLASH_SR_EOP | FlashErrors;
+        return success;
+    }
+
+    void Flash::Unlock()
+    {
+        if(FLASH->CR & FLASH_CR_LOCK)
+        {
+            FLASH->KEYR = FlashKey1;
+            FLASH->KEYR = FlashKey2;
+        }
+    }
+
+    void Flash::Lock()
+    {
+        FLASH->CR |= FLASH_CR_LOCK;
+    }
+
+    static void StartPageErase(uint32_t address, uint32_t interrupts)
+    {
+        uint32_t page = (address - FLASH_BASE) / FlashPageSize;
+        uint32_t cr = FLASH->CR & ~(FLASH_CR_PNB | FLASH_CR_PER);
+#if defined(FLASH_CR_BKER)
+        // Dual bank devices: page number is counted from bank start
+        uint32_t bankSize = ((*reinterpret_cast<const uint16_t*>(FLASHSIZE_BASE)) << 10) / 2;
+        cr &= ~FLASH_CR_BKER;
+        if(address - FLASH_BASE >= bankSize)
+        {
+            cr |= FLASH_CR_BKER;
+            page -= bankSize / FlashPageSize;
+        }
+#endif
+        FLASH->CR = cr | FLASH_CR_PER | interrupts | (page << FLASH_CR_PNB_Pos);
+        FLASH->CR |= FLASH_CR_STRT;
+    }
+
+    static void ProgramDoubleWord(uint32_t address, const uint32_t* source)
+    {
+        volatile uint32_t* destination = reinterpret_cast<volatile uint32_t*>(address);
+        destination[0] = source[0];
+        destination[1] = source[1];
+    }
+
+    bool Flash::ErasePage(uint32_t address)
+    {
+        WaitWhileBusy();
+        StartPageErase(address, 0);
+        bool success = WaitWhileBusy();
+        FLASH->CR &= ~(FLASH_CR_PER | FLASH_CR_PNB);
+        ResetCaches();
+
+        return success;
+    }
+
+    bool Flash::Program(uint32_t address, const void* data, uint32_t size)
+    {
+        const uint32_t* source = reinterpret_cast<const uint32_t*>(data);
+        bool success = WaitWhileBusy();
+
+        // Flash is programmed by double words
+        FLASH->CR |= FLASH_CR_PG;
+        for(uint32_t i = 0; success && i < size / 8; ++i)
+        {
+            ProgramDoubleWord(address + 8 * i, &source[2 * i]);
+            success = WaitWhileBusy();
+        }
+        FLASH->CR &= ~FLASH_CR_PG;
+        ResetCaches();
+
+        return success;
+    }
+
+    bool Flash::ProgramRow(uint32_t address, const void* data)
+    {
+        const uint32_t* source = reinterpret_cast<const uint32_t*>(data);
+        volatile uint32_t* destination = reinterpret_cast<volatile uint32_t*>(address);
+        bool success = WaitWhileBusy();
+
+        // Row words should be written without pauses, otherwise programming fails with MISERR
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        FLASH->CR |= FLASH_CR_FSTPG;
+        for(uint32_t i = 0; i < RowSize / 4; ++i)
+            destination[i] = source[i];
+        success = WaitWhileBusy() && success;
+        FLASH->CR &= ~FLASH_CR_FSTPG;
+        __set_PRIMASK(primask);
+        ResetCaches();
+
+        return success;
+    }
+
+    // Async operation state
+    static const uint32_t* asyncSource = nullptr;
+    static uint32_t asyncAddress = 0;
+    static uint32_t asyncRemaining = 0;
+    static Flash::OperationCallback asyncCallback = nullptr;
+    static volatile bool asyncBusy = false;
+
+    static bool StartAsync(Flash::OperationCallback callback)
+    {
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        bool start = !asyncBusy;
+        asyncBusy = true;
+        __set_PRIMASK(primask);
+
+        if(!start)
+            return false;
+
+        asyncCallback = callback;
+        asyncRemaining = 0;
+        WaitWhileBusy();
+        NVIC_EnableIRQ(FLASH_IRQn);
+        return true;
+    }
+
+    static void CompleteAsync(bool success)
+    {
+        FLASH->CR &= ~(FLASH_CR_PG | FLASH_CR_PER | FLASH_CR_PNB | FLASH_CR_EOPIE | FLASH_CR_ERRIE);
+        Flash::ResetCaches();
+        asyncBusy = false;
+        if(asyncCallback)
+            asyncCallback(success);
+    }
+
+    static void ProgramNext()
+    {
+        ProgramDoubleWord(asyncAddress, asyncSource);
+        asyncAddress += 8;
+        asyncSource += 2;
+        --asyncRemaining;
+    }
+
+    bool Flash::ErasePageAsync(uint32_t address, OperationCallback callback)
+    {
+        if(!StartAsync(callback))
+            return false;
+
+        StartPageErase(address, FLASH_CR_EOPIE | FLASH_CR_ERRIE);
+        return true;
+    }
+
+    bool Flash::ProgramAsync(uint32_t address, const void* data, uint32_t size, OperationCallback callback)
+    {
+        if(!StartAsync(callback))
+            return false;
+
+        asyncSource = reinterpret_cast<const uint32_t*>(data);
+        asyncAddress = address;
+        asyncRemaining = size / 8;
+        if(asyncRemaining == 0)
+        {
+            CompleteAsync(true);
+            return true;
+        }
+
+        FLASH->CR |= FLASH_CR_PG | FLASH_CR_EOPIE | FLASH_CR_ERRIE;
+        ProgramNext();
+        return true;
+    }
+
+    bool Flash::Busy()
+    {
+        return asyncBusy;
+    }
+
+    void Flash::IrqHandler()
+    {
+        uint32_t status = FLASH->SR;
+        FLASH->SR = FLASH_SR_EOP | FlashErrors;
+        if(!asyncBusy)
+            return;
+
+        bool success = (status & FlashErrors) == 0;
+        if(success && asyncRemaining > 0)
+            ProgramNext();
+        else
+            CompleteAsync(success);
     }
 }
 
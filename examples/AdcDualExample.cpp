@@ -0,0 +1,62 @@
+#define F_CPU 72000000
+
+#include <adc.h>
+#include <clock.h>
+#include <dma.h>
+#include <iopins.h>
+
+using namespace Zhele;
+using namespace Zhele::Clock;
+using namespace Zhele::IO;
+
+// Current (PA0, ADC1) and voltage (PA1, ADC2) sampled at the same instant
+static const uint16_t BlockScans = 64;
+const uint8_t CurrentChannels[] = {0};
+const uint8_t VoltageChannels[] = {1};
+
+uint32_t AdcBuffer[2 * BlockScans];
+volatile uint32_t Power;
+
+void ConfigureClock();
+
+int main()
+{
+    ConfigureClock();
+    Porta::Enable();
+
+    Adc1::Init(Adc1::AdcDivider::Div6);
+    Adc2::Init(Adc2::AdcDivider::Div6);
+    Adc1::SetSampleTime(0, 28);
+    Adc2::SetSampleTime(1, 28);
+
+    // Software trigger: both ADCs convert continuously at max rate.
+    // Use Adc12::Mode::FastInterleaved with one channel to double sample rate instead.
+    Adc1::SetRegularTrigger(Adc1::RegularTrigger::Software, Adc1::TriggerMode::Rising);
+    Adc12::StartRegular(Adc12::Mode::RegularSimultaneous, CurrentChannels, VoltageChannels, 1, AdcBuffer, BlockScans, [](void* data, unsigned size, bool) {
+        const uint32_t* samples = static_cast<const uint32_t*>(data);
+        uint32_t power = 0;
+        for(unsigned i = 0; i < size; ++i)
+            power += Adc12::Master(samples[i]) * Adc12::Slave(samples[i]);
+        Power = power / size;
+    });
+
+    for(;;)
+    {
+    }
+}
+
+void ConfigureClock()
+{
+    PllClock::SelectClockSource(PllClock::ClockSource::External);
+    PllClock::SetMultiplier(9);
+    Apb1Clock::SetPrescaler(Apb1Clock::Div2);
+    SysClock::SelectClockSource(SysClock::Pll);
+}
+
+extern "C"
+{
+    void DMA1_Channel1_IRQHandler()
+    {
+        Dma1Channel1::IrqHandler();
+    }
+}
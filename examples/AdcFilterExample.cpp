@@ -0,0 +1,72 @@
+#define F_CPU 72000000
+
+#include <adc.h>
+#include <clock.h>
+#include <dma.h>
+#include <iopins.h>
+#include <common/dsp.h>
+
+using namespace Zhele;
+using namespace Zhele::Clock;
+using namespace Zhele::Dsp;
+using namespace Zhele::IO;
+
+// One channel (PA0): samples are converted to Q15, low-pass filtered and decimated by 4 in ping-pong callback
+static const uint16_t BlockScans = 256;
+const uint8_t AdcChannels[] = {0};
+
+uint16_t AdcBuffer[2 * BlockScans];
+
+// Butterworth low-pass (fc = 0.05 fs), coefficients in Q14, feedback coefficients are negated
+const BiquadQ15Coefficients LowPass[] = {
+    {ToQ15(0.020083, 14), ToQ15(0.040166, 14), ToQ15(0.020083, 14), ToQ15(1.561018, 14), ToQ15(-0.641352, 14)},
+};
+// Anti-aliasing FIR for decimation
+const Q15 DecimatorTaps[8] = {ToQ15(0.03), ToQ15(0.09), ToQ15(0.16), ToQ15(0.22), ToQ15(0.22), ToQ15(0.16), ToQ15(0.09), ToQ15(0.03)};
+
+BiquadCascadeQ15<1> Filter(LowPass);
+FirDecimatorQ15<8, 4> Decimator(DecimatorTaps);
+volatile Q15 Level;
+volatile Q15 Average;
+
+void ConfigureClock();
+
+int main()
+{
+    ConfigureClock();
+    Porta::Enable();
+
+    Adc1::Init(Adc1::AdcDivider::Div6);
+    Adc1::SetSampleTime(0, 28);
+
+    Adc1::SetRegularTrigger(Adc1::RegularTrigger::Software, Adc1::TriggerMode::Rising);
+    Adc1::StartRegularPingPong(AdcChannels, sizeof(AdcChannels), AdcBuffer, BlockScans, [](void* data, unsigned size, bool) {
+        // Block is processed in place: ADC samples -> Q15 -> IIR -> decimated FIR
+        Q15* samples = static_cast<Q15*>(data);
+        AdcToQ15<12>(static_cast<uint16_t*>(data), samples, size);
+        Filter.Process(samples, samples, size);
+        unsigned count = Decimator.Process(samples, samples, size);
+        Level = Rms(samples, count);
+        Average = Mean(samples, count);
+    });
+
+    for(;;)
+    {
+    }
+}
+
+void ConfigureClock()
+{
+    PllClock::SelectClockSource(PllClock::ClockSource::External);
+    PllClock::SetMultiplier(9);
+    Apb1Clock::SetPrescaler(Apb1Clock::Div2);
+    SysClock::SelectClockSource(SysClock::Pll);
+}
+
+extern "C"
+{
+    void DMA1_Channel1_IRQHandler()
+    {
+        Dma1Channel1::IrqHandler();
+    }
+}
@@ -0,0 +1,59 @@
+#define F_CPU 72000000
+
+#include <adc.h>
+#include <clock.h>
+#include <dma.h>
+#include <iopins.h>
+
+using namespace Zhele;
+using namespace Zhele::Clock;
+using namespace Zhele::IO;
+
+// Two channels (PA0, PA1), 16x boxcar oversampling: 16-bit output, 14-bit effective resolution
+static const uint16_t BlockScans = 128;
+const uint8_t AdcChannels[] = {0, 1};
+
+uint16_t AdcBuffer[2 * BlockScans * sizeof(AdcChannels)];
+AdcDecimator<sizeof(AdcChannels), 16> Decimator;
+volatile uint16_t Result[sizeof(AdcChannels)];
+
+void ConfigureClock();
+
+int main()
+{
+    ConfigureClock();
+    Porta::Enable();
+
+    Adc1::Init(Adc1::AdcDivider::Div6);
+    Adc1::SetSampleTime(0, 28);
+    Adc1::SetSampleTime(1, 28);
+
+    Adc1::SetRegularTrigger(Adc1::RegularTrigger::Software, Adc1::TriggerMode::Rising);
+    Adc1::StartRegularPingPong(AdcChannels, sizeof(AdcChannels), AdcBuffer, BlockScans, [](void* data, unsigned size, bool) {
+        // Decimated samples are written to the beginning of block
+        unsigned count = Decimator.Process(data, size);
+        const uint16_t* samples = static_cast<const uint16_t*>(data);
+        for(unsigned channel = 0; channel < sizeof(AdcChannels); ++channel)
+            Result[channel] = samples[count - sizeof(AdcChannels) + channel];
+    });
+
+    for(;;)
+    {
+    }
+}
+
+void ConfigureClock()
+{
+    PllClock::SelectClockSource(PllClock::ClockSource::External);
+    PllClock::SetMultiplier(9);
+    Apb1Clock::SetPrescaler(Apb1Clock::Div2);
+    SysClock::SelectClockSource(SysClock::Pll);
+}
+
+extern "C"
+{
+    void DMA1_Channel1_IRQHandler()
+    {
+        Dma1Channel1::IrqHandler();
+    }
+}
@@ -0,0 +1,87 @@
+#define F_CPU 72000000
+
+#include <adc.h>
+#include <clock.h>
+#include <dma.h>
+#include <iopins.h>
+#include <timer.h>
+
+using namespace Zhele;
+using namespace Zhele::Clock;
+using namespace Zhele::IO;
+using namespace Zhele::Timers;
+
+// Current (PA0) and voltage (PA1) sampled at 10 kHz, 100 scans per block
+static const uint32_t SampleRate = 10000;
+static const uint16_t BlockScans = 100;
+const uint8_t AdcChannels[] = {0, 1};
+
+uint16_t AdcBuffer[2 * BlockScans * sizeof(AdcChannels)];
+volatile uint32_t Power;
+volatile bool Overcurrent;
+
+// Raw current limit (PA0)
+static const uint16_t CurrentLimit = 3500;
+
+using SampleTimer = Timer3;
+
+void ConfigureClock();
+
+int main()
+{
+    ConfigureClock();
+    Porta::Enable();
+
+    Adc1::Init(Adc1::AdcDivider::Div6);
+    Adc1::SetSampleTime(0, 28);
+    Adc1::SetSampleTime(1, 28);
+
+    // Overcurrent is detected by hardware right after conversion, buffer is not scanned
+    Adc1::SetAnalogWatchdog(0, 0, CurrentLimit, []() {
+        Overcurrent = true;
+        Adc1::DisableAnalogWatchdog();
+    });
+
+    // Conversions are paced by Timer3 TRGO.
+    // Use RegularTrigger::Software instead to sample at max ADC rate (continuous mode).
+    Adc1::SetRegularTrigger(Adc1::RegularTrigger::Timer3TRGO, Adc1::TriggerMode::Rising);
+    Adc1::StartRegularPingPong(AdcChannels, sizeof(AdcChannels), AdcBuffer, BlockScans, [](void* data, unsigned size, bool) {
+        // Block is stable until DMA wraps to it again
+        const uint16_t* samples = static_cast<const uint16_t*>(data);
+        uint32_t power = 0;
+        for(unsigned i = 0; i < size; i += 2)
+            power += samples[i] * samples[i + 1];
+        Power = power / (size / 2);
+    });
+
+    SampleTimer::Enable();
+    SampleTimer::SetPrescaler(0);
+    SampleTimer::SetPeriod(SysClock::ClockFreq() / SampleRate - 1);
+    SampleTimer::SetMasterMode(SampleTimer::MasterMode::Update);
+    SampleTimer::Start();
+
+    for(;;)
+    {
+    }
+}
+
+void ConfigureClock()
+{
+    PllClock::SelectClockSource(PllClock::ClockSource::External);
+    PllClock::SetMultiplier(9);
+    Apb1Clock::SetPrescaler(Apb1Clock::Div2);
+    SysClock::SelectClockSource(SysClock::Pll);
+}
+
+extern "C"
+{
+    void DMA1_Channel1_IRQHandler()
+    {
+        Dma1Channel1::IrqHandler();
+    }
+
+    void ADC1_2_IRQHandler()
+    {
+        Adc1::IrqHandler();
+    }
+}
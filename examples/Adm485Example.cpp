@@ -44,3 +44,12 @@ void TransferCompleteHandler(void* data, unsigned size, bool success)
         Led::Set();
     }
 }
+
+extern "C"
+{
+    // Direct pin is released by transmission complete interrupt
+    void USART1_IRQHandler()
+    {
+        Connection::IrqHandler();
+    }
+}
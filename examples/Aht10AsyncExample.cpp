@@ -0,0 +1,73 @@
+// Two AHT10 sensors on one I2C bus, measured without blocking main loop.
+#define F_CPU 72000000
+
+#include <i2c.h>
+#include <common/timebase.h>
+#include <drivers/aht10.h>
+
+using namespace Zhele;
+using namespace Zhele::Clock;
+using namespace Zhele::Drivers;
+
+using Bus = I2cTransactionQueue<I2c1>;
+using Timebase = DwtTimebase<>;
+using Indoor = Aht10Async<Bus, Timebase, 0x38>;
+using Outdoor = Aht10Async<Bus, Timebase, 0x39>;
+
+volatile int16_t IndoorTemperature;
+volatile uint16_t OutdoorHumidity;
+
+int main()
+{
+    Timebase::Init();
+    I2c1::Init();
+    I2c1::SelectPins<IO::Pb8, IO::Pb9>();
+
+    Indoor::StartInit();
+    Outdoor::StartInit();
+
+    uint32_t lastMeasurement = Timebase::Micros();
+    for (;;)
+    {
+        Indoor::Poll();
+        Outdoor::Poll();
+
+        if (Timebase::Micros() - lastMeasurement >= 1000000)
+        {
+            lastMeasurement = Timebase::Micros();
+            // Both sensors convert at the same time
+            Indoor::StartMeasurement([](bool success, const Indoor::Measurement& measurement) {
+                if (success)
+                    IndoorTemperature = measurement.Temperature;
+            });
+            Outdoor::StartMeasurement([](bool success, const Outdoor::Measurement& measurement) {
+                if (success)
+                    OutdoorHumidity = measurement.Humidity;
+            });
+        }
+    }
+}
+
+extern "C"
+{
+    // Queued transactions are driven by I2C and DMA interrupts
+    void I2C1_EV_IRQHandler()
+    {
+        I2c1::EventIrqHandler();
+    }
+
+    void I2C1_ER_IRQHandler()
+    {
+        I2c1::ErrorIrqHandler();
+    }
+
+    void DMA1_Channel6_IRQHandler()
+    {
+        Dma1Channel6::IrqHandler();
+    }
+
+    void DMA1_Channel7_IRQHandler()
+    {
+        Dma1Channel7::IrqHandler();
+    }
+}
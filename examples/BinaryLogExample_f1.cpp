@@ -0,0 +1,54 @@
+#define F_CPU 72000000
+
+// Enable binary log (usually defined globally as compiler option)
+#define ZHELE_LOG
+
+#include <common/log.h>
+#include <timer.h>
+#include <usart.h>
+
+using namespace Zhele;
+using namespace Zhele::IO;
+using namespace Zhele::Timers;
+
+// Log is decoded on host:
+// tools/log_decoder.py --serial /dev/ttyUSB0 --baudrate 921600 --cpu-freq 72000000
+using LogUsart = Usart1;
+
+int main()
+{
+    Log::Buffer::Enable();
+
+    LogUsart::Init(921600);
+    LogUsart::SelectTxRxPins<Pa9, Pa10>();
+
+    Timer2::Enable();
+    Timer2::SetPrescaler(7199);
+    Timer2::SetPeriod(999);
+    Timer2::EnableInterrupt();
+    Timer2::Start();
+
+    ZHELE_LOG_WRITE("boot, cpu %u Hz", F_CPU);
+
+    for (;;)
+    {
+        // Records are sent by DMA directly from log buffer
+        Log::Buffer::DrainUsart<LogUsart>();
+    }
+}
+
+extern "C"
+{
+    void TIM2_IRQHandler()
+    {
+        static uint32_t ticks = 0;
+        // Only format id, timestamp and arguments are written (16 bytes, no formatting)
+        ZHELE_LOG_WRITE("tick %u, dropped %u", ++ticks, Log::Buffer::Dropped());
+        Timer2::ClearInterruptFlag();
+    }
+
+    void DMA1_Channel4_IRQHandler()
+    {
+        Dma1Channel4::IrqHandler();
+    }
+}
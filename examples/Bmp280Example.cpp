@@ -18,6 +18,11 @@ int main()
     volatile bool initResult = BmpSendor::Init();
     volatile auto temp = BmpSendor::ReadTemperature();
 
+    // One burst read, fixed-point results: 0.01 °C and Pa * 256
+    BmpSendor::Read();
+    volatile int32_t temperature = BmpSendor::Temperature();
+    volatile uint32_t pressure = BmpSendor::Pressure() / 256;
+
     volatile int a = 42;
 
     for (;;)
@@ -0,0 +1,66 @@
+#define F_CPU 72000000
+
+#include <iopins.h>
+#include <usart.h>
+
+#include <functional>
+#include <stdio.h>
+
+using namespace Zhele;
+using namespace Zhele::IO;
+
+using UsartConnection = Usart1;
+
+static const unsigned Iterations = 1000;
+
+volatile unsigned Counter = 0;
+
+// Measures average cost (in CPU cycles) of callback dispatch, which happens in DMA interrupt handler.
+// InplaceFunction (TransferCallback) is compared with std::function and raw function pointer.
+// Results are printed to USART.
+template<typename _Callback>
+__attribute__((noinline)) uint32_t Measure(const _Callback& callback)
+{
+    uint32_t start = DWT->CYCCNT;
+    for(unsigned i = 0; i < Iterations; ++i)
+    {
+        callback(nullptr, i, true);
+    }
+    return (DWT->CYCCNT - start) / Iterations;
+}
+
+void Callback(void*, unsigned size, bool)
+{
+    Counter += size;
+}
+
+int main()
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    UsartConnection::Init(115200);
+    UsartConnection::SelectTxRxPins<Pa9, Pa10>();
+
+    volatile unsigned local = 0;
+
+    std::add_pointer_t<void(void*, unsigned, bool)> pointer = Callback;
+    std::function<void(void*, unsigned, bool)> function = [&local](void*, unsigned size, bool) { local += size; };
+    TransferCallback inplace = [&local](void*, unsigned size, bool) { local += size; };
+
+    uint32_t pointerCycles = Measure(pointer);
+    uint32_t functionCycles = Measure(function);
+    uint32_t inplaceCycles = Measure(inplace);
+
+    char buffer[96];
+    int length = snprintf(buffer, sizeof(buffer), "pointer: %lu, std::function: %lu, TransferCallback: %lu cycles\r\n",
+        static_cast<unsigned long>(pointerCycles),
+        static_cast<unsigned long>(functionCycles),
+        static_cast<unsigned long>(inplaceCycles));
+    UsartConnection::Write(buffer, length);
+
+    for (;;)
+    {
+    }
+}
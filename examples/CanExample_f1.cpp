@@ -0,0 +1,63 @@
+#define F_CPU 72000000
+
+#include <can.h>
+#include <iopins.h>
+
+using namespace Zhele;
+using namespace Zhele::IO;
+
+using CanBus = Can1;
+using Led = Pc13;
+
+// Node answers to requests 0x100...0x10f (FIFO0) with identifier + 0x80
+// and toggles led on broadcast frame 0x7df (FIFO1).
+int main()
+{
+    Led::Port::Enable();
+    Led::SetConfiguration(Led::Configuration::Out);
+    Led::SetDriverType(Led::DriverType::PushPull);
+
+    CanBus::SelectTxRxPins<Pb9, Pb8>();
+    CanBus::Init(1000000, CanBase::AutoBusOff);
+    CanBus::SetFilters<
+        CanMaskFilter32<0x100, 0x7f0>,
+        CanListFilter32<0x7df, 0x7df, false, CanFifo::Fifo1>>();
+
+    for (;;)
+    {
+        CanFrame frame;
+        while(CanBus::Read(frame))
+        {
+            if(frame.Id == 0x7df)
+            {
+                Led::Toggle();
+                continue;
+            }
+            frame.Id += 0x80;
+            CanBus::Write(frame);
+        }
+    }
+}
+
+extern "C"
+{
+    void USB_HP_CAN1_TX_IRQHandler()
+    {
+        CanBus::TxIrqHandler();
+    }
+
+    void USB_LP_CAN1_RX0_IRQHandler()
+    {
+        CanBus::Rx0IrqHandler();
+    }
+
+    void CAN1_RX1_IRQHandler()
+    {
+        CanBus::Rx1IrqHandler();
+    }
+
+    void CAN1_SCE_IRQHandler()
+    {
+        CanBus::SceIrqHandler();
+    }
+}
@@ -0,0 +1,111 @@
+/**
+ * High-speed CDC device on OTG_HS core with external ULPI PHY (USB3300 for example).
+ * Bulk endpoints have 512 bytes packets, data is transferred by OTG internal DMA.
+ * Device continuously streams buffer to host (> 10 MB/s with bulk transfers).
+ */
+#define ZHELE_USB_OTG_HS
+#define ZHELE_USB_OTG_HS_ULPI
+#define ZHELE_USB_OTG_DMA
+
+#include <clock.h>
+#include <iopins.h>
+#include <usb.h>
+
+using namespace Zhele;
+using namespace Zhele::Clock;
+using namespace Zhele::IO;
+using namespace Zhele::Usb;
+
+using CdcCommEndpointBase = InEndpointBase<1, EndpointType::Interrupt, 8, 0xff>;
+using CdcDataOutEndpointBase = OutEndpointBase<2, EndpointType::Bulk, 512, 0>;
+using CdcDataInEndpointBase = InEndpointBase<2, EndpointType::Bulk, 512, 0>;
+
+using EpInitializer = EndpointsInitializer<DefaultEp0, CdcCommEndpointBase, CdcDataOutEndpointBase, CdcDataInEndpointBase>;
+
+using Ep0 = EpInitializer::ExtendEndpoint<DefaultEp0>;
+using CdcCommEndpoint = EpInitializer::ExtendEndpoint<CdcCommEndpointBase>;
+using CdcDataOutEndpoint = EpInitializer::ExtendEndpoint<CdcDataOutEndpointBase>;
+using CdcDataInEndpoint = EpInitializer::ExtendEndpoint<CdcDataInEndpointBase>;
+
+using CdcComm = DefaultCdcCommInterface<0, Ep0, CdcCommEndpoint>;
+using CdcData = CdcDataInterface<1, 0, 0, 0, Ep0, CdcDataOutEndpoint, CdcDataInEndpoint>;
+
+using Config = Configuration<0, 250, false, false, CdcComm, CdcData>;
+
+using MyDevice = Device<0x0200, DeviceAndInterfaceClass::Comm, 0, 0, 0x0483, 0x5712, 0x0000, Ep0, Config>;
+
+// Samples buffer (should be word-aligned for DMA)
+static uint8_t StreamBuffer[16 * 512] __attribute__((aligned(4)));
+static volatile bool StreamStarted = false;
+
+void ConfigureClock();
+void ConfigureUlpiPins();
+void SendNextBuffer();
+
+int main()
+{
+    ConfigureClock();
+    ConfigureUlpiPins();
+
+    for(unsigned i = 0; i < sizeof(StreamBuffer); ++i)
+        StreamBuffer[i] = i;
+
+    MyDevice::Enable();
+
+    for(;;)
+    {
+        // Start streaming after host has sent something
+        if(StreamStarted)
+        {
+            StreamStarted = false;
+            SendNextBuffer();
+        }
+    }
+}
+
+void SendNextBuffer()
+{
+    // 8 KB transfer: 16 packets, one interrupt on completion
+    CdcDataInEndpoint::SendData(StreamBuffer, sizeof(StreamBuffer), SendNextBuffer);
+}
+
+void ConfigureClock()
+{
+    PllClock::SelectClockSource(PllClock::ClockSource::External);
+    PllClock::SetDivider(25);
+    PllClock::SetMultiplier(336);
+    PllClock::SetSystemOutputDivider(PllClock::SystemOutputDivider::Div2);
+    PllClock::SetUsbOutputDivider(7);
+    Apb1Clock::SetPrescaler(Apb1Clock::Div4);
+    Apb2Clock::SetPrescaler(Apb2Clock::Div2);
+    SysClock::SelectClockSource(SysClock::Pll);
+}
+
+template<typename... _Pins>
+void ConfigureAltFuncPins()
+{
+    ((_Pins::Port::Enable(),
+        _Pins::template SetConfiguration<_Pins::Configuration::AltFunc>(),
+        _Pins::template SetSpeed<_Pins::Speed::Fastest>(),
+        _Pins::template AltFuncNumber<10>()), ...);
+}
+
+void ConfigureUlpiPins()
+{
+    // CK, D0-D7, STP, DIR, NXT
+    ConfigureAltFuncPins<Pa5, Pa3, Pb0, Pb1, Pb10, Pb11, Pb12, Pb13, Pb5, Pc0, Pc2, Pc3>();
+}
+
+template<>
+void CdcDataOutEndpoint::HandleRx()
+{
+    if(CdcDataOutEndpoint::BufferSize > 0)
+        StreamStarted = true;
+
+    CdcDataOutEndpoint::SetRxStatusValid();
+}
+
+extern "C" void OTG_HS_IRQHandler(void)
+{
+    MyDevice::CommonHandler();
+}
@@ -0,0 +1,78 @@
+#include <clock.h>
+#include <iopins.h>
+#include <usb.h>
+
+using namespace Zhele;
+using namespace Zhele::Clock;
+using namespace Zhele::IO;
+using namespace Zhele::Usb;
+
+using CdcCommEndpointBase = InEndpointBase<1, EndpointType::Interrupt, 8, 0xff>;
+using CdcDataEndpointBase = BulkDoubleBufferedEndpointBase<2, EndpointDirection::Out, 64>;
+using CdcDataEndpointBaseIn = BulkDoubleBufferedEndpointBase<3, EndpointDirection::In, 64>;
+
+using EpInitializer = EndpointsInitializer<DefaultEp0, CdcCommEndpointBase, CdcDataEndpointBase, CdcDataEndpointBaseIn>;
+using Ep0 = EpInitializer::ExtendEndpoint<DefaultEp0>;
+
+using CdcCommEndpoint = EpInitializer::ExtendEndpoint<CdcCommEndpointBase>;
+using CdcDataEndpoint = EpInitializer::ExtendEndpoint<CdcDataEndpointBase>;
+using CdcDataEndpointIn = EpInitializer::ExtendEndpoint<CdcDataEndpointBaseIn>;
+
+using CdcComm = DefaultCdcCommInterface<0, Ep0, CdcCommEndpoint>;
+using CdcData = CdcDataInterface<1, 0, 0, 0, Ep0, CdcDataEndpoint, CdcDataEndpointIn>;
+
+using Config = Configuration<0, 250, false, false, CdcComm, CdcData>;
+using MyDevice = Device<0x0200, DeviceAndInterfaceClass::Comm, 0, 0, 0x0483, 0x5711, 0, Ep0, Config>;
+
+// Echo stream: 256 bytes RX/TX FIFOs, partial packet is sent after 2 ms idle
+using Stream = CdcStream<CdcDataEndpoint, CdcDataEndpointIn, 256, 256, 2>;
+
+void ConfigureClock();
+
+int main()
+{
+    ConfigureClock();
+    Zhele::IO::Porta::Enable();
+    MyDevice::Enable();
+
+    // 1 ms tick for flush timeout
+    SysTick_Config(SysClock::ClockFreq() / 1000);
+
+    uint8_t buffer[64];
+    for(;;)
+    {
+        unsigned size = Stream::WriteAvailable();
+        if(size > sizeof(buffer))
+            size = sizeof(buffer);
+
+        // Data is not read while TX FIFO is full, so host is NAKed (flow control)
+        size = Stream::Read(buffer, size);
+        if(size > 0)
+            Stream::Write(buffer, size);
+    }
+}
+
+void ConfigureClock()
+{
+    PllClock::SelectClockSource(PllClock::ClockSource::External);
+    PllClock::SetMultiplier(9);
+    Apb1Clock::SetPrescaler(Apb1Clock::Div2);
+    SysClock::SelectClockSource(SysClock::Pll);
+    MyDevice::SelectClockSource(Zhele::Usb::ClockSource::PllDividedOneAndHalf);
+}
+
+template<>
+void CdcDataEndpoint::HandleRx(void* data, uint16_t size)
+{
+    Stream::HandleRx(data, size);
+}
+
+extern "C" void SysTick_Handler()
+{
+    Stream::Tick();
+}
+
+extern "C" void USB_LP_IRQHandler()
+{
+    MyDevice::CommonHandler();
+}
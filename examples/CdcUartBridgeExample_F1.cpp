@@ -0,0 +1,88 @@
+#include <clock.h>
+#include <iopins.h>
+#include <usart.h>
+#include <usb.h>
+#include <common/usb/cdc_bridge.h>
+
+using namespace Zhele;
+using namespace Zhele::Clock;
+using namespace Zhele::IO;
+using namespace Zhele::Usb;
+
+using CdcCommEndpointBase = InEndpointBase<1, EndpointType::Interrupt, 8, 0xff>;
+using CdcDataEndpointBase = BulkDoubleBufferedEndpointBase<2, EndpointDirection::Out, 64>;
+using CdcDataEndpointBaseIn = BulkDoubleBufferedEndpointBase<3, EndpointDirection::In, 64>;
+
+using EpInitializer = EndpointsInitializer<DefaultEp0, CdcCommEndpointBase, CdcDataEndpointBase, CdcDataEndpointBaseIn>;
+using Ep0 = EpInitializer::ExtendEndpoint<DefaultEp0>;
+
+using CdcCommEndpoint = EpInitializer::ExtendEndpoint<CdcCommEndpointBase>;
+using CdcDataEndpoint = EpInitializer::ExtendEndpoint<CdcDataEndpointBase>;
+using CdcDataEndpointIn = EpInitializer::ExtendEndpoint<CdcDataEndpointBaseIn>;
+
+using CdcComm = DefaultCdcCommInterface<0, Ep0, CdcCommEndpoint>;
+using CdcData = CdcDataInterface<1, 0, 0, 0, Ep0, CdcDataEndpoint, CdcDataEndpointIn>;
+
+using Config = Configuration<0, 250, false, false, CdcComm, CdcData>;
+using MyDevice = Device<0x0200, DeviceAndInterfaceClass::Comm, 0, 0, 0x0483, 0x5711, 0, Ep0, Config>;
+
+// USB-serial adapter: virtual COM port data goes to USART1 (PA9/PA10), baud rate is set by host
+using Bridge = CdcUartBridge<CdcDataEndpoint, CdcDataEndpointIn, Usart1>;
+
+void ConfigureClock();
+
+int main()
+{
+    ConfigureClock();
+
+    Usart1::Init(115200);
+    Usart1::SelectTxRxPins<Pa9, Pa10>();
+
+    CdcComm::SetLineCodingCallback(Bridge::SetLineCoding);
+    Bridge::Init();
+
+    Zhele::IO::Porta::Enable();
+    MyDevice::Enable();
+
+    for(;;)
+    {
+    }
+}
+
+void ConfigureClock()
+{
+    PllClock::SelectClockSource(PllClock::ClockSource::External);
+    PllClock::SetMultiplier(9);
+    Apb1Clock::SetPrescaler(Apb1Clock::Div2);
+    SysClock::SelectClockSource(SysClock::Pll);
+    MyDevice::SelectClockSource(Zhele::Usb::ClockSource::PllDividedOneAndHalf);
+}
+
+template<>
+void CdcDataEndpoint::HandleRx(void* data, uint16_t size)
+{
+    Bridge::HandleRx(data, size);
+}
+
+extern "C"
+{
+    void USB_LP_IRQHandler()
+    {
+        MyDevice::CommonHandler();
+    }
+
+    void USART1_IRQHandler()
+    {
+        Usart1::IrqHandler();
+    }
+
+    void DMA1_Channel4_IRQHandler()
+    {
+        Dma1Channel4::IrqHandler();
+    }
+
+    void DMA1_Channel5_IRQHandler()
+    {
+        Dma1Channel5::IrqHandler();
+    }
+}
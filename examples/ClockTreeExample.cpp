@@ -0,0 +1,40 @@
+#include <common/clock_tree.h>
+#include <iopins.h>
+#include <timer.h>
+
+using namespace Zhele;
+using namespace Zhele::Clock;
+using namespace Zhele::IO;
+using namespace Zhele::Timers;
+
+// 8 MHz HSE -> 72 MHz system clock with 48 MHz USB clock. Wrong configuration breaks build.
+using Clocks = ClockTree<72000000, true, 8000000>;
+static_assert(Clocks::Apb1ClockFreq == 36000000);
+
+// Compile-time timer constants: 1 ms update of APB1 timer
+const static uint16_t TickPrescaler = Clocks::Apb1TimerClockFreq / 1000000 - 1;
+
+int main()
+{
+    if(!Clocks::Init())
+    {
+        // HSE failure: system clock is HSI
+    }
+
+    Pc13::Port::Enable();
+    Pc13::SetConfiguration(Pc13::Configuration::Out);
+
+    Timer2::Enable();
+    Timer2::SetPrescaler(TickPrescaler);
+    Timer2::SetPeriod(1000 - 1);
+    Timer2::Start();
+
+    for (;;)
+    {
+        if(Timer2::IsInterrupt())
+        {
+            Timer2::ClearInterruptFlag();
+            Pc13::Toggle();
+        }
+    }
+}
@@ -0,0 +1,84 @@
+#define F_CPU 72000000
+
+#include <clock.h>
+#include <iopins.h>
+#include <timer.h>
+
+using namespace Zhele;
+using namespace Zhele::Clock;
+using namespace Zhele::IO;
+using namespace Zhele::Timers;
+
+// Three-phase center-aligned PWM (20 kHz) with complementary outputs, 500 ns dead time and break input (PB12).
+// High side: PA8, PA9, PA10. Low side: PB13, PB14, PB15.
+using MotorTimer = Timer1;
+using PhaseU = MotorTimer::ComplementaryPWMGeneration<0>;
+using PhaseV = MotorTimer::ComplementaryPWMGeneration<1>;
+using PhaseW = MotorTimer::ComplementaryPWMGeneration<2>;
+
+static const uint16_t Period = 72000000 / 20000 / 2; // Center-aligned mode counts up and down
+
+void ConfigureClock();
+
+template<typename Phase, typename HighPin, typename LowPin>
+void ConfigurePhase()
+{
+    Phase::template SelectPins<HighPin>();
+    Phase::template SelectComplementaryPins<LowPin>();
+    Phase::SetOutputMode(Phase::OutputMode::PWM1);
+    Phase::SetComplementaryPolarity(Phase::OutputPolarity::ActiveHigh);
+    // Both transistors are off while outputs are disabled (break)
+    Phase::SetIdleState(false, false);
+    Phase::SetPulse(Period / 2);
+    Phase::Enable();
+    Phase::EnableComplementary();
+}
+
+int main()
+{
+    ConfigureClock();
+
+    MotorTimer::Enable();
+    MotorTimer::SetCounterMode(MotorTimer::CounterMode::CenterAligned1);
+    MotorTimer::SetPrescaler(0);
+    MotorTimer::SetPeriod(Period);
+    // Update event once per PWM period (on underflow only)
+    MotorTimer::SetRepetitionCounter(1);
+    MotorTimer::SetDeadTimeNs(500);
+
+    ConfigurePhase<PhaseU, Pa8, Pb13>();
+    ConfigurePhase<PhaseV, Pa9, Pb14>();
+    ConfigurePhase<PhaseW, Pa10, Pb15>();
+
+    // Overcurrent comparator output (active low) switches outputs off in hardware
+    MotorTimer::SelectBreakPins<Pb12>();
+    MotorTimer::EnableBreak(MotorTimer::BreakPolarity::ActiveLow);
+    MotorTimer::SetOffStateSelection(true, true);
+    MotorTimer::EnableBreakInterrupt();
+    MotorTimer::Lock(MotorTimer::LockLevel::Level1);
+
+    MotorTimer::EnableOutputs();
+    MotorTimer::Start();
+
+    for (;;)
+    {
+    }
+}
+
+void ConfigureClock()
+{
+    PllClock::SelectClockSource(PllClock::ClockSource::External);
+    PllClock::SetMultiplier(9);
+    Apb1Clock::SetPrescaler(Apb1Clock::Div2);
+    SysClock::SelectClockSource(SysClock::Pll);
+}
+
+extern "C"
+{
+    void TIM1_BRK_IRQHandler()
+    {
+        // Outputs are already disabled by hardware, just report fault
+        MotorTimer::DisableBreakInterrupt();
+        MotorTimer::ClearBreakFlag();
+    }
+}
@@ -0,0 +1,69 @@
+#define F_CPU 8000000
+
+#include <usart.h>
+#include <timer.h>
+#include <common/async.h>
+
+using namespace Zhele;
+using namespace Zhele::Async;
+using namespace Zhele::IO;
+using namespace Zhele::Timers;
+
+using UsartConnection = Usart1;
+using Led = Pa7;
+
+using Loop = EventLoop<16, 1>;
+using Wheel = TimerWheel<Timer2>;
+
+char TxBuffer[] = "SomeData";
+char RxBuffer[9];
+
+Task Blink()
+{
+    for (;;)
+    {
+        Led::Toggle();
+        co_await Sleep<Loop, Wheel>(500);
+    }
+}
+
+// Sequential code without callbacks: coroutine is suspended (CPU sleeps) while DMA transfers data
+Task Echo()
+{
+    for (;;)
+    {
+        UsartConnection::Write(TxBuffer, 9, true);
+        auto [data, size, success] = co_await Await<Loop>([](TransferCallback callback) {
+            UsartConnection::EnableAsyncRead(RxBuffer, 9, callback);
+        });
+
+        if (success)
+            co_await Sleep<Loop, Wheel>(1000);
+    }
+}
+
+int main()
+{
+    Led::Port::Enable();
+    Led::SetConfiguration(Led::Configuration::Out);
+    Led::SetDriverType(Led::DriverType::PushPull);
+
+    // 1 ms tick
+    Wheel::Init(1000);
+
+    UsartConnection::Init(9600);
+    UsartConnection::SelectTxRxPins<Pb6, Pb7>();
+
+    Spawn<Loop>(Blink());
+    Spawn<Loop>(Echo());
+
+    Loop::Run();
+}
+
+extern "C"
+{
+    void TIM2_IRQHandler()
+    {
+        Wheel::IrqHandler();
+    }
+}
@@ -0,0 +1,38 @@
+#include <dac.h>
+#include <dma.h>
+#include <iopins.h>
+#include <timer.h>
+
+using namespace Zhele;
+using namespace Zhele::IO;
+using namespace Zhele::Timers;
+
+// Quadrature (I/Q) square waves on PA4/PA5, both outputs are updated at the same instant
+static const uint16_t PeriodSize = 4;
+const uint32_t Quadrature[PeriodSize] = {
+    Dac1Dual::Pack(4095, 0),
+    Dac1Dual::Pack(4095, 4095),
+    Dac1Dual::Pack(0, 4095),
+    Dac1Dual::Pack(0, 0),
+};
+
+int main()
+{
+    Porta::Enable();
+    Pa4::SetConfiguration(Pa4::Configuration::Analog);
+    Pa5::SetConfiguration(Pa5::Configuration::Analog);
+
+    Dac1Dual::StartStream<Dma1Stream5, Timer2>(Quadrature, PeriodSize, 100000, true, nullptr);
+
+    for (;;)
+    {
+    }
+}
+
+extern "C"
+{
+    void DMA1_Stream5_IRQHandler()
+    {
+        Dma1Stream5::IrqHandler();
+    }
+}
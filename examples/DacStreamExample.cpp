@@ -0,0 +1,34 @@
+#include <dac.h>
+#include <dma.h>
+#include <iopins.h>
+#include <timer.h>
+#include <common/template_utils/lookup_tables.h>
+
+using namespace Zhele;
+using namespace Zhele::IO;
+using namespace Zhele::Timers;
+
+// One sine period (64 samples, generated at compile time) output endlessly at 256 kS/s (4 kHz sine) on PA4
+static const uint16_t SineSize = 64;
+constexpr auto Sine = TemplateUtils::SineTable<uint16_t, SineSize>(2047.5, 2047.5);
+
+int main()
+{
+    Porta::Enable();
+    Pa4::SetConfiguration(Pa4::Configuration::Analog);
+
+    // Buffer is constant, so callback does nothing. Refill sent half here to play arbitrary stream.
+    Dac1Channel1::StartStream<Dma1Stream5, Timer2>(Sine.Data(), SineSize, 256000, true, nullptr);
+
+    for (;;)
+    {
+    }
+}
+
+extern "C"
+{
+    void DMA1_Stream5_IRQHandler()
+    {
+        Dma1Stream5::IrqHandler();
+    }
+}
@@ -0,0 +1,60 @@
+// Define target cpu frequence
+#define F_CPU 168000000
+
+#include <fsmc.h>
+#include <drivers/dma2d_framebuffer.h>
+#include <drivers/graphics.h>
+#include <drivers/ili9341.h>
+
+using namespace Zhele;
+using namespace Zhele::IO;
+using namespace Zhele::Drivers;
+
+// stm32f429 board: ILI9341 on FSMC NE4 (A6 is DC), framebuffer (150 KB) in internal SRAM.
+using LcdPins = PinList<Pd14, Pd15, Pd0, Pd1, Pe7, Pe8, Pe9, Pe10, Pe11, Pe12, Pe13, Pe14, Pe15, Pd8, Pd9, Pd10, Pd4, Pd5, Pg12, Pf12>;
+using Bus = FsmcBus<LcdPins, 4, 6>;
+using Lcd = Ili9341<Bus, Pb1>;
+
+// Primitives are drawn into framebuffer by DMA2D
+using Screen = Dma2DFramebuffer<Lcd::Width, Lcd::Height>;
+using Canvas = Graphics<Screen>;
+
+// 16x16 translucent sprite (ARGB4444) and cursor alpha mask (A8)
+static uint16_t Sprite[16 * 16];
+static uint8_t Cursor[8 * 8];
+
+int main()
+{
+    Bus::Init(FsmcBase::CalculateTiming(F_CPU, 15, 360), FsmcBase::CalculateTiming(F_CPU, 10, 30));
+    Lcd::Init();
+    Screen::Init();
+
+    for(unsigned i = 0; i < sizeof(Sprite) / sizeof(Sprite[0]); ++i)
+        Sprite[i] = 0x80f0 | (i & 0x0f);
+    for(unsigned i = 0; i < sizeof(Cursor); ++i)
+        Cursor[i] = (i % 8) * 32;
+
+    int offset = 0;
+    for (;;)
+    {
+        // CPU prepares next primitive while DMA2D fills previous one
+        Canvas::FillRectangle(0, 0, Lcd::Width, Lcd::Height, Lcd::Color::Black);
+        Canvas::FillRectangle(20, 20, 120, 80, Lcd::Color::Blue);
+        Canvas::DrawCircle(160, 120, 50, Lcd::Color::White);
+        Screen::BlendImage(offset % (Lcd::Width - 16), 100, Sprite, 16, 16, Dma2D::ColorMode::Argb4444);
+        Screen::BlendImage(200, 40, Cursor, 8, 8, Dma2D::ColorMode::A8, 255, 0xff0000);
+        ++offset;
+
+        Lcd::WriteFramebufferAsync<Dma2Stream0>(Screen::Data());
+        while(Lcd::Busy())
+            continue;
+    }
+}
+
+extern "C"
+{
+    void DMA2_Stream0_IRQHandler()
+    {
+        Dma2Stream0::IrqHandler();
+    }
+}
@@ -0,0 +1,47 @@
+#include <dma.h>
+
+using namespace Zhele;
+
+/// DmaMemory uses given channels as memcpy/memset accelerator.
+/// Each request takes first free channel, so two transfers can run simultaneously in this example.
+#if defined (STM32F4)
+    using Dma = DmaMemory<Dma2Stream0, Dma2Stream1>; // Only DMA2 is able to perform memory-to-memory transfers.
+#else
+    using Dma = DmaMemory<Dma1Channel1, Dma1Channel2>;
+#endif
+
+void CopyCallback(void* data, unsigned size, bool success);
+void FillCallback(void* data, unsigned size, bool success);
+
+uint32_t Source[256];
+uint32_t Destination[256];
+uint8_t FrameBuffer[1024];
+
+int main()
+{
+    for(unsigned i = 0; i < 256; ++i)
+        Source[i] = i;
+
+    // Buffers are 4-bytes-aligned, so DMA transfers words
+    Dma::CopyAsync(Destination, Source, sizeof(Source), CopyCallback);
+    // Clear frame buffer (for example, for SSD1306) without CPU
+    Dma::FillAsync(FrameBuffer, 0x00, sizeof(FrameBuffer), FillCallback);
+
+    while(Dma::Busy())
+        continue;
+
+    for (;;)
+    {
+    }
+}
+
+void CopyCallback(void* data, unsigned size, bool success)
+{
+    // Set breakpoint on this dummy code and check Destination in debugger. It contains 0, 1, 2, ...
+    volatile int dummy = 42;
+}
+
+void FillCallback(void* data, unsigned size, bool success)
+{
+    volatile int dummy = 42;
+}
@@ -0,0 +1,63 @@
+#define F_CPU 72000000
+
+#include <dma.h>
+#include <iopins.h>
+#include <spi.h>
+#include <usart.h>
+
+using namespace Zhele;
+using namespace Zhele::IO;
+
+// On stm32f1 SPI1 TX and USART3 RX are mapped to the same DMA1 channel 3.
+// DmaChannelArbiter allows them to time-share channel: each owner starts
+// its transfer in grant callback and releases channel in transfer complete callback.
+using SpiInterface = Spi1;
+using UsartConnection = Usart3;
+using SharedChannel = DmaChannelArbiter<Dma1Channel3>;
+
+// Any unique addresses can be used as owners
+const char SpiOwner = 0;
+const char UsartOwner = 0;
+
+uint8_t SpiData[] = {0xde, 0xad, 0xbe, 0xef};
+uint8_t UsartData[4];
+
+void StartSpiWrite()
+{
+    SpiInterface::WriteAsync(SpiData, sizeof(SpiData), [](void*, unsigned, bool){
+        // Peripheral DMA request must be disabled before release
+        SpiInterface::DisableDma();
+        SharedChannel::Release(&SpiOwner);
+    });
+}
+
+void StartUsartRead()
+{
+    UsartConnection::EnableAsyncRead(UsartData, sizeof(UsartData), [](void*, unsigned, bool){
+        UsartConnection::DisableDma();
+        SharedChannel::Release(&UsartOwner);
+
+        // Echo received data via SPI
+        SharedChannel::RequestChannel(&SpiOwner, StartSpiWrite);
+        // And receive next packet
+        SharedChannel::RequestChannel(&UsartOwner, StartUsartRead);
+    });
+}
+
+int main()
+{
+    SpiInterface::Init();
+    SpiInterface::SelectPins<Pa7, Pa6, Pa5, Pa4>();
+
+    UsartConnection::Init(115200);
+    UsartConnection::SelectTxRxPins<Pb10, Pb11>();
+
+    // Channel is free, so SPI transfer starts immediately.
+    SharedChannel::RequestChannel(&SpiOwner, StartSpiWrite);
+    // Channel is busy, so USART receive is queued and starts when SPI releases channel.
+    SharedChannel::RequestChannel(&UsartOwner, StartUsartRead);
+
+    for (;;)
+    {
+    }
+}
@@ -0,0 +1,37 @@
+// Define target cpu frequence.
+#define F_CPU 8000000
+
+#include <exti.h>
+#include <i2c.h>
+#include <drivers/ds1307.h>
+
+using namespace Zhele;
+using namespace Zhele::Drivers;
+
+// SQW/OUT is connected to PB1
+using Rtc = Ds1307CachedClock<I2c1, Exti1, IO::Pb1>;
+
+int main()
+{
+    I2c1::Init();
+    I2c1::SelectPins<IO::Pb6, IO::Pb7>();
+
+    // Read time once, re-sync every 10 minutes
+    Rtc::Init(600);
+
+    for (;;)
+    {
+        Rtc::Poll();
+
+        // Memory read, no I2C transaction
+        volatile auto time = Rtc::GetDateTime();
+    }
+}
+
+extern "C"
+{
+    void EXTI1_IRQHandler()
+    {
+        Rtc::IrqHandler();
+    }
+}
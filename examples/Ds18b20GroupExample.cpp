@@ -0,0 +1,34 @@
+#define F_CPU 8000000
+
+#include <iopins.h>
+#include <usart.h>
+#include <one_wire.h>
+#include <drivers/ds18b20.h>
+
+using namespace Zhele;
+
+using OneWireBus = OneWire<Usart1, IO::Pa9>;
+using TempSensor = Drivers::Ds18b20<OneWireBus>;
+
+static const uint8_t MaxSensors = 32;
+uint8_t Roms[MaxSensors][8];
+TempSensor::ConvertResult Results[MaxSensors];
+
+int main()
+{
+    TempSensor::Init();
+
+    // Find all DS18B20 on line (other devices are skipped by family code)
+    uint8_t sensorsCount = TempSensor::Enumerate(Roms, MaxSensors);
+
+    for (;;)
+    {
+        // One SKIP ROM convert for all sensors and one wait
+        if (TempSensor::ConvertAll<12>())
+            TempSensor::ReadAll(Roms, sensorsCount, Results);
+
+        // Sensors with alarm condition (temperature out of TH/TL)
+        uint8_t alarms[MaxSensors][8];
+        volatile uint8_t alarmsCount = OneWireBus::Enumerate(alarms, MaxSensors, TempSensor::FamilyCode, true);
+    }
+}
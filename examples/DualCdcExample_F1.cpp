@@ -0,0 +1,78 @@
+#include <clock.h>
+#include <iopins.h>
+#include <usb.h>
+
+#include <string.h>
+
+using namespace Zhele;
+using namespace Zhele::Clock;
+using namespace Zhele::IO;
+using namespace Zhele::Usb;
+
+// Port 0: high-rate data (1 KB FIFOs), port 1: control console
+using Cdc = DualCdc<DefaultEp0, 0, 1024, 1024, 256, 256, 2>;
+
+using Config = Configuration<0, 250, false, false, Cdc::Comm0, Cdc::Data0, Cdc::Comm1, Cdc::Data1>;
+using MyDevice = Device<0x0200, DeviceAndInterfaceClass::Miscellaneous, 0x02, 0x01, 0x0483, 0x5742, 0, Cdc::Ep0, Config>;
+
+void ConfigureClock();
+
+int main()
+{
+    ConfigureClock();
+    Zhele::IO::Porta::Enable();
+    MyDevice::Enable();
+
+    // 1 ms tick for flush timeout
+    SysTick_Config(SysClock::ClockFreq() / 1000);
+
+    uint8_t data[64];
+    for(uint8_t i = 0; i < sizeof(data); ++i)
+        data[i] = i;
+
+    uint8_t command[32];
+    for(;;)
+    {
+        // Data port streams as fast as host reads, console is not blocked by it (and vice versa)
+        Cdc::Stream0::Write(data, Cdc::Stream0::WriteAvailable() < sizeof(data) ? Cdc::Stream0::WriteAvailable() : sizeof(data));
+
+        unsigned size = Cdc::Stream1::Read(command, sizeof(command));
+        if(size > 0)
+        {
+            const char reply[] = "ok\r\n";
+            Cdc::Stream1::Write(reply, strlen(reply));
+            Cdc::Stream1::Flush();
+        }
+    }
+}
+
+void ConfigureClock()
+{
+    PllClock::SelectClockSource(PllClock::ClockSource::External);
+    PllClock::SetMultiplier(9);
+    Apb1Clock::SetPrescaler(Apb1Clock::Div2);
+    SysClock::SelectClockSource(SysClock::Pll);
+    MyDevice::SelectClockSource(Zhele::Usb::ClockSource::PllDividedOneAndHalf);
+}
+
+template<>
+void Cdc::OutEp0::HandleRx(void* data, uint16_t size)
+{
+    Cdc::Stream0::HandleRx(data, size);
+}
+
+template<>
+void Cdc::OutEp1::HandleRx(void* data, uint16_t size)
+{
+    Cdc::Stream1::HandleRx(data, size);
+}
+
+extern "C" void SysTick_Handler()
+{
+    Cdc::Tick();
+}
+
+extern "C" void USB_LP_IRQHandler()
+{
+    MyDevice::CommonHandler();
+}
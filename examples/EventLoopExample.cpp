@@ -0,0 +1,52 @@
+#define F_CPU 8000000
+
+#include <usart.h>
+#include <common/event_loop.h>
+
+using namespace Zhele;
+using namespace Zhele::IO;
+
+using UsartConnection = Usart1;
+using Led = Pa7;
+
+// Two priorities: 1 - data processing, 0 - background jobs
+using Loop = EventLoop<16, 2>;
+
+char TxBuffer[] = "SomeData";
+char RxBuffer[9];
+
+void TransferCompleteHandler(void* data, unsigned size, bool success);
+
+// Target callback should have static storage duration
+const TransferCallback RxHandler = TransferCompleteHandler;
+
+// I have made connect USART1_Tx pin (PB6) with USART1_Rx pin (PB7).
+// So, controller will send data to itself.
+int main()
+{
+    Led::Port::Enable();
+    Led::SetConfiguration(Led::Configuration::Out);
+    Led::SetDriverType(Led::DriverType::PushPull);
+    Led::Set();
+
+    UsartConnection::Init(9600);
+    UsartConnection::SelectTxRxPins<Pb6, Pb7>();
+
+    // DMA interrupt only posts event, handler is called from main loop
+    UsartConnection::EnableAsyncRead(RxBuffer, 9, Loop::Defer(RxHandler, 1));
+    UsartConnection::Write(TxBuffer, 9, true);
+
+    // Events can be posted from thread too
+    Loop::Post([] { Led::Set(); });
+
+    Loop::Run();
+}
+
+void TransferCompleteHandler(void* data, unsigned size, bool success)
+{
+    if(success)
+    {
+        // Heavy processing is allowed here: it is not interrupt context
+        Led::Clear();
+    }
+}
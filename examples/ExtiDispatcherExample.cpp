@@ -0,0 +1,57 @@
+#include <exti.h>
+#include <iopins.h>
+
+using namespace Zhele;
+using namespace Zhele::IO;
+
+void OnButton();
+void OnEncoder();
+void OnIr();
+
+// Lines 5-9 share EXTI9_5 IRQ, dispatcher calls handler of every pending line
+using Dispatcher = ExtiDispatcher<
+    ExtiHandler<Exti5, OnButton>,
+    ExtiHandler<Exti6, OnEncoder>,
+    ExtiHandler<Exti8, OnIr>>;
+
+int main()
+{
+	Pc13::Port::Enable();
+	Pc13::SetConfiguration(Pc13::Configuration::Out);
+
+	Exti5::Init<Exti5::Trigger::Falling, Porta>();
+	Exti5::InitPin<Pa5>(Pa5::PullMode::PullUp);
+	Exti6::Init<Exti6::Trigger::RisingFalling, Portb>();
+	Exti6::InitPin<Pb6>(Pb6::PullMode::PullUp);
+	Exti8::Init<Exti8::Trigger::Falling, Porta>();
+	Exti8::InitPin<Pa8>(Pa8::PullMode::PullUp);
+
+	Exti5::EnableInterrupt();
+	Exti6::EnableInterrupt();
+	Exti8::EnableInterrupt();
+
+	for (;;)
+	{
+	}
+}
+
+void OnButton()
+{
+	Pc13::Toggle();
+}
+
+void OnEncoder()
+{
+}
+
+void OnIr()
+{
+}
+
+extern "C"
+{
+	void EXTI9_5_IRQHandler() // "void EXTI4_15_IRQHandler()" with EXTI4_15_IRQn for Stm32F0
+	{
+		Dispatcher::IrqHandler<EXTI9_5_IRQn>();
+	}
+}
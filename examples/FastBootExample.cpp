@@ -0,0 +1,47 @@
+#include <common/clock_tree.h>
+#include <iopins.h>
+#include <usart.h>
+
+using namespace Zhele;
+using namespace Zhele::Clock;
+using namespace Zhele::IO;
+
+using Clocks = ClockTree<72000000, false, 8000000>;
+using Serial = Usart1;
+
+void ConfigureSerial();
+
+int main()
+{
+    // CPU runs from HSI while HSE starts and PLL locks
+    Clocks::InitAsync(ConfigureSerial);
+
+    // Clock independent init is done meanwhile
+    Pc13::Port::Enable();
+    Pc13::SetConfiguration(Pc13::Configuration::Out);
+    Pc13::Set();
+
+    while(!Clocks::Ready())
+        continue;
+
+    Serial::Write("Hello", 5);
+
+    for (;;)
+    {
+    }
+}
+
+void ConfigureSerial()
+{
+    // Serial baud rate depends on final APB2 clock
+    Serial::Init(9600);
+    Serial::SelectTxRxPins<Pa9, Pa10>();
+}
+
+extern "C"
+{
+    void RCC_IRQHandler()
+    {
+        Clocks::IrqHandler();
+    }
+}
@@ -0,0 +1,129 @@
+// Two coroutine tasks share one FatFs volume: logger appends records, console prints log file by request.
+// Library should be built with FF_FS_REENTRANT=1 and drive table header ZHELE_FATFS_DRIVES_CONFIG, for example:
+// namespace Zhele::Drivers::Filesystem { using FatFsDrives = FatFsDriveTable<SdCardAdapter>; }
+#define F_CPU 72000000
+
+#include <clock.h>
+#include <iopins.h>
+#include <spi.h>
+#include <timer.h>
+#include <usart.h>
+#include <common/async.h>
+
+#include <drivers/filesystem/fatfs/ff.h>
+#include <drivers/filesystem/fatfs_lock.h>
+
+#include <stdio.h>
+
+using namespace Zhele;
+using namespace Zhele::Async;
+using namespace Zhele::Clock;
+using namespace Zhele::IO;
+using namespace Zhele::Timers;
+using namespace Zhele::Drivers::Filesystem;
+
+using UsartConnection = Usart1;
+
+using Loop = EventLoop<16, 1>;
+using Wheel = TimerWheel<Timer2>;
+
+FATFS Fs;
+char Command[1];
+
+// Volume is locked during single file function only, so task waits for it (file function of interrupt
+// or nested event may be in progress) and splits long operations into several calls.
+Task WaitVolume()
+{
+    while(FatFsLock::Locked(0))
+        co_await Yield<Loop>();
+}
+
+Task Logger()
+{
+    static FIL file;
+    static char record[32];
+    for(unsigned counter = 0;; ++counter)
+    {
+        co_await Sleep<Loop, Wheel>(1000);
+        co_await WaitVolume();
+
+        if(f_open(&file, "log.txt", FA_WRITE | FA_OPEN_APPEND) != FR_OK)
+            continue;
+
+        UINT written;
+        int size = snprintf(record, sizeof(record), "Record %u\r\n", counter);
+        f_write(&file, record, size, &written);
+        f_close(&file);
+    }
+}
+
+Task Console()
+{
+    static FIL file;
+    static char buffer[64];
+    for(;;)
+    {
+        co_await Await<Loop>([](TransferCallback callback) {
+            UsartConnection::EnableAsyncRead(Command, 1, callback);
+        });
+
+        if(Command[0] != 'p')
+            continue;
+
+        co_await WaitVolume();
+        if(f_open(&file, "log.txt", FA_READ) != FR_OK)
+            continue;
+
+        UINT read = sizeof(buffer);
+        while(read == sizeof(buffer))
+        {
+            // Logger can append record between chunks
+            co_await WaitVolume();
+            if(f_read(&file, buffer, sizeof(buffer), &read) != FR_OK)
+                break;
+            UsartConnection::Write(buffer, read);
+            co_await Yield<Loop>();
+        }
+        f_close(&file);
+    }
+}
+
+void ConfigureClock();
+
+int main()
+{
+    ConfigureClock();
+
+    // 1 ms tick
+    Wheel::Init(1000);
+
+    UsartConnection::Init(115200);
+    UsartConnection::SelectTxRxPins<Pa9, Pa10>();
+
+    Spi1::Init(Spi1::Fast, Spi1::Master);
+    Spi1::SelectPins<Pa7, Pa6, Pa5, Pa4>();
+
+    if(f_mount(&Fs, "", 1) != FR_OK)
+        UsartConnection::Write("Mount fail\r\n", 12);
+
+    Spawn<Loop>(Logger());
+    Spawn<Loop>(Console());
+
+    Loop::Run();
+}
+
+void ConfigureClock()
+{
+    PllClock::SelectClockSource(PllClock::ClockSource::External);
+    PllClock::SetMultiplier(9);
+    Apb1Clock::SetPrescaler(Apb1Clock::Div2);
+    SysClock::SelectClockSource(SysClock::Pll);
+}
+
+extern "C"
+{
+    void TIM2_IRQHandler()
+    {
+        Wheel::IrqHandler();
+    }
+}
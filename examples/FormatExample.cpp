@@ -0,0 +1,63 @@
+// Define target cpu frequence.
+#define F_CPU 8000000
+
+#include <i2c.h>
+#include <usart.h>
+#include <binary_stream.h>
+#include <common/format.h>
+#include <drivers/ssd1306.h>
+#include <drivers/fonts.h>
+
+using namespace Zhele;
+using namespace Zhele::Drivers;
+using namespace Zhele::Formatting;
+
+using Lcd = Ssd1306<I2c1>;
+
+int main()
+{
+    Usart1::Init(115200);
+    Usart1::SelectTxRxPins<IO::Pa9, IO::Pa10>();
+
+    I2c1::Init(400000);
+    I2c1::SelectPins<IO::Pb6, IO::Pb7>();
+    Lcd::Init();
+
+    BinaryStream<Usart1> stream;
+    int32_t temperature = 21 << 8; // Q8 (1/256 degree)
+    uint32_t counter = 0;
+
+    for (;;)
+    {
+        // Format is parsed at compile time, numbers are formatted without printf and heap
+        Print<"#%05u T=%.2f status=0x%04X\r\n">(stream, counter, Fixed<8>{temperature}, counter & 0xffff);
+
+        while(Lcd::UpdateInProgress())
+            continue;
+        Lcd::Fill(Lcd::Pixel::Off);
+        Lcd::Goto(0, 0);
+        Lcd::Puts<TimesNewRoman13>(ToString<"T=%.1f C, n=%u">(Fixed<8>{temperature}, counter).c_str());
+        Lcd::Update();
+
+        ++counter;
+        temperature += 13;
+    }
+}
+
+extern "C"
+{
+    void I2C1_EV_IRQHandler()
+    {
+        I2c1::EventIrqHandler();
+    }
+
+    void I2C1_ER_IRQHandler()
+    {
+        I2c1::ErrorIrqHandler();
+    }
+
+    void DMA1_Channel6_IRQHandler()
+    {
+        Dma1Channel6::IrqHandler();
+    }
+}
@@ -0,0 +1,58 @@
+#define F_CPU 72000000
+
+#include <clock.h>
+#include <iopins.h>
+#include <timer.h>
+#include <common/frequency_counter.h>
+
+using namespace Zhele;
+using namespace Zhele::Clock;
+using namespace Zhele::IO;
+using namespace Zhele::Timers;
+
+// Input signal (PA0 is TIM2_CH1_ETR) is counted by Timer2, Timer3 opens 100 ms gate (Timer3 TRGO is TIM2 ITR2).
+// Frequencies from ~0.1 Hz (reciprocal method) up to ~36 MHz (gated counting with ETR prescaler)
+// are measured with a few interrupts per gate.
+using Counter = FrequencyCounter<Timer2, Timer3, Timer2::SlaveMode::Trigger::InternalTrigger2>;
+
+ZHELE_IRQ_PRIORITY(TIM2_IRQn, 1);
+ZHELE_IRQ_PRIORITY(TIM3_IRQn, 2);
+
+volatile uint64_t Frequency; // mHz
+
+void ConfigureClock();
+
+int main()
+{
+    ConfigureClock();
+
+    Counter::SelectPins<Pa0>();
+    Counter::Start(100, [](uint64_t frequency) {
+        Frequency = frequency;
+    });
+
+    for (;;)
+    {
+    }
+}
+
+void ConfigureClock()
+{
+    PllClock::SelectClockSource(PllClock::ClockSource::External);
+    PllClock::SetMultiplier(9);
+    Apb1Clock::SetPrescaler(Apb1Clock::Div2);
+    SysClock::SelectClockSource(SysClock::Pll);
+}
+
+extern "C"
+{
+    void TIM2_IRQHandler()
+    {
+        Counter::CounterIrqHandler();
+    }
+
+    void TIM3_IRQHandler()
+    {
+        Counter::GateIrqHandler();
+    }
+}
@@ -0,0 +1,59 @@
+// Define target cpu frequence
+#define F_CPU 168000000
+
+#include <fsmc.h>
+#include <drivers/ili9341.h>
+#include <common/macro_utils/declarations.h>
+
+using namespace Zhele;
+using namespace Zhele::IO;
+using namespace Zhele::Drivers;
+
+// stm32f407ze board: ILI9341 on NE4 (A6 is DC), 1 MB SRAM IS62WV51216 on NE3.
+// Linker script includes Zhele/linker/extram_fsmc.ld (EXTRAM at 0x68000000).
+// Data, NOE/NWE and A6 pins are shared, they are configured by display bus Init.
+using LcdPins = PinList<Pd14, Pd15, Pd0, Pd1, Pe7, Pe8, Pe9, Pe10, Pe11, Pe12, Pe13, Pe14, Pe15, Pd8, Pd9, Pd10, Pd4, Pd5, Pg12, Pf12>;
+using SramPins = PinList<Pg10, Pe0, Pe1, Pf0, Pf1, Pf2, Pf3, Pf4, Pf5, Pf13, Pf14, Pf15, Pg0, Pg1, Pg2, Pg3, Pg4, Pg5, Pd11, Pd12, Pd13>;
+
+using Bus = FsmcBus<LcdPins, 4, 6>;
+using Lcd = Ili9341<Bus, Pb1>;
+using Sram = FsmcBank3;
+
+// Full screen framebuffer (150 KB) is located in external SRAM
+ZHELE_EXTRAM static uint16_t Framebuffer[Lcd::Width * Lcd::Height];
+
+int main()
+{
+    // ILI9341: read cycle is 450 ns, write cycle is 66 ns
+    Bus::Init(FsmcBase::CalculateTiming(F_CPU, 15, 360), FsmcBase::CalculateTiming(F_CPU, 10, 30));
+    Lcd::Init();
+
+    // SRAM: 10 ns access (two HCLK cycles at 168 MHz + turnaround)
+    Sram::SelectPins<SramPins>();
+    Sram::Init(FsmcBase::MemoryType::Sram, FsmcBase::BusWidth::Bus16, FsmcBase::CalculateTiming(F_CPU, 0, 12, 6));
+
+    uint16_t offset = 0;
+    for (;;)
+    {
+        // Every pixel of framebuffer is plain memory store
+        for(unsigned line = 0; line < Lcd::Height; ++line)
+        {
+            for(unsigned column = 0; column < Lcd::Width; ++column)
+                Framebuffer[line * Lcd::Width + column] = ((column + offset) & 0x1f) | (((line + offset) & 0x3f) << 5);
+        }
+        ++offset;
+
+        // DMA2 copies framebuffer from SRAM to display, frame is prepared again after transfer is completed
+        Lcd::WriteFramebufferAsync<Dma2Stream0>(Framebuffer);
+        while(Lcd::Busy())
+            continue;
+    }
+}
+
+extern "C"
+{
+    void DMA2_Stream0_IRQHandler()
+    {
+        Dma2Stream0::IrqHandler();
+    }
+}
@@ -0,0 +1,69 @@
+#define F_CPU 72000000
+
+#include <clock.h>
+#include <dma.h>
+#include <iopins.h>
+#include <pinlist.h>
+#include <timer.h>
+#include <usart.h>
+#include <common/gpio_dma.h>
+
+using namespace Zhele;
+using namespace Zhele::Clock;
+using namespace Zhele::IO;
+using namespace Zhele::Timers;
+
+// 4-channel logic analyzer on B12..B15: Timer1 update paces DMA1 channel 5 (TIM1_UP request)
+using Probes = PinList<Pb12, Pb13, Pb14, Pb15>;
+using Sampler = GpioSampler<Probes, Timer1, Dma1Channel5>;
+
+void ConfigureClock();
+
+uint16_t Samples[2][256];
+uint8_t Values[256];
+volatile bool Captured = false;
+
+int main()
+{
+    ConfigureClock();
+    Usart1::Init(921600);
+    Usart1::SelectTxRxPins<Pa9, Pa10>();
+
+    // 4 MS/s
+    Sampler::Init(4000000, Probes::PullMode::PullDown);
+    Sampler::Start(Samples[0], 256, [](void*, unsigned, bool){ Captured = true; });
+    while(!Captured)
+        continue;
+    Sampler::Stop();
+
+    // Convert raw port values to 4-bit samples (first probe is bit 0)
+    Sampler::Extract(Samples[0], Values, 256);
+    Usart1::Write(Values, sizeof(Values));
+
+    // Then stream data continuously: half of buffer is sent while DMA fills the other one
+    Sampler::SetRate(100000);
+    Sampler::StartContinuous(&Samples[0][0], 256, [](void* data, unsigned size, bool success){
+        Sampler::Extract(static_cast<uint16_t*>(data), Values, size);
+        Usart1::Write(Values, size, true);
+    });
+
+    for (;;)
+    {
+    }
+}
+
+void ConfigureClock()
+{
+    PllClock::SelectClockSource(PllClock::ClockSource::External);
+    PllClock::SetMultiplier(9);
+    Apb1Clock::SetPrescaler(Apb1Clock::Div2);
+    SysClock::SelectClockSource(SysClock::Pll);
+}
+
+extern "C"
+{
+    void DMA1_Channel5_IRQHandler()
+    {
+        Dma1Channel5::IrqHandler();
+    }
+}
@@ -0,0 +1,55 @@
+#define F_CPU 72000000
+
+#include <clock.h>
+#include <dma.h>
+#include <iopins.h>
+#include <pinlist.h>
+#include <timer.h>
+#include <common/gpio_dma.h>
+
+using namespace Zhele;
+using namespace Zhele::Clock;
+using namespace Zhele::IO;
+using namespace Zhele::Timers;
+
+// 8-bit pattern generator on A0..A7: Timer2 update paces DMA1 channel 2 (TIM2_UP request)
+using Outputs = PinList<Pa0, Pa1, Pa2, Pa3, Pa4, Pa5, Pa6, Pa7>;
+using Generator = GpioStreamer<Outputs, Timer2, Dma1Channel2>;
+
+void ConfigureClock();
+
+// Walking one and counter pattern
+uint8_t Pattern[64];
+uint32_t Words[64];
+
+int main()
+{
+    ConfigureClock();
+
+    for(unsigned i = 0; i < 64; ++i)
+        Pattern[i] = i < 8 ? (1 << i) : i;
+    Generator::Encode(Pattern, Words, 64);
+
+    Generator::Init(1000000);
+    Generator::Start(Words, 64, nullptr, true);
+
+    for (;;)
+    {
+    }
+}
+
+void ConfigureClock()
+{
+    PllClock::SelectClockSource(PllClock::ClockSource::External);
+    PllClock::SetMultiplier(9);
+    Apb1Clock::SetPrescaler(Apb1Clock::Div2);
+    SysClock::SelectClockSource(SysClock::Pll);
+}
+
+extern "C"
+{
+    void DMA1_Channel2_IRQHandler()
+    {
+        Dma1Channel2::IrqHandler();
+    }
+}
@@ -0,0 +1,129 @@
+// Define target cpu frequence.
+#define F_CPU 72000000
+
+#include <clock.h>
+#include <spi.h>
+#include <i2c.h>
+#include <drivers/compressed_font.h>
+#include <drivers/graphics.h>
+#include <drivers/ssd1306.h>
+#include <drivers/st7735.h>
+
+using namespace Zhele;
+using namespace Zhele::Clock;
+using namespace Zhele::IO;
+using namespace Zhele::Drivers;
+
+using Lcd = St7735<Spi1, IO::Pa4, IO::Pa3, IO::Pa2, 160, 128>;
+using Oled = Ssd1306<I2c1>;
+
+// The same drawing code for both displays: primitives are clipped spans
+using TftGraphics = Graphics<Lcd>;
+using OledGraphics = Graphics<Oled>;
+
+// Glyphs are run-length encoded at compile time and decoded directly to spans
+using BoldFont = CompressedFont<Fixed10x15Bold>;
+
+void ConfigureClock();
+void ConfigurePins();
+void ConfigureSpi();
+
+template<typename _Graphics>
+void DrawScene(typename _Graphics::Color color, typename _Graphics::Color background)
+{
+    _Graphics::FillRectangle(0, 0, 128, 64, background);
+    _Graphics::DrawRectangle(0, 0, 128, 64, color);
+    _Graphics::DrawLine(0, 63, 127, 0, color);
+    _Graphics::DrawCircle(96, 32, 20, color);
+    _Graphics::FillCircle(96, 32, 8, color);
+
+    // Text is clipped by rectangle
+    _Graphics::SetClip(4, 4, 60, 20);
+    _Graphics::template DrawString<TimesNewRoman13>(4, 8, "Clipped text line", color);
+    _Graphics::ResetClip();
+
+    _Graphics::template DrawString<BoldFont>(4, 40, "12:45", color);
+}
+
+int main()
+{
+    ConfigureClock();
+    ConfigurePins();
+    ConfigureSpi();
+
+    I2c1::Init(400000);
+    I2c1::SelectPins<IO::Pb6, IO::Pb7>();
+
+    Lcd::Init();
+    Oled::Init();
+
+    DrawScene<TftGraphics>(Lcd::Color::Yellow, Lcd::Color::Blue);
+    DrawScene<OledGraphics>(Oled::Pixel::On, Oled::Pixel::Off);
+    // Ssd1306 is framebuffer display: send modified regions
+    Oled::Update();
+
+    for (;;)
+    {
+    }
+}
+
+void ConfigureClock()
+{
+    PllClock::SelectClockSource(PllClock::ClockSource::External);
+    PllClock::SetMultiplier(9);
+    Apb1Clock::SetPrescaler(Apb1Clock::Div2);
+    SysClock::SelectClockSource(SysClock::Pll);
+}
+
+void ConfigurePins()
+{
+    Pa4::Port::Enable();
+    Pa4::SetConfiguration(Pa4::Configuration::Out);
+    Pa4::SetDriverType(Pa4::DriverType::PushPull);
+    Pa4::SetSpeed(Pa4::Speed::Fast);
+    Pa4::Set();
+
+    Pa3::Port::Enable();
+    Pa3::SetConfiguration(Pa3::Configuration::Out);
+    Pa3::SetDriverType(Pa3::DriverType::PushPull);
+    Pa3::SetSpeed(Pa3::Speed::Fast);
+    Pa3::Clear();
+
+    Pa2::Port::Enable();
+    Pa2::SetConfiguration(Pa2::Configuration::Out);
+    Pa2::SetDriverType(Pa2::DriverType::PushPull);
+    Pa2::SetSpeed(Pa2::Speed::Fast);
+    Pa2::Clear();
+}
+
+void ConfigureSpi()
+{
+    Spi1::Init(Spi1::ClockDivider::Fastest);
+    Spi1::SetClockPolarity(Spi1::ClockPolarity::ClockPolarityHigh);
+    Spi1::SetClockPhase(Spi1::ClockPhase::ClockPhaseFallingEdge);
+    Spi1::SelectPins<IO::Pa7, IO::Pa6, IO::Pa5, IO::NullPin>();
+}
+extern "C"
+{
+    // Large fills are sent by SPI DMA
+    void DMA1_Channel3_IRQHandler()
+    {
+        Dma1Channel3::IrqHandler();
+    }
+
+    // Oled::Update is asynchronous: transaction is driven by I2C and DMA interrupts
+    void I2C1_EV_IRQHandler()
+    {
+        I2c1::EventIrqHandler();
+    }
+
+    void I2C1_ER_IRQHandler()
+    {
+        I2c1::ErrorIrqHandler();
+    }
+
+    void DMA1_Channel6_IRQHandler()
+    {
+        Dma1Channel6::IrqHandler();
+    }
+}
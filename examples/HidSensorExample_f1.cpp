@@ -0,0 +1,112 @@
+#include <adc.h>
+#include <clock.h>
+#include <iopins.h>
+#include <timer.h>
+#include <usb.h>
+
+using namespace Zhele;
+using namespace Zhele::Clock;
+using namespace Zhele::IO;
+using namespace Zhele::Timers;
+using namespace Zhele::Usb;
+
+using Report = HidReport<
+        0x06, 0x00, 0xff,              // USAGE_PAGE (Vendor Defined)
+        0x09, 0x01,                    // USAGE (Vendor Usage 1)
+        0xa1, 0x01,                    // COLLECTION (Application)
+        0x85, 0x01,                    //   REPORT_ID (1)
+        0x09, 0x01,                    //   USAGE (Vendor Usage 1)
+        0x15, 0x00,                    //   LOGICAL_MINIMUM (0)
+        0x26, 0xff, 0x00,              //   LOGICAL_MAXIMUM (255)
+        0x75, 0x08,                    //   REPORT_SIZE (8)
+        0x95, 0x04,                    //   REPORT_COUNT (4)
+        0x81, 0x02,                    //   INPUT (Data,Var,Abs)
+        0x85, 0x02,                    //   REPORT_ID (2)
+        0x09, 0x02,                    //   USAGE (Vendor Usage 2)
+        0x95, 0x01,                    //   REPORT_COUNT (1)
+        0x81, 0x02,                    //   INPUT (Data,Var,Abs)
+        0xc0                           // END_COLLECTION
+    >;
+
+using HidDesc = HidImpl<0x1001, Report>;
+
+// Polling every 1 ms
+using SensorEpBase = InEndpointBase<1, EndpointType::Interrupt, 8, 1>;
+using EpInitializer = EndpointsInitializer<DefaultEp0, SensorEpBase>;
+
+using Ep0 = EpInitializer::ExtendEndpoint<DefaultEp0>;
+using SensorEp = EpInitializer::ExtendEndpoint<SensorEpBase>;
+
+using Hid = HidInterface<0, 0, 0, 0, HidDesc, Ep0, SensorEp>;
+using Config = Configuration<0, 250, false, false, Hid>;
+using MyDevice = Device<0x0200, DeviceAndInterfaceClass::InterfaceSpecified, 0, 0, 0x0483, 0x5712, 0, Ep0, Config>;
+
+// Report 1 - sensor data (4 bytes), report 2 - button state (1 byte)
+using Reports = HidReportQueue<SensorEp, 5, 1, 2>;
+
+using Button = Pa1;
+using SampleTimer = Timer2;
+
+void ConfigureClock();
+
+int main()
+{
+    ConfigureClock();
+
+    Porta::Enable();
+    Button::SetConfiguration<Button::Configuration::In>();
+    Button::SetPullMode<Button::PullMode::PullUp>();
+
+    Adc1::Init(Adc1::AdcDivider::Div6);
+    Adc1::SetSampleTime(0, 28);
+
+    MyDevice::Enable();
+
+    // 1 kHz sampling
+    SampleTimer::Enable();
+    SampleTimer::SetPrescaler(71);
+    SampleTimer::SetPeriod(999);
+    SampleTimer::EnableInterrupt();
+    SampleTimer::Start();
+
+    bool pressed = false;
+    for(;;)
+    {
+        // Button report is sent only if state changed
+        if(Button::IsSet() == pressed)
+        {
+            pressed = !pressed;
+            uint8_t report[] = {2, pressed};
+            Reports::Update(report, sizeof(report));
+        }
+    }
+}
+
+void ConfigureClock()
+{
+    PllClock::SelectClockSource(PllClock::ClockSource::External);
+    PllClock::SetMultiplier(9);
+    Apb1Clock::SetPrescaler(Apb1Clock::Div2);
+    SysClock::SelectClockSource(SysClock::Pll);
+    MyDevice::SelectClockSource(Zhele::Usb::ClockSource::PllDividedOneAndHalf);
+}
+
+extern "C"
+{
+    void TIM2_IRQHandler()
+    {
+        static uint16_t sequence = 0;
+        uint16_t value = Adc1::ReadInjected(0);
+
+        uint8_t report[] = {1, static_cast<uint8_t>(value), static_cast<uint8_t>(value >> 8), static_cast<uint8_t>(sequence), static_cast<uint8_t>(sequence >> 8)};
+        ++sequence;
+        Reports::Update(report, sizeof(report));
+
+        SampleTimer::ClearInterruptFlag();
+    }
+
+    void USB_LP_IRQHandler()
+    {
+        MyDevice::CommonHandler();
+    }
+}
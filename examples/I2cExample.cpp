@@ -31,4 +31,28 @@ int main()
     for (;;)
     {
     }
-}
\ No newline at end of file
+}
+
+extern "C"
+{
+    // Async operations are driven by I2C and DMA interrupts
+    void I2C1_EV_IRQHandler()
+    {
+        Interface::EventIrqHandler();
+    }
+
+    void I2C1_ER_IRQHandler()
+    {
+        Interface::ErrorIrqHandler();
+    }
+
+    void DMA1_Channel6_IRQHandler()
+    {
+        Dma1Channel6::IrqHandler();
+    }
+
+    void DMA1_Channel7_IRQHandler()
+    {
+        Dma1Channel7::IrqHandler();
+    }
+}
@@ -0,0 +1,59 @@
+#define F_CPU 168000000
+
+#include <i2s.h>
+#include <iopins.h>
+
+using namespace Zhele;
+using namespace Zhele::IO;
+
+using Microphone = I2s2;
+using Led = Pd12;
+
+// MEMS microphone (INMP441, 24-bit left channel) is captured at 16 kHz.
+// Every 8 ms callback gets half of buffer: 128 stereo frames, 2 half-words per sample.
+static uint16_t Samples[2][128 * 2 * 2];
+
+static volatile uint32_t Peak;
+
+void SamplesReceived(void* data, unsigned size, bool success)
+{
+    const uint16_t* words = static_cast<const uint16_t*>(data);
+    uint32_t peak = 0;
+    // Left channel sample is 4 half-words apart (left high, left low, right high, right low)
+    for(unsigned i = 0; i < size; i += 4)
+    {
+        int32_t sample = static_cast<int32_t>((words[i] << 16) | words[i + 1]) >> 8;
+        uint32_t magnitude = sample < 0 ? -sample : sample;
+        if(magnitude > peak)
+            peak = magnitude;
+    }
+    Peak = peak;
+}
+
+int main()
+{
+    Led::Port::Enable();
+    Led::SetConfiguration(Led::Configuration::Out);
+    Led::SetDriverType(Led::DriverType::PushPull);
+
+    Microphone::SelectPins<Pb15, Pb13, Pb12>();
+    Microphone::Init(16000, I2sBase::Mode::MasterRx, I2sBase::Standard::Philips, I2sBase::DataFormat::Data24Bit);
+    Microphone::StartReadStream(Samples[0], sizeof(Samples[0]) / sizeof(uint16_t), SamplesReceived);
+
+    for (;;)
+    {
+        // Led is on while sound is loud
+        if(Peak > (1 << 20))
+            Led::Set();
+        else
+            Led::Clear();
+    }
+}
+
+extern "C"
+{
+    void DMA1_Stream3_IRQHandler()
+    {
+        Dma1Stream3::IrqHandler();
+    }
+}
@@ -0,0 +1,45 @@
+#define F_CPU 72000000
+
+#include <clock.h>
+#include <dma.h>
+#include <iopins.h>
+#include <timer.h>
+#include <drivers/ir.h>
+
+using namespace Zhele;
+using namespace Zhele::Drivers;
+using namespace Zhele::IO;
+using namespace Zhele::Timers;
+using namespace Zhele::Clock;
+
+// IR receiver on PB6 (Timer4 channel 1). Both edges are timestamped by DMA, no interrupts are used.
+using Receiver = IrCaptureReceiver<Timer4, Pb6, Dma1Channel1>; // DMA1 channel 1 is TIM4_CH1
+
+void ConfigureClock();
+
+int main()
+{
+    ConfigureClock();
+
+    IrMultiDecoder::SetCallback([](const IrFrame& frame) {
+        if(frame.Protocol == IrProtocol::Nec && frame.Command == 0x45 && !frame.Repeat)
+        {
+            // Do smth
+        }
+    });
+
+    Receiver::Init();
+
+    for (;;)
+    {
+        Receiver::Poll();
+    }
+}
+
+void ConfigureClock()
+{
+    PllClock::SelectClockSource(PllClock::ClockSource::External);
+    PllClock::SetMultiplier(9);
+    Apb1Clock::SetPrescaler(Apb1Clock::Div2);
+    SysClock::SelectClockSource(SysClock::Pll);
+}
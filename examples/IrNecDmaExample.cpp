@@ -0,0 +1,73 @@
+#define F_CPU 72000000
+
+#include <clock.h>
+#include <dma.h>
+#include <iopins.h>
+#include <timer.h>
+#include <drivers/ir.h>
+
+using namespace Zhele;
+using namespace Zhele::Drivers;
+using namespace Zhele::IO;
+using namespace Zhele::Timers;
+using namespace Zhele::Clock;
+
+// IR receiver on PB6 (Timer4 channel 1). Falling edges are timestamped by DMA, frames are decoded in bulk.
+using CaptureTimer = Timer4;
+using FallingCapture = CaptureTimer::InputCapture<0>;
+using CaptureDma = Dma1Channel1; // TIM4_CH1
+
+static const uint16_t HalfSize = 34; // One NEC frame (start + 32 bits + stop)
+uint16_t Captures[2 * HalfSize];
+uint32_t Timestamps[HalfSize];
+CaptureTimestamps Extender;
+
+void ConfigureClock();
+
+int main()
+{
+    ConfigureClock();
+
+    Pb6::Port::Enable();
+    Pb6::SetConfiguration(Pb6::Configuration::In);
+    Pb6::SetPullMode(Pb6::PullMode::PullUp);
+
+    CaptureTimer::Enable();
+    CaptureTimer::SetPrescaler(CaptureTimer::GetClockFreq() / 1000000 - 1); // 1 us tick
+    CaptureTimer::SetPeriod(0xffff);
+
+    FallingCapture::SetCapturePolarity(FallingCapture::CapturePolarity::FallingEdge);
+    FallingCapture::SetCaptureMode(FallingCapture::CaptureMode::Direct);
+    FallingCapture::Enable();
+
+    NecDecoder::SetCallback([](NecDecoder::Command command) {
+        // Do smth
+    });
+
+    FallingCapture::StartCaptureStream<CaptureDma>(Captures, HalfSize, [](void* data, unsigned size, bool) {
+        Extender.Process(static_cast<const uint16_t*>(data), size, Timestamps);
+        IrEdgeDecoder<NecDecoder>::Process(Timestamps, size);
+    });
+
+    CaptureTimer::Start();
+
+    for (;;)
+    {
+    }
+}
+
+void ConfigureClock()
+{
+    PllClock::SelectClockSource(PllClock::ClockSource::External);
+    PllClock::SetMultiplier(9);
+    Apb1Clock::SetPrescaler(Apb1Clock::Div2);
+    SysClock::SelectClockSource(SysClock::Pll);
+}
+
+extern "C"
+{
+    void DMA1_Channel1_IRQHandler()
+    {
+        CaptureDma::IrqHandler();
+    }
+}
@@ -0,0 +1,36 @@
+#define F_CPU 8000000
+
+#include <iopins.h>
+#include <pinlist.h>
+#include <drivers/hd44780.h>
+
+using namespace Zhele::IO;
+using namespace Zhele::Drivers;
+
+// Data pins D4...D7 on one port in order, so every nibble costs one port write
+using DataPins = PinList<Pa0, Pa1, Pa2, Pa3>;
+// RS, E, RW (pass NullPin if RW is tied to ground)
+using lcd = LcdBuffered<DataPins, Pa4, Pa5, Pa6, 20, 4>;
+
+int main()
+{
+	lcd::Init();
+	lcd::Puts("Buffered HD44780\nUptime:");
+	lcd::Update();
+
+	for (unsigned seconds = 0; ; ++seconds)
+	{
+		char text[6];
+		unsigned value = seconds;
+		for (int i = 4; i >= 0; --i, value /= 10)
+			text[i] = '0' + value % 10;
+		text[5] = 0;
+
+		lcd::Goto(8, 1);
+		lcd::Puts(text);
+		// Only changed digits are written to display
+		lcd::Update();
+
+		Zhele::delay_ms<1000>();
+	}
+}
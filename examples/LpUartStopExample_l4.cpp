@@ -0,0 +1,72 @@
+// Define target cpu frequence (default MSI clock).
+#define F_CPU 4000000
+
+#include <iopins.h>
+#include <usart.h>
+#include <common/power.h>
+
+using namespace Zhele;
+using namespace Zhele::IO;
+using namespace Zhele::Power;
+
+using Uart = LpUart1;
+using Led = Pb3;
+
+char Command[32];
+volatile uint8_t Size = 0;
+volatile bool CommandReceived = false;
+
+// Battery node: MCU sleeps in Stop 2 mode, LPUART1 (LSE clock, 9600 baud) keeps receiving.
+// Start bit wakes MCU up, every byte is read by RXNE interrupt (LPUART receives it by itself,
+// so nothing is lost while system clock is restored). Line ended by '\n' is a command.
+int main()
+{
+    Led::Port::Enable();
+    Led::SetConfiguration(Led::Configuration::Out);
+    Led::SetDriverType(Led::DriverType::PushPull);
+
+    Clock::LpUart1Clock::SelectClockSource(Clock::LpUart1Clock::Lse);
+    Uart::Init(9600);
+    Uart::SelectTxRxPins<Pb11, Pb10>();
+    Uart::EnableWakeupFromStop(Uart::WakeupSource::StartBit);
+    Uart::EnableInterrupt(Uart::InterruptFlags::RxNotEmptyInt);
+
+    LowPower::SetStopMode(LowPower::StopMode::Stop2);
+    LowPower::SetWakeLatencyBudget(1000);
+
+    for (;;)
+    {
+        LowPower::WaitFor(CommandReceived);
+
+        if(Command[0] == '1')
+            Led::Set();
+        else if(Command[0] == '0')
+            Led::Clear();
+        // Reply by DMA (Stop mode is not entered while DMA channel is active)
+        Uart::WriteAsync("OK\r\n", 4);
+
+        Size = 0;
+        CommandReceived = false;
+    }
+}
+
+extern "C"
+{
+    void LPUART1_IRQHandler()
+    {
+        // Clears wakeup flag
+        Uart::IrqHandler();
+
+        if(!Uart::ReadReady())
+            return;
+
+        char c = Uart::Read();
+        if(CommandReceived || Size == sizeof(Command))
+            return;
+
+        Command[Size] = c;
+        Size = Size + 1;
+        if(c == '\n')
+            CommandReceived = true;
+    }
+}
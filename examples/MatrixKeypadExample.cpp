@@ -0,0 +1,45 @@
+#define F_CPU 72000000
+
+#include <dma.h>
+#include <iopins.h>
+#include <pinlist.h>
+#include <timer.h>
+#include <common/matrix_keypad.h>
+
+using namespace Zhele;
+using namespace Zhele::IO;
+using namespace Zhele::Timers;
+
+// 8x8 (64 keys) matrix: rows A0..A7, columns B8..B15.
+// Timer4 update request is DMA1 channel 7 (rows), Timer4 channel 1 request is DMA1 channel 1 (columns).
+using Rows = PinList<Pa0, Pa1, Pa2, Pa3, Pa4, Pa5, Pa6, Pa7>;
+using Columns = PinList<Pb8, Pb9, Pb10, Pb11, Pb12, Pb13, Pb14, Pb15>;
+using Keypad = MatrixKeypad<Rows, Columns, Timer4, Dma1Channel7, Dma1Channel1, 0>;
+
+using Led = Pc13;
+
+int main()
+{
+    Led::Port::Enable();
+    Led::SetConfiguration(Led::Configuration::Out);
+
+    // 2 kHz rows rate: whole matrix is scanned every 4 ms, key is debounced in 16 ms
+    Keypad::Init(2000);
+    Keypad::Start();
+
+    for (;;)
+    {
+        Keypad::KeysType pressed = Keypad::Pressed();
+        if(pressed & (Keypad::KeysType(1) << Keypad::KeyIndex(2, 5)))
+            Led::Toggle();
+    }
+}
+
+extern "C"
+{
+    // One interrupt per matrix scan
+    void DMA1_Channel1_IRQHandler()
+    {
+        Dma1Channel1::IrqHandler();
+    }
+}
@@ -0,0 +1,72 @@
+// Modbus RTU slave: coils drive LED, holding registers are read/write, input register counts requests.
+// Frame end (t3.5) is detected by TIM2, requests are processed in interrupts.
+
+#include <drivers/modbus_rtu.h>
+#include <timer.h>
+
+using namespace Zhele;
+using namespace Zhele::Drivers;
+using namespace Zhele::IO;
+
+using Rs485 = Adm485<Usart1, Pb5>;
+using Slave = ModbusRtuSlave<Rs485, Timers::Timer2>;
+using Led = Pc13Inv;
+
+uint8_t Coils[1];
+uint16_t HoldingRegisters[8];
+uint16_t InputRegisters[1];
+
+const ModbusBitBlock CoilsBlock {0, 8, Coils};
+const ModbusRegisterBlock HoldingBlock {0x100, 8, HoldingRegisters};
+const ModbusRegisterBlock InputBlock {0x200, 1, InputRegisters};
+
+ModbusException OnWrite(ModbusFunction function, uint16_t address, uint16_t count);
+
+const ModbusRegisterMap Map {
+    &CoilsBlock, 1,
+    nullptr, 0,
+    &HoldingBlock, 1,
+    &InputBlock, 1,
+    OnWrite
+};
+
+int main()
+{
+    Led::Port::Enable();
+    Led::SetConfiguration(Led::Configuration::Out);
+    Led::SetDriverType(Led::DriverType::PushPull);
+    Led::Clear();
+
+    Rs485::SelectTxRxPins<Pb6, Pb7>();
+    Slave::Init(19200, 1, &Map);
+
+    for (;;)
+    {
+    }
+}
+
+ModbusException OnWrite(ModbusFunction function, uint16_t address, uint16_t count)
+{
+    ++InputRegisters[0];
+    if(function == ModbusFunction::WriteSingleCoil || function == ModbusFunction::WriteMultipleCoils)
+    {
+        if(Coils[0] & 0x01)
+            Led::Set();
+        else
+            Led::Clear();
+    }
+    return ModbusException::None;
+}
+
+extern "C"
+{
+    void USART1_IRQHandler()
+    {
+        Slave::IrqHandler();
+    }
+
+    void TIM2_IRQHandler()
+    {
+        Slave::TimerIrqHandler();
+    }
+}
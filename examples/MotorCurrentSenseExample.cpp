@@ -0,0 +1,149 @@
+#define F_CPU 72000000
+
+#include <adc.h>
+#include <clock.h>
+#include <dma.h>
+#include <iopins.h>
+#include <timer.h>
+#include <common/nvic.h>
+
+using namespace Zhele;
+using namespace Zhele::Clock;
+using namespace Zhele::IO;
+using namespace Zhele::Timers;
+
+// Current loop of FOC controller: phase currents (low-side shunts, PA0 and PA1) are sampled
+// at the center of 20 kHz center-aligned PWM period, when low-side transistors are on.
+// Timer1 CC4 (counting down, just after counter top) triggers injected conversions,
+// results are handled in ADC interrupt with the highest priority within the same PWM period.
+// Speed setpoint (PA4) and bus voltage (PA5) are scanned by regular DMA in background.
+using MotorTimer = Timer1;
+using PhaseU = MotorTimer::ComplementaryPWMGeneration<0>;
+using PhaseV = MotorTimer::ComplementaryPWMGeneration<1>;
+using PhaseW = MotorTimer::ComplementaryPWMGeneration<2>;
+using SampleTrigger = MotorTimer::PWMGeneration<3>;
+
+ZHELE_IRQ_PRIORITY(ADC1_2_IRQn, 0);
+ZHELE_IRQ_PRIORITY(DMA1_Channel1_IRQn, 3);
+
+static const uint16_t Period = 72000000 / 20000 / 2; // Center-aligned mode counts up and down
+// CC4 is reached 1 tick before counter top: conversion starts in the middle of low-side on-time
+static const uint16_t SamplePoint = Period - 1;
+
+const uint8_t CurrentChannels[] = {0, 1};
+uint16_t Currents[sizeof(CurrentChannels)];
+
+static const uint16_t BlockScans = 16;
+const uint8_t SlowChannels[] = {4, 5};
+uint16_t SlowBuffer[2 * BlockScans * sizeof(SlowChannels)];
+volatile uint16_t Setpoint;
+volatile uint16_t BusVoltage;
+
+// Zero-current ADC code (mid-scale of current sense amplifier)
+static const int32_t CurrentOffset = 2048;
+
+void ConfigureClock();
+
+template<typename Phase, typename HighPin, typename LowPin>
+void ConfigurePhase()
+{
+    Phase::template SelectPins<HighPin>();
+    Phase::template SelectComplementaryPins<LowPin>();
+    Phase::SetOutputMode(Phase::OutputMode::PWM1);
+    Phase::SetComplementaryPolarity(Phase::OutputPolarity::ActiveHigh);
+    Phase::SetIdleState(false, false);
+    Phase::SetPulse(Period / 2);
+    Phase::Enable();
+    Phase::EnableComplementary();
+}
+
+void CurrentLoop(uint16_t* data, uint32_t)
+{
+    // Phase W current is restored from Kirchhoff's law: iu + iv + iw = 0
+    int32_t iu = static_cast<int32_t>(data[0]) - CurrentOffset;
+    int32_t iv = static_cast<int32_t>(data[1]) - CurrentOffset;
+    int32_t iw = -iu - iv;
+
+    // Place Clarke/Park transforms and PI regulators here. New duties are loaded
+    // by timer update (preload), so they are applied from the next PWM period.
+    int32_t gain = Setpoint / 64;
+    auto duty = [gain](int32_t current) {
+        int32_t value = Period / 2 - current * gain / 256;
+        return static_cast<uint16_t>(value < 0 ? 0 : (value > Period ? Period : value));
+    };
+    PhaseU::SetPulse(duty(iu));
+    PhaseV::SetPulse(duty(iv));
+    PhaseW::SetPulse(duty(iw));
+}
+
+int main()
+{
+    ConfigureClock();
+    Porta::Enable();
+
+    MotorTimer::Enable();
+    MotorTimer::SetCounterMode(MotorTimer::CounterMode::CenterAligned1);
+    MotorTimer::SetPrescaler(0);
+    MotorTimer::SetPeriod(Period);
+    MotorTimer::SetRepetitionCounter(1);
+    MotorTimer::SetDeadTimeNs(500);
+
+    ConfigurePhase<PhaseU, Pa8, Pb13>();
+    ConfigurePhase<PhaseV, Pa9, Pb14>();
+    ConfigurePhase<PhaseW, Pa10, Pb15>();
+
+    // CC4 is used as internal trigger only (no pin), in CenterAligned1 mode CC event is generated when counting down
+    SampleTrigger::SetOutputMode(SampleTrigger::OutputMode::PWM1);
+    SampleTrigger::SetPulse(SamplePoint);
+    SampleTrigger::Enable();
+
+    // Conversion of two channels (sample time 7.5 + 12.5 cycles at 12 MHz) takes 3.3 us
+    Adc1::Init(Adc1::AdcDivider::Div6);
+    Adc1::SetSampleTime(0, 7);
+    Adc1::SetSampleTime(1, 7);
+    Adc1::SetSampleTime(4, 239);
+    Adc1::SetSampleTime(5, 239);
+
+    Adc1::SetRegularTrigger(Adc1::RegularTrigger::Software, Adc1::TriggerMode::Rising);
+    Adc1::StartRegularPingPong(SlowChannels, sizeof(SlowChannels), SlowBuffer, BlockScans, [](void* data, unsigned size, bool) {
+        const uint16_t* samples = static_cast<const uint16_t*>(data);
+        uint32_t setpoint = 0, voltage = 0;
+        for (unsigned i = 0; i < size; i += 2)
+        {
+            setpoint += samples[i];
+            voltage += samples[i + 1];
+        }
+        Setpoint = setpoint / (size / 2);
+        BusVoltage = voltage / (size / 2);
+    });
+
+    Adc1::StartInjectedTriggered(Adc1::InjectedTrigger::Timer1CC4, CurrentChannels, Currents, sizeof(CurrentChannels), CurrentLoop);
+
+    MotorTimer::EnableOutputs();
+    MotorTimer::Start();
+
+    for (;;)
+    {
+    }
+}
+
+void ConfigureClock()
+{
+    PllClock::SelectClockSource(PllClock::ClockSource::External);
+    PllClock::SetMultiplier(9);
+    Apb1Clock::SetPrescaler(Apb1Clock::Div2);
+    SysClock::SelectClockSource(SysClock::Pll);
+}
+
+extern "C"
+{
+    void ADC1_2_IRQHandler()
+    {
+        Adc1::IrqHandler();
+    }
+
+    void DMA1_Channel1_IRQHandler()
+    {
+        Dma1Channel1::IrqHandler();
+    }
+}
@@ -0,0 +1,83 @@
+#define F_CPU 72000000
+
+#include <clock.h>
+#include <iopins.h>
+#include <pinlist.h>
+#include <spi.h>
+#include <usb.h>
+
+#include <drivers/sdcard.h>
+#include <drivers/filesystem/ram_block_device.h>
+
+using namespace Zhele;
+using namespace Zhele::Clock;
+using namespace Zhele::IO;
+using namespace Zhele::Usb;
+
+constexpr Zhele::TemplateUtils::fixed_string_16 Manufacturer(u"ZheleProduction");
+constexpr Zhele::TemplateUtils::fixed_string_16 Product(u"TwoLunsExample");
+constexpr Zhele::TemplateUtils::fixed_string_16 Serial(u"88005553535");
+
+using MscOutEpBase = BulkDoubleBufferedEndpointBase<1, EndpointDirection::Out, 64>;
+using MscInEpBase = InBulkDoubleBufferedWithoutZlpEndpointBase<2, 64>;
+
+using EpInitializer = EndpointsInitializer<DefaultEp0, MscOutEpBase, MscInEpBase>;
+using Ep0 = EpInitializer::ExtendEndpoint<DefaultEp0>;
+
+using MscOutEp = EpInitializer::ExtendEndpoint<MscOutEpBase>;
+using MscInEp = EpInitializer::ExtendEndpoint<MscInEpBase>;
+
+// Host sees two disks: fast RAM scratch disk (LUN 0) and SD card (LUN 1).
+// CBW is routed to LUN by its number, GET MAX LUN reports 1.
+using RamDisk = Drivers::Filesystem::RamBlockDevice<512, 24>;
+using SdCardReader = Drivers::SdCard<Spi1, Pa4>;
+using Lun0 = BlockDeviceScsiLun<RamDisk>;
+using Lun1 = PipelinedScsiLun<SdCardReader>;
+
+using Scsi = ScsiBulkInterface<0, 0, Ep0, MscOutEp, MscInEp, Lun0, Lun1>;
+
+using Config = Configuration<0, 250, false, false, Scsi>;
+using MyDevice = DeviceWithStrings<0x0200, DeviceAndInterfaceClass::Storage, 0, 0, 0x0483, 0x5711, 0, Manufacturer, Product, Serial, Ep0, Config>;
+
+void ConfigureClock();
+
+int main()
+{
+    ConfigureClock();
+    Zhele::IO::Porta::Enable();
+
+    Spi1::Init(Spi1::Fast, Spi1::Master);
+    Spi1::SelectPins<Pa7, Pa6, Pa5, Pa4>();
+    SdCardReader::Detect();
+
+    // SPI RX DMA interrupt completes card transfers, so it should preempt USB interrupt
+    NVIC_SetPriority(DMA1_Channel2_IRQn, 0);
+    NVIC_SetPriority(USB_LP_CAN1_RX0_IRQn, 1);
+
+    MyDevice::Enable();
+
+    for(;;)
+    {
+    }
+}
+
+void ConfigureClock()
+{
+    PllClock::SelectClockSource(PllClock::ClockSource::External);
+    PllClock::SetMultiplier(9);
+    Apb1Clock::SetPrescaler(Apb1Clock::Div2);
+    SysClock::SelectClockSource(SysClock::Pll);
+    MyDevice::SelectClockSource(Zhele::Usb::ClockSource::PllDividedOneAndHalf);
+}
+
+template<>
+void MscOutEp::HandleRx(void* data, uint16_t size)
+{
+    Scsi::HandleRx(data, size);
+}
+
+extern "C" void USB_LP_IRQHandler()
+{
+    // Sorry, but you must write device`s CommonHandler call by yourself.
+    MyDevice::CommonHandler();
+}
\ No newline at end of file
@@ -0,0 +1,44 @@
+#include <iopins.h>
+#include <timer.h>
+#include <common/one_pulse.h>
+
+using namespace Zhele;
+using namespace Zhele::IO;
+using namespace Zhele::Timers;
+
+// 10 us trigger pulse (HC-SR04 style sensor) on TIM3_CH1 (Pa6) after 5 us setup delay,
+// 60 ms measurement cycle is timed by TIM4 without busy-wait.
+using Trigger = OnePulse<Timer3, Pa6, 0>;
+using Cycle = OnePulse<Timer4>;
+
+volatile bool CycleElapsed = true;
+
+int main()
+{
+    Trigger::Init();
+    Cycle::Init(10000);
+
+    for (;;)
+    {
+        if(!CycleElapsed)
+            continue;
+        CycleElapsed = false;
+
+        Trigger::Pulse(10, 5);
+        // 600 ticks of 100 us
+        Cycle::Delay(600, []{ CycleElapsed = true; });
+    }
+}
+
+extern "C"
+{
+    void TIM3_IRQHandler()
+    {
+        Trigger::IrqHandler();
+    }
+
+    void TIM4_IRQHandler()
+    {
+        Cycle::IrqHandler();
+    }
+}
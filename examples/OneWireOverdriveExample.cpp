@@ -0,0 +1,57 @@
+#define F_CPU 72000000
+
+#include <clock.h>
+#include <dma.h>
+#include <iopins.h>
+#include <one_wire.h>
+#include <timer.h>
+
+using namespace Zhele;
+using namespace Zhele::Clock;
+using namespace Zhele::IO;
+using namespace Zhele::Timers;
+
+// One-wire bus on PB6 (Timer4 channel 1) without USART: DMA1 channel 7 is TIM4_UP (slot pulses),
+// DMA1 channel 4 is TIM4_CH2 (line sampling). Use about 2.2 kOhm pull-up for overdrive.
+using Engine = OneWireTimerEngine<Timer4, Pb6, 0, 1, Dma1Channel7, Dma1Channel4>;
+using Bus = BasicOneWire<Engine>;
+
+const uint8_t MaxDevices = 32;
+uint8_t roms[MaxDevices][8];
+
+void ConfigureClock();
+
+int main()
+{
+    ConfigureClock();
+    Bus::Init();
+
+    // Switch all overdrive-capable devices to overdrive, then search at ~7x speed
+    volatile uint8_t count = 0;
+    if (Bus::OverdriveSkipRom())
+        count = Bus::Enumerate(roms, MaxDevices);
+
+    // Standard speed reset returns all devices to standard speed
+    Bus::SetSpeed(OneWireSpeed::Standard);
+    Bus::Reset();
+
+    for (;;)
+    {
+    }
+}
+
+void ConfigureClock()
+{
+    PllClock::SelectClockSource(PllClock::ClockSource::External);
+    PllClock::SetMultiplier(9);
+    Apb1Clock::SetPrescaler(Apb1Clock::Div2);
+    SysClock::SelectClockSource(SysClock::Pll);
+}
+
+extern "C"
+{
+    void DMA1_Channel4_IRQHandler()
+    {
+        Dma1Channel4::IrqHandler();
+    }
+}
@@ -0,0 +1,151 @@
+#define F_CPU 72000000
+
+#include <clock.h>
+#include <dma.h>
+#include <i2c.h>
+#include <iopins.h>
+#include <spi.h>
+#include <usart.h>
+
+#include <containers/ring_buffer.h>
+#include <drivers/sdcard.h>
+
+#include <stdio.h>
+
+using namespace Zhele;
+using namespace Zhele::Clock;
+using namespace Zhele::IO;
+
+// Results are printed to Report USART, measured USART is other one (TX pin can stay unconnected).
+using Report = Usart1;
+using MeasuredUsart = Usart2;
+using MeasuredSpi = Spi2;
+using MeasuredI2c = I2c1;
+using Dma = DmaMemory<Dma1Channel1>;
+using SdCardReader = Drivers::SdCard<Spi1, Pa4>;
+
+// I2C device (for example, 24C32 EEPROM)
+static const uint8_t I2cDeviceAddress = 0x50;
+
+static const unsigned RingBufferIterations = 1000;
+static const unsigned DmaIterations = 100;
+
+uint8_t Buffer[512];
+Containers::RingBuffer<64, uint8_t> RingBuffer; // Power of 2 size, so it is RingBufferPO2
+volatile bool Done = false;
+volatile uint32_t CallbackCycles = 0;
+
+void ConfigureClock();
+
+// Measures on-target throughput and latency of library hot paths.
+// For every test total CPU cycles (DWT cycle counter), cycles of API call itself (how long CPU is busy before
+// DMA/interrupt continues transfer) and bytes per second are printed to Report USART (0 B/s means failed test).
+// Compare output of different library versions to catch regressions.
+__attribute__((noinline)) void Print(const char* name, uint32_t cycles, uint32_t callCycles, uint32_t bytes)
+{
+    char line[96];
+    uint32_t rate = cycles != 0 ? static_cast<uint32_t>(static_cast<uint64_t>(bytes) * F_CPU / cycles) : 0;
+    int length = snprintf(line, sizeof(line), "%-24s %10lu cycles, call %8lu cycles, %9lu B/s\r\n",
+        name, static_cast<unsigned long>(cycles), static_cast<unsigned long>(callCycles), static_cast<unsigned long>(rate));
+    Report::Write(line, length);
+}
+
+template<typename _Start>
+__attribute__((noinline)) void MeasureAsync(const char* name, uint32_t bytes, _Start start)
+{
+    Done = false;
+    uint32_t begin = DWT->CYCCNT;
+    start();
+    uint32_t call = DWT->CYCCNT - begin;
+    while(!Done)
+        continue;
+    Print(name, DWT->CYCCNT - begin, call, bytes);
+}
+
+template<typename _Action>
+__attribute__((noinline)) void MeasureSync(const char* name, uint32_t bytes, _Action action)
+{
+    uint32_t begin = DWT->CYCCNT;
+    bool success = action();
+    uint32_t cycles = DWT->CYCCNT - begin;
+    Print(name, success ? cycles : 0, cycles, bytes);
+}
+
+int main()
+{
+    ConfigureClock();
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    Report::Init(115200);
+    Report::SelectTxRxPins<Pa9, Pa10>();
+
+    MeasuredUsart::Init(2250000);
+    MeasuredUsart::SelectTxRxPins<Pa2, Pa3>();
+
+    MeasuredSpi::Init(MeasuredSpi::Fast, MeasuredSpi::Master);
+    MeasuredSpi::SelectPins<Pb15, Pb14, Pb13, Pb12>();
+
+    MeasuredI2c::Init(400000);
+    MeasuredI2c::SelectPins<Pb6, Pb7>();
+
+    Spi1::Init(Spi1::Fast, Spi1::Master);
+    Spi1::SelectPins<Pa7, Pa6, Pa5, Pa4>();
+
+    for(unsigned i = 0; i < sizeof(Buffer); ++i)
+        Buffer[i] = i;
+
+    MeasureAsync("Usart::WriteAsync", sizeof(Buffer), []{
+        MeasuredUsart::WriteAsync(Buffer, sizeof(Buffer), [](void*, unsigned, bool) { Done = true; });
+    });
+
+    MeasureAsync("Spi::SendAsync", sizeof(Buffer), []{
+        MeasuredSpi::SendAsync(Buffer, Buffer, sizeof(Buffer), [](void*, unsigned, bool) { Done = true; });
+    });
+
+    MeasureSync("I2c::Read", 32, []{
+        return MeasuredI2c::Read(I2cDeviceAddress, 0, Buffer, 32, I2cOpts::RegAddr16Bit) == I2cStatus::Success;
+    });
+
+    MeasureSync("SdCard::ReadBlock", 512, []{
+        return SdCardReader::Detect() != Drivers::SdCardType::SdCardNone && SdCardReader::ReadBlock(Buffer, 0);
+    });
+
+    MeasureSync("RingBufferPO2 push/pop", RingBufferIterations, []{
+        unsigned sum = 0;
+        for(unsigned i = 0; i < RingBufferIterations; ++i)
+        {
+            RingBuffer.push_back(static_cast<uint8_t>(i));
+            sum += RingBuffer.front();
+            RingBuffer.pop_front();
+        }
+        return sum != 0;
+    });
+
+    // Small copy: cycles are mostly interrupt entry and callback dispatch
+    uint32_t dispatch = 0;
+    for(unsigned i = 0; i < DmaIterations; ++i)
+    {
+        Done = false;
+        uint32_t begin = DWT->CYCCNT;
+        Dma::CopyAsync(Buffer + 256, Buffer, 4, [](void*, unsigned, bool) { CallbackCycles = DWT->CYCCNT; Done = true; });
+        while(!Done)
+            continue;
+        dispatch += CallbackCycles - begin;
+    }
+    Print("DMA callback dispatch", dispatch / DmaIterations, dispatch / DmaIterations, 4);
+
+    for (;;)
+    {
+    }
+}
+
+void ConfigureClock()
+{
+    PllClock::SelectClockSource(PllClock::ClockSource::External);
+    PllClock::SetMultiplier(9);
+    Apb1Clock::SetPrescaler(Apb1Clock::Div2);
+    SysClock::SelectClockSource(SysClock::Pll);
+}
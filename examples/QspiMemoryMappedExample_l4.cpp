@@ -0,0 +1,81 @@
+// Define target cpu frequence (default MSI clock).
+#define F_CPU 4000000
+
+#include <qspi.h>
+
+using namespace Zhele;
+using namespace Zhele::IO;
+
+// W25Q128 (16 MB) commands
+const QspiBase::Command WriteEnable {.Instruction = 0x06};
+const QspiBase::Command ReadStatus1 {.Instruction = 0x05, .DataLines = QspiBase::Lines::Single};
+const QspiBase::Command WriteStatus2 {.Instruction = 0x31, .DataLines = QspiBase::Lines::Single};
+const QspiBase::Command SectorErase {.Instruction = 0x20, .AddressLines = QspiBase::Lines::Single};
+const QspiBase::Command QuadPageProgram {.Instruction = 0x32, .AddressLines = QspiBase::Lines::Single, .DataLines = QspiBase::Lines::Quad};
+// Fast read quad IO: address and mode byte (0xf0 - no continuous read) by 4 lines, 4 dummy cycles
+const QspiBase::Command FastReadQuadIo {
+    .Instruction = 0xeb,
+    .AddressLines = QspiBase::Lines::Quad,
+    .AlternateLines = QspiBase::Lines::Quad,
+    .Alternate = 0xf0,
+    .DummyCycles = 4,
+    .DataLines = QspiBase::Lines::Quad
+};
+
+// Lookup table is stored in flash (one page)
+struct SineTable
+{
+    int16_t Values[128];
+};
+const uint32_t SineTableAddress = 0x1000;
+
+int main()
+{
+    Qspi::SelectPins<Pb10, Pb11, Pb1, Pb0, Pa7, Pa6>();
+    Qspi::Init(F_CPU, 16 * 1024 * 1024);
+
+    // Enable quad mode (QE bit of status register 2)
+    const uint8_t quadEnable = 0x02;
+    Qspi::Execute(WriteEnable);
+    Qspi::Write(WriteStatus2, 0, &quadEnable, 1);
+    Qspi::WaitStatus(ReadStatus1, 0x01, 0x00);
+
+    // Store table (program is done by DMA, busy bit is polled by QUADSPI)
+    static SineTable table;
+    Qspi::Execute(WriteEnable);
+    Qspi::Execute(SectorErase, SineTableAddress);
+    Qspi::WaitStatus(ReadStatus1, 0x01, 0x00);
+    Qspi::Execute(WriteEnable);
+    Qspi::WriteAsync(QuadPageProgram, SineTableAddress, table.Values, sizeof(table.Values), [](void*, unsigned, bool){
+        Qspi::WaitStatusAsync(ReadStatus1, 0x01, 0x00, [](uint8_t){
+            // Flash is ready: map it, table is read as const data without copying to SRAM
+            Qspi::EnableMemoryMapped(FastReadQuadIo);
+        });
+    });
+
+    // Wait for memory mapped mode
+    while(!Qspi::MemoryMapped())
+        continue;
+
+    const SineTable* sine = Qspi::Data<SineTable>(SineTableAddress);
+    volatile int32_t sum = 0;
+    for(unsigned i = 0; i < 128; ++i)
+        sum += sine->Values[i];
+
+    for (;;)
+    {
+    }
+}
+
+extern "C"
+{
+    void DMA2_Channel7_IRQHandler()
+    {
+        Dma2Stream7::IrqHandler();
+    }
+
+    void QUADSPI_IRQHandler()
+    {
+        Qspi::IrqHandler();
+    }
+}
@@ -0,0 +1,42 @@
+#include <timer.h>
+#include <drivers/encoder.h>
+
+using namespace Zhele::Timers;
+
+// A, B and index (Z) inputs: channels 1-3 of Timer2
+using Encoder = Zhele::Drivers::QuadratureEncoder<Timer2, Zhele::IO::Pa0, Zhele::IO::Pa1, Zhele::IO::Pa2>;
+
+int32_t Position;
+int32_t Speed;
+
+int main()
+{
+    Encoder::Init();
+    // Servo loop rate: Timer3 update samples position and velocity
+    Encoder::EnableVelocity<Timer3>(10000);
+
+    for(;;)
+    {
+        if(Encoder::IndexCaptured())
+        {
+            // Reference position to index pulse
+            Encoder::SetPosition(Encoder::Position() - Encoder::IndexPosition());
+        }
+    }
+}
+
+extern "C"
+{
+    void TIM2_IRQHandler()
+    {
+        Encoder::IrqHandler();
+    }
+
+    void TIM3_IRQHandler()
+    {
+        Encoder::Sample();
+        Position = Encoder::Position();
+        Speed = Encoder::Velocity();
+        Timer3::ClearInterruptFlag();
+    }
+}
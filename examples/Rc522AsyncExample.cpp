@@ -0,0 +1,61 @@
+#define F_CPU 8000000
+
+#include <exti.h>
+#include <iopins.h>
+#include <spi.h>
+
+#include <drivers/rc522.h>
+
+using namespace Zhele;
+using namespace Zhele::IO;
+
+// MFRC522 IRQ pin is connected to PB0
+using NfcReader = Drivers::Rc522<Spi1, Pa4, Exti0, Pb0>;
+using Led = Pc13Inv;
+
+uint8_t cardId[5];
+
+void OnCheckComplete(NfcReader::Status status)
+{
+    if(status == NfcReader::Status::Success)
+        Led::Set();
+    else
+        Led::Clear();
+}
+
+int main()
+{
+    Led::Port::Enable();
+    Led::SetConfiguration(Led::Configuration::Out);
+    Led::SetDriverType(Led::DriverType::PushPull);
+
+    Spi1::Init(Spi1::ClockDivider::Fast);
+    Spi1::SelectPins<Pa7, Pa6, Pa5, NullPin>();
+    NfcReader::Init();
+
+    for (;;)
+    {
+        // CPU is free while RF exchange runs
+        if(!NfcReader::Busy())
+            NfcReader::CheckAsync(cardId, OnCheckComplete);
+    }
+}
+
+extern "C"
+{
+    void EXTI0_IRQHandler()
+    {
+        NfcReader::IrqHandler();
+    }
+
+    // SPI1 RX and TX DMA channels
+    void DMA1_Channel2_IRQHandler()
+    {
+        Dma1Channel2::IrqHandler();
+    }
+
+    void DMA1_Channel3_IRQHandler()
+    {
+        Dma1Channel3::IrqHandler();
+    }
+}
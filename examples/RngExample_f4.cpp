@@ -0,0 +1,40 @@
+// Define target cpu frequence
+#define F_CPU 168000000
+
+#include <iopins.h>
+#include <rng.h>
+#include <usart.h>
+
+using namespace Zhele;
+using namespace Zhele::IO;
+
+// Random nonces are taken from RNG pool without waiting for generation,
+// random backoff (up to 16 slots) desynchronizes nodes after collision.
+int main()
+{
+    // RNG clock is PLL48CLK (PLLQ output)
+    Rng::Init();
+
+    Usart1::Init(115200);
+    Usart1::SelectTxRxPins<Pa9, Pa10>();
+
+    for (;;)
+    {
+        uint32_t nonce[4];
+        for(uint32_t& word : nonce)
+            word = Rng::Get();
+        Usart1::Write(nonce, sizeof(nonce));
+
+        uint32_t backoff = Rng::Range(16) * 100000;
+        for(volatile uint32_t i = 0; i < backoff; i = i + 1)
+            continue;
+    }
+}
+
+extern "C"
+{
+    void HASH_RNG_IRQHandler()
+    {
+        Rng::IrqHandler();
+    }
+}
@@ -0,0 +1,47 @@
+#include <iopins.h>
+#include <rtc.h>
+#include <common/power.h>
+
+using namespace Zhele;
+using namespace Zhele::IO;
+using namespace Zhele::Timers;
+using namespace Zhele::Power;
+
+using Led = Pc13;
+
+volatile bool WakeUp = false;
+
+// RTC keeps running through reset (if backup domain is powered) and wakes MCU up every 5 seconds.
+int main()
+{
+    Led::Port::Enable();
+    Led::SetConfiguration(Led::Configuration::Out);
+    Led::SetDriverType(Led::DriverType::PushPull);
+
+    // LSE crystal is preferred, LSI is fallback
+    if(!Rtc::Init(Rtc::ClockSource::Lse))
+        Rtc::Init(Rtc::ClockSource::Lsi);
+    Rtc::StartWakeupTimer(5000, []{ WakeUp = true; });
+
+    uint32_t last = 0;
+    for (;;)
+    {
+        LowPower::WaitFor(WakeUp);
+        WakeUp = false;
+
+        // Interval between wakeups with sub-second resolution (ms)
+        Rtc::Timestamp timestamp = Rtc::GetTimestamp();
+        uint32_t now = timestamp.Seconds * 1000 + timestamp.Subseconds * 1000 / Rtc::SubsecondRate();
+        if(now - last >= 5000)
+            Led::Toggle();
+        last = now;
+    }
+}
+
+extern "C"
+{
+    void RTC_Alarm_IRQHandler()
+    {
+        Rtc::IrqHandler();
+    }
+}
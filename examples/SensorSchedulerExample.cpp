@@ -0,0 +1,105 @@
+// Sensors on two I2C buses and 1-Wire line are sampled by one scheduler without blocking main loop.
+#define F_CPU 72000000
+
+#include <i2c.h>
+#include <iopins.h>
+#include <one_wire.h>
+#include <usart.h>
+#include <common/timebase.h>
+#include <drivers/aht10.h>
+#include <drivers/bmp280.h>
+#include <drivers/ds18b20.h>
+#include <drivers/sensor_scheduler.h>
+
+using namespace Zhele;
+using namespace Zhele::Clock;
+using namespace Zhele::Drivers;
+
+using Timebase = DwtTimebase<>;
+
+using Bus = I2cTransactionQueue<I2c1>;
+using Indoor = Aht10Async<Bus, Timebase, 0x38>;
+using Outdoor = Aht10Async<Bus, Timebase, 0x39>;
+using Barometer = Bmp280<I2c2, Timebase>;
+using Thermometer = Ds18b20<OneWire<Usart2, IO::Pa2>>;
+
+volatile int16_t WaterTemperature;
+
+void OnWaterTemperature(SampleStatus status)
+{
+    if(status == SampleStatus::Success)
+        WaterTemperature = static_cast<int16_t>(Ds18b20Sampling<Thermometer>::Result().Temperature * 100);
+}
+
+// Barometer is sampled back-to-back, AHT10 sensors convert simultaneously once per second,
+// DS18B20 converts 750 ms while I2C sensors are being read.
+using Scheduler = SensorScheduler<Timebase,
+    SamplingTask<Bmp280Sampling<Barometer>, 0>,
+    SamplingTask<Aht10Sampling<Indoor>, 1000000>,
+    SamplingTask<Aht10Sampling<Outdoor>, 1000000>,
+    SamplingTask<Ds18b20Sampling<Thermometer>, 2000000, OnWaterTemperature>>;
+
+int main()
+{
+    Timebase::Init();
+    I2c1::Init();
+    I2c1::SelectPins<IO::Pb8, IO::Pb9>();
+    I2c2::Init();
+    I2c2::SelectPins<IO::Pb10, IO::Pb11>();
+
+    Indoor::StartInit();
+    Outdoor::StartInit();
+    Barometer::SetMode(Barometer::Mode::Forced);
+    Barometer::StartInit();
+    Thermometer::Init();
+
+    // Tasks are triggered as soon as sensors are initialized
+    Scheduler::Start();
+    for (;;)
+    {
+        Scheduler::Poll();
+    }
+}
+
+extern "C"
+{
+    void I2C1_EV_IRQHandler()
+    {
+        I2c1::EventIrqHandler();
+    }
+
+    void I2C1_ER_IRQHandler()
+    {
+        I2c1::ErrorIrqHandler();
+    }
+
+    void I2C2_EV_IRQHandler()
+    {
+        I2c2::EventIrqHandler();
+    }
+
+    void I2C2_ER_IRQHandler()
+    {
+        I2c2::ErrorIrqHandler();
+    }
+
+    void DMA1_Channel4_IRQHandler()
+    {
+        Dma1Channel4::IrqHandler();
+    }
+
+    void DMA1_Channel5_IRQHandler()
+    {
+        Dma1Channel5::IrqHandler();
+    }
+
+    void DMA1_Channel6_IRQHandler()
+    {
+        Dma1Channel6::IrqHandler();
+    }
+
+    void DMA1_Channel7_IRQHandler()
+    {
+        Dma1Channel7::IrqHandler();
+    }
+}
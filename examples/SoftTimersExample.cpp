@@ -0,0 +1,49 @@
+#include <iopins.h>
+#include <timer.h>
+#include <common/timer_wheel.h>
+
+using namespace Zhele::IO;
+using namespace Zhele::Timers;
+
+// All software timers are served by one hardware timer (Timer2, output compare channel 1)
+using Wheel = TimerWheel<Timer2>;
+
+SoftTimer BlinkTimer;
+SoftTimer FastBlinkTimer;
+SoftTimer StopTimer;
+
+int main()
+{
+	Pa4::Port::Enable();
+	Pa4::SetConfiguration(Pa4::Configuration::Out);
+	Pa4::SetDriverType(Pa4::DriverType::PushPull);
+
+	Pa5::Port::Enable();
+	Pa5::SetConfiguration(Pa5::Configuration::Out);
+	Pa5::SetDriverType(Pa5::DriverType::PushPull);
+
+	// 1 ms tick
+	Wheel::Init(1000);
+
+	// Periodic timers
+	Wheel::Start(BlinkTimer, 500, [] { Pa4::Toggle(); }, 500);
+	Wheel::Start(FastBlinkTimer, 100, [] { Pa5::Toggle(); }, 100);
+
+	// One-shot timer: stop fast blinking after 10 seconds
+	Wheel::Start(StopTimer, 10000, [] {
+		Wheel::Stop(FastBlinkTimer);
+		Pa5::Clear();
+	});
+
+	for (;;)
+	{
+	}
+}
+
+extern "C"
+{
+	void TIM2_IRQHandler()
+	{
+		Wheel::IrqHandler();
+	}
+}
@@ -0,0 +1,81 @@
+#define F_CPU 72000000
+
+#include <adc.h>
+#include <clock.h>
+#include <dma.h>
+#include <iopins.h>
+#include <common/spectrum.h>
+
+using namespace Zhele;
+using namespace Zhele::Clock;
+using namespace Zhele::Dsp;
+using namespace Zhele::IO;
+
+// One channel (PA0), ADC clock 12 MHz, 239.5 + 12.5 cycles per conversion: 47619 Hz sample rate
+static const uint32_t SampleRate = 47619;
+static const uint16_t BlockScans = 1024;
+const uint8_t AdcChannels[] = {0};
+
+uint16_t AdcBuffer[2 * BlockScans];
+
+using Fft = RealFftQ15<BlockScans>;
+// Tone detectors (bins of 512 samples are 93 Hz wide)
+GoertzelBank<SampleRate, 512, 1000, 2000, 3000> Tones;
+
+volatile unsigned PeakBin;
+volatile uint32_t PeakFrequency;
+volatile Q15 PeakLevel;
+volatile bool ToneDetected;
+
+void ConfigureClock();
+
+int main()
+{
+    ConfigureClock();
+    Porta::Enable();
+
+    Adc1::Init(Adc1::AdcDivider::Div6);
+    Adc1::SetSampleTime(0, 239);
+
+    Adc1::SetRegularTrigger(Adc1::RegularTrigger::Software, Adc1::TriggerMode::Rising);
+    Adc1::StartRegularPingPong(AdcChannels, sizeof(AdcChannels), AdcBuffer, BlockScans, [](void* data, unsigned size, bool) {
+        Q15* samples = static_cast<Q15*>(data);
+        AdcToQ15<12>(static_cast<uint16_t*>(data), samples, size);
+
+        if (Tones.Process(samples, size))
+            ToneDetected = Tones.Magnitude(0) > ToQ15(0.1) && Tones.Magnitude(1) < ToQ15(0.02);
+
+        // Spectrum is calculated in place (half-buffer is overwritten)
+        Fft::Forward(samples);
+        Fft::Magnitude(samples, samples);
+        unsigned peak = 1;
+        for (unsigned k = 2; k < Fft::Bins; ++k)
+        {
+            if (samples[k] > samples[peak])
+                peak = k;
+        }
+        PeakBin = peak;
+        PeakFrequency = Fft::BinFrequency(SampleRate, peak);
+        PeakLevel = samples[peak];
+    });
+
+    for(;;)
+    {
+    }
+}
+
+void ConfigureClock()
+{
+    PllClock::SelectClockSource(PllClock::ClockSource::External);
+    PllClock::SetMultiplier(9);
+    Apb1Clock::SetPrescaler(Apb1Clock::Div2);
+    SysClock::SelectClockSource(SysClock::Pll);
+}
+
+extern "C"
+{
+    void DMA1_Channel1_IRQHandler()
+    {
+        Dma1Channel1::IrqHandler();
+    }
+}
@@ -0,0 +1,89 @@
+// Define target cpu frequence.
+#define F_CPU 72000000
+
+#include <clock.h>
+#include <spi.h>
+#include <drivers/ssd1306.h>
+
+using namespace Zhele;
+using namespace Zhele::Clock;
+using namespace Zhele::IO;
+using namespace Zhele::Drivers;
+
+// CS - PA4, D/C - PA3, RES - PA2. Double buffer: next frame is drawn while previous one is sent by DMA
+using Lcd = Ssd1306Spi<Spi1, IO::Pa4, IO::Pa3, IO::Pa2, true>;
+
+const uint8_t BallSize = 8;
+
+void ConfigureClock();
+void ConfigurePins();
+void ConfigureSpi();
+void DrawBall(int x, int y, Lcd::Pixel state);
+
+int main()
+{
+    ConfigureClock();
+    ConfigurePins();
+    ConfigureSpi();
+
+    Lcd::Init();
+
+    int x = 0, y = 0, dx = 1, dy = 1;
+    for (;;)
+    {
+        // Frame is latched only if previous one is sent, otherwise its changes are sent with next frame
+        if (!Lcd::Update())
+            continue;
+
+        DrawBall(x, y, Lcd::Pixel::Off);
+        if (x + dx < 0 || x + dx > 128 - BallSize)
+            dx = -dx;
+        if (y + dy < 0 || y + dy > 64 - BallSize)
+            dy = -dy;
+        x += dx;
+        y += dy;
+        DrawBall(x, y, Lcd::Pixel::On);
+    }
+}
+
+void DrawBall(int x, int y, Lcd::Pixel state)
+{
+    for (int i = 0; i < BallSize; ++i)
+    {
+        for (int j = 0; j < BallSize; ++j)
+            Lcd::DrawPixel(x + i, y + j, state);
+    }
+}
+
+void ConfigureClock()
+{
+    PllClock::SelectClockSource(PllClock::ClockSource::External);
+    PllClock::SetMultiplier(9);
+    Apb1Clock::SetPrescaler(Apb1Clock::Div2);
+    SysClock::SelectClockSource(SysClock::Pll);
+}
+
+void ConfigurePins()
+{
+    Porta::Enable();
+    using ControlPins = PinList<Pa2, Pa3, Pa4>;
+    ControlPins::SetConfiguration<ControlPins::Out>();
+    ControlPins::SetDriverType<ControlPins::PushPull>();
+    ControlPins::SetSpeed<ControlPins::Fast>();
+    ControlPins::Write(0x04);
+}
+
+void ConfigureSpi()
+{
+    // 72 MHz / 8 = 9 MHz
+    Spi1::Init(Spi1::ClockDivider::Div8);
+    Spi1::SelectPins<IO::Pa7, IO::Pa6, IO::Pa5, IO::NullPin>();
+}
+
+extern "C"
+{
+    void DMA1_Channel3_IRQHandler()
+    {
+        Dma1Channel3::IrqHandler();
+    }
+}
@@ -22,4 +22,23 @@ int main()
     for (;;)
     {
     }
-}
\ No newline at end of file
+}
+
+extern "C"
+{
+    // Lcd::Update is asynchronous: transaction is driven by I2C and DMA interrupts
+    void I2C1_EV_IRQHandler()
+    {
+        I2c1::EventIrqHandler();
+    }
+
+    void I2C1_ER_IRQHandler()
+    {
+        I2c1::ErrorIrqHandler();
+    }
+
+    void DMA1_Channel6_IRQHandler()
+    {
+        Dma1Channel6::IrqHandler();
+    }
+}
@@ -0,0 +1,68 @@
+// Define target cpu frequence.
+#define F_CPU 72000000
+
+#include <clock.h>
+#include <spi.h>
+#include <drivers/ssd1306.h>
+#include <drivers/fonts.h>
+
+using namespace Zhele;
+using namespace Zhele::Clock;
+using namespace Zhele::IO;
+using namespace Zhele::Drivers;
+
+// CS - PA4, D/C - PA3, RES - PA2
+using Lcd = Ssd1306Spi<Spi1, IO::Pa4, IO::Pa3, IO::Pa2>;
+
+void ConfigureClock();
+void ConfigurePins();
+void ConfigureSpi();
+
+int main()
+{
+    ConfigureClock();
+    ConfigurePins();
+    ConfigureSpi();
+
+    Lcd::Init();
+    Lcd::Puts<TimesNewRoman13>("Abcdefghijklmnopqrstu");
+    Lcd::Update();
+
+    for (;;)
+    {
+    }
+}
+
+void ConfigureClock()
+{
+    PllClock::SelectClockSource(PllClock::ClockSource::External);
+    PllClock::SetMultiplier(9);
+    Apb1Clock::SetPrescaler(Apb1Clock::Div2);
+    SysClock::SelectClockSource(SysClock::Pll);
+}
+
+void ConfigurePins()
+{
+    Porta::Enable();
+    using ControlPins = PinList<Pa2, Pa3, Pa4>;
+    ControlPins::SetConfiguration<ControlPins::Out>();
+    ControlPins::SetDriverType<ControlPins::PushPull>();
+    ControlPins::SetSpeed<ControlPins::Fast>();
+    ControlPins::Write(0x04);
+}
+
+void ConfigureSpi()
+{
+    // 72 MHz / 8 = 9 MHz
+    Spi1::Init(Spi1::ClockDivider::Div8);
+    Spi1::SelectPins<IO::Pa7, IO::Pa6, IO::Pa5, IO::NullPin>();
+}
+
+extern "C"
+{
+    // Lcd::Update is asynchronous: data is sent by DMA
+    void DMA1_Channel3_IRQHandler()
+    {
+        Dma1Channel3::IrqHandler();
+    }
+}
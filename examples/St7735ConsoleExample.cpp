@@ -0,0 +1,89 @@
+// Define target cpu frequence.
+#define F_CPU 72000000
+
+#include <clock.h>
+#include <spi.h>
+#include <drivers/st7735.h>
+#include <drivers/fonts.h>
+
+using namespace Zhele;
+using namespace Zhele::Clock;
+using namespace Zhele::IO;
+using namespace Zhele::Drivers;
+
+// Portrait orientation: hardware scrolling is vertical
+using Lcd = St7735<Spi1, IO::Pa4, IO::Pa3, IO::Pa2, 128, 160>;
+// Log view below fixed 16-lines header
+using Log = St7735Console<Lcd, Fixed10x15Bold>;
+
+void ConfigureClock();
+void ConfigurePins();
+void ConfigureSpi();
+
+int main()
+{
+    ConfigureClock();
+    ConfigurePins();
+    ConfigureSpi();
+
+    Lcd::Init();
+    Lcd::FillRectangle(0, 0, 128, 16, Lcd::Color::Blue);
+    while(Lcd::Busy()) continue;
+    Lcd::WriteString<Fixed10x15Bold>(2, 0, "Log", Lcd::Color::White, Lcd::Color::Blue);
+
+    Log::Init(16);
+
+    char line[] = "Event 0\n";
+    for (unsigned i = 0; ; ++i)
+    {
+        // Only new chars (and one cleared line when console scrolls) are sent
+        line[6] = '0' + i % 10;
+        Log::SetColors(i % 10 == 0 ? Lcd::Color::Yellow : Lcd::Color::White, Lcd::Color::Black);
+        Log::Write(line);
+    }
+}
+
+void ConfigureClock()
+{
+    PllClock::SelectClockSource(PllClock::ClockSource::External);
+    PllClock::SetMultiplier(9);
+    Apb1Clock::SetPrescaler(Apb1Clock::Div2);
+    SysClock::SelectClockSource(SysClock::Pll);
+}
+
+void ConfigurePins()
+{
+    Pa4::Port::Enable();
+    Pa4::SetConfiguration(Pa4::Configuration::Out);
+    Pa4::SetDriverType(Pa4::DriverType::PushPull);
+    Pa4::SetSpeed(Pa4::Speed::Fast);
+    Pa4::Set();
+
+    Pa3::Port::Enable();
+    Pa3::SetConfiguration(Pa3::Configuration::Out);
+    Pa3::SetDriverType(Pa3::DriverType::PushPull);
+    Pa3::SetSpeed(Pa3::Speed::Fast);
+    Pa3::Clear();
+
+    Pa2::Port::Enable();
+    Pa2::SetConfiguration(Pa2::Configuration::Out);
+    Pa2::SetDriverType(Pa2::DriverType::PushPull);
+    Pa2::SetSpeed(Pa2::Speed::Fast);
+    Pa2::Clear();
+}
+
+void ConfigureSpi()
+{
+    Spi1::Init(Spi1::ClockDivider::Fastest);
+    Spi1::SetClockPolarity(Spi1::ClockPolarity::ClockPolarityHigh);
+    Spi1::SetClockPhase(Spi1::ClockPhase::ClockPhaseFallingEdge);
+    Spi1::SelectPins<IO::Pa7, IO::Pa6, IO::Pa5, IO::NullPin>();
+}
+extern "C"
+{
+    // Async operations (FillRectangle) are driven by SPI DMA interrupt
+    void DMA1_Channel3_IRQHandler()
+    {
+        Dma1Channel3::IrqHandler();
+    }
+}
@@ -35,6 +35,13 @@ int main()
     // Write string with monospace font
     Lcd::WriteString<Fixed10x15Bold>(10, 30, "Abcdefghijklmnopqrstuvwxyz", Lcd::Color::Yellow, Lcd::Color::Black);
 
+    // Redraw whole screen by strips (no framebuffer needed: strip is rendered while previous one is being sent)
+    Lcd::Render([](Lcd::Strip& strip) {
+        strip.Fill(Lcd::Color::Black);
+        strip.FillRectangle(0, 50, 160, 20, Lcd::Color::Blue);
+        strip.WriteString<TimesNewRoman13>(10, 54, "Strip renderer", Lcd::Color::White, Lcd::Color::Blue);
+    });
+
     for (;;)
     {
     }
@@ -75,4 +82,12 @@ void ConfigureSpi()
     Spi1::SetClockPolarity(Spi1::ClockPolarity::ClockPolarityHigh);
     Spi1::SetClockPhase(Spi1::ClockPhase::ClockPhaseFallingEdge);
     Spi1::SelectPins<IO::Pa7, IO::Pa6, IO::Pa5, IO::NullPin>();
-}
\ No newline at end of file
+}
+extern "C"
+{
+    // Async operations (FillScreen, Render) are driven by SPI DMA interrupt
+    void DMA1_Channel3_IRQHandler()
+    {
+        Dma1Channel3::IrqHandler();
+    }
+}
@@ -0,0 +1,113 @@
+// Define target cpu frequence.
+#define F_CPU 72000000
+
+#include <clock.h>
+#include <spi.h>
+#include <drivers/image_decoder.h>
+#include <drivers/sdcard.h>
+#include <drivers/st7735.h>
+#include <drivers/filesystem/fatfs/ff.h>
+
+using namespace Zhele;
+using namespace Zhele::Clock;
+using namespace Zhele::IO;
+using namespace Zhele::Drivers;
+
+// Display on SPI2 (SD card on SPI1 is used by FatFs drive, see fatfs_adapter.h), portrait orientation
+using Lcd = St7735<Spi2, IO::Pb12, IO::Pb11, IO::Pb10, 128, 160>;
+using SdCardReader = Drivers::SdCard<Spi1, IO::Pa4>;
+
+void ConfigureClock();
+void ConfigurePins();
+void ConfigureSpi();
+
+static FIL file;
+
+// Positional read from opened file (BMP rows are read bottom-up)
+unsigned ReadFile(uint32_t offset, void* buffer, unsigned size)
+{
+    UINT read = 0;
+    if((f_tell(&file) != offset && f_lseek(&file, offset) != FR_OK) || f_read(&file, buffer, size, &read) != FR_OK)
+        return 0;
+    return read;
+}
+
+template<typename _Decoder>
+bool Show(const char* name)
+{
+    if(f_open(&file, name, FA_OPEN_EXISTING | FA_READ) != FR_OK)
+        return false;
+
+    // Less than 400 bytes of RAM for image of any size
+    _Decoder decoder(ReadFile);
+    bool result = decoder.Open() && decoder.Width() <= 128 && decoder.Height() <= 160
+        && Lcd::DrawStream(0, 0, decoder.Width(), decoder.Height(), decoder);
+
+    f_close(&file);
+    return result;
+}
+
+int main()
+{
+    static FATFS fs;
+
+    ConfigureClock();
+    ConfigurePins();
+    ConfigureSpi();
+
+    Lcd::Init();
+
+    if(SdCardReader::Detect() == Drivers::SdCardType::SdCardNone || f_mount(&fs, "", 1) != FR_OK)
+    {
+        Lcd::FillScreen(Lcd::Color::Red);
+        for (;;) {}
+    }
+
+    // RLE image is made by tools/rle_image.py
+    for (;;)
+    {
+        Show<BmpDecoder<decltype(&ReadFile)>>("photo.bmp");
+        delay_ms<3000>();
+        Show<RleDecoder<decltype(&ReadFile)>>("splash.rle");
+        delay_ms<3000>();
+    }
+}
+
+void ConfigureClock()
+{
+    PllClock::SelectClockSource(PllClock::ClockSource::External);
+    PllClock::SetMultiplier(9);
+    Apb1Clock::SetPrescaler(Apb1Clock::Div2);
+    SysClock::SelectClockSource(SysClock::Pll);
+}
+
+void ConfigurePins()
+{
+    using ControlPins = PinList<Pb10, Pb11, Pb12>;
+    ControlPins::Enable();
+    ControlPins::SetConfiguration<ControlPins::Out>();
+    ControlPins::SetDriverType<ControlPins::PushPull>();
+    ControlPins::SetSpeed<ControlPins::Fast>();
+    ControlPins::Write(0x04);
+}
+
+void ConfigureSpi()
+{
+    // SPI2 clock is 36 MHz / 2
+    Spi2::Init(Spi2::ClockDivider::Fastest);
+    Spi2::SetClockPolarity(Spi2::ClockPolarity::ClockPolarityHigh);
+    Spi2::SetClockPhase(Spi2::ClockPhase::ClockPhaseFallingEdge);
+    Spi2::SelectPins<IO::Pb15, IO::NullPin, IO::Pb13, IO::NullPin>();
+
+    Spi1::Init(Spi1::Fast, Spi1::Master);
+    Spi1::SelectPins<Pa7, Pa6, Pa5, Pa4>();
+}
+
+extern "C"
+{
+    // Image chunks are sent by SPI2 DMA
+    void DMA1_Channel5_IRQHandler()
+    {
+        Dma1Channel5::IrqHandler();
+    }
+}
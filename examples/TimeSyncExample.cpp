@@ -0,0 +1,127 @@
+// Attention please!!! This example consists from 2 parts: Master and Slave.
+// Flash it with MASTER defined to one mcu and without it to others.
+// Slaves toggle C13 at the same master time (compare with scope), start ADC conversions there
+// to get aligned samples.
+
+#define F_CPU 72000000
+
+#include <clock.h>
+#include <exti.h>
+#include <iopins.h>
+#include <spi.h>
+#include <timer.h>
+#include <common/timebase.h>
+#include <common/time_sync.h>
+#include <drivers/nrf24l.h>
+
+#include <string.h>
+
+using namespace Zhele;
+using namespace Zhele::Clock;
+using namespace Zhele::IO;
+using namespace Zhele::Timers;
+
+// Timer3 counts microseconds, its update event clocks Timer4 (TIM4 ITR2 = TIM3 TRGO)
+using Timebase = TimerTimebase<Timer3, Timer4, Timer4::SlaveMode::Trigger::InternalTrigger2>;
+
+// Radio IRQ is connected to B0: it is EXTI line and Timer3 channel 3 at the same time,
+// TX_DS (master) and RX_DR (slave) edges are captured by hardware
+using Radio = Drivers::Nrf24l<Spi1, Pa4, Pa3, Pb0>;
+using IrqCapture = TimebaseCapture<Timebase, 2>;
+
+void ConfigureClock();
+
+int main()
+{
+    const uint8_t address[] = { 0x5c, 0x11, 0x0c, 0x4b, 0x00 };
+
+    ConfigureClock();
+    Timebase::Init();
+    IrqCapture::Init<Pb0>();
+
+    Spi1::SelectPins<Pa7, Pa6, Pa5, NullPin>();
+    Radio::Init(90);
+    Radio::InitIrq<Exti0>();
+
+#if defined (MASTER)
+    Radio::SetTxAddress(address, false);
+    Radio::StartTransmitter();
+
+    TimeSyncMaster master;
+    uint32_t lastSync = Timebase::Micros();
+    for (;;)
+    {
+        uint32_t timestamp;
+        if (IrqCapture::Get(timestamp))
+            master.OnTransmitted(timestamp);
+
+        if (Timebase::Micros() - lastSync >= 1000000)
+        {
+            lastSync += 1000000;
+            TimeSyncMessage message;
+            master.Prepare(message);
+            Radio::Send(reinterpret_cast<const uint8_t*>(&message), sizeof(message), Radio::NoAckPipe);
+        }
+    }
+#else
+    Radio::SetPipeAddress(1, address);
+    Radio::StartReceiver();
+
+    Pc13::Port::Enable();
+    Pc13::SetConfiguration(Pc13::Configuration::Out);
+    Pc13::SetDriverType(Pc13::DriverType::PushPull);
+
+    TimeSyncSlave<> slave;
+    uint32_t timestamp = 0;
+    uint32_t nextTick = 0;
+    Radio::Packet packet;
+    for (;;)
+    {
+        // Only sync messages are received: capture of the last RX_DR edge belongs to them
+        IrqCapture::Get(timestamp);
+        while (Radio::Receive(packet))
+        {
+            TimeSyncMessage message;
+            if (packet.Size != sizeof(message))
+                continue;
+            memcpy(&message, packet.Data, sizeof(message));
+            if (slave.OnReceived(message, timestamp) && nextTick == 0)
+                nextTick = (slave.ToMaster(Timebase::Ticks()) / 100000 + 2) * 100000;
+        }
+
+        // Every 100 ms of master time
+        if (slave.Synchronized() && nextTick != 0 && static_cast<int32_t>(Timebase::Ticks() - slave.ToLocal(nextTick)) >= 0)
+        {
+            Pc13::Toggle();
+            nextTick += 100000;
+        }
+    }
+#endif
+}
+
+void ConfigureClock()
+{
+    PllClock::SelectClockSource(PllClock::ClockSource::External);
+    PllClock::SetMultiplier(9);
+    Apb1Clock::SetPrescaler(Apb1Clock::Div2);
+    SysClock::SelectClockSource(SysClock::Pll);
+}
+
+extern "C"
+{
+    void TIM3_IRQHandler()
+    {
+        IrqCapture::IrqHandler();
+    }
+
+    void TIM4_IRQHandler()
+    {
+        Timebase::UpdateIrqHandler();
+    }
+
+    void EXTI0_IRQHandler()
+    {
+        Exti0::ClearInterruptFlag();
+        Radio::IrqHandler();
+    }
+}
@@ -0,0 +1,55 @@
+#define F_CPU 72000000
+
+#include <clock.h>
+#include <iopins.h>
+#include <timer.h>
+#include <common/timebase.h>
+
+using namespace Zhele;
+using namespace Zhele::Clock;
+using namespace Zhele::IO;
+using namespace Zhele::Timers;
+
+// Timer3 counts microseconds, its update event clocks Timer4 (TIM4 ITR2 = TIM3 TRGO)
+using Timebase = TimerTimebase<Timer3, Timer4, Timer4::SlaveMode::Trigger::InternalTrigger2>;
+using CycleCounter = DwtTimebase<>;
+
+void ConfigureClock();
+
+int main()
+{
+    ConfigureClock();
+
+    Timebase::Init();
+    CycleCounter::Init();
+
+    Pc13::Port::Enable();
+    Pc13::SetConfiguration(Pc13::Configuration::Out);
+    Pc13::SetDriverType(Pc13::DriverType::PushPull);
+
+    uint64_t lastToggle = Timebase::Micros64();
+    for (;;)
+    {
+        if (Timebase::Micros64() - lastToggle >= 500000)
+        {
+            lastToggle += 500000;
+            Pc13::Toggle();
+        }
+    }
+}
+
+void ConfigureClock()
+{
+    PllClock::SelectClockSource(PllClock::ClockSource::External);
+    PllClock::SetMultiplier(9);
+    Apb1Clock::SetPrescaler(Apb1Clock::Div2);
+    SysClock::SelectClockSource(SysClock::Pll);
+}
+
+extern "C"
+{
+    void TIM4_IRQHandler()
+    {
+        Timebase::UpdateIrqHandler();
+    }
+}
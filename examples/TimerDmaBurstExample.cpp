@@ -0,0 +1,91 @@
+#define F_CPU 72000000
+
+#include <clock.h>
+#include <dma.h>
+#include <iopins.h>
+#include <timer.h>
+
+using namespace Zhele;
+using namespace Zhele::Clock;
+using namespace Zhele::IO;
+using namespace Zhele::Timers;
+
+// WS2812 strip on PA6 (Timer3 channel 1). Every PWM period DMA loads next bit duty into CCR1.
+using StripTimer = Timer3;
+using StripPwm = StripTimer::PWMGeneration<0>;
+using StripDma = Dma1Channel3; // TIM3_UP
+
+static const unsigned LedsCount = 8;
+static const uint16_t Period = 90; // 72 MHz / 90 = 800 kHz
+static const uint16_t Bit0 = 29;
+static const uint16_t Bit1 = 58;
+static const unsigned ResetPeriods = 48; // > 50 us low
+
+uint16_t StripBuffer[LedsCount * 24 + ResetPeriods];
+volatile bool StripBusy;
+
+void ConfigureClock();
+void ShowColors(const uint32_t* colors);
+
+int main()
+{
+    ConfigureClock();
+
+    StripTimer::Enable();
+    StripTimer::SetPrescaler(0);
+    StripTimer::SetPeriod(Period - 1);
+    StripPwm::SelectPins<Pa6>();
+    StripPwm::SetOutputMode(StripPwm::OutputMode::PWM1);
+    StripPwm::SetPulse(0);
+    StripPwm::Enable();
+    StripTimer::Start();
+
+    uint32_t colors[LedsCount];
+    uint8_t phase = 0;
+
+    for (;;)
+    {
+        for (unsigned i = 0; i < LedsCount; ++i)
+            colors[i] = static_cast<uint8_t>(phase + i * 32) << 8; // Green running wave (GRB)
+        ++phase;
+
+        ShowColors(colors);
+        while (StripBusy)
+        {
+        }
+    }
+}
+
+void ShowColors(const uint32_t* colors)
+{
+    uint16_t* duty = StripBuffer;
+    for (unsigned led = 0; led < LedsCount; ++led)
+    {
+        for (int bit = 23; bit >= 0; --bit)
+            *duty++ = (colors[led] & (1u << bit)) ? Bit1 : Bit0;
+    }
+    for (unsigned i = 0; i < ResetPeriods; ++i)
+        *duty++ = 0;
+
+    StripBusy = true;
+    StripTimer::StartDmaBurst<StripDma>(StripTimer::DmaBurstBase::Ccr1, 1, StripBuffer, sizeof(StripBuffer) / sizeof(StripBuffer[0]), false, [](void*, unsigned, bool) {
+        StripTimer::StopDmaBurst<StripDma>();
+        StripBusy = false;
+    });
+}
+
+void ConfigureClock()
+{
+    PllClock::SelectClockSource(PllClock::ClockSource::External);
+    PllClock::SetMultiplier(9);
+    Apb1Clock::SetPrescaler(Apb1Clock::Div2);
+    SysClock::SelectClockSource(SysClock::Pll);
+}
+
+extern "C"
+{
+    void DMA1_Channel3_IRQHandler()
+    {
+        StripDma::IrqHandler();
+    }
+}
@@ -0,0 +1,42 @@
+#define F_CPU 72000000
+
+#include <containers/dma_ring_buffer.h>
+#include <iopins.h>
+#include <usart.h>
+
+using namespace Zhele;
+using namespace Zhele::Containers;
+using namespace Zhele::IO;
+
+using UsartConnection = Usart1;
+using Led = Pc13;
+
+// USART1 RX request is DMA1 channel 5
+DmaRingBuffer<Dma1Channel5, 256> RxBuffer;
+
+// Program receives bytes by circular DMA without any interrupt
+// and echoes them back from main loop.
+int main()
+{
+    Led::Port::Enable();
+    Led::SetConfiguration(Led::Configuration::Out);
+    Led::SetDriverType(Led::DriverType::PushPull);
+
+    UsartConnection::Init(115200);
+    UsartConnection::SelectTxRxPins<Pa9, Pa10>();
+    // Stream read enables USART DMA request and starts circular transfer to ring buffer memory
+    UsartConnection::EnableStreamRead(RxBuffer.data(), RxBuffer.capacity());
+    RxBuffer.clear();
+
+    for (;;)
+    {
+        auto received = RxBuffer.peek_read_span();
+        if(received.size() == 0)
+            continue;
+
+        UsartConnection::Write(received.first.data, received.first.size);
+        UsartConnection::Write(received.second.data, received.second.size);
+        RxBuffer.consume(received.size());
+        Led::Toggle();
+    }
+}
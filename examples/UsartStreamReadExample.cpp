@@ -0,0 +1,53 @@
+#define F_CPU 72000000
+
+#include <iopins.h>
+#include <usart.h>
+
+using namespace Zhele;
+using namespace Zhele::IO;
+
+using UsartConnection = Usart1;
+using Led = Pc13;
+
+uint8_t RxBuffer[256];
+
+void FrameReceived(void* data, unsigned size, bool success);
+
+// Program receives variable-length frames via circular DMA.
+// Callback is called on idle line (end of frame), so there is no per-byte interrupts.
+// Each received frame is echoed back.
+int main()
+{
+    Led::Port::Enable();
+    Led::SetConfiguration(Led::Configuration::Out);
+    Led::SetDriverType(Led::DriverType::PushPull);
+
+    UsartConnection::Init(921600);
+    UsartConnection::SelectTxRxPins<Pa9, Pa10>();
+    UsartConnection::EnableStreamRead(RxBuffer, sizeof(RxBuffer), FrameReceived);
+
+    for (;;)
+    {
+        // Also you can read received data from main loop without callback
+        // const uint8_t* data;
+        // size_t size = UsartConnection::StreamPeek(data);
+        // ... process data
+        // UsartConnection::StreamConsume(size);
+    }
+}
+
+void FrameReceived(void* data, unsigned size, bool success)
+{
+    // Data points directly to receive buffer. It is valid until DMA overwrites it.
+    UsartConnection::Write(data, size);
+    UsartConnection::StreamConsume(size);
+    Led::Toggle();
+}
+
+extern "C"
+{
+    void USART1_IRQHandler()
+    {
+        UsartConnection::IrqHandler();
+    }
+}
@@ -0,0 +1,99 @@
+// USB flash drive is connected to OTG_FS port (PA11/PA12), board provides VBUS.
+// FatFs drive table should be declared in header ZHELE_FATFS_DRIVES_CONFIG, for example:
+// #include <usb_host.h>
+// namespace Zhele::Drivers::Filesystem { using FatFsDrives = FatFsDriveTable<BlockDeviceFatFsAdapter<Zhele::Usb::MscHost<Zhele::Usb::Host>>>; }
+#include <clock.h>
+#include <iopins.h>
+#include <usb_host.h>
+
+#include <drivers/filesystem/fatfs/ff.h>
+
+using namespace Zhele;
+using namespace Zhele::Clock;
+using namespace Zhele::IO;
+using namespace Zhele::Usb;
+
+using Drive = MscHost<Host>;
+
+void ConfigureClock();
+void ConfigureUsbPins();
+void ConfigureLed();
+bool WriteLog();
+
+int main()
+{
+    ConfigureClock();
+    ConfigureUsbPins();
+    ConfigureLed();
+
+    Host::Enable();
+
+    bool written = false;
+    for(;;)
+    {
+        if(!Drive::Process())
+        {
+            // Drive is removed: write log again to next one
+            written = false;
+            Pc13Inv::Clear();
+            continue;
+        }
+
+        if(!written)
+        {
+            written = true;
+            WriteLog() ? Pc13Inv::Set() : Pc13Inv::Clear();
+        }
+    }
+}
+
+bool WriteLog()
+{
+    static FATFS fs;
+    FIL file;
+    UINT size;
+
+    if(f_mount(&fs, "", 1) != FR_OK)
+        return false;
+
+    bool result = false;
+    if(f_open(&file, "zhele.log", FA_WRITE | FA_OPEN_APPEND) == FR_OK)
+    {
+        result = f_write(&file, "Hello from USB host\r\n", 21, &size) == FR_OK && size == 21;
+        result = f_close(&file) == FR_OK && result;
+    }
+    f_mount(nullptr, "", 0);
+    return result;
+}
+
+void ConfigureClock()
+{
+    PllClock::SelectClockSource(PllClock::ClockSource::External);
+    PllClock::SetDivider(25);
+    PllClock::SetMultiplier(336);
+    PllClock::SetSystemOutputDivider(PllClock::SystemOutputDivider::Div4);
+    PllClock::SetUsbOutputDivider(7);
+    Apb1Clock::SetPrescaler(Apb1Clock::Div2);
+    SysClock::SelectClockSource(SysClock::Pll);
+}
+
+void ConfigureUsbPins()
+{
+    Zhele::IO::Porta::Enable();
+
+    Pa11::SetConfiguration<Pa11::Configuration::AltFunc>();
+    Pa11::SetSpeed<Pa11::Speed::Fastest>();
+    Pa11::AltFuncNumber<10>();
+
+    Pa12::SetConfiguration<Pa12::Configuration::AltFunc>();
+    Pa12::SetSpeed<Pa12::Speed::Fastest>();
+    Pa12::AltFuncNumber<10>();
+}
+
+void ConfigureLed()
+{
+    Pc13Inv::Port::Enable();
+    Pc13Inv::SetConfiguration(Pc13Inv::Configuration::Out);
+    Pc13Inv::SetDriverType(Pc13Inv::DriverType::PushPull);
+    Pc13Inv::Clear();
+}
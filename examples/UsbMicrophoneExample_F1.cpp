@@ -0,0 +1,87 @@
+#include <adc.h>
+#include <clock.h>
+#include <dma.h>
+#include <iopins.h>
+#include <timer.h>
+#include <usb.h>
+
+using namespace Zhele;
+using namespace Zhele::Clock;
+using namespace Zhele::IO;
+using namespace Zhele::Timers;
+using namespace Zhele::Usb;
+
+// 16 kHz mono microphone on PA0
+static const uint32_t SampleRate = 16000;
+
+using MicrophoneEndpointBase = IsochronousEndpointBase<1, EndpointDirection::In, 40>;
+
+using EpInitializer = EndpointsInitializer<DefaultEp0, MicrophoneEndpointBase>;
+using Ep0 = EpInitializer::ExtendEndpoint<DefaultEp0>;
+using MicrophoneEndpoint = EpInitializer::ExtendEndpoint<MicrophoneEndpointBase>;
+
+using AudioControl = MicrophoneControlInterface<0, Ep0, 1, 1>;
+using AudioStreaming = AudioStreamingInterface<1, Ep0, AudioControl::StreamingTerminalId, SampleRate, 1, 16, MicrophoneEndpoint>;
+
+using Config = Configuration<0, 250, false, false, AudioControl, AudioStreaming>;
+using MyDevice = Device<0x0200, DeviceAndInterfaceClass::InterfaceSpecified, 0, 0, 0x0483, 0x5730, 0, Ep0, Config>;
+
+using Microphone = AudioInStream<MicrophoneEndpoint, SampleRate, 1>;
+
+// Sampling timer: TRGO on update
+using SampleTimer = Timer3;
+
+// Two halves by 1 ms
+uint16_t AdcBuffer[2 * SampleRate / 1000];
+const uint8_t AdcChannels[] = {0};
+
+void ConfigureClock();
+
+int main()
+{
+    ConfigureClock();
+    Porta::Enable();
+
+    Adc1::Init(Adc1::AdcDivider::Div6);
+    Adc1::SetSampleTime(0, 28);
+    Adc1::SetRegularTrigger(Adc1::RegularTrigger::Timer3TRGO, Adc1::TriggerMode::Rising);
+    Adc1::StartRegularPingPong(AdcChannels, 1, AdcBuffer, SampleRate / 1000, [](void* data, unsigned size, bool) {
+        Microphone::Push(static_cast<uint16_t*>(data), size);
+    });
+
+    SampleTimer::Enable();
+    SampleTimer::SetPrescaler(0);
+    SampleTimer::SetPeriod(SysClock::ClockFreq() / SampleRate - 1);
+    SampleTimer::SetMasterMode(SampleTimer::MasterMode::Update);
+
+    MyDevice::Enable();
+    Microphone::Start();
+
+    SampleTimer::Start();
+
+    for(;;)
+    {
+    }
+}
+
+void ConfigureClock()
+{
+    PllClock::SelectClockSource(PllClock::ClockSource::External);
+    PllClock::SetMultiplier(9);
+    Apb1Clock::SetPrescaler(Apb1Clock::Div2);
+    SysClock::SelectClockSource(SysClock::Pll);
+    MyDevice::SelectClockSource(Zhele::Usb::ClockSource::PllDividedOneAndHalf);
+}
+
+extern "C"
+{
+    void USB_LP_IRQHandler()
+    {
+        MyDevice::CommonHandler();
+    }
+
+    void DMA1_Channel1_IRQHandler()
+    {
+        Dma1Channel1::IrqHandler();
+    }
+}
@@ -0,0 +1,102 @@
+// Define target cpu frequence.
+#define F_CPU 72000000
+
+#include <clock.h>
+#include <spi.h>
+#include <drivers/st7735.h>
+#include <drivers/w25q.h>
+
+using namespace Zhele;
+using namespace Zhele::Clock;
+using namespace Zhele::IO;
+using namespace Zhele::Drivers;
+
+using Lcd = St7735<Spi1, IO::Pa4, IO::Pa3, IO::Pa2, 160, 128>;
+using ExternalFlash = W25q<Spi2, IO::Pb12>;
+
+// RGB565 image (160x128) address in external flash
+const uint32_t ImageAddress = 0x10000;
+
+void ConfigureClock();
+void ConfigurePins();
+void ConfigureSpi();
+
+int main()
+{
+    ConfigureClock();
+    ConfigurePins();
+    ConfigureSpi();
+
+    Lcd::Init();
+    if(!ExternalFlash::Init())
+    {
+        Lcd::FillScreen(Lcd::Color::Red);
+        for (;;) {}
+    }
+
+    // Strips are read from flash by DMA while previous strip is being sent to display,
+    // so image is drawn at bus speed without framebuffer.
+    Lcd::Render([](Lcd::Strip& strip) {
+        ExternalFlash::Read(ImageAddress + strip.Top() * 160 * sizeof(uint16_t), strip.Data(), strip.Height() * 160 * sizeof(uint16_t));
+    });
+
+    for (;;)
+    {
+    }
+}
+
+void ConfigureClock()
+{
+    PllClock::SelectClockSource(PllClock::ClockSource::External);
+    PllClock::SetMultiplier(9);
+    Apb1Clock::SetPrescaler(Apb1Clock::Div2);
+    SysClock::SelectClockSource(SysClock::Pll);
+}
+
+void ConfigurePins()
+{
+    Pa4::Port::Enable();
+    Pa4::SetConfiguration(Pa4::Configuration::Out);
+    Pa4::SetDriverType(Pa4::DriverType::PushPull);
+    Pa4::SetSpeed(Pa4::Speed::Fast);
+    Pa4::Set();
+
+    Pa3::Port::Enable();
+    Pa3::SetConfiguration(Pa3::Configuration::Out);
+    Pa3::SetDriverType(Pa3::DriverType::PushPull);
+    Pa3::SetSpeed(Pa3::Speed::Fast);
+    Pa3::Clear();
+
+    Pa2::Port::Enable();
+    Pa2::SetConfiguration(Pa2::Configuration::Out);
+    Pa2::SetDriverType(Pa2::DriverType::PushPull);
+    Pa2::SetSpeed(Pa2::Speed::Fast);
+    Pa2::Clear();
+}
+
+void ConfigureSpi()
+{
+    Spi1::Init(Spi1::ClockDivider::Fastest);
+    Spi1::SetClockPolarity(Spi1::ClockPolarity::ClockPolarityHigh);
+    Spi1::SetClockPhase(Spi1::ClockPhase::ClockPhaseFallingEdge);
+    Spi1::SelectPins<IO::Pa7, IO::Pa6, IO::Pa5, IO::NullPin>();
+
+    // External flash (SPI mode 0)
+    Spi2::Init(Spi2::ClockDivider::Fastest);
+    Spi2::SelectPins<IO::Pb15, IO::Pb14, IO::Pb13, IO::NullPin>();
+}
+
+extern "C"
+{
+    // Display async operations are driven by SPI1 DMA interrupt
+    void DMA1_Channel3_IRQHandler()
+    {
+        Dma1Channel3::IrqHandler();
+    }
+
+    // Flash transactions complete by SPI2 receive DMA interrupt
+    void DMA1_Channel4_IRQHandler()
+    {
+        Dma1Channel4::IrqHandler();
+    }
+}
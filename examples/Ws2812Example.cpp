@@ -0,0 +1,83 @@
+#define F_CPU 72000000
+
+#include <clock.h>
+#include <dma.h>
+#include <iopins.h>
+#include <spi.h>
+#include <timer.h>
+#include <drivers/ws2812.h>
+
+using namespace Zhele;
+using namespace Zhele::Clock;
+using namespace Zhele::Drivers;
+using namespace Zhele::IO;
+using namespace Zhele::Timers;
+
+// 300 LEDs strip on PA6 (Timer3 channel 1, DMA1 channel 3 is TIM3_UP) and 60 RGBW LEDs on PB15 (SPI2 MOSI).
+// Only 4 LEDs are encoded at once, strips are refreshed at ~100 fps with few percents of CPU.
+using Strip = Ws2812<Ws2812TimerTransport<Timer3, 0, Dma1Channel3>, 300>;
+using RgbwStrip = Ws2812<Ws2812SpiTransport<Spi2>, 60, Ws2812Format::Grbw>;
+
+void ConfigureClock();
+
+uint32_t Wheel(uint8_t position)
+{
+    if (position < 85)
+        return ((255 - position * 3) << 16) | ((position * 3) << 8);
+    if (position < 170)
+    {
+        position -= 85;
+        return ((255 - position * 3) << 8) | (position * 3);
+    }
+    position -= 170;
+    return ((position * 3) << 16) | (255 - position * 3);
+}
+
+int main()
+{
+    ConfigureClock();
+
+    Timer3::PWMGeneration<0>::SelectPins<Pa6>();
+    Strip::Init();
+    Strip::SetBrightness(64);
+
+    RgbwStrip::Init(); // SPI2 clock is 36 MHz / 16 = 2.25 MHz
+    Spi2::SelectPins<Pb15, NullPin, Pb13, NullPin>(); // SCK (PB13) is not connected
+
+    uint8_t phase = 0;
+    for (;;)
+    {
+        while (Strip::Busy() || RgbwStrip::Busy())
+        {
+        }
+
+        for (unsigned i = 0; i < Strip::Count; ++i)
+            Strip::SetPixel(i, Wheel(static_cast<uint8_t>(phase + i)));
+        RgbwStrip::Fill(static_cast<uint32_t>(phase) << 24); // White channel only
+        ++phase;
+
+        Strip::Update();
+        RgbwStrip::Update();
+    }
+}
+
+void ConfigureClock()
+{
+    PllClock::SelectClockSource(PllClock::ClockSource::External);
+    PllClock::SetMultiplier(9);
+    Apb1Clock::SetPrescaler(Apb1Clock::Div2);
+    SysClock::SelectClockSource(SysClock::Pll);
+}
+
+extern "C"
+{
+    void DMA1_Channel3_IRQHandler()
+    {
+        Dma1Channel3::IrqHandler();
+    }
+
+    void DMA1_Channel5_IRQHandler()
+    {
+        Dma1Channel5::IrqHandler(); // SPI2_TX
+    }
+}
@@ -0,0 +1,72 @@
+// Attention please!!! This example consists from 2 parts: Receiver and Transmitter.
+// Flash it with RECEIVER defined to one mcu and without it to another.
+
+// Define target cpu frequence.
+#define F_CPU 8000000
+
+#include <exti.h>
+#include <iopins.h>
+#include <spi.h>
+#include <drivers/nrf24l.h>
+
+using namespace Zhele;
+
+// IRQ is connected to A2
+using Radio = Drivers::Nrf24l<Spi1, IO::Pa4, IO::Pa3, IO::Pa2>;
+
+int main()
+{
+#if defined (RECEIVER)
+    uint8_t myAddress[] = { 0x00, 0x00, 0x00, 0x00, 0x02 };
+#else
+    uint8_t myAddress[] = { 0x00, 0x00, 0x00, 0x00, 0x01 };
+    uint8_t remoteAddress[] = { 0x00, 0x00, 0x00, 0x00, 0x02 };
+#endif
+
+    Spi1::SelectPins<IO::Pa7, IO::Pa6, IO::Pa5, IO::NullPin>();
+    Radio::Init();
+    Radio::SetMyAddress(myAddress);
+    Radio::InitIrq<Exti2>();
+
+#if defined (RECEIVER)
+    Radio::StartReceiver();
+
+    uint8_t received = 0;
+    Radio::Packet packet;
+    for (;;)
+    {
+        if(Radio::Receive(packet))
+        {
+            // Answer with next ACK payload
+            ++received;
+            Radio::Send(&received, 1, packet.Pipe);
+        }
+    }
+#else
+    Radio::SetTxAddress(remoteAddress);
+    Radio::StartTransmitter();
+
+    uint8_t counter = 0;
+    Radio::Packet ack;
+    for (;;)
+    {
+        // Keep queue full: module TX FIFO is refilled from IRQ
+        uint8_t data[32] = {counter};
+        if(Radio::Send(data, sizeof(data)))
+            ++counter;
+
+        // ACK payloads from receiver
+        while(Radio::Receive(ack))
+            continue;
+    }
+#endif
+}
+
+extern "C"
+{
+    void EXTI2_IRQHandler() // "void EXTI2_3_IRQHandler()" for Stm32F0
+    {
+        Exti2::ClearInterruptFlag();
+        Radio::IrqHandler();
+    }
+}
@@ -0,0 +1,82 @@
+// Attention please!!! This example consists from 2 parts: Hub and Node.
+// Flash it with HUB defined to one mcu and with different NODE_ID to others.
+
+// Define target cpu frequence.
+#define F_CPU 72000000
+
+#include <exti.h>
+#include <iopins.h>
+#include <spi.h>
+#include <common/timebase.h>
+#include <drivers/nrf24l_network.h>
+
+using namespace Zhele;
+
+// IRQ is connected to A2
+using Radio = Drivers::Nrf24l<Spi1, IO::Pa4, IO::Pa3, IO::Pa2>;
+using Timebase = Clock::DwtTimebase<>;
+
+// 24 nodes, 2 ms slots: every node transmits once per 49 ms without collisions
+using Hub = Drivers::Nrf24lHub<Radio, Timebase, 24>;
+using Node = Drivers::Nrf24lNode<Radio, Timebase>;
+
+#if !defined (NODE_ID)
+    #define NODE_ID 0
+#endif
+
+int main()
+{
+    const uint8_t baseAddress[] = { 0x10, 0xa5, 0xa5, 0xa5, 0xa5 };
+    const uint8_t beaconAddress[] = { 0xbe, 0xac, 0x0e, 0xac, 0x0e };
+
+    Timebase::Init();
+    Spi1::SelectPins<IO::Pa7, IO::Pa6, IO::Pa5, IO::NullPin>();
+    Radio::Init(76);
+    Radio::InitIrq<Exti2>();
+
+#if defined (HUB)
+    Hub::Init(baseAddress, beaconAddress);
+
+    Hub::NodePacket packet;
+    uint32_t received[24] = {};
+    for (;;)
+    {
+        Hub::Poll();
+        while(Hub::Receive(packet))
+        {
+            if(packet.Node < 24)
+                ++received[packet.Node];
+        }
+    }
+#else
+    Node::Init(NODE_ID, baseAddress, beaconAddress);
+
+    uint32_t lastMeasure = Timebase::Micros();
+    uint8_t counter = 0;
+    for (;;)
+    {
+        Node::Poll();
+
+        // Measurement every 100 ms is sent in next own slot
+        if(Timebase::Micros() - lastMeasure >= 100000)
+        {
+            lastMeasure += 100000;
+            uint8_t data[] = {counter++, 0x12, 0x34};
+            Node::Send(data, sizeof(data));
+        }
+    }
+#endif
+}
+
+extern "C"
+{
+    void EXTI2_IRQHandler() // "void EXTI2_3_IRQHandler()" for Stm32F0
+    {
+        Exti2::ClearInterruptFlag();
+#if defined (HUB)
+        Radio::IrqHandler();
+#else
+        Node::IrqHandler();
+#endif
+    }
+}
@@ -87,10 +87,61 @@ void ClockCompileTest()
     Clock::Hsi48Clock::Enable();
     Clock::Hsi48Clock::Disable();
 #endif
+
+    Clock::Dma1Clock::Acquire();
+    Clock::Dma1Clock::Users();
+    Clock::Dma1Clock::Release();
+}
+
+#include <common/clock_tree.h>
+
+void ClockTreeCompileTest()
+{
+#if defined (RCC_PLLCFGR_PLLREN)
+    using Tree = Clock::ClockTree<80000000, true, 8000000>;
+#elif defined (RCC_PLLCFGR_PLLM)
+    using Tree = Clock::ClockTree<168000000, true, 8000000>;
+    static_assert(Tree::Plan.PllM == 4 && Tree::Plan.PllN == 168 && Tree::Plan.PllP == 2 && Tree::Plan.PllQ == 7);
+#elif defined (RCC_CFGR_PLLMULL)
+    using Tree = Clock::ClockTree<72000000, true, 8000000>;
+    static_assert(Tree::Plan.PllN == 9 && Tree::Apb1ClockFreq == 36000000 && Tree::Apb1TimerClockFreq == 72000000 && Tree::Plan.FlashLatency == 2);
+#else
+    using Tree = Clock::ClockTree<48000000, false, 8000000>;
+#endif
+    Tree::Init();
+    Tree::InitAsync();
+    Tree::Poll();
+}
+
+#include <common/nvic.h>
+
+ZHELE_IRQ_PRIORITY(USART2_IRQn, 3);
+void NvicCompileTest()
+{
+    static_assert(Zhele::IrqPriority<USART2_IRQn>::Value == 3 && Zhele::IrqPriority<USART1_IRQn>::Value == ZHELE_DEFAULT_IRQ_PRIORITY);
+    Zhele::Nvic::EnableIrq<USART2_IRQn>();
+    Zhele::Nvic::SetPriority(USART1_IRQn, Zhele::Nvic::LowestPriority);
+    {
+        Zhele::CriticalSection<2> lock;
+    }
+    uint32_t state = Zhele::DriverCriticalSection::Enter();
+    Zhele::DriverCriticalSection::Leave(state);
 }
 
 #include <dma.h>
 
+#if defined (PERIPH_BB_BASE)
+void BitBandCompileTest()
+{
+    static_assert(Zhele::BitBand::AliasAddress(0x40020008, 1) == 0x42400104);
+    static_assert(Zhele::BitBand::InRegion(0x40020008) && !Zhele::BitBand::InRegion(0x48000000));
+    volatile uint32_t reg = 0;
+    Zhele::BitBand::SetBits(reg, 0x05);
+    Zhele::BitBand::ClearBits(reg, 0x04);
+    Zhele::BitBand::TestBit(reg, 0x01);
+}
+#endif
+
 void DmaCompileTest()
 {
 #if defined (DMA1_Stream0)
@@ -99,6 +150,10 @@ void DmaCompileTest()
     using DmaCh = Dma1Channel1;
 #endif
     DmaCh::Transfer(DmaCh::Mode(), nullptr, nullptr, 0);
+    DmaCh::PingPongTransfer(DmaCh::Mode(), nullptr, nullptr, 0);
+#if defined(DMA_SxCR_DBM)
+    DmaCh::DoubleBufferTransfer(DmaCh::Mode(), nullptr, nullptr, nullptr, 0);
+#endif
     DmaCh::SetTransferCallback(nullptr);
     DmaCh::Ready();
     DmaCh::Enabled();
@@ -143,6 +198,50 @@ void DmaCompileTest()
     DmaMod::ClearTransferComplete<0>();
     DmaMod::Enable();
     DmaMod::Disable();
+
+#if defined (DMA2_Stream0)
+    using DmaMem = DmaMemory<Dma2Stream0, Dma2Stream1>;
+#else
+    using DmaMem = DmaMemory<Dma1Channel1, Dma1Channel2>;
+#endif
+    DmaMem::CopyAsync(nullptr, nullptr, 0);
+    DmaMem::FillAsync(nullptr, 0, 0);
+    DmaMem::Busy();
+    DmaMem::Ready();
+
+    using DmaArbiter = DmaChannelArbiter<DmaCh>;
+    DmaArbiter::RequestChannel(nullptr, nullptr);
+    DmaArbiter::TryAcquire(nullptr);
+    DmaArbiter::Release(nullptr);
+    DmaArbiter::Owner();
+    DmaArbiter::OwnedBy(nullptr);
+    DmaArbiter::Busy();
+    DmaArbiter::Pending();
+}
+
+#include <can.h>
+void CanCompileTest()
+{
+#if defined (CAN1) && (defined (STM32F1) || defined (STM32F4))
+    static_assert(CanBase::CalculateBitTiming(36000000, 1000000) == (1 | (14 << CAN_BTR_TS1_Pos) | (1 << CAN_BTR_TS2_Pos) | (1 << CAN_BTR_SJW_Pos)));
+    static_assert(CanBase::CalculateBitTiming(36000000, 33000) == 0);
+
+    Can1::SelectTxRxPins<IO::Pb9, IO::Pb8>();
+    Can1::Init(500000, CanBase::AutoBusOff);
+    Can1::SetFilters<CanMaskFilter32<0x100, 0x700>, CanListFilter32<0x18ff1234, 0x18ff4321, true, CanFifo::Fifo1>,
+        CanMaskFilter16<0x10, 0x7f0, 0x20, 0x7f0>, CanListFilter16<1, 2, 3, 4>>();
+
+    CanFrame frame {0x123, {1, 2, 3}, 3};
+    Can1::Write(frame);
+    Can1::Read(frame);
+    Can1::ReadAvailable();
+    Can1::WritePending();
+    Can1::GetErrorState();
+    Can1::TxIrqHandler();
+    Can1::Rx0IrqHandler();
+    Can1::Rx1IrqHandler();
+    Can1::SceIrqHandler();
+#endif
 }
 
 #include <i2c.h>
@@ -167,6 +266,18 @@ void I2cCompileTest()
     I2c::SelectPins<0, 0>();
     I2c::SelectPins(0, 0);
     I2c::SelectPins<IO::Pb6, IO::Pb7>();
+
+    static uint8_t registers[32];
+    I2c::EnableSlave(0x42, registers, sizeof(registers), I2cOpts::RegAddr8Bit, [](uint16_t, uint16_t){});
+    I2c::SlaveRegisterPointer();
+    I2c::DisableSlave();
+
+    using Queue = I2cTransactionQueue<I2c, 4, 8>;
+    uint8_t data[2];
+    Queue::Read(0, 0, data, 2);
+    Queue::Write(0, 0, data, 2, nullptr, I2cPriority::High);
+    Queue::Pending();
+    Queue::Busy();
 }
 
 #include <ioports.h>
@@ -227,11 +338,19 @@ void PinListCompileTest()
     Pins::AltFuncNumber(0, 0);
     Pins::AltFuncNumber<0, 0>();
     Pins::AltFuncNumber<0>();
+    Pins::Configure<Pins::Configuration::AltFunc, Pins::Speed::Fast, Pins::DriverType::OpenDrain>();
+    Pins::Configure<Pins::Configuration::In, Pins::Speed::Slow, Pins::DriverType::PushPull, Pins::PullMode::PullUp>();
+    Pins::ConfigureMasked<0x01, Pins::Configuration::Out, Pins::Speed::Medium, Pins::DriverType::PushPull, Pins::PullMode::NoPull, 0>();
+    IO::PinList<IO::Pa0, IO::Pa9, IO::NullPin>::Configure<Pins::Configuration::Out, Pins::Speed::Fast>();
+    IO::Pa1::Configure<IO::Pa1::Configuration::Out, IO::Pa1::Speed::Medium>();
+    static_assert(IO::Private::PinlistMaskForPort<IO::Porta, Zhele::TemplateUtils::TypeList<IO::Pa7, IO::Pb0, IO::Pa9>, 0x05> == 0x0280);
     Pins::IndexOf<IO::Pa0>;
     using pin = Pins::Pin<0>;
 }
 
+#include <binary_stream.h>
 #include <spi.h>
+#include <exti.h>
 void SpiCompileTest()
 {
     using SpiBus = Spi1;
@@ -239,6 +358,12 @@ void SpiCompileTest()
     SpiBus::Enable();
     SpiBus::Disable();
     SpiBus::Init();
+    SpiBus::Init<10000000, Clock::ClockTree<72000000, false, 8000000>>();
+    static_assert(SpiBus::CalculateDivider(72000000, 10000000) == SpiBus::Div8);
+    static uint8_t frames[2][16];
+    SpiBus::EnableSlaveStream<Exti4, IO::Pa4>(nullptr, frames, sizeof(frames[0]), [](void*, uint16_t){});
+    SpiBus::SlaveFrameEnd();
+    SpiBus::DisableSlaveStream();
     SpiBus::SetDivider(SpiBus::ClockDivider::Slow);
     SpiBus::SetClockPolarity(SpiBus::ClockPolarity::ClockPolarityLow);
     SpiBus::SetClockPhase(SpiBus::ClockPhase::ClockPhaseLeadingEdge);
@@ -252,8 +377,59 @@ void SpiCompileTest()
     SpiBus::WriteAsync(nullptr, 0);
     SpiBus::Read();
     SpiBus::ReadAsync(nullptr, 0);
+    uint8_t buffer[32];
+    SpiBus::WriteBuffer(buffer, sizeof(buffer));
+    SpiBus::ReadBuffer(buffer, sizeof(buffer));
+    BinaryStream<SpiBus> stream;
+    stream.Read(buffer, sizeof(buffer));
+    stream.Write(static_cast<const uint8_t*>(buffer), sizeof(buffer));
+    SpiBus::DisableDma();
+    SpiBus::QueueTransaction(SpiBus::Transaction{});
+    SpiBus::TransactionQueueFree();
+    SpiBus::TransactionQueueEmpty();
+    SpiBus::ActiveLowChipSelect<IO::Pa4>(true);
     SpiBus::SelectPins(0, 0, 0, 0);
     SpiBus::SelectPins<0, 0, 0, 0>();
+    SpiBus::SetFrameFormat(SpiBus::ClockPolarity::ClockPolarityHigh, SpiBus::ClockPhase::ClockPhaseFallingEdge, SpiBus::BitOrder::LsbFirst, SpiBus::DataSize::DataSize16);
+
+    using Br = Zhele::RegisterField<SPI_CR1_BR>;
+    constexpr auto value = Br::Value(3) | Zhele::RegisterField<SPI_CR1_CPHA>::Set() | Zhele::RegisterField<SPI_CR1_LSBFIRST>::Clear();
+    static_assert(value.Mask == (SPI_CR1_BR | SPI_CR1_CPHA | SPI_CR1_LSBFIRST) && value.Bits == ((3u << Br::Position) | SPI_CR1_CPHA));
+}
+
+#include <i2s.h>
+void I2sCompileTest()
+{
+#if defined (STM32F4) && defined (RCC_PLLI2SCFGR_PLLI2SN)
+    constexpr auto config = I2sBase::CalculateClock(1000000, 48000, I2sBase::DataFormat::Data16Bit, true);
+    static_assert(config.PllN == 172 && config.PllR == 2 && config.SampleRate == 47991);
+
+    static uint16_t samples[2][64];
+    I2s2::SelectPins<IO::Pb15, IO::Pb13, IO::Pb12, IO::Pc6>();
+    I2s2::Init(48000, I2sBase::Mode::MasterRx, I2sBase::Standard::Philips, I2sBase::DataFormat::Data24Bit, true);
+    I2s2::SampleRate();
+    I2s2::StartReadStream(samples[0], 64, [](void*, unsigned, bool){});
+    I2s2::StartWriteStream(samples[0], 64, [](void*, unsigned, bool){});
+    I2s2::StopStream();
+#endif
+}
+
+#include <qspi.h>
+void QspiCompileTest()
+{
+#if defined (STM32L4) && defined (QUADSPI)
+    const QspiBase::Command read {.Instruction = 0xeb, .AddressLines = QspiBase::Lines::Quad, .AlternateLines = QspiBase::Lines::Quad,
+        .Alternate = 0xf0, .DummyCycles = 4, .DataLines = QspiBase::Lines::Quad};
+    uint8_t buffer[16];
+    Qspi::SelectPins<IO::Pb10, IO::Pb11, IO::Pb1, IO::Pb0, IO::Pa7, IO::Pa6>();
+    Qspi::Init(40000000, 16 * 1024 * 1024);
+    Qspi::Execute({.Instruction = 0x06});
+    Qspi::Read(read, 0, buffer, sizeof(buffer));
+    Qspi::ReadAsync(read, 0, buffer, sizeof(buffer), [](void*, unsigned, bool){});
+    Qspi::WaitStatusAsync({.Instruction = 0x05, .DataLines = QspiBase::Lines::Single}, 0x01, 0x00, [](uint8_t){});
+    Qspi::EnableMemoryMapped(read);
+    Qspi::Data<uint16_t>(0x100);
+#endif
 }
 
 #include <timer.h>
@@ -300,6 +476,36 @@ void TimerCompileTest()
     TimPWM::SelectPins<0>();
 }
 
+#include <common/frequency_counter.h>
+void FrequencyCounterCompileTest()
+{
+    using Counter = Timers::FrequencyCounter<Timers::Timer2, Timers::Timer3, Timers::Timer2::SlaveMode::Trigger::InternalTrigger2>;
+    Timers::Timer2::InputCapture<0>::SetCapturePrescaler(Timers::Timer2::InputCapture<0>::CapturePrescaler::Div8);
+    Counter::SelectPins<IO::Pa0>();
+    Counter::Start(100, [](uint64_t) {});
+    Counter::CounterIrqHandler();
+    Counter::GateIrqHandler();
+    Counter::Stop();
+}
+
+#include <spi.h>
+#include <drivers/ws2812.h>
+void Ws2812CompileTest()
+{
+    using Strip = Drivers::Ws2812<Drivers::Ws2812TimerTransport<Timers::Timer3, 0, Dma1Channel3>, 10>;
+    using RgbwStrip = Drivers::Ws2812<Drivers::Ws2812SpiTransport<Spi1>, 10, Drivers::Ws2812Format::Grbw>;
+    Strip::Init();
+    Strip::SetPixel(0, 0xff, 0, 0);
+    Strip::Fill(0x00ff00);
+    Strip::SetBrightness(128);
+    Strip::Update();
+    Strip::Busy();
+    RgbwStrip::Init();
+    RgbwStrip::Clear();
+    RgbwStrip::Pixels();
+    RgbwStrip::Update([]() {});
+}
+
 #include <usart.h>
 void UsartCompileTest()
 {
@@ -307,15 +513,40 @@ void UsartCompileTest()
 
     UsartBus::Init<9600>();
     UsartBus::Init(9600);
+    UsartBus::Init<115200, Clock::ClockTree<72000000, false, 8000000>>();
+    static_assert(UsartBase::CalculateBaud(72000000, 115200).Brr == 625 && UsartBase::CalculateBaud(72000000, 115200).Error == 0);
     UsartBus::SetConfig(UsartBus::UsartMode::DataBits8 | UsartBus::UsartMode::FullDuplex);
     UsartBus::ClearConfig(UsartBus::UsartMode::DataBits8 | UsartBus::UsartMode::FullDuplex);
     UsartBus::SetBaud(9600);
     UsartBus::ReadReady();
     UsartBus::Read();
     UsartBus::EnableAsyncRead(nullptr, 0);
+    UsartBus::EnableStreamRead(nullptr, 0);
+    UsartBus::DisableStreamRead();
+    UsartBus::StreamAvailable();
+    const uint8_t* streamData;
+    UsartBus::StreamPeek(streamData);
+    UsartBus::StreamConsume(0);
+    UsartBus::StreamRead(nullptr, 0);
+#if defined (USART_CR2_RTOEN)
+    UsartBus::EnableFrameRead(nullptr, 0, 35);
+    UsartBus::FramesAvailable();
+    UsartBus::RxFrame frame;
+    UsartBus::FramePeek(frame);
+    UsartBus::FrameConsume();
+    UsartBus::FrameRead(nullptr, 0);
+    UsartBus::DisableFrameRead();
+#endif
+    UsartBus::IrqHandler();
     UsartBus::WriteReady();
     UsartBus::Write(nullptr, 0);
     UsartBus::Write(0);
+    UsartBus::QueueWrite(static_cast<const void*>(nullptr), 0);
+    UsartBus::QueueWrite(static_cast<const UsartBus::TxDescriptor*>(nullptr), 0);
+    UsartBus::SetWriteQueueCallback(nullptr);
+    UsartBus::WriteQueueFree();
+    UsartBus::WriteQueueEmpty();
+    UsartBus::DisableDma();
     UsartBus::EnableInterrupt(UsartBus::InterruptFlags::AllInterrupts);
     UsartBus::DisableInterrupt(UsartBus::InterruptFlags::AllInterrupts);
     UsartBus::InterruptSource();
@@ -325,7 +556,35 @@ void UsartCompileTest()
     UsartBus::SelectTxRxPins<0, 0>();
 }
 
+#define ZHELE_LOG
+#include <common/log.h>
+void LogCompileTest()
+{
+    static_assert(Zhele::Log::Format<"adc %u, %.2f %%">::ArgumentsCount == 2);
+    static_assert(Zhele::Log::Format<"text %s">::ArgumentsCount == -1);
+    static_assert(Zhele::Log::Format<"a">::Id != Zhele::Log::Format<"b">::Id);
+    Zhele::Log::Buffer::Enable();
+    ZHELE_LOG_WRITE("adc %u, temperature %f, state %d", 1000u, 21.5f, Usart1::InterruptFlags::RxNotEmptyInt);
+    ZHELE_LOG_WRITE("boot");
+    Zhele::Log::Buffer::DrainUsart<Usart1>();
+    Zhele::Log::Buffer::DrainItm();
+    Zhele::Log::Buffer::Dropped();
+}
+
 /*
+#include <common/clock_scaling.h>
+void ClockScalingCompileTest()
+{
+    using Clock::ClockScaling;
+    ClockScaling::Subscribe(ClockScaling::UpdateUsart<Usart1, 115200>);
+    ClockScaling::Subscribe(ClockScaling::UpdateSpi<Spi1, 1000000>);
+    ClockScaling::Subscribe(ClockScaling::UpdateTimer<Timers::Timer2, 1000000>);
+    ClockScaling::SelectClockSource(Clock::SysClock::Internal);
+    ClockScaling::SetAhbPrescaler(Clock::AhbClock::Div4);
+    ClockScaling::Apply<Clock::ClockTree<48000000, false, 8000000>>();
+    ClockScaling::Unsubscribe(ClockScaling::UpdateUsart<Usart1, 115200>);
+}
+
 #include <one_wire.h>
 void OneWireCompileTest()
 {
@@ -342,6 +601,26 @@ void OneWireCompileTest()
     OneWireLine::SearchFirst(nullptr);
 }*/
 
+#include <common/matrix_keypad.h>
+void MatrixKeypadTest()
+{
+    using Keypad = Zhele::IO::MatrixKeypad<Zhele::IO::PinList<Zhele::IO::Pa0, Zhele::IO::Pa1>,
+        Zhele::IO::PinList<Zhele::IO::Pb8, Zhele::IO::Pb9, Zhele::IO::Pb10>, Zhele::Timers::Timer4, Dma1Channel7, Dma1Channel1>;
+    Keypad::Init(2000);
+    Keypad::Start();
+    Keypad::State();
+    Keypad::Pressed();
+    Keypad::Released();
+    Keypad::Stop();
+    static_assert(Keypad::KeyIndex(1, 2) == 5);
+
+    Zhele::Debouncer<uint8_t> debouncer;
+    debouncer.Update(0x01);
+    debouncer.State();
+    debouncer.Pressed();
+    debouncer.Released();
+}
+
 #include <containers/ring_buffer.h>
 void RingBufferTest()
 {
@@ -362,5 +641,729 @@ void RingBufferTest()
     buffer64.clear();
     buffer64[0] = 42;
     constBuffer64[0];
+    uint8_t values[8];
+    buffer64.write(values, 8);
+    buffer64.contiguous_size();
+    buffer64.skip(2);
+    buffer64.read(values, 8);
+    Po2Buffer::span_pair writeSpan = buffer64.acquire_write_span();
+    buffer64.commit(writeSpan.first.size);
+    Po2Buffer::const_span_pair readSpan = constBuffer64.peek_read_span();
+    buffer64.consume(readSpan.size());
+
+    Zhele::Containers::RingBuffer<10, uint16_t> buffer10;
+    buffer10.push_back(42);
+    buffer10.push_back();
+    buffer10.front();
+    buffer10.back();
+    buffer10[1];
+    buffer10.pop_front();
+    buffer10.size();
+    buffer10.clear();
+
+    Zhele::Containers::SharedCounter<uint16_t> counter;
+    counter.fetch_add(2);
+    counter.fetch_sub(1);
+    counter.store(counter.load() + 1);
+}
+
+#include <containers/dma_ring_buffer.h>
+void DmaRingBufferTest()
+{
+#if defined (DMA1_Stream0)
+    using DmaCh = Dma1Stream0;
+#else
+    using DmaCh = Dma1Channel1;
+#endif
+    static Zhele::Containers::DmaRingBuffer<DmaCh, 64, uint16_t> buffer;
+    uint16_t values[8];
+    buffer.start(nullptr);
+    buffer.size();
+    buffer.empty();
+    buffer.read(values, 8);
+    buffer.consume(buffer.peek_read_span().first.size);
+    buffer.clear();
+    buffer.data();
+    buffer.stop();
+}
+
+#include <containers/memory_pool.h>
+void MemoryPoolTest()
+{
+    static Zhele::Containers::MemoryPool<64, 8> pool;
+    void* block = pool.allocate();
+    pool.owns(block);
+    pool.deallocate(block);
+    pool.available();
+
+    static Zhele::Containers::PacketPool<64, 4> packets;
+    auto* packet = packets.create();
+    packets.destroy(packet);
+    packets.available();
+}
+
+#include <containers/mpmc_queue.h>
+void MpmcQueueTest()
+{
+    static Zhele::Containers::MpmcQueue<uint32_t, 16> queue;
+    uint32_t value = 0;
+    queue.push(42);
+    queue.pop(value);
+    queue.empty();
+    queue.size();
+    static_assert(Zhele::Containers::MpmcQueue<uint32_t, 16>::capacity() == 16);
+}
+
+#include <containers/record_queue.h>
+void RecordQueueTest()
+{
+    static Zhele::Containers::RecordQueue<256> queue;
+    uint8_t frame[8] {};
+    queue.push(frame, sizeof(frame));
+    if(uint8_t* record = queue.acquire(16))
+        queue.commit(record[0]);
+    queue.empty();
+    queue.front();
+    queue.pop();
+    static_assert(Zhele::Containers::RecordQueue<256>::max_record_size() == 124);
+}
+
+#include <containers/intrusive_list.h>
+#include <containers/static_priority_queue.h>
+#include <containers/static_vector.h>
+struct ListItem : Zhele::Containers::IntrusiveListNode {};
+void StaticContainersTest()
+{
+    Zhele::Containers::StaticVector<uint32_t, 8, true> vector;
+    vector.push_back(1);
+    vector.emplace_back(2u);
+    vector.insert(0, 3);
+    vector.erase(1);
+    vector.erase_unordered(0);
+    for(uint32_t value : vector) static_cast<void>(value);
+    vector.pop_back();
+    vector.clear();
+
+    ListItem item;
+    Zhele::Containers::IntrusiveList<ListItem, true> list;
+    list.push_back(item);
+    list.remove(item);
+    list.push_front(item);
+    for(ListItem& listItem : list) static_cast<void>(listItem.linked());
+    list.pop_front();
+    list.pop_back();
+    list.size();
+
+    Zhele::Containers::StaticPriorityQueue<uint32_t, 8> queue;
+    uint32_t value;
+    queue.push(1);
+    queue.top();
+    queue.pop(value);
+    queue.pop();
+    queue.clear();
+}
+#include <drivers/filesystem/flash_block_device.h>
+#include <drivers/filesystem/ram_block_device.h>
+void BlockDeviceTest()
+{
+    using namespace Zhele::Drivers::Filesystem;
+    using RamDisk = RamBlockDevice<512, 8>;
+    using FlashDisk = FlashBlockDevice<0x08010000, 8>;
+    static_assert(WritableMemoryMappedBlockDevice<RamDisk>);
+    static_assert(MemoryMappedBlockDevice<FlashDisk> && !WritableMemoryMappedBlockDevice<FlashDisk>);
+
+    uint8_t buffer[512];
+    RamDisk::ReadBlock(buffer, 0);
+    RamDisk::WriteMultipleBlock(buffer, 0, 1);
+    RamDisk::ReadAsync(buffer, 0, 1, [](bool){});
+    RamDisk::WriteAsync(buffer, 0, 1, nullptr);
+    RamDisk::Erase(0, 1);
+    FlashDisk::ReadMultipleBlock(buffer, 0, 1);
+    FlashDisk::WriteBlock(buffer, 0);
+    FlashDisk::ReadAsync(buffer, 0, 1, nullptr);
+    FlashDisk::WriteAsync(buffer, 0, 1, [](bool){});
+    FlashDisk::Data(0);
+    FlashDisk::Sync();
+}
+
+#include <drivers/filesystem/flash_kv_store.h>
+void KvStoreTest()
+{
+    using Store = Zhele::Drivers::Filesystem::FlashKvStore<0x0800f800, 2>;
+    uint32_t counter = 0;
+    Store::Init();
+    Store::Read(1, counter);
+    Store::Write(1, counter + 1);
+    Store::Data(1);
+    Store::Remove(1);
+    Store::FreeSpace();
+}
+
+#include <common/format.h>
+namespace FormatCompileTest
+{
+    using namespace Zhele::Formatting;
+    constexpr bool Equal(const char* a, const char* b) { while (*a != 0 && *a == *b) { ++a; ++b; } return *a == *b; }
+
+    static_assert(Equal(ToString<"%u|%5d|%-3d|%05d">(4294967295u, -42, 7, -42).Text, "4294967295|  -42|7  |-0042"));
+    static_assert(Equal(ToString<"%x %.4X 100%% %s%c">(0xbeefu, 0xau, "ok", '!').Text, "beef 000A 100% ok!"));
+    static_assert(Equal(ToString<"%.2f %.3f">(-3.14159f, Fixed<16>{3 << 15}).Text, "-3.14 1.500"));
+    static_assert(FormatString<"a%db%%%s">::ArgumentsCount == 2);
+
+    void Run()
+    {
+        Zhele::BinaryStream<Zhele::Usart1> stream;
+        Print<"%d %f\r\n">(stream, -1, 2.5f);
+        char buffer[16];
+        Format<"%08x">(buffer, sizeof(buffer), 0x1234u);
+    }
+}
+
+#include <common/lzss.h>
+void LzssCompileTest()
+{
+    struct Sink
+    {
+        void Write(const uint8_t*, unsigned) {}
+    } sink;
+    static Zhele::Compression::LzssEncoder<> encoder;
+    static_assert(Zhele::Compression::LzssEncoder<>::MinMatch == 2 && Zhele::Compression::LzssEncoder<>::MaxMatch == 17);
+    encoder.Write("abcabcabc", 9, sink);
+    encoder.Flush(sink);
+    encoder.Finish(sink);
+    encoder.OutputSize();
+}
+
+#include <common/dsp.h>
+void DspCompileTest()
+{
+    using namespace Zhele::Dsp;
+    static const Q15 taps[3] = {ToQ15(0.25), ToQ15(0.5), ToQ15(0.25)};
+    static const BiquadQ15Coefficients sections[1] = {{ToQ15(0.5, 14), ToQ15(0.5, 14), 0, 0, 0}};
+    static const BiquadQ31Coefficients sections31[1] = {{ToQ31(0.5, 30), ToQ31(0.5, 30), 0, 0, 0}};
+    static FirQ15<3> fir(taps);
+    static FirDecimatorQ15<3, 4> decimator(taps);
+    static BiquadCascadeQ15<1> biquad(sections);
+    static BiquadCascadeQ31<1> biquad31(sections31);
+    static uint16_t adc[8];
+    static Q31 samples31[8];
+    Q15* samples = reinterpret_cast<Q15*>(adc);
+
+    static_assert(ToQ15(0.5) == 16384 && ToQ15(-1.0) == -32768 && ToQ31(2.0) == INT32_MAX);
+    AdcToQ15<12>(adc, samples, 8);
+    fir.Process(samples, samples, 8);
+    decimator.Process(samples, samples, 8);
+    biquad.Process(samples, samples, 8);
+    biquad31.Process(samples31, samples31, 8);
+    Mean(samples, 8);
+    Rms(samples, 8);
+    Rms(samples31, 8);
+}
+
+#include <common/spectrum.h>
+void SpectrumCompileTest()
+{
+    using namespace Zhele::Dsp;
+    static Q15 samples[64];
+    static GoertzelBank<8000, 205, 697, 1209> dtmf;
+    static_assert(GoertzelBank<8000, 205, 697, 1209>::BinFrequency(0) == 702);
+    static_assert(RealFftQ15<64>::Bins == 32 && RealFftQ15<64>::BinFrequency(6400, 1) == 100);
+    RealFftQ15<64>::Forward(samples);
+    RealFftQ15<64>::Magnitude(samples, samples);
+    dtmf.Process(samples, 64);
+    dtmf.Magnitude(0);
+}
+
+#include <common/template_utils/lookup_tables.h>
+void LookupTablesCompileTest()
+{
+    using namespace Zhele::TemplateUtils;
+    static constexpr auto sine = SineTable<uint16_t, 64>(2047.5, 2047.5);
+    static constexpr auto quarter = QuarterSineTable<int16_t, 64>(32767);
+    static constexpr auto gamma = GammaTable<uint8_t, 256>(2.2, 255);
+    static constexpr auto ntc = NtcTable<33>(3950, 10000, 10000, 4095);
+    static_assert(sine[0] == 2048 && sine[16] == 4095 && sine[48] == 0);
+    static_assert(QuarterWaveSine(quarter, 64) == 32767 && QuarterWaveCosine(quarter, 128) == -32767);
+    static_assert(gamma[0] == 0 && gamma[255] == 255 && gamma[128] == 56);
+    static_assert(Interpolate(ntc, 2048, 4095) == 250);
+    static_assert(CrcTable<uint8_t, 8, 0x8c, true>()[1] == 0x5e);
+    static_assert(Pow(2, 10) > 1023.99 && Pow(2, 10) < 1024.01);
+}
+
+#include <common/crc.h>
+void CrcTest()
+{
+    const uint8_t data[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+    Zhele::Crc8Dallas::Calculate(data, sizeof(data));
+    Zhele::Crc7::Update(Zhele::Crc7::Initial, data, sizeof(data));
+    Zhele::Crc16Ccitt::Calculate(data, sizeof(data));
+    Zhele::Crc16Modbus::Calculate(data, sizeof(data));
 
-}
\ No newline at end of file
+    Zhele::HardwareCrc::Enable();
+    Zhele::HardwareCrc::Reset();
+    Zhele::HardwareCrc::Update(reinterpret_cast<const uint32_t*>(data), 2);
+    Zhele::HardwareCrc::Value();
+    Zhele::HardwareCrc::Disable();
+}
+
+#include <common/template_utils/packet_schema.h>
+void PacketSchemaTest()
+{
+    using namespace Zhele::TemplateUtils;
+    struct Telemetry { uint16_t Id; int16_t Temperature; uint8_t Flags; uint8_t Channel; };
+    using TelemetryPacket = PacketSchema<Telemetry,
+        Field<&Telemetry::Id, Zhele::BigEndian>,
+        Field<&Telemetry::Temperature>,
+        BitField<&Telemetry::Flags, 4>,
+        Reserved<1>,
+        BitField<&Telemetry::Channel, 3>>;
+    static_assert(TelemetryPacket::Size == 5);
+
+    Telemetry telemetry {};
+    uint8_t buffer[TelemetryPacket::Size];
+    TelemetryPacket::Encode(telemetry, buffer);
+    TelemetryPacket::Decode(buffer, telemetry);
+
+    Zhele::BinaryStream<Spi1> stream;
+    TelemetryPacket::Write(stream, telemetry);
+    TelemetryPacket::Read(stream, telemetry);
+}
+
+#include <common/usart_autobaud.h>
+void UsartAutoBaudTest()
+{
+    using AutoBaud = Zhele::UsartAutoBaud<Zhele::Usart1, Zhele::Timers::Timer1, 2>;
+    static_assert(AutoBaud::RoundBaud(116000) == 115200 && AutoBaud::RoundBaud(9400) == 9600 && AutoBaud::RoundBaud(100000) == 100000);
+    AutoBaud::Start<Zhele::IO::Pa10>([](unsigned){});
+    AutoBaud::IrqHandler();
+    AutoBaud::Stop();
+    Zhele::Usart1::GetBaud();
+}
+
+#include <drivers/modbus_rtu.h>
+void ModbusRtuTest()
+{
+    using namespace Zhele::Drivers;
+    using Rs485 = Adm485<Zhele::Usart1, Zhele::IO::Pa8>;
+    using Master = ModbusRtuMaster<Rs485, Zhele::Timers::Timer2>;
+    using Slave = ModbusRtuSlave<Adm485<Zhele::Usart2>>;
+
+    uint16_t registers[2];
+    uint8_t bits[1];
+    Master::Init(9600);
+    Master::ReadRegisters(1, ModbusFunction::ReadHoldingRegisters, 0, 2, registers, nullptr);
+    Master::ReadBits(1, ModbusFunction::ReadCoils, 0, 8, bits, nullptr);
+    Master::WriteRegister(1, 0, 0x1234, nullptr);
+    Master::WriteRegisters(0, 0, 2, registers, nullptr);
+    Master::WriteCoil(1, 0, true, nullptr);
+    Master::Busy();
+    Master::Cancel();
+    Master::IrqHandler();
+    Master::TimerIrqHandler();
+
+    static_assert(Rs485::UsartMode::NodeAddress(5) == (5u << USART_CR2_ADD_Pos));
+    Rs485::WriteTo(5, registers, sizeof(registers));
+    Rs485::WriteToAsync(5, registers, sizeof(registers));
+    Rs485::EnterMuteMode();
+    Rs485::IsMuted();
+
+    static const ModbusRegisterBlock block {0, 2, registers};
+    static const ModbusRegisterMap map {nullptr, 0, nullptr, 0, &block, 1, nullptr, 0, nullptr};
+    Slave::Init(115200, 1, &map);
+    Slave::IrqHandler();
+}
+
+#include <common/one_pulse.h>
+void OnePulseTest()
+{
+    using Pulse = Zhele::Timers::OnePulse<Timers::Timer3, Zhele::IO::Pa6, 0>;
+    Pulse::Init();
+    Pulse::Pulse(15, 2, []{});
+    Pulse::Wait();
+    Pulse::IrqHandler();
+    using Delay = Zhele::Timers::OnePulse<Timers::Timer4>;
+    Delay::Init(2000000);
+    if(!Delay::Busy())
+        Delay::Delay(100);
+}
+
+#include <common/timebase.h>
+#include <common/time_sync.h>
+void TimeSyncTest()
+{
+    using Timebase = Zhele::Clock::TimerTimebase<Timers::Timer3, Timers::Timer4, Timers::Timer4::SlaveMode::Trigger::InternalTrigger2>;
+    using Capture = Zhele::Clock::TimebaseCapture<Timebase, 2>;
+    Capture::Init<IO::Pb0>(true, true);
+    Capture::Arm();
+    Capture::IrqHandler();
+    uint32_t timestamp;
+    Capture::Get(timestamp);
+
+    Zhele::Clock::TimeSyncMaster master;
+    Zhele::Clock::TimeSyncSlave<> slave(5);
+    Zhele::Clock::TimeSyncMessage message;
+    master.Prepare(message);
+    master.OnTransmitted(timestamp);
+    slave.OnReceived(message, timestamp);
+    slave.ToLocal(slave.ToMaster(timestamp));
+}
+
+#include <drivers/bmp280.h>
+void Bmp280Test()
+{
+    using BlockingSensor = Zhele::Drivers::Bmp280<I2c1>;
+    BlockingSensor::Init();
+    BlockingSensor::Read();
+    BlockingSensor::StartMeasurement();
+    BlockingSensor::Poll();
+
+    using Sensor = Zhele::Drivers::Bmp280<I2c1, Zhele::Clock::DwtTimebase<72000000>, 0x77>;
+    Sensor::SetMode(Sensor::Mode::Forced);
+    Sensor::StartInit();
+    Sensor::Poll();
+    Sensor::StartMeasurement([](bool){});
+    Sensor::GetState();
+    Sensor::Temperature();
+    Sensor::Pressure();
+}
+
+#include <drivers/aht10.h>
+void Aht10Test()
+{
+    using Sensor = Zhele::Drivers::Aht10Async<Zhele::I2cTransactionQueue<I2c1>, Zhele::Clock::DwtTimebase<72000000>>;
+    Sensor::StartInit();
+    Sensor::Poll();
+    Sensor::StartMeasurement([](bool, const Sensor::Measurement&){});
+    Sensor::GetState();
+    Sensor::LastMeasurement();
+}
+
+#include <exti.h>
+#include <common/power.h>
+void ExtiEventTest()
+{
+    Zhele::Exti3::Init(Zhele::Exti3::Trigger::Falling, 'B');
+    Zhele::Exti3::EnableEvent();
+    Zhele::Power::LowPower::SetEventOnPending(true);
+    Zhele::Power::LowPower::WaitForEvent([]{ return !Zhele::IO::Pb3::IsSet(); });
+    Zhele::Power::LowPower::SendEvent();
+    Zhele::Exti3::DisableEvent();
+}
+
+#include <drivers/ds1307.h>
+void Ds1307Test()
+{
+    using Rtc = Zhele::Drivers::Ds1307CachedClock<I2c1, Zhele::Exti1, Zhele::IO::Pb1>;
+    Rtc::Init();
+    Rtc::GetDateTime();
+    Rtc::SetDateTime(Rtc::GetDateTime());
+    Rtc::Poll();
+    Rtc::IrqHandler();
+    Rtc::Uptime();
+}
+
+#include <rtc.h>
+void RtcTest()
+{
+    using Zhele::Timers::Rtc;
+    if(!Rtc::Init(Rtc::ClockSource::Lse))
+        Rtc::Init(Rtc::ClockSource::Lsi);
+    Rtc::SetCounter(Rtc::GetCounter() + 1);
+    Rtc::Timestamp timestamp = Rtc::GetTimestamp();
+    (void)(timestamp.Subseconds * 1000 / Rtc::SubsecondRate());
+    Rtc::StartWakeupTimer(2000, []{});
+    Rtc::SetCalibration(-10);
+    Rtc::IrqHandler();
+    Rtc::StopWakeupTimer();
+}
+
+#include <drivers/sensor_scheduler.h>
+void OnSample(Zhele::Drivers::SampleStatus) {}
+void SensorSchedulerTest()
+{
+    using Timebase = Zhele::Clock::DwtTimebase<72000000>;
+    using Barometer = Zhele::Drivers::Bmp280<I2c1, Timebase>;
+    using Hygrometer = Zhele::Drivers::Aht10Async<Zhele::I2cTransactionQueue<I2c1>, Timebase>;
+    using Scheduler = Zhele::Drivers::SensorScheduler<Timebase,
+        Zhele::Drivers::SamplingTask<Zhele::Drivers::Bmp280Sampling<Barometer>, 0>,
+        Zhele::Drivers::SamplingTask<Zhele::Drivers::Aht10Sampling<Hygrometer>, 1000000, OnSample>,
+        Zhele::Drivers::SamplingTask<Zhele::Drivers::Ds1307Sampling<Zhele::Drivers::Ds1307<I2c1>>, 1000000>>;
+    Scheduler::Start();
+    Scheduler::Poll();
+    Scheduler::Samples();
+    Scheduler::Failures();
+    Scheduler::Stop();
+}
+
+#include <drivers/rc522.h>
+void Rc522Test()
+{
+    using Reader = Zhele::Drivers::Rc522<Spi1, Zhele::IO::Pa4, Zhele::Exti2, Zhele::IO::Pb2>;
+    uint8_t id[5];
+    Reader::Init();
+    Reader::Check(id);
+    Reader::CheckAsync(id, [](Reader::Status){});
+    Reader::Busy();
+    Reader::IrqHandler();
+}
+
+#include <drivers/sdio_card.h>
+#include <drivers/filesystem/fatfs_adapter.h>
+void SdioCardTest()
+{
+    using Card = Zhele::Drivers::SdioCard<>;
+    static_assert(Zhele::Drivers::Filesystem::BlockDevice<Card>);
+    alignas(4) uint8_t block[512];
+    Card::Detect();
+    Card::ReadMultipleBlock(block, 0, 1);
+    Card::WriteMultipleBlock(block, 0, 1);
+    Card::BeginWrite(0, 1);
+    Card::WriteNextBlockAsync(block, [](bool){});
+    Card::EndWrite();
+    Card::IrqHandler();
+    Zhele::Drivers::Filesystem::SdCardFatFsAdapter<Card>::DiskRead(block, 0, 1);
+}
+
+#include <drivers/w25q.h>
+#include <drivers/filesystem/spi_flash_block_device.h>
+void W25qTest()
+{
+    using Flash = Zhele::Drivers::W25q<Spi1, Zhele::IO::Pa4>;
+    using Disk = Zhele::Drivers::Filesystem::SpiFlashBlockDevice<Flash, 256>;
+    static_assert(Zhele::Drivers::Filesystem::BlockDevice<Disk>);
+    uint8_t block[512];
+    Flash::Init();
+    Flash::ReadAsync(0, block, sizeof(block), [](bool){});
+    Flash::ProgramAsync(0, block, sizeof(block));
+    Flash::EraseSector(0);
+    Flash::WaitReady();
+    Disk::WriteBlock(block, 1);
+    Disk::ReadMultipleBlock(block, 0, 1);
+    Disk::ReadAsync(block, 0, 1, nullptr);
+    Disk::Erase(0, 7);
+    Zhele::Drivers::Filesystem::SdCardFatFsAdapter<Disk>::DiskRead(block, 0, 1);
+}
+
+#include <drivers/compressed_font.h>
+void CompressedFontTest()
+{
+    using BoldFont = Zhele::Drivers::CompressedFont<Zhele::Drivers::Fixed10x15Bold>;
+    static_assert(BoldFont::Size() < 95 * 10 * 2 && BoldFont::GetWidth('A') == 10);
+    using TextFont = Zhele::Drivers::CompressedFont<Zhele::Drivers::TimesNewRoman13>;
+    static_assert(TextFont::GetWidth('A') == Zhele::Drivers::TimesNewRoman13::GetWidth('A'));
+    TextFont::ForEachRun('A', [](uint8_t, uint8_t, uint8_t, bool) {});
+}
+
+#include <drivers/ili9341.h>
+void Ili9341Test()
+{
+#if defined (FSMC_Bank1) && defined (GPIOE)
+    using namespace Zhele::IO;
+    // 16-bit 8080 LCD on NE1, A16 is DC
+    using LcdPins = PinList<Pd14, Pd15, Pd0, Pd1, Pe7, Pe8, Pe9, Pe10, Pe11, Pe12, Pe13, Pe14, Pe15, Pd8, Pd9, Pd10, Pd4, Pd5, Pd7, Pd11>;
+    using Bus = Zhele::Drivers::FsmcBus<LcdPins, 1, 16>;
+    using Lcd = Zhele::Drivers::Ili9341<Bus, Pe1>;
+    constexpr auto timing = FsmcBase::CalculateTiming(72000000, 10, 30, 0);
+    static_assert(timing.AddressSetup == 1 && timing.DataSetup == 3);
+    Bus::Init(FsmcBase::CalculateTiming(72000000, 15, 360), timing);
+    Lcd::Init();
+    Lcd::Fill(Lcd::Blue);
+    Lcd::FillRectangle(10, 10, 20, 20, Lcd::Red);
+    Lcd::DrawPixel(1, 1, Lcd::White);
+    static uint16_t framebuffer[16];
+    Lcd::DrawImage(0, 0, 4, 4, framebuffer);
+    Lcd::WriteFramebufferAsync<Dma1Channel1>(framebuffer);
+
+    FsmcBank3::SelectPins<PinList<Pd14, Pd15, Pd0, Pd1, Pd4, Pd5, Pe0, Pe1>>();
+    FsmcBank3::Init(FsmcBase::MemoryType::Sram, FsmcBase::BusWidth::Bus16, FsmcBase::CalculateTiming(72000000, 0, 55));
+    *FsmcBank3::Memory<uint32_t>(0x100) = 0;
+    FsmcBank3::Disable();
+
+    using ByteLcd = Zhele::Drivers::Ili9341<Zhele::Drivers::ParallelBus<PinList<Pa0, Pa1, Pa2, Pa3, Pa4, Pa5, Pa6, Pa7>, Pb0, Pb1>>;
+    ByteLcd::Init();
+    ByteLcd::Fill(ByteLcd::Green);
+    ByteLcd::WriteFramebuffer(framebuffer);
+#endif
+}
+
+#include <usb.h>
+void UsbDescriptorsTest()
+{
+    using namespace Zhele::Usb;
+    constexpr Zhele::TemplateUtils::fixed_string_16 product(u"Ab");
+    static_assert(StringDescriptorBytes(product) == std::array<uint8_t, 6> {6, 0x03, 'A', 0, 'b', 0});
+    static_assert(CdcDataInterface<1, 0, 0, 0, void>::Descriptor().size() == sizeof(InterfaceDescriptor));
+    static_assert(Configuration<0, 250, false, true, CdcDataInterface<1, 0, 0, 0, void>>::Descriptor()[2] == 18);
+    static_assert(Configuration<0, 250, false, true, CdcDataInterface<1, 0, 0, 0, void>>::Descriptor()[7] == 0xc0);
+}
+
+void UsbMultipleConfigurationsTest()
+{
+    using namespace Zhele::Usb;
+    // Low-power (16 kHz) and high-bandwidth (48 kHz) configurations with alternative isochronous endpoints
+    using LowRateEndpointBase = IsochronousEndpointBase<1, EndpointDirection::In, 32>;
+    using HighRateEndpointBase = IsochronousEndpointBase<1, EndpointDirection::In, 96>;
+    using EpInitializer = EndpointsInitializer<DefaultEp0, LowRateEndpointBase, HighRateEndpointBase>;
+    using Ep0 = EpInitializer::ExtendEndpoint<DefaultEp0>;
+    using LowRateEndpoint = EpInitializer::ExtendEndpoint<LowRateEndpointBase>;
+    using HighRateEndpoint = EpInitializer::ExtendEndpoint<HighRateEndpointBase>;
+
+    using Control = MicrophoneControlInterface<0, Ep0, 1, 1>;
+    using LowRateConfig = Configuration<1, 50, false, false, Control,
+        AudioStreamingInterface<1, Ep0, Control::StreamingTerminalId, 16000, 1, 16, LowRateEndpoint>>;
+    using HighRateConfig = Configuration<2, 250, false, false, Control,
+        AudioStreamingInterface<1, Ep0, Control::StreamingTerminalId, 48000, 1, 16, HighRateEndpoint>>;
+    using MyDevice = Device<0x0200, DeviceAndInterfaceClass::InterfaceSpecified, 0, 0, 0x0483, 0x5730, 0, Ep0, LowRateConfig, HighRateConfig>;
+
+    MyDevice::Enable();
+    MyDevice::CommonHandler();
+
+    MyDevice::SetSuspendCallback([]() {});
+    MyDevice::SetResumeCallback([]() {});
+    if(MyDevice::IsSuspended())
+        MyDevice::RemoteWakeup();
+}
+
+namespace UsbNcmTest
+{
+    using namespace Zhele::Usb;
+    using NotificationEpBase = InEndpointBase<1, EndpointType::Interrupt, 16, 32>;
+    using OutEpBase = BulkDoubleBufferedEndpointBase<2, EndpointDirection::Out, 64>;
+    using InEpBase = BulkDoubleBufferedEndpointBase<3, EndpointDirection::In, 64>;
+    using EpInitializer = EndpointsInitializer<DefaultEp0, NotificationEpBase, OutEpBase, InEpBase>;
+    using Ep0 = EpInitializer::ExtendEndpoint<DefaultEp0>;
+    using NotificationEp = EpInitializer::ExtendEndpoint<NotificationEpBase>;
+    using OutEp = EpInitializer::ExtendEndpoint<OutEpBase>;
+    using InEp = EpInitializer::ExtendEndpoint<InEpBase>;
+
+    using Stream = NcmStream<OutEp, InEp>;
+    using Comm = NcmCommInterface<0, Ep0, NotificationEp, 1, Stream>;
+    using Data = NcmDataInterface<1, Ep0, Comm, OutEp, InEp>;
+    using Config = Configuration<1, 250, false, false, Comm, Data>;
+    constexpr Zhele::TemplateUtils::fixed_string_16 Mac(u"02A0B1C2D3E4");
+    using MyDevice = DeviceWithStrings<0x0200, DeviceAndInterfaceClass::Comm, 0, 0, 0x0483, 0x5740, 0, Zhele::TemplateUtils::EmptyFixedString16, Zhele::TemplateUtils::EmptyFixedString16, Mac, Ep0, Config>;
+}
+template<> void UsbNcmTest::OutEp::HandleRx(void* data, uint16_t size) { UsbNcmTest::Stream::HandleRx(data, size); }
+
+void UsbNcmCompileTest()
+{
+    using namespace UsbNcmTest;
+    static_assert(Config::Descriptor()[2] == Config::Descriptor().size());
+
+    uint8_t frame[1514] {};
+    Stream::Send(frame, 60);
+    Stream::Tick();
+    Stream::Receive(frame, sizeof(frame));
+    MyDevice::Enable();
+    MyDevice::CommonHandler();
+}
+
+namespace UsbVendorTest
+{
+    using namespace Zhele::Usb;
+    using OutEpBase = BulkDoubleBufferedEndpointBase<1, EndpointDirection::Out, 64>;
+    using InEpBase = BulkDoubleBufferedEndpointBase<2, EndpointDirection::In, 64>;
+    using EpInitializer = EndpointsInitializer<DefaultEp0, OutEpBase, InEpBase>;
+    using Ep0 = EpInitializer::ExtendEndpoint<DefaultEp0>;
+    using OutEp = EpInitializer::ExtendEndpoint<OutEpBase>;
+    using InEp = EpInitializer::ExtendEndpoint<InEpBase>;
+
+    constexpr Zhele::TemplateUtils::fixed_string_16 Guid(u"{88BAE032-5A81-49F0-BC3D-A4FF138216D6}");
+    using Vendor = VendorInterface<0, Ep0, OutEp, InEp, Guid>;
+    using Config = Configuration<1, 250, false, false, Vendor>;
+    using MyDevice = Device<0x0210, DeviceAndInterfaceClass::InterfaceSpecified, 0, 0, 0x0483, 0x5741, 0, Ep0, Config>;
+
+    static_assert(MsOs20Descriptors<Config>::DescriptorSet().size() == 10 + 20 + 132);
+    static_assert(MsOs20Descriptors<Config>::Bos().size() == 33);
+}
+template<> void UsbVendorTest::OutEp::HandleRx(void* data, uint16_t size) { UsbVendorTest::Vendor::Stream::HandleRx(data, size); }
+
+void UsbVendorCompileTest()
+{
+    using namespace UsbVendorTest;
+
+    static uint8_t buffer[4096];
+    Vendor::Stream::Receive(buffer, sizeof(buffer), [](uint32_t size) { Vendor::Stream::Send(buffer, size); });
+    MyDevice::Enable();
+    MyDevice::CommonHandler();
+}
+
+namespace UsbDfuTest
+{
+    using namespace Zhele::Usb;
+    using Ep0 = EndpointsInitializer<DefaultEp0>::ExtendEndpoint<DefaultEp0>;
+    using Dfu = DfuInterface<0, Ep0, 0x08004000, 0x1c000, 1024>;
+    using Config = Configuration<1, 50, false, false, Dfu>;
+    using MyDevice = Device<0x0200, DeviceAndInterfaceClass::InterfaceSpecified, 0, 0, 0x0483, 0xdf11, 0, Ep0, Config>;
+    static_assert(Config::Descriptor().size() == 9 + 9 + 9);
+}
+
+void UsbDfuCompileTest()
+{
+    using namespace UsbDfuTest;
+    Dfu::SetManifestationCallback([]{ NVIC_SystemReset(); });
+    MyDevice::Enable();
+    MyDevice::CommonHandler();
+}
+
+namespace UsbCompositePlanTest
+{
+    using namespace Zhele::Usb;
+    class CdcCommRequest : public InEndpointRequest<EndpointType::Interrupt, 8, 255> {};
+    class CdcOutRequest : public OutEndpointRequest<EndpointType::Bulk> {};
+    class CdcInRequest : public InEndpointRequest<EndpointType::Bulk> {};
+    class MscOutRequest : public OutEndpointRequest<EndpointType::BulkDoubleBuffered> {};
+    class MscInRequest : public InEndpointWithoutZlpRequest<EndpointType::BulkDoubleBuffered> {};
+    class HidInRequest : public InEndpointRequest<EndpointType::Interrupt, 8, 10> {};
+    class HidOutRequest : public OutEndpointRequest<EndpointType::Interrupt, 8, 10> {};
+
+    using Plan = CompositeEndpointsPlan<DefaultEp0, CdcCommRequest, CdcOutRequest, CdcInRequest, MscOutRequest, MscInRequest, HidInRequest, HidOutRequest>;
+    using CdcCommEpBase = Plan::Endpoint<CdcCommRequest>;
+    using MscInEpBase = Plan::Endpoint<MscInRequest>;
+    using HidOutEpBase = Plan::Endpoint<HidOutRequest>;
+
+    static_assert(CdcCommEpBase::Number == 1 && HidOutEpBase::Number == 2 && MscInEpBase::Number == 5);
+    static_assert(Plan::Endpoint<CdcInRequest>::MaxPacketSize == 64);
+    static_assert(Plan::Endpoint<MscOutRequest>::MaxPacketSize == 32 && MscInEpBase::MaxPacketSize == 32);
+    static_assert(Plan::UsedPacketMemory <= Plan::AvailablePacketMemory);
+
+    using Ep0 = Plan::Initializer::ExtendEndpoint<DefaultEp0>;
+    using CdcCommEp = Plan::Initializer::ExtendEndpoint<CdcCommEpBase>;
+    using HidOutEp = Plan::Initializer::ExtendEndpoint<HidOutEpBase>;
+}
+
+namespace UsbDualCdcTest
+{
+    using namespace Zhele::Usb;
+    using Cdc = DualCdc<>;
+    using Config = Configuration<0, 250, false, false, Cdc::Comm0, Cdc::Data0, Cdc::Comm1, Cdc::Data1>;
+    using MyDevice = Device<0x0200, DeviceAndInterfaceClass::Miscellaneous, 0x02, 0x01, 0x0483, 0x5742, 0, Cdc::Ep0, Config>;
+
+    static_assert(Config::Descriptor().size() == 9 + 2 * (8 + 9 + 5 + 5 + 4 + 5 + 7 + 9 + 7 + 7));
+    static_assert(Cdc::CommEp0::Number == 1 && Cdc::CommEp1::Number == 2 && Cdc::InEp1::Number == 6);
+    static_assert(Cdc::Plan::UsedPacketMemory <= Cdc::Plan::AvailablePacketMemory);
+}
+template<> void UsbDualCdcTest::Cdc::OutEp0::HandleRx(void* data, uint16_t size) { UsbDualCdcTest::Cdc::Stream0::HandleRx(data, size); }
+template<> void UsbDualCdcTest::Cdc::OutEp1::HandleRx(void* data, uint16_t size) { UsbDualCdcTest::Cdc::Stream1::HandleRx(data, size); }
+
+void UsbDualCdcCompileTest()
+{
+    using namespace UsbDualCdcTest;
+    uint8_t buffer[64];
+    Cdc::Stream1::Write(buffer, Cdc::Stream0::Read(buffer, sizeof(buffer)));
+    Cdc::Tick();
+    MyDevice::Enable();
+    MyDevice::CommonHandler();
+}
+
+#include <common/template_utils/type_list.h>
+namespace TypeListTest
+{
+    using namespace Zhele::TemplateUtils;
+    using List = TypeList<char, int, char, void, long>;
+
+    static_assert(TypeIndex<char, List>::value == 0 && TypeIndex<long, List>::value == 4 && TypeIndex<short, List>::value == -1);
+    static_assert(std::is_same_v<GetType_t<3, List>, void> && std::is_same_v<GetType_t<-1, List>, void> && std::is_same_v<GetType_t<4, List>, long>);
+    static_assert(std::is_same_v<Sample_t<std::is_integral, List>, TypeList<char, int, char, long>>);
+    static_assert(Search<std::is_void, List>::value == 3 && Search<std::is_floating_point, List>::value == -1);
+}
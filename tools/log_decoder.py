@@ -0,0 +1,153 @@
+#!/usr/bin/env python3
+"""
+Host decoder of Zhele binary log (see Zhele/include/common/log.h).
+
+Collects format strings of ZHELE_LOG_WRITE(...) calls from sources, calculates their ids
+(the same FNV-1a hash as firmware) and formats records read from file, stdin or serial port
+(USART drain) or from SWO capture (ITM stimulus port data only, without ITM packet headers).
+
+Record: header (format id << 8 | arguments count), timestamp (DWT CYCCNT), arguments,
+all are 32-bit little endian words. Records with unknown id are skipped by arguments count.
+
+Usage:
+    log_decoder.py [--sources <dir> ...] [--input <file> | --serial <port> [--baudrate 115200]] [--cpu-freq <Hz>]
+
+    --sources    Directories (or files) with sources to scan for format strings (default: repository root)
+    --input      Binary log file ("-" for stdin, default)
+    --serial     Serial port (requires pyserial)
+    --cpu-freq   CPU frequence to print timestamps in seconds instead of cycles
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+SOURCE_EXTENSIONS = (".c", ".cc", ".cpp", ".cxx", ".h", ".hpp")
+LOG_CALL = re.compile(r'ZHELE_LOG_WRITE\s*\(\s*"((?:[^"\\]|\\.)*)"')
+CONVERSION = re.compile(r"%([-+ #0]*[0-9]*(?:\.[0-9]*)?)[hl]?([diuxXcfegp%])")
+ESCAPES = {"n": "\n", "t": "\t", "r": "\r", "0": "\0", "\\": "\\", '"': '"', "'": "'"}
+
+
+def unescape(text):
+    """Converts C string literal body to string."""
+    return re.sub(r"\\(x[0-9a-fA-F]{2}|.)",
+                  lambda m: chr(int(m.group(1)[1:], 16)) if m.group(1)[0] == "x" else ESCAPES.get(m.group(1), m.group(1)),
+                  text)
+
+
+def format_id(text):
+    """FNV-1a hash folded to 24 bits (Zhele::Log::Private::FormatId)."""
+    value = 2166136261
+    for byte in text.encode("latin-1"):
+        value = ((value ^ byte) * 16777619) & 0xffffffff
+    return (value >> 24) ^ (value & 0x00ffffff)
+
+
+def collect_formats(paths):
+    """Returns dictionary id -> format string."""
+    formats = {}
+    files = []
+    for path in paths:
+        if os.path.isfile(path):
+            files.append(path)
+            continue
+        for directory, _, names in os.walk(path):
+            files.extend(os.path.join(directory, name) for name in names if name.endswith(SOURCE_EXTENSIONS))
+
+    for file in files:
+        with open(file, encoding="utf-8", errors="replace") as source:
+            for match in LOG_CALL.finditer(source.read()):
+                text = unescape(match.group(1))
+                identifier = format_id(text)
+                if identifier in formats and formats[identifier] != text:
+                    print(f"warning: format id collision 0x{identifier:06x}: {formats[identifier]!r} and {text!r}", file=sys.stderr)
+                formats[identifier] = text
+    return formats
+
+
+def format_record(text, arguments):
+    """Formats record arguments by printf-like format."""
+    values = iter(arguments)
+
+    def convert(match):
+        flags, kind = match.groups()
+        if kind == "%":
+            return "%"
+        raw = next(values, 0)
+        if kind in "di":
+            return ("%" + flags + "d") % struct.unpack("<i", struct.pack("<I", raw))[0]
+        if kind in "feg":
+            return ("%" + flags + kind) % struct.unpack("<f", struct.pack("<I", raw))[0]
+        if kind == "c":
+            return chr(raw & 0xff)
+        if kind == "p":
+            return "0x%08x" % raw
+        return ("%" + flags + kind) % raw
+
+    return CONVERSION.sub(convert, text)
+
+
+def read_words(stream):
+    """Yields 32-bit little endian words from binary stream."""
+    while True:
+        data = stream.read(4)
+        while 0 < len(data) < 4:
+            chunk = stream.read(4 - len(data))
+            if not chunk:
+                return
+            data += chunk
+        if not data:
+            return
+        yield struct.unpack("<I", data)[0]
+
+
+def decode(stream, formats, cpu_freq):
+    words = read_words(stream)
+    for header in words:
+        count = header & 0xff
+        identifier = header >> 8
+        try:
+            timestamp = next(words)
+            arguments = [next(words) for _ in range(count)]
+        except StopIteration:
+            return
+
+        stamp = f"{timestamp / cpu_freq:12.6f}" if cpu_freq else f"{timestamp:10d}"
+        if identifier in formats:
+            print(f"{stamp} {format_record(formats[identifier], arguments)}", flush=True)
+        else:
+            print(f"{stamp} <unknown format 0x{identifier:06x}> " + " ".join(f"0x{a:08x}" for a in arguments), flush=True)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Zhele binary log decoder")
+    parser.add_argument("--sources", action="append", default=None)
+    parser.add_argument("--input", default="-")
+    parser.add_argument("--serial")
+    parser.add_argument("--baudrate", type=int, default=115200)
+    parser.add_argument("--cpu-freq", type=float, default=0)
+    args = parser.parse_args()
+
+    formats = collect_formats(args.sources or [ROOT])
+
+    if args.serial:
+        import serial
+        stream = serial.Serial(args.serial, args.baudrate)
+    elif args.input == "-":
+        stream = sys.stdin.buffer
+    else:
+        stream = open(args.input, "rb")
+
+    try:
+        decode(stream, formats, args.cpu_freq)
+    except KeyboardInterrupt:
+        pass
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,120 @@
+#!/usr/bin/env python3
+"""
+Host decompressor of Zhele streaming LZSS (see Zhele/include/common/lzss.h).
+
+Decodes file, stdin or serial port stream and writes decompressed data to file or stdout,
+so it can be piped to other tools (for example, tools/log_decoder.py). Window and length
+bits should be the same as LzssEncoder template arguments.
+
+Usage:
+    lzss_decoder.py [--input <file> | --serial <port> [--baudrate 115200]] [--output <file>]
+                    [--window-bits 9] [--length-bits 4]
+
+    --input      Compressed data file ("-" for stdin, default)
+    --serial     Serial port (requires pyserial), for example CDC device
+    --output     Decompressed data file ("-" for stdout, default)
+"""
+
+import argparse
+import sys
+
+
+class BitReader:
+    """Reads MSB first bits from byte stream."""
+
+    def __init__(self, stream):
+        self.stream = stream
+        self.bits = 0
+        self.count = 0
+
+    def read(self, count):
+        """Returns value or None at stream end."""
+        while self.count < count:
+            byte = self.stream.read(1)
+            if not byte:
+                return None
+            self.bits = (self.bits << 8) | byte[0]
+            self.count += 8
+        self.count -= count
+        value = (self.bits >> self.count) & ((1 << count) - 1)
+        self.bits &= (1 << self.count) - 1
+        return value
+
+    def align(self):
+        """Skips bits up to byte boundary."""
+        self.count -= self.count % 8
+        self.bits &= (1 << self.count) - 1
+
+
+def decode(stream, output, window_bits, length_bits):
+    min_match = (1 + window_bits + length_bits) // 9 + 1
+    window = bytearray()
+    reader = BitReader(stream)
+    while True:
+        tag = reader.read(1)
+        if tag is None:
+            return
+        if tag == 1:
+            literal = reader.read(8)
+            if literal is None:
+                return
+            chunk = bytes([literal])
+        else:
+            offset = reader.read(window_bits)
+            if offset is None:
+                return
+            if offset == 0:
+                # Sync: encoder flushed data
+                reader.align()
+                output.flush()
+                continue
+            length = reader.read(length_bits)
+            if length is None:
+                return
+            length += min_match
+            if offset > len(window):
+                raise ValueError(f"invalid match offset {offset}")
+            data = bytearray()
+            for _ in range(length):
+                # Byte by byte copy: match may overlap itself (repeated pattern)
+                byte = window[-offset]
+                window.append(byte)
+                data.append(byte)
+            del window[:-(1 << window_bits)]
+            output.write(bytes(data))
+            continue
+
+        window.extend(chunk)
+        del window[:-(1 << window_bits)]
+        output.write(chunk)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Zhele LZSS decompressor")
+    parser.add_argument("--input", default="-")
+    parser.add_argument("--serial")
+    parser.add_argument("--baudrate", type=int, default=115200)
+    parser.add_argument("--output", default="-")
+    parser.add_argument("--window-bits", type=int, default=9)
+    parser.add_argument("--length-bits", type=int, default=4)
+    args = parser.parse_args()
+
+    if args.serial:
+        import serial
+        stream = serial.Serial(args.serial, args.baudrate)
+    elif args.input == "-":
+        stream = sys.stdin.buffer
+    else:
+        stream = open(args.input, "rb")
+
+    output = sys.stdout.buffer if args.output == "-" else open(args.output, "wb")
+    try:
+        decode(stream, output, args.window_bits, args.length_bits)
+    except KeyboardInterrupt:
+        pass
+    output.flush()
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
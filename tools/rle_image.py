@@ -0,0 +1,102 @@
+#!/usr/bin/env python3
+"""
+Host encoder of RLE RGB565 images (see Zhele/include/drivers/image_decoder.h, RleDecoder).
+
+Converts uncompressed 24-bit or 32-bit BMP to compact RLE format for streaming to TFT displays:
+header is "RL", width and height (16-bit), then runs follow. Run starts with control byte:
+if bit 7 is set, next pixel is repeated (control & 0x7f) + 1 times, otherwise (control + 1) pixels follow.
+Pixels (RGB565) and header values are little endian, rows are top-down.
+
+Usage:
+    rle_image.py <input.bmp> <output.rle>
+"""
+
+import argparse
+import struct
+import sys
+
+MAX_RUN = 128
+
+
+def read_bmp(path):
+    """Returns width, height and RGB565 pixels (top-down) of BMP file."""
+    with open(path, "rb") as file:
+        data = file.read()
+
+    if data[:2] != b"BM":
+        raise ValueError("not a BMP file")
+
+    offset, = struct.unpack_from("<I", data, 10)
+    width, height, _, bits, compression = struct.unpack_from("<iiHHI", data, 18)
+    if bits not in (24, 32) or compression not in (0, 3):
+        raise ValueError("only uncompressed 24-bit and 32-bit BMP are supported")
+
+    bottom_up = height > 0
+    height = abs(height)
+    step = bits // 8
+    stride = (width * step + 3) & ~3
+
+    pixels = []
+    for row in range(height):
+        file_row = height - 1 - row if bottom_up else row
+        start = offset + file_row * stride
+        for column in range(width):
+            blue, green, red = data[start + column * step:start + column * step + 3]
+            pixels.append(((red & 0xf8) << 8) | ((green & 0xfc) << 3) | (blue >> 3))
+    return width, height, pixels
+
+
+def encode(width, height, pixels):
+    """Encodes RGB565 pixels to RLE image."""
+    output = bytearray(b"RL" + struct.pack("<HH", width, height))
+    literal = []
+
+    def flush_literal():
+        while literal:
+            chunk = literal[:MAX_RUN]
+            del literal[:MAX_RUN]
+            output.append(len(chunk) - 1)
+            for pixel in chunk:
+                output.extend(struct.pack("<H", pixel))
+
+    index = 0
+    while index < len(pixels):
+        run = 1
+        while index + run < len(pixels) and run < MAX_RUN and pixels[index + run] == pixels[index]:
+            run += 1
+
+        # Repeat run of 2 pixels is shorter than literal (3 bytes instead of 4)
+        if run >= 2:
+            flush_literal()
+            output.append(0x80 | (run - 1))
+            output.extend(struct.pack("<H", pixels[index]))
+        else:
+            literal.append(pixels[index])
+        index += run
+
+    flush_literal()
+    return bytes(output)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Converts BMP to RLE RGB565 image")
+    parser.add_argument("input", help="Input BMP file")
+    parser.add_argument("output", help="Output RLE file")
+    args = parser.parse_args()
+
+    try:
+        width, height, pixels = read_bmp(args.input)
+    except (OSError, ValueError, struct.error) as error:
+        print("Error: {}".format(error), file=sys.stderr)
+        return 1
+
+    encoded = encode(width, height, pixels)
+    with open(args.output, "wb") as file:
+        file.write(encoded)
+
+    print("{}x{}: {} bytes ({:.1f}% of raw RGB565)".format(width, height, len(encoded), 100.0 * len(encoded) / (2 * len(pixels))))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
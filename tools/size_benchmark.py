@@ -0,0 +1,157 @@
+#!/usr/bin/env python3
+"""
+Code size and compile time regression benchmark.
+
+Compiles every example (with library sources) for Stm32F0/F1/F4/L4 with GNU Arm Embedded Toolchain,
+links it with --gc-sections (main and all *_IRQHandler functions are roots) and records
+.text/.data/.bss and compile time. Results are compared with baseline, script fails (exit code 1)
+if any size or compile time grows more than threshold.
+
+Examples, which names end with family suffix (_f1, _F4, ...), are built only for that family.
+Example not compiled for family (peripheral is not supported, for example) is skipped,
+but it's regression if baseline has it.
+
+Usage:
+    size_benchmark.py --cmsis <dir> [--cmsis <dir> ...] [--baseline tools/size_baseline.json] [--update]
+
+    --cmsis      CMSIS include directories (core and device headers, for example
+                 ~/.platformio/packages/framework-cmsis/CMSIS/Core/Include and
+                 ~/.platformio/packages/framework-cmsis-stm32f1/Include)
+    --update     Write results as new baseline
+"""
+
+import argparse
+import json
+import os
+import re
+import subprocess
+import sys
+import tempfile
+import time
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+FAMILIES = {
+    "f0": ["-DSTM32F0", "-DSTM32F072xB", "-mcpu=cortex-m0"],
+    "f1": ["-DSTM32F1", "-DSTM32F103xB", "-mcpu=cortex-m3"],
+    "f4": ["-DSTM32F4", "-DSTM32F401xC", "-mcpu=cortex-m4", "-mfloat-abi=hard", "-mfpu=fpv4-sp-d16"],
+    "l4": ["-DSTM32L4", "-DSTM32L432xx", "-mcpu=cortex-m4", "-mfloat-abi=hard", "-mfpu=fpv4-sp-d16"],
+}
+
+CXXFLAGS = ["-std=c++20", "-Os", "-mthumb", "-fno-exceptions", "-fno-rtti", "-fno-threadsafe-statics",
+            "-ffunction-sections", "-fdata-sections"]
+LDFLAGS = ["-Wl,--gc-sections", "--specs=nano.specs", "--specs=nosys.specs", "-Wl,-e,main"]
+
+
+def run(command):
+    return subprocess.run(command, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True)
+
+
+def example_families(name):
+    suffix = re.search(r"_(f0|f1|f4|l4)$", os.path.splitext(name)[0], re.IGNORECASE)
+    return [suffix.group(1).lower()] if suffix else list(FAMILIES)
+
+
+def library_sources(family):
+    sources = []
+    for directory in ("common", family):
+        path = os.path.join(ROOT, "Zhele", "src", directory)
+        sources += [os.path.join(path, name) for name in sorted(os.listdir(path)) if name.endswith(".cpp")]
+    return sources
+
+
+def build(args, example, family, directory):
+    flags = CXXFLAGS + FAMILIES[family] + ["-I" + os.path.join(ROOT, "Zhele", "include")]
+    flags += ["-I" + path for path in args.cmsis]
+    objects = []
+
+    started = time.monotonic()
+    for source in [example] + library_sources(family):
+        obj = os.path.join(directory, os.path.basename(source) + ".o")
+        result = run([args.cxx] + flags + ["-c", source, "-o", obj])
+        if result.returncode != 0:
+            return None
+        objects.append(obj)
+    compile_time = time.monotonic() - started
+
+    # Interrupt handlers are referenced only by vector table (startup code is not linked)
+    symbols = run([args.nm, "--defined-only", objects[0]]).stdout
+    roots = ["-Wl,-u," + symbol for symbol in re.findall(r"\b(\w+_IRQHandler)\b", symbols)]
+
+    elf = os.path.join(directory, "example.elf")
+    result = run([args.cxx] + flags + LDFLAGS + roots + objects + ["-o", elf])
+    if result.returncode != 0:
+        return None
+
+    text, data, bss = run([args.size, elf]).stdout.splitlines()[1].split()[:3]
+    return {"text": int(text), "data": int(data), "bss": int(bss), "time": round(compile_time, 2)}
+
+
+def compare(baseline, results, threshold, time_threshold):
+    regressions = []
+    for key, old in sorted(baseline.items()):
+        new = results.get(key)
+        if new is None:
+            regressions.append("%s: not compiled" % key)
+            continue
+        for section in ("text", "data", "bss"):
+            if new[section] > old[section] * (1 + threshold / 100):
+                regressions.append("%s: .%s %d -> %d" % (key, section, old[section], new[section]))
+        if new["time"] > old["time"] * (1 + time_threshold / 100):
+            regressions.append("%s: compile time %.2fs -> %.2fs" % (key, old["time"], new["time"]))
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Code size and compile time regression benchmark")
+    parser.add_argument("--cmsis", action="append", default=[], help="CMSIS include directory")
+    parser.add_argument("--baseline", default=os.path.join(ROOT, "tools", "size_baseline.json"))
+    parser.add_argument("--update", action="store_true", help="write results as new baseline")
+    parser.add_argument("--threshold", type=float, default=1.0, help="max size growth, percents")
+    parser.add_argument("--time-threshold", type=float, default=25.0, help="max compile time growth, percents")
+    parser.add_argument("--family", action="append", choices=list(FAMILIES), help="build only given families")
+    parser.add_argument("--cxx", default="arm-none-eabi-g++")
+    parser.add_argument("--nm", default="arm-none-eabi-nm")
+    parser.add_argument("--size", default="arm-none-eabi-size")
+    args = parser.parse_args()
+
+    examples_directory = os.path.join(ROOT, "examples")
+    results = {}
+    print("%-48s %8s %8s %8s %8s" % ("example", "text", "data", "bss", "time"))
+    for name in sorted(os.listdir(examples_directory)):
+        if not name.endswith(".cpp"):
+            continue
+        for family in example_families(name):
+            if args.family and family not in args.family:
+                continue
+            with tempfile.TemporaryDirectory() as directory:
+                result = build(args, os.path.join(examples_directory, name), family, directory)
+            key = "%s/%s" % (family, os.path.splitext(name)[0])
+            if result is None:
+                print("%-48s skipped" % key)
+                continue
+            results[key] = result
+            print("%-48s %8d %8d %8d %7.2fs" % (key, result["text"], result["data"], result["bss"], result["time"]))
+
+    if args.update:
+        with open(args.baseline, "w") as baseline:
+            json.dump(results, baseline, indent=4, sort_keys=True)
+        return 0
+
+    if not os.path.exists(args.baseline):
+        print("No baseline (run with --update to create it)")
+        return 0
+
+    with open(args.baseline) as baseline:
+        baseline = json.load(baseline)
+    if args.family:
+        baseline = {key: value for key, value in baseline.items() if key.split("/")[0] in args.family}
+
+    regressions = compare(baseline, results, args.threshold, args.time_threshold)
+    for regression in regressions:
+        print("REGRESSION " + regression)
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())